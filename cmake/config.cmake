@@ -39,6 +39,15 @@ set(RAF_USE_CUBLAS OFF)
 # RAF_USE_CUDNN. Option: [ON/OFF/Path-To-CUDNN]. You may use environment variables, like $ENV{CUDNN_HOME}
 set(RAF_USE_CUDNN OFF)
 
+# RAF_USE_CUPTI. Option: [ON/OFF]. Enables the low-overhead per-kernel tracer.
+set(RAF_USE_CUPTI OFF)
+
+# RAF_USE_NVTX. Option: [ON/OFF]. Annotates the ops, passes and VM phases for Nsight Systems.
+set(RAF_USE_NVTX OFF)
+
+# RAF_USE_CUSPARSELT. Option: [ON/OFF/Path-To-cuSPARSELt]. Enables the 2:4 sparse gemm on sm80+.
+set(RAF_USE_CUSPARSELT OFF)
+
 # RAF_USE_SANITIZER. Option: [OFF/ASAN/MSAN/TSAN/UBSAN]"
 set(RAF_USE_SANITIZER OFF)
 
@@ -12,6 +12,18 @@ else()
   if (${RAF_USE_CUDA} STREQUAL "OFF")
     message(FATAL_ERROR "Cannot enable cuBLAS without using CUDA.")
   endif()
-  set(RAF_CUBLAS_LIBRARY ${CUDA_CUBLAS_LIBRARIES})
+  # cuBLASLt is used by the cublaslt dialect for the matmul with fused epilogues.
+  find_library(RAF_CUBLASLT_LIBRARY cublasLt
+    HINTS ${CUDA_TOOLKIT_ROOT_DIR} PATH_SUFFIXES lib64 lib lib/x64)
+  if (NOT RAF_CUBLASLT_LIBRARY)
+    message(FATAL_ERROR "Cannot find cuBLASLt in ${CUDA_TOOLKIT_ROOT_DIR}")
+  endif()
+  # cuSPARSE is used by the cusparse dialect for the sparse matrix operators.
+  find_library(RAF_CUSPARSE_LIBRARY cusparse
+    HINTS ${CUDA_TOOLKIT_ROOT_DIR} PATH_SUFFIXES lib64 lib lib/x64)
+  if (NOT RAF_CUSPARSE_LIBRARY)
+    message(FATAL_ERROR "Cannot find cuSPARSE in ${CUDA_TOOLKIT_ROOT_DIR}")
+  endif()
+  set(RAF_CUBLAS_LIBRARY ${CUDA_CUBLAS_LIBRARIES} ${RAF_CUBLASLT_LIBRARY} ${RAF_CUSPARSE_LIBRARY})
   message(STATUS "Found RAF_CUBLAS_LIBRARY = ${RAF_CUBLAS_LIBRARY}")
 endif()
@@ -3,14 +3,25 @@
 
 # Provides:
 #  - RAF_CUDA_INCLUDE
+#  - RAF_CUDA_LIBRARY
 #
 #  See https://cmake.org/cmake/help/latest/module/FindCUDA.html
 if (${RAF_USE_CUDA} STREQUAL "OFF")
   message(STATUS "Build without CUDA")
   set(RAF_CUDA_INCLUDE "")
+  set(RAF_CUDA_LIBRARY "")
 else()
   find_package(CUDA REQUIRED)
   message(STATUS "Found CUDA ${CUDA_VERSION_STRING} at ${CUDA_TOOLKIT_ROOT_DIR}")
   set(RAF_CUDA_INCLUDE ${CUDA_INCLUDE_DIRS})
   message(STATUS "Found RAF_CUDA_INCLUDE = ${RAF_CUDA_INCLUDE}")
+  # NVRTC and the driver API are used by the nvrtc dialect.
+  find_library(RAF_CUDA_NVRTC_LIBRARY nvrtc
+    HINTS ${CUDA_TOOLKIT_ROOT_DIR}
+    PATH_SUFFIXES lib lib64 targets/x86_64-linux/lib)
+  find_library(RAF_CUDA_DRIVER_LIBRARY cuda
+    HINTS ${CUDA_TOOLKIT_ROOT_DIR}
+    PATH_SUFFIXES lib lib64 lib64/stubs targets/x86_64-linux/lib/stubs)
+  set(RAF_CUDA_LIBRARY ${RAF_CUDA_NVRTC_LIBRARY} ${RAF_CUDA_DRIVER_LIBRARY})
+  message(STATUS "Found RAF_CUDA_LIBRARY = ${RAF_CUDA_LIBRARY}")
 endif()
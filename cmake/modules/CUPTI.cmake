@@ -0,0 +1,29 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+##############################################################################
+# Provide:
+#  - RAF_CUPTI_INCLUDE
+#  - RAF_CUPTI_LIBRARY
+
+if (${RAF_USE_CUPTI} STREQUAL "OFF")
+  message(STATUS "Build without CUPTI support")
+  set(RAF_CUPTI_INCLUDE "")
+  set(RAF_CUPTI_LIBRARY "")
+else()
+  if (${RAF_USE_CUDA} STREQUAL "OFF")
+    message(FATAL_ERROR "Cannot enable CUPTI without using CUDA.")
+  endif()
+  # CUPTI ships with the CUDA toolkit under extras/CUPTI.
+  find_path(RAF_CUPTI_INCLUDE cupti.h
+    HINTS ${CUDA_TOOLKIT_ROOT_DIR}
+    PATH_SUFFIXES extras/CUPTI/include include)
+  find_library(RAF_CUPTI_LIBRARY cupti
+    HINTS ${CUDA_TOOLKIT_ROOT_DIR}
+    PATH_SUFFIXES extras/CUPTI/lib64 extras/CUPTI/lib lib64 lib)
+  if (NOT RAF_CUPTI_INCLUDE OR NOT RAF_CUPTI_LIBRARY)
+    message(FATAL_ERROR "Cannot find CUPTI in ${CUDA_TOOLKIT_ROOT_DIR}")
+  endif()
+  message(STATUS "Found RAF_CUPTI_INCLUDE = ${RAF_CUPTI_INCLUDE}")
+  message(STATUS "Found RAF_CUPTI_LIBRARY = ${RAF_CUPTI_LIBRARY}")
+endif()
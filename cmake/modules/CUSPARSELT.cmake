@@ -0,0 +1,36 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+##############################################################################
+# Provide:
+#  - RAF_CUSPARSELT_INCLUDE
+#  - RAF_CUSPARSELT_LIBRARY
+
+if (${RAF_USE_CUSPARSELT} STREQUAL "OFF")
+  message(STATUS "Build without cuSPARSELt support")
+  set(RAF_CUSPARSELT_INCLUDE "")
+  set(RAF_CUSPARSELT_LIBRARY "")
+else()
+  if (${RAF_USE_CUDA} STREQUAL "OFF")
+    message(FATAL_ERROR "Cannot enable cuSPARSELt without using CUDA.")
+  endif()
+
+  # cuSPARSELt is released separately from the CUDA toolkit.
+  if (${RAF_USE_CUSPARSELT} STREQUAL "ON")
+    set(__hint_dir "")
+  else()
+    set(__hint_dir ${RAF_USE_CUSPARSELT})
+  endif()
+
+  find_path(RAF_CUSPARSELT_INCLUDE cusparseLt.h
+    HINTS ${__hint_dir} ${CUDA_TOOLKIT_ROOT_DIR}
+    PATH_SUFFIXES include)
+  find_library(RAF_CUSPARSELT_LIBRARY cusparseLt
+    HINTS ${__hint_dir} ${CUDA_TOOLKIT_ROOT_DIR}
+    PATH_SUFFIXES lib64 lib lib/x64)
+  if (NOT RAF_CUSPARSELT_INCLUDE OR NOT RAF_CUSPARSELT_LIBRARY)
+    message(FATAL_ERROR "Please specify the path to cuSPARSELt by setting RAF_USE_CUSPARSELT")
+  endif()
+  message(STATUS "Found RAF_CUSPARSELT_INCLUDE = ${RAF_CUSPARSELT_INCLUDE}")
+  message(STATUS "Found RAF_CUSPARSELT_LIBRARY = ${RAF_CUSPARSELT_LIBRARY}")
+endif()
@@ -0,0 +1,24 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+##############################################################################
+# Provide:
+#  - RAF_NVTX_INCLUDE
+
+if (${RAF_USE_NVTX} STREQUAL "OFF")
+  message(STATUS "Build without NVTX support")
+  set(RAF_NVTX_INCLUDE "")
+else()
+  if (${RAF_USE_CUDA} STREQUAL "OFF")
+    message(FATAL_ERROR "Cannot enable NVTX without using CUDA.")
+  endif()
+  # NVTX v3 is header-only and ships with the CUDA toolkit. It loads the tool (e.g., Nsight
+  # Systems) with dlopen, so nothing is linked.
+  find_path(RAF_NVTX_INCLUDE nvtx3/nvToolsExt.h
+    HINTS ${CUDA_TOOLKIT_ROOT_DIR}
+    PATH_SUFFIXES include targets/x86_64-linux/include)
+  if (NOT RAF_NVTX_INCLUDE)
+    message(FATAL_ERROR "Cannot find nvtx3/nvToolsExt.h in ${CUDA_TOOLKIT_ROOT_DIR}")
+  endif()
+  message(STATUS "Found RAF_NVTX_INCLUDE = ${RAF_NVTX_INCLUDE}")
+endif()
@@ -0,0 +1,80 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file include/cutlass_ext/library/grouped_gemm_ext.h
+ * \brief Grouped gemm operations, which run a list of differently shaped gemms in one launch
+ */
+#pragma once
+
+#include <cuda_runtime.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cutlass/library/library.h"
+
+namespace cutlass {
+namespace library {
+
+/*! \brief The description of a grouped gemm operation. A and C are always row-major. */
+struct GroupedGemmDescriptionExt {
+  /*! \brief The kernel name */
+  std::string name;
+  /*! \brief The data type of A, B and C. The accumulation is in float32. */
+  NumericTypeID element;
+  /*! \brief The layout of B: row-major for [k, n], or column-major for B given as [n, k] */
+  LayoutTypeID layout_B;
+  /*! \brief The alignment (in units of elements) required for the pointers and leading dims */
+  int alignment;
+  /*! \brief The minimum compute capability */
+  int minimum_compute_capability;
+  /*! \brief The maximum compute capability */
+  int maximum_compute_capability;
+};
+
+/*!
+ * \brief The arguments of a grouped gemm, where problem i computes D_i = A_i * B_i. All arrays
+ * are in the device memory, except for problem_count.
+ */
+struct GroupedGemmArgumentsExt {
+  /*! \brief The number of problems */
+  int problem_count;
+  /*! \brief The {m, n, k} of each problem */
+  gemm::GemmCoord* problem_sizes;
+  /*! \brief The pointers to the operands of each problem */
+  void** ptr_A;
+  void** ptr_B;
+  void** ptr_C;
+  void** ptr_D;
+  /*! \brief The leading dims of the operands of each problem */
+  int64_t* lda;
+  int64_t* ldb;
+  int64_t* ldc;
+  int64_t* ldd;
+};
+
+/*! \brief A grouped gemm operation instantiated from cutlass::gemm::device::GemmGrouped */
+class GroupedGemmOperationExt {
+ public:
+  virtual ~GroupedGemmOperationExt() {
+  }
+
+  virtual GroupedGemmDescriptionExt const& description() const = 0;
+
+  /*! \brief Returns the size of the device workspace in bytes */
+  virtual size_t get_workspace_size(GroupedGemmArgumentsExt const& args) const = 0;
+
+  /*! \brief Runs the grouped gemm on the stream */
+  virtual Status run(GroupedGemmArgumentsExt const& args, void* workspace,
+                     cudaStream_t stream) const = 0;
+};
+
+/*! \brief Instantiates all grouped gemm operations */
+void initialize_grouped_gemm_operations_ext(
+    std::vector<std::unique_ptr<GroupedGemmOperationExt const>>* operations);
+
+}  // namespace library
+}  // namespace cutlass
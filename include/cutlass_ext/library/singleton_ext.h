@@ -12,6 +12,7 @@
 #include "cutlass/library/manifest.h"
 
 #include "./operation_table_ext.h"
+#include "./grouped_gemm_ext.h"
 
 namespace cutlass {
 namespace library {
@@ -23,6 +24,8 @@ class SingletonExt {
   Manifest manifest;
   /*! \brief Operation table referencing the manifest */
   OperationTableExt operation_table;
+  /*! \brief All available grouped gemm operations */
+  std::vector<std::unique_ptr<GroupedGemmOperationExt const>> grouped_gemm_operations;
 
  public:
   SingletonExt();
@@ -0,0 +1,131 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file alloc_trace.h
+ * \brief Capture of the allocations made by the VM and their offline replay against memory pools.
+ *
+ * While tracing, every buffer allocated by VirtualMachine::Alloc is recorded with its size,
+ * alignment, stream and time, and so is its release (e.g., by the Free instruction) once the last
+ * reference to it is dropped. The trace is saved in a compact binary format, and can be replayed
+ * against any registered memory pool to compare the pools on the allocation pattern of a real
+ * model (see tests/cpp/bench/alloc_bench.cc).
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "./device.h"
+#include "./memory_pool.h"
+
+namespace raf {
+namespace memory_pool {
+
+/*! \brief An allocation or a release of a traced buffer. */
+struct AllocEvent {
+  enum Kind : uint8_t { kAlloc = 0, kFree = 1 };
+  Kind kind = kAlloc;
+  /*! \brief The identity of the buffer, which matches its allocation and release. */
+  uint64_t id = 0;
+  /*! \brief The time since the trace is started in nanoseconds. */
+  int64_t timestamp_ns = 0;
+  /*! \brief The size and alignment in bytes of an allocation. */
+  int64_t nbytes = 0;
+  int64_t alignment = 0;
+  /*! \brief The VM stream of an asynchronous allocation, or -1 if it is synchronous. */
+  int64_t stream_id = -1;
+};
+
+/*! \brief The allocation events of a device in the order they happen. */
+struct AllocTrace {
+  Device device;
+  std::vector<AllocEvent> events;
+
+  /*!
+   * \brief Save the trace to a file. The events are delta and varint encoded, which takes a few
+   * bytes per event.
+   */
+  void Save(const std::string& path) const;
+
+  /*! \brief Load a trace saved by Save. */
+  static AllocTrace Load(const std::string& path);
+
+  /*! \brief The peak total size in bytes of the live buffers. */
+  int64_t PeakLiveBytes() const;
+};
+
+/*! \brief The results of replaying a trace against a memory pool. */
+struct AllocReplayStats {
+  /*! \brief The number of replayed events and the seconds taken per replay. */
+  int64_t num_events = 0;
+  double seconds = 0;
+  /*! \brief The peak total size of the live buffers requested by the trace, in MBs. */
+  double peak_requested_mb = 0;
+  /*! \brief The peak used and reserved memory of the pool in MBs. */
+  double peak_used_mb = 0;
+  double peak_reserved_mb = 0;
+  /*! \brief The fraction of the peak reserved memory that is not requested by the trace. */
+  double fragmentation = 0;
+};
+
+/*!
+ * \brief Replay a trace against a new memory pool of the trace device. The pool replaces the
+ * current pool of the device during the replay, and the current one is restored afterwards.
+ * \param trace The trace to be replayed.
+ * \param pool_name The name of the memory pool, e.g., "page_unit_pool".
+ * \param repeat The number of timed replays, whose average time is reported. The pool sizes are
+ * sampled after each allocation in another replay, which is not timed.
+ * \return The throughput and memory stats of the replay.
+ */
+AllocReplayStats ReplayAllocTrace(const AllocTrace& trace, const std::string& pool_name,
+                                  int repeat = 1);
+
+/*! \brief The recorder of the allocations made by the VM. */
+class AllocTracer {
+ public:
+  static AllocTracer* Get();
+
+  /*! \brief Start tracing the allocations on the device, discarding the previous trace. */
+  void Start(const Device& device);
+
+  /*! \brief Stop tracing and get the trace. */
+  AllocTrace Stop();
+
+  bool IsTracing() const {
+    return tracing_.load(std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Record an allocation, and wrap the buffer so that its release is recorded when the
+   * last reference to it is dropped. Buffers on other devices are returned as they are.
+   * \param mem The allocated buffer.
+   * \param nbytes The requested size in bytes.
+   * \param alignment The requested alignment in bytes.
+   * \param stream_id The VM stream of an asynchronous allocation, or -1 if it is synchronous.
+   * \return The buffer to be used in place of mem.
+   */
+  std::shared_ptr<Memory> Track(std::shared_ptr<Memory> mem, int64_t nbytes, int64_t alignment,
+                                int64_t stream_id);
+
+  /*! \brief Record the release of a buffer of the given trace generation. */
+  void RecordFree(uint64_t id, uint64_t generation);
+
+ private:
+  int64_t Now() const;
+
+  std::mutex mutex_;
+  std::atomic<bool> tracing_{false};
+  /*! \brief Incremented by each Start, so releases of buffers from earlier traces are ignored. */
+  uint64_t generation_ = 0;
+  uint64_t next_id_ = 0;
+  std::chrono::steady_clock::time_point start_;
+  AllocTrace trace_;
+};
+
+}  // namespace memory_pool
+}  // namespace raf
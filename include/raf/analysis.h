@@ -10,6 +10,10 @@
 #pragma once
 #include <relay/analysis/dependency_graph.h>
 #include "support/arena.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "raf/ir.h"
 
@@ -39,5 +43,126 @@ using tvm::support::Arena;
 DependencyGraph CreateDependencyGraph(Arena* arena, const Expr& e, bool prune_atomic_nodes = false,
                                       bool prune_redundant_edges = false);
 
+/*!
+ * \brief A dependency graph in the compressed sparse row (CSR) format. The nodes are numbered in
+ * the post DFS order of the DependencyGraph, so a node is numbered after all nodes it depends on.
+ * The children (the nodes a node depends on) and the parents (the nodes depending on a node) of
+ * all nodes are stored in two contiguous index arrays, which avoids the per-edge allocations and
+ * the linked lists of DependencyGraph, gets the degree of a node in O(1), and lets the passes key
+ * their per-node states by vectors instead of hash maps.
+ *
+ * Unlike DependencyGraph, nodes cannot be added. Edges and nodes are removed in batches, each of
+ * which rebuilds the index arrays in O(N + E).
+ */
+class CompactDependencyGraph {
+ public:
+  /*! \brief A read-only range of node indices. */
+  class NodeRange {
+   public:
+    NodeRange(const int* begin, const int* end) : begin_(begin), end_(end) {
+    }
+    const int* begin() const {
+      return begin_;
+    }
+    const int* end() const {
+      return end_;
+    }
+    size_t size() const {
+      return end_ - begin_;
+    }
+    bool empty() const {
+      return begin_ == end_;
+    }
+    int operator[](size_t i) const {
+      return begin_[i];
+    }
+
+   private:
+    const int* begin_;
+    const int* end_;
+  };
+
+  /*!
+   * \brief Create the compact dependency graph of given expr. See CreateDependencyGraph for the
+   * pruning of the atomic nodes and the redundant edges.
+   * \param e The expression we want to create dataflow graph for.
+   * \param prune_atomic_nodes Whether to prune the atomic nodes.
+   * \param prune_redundant_edges Whether to prune the redundant edges.
+   * \return The compact dependency graph.
+   */
+  static CompactDependencyGraph Create(const Expr& e, bool prune_atomic_nodes = false,
+                                       bool prune_redundant_edges = false);
+
+  /*! \brief The number of nodes. */
+  int size() const {
+    return static_cast<int>(exprs_.size());
+  }
+
+  /*! \brief The expr of a node, which is undefined for the nodes of new scopes. */
+  const Expr& GetExpr(int node) const {
+    return exprs_[node];
+  }
+
+  /*! \brief The node of an expr, or -1 if the expr is not in the graph. */
+  int GetNode(const Expr& expr) const {
+    auto it = expr_node_.find(expr.get());
+    return it == expr_node_.end() ? -1 : it->second;
+  }
+
+  /*! \brief The nodes that the node depends on. */
+  NodeRange Children(int node) const {
+    return NodeRange(children_.data() + child_offsets_[node],
+                     children_.data() + child_offsets_[node + 1]);
+  }
+
+  /*! \brief The nodes that depend on the node. */
+  NodeRange Parents(int node) const {
+    return NodeRange(parents_.data() + parent_offsets_[node],
+                     parents_.data() + parent_offsets_[node + 1]);
+  }
+
+  /*!
+   * \brief Remove the given edges. The duplicated edges between the same nodes are also removed.
+   * \param edges The (parent, child) pairs of the edges to remove.
+   */
+  void RemoveEdges(const std::vector<std::pair<int, int>>& edges);
+
+  /*!
+   * \brief Remove the given nodes and their edges. The remaining nodes are renumbered in order.
+   * \param removed Whether each node is removed.
+   */
+  void RemoveNodes(const std::vector<bool>& removed);
+
+  /*! \brief Prune the atomic nodes. See CreateDependencyGraph for details. */
+  void PruneAtomicNodes();
+
+  /*! \brief Prune the redundant edges. See CreateDependencyGraph for details. */
+  void PruneRedundantEdges();
+
+ private:
+  /*!
+   * \brief Rebuild the graph with the kept nodes and edges.
+   * \param new_index The new index of each node, or -1 if the node is removed.
+   * \param removed_edges The (parent, child) pairs of the removed edges, encoded by EdgeKey.
+   */
+  void Rebuild(const std::vector<int>& new_index,
+               const std::unordered_set<int64_t>& removed_edges);
+
+  int64_t EdgeKey(int parent, int child) const {
+    return static_cast<int64_t>(parent) * size() + child;
+  }
+
+  /*! \brief The expr of each node. */
+  std::vector<Expr> exprs_;
+  /*! \brief The map from expr to its node. The exprs are kept alive by exprs_. */
+  std::unordered_map<const Object*, int> expr_node_;
+  /*! \brief The children of node i are children_[child_offsets_[i]:child_offsets_[i + 1]]. */
+  std::vector<int> child_offsets_;
+  std::vector<int> children_;
+  /*! \brief The parents of node i are parents_[parent_offsets_[i]:parent_offsets_[i + 1]]. */
+  std::vector<int> parent_offsets_;
+  std::vector<int> parents_;
+};
+
 }  // namespace analysis
 }  // namespace raf
@@ -9,11 +9,21 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 #include <dmlc/memory_io.h>
 #include <sys/stat.h>
 #include "./file.h"
 #include "./op.h"
+#include "./tuning_db.h"
 #include "./value.h"
 
 namespace raf {
@@ -98,7 +108,7 @@ class HashKey {
     RAF_APPEND_BYTES(DLDataType, 4, v->dtype);
     for (int i = 0, n = v->shape.size(); i < n; ++i) {
       int64_t dim_i;
-      if (v->shape.as<ir::AnyNode>()) {
+      if (v->shape[i].as<ir::AnyNode>()) {
         dim_i = -1;
       } else {
         dim_i = ir::Downcast<ir::Integer>(v->shape[i]).IntValue();
@@ -149,66 +159,320 @@ class HashKey {
 #undef RAF_DEF_PRIMITIVE
 #undef RAF_APPEND_BYTES
 
+/*! \brief A non-owning view of the bytes of a cache key. */
+struct CacheKeyView {
+  CacheKeyView(const char* data, size_t size) : data(data), size(size) {
+  }
+  explicit CacheKeyView(const std::string& key) : CacheKeyView(key.data(), key.size()) {
+  }
+  explicit CacheKeyView(const std::vector<uint8_t>& key)
+      : CacheKeyView(reinterpret_cast<const char*>(key.data()), key.size()) {
+  }
+
+  const char* data;
+  size_t size;
+};
+
+/*! \brief The 64-bit FNV-1a hash of the key bytes. */
+struct CacheKeyViewHash {
+  size_t operator()(const CacheKeyView& key) const {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < key.size; ++i) {
+      hash = (hash ^ static_cast<uint8_t>(key.data[i])) * 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash);
+  }
+};
+
+struct CacheKeyViewEqual {
+  bool operator()(const CacheKeyView& lhs, const CacheKeyView& rhs) const {
+    return lhs.size == rhs.size && std::memcmp(lhs.data, rhs.data, lhs.size) == 0;
+  }
+};
+
+/*!
+ * \brief A thread-safe in-memory cache. The keys are split into shards by their hash, and each
+ * shard is guarded by a reader-writer lock, so lookups run concurrently and only insertions to
+ * the same shard serialize. Keys are looked up by their bytes without making a copy. The cache
+ * is unbounded by default. With a capacity, each shard keeps at most its share of the entries and
+ * evicts the ones not looked up recently (CLOCK, an approximation of LRU). Get returns a shared
+ * pointer, so an entry evicted while in use stays alive until it is released.
+ */
 template <typename T>
 class MetaCache {
  public:
+  /*!
+   * \brief Create a cache.
+   * \param num_shards The number of shards.
+   * \param capacity The maximum number of entries, or 0 for unbounded.
+   */
+  explicit MetaCache(size_t num_shards = 1, size_t capacity = 0)
+      : shards_(std::max<size_t>(num_shards, 1)) {
+    SetCapacity(capacity);
+  }
+
   ~MetaCache() = default;
 
   bool Has(const std::vector<uint8_t>& key) {
-    const std::string key_str(key.begin(), key.end());
-    return Has(key_str);
+    return Has(CacheKeyView(key));
   }
 
   bool Has(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mu_);
-    return cached_.count(key);
+    return Has(CacheKeyView(key));
   }
 
-  const T* Get(const std::vector<uint8_t>& key) {
-    const std::string key_str(key.begin(), key.end());
-    return Get(key_str);
+  std::shared_ptr<const T> Get(const std::vector<uint8_t>& key) {
+    return Get(CacheKeyView(key));
   }
 
-  const T* Get(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mu_);
-    auto iter = cached_.find(key);
-    if (iter == cached_.end()) {
-      return nullptr;
-    }
-    return &iter->second;
+  std::shared_ptr<const T> Get(const std::string& key) {
+    return Get(CacheKeyView(key));
   }
 
   void Set(const std::vector<uint8_t>& key, T val) {
-    const std::string key_str(key.begin(), key.end());
-    Set(key_str, val);
+    Set(CacheKeyView(key), std::move(val));
   }
 
   void Set(const std::string& key, T val) {
-    std::lock_guard<std::mutex> lock(mu_);
-    auto iter = cached_.find(key);
-    if (iter != cached_.end()) {
+    Set(CacheKeyView(key), std::move(val));
+  }
+
+  /*!
+   * \brief Bound the number of entries, evicting the entries over the new bound.
+   * \param capacity The maximum number of entries, or 0 for unbounded. It is split evenly among
+   * the shards, so the cache may evict before it is full if the keys are unevenly spread.
+   */
+  void SetCapacity(size_t capacity) {
+    size_t shard_capacity = (capacity + shards_.size() - 1) / shards_.size();
+    shard_capacity_.store(shard_capacity);
+    if (shard_capacity == 0) {
+      return;
+    }
+    for (auto& shard : shards_) {
+      std::unique_lock<std::shared_timed_mutex> lock(shard.mu);
+      Evict(&shard, shard_capacity);
+    }
+  }
+
+  /*! \brief Remove all entries. The entries already looked up stay valid for their holders. */
+  void Clear() {
+    for (auto& shard : shards_) {
+      std::unique_lock<std::shared_timed_mutex> lock(shard.mu);
+      shard.index.clear();
+      shard.clock.clear();
+      shard.hand = 0;
+    }
+  }
+
+  /*! \brief The number of cached entries. */
+  size_t Size() {
+    size_t size = 0;
+    for (auto& shard : shards_) {
+      std::shared_lock<std::shared_timed_mutex> lock(shard.mu);
+      size += shard.clock.size();
+    }
+    return size;
+  }
+
+  /*! \brief The number of entries evicted so far. */
+  size_t NumEvictions() const {
+    return num_evictions_.load(std::memory_order_relaxed);
+  }
+
+  /*! \brief Get a snapshot of all cached entries. */
+  std::vector<std::pair<std::string, T>> GetEntries() {
+    std::vector<std::pair<std::string, T>> ret;
+    for (auto& shard : shards_) {
+      std::shared_lock<std::shared_timed_mutex> lock(shard.mu);
+      for (const auto& entry : shard.clock) {
+        ret.emplace_back(entry->key, entry->value);
+      }
+    }
+    return ret;
+  }
+
+ private:
+  struct Entry {
+    Entry(std::string key, T value) : key(std::move(key)), value(std::move(value)) {
+    }
+
+    /*! \brief The key, which the view in the shard index points to. */
+    const std::string key;
+    const T value;
+    /*! \brief Whether the entry is looked up since the clock hand last passed it. */
+    std::atomic<bool> referenced{false};
+  };
+
+  struct Shard {
+    std::shared_timed_mutex mu;
+    std::unordered_map<CacheKeyView, std::shared_ptr<Entry>, CacheKeyViewHash, CacheKeyViewEqual>
+        index;
+    /*! \brief The entries in the order swept by the clock hand. */
+    std::vector<std::shared_ptr<Entry>> clock;
+    size_t hand = 0;
+  };
+
+  Shard& GetShard(const CacheKeyView& key) {
+    return shards_[CacheKeyViewHash()(key) % shards_.size()];
+  }
+
+  bool Has(const CacheKeyView& key) {
+    auto& shard = GetShard(key);
+    std::shared_lock<std::shared_timed_mutex> lock(shard.mu);
+    return shard.index.count(key);
+  }
+
+  std::shared_ptr<const T> Get(const CacheKeyView& key) {
+    auto& shard = GetShard(key);
+    std::shared_lock<std::shared_timed_mutex> lock(shard.mu);
+    auto iter = shard.index.find(key);
+    if (iter == shard.index.end()) {
+      return nullptr;
+    }
+    const auto& entry = iter->second;
+    // Only write the flag when it changes, so hot entries do not bounce between cores.
+    if (shard_capacity_.load(std::memory_order_relaxed) != 0 &&
+        !entry->referenced.load(std::memory_order_relaxed)) {
+      entry->referenced.store(true, std::memory_order_relaxed);
+    }
+    return std::shared_ptr<const T>(entry, &entry->value);
+  }
+
+  void Set(const CacheKeyView& key, T val) {
+    auto& shard = GetShard(key);
+    std::unique_lock<std::shared_timed_mutex> lock(shard.mu);
+    if (shard.index.count(key)) {
       LOG(FATAL) << "KeyError: The key is already cached!";
       throw;
     }
-    cached_.emplace(key, val);
+    size_t shard_capacity = shard_capacity_.load();
+    if (shard_capacity != 0) {
+      Evict(&shard, shard_capacity - 1);
+    }
+    auto entry = std::make_shared<Entry>(std::string(key.data, key.size), std::move(val));
+    shard.index.emplace(CacheKeyView(entry->key), entry);
+    shard.clock.push_back(std::move(entry));
   }
 
- private:
-  /*! \brief The cache mapping from string key to value. */
-  std::unordered_map<std::string, T> cached_;
-  /*! \brief The thread-safe lock. */
-  std::mutex mu_;
+  /*! \brief Evict entries from the shard until at most size remain. The shard must be locked. */
+  void Evict(Shard* shard, size_t size) {
+    auto& clock = shard->clock;
+    while (clock.size() > size) {
+      if (shard->hand >= clock.size()) {
+        shard->hand = 0;
+      }
+      auto& entry = clock[shard->hand];
+      if (entry->referenced.exchange(false, std::memory_order_relaxed)) {
+        // Give the recently used entry a second chance.
+        ++shard->hand;
+        continue;
+      }
+      shard->index.erase(CacheKeyView(entry->key));
+      entry = std::move(clock.back());
+      clock.pop_back();
+      num_evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /*! \brief The shards of the cache. */
+  std::vector<Shard> shards_;
+  /*! \brief The maximum number of entries per shard, or 0 for unbounded. */
+  std::atomic<size_t> shard_capacity_{0};
+  /*! \brief The number of evicted entries. */
+  std::atomic<size_t> num_evictions_{0};
 };
 
+/*! \brief The default number of shards of the named caches shared by all threads. */
+constexpr size_t kDefaultCacheShards = 16;
+
+/*!
+ * \brief The interface of a named cache, which can be inspected and bounded by name. The metrics
+ * are atomic counters, so they are updated without a lock on each lookup.
+ */
 class MetaCacheMetric {
  public:
-  virtual std::unordered_map<std::string, size_t> GetMetric() = 0;
+  virtual ~MetaCacheMetric() = default;
+
+  /*! \brief Get the non-zero metrics. */
+  virtual std::unordered_map<std::string, size_t> GetMetric() {
+    static const char* names[kNumMetrics] = {"CacheGet",
+                                             "CacheHit",
+                                             "CacheMiss",
+                                             "CacheSet",
+                                             "CacheEviction",
+                                             "PersistCacheMiss",
+                                             "PersistCacheHit",
+                                             "PersistCacheLoadFailure",
+                                             "PersistCacheSaveFailure",
+                                             "TuningDBMiss",
+                                             "TuningDBHit",
+                                             "TuningDBLoadFailure"};
+    std::unordered_map<std::string, size_t> ret;
+    for (int i = 0; i < kNumMetrics; ++i) {
+      size_t val = i == kCacheEviction ? NumEvictions() : metrics_[i].load();
+      if (val != 0) {
+        ret[names[i]] = val;
+      }
+    }
+    return ret;
+  }
+
+  /*! \brief Bound the number of in-memory entries, or 0 for unbounded. */
+  virtual void SetCapacity(size_t capacity) = 0;
+
+  /*! \brief The number of in-memory entries. */
+  virtual size_t Size() = 0;
+
+  /*! \brief The number of evicted in-memory entries. */
+  virtual size_t NumEvictions() const = 0;
+
+ protected:
+  enum Metric {
+    kCacheGet,
+    kCacheHit,
+    kCacheMiss,
+    kCacheSet,
+    kCacheEviction,
+    kPersistCacheMiss,
+    kPersistCacheHit,
+    kPersistCacheLoadFailure,
+    kPersistCacheSaveFailure,
+    kTuningDBMiss,
+    kTuningDBHit,
+    kTuningDBLoadFailure,
+    kNumMetrics
+  };
+
+  inline void AddMetric(Metric metric, size_t val = 1) {
+    metrics_[metric].fetch_add(val, std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Register the cache by name, and bound it by RAF_CACHE_CAPACITY if the environment
+   * variable is set.
+   */
+  void Register(const std::string& name);
+
+  /*! \brief Unregister the cache. Called by the destructor of the derived class. */
+  void Unregister();
+
+ private:
+  /*! \brief The cache metrics for analysis. */
+  std::array<std::atomic<size_t>, kNumMetrics> metrics_{};
+  /*! \brief The registered name. */
+  std::string registered_name_;
 };
 
+/*! \brief Get the registered cache with the name, or nullptr if there is none. */
+MetaCacheMetric* GetNamedCache(const std::string& name);
+
 template <typename T>
 class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
  public:
-  MetaPersistCache(const std::string persist_name) : persist_name_(persist_name) {
+  MetaPersistCache(const std::string persist_name, size_t num_shards = kDefaultCacheShards)
+      : MetaCache<T>(num_shards), persist_name_(persist_name) {
+    Register(persist_name_);
+
     // Enable persistent by users.
     const char* enable_persist = getenv("RAF_PERSIST_CACHE");
     if (enable_persist != nullptr && strcmp(enable_persist, "1") == 0) {
@@ -235,45 +499,27 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
     CreateDir(path_);
   }
 
-  const T* Get(const std::vector<uint8_t>& key) {
-    const std::string key_str(key.begin(), key.end());
-    return Get(key_str);
+  ~MetaPersistCache() {
+    Unregister();
   }
 
-  const T* Get(const std::string& key) {
-    AddMetric("CacheGet", 1);
-
-    // Cache hit.
+  std::shared_ptr<const T> Get(const std::vector<uint8_t>& key) {
+    AddMetric(kCacheGet);
+    // Look up the bytes directly, and only make the string key on a miss.
     if (auto val = MetaCache<T>::Get(key)) {
-      AddMetric("CacheHit", 1);
+      AddMetric(kCacheHit);
       return val;
     }
-    AddMetric("CacheMiss", 1);
-    if (!persist_) {
-      return nullptr;
-    }
-
-    // Cache miss, try to load from the persistent cache.
-    std::lock_guard<std::mutex> lock(mu_);
-
-    auto persist_path = GetPersistPath(key);
-
-    // Persistent cache miss.
-    if (!DirExists(persist_path)) {
-      AddMetric("PersistCacheMiss", 1);
-      return nullptr;
-    }
-    AddMetric("PersistCacheHit", 1);
+    return Load(std::string(key.begin(), key.end()));
+  }
 
-    try {
-      MetaCache<T>::Set(key, T::Load(persist_path));
-      return MetaCache<T>::Get(key);
-    } catch (dmlc::Error& e) {
-      AddMetric("PersistCacheLoadFailure", 1);
-      LOG(WARNING) << "Failed to load persist entry " << path_ << ": " << e.what();
-      return nullptr;
+  std::shared_ptr<const T> Get(const std::string& key) {
+    AddMetric(kCacheGet);
+    if (auto val = MetaCache<T>::Get(key)) {
+      AddMetric(kCacheHit);
+      return val;
     }
-    return nullptr;
+    return Load(key);
   }
 
   void Set(const std::vector<uint8_t>& key, T val) {
@@ -282,7 +528,7 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
   }
 
   void Set(const std::string& key, T val) {
-    AddMetric("CacheSet", 1);
+    AddMetric(kCacheSet);
     MetaCache<T>::Set(key, val);
     if (!persist_) {
       return;
@@ -299,7 +545,7 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
         throw;
       }
     } catch (dmlc::Error& e) {
-      AddMetric("PersistCacheSaveFailure", 1);
+      AddMetric(kPersistCacheSaveFailure);
       LOG(WARNING) << "Failed to persist cache entry to " << path_ << ": " << e.what();
       return;
     }
@@ -310,29 +556,166 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
     metadata_file.close();
   }
 
-  std::unordered_map<std::string, size_t> GetMetric() override {
-    return metrics_;
+  void SetCapacity(size_t capacity) override {
+    MetaCache<T>::SetCapacity(capacity);
+  }
+
+  size_t Size() override {
+    return MetaCache<T>::Size();
+  }
+
+  size_t NumEvictions() const override {
+    return MetaCache<T>::NumEvictions();
   }
 
  private:
+  /*! \brief Handle an in-memory cache miss by loading the entry from the persistent cache. */
+  std::shared_ptr<const T> Load(const std::string& key) {
+    AddMetric(kCacheMiss);
+    if (!persist_) {
+      return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mu_);
+    if (auto val = MetaCache<T>::Get(key)) {
+      // Loaded by another thread.
+      return val;
+    }
+
+    auto persist_path = GetPersistPath(key);
+
+    // Persistent cache miss.
+    if (!DirExists(persist_path)) {
+      AddMetric(kPersistCacheMiss);
+      return nullptr;
+    }
+    AddMetric(kPersistCacheHit);
+
+    try {
+      MetaCache<T>::Set(key, T::Load(persist_path));
+      return MetaCache<T>::Get(key);
+    } catch (dmlc::Error& e) {
+      AddMetric(kPersistCacheLoadFailure);
+      LOG(WARNING) << "Failed to load persist entry " << path_ << ": " << e.what();
+      return nullptr;
+    }
+  }
+
   inline std::string GetPersistPath(const std::string& key) {
     const size_t hashed_key = std::hash<std::string>{}(key);
     return path_ + "/" + std::to_string(hashed_key);
   }
 
-  inline void AddMetric(const std::string name, size_t val) {
-    metrics_[name] += val;
-  }
-
-  /*! \brief The cache metrics for analysis. */
-  std::unordered_map<std::string, size_t> metrics_;
   /*! \brief Persist directory name. */
   std::string persist_name_;
   /*! \brief Persist directory path. */
   std::string path_;
   /*! \brief Whether to presist values. */
   bool persist_ = false;
-  /*! \brief The thread-safe lock. */
+  /*! \brief The lock of the persistent cache directory. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief A cache of tuning results backed by the shared TuningDatabase. Unlike MetaPersistCache,
+ * which writes one directory per key, the entries of all tuning caches are records in a single
+ * indexed log. The database key is prefixed with the cache name and a fingerprint of the
+ * environment (e.g., GPU arch, driver and library versions) the tuning result depends on, so a
+ * database can be shared by nodes with different GPUs. T has to implement
+ * `std::string Serialize() const` and `static T Deserialize(const std::string&)`.
+ */
+template <typename T>
+class MetaTuningCache : public MetaCache<T>, public MetaCacheMetric {
+ public:
+  /*!
+   * \brief Create a tuning cache.
+   * \param name The cache name.
+   * \param fingerprint The function evaluated on each access to fingerprint the environment.
+   * \param num_shards The number of shards of the in-memory cache.
+   */
+  MetaTuningCache(const std::string name, std::function<std::string()> fingerprint,
+                  size_t num_shards = kDefaultCacheShards)
+      : MetaCache<T>(num_shards), name_(name), fingerprint_(fingerprint) {
+    Register(name_);
+  }
+
+  ~MetaTuningCache() {
+    Unregister();
+  }
+
+  std::shared_ptr<const T> Get(const std::vector<uint8_t>& key) {
+    const std::string key_str(key.begin(), key.end());
+    return Get(key_str);
+  }
+
+  std::shared_ptr<const T> Get(const std::string& key) {
+    AddMetric(kCacheGet);
+    const std::string db_key = GetDBKey(key);
+
+    // Cache hit.
+    if (auto val = MetaCache<T>::Get(db_key)) {
+      AddMetric(kCacheHit);
+      return val;
+    }
+    AddMetric(kCacheMiss);
+
+    // Cache miss, try to load from the tuning database.
+    std::lock_guard<std::mutex> lock(mu_);
+    if (auto val = MetaCache<T>::Get(db_key)) {
+      // Loaded by another thread.
+      return val;
+    }
+    std::string record;
+    if (!TuningDatabase::Global()->Get(db_key, &record)) {
+      AddMetric(kTuningDBMiss);
+      return nullptr;
+    }
+    AddMetric(kTuningDBHit);
+
+    try {
+      MetaCache<T>::Set(db_key, T::Deserialize(record));
+      return MetaCache<T>::Get(db_key);
+    } catch (dmlc::Error& e) {
+      AddMetric(kTuningDBLoadFailure);
+      LOG(WARNING) << "Failed to load tuning record of " << name_ << ": " << e.what();
+      return nullptr;
+    }
+  }
+
+  void Set(const std::vector<uint8_t>& key, T val) {
+    const std::string key_str(key.begin(), key.end());
+    Set(key_str, val);
+  }
+
+  void Set(const std::string& key, T val) {
+    AddMetric(kCacheSet);
+    const std::string db_key = GetDBKey(key);
+    MetaCache<T>::Set(db_key, val);
+    TuningDatabase::Global()->Put(db_key, val.Serialize());
+  }
+
+  void SetCapacity(size_t capacity) override {
+    MetaCache<T>::SetCapacity(capacity);
+  }
+
+  size_t Size() override {
+    return MetaCache<T>::Size();
+  }
+
+  size_t NumEvictions() const override {
+    return MetaCache<T>::NumEvictions();
+  }
+
+ private:
+  inline std::string GetDBKey(const std::string& key) {
+    return name_ + "/" + fingerprint_() + "/" + key;
+  }
+
+  /*! \brief The cache name. */
+  std::string name_;
+  /*! \brief The function to fingerprint the environment. */
+  std::function<std::string()> fingerprint_;
+  /*! \brief The lock of loading from the tuning database. */
   std::mutex mu_;
 };
 
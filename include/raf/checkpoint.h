@@ -0,0 +1,60 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file checkpoint.h
+ * \brief Sharded checkpoints of the parameters and the optimizer states.
+ *
+ * A checkpoint is a directory with a pair of files per rank: "rank<k>.data" holds the raw bytes
+ * of the tensors of the rank, each starting at an offset aligned to kCheckpointAlignment so that
+ * the file can be mapped and read with direct I/O, and "rank<k>.index" holds the name, dtype,
+ * shape, offset and size of each tensor. The ranks save and load their own shards independently.
+ */
+#pragma once
+#include <string>
+#include <tvm/runtime/module.h>
+#include "./device.h"
+#include "./ir.h"
+#include "./value.h"
+
+namespace raf {
+namespace checkpoint {
+
+/*! \brief The alignment in bytes of the tensors in the data files. */
+constexpr int64_t kCheckpointAlignment = 4096;
+
+/*!
+ * \brief Save the tensors of a rank to a checkpoint asynchronously. The tensors are snapshotted
+ * to pinned host buffers on a copy stream before returning, and the following computation on the
+ * current streams of their devices is ordered after the snapshot, so the tensors can be updated
+ * right away. The files are written by background threads.
+ * \param path The directory of the checkpoint.
+ * \param rank The rank whose shard is saved.
+ * \param tensors The tensors to save, keyed by their names.
+ * \param num_threads The number of threads to write the data file.
+ * \param device_copy Whether to snapshot the tensors to device copies first, so that the
+ * following computation only waits for the copies on the device instead of the transfers to the
+ * host. The device copies are released by "wait".
+ * \return The module with "wait" that waits for the files to be written and "done" that checks
+ * it without blocking.
+ */
+tvm::runtime::Module SaveCheckpoint(const std::string& path, int rank,
+                                    const ir::Map<ir::String, value::Value>& tensors,
+                                    int num_threads = 1, bool device_copy = false);
+
+/*!
+ * \brief Load the tensors of a rank from a checkpoint. The data file is mapped instead of being
+ * read into the memory: the CPU tensors refer to the mapping, and the tensors of other devices
+ * are streamed from the mapping to the device through pinned staging buffers.
+ * \param path The directory of the checkpoint.
+ * \param rank The rank whose shard is loaded.
+ * \param device The device of the loaded tensors.
+ * \return The loaded tensors keyed by their names.
+ */
+ir::Map<ir::String, value::Value> LoadCheckpoint(const std::string& path, int rank,
+                                                 const Device& device);
+
+}  // namespace checkpoint
+}  // namespace raf
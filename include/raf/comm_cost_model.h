@@ -0,0 +1,95 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file comm_cost_model.h
+ * \brief The calibrated latency model of the collective communication ops.
+ */
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "./ir.h"
+#include "./value.h"
+
+namespace raf {
+namespace distributed {
+
+/*!
+ * \brief The latency of a collective in microseconds is modeled as alpha_us + beta_us_per_byte *
+ * bytes, where bytes is the larger of its input and output sizes.
+ */
+struct CommCost {
+  /*! \brief The fixed latency in microseconds. */
+  double alpha_us;
+  /*! \brief The inverse bandwidth in microseconds per byte. */
+  double beta_us_per_byte;
+};
+
+/*!
+ * \brief The alpha-beta latency model of the collective ops, fitted per op and per communicator
+ * scope by raf.distributed.calibrate_comm_cost, which runs the ops over a sweep of message sizes.
+ * The scopes are "intra" (each group is within a node), "inter" (each group has at most one rank
+ * per node), and "global" (the global communicator, which runs the hierarchical allreduce if it is
+ * enabled). The model is persisted in the "comm_cost_model" cache keyed by the topology, so the
+ * scheduling passes can estimate the communication time at compile time without profiling.
+ */
+class CommCostModel {
+ public:
+  /*! \brief Get the model of the current topology. */
+  static CommCostModel* Get();
+
+  /*! \brief Set the cost of an op (e.g., "raf.op._allreduce") in a scope. */
+  void Set(const std::string& op_name, const std::string& scope, const CommCost& cost);
+
+  /*!
+   * \brief Look up the cost of an op in a scope. The persisted model of the topology is loaded on
+   * the first lookup if nothing is set.
+   * \return Whether the op is calibrated in the scope.
+   */
+  bool Find(const std::string& op_name, const std::string& scope, CommCost* cost);
+
+  /*!
+   * \brief Estimate the latency of an op in a scope.
+   * \return The latency in microseconds, or -1 if the op is not calibrated in the scope.
+   */
+  double Estimate(const std::string& op_name, const std::string& scope, double bytes);
+
+  /*!
+   * \brief Estimate the latency of a collective call, whose scope is derived from its rank_list.
+   * \return The latency in microseconds, or -1 if it is not a calibrated collective.
+   */
+  double Estimate(const ir::Call& call);
+
+  /*! \brief The scope of a rank_list value, or "global" if it is undefined or empty. */
+  static std::string GetScope(const value::Value& rank_list);
+
+  /*! \brief Persist the model of the current topology. Returns false if nothing is set. */
+  bool Save();
+
+  /*! \brief Load the persisted model of the current topology. Returns false if there is none. */
+  bool Load();
+
+  /*! \brief Remove all costs. The persisted model is not loaded again afterwards. */
+  void Clear();
+
+  /*! \brief All costs keyed by "<op_name>@<scope>". */
+  std::unordered_map<std::string, CommCost> GetAll();
+
+ private:
+  /*! \brief The key of the current topology in the persist cache. */
+  static std::string TopologyKey();
+
+  /*! \brief The costs keyed by "<op_name>@<scope>". */
+  std::unordered_map<std::string, CommCost> costs_;
+  /*! \brief Whether the persisted model has been looked up or the model is cleared. */
+  std::atomic<bool> loaded_{false};
+  /*! \brief Guard the costs. */
+  std::mutex mu_;
+};
+
+}  // namespace distributed
+}  // namespace raf
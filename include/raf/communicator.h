@@ -10,9 +10,13 @@
 #pragma once
 #include <unistd.h>
 #include <stdint.h>
-#include <string>
-#include <set>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
 #include "dmlc/logging.h"
 #include "raf/registry.h"
 #include "raf/value.h"
@@ -49,6 +53,13 @@ using namespace raf::value;
   } while (0)
 #endif
 
+/*! \brief The kinds of the collectives launched as one NCCL group by raf.op._group_comm. */
+enum GroupCommKind : int64_t {
+  kGroupAllReduce = 0,
+  kGroupAllGather = 1,
+  kGroupReduceScatter = 2,
+};
+
 class CommunicatorObj : public Object {
  public:
   int local_size;
@@ -82,7 +93,17 @@ class CommunicatorObj : public Object {
 
 class Communicator : public ObjectRef {
  public:
-  static Communicator Get(const std::string& name, const Value rank_list = NullValue<Value>());
+  /*!
+   * \brief Get a communicator from the pool.
+   * \param name The name of the communicator, e.g., "nccl".
+   * \param rank_list The groups of the sub-communicator, or null for the global communicator.
+   * \param lane The instance of the communicator. The collectives launched concurrently on
+   * different communication streams use different instances, since the collectives of one
+   * instance have to be run one after another.
+   * \return The communicator.
+   */
+  static Communicator Get(const std::string& name, const Value rank_list = NullValue<Value>(),
+                          int lane = 0);
   static void InitSubCommunicator(CommunicatorObj* sub_comm, const Value rank_list,
                                   const Communicator global_comm);
   static uint64_t GetHostID();
@@ -112,7 +133,9 @@ class CommunicatorPool {
     return &instance;
   }
 
-  Communicator GetCommunicator(const std::string& name, const Value rank_list) {
+  Communicator GetCommunicator(const std::string& name, const Value rank_list, int lane = 0) {
+    WaitWarmUp();
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     std::vector<std::vector<int64_t>> rank_list_;
     std::set<int64_t> rank_set_;
     if (rank_list.defined()) {
@@ -128,7 +151,8 @@ class CommunicatorPool {
       }
     }
 
-    CommunicatorID id(name, rank_list_);
+    // The lanes other than the first one are distinct instances of the same group.
+    CommunicatorID id(lane == 0 ? name : name + "#" + std::to_string(lane), rank_list_);
 
     if (comm_.count(id) == 0) {
       const std::string prefix = "raf.distributed.communicator._make.";
@@ -139,12 +163,35 @@ class CommunicatorPool {
     return comm_[id];
   }
 
+  /*!
+   * \brief Create the communicators of the given rank lists ahead of time, instead of lazily by
+   * the first execution of the ops using them. The global communicator is created first by the
+   * calling thread. When async is true, the other communicators are created by a background
+   * thread to overlap with the rest of the initialization (e.g., uploading the weights), and
+   * the following GetCommunicator calls wait for them.
+   * \param name The name of the communicator.
+   * \param rank_lists The rank lists of the sub-communicators.
+   * \param async Whether to create the sub-communicators in the background.
+   */
+  void WarmUp(const std::string& name, const ir::Array<Value>& rank_lists, bool async);
+
+  /*! \brief Wait for the communicators being created in the background, if any. */
+  void WaitWarmUp();
+
   void Remove() {
+    WaitWarmUp();
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     comm_.clear();
   }
 
  private:
   std::map<CommunicatorID, Communicator> comm_;
+  /*! \brief Guard comm_. It is recursive because making a communicator may get its parent. */
+  std::recursive_mutex mutex_;
+  /*! \brief Guard warm_up_. */
+  std::mutex warm_up_mutex_;
+  /*! \brief The pending creation of the communicators in the background. */
+  std::future<void> warm_up_;
 };
 
 Communicator GetGlobalCommunicator();
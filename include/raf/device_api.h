@@ -81,9 +81,11 @@ class DeviceAPI {
   /*!
    * \brief Create a stream on given device.
    * \param dev The device to create the stream.
+   * \param priority The priority of the stream. 0 is the default priority, and larger numbers are
+   * higher priorities, which are clamped to the range supported by the device.
    * \return The created stream.
    */
-  virtual void* CreateStream(const Device& dev) = 0;
+  virtual void* CreateStream(const Device& dev, int priority = 0) = 0;
 
   /*!
    * \brief Free a stream.
@@ -168,6 +170,14 @@ class DeviceAPI {
    */
   virtual void WaitEvent(void* event) = 0;
 
+  /*!
+   * \brief Query whether the workloads captured by the given event have finished. This call does
+   * not block the host thread.
+   * \param event The event to query.
+   * \return Whether the captured workloads have finished.
+   */
+  virtual bool QueryEvent(void* event) = 0;
+
   /*!
    * \brief The the device api of given device type
    * \param device_type The device type.
@@ -8,6 +8,7 @@
  * \brief Config of Distributed Settings.
  */
 #pragma once
+#include <string>
 #include "./ir.h"
 #include "./communicator.h"
 
@@ -24,6 +25,38 @@ class DistConfigObj : public ir::Object {
   int auto_dp_profiling_start_iter = 2;
   int auto_dp_profiling_end_iter = 4;
   int64_t group_bucket_size = 5000000000;
+  /*! \brief The dtype to compress float32 gradients to in data parallel ("none" to disable). */
+  std::string gradient_compression = "none";
+  /*! \brief Whether to use the hierarchical (intra-node then inter-node) schedule for the global
+   * allreduce when the job spans multiple nodes.
+   */
+  bool enable_hierarchical_allreduce = false;
+  /*! \brief Whether to group the allreduce ops of gradients into buckets of at most
+   * group_bucket_size elements in DataParallelSchedule.
+   */
+  bool enable_allreduce_bucketing = false;
+  /*! \brief Whether ZeRO-1/2 defers gathering the updated parameter partitions to the next step,
+   * where each parameter is gathered right before its first use in the forward.
+   */
+  bool zero_defer_allgather = false;
+  /*! \brief Whether to launch the consecutive independent collectives on the communication stream
+   * as one NCCL group.
+   */
+  bool enable_group_collectives = false;
+  /*! \brief Whether ZeRO-1/2 keeps the optimizer status and the float32 master weights in the host
+   * memory, where the optimizer step runs on the gradient partitions copied from the device.
+   */
+  bool zero_offload = false;
+  /*! \brief Whether ZeRO-1/2 packs the gradients into a few flat buffers, each of which is padded
+   * and partitioned once, so that the optimizer updates the flat partitions.
+   */
+  bool zero_flat_buffer = false;
+  /*! \brief The number of communication streams, each with its own communicator instances.
+   * EnforceSync spreads the classes of collectives (the op and the ranks) over the streams, so
+   * that independent collectives, e.g., the data-parallel allreduce and the tensor-parallel
+   * traffic, can run concurrently.
+   */
+  int num_comm_streams = 1;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("enable_data_parallel", &enable_data_parallel);
@@ -32,6 +65,14 @@ class DistConfigObj : public ir::Object {
     v->Visit("auto_dp_profiling_start_iter", &auto_dp_profiling_start_iter);
     v->Visit("auto_dp_profiling_end_iter", &auto_dp_profiling_end_iter);
     v->Visit("group_bucket_size", &group_bucket_size);
+    v->Visit("gradient_compression", &gradient_compression);
+    v->Visit("enable_hierarchical_allreduce", &enable_hierarchical_allreduce);
+    v->Visit("enable_allreduce_bucketing", &enable_allreduce_bucketing);
+    v->Visit("zero_defer_allgather", &zero_defer_allgather);
+    v->Visit("enable_group_collectives", &enable_group_collectives);
+    v->Visit("zero_offload", &zero_offload);
+    v->Visit("zero_flat_buffer", &zero_flat_buffer);
+    v->Visit("num_comm_streams", &num_comm_streams);
   }
 
  public:
@@ -0,0 +1,78 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file embedding_cache.h
+ * \brief Embedding tables on the host with a row cache on the device.
+ *
+ * A table that does not fit in the device memory is kept in pinned host memory, which is mapped
+ * to the device, so the table tensor is on the device as far as the VM is concerned and is passed
+ * to each execution without a copy. The frequent rows are kept by a set-associative cache of
+ * num_sets * num_ways rows on the device, whose tags are in shape [num_sets, 1 + num_ways, 3] (see
+ * src/op/dialect/cuda/kernels/embedding_cache.cu). raf.op.embedding_cache looks up the rows
+ * through the cache and fills in the missed rows, and raf.op.embedding_cache_sgd updates the
+ * cached rows in the cache, which are written back to the table once evicted or flushed.
+ */
+#pragma once
+#include <memory>
+#include <vector>
+#include "./device.h"
+#include "./memory_pool.h"
+#include "./value.h"
+
+namespace raf {
+namespace embedding_cache {
+
+class EmbeddingCache {
+ public:
+  /*!
+   * \brief Copy a table to pinned host memory and allocate its row cache.
+   * \param device The device of the cache, to which the table is mapped.
+   * \param table The initial table in shape [num_rows, hidden...].
+   * \param num_sets The number of sets of the cache.
+   * \param num_ways The number of rows of each set, which is at most 32.
+   */
+  EmbeddingCache(const Device& device, const value::TensorValue& table, int64_t num_sets,
+                 int64_t num_ways);
+
+  /*! \brief Write the dirty rows of the cache back to the table. */
+  void Flush();
+
+  /*! \brief A copy of the table on the CPU after flushing the cache. */
+  value::TensorValue ReadTable();
+
+  /*! \brief The number of rows kept by the cache. */
+  int64_t NumCachedRows();
+
+  /*! \brief The table mapped to the device. */
+  const value::TensorValue& Table() const {
+    return table_;
+  }
+
+  /*! \brief The tags of the cache. */
+  const value::TensorValue& Tags() const {
+    return tags_;
+  }
+
+  /*! \brief The cached rows in shape [num_sets * num_ways, hidden...]. */
+  const value::TensorValue& Rows() const {
+    return rows_;
+  }
+
+ private:
+  /*! \brief Read the tags to the host after the pending kernels are finished. */
+  std::vector<int64_t> ReadTags();
+
+  Device device_;
+  int64_t num_sets_, num_ways_;
+  /*! \brief The bytes of a row. */
+  int64_t row_bytes_;
+  /*! \brief The pinned host memory of the table. */
+  std::shared_ptr<memory_pool::Memory> host_;
+  value::TensorValue table_, tags_, rows_;
+};
+
+}  // namespace embedding_cache
+}  // namespace raf
@@ -9,7 +9,10 @@
  */
 #pragma once
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "./device.h"
 #include "device_api.h"
 
@@ -19,6 +22,13 @@ namespace event_pool {
 using namespace device_api;
 
 class EventPool;
+class LocalEventLists;
+
+/*!
+ * \brief The flag of the events that are only used for synchronization, which are cheaper to record
+ * and wait than the timing ones. It is cudaEventDisableTiming on CUDA devices.
+ */
+constexpr uint32_t kEventDisableTiming = 0x02;
 
 /*!
  * \brief A representation of event on a device. The events can be used to describe the dependency
@@ -26,7 +36,8 @@ class EventPool;
  * device without blocking the entire device.
  *
  * This class implements the event managed by the event pool, which can reduce the real event
- * allocation on device through recycling.
+ * allocation on device through recycling. The event is returned to the free list of the releasing
+ * thread when this object is destroyed.
  */
 class Event final {
  public:
@@ -39,14 +50,15 @@ class Event final {
   void* data() const;
 
  private:
-  class Impl;
-
-  explicit Event(std::unique_ptr<Impl> impl);
+  Event(EventPool* pool, uint32_t flags, void* event);
 
-  /*! \brief The internal implementation of Event. */
-  std::unique_ptr<Impl> impl_;
+  /*! \brief The pool of the event, which lives until the program exits. */
+  EventPool* pool_;
+  /*! \brief The flags of the event. */
+  uint32_t flags_;
+  /*! \brief The event created by the device api. */
+  void* event_;
 
-  friend Impl;
   friend EventPool;
 };
 
@@ -63,7 +75,8 @@ class EventPool {
 
   /*!
    * \brief Get a new event with given flags. The new event can be a new event created by device api
-   * or an event that has been recycled previously.
+   * or an event that has been recycled previously. The recycled events are first taken from the
+   * free list of the calling thread without locking, which is refilled from the pool in batches.
    * \param flags The flags of the event. The flags depends on the underlying device. For cuda
    * device, refers to https://docs.nvidia.com/cuda/cuda-runtime-api/group__CUDART__EVENT.html for
    * available flags.
@@ -79,13 +92,21 @@ class EventPool {
   explicit EventPool(const Device& dev);
 
   /*!
-   * \brief Recycle an event. The event will be reused later when user tries to get a new event with
-   * the same flags.
-   *
-   * \param flags The flags of the recycled event.
-   * \param event The event to be recycled.
+   * \brief Move at most n freed events with given flags from the pool to the given list.
+   * \param flags The flags of the events.
+   * \param n The maximal number of events to move.
+   * \param events The list to append the events to.
+   */
+  void TakeEvents(uint32_t flags, size_t n, std::vector<void*>* events);
+
+  /*!
+   * \brief Recycle the last n events of the given list to the pool, which will be reused later when
+   * user tries to get a new event with the same flags.
+   * \param flags The flags of the recycled events.
+   * \param n The number of events to recycle.
+   * \param events The list to remove the events from.
    */
-  void RecycleEvent(uint32_t flags, void* event);
+  void RecycleEvents(uint32_t flags, size_t n, std::vector<void*>* events);
 
   /*! \brief The device of the memory pool. */
   Device device_;
@@ -97,6 +118,7 @@ class EventPool {
   std::mutex mutex_;
 
   friend Event;
+  friend LocalEventLists;
 };
 
 }  // namespace event_pool
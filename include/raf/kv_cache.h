@@ -0,0 +1,94 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file kv_cache.h
+ * \brief Paged key/value caches for autoregressive decoding.
+ *
+ * The keys and values of each layer are kept in a cache tensor in shape
+ * [num_blocks, block_size, ...], which is allocated once from the memory pool. The blocks are
+ * handed out to the sequences on demand and returned to a free list once a sequence finishes, so
+ * the sequences of different lengths share the caches without fragmentation. A token of a
+ * sequence is stored at the flat slot block * block_size + offset, and the blocks of a sequence
+ * in order form its block table, which are consumed by raf.op.kv_cache_append and
+ * raf.op.kv_cache_gather respectively. The cache tensors are passed to each decoding step and
+ * updated in place, so the cached tokens persist across the executions.
+ */
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "./device.h"
+#include "./memory_pool.h"
+#include "./value.h"
+
+namespace raf {
+namespace kv_cache {
+
+class KVCacheManager {
+ public:
+  /*!
+   * \brief Allocate the caches of all layers.
+   * \param device The device of the caches.
+   * \param dtype The dtype of the keys and values.
+   * \param num_layers The number of layers, each of which has a key cache and a value cache.
+   * \param num_blocks The number of blocks of each cache.
+   * \param block_size The number of tokens of each block.
+   * \param token_shape The shape of the key or value of a token, e.g., [num_heads, head_dim].
+   */
+  KVCacheManager(const Device& device, DType dtype, int num_layers, int64_t num_blocks,
+                 int64_t block_size, const std::vector<int64_t>& token_shape);
+
+  /*!
+   * \brief Reserve the slots of the next tokens of a sequence, taking free blocks as needed. A new
+   * sequence is started if seq_id is unknown. It fails without side effects if there are not
+   * enough free blocks.
+   * \return The flat slots of the tokens.
+   */
+  std::vector<int64_t> Append(int64_t seq_id, int64_t num_tokens);
+
+  /*!
+   * \brief The block tables of a batch of sequences in shape [batch_size, max_blocks] in row-major
+   * order, where max_blocks is the most blocks of a sequence. The short tables are padded with
+   * block 0, whose positions are past the lengths of the sequences.
+   */
+  std::vector<int64_t> BlockTables(const std::vector<int64_t>& seq_ids, int64_t* max_blocks) const;
+
+  /*! \brief The number of cached tokens of a sequence, including the reserved ones. */
+  int64_t SeqLen(int64_t seq_id) const;
+
+  /*! \brief Return the blocks of a finished sequence to the free list. */
+  void Free(int64_t seq_id);
+
+  /*! \brief The number of free blocks. */
+  int64_t NumFreeBlocks() const {
+    return free_blocks_.size();
+  }
+
+  /*! \brief The key cache and then the value cache of each layer. */
+  const std::vector<value::TensorValue>& Caches() const {
+    return caches_;
+  }
+
+  const Device& device() const {
+    return device_;
+  }
+
+ private:
+  struct Sequence {
+    std::vector<int64_t> blocks;
+    int64_t length = 0;
+  };
+
+  Device device_;
+  int64_t block_size_;
+  /*! \brief The free blocks as a stack, so that the recently freed blocks are reused first. */
+  std::vector<int64_t> free_blocks_;
+  std::unordered_map<int64_t, Sequence> sequences_;
+  std::vector<value::TensorValue> caches_;
+};
+
+}  // namespace kv_cache
+}  // namespace raf
@@ -10,6 +10,7 @@
 #pragma once
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "./device.h"
 
@@ -18,6 +19,52 @@ namespace memory_pool {
 
 class MemoryPool;
 
+/*!
+ * \brief The memory usage of a tenant of a pool shared by several models (e.g., VMs serving
+ * different models on one GPU). All sizes are in bytes.
+ */
+struct TenantStats {
+  /*! \brief The bytes guaranteed to the tenant, which the other tenants cannot take. */
+  int64_t reserved_bytes = 0;
+  /*! \brief The most bytes the tenant can use at a time. 0 means no quota. */
+  int64_t quota_bytes = 0;
+  /*! \brief The bytes currently used by the tenant. */
+  int64_t used_bytes = 0;
+  /*! \brief The bytes released by the tenant and cached for its later requests. */
+  int64_t cached_bytes = 0;
+  /*! \brief The peak of the used bytes. */
+  int64_t peak_bytes = 0;
+  /*! \brief The number of requests. */
+  int64_t num_allocs = 0;
+  /*! \brief The cached bytes of the tenant returned to the device to serve the others. */
+  int64_t reclaimed_bytes = 0;
+};
+
+/*!
+ * \brief Attribute the memory allocated by this thread to the given tenant within the scope. The
+ * scopes can be nested, and the empty name is the default tenant.
+ */
+class TenantScope {
+ public:
+  explicit TenantScope(const std::string& tenant) : prev_(Current()) {
+    Current() = tenant;
+  }
+
+  ~TenantScope() {
+    Current() = prev_;
+  }
+
+  /*! \brief The tenant of the allocations of this thread. */
+  static std::string& Current() {
+    thread_local std::string tenant;
+    return tenant;
+  }
+
+ private:
+  /*! \brief The tenant before the scope. */
+  std::string prev_;
+};
+
 /*!
  * \brief A wrapper for a chunk of memory, which may have shared reference to the pool so that they
  * are freed correctly. Interaction between memory pool manager also happens here.
@@ -39,6 +86,17 @@ class Memory {
   static std::shared_ptr<Memory> AllocAsync(const Device& dev, int64_t nbytes, void* stream,
                                             int64_t alignment = kDefaultMemoryAlignment);
 
+  /*!
+   * \brief Allocate host memory to exchange data with the given device. The memory is pinned when
+   * the device is a CUDA GPU, so that the copies run at full bandwidth and can be asynchronous.
+   * \param dev The device to exchange data with.
+   * \param nbytes The size of the memory.
+   * \param alignment The alignment of the memory.
+   * \return The host memory.
+   */
+  static std::shared_ptr<Memory> AllocHost(const Device& dev, int64_t nbytes,
+                                           int64_t alignment = kDefaultMemoryAlignment);
+
   static std::vector<std::shared_ptr<Memory> > AllocBatch(
       const Device& dev, const std::vector<int64_t>& nbytes,
       int64_t alignment = kDefaultMemoryAlignment);
@@ -54,11 +112,28 @@ class Memory {
 
   static MemoryPool* InitPool(const Device& dev, const std::string& name);
 
+  /*!
+   * \brief Configure a tenant of the pool of the device. See MemoryPool::SetTenant.
+   * \param dev The device of the pool.
+   * \param tenant The name of the tenant.
+   * \param reserved_bytes The bytes guaranteed to the tenant.
+   * \param quota_bytes The most bytes the tenant can use at a time. 0 means no quota.
+   */
+  static void SetTenant(const Device& dev, const std::string& tenant, int64_t reserved_bytes,
+                        int64_t quota_bytes);
+
+  static std::unordered_map<std::string, TenantStats> GetTenantStats(const Device& dev);
+
  public:
   /*! \brief The pointer to the allocated chunk of memory. */
   void* data = nullptr;
   /*! \brief The context of the allocated chunk of memory. */
   Device device{};
+  /*!
+   * \brief The stream that the allocation (and release) of this chunk of memory is ordered on.
+   * nullptr if the memory was allocated synchronously.
+   */
+  void* stream = nullptr;
 };
 
 /*!
@@ -124,6 +199,28 @@ class MemoryPool {
    * \return A pair of the total size of (used chunks, pool).
    */
   virtual std::pair<float, float> GetPoolSize() = 0;
+
+  /*!
+   * \brief Configure a tenant, whose memory is allocated in the scopes of TenantScope. Only the
+   * pools shared by tenants support this.
+   *
+   * \param tenant The name of the tenant.
+   * \param reserved_bytes The bytes guaranteed to the tenant.
+   * \param quota_bytes The most bytes the tenant can use at a time. 0 means no quota.
+   */
+  virtual void SetTenant(const std::string& tenant, int64_t reserved_bytes, int64_t quota_bytes) {
+    LOG(FATAL) << GetName() << " does not support tenants. Please use tenant_pool.";
+  }
+
+  /*!
+   * \brief Get the memory usage of each tenant.
+   *
+   * \return The map from the tenant name to its stats, which is empty if the pool does not support
+   * tenants.
+   */
+  virtual std::unordered_map<std::string, TenantStats> GetTenantStats() {
+    return {};
+  }
 };
 
 }  // namespace memory_pool
@@ -46,6 +46,24 @@ struct MemoryTrace {
   }
 };
 
+/*! \brief A buffer allocated by the VM, tracked from its allocation to its release. */
+struct AllocationRecord {
+  /*! \brief The size in bytes. */
+  int64_t nbytes = 0;
+  /*! \brief The IR variable the buffer is bound to, or "<workspace>" for op workspaces. */
+  std::string var;
+  /*! \brief The op executed right after the allocation, which is the op that uses the buffer. */
+  std::string op;
+  /*! \brief The VM stream that allocates the buffer. */
+  int64_t stream_id = 0;
+  /*! \brief The number of memory traces recorded before the allocation and the release. */
+  int64_t alloc_trace = 0;
+  int64_t free_trace = -1;
+  /*! \brief The order of the allocation and the release among all allocation events. */
+  int64_t alloc_seq = 0;
+  int64_t free_seq = -1;
+};
+
 /*! \brief Memory stats of a device. */
 struct MemoryStat {
   /*! \brief A sequence of memory traces. */
@@ -54,6 +72,19 @@ struct MemoryStat {
   int max_trace_idx = 0;
   /*! \brief The number of triggered garbage collections. */
   int num_gc = 0;
+  /*! \brief All tracked allocations in allocation order. */
+  std::vector<AllocationRecord> allocations;
+  /*! \brief The live allocations, keyed by their memory buffer. */
+  std::unordered_map<const void*, size_t> live_allocations;
+  /*! \brief The allocations whose op is not executed yet. */
+  std::vector<size_t> pending_ops;
+  /*! \brief The number of allocation events. */
+  int64_t num_events = 0;
+  /*! \brief The current and the peak bytes of the live allocations. */
+  int64_t live_bytes = 0;
+  int64_t peak_live_bytes = 0;
+  /*! \brief The allocation event that reaches the peak live bytes. */
+  int64_t peak_seq = -1;
 };
 
 /*! \brief The memory profiler for all devices. */
@@ -77,6 +108,25 @@ class MemoryProfiler {
    */
   void Record(const Device& device, const std::string& tag);
 
+  /*!
+   * \brief Record an allocation made by the VM. The allocation is attributed to the op of the
+   * next memory trace. Allocating a buffer that is still live is ignored.
+   * \param device The device of the buffer.
+   * \param key The identity of the buffer.
+   * \param nbytes The size in bytes.
+   * \param var The IR variable the buffer is bound to.
+   * \param stream_id The VM stream that allocates the buffer.
+   */
+  void RecordAlloc(const Device& device, const void* key, int64_t nbytes, const std::string& var,
+                   int64_t stream_id);
+
+  /*!
+   * \brief Record the release of a buffer. Buffers that are not tracked are ignored.
+   * \param device The device of the buffer.
+   * \param key The identity of the buffer.
+   */
+  void RecordFree(const Device& device, const void* key);
+
   /*! \brief Reset all memory stats. */
   void Reset();
 
@@ -95,6 +145,23 @@ class MemoryProfiler {
    */
   std::string GetMemoryTrace(const Device& device);
 
+  /*!
+   * \brief Get the report of the tracked allocations of the given device.
+   * \param device The device to get the report.
+   * \param predicted_peak The peak memory in MBs predicted by EstimateMemory, or a non-positive
+   * value if not available.
+   * \return The report, including the live set at the peak, the fragmentation of the pool and
+   * the difference from the prediction. Sizes are in MBs.
+   */
+  Map<String, ObjectRef> GetAllocationReport(const Device& device, float predicted_peak);
+
+  /*!
+   * \brief Get the allocation timeline of the given device.
+   * \param device The device to get the timeline.
+   * \return The allocation table of the device in a pretty string.
+   */
+  std::string GetAllocationTrace(const Device& device);
+
  private:
   /*! \brief Mapping from device string to memory stats. */
   std::unordered_map<std::string, MemoryStat> memory_stats_;
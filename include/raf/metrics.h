@@ -0,0 +1,210 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file metrics.h
+ * \brief The registry of the runtime metrics, e.g., the VM run latency, the OpEnv cache hits and
+ * the memory pool usage, for the production telemetry.
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace raf {
+namespace metrics {
+
+/*! \brief The labels of a metric as (name, value) pairs, e.g., {{"device", "cuda(0)"}}. */
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+enum class MetricType : int {
+  kCounter = 0,
+  kGauge,
+  kHistogram,
+};
+
+/*! \brief A monotonically increasing count. Updating it is lock-free. */
+class Counter {
+ public:
+  void Inc(int64_t delta = 1) {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  int64_t Value() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+  void Reset() {
+    value_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+/*! \brief A value that can go up and down. Updating it is lock-free. */
+class Gauge {
+ public:
+  void Set(double value) {
+    value_.store(value, std::memory_order_relaxed);
+  }
+
+  void Add(double delta) {
+    double old = value_.load(std::memory_order_relaxed);
+    while (!value_.compare_exchange_weak(old, old + delta, std::memory_order_relaxed)) {
+    }
+  }
+
+  double Value() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+  void Reset() {
+    Set(0);
+  }
+
+ private:
+  std::atomic<double> value_{0};
+};
+
+/*!
+ * \brief The distribution of the observed values in fixed buckets. A value v is counted in the
+ * first bucket whose upper bound is at least v, or in the overflow bucket. Observing a value is
+ * lock-free.
+ */
+class Histogram {
+ public:
+  /*! \param bounds The upper bounds of the buckets in ascending order. */
+  explicit Histogram(std::vector<double> bounds);
+
+  void Observe(double value);
+
+  const std::vector<double>& Bounds() const {
+    return bounds_;
+  }
+
+  /*! \brief The count of each bucket, where the last one is the overflow bucket. */
+  std::vector<uint64_t> BucketCounts() const;
+
+  double Sum() const {
+    return sum_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t Count() const {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  void Reset();
+
+ private:
+  std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+  std::atomic<double> sum_{0};
+  std::atomic<uint64_t> count_{0};
+};
+
+/*! \brief The bounds of start * factor^i for i in [0, count), e.g., for the latency in us. */
+std::vector<double> ExponentialBuckets(double start, double factor, int count);
+
+/*! \brief Observe the elapsed time of the scope in microseconds. */
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(Histogram* histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {
+  }
+
+  ~ScopedLatency() {
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start_;
+    histogram_->Observe(elapsed.count());
+  }
+
+  ScopedLatency(const ScopedLatency&) = delete;
+  ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+ private:
+  Histogram* histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/*! \brief A metric value at the snapshot time. */
+struct MetricSample {
+  std::string name;
+  Labels labels;
+  MetricType type;
+  /*! \brief The value of a counter or a gauge. */
+  double value = 0;
+  /*! \brief The bucket bounds and counts of a histogram, where the last count is the overflow. */
+  std::vector<double> bounds;
+  std::vector<uint64_t> bucket_counts;
+  double sum = 0;
+  uint64_t count = 0;
+};
+
+/*!
+ * \brief The registry of the metrics. The metrics are created once (e.g., held by function-local
+ * statics or by the OpEnvs), and their pointers stay valid for the process, so updating them does
+ * not touch the registry. The values that are owned by other components (e.g., the memory pool
+ * sizes) are reported by collectors, which are only called when a snapshot is taken.
+ */
+class Registry {
+ public:
+  /*! \brief A function that appends the samples of a component to a snapshot. */
+  using Collector = std::function<void(std::vector<MetricSample>*)>;
+
+  static Registry* Get();
+
+  /*! \brief Get or create a counter. The help string is kept from its first creation. */
+  Counter* GetCounter(const std::string& name, const std::string& help, const Labels& labels = {});
+
+  /*! \brief Get or create a gauge. */
+  Gauge* GetGauge(const std::string& name, const std::string& help, const Labels& labels = {});
+
+  /*! \brief Get or create a histogram. The bounds are kept from its first creation. */
+  Histogram* GetHistogram(const std::string& name, const std::string& help,
+                          const std::vector<double>& bounds, const Labels& labels = {});
+
+  /*! \brief Register a collector with the names and help strings of the metrics it reports. */
+  void RegisterCollector(const std::vector<std::pair<std::string, std::string>>& helps,
+                         Collector collector);
+
+  /*! \brief Take a snapshot of all metrics, sorted by name and labels. */
+  std::vector<MetricSample> Snapshot();
+
+  /*! \brief Render a snapshot in the Prometheus text exposition format. */
+  std::string ExportPrometheus();
+
+  /*! \brief Reset the counters, gauges and histograms. The collected values are not affected. */
+  void Reset();
+
+ private:
+  struct Entry {
+    std::string name;
+    Labels labels;
+    MetricType type;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+  };
+
+  /*! \brief Get or create an entry. The caller must hold mu_. */
+  Entry* GetEntry(const std::string& name, const std::string& help, const Labels& labels,
+                  MetricType type);
+
+  /*! \brief The entries keyed by the name and the labels. */
+  std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;
+  /*! \brief The help string of each metric name. */
+  std::unordered_map<std::string, std::string> helps_;
+  std::vector<Collector> collectors_;
+  std::mutex mu_;
+};
+
+}  // namespace metrics
+}  // namespace raf
@@ -30,6 +30,8 @@ class NCCLCommunicatorObj final : public CommunicatorObj {
 class NCCLCommunicator final : public Communicator {
  public:
   static NCCLCommunicator make(Value rank_list);
+  /*! \brief Create the sub-communicators of the rank lists in a batch. */
+  static void WarmUp(ir::Array<Value> rank_lists);
   RAF_OBJECT_REF(NCCLCommunicator, Communicator, NCCLCommunicatorObj);
 };
 
@@ -8,6 +8,7 @@
  * \brief Operator interface
  */
 #pragma once
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -194,6 +195,16 @@ inline T GetOpAttrOrDefault(const ir::Op& op, const std::string attr_name, T def
  */
 std::shared_ptr<OpEnv> Dispatch(const CallValues& call);
 
+/*!
+ * \brief Dispatch the calls concurrently, e.g., to build the kernels ahead of time. The first
+ * exception thrown by any call is rethrown after all calls are dispatched.
+ * \param calls The call values.
+ * \param num_threads The number of threads. All cores are used if it is not positive.
+ * \return The created OpEnvs in the order of the calls.
+ */
+std::vector<std::shared_ptr<OpEnv>> DispatchParallel(const std::vector<CallValues>& calls,
+                                                     int num_threads);
+
 /*!
  * \brief Create a dummy call_values from a call expression. The inputs and output of the call
  * values are dummy values created according to the inferred type of the call expression.
@@ -203,6 +214,17 @@ std::shared_ptr<OpEnv> Dispatch(const CallValues& call);
  */
 CallValues CreateDummyCallValues(Call call, Device device);
 
+/*!
+ * \brief Create a dummy call_values from a call expression, with the dummy inputs and output
+ * created by the given function.
+ * \param call The call expression.
+ * \param device The target device.
+ * \param make_dummy The function creating a dummy value of the given type.
+ * \return The created dummy call_values.
+ */
+CallValues CreateDummyCallValues(Call call, Device device,
+                                 const std::function<Value(const ir::Type&)>& make_dummy);
+
 // Operator pattern
 using tvm::relay::kBroadcast;
 using tvm::relay::kCommReduce;
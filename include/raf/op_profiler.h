@@ -31,6 +31,50 @@ using LatencyAndWorkspaceMapT =
     std::unordered_map<std::string, std::pair<std::vector<float>, int64_t>>;
 using OpEnvMapT = std::unordered_map<std::string, OpEnvPtr>;
 
+/*!
+ * \brief A device buffer carved into dummy tensors. Since dummy data is never read back, the ops
+ * profiled one after another can rewind and reuse the same buffer instead of allocating their
+ * own inputs and outputs.
+ */
+class DummyArena {
+ public:
+  /*!
+   * \brief Allocate a zero-initialized arena.
+   * \param device The device of the arena.
+   * \param nbytes The size of the arena in bytes.
+   */
+  DummyArena(const Device& device, int64_t nbytes);
+
+  /*!
+   * \brief The number of bytes needed to carve the dummy arguments and output of a call.
+   * \param call The call node.
+   * \return The size in bytes, including the alignment padding.
+   */
+  static int64_t CallBytes(const Call& call);
+
+  /*!
+   * \brief Carve a dummy value of the given type from the arena.
+   * \param type The tensor or tuple type.
+   * \return The dummy value, which holds a reference to the arena memory.
+   */
+  Value Create(const Type& type);
+
+  /*! \brief Reuse the arena from the beginning. */
+  void Rewind() {
+    offset_ = 0;
+  }
+
+ private:
+  /*! \brief The alignment of each carved tensor in bytes. */
+  static constexpr int64_t kAlign = 256;
+  static int64_t TypeBytes(const Type& type);
+
+  Device device_;
+  std::shared_ptr<memory_pool::Memory> memory_;
+  int64_t nbytes_;
+  int64_t offset_ = 0;
+};
+
 /*! \brief A class to JIT op, create dummy input data, and allocate memory buffers for profiling. */
 class OpWithData {
  public:
@@ -40,13 +84,34 @@ class OpWithData {
   Value output;
   int64_t workspace_size = 0;  // Workspace memory size in bytes.
 
-  OpWithData(const Device device, const Expr& op, const int stream_id = -1);
+  /*!
+   * \brief Build an op, and create its dummy inputs and output.
+   * \param device The target device.
+   * \param op The op to be profiled.
+   * \param stream_id The stream to launch the op, or -1 for the default stream.
+   * \param built_op_env The OpEnv of the op that has been built, or nullptr to build it here.
+   */
+  OpWithData(const Device device, const Expr& op, const int stream_id = -1,
+             OpEnvPtr built_op_env = nullptr);
+
+  /*!
+   * \brief Wrap an op that has been built, with the dummy inputs and output carved from an arena.
+   * \param device The target device.
+   * \param op The op to be profiled.
+   * \param op_env The built OpEnv of the op, or nullptr if the op cannot be built.
+   * \param arena The arena of the dummy data, which must be rewound by the caller.
+   */
+  OpWithData(const Device device, const Expr& op, OpEnvPtr op_env, DummyArena* arena);
 
   ~OpWithData();
 
   bool profilable() const {
     return op_env != nullptr;
   }
+
+ private:
+  /*! \brief Collect the inputs used by the OpEnv and allocate its workspace. */
+  void Prepare(const Call& call, const std::vector<Value>& args);
 };
 
 using OpWithDataPtr = std::shared_ptr<OpWithData>;
@@ -61,6 +126,15 @@ class OpProfiler {
    */
   static OpProfiler* Get(const Device& device);
 
+  /*!
+   * \brief Get the cost model of op latency selected by the pass config
+   * "raf.op_profiler.cost_model", which is either "profile" (default) to profile the ops on the
+   * device, or "analytical" to estimate them with AnalyticalOpProfiler.
+   * \param device The target device.
+   * \return The op profiler pointer.
+   */
+  static OpProfiler* GetCostModel(const Device& device);
+
   virtual ~OpProfiler() {
   }
 
@@ -75,13 +149,35 @@ class OpProfiler {
    * (2) workspace size of the op in bytes. If cache hits, the latency and
    * workspace size are retrieved from the cache and no execution is performed on the device.
    */
-  std::pair<std::vector<float>, float> ProfileOp(const Expr& op, int32_t warmup = 10,
-                                                 int32_t exec_number = 10, int32_t repeat = 1);
+  virtual std::pair<std::vector<float>, float> ProfileOp(const Expr& op, int32_t warmup = 10,
+                                                         int32_t exec_number = 10,
+                                                         int32_t repeat = 1);
+
+  /*!
+   * \brief Profile a batch of ops, each independently, and return the latency and workspace size
+   * of each op as ProfileOp does. Ops with the same hash key are profiled only once. The ops that
+   * miss the cache are built concurrently on a thread pool, and then profiled one by one with the
+   * dummy inputs and outputs carved from a shared arena sized to the largest op, so that the
+   * device memory is allocated once for the whole batch.
+   * \param ops The ops to be profiled.
+   * \param warmup The number of warmup iterations. Default 10.
+   * \param exec_number The number of execution iterations. Default 10.
+   * \param repeat The number of repeat iterations. Default 1.
+   * \param num_threads The number of threads to build the ops, or the number of CPU cores if
+   * non-positive. Note that the dialects tuning their kernels when building (e.g., cuDNN algorithm
+   * search) are tuned concurrently unless num_threads is 1.
+   * \return The latency and workspace size of each op in the order of ops.
+   */
+  virtual std::vector<std::pair<std::vector<float>, float>> ProfileOps(
+      const std::vector<Expr>& ops, int32_t warmup = 10, int32_t exec_number = 10,
+      int32_t repeat = 1, int num_threads = 0);
 
   /*!
    * \brief Profile a group of ops and return (1) the total latency in microseconds, and (2) the
    * total workspace size of this group of ops in bytes. If stream_ids are presented, each op will
-   * be launched on the corresponding stream, which enables async execution.
+   * be launched on the corresponding stream, which enables async execution. The ops built by
+   * ProfileOp or ProfileOps are not built again, so a batch of ops can be built concurrently with
+   * ProfileOps before profiling the groups of them.
    * \param ops The ops to be profiled.
    * \param stream_ids The stream id for each op, or default stream if empty.
    * \param warmup The number of warmup iterations. Default 10.
@@ -91,10 +187,9 @@ class OpProfiler {
    * of all ops in bytes. If cache hits, the latency and workspace size are retrieved from the cache
    * and no execution is performed on the device.
    */
-  std::pair<std::vector<float>, float> ProfileOpGroup(const std::vector<Expr>& ops,
-                                                      const std::vector<int>& stream_ids = {},
-                                                      int32_t warmup = 10, int32_t exec_number = 10,
-                                                      int32_t repeat = 1);
+  virtual std::pair<std::vector<float>, float> ProfileOpGroup(
+      const std::vector<Expr>& ops, const std::vector<int>& stream_ids = {}, int32_t warmup = 10,
+      int32_t exec_number = 10, int32_t repeat = 1);
 
   /*!
    * \brief Return the OpEnv of the given op if it has been profiled.
@@ -130,7 +225,6 @@ class OpProfiler {
   /*! \brief A cache to store built OpEnv. */
   OpEnvMapT op_env_cache_;
 
- private:
   /*!
    * \brief Generate a byte string hash for the given call node using its op as well as
    * argument and return types.
@@ -197,6 +291,7 @@ class OpProfiler {
     return std::string(key.byte_vector.begin(), key.byte_vector.end());
   }
 
+ private:
   /*!
    * \brief The function that actually executes the op on the device.
    * \param op_with_data The executable op with data.
@@ -313,5 +408,102 @@ class CUDAOpProfiler : public OpProfiler {
 };
 #endif
 
+/*! \brief The characteristics of a device used by the analytical cost model. */
+struct DeviceSpec {
+  /*! \brief The achievable compute throughput in GFLOPS. */
+  double peak_gflops;
+  /*! \brief The achievable memory bandwidth in GB/s. */
+  double peak_gbps;
+  /*! \brief The fixed overhead of each kernel in microseconds. */
+  double launch_us;
+};
+
+/*!
+ * \brief A cost model that estimates the op latency with a roofline model instead of running the
+ * ops, so that the passes relying on the op latency can run on hosts without the target device
+ * and make deterministic decisions. The latency of an op is the launch overhead plus the maximum
+ * of its compute time (from the FLOPS estimated by the TVM dialect) and its memory time (from
+ * the bytes of its inputs and output). The device spec can be calibrated once per device model
+ * and then set for the compilation. The collectives calibrated in the CommCostModel take the
+ * calibrated latency of their communicator scope instead.
+ */
+class AnalyticalOpProfiler : public OpProfiler {
+ public:
+  /*!
+   * \brief Get the analytical cost model of the given device type.
+   * \param device The target device.
+   * \return The cost model pointer.
+   */
+  static AnalyticalOpProfiler* Get(const Device& device);
+
+  virtual ~AnalyticalOpProfiler() {
+  }
+
+  /*!
+   * \brief Estimate the latency of an op. The returned latency is the same in all repeats, and the
+   * workspace size is always 0.
+   */
+  std::pair<std::vector<float>, float> ProfileOp(const Expr& op, int32_t warmup = 10,
+                                                 int32_t exec_number = 10,
+                                                 int32_t repeat = 1) override;
+
+  std::vector<std::pair<std::vector<float>, float>> ProfileOps(const std::vector<Expr>& ops,
+                                                               int32_t warmup = 10,
+                                                               int32_t exec_number = 10,
+                                                               int32_t repeat = 1,
+                                                               int num_threads = 0) override;
+
+  /*!
+   * \brief Estimate the latency of a group of ops. The ops on the same stream run one after
+   * another, and the streams share the compute and memory throughput of the device, so the
+   * latency is the maximum of the longest stream and the time to finish all the work at the
+   * device throughput.
+   */
+  std::pair<std::vector<float>, float> ProfileOpGroup(const std::vector<Expr>& ops,
+                                                      const std::vector<int>& stream_ids = {},
+                                                      int32_t warmup = 10, int32_t exec_number = 10,
+                                                      int32_t repeat = 1) override;
+
+  /*! \brief Set the device spec. The estimated FLOPS and bytes of the ops are still cached. */
+  void SetDeviceSpec(const DeviceSpec& spec) {
+    spec_ = spec;
+  }
+
+  const DeviceSpec& GetDeviceSpec() const {
+    return spec_;
+  }
+
+  /*!
+   * \brief The GFLOPS and the bytes accessed by an op, which do not depend on the device spec. The
+   * collectives calibrated in the CommCostModel have their latency in comm_us instead.
+   */
+  struct OpWork {
+    double gflops;
+    double bytes;
+    double comm_us = -1;
+  };
+
+  /*! \brief Get the work of an op, or zero for non-call nodes. */
+  OpWork GetOpWork(const Expr& op);
+
+ private:
+  explicit AnalyticalOpProfiler(const Device& device);
+
+  /*! \brief The latency in microseconds of the given work. */
+  float Latency(const OpWork& work) const;
+
+  std::vector<float> RunOp(const OpWithDataPtr& op_with_data, int32_t warmup = 10,
+                           int32_t exec_number = 10, int32_t repeat = 1) override;
+
+  std::vector<float> RunOpGroup(const std::vector<OpWithDataPtr>& op_with_datas,
+                                int32_t warmup = 10, int32_t exec_number = 10,
+                                int32_t repeat = 1) override;
+
+  /*! \brief The device spec. */
+  DeviceSpec spec_;
+  /*! \brief The cached work of the ops, keyed by the hash of the calls. */
+  std::unordered_map<std::string, OpWork> work_cache_;
+};
+
 }  // namespace op_profiler
 }  // namespace raf
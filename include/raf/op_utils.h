@@ -44,6 +44,23 @@ static inline void GetPadHW(const std::vector<int64_t>& padding, int64_t* pad_h,
   }
 }
 
+/*! \brief Get the (top, left, bottom, right) padding from the padding of 1, 2 or 4 values. */
+static inline std::vector<int64_t> GetPadTLBR(const std::vector<int64_t>& padding) {
+  if (padding.size() == 1) {
+    return std::vector<int64_t>(4, padding[0]);
+  } else if (padding.size() == 2) {
+    return {padding[0], padding[1], padding[0], padding[1]};
+  }
+  CHECK_EQ(padding.size(), 4) << " Padding size should be 1, 2 or 4, but got " << padding.size();
+  return padding;
+}
+
+/*! \brief Whether the padding is the same at the beginning and the end of each spatial axis. */
+static inline bool IsSymmetricPadding(const std::vector<int64_t>& padding) {
+  auto tlbr = GetPadTLBR(padding);
+  return tlbr[0] == tlbr[2] && tlbr[1] == tlbr[3];
+}
+
 static inline void GetOutputPadHW(const std::vector<int64_t>& padding, int64_t* pad_h,
                                   int64_t* pad_w) {
   if (padding.size() == 1) {
@@ -125,6 +142,44 @@ inline bool IsReshapeOp(const Op& op) {
   return IsInOpSet(op, reshape_ops);
 }
 
+/*!
+ * \brief Check whether transposing a compact tensor keeps the order of its elements, i.e., the
+ * permutation only moves the axes of size 1, so the transposed tensor is a view of the input.
+ * \param shape The shape of the input.
+ * \param axes The permutation of the axes, where an empty one reverses the axes.
+ * \return Whether the transposed tensor is a view of the input.
+ */
+inline bool IsOrderPreservingTranspose(const std::vector<int64_t>& shape,
+                                       const std::vector<int64_t>& axes) {
+  int64_t ndim = shape.size();
+  int64_t last = -1;
+  for (int64_t i = 0; i < ndim; ++i) {
+    int64_t axis = axes.empty() ? ndim - i - 1 : (axes[i] >= 0 ? axes[i] : axes[i] + ndim);
+    if (shape[axis] == 1) {
+      continue;
+    }
+    if (axis < last) {
+      return false;
+    }
+    last = axis;
+  }
+  return true;
+}
+
+/*!
+ * \brief Check whether the op computes a shape-related integer tensor on the host. Such an op only
+ * reads the shape of its input, so its output stays on CPU wherever the input is, and the VM reads
+ * it without a device-to-host copy.
+ */
+inline bool IsHostShapeOp(const Expr& op) {
+  static OpSet host_shape_ops = {
+      Op::Get("raf.op.shape_as_tensor"),
+      Op::Get("raf.op.size"),
+      Op::Get("raf.op.numel"),
+  };
+  return IsInOpSet(op, host_shape_ops);
+}
+
 inline bool IsNonDeterministicOp(const Op& op) {
   static std::unordered_set<Op, ObjectPtrHash, ObjectPtrEqual> non_deterministic_ops{
       Op::Get("raf.op._contrib_dropout"), Op::Get("raf.op._contrib_dropout_dx")};
@@ -39,11 +39,14 @@ using tvm::transform::PassNode;
  * \param opt_level The optimization level of the function pass.
  * \param name The name of the function pass.
  * \param required The list of the passes that the function pass is dependent on.
+ * \param parallel Whether the pass function only reads the module and the other functions, so
+ * it can run on the functions with "raf.pass.function_pass_threads" threads.
  * \return The created function pass.
  */
 TVM_DLL Pass
 CreateRAFFunctionPass(const TypedPackedFunc<Function(Function, IRModule, PassContext)>& pass_func,
-                      int opt_level, String name, tvm::Array<String> required);
+                      int opt_level, String name, tvm::Array<String> required,
+                      bool parallel = false);
 
 /*!
  * \brief A special trace pass that prints the header and IR to LOG(INFO).
@@ -66,9 +69,24 @@ Pass AutoDiff(ir::Array<tvm::Bool> requires_grads = {});
  * closure by adding communication ops after the ops that generate local
  * gradient and stream_sync ops before the end of backward closure to ensure
  * communication is done.
+ * \param local_grads If the gradient(s) of input(s) of function are local to the rank and are not
+ * aggregated, e.g., the gradients of the partitioned parameters. It is in the same order as
+ * func->param. If empty, all gradients are aggregated.
  * \return The created pass.
  */
-Pass AutoDataParallel();
+Pass AutoDataParallel(ir::Array<tvm::Bool> local_grads = {});
+
+/*!
+ * \brief A pass that accumulates the gradients of a micro-batch to the accumulated gradients of
+ * the previous micro-batches. It must be applied right after AutoDiff. The forward function takes
+ * the accumulated gradients as extra parameters after the original ones, and the backward closure
+ * adds them to the local gradients right after the local gradients are computed, so that the
+ * aggregation inserted by AutoDataParallel communicates the accumulated gradients.
+ * \param accumulate If each gradient returned by the backward closure is accumulated. It is in the
+ * same order as func->param.
+ * \return The created pass.
+ */
+Pass AccumulateGradient(ir::Array<tvm::Bool> accumulate);
 
 /*!
  * \brief The constant folding pass.
@@ -76,6 +94,13 @@ Pass AutoDataParallel();
  */
 Pass FoldConstant();
 
+/*!
+ * \brief Deduplicate the tensor constants with the same dtype, shape, device and content, e.g.,
+ * the bound params of the tied embeddings, so that the executable keeps one copy of them.
+ * \return The created pass.
+ */
+Pass DedupConstant();
+
 /*!
  * \brief A pass that lifts the lambda to the global scope.
  * \return The created pass.
@@ -163,6 +188,13 @@ Pass AutoCast();
  */
 Pass Rematerialization();
 
+/*!
+ * \brief A pass that compresses the activations saved for the backward to a 16-bit dtype, and
+ * decompresses them right before their backward consumers.
+ * \return The created pass.
+ */
+Pass CompressActivation();
+
 /*!
  * \brief A pass that schedules ANF for memory optimization.
  * \return The created pass.
@@ -412,6 +444,60 @@ Pass Deduplicate(int forward_steps, bool consider_type, bool must_dominate,
  */
 Pass GroupAllgather();
 
+/*!
+ * \brief This pass works in ANF and merges the consecutive independent collectives into one
+ * _group_comm op, which launches them as one NCCL group.
+ * \return The created pass.
+ */
+Pass GroupCollectives();
+
+/*!
+ * \brief This pass works in ANF and fuses the independent matmuls with the same shapes and dtypes
+ * into one batch_matmul.
+ * \return The created pass.
+ */
+Pass HorizontalFuse();
+
+/*!
+ * \brief This pass works in ANF and converts the NCHW conv2d regions to NHWC, so the transposes
+ * are only at the region boundaries.
+ * \return The created pass.
+ */
+Pass ConvertLayout();
+
+/*!
+ * \brief This pass works in ANF and fuses batch_norm_train followed by relu, and optionally a
+ * residual add, into batch_norm_relu_train.
+ * \return The created pass.
+ */
+Pass FuseBatchNormRelu();
+
+/*!
+ * \brief This pass works in ANF and appends the absolute maximum of the activation of each
+ * quantizable op (conv2d, dense and matmul) in main to its outputs, which are the observers to
+ * calibrate the int8 quantization.
+ * \return The created pass.
+ */
+Pass InsertQuantObservers();
+
+/*!
+ * \brief This pass works in ANF and rewrites the quantizable ops in main into the int8 ops with the
+ * symmetric per-tensor activation scales and per-channel weight scales.
+ * \param act_abs_max The calibrated absolute maximum of the activation of each quantizable op, in
+ * the order of the observers of InsertQuantObservers.
+ * \return The created pass.
+ */
+Pass Quantize(ir::Array<ir::FloatImm> act_abs_max);
+
+/*!
+ * \brief This pass works in ANF and rewrites the 16-bit dense ops in main, whose weights are
+ * parameters or constants, into sparse24_dense. It is controlled by the "raf.sparsity_24" config:
+ * "none" (default) skips it, "pruned" assumes the weights are already 2:4 sparse, and "prune"
+ * prunes them by prune_24.
+ * \return The created pass.
+ */
+Pass Sparsify24();
+
 // Helper functions
 
 /*!
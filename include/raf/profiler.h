@@ -8,12 +8,13 @@
  * \brief profiler
  */
 #pragma once
-#include <dmlc/concurrentqueue.h>
+#include <atomic>
 #include <cstdint>
 #include <array>
 #include <utility>
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <mutex>
 #include <memory>
 #include <thread>
@@ -29,25 +30,26 @@
 #include <unistd.h>
 #endif
 
-#define WITH_BASE_PROFILER_LEVEL(LEVEL, DEVICE, NAME, CAT, ARGS, CODE_SNIPPET)                \
-  {                                                                                           \
-    bool _profiling = raf::profiler::Profiler::Get()->IsProfiling(LEVEL);                     \
-    if (_profiling) {                                                                         \
-      auto& _pool = raf::profiler::Profiler::Get()->HelperPool();                             \
-      auto _phelper_index = _pool.size();                                                     \
-      _pool.push_back(raf::profiler::ProfilerHelper(DEVICE.device_id(), DEVICE.device_type(), \
-                                                    NAME, CAT, ARGS));                        \
-      _pool[_phelper_index].start();                                                          \
-      CODE_SNIPPET                                                                            \
-      _pool[_phelper_index].stop();                                                           \
-    } else {                                                                                  \
-      CODE_SNIPPET                                                                            \
-    }                                                                                         \
+#define WITH_BASE_PROFILER_LEVEL(LEVEL, DEVICE, NAME, CAT, ARGS, CODE_SNIPPET)         \
+  {                                                                                    \
+    bool _profiling = raf::profiler::Profiler::Get()->IsProfiling(LEVEL);              \
+    if (_profiling) {                                                                  \
+      raf::profiler::ProfilerHelper _phelper(DEVICE.device_id(), DEVICE.device_type(), \
+                                             NAME, CAT, ARGS);                         \
+      _phelper.start();                                                                \
+      CODE_SNIPPET                                                                     \
+      _phelper.stop();                                                                 \
+    } else {                                                                           \
+      CODE_SNIPPET                                                                     \
+    }                                                                                  \
   }
 
 #define WITH_BASE_PROFILER(DEVICE, NAME, CAT, ARGS, CODE_SNIPPET) \
   WITH_BASE_PROFILER_LEVEL(1, DEVICE, NAME, CAT, ARGS, CODE_SNIPPET)
 
+/*! \brief Mark a string literal to be interned by its address. It does not compile otherwise. */
+#define RAF_PROFILER_LITERAL(STR) raf::profiler::Literal{"" STR}
+
 namespace raf {
 namespace profiler {
 
@@ -61,6 +63,11 @@ inline size_t current_process_id() {
 }
 #endif
 
+/*! \brief A string literal, whose address identifies it. Made by RAF_PROFILER_LITERAL. */
+struct Literal {
+  const char* str;
+};
+
 /*!
  * \brief Event type as used for chrome://tracing support
  * \note Tracing formats:
@@ -137,32 +144,25 @@ class ProfileStat {
   void EmitEvents(std::ostream* os);
 };
 
-class DeviceStats {
-  using TQueue = dmlc::moodycamel::ConcurrentQueue<ProfileStat*>;
-
- public:
-  /* data */
-  /*! \brief device name */
-  std::string dev_name_;
-  /*! \brief operation execution statistics on this device */
-  std::shared_ptr<TQueue> opr_exec_stats_ = std::make_shared<TQueue>();
-
- public:
-  ~DeviceStats();
+/*!
+ * \brief A recorded event. Names, categories and arguments are interned into ids by the profiler,
+ * so recording an event is a plain copy without memory allocation.
+ */
+struct ProfileRecord {
+  /*! \brief The start and end time in microseconds. */
+  uint64_t start_time;
+  uint64_t end_time;
+  /*! \brief The interned name, category and argument string. */
+  uint32_t name_id;
+  uint32_t category_id;
+  uint32_t args_id;
 };
 
 class ProfilerHelper {
  public:
-  ProfilerHelper(int dev_id, raf::DevType dev_type, std::string name, std::string categories,
-                 std::vector<std::string> args = {})
-      : device_(Device(dev_type, dev_id)),
-        name_(std::move(name)),
-        categories_(std::move(categories)),
-        args(std::move(args)) {
-    if (dev_type != raf::DevType::kUnknown()) {
-      dev_api_ = device_api::DeviceAPI::Get(dev_type);
-    }
-  }
+  template <typename NameT, typename CategoryT>
+  ProfilerHelper(int dev_id, raf::DevType dev_type, const NameT& name, const CategoryT& categories,
+                 const std::vector<std::string>& args = {});
 
   virtual ~ProfilerHelper() {
   }
@@ -174,39 +174,65 @@ class ProfilerHelper {
  protected:
   /*! \brief the device on which profiled code runs */
   Device device_;
-  /*! \brief the name annotation of profiling results */
-  std::string name_;
-  /*! \brief the category annotation of profiling results */
-  std::string categories_;
+  /*! \brief the interned name, category and argument annotations of profiling results */
+  uint32_t name_id_;
+  uint32_t category_id_;
+  uint32_t args_id_;
   /*! \brief profiler start time */
   uint64_t start_time_;
   /*! \brief profiler end time */
   uint64_t end_time_;
   /*! \brief the api of the device on which profiled code runs */
   std::shared_ptr<device_api::DeviceAPI> dev_api_;
-  /*! \brief the arguments annotation */
-  std::vector<std::string> args;
+};
+
+/*! \brief The estimated work of a profiled op, which is related to its measured latency. */
+struct OpWorkStat {
+  /*! \brief The op type, i.e., the OpEnv name without its unique suffix. */
+  std::string type;
+  /*! \brief The floating point operations in GFLOPs. */
+  double gflops;
+  /*! \brief The bytes of the inputs and outputs. */
+  double bytes;
 };
 
 class Profiler {
  public:
   ~Profiler();
   static Profiler* Get();  // std::shared_ptr<Profiler>* sp = nullptr);
+  /*!
+   * \brief Intern a string into an id. Lookups hit a per-thread cache first, so interning a seen
+   * string takes no lock and does not allocate.
+   */
+  uint32_t Intern(const std::string& str);
+  /*! \brief Intern a string literal. The per-thread cache is keyed by the pointer. */
+  uint32_t Intern(const Literal& literal) {
+    return InternLiteral(literal.str);
+  }
+  /*! \brief Intern the arguments annotation. Multiple arguments are joined by ";". */
+  uint32_t InternArgs(const std::vector<std::string>& args);
+  /*! \brief Record an event into the ring of the calling thread. */
+  void AddRecord(const ProfileRecord& record);
   void AddNewProfileStat(std::string categories, std::string name, uint64_t start_time,
                          uint64_t end_time, const std::vector<std::string>& args);
   std::string GetProfile();
-  std::vector<ProfileStat> GetProfileStats();
+  /*!
+   * \brief Get the collected profile stats.
+   * \param consume Whether to drop the returned stats from the profiler.
+   */
+  std::vector<ProfileStat> GetProfileStats(bool consume = true);
   void ClearProfile();
+  /*! \brief Record the estimated work of an op by the name of its profiled events. */
+  void SetOpWork(const std::string& name, const OpWorkStat& work);
+  /*! \brief Get the estimated work of the profiled ops, keyed by their names. */
+  std::unordered_map<std::string, OpWorkStat> GetOpWork();
 
   inline bool IsProfiling(int level) {
     return profile_level_ >= level;
   }
 
-  void CollectStat() {
-    for (int i = 0; i < helpers_.size(); i++) {
-      helpers_[i].collect();
-    }
-  }
+  /*! \brief Merge the records of all threads collected so far. */
+  void CollectStat();
 
   inline int profile_level() const {
     return profile_level_;
@@ -216,23 +242,130 @@ class Profiler {
     profile_level_ = profile_level;
   }
 
-  std::vector<ProfilerHelper>& HelperPool() {
-    return helpers_;
-  }
-
  private:
   Profiler();
 
-  /*! \brief Profile statistics. */
-  DeviceStats profile_stats_;
+  /*! \brief A fixed-size block of records. Only the owner thread appends to it. */
+  struct RecordChunk;
+  /*! \brief The per-thread recording state. */
+  struct ThreadBuffer;
+  /*! \brief Get the buffer of the calling thread, registering it on first use. */
+  ThreadBuffer* GetThreadBuffer();
+  /*! \brief Hand a full chunk over for merging and install a fresh one. */
+  void SwapChunk(ThreadBuffer* buffer);
+  /*! \brief Get a chunk from the free list, or allocate one. The caller must hold m_. */
+  RecordChunk* AcquireChunk();
+  /*! \brief Intern a string with static storage, caching it by the pointer. */
+  uint32_t InternLiteral(const char* str);
+  /*! \brief Intern a string that missed the per-thread cache. */
+  uint32_t InternGlobal(const std::string& str);
+  /*! \brief Convert the merged records into profile stats, optionally dropping them. */
+  std::vector<ProfileStat> TakeProfileStats(bool consume);
+
   /*! \brief Profiling level. */
   int profile_level_{0};
-  /*! \brief Mutex for multi-threading. */
+  /*! \brief Mutex for multi-threading. Guards the thread buffers, chunks and merged records. */
   std::recursive_mutex m_;
-  /*! \brief The helper pool. */
-  std::vector<ProfilerHelper> helpers_;
+  /*! \brief The buffers of all threads that recorded events. */
+  std::vector<std::shared_ptr<ThreadBuffer>> thread_buffers_;
+  /*! \brief The chunks filled up by their threads and not merged yet. */
+  std::vector<RecordChunk*> full_chunks_;
+  /*! \brief The chunks ready for reuse. */
+  std::vector<RecordChunk*> free_chunks_;
+  /*! \brief The records merged by CollectStat. */
+  std::vector<ProfileRecord> merged_;
+  /*! \brief The interned strings. Id 0 is the empty string. */
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, uint32_t> string_ids_;
+  std::mutex intern_m_;
+  /*! \brief The estimated work of the profiled ops, keyed by their names. */
+  std::unordered_map<std::string, OpWorkStat> op_work_;
+  std::mutex op_work_m_;
+};
+
+template <typename NameT, typename CategoryT>
+ProfilerHelper::ProfilerHelper(int dev_id, raf::DevType dev_type, const NameT& name,
+                               const CategoryT& categories, const std::vector<std::string>& args)
+    : device_(Device(dev_type, dev_id)) {
+  auto prof = Profiler::Get();
+  name_id_ = prof->Intern(name);
+  category_id_ = prof->Intern(categories);
+  args_id_ = prof->InternArgs(args);
+  if (dev_type != raf::DevType::kUnknown()) {
+    dev_api_ = device_api::DeviceAPI::Get(dev_type);
+  }
+}
+
+/*! \brief The time a collective op is not overlapped by computation. */
+struct ExposedCommunication {
+  std::string name;
+  uint64_t start_time;
+  uint64_t duration;
+  uint64_t exposed;
+};
+
+/*! \brief The summary of a trace. All times are in microseconds. */
+struct TraceSummary {
+  /*! \brief The time from the first start to the last end of the analyzed events. */
+  uint64_t makespan = 0;
+  /*! \brief The total duration of the events on the critical path. */
+  uint64_t critical_path = 0;
+  /*! \brief The total gap between consecutive events on the critical path. */
+  uint64_t critical_path_idle = 0;
+  /*! \brief The time on the critical path of each op name. */
+  std::unordered_map<std::string, uint64_t> critical_path_ops;
+  /*! \brief The time each stream has no event running within the makespan. */
+  std::unordered_map<std::string, uint64_t> stream_idle;
+  /*! \brief The exposed time of each collective op, in start order. */
+  std::vector<ExposedCommunication> exposed_comm;
 };
 
+/*!
+ * \brief Analyze the events on the CUDA streams. The critical path is recovered backwards from the
+ * last finishing event: the predecessor of an event is the latest event that finishes before it
+ * starts, since the trace has no dependency information.
+ * \param stats The collected profile stats. Events not on a stream category ("Default Stream",
+ * "Stream <id>" or "CUPTI Stream <id>") are ignored.
+ * \param comm_streams The stream categories that run the collective ops.
+ * \return The summary.
+ */
+TraceSummary AnalyzeTrace(const std::vector<ProfileStat>& stats,
+                          const std::vector<std::string>& comm_streams);
+
+/*! \brief The measured time and the estimated work of the ops of a type. */
+struct OpUtilization {
+  std::string type;
+  uint64_t count = 0;
+  /*! \brief The total latency in microseconds. */
+  uint64_t time = 0;
+  double gflops = 0;
+  double bytes = 0;
+};
+
+/*! \brief The utilization of a trace. All times are in microseconds. */
+struct UtilizationSummary {
+  /*! \brief The time from the first start to the last end of the op events. */
+  uint64_t makespan = 0;
+  /*! \brief The total latency of the op events, and the part of the ops with estimated work. */
+  uint64_t op_time = 0;
+  uint64_t estimated_op_time = 0;
+  /*! \brief The total estimated work of the op events. */
+  double gflops = 0;
+  double bytes = 0;
+  /*! \brief The ops of each type with estimated work, in descending order of their time. */
+  std::vector<OpUtilization> ops;
+};
+
+/*!
+ * \brief Relate the estimated work of the ops to their profiled latency.
+ * \param stats The collected profile stats. The op events are the events on a stream category and
+ * the CPU ops ("ComputationOperator").
+ * \param op_work The estimated work of the ops by the names of their events.
+ * \return The summary.
+ */
+UtilizationSummary AnalyzeUtilization(const std::vector<ProfileStat>& stats,
+                                      const std::unordered_map<std::string, OpWorkStat>& op_work);
+
 inline void ProfilerHelper::start() {
   if (dev_api_) {
     dev_api_->WaitDevice(device_);
@@ -245,10 +378,11 @@ inline void ProfilerHelper::stop() {
     dev_api_->WaitDevice(device_);
   }
   end_time_ = ProfileStat::NowInMicrosec();
+  collect();
 }
 
 inline void ProfilerHelper::collect() {
-  Profiler::Get()->AddNewProfileStat(categories_, name_, start_time_, end_time_, args);
+  Profiler::Get()->AddRecord({start_time_, end_time_, name_id_, category_id_, args_id_});
 }
 
 }  // namespace profiler
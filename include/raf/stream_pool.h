@@ -75,6 +75,39 @@ class StreamTagEnum : public EnumBase<StreamTagEnum, 16, int32_t, StreamTag> {
   ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 15, Reserved9, kReserved9, "Reserved for other devices");
 };
 
+/*!
+ * \brief The max number of communication streams. The first one is the stream of CudaCommunicate,
+ * and the others are the streams of the reserved tags.
+ */
+constexpr int kMaxCommStreams = 1 + kReserved9 - kReserved1 + 1;
+
+/*! \brief Get the index of the stream of a communication lane in [0, kMaxCommStreams). */
+inline int CommStreamIndex(int lane) {
+  return lane == 0 ? kCudaCommunicate : kReserved1 + lane - 1;
+}
+
+/*!
+ * \brief Get the communication lane of a stream index, or -1 if it is not a communication stream.
+ */
+inline int CommStreamLane(int64_t stream_idx) {
+  if (stream_idx == kCudaCommunicate) {
+    return 0;
+  }
+  if (stream_idx >= kReserved1 && stream_idx <= kReserved9) {
+    return stream_idx - kReserved1 + 1;
+  }
+  return -1;
+}
+
+/*! \brief The priority of the streams by default. */
+constexpr int kDefaultPriority = 0;
+/*!
+ * \brief The priority of the streams whose work should not be delayed by the other streams, e.g.,
+ * the communication and the critical path. Larger numbers are higher priorities, which are clamped
+ * to the range supported by the device.
+ */
+constexpr int kHighPriority = 1;
+
 class Stream;
 
 class Stream final {
@@ -91,7 +124,29 @@ class Stream final {
 
   void* data() const;
 
-  static std::shared_ptr<Stream> Get(const Device& dev, int tag_idx, int index);
+  /*!
+   * \brief Get a stream from the stream pool. The streams of different priorities are different
+   * streams even with the same tag and index.
+   * \param dev The device of the stream.
+   * \param tag_idx The tag of the stream.
+   * \param index The index of the stream among the ones of the same tag.
+   * \param priority The priority of the stream.
+   * \return The stream.
+   */
+  static std::shared_ptr<Stream> Get(const Device& dev, int tag_idx, int index,
+                                     int priority = kDefaultPriority);
+
+  /*!
+   * \brief Create a new stream that is not shared through the stream pool. The stream is freed
+   * when the returned object is destroyed.
+   * \param dev The device to create the stream on.
+   * \param priority The priority of the stream.
+   * \return The created stream.
+   */
+  static std::shared_ptr<Stream> Create(const Device& dev, int priority = kDefaultPriority);
+
+  /*! \brief The priority of the stream. */
+  int priority() const;
 
   void Wait() const;
 
@@ -0,0 +1,84 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file tuning_db.h
+ * \brief A tuning database in a single append-only log file, shared by processes.
+ */
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace raf {
+namespace op {
+
+/*!
+ * \brief A key-value database of tuning results. Each record is appended to a single log file;
+ * the whole log is indexed in memory by a hash map from the key to its latest value. Processes
+ * sharing the file see the records appended by each other, because a lookup miss reads the new
+ * tail of the log before giving up. A database pre-populated offline (e.g., shipped with a
+ * model) can be imported, so the tuning does not have to be repeated on every node.
+ *
+ * The values are expected to be small, e.g., the chosen algorithm of a kernel, and the keys
+ * should contain everything the value depends on, such as the device fingerprint.
+ */
+class TuningDatabase {
+ public:
+  /*!
+   * \brief Open the database at the given log file, which is created if it does not exist.
+   * \param path The log file path. An empty path means an in-memory database.
+   */
+  explicit TuningDatabase(const std::string& path);
+
+  /*!
+   * \brief The database used by the tuning caches. It is at $RAF_TUNING_DB if set, otherwise
+   * at $RAF_PERSIST_CACHE_PATH/tuning.db (~/.raf_cache/tuning.db by default) when
+   * RAF_PERSIST_CACHE=1, otherwise in memory. The colon-separated database files in
+   * $RAF_TUNING_DB_IMPORT are imported.
+   */
+  static TuningDatabase* Global();
+
+  /*! \brief Look up the key. Returns false if it is not found. */
+  bool Get(const std::string& key, std::string* value);
+
+  /*! \brief Insert or overwrite the key, and append the record to the log. */
+  void Put(const std::string& key, const std::string& value);
+
+  /*!
+   * \brief Import all records of another database file without appending them to this log.
+   * \return The number of imported records.
+   */
+  int64_t Import(const std::string& path);
+
+  /*! \brief The number of keys. */
+  size_t Size();
+
+  /*! \brief The log file path, which is empty for an in-memory database. */
+  const std::string& path() const {
+    return path_;
+  }
+
+ private:
+  /*!
+   * \brief Read the records in the file from the offset into the index, and advance the offset
+   * past the last complete record.
+   * \return The number of read records.
+   */
+  int64_t ReadLog(const std::string& path, int64_t* offset);
+
+  /*! \brief The log file path. */
+  std::string path_;
+  /*! \brief The offset in the log file up to which the records have been read. */
+  int64_t offset_ = 0;
+  /*! \brief The index from the key to the latest value. */
+  std::unordered_map<std::string, std::string> index_;
+  /*! \brief The thread-safe lock. */
+  std::mutex mu_;
+};
+
+}  // namespace op
+}  // namespace raf
@@ -64,6 +64,7 @@ enum class Opcode {
   // AllocADT = 25U,
   SetShape = 26U,
   Free = 27U,
+  KillRegister = 28U,
 
   // Invoke instructions
   InvokeFunc = 30U,
@@ -251,6 +252,8 @@ struct Instruction {
       Index device_id;
       /*! \brief The id of the target stream */
       Index stream_id;
+      /*! \brief The priority to create the stream with, or -1 to use the stream as is */
+      Index priority;
     } cuda_set_stream;
     struct /* CudaAddEvent and CudaWaitEvent Operands */ {
       /*! \brief The id of the event need to add or wait on current device */
@@ -413,6 +416,13 @@ struct Instruction {
    */
   static Instruction Free(RegName memory);
 
+  /*!
+   * \brief Release the value of a register after its last use.
+   * \param dst The register to release.
+   * \return The kill register instruction.
+   */
+  static Instruction KillRegister(RegName dst);
+
   /*!
    * \brief Construct an invoke JIT operator instruction.
    * \param op_reg The register containing the OpValue to invoke.
@@ -435,9 +445,10 @@ struct Instruction {
    * \brief Construct a CudaSetStream instruction.
    * \param device_id The id of device we want to set the stream on.
    * \param stream_id The id of target stream.
+   * \param priority The priority to create the stream with, or -1 to use the stream as is.
    * \return The set stream instruction.
    */
-  static Instruction CudaSetStream(Index device_id, Index stream_id);
+  static Instruction CudaSetStream(Index device_id, Index stream_id, Index priority = -1);
   /*!
    * \brief Construct a CudaAddEvent instruction.
    * \param event_id The id of event we would use to record.
@@ -26,6 +26,29 @@ using raf::registry::PackedFunc;
 
 struct VMFunction;
 
+/*!
+ * \brief A version of a function specialized to the static shapes of some of its parameters.
+ */
+struct ShapeBucket {
+  /*! \brief The index of the specialized function. */
+  Index func_index;
+  /*! \brief The indices of the parameters with static shapes. */
+  std::vector<int64_t> param_indices;
+  /*! \brief The static shapes of the parameters. */
+  std::vector<std::vector<int64_t>> shapes;
+};
+
+/*!
+ * \brief The work of an InvokeJit instruction estimated at compile time, which is related to the
+ * measured op latency by the profiler to report the FLOPs and memory bandwidth utilization.
+ */
+struct OpWorkEstimate {
+  /*! \brief The floating point operations in GFLOPs. */
+  double gflops;
+  /*! \brief The bytes of the inputs and outputs. */
+  double bytes;
+};
+
 /*!
  * \brief The executable emitted by the VM compiler.
  *
@@ -37,6 +60,8 @@ struct VMFunction;
  *  - Primitive name section, containing the function name of the primitive ops
  *  used by the virtual machine.
  *  - Code section, handling the VM functions and bytecode.
+ *  - Shape bucket section, mapping functions to their shape-specialized versions.
+ *  - Op work section, containing the estimated work of the InvokeJit instructions.
  */
 class Executable : public tvm::runtime::ModuleNode {
  public:
@@ -68,6 +93,19 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   static tvm::runtime::Module Load(const std::string& code, const tvm::runtime::Module lib);
 
+  /*!
+   * \brief Load the VM executable saved in a file by mapping the file into memory. The tensor
+   * constants are not copied but refer to the mapped file, so that they are only read from the
+   * disk when the virtual machine loads them to the device for the first time.
+   *
+   * \param path The path to the file of the saved executable.
+   * \param lib The compiled runtime library.
+   *
+   * \return exe The constructed executable.
+   */
+  static tvm::runtime::Module LoadFromFile(const std::string& path,
+                                           const tvm::runtime::Module lib);
+
   /*!
    * \brief Get the serialized form of the `functions`. This is
    * essentially bytecode serialization.
@@ -153,6 +191,13 @@ class Executable : public tvm::runtime::ModuleNode {
   std::unordered_map<std::string, Index> primitive_map;
   /*! \brief The virtual machine's function table. */
   std::vector<VMFunction> functions;
+  /*! \brief A mapping from the functions (as strings) to their shape-specialized versions. */
+  std::unordered_map<std::string, std::vector<ShapeBucket>> shape_buckets;
+  /*!
+   * \brief The estimated work of the InvokeJit instructions, keyed by the function name and the
+   * pc. It is only populated when raf.vm.estimate_op_work is enabled.
+   */
+  std::unordered_map<std::string, std::unordered_map<Index, OpWorkEstimate>> op_work;
 
  private:
   /*!
@@ -183,6 +228,20 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   void SaveCodeSection(dmlc::Stream* strm);
 
+  /*!
+   * \brief Save the shape buckets.
+   *
+   * \param strm The input stream.
+   */
+  void SaveShapeBucketSection(dmlc::Stream* strm);
+
+  /*!
+   * \brief Save the estimated op work.
+   *
+   * \param strm The input stream.
+   */
+  void SaveOpWorkSection(dmlc::Stream* strm);
+
   /*!
    * \brief Load the globals.
    *
@@ -211,6 +270,20 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   void LoadCodeSection(dmlc::Stream* strm);
 
+  /*!
+   * \brief Load the shape buckets.
+   *
+   * \param strm The input stream.
+   */
+  void LoadShapeBucketSection(dmlc::Stream* strm);
+
+  /*!
+   * \brief Load the estimated op work.
+   *
+   * \param strm The input stream.
+   */
+  void LoadOpWorkSection(dmlc::Stream* strm);
+
   /*! \brief The serialized bytecode. */
   std::string code_;
 };
@@ -8,7 +8,9 @@
  * \brief The values that are specific to VM.
  */
 #pragma once
+#include <future>
 #include "raf/ir.h"
+#include "raf/event_pool.h"
 #include "raf/memory_pool.h"
 #include "raf/value.h"
 
@@ -51,6 +53,8 @@ class StorageValueObj final : public ValueObj {
  public:
   /*! \brief The index into the VM function table. */
   std::shared_ptr<memory_pool::Memory> buffer;
+  /*! \brief The requested size of the buffer in bytes. -1 means unknown. */
+  int64_t size = -1;
 
   static constexpr const char* _type_key = "raf.value.vm.StorageValue";
   RAF_FINAL_OBJECT(StorageValueObj, ValueObj);
@@ -59,11 +63,47 @@ class StorageValueObj final : public ValueObj {
 /*! \brief reference to storage. */
 class StorageValue final : public Value {
  public:
-  static StorageValue make(std::shared_ptr<memory_pool::Memory> buffer);
+  static StorageValue make(std::shared_ptr<memory_pool::Memory> buffer, int64_t size = -1);
 
   RAF_MUTABLE_OBJECT_REF(StorageValue, Value, StorageValueObj);
 };
 
+/*!
+ * \brief An object representing the outputs of a VM execution that may still be computed on the
+ * device. The outputs are ready once the event is completed. With asynchronous dispatch, the value
+ * and the event are only set once the execution is launched by the dispatch thread.
+ */
+class FutureValueObj final : public ValueObj {
+ public:
+  /*! \brief The outputs, which must not be read before they are ready. */
+  Value value;
+  /*! \brief The device that computes the outputs. */
+  Device device;
+  /*! \brief The event recorded after the execution. nullptr if the outputs are ready. */
+  std::shared_ptr<event_pool::Event> event;
+  /*!
+   * \brief Completed once the execution is launched with asynchronous dispatch, which holds the
+   * error of the launch if any. Invalid if the execution was launched by the caller.
+   */
+  std::shared_future<void> launched;
+
+  /*! \brief Whether the outputs are ready, without blocking. */
+  bool IsReady() const;
+  /*! \brief Wait for the outputs to be ready and return them. */
+  Value Get() const;
+
+  static constexpr const char* _type_key = "raf.value.vm.FutureValue";
+  RAF_FINAL_OBJECT(FutureValueObj, ValueObj);
+};
+
+/*! \brief reference to future. */
+class FutureValue final : public Value {
+ public:
+  static FutureValue make(Value value, Device device, std::shared_ptr<event_pool::Event> event);
+
+  RAF_OBJECT_REF(FutureValue, Value, FutureValueObj);
+};
+
 }  // namespace vm
 }  // namespace executor
 }  // namespace  raf
@@ -9,8 +9,17 @@
  */
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -63,6 +72,11 @@ struct VMFunction {
   std::vector<Instruction> instructions;
   /*! \brief The size of the frame for this function */
   Index register_file_size;
+  /*!
+   * \brief The name of the IR variable bound to each register, for debugging and profiling. It is
+   * not serialized, so it is empty for a loaded executable.
+   */
+  std::unordered_map<Index, std::string> register_names;
 
   VMFunction(const std::string& name, std::vector<std::string> params,
              std::vector<Instruction> instructions, Index register_file_size)
@@ -110,6 +124,75 @@ struct VMFrame {
   }
 };
 
+/*!
+ * \brief The instruction counters of the executions of a context in the counter mode, which
+ * separate the host overheads of the VM from the device time. The counters are sized for the
+ * executable once so that counting does not allocate.
+ */
+struct VMCounters {
+  /*! \brief The number of opcodes. */
+  static constexpr int kNumOpcodes = static_cast<int>(Opcode::CudaStreamBarrier) + 1;
+  /*! \brief The execution count of each opcode. */
+  std::array<uint64_t, kNumOpcodes> opcode_counts{};
+  /*! \brief The execution count of each instruction, indexed by the function index and pc. */
+  std::vector<std::vector<uint64_t>> pc_counts;
+  /*! \brief The host time in nanoseconds spent in preparing OpEnvs (including JIT). */
+  uint64_t prepare_op_env_ns = 0;
+  /*! \brief The number of memory allocations and the host time in nanoseconds spent in them. */
+  uint64_t num_allocs = 0;
+  uint64_t alloc_ns = 0;
+  /*! \brief The host time in nanoseconds blocked in CudaWaitEvent and CudaStreamBarrier. */
+  uint64_t wait_event_ns = 0;
+  uint64_t stream_barrier_ns = 0;
+  /*! \brief The number of storages evicted and rematerialized by DTR. */
+  uint64_t num_dtr_evictions = 0;
+  uint64_t num_dtr_rematerializations = 0;
+
+  explicit VMCounters(const Executable* exec);
+  /*! \brief Count an executed instruction. */
+  inline void Count(Index func_index, Index pc, Opcode op) {
+    ++opcode_counts[static_cast<int>(op)];
+    ++pc_counts[func_index][pc];
+  }
+  /*! \brief Add the counters of another execution of the same executable. */
+  void Merge(const VMCounters& other);
+  /*! \brief Reset all counters to zero. */
+  void Clear();
+};
+
+/*!
+ * \brief The pre-bound execution of a context in the frozen mode, which is recorded from the first
+ * run of the context. The following runs execute the steps in order on the recorded values without
+ * interpreting the bytecode, looking up the OpEnvs or allocating the tensors.
+ */
+struct VMFrozenPlan {
+  /*! \brief A step executes an OpEnv, or replays a stream instruction if the OpEnv is null. */
+  struct Step {
+    OpEnvPtr op_env;
+    std::vector<Value> inputs;
+    Value output;
+    const Instruction* instr{nullptr};
+  };
+  /*! \brief The steps in the execution order. */
+  std::vector<Step> steps;
+  /*!
+   * \brief The buffers of the recorded values. They are kept resident even if the bytecode frees
+   * them, so that no one else can take the memory bound to the steps.
+   */
+  std::vector<std::shared_ptr<Memory>> buffers;
+  /*! \brief The return value of the recorded run, which is updated in place by the steps. */
+  Value ret;
+  /*! \brief Indicates whether the plan has been recorded. */
+  bool ready = false;
+};
+
+class DTRManager;
+class AsyncDispatcher;
+class OutputStager;
+
+/*! \brief The initial capacity of the frame stack of a context. */
+constexpr size_t kInitialFrameStackDepth = 16;
+
 /*!
  * \brief VMContextObj holds the runtime data for an execution in the VM.
  */
@@ -117,6 +200,11 @@ class VMContextObj : public ValueObj {
  public:
   /*! \brief The current stack of call frames. */
   std::vector<VMFrame> frames;
+  /*!
+   * \brief The popped frames of each function, whose register files are reused by the next calls
+   * of the function. Their constant registers are kept, while the other registers are cleared.
+   */
+  std::vector<std::vector<VMFrame>> recycled_frames;
   /*! \brief The fuction table index of the current function. */
   Index func_index{-1};
   /*! \brief The virtual machine PC. */
@@ -143,6 +231,49 @@ class VMContextObj : public ValueObj {
   Index current_device_id{0};
   /*! \brief The index of current working stream into cuda_streams. 0 indicates default stream. */
   Index current_stream_id{0};
+  /*!
+   * \brief The memory buffers whose release is deferred until the paired event (recorded on the
+   * stream that last used the buffer) completes. Only used in stream-ordered allocation mode.
+   */
+  std::vector<std::pair<std::shared_ptr<Event>, std::shared_ptr<Memory>>> deferred_releases;
+  /*! \brief The instruction counters of the execution, or nullptr if the counter mode is off. */
+  std::shared_ptr<VMCounters> counters;
+  /*! \brief The pre-bound execution in the frozen mode, or nullptr if the context is not frozen. */
+  std::shared_ptr<VMFrozenPlan> frozen_plan;
+  /*! \brief Whether the current call runs on a fork stream in fork/join mode. */
+  bool in_fork{false};
+  /*! \brief The number of frames right after the forked call is pushed, to find its return. */
+  size_t fork_frame_depth{0};
+  /*! \brief Whether to join the forks once the forked call returns. */
+  bool join_after_fork{false};
+  /*! \brief The event recorded on the parent stream before the first fork, waited by the forks. */
+  std::shared_ptr<Event> fork_event;
+  /*! \brief The events recorded at the returns of the forks, waited by the parent at the join. */
+  std::vector<std::shared_ptr<Event>> join_events;
+  /*!
+   * \brief The values and buffers released by the forks, which are kept until the join so that the
+   * other forks running concurrently cannot take their memory.
+   */
+  std::vector<Value> fork_values;
+  std::vector<std::shared_ptr<Memory>> fork_buffers;
+  /*! \brief The CPU lane of the ops issued since the last set_stream, or -1 outside a wave. */
+  Index cpu_lane{-1};
+  /*! \brief The ops issued to each CPU lane of the current wave, run at the end of the wave. */
+  std::vector<std::vector<std::function<void()>>> cpu_lanes;
+  /*! \brief The OpEnvs and buffers released in the current wave, kept until the lanes finish. */
+  std::vector<OpEnvPtr> cpu_wave_op_envs;
+  std::vector<std::shared_ptr<Memory>> cpu_wave_buffers;
+  /*! \brief The rematerialization of the storages in DTR mode, or nullptr if it is off. */
+  std::shared_ptr<DTRManager> dtr;
+  /*! \brief The stream capturing the CUDA graph of the execution, or nullptr if not capturing. */
+  void* capture_stream{nullptr};
+  /*! \brief The streams forked from the capture stream, which are joined back at the end. */
+  std::vector<void*> captured_streams;
+  /*!
+   * \brief The buffers allocated while capturing the CUDA graph. They are kept resident even if the
+   * bytecode frees them, since the replays of the graph use the same addresses.
+   */
+  std::vector<std::shared_ptr<Memory>> graph_buffers;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("func_index", &func_index);
@@ -169,7 +300,7 @@ class VMContext : public Value {
    * \param reg The register to read from.
    * \return The read object.
    */
-  inline Value ReadRegister(Index reg) const;
+  inline const Value& ReadRegister(Index reg) const;
   /*!
    * \brief Write to a VM register.
    * \param reg The register to write to.
@@ -201,6 +332,18 @@ class VMContext : public Value {
    * \param ret_reg The return register to write back in the caller.
    */
   inline void PushFrame(Index func_index, const std::vector<Value>& args, RegName ret_reg);
+  /*!
+   * \brief Push a call frame whose arguments are read from the registers of the current frame,
+   * without building the argument list.
+   * \param func_index The index of the VM function to invoke.
+   * \param free_vars The free variables of the invoked closure, which are the leading arguments,
+   * or nullptr.
+   * \param arg_regs The registers of the other arguments in the current frame.
+   * \param num_args The number of the other arguments.
+   * \param ret_reg The return register to write back in the caller.
+   */
+  inline void PushFrame(Index func_index, const Array<Value>* free_vars, const RegName* arg_regs,
+                        Index num_args, RegName ret_reg);
   /*!
    * \brief Pop a frame off the call stack.
    * \return The number of frnames left.
@@ -212,9 +355,47 @@ class VMContext : public Value {
 
 using OpEnvCache = MetaCache<OpEnvPtr>;
 
+/*!
+ * \brief A fixed-size binary signature of the dtypes and shapes of the non-constant arguments of an
+ * InvokeJit instruction. It is built from the registers and compared in place without any heap
+ * allocation. Signatures that do not fit are marked as overflowed and never match.
+ */
+struct OpEnvSignature {
+  static constexpr int kMaxWords = 64;
+  /*! \brief The encoded dtypes, ranks and dims. */
+  int64_t words[kMaxWords];
+  /*! \brief The number of used words. */
+  int size = 0;
+  /*! \brief The hash of all pushed words, which is compared first. */
+  size_t hash = 0;
+  /*! \brief Whether the signature has more words than kMaxWords. */
+  bool overflow = false;
+
+  inline void Push(int64_t word) {
+    if (size < kMaxWords) {
+      words[size++] = word;
+    } else {
+      overflow = true;
+    }
+    hash ^= std::hash<int64_t>()(word) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  }
+
+  inline bool Matches(const OpEnvSignature& other) const {
+    return !overflow && !other.overflow && hash == other.hash && size == other.size &&
+           std::memcmp(words, other.words, size * sizeof(int64_t)) == 0;
+  }
+};
+
 /*! \brief The OpEnv cache for a VM function. */
 class VMFuncOpEnvCache {
  public:
+  VMFuncOpEnvCache() = default;
+  /*!
+   * \brief Create the OpEnv cache for a VM function. The caches for all InvokeJit instructions are
+   * created ahead of time, so that they can be looked up without locking.
+   * \param func The VM function.
+   */
+  explicit VMFuncOpEnvCache(const VMFunction& func);
   /*!
    * \brief Get the OpEnv cache for a given instruction.
    * \param pc The program counter
@@ -222,18 +403,184 @@ class VMFuncOpEnvCache {
    */
   std::shared_ptr<OpEnvCache> Get(Index pc);
 
+  /*!
+   * \brief Get the OpEnv cache pre-created for a given instruction, whose address stays valid as
+   * long as this cache.
+   * \param pc The program counter.
+   * \return The OpEnv cache, or nullptr if the instruction is not an InvokeJit instruction.
+   */
+  OpEnvCache* GetPreCreated(Index pc) const;
+
+  /*!
+   * \brief Look up the OpEnv of the previous invocation of a given instruction.
+   * \param pc The program counter.
+   * \param signature The signature of the current invocation.
+   * \param key If not null, it is set to the string key of the OpEnv on hit.
+   * \return The OpEnv if the signature matches the previous invocation, or nullptr otherwise.
+   */
+  OpEnvPtr GetLast(Index pc, const OpEnvSignature& signature, std::string* key = nullptr);
+
+  /*!
+   * \brief Record the OpEnv of the latest invocation of a given instruction.
+   * \param pc The program counter.
+   * \param signature The signature of the invocation.
+   * \param op_env The OpEnv.
+   * \param key The string key of the OpEnv in the OpEnv cache.
+   */
+  void SetLast(Index pc, const OpEnvSignature& signature, const OpEnvPtr& op_env,
+               const std::string& key);
+
   /*!
    * \brief Clear the OpEnv cache.
    */
   void Clear();
 
  private:
+  /*! \brief The OpEnv of the previous invocation of an instruction. */
+  struct LastOpEnv {
+    std::mutex mu;
+    OpEnvSignature signature;
+    OpEnvPtr op_env;
+    std::string key;
+  };
+
+  /*! \brief The previous invocations indexed by the instruction index. */
+  std::vector<std::unique_ptr<LastOpEnv>> pc_last_;
+  /*!
+   * \brief The pre-created OpEnv caches indexed by the instruction index. They are read without
+   * locking, so the pointers are never reassigned after construction.
+   */
+  std::vector<std::shared_ptr<OpEnvCache>> pc_caches_;
   /*! \brief Cache map from instruction index to OpEnv cache. */
   std::unordered_map<Index, std::shared_ptr<OpEnvCache>> cache_map_;
   /*! \brief The mutex for the cache_map_. */
   std::mutex mu_;
 };
 
+/*!
+ * \brief A non-blocking pool of VM contexts to be recycled across executions. Each slot is claimed
+ * with an atomic exchange, so the threads never wait for each other and a busy slot is skipped.
+ */
+class VMContextPool {
+ public:
+  explicit VMContextPool(size_t capacity);
+  /*!
+   * \brief Take a context that was created for the given function from the pool.
+   * \param func_index The entry function index.
+   * \return The context, or an undefined context if there is none.
+   */
+  VMContext Acquire(Index func_index);
+  /*!
+   * \brief Put a context into the pool. It is dropped if the pool is full.
+   * \param ctx The context to be recycled.
+   */
+  void Release(VMContext ctx);
+
+ private:
+  struct Slot {
+    /*! \brief Whether the slot is being accessed by a thread. */
+    std::atomic<bool> busy{false};
+    /*! \brief The recycled context, which is undefined if the slot is empty. */
+    VMContext ctx;
+  };
+  /*! \brief The slots of the pool. */
+  std::unique_ptr<Slot[]> slots_;
+  /*! \brief The number of slots. */
+  size_t capacity_;
+};
+
+/*!
+ * \brief The constants of an executable materialized on a device, which are shared by all the
+ * virtual machines running the executable on the device.
+ *
+ * The tensor constants are uploaded in the background on a dedicated memory copy stream, so that
+ * the uploading overlaps with the first executions. A constant that is loaded before it is
+ * uploaded is materialized by the loading thread instead.
+ *
+ * On a multi-socket host, the CPU constants can be replicated to each NUMA node that runs them, so
+ * that the kernels do not read the weights from the memory of a remote node.
+ *
+ * On a CUDA device, the tensor constants can be exported to the other processes running the same
+ * executable on the same GPU with a CUDA IPC handle, which import them instead of uploading their
+ * own copies, so each extra process only takes the memory of its activations.
+ */
+class DeviceConstantPool {
+ public:
+  DeviceConstantPool(tvm::runtime::Module exec, const Device& dev);
+  ~DeviceConstantPool();
+  /*!
+   * \brief Get the constant pool of the executable on the device. The pool is created if no
+   * virtual machine holds it.
+   * \param exec The executable.
+   * \param dev The device.
+   * \return The constant pool.
+   */
+  static std::shared_ptr<DeviceConstantPool> Get(const Executable* exec, const Device& dev);
+  /*! \brief Start uploading the constants in the background, if it is not started yet. */
+  void Prefetch();
+  /*!
+   * \brief Get the materialized constant, which waits for the constant being uploaded.
+   * \param const_index The index of the constant.
+   * \return The constant on the device.
+   */
+  Value Get(Index const_index);
+  /*!
+   * \brief Get the replica of a CPU constant on a NUMA node, which is created on the first use.
+   * \param const_index The index of the constant.
+   * \param node The NUMA node.
+   * \return The constant in the memory of the node.
+   */
+  Value GetReplica(Index const_index, int node);
+  /*!
+   * \brief Upload the compact tensor constants into a single device buffer, which is used by the
+   * pool from now on, and export it to the other processes. The buffer must stay alive (i.e., the
+   * exporting process must not exit) as long as the other processes use the constants.
+   * \return The serialized IPC handle with the locations of the constants in the buffer.
+   */
+  std::string ExportIpc();
+  /*!
+   * \brief Use the tensor constants exported by another process, which are read-only and not
+   * copied. The constants that are not exported are materialized as usual.
+   * \param handle The serialized IPC handle returned by ExportIpc of the other process.
+   */
+  void ImportIpc(const std::string& handle);
+
+ private:
+  /*! \brief The state of a constant. */
+  enum State : uint8_t { kPending, kUploading, kReady };
+  /*! \brief The loop of the background thread that uploads the constants in order. */
+  void PrefetchLoop();
+  /*!
+   * \brief Stop the background uploading and wait for the constants being uploaded by the other
+   * threads, so that the constants can be replaced.
+   * \param lock The lock on mu_, which is held on return.
+   */
+  void StopUploading(std::unique_lock<std::mutex>* lock);
+
+  /*! \brief The executable, which is kept alive by the pool. */
+  tvm::runtime::Module exec_module_;
+  /*! \brief The executable. */
+  const Executable* exec_;
+  /*! \brief The device of the pool. */
+  Device dev_;
+  /*! \brief The materialized constants. */
+  std::vector<Value> values_;
+  /*! \brief The states of the constants. */
+  std::vector<State> states_;
+  /*! \brief The replicas of the constants on each NUMA node. */
+  std::vector<std::vector<Value>> replicas_;
+  /*! \brief The serialized IPC handle if the constants are shared across processes. */
+  std::string ipc_handle_;
+  /*! \brief Whether the pool is being destroyed, or the background uploading is stopped. */
+  bool stop_ = false;
+  /*! \brief The mutex for the constants and their states. */
+  std::mutex mu_;
+  /*! \brief The condition variable to notify the constants being ready. */
+  std::condition_variable cv_;
+  /*! \brief The background thread to upload the constants. */
+  std::thread prefetcher_;
+};
+
 /*!
  * \brief The virtual machine.
  *
@@ -247,19 +594,82 @@ class VMFuncOpEnvCache {
  */
 class VirtualMachine : public tvm::runtime::ModuleNode {
  public:
-  VirtualMachine(bool enable_cuda_graph, bool dryrun)
-      : exec_(nullptr), dryrun_(dryrun), enable_cuda_graph_(enable_cuda_graph) {
+  VirtualMachine(bool enable_cuda_graph, bool dryrun, bool stream_ordered_alloc = false,
+                 bool threaded_dispatch = false, bool serving_mode = false,
+                 bool persistent_storage = false, bool frozen = false, bool fork_join = false,
+                 int64_t dtr_budget = 0, bool async_dispatch = false, bool host_outputs = false)
+      : exec_(nullptr),
+        dryrun_(dryrun),
+        enable_cuda_graph_(enable_cuda_graph),
+        stream_ordered_alloc_(stream_ordered_alloc),
+        threaded_dispatch_(threaded_dispatch),
+        serving_mode_(serving_mode),
+        persistent_storage_(persistent_storage),
+        frozen_(frozen),
+        fork_join_(fork_join),
+        dtr_budget_(dtr_budget),
+        async_dispatch_(async_dispatch),
+        host_outputs_(host_outputs) {
 #ifndef RAF_USE_CUDA
     if (enable_cuda_graph) {
       LOG(WARNING) << "Because CUDA is not enabled in RAF, CUDA graph will be disabled in the VM.";
       enable_cuda_graph_ = false;
     }
+    stream_ordered_alloc_ = false;
+    fork_join_ = false;
+    host_outputs_ = false;
 #endif
     if (enable_cuda_graph_) {
       LOG(WARNING) << "Concurrent execution is not supported for VM in CUDA graph mode.";
+      if (stream_ordered_alloc_) {
+        LOG(WARNING) << "Stream-ordered allocation is disabled in CUDA graph mode.";
+        stream_ordered_alloc_ = false;
+      }
+      if (serving_mode_) {
+        LOG(WARNING) << "Serving mode is disabled in CUDA graph mode.";
+        serving_mode_ = false;
+      }
+      if (frozen_) {
+        LOG(WARNING) << "Frozen mode is disabled in CUDA graph mode.";
+        frozen_ = false;
+      }
+      if (fork_join_) {
+        LOG(WARNING) << "Fork/join mode is disabled in CUDA graph mode.";
+        fork_join_ = false;
+      }
+      if (host_outputs_) {
+        LOG(WARNING) << "Host outputs are disabled in CUDA graph mode.";
+        host_outputs_ = false;
+      }
+    }
+    if (fork_join_ && (serving_mode_ || frozen_)) {
+      LOG(WARNING) << "Fork/join mode is disabled in serving mode and frozen mode.";
+      fork_join_ = false;
+    }
+    if (frozen_ && (serving_mode_ || dryrun_)) {
+      LOG(WARNING) << "Frozen mode is disabled in serving mode and dryrun mode.";
+      frozen_ = false;
+    }
+    if (dtr_budget_ > 0 && (enable_cuda_graph_ || dryrun_ || stream_ordered_alloc_ ||
+                            serving_mode_ || frozen_ || fork_join_)) {
+      LOG(WARNING) << "DTR is disabled in CUDA graph, dryrun, stream-ordered allocation, serving, "
+                   << "frozen and fork/join modes.";
+      dtr_budget_ = 0;
+    }
+    if (async_dispatch_ && (enable_cuda_graph_ || serving_mode_ || frozen_)) {
+      LOG(WARNING) << "Asynchronous dispatch is disabled in CUDA graph, serving and frozen modes.";
+      async_dispatch_ = false;
+    }
+    if (serving_mode_) {
+      context_pool_ = std::make_unique<VMContextPool>(kServingContextPoolSize);
     }
   }
 
+  ~VirtualMachine() {
+    // Launch the pending executions before the states they use are destroyed.
+    async_dispatcher_ = nullptr;
+  }
+
   const char* type_key() const final {
     return "VirtualMachine";
   }
@@ -302,9 +712,47 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
   /*!
    * \brief Run the virtual machine.
    * \param ctx The runtime context.
+   * \param future Whether to return a FutureValue right after the kernels are issued, instead of
+   * waiting for the outputs in the serving mode.
    * \return The return value.
    */
-  Value Run(VMContext ctx);
+  Value Run(VMContext ctx, bool future = false);
+  /*!
+   * \brief Submit an execution to the dispatch thread in asynchronous dispatch mode. The
+   * executions are launched in the order they are submitted.
+   * \param ctx The runtime context, which must not be reused before the execution is launched.
+   * \return The future of the outputs, which is returned before the execution is launched.
+   */
+  FutureValue RunAsync(VMContext ctx);
+  /*!
+   * \brief Run the function for multiple steps with the same context, so that the inputs other
+   * than the batches (e.g., the parameters and the optimizer states) stay bound to the context
+   * without preparing a context for each step. Before each step, the inputs at the batch indices
+   * are rebound to the next batch. Note that in the CUDA graph and frozen modes, the outputs of
+   * the steps share the same buffers.
+   * \param ctx The runtime context prepared with the inputs of the first step.
+   * \param num_steps The number of steps.
+   * \param batch_indices The indices of the inputs to rebind at each step.
+   * \param fnext The function returning the next batch as an array of values, e.g., the pop
+   * function of InputPrefetcher. If it is null, the steps run on the same inputs.
+   * \return The outputs of the steps.
+   */
+  Array<Value> RunSteps(VMContext ctx, int num_steps, const std::vector<int>& batch_indices,
+                        const PackedFunc& fnext);
+  /*!
+   * \brief Reset a VM runtime context after an execution and rebind its inputs in place, so that
+   * the context, including its register files and constant registers, is reused by the next
+   * execution of the same function.
+   * \param ctx The runtime context, which should not be running.
+   * \param inputs The new inputs to the function.
+   */
+  void ResetVMContext(VMContext ctx, const std::vector<Value>& inputs);
+  /*!
+   * \brief Recycle a VM runtime context after the execution in serving mode, so that its
+   * registers, stream and events can be reused by the following executions.
+   * \param ctx The runtime context, which should not be used after this call.
+   */
+  void ReleaseVMContext(VMContext ctx);
   /*!
    * \brief Profile the end-to-end execution latency using virtual machine.
 
@@ -334,6 +782,54 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * \return A list of latency numbers in milliseconds (length of the list equals 'repeat').
    */
   Array<FloatValue> Profile(VMContext ctx, int warmup, int number, int repeat);
+  /*!
+   * \brief Turn on or off the counter mode, in which the executions count each instruction and the
+   * host time of preparing OpEnvs, allocations and stream synchronizations. The counters of each
+   * execution are accumulated to the VM after it finishes. The instructions replayed from CUDA
+   * graphs are not counted.
+   * \param enabled Whether to turn on the counter mode.
+   */
+  void EnableCounters(bool enabled);
+  /*!
+   * \brief Get the accumulated counters since the last reset.
+   * \return The counters, including "opcode_counts" (opcode name to count), "pc_counts" (the
+   * executed instructions with their function name, pc, text and count), and the host time
+   * "prepare_op_env_us", "alloc_us", "wait_event_us" and "stream_barrier_us" with "num_allocs".
+   */
+  Map<String, ObjectRef> GetCounters();
+  /*! \brief Reset the accumulated counters. */
+  void ResetCounters();
+  /*!
+   * \brief Turn on or off allocating the runs of consecutive AllocStorage instructions with one
+   * Memory::AllocBatch call. It is on by default, and should only be switched between executions.
+   * \param enabled Whether to allocate the storages in batches.
+   */
+  void EnableAllocBatching(bool enabled);
+  /*!
+   * \brief Get the batched allocations found in the loaded executable.
+   * \return The runs of AllocStorage instructions, each as (function index, pc, count).
+   */
+  std::vector<std::tuple<Index, Index, Index>> GetAllocBatches() const;
+  /*!
+   * \brief Export the constants on the device to the other processes with CUDA IPC. See
+   * DeviceConstantPool::ExportIpc.
+   * \return The serialized IPC handle.
+   */
+  std::string ExportConstants();
+  /*!
+   * \brief Use the constants exported by another process instead of uploading them. It is applied
+   * to the device set by SetDevices, before the constants are uploaded if called before that.
+   * \param handle The serialized IPC handle returned by ExportConstants of the other process.
+   */
+  void ImportConstants(const std::string& handle);
+  /*!
+   * \brief Attribute the memory allocated by the runs of this VM to the tenant, whose reservation
+   * and quota are configured in the memory pool. See memory_pool::TenantScope.
+   * \param tenant The name of the tenant. The empty name is the default tenant.
+   */
+  void SetTenant(const std::string& tenant) {
+    tenant_ = tenant;
+  }
 
  protected:
   /*! \brief Get device for params. */
@@ -350,11 +846,202 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
   inline std::shared_ptr<Memory> Alloc(const VMContext& ctx, Device dev, int64_t nbytes,
                                        int64_t alignment = kDefaultMemoryAlignment,
                                        bool alloc_async = true) const;
+  /*!
+   * \brief Release a memory buffer that may still be used by kernels launched on the current
+   * stream. In stream-ordered allocation mode, the release is ordered after the pending workloads
+   * on the current stream, either by letting the allocation stream wait for them (so that
+   * cudaFreeAsync happens afterwards) or by deferring the release until an event completes.
+   * Otherwise, the buffer is released immediately.
+   * \param ctx The VM context.
+   * \param mem The memory buffer to release. It is reset after this call.
+   */
+  void ReleaseMemory(const VMContext& ctx, std::shared_ptr<Memory>* mem);
+  /*! \brief Release a non-null memory buffer without recording it to the memory profiler. */
+  void ReleaseMemoryImpl(const VMContext& ctx, std::shared_ptr<Memory>* mem);
+  /*!
+   * \brief Record an allocation to the memory profiler. The allocation is named after the IR
+   * variable bound to the destination register of the current instruction.
+   * \param ctx The VM context.
+   * \param mem The allocated memory buffer.
+   * \param nbytes The number of bytes.
+   */
+  void ProfileAllocation(const VMContext& ctx, const std::shared_ptr<Memory>& mem,
+                         int64_t nbytes) const;
+  /*!
+   * \brief Release the deferred memory buffers whose events have completed.
+   * \param ctx The VM context.
+   * \param wait Whether to block until all deferred memory buffers can be released.
+   */
+  void ReclaimDeferredMemory(const VMContext& ctx, bool wait);
+  /*!
+   * \brief Get a CUDA workspace of at least the given size from the persistent workspace arena of
+   * the current stream. The arena only grows when a larger workspace is requested, so there is no
+   * allocation in steady state.
+   * \param ctx The VM context.
+   * \param dev The device of the workspace.
+   * \param nbytes The number of bytes.
+   * \return The pointer to the workspace.
+   */
+  void* GetWorkspaceFromArena(const VMContext& ctx, Device dev, int64_t nbytes);
+  /*!
+   * \brief Find the storages of each VM function that are never freed in the function (e.g., the
+   * gradients and the updated optimizer states returned by a training step). Their buffers are
+   * kept resident and reused across executions when persistent_storage_ is enabled.
+   */
+  void InitPersistentStorages();
+  /*!
+   * \brief Get the persistent buffer allocated by the current AllocStorage instruction. The buffer
+   * of the previous execution is reused if it is no longer referenced by anyone else.
+   * \param ctx The VM context.
+   * \param dev The device of the buffer.
+   * \param nbytes The number of bytes.
+   * \param alignment The alignment of the buffer.
+   * \return The buffer, or nullptr if the storage is not persistent.
+   */
+  std::shared_ptr<Memory> GetPersistentBuffer(const VMContext& ctx, Device dev, int64_t nbytes,
+                                              int64_t alignment);
+  /*!
+   * \brief Find the runs of consecutive AllocStorage instructions of each VM function that
+   * allocate on the same device with the same alignment, which are allocated by one
+   * Memory::AllocBatch call. The persistent storages and the asynchronous CUDA allocations are
+   * excluded, as they are allocated differently.
+   */
+  void InitAllocBatches();
+  /*!
+   * \brief Allocate the storages of the run of AllocStorage instructions at the current pc, and
+   * advance the pc past them.
+   * \param ctx The VM context.
+   * \param count The number of the instructions in the run.
+   */
+  void AllocStorageBatch(VMContext& ctx, Index count);
+  /*! \brief Rebind an input of a prepared context to the given value. */
+  void RebindInput(VMContext& ctx, int index, const Value& value);
+  /*!
+   * \brief Wrap the outputs of an execution with an event recorded on the given stream, which
+   * completes once the execution is finished.
+   * \param ctx The runtime context.
+   * \param stream The stream of the execution, or nullptr for the legacy default stream.
+   * \param event The event to wait for instead, e.g., the one after the copies of the host outputs.
+   * \return The future of the outputs.
+   */
+  FutureValue MakeFutureValue(const VMContext& ctx, void* stream,
+                              std::shared_ptr<event_pool::Event> event = nullptr);
+  /*!
+   * \brief Find the function calls that can be forked in fork/join mode. A run of calls is forked
+   * if none of them reads the results of the others, and only host instructions (e.g., closure
+   * allocations and moves) that do not read the results are in between. The forks are joined once
+   * the last call of the run returns.
+   */
+  void BuildForkPlan();
+  /*!
+   * \brief Push a call frame on a fork stream if the current call instruction is forkable.
+   * \param ctx The VM context.
+   * \param func_index The index of the callee.
+   * \param args The arguments of the callee.
+   * \param dst The register to write the return value.
+   * \return Whether the call has been forked. If not, the frame should be pushed as usual.
+   */
+  bool ForkCall(VMContext& ctx, Index func_index, const std::vector<Value>& args, RegName dst);
+  /*!
+   * \brief Return from a forked call: record its join event on the fork stream and switch back to
+   * the parent stream, joining all the forks if it is the last of the run.
+   * \param ctx The VM context.
+   * \param ret_val The return value of the forked call.
+   */
+  void ReturnFromFork(VMContext& ctx, const Value& ret_val);
+  /*! \brief Let the parent stream wait for all the forks and release what they kept. */
+  void JoinForks(VMContext& ctx);
+  /*!
+   * \brief Bring a stream into the CUDA graph capture of the context by letting it wait for the
+   * capture stream, unless it is captured already or the context is not capturing.
+   * \param ctx The VM context.
+   * \param stream The stream to be used by the next instruction.
+   */
+  void ForkCaptureStream(const VMContext& ctx, void* stream);
+  /*! \brief Let the capture stream wait for all the streams forked from it. */
+  void JoinCaptureStreams(const VMContext& ctx);
+  /*!
+   * \brief Run the CPU ops issued to the lanes of the current wave concurrently, and release the
+   * workspaces and buffers kept for them. On CPU, the streams of a wavefront schedule are lanes
+   * whose ops are deferred until the end of the wave, which is the next stream barrier or any
+   * instruction that needs the results on the host.
+   */
+  void RunCpuLanes(VMContext& ctx);
   /*! \brief Run VM dispatch loop. */
   virtual void RunLoop(VMContext& ctx);
-  /*! \brief Prepare an OpEnv with its inputs and output */
+  /*!
+   * \brief Run the VM dispatch loop with direct threading over the pre-decoded instructions.
+   * The instruction profiling is skipped in this loop.
+   */
+  void RunThreadedLoop(VMContext& ctx);
+#ifdef RAF_USE_CUDA
+  /*!
+   * \brief Find the static segments of the executable that can be captured as CUDA graphs. This
+   * is only used when CUDA graph is enabled but the executable has control flow or dynamic shapes,
+   * so that the whole function cannot be captured.
+   */
+  void BuildCudaGraphSegments();
+  /*!
+   * \brief Run the static segment starting at the current instruction by replaying its CUDA graph.
+   * The graph is captured when the segment is executed the second time with the same buffers.
+   * \param ctx The VM context.
+   * \return Whether the segment has been executed. If not, the instructions should be executed
+   * as usual.
+   */
+  bool RunCudaGraphSegment(VMContext& ctx);
+#endif
+  /*!
+   * \brief Prepare an OpEnv with its inputs and output. The OpEnv of the previous invocation is
+   * reused if the binary shape signature matches, in which case the returned string key is only
+   * generated when profiling.
+   */
   virtual std::tuple<OpEnvPtr, std::vector<Value>, Value, std::string> PrepareOpEnv(
       const VMContext& ctx, const Instruction& instr);
+  /*! \brief The operands of an InvokeJit instruction that are resolved from its location. */
+  struct JitOperands {
+    /*! \brief The OpEnv cache of the function. */
+    VMFuncOpEnvCache* func_op_env_cache = nullptr;
+    /*! \brief The OpEnv cache of the instruction, or nullptr to look it up. */
+    OpEnvCache* op_env_cache = nullptr;
+    /*! \brief The lock to serialize the executions of the instruction in serving mode. */
+    std::mutex* op_env_lock = nullptr;
+  };
+  /*! \brief Resolve the operands of the InvokeJit instruction at the given location. */
+  JitOperands ResolveJitOperands(Index func_index, Index pc);
+  /*! \brief Prepare an OpEnv like PrepareOpEnv, with the resolved operands of the instruction. */
+  std::tuple<OpEnvPtr, std::vector<Value>, Value, std::string> PrepareJitOpEnv(
+      const VMContext& ctx, const Instruction& instr, const JitOperands& operands);
+  /*! \brief Execute an InvokeJit instruction with its resolved operands. */
+  void InvokeJit(VMContext& ctx, const Instruction& instr, const JitOperands& operands);
+  /*! \brief Allocate the workspace requested by an OpEnv. */
+  void PrepareWorkspace(const VMContext& ctx, const OpEnvPtr& op_env);
+  /*! \brief Release the workspace allocated for an OpEnv outside the workspace arena. */
+  void ReleaseWorkspace(const VMContext& ctx, const OpEnvPtr& op_env);
+  /*!
+   * \brief Get or create the frozen context of a function for the input shapes. The inputs are
+   * copied into the buffers owned by the context, which are bound to the recorded steps.
+   * \param func_index The function index.
+   * \param inputs The inputs.
+   * \return The frozen context, or an undefined context if any input is not a tensor.
+   */
+  VMContext PrepareFrozenContext(Index func_index, const std::vector<Value>& inputs);
+  /*!
+   * \brief Record an executed instruction to the frozen plan of the context, if it is being
+   * recorded.
+   * \param ctx The VM context.
+   * \param instr The instruction.
+   * \param op_env The OpEnv of an InvokeJit instruction, or nullptr for a stream instruction.
+   * \param inputs The inputs of the OpEnv.
+   * \param output The output of the OpEnv.
+   */
+  void RecordFrozenStep(const VMContext& ctx, const Instruction& instr,
+                        const OpEnvPtr& op_env = nullptr, const std::vector<Value>& inputs = {},
+                        const Value& output = Value());
+  /*!
+   * \brief Run a frozen context. The first run interprets the bytecode and records the steps,
+   * and the following runs execute the recorded steps only, unless they are profiled or counted.
+   */
+  void RunFrozenPlan(VMContext& ctx);
   /*! \brief Handle Move instruction*/
   virtual void HandleMove(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle LoadConst instruction*/
@@ -377,6 +1064,8 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
   virtual void HandleAllocClosure(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle Free instruction*/
   virtual void HandleFree(VMContext& ctx, const Instruction& instr);
+  /*! \brief Handle KillRegister instruction*/
+  virtual void HandleKillRegister(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle InvokeFunc instruction*/
   virtual void HandleInvokeFunc(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle InvokeClosure instruction*/
@@ -412,17 +1101,186 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * object to avoid rellocation of constants during inference.
    */
   std::vector<Value> const_pool_;
+  /*! \brief The constants on the device shared with the other VMs running the same executable. */
+  std::shared_ptr<DeviceConstantPool> device_constants_;
+  /*! \brief The IPC handle of the constants exported by another process, or empty. */
+  std::string ipc_constants_;
+  /*! \brief The memory pool tenant of the runs of this VM. */
+  std::string tenant_;
   /*!
    * \brief OpEnv cache. Each element in the vector stores the cache for the
    * corresponding VM function. It's a map from pc to the OpEnv cache.
    */
   std::vector<std::shared_ptr<VMFuncOpEnvCache>> op_env_cache_;
+  /*! \brief A persistent workspace that is shared by the ops launched on the same stream. */
+  struct WorkspaceArena {
+    /*! \brief The memory of the arena. */
+    std::shared_ptr<Memory> memory;
+    /*! \brief The size of the arena in bytes. */
+    int64_t nbytes = 0;
+  };
+  /*!
+   * \brief The persistent CUDA workspace arenas keyed by (device type, device id, stream). Each
+   * stream has its own arena, because ops on the same stream are serialized and can safely reuse
+   * the same workspace.
+   */
+  std::map<std::tuple<int, int, void*>, WorkspaceArena> workspace_arenas_;
+  /*! \brief The maximum workspace size (in bytes) required by a single OpEnv so far. */
+  int64_t max_workspace_nbytes_ = 0;
+  /*! \brief The mutex to access the workspace arenas. */
+  std::mutex workspace_mutex_;
+  /*!
+   * \brief A pre-decoded instruction for the threaded dispatch loop, with the operands that do not
+   * depend on the context resolved ahead of time. The registers are not resolved, since the
+   * register files belong to the frames of a context.
+   */
+  struct DecodedInstruction {
+    /*! \brief The address of the instruction handler in the dispatch loop. */
+    const void* handler;
+    /*! \brief The decoded instruction. */
+    const Instruction* instr;
+    /*! \brief The resolved operands of an InvokeJit instruction. */
+    JitOperands jit;
+  };
+  /*! \brief The pre-decoded instructions of each VM function. */
+  std::vector<std::vector<DecodedInstruction>> decoded_code_;
+  /*! \brief The flag to decode the instructions only once. */
+  std::once_flag decode_once_;
   /*! \brief Indicates whether to dryrun (skip op execution). */
   bool dryrun_ = false;
   /*! \brief Indicates whether CUDA is used. */
   bool use_cuda_ = false;
   /*! \brief Indicates whether CUDA Graph is enabled when VM is initialized. */
   bool enable_cuda_graph_ = false;
+  /*!
+   * \brief Indicates whether to allocate and free memory in the order of the stream that uses it,
+   * so that multi-stream schedules can safely reuse memory without device synchronization.
+   */
+  bool stream_ordered_alloc_ = false;
+  /*!
+   * \brief Indicates whether to use the threaded dispatch loop when the instructions are not
+   * being profiled.
+   */
+  bool threaded_dispatch_ = false;
+  /*!
+   * \brief Indicates whether the VM is driven by multiple threads concurrently. In this mode, each
+   * context launches kernels to its own stream, and contexts are recycled through a pool.
+   */
+  bool serving_mode_ = false;
+  /*!
+   * \brief Indicates whether to keep the buffers of the storages that outlive an execution resident
+   * across executions, so that the steady state training step does not allocate them again.
+   * Note that the outputs of an execution may be overwritten by the next execution once the user
+   * releases them.
+   */
+  bool persistent_storage_ = false;
+  /*!
+   * \brief Indicates whether to record the kernels of the first execution with each function and
+   * input shapes, and replay them on the pre-bound tensors afterwards. It only applies to the
+   * executables without control flow or dynamic shapes. Note that the outputs of an execution are
+   * overwritten by the next execution with the same input shapes.
+   */
+  bool frozen_ = false;
+  /*!
+   * \brief Indicates whether to launch the independent function calls (e.g., the sub-models of an
+   * ensemble after LambdaLift) on separate streams, and join them with events.
+   */
+  bool fork_join_ = false;
+  /*!
+   * \brief The budget in bytes of the storages allocated by an execution in DTR mode, in which the
+   * storages over the budget are evicted and recomputed from their lineage once accessed. 0 means
+   * DTR is off. It only applies to single-stream executions.
+   */
+  int64_t dtr_budget_ = 0;
+  /*!
+   * \brief Indicates whether the executions are launched in order by a dedicated host thread, so
+   * that the caller gets the futures of the outputs before the kernels are launched.
+   */
+  bool async_dispatch_ = false;
+  /*! \brief The max number of executions waiting to be launched in asynchronous dispatch mode. */
+  static constexpr int kAsyncDispatchDepth = 2;
+  /*! \brief The dispatcher of the executions in asynchronous dispatch mode. */
+  std::shared_ptr<AsyncDispatcher> async_dispatcher_;
+  /*!
+   * \brief Indicates whether the outputs are copied to pinned host memory on the device-to-host
+   * copy stream as soon as the execution is issued, so that the caller gets host tensors, and the
+   * copies overlap with the following executions. It only applies to the CUDA devices.
+   */
+  bool host_outputs_ = false;
+  /*! \brief The number of executions whose outputs are staged at the same time. */
+  static constexpr int kOutputStagingDepth = 4;
+  /*! \brief The stager of the host outputs. */
+  std::shared_ptr<OutputStager> output_stager_;
+  /*! \brief The fork plans of the instructions. */
+  static constexpr int8_t kNoFork = 0;
+  static constexpr int8_t kFork = 1;
+  static constexpr int8_t kForkAndJoin = 2;
+  /*!
+   * \brief The stream ids of the fork streams start from this one, above the stream ids used by the
+   * stream schedules, and the forks of a run take the fork streams in turn.
+   */
+  static constexpr Index kForkStreamIdBase = 64;
+  static constexpr Index kNumForkStreams = 8;
+  /*!
+   * \brief The fork plan of each instruction of each function in fork/join mode, which is one of
+   * kNoFork, kFork and kForkAndJoin.
+   */
+  std::vector<std::vector<int8_t>> fork_plan_;
+  /*! \brief Whether each function switches streams by itself, so that it cannot be forked. */
+  std::vector<bool> func_uses_streams_;
+  /*! \brief The frozen contexts indexed by the function and the input shapes. */
+  std::unordered_map<std::string, VMContext> frozen_contexts_;
+  /*! \brief Indicates whether a frozen context is being executed. */
+  bool frozen_occupied_ = false;
+  /*! \brief The mutex to access the frozen contexts. */
+  std::mutex frozen_mutex_;
+  /*! \brief A buffer that is kept resident across executions. */
+  struct PersistentBuffer {
+    /*! \brief The memory of the buffer. */
+    std::shared_ptr<Memory> memory;
+    /*! \brief The size of the buffer in bytes. */
+    int64_t nbytes = 0;
+  };
+  /*!
+   * \brief The persistent buffers of each VM function. It maps the pc of an AllocStorage instruction
+   * to the buffer of its latest execution.
+   */
+  std::vector<std::unordered_map<Index, PersistentBuffer>> persistent_buffers_;
+  /*!
+   * \brief The batched allocations of each VM function. It maps the pc of the first AllocStorage
+   * instruction of a run to the number of the instructions in the run.
+   */
+  std::vector<std::unordered_map<Index, Index>> alloc_batches_;
+  /*! \brief Whether to allocate the runs of AllocStorage instructions in batches. */
+  std::atomic<bool> alloc_batching_{true};
+  /*! \brief The mutex to access the persistent buffers. */
+  std::mutex persistent_mutex_;
+  /*! \brief The maximum number of the memoized type inference results of an instruction. */
+  static constexpr size_t kMaxInferTypeCacheEntries = 1024;
+  /*!
+   * \brief The memoized results of the InferType instructions of each VM function. It maps the pc
+   * of an instruction to its results keyed by the callee and the argument signatures.
+   */
+  std::vector<std::unordered_map<Index, std::unordered_map<std::string, Value>>> infer_type_cache_;
+  /*! \brief The mutex to access the memoized type inference results. */
+  std::mutex infer_type_mutex_;
+  /*! \brief The number of contexts kept in the pool in serving mode. */
+  static constexpr size_t kServingContextPoolSize = 64;
+  /*! \brief The pool of the contexts to be recycled in serving mode. */
+  std::unique_ptr<VMContextPool> context_pool_;
+  /*!
+   * \brief The locks to serialize the executions of the same instruction by different contexts in
+   * serving mode, since the shared OpEnvs hold the arguments and workspaces of the execution.
+   */
+  std::array<std::mutex, 64> op_env_locks_;
+  /*! \brief The mutex to populate the constant pool. */
+  std::mutex const_pool_mutex_;
+  /*! \brief Indicates whether the counter mode is on. */
+  std::atomic<bool> counters_enabled_{false};
+  /*! \brief The counters accumulated from the executions, created when first enabled. */
+  std::unique_ptr<VMCounters> counters_;
+  /*! \brief The mutex to access the accumulated counters. */
+  std::mutex counters_mutex_;
 
 #ifdef RAF_USE_CUDA
   /*!
@@ -431,14 +1289,41 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * Cached CUDA Graph is stored in this class, as well as stream for capturing.
    */
   class CudaGraphImpl;
-  /*! \brief A pointer into the CUDA Graph instance. */
-  CudaGraphImpl* cuda_graph_impl_ = nullptr;
-  /*! \brief The context associated with the captured CUDA graph. */
-  VMContext cuda_graph_ctx_;
+  /*! \brief A captured CUDA graph with its associated context. */
+  struct CudaGraphBucket {
+    /*! \brief The key of the function and the input shapes. */
+    std::string key;
+    /*! \brief The context associated with the captured CUDA graph. */
+    VMContext ctx;
+    /*! \brief The CUDA Graph instance, which is null before capturing. */
+    std::shared_ptr<CudaGraphImpl> impl;
+    /*! \brief The logical time of the last use. */
+    uint64_t last_use;
+  };
+  /*! \brief The cached CUDA graphs, which are evicted in the least recently used order. */
+  std::vector<CudaGraphBucket> cuda_graph_buckets_;
+  /*! \brief The index of the bucket in use. */
+  int cuda_graph_bucket_index_ = -1;
+  /*! \brief The evicted CUDA graph whose executable can be updated for the next captured one. */
+  std::shared_ptr<CudaGraphImpl> cuda_graph_evicted_;
+  /*! \brief The logical clock for the CUDA graph uses. */
+  uint64_t cuda_graph_clock_ = 0;
   /*! \brief Indicate whether the CUDA graph is currently in use by a context. */
   bool cuda_graph_occupied_ = false;
   /*! \brief The mutex to access CUDA graph related fields. */
   std::mutex cuda_graph_mutex_;
+  /*!
+   * \brief A static segment of consecutive InvokeJit and Free instructions with its captured
+   * CUDA graphs.
+   */
+  class CudaGraphSegment;
+  /*!
+   * \brief Indicates whether CUDA graphs are captured for the static segments instead of the
+   * whole function.
+   */
+  bool use_cuda_graph_segments_ = false;
+  /*! \brief The static segments indexed by the function index and the first instruction index. */
+  std::vector<std::vector<std::shared_ptr<CudaGraphSegment>>> cuda_graph_segments_;
 #endif
 };
 
@@ -12,10 +12,11 @@ except:  # pylint: disable=bare-except
     __full_version__ = "dev"
     __gitrev__ = "unknown"
 
-from ._core.ndarray import array, ndarray
+from ._core.ndarray import array, ndarray, from_dlpack
 from ._op.imp import *  # pylint: disable=redefined-builtin
 from . import frontend
 from . import amp
+from . import quantization
 from . import random
 from . import build
 from . import ir
@@ -31,10 +31,34 @@ def interpret(expr, module=None):
     return _ffi.executor.Interpret(expr, module)
 
 
+def tuning_db_key(target, workload_key):
+    """The key of the tuned schedule of a workload in the tuning database. The schedules of
+    CUDA are specific to the compute capability of the GPU.
+
+    Parameters
+    ----------
+    target: tvm.target.Target
+        The target of the workload.
+
+    workload_key: str
+        The auto-scheduler workload key.
+
+    Returns
+    -------
+    key: str
+        The key in the tuning database.
+    """
+    kind = target.kind.name
+    if kind == "cuda":
+        kind += "-sm" + tvm.cuda(0).compute_version.replace(".", "")
+    return "auto_scheduler/%s/%s" % (kind, workload_key)
+
+
 class MetaFallbackContext(ApplyHistoryBest):
     """
-    The RAF fallback dispatch context, which queries the builtin schedules and outputs
-    the message when missed. This is used as the root context for RAF.
+    The RAF fallback dispatch context, which queries the builtin schedules and then the
+    schedules stored in the tuning database by raf.utils.tuner, and outputs the message when
+    missed. This is used as the root context for RAF.
 
     Parameters
     ----------
@@ -75,6 +99,13 @@ class MetaFallbackContext(ApplyHistoryBest):
         if key in self.memory:
             return None
 
+        # Query the tuning database, and cache the schedule in this context if found.
+        record = _ffi.cache.GetTuningRecord(tuning_db_key(target, workload_key))
+        if record:
+            inp, _ = auto_scheduler.measure_record.load_record_from_string(record)
+            self.update(target, workload_key, inp.state)
+            return inp.state
+
         # Print the message due to no valid schedule.
         if has_complex_op and self.verbose >= 2:
             msg = f"Cannot find tuned schedule for op={func_name}, target={target}"
@@ -119,17 +150,63 @@ class VMExecutor:
 
     dryrun: bool
         Whether to create a dryrun VM that skips the op execution.
+
+    stream_ordered_alloc: bool
+        Whether to order the memory allocation and release with the CUDA streams that use it.
+
+    threaded_dispatch: bool
+        Whether to use the threaded dispatch loop of the VM.
+
+    serving_mode: bool
+        Whether the VM is run by multiple threads concurrently.
+
+    persistent_storage: bool
+        Whether to keep the buffers that outlive an execution resident across executions.
+
+    frozen: bool
+        Whether to replay the recorded kernels on the pre-bound tensors for static executables.
+
+    fork_join: bool
+        Whether to launch the independent function calls on separate CUDA streams.
+
+    dtr_budget: int
+        The memory budget in bytes of an execution to rematerialize the evicted tensors, 0 for off.
     """
 
-    def __init__(self, mod, device, enable_cuda_graph=False, dryrun=False):
+    def __init__(
+        self,
+        mod,
+        device,
+        enable_cuda_graph=False,
+        dryrun=False,
+        stream_ordered_alloc=False,
+        threaded_dispatch=False,
+        serving_mode=False,
+        persistent_storage=False,
+        frozen=False,
+        fork_join=False,
+        dtr_budget=0,
+    ):  # pylint: disable=too-many-arguments
         if mod is None:
             raise RuntimeError("Must provide module to get VM executor.")
         if "gpu" not in device and "cuda" not in device:
             enable_cuda_graph = False
+            stream_ordered_alloc = False
+            fork_join = False
         self.device = Device(device)
         self.executable = vm.compile(mod, self.device)
         self.vm = vm.VirtualMachine(
-            self.executable, self.device, enable_cuda_graph=enable_cuda_graph, dryrun=dryrun
+            self.executable,
+            self.device,
+            enable_cuda_graph=enable_cuda_graph,
+            dryrun=dryrun,
+            stream_ordered_alloc=stream_ordered_alloc,
+            threaded_dispatch=threaded_dispatch,
+            serving_mode=serving_mode,
+            persistent_storage=persistent_storage,
+            frozen=frozen,
+            fork_join=fork_join,
+            dtr_budget=dtr_budget,
         )
 
     @staticmethod
@@ -6,6 +6,7 @@
 import ctypes
 
 from raf._core.core_utils import dev2str, set_module, str2dev
+from raf._core.device import Device
 from raf._core.value import TensorValue
 from raf._ffi.binding import (
     BindNDArray,
@@ -17,8 +18,8 @@ from raf._ffi.binding import (
     LookupGrad,
 )
 from raf._ffi.tensor import MarkNumpy
-from raf._ffi.value import ToTVM
-from raf._lib import _register_func, relay, tvm_ndarray
+from raf._ffi.value import CopyTo, ToTVM
+from raf._lib import _register_func, relay, tvm_empty, tvm_ndarray
 from raf._lib import TensorContainer as _DLManagedTensor
 
 
@@ -58,6 +59,7 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
             # NDArray is treated as relay.Constant
             self.__handle = BindNDArray(_np_to_tensor_value(npa, device=device), None, name)
         self.__requires_grad = False
+        self.__model_parallel = False
 
     def __setitem__(self, key, value):
         if isinstance(key, slice):
@@ -81,6 +83,17 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
         self.__requires_grad = value
         SetRequiresGrad(self.__handle, value)
 
+    @property
+    def model_parallel(self):
+        """Whether this parameter is partitioned across ranks, e.g., a shard of an embedding
+        table, so its gradient is local to the rank and not aggregated by data parallelism."""
+        return self.__model_parallel
+
+    @model_parallel.setter
+    def model_parallel(self, value):
+        assert isinstance(value, bool)
+        self.__model_parallel = value
+
     @property
     def __handle(self):
         return self.__handle_
@@ -124,6 +137,12 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
     def numpy(self):
         return ToTVM(self.__value).numpy()  # pylint: disable=protected-access
 
+    def __dlpack__(self, stream=None):
+        return self.__value.__dlpack__(stream=stream)
+
+    def __dlpack_device__(self):
+        return self.__value.__dlpack_device__()
+
     @property
     def device(self):
         return self.__device
@@ -173,13 +192,25 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
         self.__byte_offset = byte_offset
 
     def to(self, *, device=None, dtype=None):  # pylint: disable=invalid-name
-        npa = self.numpy()
-        if dtype is not None:
-            npa = npa.astype(dtype)
+        # The dtype is converted on the host before the upload, so that the device only holds the
+        # array in the target dtype, e.g., the float16 weights loaded from a float32 checkpoint.
+        dtype = _normalize_dtype(self.dtype if dtype is None else dtype)
         if device is None:
             device = self.device
-        ret = ndarray(BindNDArray(_np_to_tensor_value(npa, device=device), None, ""))
+        src_dev, dst_dev = str2dev(self.device), str2dev(device)
+        if (
+            dtype == _normalize_dtype(self.dtype)
+            and src_dev.device_type == dst_dev.device_type == str2dev("cuda").device_type
+            and src_dev.device_id != dst_dev.device_id
+        ):
+            # Copy between the GPUs directly, which is a peer-to-peer copy if the topology allows.
+            value = CopyTo(self.__value, Device(device))
+        else:
+            npa = _astype(self.numpy(), self.dtype, dtype)
+            value = _np_to_tensor_value(npa, device=device, dtype=dtype)
+        ret = ndarray(BindNDArray(value, None, ""))
         ret.requires_grad = self.requires_grad
+        ret.model_parallel = self.model_parallel
         return ret
 
     def backward(self, gradient=None):
@@ -328,7 +359,44 @@ class Symbol:
         return divide(self, other)
 
 
-def _np_to_tensor_value(npa, device="cpu"):
+# The number of elements converted at a time when changing the dtype of an array on the host,
+# which bounds the temporaries of the conversion.
+_CONVERT_CHUNK_SIZE = 1 << 22
+
+
+def _normalize_dtype(dtype):
+    if str(dtype) == "bfloat16":
+        return "bfloat16"
+    import numpy as np  # pylint: disable=import-outside-toplevel
+
+    return np.dtype(str(dtype)).name
+
+
+def _astype(npa, src_dtype, dtype):
+    """Convert a numpy array to the dtype in chunks. As in TVM, a bfloat16 array is represented by
+    its uint16 bits, which are rounded to the nearest even from float32."""
+    import numpy as np  # pylint: disable=import-outside-toplevel
+
+    src_dtype, dtype = _normalize_dtype(src_dtype), _normalize_dtype(dtype)
+    if src_dtype == dtype:
+        return npa
+    src = np.ascontiguousarray(npa).reshape(-1)
+    out = np.empty(src.size, dtype="uint16" if dtype == "bfloat16" else dtype)
+    for begin in range(0, src.size, _CONVERT_CHUNK_SIZE):
+        end = min(begin + _CONVERT_CHUNK_SIZE, src.size)
+        chunk = src[begin:end]
+        if src_dtype == "bfloat16":
+            chunk = (chunk.astype("uint32") << 16).view("float32")
+        if dtype == "bfloat16":
+            chunk = chunk.astype("float32")
+            bits = chunk.view("uint32")
+            bits = (bits + 0x7FFF + ((bits >> 16) & 1)) >> 16
+            chunk = np.where(np.isnan(chunk), 0x7FC0, bits)
+        np.copyto(out[begin:end], chunk, casting="unsafe")
+    return out.reshape(npa.shape)
+
+
+def _np_to_tensor_value(npa, device="cpu", dtype=None):
     def _tensor_value(obj):
         device = "cpu"
         dtype = str(obj.dtype)
@@ -351,6 +419,11 @@ def _np_to_tensor_value(npa, device="cpu"):
         MarkNumpy(result._tensor, _manager_ctx(npa))  # pylint: disable=protected-access
         return result
 
+    if dtype == "bfloat16":
+        # The numpy array holds the bits of bfloat16, which numpy does not support.
+        tvm_array = tvm_empty(npa.shape, dtype, str2dev(device))
+        tvm_array.copyfrom(npa)
+        return TensorValue.from_tvm(tvm_array)
     return TensorValue.from_tvm(tvm_ndarray(npa, device=str2dev(device)))
 
 
@@ -372,6 +445,13 @@ def array(
     return ndarray(BindNDArray(_np_to_tensor_value(npa, device=device), None, name))
 
 
+@set_module("raf")
+def from_dlpack(tensor, *, name=""):
+    """Create an ndarray sharing the memory of a tensor of another framework without copying.
+    See TensorValue.from_dlpack for the accepted tensors."""
+    return ndarray(BindNDArray(TensorValue.from_dlpack(tensor), None, name))
+
+
 _DL_MANAGED_TENSOR_PTR = ctypes.POINTER(_DLManagedTensor)
 
 
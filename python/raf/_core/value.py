@@ -5,10 +5,12 @@
 """Runtime value instances."""
 from raf._core.core_utils import dev2str, register_node, str2dev
 from raf._ffi import value as ffi
+from raf._ffi.device_api import StreamWaitStream
 from raf._ffi.ir._make import Constant as make_const_expr
 from raf._ffi.value import _make, ToTVM
 from raf._lib import Object
 from raf._lib import tvm_ndarray
+from raf._lib import tvm as _tvm
 from raf._lib import relay as _relay
 
 
@@ -92,6 +94,57 @@ class TensorValue(BaseTensorValue):
     def from_numpy(np_array):
         return TensorValue.from_tvm(tvm_ndarray(np_array))
 
+    @staticmethod
+    def from_dlpack(tensor):
+        """Create a tensor value sharing the memory of a tensor of another framework, e.g.,
+        a PyTorch or CuPy tensor, without copying.
+
+        Parameters
+        ----------
+        tensor : object
+            The tensor implementing the DLPack protocol (__dlpack__ and __dlpack_device__),
+            a DLPack capsule, or a TVM NDArray.
+
+        Returns
+        -------
+        ret : TensorValue
+            The tensor value that keeps the tensor alive.
+        """
+        if isinstance(tensor, _tvm.nd.NDArray):
+            return TensorValue.from_tvm(tensor)
+        if hasattr(tensor, "__dlpack__"):
+            device_type, _ = tensor.__dlpack_device__()
+            if device_type == _tvm.runtime.Device.kDLCUDA:
+                # RAF executes on the legacy default stream, which the producer makes its
+                # pending writes to the tensor visible to.
+                tensor = tensor.__dlpack__(stream=1)
+            else:
+                tensor = tensor.__dlpack__()
+        return TensorValue.from_tvm(_tvm.nd.from_dlpack(tensor))
+
+    def __dlpack__(self, stream=None):
+        """Export the tensor as a DLPack capsule sharing the memory.
+
+        Parameters
+        ----------
+        stream : Optional[int]
+            The CUDA stream of the consumer, which is made to wait for the pending work of RAF on
+            the tensor. None or 1 means the legacy default stream, on which RAF executes.
+
+        Returns
+        -------
+        ret : PyCapsule
+            The DLPack capsule.
+        """
+        device = self.dltensor_handle.contents.device
+        if stream not in (None, 1) and device.device_type == _tvm.runtime.Device.kDLCUDA:
+            StreamWaitStream(device, 0, stream)
+        return ToTVM(self).to_dlpack()
+
+    def __dlpack_device__(self):
+        device = self.dltensor_handle.contents.device
+        return (device.device_type, device.device_id)
+
     def numpy(self):
         return ToTVM(self).numpy()
 
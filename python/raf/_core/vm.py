@@ -3,12 +3,15 @@
 
 """RAF virtual machine and utility functions."""
 # pylint: disable=no-self-use
+import json
+import os
+
 import numpy as np
 import tvm
 
 from .. import _ffi
 from .._lib import _ByteArray
-from .._core.value import Value, TupleValue
+from .._core.value import Value, TensorValue, TupleValue
 from . import ndarray as _nd
 from .core_utils import register_node, DEVICE_TYPE_MAP
 from .device import Device
@@ -126,6 +129,92 @@ class Executable:
 
         return Executable(_ffi.vm.Load_Executable(bytecode, lib))
 
+    @staticmethod
+    def load_exec_from_file(path, lib):
+        """Construct an executable from the bytecode saved in a file. The file is mapped into
+        memory, and the constants are only copied to the device when they are used for the first
+        time, which saves the start-up time and the host memory of large models.
+
+        Parameters
+        ----------
+        path : str
+            The path to the file of the saved bytecode.
+
+        lib : :py:class:`~tvm.runtime.Module`
+            The runtime module that contains the generated code.
+
+        Returns
+        -------
+        exec: Executable
+            An executable constructed using the provided artifacts.
+        """
+        if lib is not None and not isinstance(lib, tvm.runtime.Module):
+            raise TypeError(
+                "lib is expected to be the type of tvm.runtime.Module"
+                + ", but received {}".format(type(lib))
+            )
+
+        return Executable(_ffi.vm.Load_ExecutableFromFile(str(path), lib))
+
+    def export_aot(self, path):
+        """Export the executable ahead of time to a directory with the bytecode ("code.ro"), one
+        shared library linking all kernels built in this process ("kernels.so"), and a manifest
+        mapping the kernel cache keys to the kernel names ("kernels.json"). Since the cache keys
+        are the op and tensor types the dialect ops are resolved with, loading the directory with
+        `load_aot` dispatches the ops to the linked kernels without compilation.
+
+        Note that only the kernels built (or loaded from the persistent cache) by the time of
+        exporting are linked, so the executable should be run once (or compiled with
+        "raf.vm.jit_warmup_threads") beforehand. Kernels of the vendor libraries (e.g., cuBLAS
+        and cuDNN) need no compilation and are not included.
+
+        Parameters
+        ----------
+        path : str
+            The directory to export to.
+        """
+        os.makedirs(path, exist_ok=True)
+        with open(os.path.join(path, "code.ro"), "wb") as code_file:
+            code_file.write(self.save()[0])
+
+        # The kernel names are mangled by the target and the function hash, so modules with the
+        # same kernel name are identical and only linked once.
+        root = tvm.get_global_func("runtime.CSourceModuleCreate")("", "c", [], [])
+        manifest = []
+        linked = set()
+        for cache_name in ["tvm_cpu", "tvm_cuda"]:
+            for key, func_name in _ffi.cache.GetTVMCacheEntries(cache_name):
+                key, func_name = str(key), str(func_name)
+                if func_name not in linked:
+                    root.import_module(_ffi.cache.GetTVMCacheModule(cache_name, key))
+                    linked.add(func_name)
+                manifest.append({"cache": cache_name, "key": key, "func_name": func_name})
+        root.export_library(os.path.join(path, "kernels.so"))
+        with open(os.path.join(path, "kernels.json"), "w") as manifest_file:
+            json.dump(manifest, manifest_file, indent=4)
+
+    @staticmethod
+    def load_aot(path):
+        """Load an executable exported by `export_aot`, and register its kernels to the kernel
+        caches so that running the executable needs no compilation.
+
+        Parameters
+        ----------
+        path : str
+            The directory exported by `export_aot`.
+
+        Returns
+        -------
+        exec: Executable
+            The loaded executable.
+        """
+        lib = tvm.runtime.load_module(os.path.join(path, "kernels.so"))
+        with open(os.path.join(path, "kernels.json"), "r") as manifest_file:
+            manifest = json.load(manifest_file)
+        for entry in manifest:
+            _ffi.cache.SetTVMCacheEntry(entry["cache"], entry["key"], lib, entry["func_name"])
+        return Executable.load_exec_from_file(os.path.join(path, "code.ro"), None)
+
     @property
     def lib(self):
         """Get the library that contains hardware dependent code.
@@ -405,8 +494,12 @@ def _convert(arg):
         return nd_arr._ndarray__value
     if isinstance(arg, _nd.ndarray):
         return arg._ndarray__value
+    if isinstance(arg, Value):
+        return arg
     if isinstance(arg, (tuple, list)):
         return TupleValue([_convert(x) for x in arg])
+    if hasattr(arg, "__dlpack__"):
+        return TensorValue.from_dlpack(arg)
     raise TypeError("Unsupported type: %s" % (type(arg)))
 
 
@@ -420,6 +513,35 @@ class VMContext(Value):
     """The VMContext holds the runtime data for an execution in the VM."""
 
 
+@register_node("raf.value.vm.FutureValue")
+class FutureValue(Value):
+    """The outputs of a VM execution that may still be computed on the device."""
+
+    def done(self):
+        """Check whether the outputs are ready without blocking.
+
+        Returns
+        -------
+        ret : bool
+            Whether the outputs are ready.
+        """
+        return bool(_ffi.vm.FutureValueIsReady(self))
+
+    def result(self):
+        """Wait for the outputs to be ready and return them.
+
+        Returns
+        -------
+        ret : Value
+            The outputs.
+        """
+        return _ffi.vm.FutureValueGet(self)
+
+    def numpy(self):
+        """Wait for the output tensor and convert it to a numpy array."""
+        return self.result().numpy()
+
+
 class VirtualMachine:
     """Relay VM runtime.
 
@@ -432,23 +554,129 @@ class VirtualMachine:
         The runtime context to run the code on.
 
     enable_cuda_graph : bool
-        Whether use CUDA graph.
+        Whether use CUDA graph. If the executable has control flow or dynamic shapes, CUDA graphs
+        are captured for its static segments instead of the whole function. Otherwise, the whole
+        function, including its multi-stream schedule and NCCL collectives, is captured into one
+        graph, which is bound to the input tensors of the first run. Passing the same tensors
+        again (e.g., the parameters updated in place by the optimizer) skips the copies, while
+        the other inputs are copied into the bound tensors.
 
     dryrun: bool
         Whether to create a dryrun VM that skips the op execution.
+
+    stream_ordered_alloc: bool
+        Whether to order the memory allocation and release with the CUDA streams that use the
+        memory, so that multi-stream schedules can safely reuse memory without synchronization.
+
+    threaded_dispatch: bool
+        Whether to interpret the pre-decoded instructions with a threaded dispatch loop, which
+        reduces the interpreter overhead but skips the per-instruction profiling.
+
+    serving_mode: bool
+        Whether the VM is run by multiple threads concurrently. In this mode, each context launches
+        kernels to its own CUDA stream, and the contexts are recycled after execution.
+
+    persistent_storage: bool
+        Whether to keep the buffers that outlive an execution (e.g., gradients and optimizer
+        states) resident and reuse them in the following executions. Note that the outputs of an
+        execution may be overwritten by the next execution once they are released.
+
+    frozen: bool
+        Whether to record the kernels of the first execution with each function and input shapes,
+        and replay them on the pre-bound tensors in the following executions without interpreting
+        the bytecode. It only applies to the executables without control flow or dynamic shapes,
+        and keeps all the buffers of the recorded execution resident. Note that the outputs of an
+        execution are overwritten by the next execution with the same input shapes.
+
+    fork_join: bool
+        Whether to launch the independent function calls, e.g., the sub-models of an ensemble
+        lifted by LambdaLift, on separate CUDA streams and join them with events, so that they
+        run concurrently. It is disabled in CUDA graph, serving and frozen modes.
+
+    dtr_budget: int
+        The memory budget in bytes of an execution for dynamic tensor rematerialization (DTR).
+        Once an allocation would exceed the budget, the cheapest tensors to recompute are evicted,
+        and recomputed from their recorded ops once accessed. 0 means DTR is off. It only applies
+        to single-stream executions, and is disabled in CUDA graph, dryrun, stream-ordered
+        allocation, serving, frozen and fork/join modes.
+
+    ipc_constants: Optional[bytearray]
+        The constants exported by another process running the same executable on the same GPU
+        with :py:meth:`export_constants`, which are used by this VM instead of being uploaded.
+
+    tenant: Optional[str]
+        The memory pool tenant that the memory allocated by the executions belongs to, whose
+        reservation and quota are set by ``raf._ffi.memory_pool.SetTenant`` on a ``tenant_pool``.
+
+    async_dispatch: bool
+        Whether to launch the executions in order on a dedicated host thread. In this mode,
+        :py:meth:`run_future` returns as soon as the execution is queued, so that the host overhead
+        of launching the next step overlaps with the Python work of the current one. The errors
+        of an execution are raised when its outputs are accessed. It is disabled in CUDA graph,
+        serving and frozen modes.
+
+    host_outputs: bool
+        Whether to return the outputs as host tensors. The outputs of an execution are copied to
+        pinned host memory on a dedicated copy stream as soon as its kernels are issued, so that
+        with :py:meth:`run_future`, the copies overlap with the following executions instead of
+        blocking when the outputs are converted to numpy. It only applies to the CUDA devices,
+        and is disabled in CUDA graph mode.
     """
 
-    def __init__(self, exe, device, enable_cuda_graph=False, dryrun=False):
+    def __init__(
+        self,
+        exe,
+        device,
+        enable_cuda_graph=False,
+        dryrun=False,
+        stream_ordered_alloc=False,
+        threaded_dispatch=False,
+        serving_mode=False,
+        persistent_storage=False,
+        frozen=False,
+        fork_join=False,
+        dtr_budget=0,
+        ipc_constants=None,
+        tenant=None,
+        async_dispatch=False,
+        host_outputs=False,
+    ):  # pylint: disable=too-many-arguments
         if not isinstance(exe, Executable):
             raise TypeError(
                 "mod is expected to be the type of Executable, but received {}".format(type(exe))
             )
-        self.module = _ffi.vm.VirtualMachine(exe.module, enable_cuda_graph, dryrun)
+        self.module = _ffi.vm.VirtualMachine(
+            exe.module,
+            enable_cuda_graph,
+            dryrun,
+            stream_ordered_alloc,
+            threaded_dispatch,
+            serving_mode,
+            persistent_storage,
+            frozen,
+            fork_join,
+            dtr_budget,
+            async_dispatch,
+            host_outputs,
+        )
+        self._serving_mode = serving_mode
         self._exec = exe
         self._set_devices = self.module["set_devices"]
         self._prepare_context = self.module["prepare_context"]
         self._run = self.module["run"]
+        self._run_future = self.module["run_future"]
+        self._run_steps = self.module["run_steps"]
+        self._reset_context = self.module["reset_context"]
+        self._release_context = self.module["release_context"]
         self._profile = self.module["profile"]
+        self._set_counters = self.module["set_counters"]
+        self._get_counters = self.module["get_counters"]
+        self._reset_counters = self.module["reset_counters"]
+        if ipc_constants is not None:
+            # Imported before setting the devices, so the constants are never uploaded.
+            self.module["import_constants"](bytearray(ipc_constants))
+        if tenant is not None:
+            self.module["set_tenant"](tenant)
         self._set_devices(device)
 
     def prepare_context(self, func_name, *args, **kwargs):
@@ -506,8 +734,124 @@ class VirtualMachine:
             The output.
         """
         ctx = self.prepare_context(func_name, *args, **kwargs)
+        if not self._serving_mode:
+            return self._run(ctx)
+        try:
+            return self._run(ctx)
+        finally:
+            self._release_context(ctx)
+
+    def reset_context(self, ctx, *args):
+        """Reset a VM context after its execution and rebind its arguments in place, so that the
+        context is reused by the next execution without being created again. The register files
+        and the loaded constants of the context are kept.
+
+        Parameters
+        ----------
+        ctx : VMContext
+            The context created by prepare_context, which should not be running.
+
+        args : list[raf.ndarray] or list[np.ndarray]
+            The new arguments to the function.
+        """
+        self._reset_context(ctx, *_convert_args(args))
+
+    def run_context(self, ctx):
+        """Run the virtual machine on a prepared context.
+
+        Parameters
+        ----------
+        ctx : VMContext
+            The context created by prepare_context and optionally reset by reset_context.
+
+        Returns
+        -------
+        result : Object
+            The output.
+        """
         return self._run(ctx)
 
+    def run_steps(
+        self, num_steps, *args, next_batch=None, batch_args=None, func_name="main", **kwargs
+    ):  # pylint: disable=too-many-arguments
+        """Run the virtual machine for multiple steps without returning to Python, e.g., the
+        iterations of a training loop. The context is prepared once, so that the arguments other
+        than the batches (e.g., the parameters and the optimizer states) stay bound to it. Before
+        each step, the arguments at batch_args are rebound to the next batch.
+
+        Parameters
+        ----------
+        num_steps : int
+            The number of steps.
+
+        args : list[raf.ndarray] or list[np.ndarray]
+            The arguments to the function. The ones at batch_args are replaced by the batches.
+
+        next_batch : Optional[Union[InputPrefetcher, Callable]]
+            The source of the batches, which is an InputPrefetcher or a function returning the
+            next batch as a list. If None, all steps run on the given arguments.
+
+        batch_args : Optional[List[int]]
+            The indices of the arguments to rebind at each step.
+
+        func_name : str
+            The name of function to run.
+
+        kwargs: dict of str to raf.ndarray or np.ndarray
+            Named arguments to the function.
+
+        Returns
+        -------
+        result : List[Object]
+            The outputs of the steps.
+        """
+        if isinstance(next_batch, InputPrefetcher):
+            fnext = next_batch.module["pop"]
+        elif next_batch is not None:
+
+            def fnext():
+                return _convert_args(next_batch())
+
+        else:
+            fnext = None
+        batch_args = batch_args if batch_args is not None else []
+        ctx = self.prepare_context(func_name, *args, **kwargs)
+        try:
+            return list(self._run_steps(ctx, num_steps, batch_args, fnext))
+        finally:
+            if self._serving_mode:
+                self._release_context(ctx)
+
+    def run_future(self, *args, func_name="main", **kwargs):
+        """Run the virtual machine without waiting for the outputs. The outputs are only
+        synchronized when they are accessed, so that the host can prepare the next execution
+        while the device is computing this one. In asynchronous dispatch mode, it returns before
+        the execution is launched.
+
+        Parameters
+        ----------
+        args : list[raf.ndarray] or list[np.ndarray]
+            The arguments to the function.
+
+        func_name : str
+            The name of function to run.
+
+        kwargs: dict of str to raf.ndarray or np.ndarray
+            Named arguments to the function.
+
+        Returns
+        -------
+        result : FutureValue
+            The future of the output.
+        """
+        ctx = self.prepare_context(func_name, *args, **kwargs)
+        if not self._serving_mode:
+            return self._run_future(ctx)
+        try:
+            return self._run_future(ctx)
+        finally:
+            self._release_context(ctx)
+
     def profile(self, *args, func_name="main", warmup=5, number=10, repeat=10, **kwargs):
         """Profile the virtual machine.
 
@@ -543,3 +887,339 @@ class VirtualMachine:
         ctx = self.prepare_context(func_name, *args, **kwargs)
         result = [v.value for v in self._profile(ctx, warmup, number, repeat)]
         return result
+
+    def set_counters(self, enabled=True):
+        """Turn on or off the counter mode, in which the following executions count each
+        instruction and the host time of preparing OpEnvs, allocations and stream
+        synchronizations, to separate the host overheads from the device time. The threaded
+        dispatch loop is not used and the instructions replayed from CUDA graphs are not counted
+        in this mode.
+
+        Parameters
+        ----------
+        enabled : bool
+            Whether to turn on the counter mode.
+        """
+        self._set_counters(enabled)
+
+    def get_counters(self):
+        """Get the counters accumulated since the last reset.
+
+        Returns
+        -------
+        result : Dict[str, Any]
+            - 'opcode_counts': The execution count of each opcode.
+            - 'pc_counts': The executed instructions, each with 'func', 'pc', 'instruction' and
+              'count', in the descending order of count.
+            - 'prepare_op_env_us': The host time of preparing OpEnvs, including JIT.
+            - 'num_allocs' and 'alloc_us': The number and the host time of allocations.
+            - 'wait_event_us' and 'stream_barrier_us': The host time blocked in CudaWaitEvent and
+              CudaStreamBarrier.
+            - 'num_dtr_evictions' and 'num_dtr_rematerializations': The number of tensors evicted
+              and recomputed by DTR.
+        """
+        counters = self._get_counters()
+        pc_counts = [
+            {
+                "func": item["func"],
+                "pc": item["pc"].value,
+                "instruction": item["instruction"],
+                "count": item["count"].value,
+            }
+            for item in counters["pc_counts"]
+        ]
+        pc_counts.sort(key=lambda item: item["count"], reverse=True)
+        ret = {
+            "opcode_counts": {k: v.value for k, v in counters["opcode_counts"].items()},
+            "pc_counts": pc_counts,
+        }
+        for key in ["prepare_op_env_us", "alloc_us", "wait_event_us", "stream_barrier_us"]:
+            ret[key] = counters[key].value
+        for key in ["num_allocs", "num_dtr_evictions", "num_dtr_rematerializations"]:
+            ret[key] = counters[key].value
+        return ret
+
+    def reset_counters(self):
+        """Reset the accumulated counters."""
+        self._reset_counters()
+
+    def set_alloc_batching(self, enabled=True):
+        """Turn on or off allocating the runs of consecutive storage allocations of the same
+        device and alignment in batches. It is on by default.
+
+        Parameters
+        ----------
+        enabled : bool
+            Whether to allocate the storages in batches.
+        """
+        self.module["set_alloc_batching"](enabled)
+
+    def get_alloc_batches(self):
+        """Get the runs of storage allocations that are allocated in batches.
+
+        Returns
+        -------
+        result : List[Tuple[int, int, int]]
+            The function index, the pc of the first instruction and the number of the
+            instructions of each run.
+        """
+        return [tuple(x.value for x in batch) for batch in self.module["get_alloc_batches"]()]
+
+    def export_constants(self):
+        """Upload the tensor constants into a single device buffer shared by CUDA IPC, so that the
+        other processes running the same executable on the same GPU use them without their own
+        copies, by creating their VMs with ``ipc_constants``. This process must keep the VM alive
+        as long as the other processes use the constants, which are read-only.
+
+        Returns
+        -------
+        handle : bytearray
+            The serialized IPC handle of the constants.
+        """
+        return self.module["export_constants"]()
+
+
+class BatchingExecutor:
+    """Dynamic request batching on top of the VM. The requests submitted concurrently are
+    coalesced along the batch dimension (axis 0), executed once, and the outputs are scattered
+    back to the requests.
+
+    Parameters
+    ----------
+    vm : VirtualMachine
+        The VM to run the batches.
+
+    batched_args : List[int]
+        The indices of the arguments that are batched along axis 0. The other arguments (e.g., the
+        model parameters) are shared, and only the requests with the same ones are coalesced.
+
+    max_batch_size : int
+        The maximal batch size of an execution.
+
+    max_delay_us : int
+        The maximal time in microseconds for a request to wait for others before running.
+
+    batch_buckets : Optional[List[int]]
+        The batch sizes to pad the coalesced batches to, e.g., the batch sizes that the executable
+        or the CUDA graphs are specialized for. A batch is not padded if no bucket fits.
+
+    func_name : str
+        The name of function to run.
+    """
+
+    def __init__(
+        self,
+        vm,
+        batched_args,
+        max_batch_size,
+        max_delay_us=1000,
+        batch_buckets=None,
+        func_name="main",
+    ):  # pylint: disable=too-many-arguments
+        self._vm = vm
+        self.module = _ffi.vm.BatchingExecutor(
+            vm.module,
+            func_name,
+            batched_args,
+            max_batch_size,
+            max_delay_us,
+            batch_buckets if batch_buckets is not None else [],
+        )
+        self._infer = self.module["infer"]
+
+    def __call__(self, *args):
+        """Submit a request and wait for its outputs.
+
+        Parameters
+        ----------
+        args : list[raf.ndarray] or list[np.ndarray]
+            The arguments to the function.
+
+        Returns
+        -------
+        result : Object
+            The outputs of the request.
+        """
+        return self._infer(*_convert_args(args))
+
+
+class GenerationScheduler:
+    """Continuous (iteration-level) batching of autoregressive generation on top of the VM. The
+    sequences are admitted and retired at every decoding step, and their keys and values are kept
+    in paged caches owned by the scheduler (see raf.utils.kv_cache).
+
+    Each step runs the function with the padded inputs
+    ``(tokens, positions, slots, block_tables, mask, k_cache_0, v_cache_0, ..., *params)``, where
+    tokens, positions and slots are int64 in shape [max_num_tokens], block_tables is int64 in shape
+    [max_num_tokens, max_blocks] (the block table of the sequence of each token), and mask is the
+    float32 additive attention mask in shape [max_num_tokens, max_blocks * block_size]. The
+    function returns the float32 logits of the tokens in shape [max_num_tokens, vocab_size], and
+    the next token of a sequence is the argmax of the logits of its last token.
+
+    Parameters
+    ----------
+    vm : VirtualMachine
+        The VM to run the steps.
+
+    num_layers : int
+        The number of layers, each of which has a key cache and a value cache.
+
+    num_blocks : int
+        The number of blocks of each cache.
+
+    block_size : int
+        The number of tokens of each block.
+
+    token_shape : Tuple[int]
+        The shape of the key or value of a token, e.g., (num_heads, head_dim).
+
+    max_num_tokens : int
+        The number of tokens computed by a step.
+
+    max_num_seqs : int
+        The maximal number of running sequences.
+
+    max_seq_len : int
+        The maximal length of a sequence, including its prompt.
+
+    device : str
+        The device of the caches and the inputs.
+
+    dtype : str
+        The dtype of the caches.
+
+    eos_token_id : int
+        The token that ends a sequence, or -1 for none.
+
+    params : Optional[List[raf.ndarray]]
+        The trailing arguments of the step, e.g., the model parameters.
+
+    func_name : str
+        The name of function to run.
+    """
+
+    def __init__(
+        self,
+        vm,
+        num_layers,
+        num_blocks,
+        block_size,
+        token_shape,
+        max_num_tokens,
+        max_num_seqs,
+        max_seq_len,
+        device,
+        dtype="float32",
+        eos_token_id=-1,
+        params=None,
+        func_name="main",
+    ):  # pylint: disable=too-many-arguments
+        self._vm = vm
+        self.module = _ffi.vm.GenerationScheduler(
+            vm.module,
+            func_name,
+            Device(device),
+            dtype,
+            num_layers,
+            num_blocks,
+            block_size,
+            list(token_shape),
+            max_num_tokens,
+            max_num_seqs,
+            max_seq_len,
+            eos_token_id,
+            _convert_args(params if params is not None else []),
+        )
+        self._generate = self.module["generate"]
+
+    def generate(self, prompt, max_new_tokens):
+        """Submit a prompt and wait for the generated tokens. It can be called from multiple
+        threads, whose sequences are batched together.
+
+        Parameters
+        ----------
+        prompt : List[int]
+            The tokens of the prompt.
+
+        max_new_tokens : int
+            The maximal number of tokens to generate.
+
+        Returns
+        -------
+        ret : List[int]
+            The generated tokens, ending with the EOS token if it is generated.
+        """
+        return [int(token) for token in self._generate(list(prompt), max_new_tokens)]
+
+
+class InputPrefetcher:
+    """Upload the host inputs of the next executions to the device in the background. The host
+    tensors are staged into pinned buffers and copied on a dedicated stream, so that the copies of
+    the next batches overlap with the computation of the current one. The popped inputs can be
+    passed to VirtualMachine.run directly. The inputs are passed through on CPU.
+
+    Example
+    -------
+    .. code-block:: python
+
+        prefetcher = InputPrefetcher("cuda", depth=2)
+        for inputs in prefetcher.prefetch(batches):
+            vm.run(*inputs)
+
+    Parameters
+    ----------
+    device : str
+        The target device.
+
+    depth : int
+        The max number of batches in flight, i.e., the number of staging buffers.
+    """
+
+    def __init__(self, device, depth=2):
+        self.depth = depth
+        self.module = _ffi.vm.InputPrefetcher(Device(device), depth)
+        self._push = self.module["push"]
+        self._pop = self.module["pop"]
+
+    def push(self, *args):
+        """Submit a batch to upload. It blocks if there are already depth batches in flight.
+
+        Parameters
+        ----------
+        args : list[raf.ndarray] or list[np.ndarray]
+            The inputs of the batch.
+        """
+        self._push(*_convert_args(args))
+
+    def pop(self):
+        """Take the oldest batch, waiting for its copies to finish.
+
+        Returns
+        -------
+        result : List[Value]
+            The device-resident inputs of the batch.
+        """
+        return list(self._pop())
+
+    def prefetch(self, batches):
+        """Iterate over the batches with the next ones uploaded ahead.
+
+        Parameters
+        ----------
+        batches : Iterable[Tuple[raf.ndarray or np.ndarray]]
+            The inputs of each batch.
+
+        Returns
+        -------
+        result : Generator[List[Value]]
+            The device-resident inputs of each batch.
+        """
+        num_pending = 0
+        for batch in batches:
+            if num_pending == self.depth:
+                yield self.pop()
+                num_pending -= 1
+            self.push(*batch)
+            num_pending += 1
+        for _ in range(num_pending):
+            yield self.pop()
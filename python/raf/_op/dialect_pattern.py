@@ -3,7 +3,14 @@
 
 """Define dialect fusion patterns."""
 from .dialect import register_pattern
-from ..ir.dataflow_pattern import is_op, wildcard, is_constant, has_dtype, has_shape
+from ..ir.dataflow_pattern import (
+    is_op,
+    is_tuple_get_item,
+    wildcard,
+    is_constant,
+    has_dtype,
+    has_shape,
+)
 from .._core.value import StringValue, IntValue
 
 MATMUL_OPS = [
@@ -73,6 +80,17 @@ def _cutlass_matmul_fusion(matmul_ops, dtype=None):
     return with_act | with_bias
 
 
+def _cublaslt_matmul_fusion(matmul_ops):
+    # cuBLASLt supports the bias and the activation epilogues. Note that its GELU epilogue uses the
+    # tanh approximation.
+    act_ops = ["raf.op.relu", "raf.op.gelu"]
+    dtype = has_dtype("float16") | has_dtype("float32")
+    matmul = is_ops(matmul_ops)(dtype, dtype)
+    with_bias = is_op("raf.op.add")(matmul, wildcard(), *n_null_constant(2))
+    with_act = is_ops(act_ops)(with_bias | matmul)
+    return with_act | with_bias
+
+
 def _call_conv2d(dtype=None):
     if dtype is None:
         x, w = wildcard(), wildcard()
@@ -113,6 +131,31 @@ def _cutlass_conv2d_fusion():
     return with_act | with_bias
 
 
+def _cuda_add_dropout_layer_norm():
+    # The residual add, the dropout and the layer norm over the last axis are computed by the
+    # fused add_dropout_layer_norm kernel in one pass. The dropout is optional.
+    def float_tensor():
+        return has_dtype("float16") | has_dtype("float32")
+
+    def dropout():
+        call = is_op("raf.op._contrib_dropout")(float_tensor(), wildcard(), wildcard())
+        return is_tuple_get_item(call, 0)
+
+    add = is_op("raf.op.add")(dropout() | float_tensor(), wildcard(), *n_null_constant(2))
+    add = add | is_op("raf.op.add")(wildcard(), dropout(), *n_null_constant(2))
+    axis = is_constant(IntValue(-1))
+    return is_op("raf.op.layer_norm")(add, float_tensor(), float_tensor(), axis, wildcard())
+
+
+def _cuda_get_valid_counts_nms():
+    # The valid boxes are selected inline by the non-maximum suppression kernel instead of being
+    # compacted by get_valid_counts first.
+    data = has_dtype("float16") | has_dtype("float32")
+    gvc = is_op("raf.op.get_valid_counts")(data, *n_wildcards(3))
+    boxes, valid_count, indices = [is_tuple_get_item(gvc, i) for i in (1, 0, 2)]
+    return is_op("raf.op.non_max_suppression")(boxes, valid_count, indices, *n_wildcards(9))
+
+
 def _call_pool2d_dx():
     pool_ops = ["raf.op.max_pool2d_dx", "raf.op.avg_pool2d_dx"]
     return is_ops(pool_ops)(*n_wildcards(9))
@@ -121,6 +164,12 @@ def _call_pool2d_dx():
 # softmax
 register_pattern(_call_softmax(), "cudnn", 55, "softmax")
 
+# residual add + dropout + layer_norm
+register_pattern(_cuda_add_dropout_layer_norm(), "cuda", 45, "add_dropout_layer_norm")
+
+# get_valid_counts + non_max_suppression
+register_pattern(_cuda_get_valid_counts_nms(), "cuda", 44, "get_valid_counts_nms")
+
 # pool2d_dx
 register_pattern(_call_pool2d_dx(), "cudnn", 50, "pool2d_dx")
 
@@ -138,5 +187,6 @@ register_pattern(call_binary_ops(BATCH_MATMUL_OPS), "cutlass", 18, "batch_matmul
 
 # matmul / dense
 register_pattern(_cutlass_matmul_fusion(MATMUL_OPS), "cutlass", 10, "matmul_fusion")
-register_pattern(call_binary_ops(MATMUL_OPS), "cublas", 9, "matmul")
-register_pattern(call_binary_ops(MATMUL_OPS), "cutlass", 8, "matmul")
+register_pattern(_cublaslt_matmul_fusion(MATMUL_OPS), "cublaslt", 9, "matmul_fusion")
+register_pattern(call_binary_ops(MATMUL_OPS), "cublas", 8, "matmul")
+register_pattern(call_binary_ops(MATMUL_OPS), "cutlass", 7, "matmul")
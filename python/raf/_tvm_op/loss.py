@@ -173,3 +173,80 @@ def cross_entropy_dtrue_compute(attr, inputs, output_type):  # pylint: disable=u
 
 
 _reg.register_broadcast_schedule("raf.op.tvm.cross_entropy_dtrue")
+
+
+def _softmax_cross_entropy_valid(true, c, attrs):
+    """Whether each row is counted by the loss. The labels out of [0, c) are ignored as well."""
+    return lambda i: _tvm.tir.all(true[i] != attrs.ignore_index, true[i] >= 0, true[i] < c)
+
+
+def _softmax_cross_entropy_count(true, c, attrs):
+    """The number of the counted rows, which is at least 1 to avoid dividing by 0."""
+    valid = _softmax_cross_entropy_valid(true, c, attrs)
+    count = _topi.sum(
+        _tvm.te.compute(
+            true.shape,
+            lambda i: _tvm.tir.if_then_else(valid(i), _tvm.tir.const(1.0), _tvm.tir.const(0.0)),
+        )
+    )
+    return _tvm.te.max(count[()], _tvm.tir.const(1.0))
+
+
+@register_compute("raf.op.tvm.softmax_cross_entropy")
+def softmax_cross_entropy_compute(attrs, inputs, output_type):  # pylint: disable=unused-argument
+    true, pred = inputs
+    n, c = pred.shape
+    smoothing = attrs.label_smoothing
+    log_pred = _topi.nn.log_softmax(_topi.cast(pred, "float32"))
+    redc = _tvm.te.reduce_axis((0, c), name="rc")
+    sum_log_pred = _tvm.te.compute((n,), lambda i: _tvm.te.sum(log_pred[i, redc], axis=redc))
+    valid = _softmax_cross_entropy_valid(true, c, attrs)
+    row_loss = _tvm.te.compute(
+        (n,),
+        lambda i: _tvm.tir.if_then_else(
+            _tvm.tir.Not(valid(i)),
+            _tvm.tir.const(0.0),
+            -(1.0 - smoothing) * log_pred[i, true[i]] - smoothing / c * sum_log_pred[i],
+        ),
+    )
+    total = _topi.sum(row_loss)
+    count = _softmax_cross_entropy_count(true, c, attrs)
+    loss = _tvm.te.compute(
+        (1,),
+        lambda _: total[()] / count,
+        tag=_tvm.topi.tag.COMM_REDUCE,
+    )
+    return [loss]
+
+
+_reg.register_reduce_schedule("raf.op.tvm.softmax_cross_entropy")
+
+
+@register_compute("raf.op.tvm.softmax_cross_entropy_dpred")
+def softmax_cross_entropy_dpred_compute(
+    attrs, inputs, output_type
+):  # pylint: disable=unused-argument
+    dy, true, pred = inputs
+    _, c = pred.shape
+    smoothing = attrs.label_smoothing
+    dy = dy[()] if dy.ndim == 0 else dy[0]
+    prob = _topi.nn.softmax(_topi.cast(pred, "float32"))
+    valid = _softmax_cross_entropy_valid(true, c, attrs)
+    scale = dy / _softmax_cross_entropy_count(true, c, attrs)
+    dpred = _tvm.te.compute(
+        pred.shape,
+        lambda i, j: _tvm.tir.if_then_else(
+            _tvm.tir.Not(valid(i)),
+            _tvm.tir.const(0.0),
+            (
+                prob[i, j]
+                - smoothing / c
+                - _tvm.tir.if_then_else(j == true[i], 1.0 - smoothing, _tvm.tir.const(0.0))
+            )
+            * scale,
+        ),
+    )
+    return [_topi.cast(dpred, pred.dtype)]
+
+
+_reg.register_broadcast_schedule("raf.op.tvm.softmax_cross_entropy_dpred")
@@ -19,6 +19,30 @@ _topi = _tvm.topi  # pylint: disable=no-member
 _reg.register_injective_schedule("raf.op.tvm.pad")
 
 _reg.register_strategy("raf.op.tvm.dense", strategy.dense_strategy)
+_reg.register_strategy("raf.op.tvm.quantized_dense", strategy.dense_strategy)
+_reg.register_strategy("raf.op.tvm.sparse24_dense", strategy.dense_strategy)
+
+
+@register_compute("raf.op.tvm.prune_24")
+def compute_prune_24(attr, inputs, output_type):
+    # Keep an element if fewer than two elements in its group of four have larger magnitudes,
+    # where the ties are broken by the positions.
+    data = inputs[0]
+
+    def _fcompute(i, j):
+        base = j - j % 4
+        mag = _tvm.te.abs(data[i, j])
+        rank = 0
+        for t in range(4):
+            other = _tvm.te.abs(data[i, base + t])
+            larger = _tvm.tir.any(other > mag, _tvm.tir.all(other == mag, base + t < j))
+            rank = rank + larger.astype("int32")
+        return _tvm.tir.Select(rank < 2, data[i, j], _tvm.tir.const(0, data.dtype))
+
+    return [_tvm.te.compute(data.shape, _fcompute, name="prune_24")]
+
+
+_reg.register_injective_schedule("raf.op.tvm.prune_24")
 
 
 def compute_matmul_general(attr, inputs, output_type, transpose_a=False, transpose_b=False):
@@ -97,6 +121,20 @@ _reg.register_injective_schedule("raf.op.tvm.batch_matmul_tt")
 _reg.register_strategy("raf.op.tvm.batch_matmul_nt", strategy.batch_matmul_strategy)
 
 
+@register_compute("raf.op.tvm.grouped_matmul")
+def compute_grouped_matmul(attr, inputs, output_type):
+    # The inputs are the flattened a and b lists.
+    num_problems = len(inputs) // 2
+    transpose_b = bool(attr.transpose_b)
+    return [
+        _topi.matmul(inputs[i], inputs[num_problems + i], transp_b=transpose_b)
+        for i in range(num_problems)
+    ]
+
+
+_reg.register_injective_schedule("raf.op.tvm.grouped_matmul")
+
+
 @register_compute("raf.op.tvm.softmax", level=15)
 def compute_softmax(attr, inputs, output_type):
     return [_topi.nn.softmax(inputs[0])]
@@ -323,7 +361,6 @@ _reg.register_injective_schedule("raf.op.tvm.log_softmax_dx")
 
 @register_compute("raf.op.tvm._contrib_dropout")
 def compute_contrib_dropout(attr, inputs, output_type):
-    # pylint: disable=import-outside-toplevel
     x = inputs[0]
     p = attr.rate
     if x.dtype != "float32" and x.dtype != "float64":
@@ -349,15 +386,9 @@ def compute_contrib_dropout(attr, inputs, output_type):
             _tvm.tir.const(1 / (1 - p), "float32"),
         ),
     )
-    # reserve_space is valid in cudnn only
-    reserve_space_shape = ()
-    if len(output_type.fields[-1].shape) > 0:
-        # Reserve_space is not scalar type. It is dispatched from the base op
-        from .._ffi.backend.cudnn import GetDropoutReserveSpaceSizeInBytes
-
-        if GetDropoutReserveSpaceSizeInBytes:
-            x_ty = _tvm.relay.TensorType(x.shape, dtype=x.dtype)
-            reserve_space_shape = (GetDropoutReserveSpaceSizeInBytes(x_ty),)
+    # reserve_space is valid in cudnn and cuda only. It is not a scalar if dispatched from the
+    # base op, whose type already has the reserve space size.
+    reserve_space_shape = _topi.utils.get_const_tuple(output_type.fields[-1].shape)
     reserve_space = _topi.full(reserve_space_shape, dtype="uint8", fill_value=0.0)
     return [ret, mask, reserve_space]
 
@@ -687,6 +718,7 @@ def compute_layer_norm_train_dx(attr, inputs, output_type):
 _reg.register_schedule("raf.op.tvm.layer_norm_train_dx", schedule_generic)
 
 _reg.register_strategy("raf.op.tvm.conv2d", strategy.conv2d_strategy)
+_reg.register_strategy("raf.op.tvm.quantized_conv2d", strategy.conv2d_strategy)
 
 _reg.register_strategy("raf.op.tvm.conv2d_transpose", strategy.conv2d_transpose_strategy)
 
@@ -939,3 +971,81 @@ def batch_norm_train_dxwb_compute(attrs, inputs, output_type):  # pylint: disabl
 
 
 _reg.register_reduce_schedule("raf.op.tvm.batch_norm_train_dxwb")
+
+
+def _batch_norm_relu_axes(x, layout):
+    """Get the channel axis, the reduced axes and the reduced size of the input in the layout."""
+    shape = _topi.utils.get_const_tuple(x.shape)
+    ndim = len(shape)
+    axis = layout.index("C") if len(layout) == ndim else 1
+    num_newaxis = ndim - axis - 1
+    reduce_axes = list(range(axis)) + list(range(axis + 1, ndim))
+    reduce_size = reduce(operator.mul, [shape[i] for i in reduce_axes], 1)
+
+    def pad(data):
+        if num_newaxis == 0:
+            return data
+        return _topi.expand_dims(data, axis=1, num_newaxis=num_newaxis)
+
+    return reduce_axes, reduce_size, pad
+
+
+@register_compute("raf.op.tvm.batch_norm_relu_train")
+def batch_norm_relu_train_compute(attrs, inputs, output_type):  # pylint: disable=too-many-locals
+    x, running_m0, running_v0, w, b = inputs[:5]
+    momentum, eps = attrs.momentum, attrs.eps
+    reduce_axes, reduce_size, pad = _batch_norm_relu_axes(x, attrs.layout)
+    mean = average(x, axis=reduce_axes)
+    x_sq = _topi.multiply(x, x)
+    sq_mean = average(x_sq, axis=reduce_axes)
+    mean_sq = _topi.multiply(mean, mean)
+    var = sq_mean - mean_sq
+    running_m = running_m0 * (1 - momentum) + mean * momentum
+    running_v = running_v0 * (1 - momentum) + var * reduce_size / (reduce_size - 1) * momentum
+    var_add_eps = _topi.add(var, eps)
+    sqrt_var = _topi.sqrt(var_add_eps)
+    scale = _topi.divide(w, sqrt_var)
+    neg_mean = _topi.negative(mean)
+    shift = _topi.multiply(neg_mean, scale)
+    shift = _topi.add(shift, b)
+    y = _topi.add(_topi.multiply(x, pad(scale)), pad(shift))
+    if attrs.with_z:
+        y = _topi.add(y, inputs[5])
+    y = _topi.nn.relu(y)
+    # The reserve space is only used by cuDNN, because the relu mask is recovered from y.
+    reserve_type = output_type.fields[-1]
+    reserve_space = _topi.full(
+        _topi.utils.get_const_tuple(reserve_type.shape), reserve_type.dtype, 0
+    )
+    return [y, running_m, running_v, reserve_space]
+
+
+_reg.register_reduce_schedule("raf.op.tvm.batch_norm_relu_train")
+
+
+@register_compute("raf.op.tvm.batch_norm_relu_train_dxwb")
+def batch_norm_relu_train_dxwb_compute(attrs, inputs, output_type):  # pylint: disable=too-many-locals
+    dy, x, w, _, y = inputs
+    eps = attrs.eps
+    reduce_axes, reduce_size, pad = _batch_norm_relu_axes(x, attrs.layout)
+    zero = _tvm.tir.const(0, y.dtype)
+    dy = _topi.where(_topi.greater(y, zero), dy, _topi.cast(zero, dy.dtype))
+    mean = average(x, axis=reduce_axes)
+    x_sq = _topi.multiply(x, x)
+    sq_mean = average(x_sq, axis=reduce_axes)
+    mean_sq = _topi.multiply(mean, mean)
+    var = sq_mean - mean_sq
+    inv_sqrt_var = 1 / _topi.sqrt(var + eps)
+    sum_dy_x = _topi.sum(dy * x, axis=reduce_axes)
+    sum_dy = _topi.sum(dy, axis=reduce_axes)
+    db = sum_dy
+    dw = (sum_dy_x - mean * sum_dy) * inv_sqrt_var
+    dx = (
+        dy - pad(db / reduce_size) - (x - pad(mean)) * pad(dw * inv_sqrt_var) / reduce_size
+    ) * pad(w * inv_sqrt_var)
+    if attrs.with_z:
+        return [dx, dw, db, dy]
+    return [dx, dw, db]
+
+
+_reg.register_reduce_schedule("raf.op.tvm.batch_norm_relu_train_dxwb")
@@ -1,9 +1,145 @@
 # Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
 # SPDX-License-Identifier: Apache-2.0
 
+# pylint: disable=missing-function-docstring
 """Compute definition and schedules for random operators"""
+import math
+
+from .._lib import register_compute
+from .._lib import tvm as _tvm
 from .._lib import _reg
 from .._lib import strategy
 
 _reg.register_strategy("raf.op.tvm.threefry_generate", strategy.threefry_generate_strategy)
 _reg.register_strategy("raf.op.tvm.threefry_split", strategy.threefry_split_strategy)
+
+# Threefry-2x64 with 20 rounds (Salmon et al., SC'11). Keep in sync with Threefry2x64 in
+# src/op/dialect/cuda/kernels/device_util.cuh, so that both dialects draw the same numbers.
+_THREEFRY_PARITY = 0x1BD11BDAA9FC1A22
+_THREEFRY_ROTATIONS = [16, 42, 12, 31, 16, 32, 24, 21]
+_THREEFRY_ROUNDS = 20
+
+
+def _u64(value):
+    return _tvm.tir.const(value, "uint64")
+
+
+def _rotl(x, r):
+    if r == 0:
+        return x
+    return (x << _u64(r)) | (x >> _u64(64 - r))
+
+
+def _bind(value, body):
+    """Bind the value to a variable of body, so that the value is not duplicated in the
+    expression when body uses the variable several times."""
+    var = _tvm.tir.Var("t", value.dtype)
+    return _tvm.tir.Let(var, value, body(var))
+
+
+def _threefry_key(key):
+    """Fold the words of the key into the Threefry key and the high word of the counter."""
+    k0, k1, c1 = _u64(0), _u64(0), _u64(0)
+    for i in range(int(key.shape[0])):
+        word = _rotl(key[i], (7 * i) % 64)
+        if i % 2 == 0:
+            k0 = k0 ^ word
+        else:
+            k1 = k1 ^ word
+        c1 = c1 + key[i]
+    return k0, k1, c1
+
+
+def _threefry(key, c0, body):
+    """The expression body(x0, x1), where (x0, x1) are the random bits of the counter c0."""
+    k0, k1, c1 = _threefry_key(key)
+
+    def rounds(r, x0, x1, ks):
+        if r == _THREEFRY_ROUNDS:
+            return body(x0, x1)
+
+        def mix(y0):
+            def inject(y1):
+                if r % 4 != 3:
+                    return rounds(r + 1, y0, y1, ks)
+                s = (r + 1) // 4
+                return _bind(
+                    y0 + ks[s % 3],
+                    lambda z0: _bind(
+                        y1 + ks[(s + 1) % 3] + _u64(s), lambda z1: rounds(r + 1, z0, z1, ks)
+                    ),
+                )
+
+            return _bind(_rotl(x1, _THREEFRY_ROTATIONS[r % 8]) ^ y0, inject)
+
+        return _bind(x0 + x1, mix)
+
+    def start(ks):
+        return _bind(c0 + ks[0], lambda x0: _bind(c1 + ks[1], lambda x1: rounds(0, x0, x1, ks)))
+
+    return _bind(
+        k0,
+        lambda v0: _bind(
+            k1, lambda v1: _bind(_u64(_THREEFRY_PARITY) ^ v0 ^ v1, lambda v2: start([v0, v1, v2]))
+        ),
+    )
+
+
+def _flat_index(shape, indices):
+    """The row-major position of indices in shape as uint64, which is the Threefry counter."""
+    index = _u64(0)
+    for dim, idx in zip(shape, indices):
+        index = index * _u64(int(dim)) + idx.astype("uint64")
+    return index
+
+
+def _to_unit_float(bits):
+    """Map the top 24 bits to a float32 in [0, 1)."""
+    return (bits >> _u64(40)).astype("float32") * _tvm.tir.const(1.0 / (1 << 24), "float32")
+
+
+@register_compute("raf.op.tvm.threefry_uniform")
+def threefry_uniform_compute(attrs, inputs, output_type):
+    key = inputs[0]
+    low = _tvm.tir.const(attrs.low, "float32")
+    scale = _tvm.tir.const(attrs.high - attrs.low, "float32")
+
+    def uniform(x0, _):
+        return (low + scale * _to_unit_float(x0)).astype(output_type.dtype)
+
+    shape = output_type.shape
+    out = _tvm.te.compute(
+        shape,
+        lambda *indices: _threefry(key, _flat_index(shape, indices), uniform),
+        tag=_tvm.topi.tag.INJECTIVE,
+    )
+    return [out]
+
+
+_reg.register_injective_schedule("raf.op.tvm.threefry_uniform")
+
+
+@register_compute("raf.op.tvm.threefry_normal")
+def threefry_normal_compute(attrs, inputs, output_type):
+    key = inputs[0]
+    mean = _tvm.tir.const(attrs.mean, "float32")
+    stddev = _tvm.tir.const(attrs.stddev, "float32")
+
+    def normal(x0, x1):
+        # Box-Muller, where u1 is in (0, 1] so that its log is finite.
+        u1 = _to_unit_float(x0) + _tvm.tir.const(1.0 / (1 << 24), "float32")
+        u2 = _to_unit_float(x1)
+        radius = _tvm.te.sqrt(_tvm.tir.const(-2.0, "float32") * _tvm.te.log(u1))
+        z = radius * _tvm.te.cos(_tvm.tir.const(2.0 * math.pi, "float32") * u2)
+        return (mean + stddev * z).astype(output_type.dtype)
+
+    shape = output_type.shape
+    out = _tvm.te.compute(
+        shape,
+        lambda *indices: _threefry(key, _flat_index(shape, indices), normal),
+        tag=_tvm.topi.tag.INJECTIVE,
+    )
+    return [out]
+
+
+_reg.register_injective_schedule("raf.op.tvm.threefry_normal")
@@ -0,0 +1,164 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=missing-function-docstring, missing-module-docstring
+# pylint: disable=unused-argument, invalid-name, too-many-locals
+from .._lib import register_compute
+from .._lib import tvm as _tvm
+from .._lib import _reg
+
+_topi = _tvm.topi  # pylint: disable=no-member
+
+
+def _is_gpu():
+    return "gpu" in _tvm.target.Target.current(allow_none=False).keys
+
+
+def _num_threads(extent):
+    target = _tvm.target.Target.current(allow_none=False)
+    return min(int(target.max_num_threads), _topi.utils.get_const_int(extent))
+
+
+def _csr_spmm_ir(indptr, indices, values, dense, out):
+    """out[i, j] = sum(values[p] * dense[indices[p], j]) over the non-zeros p of row i."""
+    ib = _tvm.tir.ir_builder.create()
+    m, n = out.shape
+    indptr = ib.buffer_ptr(indptr)
+    indices = ib.buffer_ptr(indices)
+    values = ib.buffer_ptr(values)
+    dense = ib.buffer_ptr(dense)
+    out = ib.buffer_ptr(out)
+
+    def row(i, j):
+        acc = ib.allocate(out.dtype, (1,), name="acc", scope="local")
+        acc[0] = _tvm.tir.const(0, out.dtype)
+        with ib.for_range(indptr[i], indptr[i + 1], name="p") as p:
+            acc[0] += values[p] * dense[indices[p] * n + j]
+        out[i * n + j] = acc[0]
+
+    if _is_gpu():
+        nthread_tx = _num_threads(n)
+        tx = _tvm.te.thread_axis("threadIdx.x")
+        bx = _tvm.te.thread_axis("blockIdx.x")
+        ib.scope_attr(tx, "thread_extent", nthread_tx)
+        ib.scope_attr(bx, "thread_extent", m)
+        with ib.for_range(0, _topi.utils.ceil_div(n, nthread_tx), name="k") as k:
+            j = k * nthread_tx + tx
+            with ib.if_scope(j < n):
+                row(bx, j)
+    else:
+        with ib.for_range(0, m, name="i", kind="parallel") as i:
+            with ib.for_range(0, n, name="j") as j:
+                row(i, j)
+    return ib.get()
+
+
+def _csr_spmm_tn_ir(indptr, indices, values, dense, out):
+    """out[indices[p], j] += values[p] * dense[i, j] over the non-zeros p of each row i. Each
+    thread owns a column of out, so the accumulation needs no atomics."""
+    ib = _tvm.tir.ir_builder.create()
+    m = dense.shape[0]
+    k, n = out.shape
+    indptr = ib.buffer_ptr(indptr)
+    indices = ib.buffer_ptr(indices)
+    values = ib.buffer_ptr(values)
+    dense = ib.buffer_ptr(dense)
+    out = ib.buffer_ptr(out)
+
+    def column(j):
+        with ib.for_range(0, k, name="r") as r:
+            out[r * n + j] = _tvm.tir.const(0, out.dtype)
+        with ib.for_range(0, m, name="i") as i:
+            with ib.for_range(indptr[i], indptr[i + 1], name="p") as p:
+                out[indices[p] * n + j] += values[p] * dense[i * n + j]
+
+    if _is_gpu():
+        nthread_tx = _num_threads(n)
+        tx = _tvm.te.thread_axis("threadIdx.x")
+        bx = _tvm.te.thread_axis("blockIdx.x")
+        ib.scope_attr(tx, "thread_extent", nthread_tx)
+        ib.scope_attr(bx, "thread_extent", _topi.utils.ceil_div(n, nthread_tx))
+        j = bx * nthread_tx + tx
+        with ib.if_scope(j < n):
+            column(j)
+    else:
+        with ib.for_range(0, n, name="j", kind="parallel") as j:
+            column(j)
+    return ib.get()
+
+
+def _csr_sddmm_ir(indptr, indices, x1, x2, out):
+    """out[p] = dot(x1[i], x2[indices[p]]) for the non-zeros p of each row i."""
+    ib = _tvm.tir.ir_builder.create()
+    m, d = x1.shape
+    indptr = ib.buffer_ptr(indptr)
+    indices = ib.buffer_ptr(indices)
+    x1 = ib.buffer_ptr(x1)
+    x2 = ib.buffer_ptr(x2)
+    out = ib.buffer_ptr(out)
+
+    def nonzero(i, p):
+        acc = ib.allocate(out.dtype, (1,), name="acc", scope="local")
+        acc[0] = _tvm.tir.const(0, out.dtype)
+        with ib.for_range(0, d, name="t") as t:
+            acc[0] += x1[i * d + t] * x2[indices[p] * d + t]
+        out[p] = acc[0]
+
+    if _is_gpu():
+        nthread_tx = _num_threads(out.shape[0])
+        tx = _tvm.te.thread_axis("threadIdx.x")
+        bx = _tvm.te.thread_axis("blockIdx.x")
+        ib.scope_attr(tx, "thread_extent", nthread_tx)
+        ib.scope_attr(bx, "thread_extent", m)
+        start, end = indptr[bx], indptr[bx + 1]
+        with ib.for_range(0, _topi.utils.ceil_div(end - start, nthread_tx), name="k") as k:
+            p = start + k * nthread_tx + tx
+            with ib.if_scope(p < end):
+                nonzero(bx, p)
+    else:
+        with ib.for_range(0, m, name="i", kind="parallel") as i:
+            with ib.for_range(indptr[i], indptr[i + 1], name="p") as p:
+                nonzero(i, p)
+    return ib.get()
+
+
+def _extern(name, out_shape, dtype, inputs, fir):
+    return _tvm.te.extern(
+        [out_shape],
+        inputs,
+        lambda ins, outs: fir(*ins, outs[0]),
+        dtype=[dtype],
+        name=name,
+        tag=name,
+    )
+
+
+@register_compute("raf.op.tvm.csr_spmm")
+def csr_spmm_compute(attrs, inputs, output_type):
+    indptr, indices, values, dense = inputs
+    out_shape = [indptr.shape[0] - 1, dense.shape[1]]
+    return [_extern("csr_spmm", out_shape, dense.dtype, inputs, _csr_spmm_ir)]
+
+
+@register_compute("raf.op.tvm.csr_spmm_tn")
+def csr_spmm_tn_compute(attrs, inputs, output_type):
+    dense = inputs[3]
+    out_shape = [int(dim) for dim in attrs.dims]
+    return [_extern("csr_spmm_tn", out_shape, dense.dtype, inputs, _csr_spmm_tn_ir)]
+
+
+@register_compute("raf.op.tvm.csr_sddmm")
+def csr_sddmm_compute(attrs, inputs, output_type):
+    indices, x1 = inputs[1], inputs[2]
+    return [_extern("csr_sddmm", [indices.shape[0]], x1.dtype, inputs, _csr_sddmm_ir)]
+
+
+def schedule_sparse(attrs, outs, target):
+    # The extern kernels bind their own threads.
+    with target:
+        return _tvm.te.create_schedule([x.op for x in outs])
+
+
+_reg.register_schedule("raf.op.tvm.csr_spmm", schedule_sparse)
+_reg.register_schedule("raf.op.tvm.csr_spmm_tn", schedule_sparse)
+_reg.register_schedule("raf.op.tvm.csr_sddmm", schedule_sparse)
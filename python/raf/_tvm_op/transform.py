@@ -30,6 +30,91 @@ def embedding_compute(attrs, inputs, output_type):
 _reg.register_injective_schedule("raf.op.tvm.embedding")
 
 
+@register_compute("raf.op.tvm.embedding_position")
+def embedding_position_compute(attrs, inputs, output_type):
+    x, indices, position, position_ids = inputs
+    out = _topi.add(_topi.take(x, indices, axis=0), _topi.take(position, position_ids, axis=0))
+    return [out]
+
+
+_reg.register_injective_schedule("raf.op.tvm.embedding_position")
+
+
+def _kv_cache_append_ir(data, slots, out):
+    """Write each token of data to its slot of out, which shares the buffer of the cache."""
+    ib = _tvm.tir.ir_builder.create()
+    num_tokens = data.shape[0]
+    row = _topi.utils.get_const_int(_topi.utils.prod(data.shape[1:]))
+    data = ib.buffer_ptr(data)
+    slots = ib.buffer_ptr(slots)
+    out = ib.buffer_ptr(out)
+
+    def write(token, k):
+        slot = _topi.cast(slots[token], "int64")
+        with ib.if_scope(slot >= 0):
+            src = _topi.cast(token, "int64") * row + _topi.cast(k, "int64")
+            out[slot * row + _topi.cast(k, "int64")] = data[src]
+
+    target = _tvm.target.Target.current(allow_none=False)
+    if "gpu" in target.keys:
+        nthread_tx = min(int(target.max_num_threads), row)
+        tx = _tvm.te.thread_axis("threadIdx.x")
+        bx = _tvm.te.thread_axis("blockIdx.x")
+        ib.scope_attr(tx, "thread_extent", nthread_tx)
+        ib.scope_attr(bx, "thread_extent", num_tokens)
+        with ib.for_range(0, _topi.utils.ceil_div(row, nthread_tx), name="j") as j:
+            k = j * nthread_tx + tx
+            with ib.if_scope(k < row):
+                write(bx, k)
+    else:
+        with ib.for_range(0, num_tokens, name="i", kind="parallel") as i:
+            with ib.for_range(0, row, name="k") as k:
+                write(i, k)
+    return ib.get()
+
+
+@register_compute("raf.op.tvm.kv_cache_append")
+def kv_cache_append_compute(attrs, inputs, output_type):
+    cache, data, slots = inputs
+    out_buf = _tvm.tir.decl_buffer(cache.shape, cache.dtype, "out_buf", data_alignment=8)
+    # Only the new tokens are written, since the output shares the buffer of the cache.
+    out = _tvm.te.extern(
+        [cache.shape],
+        [data, slots],
+        lambda ins, outs: _kv_cache_append_ir(ins[0], ins[1], outs[0]),
+        dtype=[cache.dtype],
+        out_buffers=[out_buf],
+        name="kv_cache_append",
+        tag="kv_cache_append",
+    )
+    return [out]
+
+
+def schedule_kv_cache_append(attrs, outs, target):
+    # The extern kernel binds its own threads.
+    with target:
+        return _tvm.te.create_schedule([x.op for x in outs])
+
+
+_reg.register_schedule("raf.op.tvm.kv_cache_append", schedule_kv_cache_append)
+
+
+@register_compute("raf.op.tvm.kv_cache_gather")
+def kv_cache_gather_compute(attrs, inputs, output_type):
+    cache, block_table = inputs
+    block_size = cache.shape[1]
+    out_shape = [block_table.shape[0], block_table.shape[1] * block_size] + list(cache.shape[2:])
+
+    def fcompute(b, i, *rest):
+        block = block_table[b, _tvm.tir.indexdiv(i, block_size)]
+        return cache[(block, _tvm.tir.indexmod(i, block_size)) + rest]
+
+    return [_tvm.te.compute(out_shape, fcompute)]
+
+
+_reg.register_injective_schedule("raf.op.tvm.kv_cache_gather")
+
+
 @register_compute("raf.op.tvm.transpose_dx")
 def transpose_dx_compute(attrs, inputs, output_type):
     dy = inputs[0]
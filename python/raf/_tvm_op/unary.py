@@ -31,6 +31,44 @@ _reg.register_broadcast_schedule("raf.op.tvm.sigmoid")
 _reg.register_broadcast_schedule("raf.op.tvm.tanh")
 
 
+def use_fast_math(op_name):
+    """Whether to lower the base op with the fast math approximations, which is enabled per op by
+    the "raf.tvm.fast_math" config of the current PassContext, e.g., ["raf.op.gelu"]. Note that
+    the fast exp and tanh of TOPI only approximate float32 and use the precise ones otherwise."""
+    ops = _tvm.transform.PassContext.current().config.get("raf.tvm.fast_math", [])
+    return op_name in [str(op) for op in ops]
+
+
+@register_compute("raf.op.tvm.exp")
+def exp_compute(attrs, inputs, output_type):
+    if use_fast_math("raf.op.exp"):
+        return [_tvm.topi.fast_exp(inputs[0])]
+    return [_tvm.topi.exp(inputs[0])]
+
+
+@register_compute("raf.op.tvm.erf")
+def erf_compute(attrs, inputs, output_type):
+    if use_fast_math("raf.op.erf"):
+        return [_tvm.topi.fast_erf(inputs[0])]
+    return [_tvm.topi.erf(inputs[0])]
+
+
+@register_compute("raf.op.tvm.tanh")
+def tanh_compute(attrs, inputs, output_type):
+    if use_fast_math("raf.op.tanh"):
+        return [_tvm.topi.fast_tanh(inputs[0])]
+    return [_tvm.topi.tanh(inputs[0])]
+
+
+@register_compute("raf.op.tvm.sigmoid")
+def sigmoid_compute(attrs, inputs, output_type):
+    x = inputs[0]
+    if use_fast_math("raf.op.sigmoid"):
+        const_1 = _tvm.tir.const(1, dtype=x.dtype)
+        return [_tvm.topi.divide(const_1, const_1 + _tvm.topi.fast_exp(_tvm.topi.negative(x)))]
+    return [_tvm.topi.sigmoid(x)]
+
+
 def select_unary_dx_input(attrs, inputs, x_or_y):
     """Select the required input based on the grad_mode to calculate the gradient.
     x_or_y=True selects x; otherwise y.
@@ -63,6 +101,9 @@ _reg.register_broadcast_schedule("raf.op.tvm.trunc")
 @register_compute("raf.op.tvm.erf_dx")
 def erf_dx_compute(attrs, inputs, output_type):
     x, dy = select_unary_dx_input(attrs, inputs, True)
+    if use_fast_math("raf.op.erf_dx"):
+        const_scale = _tvm.tir.const(2 / math.sqrt(math.pi), dtype=dy.dtype)
+        return [const_scale * _tvm.topi.fast_exp(_tvm.topi.negative(x * x)) * dy]
     return [
         _tvm.te.compute(
             x.shape,
@@ -98,6 +139,12 @@ def gelu_compute(attrs, inputs, output_type):
     # gelu is data  * normcdf(data)
     const_point_5 = _tvm.tir.const(0.5, dtype=data.dtype)
     const_1 = _tvm.tir.const(1, dtype=data.dtype)
+    if use_fast_math("raf.op.gelu"):
+        # The tanh approximation: 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+        const_k = _tvm.tir.const(math.sqrt(2 / math.pi), dtype=data.dtype)
+        const_c = _tvm.tir.const(0.044715, dtype=data.dtype)
+        inner = const_k * (data + const_c * data * data * data)
+        return [const_point_5 * data * (const_1 + _tvm.topi.fast_tanh(inner))]
     const_sqrt_2 = _tvm.tir.const(math.sqrt(2), dtype=data.dtype)
     return [data * (const_point_5 * (const_1 + _tvm.topi.erf(data / const_sqrt_2)))]
 
@@ -111,6 +158,15 @@ def gelu_dx_compute(attrs, inputs, output_type):
     const_point_5 = _tvm.tir.const(0.5, dtype=x.dtype)
     const_minus_point_5 = _tvm.tir.const(-0.5, dtype=x.dtype)
     const_1 = _tvm.tir.const(1, dtype=x.dtype)
+    if use_fast_math("raf.op.gelu_dx"):
+        # The derivative of the tanh approximation, where t = tanh(k * (x + c * x^3)):
+        # 0.5 * (1 + t) + 0.5 * x * (1 - t^2) * k * (1 + 3 * c * x^2)
+        const_k = _tvm.tir.const(math.sqrt(2 / math.pi), dtype=x.dtype)
+        const_c = _tvm.tir.const(0.044715, dtype=x.dtype)
+        const_3c = _tvm.tir.const(3 * 0.044715, dtype=x.dtype)
+        t = _tvm.topi.fast_tanh(const_k * (x + const_c * x * x * x))
+        dt = (const_1 - t * t) * const_k * (const_1 + const_3c * x * x)
+        return [dy * const_point_5 * (const_1 + t + x * dt)]
     const_sqrt_2 = _tvm.tir.const(math.sqrt(2), dtype=x.dtype)
     const_sqrt_pi = _tvm.tir.const(math.sqrt(math.pi), dtype=x.dtype)
     # cdf = 0.5 * (1 + erf(x/sqrt(2)))
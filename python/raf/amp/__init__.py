@@ -3,4 +3,5 @@
 
 """Automatic mixed precision (AMP) module"""
 from .amp import autocast, CustomTypeHint
+from .loss_scaler import DynamicLossScaler
 from . import type_hints
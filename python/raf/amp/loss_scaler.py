@@ -0,0 +1,76 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Dynamic loss scaling for mixed precision training."""
+# pylint: disable=protected-access, too-many-arguments, too-few-public-methods
+from raf._core.ndarray import array
+from raf._op import sym as _op
+from raf.model import trace_mutate_attr
+
+
+class DynamicLossScaler:
+    """Dynamic loss scaling, whose state stays on the device. Given to an optimizer wrapper such
+    as `raf.optim.adam.with_adam`, the output gradient is multiplied by the loss scale, the
+    optimizer kernel unscales the gradients and skips the step if they overflow, and the loss
+    scale is then updated, all without reading the overflow flag back to the host.
+
+    Parameters
+    ----------
+    init_scale: float
+        The initial loss scale. Default: 2**15, the largest power of two in float16.
+
+    growth_factor: float
+        The factor to grow the scale by after growth_interval steps without overflow. Default: 2
+
+    backoff_factor: float
+        The factor to shrink the scale by when the gradients overflow. Default: 0.5
+
+    growth_interval: int
+        The number of steps in a row without overflow to grow the scale. Default: 2000
+
+    min_scale: float
+        The smallest loss scale. Default: 1
+    """
+
+    def __init__(
+        self,
+        init_scale=2.0**15,
+        growth_factor=2.0,
+        backoff_factor=0.5,
+        growth_interval=2000,
+        min_scale=1.0,
+    ):
+        assert growth_factor > 1.0 and 0.0 < backoff_factor < 1.0
+        self.init_scale = init_scale
+        self.growth_factor = growth_factor
+        self.backoff_factor = backoff_factor
+        self.growth_interval = growth_interval
+        self.min_scale = min_scale
+
+    def init_state(self, wrapper, device):
+        """Create the loss scale and the number of steps without overflow as the states of the
+        optimizer wrapper, which are float32 scalars on the device."""
+        wrapper.loss_scale = array(self.init_scale, dtype="float32", device=device)
+        wrapper.good_steps = array(0.0, dtype="float32", device=device)
+
+    @staticmethod
+    def scale(wrapper, dy):
+        """Scale the output gradient dy by the loss scale, which is multiplied in float32."""
+        scaled = _op.multiply(_op.cast(dy, "float32"), wrapper.loss_scale)
+        return _op.cast_like(scaled, dy)
+
+    def update(self, wrapper, grad_norm):
+        """Update the loss scale given the global norm of the scaled gradients, which is inf or
+        nan if they overflow. This must be traced after the loss scale is used by the optimizer.
+        """
+        new_state = _op.update_loss_scale(
+            grad_norm,
+            wrapper.loss_scale,
+            wrapper.good_steps,
+            self.growth_factor,
+            self.backoff_factor,
+            self.growth_interval,
+            self.min_scale,
+        )
+        trace_mutate_attr(wrapper, "loss_scale", new_state[0])
+        trace_mutate_attr(wrapper, "good_steps", new_state[1])
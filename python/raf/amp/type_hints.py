@@ -10,6 +10,7 @@ Here are some type hint examples:
 
 - PrimType("float32"): The argument must be in float32.
 - PrimType("float16"): The argument should be in the specified AMP dtype (float16 in this case).
+    The AMP dtype is float16 or bfloat16, which is set by the pass config "raf.amp.dtype".
 - PrimType(None): Do not change the dtype of this argument. It means if the argument has been
     casted to the AMP dtype, we need to cast it back.
 
@@ -101,6 +102,30 @@ def generic_cast(cast_to_amp, castable_arg_num_or_list):
     return _gen
 
 
+def dtype_policy_cast(default_rule, dtype_rules):
+    """The cast rule that depends on the AMP dtype. It looks up the rule of the AMP dtype in the
+    precision policy table, and falls back to the default rule.
+
+    Parameters
+    ----------
+    default_rule : Callable[[List[Expr], Type, str], List[Type]]
+        The cast rule of the AMP dtypes that are not in the table.
+
+    dtype_rules : Dict[str, Callable[[List[Expr], Type, str], List[Type]]]
+        The precision policy table, which maps an AMP dtype to its cast rule.
+
+    Returns
+    -------
+    gen: Callable[[List[Expr], Type], List[Type]]
+        The cast rule function.
+    """
+
+    def _gen(args, ret_type, amp_dtype):
+        return dtype_rules.get(amp_dtype, default_rule)(args, ret_type, amp_dtype)
+
+    return _gen
+
+
 # Always cast.
 register_op_cast_rule("raf.op.conv2d", generic_cast(True, 2))
 register_op_cast_rule("raf.op.conv2d_dx", generic_cast(True, 3))
@@ -110,6 +135,7 @@ register_op_cast_rule("raf.op.conv2d_transpose_dx", generic_cast(True, 3))
 register_op_cast_rule("raf.op.conv2d_transpose_dw", generic_cast(True, 3))
 register_op_cast_rule("raf.op.matmul", generic_cast(True, 2))
 register_op_cast_rule("raf.op.dense", generic_cast(True, 2))
+register_op_cast_rule("raf.op.sparse24_dense", generic_cast(True, 2))
 register_op_cast_rule("raf.op.matmul_nt", generic_cast(True, 2))
 register_op_cast_rule("raf.op.matmul_tn", generic_cast(True, 2))
 register_op_cast_rule("raf.op.matmul_tt", generic_cast(True, 2))
@@ -117,15 +143,35 @@ register_op_cast_rule("raf.op.batch_matmul", generic_cast(True, 2))
 register_op_cast_rule("raf.op.batch_matmul_nt", generic_cast(True, 2))
 register_op_cast_rule("raf.op.batch_matmul_tn", generic_cast(True, 2))
 register_op_cast_rule("raf.op.batch_matmul_tt", generic_cast(True, 2))
+register_op_cast_rule("raf.op.grouped_matmul", generic_cast(True, 2))
+register_op_cast_rule("raf.op.csr_spmm", generic_cast(True, [2, 3]))
+register_op_cast_rule("raf.op.csr_spmm_tn", generic_cast(True, [2, 3]))
+register_op_cast_rule("raf.op.csr_sddmm", generic_cast(True, [2, 3]))
+
+# Never cast in float16, whose range is too narrow for their outputs. bfloat16 has the range of
+# float32, so they are cast in bfloat16.
+for _op_name in ["raf.op.exp", "raf.op.power", "raf.op.reciprocal"]:
+    register_op_cast_rule(
+        _op_name, dtype_policy_cast(generic_cast(False, 1), {"bfloat16": generic_cast(True, 1)})
+    )
 
 # Never cast.
 register_op_cast_rule("raf.op.arange", generic_cast(False, 3))
-register_op_cast_rule("raf.op.exp", generic_cast(False, 1))
-register_op_cast_rule("raf.op.power", generic_cast(False, 1))
-register_op_cast_rule("raf.op.reciprocal", generic_cast(False, 1))
+register_op_cast_rule("raf.op.quantized_dense", generic_cast(False, 2))
+register_op_cast_rule("raf.op.quantized_conv2d", generic_cast(False, 2))
 register_op_cast_rule("raf.op.softmax", generic_cast(False, 1))
 register_op_cast_rule("raf.op.softmax_dx", generic_cast(False, 2))
 register_op_cast_rule("raf.op.lans", generic_cast(False, 2))
+register_op_cast_rule("raf.op.multi_tensor_sgd", generic_cast(False, 1))
+register_op_cast_rule("raf.op.multi_tensor_adam", generic_cast(False, 2))
+register_op_cast_rule("raf.op.global_norm_and_check", generic_cast(False, 1))
+register_op_cast_rule("raf.op.update_loss_scale", generic_cast(False, 3))
+# The caches are updated in place, so the new keys and values are kept in the dtype of the caches.
+register_op_cast_rule("raf.op.kv_cache_append", generic_cast(False, 2))
+# The embedding tables and their caches are updated in place, so they are never cast, and the
+# gradients are kept in float32 as the tables.
+register_op_cast_rule("raf.op.embedding_cache", generic_cast(False, 0))
+register_op_cast_rule("raf.op.embedding_cache_sgd", generic_cast(False, [1]))
 register_op_cast_rule("raf.op.log_softmax", generic_cast(False, 1))
 register_op_cast_rule("raf.op.log_softmax_dx", generic_cast(False, 2))
 register_op_cast_rule("raf.op.erf", generic_cast(False, 1))
@@ -141,11 +187,16 @@ register_op_cast_rule("raf.op.nll_loss_dtrue", generic_cast(False, 3))
 register_op_cast_rule("raf.op.cross_entropy", generic_cast(False, 2))
 register_op_cast_rule("raf.op.cross_entropy_dpred", generic_cast(False, 2))
 register_op_cast_rule("raf.op.cross_entropy_dtrue", generic_cast(False, 2))
+# The fused softmax cross entropy reads the logits in the AMP dtype and accumulates the loss in
+# float32, so only the logits are casted.
+register_op_cast_rule("raf.op.softmax_cross_entropy", generic_cast(True, [1]))
+register_op_cast_rule("raf.op.softmax_cross_entropy_dpred", generic_cast(True, [2]))
 
 # embedding_dx/take_dx has accuracy issue and its performance does not improve significantly
 # over float32, so never cast.
 register_op_cast_rule("raf.op.take_dx", generic_cast(3, False))
 register_op_cast_rule("raf.op.embedding_dx", generic_cast(2, False))
+register_op_cast_rule("raf.op.embedding_dx_sparse", generic_cast(2, False))
 
 # FIXME: These ops should support float16, but the current TVM code results in
 # either runtime error or mismatch outputs.
@@ -226,6 +277,7 @@ register_op_cast_rule("raf.op.logical_not", infer_cast(1))
 register_op_cast_rule("raf.op.relu", infer_cast(1))
 register_op_cast_rule("raf.op.copy", infer_cast(1))
 register_op_cast_rule("raf.op.abs", infer_cast(1))
+register_op_cast_rule("raf.op.prune_24", infer_cast(1))
 register_op_cast_rule("raf.op.all", infer_cast(1))
 register_op_cast_rule("raf.op.any", infer_cast(1))
 register_op_cast_rule("raf.op.ceil", infer_cast(1))
@@ -281,6 +333,8 @@ register_op_cast_rule("raf.op.repeat_dx", infer_cast(3))
 register_op_cast_rule("raf.op.expand_dims", infer_cast(1))
 register_op_cast_rule("raf.op.threefry_generate", infer_cast(1))
 register_op_cast_rule("raf.op.threefry_split", infer_cast(1))
+register_op_cast_rule("raf.op.threefry_uniform", generic_cast(False, 1))
+register_op_cast_rule("raf.op.threefry_normal", generic_cast(False, 1))
 register_op_cast_rule("raf.op.strided_slice", infer_cast(1))
 register_op_cast_rule("raf.op.strided_slice_dx", infer_cast(1))
 register_op_cast_rule("raf.op.sequence_mask", infer_cast(1))
@@ -292,6 +346,7 @@ register_op_cast_rule("raf.op.squeeze", infer_cast(1))
 register_op_cast_rule("raf.op.stack", infer_cast(1))
 register_op_cast_rule("raf.op.scatter", infer_cast(1))
 register_op_cast_rule("raf.op.scatter_dx", infer_cast(3))
+register_op_cast_rule("raf.op.kv_cache_gather", infer_cast(1))
 register_op_cast_rule("raf.op.clip", infer_cast(1))
 register_op_cast_rule("raf.op.clip_dx", infer_cast(2))
 register_op_cast_rule("raf.op.get_valid_counts", infer_cast(1))
@@ -327,6 +382,7 @@ register_op_cast_rule("raf.op.size", infer_cast(1))
 register_op_cast_rule("raf.op.numel", infer_cast(1))
 register_op_cast_rule("raf.op.shape_as_tensor", infer_cast(1))
 register_op_cast_rule("raf.op.embedding", infer_cast(2))
+register_op_cast_rule("raf.op.embedding_position", infer_cast([0, 2]))
 register_op_cast_rule("raf.op.take", infer_cast(2))
 
 # Special cases.
@@ -419,6 +475,27 @@ register_op_cast_rule("raf.op.batch_norm_train", op_cast_norm(1))
 register_op_cast_rule("raf.op.batch_norm_train_dxwb", op_cast_norm(2))
 
 
+
+def op_cast_batch_norm_relu_train(args, ret_type, amp_dtype):
+    """It has args in order (x, running_mean, running_var, w, b, z, momentum, eps, layout), where
+    the residual input z, if given, follows x."""
+    ret = op_cast_norm(1)(args, ret_type, amp_dtype)
+    if not isinstance(args[5], relay.Constant):
+        ret[5] = PrimType(amp_dtype)
+    return ret
+
+
+def op_cast_batch_norm_relu_train_dxwb(args, ret_type, amp_dtype):
+    """It has args in order (dy, x, w, b, y, reserve_space, with_z, eps, layout), where dy, x and
+    y are in the data type."""
+    ret = op_cast_norm(2)(args, ret_type, amp_dtype)
+    ret[4] = PrimType(amp_dtype)
+    return ret
+
+
+register_op_cast_rule("raf.op.batch_norm_relu_train", op_cast_batch_norm_relu_train)
+register_op_cast_rule("raf.op.batch_norm_relu_train_dxwb", op_cast_batch_norm_relu_train_dxwb)
+
 register_op_cast_rule("raf.op.layer_norm", infer_cast(1))
 register_op_cast_rule("raf.op.layer_norm_dx", infer_cast(3))
 
@@ -451,6 +528,59 @@ register_op_cast_rule("raf.op.layer_norm_train", op_cast_layer_norm_train)
 register_op_cast_rule("raf.op.layer_norm_train_dx", op_cast_layer_norm_train_dx)
 
 
+def op_cast_add_dropout_layer_norm(args, ret_type, amp_dtype):
+    """It has args in order (x, residual, scale, bias, p, eps). Like layer_norm_train, all tensors
+    follow the dtype of x."""
+    ret = [PrimType(args[0].checked_type.dtype) for _ in range(4)]
+    ret += [PrimType(None) for _ in range(len(args) - 4)]
+    return ret
+
+
+def op_cast_add_dropout_layer_norm_dx(args, ret_type, amp_dtype):
+    """It has args in order (dy, dz, z, scale, mean, invvar, rng_state, p), where mean and invvar
+    are always in float32."""
+    dtype = args[2].checked_type.dtype
+    ret = [PrimType(dtype) for _ in range(4)]
+    ret += [PrimType("float32"), PrimType("float32")]
+    ret += [PrimType(None) for _ in range(len(args) - 6)]
+    return ret
+
+
+register_op_cast_rule("raf.op.add_dropout_layer_norm", op_cast_add_dropout_layer_norm)
+register_op_cast_rule("raf.op.add_dropout_layer_norm_dx", op_cast_add_dropout_layer_norm_dx)
+
+
+def op_cast_follow_first(data_num):
+    """The first data_num tensors follow the dtype of the 1st arg, like layer_norm_train."""
+
+    def _gen_rules(args, ret_type, amp_dtype):
+        ret = [PrimType(args[0].checked_type.dtype) for _ in range(data_num)]
+        ret += [PrimType(None) for _ in range(len(args) - data_num)]
+        return ret
+
+    return _gen_rules
+
+
+# rms_norm has args (x, scale, eps) and rms_norm_dx has (x, scale, dy, eps).
+register_op_cast_rule("raf.op.rms_norm", op_cast_follow_first(2))
+register_op_cast_rule("raf.op.rms_norm_dx", op_cast_follow_first(3))
+# The position tables (cos, sin) are cast to the dtype of x.
+register_op_cast_rule("raf.op.rotary_embedding", op_cast_follow_first(3))
+
+
+def op_cast_attention_dx(args, ret_type, amp_dtype):
+    """It has args in order (q, k, v, out, dy, lse, rng_state, scale, causal, p), where lse is
+    always in float32."""
+    ret = [PrimType(amp_dtype) for _ in range(5)]
+    ret += [PrimType("float32")]
+    ret += [PrimType(None) for _ in range(len(args) - 6)]
+    return ret
+
+
+register_op_cast_rule("raf.op.attention", generic_cast(True, 3))
+register_op_cast_rule("raf.op.attention_dx", op_cast_attention_dx)
+
+
 def op_cast_concatenate(args, ret_type, amp_dtype):
     """Concatenate may have too many inputs that exceeds the GPU register when using the injective
     schedule with float16, so we make a heuristic that prevents concat from being executed with
@@ -51,6 +51,21 @@ def with_cutlass():
     return build_info.use_cutlass() != "OFF"
 
 
+def with_cupti():
+    """Whether the CUPTI kernel tracer is enabled."""
+    return build_info.use_cupti() != "OFF"
+
+
+def with_nvtx():
+    """Whether the NVTX ranges are enabled."""
+    return build_info.use_nvtx() != "OFF"
+
+
+def with_cusparselt():
+    """Whether cuSPARSELt is enabled."""
+    return build_info.use_cusparselt() != "OFF"
+
+
 def cmake_build_type():
     """Return cmake build type"""
     return build_info.cmake_build_type()
@@ -68,19 +83,29 @@ def build_with(backend):  # pylint: disable=too-many-return-statements
     -------
     Whether the backend is built with RAF.
     """
-    assert backend in ["tvm", "cuda", "cudnn", "cutlass", "cublas", "nccl"], (
-        "Invalid backend: %s" % backend
-    )
+    assert backend in [
+        "tvm",
+        "cuda",
+        "cudnn",
+        "cutlass",
+        "cublas",
+        "cublaslt",
+        "cusparse",
+        "cusparselt",
+        "nccl",
+    ], ("Invalid backend: %s" % backend)
     if backend == "tvm":
         return True  # it seems like that we always build with TVM
     if backend == "cuda":
         return with_cuda() is not None
-    if backend == "cublas":
+    if backend in ("cublas", "cublaslt", "cusparse"):
         return with_cublas()
     if backend == "cudnn":
         return with_cudnn() is not None
     if backend == "cutlass":
         return with_cutlass()
+    if backend == "cusparselt":
+        return with_cusparselt()
     if backend == "nccl":
         return with_nccl() is not None
     return False
@@ -13,7 +13,21 @@ from .op import (
     recv,
     group_allgather,
     group_reduce_scatter,
+    group_comm,
     all_to_all,
+    all_to_allv,
+    moe_dispatch,
+    moe_combine,
+    sharded_embedding,
 )
 from .config import DistConfig, get_config
-from .communicator import get_communicator, set_default_communicator
+from . import planner
+from . import comm_cost
+from . import simulator
+from .communicator import (
+    get_communicator,
+    set_default_communicator,
+    get_rank_lists,
+    warm_up_communicators,
+    wait_communicators,
+)
@@ -0,0 +1,257 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""The calibrated cost model of the collective communication ops. The latency of a collective is
+modeled as alpha_us + beta_us_per_byte * bytes for each op and each communicator scope, where bytes
+is the larger of its input and output sizes. The scopes are "intra" (each group is within a node),
+"inter" (each group has at most one rank per node), and "global" (the global communicator, which
+runs the hierarchical allreduce if it is enabled).
+
+The calibrated model is used by the analytical op cost model (pass config
+"raf.op_profiler.cost_model" = "analytical") for the collectives, e.g., in IOS stream scheduling,
+and by AutoDataParallel to tune the allreduce bucket size (pass config
+"raf.data_parallel.tune_bucket_size" = True) at compile time without profiling.
+
+Example
+-------
+.. code-block:: python
+
+    # Once per cluster topology, on all ranks with RAF_PERSIST_CACHE=1.
+    comm_cost.calibrate_comm_cost(f"cuda({comm.local_rank})")
+
+    # Later compilations on the same topology load the persisted model automatically.
+    with raf.ir.PassContext(config={"raf.data_parallel.tune_bucket_size": True}):
+        ...
+"""
+from raf._ffi.distributed import (
+    SetCommCost,
+    GetCommCost,
+    EstimateCommLatency,
+    SaveCommCostModel,
+    LoadCommCostModel,
+    ClearCommCostModel,
+)
+
+COLLECTIVE_OPS = {
+    "allreduce": "raf.op._allreduce",
+    "allgather": "raf.op._allgather",
+    "reduce_scatter": "raf.op._reduce_scatter",
+}
+
+
+def set_comm_cost(op_name, scope, alpha_us, beta_us_per_byte):
+    """Set the cost of a collective op in a communicator scope.
+
+    Parameters
+    ----------
+    op_name : str
+        The op name, e.g., "raf.op._allreduce".
+
+    scope : str
+        The communicator scope, which is "intra", "inter" or "global".
+
+    alpha_us : float
+        The fixed latency in microseconds.
+
+    beta_us_per_byte : float
+        The inverse bandwidth in microseconds per byte.
+    """
+    SetCommCost(op_name, scope, alpha_us, beta_us_per_byte)
+
+
+def get_comm_cost():
+    """Get all costs of the current topology.
+
+    Returns
+    -------
+    ret : Dict[Tuple[str, str], Tuple[float, float]]
+        The map from (op_name, scope) to (alpha_us, beta_us_per_byte).
+    """
+    ret = {}
+    for key, params in GetCommCost().items():
+        op_name, scope = str(key).split("@")
+        ret[(op_name, scope)] = (params[0].value, params[1].value)
+    return ret
+
+
+def estimate_comm_latency(op_name, scope, nbytes):
+    """Estimate the latency in microseconds of a collective, or -1 if it is not calibrated."""
+    return EstimateCommLatency(op_name, scope, float(nbytes))
+
+
+def save_comm_cost():
+    """Persist the model of the current topology in the "comm_cost_model" cache, which is only
+    written to the disk when RAF_PERSIST_CACHE=1. Returns False if nothing is set."""
+    return SaveCommCostModel()
+
+
+def load_comm_cost():
+    """Load the persisted model of the current topology. Returns False if there is none."""
+    return LoadCommCostModel()
+
+
+def clear_comm_cost():
+    """Remove all costs. The persisted model is not loaded again unless load_comm_cost is called."""
+    ClearCommCostModel()
+
+
+def get_scope_rank_lists(size, local_size):
+    """Get the rank lists of the communicator scopes, assuming the ranks of a node are
+    consecutive. The scopes whose groups have a single rank are omitted.
+
+    Parameters
+    ----------
+    size : int
+        The number of ranks.
+
+    local_size : int
+        The number of ranks per node.
+
+    Returns
+    -------
+    ret : Dict[str, Optional[List[List[int]]]]
+        The map from the scope to its rank list, which is None for the global communicator.
+    """
+    local_size = max(min(local_size, size), 1)
+    n_nodes = size // local_size
+    ret = {"global": None}
+    if local_size > 1:
+        ret["intra"] = [
+            [node * local_size + i for i in range(local_size)] for node in range(n_nodes)
+        ]
+    if n_nodes > 1:
+        ret["inter"] = [
+            [node * local_size + i for node in range(n_nodes)] for i in range(local_size)
+        ]
+    return ret
+
+
+def fit_alpha_beta(nbytes, latencies):
+    """Fit latency = alpha + beta * nbytes with least squares, where both are non-negative.
+
+    Parameters
+    ----------
+    nbytes : List[float]
+        The message sizes in bytes.
+
+    latencies : List[float]
+        The latencies in microseconds.
+
+    Returns
+    -------
+    ret : Tuple[float, float]
+        The alpha in microseconds and the beta in microseconds per byte.
+    """
+    n = len(nbytes)
+    assert n > 0 and n == len(latencies)
+    mean_size = sum(nbytes) / n
+    mean_lat = sum(latencies) / n
+    cov = sum((s - mean_size) * (t - mean_lat) for s, t in zip(nbytes, latencies))
+    var = sum((s - mean_size) ** 2 for s in nbytes)
+    beta = max(cov / var, 0.0) if var > 0 else 0.0
+    alpha = max(mean_lat - beta * mean_size, 0.0)
+    return alpha, beta
+
+
+def calibrate_comm_cost(
+    device,
+    ops=("allreduce", "allgather", "reduce_scatter"),
+    min_bytes=1 << 12,
+    max_bytes=1 << 28,
+    dtype="float32",
+    warmup=5,
+    number=10,
+    save=True,
+):
+    """Calibrate the cost model by profiling the collectives over a sweep of message sizes in each
+    communicator scope. It is collective, so it must be called on all ranks. The fitted parameters
+    are averaged over the ranks, so all ranks make the same scheduling decisions. They are also set
+    to the cost model.
+
+    Parameters
+    ----------
+    device : str
+        The device of this rank, e.g., "cuda(0)".
+
+    ops : List[str]
+        The collectives to calibrate, in "allreduce", "allgather" and "reduce_scatter".
+
+    min_bytes : int
+        The smallest message size in bytes.
+
+    max_bytes : int
+        The largest message size in bytes. The sizes in between are 4x apart.
+
+    dtype : str
+        The data type of the messages.
+
+    warmup : int
+        The number of warmup runs of each size.
+
+    number : int
+        The number of profiled runs of each size.
+
+    save : bool
+        Whether to persist the model of the current topology.
+
+    Returns
+    -------
+    ret : Dict[Tuple[str, str], Tuple[float, float]]
+        The map from (op_name, scope) to (alpha_us, beta_us_per_byte).
+    """
+    # pylint: disable=import-outside-toplevel, too-many-arguments, too-many-locals
+    import numpy as np
+    import raf
+    from raf._core.device import Device
+    from raf._ffi.op_profiler import Profile, ResetCache
+    from raf._lib import relay, tvm
+    from raf.testing import run_infer_type
+    from .communicator import get_communicator
+    from .op import allreduce
+
+    comm = get_communicator()
+    itemsize = tvm.runtime.DataType(dtype).bits // 8
+
+    def make_expr(op, rank_list, group_size, numel):
+        if op == "allreduce":
+            x = raf.ir.var("x", shape=(numel,), dtype=dtype)
+            return raf.ir.op._allreduce(relay.Tuple([x]), "sum", rank_list), numel
+        if op == "allgather":
+            x = raf.ir.var("x", shape=(numel,), dtype=dtype)
+            return raf.ir.op._allgather(x, 0, rank_list), numel * group_size
+        if op == "reduce_scatter":
+            x = raf.ir.var("x", shape=(numel * group_size,), dtype=dtype)
+            return raf.ir.op._reduce_scatter(x, "sum", rank_list), numel * group_size
+        raise ValueError("Unsupported collective %s" % op)
+
+    results = []
+    ResetCache(Device(device))
+    for scope, rank_list in get_scope_rank_lists(comm.size, comm.local_size).items():
+        group_size = comm.size if rank_list is None else len(rank_list[0])
+        for op in ops:
+            sizes, latencies = [], []
+            nbytes = min_bytes
+            while nbytes <= max_bytes:
+                # The message size is per rank for allreduce and per shard for the others.
+                numel = max(nbytes // itemsize // group_size, 1)
+                expr, msg_numel = make_expr(op, rank_list, group_size, numel)
+                expr = run_infer_type(expr).body
+                lats = Profile(expr, Device(device), warmup, number, 1)["latency"]
+                sizes.append(msg_numel * itemsize)
+                latencies.append(min(lat.value for lat in lats))
+                nbytes *= 4
+            results.append((COLLECTIVE_OPS[op], scope, *fit_alpha_beta(sizes, latencies)))
+    ResetCache(Device(device))
+
+    # Average the parameters over the ranks.
+    params = [param for result in results for param in result[2:]]
+    params = raf.array(np.array(params, dtype="float64"), device=device)
+    params = allreduce(params).numpy() / comm.size
+    ret = {}
+    for i, (op_name, scope, _, _) in enumerate(results):
+        alpha, beta = float(params[i * 2]), float(params[i * 2 + 1])
+        set_comm_cost(op_name, scope, alpha, beta)
+        ret[(op_name, scope)] = (alpha, beta)
+    if save:
+        save_comm_cost()
+    return ret
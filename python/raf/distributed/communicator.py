@@ -80,3 +80,51 @@ def get_communicator():
 def set_default_communicator(name):
     assert name in ["mpi", "void"], "Invalid name to set global communicator!"
     ffi.SetDefaultCommunicator(name)
+
+
+def get_rank_lists(mod):
+    """Get the distinct rank lists of the collective operators in a module.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The module.
+
+    Returns
+    -------
+    ret : List[Tuple[Tuple[int]]]
+        The rank lists in a sorted order, which is the same on all ranks.
+    """
+    return [
+        tuple(tuple(rank.value for rank in group) for group in rank_list)
+        for rank_list in ffi.CollectRankLists(mod)
+    ]
+
+
+def warm_up_communicators(mod, name="nccl", blocking=False):
+    """Create the communicators used by the collective operators in a module ahead of time,
+    instead of lazily in the first execution of the operators. The global communicator is
+    created before this function returns. Unless blocking, the sub-communicators are created by a
+    background thread, so it overlaps with the rest of initialization, e.g., moving the weights to
+    the device, and the first operator that requests a communicator waits for them.
+
+    Note that without ncclCommSplit (NCCL < 2.18), the background thread syncs the NCCL ids of the
+    sub-communicators with MPI, so other MPI calls should not be issued until it finishes.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The module to be executed, which is usually the module before compilation.
+
+    name : str
+        The name of the communicator.
+
+    blocking : bool
+        Whether to wait for all communicators to be created.
+    """
+    ffi.WarmUpCommunicators(name, ffi.CollectRankLists(mod), not blocking)
+
+
+def wait_communicators():
+    """Wait for the communicators being created by warm_up_communicators."""
+    ffi.WaitCommunicators()
@@ -55,6 +55,78 @@ class DistConfig(Object):
         self.auto_dp_profiling_end_iter_ = value
         ffi.AutoDPProfilingEndIter(value)
 
+    @property
+    def gradient_compression(self):
+        return self.gradient_compression_
+
+    @gradient_compression.setter
+    def gradient_compression(self, value):
+        self.gradient_compression_ = value
+        ffi.GradientCompression(value)
+
+    @property
+    def enable_hierarchical_allreduce(self):
+        return self.enable_hierarchical_allreduce_
+
+    @enable_hierarchical_allreduce.setter
+    def enable_hierarchical_allreduce(self, value):
+        self.enable_hierarchical_allreduce_ = value
+        ffi.EnableHierarchicalAllreduce(value)
+
+    @property
+    def enable_allreduce_bucketing(self):
+        return self.enable_allreduce_bucketing_
+
+    @enable_allreduce_bucketing.setter
+    def enable_allreduce_bucketing(self, value):
+        self.enable_allreduce_bucketing_ = value
+        ffi.EnableAllreduceBucketing(value)
+
+    @property
+    def zero_defer_allgather(self):
+        return self.zero_defer_allgather_
+
+    @zero_defer_allgather.setter
+    def zero_defer_allgather(self, value):
+        self.zero_defer_allgather_ = value
+        ffi.ZeroDeferAllgather(value)
+
+    @property
+    def enable_group_collectives(self):
+        return self.enable_group_collectives_
+
+    @enable_group_collectives.setter
+    def enable_group_collectives(self, value):
+        self.enable_group_collectives_ = value
+        ffi.EnableGroupCollectives(value)
+
+    @property
+    def zero_offload(self):
+        return self.zero_offload_
+
+    @zero_offload.setter
+    def zero_offload(self, value):
+        self.zero_offload_ = value
+        ffi.ZeroOffload(value)
+
+    @property
+    def zero_flat_buffer(self):
+        return self.zero_flat_buffer_
+
+    @zero_flat_buffer.setter
+    def zero_flat_buffer(self, value):
+        self.zero_flat_buffer_ = value
+        ffi.ZeroFlatBuffer(value)
+
+    @property
+    def num_comm_streams(self):
+        return self.num_comm_streams_
+
+    @num_comm_streams.setter
+    def num_comm_streams(self, value):
+        self.num_comm_streams_ = value
+        ffi.NumCommStreams(value)
+
     def dumps(self):
         attr_keys = [
             "enable_data_parallel",
@@ -62,6 +134,14 @@ class DistConfig(Object):
             "enable_auto_dp_profiling",
             "auto_dp_profiling_start_iter",
             "auto_dp_profiling_end_iter",
+            "gradient_compression",
+            "enable_hierarchical_allreduce",
+            "enable_allreduce_bucketing",
+            "zero_defer_allgather",
+            "enable_group_collectives",
+            "zero_offload",
+            "num_comm_streams",
+            "zero_flat_buffer",
         ]
         return {attr: getattr(self, attr) for attr in attr_keys}
 
@@ -3,6 +3,8 @@
 
 # pylint: disable=protected-access, invalid-name
 """Collective communication operators"""
+import numpy as np
+
 from .._op import sym
 from .communicator import get_communicator
 from .._core.ndarray import Symbol
@@ -199,6 +201,28 @@ def group_reduce_scatter(tensor_list, computation="sum"):
     return sym._group_reduce_scatter(tensor_list, computation)
 
 
+def group_comm(tensor_list, kinds, computation="sum"):
+    """Performs independent collectives on the global communicator as one NCCL group.
+
+    Parameters
+    ----------
+    tensor_list: List[Tensor]
+        The input of each collective
+    kinds: List[str]
+        The kind of each collective, which is one of "allreduce", "allgather" (along the
+        first axis) and "reduce_scatter" (along the first axis)
+    computation: string
+        The reduction operation of allreduce and reduce_scatter, default is sum
+
+    Returns
+    -------
+    ret: List[Tensor]
+        The output of each collective
+    """
+    codes = {"allreduce": 0, "allgather": 1, "reduce_scatter": 2}
+    return sym._group_comm(tensor_list, [codes[kind] for kind in kinds], computation)
+
+
 def broadcast(x, root):
     """Performs broadcast
 
@@ -247,6 +271,137 @@ def all_to_all(x, group_use_memcpy=False):
     return sym._all_to_all(x, group_use_memcpy)
 
 
+def all_to_allv(x, send_counts):
+    """Performs an all-to-all communication with variable-size splits across all ranks.
+
+    Parameters
+    ----------
+    x : Tensor
+        The tensor to perform all-to-all on. It is evenly split into n blocks at axis 0, where n
+        is the size of send_counts, and the blocks are evenly distributed to the ranks in order,
+        e.g., block i is sent to rank i if n is the number of ranks.
+    send_counts : Tensor
+        The int64 tensor of the number of valid rows in each block. Only the valid rows of a
+        block are sent.
+
+    Returns
+    -------
+    ret: Tuple[Tensor, Tensor]
+        The received blocks with the same shape as x, and the number of valid rows in each of
+        them. Block i is received from the rank that block i is sent to. The rows after the valid
+        rows of a block are zeros.
+    """
+    return sym._all_to_allv(x, send_counts)
+
+
+def moe_dispatch(x, expert_indices, n_experts, capacity):
+    """Dispatch the tokens to the blocks of their experts for all_to_allv. The blocks and the
+    counts are computed on device, so the routing does not synchronize with the host.
+
+    Parameters
+    ----------
+    x : Tensor
+        The tokens in (n_tokens, hidden_size).
+    expert_indices : Tensor
+        The int64 expert index of each token.
+    n_experts : int
+        The number of experts, where the experts are evenly distributed to the ranks in order.
+    capacity : int
+        The maximum number of tokens of an expert. The tokens over the capacity are dropped.
+
+    Returns
+    -------
+    ret: Tuple[Tensor, Tensor, Tensor]
+        The blocks in (n_experts * capacity, hidden_size), the number of tokens in each block,
+        and the slot of each token in the blocks, which is used to combine the expert outputs.
+    """
+    n_slots = n_experts * capacity
+    capacity = np.array(capacity, dtype="int64")
+    experts = np.arange(n_experts, dtype="int64")
+    mask = sym.cast(sym.equal(sym.expand_dims(expert_indices, -1), experts), "int64")
+    # The position of each token among the tokens of the same expert.
+    pos = sym.sum(sym.multiply(sym.cumsum(mask, 0, "int64", True), mask), axis=1)
+    counts = sym.sum(mask, axis=0)
+    counts = sym.where(sym.less(counts, capacity), counts, capacity)
+    # The dropped tokens go to the scratch slot after the blocks.
+    slots = sym.add(sym.multiply(expert_indices, capacity), pos)
+    slots = sym.where(sym.less(pos, capacity), slots, np.array(n_slots, dtype="int64"))
+    # Scatter the token indices to their slots, where 0 is an empty slot and token i is i + 1.
+    tokens = sym.cumsum(sym.ones_like(expert_indices), 0, "int64")
+    token_of_slots = sym.scatter(np.zeros(n_slots + 1, dtype="int64"), slots, tokens, 0)
+    token_of_slots = sym.strided_slice(token_of_slots, [0], [n_slots], [1])
+    # Gather the tokens to the blocks.
+    zeros = sym.zeros_like(sym.strided_slice(x, [0], [1], [1]))
+    blocks = sym.take(sym.concatenate([zeros, x], axis=0), token_of_slots, axis=0)
+    return blocks, counts, slots
+
+
+def moe_combine(blocks, slots, gates=None):
+    """Combine the expert outputs back to the tokens. This is the reverse of moe_dispatch.
+
+    Parameters
+    ----------
+    blocks : Tensor
+        The expert outputs in the blocks of moe_dispatch, i.e., (n_experts * capacity, hidden_size).
+    slots : Tensor
+        The slot of each token returned by moe_dispatch.
+    gates : Optional[Tensor]
+        The gate value of each token to scale its expert output.
+
+    Returns
+    -------
+    ret: Tensor
+        The expert output of each token in (n_tokens, hidden_size), which is zeros for the
+        dropped tokens.
+    """
+    # The dropped tokens take the scratch slot of zeros after the blocks.
+    zeros = sym.zeros_like(sym.strided_slice(blocks, [0], [1], [1]))
+    out = sym.take(sym.concatenate([blocks, zeros], axis=0), slots, axis=0)
+    if gates is not None:
+        out = sym.multiply(out, sym.expand_dims(gates, -1))
+    return out
+
+
+def sharded_embedding(shard, indices, rows_per_shard, capacity):
+    """Look up a row-sharded embedding table, where rank r owns the rows
+    [r * rows_per_shard, (r + 1) * rows_per_shard) of the table as its shard. The indices are
+    routed to the ranks owning their rows, and the vectors are routed back, both with
+    all_to_allv, so the table is never replicated. In the backward, the gradients of the vectors
+    are routed back to the owners and accumulated to the gradient of the local shard, which is
+    complete on its own and is not aggregated by data parallelism if the shard is marked with
+    model_parallel, e.g., by raf.model.nn.ShardedEmbedding.
+
+    Parameters
+    ----------
+    shard : Tensor
+        The rows of the table owned by this rank in (rows_per_shard, embedding_dim).
+    indices : Tensor
+        The 1-D int64 indices of the rows in the complete table.
+    rows_per_shard : int
+        The number of rows of each shard.
+    capacity : int
+        The maximum number of indices routed to a rank, which is at most the number of indices.
+        The indices over the capacity look up zeros.
+
+    Returns
+    -------
+    ret: Tensor
+        The vectors of the indices in (n_indices, embedding_dim).
+    """
+    n_ranks = get_communicator().size
+    rows_per_shard = np.array(rows_per_shard, dtype="int64")
+    owners = sym.floor_divide(indices, rows_per_shard)
+    local_indices = sym.subtract(indices, sym.multiply(owners, rows_per_shard))
+    blocks, counts, slots = moe_dispatch(
+        sym.expand_dims(local_indices, -1), owners, n_ranks, capacity
+    )
+    recv = all_to_allv(blocks, counts)
+    # The empty slots of the received blocks look up row 0, which are not sent back.
+    vectors = sym.embedding(shard, sym.reshape(recv[0], [-1]))
+    vectors = all_to_allv(vectors, recv[1])
+    return moe_combine(vectors[0], slots)
+
+
 def send(x, peer, token=None):
     """Send x to peer.
     This operation is blocking for GPU.
@@ -0,0 +1,491 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""The planner of hybrid parallelism. It enumerates the data (DP), tensor (TP) and pipeline (PP)
+parallel degrees, the ZeRO level, the number of micro-batches and the allreduce bucket size that
+fit the cluster, estimates the step time and the peak memory per GPU of each configuration, and
+returns the configurations ranked by the estimated step time.
+
+The model is profiled once on a single device: the op latencies come from the analytical cost
+model (see raf.utils.cost_model), the activations kept for the backward are the outputs of the
+forward ops, and the partitioned GEMMs are the dense, matmul and batch_matmul ops. The collectives
+follow the alpha-beta model of ring algorithms, with the bandwidth of NVLink/PCIe within a node
+and of the network across nodes. The ranks of a TP group are adjacent, followed by the PP stages
+and then the DP replicas, so TP stays within a node when possible.
+
+Example
+-------
+.. code-block:: python
+
+    cost_model.load_device_spec("specs.json", "Tesla V100-SXM2-16GB", "cuda")
+    profile = planner.profile_model(model, "cuda", [x])
+    cluster = planner.ClusterSpec(n_nodes=2, gpus_per_node=8, gpu_memory_gb=16,
+                                  intra_node_gbps=150, inter_node_gbps=12)
+    best = planner.plan_parallelism(profile, cluster, global_batch_size=256)[0]
+    best.apply()  # Set the DistConfig.
+    print(best.pass_pipeline)  # The wrappers to apply to the model.
+"""
+# pylint: disable=too-many-arguments, too-many-locals, too-many-instance-attributes
+import math
+
+GEMM_OPS = (
+    "raf.op.dense",
+    "raf.op.matmul",
+    "raf.op.matmul_nt",
+    "raf.op.matmul_tn",
+    "raf.op.matmul_tt",
+    "raf.op.batch_matmul",
+    "raf.op.batch_matmul_nt",
+    "raf.op.batch_matmul_tn",
+    "raf.op.batch_matmul_tt",
+)
+
+
+class ClusterSpec:
+    """The GPUs and the interconnects of a cluster.
+
+    Parameters
+    ----------
+    n_nodes: int
+        The number of nodes.
+
+    gpus_per_node: int
+        The number of GPUs in each node.
+
+    gpu_memory_gb: float
+        The memory of each GPU in GB.
+
+    intra_node_gbps: float
+        The bus bandwidth in GB/s of the collectives within a node.
+
+    inter_node_gbps: float
+        The bus bandwidth in GB/s of the collectives across nodes.
+
+    comm_latency_us: float
+        The fixed latency in microseconds of each collective or send/recv.
+    """
+
+    def __init__(
+        self,
+        n_nodes,
+        gpus_per_node,
+        gpu_memory_gb,
+        intra_node_gbps,
+        inter_node_gbps,
+        comm_latency_us=20.0,
+    ):
+        self.n_nodes = n_nodes
+        self.gpus_per_node = gpus_per_node
+        self.gpu_memory_gb = gpu_memory_gb
+        self.intra_node_gbps = intra_node_gbps
+        self.inter_node_gbps = inter_node_gbps
+        self.comm_latency_us = comm_latency_us
+
+    @property
+    def world_size(self):
+        """The total number of GPUs."""
+        return self.n_nodes * self.gpus_per_node
+
+    def group_gbps(self, stride, size):
+        """The bandwidth of a group of size ranks, which are stride ranks apart."""
+        return self.intra_node_gbps if stride * size <= self.gpus_per_node else self.inter_node_gbps
+
+    def comm_ms(self, nbytes, stride, size, volume):
+        """The time of a collective of nbytes per rank in a group, which transfers volume times
+        nbytes over the links, e.g., 2 * (size - 1) / size for ring allreduce."""
+        if size <= 1:
+            return 0.0
+        return self.comm_latency_us / 1e3 + volume * nbytes / 1e6 / self.group_gbps(stride, size)
+
+
+class ModelProfile:
+    """The costs of a model profiled on a single device, normalized per sample.
+
+    Parameters
+    ----------
+    param_sizes: List[int]
+        The bytes of each trainable parameter, in the order of the forward.
+
+    fwd_ms_per_sample: float
+        The forward time of a sample in milliseconds.
+
+    act_bytes_per_sample: int
+        The bytes of the activations of a sample kept for the backward.
+
+    gemm_bytes_per_sample: int
+        The bytes of the outputs of the GEMMs of a sample, which TP communicates.
+
+    n_gemms: int
+        The number of GEMMs in the forward.
+
+    gflops_per_sample: float
+        The forward GFLOPs of a sample, for reference.
+    """
+
+    def __init__(
+        self,
+        param_sizes,
+        fwd_ms_per_sample,
+        act_bytes_per_sample,
+        gemm_bytes_per_sample,
+        n_gemms,
+        gflops_per_sample=0.0,
+    ):
+        self.param_sizes = list(param_sizes)
+        self.fwd_ms_per_sample = fwd_ms_per_sample
+        self.act_bytes_per_sample = act_bytes_per_sample
+        self.gemm_bytes_per_sample = gemm_bytes_per_sample
+        self.n_gemms = n_gemms
+        self.gflops_per_sample = gflops_per_sample
+
+    @property
+    def param_bytes(self):
+        """The bytes of all trainable parameters."""
+        return sum(self.param_sizes)
+
+    @property
+    def boundary_bytes_per_sample(self):
+        """The bytes of a sample sent between pipeline stages, taken as a GEMM output."""
+        return self.gemm_bytes_per_sample / max(self.n_gemms, 1)
+
+
+def _type_bytes(ty):
+    # pylint: disable=import-outside-toplevel
+    from raf._lib import tvm
+
+    if isinstance(ty, tvm.ir.TupleType):
+        return sum(_type_bytes(field) for field in ty.fields)
+    if isinstance(ty, tvm.ir.TensorType):
+        numel = 1
+        for dim in ty.shape:
+            numel *= int(dim)
+        return numel * tvm.runtime.DataType(ty.dtype).bits // 8
+    return 0
+
+
+def profile_model(model, device, args):
+    """Profile the forward of a model on a single device with the analytical cost model.
+
+    Parameters
+    ----------
+    model: Model
+        The model with forward computations, whose first argument is batched by the first axis.
+
+    device: str
+        The device whose spec is set to the analytical cost model.
+
+    args: List[ndarray]
+        The inputs of a batch.
+
+    Returns
+    -------
+    ret: ModelProfile
+        The profile.
+    """
+    # pylint: disable=import-outside-toplevel, protected-access
+    from raf._lib import relay, tvm
+    from raf._core.device import Device
+    from raf._ffi.op_profiler import EstimateLatency
+    from raf._ffi.pass_ import EstimateGFLOPS, InferType
+
+    batch_size = args[0].shape[0]
+    mod = InferType()(model._internal(*args).mod)
+    with Device(device):
+        gflops = sum(gf.value for gf in EstimateGFLOPS(mod).values())
+
+    fwd_us, act_bytes, gemm_bytes, n_gemms = 0.0, 0, 0, 0
+    body = mod["main"].body
+    while isinstance(body, relay.Let):
+        value = body.value
+        if isinstance(value, relay.Call) and isinstance(value.op, tvm.ir.Op):
+            fwd_us += EstimateLatency(value, Device(device)).value
+            nbytes = _type_bytes(value.checked_type)
+            act_bytes += nbytes
+            if value.op.name in GEMM_OPS:
+                gemm_bytes += nbytes
+                n_gemms += 1
+        body = body.body
+
+    param_sizes = []
+    for param in model.state().values():
+        if param.requires_grad:
+            numel = 1
+            for dim in param.shape:
+                numel *= dim
+            param_sizes.append(numel * tvm.runtime.DataType(param.dtype).bits // 8)
+    return ModelProfile(
+        param_sizes,
+        fwd_us / 1e3 / batch_size,
+        act_bytes / batch_size,
+        gemm_bytes / batch_size,
+        n_gemms,
+        gflops / batch_size,
+    )
+
+
+class ParallelPlan:
+    """A hybrid parallel configuration with its estimated costs."""
+
+    def __init__(self, dp, tp, pp, zero_opt_level, n_micro_batches, bucket_size, step_ms, memory):
+        self.dp = dp
+        self.tp = tp
+        self.pp = pp
+        self.zero_opt_level = zero_opt_level
+        self.n_micro_batches = n_micro_batches
+        # The allreduce bucket size in elements, or 0 if not bucketed.
+        self.bucket_size = bucket_size
+        self.step_ms = step_ms
+        # The peak memory per GPU in bytes.
+        self.memory = memory
+
+    @property
+    def peak_memory_mb(self):
+        """The estimated peak memory per GPU in MBs."""
+        return self.memory / 1048576.0
+
+    def dist_config(self):
+        """The DistConfig attributes of the plan, which can be loaded by DistConfig.loads."""
+        return {
+            "enable_data_parallel": self.dp > 1,
+            "zero_opt_level": self.zero_opt_level,
+            "enable_allreduce_bucketing": self.bucket_size > 0,
+        }
+
+    @property
+    def pass_pipeline(self):
+        """The wrappers to apply to the model, from the innermost."""
+        ret = []
+        if self.tp > 1:
+            ret.append("with_tensor_parallel")
+        if self.pp > 1:
+            ret.append("with_pipeline(%d)" % self.n_micro_batches)
+        else:
+            ret.append("with_autodiff")
+        if self.dp > 1:
+            ret.append("with_data_parallel")
+        return ret
+
+    def apply(self):
+        """Set the plan to the global DistConfig."""
+        # pylint: disable=import-outside-toplevel
+        from raf._ffi.distributed import GroupBucketSize
+        from .config import get_config
+
+        get_config().loads(self.dist_config())
+        if self.bucket_size > 0:
+            GroupBucketSize(self.bucket_size)
+
+    def __repr__(self):
+        return "ParallelPlan(dp=%d, tp=%d, pp=%d, zero=%d, micro_batches=%d, %.2f ms, %.0f MB)" % (
+            self.dp,
+            self.tp,
+            self.pp,
+            self.zero_opt_level,
+            self.n_micro_batches,
+            self.step_ms,
+            self.peak_memory_mb,
+        )
+
+
+def _divisors(n):
+    return [d for d in range(1, n + 1) if n % d == 0]
+
+
+def _exposed_allreduce_ms(grad_sizes, backward_ms, comm_ms):
+    """Simulate the bucketed gradient allreduces like DataParallelSchedule, where the gradients
+    are ready in the backward order at a uniform rate, and return the best (exposed time, bucket
+    size in bytes) among the power-of-two bucket sizes."""
+    total = sum(grad_sizes)
+    if total == 0:
+        return 0.0, 0
+    ready, curr = [], 0
+    for size in reversed(grad_sizes):
+        curr += size
+        ready.append((size, backward_ms * curr / total))
+
+    def simulate(bucket_size):
+        comm_end, curr_size = 0.0, 0
+        for i, (size, ready_ms) in enumerate(ready):
+            curr_size += size
+            if curr_size >= bucket_size or i + 1 == len(ready):
+                launch_ms = ready_ms if curr_size >= bucket_size else backward_ms
+                comm_end = max(comm_end, launch_ms) + comm_ms(curr_size)
+                curr_size = 0
+        return max(comm_end - backward_ms, 0.0)
+
+    best = (simulate(total), total)
+    bucket_size = 1 << 16
+    while bucket_size < total:
+        exposed = simulate(bucket_size)
+        if exposed < best[0]:
+            best = (exposed, bucket_size)
+        bucket_size *= 2
+    return best
+
+
+def estimate_plan(
+    profile,
+    cluster,
+    global_batch_size,
+    dp,
+    tp,
+    pp,
+    zero_opt_level,
+    n_micro_batches,
+    optimizer_state_factor=2.0,
+):
+    """Estimate the step time and the peak memory per GPU of a configuration.
+
+    Parameters
+    ----------
+    profile: ModelProfile
+        The profile of the model.
+
+    cluster: ClusterSpec
+        The cluster.
+
+    global_batch_size: int
+        The number of samples of a step over all replicas.
+
+    dp, tp, pp: int
+        The data, tensor and pipeline parallel degrees.
+
+    zero_opt_level: int
+        The ZeRO level, which partitions the optimizer states (1), the gradients (2) and the
+        parameters (3) across the data parallel replicas.
+
+    n_micro_batches: int
+        The number of micro-batches of the pipeline.
+
+    optimizer_state_factor: float
+        The bytes of the optimizer states per parameter byte, e.g., 2 for Adam and 1 for SGD with
+        momentum.
+
+    Returns
+    -------
+    ret: ParallelPlan
+        The plan with the estimated costs.
+    """
+    micro_batch = global_batch_size / dp / n_micro_batches
+    shards = tp * pp
+
+    # The time of a micro-batch on a stage. The backward takes twice the forward, and the
+    # pipeline recomputes the forward in the backward.
+    fwd_ms = profile.fwd_ms_per_sample * micro_batch / shards
+    bwd_ms = 2 * fwd_ms + (fwd_ms if pp > 1 else 0.0)
+    # TP gathers the inputs and reduce-scatters the outputs of the partitioned GEMMs in both the
+    # forward and the backward.
+    gemm_bytes = profile.gemm_bytes_per_sample * micro_batch / pp
+    tp_ms = 2 * cluster.comm_ms(gemm_bytes, 1, tp, (tp - 1) / tp)
+    if tp > 1:
+        tp_ms += 2 * profile.n_gemms / pp * cluster.comm_latency_us / 1e3
+    # PP sends the activations forward and their gradients backward.
+    boundary_bytes = profile.boundary_bytes_per_sample * micro_batch / tp
+    pp_ms = 2 * cluster.comm_ms(boundary_bytes, tp, 2, 1.0) if pp > 1 else 0.0
+    micro_ms = fwd_ms + bwd_ms + tp_ms + pp_ms
+    step_ms = micro_ms * (n_micro_batches + pp - 1)
+
+    # DP reduces the gradients, overlapped with the backward of the last micro-batch, and ZeRO-3
+    # gathers the parameters once more in the forward.
+    grad_sizes = [size / shards for size in profile.param_sizes]
+    grad_bytes = sum(grad_sizes)
+    bucket_size = 0
+    if dp > 1:
+        volume = 2 * (dp - 1) / dp
+
+        def comm_ms(nbytes):
+            return cluster.comm_ms(nbytes, shards, dp, volume)
+
+        exposed_ms, bucket_bytes = _exposed_allreduce_ms(grad_sizes, bwd_ms, comm_ms)
+        step_ms += exposed_ms
+        if zero_opt_level > 2:
+            step_ms += cluster.comm_ms(grad_bytes, shards, dp, (dp - 1) / dp)
+        # The bucket size in elements, assuming 4-byte gradients.
+        bucket_size = max(int(bucket_bytes) // 4, 1)
+
+    weights = grad_bytes / (dp if zero_opt_level > 2 else 1)
+    grads = grad_bytes / (dp if zero_opt_level > 1 else 1)
+    states = optimizer_state_factor * grad_bytes / (dp if zero_opt_level > 0 else 1)
+    acts = profile.act_bytes_per_sample * micro_batch / shards
+    if pp > 1:
+        # The inputs of the in-flight micro-batches are kept for the recomputation.
+        acts += profile.boundary_bytes_per_sample * micro_batch / tp * min(pp, n_micro_batches)
+    memory = weights + grads + states + acts
+    return ParallelPlan(
+        dp, tp, pp, zero_opt_level, n_micro_batches, bucket_size, step_ms, int(math.ceil(memory))
+    )
+
+
+def plan_parallelism(
+    profile,
+    cluster,
+    global_batch_size,
+    optimizer_state_factor=2.0,
+    memory_fraction=0.9,
+    allow_hybrid=False,
+):
+    """Enumerate the feasible configurations and rank them by the estimated step time.
+
+    Parameters
+    ----------
+    profile: ModelProfile
+        The profile of the model, e.g., from profile_model.
+
+    cluster: ClusterSpec
+        The cluster.
+
+    global_batch_size: int
+        The number of samples of a step over all replicas.
+
+    optimizer_state_factor: float
+        The bytes of the optimizer states per parameter byte.
+
+    memory_fraction: float
+        The fraction of the GPU memory available to the model, leaving room for the workspaces
+        and the fragmentation.
+
+    allow_hybrid: bool
+        Whether to include the configurations combining DP, TP and PP. The wrappers in this tree
+        use all ranks of the global communicator as one group, so only one of them can be applied
+        at a time; the hybrid ones are estimated for reference.
+
+    Returns
+    -------
+    ret: List[ParallelPlan]
+        The feasible configurations, the fastest first.
+    """
+    world_size = cluster.world_size
+    capacity = cluster.gpu_memory_gb * 1e9 * memory_fraction
+    plans = []
+    for tp in _divisors(min(world_size, cluster.gpus_per_node)):
+        if world_size % tp != 0:
+            continue
+        for pp in _divisors(world_size // tp):
+            dp = world_size // tp // pp
+            if not allow_hybrid and sum(degree > 1 for degree in (dp, tp, pp)) > 1:
+                continue
+            if global_batch_size % dp != 0:
+                continue
+            replica_batch = global_batch_size // dp
+            if pp > 1:
+                micro_candidates = [m for m in _divisors(replica_batch) if pp <= m <= 8 * pp]
+            else:
+                micro_candidates = [1]
+            for zero_opt_level in range(4) if dp > 1 else [0]:
+                for n_micro_batches in micro_candidates:
+                    plan = estimate_plan(
+                        profile,
+                        cluster,
+                        global_batch_size,
+                        dp,
+                        tp,
+                        pp,
+                        zero_opt_level,
+                        n_micro_batches,
+                        optimizer_state_factor,
+                    )
+                    if plan.memory <= capacity:
+                        plans.append(plan)
+    # The lower ZeRO level is preferred on ties since it has fewer collectives in practice.
+    plans.sort(key=lambda plan: (plan.step_ms, plan.zero_opt_level, plan.memory))
+    return plans
@@ -0,0 +1,331 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""The offline simulator of the distributed step time. It replays the scheduled multi-stream IR of
+a given world size and DistConfig on virtual streams, where the op latencies come from a single
+device profile of raf.utils.profiler, and the ops that are not profiled (e.g., the collectives)
+are estimated by the analytical cost model with the calibrated collectives of
+raf.distributed.comm_cost. It predicts the step time, the exposed communication time and the peak
+memory, and outputs a Chrome trace, so the schedules can be iterated offline.
+
+Example
+-------
+.. code-block:: python
+
+    # Profile a step on a single device.
+    profiler.start()
+    model(*args)
+    profile = simulator.load_profile(profiler.get())
+    profiler.stop()
+
+    # Simulate 16 ranks on 2 nodes with ZeRO-1.
+    result = simulator.simulate_model(
+        model, "cuda", args, world_size=16, local_size=8,
+        dist_config={"enable_data_parallel": True, "zero_opt_level": 1}, profile=profile,
+    )
+    print(result.step_ms, result.exposed_comm_ms, result.peak_memory_mb)
+    result.dump("sim_trace.json")
+"""
+# pylint: disable=too-many-arguments, too-many-locals
+import json
+from contextlib import contextmanager
+
+from raf._core.device import Device
+from raf._ffi.pass_ import SimulateStep, EstimateMemory, InferType
+from .communicator import get_communicator, VoidCommunicator
+from .config import get_config
+
+
+def load_profile(trace):
+    """Collect the mean latencies of the ops in a profile.
+
+    Parameters
+    ----------
+    trace : Union[str, Dict[str, ...]]
+        The profile in google trace event format from raf.utils.profiler.get(), or its dumped
+        file. The op events carry the signatures of their inputs and outputs in "args_string".
+
+    Returns
+    -------
+    ret : Dict[str, float]
+        The mean latency in microseconds keyed by "<OpEnv name>@<signature>".
+    """
+    if isinstance(trace, str):
+        with open(trace, "r") as f:  # pylint: disable=invalid-name
+            trace = json.load(f)
+    begins, sums = {}, {}
+    for event in trace["traceEvents"]:
+        signature = event.get("args", {}).get("args_string", "")
+        if "|" not in signature:
+            continue
+        key = (event["cat"], event["name"], signature)
+        if event["ph"] == "B":
+            begins.setdefault(key, []).append(int(event["ts"]))
+        elif event["ph"] == "E" and begins.get(key):
+            total, count = sums.get(key[1:], (0.0, 0))
+            sums[key[1:]] = (total + int(event["ts"]) - begins[key].pop(), count + 1)
+    return {"%s@%s" % key: total / count for key, (total, count) in sums.items()}
+
+
+def _union(intervals):
+    """Merge the intervals to disjoint ones in order."""
+    ret = []
+    for start, end in sorted(intervals):
+        if ret and start <= ret[-1][1]:
+            ret[-1][1] = max(ret[-1][1], end)
+        else:
+            ret.append([start, end])
+    return ret
+
+
+def _uncovered(intervals, covers):
+    """The total length of the intervals that is not covered by any of the covers."""
+    covers = _union(covers)
+    ret = 0.0
+    for start, end in _union(intervals):
+        length = end - start
+        for c_start, c_end in covers:
+            length -= max(min(end, c_end) - max(start, c_start), 0.0)
+        ret += length
+    return ret
+
+
+class SimulatedOp:
+    """An op replayed by the simulator."""
+
+    def __init__(self, name, stream_id, start_us, dur_us, kind, source):
+        self.name = name
+        self.stream_id = stream_id
+        self.start_us = start_us
+        self.dur_us = dur_us
+        self.kind = kind
+        self.source = source
+
+    @property
+    def end_us(self):
+        return self.start_us + self.dur_us
+
+    def __repr__(self):
+        return "SimulatedOp(%s, stream=%d, start=%.2fus, dur=%.2fus, %s, %s)" % (
+            self.name,
+            self.stream_id,
+            self.start_us,
+            self.dur_us,
+            self.kind,
+            self.source,
+        )
+
+
+class SimulationResult:
+    """The result of a simulated step.
+
+    Attributes
+    ----------
+    ops : List[SimulatedOp]
+        The simulated ops in the program order.
+
+    peak_memory_mb : Optional[float]
+        The estimated peak memory in MBs, or None if it is not estimated.
+    """
+
+    def __init__(self, ops, peak_memory_mb=None):
+        self.ops = ops
+        self.peak_memory_mb = peak_memory_mb
+
+    @property
+    def step_ms(self):
+        """The time from the first op start to the last op end."""
+        if not self.ops:
+            return 0.0
+        return (max(op.end_us for op in self.ops) - min(op.start_us for op in self.ops)) / 1e3
+
+    @property
+    def comm_ms(self):
+        """The total latency of the collectives."""
+        return sum(op.dur_us for op in self.ops if op.kind == "comm") / 1e3
+
+    @property
+    def exposed_comm_ms(self):
+        """The time of the collectives that is not overlapped by any computation."""
+        comm = [(op.start_us, op.end_us) for op in self.ops if op.kind == "comm"]
+        comp = [(op.start_us, op.end_us) for op in self.ops if op.kind != "comm"]
+        return _uncovered(comm, comp) / 1e3
+
+    @property
+    def stream_busy_ms(self):
+        """The total latency of the ops on each stream."""
+        ret = {}
+        for op in self.ops:
+            ret[op.stream_id] = ret.get(op.stream_id, 0.0) + op.dur_us / 1e3
+        return ret
+
+    @property
+    def profiled_ratio(self):
+        """The fraction of the ops whose latencies come from the profile."""
+        if not self.ops:
+            return 0.0
+        return sum(op.source == "profile" for op in self.ops) / len(self.ops)
+
+    def to_chrome_trace(self):
+        """Convert the simulated ops to google trace event format, with a thread per stream."""
+        events = []
+        for op in self.ops:
+            events.append(
+                {
+                    "name": op.name,
+                    "cat": op.kind,
+                    "ph": "X",
+                    "ts": op.start_us,
+                    "dur": op.dur_us,
+                    "pid": 0,
+                    "tid": "Stream %d" % op.stream_id,
+                    "args": {"source": op.source},
+                }
+            )
+        return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+    def dump(self, filename="simulation.json"):
+        """Dump the Chrome trace to `filename`."""
+        with open(filename, "w") as f:  # pylint: disable=invalid-name
+            json.dump(self.to_chrome_trace(), f, indent=4)
+
+    def __repr__(self):
+        return "SimulationResult(step=%.3fms, exposed_comm=%.3fms, peak_memory=%s)" % (
+            self.step_ms,
+            self.exposed_comm_ms,
+            "%.2fMB" % self.peak_memory_mb if self.peak_memory_mb is not None else "N/A",
+        )
+
+
+def simulate(mod, device, profile=None, optimize=True, include_memory=True):
+    """Simulate a step of a module.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The module. If it is not optimized, its IR must be before ManifestAlloc.
+
+    device : str
+        The target device, which is also the device of the analytical cost model.
+
+    profile : Optional[Dict[str, float]]
+        The profiled latencies from load_profile. None estimates all ops analytically.
+
+    optimize : bool
+        Whether to optimize the module by VMCompiler, which schedules the streams and manifests
+        the memory allocation. Otherwise, the module must be after ManifestAlloc.
+
+    include_memory : bool
+        Whether to estimate the peak memory, including the parameters.
+
+    Returns
+    -------
+    ret : SimulationResult
+        The simulated step.
+    """
+    # pylint: disable=import-outside-toplevel
+    import tvm
+    from raf._core.vm import VMCompiler
+
+    if optimize:
+        with tvm.transform.PassContext(opt_level=3):
+            mod, _ = VMCompiler().optimize(mod, device)
+    mod = InferType()(mod)
+    trace = SimulateStep(mod, Device(device), profile or {})
+    ops = [
+        SimulatedOp(str(name), stream.value, start.value, dur.value, str(kind), str(source))
+        for name, stream, start, dur, kind, source in trace
+    ]
+    peak_memory_mb = None
+    if include_memory:
+        trace = EstimateMemory(mod, Device(device), True)
+        peak_memory_mb = max(mem.value for _, mem in trace)
+    return SimulationResult(ops, peak_memory_mb)
+
+
+@contextmanager
+def virtual_world(world_size, local_size=None, dist_config=None):
+    """Make the void communicator pretend to have the given world size, and set the DistConfig.
+    Both are restored on exit. The rank is 0.
+
+    Parameters
+    ----------
+    world_size : int
+        The number of ranks.
+
+    local_size : Optional[int]
+        The number of ranks per node. None means all ranks are in a node.
+
+    dist_config : Optional[Dict[str, ...]]
+        The DistConfig attributes to set, e.g., {"zero_opt_level": 1}.
+    """
+    comm = get_communicator()
+    assert isinstance(
+        comm, VoidCommunicator
+    ), "The simulation requires the void communicator. Call set_default_communicator('void')."
+    dcfg = get_config()
+    comm_state, dcfg_state = comm.dumps(), dcfg.dumps()
+    try:
+        comm.loads(
+            {
+                "size": world_size,
+                "rank": 0,
+                "local_size": local_size or world_size,
+                "local_rank": 0,
+            }
+        )
+        dcfg.loads(dist_config or {})
+        yield
+    finally:
+        comm.loads(comm_state)
+        dcfg.loads(dcfg_state)
+
+
+def simulate_model(
+    model,
+    device,
+    args,
+    world_size,
+    local_size=None,
+    dist_config=None,
+    profile=None,
+    include_memory=True,
+):
+    """Simulate a step of a model in a virtual world. The model is traced within the world, so the
+    distributed wrappers (e.g., the optimizers with data parallelism) take the given DistConfig.
+
+    Parameters
+    ----------
+    model : Model
+        The model, which may be wrapped by an optimizer.
+
+    device : str
+        The target device.
+
+    args : List[ndarray]
+        The inputs of a step on a rank.
+
+    world_size : int
+        The number of ranks.
+
+    local_size : Optional[int]
+        The number of ranks per node. None means all ranks are in a node.
+
+    dist_config : Optional[Dict[str, ...]]
+        The DistConfig attributes to set, e.g., {"zero_opt_level": 1}.
+
+    profile : Optional[Dict[str, float]]
+        The profiled latencies from load_profile.
+
+    include_memory : bool
+        Whether to estimate the peak memory.
+
+    Returns
+    -------
+    ret : SimulationResult
+        The simulated step.
+    """
+    # pylint: disable=protected-access
+    with virtual_world(world_size, local_size, dist_config):
+        mod = model._internal(*args).mod
+        return simulate(mod, device, profile, include_memory=include_memory)
@@ -6,7 +6,7 @@
 from tvm import relay
 
 from raf._ffi.model import RunModel
-from raf.model.model import BaseModel
+from raf.model.model import BaseModel, ExecutorCache, _param_to
 from raf.model.trace import _unwrap, _TraceRecord
 from raf._core.ir_ext import extended_var
 from raf._core.ndarray import ndarray, Symbol
@@ -79,6 +79,45 @@ def annotate_main_func_params(func, args):
     return relay.Function(params, body)
 
 
+def tie_aliased_params(mods, arg_params, aux_params):
+    """Tie the params that are the same array, e.g., the tied input and output embeddings, so
+    that the main functions take the array once and AutoDiff sums up its gradients. The aliases are
+    removed from the params, so the optimizers keep one state for them. The params with the same
+    content that are different arrays are not tied, because they may be trained differently.
+
+    Parameters
+    ----------
+    mods : List[IRModule]
+        The modules whose main functions take the params, which are updated in place.
+
+    arg_params : Dict[str, ndarray]
+        Model parameters, which are updated in place.
+
+    aux_params : Dict[str, ndarray]
+        Auxiliary params, not learnable, which are updated in place.
+    """
+    func_params = [{var.name_hint: var for var in mod["main"].params} for mod in mods]
+    first_names = {}
+    aliases = {}
+    for name, param in arg_params.items():
+        if not all(name in params for params in func_params):
+            continue
+        if id(param) in first_names:
+            aliases[name] = first_names[id(param)]
+        else:
+            first_names[id(param)] = name
+    if not aliases:
+        return
+    for mod, params in zip(mods, func_params):
+        func = mod["main"]
+        vmap = {params[alias]: params[name] for alias, name in aliases.items()}
+        new_params = [var for var in func.params if var not in vmap]
+        mod["main"] = relay.Function(new_params, Substitute(func.body, vmap))
+    for alias in aliases:
+        del arg_params[alias]
+        aux_params.pop(alias, None)
+
+
 class FrameworkModel(BaseModel):
     """Represent the wrapper of the models read from deep learning frameworks.
 
@@ -107,9 +146,11 @@ class FrameworkModel(BaseModel):
         self.__infer_mod = infer_mod
         self.__arg_params = arg_params
         self.__aux_params = aux_params
+        tie_aliased_params([train_mod, infer_mod], arg_params, aux_params)
         for param in self.__aux_params.values():
             param.requires_grad = False
         self.__recorded = None
+        self.__executor_cache = ExecutorCache()
 
     def __call__(self, *args, **kwargs):
         mod = self.__infer_mod
@@ -204,6 +245,12 @@ class FrameworkModel(BaseModel):
             requires_grads=requires_grads,
         )
 
+    def _executor_cache(self):
+        return self.__executor_cache
+
+    def _get_vm_inputs(self, record, args, kwargs):
+        return _get_main_func_params(self, args, kwargs, get_handle=False)
+
     def _state(self):
         state = {}
         state.update(self.__arg_params)
@@ -211,12 +258,14 @@ class FrameworkModel(BaseModel):
         return state
 
     def to(self, *, device=None, dtype=None):
+        converted = {}
         for name, param in self.__arg_params.items():
-            new_param = param.to(device=device, dtype=dtype)
+            new_param = _param_to(param, device, dtype, converted)
             self.__arg_params[name] = new_param
         for name, param in self.__aux_params.items():
-            new_param = param.to(device=device, dtype=dtype)
+            new_param = _param_to(param, device, dtype, converted)
             self.__aux_params[name] = new_param
 
         self.__train_mod = AssignDevice(device)(self.__train_mod)
         self.__infer_mod = AssignDevice(device)(self.__infer_mod)
+        self.__executor_cache = ExecutorCache()
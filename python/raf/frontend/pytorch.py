@@ -4,15 +4,16 @@
 """The frontend that converts PyTorch models to RAF models via Relay."""
 # pylint: disable=too-many-locals, too-many-branches
 from collections import OrderedDict
+import json
 import os
 import hashlib
-import torch
 
 from raf import distributed as dist
-from .._core.ndarray import ndarray
-from .._lib import relay
+from .._core.ndarray import from_dlpack
+from .._lib import relay, tvm
 from .._ffi.pass_ import FromRelay, SwitchTrainOp, validate_relay_param_name
 from ..frontend.model import FrameworkModel
+from ..ir import save_json, load_json
 
 
 def trace_model(model, shape_dict):
@@ -33,6 +34,8 @@ def trace_model(model, shape_dict):
     model: ScriptedModel
         PyTorch scripted model.
     """
+    # PyTorch is imported on use, so that importing RAF does not pay for it.
+    import torch  # pylint: disable=import-outside-toplevel
 
     class TraceWrapper(torch.nn.Module):
         """A wrapper to process the forward output. This is required for object detection
@@ -112,7 +115,53 @@ def trace_model(model, shape_dict):
     return scripted_model
 
 
-def from_pytorch(model, shape_dict, model_file=None, hash_file=None):
+def _get_states(model, prefix=""):
+    """Get the states and the parameters of the model by the names of the Relay params, which are
+    the names in the scripted model. The prefix is "model." for the model before tracing, as it is
+    wrapped as the "model" attribute of TraceWrapper."""
+    states = {prefix + name: value for name, value in model.state_dict(keep_vars=True).items()}
+    param_dict = {prefix + name: value for name, value in model.named_parameters()}
+    return states, param_dict
+
+
+def _convert_params(param_names, states, param_dict, relay_params=None):
+    """Get the RAF params and the auxiliary params by the names of the Relay params. The PyTorch
+    tensors in the states are shared by DLPack if relay_params is None, or the Relay params are
+    used otherwise. The names of the same PyTorch tensor, e.g., the tied embeddings, get the same
+    RAF param, which FrameworkModel then ties."""
+    meta_params = OrderedDict()
+    aux_params = OrderedDict()
+    shared = {}
+    for name in param_names:
+        key = id(states[name]) if name in states else name
+        if key in shared:
+            array_value = shared[key]
+        elif relay_params is not None:
+            array_value = from_dlpack(relay_params[name])
+        else:
+            array_value = from_dlpack(states[name].detach().contiguous())
+        shared[key] = array_value
+        valid_name = validate_relay_param_name(name)
+        meta_params[valid_name] = array_value
+        if name in param_dict:
+            # If a learnable paratmer's requires_grad is False,
+            # the training freezes the parameter update.
+            if not param_dict[name].requires_grad:
+                aux_params[valid_name] = array_value
+        else:
+            aux_params[valid_name] = array_value
+    return meta_params, aux_params
+
+
+def from_pytorch(
+    model,
+    shape_dict,
+    model_file=None,
+    hash_file=None,
+    zero_copy=False,
+    num_threads=1,
+    cache_dir=None,
+):  # pylint: disable=too-many-arguments
     """Load PyTorch model and convert into RAF via Relay.
 
     Parameters
@@ -130,13 +179,41 @@ def from_pytorch(model, shape_dict, model_file=None, hash_file=None):
 
     hash_file: str
         The file that stores the scripted model hash
+
+    zero_copy: bool
+        Whether to share the tensors of the PyTorch model with the RAF params by DLPack instead of
+        using the copies made by the Relay frontend, so the copies are freed after the conversion.
+        Note that the RAF params then alias the PyTorch tensors.
+
+    num_threads: int
+        The number of threads to convert the Relay functions to RAF in parallel.
+
+    cache_dir: str
+        The directory to cache the converted RAF modules by the hash of the model and the input
+        shapes. With a cached module, the tracing and the conversion are skipped, and the params
+        are shared with the PyTorch model as in the zero-copy mode.
+
     Returns
     -------
     model: FrameworkModel
         The converted FrameworkModel.
     """
+    import torch  # pylint: disable=import-outside-toplevel
+
+    model_hash = hashlib.md5(str(model).encode(encoding="UTF-8")).hexdigest()
+    cache_file = None
+    if cache_dir is not None:
+        key = (model_hash + str(sorted(shape_dict.items()))).encode(encoding="UTF-8")
+        cache_file = os.path.join(cache_dir, hashlib.md5(key).hexdigest() + ".json")
+        if os.path.exists(cache_file):
+            with open(cache_file, "r") as cachef:
+                cached = json.load(cachef)
+            meta_mod = load_json(cached["module"])
+            states, param_dict = _get_states(model, "model.")
+            meta_params, aux_params = _convert_params(cached["params"], states, param_dict)
+            return FrameworkModel(SwitchTrainOp(True)(meta_mod), meta_mod, meta_params, aux_params)
+
     if model_file is not None and hash_file is not None:
-        model_hash = hashlib.md5(str(model).encode(encoding="UTF-8")).hexdigest()
         if os.path.exists(model_file) and os.path.exists(hash_file):
             try:
                 with open(hash_file, "r") as hashf:
@@ -160,27 +237,20 @@ def from_pytorch(model, shape_dict, model_file=None, hash_file=None):
         input_type = input_info[1]
         shape_list.append((input_name, (input_shape, input_type)))
 
-    py_parameters = scripted_model.named_parameters()
-    param_dict = {}
-    for name, value in py_parameters:
-        param_dict[name] = value
     relay_mod, relay_params = relay.frontend.from_pytorch(scripted_model, shape_list)
-    meta_mod = FromRelay()(relay_mod)
-    meta_params = OrderedDict()
-    aux_params = OrderedDict()
-    for var in relay_mod["main"].params:
-        name = var.name_hint
-        if name in relay_params:
-            array_value = ndarray(relay_params[name].numpy())
-            valid_name = validate_relay_param_name(name)
-            meta_params[valid_name] = array_value
-            if name in param_dict:
-                # If a learnable paratmer's requires_grad is False,
-                # the training freezes the parameter update.
-                if not param_dict[name].requires_grad:
-                    aux_params[valid_name] = array_value
-            else:
-                aux_params[valid_name] = array_value
+    with tvm.transform.PassContext(config={"raf.pass.function_pass_threads": num_threads}):
+        meta_mod = FromRelay()(relay_mod)
+    param_names = [var.name_hint for var in relay_mod["main"].params]
+    param_names = [name for name in param_names if name in relay_params]
+    states, param_dict = _get_states(scripted_model)
+    if zero_copy or cache_dir is not None:
+        meta_params, aux_params = _convert_params(param_names, states, param_dict)
+    else:
+        meta_params, aux_params = _convert_params(param_names, states, param_dict, relay_params)
     # relay_params may contain unused parameters, which are not present in meta_params
     assert len(meta_params) <= len(relay_params)
+    if cache_file is not None:
+        os.makedirs(cache_dir, exist_ok=True)
+        with open(cache_file, "w") as cachef:
+            json.dump({"module": save_json(meta_mod), "params": param_names}, cachef)
     return FrameworkModel(SwitchTrainOp(True)(meta_mod), meta_mod, meta_params, aux_params)
@@ -33,10 +33,13 @@ class ANFBuilder:
     def call(self, op_name: str, args: List[tvm.relay.Expr]) -> tvm.relay.Var:
         return self.scope_builder.let("", tvm.relay.Call(self.get_operator(op_name), args))
 
-    def set_stream(self, device_id: int, stream_id: int):
+    def set_stream(self, device_id: int, stream_id: int, priority: int = 0):
         device_id = const(device_id)
         stream_id = const(stream_id)
-        return self.call("set_stream", [device_id, stream_id])
+        args = [device_id, stream_id]
+        if priority != 0:
+            args.append(const(priority))
+        return self.call("set_stream", args)
 
     def add_event(self, event_id: int, stream_id: int):
         event_id = const(event_id)
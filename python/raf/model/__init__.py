@@ -4,5 +4,5 @@
 """Model block definition."""
 from .model import Model
 from .trace import trace, trace_mutate_attr
-from .nn import BatchNorm, Conv2d, Linear
+from .nn import BatchNorm, Conv2d, Linear, ShardedEmbedding
 from .structure import Sequential
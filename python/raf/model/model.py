@@ -9,8 +9,16 @@ import re
 from raf._core import cacher
 from raf._core.core_utils import bfs, get_attr, get_named_attr, set_module
 from raf._core.device import Device
+from raf._core.executor import VMExecutor
 from raf._core.ndarray import ndarray
-from raf.model.trace import _get_trace_record
+from raf._ffi.model import (
+    GetExecutorCacheCapacity,
+    RecordExecutorCacheGet,
+    RecordExecutorCacheRelease,
+    RecordExecutorCacheSet,
+)
+from raf._lib import tvm
+from raf.model.trace import _get_func_inputs, _get_input_signature, _get_trace_record
 
 
 @set_module("raf")
@@ -40,6 +48,88 @@ class BaseModel:
     def to(self, *, device=None, dtype=None):  # pylint: disable=invalid-name
         raise NotImplementedError
 
+    def _executor_cache(self):
+        raise NotImplementedError
+
+    def _get_vm_inputs(self, record, args, kwargs):
+        raise NotImplementedError
+
+    def run_vm(self, *args, device="cpu", **kwargs):
+        """Run the model on the VM. The executable and the VM are compiled once for each mode,
+        input signature (the shapes and dtypes of the inputs), device, distributed config and pass
+        context, and are reused by the following calls with the same ones.
+
+        Parameters
+        ----------
+        args : raf.ndarray
+            The input data of the model.
+
+        device : str
+            The device to run the model on.
+
+        kwargs : named inputs
+            The named input data of the model.
+
+        Returns
+        -------
+        result : Object
+            The output of the VM.
+        """
+        pass_ctx = tvm.transform.PassContext.current()
+        key = (
+            self.__is_train,
+            _get_input_signature(args, kwargs),
+            str(device),
+            tuple(sorted(_get_dist_config().dumps().items())),
+            (
+                pass_ctx.opt_level,
+                str(pass_ctx.config),
+                tuple(pass_ctx.required_pass),
+                tuple(pass_ctx.disabled_pass),
+            ),
+        )
+
+        def compile_model():
+            record = self._internal(*args, **kwargs)
+            return record, VMExecutor(record.mod, device)
+
+        record, executor = self._executor_cache().get(key, compile_model)
+        return executor.vm.run(*self._get_vm_inputs(record, args, kwargs))
+
+
+class ExecutorCache:
+    """The compiled records and VM executors of a model, keyed by the signature of the inputs.
+    Each model keeps at most the capacity of the "model_executor" cache, which can be set by
+    raf._ffi.cache.SetCacheCapacity, and evicts the least recently used one once it is full.
+    The lookups are counted in the metrics of the "model_executor" cache.
+    """
+
+    def __init__(self):
+        self.entries = OrderedDict()
+
+    def __del__(self):
+        if self.entries:
+            RecordExecutorCacheRelease(len(self.entries), False)
+
+    def get(self, key, maker):
+        """Get the entry of the key, or make and cache it on a miss."""
+        entry = self.entries.get(key, None)
+        RecordExecutorCacheGet(entry is not None)
+        if entry is not None:
+            self.entries.move_to_end(key)
+            return entry
+        entry = maker()
+        capacity = GetExecutorCacheCapacity()
+        num_evicted = 0
+        while 0 < capacity <= len(self.entries):
+            self.entries.popitem(last=False)
+            num_evicted += 1
+        if num_evicted > 0:
+            RecordExecutorCacheRelease(num_evicted, True)
+        self.entries[key] = entry
+        RecordExecutorCacheSet()
+        return entry
+
 
 class Model(BaseModel, cacher.Cacher):
     def __init__(self, *args, **kwargs):
@@ -131,17 +221,36 @@ class Model(BaseModel, cacher.Cacher):
         return _get_attr_params_key_value(self)
 
     def to(self, *, device=None, dtype=None, invalidate=True):  # pylint: disable=arguments-differ
+        converted = {}
         for model in _get_model_dict(self, prefix="", recursive=True).values():
             for name, param in _get_attr_params_key_value(model).items():
-                param = param.to(device=device, dtype=dtype)
+                param = _param_to(param, device, dtype, converted)
                 setattr(model, name, param)
         if invalidate:
             cacher.invalidate(self, include_self=True, recursive=True)
 
+    def _executor_cache(self):
+        # The executors are dropped with the other caches once the model is invalidated.
+        cache = cacher.get_cache(self, "executor", None)
+        if cache is None:
+            cache = ExecutorCache()
+            cacher.set_cache(self, "executor", cache)
+        return cache
+
+    def _get_vm_inputs(self, record, args, kwargs):
+        return _get_func_inputs(record, args, kwargs, get_handle=False)
+
 
 # pylint: disable=protected-access
 
 
+def _get_dist_config():
+    # pylint: disable=import-outside-toplevel
+    from raf.distributed import get_config
+
+    return get_config()
+
+
 def _get_attr_models_key_value(model):
     return get_named_attr(model, check=lambda x: isinstance(x, BaseModel))
 
@@ -150,6 +259,18 @@ def _get_attr_models_value(model):
     return get_attr(model, check=lambda x: isinstance(x, BaseModel))
 
 
+def _param_to(param, device, dtype, converted):
+    """Move a param to the device and convert it to the dtype. Only the floating-point params are
+    converted, as the integer ones are usually indices. The params sharing an array, e.g., the tied
+    weights, keep sharing the converted one, which is memoized in converted by the array id."""
+    key = id(param)
+    if key not in converted:
+        is_float = str(param.dtype).startswith(("float", "bfloat"))
+        # The original param is kept as well, so that its id is not reused by another one.
+        converted[key] = (param, param.to(device=device, dtype=dtype if is_float else None))
+    return converted[key][1]
+
+
 def _get_attr_params_key_value(model):
     return get_named_attr(model, check=lambda x: isinstance(x, ndarray))
 
@@ -10,7 +10,9 @@ import numpy as np
 from raf._core.ndarray import ndarray, array
 from raf._core.core_utils import get_chained_attr
 from raf._op import sym
-from raf.random import uniform
+from raf.distributed.communicator import get_communicator
+from raf.distributed.op import sharded_embedding
+from raf.random import normal, uniform
 from raf.random.nn import kaiming_uniform
 
 from .model import Model
@@ -203,3 +205,28 @@ class GELU(Model):
                 sym.multiply(sym.erf(sym.multiply(x, self._inv_sqrt_2)), self._inv_2),
             ),
         )
+
+
+class ShardedEmbedding(Model):
+    """An embedding table whose rows are evenly partitioned across all ranks, where each rank
+    only holds its shard. See raf.distributed.sharded_embedding for the lookup."""
+
+    def build(self, num_embeddings, embedding_dim, capacity):
+        comm = get_communicator()
+        self.num_embeddings = num_embeddings
+        self.embedding_dim = embedding_dim
+        self.capacity = capacity
+        self.rows_per_shard = (num_embeddings + comm.size - 1) // comm.size
+        self.reset()
+
+    def reset(self):
+        self.w = normal(
+            shape=(self.rows_per_shard, self.embedding_dim),
+            name="w",
+            device=get_chained_attr(self, ["w", "device"], "cpu"),
+        )
+        self.w.model_parallel = True
+
+    @trace
+    def forward(self, indices):
+        return sharded_embedding(self.w, indices, self.rows_per_shard, self.capacity)
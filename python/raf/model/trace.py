@@ -118,14 +118,32 @@ def _unwrap(result):
     return result
 
 
+def _get_input_signature(args, kwargs):
+    """Get the hashable signature of the inputs, i.e., the shapes, dtypes and devices of the
+    arrays, which determines the types of the traced function."""
+
+    def get_signature(x):
+        if isinstance(x, ndarray):
+            return (tuple(x.shape), x.dtype, x.device)
+        if isinstance(x, (tuple, list)):
+            return tuple(get_signature(i) for i in x)
+        # Symbols and other inputs are only matched by identity.
+        return (type(x).__name__, id(x))
+
+    return (
+        tuple(get_signature(x) for x in args),
+        tuple(sorted((k, get_signature(v)) for k, v in kwargs.items())),
+    )
+
+
 def _get_trace_record(pyfunc, args, kwargs):
     model = args[0]
-    func_name = get_func_name(pyfunc)
-    record = cacher.get_cache(model, "trace@" + func_name, None)
+    key = ("trace@" + get_func_name(pyfunc), _get_input_signature(args[1:], kwargs))
+    record = cacher.get_cache(model, key, None)
     if record is not None:
         return record
     record = _do_tracing(pyfunc, args, kwargs)
-    cacher.set_cache(model, "trace@" + func_name, record)
+    cacher.set_cache(model, key, record)
     return record
 
 
@@ -2,7 +2,10 @@
 # SPDX-License-Identifier: Apache-2.0
 
 """Optimizers, e.g., SGD."""
-from . import sgd, lans
+from . import sgd, lans, adam
 from .sgd import SGD
 from .lans import LANS
+from .adam import Adam, AdamW
 from .optim import inline
+from .pipeline import with_pipeline
+from .tensor_parallel import with_tensor_parallel
@@ -0,0 +1,371 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name, missing-function-docstring, too-many-instance-attributes, too-many-locals, too-many-statements, protected-access, too-many-arguments, too-many-branches
+"""Adam and AdamW optimizers with the multi-tensor kernel."""
+import numpy as np
+
+from raf._core.core_utils import get_chained_attr
+from raf._core.ndarray import array, ndarray
+from raf.model import trace, Model, trace_mutate_attr
+from raf.model.trace import _get_func_inputs
+from raf._op import sym as _op
+from raf._op import imp
+from .. import distributed as dist
+from .data_parallel import with_data_parallel
+from ..distributed.op import allgather
+from .optim import with_autodiff
+from .utils import has_grad, split_ndarray_with_padding
+
+
+# pylint: disable=too-few-public-methods
+class Adam:
+    """Optimizer : Adam. All parameters are updated by a single multi-tensor kernel.
+    # References
+    - Adam: A Method for Stochastic Optimization. https://arxiv.org/abs/1412.6980
+    - Decoupled Weight Decay Regularization. https://arxiv.org/abs/1711.05101
+
+    Parameters
+    ----------
+    lr: Optional[Float]
+        Learning rate. Default: 1e-3
+
+    betas: Optional[Tuple[Float, Float]]
+        Coefficients used for computing running averages of gradient and its square.
+        Default: (0.9, 0.999)
+
+    eps: Optional[Float]
+        Term added to the denominator to improve numerical stability. Default: 1e-8
+
+    weight_decay: Optional[Float]
+        Weight decay. Default: 0
+
+    adamw: Optional[bool]
+        Whether to decouple the weight decay from the gradient (AdamW) instead of applying it
+        as L2 regularization. Default: False
+    """
+
+    def __init__(self, params, lr=1e-3, betas=(0.9, 0.999), eps=1e-8, weight_decay=0, adamw=False):
+        self.lr = lr
+        self.beta1 = betas[0]
+        self.beta2 = betas[1]
+        self.eps = eps
+        self.weight_decay = weight_decay
+        self.mode = 1 if adamw else 0
+        self.params = []
+        self._step = 1
+        for i, x in enumerate(params):
+            assert isinstance(x, ndarray), "Only `raf.ndarray' can be optimized!"
+            assert x.dtype == "float32", "Only float32 parameters are supported"
+            npa = np.zeros(x.shape, dtype=x.dtype)
+            m_i = ndarray(npa, device=x.device, name=f"adam.{i}.m")
+            v_i = ndarray(npa, device=x.device, name=f"adam.{i}.v")
+            self.params.append((x, m_i, v_i))
+
+    def step(self):
+        """Update the parameters with gradients."""
+        g_list = []
+        x_list = []
+        m_list = []
+        v_list = []
+        for x, m, v in self.params:
+            if x.grad is None:
+                continue
+            g_list.append(x.grad)
+            x_list.append(x)
+            m_list.append(m)
+            v_list.append(v)
+        if not g_list:
+            return
+        step = array(self._step, dtype="float32", device=x_list[0].device, name="step")
+        # The tensors are updated in place.
+        imp.multi_tensor_adam(
+            g_list + x_list + m_list + v_list,
+            step,
+            self.lr,
+            self.beta1,
+            self.beta2,
+            self.eps,
+            self.weight_decay,
+            True,
+            self.mode,
+        )
+        self._step += 1
+
+
+class AdamW(Adam):
+    """Optimizer : AdamW, i.e., Adam with the decoupled weight decay. See `Adam`."""
+
+    def __init__(self, params, lr=1e-3, betas=(0.9, 0.999), eps=1e-8, weight_decay=0.01):
+        super().__init__(params, lr, betas, eps, weight_decay, adamw=True)
+
+
+def with_adam(
+    lr=1e-3,
+    betas=(0.9, 0.999),
+    eps=1e-8,
+    weight_decay=0,
+    adamw=False,
+    max_grad_norm=None,
+    skip_overflow=False,
+    loss_scaler=None,
+):
+    """Optimizer : Adam/AdamW. The whole optimizer step of all parameters is a single
+    multi-tensor kernel. For float16 models, float32 master weights are maintained and the
+    kernel also writes the updated float16 parameters, unless the optimizer status is
+    partitioned by ZeRO. With ZeRO-Offload, the optimizer status and the float32 master weights
+    are kept in the host memory and the kernel runs on CPU, which writes the float16 partitions to
+    be copied back to the device.
+
+    Parameters
+    ----------
+    lr: Optional[Float]
+        Learning rate. Default: 1e-3
+
+    betas: Optional[Tuple[Float, Float]]
+        Coefficients used for computing running averages of gradient and its square.
+        Default: (0.9, 0.999)
+
+    eps: Optional[Float]
+        Term added to the denominator to improve numerical stability. Default: 1e-8
+
+    weight_decay: Optional[Float]
+        Weight decay. Default: 0
+
+    adamw: Optional[bool]
+        Whether to use the decoupled weight decay (AdamW). Default: False
+
+    max_grad_norm: Optional[float]
+        If set, the gradients are scaled so that their global L2 norm is at most max_grad_norm.
+        Default: None
+
+    skip_overflow: Optional[bool]
+        Whether to skip the step if any gradient has inf or nan. The step is always skipped in
+        this case if max_grad_norm is set. The global norm and the decision are computed on the
+        device without a host synchronization. Default: False
+
+    loss_scaler: Optional[raf.amp.DynamicLossScaler]
+        If set, the output gradient is scaled by the dynamic loss scale, which is kept and updated
+        on the device. The gradients are unscaled by the kernel, and the step is skipped if they
+        overflow. Default: None
+
+    Returns
+    ret : function
+        The wrapper which wraps a model with Adam
+    """
+
+    def get_model_dtype(model):
+        """A helper function to determine the parameter dtype by referring to
+        the first floating type parameter.
+        Parameters
+        ----------
+        model: Model
+            The model to be evaluated.
+        """
+        for param in model.state().values():
+            if "float" in param.dtype:
+                return param.dtype
+        return "float32"
+
+    def decorator(model):
+        class AdamWrapper(Model):
+            """Adam wrapper model
+
+            Parameters
+            ----------
+            model: the forward model
+            """
+
+            # pylint: disable=attribute-defined-outside-init
+            def build(self, model):
+                assert dist.get_config().zero_opt_level < 3, "Adam does not support ZeRO-3 yet"
+                assert (
+                    not dist.get_config().zero_flat_buffer
+                ), "Adam does not support flat buffers yet"
+                # The norm of the gradients partitioned by ZeRO would only be a partial norm.
+                self.check_grad_norm = (
+                    max_grad_norm is not None or skip_overflow or loss_scaler is not None
+                )
+                assert (
+                    not self.check_grad_norm or not dist.get_config().zero_opt_level
+                ), "Gradient clipping and overflow check do not support ZeRO yet"
+                self.model = model
+                self.ad_model = with_data_parallel(with_autodiff(model))
+                self.lr = lr
+                self.beta1 = betas[0]
+                self.beta2 = betas[1]
+                self.eps = eps
+                self.weight_decay = weight_decay
+                self.mode = 1 if adamw else 0
+                # Determine the parameter dtype by referring to the first floating type parameter.
+                self.dtype = get_model_dtype(self.model)
+                self.zero = array(0.0, dtype=self.dtype)
+                self.one = array(1.0, dtype="float32")
+                dcfg = dist.get_config()
+                comm = dist.get_communicator()
+                # The kernel directly writes the float16 parameters if they are not partitioned.
+                self.fp16_params = self.dtype == "float16" and not dcfg.zero_opt_level
+                # ZeRO-Offload: The status is on CPU, where the kernel writes float16 partitions so
+                # that only half of the bytes are copied back to the device.
+                self.offload = dcfg.zero_opt_level > 0 and dcfg.zero_offload
+                self.offload_fp16 = self.offload and self.dtype == "float16"
+                device = None
+                self.params = {}
+                # ZeRO-Offload: Mapping from a parameter to its float16 partition on CPU.
+                self.offload_params = {}
+                for name, param in self.model.state().items():
+                    if param.requires_grad is True:
+                        if device is None:
+                            device = param.device
+                        else:
+                            assert device == param.device
+                        assert isinstance(param, ndarray), "Only `raf.ndarray` can be optimized!"
+                        part_shape = param.shape
+                        if dcfg.zero_opt_level:
+                            # Keep a float32 slice of the weight as the master weight.
+                            param_nd = param.to(device="cpu")
+                            if "float" in param.dtype and param.dtype != "float32":
+                                param_nd = param_nd.to(dtype="float32")
+                            slice_param = split_ndarray_with_padding(param_nd, comm.size)[comm.rank]
+                            weight = ndarray(
+                                slice_param,
+                                device="cpu" if self.offload else param.device,
+                                name=f"{name}.adam_w",
+                                dtype="float32",
+                            )
+                            setattr(self, f"{name}.adam_w", weight)
+                            part_shape = slice_param.shape
+                            if self.offload_fp16:
+                                part_p = array(
+                                    np.zeros(part_shape, dtype="float16"),
+                                    device="cpu",
+                                    name=f"{name}.adam_p",
+                                )
+                                setattr(self, f"{name}.adam_p", part_p)
+                                self.offload_params[param._ndarray__handle] = part_p
+                        elif "float" in param.dtype and param.dtype != "float32":
+                            weight = ndarray(
+                                param.to(dtype="float32"),
+                                device=param.device,
+                                name=f"{name}.adam_w",
+                                dtype="float32",
+                            )
+                            setattr(self, f"{name}.adam_w", weight)
+                        else:
+                            weight = param
+                        npa = np.zeros(part_shape, dtype="float32")
+                        status_device = "cpu" if self.offload else device
+                        m_i = array(npa, device=status_device, name=f"{name}.adam_m")
+                        v_i = array(npa, device=status_device, name=f"{name}.adam_v")
+                        setattr(self, f"{name}.adam_m", m_i)
+                        setattr(self, f"{name}.adam_v", v_i)
+                        self.params[param._ndarray__handle] = (name, param, weight, m_i, v_i)
+                assert device is not None
+                if loss_scaler is not None:
+                    loss_scaler.init_state(self, device)
+                self.step = array(
+                    0.0, dtype="float32", device="cpu" if self.offload else device, name="step"
+                )
+
+            @trace
+            def forward(self, dy, *args, **kwargs):
+                dcfg = dist.get_config()
+                comm = dist.get_communicator()
+                scaled_dy = dy if loss_scaler is None else loss_scaler.scale(self, dy)
+                y, dxs = self.ad_model(scaled_dy, *args, **kwargs)
+                record = self.ad_model._internal(dy, *args, **kwargs)
+                inputs = _get_func_inputs(record, [dy, *args], kwargs)
+                inputs = inputs[1:]  # remove dy
+
+                updated = []
+                g_list = []
+                for i, param in enumerate(inputs):
+                    dxi = dxs[i] if len(inputs) > 1 else dxs
+                    if param in self.params and has_grad(dxi):
+                        name, p, w, m, v = self.params[param]
+                        if "float" not in w.dtype:
+                            continue
+                        updated.append((name, p, w, m, v))
+                        g_list.append(dxi)
+                if not updated:
+                    next_step = _op.add(self.step, self.one, out=self.step)
+                    trace_mutate_attr(self, "step", next_step)
+                    return y
+                ntensor = len(updated)
+
+                # The kernel takes float32 or float16 gradients.
+                if self.dtype not in ("float32", "float16"):
+                    fp32_g = _op.group_cast(g_list, "float32")
+                    g_list = [fp32_g[i] for i in range(ntensor)]
+
+                # update step, which is not counted if the step is skipped due to overflow
+                grad_norm = None
+                if self.check_grad_norm:
+                    norm_and_check = _op.global_norm_and_check(g_list)
+                    grad_norm = norm_and_check[0]
+                    not_skipped = _op.subtract(self.one, _op.cast(norm_and_check[1], "float32"))
+                    next_step = _op.add(self.step, not_skipped, out=self.step)
+                else:
+                    next_step = _op.add(self.step, self.one, out=self.step)
+                trace_mutate_attr(self, "step", next_step)
+
+                tensor_list = g_list + [item[2] for item in updated]
+                tensor_list += [item[3] for item in updated] + [item[4] for item in updated]
+                if self.fp16_params:
+                    tensor_list += [item[1] for item in updated]
+                elif self.offload_fp16:
+                    handles = [item[1]._ndarray__handle for item in updated]
+                    tensor_list += [self.offload_params[handle] for handle in handles]
+                output_list = _op.multi_tensor_adam(
+                    tensor_list,
+                    next_step,
+                    self.lr,
+                    self.beta1,
+                    self.beta2,
+                    self.eps,
+                    self.weight_decay,
+                    True,
+                    self.mode,
+                    self.fp16_params or self.offload_fp16,
+                    grad_norm,
+                    max_grad_norm or 0.0,
+                    self.loss_scale if loss_scaler is not None else None,
+                )
+                if loss_scaler is not None:
+                    loss_scaler.update(self, grad_norm)
+
+                for idx, (name, p, w, m, v) in enumerate(updated):
+                    new_w = output_list[idx + ntensor]
+                    if self.fp16_params:
+                        next_w = output_list[idx + 4 * ntensor]
+                    elif dcfg.zero_opt_level > 0:
+                        new_weight = new_w
+                        if self.offload_fp16:
+                            new_weight = output_list[idx + 4 * ntensor]
+                            trace_mutate_attr(self, f"{name}.adam_p", new_weight)
+                        elif self.dtype != "float32":
+                            new_weight = _op.cast(new_weight, self.dtype)
+                        if self.offload:
+                            # Copy the updated partition back to the device to be gathered.
+                            new_weight = _op.device_copy(new_weight, "cpu", p.device)
+                        new_weight = allgather(new_weight, axis=0)
+                        # Slice to remove the zero-padding if needed.
+                        if w.shape[0] * comm.size > p.shape[0]:
+                            new_weight = _op.strided_slice(new_weight, [0], [p.shape[0]], [1])
+                        next_w = _op.add(new_weight, self.zero, out=p)
+                    elif self.dtype != "float32":
+                        next_w = _op.add(_op.cast(new_w, self.dtype), self.zero, out=p)
+                    else:
+                        # The weight is updated in place.
+                        next_w = new_w
+                    param_model = get_chained_attr(self.model, name.split(".")[:-1])
+                    trace_mutate_attr(param_model, name.split(".")[-1], next_w)
+                    if w is not p:
+                        trace_mutate_attr(self, f"{name}.adam_w", new_w)
+                    trace_mutate_attr(self, f"{name}.adam_m", output_list[idx + 2 * ntensor])
+                    trace_mutate_attr(self, f"{name}.adam_v", output_list[idx + 3 * ntensor])
+                return y
+
+        return AdamWrapper(model)
+
+    return decorator
@@ -12,11 +12,30 @@ The methodologies includes:
                  optimizer can have a partitioned optimizer status. Note that optimizers must
                  consider gradient partitioning if applied; otherwise the result will be incorrect.
    2.2 (ZeRO-2): Use reduce instead of all-reduce in (1) to obtain only a partition of gradients.
+   2.3 (ZeRO-3): In addition to (2.2), partition the parameters. Each rank only keeps the
+                 partition of the parameters on device, and the complete parameters are gathered
+                 right before they are used in the forward and the backward. The complete
+                 parameters of the model are moved to CPU, and the optimizer updates the
+                 partitions in `zero3_shards` instead.
+3. Deferred allgather (ZeRO-1/2 with zero_defer_allgather): The parameters are partitioned like
+   ZeRO-3, so the updated partitions are not gathered at the end of a step. Instead, each
+   parameter is gathered in the next step right before its first use in the forward, which
+   overlaps with the forward of the earlier layers, and the gathered parameter is kept for the
+   backward instead of being gathered again.
+4. ZeRO-Offload (ZeRO-1/2 with zero_offload, https://arxiv.org/abs/2101.06840): The gradient
+   partitions are copied to the pinned host memory, so that the optimizer keeps its status and
+   the float32 master weights in the host memory and updates them on CPU.
+5. Flat buffers (ZeRO-1/2 with zero_flat_buffer): The gradients are packed into a few flat
+   buffers in `zero_flat_buckets`, each of which is padded and partitioned once instead of
+   padding and partitioning each gradient, which saves the memory and the collectives for the
+   models with many small parameters. The optimizer updates the flat partitions accordingly.
 """
 from raf.ir import RAFSequential
 from .optim import inline
+from .utils import make_flat_buckets, split_ndarray_with_padding
 from .. import distributed as dist
-from .._ffi.pass_ import PartitionGradient, InferType
+from .._core.ndarray import ndarray
+from .._ffi.pass_ import PartitionGradient, PartitionParameter, InferType
 from ..model import Model, trace
 from ..model.trace import _get_func_inputs
 
@@ -37,6 +56,42 @@ def with_data_parallel(model):
             # pylint: disable=attribute-defined-outside-init, missing-function-docstring
             self.model = model
 
+            # ZeRO-3: Mapping from the handle of a parameter to the attribute name and the
+            # partition of the parameter on this rank.
+            self.zero3_shards = {}
+            dcfg = dist.get_config()
+            # ZeRO-Offload: The device of the gradients to be copied to the host.
+            self.offload_device = ""
+            if dcfg.zero_offload:
+                assert 0 < dcfg.zero_opt_level < 3, "ZeRO-Offload only supports ZeRO-1/2"
+                params = [p for p in self.model.state().values() if p.requires_grad]
+                self.offload_device = params[0].device if params else ""
+            # Flat buffers: The buckets of (name, param) whose gradients are packed into flat
+            # buffers, in the order of packing.
+            self.zero_flat_buckets = []
+            if dcfg.zero_flat_buffer:
+                assert (
+                    0 < dcfg.zero_opt_level < 3 and not dcfg.zero_defer_allgather
+                ), "Flat buffers only support ZeRO-1/2 without deferred allgather"
+                params = [(n, p) for n, p in self.model.state().items() if p.requires_grad]
+                self.zero_flat_buckets = make_flat_buckets(params, dcfg.group_bucket_size)
+            if dcfg.zero_opt_level > 2 or (dcfg.zero_opt_level > 0 and dcfg.zero_defer_allgather):
+                comm = dist.get_communicator()
+                for name, param in self.model.state().items():
+                    if not param.requires_grad:
+                        continue
+                    param_nd = param.to(device="cpu")
+                    shard = ndarray(
+                        split_ndarray_with_padding(param_nd, comm.size)[comm.rank],
+                        device=param.device,
+                        name=f"{name}.zero3_shard",
+                        dtype=param.dtype,
+                    )
+                    setattr(self, f"{name}.zero3_shard", shard)
+                    self.zero3_shards[param._ndarray__handle] = (f"{name}.zero3_shard", shard)
+                    # The complete parameter is only used for tracing from now on.
+                    param.update(param_nd)
+
         @trace
         def forward(self, *args, **kwargs):
             # pylint: disable=protected-access, missing-function-docstring
@@ -49,17 +104,37 @@ def with_data_parallel(model):
             # so that it can be applied here.
             # if dcfg.enable_data_parallel:
             #     passes.append(AutoDataParallel())
+            inputs = _get_func_inputs(record, args, kwargs)
             if dcfg.zero_opt_level > 0:
                 passes = []
+                # The gradients are in the order of the inputs except dy.
+                flat_buckets = []
+                for bucket in self.zero_flat_buckets:
+                    handles = [param._ndarray__handle for _, param in bucket]
+                    assert all(
+                        h in inputs for h in handles
+                    ), "Flat buffers need all parameters to be used by the model"
+                    flat_buckets.append([inputs.index(h) - 1 for h in handles])
                 passes.append(InferType())
                 passes.append(
                     PartitionGradient(
-                        dcfg.zero_opt_level, comm.size, comm.rank, dcfg.group_bucket_size
+                        dcfg.zero_opt_level,
+                        comm.size,
+                        comm.rank,
+                        dcfg.group_bucket_size,
+                        self.offload_device,
+                        flat_buckets,
                     )
                 )
+                if self.zero3_shards:
+                    # Feed the partitions of the parameters instead of the complete ones.
+                    param_indices = [i for i, x in enumerate(inputs) if x in self.zero3_shards]
+                    regather = dcfg.zero_opt_level > 2
+                    passes.append(PartitionParameter(comm.size, param_indices, regather))
+                    for i in param_indices:
+                        inputs[i] = self.zero3_shards[inputs[i]][1]._ndarray__handle
                 seq = RAFSequential(passes, name="with_data_parallel")
                 mod = seq(mod)
-            inputs = _get_func_inputs(record, args, kwargs)
             out = inline(mod["main"], inputs)
             y = out[0]
             dxs = out[1]
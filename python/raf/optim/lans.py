@@ -162,6 +162,11 @@ def with_lans(
 
             # pylint: disable=attribute-defined-outside-init
             def build(self, model):
+                assert dist.get_config().zero_opt_level < 3, "LANS does not support ZeRO-3 yet"
+                assert not dist.get_config().zero_offload, "LANS does not support ZeRO-Offload yet"
+                assert (
+                    not dist.get_config().zero_flat_buffer
+                ), "LANS does not support flat buffers yet"
                 self.model = model
                 self.ad_model = with_data_parallel(with_autodiff(model))
                 self.bias_correction = bias_correction
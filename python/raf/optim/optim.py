@@ -2,18 +2,23 @@
 # SPDX-License-Identifier: Apache-2.0
 
 """Traced Optimizers"""
+import numpy as np
+
 from raf.frontend.model import _get_func_output_var
-from raf.ir import RAFSequential
+from raf.ir import RAFSequential, PassContext
 from .. import distributed as dist
-from .._core.ndarray import Symbol, get_symbol_handle
+from .._core.ndarray import Symbol, ndarray, get_symbol_handle
 from .._core.value import NoGradValue, Value
 from .._core.ir_ext import ExtendedVar
 from ..model.trace import _get_func_inputs
 from ..model import Model, trace
 from .._ffi.pass_ import AutoDiff, InlineBackward, Substitute, InferType, FoldConstant
-from .._ffi.pass_ import DeadCodeElimination, AutoDataParallel
+from .._ffi.pass_ import DeadCodeElimination, AutoDataParallel, FuseBatchNormRelu
+from .._ffi.pass_ import AccumulateGradient
+from .._op.sym import add, concatenate, multiply, split
 from .._ffi.binding import BindSymbol
 from .._lib import tvm
+from .utils import has_grad
 
 
 def calc_dy(dy, record):
@@ -55,7 +60,16 @@ def inline(func, inputs):
 
 
 def with_autodiff(model):
-    """create a new model by apply autodiff to the input"""
+    """create a new model by apply autodiff to the input
+
+    If "raf.optim.grad_accumulation_steps" in the current PassContext is N > 1 when the model is
+    traced, the inputs are split into N micro-batches along the first axis, and the gradients
+    of the parameters are accumulated over the micro-batches within one step. The model has to
+    output a single loss, and the output is the average loss of the micro-batches. Each micro-batch
+    adds its gradients to the accumulated ones right after they are computed in its backward, and
+    only the last micro-batch aggregates the accumulated gradients across ranks for data
+    parallelism, which overlaps with its backward.
+    """
 
     class AutoDiffWrapper(Model):
         """AutoDiff model
@@ -71,22 +85,76 @@ def with_autodiff(model):
 
         @trace
         def forward(self, dy, *args, **kwargs):
-            # pylint: disable=protected-access, missing-function-docstring
-            record = self.model._internal(*args, **kwargs)
-            dy = calc_dy(dy, record)
-            mod = record.mod
-            passes = [InferType(), AutoDiff(record.requires_grads)]
-            if dist.get_config().enable_data_parallel:
-                # TODO: Refactor AutoDataParallel to let it work on the IR after InlineBackward.
-                passes += [AutoDataParallel()]
-            passes += [InferType(), FoldConstant(), DeadCodeElimination(), InlineBackward()]
-            seq = RAFSequential(passes, name="with_autodiff")
-            mod = seq(mod)
-            inputs = _get_func_inputs(record, args, kwargs)
-            inputs = inputs + [get_symbol_handle(dy)]
-            out = inline(mod["main"], inputs)
-            y = out[0]
-            dxs = out[1]
-            return y, dxs
+            # pylint: disable=protected-access, missing-function-docstring, too-many-locals
+            def run_backward(dy, args, kwargs, acc_grads=None, aggregate=True):
+                record = self.model._internal(*args, **kwargs)
+                dy = calc_dy(dy, record)
+                mod = record.mod
+                orig_inputs = _get_func_inputs(record, args, kwargs, get_handle=False)
+                passes = [InferType()]
+                if PassContext.current().config.get("raf.optim.fuse_batch_norm_relu", False):
+                    passes += [FuseBatchNormRelu()]
+                passes += [AutoDiff(record.requires_grads)]
+                if acc_grads is not None:
+                    passes += [AccumulateGradient([x is not None for x in acc_grads])]
+                if aggregate and dist.get_config().enable_data_parallel:
+                    # TODO: Refactor AutoDataParallel to let it work on the IR after
+                    # InlineBackward.
+                    # The gradients of the partitioned parameters are not aggregated.
+                    local_grads = [isinstance(x, ndarray) and x.model_parallel for x in orig_inputs]
+                    passes += [AutoDataParallel(local_grads)]
+                passes += [InferType(), FoldConstant(), DeadCodeElimination(), InlineBackward()]
+                seq = RAFSequential(passes, name="with_autodiff")
+                mod = seq(mod)
+                inputs = _get_func_inputs(record, args, kwargs)
+                if acc_grads is not None:
+                    inputs += [get_symbol_handle(x) for x in acc_grads if x is not None]
+                inputs = inputs + [get_symbol_handle(dy)]
+                out = inline(mod["main"], inputs)
+                y = out[0]
+                dxs = out[1]
+                return y, dxs, len(orig_inputs), len(orig_inputs) - len(record.named_params)
+
+            n_micro_batches = int(
+                PassContext.current().config.get("raf.optim.grad_accumulation_steps", 1)
+            )
+            if n_micro_batches == 1:
+                y, dxs, _, _ = run_backward(dy, args, kwargs)
+                return y, dxs
+
+            def split_micro_batches(data):
+                parts = split(data, n_micro_batches, axis=0)
+                return [parts[i] for i in range(n_micro_batches)]
+
+            arg_parts = [split_micro_batches(arg) for arg in args]
+            kwarg_parts = {key: split_micro_batches(val) for key, val in kwargs.items()}
+            scale = np.array(1.0 / n_micro_batches, dtype="float32")
+            dy = multiply(dy, scale)
+            y, grads, data_grads = None, None, None
+            for i in range(n_micro_batches):
+                micro_args = [parts[i] for parts in arg_parts]
+                micro_kwargs = {key: parts[i] for key, parts in kwarg_parts.items()}
+                # The gradients of the parameters are accumulated, and the gradients of the
+                # inputs of the micro-batches are concatenated afterwards.
+                acc_grads = None
+                if grads is not None:
+                    acc_grads = [None] * n_data + [x if has_grad(x) else None for x in grads]
+                loss, dxs, n_inputs, n_data = run_backward(
+                    dy, micro_args, micro_kwargs, acc_grads, i == n_micro_batches - 1
+                )
+                dxs = [dxs[j] for j in range(n_inputs)] if n_inputs > 1 else [dxs]
+                loss = multiply(loss, scale)
+                y = loss if y is None else add(y, loss)
+                grads = dxs[n_data:]
+                if data_grads is None:
+                    data_grads = [[] for _ in range(n_data)]
+                for parts, grad in zip(data_grads, dxs[:n_data]):
+                    parts.append(grad)
+            dxs = [
+                concatenate(parts, axis=0) if has_grad(parts[0]) else parts[0]
+                for parts in data_grads
+            ]
+            dxs += grads
+            return y, dxs[0] if len(dxs) == 1 else Symbol.make_tuple(dxs)
 
     return AutoDiffWrapper(model)
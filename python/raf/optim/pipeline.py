@@ -0,0 +1,204 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""A pipeline parallel wrapper. Each rank holds one stage of the model, and the stages are
+chained by rank, i.e., rank i sends its output activations to rank i + 1 and the gradients of its
+input activations to rank i - 1 with NCCL send/recv. Each mini-batch is split into micro-batches
+along the first axis, and the micro-batches are executed with the 1F1B schedule
+(https://arxiv.org/abs/2104.04473): after a warm-up of forward passes to fill the pipeline, each
+stage alternates between the forward of a micro-batch and the backward of an earlier one, so only
+the inputs of at most (number of stages - stage) micro-batches are kept alive. The backward of a
+micro-batch recomputes its forward instead of keeping the activations, and the gradients of the
+parameters are accumulated over the micro-batches.
+"""
+# pylint: disable=too-many-locals, too-many-statements
+from raf._core.ndarray import Symbol, array
+from raf._op.sym import split, add, multiply
+from .optim import with_autodiff
+from .utils import has_grad
+from .. import distributed as dist
+from .._ffi.pass_ import InferType
+from ..distributed.op import send, recv
+from ..model import Model, trace
+
+
+def get_1f1b_schedule(stage, n_stages, n_micro_batches):
+    """Get the 1F1B schedule of a stage, including the send/recv with the neighbor stages.
+
+    The computations of a stage follow the 1F1B order. The send/recv with the previous stage
+    happen right before the forward and right after the backward of each micro-batch, so they are
+    in the order of the computations of this stage. The send/recv with the next stage are issued
+    in the order of the computations of the next stage, so that the two stages always issue their
+    send/recv with each other in the same order, which is required by NCCL to not deadlock.
+
+    Parameters
+    ----------
+    stage: int
+        The stage index.
+
+    n_stages: int
+        The number of stages.
+
+    n_micro_batches: int
+        The number of micro-batches.
+
+    Returns
+    -------
+    ret: List[Tuple[str, int]]
+        The list of (event, micro-batch index), where the event is one of "forward", "backward",
+        "recv_act", "send_act", "recv_grad", and "send_grad".
+    """
+
+    def compute_order(stage):
+        n_warmup = min(n_stages - stage - 1, n_micro_batches)
+        order = [("forward", i) for i in range(n_warmup)]
+        for i in range(n_micro_batches - n_warmup):
+            order += [("forward", n_warmup + i), ("backward", i)]
+        order += [("backward", i) for i in range(n_micro_batches - n_warmup, n_micro_batches)]
+        return order
+
+    # The send/recv with the next stage, in the order of the computations of the next stage.
+    next_comm = []
+    if stage < n_stages - 1:
+        for event, idx in compute_order(stage + 1):
+            next_comm.append(("send_act" if event == "forward" else "recv_grad", idx))
+    next_comm.reverse()
+
+    schedule = []
+    done_forward = set()
+
+    def issue_sends():
+        # Eagerly send the activations that are ready and in order.
+        while next_comm and next_comm[-1][0] == "send_act" and next_comm[-1][1] in done_forward:
+            schedule.append(next_comm.pop())
+
+    for event, idx in compute_order(stage):
+        if event == "forward":
+            if stage > 0:
+                schedule.append(("recv_act", idx))
+            schedule.append(("forward", idx))
+            done_forward.add(idx)
+        else:
+            while stage < n_stages - 1 and ("recv_grad", idx) not in schedule:
+                comm = next_comm.pop()
+                assert comm[0] == "recv_grad" or comm[1] in done_forward
+                schedule.append(comm)
+            schedule.append(("backward", idx))
+            if stage > 0:
+                schedule.append(("send_grad", idx))
+        issue_sends()
+    assert not next_comm
+    return schedule
+
+
+def with_pipeline(n_micro_batches):
+    """Enable pipeline parallelism for a stage of the model. The rank of the global communicator
+    is the stage index, and the size of the global communicator is the number of stages.
+
+    The stage model takes the input activation as its first argument, which is the input data for
+    the first stage, and may take additional per-sample arguments (e.g., the labels for the last
+    stage), which are split into micro-batches as well. It has to output a single tensor, which
+    is the loss for the last stage. Note that the scale of the micro-batch losses is float32.
+
+    The wrapped model takes (dy, x, *args) like with_autodiff, where dy is the gradient of the
+    loss of a micro-batch, which is only used by the last stage, and x is the input activation
+    of the mini-batch. The stages other than the first one receive their input activations from
+    the previous stage, so their x is only used to get the shape and dtype of the activation.
+    It outputs (y, grads, token), where y is the average loss of the micro-batches on the last
+    stage and the output of the last micro-batch on the other stages, grads is the tuple of the
+    accumulated gradients of the stage parameters, and token is the output of the last send/recv,
+    which must be kept alive to not eliminate the send/recv.
+
+    Parameters
+    ----------
+    n_micro_batches: int
+        The number of micro-batches in a mini-batch.
+
+    Returns
+    -------
+    ret : function
+        The wrapper which wraps a stage model with pipeline parallelism.
+    """
+
+    def decorator(model):
+        class PipelineWrapper(Model):
+            """Pipeline parallel model
+
+            Parameters
+            ----------
+            model: Model
+                The stage model with forward computations.
+            """
+
+            # pylint: disable=attribute-defined-outside-init, protected-access
+            # pylint: disable=missing-function-docstring
+            def build(self, model):
+                self.model = model
+                self.ad_model = with_autodiff(model)
+                self.micro_batch_scale = array(1.0 / n_micro_batches, dtype="float32")
+
+            @trace
+            def forward(self, dy, x, *args):
+                comm = dist.get_communicator()
+                stage, n_stages = comm.rank, comm.size
+                is_first, is_last = stage == 0, stage == n_stages - 1
+
+                def split_micro_batches(data):
+                    if n_micro_batches == 1:
+                        return [data]
+                    parts = split(data, n_micro_batches, axis=0)
+                    return [parts[i] for i in range(n_micro_batches)]
+
+                xs = split_micro_batches(x)
+                arg_parts = [split_micro_batches(arg) for arg in args]
+                micro_args = [[parts[i] for parts in arg_parts] for i in range(n_micro_batches)]
+
+                # Get the shapes and dtypes of the input and output activations.
+                record = self.model._internal(xs[0], *micro_args[0])
+                func = InferType()(record.mod)["main"]
+                in_type, out_type = func.params[0].checked_type, func.checked_type.ret_type
+                in_shape = [int(dim) for dim in in_type.shape]
+                out_shape = [int(dim) for dim in out_type.shape]
+                n_inputs = 1 + len(args)
+
+                token = None
+                out = None
+                grads = None
+                for event, idx in get_1f1b_schedule(stage, n_stages, n_micro_batches):
+                    if event == "recv_act":
+                        xs[idx] = token = recv(stage - 1, in_shape, in_type.dtype, token=token)
+                    elif event == "forward":
+                        # The forward of the last stage is computed with its backward.
+                        if not is_last:
+                            out = self.model(xs[idx], *micro_args[idx])
+                    elif event == "send_act":
+                        # The activation is recomputed in the backward, so the output of a
+                        # forward is only kept until it is sent.
+                        token = send(out, stage + 1, token=token)
+                    elif event == "recv_grad":
+                        dy = token = recv(stage + 1, out_shape, out_type.dtype, token=token)
+                    elif event == "backward":
+                        micro_dy = multiply(dy, self.micro_batch_scale) if is_last else dy
+                        outs = self.ad_model(micro_dy, xs[idx], *micro_args[idx])
+                        dxs = outs[1]
+                        if is_last:
+                            loss = multiply(outs[0], self.micro_batch_scale)
+                            out = loss if out is None else add(out, loss)
+                        param_grads = [dxs[i] for i in range(n_inputs, len(func.params))]
+                        if grads is None:
+                            grads = param_grads
+                        else:
+                            grads = [
+                                add(acc, grad) if has_grad(grad) else acc
+                                for acc, grad in zip(grads, param_grads)
+                            ]
+                        xs[idx] = dxs[0]
+                    elif event == "send_grad":
+                        token = send(xs[idx], stage - 1, token=token)
+                if is_first and is_last:
+                    token = out
+                return out, Symbol.make_tuple(grads), token
+
+        return PipelineWrapper(model)
+
+    return decorator
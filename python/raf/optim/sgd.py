@@ -10,12 +10,13 @@ from raf._core.ndarray import ndarray, array
 from raf.model import trace, Model, trace_mutate_attr
 from raf.model.trace import _get_func_inputs
 from raf._op import imp
-from raf._op.sym import multiply, add, subtract, strided_slice, cast
+from raf._op.sym import multiply, add, subtract, strided_slice, cast, reshape
+from raf._op.sym import multi_tensor_sgd, global_norm_and_check
 from .. import distributed as dist
 from .data_parallel import with_data_parallel
 from ..distributed.op import allgather
 from .optim import with_autodiff
-from .utils import has_grad, split_ndarray_with_padding
+from .utils import has_grad, split_ndarray_with_padding, flat_shard_with_padding
 
 
 # pylint: disable=too-few-public-methods
@@ -58,7 +59,14 @@ class SGD:
             v0.update(v1)
 
 
-def with_sgd(learning_rate=0.1, momentum=0.01):
+def with_sgd(
+    learning_rate=0.1,
+    momentum=0.01,
+    multi_tensor=False,
+    max_grad_norm=None,
+    skip_overflow=False,
+    loss_scaler=None,
+):
     """Optimizer : stochastic gradient descent
 
     Parameters:
@@ -69,6 +77,24 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
     momentum: float (optional)
         momentum factor
 
+    multi_tensor: bool (optional)
+        Whether to update all parameters with a single multi-tensor kernel (CUDA only) instead
+        of a few ops per parameter. The learning rate and momentum are then compile-time
+        constants of the kernel.
+
+    max_grad_norm: float (optional)
+        If set, the gradients are scaled so that their global L2 norm is at most max_grad_norm.
+        Requires multi_tensor.
+
+    skip_overflow: bool (optional)
+        Whether to skip the step if any gradient has inf or nan, which is always the case if
+        max_grad_norm is set. The decision is made on the device. Requires multi_tensor.
+
+    loss_scaler: Optional[raf.amp.DynamicLossScaler]
+        If set, the output gradient is scaled by the dynamic loss scale, which is kept and updated
+        on the device. The gradients are unscaled by the kernel, and the step is skipped if they
+        overflow. Requires multi_tensor.
+
     Returns
     ret : function
         The wrapper which wraps a model with sgd
@@ -101,6 +127,13 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
             # pylint: disable=attribute-defined-outside-init, protected-access, too-many-locals
             # pylint: disable=missing-function-docstring
             def build(self, model):
+                # The norm of the gradients partitioned by ZeRO would only be a partial norm.
+                self.check_grad_norm = (
+                    max_grad_norm is not None or skip_overflow or loss_scaler is not None
+                )
+                assert not self.check_grad_norm or (
+                    multi_tensor and not dist.get_config().zero_opt_level
+                ), "Gradient clipping and overflow check require multi_tensor and no ZeRO"
                 self.model = model
                 self.ad_model = with_data_parallel(with_autodiff(model))
                 self.learning_rate = array(learning_rate, dtype="float32")
@@ -117,18 +150,59 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
 
                 dcfg = dist.get_config()
                 comm = dist.get_communicator()
+
+                # Flat buffers: Each bucket of parameters has a flat SGD weight and variant, which
+                # are the partitions of the flat buffer of the bucket on this rank.
+                self.flat_buckets = []
+                flat_handles = set()
+                for i, bucket in enumerate(self.ad_model.zero_flat_buckets):
+                    params = [param.to(device="cpu", dtype="float32") for _, param in bucket]
+                    device = bucket[0][1].device
+                    v_w = ndarray(
+                        flat_shard_with_padding(params, comm.size)[comm.rank],
+                        device=device,
+                        name=f"sgd.flat{i}.sgd_w",
+                        dtype="float32",
+                    )
+                    v_i = ndarray(
+                        np.zeros(v_w.shape, dtype="float32"),
+                        device=device,
+                        name=f"sgd.flat{i}.sgd_v",
+                    )
+                    setattr(self, f"sgd.flat{i}.sgd_w", v_w)
+                    setattr(self, f"sgd.flat{i}.sgd_v", v_i)
+                    self.flat_buckets.append((bucket, v_w, v_i))
+                    flat_handles.update(param._ndarray__handle for _, param in bucket)
+                    self.has_sgd_w = True
+
                 self.params = {}
                 for name, param in self.model.state().items():
                     # For each tensor "param" that requires gradient (i.e., training weights),
                     # create a tensor "param.sgd_v" to be its SGD variant.
-                    if param.requires_grad:
+                    if param.requires_grad and param._ndarray__handle not in flat_handles:
                         assert isinstance(param, ndarray), "Only `raf.ndarray` can be optimized!"
 
                         # By default we directly use the model parameter as the SGD weight.
                         v_w = param
 
                         status_shape = param.shape
-                        if dcfg.zero_opt_level:
+                        _, shard = self.ad_model.zero3_shards.get(
+                            param._ndarray__handle, (None, None)
+                        )
+                        if shard is not None:
+                            # ZeRO-3: The parameter is already partitioned, so directly use its
+                            # partition as the SGD weight if possible.
+                            v_w = shard
+                            if shard.dtype != "float32":
+                                v_w = ndarray(
+                                    shard.to(dtype="float32"),
+                                    device=shard.device,
+                                    name=f"{name}.sgd_w",
+                                    dtype="float32",
+                                )
+                                self.has_sgd_w = True
+                            status_shape = shard.shape
+                        elif dcfg.zero_opt_level:
                             # If optimizer status partitioning is enable, then the first axis of
                             # variant and weight is partitioned to 1/n. Accordingly, we have to
                             # also keep a param.w (size 1/n) locally.
@@ -165,7 +239,7 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
                         # Initialize variants according to the status shape.
                         v_i = ndarray(
                             np.zeros(status_shape, dtype="float32"),
-                            device=param.device,
+                            device=v_w.device,
                             name=f"{name}.sgd_v",
                         )
                         setattr(self, f"{name}.sgd_v", v_i)
@@ -174,52 +248,160 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
                 if self.has_sgd_w:
                     # TODO(issue 758): Remove this and in-place update parameters.
                     self.zero = array(0, dtype=self.dtype)
+                if loss_scaler is not None:
+                    device = next(iter(self.params.values()))[1].device
+                    loss_scaler.init_state(self, device)
 
             @trace
             def forward(self, dy, *args, **kwargs):
-                y, dxs = self.ad_model(dy, *args, **kwargs)
-                record = self.ad_model._internal(dy, *args, **kwargs)
+                scaled_dy = dy if loss_scaler is None else loss_scaler.scale(self, dy)
+                y, dxs = self.ad_model(scaled_dy, *args, **kwargs)
+                # The gradients are in the order of the inputs of the autodiff model, which are
+                # the complete parameters even if they are partitioned by ZeRO-3.
+                record = self.ad_model.model._internal(dy, *args, **kwargs)
                 inputs = _get_func_inputs(record, [dy, *args], kwargs)
                 inputs = inputs[1:]  # remove dy
+                if self.flat_buckets:
+                    self.flat_step(inputs, dxs)
+                    return y
                 dcfg = dist.get_config()
                 comm = dist.get_communicator()
+                updated = []
                 for i, param in enumerate(inputs):
                     dxi = dxs[i] if len(inputs) > 1 else dxs
                     if param in self.params and has_grad(dxi):
                         name, weight, sgd_w, sgd_v = self.params[param]
+                        shard_name, shard = self.ad_model.zero3_shards.get(param, (None, None))
                         assert "float" in sgd_w.dtype, "Non-float parameter is not learnable"
 
-                        # Cast gradient to float32 if necessary.
-                        if self.dtype != "float32":
+                        # Cast gradient to float32 if necessary. The multi-tensor kernel
+                        # also takes float16 gradients.
+                        if self.dtype != "float32" and not (
+                            multi_tensor and self.dtype == "float16"
+                        ):
                             dxi = cast(dxi, "float32")
-
+                        updated.append((name, weight, sgd_w, sgd_v, shard_name, shard, dxi))
+
+                # Whether the multi-tensor kernel directly writes the float16 model parameters.
+                fp16_params = (
+                    multi_tensor
+                    and self.dtype == "float16"
+                    and not dcfg.zero_opt_level
+                    and all(item[5] is None for item in updated)
+                )
+                if multi_tensor and updated:
+                    # Inplace update all local SGD variants and weights (float32) at once.
+                    ntensor = len(updated)
+                    tensor_list = [item[6] for item in updated]
+                    tensor_list += [item[2] for item in updated] + [item[3] for item in updated]
+                    if fp16_params:
+                        tensor_list += [item[1] for item in updated]
+                    grad_norm = None
+                    if self.check_grad_norm:
+                        grad_norm = global_norm_and_check([item[6] for item in updated])[0]
+                    output_list = multi_tensor_sgd(
+                        tensor_list,
+                        learning_rate,
+                        momentum,
+                        fp16_params,
+                        grad_norm,
+                        max_grad_norm or 0.0,
+                        self.loss_scale if loss_scaler is not None else None,
+                    )
+                    if loss_scaler is not None:
+                        loss_scaler.update(self, grad_norm)
+                    if fp16_params:
+                        for i, item in enumerate(updated):
+                            name = item[0]
+                            param_model = get_chained_attr(self.model, name.split(".")[:-1])
+                            new_weight = output_list[3 * ntensor + i]
+                            trace_mutate_attr(param_model, name.split(".")[-1], new_weight)
+                        return y
+                    new_sgd_ws = [output_list[ntensor + i] for i in range(ntensor)]
+                else:
+                    new_sgd_ws = []
+                    for _, _, sgd_w, sgd_v, _, _, dxi in updated:
                         # Inplace update the local SGD variant and weight (float32).
                         new_sgd_v = add(multiply(self.momentum, sgd_v), dxi, out=sgd_v)
                         new_sgd_w = subtract(
                             sgd_w, multiply(self.learning_rate, new_sgd_v), out=sgd_w
                         )
+                        new_sgd_ws.append(new_sgd_w)
+
+                for item, new_sgd_w in zip(updated, new_sgd_ws):
+                    name, weight, sgd_w, _, shard_name, shard, _ = item
+                    # Cast the updated SGD weight to the model parameter dtype.
+                    if self.dtype != "float32":
+                        new_sgd_w = cast(new_sgd_w, self.dtype)
+
+                    if shard is not None:
+                        # ZeRO-3: Only update the partition of the parameter, which is
+                        # gathered when it is used in the next iteration.
+                        if shard is not sgd_w:
+                            new_sgd_w = add(new_sgd_w, self.zero, out=shard)
+                        trace_mutate_attr(self.ad_model, shard_name, new_sgd_w)
+                        continue
+
+                    # If the SGD status is partitioned, use all-gather to sync
+                    # the updated weights.
+                    if dcfg.zero_opt_level > 0:
+                        new_sgd_w = allgather(new_sgd_w, axis=0)
+                        # Slice to remove the zero-padding if needed.
+                        if sgd_w.shape[0] * comm.size > weight.shape[0]:
+                            new_sgd_w = strided_slice(new_sgd_w, [0], [weight.shape[0]], [1])
+
+                    # Update the model parameter.
+                    new_weight = (
+                        add(new_sgd_w, self.zero, out=weight) if self.has_sgd_w else new_sgd_w
+                    )
+
+                    # Put the updated weight to the model output to avoid being dead code.
+                    param_model = get_chained_attr(self.model, name.split(".")[:-1])
+                    trace_mutate_attr(param_model, name.split(".")[-1], new_weight)
+                return y
 
-                        # Cast the updated SGD weight to the model parameter dtype.
-                        if self.dtype != "float32":
-                            new_sgd_w = cast(new_sgd_w, self.dtype)
-
-                        # If the SGD status is partitioned, use all-gather to sync
-                        # the updated weights.
-                        if dcfg.zero_opt_level > 0:
-                            new_sgd_w = allgather(new_sgd_w, axis=0)
-                            # Slice to remove the zero-padding if needed.
-                            if sgd_w.shape[0] * comm.size > weight.shape[0]:
-                                new_sgd_w = strided_slice(new_sgd_w, [0], [weight.shape[0]], [1])
-
-                        # Update the model parameter.
-                        new_weight = (
-                            add(new_sgd_w, self.zero, out=weight) if self.has_sgd_w else new_sgd_w
+            def flat_step(self, inputs, dxs):
+                """Update the flat partitions, whose gradients are the partitions of the flat
+                buffers that replace the gradients of each bucket."""
+                grads = []
+                for bucket, _, _ in self.flat_buckets:
+                    i = inputs.index(bucket[0][1]._ndarray__handle)
+                    dxi = dxs[i] if len(inputs) > 1 else dxs
+                    if self.dtype != "float32" and not (multi_tensor and self.dtype == "float16"):
+                        dxi = cast(dxi, "float32")
+                    grads.append(dxi)
+
+                if multi_tensor:
+                    # Inplace update all flat SGD variants and weights at once.
+                    nbucket = len(self.flat_buckets)
+                    tensor_list = grads + [item[1] for item in self.flat_buckets]
+                    tensor_list += [item[2] for item in self.flat_buckets]
+                    output_list = multi_tensor_sgd(
+                        tensor_list, learning_rate, momentum, False, None, 0.0
+                    )
+                    new_sgd_ws = [output_list[nbucket + i] for i in range(nbucket)]
+                else:
+                    new_sgd_ws = []
+                    for (_, sgd_w, sgd_v), dxi in zip(self.flat_buckets, grads):
+                        new_sgd_v = add(multiply(self.momentum, sgd_v), dxi, out=sgd_v)
+                        new_sgd_w = subtract(
+                            sgd_w, multiply(self.learning_rate, new_sgd_v), out=sgd_w
                         )
-
-                        # Put the updated weight to the model output to avoid being dead code.
+                        new_sgd_ws.append(new_sgd_w)
+
+                for (bucket, _, _), new_sgd_w in zip(self.flat_buckets, new_sgd_ws):
+                    # Gather the updated flat buffer, and unpack the parameters from it.
+                    flat_w = allgather(new_sgd_w, axis=0)
+                    if self.dtype != "float32":
+                        flat_w = cast(flat_w, self.dtype)
+                    offset = 0
+                    for name, weight in bucket:
+                        size = int(np.prod(weight.shape))
+                        new_weight = strided_slice(flat_w, [offset], [offset + size], [1])
+                        new_weight = add(reshape(new_weight, weight.shape), self.zero, out=weight)
                         param_model = get_chained_attr(self.model, name.split(".")[:-1])
                         trace_mutate_attr(param_model, name.split(".")[-1], new_weight)
-                return y
+                        offset += size
 
         return SGDWrapper(model)
 
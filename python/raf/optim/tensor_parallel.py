@@ -0,0 +1,119 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""A tensor parallel wrapper. Assuming the input model only includes forward computations, this
+wrapper partitions the annotated weights of its dense, matmul and embedding layers across ranks
+(https://arxiv.org/abs/1909.08053), so that wide layers use the aggregate memory and compute of all
+ranks. The input data (e.g., mini-batches) are expected to be distributed to each rank like data
+parallelism, and the activations outside of the partitioned layers stay partitioned by the samples
+(https://arxiv.org/abs/2205.05198). The wrapped model is expected to be wrapped by with_autodiff,
+and the gradients of the replicated parameters are summed across ranks.
+
+Since dense and matmul take 2-D activations, the first axis is the tokens of a transformer, so the
+layer norms, dropouts and residual adds between the partitioned blocks run on the local tokens of
+each rank (sequence parallelism). The partitioned blocks are entered with an allgather and left
+with a reduce-scatter instead of an allreduce, so the activation memory of these regions is divided
+by the number of ranks at the same communication volume.
+"""
+import numpy as np
+
+from .optim import inline
+from .. import distributed as dist
+from .._core.ndarray import ndarray
+from .._ffi.pass_ import OverlapCollectiveMatmul, ShardTensorParallel
+from ..model import Model, trace
+from ..model.trace import _get_func_inputs
+
+
+def with_tensor_parallel(shard_specs, overlap_chunks=1):
+    """Enable tensor parallelism for the model. All ranks of the global communicator form one
+    tensor parallel group.
+
+    Parameters
+    ----------
+    shard_specs: Dict[str, Union[str, int]]
+        Mapping from the name of a parameter in model.state() to how it is partitioned. "column"
+        and "row" partition the weight of Linear, which is in (out_features, in_features), by the
+        output and input features, respectively, and "column" partitions the bias of a column
+        parallel Linear as well. An integer is the axis to be partitioned along, e.g., 0 for an
+        embedding table to partition it by the vocabulary. The other parameters that require
+        gradients are replicated.
+
+    overlap_chunks: int
+        The number of chunks to split the allgather before and the reduce-scatter after each
+        partitioned GEMM into along the samples, so that the collective of a chunk overlaps with
+        the GEMM of another chunk. 1 keeps the collectives as they are.
+
+    Returns
+    -------
+    ret : function
+        The wrapper which wraps a model with tensor parallelism.
+    """
+
+    def decorator(model):
+        class TensorParallelWrapper(Model):
+            """Tensor parallel model
+
+            Parameters
+            ----------
+            model: Model
+                The model with forward computations.
+            """
+
+            # pylint: disable=attribute-defined-outside-init, protected-access
+            # pylint: disable=missing-function-docstring
+            def build(self, model):
+                self.model = model
+                comm = dist.get_communicator()
+
+                # Mapping from the handle of a parameter to its partitioned axis, where -1 means
+                # the parameter is replicated.
+                self.tp_axes = {}
+                # Mapping from the handle of a parameter to its partition on this rank.
+                self.tp_shards = {}
+                for name, param in self.model.state().items():
+                    if name in shard_specs:
+                        axis = shard_specs[name]
+                        if isinstance(axis, str):
+                            assert axis in ("column", "row"), "Unknown shard spec %s" % axis
+                            axis = 0 if axis == "column" else 1
+                        assert 0 <= axis < len(param.shape), f"Cannot partition {name} by {axis}"
+                        assert param.shape[axis] % comm.size == 0, f"Cannot partition {name} evenly"
+                    elif param.requires_grad:
+                        axis = -1
+                    else:
+                        continue
+                    self.tp_axes[param._ndarray__handle] = axis
+                    if axis < 0:
+                        continue
+                    param_nd = param.to(device="cpu")
+                    shard = ndarray(
+                        np.split(param_nd.numpy(), comm.size, axis=axis)[comm.rank],
+                        device=param.device,
+                        name=f"{name}.tp_shard",
+                        dtype=param.dtype,
+                    )
+                    setattr(self, f"{name}.tp_shard", shard)
+                    self.tp_shards[param._ndarray__handle] = shard
+                    # The complete parameter is only used for tracing from now on.
+                    param.update(param_nd)
+
+            @trace
+            def forward(self, *args, **kwargs):
+                comm = dist.get_communicator()
+                record = self.model._internal(*args, **kwargs)
+                inputs = _get_func_inputs(record, args, kwargs)
+                param_indices = [i for i, x in enumerate(inputs) if x in self.tp_axes]
+                axes = [self.tp_axes[inputs[i]] for i in param_indices]
+                mod = ShardTensorParallel(comm.size, comm.rank, param_indices, axes)(record.mod)
+                if overlap_chunks > 1:
+                    mod = OverlapCollectiveMatmul(overlap_chunks)(mod)
+                for i in param_indices:
+                    if inputs[i] in self.tp_shards:
+                        # Feed the partitions of the parameters instead of the complete ones.
+                        inputs[i] = self.tp_shards[inputs[i]]._ndarray__handle
+                return inline(mod["main"], inputs)
+
+        return TensorParallelWrapper(model)
+
+    return decorator
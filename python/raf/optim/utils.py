@@ -50,3 +50,35 @@ def split_ndarray_with_padding(inp, n_part):
         pad_width[0] = (0, pad_first_dim_size - inp.shape[0])
         inp = np.pad(inp, pad_width)
     return np.split(inp, n_part)
+
+
+def make_flat_buckets(named_params, bucket_size):
+    """
+    Group the parameters into buckets for ZeRO with flat buffers. The consecutive parameters
+    with the same dtype are packed into the same bucket until it has bucket_size elements.
+    Each bucket is a list of (name, param), whose gradients are packed in this order.
+    """
+    buckets = []
+    bucket_sizes = []
+    for name, param in named_params:
+        size = int(np.prod(param.shape))
+        if (
+            not buckets
+            or buckets[-1][0][1].dtype != param.dtype
+            or bucket_sizes[-1] + size > max(bucket_size, 1)
+        ):
+            buckets.append([])
+            bucket_sizes.append(0)
+        buckets[-1].append((name, param))
+        bucket_sizes[-1] += size
+    return buckets
+
+
+def flat_shard_with_padding(arrays, n_part):
+    """
+    Flatten and concatenate the ndarrays, and split the flat buffer to N parts evenly after
+    zero-padding it as PartitionGradient does. Note that the given ndarrays have to be on CPU.
+    """
+    arrays = [arr.numpy() if isinstance(arr, ndarray) else arr for arr in arrays]
+    flat = np.concatenate([arr.reshape(-1) for arr in arrays])
+    return split_ndarray_with_padding(flat, n_part)
@@ -0,0 +1,72 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Functions for the int8 post-training quantization."""
+# pylint: disable=protected-access
+from raf._ffi.pass_ import InsertQuantObservers, Quantize, InferType
+from raf._core.executor import VMExecutor
+from raf._lib import tvm
+from raf.frontend.model import FrameworkModel
+from raf.model.trace import _get_func_inputs
+
+
+def calibrate(model, dataset, device):
+    """Calibrate the activations of the quantizable ops (conv2d, dense and matmul) of a model
+    running in single precision.
+
+    Parameters
+    ----------
+    model : raf.model.Model
+        The model running in single precision mode.
+
+    dataset : Iterable[List[raf.ndarray]]
+        The calibration batches, each of which is the input data of the model. All the batches
+        should have the same shapes.
+
+    device : str
+        The device to run the calibration on.
+
+    Returns
+    -------
+    ret : List[float]
+        The absolute maximum of the activation of each quantizable op over all the batches.
+    """
+    executor = None
+    abs_max = None
+    for args in dataset:
+        record = model._internal(*args)
+        if executor is None:
+            mod = InsertQuantObservers()(record.mod)
+            executor = VMExecutor(mod, device).make_executor()
+        inputs = _get_func_inputs(record, args, {}, get_handle=False)
+        outs = executor(*inputs)
+        observed = [float(out.numpy()) for out in outs[1:]]
+        abs_max = observed if abs_max is None else list(map(max, abs_max, observed))
+    assert abs_max is not None, "The calibration dataset is empty"
+    return abs_max
+
+
+def quantize(model, args, abs_max):
+    """Convert a model running in single precision to int8, where the quantizable ops use the
+    calibrated activation scales and the per-channel weight scales.
+
+    Parameters
+    ----------
+    model : raf.model.Model
+        The model running in single precision mode.
+
+    args : List[raf.ndarray]
+        The input data of the model.
+
+    abs_max : List[float]
+        The calibrated absolute maximum of the activations from calibrate.
+
+    Returns
+    -------
+    ret : raf.frontend.FrameworkModel
+        The quantized model.
+    """
+    mod = model._internal(*args).mod
+    mod = Quantize([tvm.tir.FloatImm("float64", val) for val in abs_max])(mod)
+    mod = InferType()(mod)
+    return FrameworkModel(mod, mod, model.state(), dict())
@@ -0,0 +1,240 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+"""End-to-end training benchmarks with the breakdown of the compilation time.
+
+Example
+-------
+python3 -m raf.testing.benchmark --model bert-base-uncased --batch-size 32 --output bert.json
+"""
+# pylint: disable=too-many-arguments, too-many-locals, protected-access
+import argparse
+import json
+import time
+
+import numpy as np
+
+import raf
+from raf._core.executor import VMExecutor
+from raf.model.trace import _get_func_inputs
+from raf.utils import profiler, memory_profiler
+from .._ffi import pass_
+from .._lib import tvm
+
+TORCHVISION_MODELS = ["resnet50"]
+TRANSFORMER_MODELS = ["bert-base-uncased", "bert-large-uncased", "gpt2"]
+
+
+def get_training_model(
+    name,
+    batch_size,
+    seq_length=128,
+    image_size=224,
+    dtype="float32",
+    device="cuda",
+    optimizer="sgd",
+):
+    """Get a standard model with the loss and optimizer appended, and the inputs of a step.
+
+    Parameters
+    ----------
+    name: str
+        The model name, one of TORCHVISION_MODELS and TRANSFORMER_MODELS.
+
+    batch_size: int
+        The batch size.
+
+    seq_length: int
+        The sequence length of the transformer models.
+
+    image_size: int
+        The image size of the vision models.
+
+    dtype: str
+        The data type of the model.
+
+    device: str
+        The device to run the model.
+
+    optimizer: str
+        The optimizer, one of "sgd", "adam" and "lans".
+
+    Returns
+    -------
+    trainer_n_args: Tuple[raf.Model, List[raf.ndarray]]
+        The training model and its inputs, i.e., dy, the model input and the ground truth.
+    """
+    from .pt_models import get_torchvision_model, get_transformer_model, append_loss_n_optimizer
+
+    if name in TORCHVISION_MODELS:
+        model, out_shape = get_torchvision_model(name, batch_size, (image_size, image_size), dtype)
+        x = np.random.randn(batch_size, 3, image_size, image_size).astype(dtype)
+        num_classes = out_shape[-1]
+        num_labels = batch_size
+    elif name in TRANSFORMER_MODELS:
+        model, out_shape = get_transformer_model(name, batch_size, seq_length, dtype)
+        x = np.random.randint(0, 10000, (batch_size, seq_length)).astype("int64")
+        num_classes = out_shape[-1]
+        num_labels = batch_size * seq_length
+    else:
+        raise ValueError("Unsupported model: %s" % name)
+    model.to(device=device)
+    x = raf.array(x, device=device)
+    y_true = raf.array(np.random.randint(0, num_classes, (num_labels,)), device=device)
+    dy = raf.array(np.ones((), dtype=dtype), device=device)
+    trainer = append_loss_n_optimizer(model, [x], out_shape, y_true, optimizer)
+    return trainer, [dy, x, y_true]
+
+
+def benchmark_training(
+    trainer, args, batch_size, device="cuda", warmup=5, number=20, config=None, disabled_pass=None
+):
+    """Benchmark the training steps of a model from tracing to the steady state.
+
+    Parameters
+    ----------
+    trainer: raf.Model
+        The model of a training step, e.g., one with the optimizer.
+
+    args: List[raf.ndarray]
+        The inputs of the training step.
+
+    batch_size: int
+        The number of samples of a step.
+
+    device: str
+        The device to run the model.
+
+    warmup: int
+        The number of steps run after the first step before timing the steady state.
+
+    number: int
+        The number of timed steps.
+
+    config: Optional[Dict[str, Any]]
+        The pass context config used to compile the model.
+
+    disabled_pass: Optional[List[str]]
+        The passes disabled when compiling the model.
+
+    Returns
+    -------
+    ret: Dict[str, Any]
+        All times are in milliseconds and memory sizes are in MBs.
+        - 'trace': The time to trace the model into IR, including AutoDiff.
+        - 'compile': The time of VMExecutor, i.e., the passes and the bytecode generation.
+        - 'compile_breakdown': The time of 'OptimizeModule' and 'CodeGen' of the VM compiler.
+        - 'passes': The total time of each pass run by RAFSequential. Passes nested in another
+          sequence are also counted in the time of the outer pass.
+        - 'first_step': The latency of the first step, which JITs all kernels.
+        - 'jit': The total time to build the kernels of each op or fused dialect function,
+          including tuning.
+        - 'step': The average latency of a step in the steady state.
+        - 'samples_per_sec': The throughput in the steady state.
+        - 'peak_memory': The max used and allocated memory of a step.
+    """
+    tvm_device = tvm.nd.device(device)
+    ret = {"batch_size": batch_size, "device": device}
+    profiler.clear()
+    profiler.start()
+
+    start = time.perf_counter()
+    record = trainer._internal(*args)
+    ret["trace"] = (time.perf_counter() - start) * 1000
+
+    start = time.perf_counter()
+    with raf.ir.PassContext(config=config or {}, disabled_pass=disabled_pass or []):
+        mod = pass_.InferType()(record.mod)
+        executor = VMExecutor(mod, device)
+    ret["compile"] = (time.perf_counter() - start) * 1000
+
+    vm = executor.make_executor()
+    inputs = _get_func_inputs(record, args, {}, get_handle=False)
+    start = time.perf_counter()
+    vm(*inputs)
+    tvm_device.sync()
+    ret["first_step"] = (time.perf_counter() - start) * 1000
+
+    profiler.stop()
+    data = profiler.get()
+    profiler.clear()
+    ret["compile_breakdown"] = profiler.get_category_durations(data, "Compile")
+    ret["passes"] = profiler.get_category_durations(data, "Pass")
+    ret["jit"] = profiler.get_category_durations(data, "JIT")
+
+    for _ in range(warmup):
+        vm(*inputs)
+    tvm_device.sync()
+
+    memory_profiler.reset()
+    memory_profiler.start()
+    vm(*inputs)
+    tvm_device.sync()
+    memory_profiler.stop()
+    mem = memory_profiler.get_max_memory_info(raf.Device(device))
+    ret["peak_memory"] = {
+        "max_used": mem["max_used"].value,
+        "max_allocated": mem["max_allocated"].value,
+    }
+    memory_profiler.reset()
+
+    start = time.perf_counter()
+    for _ in range(number):
+        vm(*inputs)
+    tvm_device.sync()
+    elapsed = time.perf_counter() - start
+    ret["step"] = elapsed * 1000 / number
+    ret["samples_per_sec"] = batch_size * number / elapsed
+    return ret
+
+
+def main():
+    """The benchmark driver."""
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--model", nargs="+", default=TORCHVISION_MODELS + TRANSFORMER_MODELS)
+    parser.add_argument("--batch-size", type=int, default=8)
+    parser.add_argument("--seq-length", type=int, default=128)
+    parser.add_argument("--image-size", type=int, default=224)
+    parser.add_argument("--dtype", default="float32")
+    parser.add_argument("--device", default="cuda")
+    parser.add_argument("--optimizer", default="sgd", choices=["sgd", "adam", "lans"])
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--number", type=int, default=20)
+    parser.add_argument("--output", default=None, help="The JSON file to write the results.")
+    opts = parser.parse_args()
+
+    results = {}
+    for name in opts.model:
+        trainer, args = get_training_model(
+            name,
+            opts.batch_size,
+            opts.seq_length,
+            opts.image_size,
+            opts.dtype,
+            opts.device,
+            opts.optimizer,
+        )
+        ret = benchmark_training(
+            trainer, args, opts.batch_size, opts.device, opts.warmup, opts.number
+        )
+        ret.update({"dtype": opts.dtype, "optimizer": opts.optimizer})
+        results[name] = ret
+        print(
+            "%s: trace %.1f ms, compile %.1f ms, first step %.1f ms (JIT %.1f ms), "
+            "%.2f samples/sec, peak memory %.1f MB"
+            % (
+                name,
+                ret["trace"],
+                ret["compile"],
+                ret["first_step"],
+                sum(ret["jit"].values()),
+                ret["samples_per_sec"],
+                ret["peak_memory"]["max_used"],
+            )
+        )
+    if opts.output:
+        with open(opts.output, "w") as out_file:
+            json.dump(results, out_file, indent=4)
+
+
+if __name__ == "__main__":
+    main()
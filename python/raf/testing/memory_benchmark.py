@@ -0,0 +1,278 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+"""Memory footprint benchmarks of the training steps compiled by the standard pipeline, which
+catch the memory regressions of the passes, e.g., MemoryPlan, liveness analysis and the schedulers.
+
+Example
+-------
+python3 -m raf.testing.memory_benchmark --baseline memory.json --update-baseline
+python3 -m raf.testing.memory_benchmark --baseline memory.json
+"""
+# pylint: disable=too-many-arguments, too-many-locals, protected-access
+import argparse
+import json
+import sys
+
+import numpy as np
+
+import raf
+from raf._core.device import Device
+from raf._core.executor import VMExecutor
+from raf._core.vm import VMCompiler
+from raf.model.trace import _get_func_inputs
+from raf.utils import memory_profiler
+from .._ffi import pass_
+from .._ffi.ir.constant import ExtractValue
+from .._lib import tvm
+from .benchmark import TORCHVISION_MODELS, TRANSFORMER_MODELS, get_training_model
+
+# The fixed set of models whose memory footprints are tracked by default.
+MEMORY_MODELS = ["mlp", "resnet50", "bert-base-uncased"]
+
+# The metrics that regress when they grow, as paths in the result of a model.
+MEMORY_METRICS = [
+    ("estimated_peak",),
+    ("num_storages",),
+    ("storage_size",),
+    ("measured_peak", "max_used"),
+    ("measured_peak", "max_allocated"),
+    ("remat", "estimated_peak"),
+    ("remat", "recomputed_ops"),
+]
+
+_MB = 1048576.0
+
+
+def get_memory_model(name, batch_size, device="cuda"):
+    """Get a model of MEMORY_MODELS, TORCHVISION_MODELS or TRANSFORMER_MODELS with the loss and
+    the SGD optimizer appended, and the inputs of a step.
+
+    Parameters
+    ----------
+    name: str
+        The model name.
+
+    batch_size: int
+        The batch size.
+
+    device: str
+        The device to run the model.
+
+    Returns
+    -------
+    trainer_n_args: Tuple[raf.Model, List[raf.ndarray]]
+        The training model and its inputs, i.e., dy, the model input and the ground truth.
+    """
+    if name != "mlp":
+        return get_training_model(name, batch_size, device=device)
+    from . import mlp  # pylint: disable=import-outside-toplevel
+
+    config = (784, 10, 256, 256)
+    model, _ = mlp.get_model(config)
+    model.to(device=device)
+    trainer = raf.optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(model)
+    m_x, m_y = mlp.get_input(config, batch_size, device)[0]
+    dy = raf.array(np.ones((), dtype="float32"), device=device)
+    return trainer, [dy, m_x, m_y]
+
+
+def _optimize(mod, device, config, disabled_pass):
+    with raf.ir.PassContext(config=config, disabled_pass=disabled_pass):
+        mod, _ = VMCompiler().optimize(mod, device)
+    return pass_.InferType()(mod)
+
+
+def _estimate_peak(mod, device):
+    return max(mem.value for _, mem in pass_.EstimateMemory(mod, Device(device), True))
+
+
+def _collect_calls(mod, op_name):
+    """Collect the calls to the given op in all functions of the module."""
+    op = tvm.ir.Op.get(op_name)
+    calls = []
+
+    def fvisit(expr):
+        if isinstance(expr, tvm.relay.Call) and expr.op == op:
+            calls.append(expr)
+
+    for func in mod.functions.values():
+        if isinstance(func, tvm.relay.Function):
+            tvm.relay.analysis.post_order_visit(func, fvisit)
+    return calls
+
+
+def measure_memory(trainer, args, device="cuda", memory_budget=0, config=None, disabled_pass=None):
+    """Measure the memory footprint of a training step.
+
+    Parameters
+    ----------
+    trainer: raf.Model
+        The model of a training step, e.g., one with the optimizer.
+
+    args: List[raf.ndarray]
+        The inputs of the training step.
+
+    device: str
+        The device to run the model.
+
+    memory_budget: int
+        The memory budget in bytes for rematerialization. 0 means the overhead of
+        rematerialization is not measured.
+
+    config: Optional[Dict[str, Any]]
+        The pass context config used to compile the model.
+
+    disabled_pass: Optional[List[str]]
+        The passes disabled when compiling the model.
+
+    Returns
+    -------
+    ret: Dict[str, Any]
+        All memory sizes are in MBs.
+        - 'estimated_peak': The peak memory estimated by EstimateMemory, including the params.
+        - 'num_storages': The number of storages allocated by a step after MemoryPlan.
+        - 'storage_size': The total size of the storages allocated by a step after MemoryPlan.
+        - 'measured_peak': The max used and allocated memory of a step run by the VM.
+        - 'remat': With a memory budget, the estimated peak memory and the number of the ops
+          recomputed by Rematerialization, i.e., the increase of the ops invoked by a step.
+    """
+    config = config or {}
+    disabled_pass = disabled_pass or []
+    ret = {"device": device}
+    record = trainer._internal(*args)
+    mod = pass_.InferType()(record.mod)
+
+    opt_mod = _optimize(mod, device, config, disabled_pass)
+    ret["estimated_peak"] = _estimate_peak(opt_mod, device)
+    storages = _collect_calls(opt_mod, "raf.op.vm.alloc_storage")
+    ret["num_storages"] = len(storages)
+    ret["storage_size"] = sum(ExtractValue(call.args[0]).value for call in storages) / _MB
+    if memory_budget > 0:
+        remat_config = dict(config)
+        remat_config["raf.memory_budget"] = memory_budget
+        remat_mod = _optimize(mod, device, remat_config, disabled_pass)
+        num_ops = len(_collect_calls(opt_mod, "raf.op.vm.invoke_op"))
+        ret["remat"] = {
+            "memory_budget": memory_budget / _MB,
+            "estimated_peak": _estimate_peak(remat_mod, device),
+            "recomputed_ops": len(_collect_calls(remat_mod, "raf.op.vm.invoke_op")) - num_ops,
+        }
+
+    with raf.ir.PassContext(config=config, disabled_pass=disabled_pass):
+        executor = VMExecutor(mod, device)
+    vm = executor.make_executor()
+    inputs = _get_func_inputs(record, args, {}, get_handle=False)
+    tvm_device = tvm.nd.device(device)
+    # The first step JITs the kernels, whose workspaces are not part of the steady state.
+    vm(*inputs)
+    tvm_device.sync()
+    memory_profiler.reset()
+    memory_profiler.start()
+    vm(*inputs)
+    tvm_device.sync()
+    memory_profiler.stop()
+    mem = memory_profiler.get_max_memory_info(raf.Device(device))
+    ret["measured_peak"] = {
+        "max_used": mem["max_used"].value,
+        "max_allocated": mem["max_allocated"].value,
+    }
+    memory_profiler.reset()
+    return ret
+
+
+def compare_with_baseline(results, baseline, rtol=0.02):
+    """Compare the memory footprints with the baseline.
+
+    Parameters
+    ----------
+    results: Dict[str, Dict[str, Any]]
+        The results of measure_memory of each model.
+
+    baseline: Dict[str, Dict[str, Any]]
+        The baseline results of each model.
+
+    rtol: float
+        The relative tolerance of the growth of a metric.
+
+    Returns
+    -------
+    regressions: List[str]
+        The descriptions of the metrics exceeding their baselines by more than rtol. The models
+        and metrics missing in the baseline are skipped.
+    """
+    regressions = []
+    for name, ret in results.items():
+        if name not in baseline:
+            continue
+        for path in MEMORY_METRICS:
+            new, old = ret, baseline[name]
+            for key in path:
+                new = new.get(key) if isinstance(new, dict) else None
+                old = old.get(key) if isinstance(old, dict) else None
+            if new is None or old is None:
+                continue
+            if new > old * (1 + rtol) + 1e-6:
+                regressions.append("%s %s: %.4g -> %.4g" % (name, ".".join(path), old, new))
+    return regressions
+
+
+def main():
+    """The benchmark driver, which exits with 1 on regressions."""
+    parser = argparse.ArgumentParser(description=__doc__.split("\n", maxsplit=1)[0])
+    parser.add_argument(
+        "--model",
+        nargs="+",
+        default=MEMORY_MODELS,
+        choices=sorted(set(MEMORY_MODELS + TORCHVISION_MODELS + TRANSFORMER_MODELS)),
+    )
+    parser.add_argument("--batch-size", type=int, default=8)
+    parser.add_argument("--device", default="cuda")
+    parser.add_argument(
+        "--memory-budget", type=float, default=0, help="The rematerialization budget in MBs."
+    )
+    parser.add_argument("--baseline", default=None, help="The JSON file of the baselines.")
+    parser.add_argument(
+        "--update-baseline", action="store_true", help="Write the results to the baseline file."
+    )
+    parser.add_argument("--rtol", type=float, default=0.02)
+    opts = parser.parse_args()
+
+    results = {}
+    for name in opts.model:
+        trainer, args = get_memory_model(name, opts.batch_size, opts.device)
+        ret = measure_memory(trainer, args, opts.device, int(opts.memory_budget * _MB))
+        ret["batch_size"] = opts.batch_size
+        results[name] = ret
+        print(
+            "%s: estimated peak %.1f MB, %d storages of %.1f MB, measured peak %.1f MB"
+            % (
+                name,
+                ret["estimated_peak"],
+                ret["num_storages"],
+                ret["storage_size"],
+                ret["measured_peak"]["max_used"],
+            )
+        )
+        if "remat" in ret:
+            print(
+                "%s: estimated peak %.1f MB with rematerialization, %d ops recomputed"
+                % (name, ret["remat"]["estimated_peak"], ret["remat"]["recomputed_ops"])
+            )
+
+    if opts.baseline is None:
+        return
+    if opts.update_baseline:
+        with open(opts.baseline, "w") as out_file:
+            json.dump(results, out_file, indent=4)
+        return
+    with open(opts.baseline, "r") as in_file:
+        baseline = json.load(in_file)
+    regressions = compare_with_baseline(results, baseline, opts.rtol)
+    for regression in regressions:
+        print("Regression: %s" % regression)
+    if regressions:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
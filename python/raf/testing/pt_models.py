@@ -230,4 +230,6 @@ def append_loss_n_optimizer(model, args, out_shape, y_true, optimizer="sgd"):
         return optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(model_w_loss)
     if optimizer == "lans":
         return optim.lans.with_lans()(model_w_loss)
+    if optimizer == "adam":
+        return optim.adam.with_adam()(model_w_loss)
     raise ValueError("Unrecognized optimizer: %s" % optimizer)
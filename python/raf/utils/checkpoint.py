@@ -0,0 +1,189 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Sharded checkpoints of the parameters and the optimizer states. Each rank saves and loads its
+own shard, e.g., its ZeRO partition, as a data file with the aligned raw bytes of the tensors and
+an index file, so that saving does not stall the training and loading does not read the whole
+shard into the memory.
+
+Example
+-------
+.. code-block:: python
+
+    handle = checkpoint.save("ckpt", model.state(), rank=dist.get_communicator().rank)
+    ...  # Continue training while the files are written.
+    handle.wait()
+
+    state = checkpoint.load("ckpt", device="cuda", rank=dist.get_communicator().rank)
+    for name, param in model.state().items():
+        param.update(state[name])
+
+    # Or save every 100 steps in the background between the steps.
+    manager = checkpoint.CheckpointManager("ckpt", every=100, keep=2, device_copy=True)
+    for step in range(num_steps):
+        ...  # Run the training step.
+        manager.step(step, model.state)
+    manager.wait()
+"""
+import os
+
+from raf._ffi.checkpoint import Save, Load
+from raf._core.device import Device
+from raf._core.ndarray import ndarray
+from raf._core.value import TensorValue
+
+
+class SaveHandle:
+    """The handle of an asynchronous save."""
+
+    def __init__(self, module):
+        self._wait = module["wait"]
+        self._done = module["done"]
+
+    def done(self):
+        """Check whether the files have been written without blocking.
+
+        Returns
+        -------
+        ret : bool
+            Whether the files have been written.
+        """
+        return bool(self._done())
+
+    def wait(self):
+        """Wait for the files to be written, and raise the error while writing them."""
+        self._wait()
+
+
+def save(path, tensors, rank=0, num_threads=4, device_copy=False):
+    """Save the tensors of a rank to a checkpoint. The tensors are snapshotted before returning,
+    so they can be updated right away, and the files are written in the background.
+
+    Parameters
+    ----------
+    path : str
+        The directory of the checkpoint.
+
+    tensors : Dict[str, Union[raf.ndarray, TensorValue]]
+        The tensors of the rank, e.g., the parameters and the optimizer states.
+
+    rank : int
+        The rank whose shard is saved.
+
+    num_threads : int
+        The number of threads to write the data file.
+
+    device_copy : bool
+        Whether to snapshot the tensors to device copies first, so that the next update of the
+        tensors only waits for the copies on the device instead of the transfers to the host.
+        The device copies take as much device memory as the tensors until the handle is waited.
+
+    Returns
+    -------
+    ret : SaveHandle
+        The handle to wait for the files to be written.
+    """
+    values = {}
+    for name, tensor in tensors.items():
+        if isinstance(tensor, ndarray):
+            tensor = tensor._ndarray__value  # pylint: disable=protected-access
+        assert isinstance(tensor, TensorValue), "Cannot checkpoint %s of %s" % (name, type(tensor))
+        values[name] = tensor
+    return SaveHandle(Save(path, rank, values, num_threads, device_copy))
+
+
+def load(path, device="cpu", rank=0):
+    """Load the tensors of a rank from a checkpoint. The data file is mapped: the tensors loaded
+    to the CPU refer to the mapping, and the others are streamed to the device.
+
+    Parameters
+    ----------
+    path : str
+        The directory of the checkpoint.
+
+    device : str
+        The device of the loaded tensors.
+
+    rank : int
+        The rank whose shard is loaded.
+
+    Returns
+    -------
+    ret : Dict[str, raf.ndarray]
+        The loaded tensors keyed by their names.
+    """
+    tensors = Load(path, rank, Device(device))
+    return {name: ndarray.from_tensor_value(value) for name, value in tensors.items()}
+
+
+class CheckpointManager:
+    """Save checkpoints periodically between the training steps, overlapping the writes with the
+    following steps. At most one checkpoint is in flight: a new one waits for the previous one.
+
+    Parameters
+    ----------
+    path : str
+        The directory to keep the checkpoints, each in a sub-directory named after its step.
+
+    every : int
+        The number of steps between the checkpoints.
+
+    rank : int
+        The rank whose shard is saved.
+
+    keep : Optional[int]
+        The number of the latest checkpoints to keep, or None to keep all of them.
+
+    **kwargs
+        The other options of save, e.g., num_threads and device_copy.
+    """
+
+    def __init__(self, path, every, rank=0, keep=None, **kwargs):
+        self.path = path
+        self.every = every
+        self.rank = rank
+        self.keep = keep
+        self.options = kwargs
+        self.saved = []
+        self._pending = None
+
+    def step(self, step, tensors):
+        """Save a checkpoint if the step is due. It should be called between the steps, after the
+        updates of the step are issued.
+
+        Parameters
+        ----------
+        step : int
+            The index of the finished step.
+
+        tensors : Union[Dict[str, raf.ndarray], Callable[[], Dict[str, raf.ndarray]]]
+            The tensors to save, or the function to get them that is only called when due.
+
+        Returns
+        -------
+        ret : Optional[str]
+            The directory of the checkpoint being saved, or None if the step is not due.
+        """
+        if (step + 1) % self.every != 0:
+            return None
+        self.wait()
+        if callable(tensors):
+            tensors = tensors()
+        path = os.path.join(self.path, "step-%d" % step)
+        self._pending = (path, save(path, tensors, rank=self.rank, **self.options))
+        return path
+
+    def wait(self):
+        """Wait for the checkpoint in flight, and remove the stale ones."""
+        if self._pending is None:
+            return
+        path, handle = self._pending
+        self._pending = None
+        handle.wait()
+        self.saved.append(path)
+        if self.keep is not None:
+            while len(self.saved) > self.keep:
+                stale = self.saved.pop(0)
+                for name in ("rank%d.data" % self.rank, "rank%d.index" % self.rank):
+                    if os.path.exists(os.path.join(stale, name)):
+                        os.remove(os.path.join(stale, name))
@@ -0,0 +1,169 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""The analytical cost model of op latency, which is used by the passes relying on the op latency
+(e.g., rematerialization and IOS stream scheduling) instead of profiling the ops on the device
+when the pass config "raf.op_profiler.cost_model" is "analytical".
+
+Example
+-------
+.. code-block:: python
+
+    # On a host with the target GPU, calibrate once and save the spec.
+    spec = cost_model.calibrate("cuda")
+    cost_model.save_device_spec("specs.json", cost_model.get_device_name("cuda"), spec)
+
+    # On the build host, load the spec and compile with the analytical cost model.
+    cost_model.load_device_spec("specs.json", "Tesla V100-SXM2-16GB", "cuda")
+    with raf.ir.PassContext(config={"raf.op_profiler.cost_model": "analytical"}):
+        ...
+"""
+import json
+import os
+
+from raf._ffi.op_profiler import SetDeviceSpec, GetDeviceSpec, Profile, ResetCache
+from raf._core.device import Device
+from .._lib import tvm
+
+
+def set_device_spec(device, peak_gflops, peak_gbps, launch_us):
+    """Set the device spec of the analytical cost model.
+
+    Parameters
+    ----------
+    device : str
+        The target device.
+
+    peak_gflops : float
+        The achievable compute throughput in GFLOPS.
+
+    peak_gbps : float
+        The achievable memory bandwidth in GB/s.
+
+    launch_us : float
+        The fixed overhead of each kernel in microseconds.
+    """
+    SetDeviceSpec(Device(device), peak_gflops, peak_gbps, launch_us)
+
+
+def get_device_spec(device):
+    """Get the device spec of the analytical cost model.
+
+    Parameters
+    ----------
+    device : str
+        The target device.
+
+    Returns
+    -------
+    ret : Dict[str, float]
+        The spec with 'peak_gflops', 'peak_gbps' and 'launch_us'.
+    """
+    return {k: v.value for k, v in GetDeviceSpec(Device(device)).items()}
+
+
+def get_device_name(device):
+    """Get the model name of the device, e.g., the GPU SKU, to key the calibrated specs."""
+    dev = tvm.nd.device(device)
+    name = dev.device_name if dev.device_type != tvm.runtime.Device.kDLCPU else None
+    return name or "cpu"
+
+
+def calibrate(device, dtype="float32", matmul_size=4096, num_elements=1 << 24):
+    """Calibrate the device spec by profiling a large matmul, a large elementwise op, and a tiny
+    op on the device. The calibrated spec is also set to the cost model.
+
+    Parameters
+    ----------
+    device : str
+        The target device.
+
+    dtype : str
+        The data type of the calibration ops, which should be the one used by the models.
+
+    matmul_size : int
+        The size of the square matrices of the matmul that measures the compute throughput.
+
+    num_elements : int
+        The number of elements of the elementwise op that measures the memory bandwidth.
+
+    Returns
+    -------
+    ret : Dict[str, float]
+        The calibrated spec with 'peak_gflops', 'peak_gbps' and 'launch_us'.
+    """
+    # pylint: disable=import-outside-toplevel
+    import raf
+    from raf.testing import run_infer_type
+
+    def latency(expr):
+        expr = run_infer_type(expr).body
+        lats = Profile(expr, Device(device), 10, 10, 3)["latency"]
+        return min(lat.value for lat in lats)
+
+    ResetCache(Device(device))
+    launch_us = latency(raf.ir.op.relu(raf.ir.var("x", shape=(1,), dtype=dtype)))
+
+    x = raf.ir.var("x", shape=(matmul_size, matmul_size), dtype=dtype)
+    matmul_us = max(latency(raf.ir.op.matmul(x, x)) - launch_us, 1e-3)
+    peak_gflops = 2 * matmul_size ** 3 / 1e9 / (matmul_us * 1e-6)
+
+    x = raf.ir.var("x", shape=(num_elements,), dtype=dtype)
+    add_us = max(latency(raf.ir.op.add(x, x)) - launch_us, 1e-3)
+    nbytes = 3 * num_elements * tvm.runtime.DataType(dtype).bits // 8
+    peak_gbps = nbytes / 1e9 / (add_us * 1e-6)
+    ResetCache(Device(device))
+
+    set_device_spec(device, peak_gflops, peak_gbps, launch_us)
+    return {"peak_gflops": peak_gflops, "peak_gbps": peak_gbps, "launch_us": launch_us}
+
+
+def save_device_spec(path, name, spec):
+    """Save a calibrated spec to a JSON file keyed by the device name, keeping the other specs.
+
+    Parameters
+    ----------
+    path : str
+        The JSON file.
+
+    name : str
+        The device name, e.g., the one returned by get_device_name.
+
+    spec : Dict[str, float]
+        The spec returned by calibrate.
+    """
+    specs = {}
+    if os.path.exists(path):
+        with open(path, "r") as spec_file:
+            specs = json.load(spec_file)
+    specs[name] = spec
+    with open(path, "w") as spec_file:
+        json.dump(specs, spec_file, indent=4)
+
+
+def load_device_spec(path, name, device):
+    """Load a calibrated spec from a JSON file and set it to the cost model.
+
+    Parameters
+    ----------
+    path : str
+        The JSON file.
+
+    name : str
+        The device name.
+
+    device : str
+        The target device to set the spec.
+
+    Returns
+    -------
+    ret : Dict[str, float]
+        The loaded spec.
+    """
+    with open(path, "r") as spec_file:
+        specs = json.load(spec_file)
+    if name not in specs:
+        raise ValueError("Cannot find the spec of %s in %s" % (name, path))
+    spec = specs[name]
+    set_device_spec(device, spec["peak_gflops"], spec["peak_gbps"], spec["launch_us"])
+    return spec
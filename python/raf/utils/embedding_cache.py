@@ -0,0 +1,79 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+# pylint: disable=protected-access
+"""Embedding tables on the host with a row cache on the device, for the recommendation models
+whose tables do not fit in the device memory. The table is kept in pinned host memory mapped to
+the device, and the frequent rows are kept by a set-associative cache on the device.
+
+A step looks up the rows with raf.embedding_cache, which serves the cached rows from the device
+memory, reads the missed ones from the host and fills them into the cache, evicting the least
+recently used row of each set. The gradient is applied by raf.embedding_cache_sgd, which updates
+the cached rows in the cache and writes the dirty ones back to the table once they are evicted or
+flushed. The table, the tags and the cached rows are passed to every execution and updated in
+place, so the cache persists across the executions of the VM.
+
+Example
+-------
+.. code-block:: python
+
+    cache = embedding_cache.EmbeddingCache(table, num_sets=4096, num_ways=8, device="cuda")
+    for indices, labels in loader:
+        loss = vm.run(indices, labels, *cache.states())
+    table = cache.read_table()
+"""
+from raf._ffi.embedding_cache import EmbeddingCache as _EmbeddingCache
+from raf._core.device import Device
+from raf._core.ndarray import ndarray
+
+
+class EmbeddingCache:
+    """An embedding table on the host and its row cache on the device.
+
+    Parameters
+    ----------
+    table : raf.ndarray
+        The initial table in shape [num_rows, hidden...], which is copied to pinned host memory.
+
+    num_sets : int
+        The number of sets of the cache. Row r can only be cached in set r % num_sets.
+
+    num_ways : int
+        The number of rows of each set, which is at most 32.
+
+    device : str
+        The device of the cache, to which the table is mapped.
+    """
+
+    def __init__(self, table, num_sets, num_ways, device="cuda"):
+        if not isinstance(table, ndarray):
+            table = ndarray(table)
+        module = _EmbeddingCache(Device(device), table._ndarray__value, num_sets, num_ways)
+        self._flush = module["flush"]
+        self._read_table = module["read_table"]
+        self._num_cached_rows = module["num_cached_rows"]
+        self.table, self.tags, self.rows = [
+            ndarray.from_tensor_value(value) for value in module["states"]()
+        ]
+
+    def states(self):
+        """The table, the tags and the cached rows, as the inputs of a step."""
+        return [self.table, self.tags, self.rows]
+
+    def flush(self):
+        """Write the dirty rows of the cache back to the table on the host."""
+        self._flush()
+
+    def read_table(self):
+        """Read the table after flushing the cache.
+
+        Returns
+        -------
+        ret : raf.ndarray
+            A copy of the table on the CPU.
+        """
+        return ndarray.from_tensor_value(self._read_table())
+
+    @property
+    def num_cached_rows(self):
+        """The number of rows kept by the cache."""
+        return self._num_cached_rows()
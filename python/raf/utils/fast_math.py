@@ -0,0 +1,91 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+The accuracy check of the fast math approximations of the TVM ops. The approximations are enabled
+per base op by the "raf.tvm.fast_math" config of the PassContext, for example:
+
+.. code-block:: python
+
+    with tvm.transform.PassContext(config={"raf.tvm.fast_math": ["raf.op.gelu"]}):
+        out = model.run_vm(*args, device="cuda")
+"""
+import numpy as np
+
+import tvm
+
+from raf._core.ndarray import array
+from raf._ffi.executor import ClearInterpreterOpEnvCache
+from raf._op import imp
+from raf._op.dialect import DialectPreference
+
+# The base ops with the fast math approximations.
+FAST_MATH_OPS = [
+    "raf.op.exp",
+    "raf.op.erf",
+    "raf.op.tanh",
+    "raf.op.sigmoid",
+    "raf.op.gelu",
+    "raf.op.gelu_dx",
+    "raf.op.erf_dx",
+]
+
+
+def _run_op(op_name, n_x, n_dy, device, fast):
+    name = op_name[len("raf.op.") :]
+    config = {"raf.tvm.fast_math": [op_name]} if fast else {}
+    # The op envs cached by the interpreter do not depend on the config.
+    ClearInterpreterOpEnvCache()
+    with tvm.transform.PassContext(config=config), DialectPreference(["tvm"]):
+        m_x = array(n_x, device=device)
+        if name.endswith("_dx"):
+            m_y = getattr(imp, name[: -len("_dx")])(m_x)
+            m_out = getattr(imp, name)(m_x, m_y, array(n_dy, device=device))
+        else:
+            m_out = getattr(imp, name)(m_x)
+    return m_out.numpy().astype("float64")
+
+
+def check_accuracy(ops=None, shape=(1 << 16,), dtype="float32", device="cpu", low=-8.0, high=8.0):
+    """Compare the fast math approximations of the ops with the precise ones on the uniformly
+    random inputs in [low, high), so that the errors can be checked before opting in to them.
+
+    Parameters
+    ----------
+    ops: Optional[List[str]]
+        The base ops to check, which are all the ops in FAST_MATH_OPS by default.
+
+    shape: Tuple[int]
+        The shape of the inputs.
+
+    dtype: str
+        The dtype of the inputs.
+
+    device: str
+        The device to run the ops on.
+
+    low: float
+        The lower bound of the inputs.
+
+    high: float
+        The upper bound of the inputs.
+
+    Returns
+    -------
+    ret: Dict[str, Tuple[float, float]]
+        The max absolute and relative errors of each op, where the relative error of an element
+        whose precise result is close to zero is relative to 1e-3 instead.
+    """
+    ops = FAST_MATH_OPS if ops is None else ops
+    n_x = np.random.uniform(low, high, size=shape).astype(dtype)
+    n_dy = np.random.uniform(-1.0, 1.0, size=shape).astype(dtype)
+    ret = {}
+    for op_name in ops:
+        if op_name not in FAST_MATH_OPS:
+            raise ValueError("%s has no fast math approximation" % op_name)
+        precise = _run_op(op_name, n_x, n_dy, device, fast=False)
+        fast = _run_op(op_name, n_x, n_dy, device, fast=True)
+        abs_err = np.abs(fast - precise)
+        rel_err = abs_err / np.maximum(np.abs(precise), 1e-3)
+        ret[op_name] = (float(np.max(abs_err)), float(np.max(rel_err)))
+    return ret
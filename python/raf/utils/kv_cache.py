@@ -0,0 +1,131 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Paged key/value caches for autoregressive decoding. The keys and values of each layer are kept
+in a cache tensor in shape [num_blocks, block_size, num_heads, head_dim] allocated once, whose
+blocks are handed out to the sequences on demand, so that each decoding step only computes the
+attention of the new tokens over the cached ones instead of recomputing the whole prefix.
+
+A decoding step writes the keys and values of the new tokens to their slots with
+raf.kv_cache_append, which updates the caches in place, and reads the cached ones of the batch
+with raf.kv_cache_gather by the block tables, masking out the positions past the lengths of the
+sequences. The caches are passed to every execution of the step, so the cached tokens persist
+across the executions of the VM.
+
+Example
+-------
+.. code-block:: python
+
+    cache = kv_cache.KVCache(num_layers, num_blocks=256, block_size=16, token_shape=(12, 64))
+    slots = cache.append(seq_id, len(prompt))
+    ...  # Run the prefill step with the slots.
+    while not done:
+        slots = cache.append(seq_id, 1)
+        tables, lens = cache.block_tables([seq_id]), cache.seq_lens([seq_id])
+        logits = vm.run(token, *cache.flat_caches(), slots, tables, lens)
+    cache.free(seq_id)
+"""
+from raf._ffi.kv_cache import KVCache as _KVCache
+from raf._core.device import Device
+from raf._core.ndarray import ndarray
+
+
+class KVCache:
+    """The paged key/value caches of all layers.
+
+    Parameters
+    ----------
+    num_layers : int
+        The number of layers, each of which has a key cache and a value cache.
+
+    num_blocks : int
+        The number of blocks of each cache, shared by all sequences.
+
+    block_size : int
+        The number of tokens of each block.
+
+    token_shape : Tuple[int]
+        The shape of the key or value of a token, e.g., (num_heads, head_dim).
+
+    dtype : str
+        The dtype of the keys and values.
+
+    device : str
+        The device of the caches.
+    """
+
+    def __init__(
+        self, num_layers, num_blocks, block_size, token_shape, dtype="float32", device="cpu"
+    ):  # pylint: disable=too-many-arguments
+        self.block_size = block_size
+        module = _KVCache(
+            Device(device), dtype, num_layers, num_blocks, block_size, list(token_shape)
+        )
+        self._append = module["append"]
+        self._block_tables = module["block_tables"]
+        self._seq_lens = module["seq_lens"]
+        self._free = module["free"]
+        self._num_free_blocks = module["num_free_blocks"]
+        caches = [ndarray.from_tensor_value(value) for value in module["caches"]()]
+        self.caches = [(caches[2 * i], caches[2 * i + 1]) for i in range(num_layers)]
+
+    def append(self, seq_id, num_tokens=1):
+        """Reserve the slots of the next tokens of a sequence, which is started if unknown.
+
+        Parameters
+        ----------
+        seq_id : int
+            The ID of the sequence.
+
+        num_tokens : int
+            The number of the new tokens.
+
+        Returns
+        -------
+        ret : raf.ndarray
+            The int64 slots of the tokens in shape [num_tokens] for raf.kv_cache_append.
+        """
+        return ndarray.from_tensor_value(self._append(seq_id, num_tokens))
+
+    def block_tables(self, seq_ids):
+        """Get the block tables of a batch of sequences.
+
+        Parameters
+        ----------
+        seq_ids : List[int]
+            The IDs of the sequences.
+
+        Returns
+        -------
+        ret : raf.ndarray
+            The int64 block tables in shape [batch_size, max_blocks] for raf.kv_cache_gather.
+        """
+        return ndarray.from_tensor_value(self._block_tables(list(seq_ids)))
+
+    def seq_lens(self, seq_ids):
+        """Get the number of cached tokens of a batch of sequences, including the reserved ones.
+
+        Parameters
+        ----------
+        seq_ids : List[int]
+            The IDs of the sequences.
+
+        Returns
+        -------
+        ret : raf.ndarray
+            The int64 lengths in shape [batch_size].
+        """
+        return ndarray.from_tensor_value(self._seq_lens(list(seq_ids)))
+
+    def free(self, seq_id):
+        """Return the blocks of a finished sequence."""
+        self._free(seq_id)
+
+    @property
+    def num_free_blocks(self):
+        """The number of free blocks."""
+        return self._num_free_blocks()
+
+    def flat_caches(self):
+        """The key cache and then the value cache of each layer, as the inputs of a step."""
+        return [cache for pair in self.caches for cache in pair]
@@ -5,6 +5,8 @@
 
 from raf._ffi.memory_profiler import EnableMemoryProfiler, DisableMemoryeProfiler
 from raf._ffi.memory_profiler import ResetMemoryProfiler, GetMaxMemoryInfo, GetMemoryTrace
+from raf._ffi.memory_profiler import GetAllocationReport, GetAllocationTrace
+from raf._ffi.memory_profiler import StartAllocTrace, StopAllocTrace, ReplayAllocTrace
 
 
 def start():
@@ -53,3 +55,104 @@ def get_memory_trace(device):
         The complete trace in a string.
     """
     return GetMemoryTrace(device)
+
+
+def get_allocation_report(device, predicted_peak=None):
+    """Get the report of the buffers allocated by the VM.
+
+    Parameters
+    ----------
+    device: Device
+        The device to get the report.
+
+    predicted_peak: Optional[float]
+        The peak memory in MBs predicted by the compiler, such as the one returned by
+        raf.model.model.get_peak_memory, which is based on EstimateMemory.
+
+    Returns
+    -------
+    ret: Dict[str, ...]
+        The report with sizes in MBs, including
+        - 'peak_live': The peak size of the live buffers.
+        - 'live_at_peak': The var, op, stream and size of each buffer live at the peak, from the
+          largest to the smallest. The op is the one executed right after the allocation.
+        - 'live_at_peak_by_op': The size of the live buffers at the peak grouped by op.
+        - 'peak_pool_used' and 'peak_pool_allocated': The used and allocated memory of the pool
+          when it uses the most memory.
+        - 'fragmentation': The fraction of the allocated pool memory that is not used at that
+          moment.
+        - 'predicted_peak' and 'prediction_error': The given prediction and the relative error of
+          it against the measured peak, if a prediction is given.
+    """
+    return GetAllocationReport(device, predicted_peak if predicted_peak is not None else -1.0)
+
+
+def get_allocation_trace(device):
+    """Get the allocation timeline.
+
+    Parameters
+    ----------
+    device: Device
+        The device to fetch.
+
+    Returns
+    -------
+    ret: str
+        The allocations with their size, IR variable, op, stream, and the memory trace indices
+        when they are allocated and freed, in a string.
+    """
+    return GetAllocationTrace(device)
+
+
+def start_alloc_trace(device):
+    """Start capturing the allocations made by the VM on the device. Unlike the profiler, the
+    capture keeps only the size, alignment, stream and time of each allocation and release, so
+    that the trace can be saved compactly and replayed against other memory pools.
+
+    Parameters
+    ----------
+    device: Device
+        The device to capture.
+    """
+    StartAllocTrace(device)
+
+
+def stop_alloc_trace(path=""):
+    """Stop capturing the allocations, and save the trace in a binary file if a path is given.
+
+    Parameters
+    ----------
+    path: str
+        The path to save the trace.
+
+    Returns
+    -------
+    ret: int
+        The number of captured allocation and release events.
+    """
+    return StopAllocTrace(path)
+
+
+def replay_alloc_trace(path, pool_name, repeat=1):
+    """Replay a saved allocation trace against a new memory pool of the trace device. The current
+    pool of the device is restored afterwards. See also tests/cpp/bench/alloc_bench.cc.
+
+    Parameters
+    ----------
+    path: str
+        The path of the trace.
+
+    pool_name: str
+        The name of the memory pool, e.g., "page_unit_pool" or "no_pool".
+
+    repeat: int
+        The number of timed replays.
+
+    Returns
+    -------
+    ret: Dict[str, float]
+        The stats with sizes in MBs, including 'num_events', 'seconds' per replay,
+        'events_per_sec', 'peak_requested_mb', 'peak_used_mb', 'peak_reserved_mb' and
+        'fragmentation', the fraction of the peak reserved memory not requested by the trace.
+    """
+    return {key: val.value for key, val in ReplayAllocTrace(path, pool_name, repeat).items()}
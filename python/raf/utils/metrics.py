@@ -0,0 +1,74 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Runtime metrics, e.g., the VM run latency, the OpEnv cache hits and the memory pool usage."""
+from raf._ffi.metrics import Snapshot, ExportPrometheus, Reset
+
+
+def snapshot():
+    """Take a snapshot of the runtime metrics. Updating a metric is lock-free, so the snapshot is
+    cheap enough to be polled periodically by an exporter.
+
+    Returns
+    -------
+    ret : List[Dict[str, Any]]
+        The metrics sorted by name and labels. Each metric has "name", "labels" and "type"
+        ("counter", "gauge" or "histogram"). A counter or a gauge has "value". A histogram has
+        "bounds", "bucket_counts", "sum" and "count", where the last bucket count is the overflow
+        of the values larger than all bounds.
+    """
+    ret = []
+    for item in Snapshot():
+        metric = {
+            "name": item["name"].value,
+            "labels": {str(k): str(v) for k, v in item["labels"].items()},
+            "type": item["type"].value,
+        }
+        if metric["type"] == "histogram":
+            metric["bounds"] = [bound.value for bound in item["bounds"]]
+            metric["bucket_counts"] = [count.value for count in item["bucket_counts"]]
+            metric["sum"] = item["sum"].value
+            metric["count"] = item["count"].value
+        else:
+            metric["value"] = item["value"].value
+        ret.append(metric)
+    return ret
+
+
+def get(name, **labels):
+    """Get a metric from a new snapshot.
+
+    Parameters
+    ----------
+    name : str
+        The metric name, e.g., "raf_vm_run_latency_us".
+
+    labels : Dict[str, str]
+        The labels of the metric, e.g., result="hit".
+
+    Returns
+    -------
+    ret : Optional[Dict[str, Any]]
+        The metric in the format of snapshot, or None if it does not exist.
+    """
+    for metric in snapshot():
+        if metric["name"] == name and metric["labels"] == labels:
+            return metric
+    return None
+
+
+def export_prometheus():
+    """Render the runtime metrics in the Prometheus text exposition format.
+
+    Returns
+    -------
+    ret : str
+        The metrics, which can be served at the /metrics endpoint of an exporter.
+    """
+    return ExportPrometheus()
+
+
+def reset():
+    """Reset the counters, gauges and histograms. The metrics collected from other components,
+    such as the memory pool sizes and the named cache events, are not affected."""
+    Reset()
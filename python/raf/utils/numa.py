@@ -0,0 +1,61 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""The NUMA topology of the host and the thread pinning, to scale the CPU serving across sockets.
+
+The CPU memory is bound to the NUMA node of the allocating thread with RAF_CPU_NUMA_BIND=1, the
+constants of the executables are replicated to each node that runs them with
+RAF_CPU_NUMA_REPLICATE=1, and the CPU workers of the VM are pinned to the nodes with
+RAF_CPU_NUMA_PIN=1. The serving threads should be pinned to their nodes with pin_thread, so that
+their allocations and constants are local to them.
+
+Example
+-------
+.. code-block:: python
+
+    def serve(node):
+        numa.pin_thread(node)
+        while True:
+            ...  # Run the requests of this thread.
+
+    threads = [threading.Thread(target=serve, args=(i,)) for i in range(numa.num_nodes())]
+"""
+from raf._ffi.numa import NumNodes, CurrentNode, PinThreadToNode
+
+
+def num_nodes():
+    """Get the number of the NUMA nodes of the host.
+
+    Returns
+    -------
+    ret : int
+        The number of the nodes, which is 1 on the hosts without NUMA.
+    """
+    return int(NumNodes())
+
+
+def current_node():
+    """Get the NUMA node of the CPU that the calling thread is running on.
+
+    Returns
+    -------
+    ret : int
+        The node.
+    """
+    return int(CurrentNode())
+
+
+def pin_thread(node):
+    """Pin the calling thread to the CPUs of a NUMA node.
+
+    Parameters
+    ----------
+    node : int
+        The node.
+
+    Returns
+    -------
+    ret : bool
+        Whether the thread is pinned.
+    """
+    return bool(PinThreadToNode(node))
@@ -0,0 +1,81 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Pass profiler that measures each pass run by RAFSequential."""
+
+from raf._ffi.pass_ import EnablePassInstrument, ClearPassInstrument, GetPassInstrumentRecords
+
+
+def start():
+    """Start recording the wall time, memory and IR size of each pass run by RAFSequential."""
+    EnablePassInstrument(True)
+
+
+def stop():
+    """Stop recording the passes."""
+    EnablePassInstrument(False)
+
+
+def clear():
+    """Drop the recorded passes."""
+    ClearPassInstrument()
+
+
+def get():
+    """Get the recorded passes.
+
+    Returns
+    -------
+    ret : List[Dict[str, Union[str, int]]]
+        The passes in the order they start. Passes of nested sequences and the passes required by
+        others are recorded as well. Each record includes
+        - 'name': The pass name.
+        - 'parent': The name of the sequence running the pass.
+        - 'depth': The nesting depth of the sequence, where the outermost sequence is 0.
+        - 'time_us': The wall time of the pass, including its nested passes.
+        - 'rss_before_kb', 'rss_after_kb': The resident set size before and after the pass.
+        - 'peak_rss_kb': The peak resident set size of the process after the pass.
+        - 'lets_before', 'lets_after': The number of let bindings in the module.
+        - 'calls_before', 'calls_after': The number of calls in the module, which also measures
+          the graph-normal-form IR.
+    """
+    ret = []
+    for record in GetPassInstrumentRecords():
+        ret.append({k: v if isinstance(v, str) else v.value for k, v in record.items()})
+    return ret
+
+
+def get_summary(records=None):
+    """Summarize the recorded passes by name.
+
+    Parameters
+    ----------
+    records : Optional[List[Dict[str, Union[str, int]]]]
+        The records returned by `get`. If not given, the current records are used.
+
+    Returns
+    -------
+    ret : List[Dict[str, Union[str, int, float]]]
+        The count, the total time in milliseconds, the max IR size and the max increase of the
+        resident set size in KBs of each pass name, in the descending order of time.
+    """
+    records = get() if records is None else records
+    summary = {}
+    for record in records:
+        item = summary.setdefault(
+            record["name"],
+            {
+                "name": record["name"],
+                "count": 0,
+                "time_ms": 0.0,
+                "max_lets": 0,
+                "max_rss_increase_kb": 0,
+            },
+        )
+        item["count"] += 1
+        item["time_ms"] += record["time_us"] / 1000.0
+        item["max_lets"] = max(item["max_lets"], record["lets_before"], record["lets_after"])
+        item["max_rss_increase_kb"] = max(
+            item["max_rss_increase_kb"], record["rss_after_kb"] - record["rss_before_kb"]
+        )
+    return sorted(summary.values(), key=lambda item: item["time_ms"], reverse=True)
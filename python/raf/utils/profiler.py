@@ -7,6 +7,10 @@ from raf import build
 from raf._ffi.profiler import EnableProfiler, DisableProfiler
 from raf._ffi.profiler import CollectBaseProfile, CollectCudaProfile, GetProfile
 from raf._ffi.profiler import ClearProfile, ClearCudaProfile
+from raf._ffi.profiler import StartCuptiProfile, StopCuptiProfile
+from raf._ffi.profiler import CollectCuptiProfile, ClearCuptiProfile
+from raf._ffi.profiler import EnableNVTX, NVTXEnabled
+from raf._ffi.profiler import AnalyzeProfile, AnalyzeUtilization
 
 
 def start(prof_level=1):
@@ -25,11 +29,57 @@ def stop():
     DisableProfiler()
 
 
+def start_kernel_trace(capacity=1 << 20, num_buffers=8):
+    """Start the CUPTI-based kernel tracer. Unlike `start`, it does not synchronize or time each
+    op on the host. GPU kernels, copies and sets are recorded asynchronously and tagged with the
+    VM instruction and op that launched them, so it is cheap enough to keep on in production.
+
+    Parameters
+    ----------
+    capacity : int
+        The number of GPU activities kept. When exceeded, the oldest ones are overwritten.
+
+    num_buffers : int
+        The number of 4MB activity buffers handed to CUPTI. Activities are dropped by CUPTI
+        when all buffers are in flight.
+    """
+    assert build.with_cupti(), "RAF is not built with CUPTI"
+    StartCuptiProfile(capacity, num_buffers)
+
+
+def stop_kernel_trace():
+    """Stop the CUPTI-based kernel tracer."""
+    assert build.with_cupti(), "RAF is not built with CUPTI"
+    StopCuptiProfile()
+
+
+def enable_nvtx(enable=True):
+    """Enable or disable the NVTX ranges of the ops, the passes, the VM phases, the JIT
+    compilation and the NCCL collectives, which are shown in the timeline of Nsight Systems under
+    the domains raf.op, raf.pass, raf.vm, raf.jit and raf.comm, respectively. They are enabled by
+    default when the process runs under Nsight Systems, or when RAF_NVTX=1.
+
+    Parameters
+    ----------
+    enable : bool
+        Whether to emit the ranges.
+    """
+    assert build.with_nvtx(), "RAF is not built with NVTX"
+    EnableNVTX(enable)
+
+
+def nvtx_enabled():
+    """Whether the NVTX ranges are emitted."""
+    return build.with_nvtx() and NVTXEnabled()
+
+
 def clear():
     """Clear the cached profiler records in backend."""
     ClearProfile()
     if build.with_cuda():
         ClearCudaProfile()
+    if build.with_cupti():
+        ClearCuptiProfile()
 
 
 def dump(filename="profile.json"):
@@ -55,9 +105,97 @@ def get():
     CollectBaseProfile()
     if build.with_cuda():
         CollectCudaProfile()
+    if build.with_cupti():
+        CollectCuptiProfile()
     return json.loads(GetProfile())
 
 
+def analyze(comm_streams=("Stream 4",)):
+    """Analyze the collected events on the CUDA streams. The events are kept, so they can still
+    be dumped afterwards.
+
+    Parameters
+    ----------
+    comm_streams : Sequence[str]
+        The stream categories that run the collective ops. By default, it is the stream of
+        StreamTagEnum::CudaCommunicate that EnforceSync assigns the collectives to. With more
+        than one communication stream (DistConfig.num_comm_streams), the other ones are
+        "Stream 7", "Stream 8", and so on.
+
+    Returns
+    -------
+    ret : Dict[str, ...]
+        The summary in milliseconds, including
+        - 'makespan': The time from the first start to the last end.
+        - 'critical_path': The total duration of the ops on the critical path, which is recovered
+          backwards by taking the latest op finishing before the current one starts.
+        - 'critical_path_idle': The total gap between the ops on the critical path.
+        - 'critical_path_op_share': The fraction of the critical path spent in each op name.
+        - 'stream_idle': The idle time of each stream within the makespan.
+        - 'exposed_comm': The name, duration and exposed time of each collective, in start
+          order. The exposed time is the part not overlapped by any computation.
+        - 'total_exposed_comm': The total exposed communication time.
+    """
+    if build.with_cuda():
+        CollectCudaProfile()
+    if build.with_cupti():
+        CollectCuptiProfile()
+    return AnalyzeProfile(list(comm_streams))
+
+
+def analyze_utilization(device, peak_gflops=None, peak_gbps=None):
+    """Relate the FLOPs and bytes of the ops estimated at compile time to their profiled latency,
+    and report the model FLOPs utilization (MFU) and the memory bandwidth utilization of the whole
+    step and of each op type. The executable must be compiled with the pass config
+    "raf.vm.estimate_op_work" enabled, and the VM records the work of the ops while profiling.
+
+    Parameters
+    ----------
+    device : str
+        The device the ops run on, whose analytical cost model spec provides the default peaks.
+
+    peak_gflops : Optional[float]
+        The peak compute throughput in GFLOPS, e.g., 312000 for the FP16 tensor cores of A100.
+
+    peak_gbps : Optional[float]
+        The peak memory bandwidth in GB/s.
+
+    Returns
+    -------
+    ret : Dict[str, ...]
+        The summary of the profiled window, including
+        - 'makespan': The time in ms from the first start to the last end of the ops.
+        - 'op_time': The total latency in ms of the ops.
+        - 'coverage': The fraction of op_time from the ops with estimated work.
+        - 'gflops', 'gbytes': The total estimated work.
+        - 'achieved_gflops', 'achieved_gbps', 'mfu', 'bandwidth_util': The throughputs over the
+          makespan and their ratios to the peaks.
+        - 'ops': The op types in descending order of their time, each with 'type', 'count',
+          'time', 'time_share', 'gflops', 'gbytes' and the throughputs over its own time.
+    """
+    if peak_gflops is None or peak_gbps is None:
+        from .cost_model import get_device_spec  # pylint: disable=import-outside-toplevel
+
+        spec = get_device_spec(device)
+        peak_gflops = spec["peak_gflops"] if peak_gflops is None else peak_gflops
+        peak_gbps = spec["peak_gbps"] if peak_gbps is None else peak_gbps
+    if build.with_cuda():
+        CollectCudaProfile()
+    if build.with_cupti():
+        CollectCuptiProfile()
+
+    def to_py(obj):
+        if isinstance(obj, str):
+            return obj
+        if hasattr(obj, "items"):
+            return {str(k): to_py(v) for k, v in obj.items()}
+        if hasattr(obj, "value"):
+            return obj.value
+        return [to_py(v) for v in obj]
+
+    return to_py(AnalyzeUtilization(float(peak_gflops), float(peak_gbps)))
+
+
 def get_duration(data, event, category=None):
     """
     Get the duration of given event on given category in milliseconds.
@@ -97,3 +235,36 @@ def get_duration(data, event, category=None):
     if start_time_stamp is None or end_time_stamp is None:
         raise ValueError(f"The start or end time stamp of event {event} does not exist")
     return float((end_time_stamp - start_time_stamp) / 1000.0)
+
+
+def get_category_durations(data, category):
+    """
+    Get the total duration of each event name on the given category in milliseconds. Unlike
+    `get_duration`, an event name may occur many times, and nested events are paired correctly.
+
+    Parameters
+    ----------
+    data : Dict[str, ...]
+        The traced data in google trace event format, which can be get by
+        raf.utils.profiler.get().
+
+    category : str
+        The category name, e.g., 'Pass' for the passes run by RAFSequential, 'Compile' for the
+        VM compilation, and 'JIT' for the kernel builds and tuning.
+
+    Returns
+    -------
+    ret : Dict[str, float]
+        The total duration of each event name in milliseconds.
+    """
+    starts = {}
+    ret = {}
+    for e in data["traceEvents"]:
+        if e["cat"] != category:
+            continue
+        if e["ph"] == "B":
+            starts.setdefault(e["name"], []).append(int(e["ts"]))
+        elif e["ph"] == "E" and starts.get(e["name"]):
+            start = starts[e["name"]].pop()
+            ret[e["name"]] = ret.get(e["name"], 0.0) + (int(e["ts"]) - start) / 1000.0
+    return ret
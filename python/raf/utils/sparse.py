@@ -0,0 +1,128 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Sparse matrices for the sparse operators. A sparse matrix in shape [m, k] is passed to the
+operators in the CSR format of three tensors: indptr in shape [m + 1], and indices and values in
+shape [nnz], where the non-zeros of row i are values[indptr[i]:indptr[i + 1]] at columns
+indices[indptr[i]:indptr[i + 1]]. Matrices in the COO format are converted to CSR on the host.
+
+- raf.csr_spmm(indptr, indices, values, dense): A * dense in shape [m, n].
+- raf.csr_spmm_tn(indptr, indices, values, dense, shape): A^T * dense in the given shape [k, n].
+- raf.csr_sddmm(indptr, indices, x1, x2): the values of x1 * x2^T at the non-zeros of A.
+
+The sparsity pattern is constant, and the gradient of the values is only taken at the non-zeros.
+
+Example
+-------
+.. code-block:: python
+
+    adj = sparse.CSRMatrix.from_coo(rows, cols, weights, shape=(num_nodes, num_nodes))
+    indptr, indices, values = adj.tensors(device="cuda")
+    out = raf.csr_spmm(indptr, indices, values, features)
+"""
+import numpy as np
+
+from raf._core.ndarray import array
+
+
+class CSRMatrix:
+    """A sparse matrix in the CSR format on the host.
+
+    Parameters
+    ----------
+    indptr : numpy.ndarray
+        The offsets of the non-zeros of each row in shape [m + 1].
+
+    indices : numpy.ndarray
+        The columns of the non-zeros in shape [nnz].
+
+    values : numpy.ndarray
+        The values of the non-zeros in shape [nnz].
+
+    shape : Tuple[int, int]
+        The shape of the matrix.
+    """
+
+    def __init__(self, indptr, indices, values, shape):
+        assert len(indptr) == shape[0] + 1, "The indptr should be in shape [m + 1]"
+        assert len(indices) == len(values) == indptr[-1], "Each non-zero should have a column"
+        self.indptr = np.asarray(indptr)
+        self.indices = np.asarray(indices, dtype=self.indptr.dtype)
+        self.values = np.asarray(values)
+        self.shape = tuple(shape)
+
+    @staticmethod
+    def from_coo(rows, cols, values, shape, index_dtype="int32"):
+        """Convert a matrix in the COO format, whose duplicated entries are summed.
+
+        Parameters
+        ----------
+        rows : numpy.ndarray
+            The rows of the entries.
+
+        cols : numpy.ndarray
+            The columns of the entries.
+
+        values : numpy.ndarray
+            The values of the entries.
+
+        shape : Tuple[int, int]
+            The shape of the matrix.
+
+        index_dtype : str
+            The dtype of indptr and indices, which is int32 or int64.
+
+        Returns
+        -------
+        ret : CSRMatrix
+            The matrix in the CSR format, whose columns are sorted in each row.
+        """
+        rows, cols, values = np.asarray(rows), np.asarray(cols), np.asarray(values)
+        keys, inverse = np.unique(rows.astype("int64") * shape[1] + cols, return_inverse=True)
+        summed = np.zeros(len(keys), dtype=values.dtype)
+        np.add.at(summed, inverse, values)
+        counts = np.bincount(keys // shape[1], minlength=shape[0])
+        indptr = np.concatenate([[0], np.cumsum(counts)]).astype(index_dtype)
+        return CSRMatrix(indptr, (keys % shape[1]).astype(index_dtype), summed, shape)
+
+    @staticmethod
+    def from_dense(dense, index_dtype="int32"):
+        """Convert a dense matrix, keeping its non-zeros.
+
+        Parameters
+        ----------
+        dense : numpy.ndarray
+            The dense matrix.
+
+        index_dtype : str
+            The dtype of indptr and indices, which is int32 or int64.
+
+        Returns
+        -------
+        ret : CSRMatrix
+            The matrix in the CSR format.
+        """
+        rows, cols = np.nonzero(dense)
+        return CSRMatrix.from_coo(rows, cols, dense[rows, cols], dense.shape, index_dtype)
+
+    def to_dense(self):
+        """Convert to a dense matrix."""
+        dense = np.zeros(self.shape, dtype=self.values.dtype)
+        rows = np.repeat(np.arange(self.shape[0]), np.diff(self.indptr))
+        np.add.at(dense, (rows, self.indices), self.values)
+        return dense
+
+    def tensors(self, device="cpu"):
+        """The indptr, indices and values as the arguments of the sparse operators.
+
+        Parameters
+        ----------
+        device : str
+            The device of the tensors.
+
+        Returns
+        -------
+        ret : Tuple[raf.ndarray, raf.ndarray, raf.ndarray]
+            The indptr, indices and values.
+        """
+        return tuple(array(x, device=device) for x in (self.indptr, self.indices, self.values))
@@ -13,7 +13,8 @@ from copy import copy
 import tvm
 
 import raf
-from raf._core.executor import MetaFallbackContext
+from raf import _ffi
+from raf._core.executor import MetaFallbackContext, tuning_db_key
 from raf._core.ndarray import array
 from raf._core.executor import VMExecutor
 from raf.model.trace import _get_func_inputs
@@ -108,7 +109,7 @@ def extract_tuning_tasks(mod_or_executor, args, device, *, fusion=False, pass_se
     return tasks, weights
 
 
-def tune_tasks(tasks, weights, log_file, n_trials):
+def tune_tasks(tasks, weights, log_file, n_trials, n_parallel=None):
     """Tune a set of given tasks.
 
     tasks: List[tvm.auto_scheduler.SearchTask]
@@ -123,8 +124,13 @@ def tune_tasks(tasks, weights, log_file, n_trials):
     n_trials: Callable[[int], int] or int
         An integer of total number of measurement trials, or a function that determines
         the total number of measurement trials by taking the task number.
+
+    n_parallel: Optional[int]
+        The number of processes to build the candidate schedules in parallel. Default is the
+        number of CPU cores.
     """
     measure_device = auto_scheduler.LocalRPCMeasureContext(repeat=1, min_repeat_ms=400, timeout=20)
+    builder = auto_scheduler.LocalBuilder(n_parallel=n_parallel or os.cpu_count())
 
     # FIXME(comaniac): Remove this custom objective function after
     # https://github.com/apache/tvm/pull/8984
@@ -147,6 +153,7 @@ def tune_tasks(tasks, weights, log_file, n_trials):
     print("Start tuning for maximal %d trials" % n_trials)
     tune_option = auto_scheduler.TuningOptions(
         num_measure_trials=n_trials,
+        builder=builder,
         runner=measure_device.runner,
         measure_callbacks=[auto_scheduler.RecordToFile(log_file)],
     )
@@ -155,6 +162,49 @@ def tune_tasks(tasks, weights, log_file, n_trials):
     print("Done tuning. Records saved in %s" % log_file)
 
 
+def _record_cost(res):
+    costs = [cost.value for cost in res.costs]
+    return sum(costs) / len(costs)
+
+
+def save_to_database(log_file):
+    """Store the best schedule of each workload in the tuning log to the tuning database, which
+    is consulted when building the TVM ops and fused functions. The workloads without tuned
+    schedules fall back to the default schedules. A stored schedule is only replaced by a faster
+    one. Note that the kernels persisted by RAF_PERSIST_CACHE before the tuning are not rebuilt.
+
+    Parameters
+    ----------
+    log_file: str
+        The tuning log.
+
+    Returns
+    -------
+    n_saved: int
+        The number of stored schedules.
+    """
+    best = {}
+    for inp, res in auto_scheduler.load_records(log_file):
+        if res.error_no != 0:
+            continue
+        key = tuning_db_key(inp.task.target, inp.task.workload_key)
+        cost = _record_cost(res)
+        if key not in best or cost < best[key][0]:
+            best[key] = (cost, inp, res)
+
+    n_saved = 0
+    for key, (cost, inp, res) in best.items():
+        record = _ffi.cache.GetTuningRecord(key)
+        if record:
+            _, old_res = auto_scheduler.measure_record.load_record_from_string(record)
+            if _record_cost(old_res) <= cost:
+                continue
+        record = auto_scheduler.measure_record.dump_record_to_string(inp, res)
+        _ffi.cache.PutTuningRecord(key, record)
+        n_saved += 1
+    return n_saved
+
+
 def run_tuning(
     model_or_executor,
     device,
@@ -165,7 +215,9 @@ def run_tuning(
     pass_seq=None,
     n_trials=lambda l: 300 * min(l, 100),
     only_tune_tasks_with_name=None,
-    only_extract_tasks=False
+    only_extract_tasks=False,
+    n_parallel=None,
+    save_to_db=True
 ):
     """Tune the given tasks.
 
@@ -201,6 +253,14 @@ def run_tuning(
 
     only_extract_tasks: bool
         Whether to extract and print tasks only without actual tuning them.
+
+    n_parallel: Optional[int]
+        The number of processes to build the candidate schedules in parallel. Default is the
+        number of CPU cores.
+
+    save_to_db: bool
+        Whether to store the best schedules to the tuning database, so that the later built
+        kernels use them without RAF_SCH_FILE. Default: True.
     """
     print("Extracting tasks...")
     tasks, weights = extract_tuning_tasks(
@@ -228,7 +288,10 @@ def run_tuning(
         return
 
     print("Tuning %d out of %s tasks..." % (len(tasks), ori_task_num))
-    tune_tasks(tasks, weights, log_file, n_trials)
+    tune_tasks(tasks, weights, log_file, n_trials, n_parallel)
+    if save_to_db:
+        n_saved = save_to_database(log_file)
+        print("Stored %d schedules to the tuning database" % n_saved)
 
 
 def tune_op(
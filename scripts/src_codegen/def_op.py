@@ -10,6 +10,7 @@ OPS = [
     Op(name="adv_index_dx", schema_name="adv_index_dx"),
     Op(name="atan", schema_name="unary"),
     Op(name="conv2d", schema_name="conv"),
+    Op(name="quantized_conv2d", schema_name="conv"),
     Op(name="conv2d_transpose", schema_name="conv_trans"),
     Op(name="max_pool2d", schema_name="pool"),
     Op(name="avg_pool2d", schema_name="pool"),
@@ -21,6 +22,8 @@ OPS = [
     Op(name="batch_norm_train", schema_name="batch_norm"),
     Op(name="batch_norm_infer", schema_name="batch_norm"),
     Op(name="batch_norm_train_dxwb", schema_name="batch_norm_train_dxwb"),
+    Op(name="batch_norm_relu_train", schema_name="batch_norm_relu"),
+    Op(name="batch_norm_relu_train_dxwb", schema_name="batch_norm_relu_dxwb"),
     Op(name="conv2d_dx", schema_name="conv_dxw"),
     Op(name="conv2d_dw", schema_name="conv_dxw"),
     Op(name="conv2d_transpose_dx", schema_name="conv_transpose_dxw"),
@@ -87,6 +90,10 @@ OPS = [
     Op(name="batch_matmul_nt", schema_name="binary"),
     Op(name="batch_matmul_tn", schema_name="binary"),
     Op(name="batch_matmul_tt", schema_name="binary"),
+    Op(name="grouped_matmul", schema_name="grouped_matmul"),
+    Op(name="csr_spmm", schema_name="csr_spmm"),
+    Op(name="csr_spmm_tn", schema_name="csr_spmm_tn"),
+    Op(name="csr_sddmm", schema_name="csr_sddmm"),
     Op(name="smooth_l1_loss", schema_name="loss"),
     Op(name="smooth_l1_loss_dpred", schema_name="loss"),
     Op(name="smooth_l1_loss_dtrue", schema_name="loss"),
@@ -96,6 +103,8 @@ OPS = [
     Op(name="cross_entropy", schema_name="loss"),
     Op(name="cross_entropy_dpred", schema_name="loss_dtp"),
     Op(name="cross_entropy_dtrue", schema_name="loss_dtp"),
+    Op(name="softmax_cross_entropy", schema_name="softmax_cross_entropy"),
+    Op(name="softmax_cross_entropy_dpred", schema_name="softmax_cross_entropy_dpred"),
     Op(name="reshape", schema_name="reshape"),
     Op(name="reshape_like", schema_name="binary_like"),
     Op(name="resize2d", schema_name="resize2d"),
@@ -119,18 +128,33 @@ OPS = [
     Op(name="get_kept_dims", schema_name="binary"),
     Op(name="sgd", schema_name="sgd"),
     Op(name="lans", schema_name="lans"),
+    Op(name="multi_tensor_sgd", schema_name="multi_tensor_sgd"),
+    Op(name="multi_tensor_adam", schema_name="multi_tensor_adam"),
+    Op(name="global_norm_and_check", schema_name="global_norm_and_check"),
+    Op(name="update_loss_scale", schema_name="update_loss_scale"),
     Op(name="shape", schema_name="unary"),
     Op(name="swap_axis", schema_name="swap_axis"),
     Op(name="take", schema_name="take"),
     Op(name="take_dx", schema_name="take_dx"),
     Op(name="embedding", schema_name="embedding"),
     Op(name="embedding_dx", schema_name="embedding_dx"),
+    Op(name="embedding_dx_sparse", schema_name="embedding_dx"),
+    Op(name="embedding_position", schema_name="embedding_position"),
+    Op(name="embedding_cache", schema_name="embedding_cache"),
+    Op(name="embedding_cache_sgd", schema_name="embedding_cache_sgd"),
+    Op(name="kv_cache_append", schema_name="kv_cache_append"),
+    Op(name="kv_cache_gather", schema_name="kv_cache_gather"),
     Op(name="dense", schema_name="binary"),
+    Op(name="quantized_dense", schema_name="binary"),
+    Op(name="sparse24_dense", schema_name="binary"),
+    Op(name="prune_24", schema_name="unary"),
     Op(name="repeat", schema_name="repeat"),
     Op(name="repeat_dx", schema_name="repeat_dx"),
     Op(name="expand_dims", schema_name="expand_dims"),
     Op(name="threefry_generate", schema_name="threefry_generate"),
     Op(name="threefry_split", schema_name="threefry_split"),
+    Op(name="threefry_uniform", schema_name="threefry_uniform"),
+    Op(name="threefry_normal", schema_name="threefry_normal"),
     Op(name="strided_slice", schema_name="strided_slice"),
     Op(name="strided_slice_dx", schema_name="strided_slice_dx"),
     Op(name="strided_set", schema_name="strided_set"),
@@ -159,6 +183,13 @@ OPS = [
     Op(name="bias_add", schema_name="bias_add"),
     Op(name="_contrib_dropout", schema_name="dropout"),
     Op(name="_contrib_dropout_dx", schema_name="dropout_dx"),
+    Op(name="add_dropout_layer_norm", schema_name="add_dropout_layer_norm"),
+    Op(name="add_dropout_layer_norm_dx", schema_name="add_dropout_layer_norm_dx"),
+    Op(name="rms_norm", schema_name="rms_norm"),
+    Op(name="rms_norm_dx", schema_name="rms_norm_dx"),
+    Op(name="rotary_embedding", schema_name="rotary_embedding"),
+    Op(name="attention", schema_name="attention"),
+    Op(name="attention_dx", schema_name="attention_dx"),
     Op(name="non_max_suppression", schema_name="non_max_suppression"),
     Op(name="stream_sync", schema_name="stream"),
     Op(name="fuse_tensor", schema_name="fuse_tensor"),
@@ -206,8 +237,10 @@ OPS = [
     Op(name="_reduce", schema_name="comm_reduce"),
     Op(name="_reduce_scatter", schema_name="reduce_scatter"),
     Op(name="_group_reduce_scatter", schema_name="group_reduce_scatter"),
+    Op(name="_group_comm", schema_name="group_comm"),
     Op(name="_broadcast", schema_name="broadcast"),
     Op(name="_all_to_all", schema_name="all_to_all"),
+    Op(name="_all_to_allv", schema_name="all_to_allv"),
     Op(name="_send", schema_name="send"),
     Op(name="_recv", schema_name="recv"),
     # VM ops
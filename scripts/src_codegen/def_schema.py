@@ -137,6 +137,28 @@ SCHEMAS = {
         Arg(name="b", cxx_type="value::BaseTensorValue"),
         Arg(name="eps", cxx_type="double"),
     ],
+    "nn.h::batch_norm_relu": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="running_mean", cxx_type="value::BaseTensorValue"),
+        Arg(name="running_var", cxx_type="value::BaseTensorValue"),
+        Arg(name="w", cxx_type="value::BaseTensorValue"),
+        Arg(name="b", cxx_type="value::BaseTensorValue"),
+        Arg(name="z", cxx_type=OptionalTensor, cxx_default="nullptr"),
+        Arg(name="momentum", cxx_type="double", cxx_default=0.1),
+        Arg(name="eps", cxx_type="double", cxx_default=1e-5),
+        Arg(name="layout", cxx_type="std::string", cxx_default='"NCHW"', py_default='"NCHW"'),
+    ],
+    "nn.h::batch_norm_relu_dxwb": [
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="w", cxx_type="value::BaseTensorValue"),
+        Arg(name="b", cxx_type="value::BaseTensorValue"),
+        Arg(name="y", cxx_type="value::BaseTensorValue"),
+        Arg(name="reserve_space", cxx_type="value::BaseTensorValue"),
+        Arg(name="with_z", cxx_type="bool", cxx_default=False),
+        Arg(name="eps", cxx_type="double", cxx_default=1e-5),
+        Arg(name="layout", cxx_type="std::string", cxx_default='"NCHW"', py_default='"NCHW"'),
+    ],
     "nn.h::bias_add": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="bias", cxx_type="value::BaseTensorValue"),
@@ -225,6 +247,26 @@ SCHEMAS = {
         Arg(name="indices", cxx_type="value::BaseTensorValue"),
         Arg(name="num_weight", cxx_type="value::Value"),
     ],
+    "nn.h::embedding_position": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="indices", cxx_type="value::BaseTensorValue"),
+        Arg(name="position", cxx_type="value::BaseTensorValue"),
+        Arg(name="position_ids", cxx_type="value::BaseTensorValue"),
+    ],
+    "nn.h::embedding_cache": [
+        Arg(name="table", cxx_type="value::BaseTensorValue"),
+        Arg(name="indices", cxx_type="value::BaseTensorValue"),
+        Arg(name="tags", cxx_type="value::BaseTensorValue"),
+        Arg(name="rows", cxx_type="value::BaseTensorValue"),
+    ],
+    "nn.h::embedding_cache_sgd": [
+        Arg(name="table", cxx_type="value::BaseTensorValue"),
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="indices", cxx_type="value::BaseTensorValue"),
+        Arg(name="tags", cxx_type="value::BaseTensorValue"),
+        Arg(name="rows", cxx_type="value::BaseTensorValue"),
+        Arg(name="learning_rate", cxx_type="double"),
+    ],
     "nn.h::repeat": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="repeats", cxx_type="int"),
@@ -252,6 +294,11 @@ SCHEMAS = {
         Arg(name="x", cxx_type="std::vector<value::BaseTensorValue>", cxx_normalizer="TensorTuple"),
         Arg(name="axis", cxx_type="int", cxx_default=0),
     ],
+    "nn.h::grouped_matmul": [
+        Arg(name="a", cxx_type="std::vector<value::BaseTensorValue>", cxx_normalizer="TensorTuple"),
+        Arg(name="b", cxx_type="std::vector<value::BaseTensorValue>", cxx_normalizer="TensorTuple"),
+        Arg(name="transpose_b", cxx_type="bool", cxx_default=False),
+    ],
     "nn.h::mesh_grid": [
         Arg(name="x", cxx_type="std::vector<value::BaseTensorValue>", cxx_normalizer="TensorTuple"),
     ],
@@ -292,6 +339,62 @@ SCHEMAS = {
         Arg(name="axis", cxx_type="int64_t", cxx_default=-1),
         Arg(name="eps", cxx_type="double", cxx_default=1e-5),
     ],
+    "nn.h::add_dropout_layer_norm": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="residual", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type=OptionalTensor, cxx_default="nullptr"),
+        Arg(name="bias", cxx_type=OptionalTensor, cxx_default="nullptr"),
+        Arg(name="p", cxx_type="double", cxx_default=0.0),
+        Arg(name="eps", cxx_type="double", cxx_default=1e-5),
+    ],
+    "nn.h::add_dropout_layer_norm_dx": [
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="dz", cxx_type=OptionalTensor),
+        Arg(name="z", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type=OptionalTensor),
+        Arg(name="mean", cxx_type="value::BaseTensorValue"),
+        Arg(name="invvar", cxx_type="value::BaseTensorValue"),
+        Arg(name="rng_state", cxx_type="value::BaseTensorValue"),
+        Arg(name="p", cxx_type="double", cxx_default=0.0),
+    ],
+    "nn.h::rms_norm": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type=OptionalTensor, cxx_default="nullptr"),
+        Arg(name="eps", cxx_type="double", cxx_default=1e-6),
+    ],
+    "nn.h::rms_norm_dx": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type=OptionalTensor),
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="eps", cxx_type="double", cxx_default=1e-6),
+    ],
+    "nn.h::rotary_embedding": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="cos", cxx_type="value::BaseTensorValue"),
+        Arg(name="sin", cxx_type="value::BaseTensorValue"),
+        Arg(name="seq_axis", cxx_type="int", cxx_default=-2),
+        Arg(name="interleaved", cxx_type="bool", cxx_default=False),
+    ],
+    "nn.h::attention": [
+        Arg(name="q", cxx_type="value::BaseTensorValue"),
+        Arg(name="k", cxx_type="value::BaseTensorValue"),
+        Arg(name="v", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="double", cxx_default=-1.0),
+        Arg(name="causal", cxx_type="bool", cxx_default=False),
+        Arg(name="p", cxx_type="double", cxx_default=0.0),
+    ],
+    "nn.h::attention_dx": [
+        Arg(name="q", cxx_type="value::BaseTensorValue"),
+        Arg(name="k", cxx_type="value::BaseTensorValue"),
+        Arg(name="v", cxx_type="value::BaseTensorValue"),
+        Arg(name="out", cxx_type="value::BaseTensorValue"),
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="lse", cxx_type="value::BaseTensorValue"),
+        Arg(name="rng_state", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="double", cxx_default=-1.0),
+        Arg(name="causal", cxx_type="bool", cxx_default=False),
+        Arg(name="p", cxx_type="double", cxx_default=0.0),
+    ],
     "nn.h::split": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="indices_or_sections", cxx_type="value::Value", cxx_default="nullptr"),
@@ -316,6 +419,19 @@ SCHEMAS = {
         Arg(name="y_true", cxx_type="value::BaseTensorValue"),
         Arg(name="y_pred", cxx_type="value::BaseTensorValue"),
     ],
+    "loss.h::softmax_cross_entropy": [
+        Arg(name="y_true", cxx_type="value::BaseTensorValue"),
+        Arg(name="y_pred", cxx_type="value::BaseTensorValue"),
+        Arg(name="ignore_index", cxx_type="int64_t", cxx_default=-100),
+        Arg(name="label_smoothing", cxx_type="double", cxx_default=0.0),
+    ],
+    "loss.h::softmax_cross_entropy_dpred": [
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="y_true", cxx_type="value::BaseTensorValue"),
+        Arg(name="y_pred", cxx_type="value::BaseTensorValue"),
+        Arg(name="ignore_index", cxx_type="int64_t", cxx_default=-100),
+        Arg(name="label_smoothing", cxx_type="double", cxx_default=0.0),
+    ],
     "ufunc.h::unary_ufunc": [
         Arg(name="x", cxx_type="value::Value"),
         Arg(name="out", cxx_type="value::Value", cxx_default="nullptr"),
@@ -492,6 +608,34 @@ SCHEMAS = {
         Arg(name="src", cxx_type="value::BaseTensorValue"),
         Arg(name="axis", cxx_type="value::Value"),
     ],
+    "sparse.h::csr_spmm": [
+        Arg(name="indptr", cxx_type="value::BaseTensorValue"),
+        Arg(name="indices", cxx_type="value::BaseTensorValue"),
+        Arg(name="values", cxx_type="value::BaseTensorValue"),
+        Arg(name="dense", cxx_type="value::BaseTensorValue"),
+    ],
+    "sparse.h::csr_spmm_tn": [
+        Arg(name="indptr", cxx_type="value::BaseTensorValue"),
+        Arg(name="indices", cxx_type="value::BaseTensorValue"),
+        Arg(name="values", cxx_type="value::BaseTensorValue"),
+        Arg(name="dense", cxx_type="value::BaseTensorValue"),
+        Arg(name="shape", cxx_type="value::Value"),
+    ],
+    "sparse.h::csr_sddmm": [
+        Arg(name="indptr", cxx_type="value::BaseTensorValue"),
+        Arg(name="indices", cxx_type="value::BaseTensorValue"),
+        Arg(name="x1", cxx_type="value::BaseTensorValue"),
+        Arg(name="x2", cxx_type="value::BaseTensorValue"),
+    ],
+    "transform.h::kv_cache_append": [
+        Arg(name="cache", cxx_type="value::BaseTensorValue"),
+        Arg(name="data", cxx_type="value::BaseTensorValue"),
+        Arg(name="slots", cxx_type="value::BaseTensorValue"),
+    ],
+    "transform.h::kv_cache_gather": [
+        Arg(name="cache", cxx_type="value::BaseTensorValue"),
+        Arg(name="block_table", cxx_type="value::BaseTensorValue"),
+    ],
     "transform.h::transpose": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(
@@ -629,6 +773,20 @@ SCHEMAS = {
     "random.h::threefry_split": [
         Arg(name="key", cxx_type="value::BaseTensorValue"),
     ],
+    "random.h::threefry_uniform": [
+        Arg(name="key", cxx_type="value::BaseTensorValue"),
+        Arg(name="shape", cxx_type="std::vector<int64_t>", cxx_normalizer="IntTuple"),
+        Arg(name="low", cxx_type="double", cxx_default=0.0),
+        Arg(name="high", cxx_type="double", cxx_default=1.0),
+        Arg(name="dtype", cxx_type="std::string", cxx_default='"float32"', py_default='"float32"'),
+    ],
+    "random.h::threefry_normal": [
+        Arg(name="key", cxx_type="value::BaseTensorValue"),
+        Arg(name="shape", cxx_type="std::vector<int64_t>", cxx_normalizer="IntTuple"),
+        Arg(name="mean", cxx_type="double", cxx_default=0.0),
+        Arg(name="stddev", cxx_type="double", cxx_default=1.0),
+        Arg(name="dtype", cxx_type="std::string", cxx_default='"float32"', py_default='"float32"'),
+    ],
     "vision.h::get_valid_counts": [
         Arg(name="data", cxx_type="value::BaseTensorValue"),
         Arg(name="score_threshold", cxx_type="value::BaseTensorValue"),
@@ -692,6 +850,54 @@ SCHEMAS = {
         Arg(name="mode", cxx_type="int"),
         Arg(name="normalize_grad", cxx_type="bool"),
     ],
+    "optimizer.h::multi_tensor_sgd": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+        Arg(name="learning_rate", cxx_type="float"),
+        Arg(name="momentum", cxx_type="float"),
+        Arg(name="fp16_params", cxx_type="bool", cxx_default=False),
+        Arg(name="grad_norm", cxx_type=OptionalTensor, cxx_default="nullptr"),
+        Arg(name="max_grad_norm", cxx_type="float", cxx_default=0.0),
+        Arg(name="loss_scale", cxx_type=OptionalTensor, cxx_default="nullptr"),
+    ],
+    "optimizer.h::multi_tensor_adam": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+        Arg(name="step", cxx_type="value::BaseTensorValue"),
+        Arg(name="learning_rate", cxx_type="float"),
+        Arg(name="beta1", cxx_type="float"),
+        Arg(name="beta2", cxx_type="float"),
+        Arg(name="eps", cxx_type="float"),
+        Arg(name="weight_decay", cxx_type="float"),
+        Arg(name="bias_correction", cxx_type="bool", cxx_default=True),
+        Arg(name="mode", cxx_type="int", cxx_default=0),
+        Arg(name="fp16_params", cxx_type="bool", cxx_default=False),
+        Arg(name="grad_norm", cxx_type=OptionalTensor, cxx_default="nullptr"),
+        Arg(name="max_grad_norm", cxx_type="float", cxx_default=0.0),
+        Arg(name="loss_scale", cxx_type=OptionalTensor, cxx_default="nullptr"),
+    ],
+    "optimizer.h::global_norm_and_check": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+    ],
+    "optimizer.h::update_loss_scale": [
+        Arg(name="grad_norm", cxx_type="value::BaseTensorValue"),
+        Arg(name="loss_scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="good_steps", cxx_type="value::BaseTensorValue"),
+        Arg(name="growth_factor", cxx_type="float", cxx_default=2.0),
+        Arg(name="backoff_factor", cxx_type="float", cxx_default=0.5),
+        Arg(name="growth_interval", cxx_type="int", cxx_default=2000),
+        Arg(name="min_scale", cxx_type="float", cxx_default=1.0),
+    ],
     "stream.h::stream": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="stream_tag", cxx_type="int", cxx_default=0),
@@ -735,6 +941,15 @@ SCHEMAS = {
         ),
         Arg(name="computation", cxx_type="std::string", cxx_default='"sum"', py_default='"sum"'),
     ],
+    "communication.h::group_comm": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+        Arg(name="kinds", cxx_type="std::vector<int64_t>", cxx_normalizer="IntTuple"),
+        Arg(name="computation", cxx_type="std::string", cxx_default='"sum"', py_default='"sum"'),
+    ],
     "communication.h::broadcast": [
         Arg(name="x", cxx_type="std::vector<value::BaseTensorValue>", cxx_normalizer="TensorTuple"),
         Arg(name="root", cxx_type="int"),
@@ -743,6 +958,10 @@ SCHEMAS = {
         Arg(name="x", cxx_type="std::vector<value::BaseTensorValue>", cxx_normalizer="TensorTuple"),
         Arg(name="group_use_memcpy", cxx_type="bool", cxx_default=False),
     ],
+    "communication.h::all_to_allv": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="send_counts", cxx_type="value::BaseTensorValue"),
+    ],
     "communication.h::send": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="peer", cxx_type="int"),
@@ -885,6 +1104,7 @@ SCHEMAS = {
             py_default="None",
         ),
         Arg(name="own", cxx_type="bool", cxx_default=True),
+        Arg(name="offset", cxx_type="int64_t", cxx_default=0),
     ],
     "vm.h::free": [
         Arg(name="memory", cxx_type="value::BaseTensorValue"),
@@ -908,6 +1128,7 @@ SCHEMAS = {
     "stream.h::set_stream": [
         Arg(name="device_id", cxx_type="int64_t"),
         Arg(name="stream_id", cxx_type="int64_t"),
+        Arg(name="priority", cxx_type="int64_t", cxx_default=0, py_default=0),
     ],
     "stream.h::event": [
         Arg(name="event_id", cxx_type="int64_t"),
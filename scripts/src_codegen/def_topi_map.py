@@ -30,8 +30,6 @@ OP_MAP = {
     "raf.op.tvm.cos": "cos",
     "raf.op.tvm.divide": "divide",
     "raf.op.tvm.equal": "equal",
-    "raf.op.tvm.erf": "erf",
-    "raf.op.tvm.exp": "exp",
     "raf.op.tvm.expand_dims": "expand_dims",
     "raf.op.tvm.floor": "floor",
     "raf.op.tvm.floor_divide": "floor_divide",
@@ -76,7 +74,6 @@ OP_MAP = {
     "raf.op.tvm.sequence_mask": "sequence_mask",
     "raf.op.tvm.reverse_sequence": "reverse_sequence",
     "raf.op.tvm.scatter": "scatter",
-    "raf.op.tvm.sigmoid": "sigmoid",
     "raf.op.tvm.sign": "sign",
     "raf.op.tvm.sin": "sin",
     "raf.op.tvm.slice_like": "slice_like",
@@ -87,7 +84,6 @@ OP_MAP = {
     "raf.op.tvm.strided_slice": "strided_slice",
     "raf.op.tvm.subtract": "subtract",
     "raf.op.tvm.take": "take",
-    "raf.op.tvm.tanh": "tanh",
     "raf.op.tvm.tile": "tile",
     "raf.op.tvm.topk": "topk",
     "raf.op.tvm.transpose": "transpose",
@@ -9,6 +9,7 @@
  * Tuple, and TupleGetItem as nodes and the dependency among them as edges. It is a directed acyclic
  * graph (DAG) and can be used to analyze the expr.
  */
+#include <numeric>
 #include "support/arena.h"
 #include "raf/analysis.h"
 #include "raf/registry.h"
@@ -291,6 +292,179 @@ DependencyGraph CreateDependencyGraph(Arena* arena, const Expr& e, bool prune_at
   return std::move(dg);
 }
 
+CompactDependencyGraph CompactDependencyGraph::Create(const Expr& e, bool prune_atomic_nodes,
+                                                      bool prune_redundant_edges) {
+  // The arena and the linked lists of DependencyGraph are only alive during the creation.
+  Arena arena;
+  DependencyGraph dg = DependencyGraph::Create(&arena, e);
+  int num_nodes = static_cast<int>(dg.post_dfs_order.size());
+  std::unordered_map<const dependency_graph::Node*, int> node_index;
+  for (int i = 0; i < num_nodes; ++i) {
+    node_index[dg.post_dfs_order[i]] = i;
+  }
+
+  CompactDependencyGraph graph;
+  graph.exprs_.resize(num_nodes);
+  for (auto& it : dg.expr_node) {
+    auto idx = node_index.find(it.second);
+    if (idx != node_index.end()) {
+      graph.exprs_[idx->second] = it.first;
+      graph.expr_node_[it.first.get()] = idx->second;
+    }
+  }
+  graph.child_offsets_.reserve(num_nodes + 1);
+  graph.parent_offsets_.reserve(num_nodes + 1);
+  graph.child_offsets_.push_back(0);
+  graph.parent_offsets_.push_back(0);
+  for (auto node : dg.post_dfs_order) {
+    for (auto iit = node->children.head; iit; iit = iit->next) {
+      graph.children_.push_back(node_index.at(iit->value));
+    }
+    for (auto iit = node->parents.head; iit; iit = iit->next) {
+      graph.parents_.push_back(node_index.at(iit->value));
+    }
+    graph.child_offsets_.push_back(static_cast<int>(graph.children_.size()));
+    graph.parent_offsets_.push_back(static_cast<int>(graph.parents_.size()));
+  }
+
+  if (prune_atomic_nodes) {
+    graph.PruneAtomicNodes();
+  }
+  if (prune_redundant_edges) {
+    graph.PruneRedundantEdges();
+  }
+  return graph;
+}
+
+void CompactDependencyGraph::Rebuild(const std::vector<int>& new_index,
+                                     const std::unordered_set<int64_t>& removed_edges) {
+  std::vector<Expr> exprs;
+  std::vector<int> child_offsets{0}, children, parent_offsets{0}, parents;
+  children.reserve(children_.size());
+  parents.reserve(parents_.size());
+  for (int i = 0; i < size(); ++i) {
+    if (new_index[i] < 0) {
+      continue;
+    }
+    for (int child : Children(i)) {
+      if (new_index[child] >= 0 && !removed_edges.count(EdgeKey(i, child))) {
+        children.push_back(new_index[child]);
+      }
+    }
+    for (int parent : Parents(i)) {
+      if (new_index[parent] >= 0 && !removed_edges.count(EdgeKey(parent, i))) {
+        parents.push_back(new_index[parent]);
+      }
+    }
+    child_offsets.push_back(static_cast<int>(children.size()));
+    parent_offsets.push_back(static_cast<int>(parents.size()));
+    exprs.push_back(exprs_[i]);
+  }
+  exprs_ = std::move(exprs);
+  child_offsets_ = std::move(child_offsets);
+  children_ = std::move(children);
+  parent_offsets_ = std::move(parent_offsets);
+  parents_ = std::move(parents);
+  expr_node_.clear();
+  for (int i = 0; i < size(); ++i) {
+    if (exprs_[i].defined()) {
+      expr_node_[exprs_[i].get()] = i;
+    }
+  }
+}
+
+void CompactDependencyGraph::RemoveEdges(const std::vector<std::pair<int, int>>& edges) {
+  std::vector<int> new_index(size());
+  std::iota(new_index.begin(), new_index.end(), 0);
+  std::unordered_set<int64_t> removed_edges;
+  for (const auto& edge : edges) {
+    removed_edges.insert(EdgeKey(edge.first, edge.second));
+  }
+  Rebuild(new_index, removed_edges);
+}
+
+void CompactDependencyGraph::RemoveNodes(const std::vector<bool>& removed) {
+  CHECK_EQ(removed.size(), static_cast<size_t>(size()));
+  std::vector<int> new_index(size(), -1);
+  int num_kept = 0;
+  for (int i = 0; i < size(); ++i) {
+    if (!removed[i]) {
+      new_index[i] = num_kept++;
+    }
+  }
+  Rebuild(new_index, {});
+}
+
+void CompactDependencyGraph::PruneAtomicNodes() {
+  // Same as DependencyGraphPruneAtomicNodes, each atomic node is pruned with all its successors.
+  std::vector<bool> removed(size(), false);
+  std::vector<int> stack;
+  for (int i = 0; i < size(); ++i) {
+    const Expr& e = exprs_[i];
+    bool atomic = !e.defined() || e->IsInstance<VarNode>() || e->IsInstance<GlobalVarNode>() ||
+                  e->IsInstance<RelayConstantNode>() || e->IsInstance<OpNode>() ||
+                  (e->IsInstance<FunctionNode>() &&
+                   e.as<FunctionNode>()->HasNonzeroAttr(attr::kPrimitive));
+    if (!atomic || removed[i]) {
+      continue;
+    }
+    removed[i] = true;
+    stack.push_back(i);
+    while (!stack.empty()) {
+      int node = stack.back();
+      stack.pop_back();
+      for (int child : Children(node)) {
+        if (!removed[child]) {
+          removed[child] = true;
+          stack.push_back(child);
+        }
+      }
+    }
+  }
+  RemoveNodes(removed);
+}
+
+void CompactDependencyGraph::PruneRedundantEdges() {
+  // Same as DependencyGraphPruneRedundantEdges, but the nodes reachable from each node through
+  // paths of at least two edges are kept in a bitset over the smaller node indices, and the bitset
+  // is released once all parents of the node have been visited. So the memory is bounded by the
+  // width of the graph instead of its size.
+  constexpr int kBits = 64;
+  std::vector<std::vector<uint64_t>> reachable(size());
+  std::vector<int> pending_parents(size());
+  for (int i = 0; i < size(); ++i) {
+    pending_parents[i] = static_cast<int>(Parents(i).size());
+  }
+  std::vector<std::pair<int, int>> edges2remove;
+  for (int i = 0; i < size(); ++i) {
+    auto& bits = reachable[i];
+    bits.assign((i + kBits - 1) / kBits, 0);
+    for (int child : Children(i)) {
+      const auto& child_bits = reachable[child];
+      for (size_t w = 0; w < child_bits.size(); ++w) {
+        bits[w] |= child_bits[w];
+      }
+    }
+    for (int child : Children(i)) {
+      if ((bits[child / kBits] >> (child % kBits)) & 1) {
+        // There is a path from node i to the child that does not go through the edge directly.
+        edges2remove.emplace_back(i, child);
+      }
+    }
+    for (int child : Children(i)) {
+      bits[child / kBits] |= uint64_t(1) << (child % kBits);
+    }
+    for (int child : Children(i)) {
+      if (--pending_parents[child] == 0) {
+        std::vector<uint64_t>().swap(reachable[child]);
+      }
+    }
+  }
+  if (!edges2remove.empty()) {
+    RemoveEdges(edges2remove);
+  }
+}
+
 /*!
  * \brief Get the nodes and edges of given relay expression's dependency graph
  * \param e The expr for which we want to get the dataflow graph
@@ -328,5 +502,19 @@ Map<String, ObjectRef> GetDependencyGraphNodesEdges(Expr e, bool prune_atomic_no
 RAF_REGISTER_GLOBAL("raf.analysis.GetDependencyGraphNodesEdges")
     .set_body_typed(GetDependencyGraphNodesEdges);
 
+RAF_REGISTER_GLOBAL("raf.analysis.GetCompactDependencyGraphNodesEdges")
+    .set_body_typed([](Expr e, bool prune_atomic_nodes, bool prune_redundant_edges) {
+      auto graph = CompactDependencyGraph::Create(e, prune_atomic_nodes, prune_redundant_edges);
+      Array<Expr> nodes;
+      Array<Array<Expr>> edges;
+      for (int node = 0; node < graph.size(); ++node) {
+        nodes.push_back(graph.GetExpr(node));
+        for (int child : graph.Children(node)) {
+          edges.push_back({graph.GetExpr(node), graph.GetExpr(child)});
+        }
+      }
+      return Map<String, ObjectRef>{{"nodes", nodes}, {"edges", edges}};
+    });
+
 }  // namespace analysis
 }  // namespace raf
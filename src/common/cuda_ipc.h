@@ -0,0 +1,83 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/common/cuda_ipc.h
+ * \brief Device buffers shared across processes with CUDA IPC handles, whose tensors are used by
+ * the other processes without being copied.
+ */
+#pragma once
+#include <cuda_runtime.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "raf/memory_pool.h"
+#include "./cuda_utils.h"
+
+namespace raf {
+namespace common {
+namespace cuda_ipc {
+
+/*!
+ * \brief A device buffer shared across processes. The exporting process allocates the buffer and
+ * owns it, and the importing processes open it from the handle, which is only valid as long as
+ * the buffer of the exporting process is alive.
+ */
+class IpcBuffer {
+ public:
+  /*! \brief Allocate a buffer of size bytes on the current device to export. */
+  explicit IpcBuffer(size_t size) : size(size), imported_(false) {
+    CUDA_CALL(cudaMalloc(&data, size));
+    CUDA_CALL(cudaIpcGetMemHandle(&handle, data));
+  }
+
+  /*! \brief Open the buffer exported by another process on the current device. */
+  IpcBuffer(const cudaIpcMemHandle_t& handle, size_t size)
+      : handle(handle), size(size), imported_(true) {
+    CUDA_CALL(cudaIpcOpenMemHandle(&data, handle, cudaIpcMemLazyEnablePeerAccess));
+  }
+
+  ~IpcBuffer() {
+    if (imported_) {
+      cudaIpcCloseMemHandle(data);
+    } else {
+      cudaFree(data);
+    }
+  }
+
+  /*! \brief The handle of the buffer. */
+  cudaIpcMemHandle_t handle;
+  /*! \brief The start address of the buffer in this process. */
+  void* data = nullptr;
+  /*! \brief The size of the buffer in bytes. */
+  size_t size;
+
+ private:
+  /*! \brief Whether the buffer is opened from another process. */
+  bool imported_;
+};
+
+/*!
+ * \brief The memory of a tensor in a shared buffer, which does not own the memory but keeps the
+ * buffer alive (or open) as long as the tensor is alive.
+ */
+class IpcMemory final : public memory_pool::Memory {
+ public:
+  IpcMemory(std::shared_ptr<IpcBuffer> buffer, void* ptr, const Device& dev)
+      : buffer_(std::move(buffer)) {
+    data = ptr;
+    device = dev;
+  }
+
+ private:
+  /*! \brief The buffer that holds the memory. */
+  std::shared_ptr<IpcBuffer> buffer_;
+};
+
+}  // namespace cuda_ipc
+}  // namespace common
+}  // namespace raf
@@ -11,7 +11,11 @@
 
 #include <cuda.h>
 #include <cuda_runtime.h>
+#include <cuda_bf16.h>
 #include <cuda_fp16.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include "raf/device.h"
 
@@ -35,7 +39,9 @@
   } while (false)
 
 template <typename T, int value,
-          typename std::enable_if<std::is_same<T, __half>::value, int>::type = 0>
+          typename std::enable_if<std::is_same<T, __half>::value ||
+                                      std::is_same<T, __nv_bfloat16>::value,
+                                  int>::type = 0>
 inline const void* const_typed_addr() {
   float tmp = static_cast<float>(value);
   static const T a = static_cast<T>(tmp);
@@ -43,7 +49,9 @@ inline const void* const_typed_addr() {
 }
 
 template <typename T, int value,
-          typename std::enable_if<!std::is_same<T, __half>::value, int>::type = 0>
+          typename std::enable_if<!std::is_same<T, __half>::value &&
+                                      !std::is_same<T, __nv_bfloat16>::value,
+                                  int>::type = 0>
 inline const void* const_typed_addr() {
   static const T a = static_cast<T>(value);
   return static_cast<const void*>(&a);
@@ -58,6 +66,8 @@ inline const void* const_addr(cudaDataType_t dt) {
       return const_typed_addr<uint8_t, value>();
     case CUDA_R_16F:
       return const_typed_addr<__half, value>();
+    case CUDA_R_16BF:
+      return const_typed_addr<__nv_bfloat16, value>();
     case CUDA_R_32F:
       return const_typed_addr<float, value>();
     case CUDA_R_64F:
@@ -83,6 +93,8 @@ inline std::shared_ptr<void> shared_addr(cudaDataType_t dt, float value) {
       return shared_typed_addr<uint8_t>(value);
     case CUDA_R_16F:
       return shared_typed_addr<__half>(value);
+    case CUDA_R_16BF:
+      return shared_typed_addr<__nv_bfloat16>(value);
     case CUDA_R_32F:
       return shared_typed_addr<float>(value);
     case CUDA_R_64F:
@@ -110,10 +122,41 @@ inline DType::operator cudaDataType_t() const {
       if (bits == 16) return CUDA_R_16F;
       if (bits == 32) return CUDA_R_32F;
       if (bits == 64) return CUDA_R_64F;
+      break;
+    case kDLBfloat:
+      if (bits == 16) return CUDA_R_16BF;
+      break;
     default:
-      LOG(FATAL) << "NotImplementedError: " << c_str();
+      break;
   }
+  LOG(FATAL) << "NotImplementedError: " << c_str();
   throw;
 }
 
+/*!
+ * \brief The fingerprint of the current CUDA device and software stack for keying tuning
+ * results, e.g., "sm_80/NVIDIA A100-SXM4-40GB/driver_11040/cuda_11030".
+ */
+inline std::string GetCUDADeviceFingerprint() {
+  static std::unordered_map<int, std::string> fingerprints;
+  static std::mutex mu;
+  int device;
+  CUDA_CALL(cudaGetDevice(&device));
+  std::lock_guard<std::mutex> lock(mu);
+  auto it = fingerprints.find(device);
+  if (it != fingerprints.end()) {
+    return it->second;
+  }
+  cudaDeviceProp prop;
+  int driver_version, runtime_version;
+  CUDA_CALL(cudaGetDeviceProperties(&prop, device));
+  CUDA_CALL(cudaDriverGetVersion(&driver_version));
+  CUDA_CALL(cudaRuntimeGetVersion(&runtime_version));
+  std::string fingerprint = "sm_" + std::to_string(prop.major * 10 + prop.minor) + "/" +
+                            prop.name + "/driver_" + std::to_string(driver_version) + "/cuda_" +
+                            std::to_string(runtime_version);
+  fingerprints.emplace(device, fingerprint);
+  return fingerprint;
+}
+
 }  // namespace raf
@@ -0,0 +1,79 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/common/mapped_file.h
+ * \brief Files mapped into the host memory, whose tensors are used without being copied.
+ */
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "raf/memory_pool.h"
+
+namespace raf {
+namespace common {
+namespace mapped_file {
+
+/*! \brief A file that is mapped into the host memory. */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    CHECK_GE(fd, 0) << "Cannot open " << path << ": " << strerror(errno);
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "Cannot stat " << path << ": " << strerror(errno);
+    size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+      close(fd);
+      return;
+    }
+    // The pages are private and copy-on-write, so the untouched pages are shared with the page
+    // cache, and the file is never modified even if a kernel writes to a mapped tensor.
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    CHECK(ptr != MAP_FAILED) << "Cannot map " << path << ": " << strerror(errno);
+    data = static_cast<char*>(ptr);
+  }
+
+  ~MappedFile() {
+    if (data != nullptr) {
+      munmap(data, size);
+    }
+  }
+
+  /*! \brief The start address of the mapping. */
+  char* data = nullptr;
+  /*! \brief The size of the mapping in bytes. */
+  size_t size = 0;
+};
+
+/*!
+ * \brief The memory of a tensor that stays in a mapped file, which keeps the file mapped as long
+ * as the tensor is alive.
+ */
+class MappedMemory final : public memory_pool::Memory {
+ public:
+  MappedMemory(std::shared_ptr<MappedFile> file, void* ptr) : file_(std::move(file)) {
+    data = ptr;
+    device = Device(DevType::kCPU(), 0);
+  }
+
+ private:
+  /*! \brief The mapped file that holds the memory. */
+  std::shared_ptr<MappedFile> file_;
+};
+
+}  // namespace mapped_file
+}  // namespace common
+}  // namespace raf
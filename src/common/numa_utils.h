@@ -0,0 +1,201 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/common/numa_utils.h
+ * \brief The NUMA topology of the host, and the binding of the memory and the threads to the NUMA
+ * nodes. The topology is read from sysfs and the binding is done by the raw system calls, so that
+ * no extra library is needed. On the hosts without NUMA, there is a single node and the binding is
+ * a no-op.
+ */
+#pragma once
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace raf {
+namespace common {
+namespace numa_utils {
+
+/*! \brief The NUMA topology of the host. */
+struct Topology {
+  /*! \brief The CPUs of each node. */
+  std::vector<std::vector<int>> node_cpus;
+  /*! \brief The node of each CPU. */
+  std::vector<int> cpu_node;
+};
+
+/*!
+ * \brief Parse a list of the sysfs format, e.g., "0-3,8-11".
+ * \param list The list.
+ * \return The indices in the list.
+ */
+inline std::vector<int> ParseList(const std::string& list) {
+  std::vector<int> ret;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") {
+      continue;
+    }
+    size_t dash = range.find('-');
+    int begin = std::stoi(range.substr(0, dash));
+    int end = dash == std::string::npos ? begin : std::stoi(range.substr(dash + 1));
+    for (int i = begin; i <= end; ++i) {
+      ret.push_back(i);
+    }
+  }
+  return ret;
+}
+
+/*!
+ * \brief Get the NUMA topology of the host, which is read once.
+ * \return The topology.
+ */
+inline const Topology& GetTopology() {
+  static Topology topology = []() {
+    Topology topo;
+    std::string list;
+#ifdef __linux__
+    std::ifstream online("/sys/devices/system/node/online");
+    std::getline(online, list);
+#endif
+    for (int node : list.empty() ? std::vector<int>{} : ParseList(list)) {
+      std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+      std::string cpus;
+      std::getline(cpulist, cpus);
+      if (topo.node_cpus.size() <= static_cast<size_t>(node)) {
+        topo.node_cpus.resize(node + 1);
+      }
+      topo.node_cpus[node] = ParseList(cpus);
+      for (int cpu : topo.node_cpus[node]) {
+        if (topo.cpu_node.size() <= static_cast<size_t>(cpu)) {
+          topo.cpu_node.resize(cpu + 1, 0);
+        }
+        topo.cpu_node[cpu] = node;
+      }
+    }
+    if (topo.node_cpus.empty()) {
+      // No NUMA information, so all the CPUs are on node 0.
+      topo.node_cpus.resize(1);
+    }
+    return topo;
+  }();
+  return topology;
+}
+
+/*! \brief The number of NUMA nodes of the host. */
+inline int NumNodes() {
+  return static_cast<int>(GetTopology().node_cpus.size());
+}
+
+/*! \brief The NUMA node of the CPU that the calling thread is running on. */
+inline int CurrentNode() {
+#ifdef __linux__
+  const auto& topo = GetTopology();
+  int cpu = sched_getcpu();
+  if (cpu >= 0 && static_cast<size_t>(cpu) < topo.cpu_node.size()) {
+    return topo.cpu_node[cpu];
+  }
+#endif
+  return 0;
+}
+
+/*!
+ * \brief Check whether an environment variable is set to a non-zero value.
+ * \param name The name of the environment variable.
+ * \return Whether it is enabled.
+ */
+inline bool EnvEnabled(const char* name) {
+  const char* val = getenv(name);
+  return val != nullptr && std::string(val) != "0" && std::string(val) != "";
+}
+
+/*!
+ * \brief Whether the CPU allocations are bound to the node of the allocating thread, which is
+ * enabled by the environment variable RAF_CPU_NUMA_BIND on the hosts with multiple nodes.
+ */
+inline bool BindEnabled() {
+  static bool enabled = NumNodes() > 1 && EnvEnabled("RAF_CPU_NUMA_BIND");
+  return enabled;
+}
+
+/*!
+ * \brief Whether the constants of the executables are replicated to each node that runs them,
+ * which is enabled by the environment variable RAF_CPU_NUMA_REPLICATE on the hosts with multiple
+ * nodes.
+ */
+inline bool ReplicateEnabled() {
+  static bool enabled = NumNodes() > 1 && EnvEnabled("RAF_CPU_NUMA_REPLICATE");
+  return enabled;
+}
+
+/*!
+ * \brief Whether the CPU worker threads are pinned to the nodes, which is enabled by the
+ * environment variable RAF_CPU_NUMA_PIN on the hosts with multiple nodes.
+ */
+inline bool PinEnabled() {
+  static bool enabled = NumNodes() > 1 && EnvEnabled("RAF_CPU_NUMA_PIN");
+  return enabled;
+}
+
+/*!
+ * \brief Prefer the pages of a memory range on a node. The pages that are already touched are
+ * moved to the node. Other nodes are still used when the node runs out of memory.
+ * \param ptr The start of the range, which should be aligned to the page size.
+ * \param nbytes The size of the range in bytes.
+ * \param node The node.
+ * \return Whether the binding succeeds.
+ */
+inline bool BindMemory(void* ptr, size_t nbytes, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+  // The constants from <numaif.h>, which is not included to avoid depending on libnuma.
+  constexpr int kMpolPreferred = 1;
+  constexpr unsigned kMpolMfMove = 1 << 1;
+  if (node < 0 || node >= 64 || nbytes == 0) {
+    return false;
+  }
+  uint64_t mask = uint64_t(1) << node;
+  return syscall(SYS_mbind, ptr, nbytes, kMpolPreferred, &mask, 64, kMpolMfMove) == 0;
+#else
+  return false;
+#endif
+}
+
+/*!
+ * \brief Pin the calling thread to the CPUs of a node.
+ * \param node The node.
+ * \return Whether the pinning succeeds.
+ */
+inline bool PinThreadToNode(int node) {
+#ifdef __linux__
+  const auto& topo = GetTopology();
+  if (node < 0 || node >= NumNodes() || topo.node_cpus[node].empty()) {
+    return false;
+  }
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (int cpu : topo.node_cpus[node]) {
+    CPU_SET(cpu, &cpuset);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+  return false;
+#endif
+}
+
+}  // namespace numa_utils
+}  // namespace common
+}  // namespace raf
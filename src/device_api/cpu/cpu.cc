@@ -7,14 +7,19 @@
  * \file src/device_api/cpu/cpu.cc
  * \brief CPU device API
  */
+#include <algorithm>
 #include <thread>
 #include "raf/device_api.h"
 #include "raf/registry.h"
+#include "../../common/numa_utils.h"
 
 namespace raf {
 namespace device_api {
 namespace cpu {
 
+/*! \brief The page size, which is the granularity of the NUMA binding. */
+constexpr int64_t kNumaPageSize = 4096;
+
 class CPUDeviceAPI final : public DeviceAPI {
  public:
   CPUDeviceAPI() = default;
@@ -35,10 +40,21 @@ class CPUDeviceAPI final : public DeviceAPI {
       throw std::bad_alloc();
     }
 #else
+    bool bind = common::numa_utils::BindEnabled() && nbytes >= kNumaPageSize;
+    if (bind) {
+      // The binding works on whole pages.
+      alignment = std::max(alignment, kNumaPageSize);
+    }
     int ret = posix_memalign(&ptr, alignment, nbytes);
     if (ret != 0) {
       throw std::bad_alloc();
     }
+    if (bind) {
+      // Place the pages on the node of the allocating thread, which is the node that runs the
+      // kernels on the memory when the threads are pinned, instead of the node that first touches
+      // the pages, e.g., the loader thread of the weights.
+      common::numa_utils::BindMemory(ptr, nbytes, common::numa_utils::CurrentNode());
+    }
 #endif
     return ptr;
   }
@@ -71,7 +87,7 @@ class CPUDeviceAPI final : public DeviceAPI {
     memcpy(to_data_ptr, from_data_ptr, nbytes);
   }
 
-  void* CreateStream(const Device&) override {
+  void* CreateStream(const Device&, int) override {
     throw;
   }
 
@@ -119,6 +135,10 @@ class CPUDeviceAPI final : public DeviceAPI {
     throw;
   }
 
+  bool QueryEvent(void* event) override {
+    throw;
+  }
+
   void SetDevice(const int device_id) override {
     throw;
   }
@@ -129,6 +149,10 @@ class CPUDeviceAPI final : public DeviceAPI {
 };
 
 RAF_REGISTER_GLOBAL("raf.device_api._make.cpu").set_body_typed(CPUDeviceAPI::make);
+RAF_REGISTER_GLOBAL("raf.numa.NumNodes").set_body_typed(common::numa_utils::NumNodes);
+RAF_REGISTER_GLOBAL("raf.numa.CurrentNode").set_body_typed(common::numa_utils::CurrentNode);
+RAF_REGISTER_GLOBAL("raf.numa.PinThreadToNode")
+    .set_body_typed(common::numa_utils::PinThreadToNode);
 
 }  // namespace cpu
 }  // namespace device_api
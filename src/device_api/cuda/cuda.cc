@@ -7,6 +7,10 @@
  * \file src/device_api/cuda/cuda.cc
  * \brief CUDA device API
  */
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include <utility>
 #include <tvm/runtime/device_api.h>
 #include "raf/op.h"
 #include "raf/device_api.h"
@@ -133,8 +137,9 @@ class CUDADeviceAPI final : public DeviceAPI {
       if (from->device.device_id == to->device.device_id) {
         HandleCopy(from_data_ptr, to_data_ptr, nbytes, cudaMemcpyDeviceToDevice, cu_stream);
       } else {
-        cudaMemcpyPeerAsync(to_data_ptr, to->device.device_id, from_data_ptr,
-                            from->device.device_id, nbytes, cu_stream);
+        EnablePeerAccess(from->device.device_id, to->device.device_id);
+        CUDA_CALL(cudaMemcpyPeerAsync(to_data_ptr, to->device.device_id, from_data_ptr,
+                                      from->device.device_id, nbytes, cu_stream));
       }
     } else if (from_dev_type == kDLCUDA && to_dev_type == kDLCPU) {
       // GPU to CPU.
@@ -151,11 +156,19 @@ class CUDADeviceAPI final : public DeviceAPI {
     SetDevice(curr_device_id);
   }
 
-  void* CreateStream(const Device& dev) override {
+  void* CreateStream(const Device& dev, int priority) override {
     CHECK_EQ(dev.device_type(), DevType::kCUDA());
     CUDA_CALL(cudaSetDevice(dev.device_id()));
     cudaStream_t ret = nullptr;
-    CUDA_CALL(cudaStreamCreate(&ret));
+    if (priority == 0) {
+      CUDA_CALL(cudaStreamCreate(&ret));
+      return ret;
+    }
+    // CUDA uses lower numbers for higher priorities, starting from the least priority (0).
+    int least, greatest;
+    CUDA_CALL(cudaDeviceGetStreamPriorityRange(&least, &greatest));
+    int cuda_priority = std::min(std::max(least - priority, greatest), least);
+    CUDA_CALL(cudaStreamCreateWithPriority(&ret, cudaStreamDefault, cuda_priority));
     return ret;
   }
 
@@ -224,11 +237,49 @@ class CUDADeviceAPI final : public DeviceAPI {
     CUDA_CALL(cudaEventSynchronize(static_cast<cudaEvent_t>(event)));
   }
 
+  bool QueryEvent(void* event) override {
+    CHECK(event != nullptr) << "Cannot query a null event";
+    cudaError_t err = cudaEventQuery(static_cast<cudaEvent_t>(event));
+    if (err == cudaErrorNotReady) {
+      return false;
+    }
+    CUDA_CALL(err);
+    return true;
+  }
+
   static void* make() {
     return new CUDADeviceAPI();
   }
 
  private:
+  /*!
+   * \brief Enable the access of a GPU to the memory of its peer on the first copy between them, if
+   * the topology allows, e.g., they are connected by NVLink or under the same PCIe switch. Then
+   * the peer copies go directly between them, instead of being staged through the host by the
+   * driver. Note that the GPU of from_id must be the current device.
+   */
+  static void EnablePeerAccess(int from_id, int to_id) {
+    static std::mutex mu;
+    static std::set<std::pair<int, int>> visited;
+    std::lock_guard<std::mutex> lock(mu);
+    if (!visited.emplace(from_id, to_id).second) {
+      return;
+    }
+    int can_access = 0;
+    CUDA_CALL(cudaDeviceCanAccessPeer(&can_access, from_id, to_id));
+    if (!can_access) {
+      DLOG(INFO) << "GPU " << from_id << " cannot access GPU " << to_id << " as a peer";
+      return;
+    }
+    cudaError_t err = cudaDeviceEnablePeerAccess(to_id, 0);
+    if (err == cudaErrorPeerAccessAlreadyEnabled) {
+      // Enabled elsewhere in the process, e.g., by another library. Clear the sticky error.
+      cudaGetLastError();
+      return;
+    }
+    CUDA_CALL(err);
+  }
+
   static void HandleCopy(const void* from, void* to, size_t size, cudaMemcpyKind kind,
                          cudaStream_t cu_stream) {
     if (cu_stream != nullptr) {
@@ -241,10 +292,13 @@ class CUDADeviceAPI final : public DeviceAPI {
   }
 
   int device_id_;
-  // using cuda default stream if stream is not set explicitly
-  void* stream_ = nullptr;
+  // using cuda default stream if stream is not set explicitly. The stream is thread local, so that
+  // the threads can launch kernels to their own streams concurrently.
+  static thread_local void* stream_;
 };
 
+thread_local void* CUDADeviceAPI::stream_ = nullptr;
+
 RAF_REGISTER_GLOBAL("raf.device_api._make.cuda").set_body_typed(CUDADeviceAPI::make);
 
 }  // namespace cuda
@@ -56,7 +56,7 @@ class CUDAHostDeviceAPI final : public DeviceAPI {
     throw;
   }
 
-  void* CreateStream(const Device& dev) override {
+  void* CreateStream(const Device& dev, int priority) override {
     throw;
   }
 
@@ -104,6 +104,10 @@ class CUDAHostDeviceAPI final : public DeviceAPI {
     throw;
   }
 
+  bool QueryEvent(void* event) override {
+    throw;
+  }
+
   static void* make() {
     return new CUDAHostDeviceAPI();
   }
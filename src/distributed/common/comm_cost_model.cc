@@ -0,0 +1,265 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/distributed/common/comm_cost_model.cc
+ * \brief The calibrated latency model of the collective communication ops.
+ */
+#include <dmlc/memory_io.h>
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <vector>
+#include "raf/cache.h"
+#include "raf/comm_cost_model.h"
+#include "raf/communicator.h"
+#include "raf/dialect.h"
+#include "raf/dist_config.h"
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/registry.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
+
+namespace raf {
+namespace distributed {
+
+using namespace raf::ir;
+using namespace raf::value;
+using communicator::GetGlobalCommunicator;
+
+/*! \brief The persisted costs of a topology. */
+class CommCostCacheEntry {
+ public:
+  explicit CommCostCacheEntry(std::unordered_map<std::string, CommCost> costs)
+      : costs_(std::move(costs)) {
+  }
+
+  const std::unordered_map<std::string, CommCost>& Value() const {
+    return costs_;
+  }
+
+  static CommCostCacheEntry Load(const std::string& path) {
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/value.bin", &data);
+    dmlc::MemoryStringStream reader(&data);
+    dmlc::Stream* stream = &reader;
+    std::vector<std::string> keys;
+    std::vector<double> params;
+    CHECK(stream->Read(&keys) && stream->Read(&params) && params.size() == keys.size() * 2)
+        << "Corrupted communication cost model at " << path;
+    std::unordered_map<std::string, CommCost> costs;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      costs[keys[i]] = {params[i * 2], params[i * 2 + 1]};
+    }
+    return CommCostCacheEntry(std::move(costs));
+  }
+
+  bool Save(const std::string& path) {
+    std::vector<std::string> keys;
+    std::vector<double> params;
+    for (const auto& kv : costs_) {
+      keys.push_back(kv.first);
+      params.push_back(kv.second.alpha_us);
+      params.push_back(kv.second.beta_us_per_byte);
+    }
+    std::string data;
+    dmlc::MemoryStringStream writer(&data);
+    dmlc::SeekStream* stream = &writer;
+    stream->Write(keys);
+    stream->Write(params);
+    tvm::runtime::SaveBinaryToFile(path + "/value.bin", data);
+    return true;
+  }
+
+ private:
+  std::unordered_map<std::string, CommCost> costs_;
+};
+
+MetaPersistCache<CommCostCacheEntry> CacheCommCost("comm_cost_model");
+
+/*! \brief The bytes of the tensors in a type, where the other types take no bytes. */
+int64_t TensorBytes(const Type& type) {
+  if (const auto* tuple_type = type.as<TupleTypeNode>()) {
+    int64_t bytes = 0;
+    for (const auto& field : tuple_type->fields) {
+      bytes += TensorBytes(field);
+    }
+    return bytes;
+  } else if (const auto* tensor_type = type.as<TensorTypeNode>()) {
+    int64_t bytes = (tensor_type->dtype.bits() * tensor_type->dtype.lanes() + 7) / 8;
+    for (const auto& dim : tensor_type->shape) {
+      const auto* dim_imm = dim.as<IntImmNode>();
+      if (dim_imm == nullptr) {
+        return 0;
+      }
+      bytes *= dim_imm->value;
+    }
+    return bytes;
+  }
+  return 0;
+}
+
+std::string CostKey(const std::string& op_name, const std::string& scope) {
+  return op_name + "@" + scope;
+}
+
+CommCostModel* CommCostModel::Get() {
+  static CommCostModel* inst = new CommCostModel();
+  return inst;
+}
+
+void CommCostModel::Set(const std::string& op_name, const std::string& scope,
+                        const CommCost& cost) {
+  std::lock_guard<std::mutex> lock(mu_);
+  costs_[CostKey(op_name, scope)] = cost;
+}
+
+bool CommCostModel::Find(const std::string& op_name, const std::string& scope, CommCost* cost) {
+  if (!loaded_) {
+    Load();
+  }
+  std::lock_guard<std::mutex> lock(mu_);
+  auto it = costs_.find(CostKey(op_name, scope));
+  if (it == costs_.end()) {
+    return false;
+  }
+  *cost = it->second;
+  return true;
+}
+
+double CommCostModel::Estimate(const std::string& op_name, const std::string& scope,
+                               double bytes) {
+  CommCost cost;
+  if (!Find(op_name, scope, &cost)) {
+    return -1;
+  }
+  return cost.alpha_us + cost.beta_us_per_byte * bytes;
+}
+
+double CommCostModel::Estimate(const Call& call) {
+  static auto fschema_index = Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+  if (!op::IsCollectiveOp(call->op)) {
+    return -1;
+  }
+  auto op = Downcast<Op>(call->op);
+  if (op::IsDialectOp(op)) {
+    op = op::GetBaseOp(op);
+  }
+  Value rank_list;
+  int index = fschema_index.count(op) ? fschema_index[op]("rank_list") : -1;
+  if (index >= 0 && index < static_cast<int>(call->args.size())) {
+    if (const auto* node = call->args[index].as<ConstantNode>()) {
+      rank_list = Downcast<Value>(ConstantExtractValue(GetRef<Constant>(node)));
+    }
+  }
+  int64_t in_bytes = 0;
+  for (const auto& arg : call->args) {
+    if (!arg->IsInstance<ConstantNode>() && arg->checked_type_.defined()) {
+      in_bytes += TensorBytes(arg->checked_type());
+    }
+  }
+  int64_t out_bytes = call->checked_type_.defined() ? TensorBytes(call->checked_type()) : 0;
+  return Estimate(op->name, GetScope(rank_list), std::max(in_bytes, out_bytes));
+}
+
+std::string CommCostModel::GetScope(const Value& rank_list) {
+  const auto* tuple = rank_list.as<TupleValueObj>();
+  if (tuple == nullptr || tuple->fields.empty()) {
+    return "global";
+  }
+  int64_t local_size = std::max(GetGlobalCommunicator()->local_size, 1);
+  bool intra = true, inter = true;
+  for (const auto& group : tuple->fields) {
+    std::set<int64_t> nodes;
+    const auto& ranks = Downcast<TupleValue>(group)->fields;
+    for (const auto& rank : ranks) {
+      nodes.insert(Downcast<IntValue>(rank)->value / local_size);
+    }
+    intra = intra && nodes.size() <= 1;
+    inter = inter && nodes.size() == ranks.size();
+  }
+  // A group of a single rank is both; it communicates nothing across the nodes.
+  return intra ? "intra" : (inter ? "inter" : "global");
+}
+
+std::string CommCostModel::TopologyKey() {
+  auto comm = GetGlobalCommunicator();
+  std::ostringstream os;
+  os << "size=" << comm->size << ";local_size=" << comm->local_size
+     << ";hierarchical=" << DistConfig::Global()->enable_hierarchical_allreduce;
+  return os.str();
+}
+
+bool CommCostModel::Save() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (costs_.empty()) {
+    return false;
+  }
+  CacheCommCost.Set(TopologyKey(), CommCostCacheEntry(costs_));
+  return true;
+}
+
+bool CommCostModel::Load() {
+  auto entry = CacheCommCost.Get(TopologyKey());
+  std::lock_guard<std::mutex> lock(mu_);
+  loaded_ = true;
+  if (entry == nullptr) {
+    return false;
+  }
+  for (const auto& kv : entry->Value()) {
+    // The costs set in this process take precedence.
+    costs_.insert(kv);
+  }
+  return true;
+}
+
+void CommCostModel::Clear() {
+  std::lock_guard<std::mutex> lock(mu_);
+  costs_.clear();
+  loaded_ = true;
+}
+
+std::unordered_map<std::string, CommCost> CommCostModel::GetAll() {
+  std::lock_guard<std::mutex> lock(mu_);
+  return costs_;
+}
+
+RAF_REGISTER_GLOBAL("raf.distributed.SetCommCost")
+    .set_body_typed([](String op_name, String scope, double alpha_us, double beta_us_per_byte) {
+      CHECK(scope == "intra" || scope == "inter" || scope == "global")
+          << "Unknown communicator scope " << scope << ", expected intra, inter or global";
+      CHECK_GE(alpha_us, 0) << "The latency must be non-negative";
+      CHECK_GE(beta_us_per_byte, 0) << "The inverse bandwidth must be non-negative";
+      CommCostModel::Get()->Set(op_name, scope, {alpha_us, beta_us_per_byte});
+    });
+
+RAF_REGISTER_GLOBAL("raf.distributed.GetCommCost").set_body_typed([]() {
+  Map<String, Array<FloatImm>> ret;
+  for (const auto& kv : CommCostModel::Get()->GetAll()) {
+    ret.Set(kv.first, {FloatImm(DataType::Float(64), kv.second.alpha_us),
+                       FloatImm(DataType::Float(64), kv.second.beta_us_per_byte)});
+  }
+  return ret;
+});
+
+RAF_REGISTER_GLOBAL("raf.distributed.EstimateCommLatency")
+    .set_body_typed([](String op_name, String scope, double bytes) {
+      return CommCostModel::Get()->Estimate(op_name, scope, bytes);
+    });
+
+RAF_REGISTER_GLOBAL("raf.distributed.SaveCommCostModel").set_body_typed([]() {
+  return CommCostModel::Get()->Save();
+});
+
+RAF_REGISTER_GLOBAL("raf.distributed.LoadCommCostModel").set_body_typed([]() {
+  return CommCostModel::Get()->Load();
+});
+
+RAF_REGISTER_GLOBAL("raf.distributed.ClearCommCostModel").set_body_typed([]() {
+  CommCostModel::Get()->Clear();
+});
+
+}  // namespace distributed
+}  // namespace raf
@@ -9,13 +9,15 @@
  */
 
 #include "raf/communicator.h"
+#include "raf/ir_ext.h"
+#include "raf/op.h"
 
 namespace raf {
 namespace distributed {
 namespace communicator {
 
-Communicator Communicator::Get(const std::string& name, const Value rank_list) {
-  return CommunicatorPool::Get()->GetCommunicator(name, rank_list);
+Communicator Communicator::Get(const std::string& name, const Value rank_list, int lane) {
+  return CommunicatorPool::Get()->GetCommunicator(name, rank_list, lane);
 }
 
 void Communicator::InitSubCommunicator(CommunicatorObj* sub_comm, const Value rank_list,
@@ -83,6 +85,98 @@ void Communicator::InitSubCommunicator(CommunicatorObj* sub_comm, const Value ra
   }
 }
 
+namespace {
+/*! \brief Whether the current thread is creating the communicators in the background. */
+thread_local bool in_warm_up = false;
+}  // namespace
+
+void CommunicatorPool::WarmUp(const std::string& name, const ir::Array<Value>& rank_lists,
+                              bool async) {
+  WaitWarmUp();
+  // The sub-communicators are made with the global one, so it is created by the caller thread.
+  GetCommunicator(name, NullValue<Value>());
+  auto task = [this, name, rank_lists]() {
+    // A backend may create a batch of communicators at once, e.g., NCCL groups their init.
+    const auto* fwarm_up = registry::Registry::Get("raf.distributed.communicator._warm_up." + name);
+    if (fwarm_up != nullptr) {
+      (*fwarm_up)(rank_lists);
+    } else {
+      for (const auto& rank_list : rank_lists) {
+        GetCommunicator(name, rank_list);
+      }
+    }
+  };
+  if (!async) {
+    task();
+    return;
+  }
+  std::lock_guard<std::mutex> lock(warm_up_mutex_);
+  warm_up_ = std::async(std::launch::async, [task]() {
+    in_warm_up = true;
+    task();
+  });
+}
+
+void CommunicatorPool::WaitWarmUp() {
+  if (in_warm_up) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(warm_up_mutex_);
+  if (warm_up_.valid()) {
+    // Rethrow the error raised in the background, if any.
+    warm_up_.get();
+  }
+}
+
+/*!
+ * \brief Collect the distinct rank lists of the collective ops in a module. The result is sorted,
+ * so all ranks create the communicators in the same order regardless of the function order.
+ */
+ir::Array<Value> CollectRankLists(const ir::IRModule& mod) {
+  class RankListCollector : public ir::ExprVisitor {
+   public:
+    void VisitExpr_(const ir::CallNode* call) final {
+      static auto fschema_index =
+          ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+      if (op::IsCollectiveOp(call->op)) {
+        auto op_ref = ir::Downcast<ir::Op>(call->op);
+        int index = fschema_index.count(op_ref) ? fschema_index[op_ref]("rank_list") : -1;
+        if (index >= 0 && index < static_cast<int>(call->args.size())) {
+          if (const auto* node = call->args[index].as<ir::ConstantNode>()) {
+            auto value = Downcast<Value>(ir::ConstantExtractValue(ir::GetRef<ir::Constant>(node)));
+            if (value.defined() && value->IsInstance<TupleValueObj>()) {
+              auto rank_list = Downcast<TupleValue>(value);
+              std::vector<std::vector<int64_t>> key;
+              for (const auto& group : rank_list->fields) {
+                key.emplace_back();
+                for (const auto& rank : Downcast<TupleValue>(group)->fields) {
+                  key.back().push_back(Downcast<IntValue>(rank)->value);
+                }
+              }
+              rank_lists.emplace(key, rank_list);
+            }
+          }
+        }
+      }
+      ir::ExprVisitor::VisitExpr_(call);
+    }
+
+    std::map<std::vector<std::vector<int64_t>>, Value> rank_lists;
+  };
+
+  RankListCollector collector;
+  for (const auto& kv : mod->functions) {
+    if (kv.second->IsInstance<ir::FunctionNode>()) {
+      collector(kv.second);
+    }
+  }
+  ir::Array<Value> ret;
+  for (const auto& kv : collector.rank_lists) {
+    ret.push_back(kv.second);
+  }
+  return ret;
+}
+
 uint64_t Communicator::GetHostID() {
   // Prevent confusion if all the nodes share the same hostname
   auto hostid = std::to_string(gethostid());
@@ -180,6 +274,14 @@ RAF_REGISTER_GLOBAL("raf.distributed.RemoveCommunicator").set_body_typed([]() {
   CommunicatorPool::Get()->Remove();
 });
 
+RAF_REGISTER_GLOBAL("raf.distributed.CollectRankLists").set_body_typed(CollectRankLists);
+RAF_REGISTER_GLOBAL("raf.distributed.WarmUpCommunicators")
+    .set_body_typed([](std::string name, ir::Array<Value> rank_lists, bool async) {
+      CommunicatorPool::Get()->WarmUp(name, rank_lists, async);
+    });
+RAF_REGISTER_GLOBAL("raf.distributed.WaitCommunicators").set_body_typed([]() {
+  CommunicatorPool::Get()->WaitWarmUp();
+});
 RAF_REGISTER_GLOBAL("raf.distributed.GetGlobalCommunicator").set_body_typed(GetGlobalCommunicator);
 RAF_REGISTER_GLOBAL("raf.distributed.SetDefaultCommunicator")
     .set_body_typed(SetDefaultCommunicator);
@@ -10,6 +10,7 @@
 #include "raf/registry.h"
 #include "raf/communicator.h"
 #include "raf/dist_config.h"
+#include "raf/stream_pool.h"
 
 namespace raf {
 namespace distributed {
@@ -47,6 +48,49 @@ void AutoDPProfilingEndIter(int auto_dp_profiling_end_iter) {
   DistConfig::Global()->auto_dp_profiling_end_iter = auto_dp_profiling_end_iter;
 }
 
+void GradientCompression(std::string dtype) {
+  CHECK(dtype == "none" || dtype == "float16" || dtype == "bfloat16")
+      << "Unsupported gradient compression: " << dtype
+      << ". Expected one of \"none\", \"float16\", and \"bfloat16\"";
+  DistConfig::Global()->gradient_compression = dtype;
+}
+
+void EnableHierarchicalAllreduce(bool enable) {
+  DistConfig::Global()->enable_hierarchical_allreduce = enable;
+}
+
+void EnableAllreduceBucketing(bool enable) {
+  DistConfig::Global()->enable_allreduce_bucketing = enable;
+}
+
+void ZeroDeferAllgather(bool enable) {
+  DistConfig::Global()->zero_defer_allgather = enable;
+}
+
+void EnableGroupCollectives(bool enable) {
+  DistConfig::Global()->enable_group_collectives = enable;
+}
+
+void ZeroOffload(bool enable) {
+  DistConfig::Global()->zero_offload = enable;
+}
+
+void ZeroFlatBuffer(bool enable) {
+  DistConfig::Global()->zero_flat_buffer = enable;
+}
+
+void NumCommStreams(int num) {
+  CHECK(num >= 1 && num <= stream_pool::kMaxCommStreams)
+      << "The number of communication streams must be in [1, " << stream_pool::kMaxCommStreams
+      << "], but got " << num;
+  DistConfig::Global()->num_comm_streams = num;
+}
+
+void GroupBucketSize(int64_t size) {
+  CHECK_GT(size, 0) << "The bucket size must be positive";
+  DistConfig::Global()->group_bucket_size = size;
+}
+
 RAF_REGISTER_GLOBAL("raf.distributed.GlobalDistConfig").set_body_typed(DistConfig::Global);
 RAF_REGISTER_GLOBAL("raf.distributed.EnableDataParallel").set_body_typed(EnableDataParallel);
 RAF_REGISTER_GLOBAL("raf.distributed.ZeroOpt").set_body_typed(ZeroOpt);
@@ -55,6 +99,18 @@ RAF_REGISTER_GLOBAL("raf.distributed.AutoDPProfilingStartIter")
     .set_body_typed(AutoDPProfilingStartIter);
 RAF_REGISTER_GLOBAL("raf.distributed.AutoDPProfilingEndIter")
     .set_body_typed(AutoDPProfilingEndIter);
+RAF_REGISTER_GLOBAL("raf.distributed.GradientCompression").set_body_typed(GradientCompression);
+RAF_REGISTER_GLOBAL("raf.distributed.EnableHierarchicalAllreduce")
+    .set_body_typed(EnableHierarchicalAllreduce);
+RAF_REGISTER_GLOBAL("raf.distributed.EnableAllreduceBucketing")
+    .set_body_typed(EnableAllreduceBucketing);
+RAF_REGISTER_GLOBAL("raf.distributed.ZeroDeferAllgather").set_body_typed(ZeroDeferAllgather);
+RAF_REGISTER_GLOBAL("raf.distributed.EnableGroupCollectives")
+    .set_body_typed(EnableGroupCollectives);
+RAF_REGISTER_GLOBAL("raf.distributed.ZeroOffload").set_body_typed(ZeroOffload);
+RAF_REGISTER_GLOBAL("raf.distributed.ZeroFlatBuffer").set_body_typed(ZeroFlatBuffer);
+RAF_REGISTER_GLOBAL("raf.distributed.GroupBucketSize").set_body_typed(GroupBucketSize);
+RAF_REGISTER_GLOBAL("raf.distributed.NumCommStreams").set_body_typed(NumCommStreams);
 
 RAF_REGISTER_OBJECT_REFLECT(DistConfigObj);
 
@@ -19,8 +19,18 @@ namespace communicator {
 
 #define NCCL_UNIQUE_ID_BYTES 128
 
+/*!
+ * \brief Sync the NCCL unique IDs through the file store when MPI is unavailable. Each ID is
+ * stored in its own file, and the helper is shared by all communicators of the process, so the
+ * file of an ID is never reused by the next communicator while a slow rank may still access it.
+ */
 class NCCLIdSyncHelper {
  public:
+  static NCCLIdSyncHelper* Get() {
+    static NCCLIdSyncHelper instance;
+    return &instance;
+  }
+
   NCCLIdSyncHelper() {
     const char* temp = getenv("RAF_FILE_STORE_PATH");
     if (temp == nullptr) {
@@ -35,10 +45,14 @@ class NCCLIdSyncHelper {
     } else {
       base_path_ = std::string(temp);
     }
-    this->Append();
   }
 
+  /*!
+   * \brief Sync the NCCL unique ID of a group from its root rank. All ranks have to call it for
+   * every group in the same order, even if they are not in the group, to consume the same file.
+   */
   void Sync(ncclUniqueId* nccl_id, int rank, std::vector<int>& rank_vec) {
+    this->Append();
     // rank not in this group, do nothing
     if (std::find(rank_vec.begin(), rank_vec.end(), rank) == rank_vec.end()) {
       return;
@@ -76,10 +90,7 @@ NCCLCommunicator NCCLCommunicator::make(Value rank_list) {
   auto global_comm = GetGlobalCommunicator();
   auto obj = make_object<NCCLCommunicatorObj>();
 
-  std::unique_ptr<NCCLIdSyncHelper> helper{nullptr};
-  if (global_comm->IsInstance<VoidCommunicatorObj>()) {
-    helper = std::make_unique<NCCLIdSyncHelper>();
-  }
+  NCCLIdSyncHelper* helper = NCCLIdSyncHelper::Get();
 
   ncclUniqueId nccl_id;
   NCCL_CALL(ncclGetUniqueId(&nccl_id));
@@ -116,6 +127,20 @@ NCCLCommunicator NCCLCommunicator::make(Value rank_list) {
 
     obj->parent_comm = global_comm;
 
+#if NCCL_VERSION_CODE >= 21800
+    // Split the global NCCL communicator, which skips syncing the NCCL id and reuses the
+    // topology detected by the global one.
+    auto global_nccl_comm = Downcast<NCCLCommunicator>(Communicator::Get("nccl"));
+    int color = obj->group_id == -1 ? NCCL_SPLIT_NOCOLOR : obj->group_id;
+    NCCL_CALL(ncclCommSplit(global_nccl_comm->nccl_comm, color, obj->rank, &obj->nccl_comm,
+                            nullptr));
+    if (obj->group_id == -1) {
+      // This rank is not in rank_list, so it has a communicator of itself.
+      NCCL_CALL(ncclCommInitRank(&obj->nccl_comm, 1, nccl_id, 0));
+    }
+    return NCCLCommunicator(obj);
+#endif
+
     // sync NCCL id between ranks
     ncclUniqueId& root_nccl_id = nccl_id;
     if (global_comm->IsInstance<MPICommunicatorObj>()) {
@@ -151,7 +176,6 @@ NCCLCommunicator NCCLCommunicator::make(Value rank_list) {
           auto rank_val = Downcast<IntValue>(rank)->value;
           vec.push_back(rank_val);
         }
-        helper->Append();
         helper->Sync(&nccl_id, global_comm->rank, vec);
       }
     }
@@ -161,8 +185,25 @@ NCCLCommunicator NCCLCommunicator::make(Value rank_list) {
   return NCCLCommunicator(obj);
 }
 
+void NCCLCommunicator::WarmUp(ir::Array<Value> rank_lists) {
+  auto pool = CommunicatorPool::Get();
+#if NCCL_VERSION_CODE < 21800
+  // Group the initialization of the communicators, so NCCL sets them up in parallel instead of
+  // one after another. The NCCL ids are still synced on the host one by one in the group.
+  NCCL_CALL(ncclGroupStart());
+#endif
+  for (const auto& rank_list : rank_lists) {
+    pool->GetCommunicator("nccl", rank_list);
+  }
+#if NCCL_VERSION_CODE < 21800
+  NCCL_CALL(ncclGroupEnd());
+#endif
+}
+
 RAF_REGISTER_GLOBAL("raf.distributed.communicator._make.nccl")
     .set_body_typed(NCCLCommunicator::make);
+RAF_REGISTER_GLOBAL("raf.distributed.communicator._warm_up.nccl")
+    .set_body_typed(NCCLCommunicator::WarmUp);
 
 RAF_REGISTER_OBJECT_REFLECT(NCCLCommunicatorObj);
 
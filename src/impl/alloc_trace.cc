@@ -0,0 +1,305 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/alloc_trace.cc
+ * \brief Capture of the allocations made by the VM and their offline replay against memory pools.
+ */
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include "raf/alloc_trace.h"
+#include "raf/device_api.h"
+#include "raf/registry.h"
+#include "raf/value.h"
+
+namespace raf {
+namespace memory_pool {
+
+using device_api::DeviceAPI;
+
+namespace {
+
+/*! \brief The magic number and the version at the beginning of a trace file. */
+constexpr char kTraceMagic[8] = {'R', 'A', 'F', 'A', 'L', 'O', 'C', 'T'};
+constexpr uint32_t kTraceVersion = 1;
+
+void WriteVarint(std::ostream& os, uint64_t value) {
+  while (value >= 0x80) {
+    os.put(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  os.put(static_cast<char>(value));
+}
+
+uint64_t ReadVarint(std::istream& is) {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = is.get();
+    CHECK(byte != EOF) << "Unexpected end of the allocation trace";
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  LOG(FATAL) << "Malformed varint in the allocation trace";
+  return value;
+}
+
+/*! \brief Zigzag encode a signed value so that small negative values stay short. */
+uint64_t ZigZag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+template <typename T>
+void WritePod(std::ostream& os, const T& value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T ReadPod(std::istream& is) {
+  T value;
+  is.read(reinterpret_cast<char*>(&value), sizeof(T));
+  CHECK(is) << "Unexpected end of the allocation trace";
+  return value;
+}
+
+/*! \brief A traced buffer, which records its release when the last reference to it is dropped. */
+class TracedMemory : public Memory {
+ public:
+  TracedMemory(std::shared_ptr<Memory> mem, uint64_t id, uint64_t generation)
+      : mem_(std::move(mem)), id_(id), generation_(generation) {
+    data = mem_->data;
+    device = mem_->device;
+    stream = mem_->stream;
+  }
+
+  ~TracedMemory() {
+    AllocTracer::Get()->RecordFree(id_, generation_);
+  }
+
+ private:
+  std::shared_ptr<Memory> mem_;
+  uint64_t id_;
+  uint64_t generation_;
+};
+
+}  // namespace
+
+void AllocTrace::Save(const std::string& path) const {
+  std::ofstream os(path, std::ios::binary);
+  CHECK(os) << "Cannot open " << path;
+  os.write(kTraceMagic, sizeof(kTraceMagic));
+  WritePod<uint32_t>(os, kTraceVersion);
+  WritePod<int32_t>(os, device.device_type());
+  WritePod<int32_t>(os, device.device_id());
+  WritePod<uint64_t>(os, events.size());
+  int64_t last_ns = 0;
+  for (const auto& event : events) {
+    os.put(static_cast<char>(event.kind));
+    WriteVarint(os, ZigZag(event.timestamp_ns - last_ns));
+    WriteVarint(os, event.id);
+    last_ns = event.timestamp_ns;
+    if (event.kind == AllocEvent::kAlloc) {
+      WriteVarint(os, event.nbytes);
+      WriteVarint(os, event.alignment);
+      WriteVarint(os, ZigZag(event.stream_id));
+    }
+  }
+  CHECK(os) << "Failed to write " << path;
+}
+
+AllocTrace AllocTrace::Load(const std::string& path) {
+  std::ifstream is(path, std::ios::binary);
+  CHECK(is) << "Cannot open " << path;
+  char magic[sizeof(kTraceMagic)];
+  is.read(magic, sizeof(magic));
+  CHECK(is && std::memcmp(magic, kTraceMagic, sizeof(magic)) == 0)
+      << path << " is not an allocation trace";
+  uint32_t version = ReadPod<uint32_t>(is);
+  CHECK_EQ(version, kTraceVersion) << "Unsupported allocation trace version " << version;
+  AllocTrace trace;
+  int32_t device_type = ReadPod<int32_t>(is);
+  int32_t device_id = ReadPod<int32_t>(is);
+  trace.device = Device(DevType(device_type), device_id);
+  uint64_t num_events = ReadPod<uint64_t>(is);
+  trace.events.resize(num_events);
+  int64_t last_ns = 0;
+  for (auto& event : trace.events) {
+    int kind = is.get();
+    CHECK(kind == AllocEvent::kAlloc || kind == AllocEvent::kFree)
+        << "Malformed event in the allocation trace";
+    event.kind = static_cast<AllocEvent::Kind>(kind);
+    event.timestamp_ns = last_ns + UnZigZag(ReadVarint(is));
+    event.id = ReadVarint(is);
+    last_ns = event.timestamp_ns;
+    if (event.kind == AllocEvent::kAlloc) {
+      event.nbytes = ReadVarint(is);
+      event.alignment = ReadVarint(is);
+      event.stream_id = UnZigZag(ReadVarint(is));
+    }
+  }
+  return trace;
+}
+
+int64_t AllocTrace::PeakLiveBytes() const {
+  std::unordered_map<uint64_t, int64_t> live;
+  int64_t live_bytes = 0, peak = 0;
+  for (const auto& event : events) {
+    if (event.kind == AllocEvent::kAlloc) {
+      live[event.id] = event.nbytes;
+      live_bytes += event.nbytes;
+      peak = std::max(peak, live_bytes);
+    } else {
+      auto it = live.find(event.id);
+      if (it != live.end()) {
+        live_bytes -= it->second;
+        live.erase(it);
+      }
+    }
+  }
+  return peak;
+}
+
+AllocTracer* AllocTracer::Get() {
+  static AllocTracer* instance = new AllocTracer();
+  return instance;
+}
+
+int64_t AllocTracer::Now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                              start_)
+      .count();
+}
+
+void AllocTracer::Start(const Device& device) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++generation_;
+  next_id_ = 0;
+  trace_ = AllocTrace();
+  trace_.device = device;
+  start_ = std::chrono::steady_clock::now();
+  tracing_ = true;
+}
+
+AllocTrace AllocTracer::Stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  tracing_ = false;
+  AllocTrace ret = std::move(trace_);
+  trace_ = AllocTrace();
+  return ret;
+}
+
+std::shared_ptr<Memory> AllocTracer::Track(std::shared_ptr<Memory> mem, int64_t nbytes,
+                                           int64_t alignment, int64_t stream_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!tracing_ || mem == nullptr || mem->device != trace_.device) {
+    return mem;
+  }
+  AllocEvent event;
+  event.kind = AllocEvent::kAlloc;
+  event.id = next_id_++;
+  event.timestamp_ns = Now();
+  event.nbytes = nbytes;
+  event.alignment = alignment;
+  event.stream_id = stream_id;
+  trace_.events.push_back(event);
+  return std::make_shared<TracedMemory>(std::move(mem), event.id, generation_);
+}
+
+void AllocTracer::RecordFree(uint64_t id, uint64_t generation) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!tracing_ || generation != generation_) {
+    return;
+  }
+  AllocEvent event;
+  event.kind = AllocEvent::kFree;
+  event.id = id;
+  event.timestamp_ns = Now();
+  trace_.events.push_back(event);
+}
+
+AllocReplayStats ReplayAllocTrace(const AllocTrace& trace, const std::string& pool_name,
+                                  int repeat) {
+  CHECK_GE(repeat, 1);
+  const Device& device = trace.device;
+  std::string prev_pool = Memory::GetPool(device)->GetName();
+  std::shared_ptr<DeviceAPI> api = DeviceAPI::Get(device.device_type());
+
+  AllocReplayStats stats;
+  stats.num_events = trace.events.size();
+  stats.peak_requested_mb = trace.PeakLiveBytes() / 1048576.0;
+  // Replay the trace on a new pool, and sample the pool size after each allocation if measure.
+  auto replay = [&](bool measure) {
+    Memory::RemovePool(device);
+    MemoryPool* pool = Memory::InitPool(device, pool_name);
+    std::unordered_map<uint64_t, std::shared_ptr<Memory>> live;
+    live.reserve(trace.events.size());
+    auto begin = std::chrono::steady_clock::now();
+    for (const auto& event : trace.events) {
+      if (event.kind == AllocEvent::kFree) {
+        live.erase(event.id);
+        continue;
+      }
+      live[event.id] = pool->Alloc(event.nbytes, event.alignment);
+      if (measure) {
+        auto size = pool->GetPoolSize();
+        stats.peak_used_mb = std::max<double>(stats.peak_used_mb, size.first);
+        stats.peak_reserved_mb = std::max<double>(stats.peak_reserved_mb, size.second);
+      }
+    }
+    live.clear();
+    api->WaitDevice(device);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    Memory::RemovePool(device);
+    return elapsed.count();
+  };
+  for (int i = 0; i < repeat; ++i) {
+    stats.seconds += replay(false) / repeat;
+  }
+  replay(true);
+  if (stats.peak_reserved_mb > 0) {
+    stats.fragmentation = std::max(0.0, 1.0 - stats.peak_requested_mb / stats.peak_reserved_mb);
+  }
+  Memory::InitPool(device, prev_pool);
+  return stats;
+}
+
+RAF_REGISTER_GLOBAL("raf.memory_profiler.StartAllocTrace").set_body_typed([](const Device& dev) {
+  AllocTracer::Get()->Start(dev);
+});
+
+RAF_REGISTER_GLOBAL("raf.memory_profiler.StopAllocTrace").set_body_typed([](std::string path) {
+  AllocTrace trace = AllocTracer::Get()->Stop();
+  if (!path.empty()) {
+    trace.Save(path);
+  }
+  return static_cast<int64_t>(trace.events.size());
+});
+
+RAF_REGISTER_GLOBAL("raf.memory_profiler.ReplayAllocTrace")
+    .set_body_typed([](std::string path, std::string pool_name, int repeat) {
+      AllocReplayStats stats = ReplayAllocTrace(AllocTrace::Load(path), pool_name, repeat);
+      Map<String, FloatImm> ret;
+      auto set = [&](const char* key, double value) {
+        ret.Set(key, FloatImm(DataType::Float(64), value));
+      };
+      set("num_events", stats.num_events);
+      set("seconds", stats.seconds);
+      set("events_per_sec", stats.seconds > 0 ? stats.num_events / stats.seconds : 0);
+      set("peak_requested_mb", stats.peak_requested_mb);
+      set("peak_used_mb", stats.peak_used_mb);
+      set("peak_reserved_mb", stats.peak_reserved_mb);
+      set("fragmentation", stats.fragmentation);
+      return ret;
+    });
+
+}  // namespace memory_pool
+}  // namespace raf
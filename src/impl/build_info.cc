@@ -66,6 +66,18 @@ std::string UseCUTLASS() {
   return RAF_USE_CUTLASS;
 }
 
+std::string UseCUPTI() {
+  return RAF_USE_CUPTI;
+}
+
+std::string UseNVTX() {
+  return RAF_USE_NVTX;
+}
+
+std::string UseCuSPARSELt() {
+  return RAF_USE_CUSPARSELT;
+}
+
 std::string CudaVersion() {
   return RAF_CUDA_VERSION;
 }
@@ -89,6 +101,9 @@ RAF_REGISTER_GLOBAL("raf.build_info.use_llvm").set_body_typed(UseLLVM);
 RAF_REGISTER_GLOBAL("raf.build_info.use_mpi").set_body_typed(UseMPI);
 RAF_REGISTER_GLOBAL("raf.build_info.use_nccl").set_body_typed(UseNCCL);
 RAF_REGISTER_GLOBAL("raf.build_info.use_cutlass").set_body_typed(UseCUTLASS);
+RAF_REGISTER_GLOBAL("raf.build_info.use_cupti").set_body_typed(UseCUPTI);
+RAF_REGISTER_GLOBAL("raf.build_info.use_nvtx").set_body_typed(UseNVTX);
+RAF_REGISTER_GLOBAL("raf.build_info.use_cusparselt").set_body_typed(UseCuSPARSELt);
 RAF_REGISTER_GLOBAL("raf.build_info.nccl_version").set_body_typed(NCCLVersion);
 }  // namespace build_info
 }  // namespace raf
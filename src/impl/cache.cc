@@ -0,0 +1,130 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/cache.cc
+ * \brief The registry of the named caches.
+ */
+#include <cstdlib>
+#include "raf/cache.h"
+#include "raf/metrics.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace op {
+
+namespace {
+
+struct NamedCacheRegistry {
+  std::mutex mu;
+  std::unordered_map<std::string, MetaCacheMetric*> caches;
+
+  NamedCacheRegistry() {
+    metrics::Registry::Get()->RegisterCollector(
+        {{"raf_cache_events_total", "The events of each named cache, e.g., CacheHit."},
+         {"raf_cache_entries", "The number of in-memory entries of each named cache."}},
+        [this](std::vector<metrics::MetricSample>* samples) { CollectMetrics(samples); });
+  }
+
+  static NamedCacheRegistry* Global() {
+    static NamedCacheRegistry registry;
+    return &registry;
+  }
+
+  /*! \brief Report the event counts and the sizes of the named caches to a metrics snapshot. */
+  void CollectMetrics(std::vector<metrics::MetricSample>* samples) {
+    std::lock_guard<std::mutex> lock(mu);
+    for (const auto& kv : caches) {
+      for (const auto& event : kv.second->GetMetric()) {
+        metrics::MetricSample sample;
+        sample.name = "raf_cache_events_total";
+        sample.labels = {{"cache", kv.first}, {"event", event.first}};
+        sample.type = metrics::MetricType::kCounter;
+        sample.value = event.second;
+        samples->push_back(std::move(sample));
+      }
+      metrics::MetricSample sample;
+      sample.name = "raf_cache_entries";
+      sample.labels = {{"cache", kv.first}};
+      sample.type = metrics::MetricType::kGauge;
+      sample.value = kv.second->Size();
+      samples->push_back(std::move(sample));
+    }
+  }
+};
+
+/*! \brief The default capacity of the named caches from RAF_CACHE_CAPACITY, or 0 for unbounded. */
+size_t GetDefaultCapacity() {
+  const char* capacity = getenv("RAF_CACHE_CAPACITY");
+  return capacity == nullptr ? 0 : std::strtoull(capacity, nullptr, 10);
+}
+
+}  // namespace
+
+void MetaCacheMetric::Register(const std::string& name) {
+  auto* registry = NamedCacheRegistry::Global();
+  {
+    std::lock_guard<std::mutex> lock(registry->mu);
+    CHECK_EQ(registry->caches.count(name), 0) << "The cache " << name << " is already registered";
+    registry->caches[name] = this;
+  }
+  registered_name_ = name;
+  static size_t capacity = GetDefaultCapacity();
+  if (capacity != 0) {
+    SetCapacity(capacity);
+  }
+}
+
+void MetaCacheMetric::Unregister() {
+  if (registered_name_.empty()) {
+    return;
+  }
+  auto* registry = NamedCacheRegistry::Global();
+  std::lock_guard<std::mutex> lock(registry->mu);
+  registry->caches.erase(registered_name_);
+}
+
+MetaCacheMetric* GetNamedCache(const std::string& name) {
+  auto* registry = NamedCacheRegistry::Global();
+  std::lock_guard<std::mutex> lock(registry->mu);
+  auto it = registry->caches.find(name);
+  return it == registry->caches.end() ? nullptr : it->second;
+}
+
+PackedMetricMap DumpMetric(const std::string& cache_name) {
+  PackedMetricMap ret;
+  auto* cache = GetNamedCache(cache_name);
+  if (cache == nullptr) {
+    LOG(WARNING) << "Cannot find cache " << cache_name << " for dumping metric";
+    return ret;
+  }
+  for (const auto& it : cache->GetMetric()) {
+    ret.Set(it.first, it.second);
+  }
+  return ret;
+}
+
+namespace {
+
+MetaCacheMetric* GetNamedCacheOrFail(const std::string& cache_name) {
+  auto* cache = GetNamedCache(cache_name);
+  CHECK(cache != nullptr) << "Cannot find cache " << cache_name;
+  return cache;
+}
+
+}  // namespace
+
+RAF_REGISTER_GLOBAL("raf.cache.DumpMetric").set_body_typed(DumpMetric);
+RAF_REGISTER_GLOBAL("raf.cache.SetCacheCapacity")
+    .set_body_typed([](std::string cache_name, int64_t capacity) {
+      CHECK_GE(capacity, 0) << "The capacity of a cache cannot be negative";
+      GetNamedCacheOrFail(cache_name)->SetCapacity(capacity);
+    });
+RAF_REGISTER_GLOBAL("raf.cache.GetCacheSize").set_body_typed([](std::string cache_name) {
+  return static_cast<int64_t>(GetNamedCacheOrFail(cache_name)->Size());
+});
+
+}  // namespace op
+}  // namespace raf
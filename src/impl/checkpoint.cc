@@ -0,0 +1,483 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/checkpoint.cc
+ * \brief Sharded checkpoints of the parameters and the optimizer states.
+ */
+#include <dmlc/io.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "raf/checkpoint.h"
+#include "raf/device_api.h"
+#include "raf/event_pool.h"
+#include "raf/file.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+#include "raf/stream_pool.h"
+#include "../common/mapped_file.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace checkpoint {
+
+using namespace raf::ir;
+using namespace raf::value;
+using common::mapped_file::MappedFile;
+using common::mapped_file::MappedMemory;
+using common::shape_utils::BytesCompactTensor;
+using common::shape_utils::IsCompact;
+using device_api::DeviceAPI;
+using memory_pool::Memory;
+using registry::PackedFunc;
+using stream_pool::Stream;
+
+/*! \brief The magic number at the beginning of the index files. */
+constexpr uint64_t kCheckpointMagic = 0x5241464350543031;
+/*! \brief The size of the pinned buffers to stage the uploaded tensors. */
+constexpr int64_t kStagingBytes = 64 << 20;
+
+/*! \brief The record of a tensor in the index file. */
+struct IndexEntry {
+  std::string name;
+  DLDataType dtype;
+  std::vector<int64_t> shape;
+  uint64_t offset;
+  uint64_t nbytes;
+};
+
+inline std::string DataPath(const std::string& path, int rank) {
+  return path + "/rank" + std::to_string(rank) + ".data";
+}
+
+inline std::string IndexPath(const std::string& path, int rank) {
+  return path + "/rank" + std::to_string(rank) + ".index";
+}
+
+inline uint64_t AlignUp(uint64_t offset) {
+  return (offset + kCheckpointAlignment - 1) / kCheckpointAlignment * kCheckpointAlignment;
+}
+
+/*! \brief A 1-D byte tensor over a memory range, to copy raw bytes with the device APIs. */
+struct ByteTensor {
+  ByteTensor(void* data, const Device& device, int64_t nbytes) : nbytes(nbytes) {
+    tensor.data = data;
+    tensor.device = device;
+    tensor.ndim = 1;
+    tensor.dtype = DLDataType{kDLUInt, 8, 1};
+    tensor.shape = &this->nbytes;
+    tensor.strides = nullptr;
+    tensor.byte_offset = 0;
+  }
+
+  int64_t nbytes;
+  DLTensor tensor;
+};
+
+/*!
+ * \brief Save the tensors of a rank in the background. The tensors are snapshotted in the
+ * constructor and written to the files by a pool of writer threads.
+ */
+class CheckpointSaver : public tvm::runtime::ModuleNode {
+ public:
+  CheckpointSaver(const std::string& path, int rank, const Map<String, Value>& tensors,
+                  int num_threads, bool device_copy)
+      : path_(path), rank_(rank), num_threads_(std::max(num_threads, 1)) {
+    std::vector<std::string> names;
+    for (const auto& kv : tensors) {
+      names.push_back(kv.first);
+    }
+    std::sort(names.begin(), names.end());
+    uint64_t offset = 0;
+    for (const auto& name : names) {
+      const auto* tv = tensors[name].as<TensorValueObj>();
+      CHECK(tv != nullptr) << "Only tensors can be checkpointed, but " << name << " is a "
+                           << tensors[name]->GetTypeKey();
+      DLTensor* src = GetRef<TensorValue>(tv);
+      CHECK(IsCompact(*src)) << "Only compact tensors can be checkpointed, but " << name
+                             << " is strided";
+      IndexEntry entry;
+      entry.name = name;
+      entry.dtype = src->dtype;
+      entry.shape.assign(src->shape, src->shape + src->ndim);
+      entry.nbytes = BytesCompactTensor(*src);
+      entry.offset = AlignUp(offset);
+      offset = entry.offset + entry.nbytes;
+      entries_.push_back(std::move(entry));
+      sources_.push_back(GetRef<TensorValue>(tv));
+    }
+    Snapshot(device_copy);
+    worker_ = std::thread([this]() {
+      try {
+        Write();
+      } catch (...) {
+        error_ = std::current_exception();
+      }
+      done_.store(true);
+    });
+  }
+
+  ~CheckpointSaver() {
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+  }
+
+  const char* type_key() const final {
+    return "CheckpointSaver";
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "wait") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        Wait();
+      });
+    } else if (name == "done") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        *rv = done_.load();
+      });
+    } else {
+      LOG(FATAL) << "Unknown packed function: " << name;
+      return PackedFunc([sptr_to_self, name](registry::TVMArgs args, registry::TVMRetValue* rv) {});
+    }
+  }
+
+  /*!
+   * \brief Wait for the files to be written, and rethrow the error while writing them. The device
+   * copies of the snapshot are released here, on the thread that owns the device memory.
+   */
+  void Wait() {
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+    clones_.clear();
+    if (error_ != nullptr) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+ private:
+  /*! \brief The streams and the events to snapshot the tensors of a device. */
+  struct DeviceCopy {
+    /*! \brief The device. */
+    Device device;
+    /*! \brief The stream to copy the tensors to the host. */
+    std::shared_ptr<Stream> d2h;
+    /*! \brief The stream to copy the tensors on the device, or null without device copies. */
+    std::shared_ptr<Stream> d2d;
+    /*! \brief The event after which the tensors can be updated. */
+    void* snapshot_event;
+    /*! \brief The event after which the host snapshot is complete. */
+    void* done_event;
+  };
+
+  /*!
+   * \brief Copy the tensors to new pinned host buffers. The current compute stream of each device
+   * waits for the snapshot before the following computation updates the tensors. With device
+   * copies, it only waits for the tensors to be copied on the device, and the copies are then
+   * transferred to the host in the background, i.e., the training continues on a copy-on-write
+   * basis at the cost of the device memory of the copies.
+   */
+  void Snapshot(bool device_copy) {
+    snapshots_.resize(entries_.size());
+    clones_.resize(entries_.size());
+    for (size_t i = 0; i < entries_.size(); ++i) {
+      DLTensor* src = sources_[i];
+      Device device = src->device;
+      int64_t nbytes = entries_[i].nbytes;
+      snapshots_[i] = Memory::AllocHost(device, nbytes, kCheckpointAlignment);
+      char* src_data = static_cast<char*>(src->data) + src->byte_offset;
+      if (device.device_type() == DevType::kCPU()) {
+        std::memcpy(snapshots_[i]->data, src_data, nbytes);
+        continue;
+      }
+      auto api = DeviceAPI::Get(device.device_type());
+      api->SetDevice(device.device_id());
+      DeviceCopy& copy = GetDeviceCopy(device, device_copy);
+      ByteTensor from(src_data, device, nbytes);
+      if (device_copy) {
+        clones_[i] = Memory::Alloc(device, nbytes);
+        ByteTensor to(clones_[i]->data, device, nbytes);
+        api->CopyDataFromTo(&from.tensor, &to.tensor, copy.d2d->data());
+      } else {
+        ByteTensor to(snapshots_[i]->data, Device(DevType::kCPU(), 0), nbytes);
+        api->CopyDataFromTo(&from.tensor, &to.tensor, copy.d2h->data());
+      }
+    }
+    for (auto& copy : copies_) {
+      auto api = DeviceAPI::Get(copy.device.device_type());
+      api->SetDevice(copy.device.device_id());
+      void* stream = device_copy ? copy.d2d->data() : copy.d2h->data();
+      api->EventRecordOnStream(copy.snapshot_event, stream);
+      api->StreamWaitEvent(api->GetStream(), copy.snapshot_event);
+      if (device_copy) {
+        api->StreamWaitEvent(copy.d2h->data(), copy.snapshot_event);
+      }
+    }
+    for (size_t i = 0; i < entries_.size(); ++i) {
+      if (clones_[i] != nullptr) {
+        Device device = clones_[i]->device;
+        auto api = DeviceAPI::Get(device.device_type());
+        api->SetDevice(device.device_id());
+        ByteTensor from(clones_[i]->data, device, entries_[i].nbytes);
+        ByteTensor to(snapshots_[i]->data, Device(DevType::kCPU(), 0), entries_[i].nbytes);
+        api->CopyDataFromTo(&from.tensor, &to.tensor, GetDeviceCopy(device, true).d2h->data());
+      }
+    }
+    for (auto& copy : copies_) {
+      auto api = DeviceAPI::Get(copy.device.device_type());
+      api->SetDevice(copy.device.device_id());
+      api->EventRecordOnStream(copy.done_event, copy.d2h->data());
+    }
+    // The tensors are no longer referred once their copies are ordered before the updates.
+    sources_.clear();
+  }
+
+  /*! \brief Get the snapshot streams of a device, which wait for its pending computation. */
+  DeviceCopy& GetDeviceCopy(const Device& device, bool device_copy) {
+    for (auto& copy : copies_) {
+      if (copy.device.device_type() == device.device_type() &&
+          copy.device.device_id() == device.device_id()) {
+        return copy;
+      }
+    }
+    auto api = DeviceAPI::Get(device.device_type());
+    DeviceCopy copy;
+    copy.device = device;
+    copy.d2h = Stream::Get(device, stream_pool::kMemCpyCudaToCpu, 0);
+    if (device_copy) {
+      copy.d2d = Stream::Get(device, stream_pool::kMemCpyCudaToCuda1, 0);
+    }
+    copy.snapshot_event = api->CreateEvent(device, event_pool::kEventDisableTiming);
+    copy.done_event = api->CreateEvent(device, event_pool::kEventDisableTiming);
+    // The snapshot event is recorded again once the snapshot is issued.
+    api->EventRecordOnStream(copy.snapshot_event, api->GetStream());
+    api->StreamWaitEvent((device_copy ? copy.d2d : copy.d2h)->data(), copy.snapshot_event);
+    copies_.push_back(std::move(copy));
+    return copies_.back();
+  }
+
+  /*! \brief Write the snapshot to the data file and then the index file. */
+  void Write() {
+    for (auto& copy : copies_) {
+      auto api = DeviceAPI::Get(copy.device.device_type());
+      api->SetDevice(copy.device.device_id());
+      api->WaitEvent(copy.done_event);
+      api->FreeEvent(copy.device, copy.snapshot_event);
+      api->FreeEvent(copy.device, copy.done_event);
+    }
+    copies_.clear();
+
+    CreateDir(path_);
+    std::string data_path = DataPath(path_, rank_);
+    int fd = open(data_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CHECK_GE(fd, 0) << "Cannot open " << data_path << ": " << strerror(errno);
+    // The writers take the tensors in turn and write them at their own offsets.
+    std::atomic<size_t> next{0};
+    std::vector<std::exception_ptr> errors(num_threads_);
+    auto writer = [&](int tid) {
+      try {
+        for (size_t i = next++; i < entries_.size(); i = next++) {
+          WriteAt(fd, data_path, static_cast<const char*>(snapshots_[i]->data),
+                  entries_[i].nbytes, entries_[i].offset);
+          // Release the pinned buffer as soon as it is written.
+          snapshots_[i].reset();
+        }
+      } catch (...) {
+        errors[tid] = std::current_exception();
+      }
+    };
+    std::vector<std::thread> writers;
+    for (int tid = 1; tid < num_threads_; ++tid) {
+      writers.emplace_back(writer, tid);
+    }
+    writer(0);
+    for (auto& thread : writers) {
+      thread.join();
+    }
+    for (auto& error : errors) {
+      if (error != nullptr) {
+        close(fd);
+        std::rethrow_exception(error);
+      }
+    }
+    CHECK_EQ(fsync(fd), 0) << "Cannot sync " << data_path << ": " << strerror(errno);
+    close(fd);
+
+    // The index is written last and renamed into place, so a complete index always refers to a
+    // complete data file.
+    std::string index_path = IndexPath(path_, rank_);
+    std::string tmp_path = index_path + ".tmp";
+    {
+      std::unique_ptr<dmlc::Stream> strm(dmlc::Stream::Create(tmp_path.c_str(), "w"));
+      strm->Write(kCheckpointMagic);
+      strm->Write(static_cast<uint64_t>(kCheckpointAlignment));
+      strm->Write(static_cast<uint64_t>(entries_.size()));
+      for (const auto& entry : entries_) {
+        strm->Write(entry.name);
+        strm->Write(entry.dtype);
+        strm->Write(entry.shape);
+        strm->Write(entry.offset);
+        strm->Write(entry.nbytes);
+      }
+    }
+    CHECK_EQ(rename(tmp_path.c_str(), index_path.c_str()), 0)
+        << "Cannot write " << index_path << ": " << strerror(errno);
+  }
+
+  /*! \brief Write a buffer to a file at an offset. */
+  static void WriteAt(int fd, const std::string& path, const char* data, uint64_t nbytes,
+                      uint64_t offset) {
+    uint64_t written = 0;
+    while (written < nbytes) {
+      ssize_t ret = pwrite(fd, data + written, nbytes - written, offset + written);
+      if (ret < 0 && errno == EINTR) {
+        continue;
+      }
+      CHECK_GE(ret, 0) << "Cannot write " << path << ": " << strerror(errno);
+      written += ret;
+    }
+  }
+
+  /*! \brief The directory of the checkpoint. */
+  std::string path_;
+  /*! \brief The rank whose shard is saved. */
+  int rank_;
+  /*! \brief The number of threads to write the data file. */
+  int num_threads_;
+  /*! \brief The records of the tensors in the order of their offsets. */
+  std::vector<IndexEntry> entries_;
+  /*! \brief The tensors to snapshot. */
+  std::vector<TensorValue> sources_;
+  /*! \brief The pinned host snapshot of each tensor. */
+  std::vector<std::shared_ptr<Memory>> snapshots_;
+  /*! \brief The device copy of each tensor, if the snapshot goes through device copies. */
+  std::vector<std::shared_ptr<Memory>> clones_;
+  /*! \brief The snapshot streams of each device. */
+  std::vector<DeviceCopy> copies_;
+  /*! \brief Whether the files have been written. */
+  std::atomic<bool> done_{false};
+  /*! \brief The error while writing the files. */
+  std::exception_ptr error_;
+  /*! \brief The worker thread that writes the files. */
+  std::thread worker_;
+};
+
+tvm::runtime::Module SaveCheckpoint(const std::string& path, int rank,
+                                    const Map<String, Value>& tensors, int num_threads,
+                                    bool device_copy) {
+  return tvm::runtime::Module(
+      make_object<CheckpointSaver>(path, rank, tensors, num_threads, device_copy));
+}
+
+/*!
+ * \brief Stream a range of a mapped file to the device through two pinned buffers, so that the
+ * copy of one chunk overlaps with staging the next one.
+ */
+class Uploader {
+ public:
+  explicit Uploader(const Device& device)
+      : device_(device), api_(DeviceAPI::Get(device.device_type())) {
+    api_->SetDevice(device_.device_id());
+    stream_ = Stream::Get(device_, stream_pool::kMemCpyCpuToCuda, 0);
+    for (int i = 0; i < 2; ++i) {
+      buffers_[i] = Memory::AllocHost(device_, kStagingBytes);
+      events_[i] = api_->CreateEvent(device_, event_pool::kEventDisableTiming);
+    }
+  }
+
+  ~Uploader() {
+    api_->WaitStream(stream_->data());
+    for (int i = 0; i < 2; ++i) {
+      api_->FreeEvent(device_, events_[i]);
+    }
+  }
+
+  void Upload(const char* src, void* dst, int64_t nbytes) {
+    for (int64_t offset = 0; offset < nbytes; offset += kStagingBytes) {
+      int64_t size = std::min(kStagingBytes, nbytes - offset);
+      // Wait for the previous copy from the buffer before overwriting it.
+      api_->WaitEvent(events_[next_]);
+      std::memcpy(buffers_[next_]->data, src + offset, size);
+      ByteTensor from(buffers_[next_]->data, Device(DevType::kCPU(), 0), size);
+      ByteTensor to(static_cast<char*>(dst) + offset, device_, size);
+      api_->CopyDataFromTo(&from.tensor, &to.tensor, stream_->data());
+      api_->EventRecordOnStream(events_[next_], stream_->data());
+      next_ = 1 - next_;
+    }
+  }
+
+ private:
+  /*! \brief The target device. */
+  Device device_;
+  /*! \brief The API of the target device. */
+  std::shared_ptr<DeviceAPI> api_;
+  /*! \brief The stream to copy the chunks. */
+  std::shared_ptr<Stream> stream_;
+  /*! \brief The pinned staging buffers. */
+  std::shared_ptr<Memory> buffers_[2];
+  /*! \brief The event recorded after the copy from each buffer. */
+  void* events_[2];
+  /*! \brief The buffer to stage the next chunk. */
+  int next_ = 0;
+};
+
+Map<String, Value> LoadCheckpoint(const std::string& path, int rank, const Device& device) {
+  std::string index_path = IndexPath(path, rank);
+  std::unique_ptr<dmlc::Stream> strm(dmlc::Stream::Create(index_path.c_str(), "r"));
+  uint64_t magic, alignment, count;
+  CHECK(strm->Read(&magic) && magic == kCheckpointMagic) << index_path << " is not a checkpoint";
+  CHECK(strm->Read(&alignment) && strm->Read(&count)) << "Invalid checkpoint " << index_path;
+  std::vector<IndexEntry> entries(count);
+  for (auto& entry : entries) {
+    CHECK(strm->Read(&entry.name) && strm->Read(&entry.dtype) && strm->Read(&entry.shape) &&
+          strm->Read(&entry.offset) && strm->Read(&entry.nbytes))
+        << "Invalid checkpoint " << index_path;
+  }
+
+  auto file = std::make_shared<MappedFile>(DataPath(path, rank));
+  Map<String, Value> tensors;
+  if (device.device_type() == DevType::kCPU()) {
+    for (const auto& entry : entries) {
+      CHECK_LE(entry.offset + entry.nbytes, file->size) << "Truncated checkpoint " << path;
+      void* data = file->data + entry.offset;
+      auto mem = std::make_shared<MappedMemory>(file, data);
+      tensors.Set(entry.name,
+                  TensorValue::Assemble(device, entry.dtype, entry.shape, {}, data, mem));
+    }
+    return tensors;
+  }
+  // The mapping is read once from the beginning to the end.
+  if (file->size > 0) {
+    madvise(file->data, file->size, MADV_SEQUENTIAL);
+  }
+  Uploader uploader(device);
+  for (const auto& entry : entries) {
+    CHECK_LE(entry.offset + entry.nbytes, file->size) << "Truncated checkpoint " << path;
+    auto mem = Memory::Alloc(device, entry.nbytes);
+    uploader.Upload(file->data + entry.offset, mem->data, entry.nbytes);
+    tensors.Set(entry.name,
+                TensorValue::Assemble(device, entry.dtype, entry.shape, {}, mem->data, mem));
+  }
+  return tensors;
+}
+
+RAF_REGISTER_GLOBAL("raf.checkpoint.Save").set_body_typed(SaveCheckpoint);
+RAF_REGISTER_GLOBAL("raf.checkpoint.Load").set_body_typed(LoadCheckpoint);
+
+}  // namespace checkpoint
+}  // namespace raf
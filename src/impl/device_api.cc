@@ -8,6 +8,7 @@
  * \brief Device api manager
  */
 #include "raf/device_api.h"
+#include "raf/event_pool.h"
 #include "raf/registry.h"
 
 namespace raf {
@@ -46,5 +47,22 @@ std::shared_ptr<DeviceAPI> DeviceAPI::Get(DevType device_type) {
   return result;
 }
 
+/*!
+ * \brief Make the consumer stream wait for the work submitted to the producer stream so far, which
+ * orders the accesses to the tensors shared between the streams, e.g., through DLPack.
+ */
+void StreamWaitStream(const Device& dev, int64_t producer, int64_t consumer) {
+  if (producer == consumer) {
+    return;
+  }
+  auto api = DeviceAPI::Get(dev.device_type());
+  api->SetDevice(dev.device_id());
+  auto event = event_pool::EventPool::Get(dev)->GetEvent(event_pool::kEventDisableTiming);
+  api->EventRecordOnStream(event->data(), reinterpret_cast<void*>(producer));
+  api->StreamWaitEvent(reinterpret_cast<void*>(consumer), event->data());
+}
+
+RAF_REGISTER_GLOBAL("raf.device_api.StreamWaitStream").set_body_typed(StreamWaitStream);
+
 }  // namespace device_api
 }  // namespace raf
@@ -0,0 +1,186 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/embedding_cache.cc
+ * \brief Embedding tables on the host with a row cache on the device.
+ */
+#include <cstring>
+#include <tvm/runtime/module.h>
+#include "raf/device_api.h"
+#include "raf/embedding_cache.h"
+#include "raf/registry.h"
+
+#ifdef RAF_USE_CUDA
+#include "../common/cuda_utils.h"
+#endif
+
+namespace raf {
+namespace embedding_cache {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+using memory_pool::Memory;
+using registry::PackedFunc;
+
+namespace {
+
+/*! \brief Copy between the host and the device memory, which is synchronous. */
+void CopyBytes(const Device& device, void* dst, const void* src, int64_t nbytes) {
+#ifdef RAF_USE_CUDA
+  if (device.device_type() == DevType::kCUDA()) {
+    CUDA_CALL(cudaMemcpy(dst, src, nbytes, cudaMemcpyDefault));
+    return;
+  }
+#endif
+  std::memcpy(dst, src, nbytes);
+}
+
+}  // namespace
+
+EmbeddingCache::EmbeddingCache(const Device& device, const TensorValue& table, int64_t num_sets,
+                               int64_t num_ways)
+    : device_(device), num_sets_(num_sets), num_ways_(num_ways) {
+  CHECK_GT(num_sets, 0);
+  CHECK(num_ways > 0 && num_ways <= 32) << "The number of ways should be in [1, 32]";
+  auto cpu_table = Downcast<TensorValue>(CopyTo(table, Device(DevType::kCPU(), 0)));
+  const DLTensor* dlt = cpu_table;
+  CHECK_GE(dlt->ndim, 2) << "The table should be in shape [num_rows, hidden...]";
+  std::vector<int64_t> shape(dlt->shape, dlt->shape + dlt->ndim);
+  row_bytes_ = (dlt->dtype.bits * dlt->dtype.lanes + 7) / 8;
+  for (int i = 1; i < dlt->ndim; ++i) {
+    row_bytes_ *= shape[i];
+  }
+  int64_t nbytes = row_bytes_ * shape[0];
+  host_ = Memory::AllocHost(device, nbytes);
+  std::memcpy(host_->data, static_cast<const char*>(dlt->data) + dlt->byte_offset, nbytes);
+  void* mapped = host_->data;
+#ifdef RAF_USE_CUDA
+  if (device.device_type() == DevType::kCUDA()) {
+    CUDA_CALL(cudaHostGetDevicePointer(&mapped, host_->data, 0));
+  }
+#endif
+  table_ = TensorValue::Assemble(device, dlt->dtype, shape, {}, mapped, host_);
+
+  // The sets are unlocked at clock 0, and all ways are empty.
+  std::vector<int64_t> tags(num_sets * (1 + num_ways) * 3, 0);
+  for (int64_t s = 0; s < num_sets; ++s) {
+    for (int64_t w = 0; w < num_ways; ++w) {
+      tags[(s * (1 + num_ways) + 1 + w) * 3] = -1;
+    }
+  }
+  int64_t tags_bytes = tags.size() * sizeof(int64_t);
+  auto tags_mem = Memory::Alloc(device, tags_bytes);
+  CopyBytes(device, tags_mem->data, tags.data(), tags_bytes);
+  tags_ = TensorValue::Assemble(device, DType(DTypeCode::kInt(), 64), {num_sets, 1 + num_ways, 3},
+                                {}, tags_mem->data, tags_mem);
+
+  shape[0] = num_sets * num_ways;
+  auto rows_mem = Memory::Alloc(device, row_bytes_ * shape[0]);
+  rows_ = TensorValue::Assemble(device, dlt->dtype, shape, {}, rows_mem->data, rows_mem);
+}
+
+std::vector<int64_t> EmbeddingCache::ReadTags() {
+  DeviceAPI::Get(device_.device_type())->WaitDevice(device_);
+  std::vector<int64_t> tags(num_sets_ * (1 + num_ways_) * 3);
+  CopyBytes(device_, tags.data(), tags_->tensor->data, tags.size() * sizeof(int64_t));
+  return tags;
+}
+
+void EmbeddingCache::Flush() {
+  auto tags = ReadTags();
+  bool dirty = false;
+  for (int64_t s = 0; s < num_sets_; ++s) {
+    for (int64_t w = 0; w < num_ways_; ++w) {
+      int64_t* entry = &tags[(s * (1 + num_ways_) + 1 + w) * 3];
+      if (entry[0] < 0 || entry[2] == 0) {
+        continue;
+      }
+      const char* slot = static_cast<const char*>(rows_->tensor->data) +
+                         (s * num_ways_ + w) * row_bytes_;
+      CopyBytes(device_, static_cast<char*>(host_->data) + entry[0] * row_bytes_, slot,
+                row_bytes_);
+      entry[2] = 0;
+      dirty = true;
+    }
+  }
+  if (dirty) {
+    CopyBytes(device_, tags_->tensor->data, tags.data(), tags.size() * sizeof(int64_t));
+  }
+}
+
+TensorValue EmbeddingCache::ReadTable() {
+  Flush();
+  const DLTensor* dlt = table_;
+  std::vector<int64_t> shape(dlt->shape, dlt->shape + dlt->ndim);
+  Device cpu(DevType::kCPU(), 0);
+  int64_t nbytes = row_bytes_ * shape[0];
+  auto mem = Memory::Alloc(cpu, nbytes);
+  std::memcpy(mem->data, host_->data, nbytes);
+  return TensorValue::Assemble(cpu, dlt->dtype, shape, {}, mem->data, mem);
+}
+
+int64_t EmbeddingCache::NumCachedRows() {
+  auto tags = ReadTags();
+  int64_t ret = 0;
+  for (int64_t s = 0; s < num_sets_; ++s) {
+    for (int64_t w = 0; w < num_ways_; ++w) {
+      ret += tags[(s * (1 + num_ways_) + 1 + w) * 3] >= 0;
+    }
+  }
+  return ret;
+}
+
+namespace {
+
+/*! \brief The module of an EmbeddingCache, whose functions are called by the training loop. */
+class EmbeddingCacheModule : public tvm::runtime::ModuleNode {
+ public:
+  explicit EmbeddingCacheModule(std::unique_ptr<EmbeddingCache> cache) : cache_(std::move(cache)) {
+  }
+
+  const char* type_key() const final {
+    return "EmbeddingCache";
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "flush") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        cache_->Flush();
+      });
+    } else if (name == "read_table") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        *rv = cache_->ReadTable();
+      });
+    } else if (name == "num_cached_rows") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        *rv = cache_->NumCachedRows();
+      });
+    } else if (name == "states") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        *rv = Array<Value>({cache_->Table(), cache_->Tags(), cache_->Rows()});
+      });
+    } else {
+      LOG(FATAL) << "Unknown packed function: " << name;
+      return PackedFunc([sptr_to_self, name](registry::TVMArgs args, registry::TVMRetValue* rv) {});
+    }
+  }
+
+ private:
+  std::unique_ptr<EmbeddingCache> cache_;
+};
+
+}  // namespace
+
+RAF_REGISTER_GLOBAL("raf.embedding_cache.EmbeddingCache")
+    .set_body_typed([](const Device& device, TensorValue table, int64_t num_sets,
+                       int64_t num_ways) {
+      auto cache = std::make_unique<EmbeddingCache>(device, table, num_sets, num_ways);
+      return tvm::runtime::Module(make_object<EmbeddingCacheModule>(std::move(cache)));
+    });
+
+}  // namespace embedding_cache
+}  // namespace raf
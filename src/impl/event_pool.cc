@@ -7,6 +7,7 @@
  * \file src/impl/event_pool.cc
  * \brief RAF event pool underlying implementation
  */
+#include <algorithm>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -21,29 +22,65 @@ namespace event_pool {
 using device_api::DeviceAPI;
 using registry::PerDeviceStore;
 
-class Event::Impl {
+/*! \brief The number of events moved between the pool and the free list of a thread at a time. */
+constexpr size_t kEventBatchSize = 64;
+
+/*!
+ * \brief The free lists of the events released by a thread, keyed by the pool and the flags. The
+ * events are got and released without locking the pool, and are moved from and to the pool in
+ * batches, so that a thread issuing lots of synchronization rarely contends with the others.
+ */
+class LocalEventLists {
  public:
-  explicit Impl(Device dev, uint32_t flags, void* event)
-      : device_(std::move(dev)), flags_(flags), event_(event) {
-  }
+  struct Entry {
+    EventPool* pool;
+    uint32_t flags;
+    std::vector<void*> events;
+  };
+
+  ~LocalEventLists();
 
-  ~Impl() {
-    if (event_ != nullptr) {
-      EventPool::Get(device_)->RecycleEvent(flags_, event_);
+  std::vector<void*>* Get(EventPool* pool, uint32_t flags) {
+    // There are only a few pools and flags, so a linear search is faster than hashing.
+    for (auto& entry : entries_) {
+      if (entry.pool == pool && entry.flags == flags) {
+        return &entry.events;
+      }
     }
+    entries_.push_back({pool, flags, {}});
+    return &entries_.back().events;
   }
 
- public:
-  Device device_;
-  uint32_t flags_;
-  void* event_;
+ private:
+  std::vector<Entry> entries_;
 };
 
-Event::Event(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {
+/*! \brief Whether the free lists of this thread have been destroyed at the thread exit. */
+static thread_local bool local_event_lists_destroyed = false;
+static thread_local LocalEventLists local_event_lists;
+
+Event::Event(EventPool* pool, uint32_t flags, void* event)
+    : pool_(pool), flags_(flags), event_(event) {
+}
+
+Event::~Event() {
+  if (event_ == nullptr) {
+    return;
+  }
+  if (local_event_lists_destroyed) {
+    std::vector<void*> events{event_};
+    pool_->RecycleEvents(flags_, 1, &events);
+    return;
+  }
+  auto* events = local_event_lists.Get(pool_, flags_);
+  events->push_back(event_);
+  if (events->size() >= 2 * kEventBatchSize) {
+    pool_->RecycleEvents(flags_, kEventBatchSize, events);
+  }
 }
 
 void* Event::data() const {
-  return impl_ ? impl_->event_ : nullptr;
+  return event_;
 }
 
 EventPool::~EventPool() {
@@ -55,24 +92,44 @@ EventPool::~EventPool() {
 }
 
 std::shared_ptr<Event> EventPool::GetEvent(uint32_t flags) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto& pool = freed_events_[flags];
-  void* event;
-  if (!pool.empty()) {
-    event = pool.back();
-    pool.pop_back();
+  void* event = nullptr;
+  std::vector<void*>* events =
+      local_event_lists_destroyed ? nullptr : local_event_lists.Get(this, flags);
+  if (events != nullptr && events->empty()) {
+    TakeEvents(flags, kEventBatchSize, events);
+  }
+  if (events != nullptr && !events->empty()) {
+    event = events->back();
+    events->pop_back();
   } else {
     event = api_->CreateEvent(device_, flags);
   }
-  return std::shared_ptr<Event>(new Event(std::make_unique<Event::Impl>(device_, flags, event)));
+  return std::shared_ptr<Event>(new Event(this, flags, event));
 }
 
 EventPool::EventPool(const Device& dev) : device_(dev), api_(DeviceAPI::Get(dev.device_type())) {
 }
 
-void EventPool::RecycleEvent(uint32_t flags, void* event) {
+void EventPool::TakeEvents(uint32_t flags, size_t n, std::vector<void*>* events) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& pool = freed_events_[flags];
+  n = std::min(n, pool.size());
+  events->insert(events->end(), pool.end() - n, pool.end());
+  pool.resize(pool.size() - n);
+}
+
+void EventPool::RecycleEvents(uint32_t flags, size_t n, std::vector<void*>* events) {
   std::lock_guard<std::mutex> lock(mutex_);
-  freed_events_[flags].push_back(event);
+  auto& pool = freed_events_[flags];
+  pool.insert(pool.end(), events->end() - n, events->end());
+  events->resize(events->size() - n);
+}
+
+LocalEventLists::~LocalEventLists() {
+  local_event_lists_destroyed = true;
+  for (auto& entry : entries_) {
+    entry.pool->RecycleEvents(entry.flags, entry.events.size(), &entry.events);
+  }
 }
 
 std::shared_ptr<EventPool> EventPool::Get(const Device& dev) {
@@ -87,7 +144,5 @@ std::shared_ptr<EventPool> EventPool::Get(const Device& dev) {
   return ret;
 }
 
-Event::~Event() = default;
-
 }  // namespace event_pool
 }  // namespace raf
@@ -18,6 +18,7 @@
 #include "raf/binding.h"
 #include "raf/profiler.h"
 #include "raf/communicator.h"
+#include "raf/cache.h"
 #include "dmlc/thread_local.h"
 #include "../common/shape_utils.h"
 #include "../requests.h"
@@ -174,9 +175,10 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
       return InvokeClosure(call_values);
     } else if (const auto* opv = call_values->callee.as<OpValueObj>()) {
       call_values->args = fschema[opv->op](args);
+      OpEnvPtr* cached_op_env = LookupOpEnvCache(node, opv->op, args);
       Value output_value;
       WITH_BASE_PROFILER(call_values->device, opv->op->name, "SchedulingCommunication", {},
-                         { output_value = InvokePrimitive(call_values); });
+                         { output_value = InvokePrimitive(call_values, cached_op_env); });
       return output_value;
     }
     LOG(FATAL) << "ValueError: type " << call_values->callee->GetTypeKey() << " is not callable";
@@ -244,7 +246,14 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
   }
 
  public:
-  Value InvokePrimitive(const CallValues& call) {
+  /*!
+   * \brief Invoke a primitive op.
+   * \param call The call values.
+   * \param cached_op_env The slot of the op env cache for the call. The op env is dispatched and
+   * stored in the slot if the slot is empty, and reused otherwise. Nullptr if it is not cacheable.
+   * \return The output value.
+   */
+  Value InvokePrimitive(const CallValues& call, OpEnvPtr* cached_op_env = nullptr) {
     const Op& op = Downcast<OpValue>(call->callee)->op;
     bool use_upper_bound = false;
     static auto upper_bound_map = Op::GetAttrMap<Op>("TRAFUpperBoundOp");
@@ -259,7 +268,15 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
     ICHECK(call->out.defined()) << "ValueError: Tensor compute of " << op->name
                                 << " is not implemented.";
     AllocOutputBuffer(call->out);
-    std::shared_ptr<OpEnv> op_env = Dispatch(call);
+    std::shared_ptr<OpEnv> op_env;
+    if (cached_op_env != nullptr && *cached_op_env != nullptr) {
+      op_env = *cached_op_env;
+    } else {
+      op_env = Dispatch(call);
+      if (cached_op_env != nullptr) {
+        *cached_op_env = op_env;
+      }
+    }
     if (op_env != nullptr) {
       InvokePrimitiveOpEnv(std::move(op_env), call, use_upper_bound);
     } else {
@@ -318,14 +335,17 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
       for (int i = 0, n = req->stream.size(); i < n; ++i) {
         req->stream[i].stream->Wait();
       }
-      // note: Free the workspace of this op.
+      // note: Free the workspace of this op. The requests are kept so that a cached op env
+      // requests them again in the next invocation.
       WITH_BASE_PROFILER(call->device, op->name, "WorkspaceClear", {}, {
-        req->workspace.clear();
-        req->workspace.shrink_to_fit();
+        for (auto& entry : req->workspace) {
+          entry.memory = nullptr;
+        }
       });
 
-      req->stream.clear();
-      req->stream.shrink_to_fit();
+      for (auto& entry : req->stream) {
+        entry.stream = nullptr;
+      }
     }
 
     // note: The next op holds a reference to this op. It will make sure that the memories requested
@@ -366,6 +386,103 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
     }
   }
 
+ public:
+  /*!
+   * \brief Look up the op env cache of an op call. Eager mode runs the same ops with the same
+   * shapes over and over, so the dispatched op env (i.e., the chosen dialect and its compiled
+   * kernel) is memoized by the op, the shapes and devices of the tensor arguments, and the values
+   * of the other arguments. Each call site first checks the key of its last invocation, then the
+   * cache shared by all call sites of this thread.
+   * \param site The call site.
+   * \param op The op.
+   * \param args The arguments.
+   * \return The slot of the op env in the cache, or nullptr if the arguments are not cacheable.
+   */
+  OpEnvPtr* LookupOpEnvCache(const CallNode* site, const Op& op, const Array<Value>& args) {
+    HashKey key;
+    key << reinterpret_cast<uint64_t>(op.get());
+    for (const auto& arg : args) {
+      if (!HashArg(&key, arg)) {
+        return nullptr;
+      }
+    }
+    std::string key_str(key.byte_vector.begin(), key.byte_vector.end());
+    auto site_it = site_op_env_cache_.find(site);
+    if (site_it != site_op_env_cache_.end() && site_it->second == key_str) {
+      ++op_env_cache_hits_;
+      return &op_env_cache_.at(key_str);
+    }
+    if (op_env_cache_.size() >= kMaxOpEnvCacheSize) {
+      ClearOpEnvCache();
+    }
+    auto it = op_env_cache_.find(key_str);
+    if (it != op_env_cache_.end()) {
+      ++op_env_cache_hits_;
+    } else {
+      ++op_env_cache_misses_;
+      it = op_env_cache_.emplace(key_str, nullptr).first;
+    }
+    site_op_env_cache_[site] = key_str;
+    return &it->second;
+  }
+
+  void ClearOpEnvCache() {
+    op_env_cache_.clear();
+    site_op_env_cache_.clear();
+  }
+
+  /*! \brief The number of hits and misses of the op env cache. */
+  std::pair<int64_t, int64_t> GetOpEnvCacheStats() const {
+    return {op_env_cache_hits_, op_env_cache_misses_};
+  }
+
+ private:
+  /*! \brief Append an argument to the key of the op env cache. Return false if not cacheable. */
+  static bool HashArg(HashKey* key, const Value& arg) {
+    if (!arg.defined()) {
+      *key << static_cast<uint8_t>(0);
+    } else if (arg->IsInstance<TensorValueObj>()) {
+      const DLTensor* t = arg;
+      if (t->strides != nullptr) {
+        return false;
+      }
+      *key << static_cast<uint8_t>(1) << *t << t->device;
+    } else if (const auto* ival = arg.as<IntValueObj>()) {
+      *key << static_cast<uint8_t>(2) << ival->dtype.operator DLDataType() << ival->value;
+    } else if (const auto* fval = arg.as<FloatValueObj>()) {
+      *key << static_cast<uint8_t>(3) << fval->dtype.operator DLDataType() << fval->value;
+    } else if (const auto* bval = arg.as<BoolValueObj>()) {
+      *key << static_cast<uint8_t>(4) << bval->value;
+    } else if (const auto* sval = arg.as<StringValueObj>()) {
+      *key << static_cast<uint8_t>(5) << sval->value;
+    } else if (const auto* tup = arg.as<TupleValueObj>()) {
+      *key << static_cast<uint8_t>(6) << static_cast<int64_t>(tup->fields.size());
+      for (const auto& field : tup->fields) {
+        if (!HashArg(key, field)) {
+          return false;
+        }
+      }
+    } else if (arg->IsInstance<NoGradValueObj>() || arg->IsInstance<VoidValueObj>()) {
+      *key << static_cast<uint8_t>(7);
+    } else {
+      // E.g., closures and references.
+      return false;
+    }
+    return true;
+  }
+
+  /*! \brief The max number of cached op envs, beyond which the cache is cleared. */
+  static constexpr size_t kMaxOpEnvCacheSize = 4096;
+  /*! \brief The op envs shared by all call sites, keyed by the op and the arguments. */
+  std::unordered_map<std::string, OpEnvPtr> op_env_cache_;
+  /*!
+   * \brief The key of the last invocation of each call site. The key is compared in full, so a
+   * call site whose address is reused by another call never hits a stale entry.
+   */
+  std::unordered_map<const CallNode*, std::string> site_op_env_cache_;
+  int64_t op_env_cache_hits_ = 0;
+  int64_t op_env_cache_misses_ = 0;
+
  public:
   void OnBind(const op::OpEnv* op_env) override {
   }
@@ -467,6 +584,14 @@ ObjectRef _Interpret(Expr expr, Optional<IRModule> mod) {
 }
 
 RAF_REGISTER_GLOBAL("raf.executor.Interpret").set_body_typed(_Interpret);
+RAF_REGISTER_GLOBAL("raf.executor.GetInterpreterOpEnvCacheStats").set_body_typed([]() {
+  auto stats = IntrpThreadEntry::ThreadLocal()->GetOpEnvCacheStats();
+  return Map<String, Integer>{{"hit", Integer(static_cast<int>(stats.first))},
+                              {"miss", Integer(static_cast<int>(stats.second))}};
+});
+RAF_REGISTER_GLOBAL("raf.executor.ClearInterpreterOpEnvCache").set_body_typed([]() {
+  IntrpThreadEntry::ThreadLocal()->ClearOpEnvCache();
+});
 }  // namespace interpreter
 }  // namespace executor
 }  // namespace raf
@@ -0,0 +1,200 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/kv_cache.cc
+ * \brief Paged key/value caches for autoregressive decoding.
+ */
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <tvm/runtime/module.h>
+#include "raf/kv_cache.h"
+#include "raf/registry.h"
+
+#ifdef RAF_USE_CUDA
+#include "../common/cuda_utils.h"
+#endif
+
+namespace raf {
+namespace kv_cache {
+
+using namespace raf::ir;
+using namespace raf::value;
+using memory_pool::Memory;
+using registry::PackedFunc;
+
+KVCacheManager::KVCacheManager(const Device& device, DType dtype, int num_layers,
+                               int64_t num_blocks, int64_t block_size,
+                               const std::vector<int64_t>& token_shape)
+    : device_(device), block_size_(block_size) {
+  CHECK_GT(num_layers, 0);
+  CHECK_GT(num_blocks, 0);
+  CHECK_GT(block_size, 0);
+  std::vector<int64_t> shape{num_blocks, block_size};
+  shape.insert(shape.end(), token_shape.begin(), token_shape.end());
+  int64_t nbytes = (dtype.bits * dtype.lanes + 7) / 8;
+  for (auto dim : shape) {
+    nbytes *= dim;
+  }
+  for (int i = 0; i < 2 * num_layers; ++i) {
+    auto mem = Memory::Alloc(device, nbytes);
+    // The unused positions are masked out by the attention, but must not be nan or inf.
+#ifdef RAF_USE_CUDA
+    if (device.device_type() == DevType::kCUDA()) {
+      CUDA_CALL(cudaMemset(mem->data, 0, nbytes));
+    } else
+#endif
+      memset(mem->data, 0, nbytes);
+    caches_.push_back(TensorValue::Assemble(device, dtype, shape, {}, mem->data, mem));
+  }
+  free_blocks_.resize(num_blocks);
+  for (int64_t i = 0; i < num_blocks; ++i) {
+    free_blocks_[i] = num_blocks - 1 - i;
+  }
+}
+
+std::vector<int64_t> KVCacheManager::Append(int64_t seq_id, int64_t num_tokens) {
+  CHECK_GE(num_tokens, 0);
+  auto it = sequences_.find(seq_id);
+  int64_t length = it == sequences_.end() ? 0 : it->second.length;
+  int64_t num_blocks = it == sequences_.end() ? 0 : it->second.blocks.size();
+  int64_t new_blocks = (length + num_tokens + block_size_ - 1) / block_size_ - num_blocks;
+  CHECK_LE(new_blocks, NumFreeBlocks())
+      << "Out of KV cache blocks: " << new_blocks << " more blocks are needed by sequence "
+      << seq_id << ", but only " << NumFreeBlocks() << " are free";
+  Sequence& seq = sequences_[seq_id];
+  for (int64_t i = 0; i < new_blocks; ++i) {
+    seq.blocks.push_back(free_blocks_.back());
+    free_blocks_.pop_back();
+  }
+  std::vector<int64_t> slots(num_tokens);
+  for (int64_t i = 0; i < num_tokens; ++i, ++seq.length) {
+    slots[i] = seq.blocks[seq.length / block_size_] * block_size_ + seq.length % block_size_;
+  }
+  return slots;
+}
+
+std::vector<int64_t> KVCacheManager::BlockTables(const std::vector<int64_t>& seq_ids,
+                                                 int64_t* max_blocks) const {
+  *max_blocks = 1;
+  for (auto seq_id : seq_ids) {
+    auto it = sequences_.find(seq_id);
+    CHECK(it != sequences_.end()) << "Unknown sequence " << seq_id;
+    *max_blocks = std::max<int64_t>(*max_blocks, it->second.blocks.size());
+  }
+  std::vector<int64_t> tables(seq_ids.size() * *max_blocks, 0);
+  for (size_t i = 0; i < seq_ids.size(); ++i) {
+    const auto& blocks = sequences_.at(seq_ids[i]).blocks;
+    std::copy(blocks.begin(), blocks.end(), tables.begin() + i * *max_blocks);
+  }
+  return tables;
+}
+
+int64_t KVCacheManager::SeqLen(int64_t seq_id) const {
+  auto it = sequences_.find(seq_id);
+  return it == sequences_.end() ? 0 : it->second.length;
+}
+
+void KVCacheManager::Free(int64_t seq_id) {
+  auto it = sequences_.find(seq_id);
+  if (it == sequences_.end()) {
+    return;
+  }
+  free_blocks_.insert(free_blocks_.end(), it->second.blocks.rbegin(), it->second.blocks.rend());
+  sequences_.erase(it);
+}
+
+namespace {
+
+/*! \brief Copy an int64 array on the host to a tensor on the device. */
+TensorValue ToTensor(const std::vector<int64_t>& data, const std::vector<int64_t>& shape,
+                     const Device& device) {
+  Device cpu(DevType::kCPU(), 0);
+  int64_t nbytes = std::max<int64_t>(data.size(), 1) * sizeof(int64_t);
+  auto mem = Memory::Alloc(cpu, nbytes);
+  std::memcpy(mem->data, data.data(), data.size() * sizeof(int64_t));
+  auto tensor = TensorValue::Assemble(cpu, DType(DTypeCode::kInt(), 64), shape, {}, mem->data, mem);
+  return Downcast<TensorValue>(CopyTo(tensor, device));
+}
+
+std::vector<int64_t> ToVector(const Array<Integer>& array) {
+  std::vector<int64_t> ret;
+  for (const auto& v : array) {
+    ret.push_back(v->value);
+  }
+  return ret;
+}
+
+/*! \brief The module of a KVCacheManager, whose functions are called by the decoding loop. */
+class KVCacheModule : public tvm::runtime::ModuleNode {
+ public:
+  explicit KVCacheModule(std::unique_ptr<KVCacheManager> manager) : manager_(std::move(manager)) {
+  }
+
+  const char* type_key() const final {
+    return "KVCache";
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "append") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        int64_t num_tokens = args[1];
+        auto slots = manager_->Append(args[0], num_tokens);
+        *rv = ToTensor(slots, {num_tokens}, manager_->device());
+      });
+    } else if (name == "block_tables") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        auto seq_ids = ToVector(args[0]);
+        int64_t max_blocks;
+        auto tables = manager_->BlockTables(seq_ids, &max_blocks);
+        *rv = ToTensor(tables, {static_cast<int64_t>(seq_ids.size()), max_blocks},
+                       manager_->device());
+      });
+    } else if (name == "seq_lens") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        auto seq_ids = ToVector(args[0]);
+        std::vector<int64_t> lens;
+        for (auto seq_id : seq_ids) {
+          lens.push_back(manager_->SeqLen(seq_id));
+        }
+        *rv = ToTensor(lens, {static_cast<int64_t>(seq_ids.size())}, manager_->device());
+      });
+    } else if (name == "free") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        manager_->Free(args[0]);
+      });
+    } else if (name == "num_free_blocks") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        *rv = manager_->NumFreeBlocks();
+      });
+    } else if (name == "caches") {
+      return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+        const auto& caches = manager_->Caches();
+        *rv = Array<Value>(caches.begin(), caches.end());
+      });
+    } else {
+      LOG(FATAL) << "Unknown packed function: " << name;
+      return PackedFunc([sptr_to_self, name](registry::TVMArgs args, registry::TVMRetValue* rv) {});
+    }
+  }
+
+ private:
+  std::unique_ptr<KVCacheManager> manager_;
+};
+
+}  // namespace
+
+RAF_REGISTER_GLOBAL("raf.kv_cache.KVCache")
+    .set_body_typed([](const Device& device, std::string dtype, int num_layers, int64_t num_blocks,
+                       int64_t block_size, Array<Integer> token_shape) {
+      auto manager = std::make_unique<KVCacheManager>(device, String2DLDataType(dtype), num_layers,
+                                                      num_blocks, block_size,
+                                                      ToVector(token_shape));
+      return tvm::runtime::Module(make_object<KVCacheModule>(std::move(manager)));
+    });
+
+}  // namespace kv_cache
+}  // namespace raf
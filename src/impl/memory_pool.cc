@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include "raf/device.h"
 #include "raf/memory_pool.h"
+#include "raf/metrics.h"
 #include "raf/registry.h"
 
 #ifdef RAF_USE_CUDA
@@ -31,7 +32,7 @@ static std::unordered_map<int, std::string> default_strategies = {
 #else
     {DevType(DevType::kCUDA()), "page_unit_pool"},
 #endif
-    {DevType(DevType::kCUDAHost()), "page_unit_pool"},
+    {DevType(DevType::kCUDAHost()), "pinned_host_pool"},
 };
 
 class MemoryPoolManager {
@@ -41,6 +42,13 @@ class MemoryPoolManager {
     return instance;
   }
 
+  MemoryPoolManager() {
+    metrics::Registry::Get()->RegisterCollector(
+        {{"raf_memory_pool_used_mb", "The memory in use of each memory pool in MBs."},
+         {"raf_memory_pool_reserved_mb", "The memory held by each memory pool in MBs."}},
+        [this](std::vector<metrics::MetricSample>* samples) { CollectMetrics(samples); });
+  }
+
   /*!
    * \brief Get an existing memory pool of the given device. If the memory pool for the device
    * is not created, then this function initializes a new one. On the other hand, if the memory
@@ -65,6 +73,31 @@ class MemoryPoolManager {
     return result.get();
   }
 
+  /*! \brief Report the used and reserved sizes of the existing pools to a metrics snapshot. */
+  void CollectMetrics(std::vector<metrics::MetricSample>* samples) {
+    std::lock_guard<std::mutex> lock(reg.mutex_);
+    for (size_t i = 0; i < reg.entries_.size(); ++i) {
+      for (size_t j = 0; j < reg.entries_[i].size(); ++j) {
+        const auto& pool = reg.entries_[i][j];
+        if (pool == nullptr) {
+          continue;
+        }
+        std::string dev = Device(DevType(static_cast<int>(i)), static_cast<int>(j)).c_str();
+        auto size = pool->GetPoolSize();
+        metrics::MetricSample used, reserved;
+        used.name = "raf_memory_pool_used_mb";
+        used.value = size.first;
+        reserved.name = "raf_memory_pool_reserved_mb";
+        reserved.value = size.second;
+        for (auto* sample : {&used, &reserved}) {
+          sample->labels = {{"device", dev}, {"pool", pool->GetName()}};
+          sample->type = metrics::MetricType::kGauge;
+          samples->push_back(*sample);
+        }
+      }
+    }
+  }
+
   void Remove(const Device& dev) {
     std::lock_guard<std::mutex> lock(reg.mutex_);
     std::shared_ptr<MemoryPool>& result = reg.Get(dev);
@@ -75,6 +108,22 @@ class MemoryPoolManager {
   PerDeviceStore<MemoryPool, false> reg;
 };
 
+/*!
+ * \brief Call an allocation function of a pool, and count the failure when the pool runs out of
+ * memory before rethrowing the error.
+ */
+template <typename FAlloc>
+inline auto CountAllocFailure(FAlloc f_alloc) -> decltype(f_alloc()) {
+  static auto* failures = metrics::Registry::Get()->GetCounter(
+      "raf_memory_alloc_failures_total", "The allocations failed by the memory pools.");
+  try {
+    return f_alloc();
+  } catch (const dmlc::Error&) {
+    failures->Inc();
+    throw;
+  }
+}
+
 inline void CheckAlignment(int64_t alignment) {
   CHECK_EQ(alignment % kDefaultMemoryAlignment, 0U)
       << "Requested memory with alignment " << alignment << " is not aligned to "
@@ -89,14 +138,23 @@ int64_t Memory::GetAllocBytes(const Device& dev, int64_t nbytes) {
 std::shared_ptr<Memory> Memory::Alloc(const Device& dev, int64_t nbytes, int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
   CheckAlignment(alignment);
-  return mgr->GetPool(dev, "")->Alloc(nbytes, alignment);
+  auto* pool = mgr->GetPool(dev, "");
+  return CountAllocFailure([&]() { return pool->Alloc(nbytes, alignment); });
 }
 
 std::shared_ptr<Memory> Memory::AllocAsync(const Device& dev, int64_t nbytes, void* stream,
                                            int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
   CheckAlignment(alignment);
-  return mgr->GetPool(dev, "")->AllocAsync(nbytes, stream, alignment);
+  auto* pool = mgr->GetPool(dev, "");
+  return CountAllocFailure([&]() { return pool->AllocAsync(nbytes, stream, alignment); });
+}
+
+std::shared_ptr<Memory> Memory::AllocHost(const Device& dev, int64_t nbytes, int64_t alignment) {
+  if (dev.device_type() == DevType::kCUDA()) {
+    return Alloc(Device(DevType::kCUDAHost(), dev.device_id()), nbytes, alignment);
+  }
+  return Alloc(Device(DevType::kCPU(), 0), nbytes, alignment);
 }
 
 std::vector<std::shared_ptr<Memory> > Memory::AllocBatch(const Device& dev,
@@ -104,7 +162,8 @@ std::vector<std::shared_ptr<Memory> > Memory::AllocBatch(const Device& dev,
                                                          int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
   CheckAlignment(alignment);
-  return mgr->GetPool(dev, "")->AllocBatch(nbytes, alignment);
+  auto* pool = mgr->GetPool(dev, "");
+  return CountAllocFailure([&]() { return pool->AllocBatch(nbytes, alignment); });
 }
 
 std::pair<float, float> Memory::GetPoolSize(const Device& dev) {
@@ -134,6 +193,17 @@ MemoryPool* Memory::InitPool(const Device& dev, const std::string& name) {
   return mgr->GetPool(dev, name);
 }
 
+void Memory::SetTenant(const Device& dev, const std::string& tenant, int64_t reserved_bytes,
+                       int64_t quota_bytes) {
+  MemoryPoolManager* mgr = MemoryPoolManager::Get();
+  mgr->GetPool(dev, "")->SetTenant(tenant, reserved_bytes, quota_bytes);
+}
+
+std::unordered_map<std::string, TenantStats> Memory::GetTenantStats(const Device& dev) {
+  MemoryPoolManager* mgr = MemoryPoolManager::Get();
+  return mgr->GetPool(dev, "")->GetTenantStats();
+}
+
 /*!
  * \brief RemovePool Disable the current memory pool, the memory chuncks in this pool will not
  * be freed unitl there is nobody using to it.
@@ -178,5 +248,27 @@ RAF_REGISTER_GLOBAL("raf.memory_pool.ResetPool").set_body_typed([](const Device&
   return ResetPool(dev);
 });
 
+RAF_REGISTER_GLOBAL("raf.memory_pool.SetTenant")
+    .set_body_typed([](const Device& dev, const std::string tenant, int64_t reserved_bytes,
+                       int64_t quota_bytes) {
+      Memory::SetTenant(dev, tenant, reserved_bytes, quota_bytes);
+    });
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.GetTenantStats").set_body_typed([](const Device& dev) {
+  auto make_int = [](int64_t value) { return ir::IntImm(ir::DataType::Int(64), value); };
+  ir::Map<ir::String, ir::Map<ir::String, ir::IntImm>> ret;
+  for (const auto& kv : Memory::GetTenantStats(dev)) {
+    const TenantStats& stats = kv.second;
+    ret.Set(kv.first, {{"reserved_bytes", make_int(stats.reserved_bytes)},
+                       {"quota_bytes", make_int(stats.quota_bytes)},
+                       {"used_bytes", make_int(stats.used_bytes)},
+                       {"cached_bytes", make_int(stats.cached_bytes)},
+                       {"peak_bytes", make_int(stats.peak_bytes)},
+                       {"num_allocs", make_int(stats.num_allocs)},
+                       {"reclaimed_bytes", make_int(stats.reclaimed_bytes)}});
+  }
+  return ret;
+});
+
 }  // namespace memory_pool
 }  // namespace raf
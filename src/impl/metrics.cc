@@ -0,0 +1,281 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/metrics.cc
+ * \brief The registry of the runtime metrics.
+ */
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include "raf/ir.h"
+#include "raf/metrics.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace metrics {
+
+using namespace raf::ir;
+
+Histogram::Histogram(std::vector<double> bounds) : bounds_(std::move(bounds)) {
+  CHECK(std::is_sorted(bounds_.begin(), bounds_.end()))
+      << "The bucket bounds of a histogram must be in ascending order";
+  counts_.reset(new std::atomic<uint64_t>[bounds_.size() + 1]);
+  for (size_t i = 0; i <= bounds_.size(); ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::Observe(double value) {
+  size_t index = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+  counts_[index].fetch_add(1, std::memory_order_relaxed);
+  double old = sum_.load(std::memory_order_relaxed);
+  while (!sum_.compare_exchange_weak(old, old + value, std::memory_order_relaxed)) {
+  }
+  count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<uint64_t> Histogram::BucketCounts() const {
+  std::vector<uint64_t> ret(bounds_.size() + 1);
+  for (size_t i = 0; i < ret.size(); ++i) {
+    ret[i] = counts_[i].load(std::memory_order_relaxed);
+  }
+  return ret;
+}
+
+void Histogram::Reset() {
+  for (size_t i = 0; i <= bounds_.size(); ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+  sum_.store(0, std::memory_order_relaxed);
+  count_.store(0, std::memory_order_relaxed);
+}
+
+std::vector<double> ExponentialBuckets(double start, double factor, int count) {
+  CHECK(start > 0 && factor > 1 && count > 0) << "Invalid exponential buckets";
+  std::vector<double> ret;
+  for (int i = 0; i < count; ++i, start *= factor) {
+    ret.push_back(start);
+  }
+  return ret;
+}
+
+/*! \brief Render the labels as {k1="v1",k2="v2"}, or an empty string if there is none. */
+std::string LabelsToString(const Labels& labels) {
+  if (labels.empty()) {
+    return "";
+  }
+  std::ostringstream os;
+  os << "{";
+  for (size_t i = 0; i < labels.size(); ++i) {
+    os << (i ? "," : "") << labels[i].first << "=\"";
+    for (char c : labels[i].second) {
+      if (c == '\\' || c == '"') {
+        os << '\\' << c;
+      } else if (c == '\n') {
+        os << "\\n";
+      } else {
+        os << c;
+      }
+    }
+    os << "\"";
+  }
+  os << "}";
+  return os.str();
+}
+
+Registry* Registry::Get() {
+  static Registry* inst = new Registry();
+  return inst;
+}
+
+Registry::Entry* Registry::GetEntry(const std::string& name, const std::string& help,
+                                    const Labels& labels, MetricType type) {
+  auto key = name + LabelsToString(labels);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    CHECK(it->second->type == type) << "The metric " << key << " is registered with another type";
+    return it->second.get();
+  }
+  helps_.emplace(name, help);
+  auto entry = std::make_unique<Entry>();
+  entry->name = name;
+  entry->labels = labels;
+  entry->type = type;
+  auto* ret = entry.get();
+  entries_[key] = std::move(entry);
+  return ret;
+}
+
+Counter* Registry::GetCounter(const std::string& name, const std::string& help,
+                              const Labels& labels) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto* entry = GetEntry(name, help, labels, MetricType::kCounter);
+  if (entry->counter == nullptr) {
+    entry->counter = std::make_unique<Counter>();
+  }
+  return entry->counter.get();
+}
+
+Gauge* Registry::GetGauge(const std::string& name, const std::string& help, const Labels& labels) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto* entry = GetEntry(name, help, labels, MetricType::kGauge);
+  if (entry->gauge == nullptr) {
+    entry->gauge = std::make_unique<Gauge>();
+  }
+  return entry->gauge.get();
+}
+
+Histogram* Registry::GetHistogram(const std::string& name, const std::string& help,
+                                  const std::vector<double>& bounds, const Labels& labels) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto* entry = GetEntry(name, help, labels, MetricType::kHistogram);
+  if (entry->histogram == nullptr) {
+    entry->histogram = std::make_unique<Histogram>(bounds);
+  }
+  return entry->histogram.get();
+}
+
+void Registry::RegisterCollector(const std::vector<std::pair<std::string, std::string>>& helps,
+                                 Collector collector) {
+  std::lock_guard<std::mutex> lock(mu_);
+  for (const auto& kv : helps) {
+    helps_.emplace(kv.first, kv.second);
+  }
+  collectors_.push_back(std::move(collector));
+}
+
+std::vector<MetricSample> Registry::Snapshot() {
+  std::vector<MetricSample> ret;
+  std::vector<Collector> collectors;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& kv : entries_) {
+      const auto& entry = kv.second;
+      MetricSample sample;
+      sample.name = entry->name;
+      sample.labels = entry->labels;
+      sample.type = entry->type;
+      if (entry->type == MetricType::kCounter) {
+        sample.value = entry->counter->Value();
+      } else if (entry->type == MetricType::kGauge) {
+        sample.value = entry->gauge->Value();
+      } else {
+        sample.bounds = entry->histogram->Bounds();
+        sample.bucket_counts = entry->histogram->BucketCounts();
+        sample.sum = entry->histogram->Sum();
+        sample.count = entry->histogram->Count();
+      }
+      ret.push_back(std::move(sample));
+    }
+    collectors = collectors_;
+  }
+  // The collectors may take the locks of their components, so they are called without mu_.
+  for (const auto& collector : collectors) {
+    collector(&ret);
+  }
+  std::sort(ret.begin(), ret.end(), [](const MetricSample& a, const MetricSample& b) {
+    return std::make_pair(a.name, LabelsToString(a.labels)) <
+           std::make_pair(b.name, LabelsToString(b.labels));
+  });
+  return ret;
+}
+
+std::string Registry::ExportPrometheus() {
+  static const char* type_names[] = {"counter", "gauge", "histogram"};
+  auto samples = Snapshot();
+  std::unordered_map<std::string, std::string> helps;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    helps = helps_;
+  }
+  std::ostringstream os;
+  os << std::setprecision(std::numeric_limits<double>::max_digits10);
+  std::string last_name;
+  for (const auto& sample : samples) {
+    if (sample.name != last_name) {
+      os << "# HELP " << sample.name << " " << helps[sample.name] << "\n";
+      os << "# TYPE " << sample.name << " " << type_names[static_cast<int>(sample.type)] << "\n";
+      last_name = sample.name;
+    }
+    if (sample.type != MetricType::kHistogram) {
+      os << sample.name << LabelsToString(sample.labels) << " " << sample.value << "\n";
+      continue;
+    }
+    // The buckets of Prometheus are cumulative.
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < sample.bucket_counts.size(); ++i) {
+      cumulative += sample.bucket_counts[i];
+      auto labels = sample.labels;
+      std::ostringstream le;
+      if (i < sample.bounds.size()) {
+        le << sample.bounds[i];
+      } else {
+        le << "+Inf";
+      }
+      labels.emplace_back("le", le.str());
+      os << sample.name << "_bucket" << LabelsToString(labels) << " " << cumulative << "\n";
+    }
+    os << sample.name << "_sum" << LabelsToString(sample.labels) << " " << sample.sum << "\n";
+    os << sample.name << "_count" << LabelsToString(sample.labels) << " " << sample.count << "\n";
+  }
+  return os.str();
+}
+
+void Registry::Reset() {
+  std::lock_guard<std::mutex> lock(mu_);
+  for (auto& kv : entries_) {
+    auto& entry = kv.second;
+    if (entry->type == MetricType::kCounter) {
+      entry->counter->Reset();
+    } else if (entry->type == MetricType::kGauge) {
+      entry->gauge->Reset();
+    } else {
+      entry->histogram->Reset();
+    }
+  }
+}
+
+RAF_REGISTER_GLOBAL("raf.metrics.Snapshot").set_body_typed([]() {
+  static const char* type_names[] = {"counter", "gauge", "histogram"};
+  Array<Map<String, ObjectRef>> ret;
+  for (const auto& sample : Registry::Get()->Snapshot()) {
+    Map<String, String> labels;
+    for (const auto& kv : sample.labels) {
+      labels.Set(kv.first, kv.second);
+    }
+    Map<String, ObjectRef> item{{"name", String(sample.name)},
+                                {"labels", labels},
+                                {"type", String(type_names[static_cast<int>(sample.type)])}};
+    if (sample.type == MetricType::kHistogram) {
+      Array<FloatImm> bounds;
+      Array<Integer> counts;
+      for (auto bound : sample.bounds) {
+        bounds.push_back(FloatImm(DataType::Float(64), bound));
+      }
+      for (auto count : sample.bucket_counts) {
+        counts.push_back(Integer(static_cast<int64_t>(count)));
+      }
+      item.Set("bounds", bounds);
+      item.Set("bucket_counts", counts);
+      item.Set("sum", FloatImm(DataType::Float(64), sample.sum));
+      item.Set("count", Integer(static_cast<int64_t>(sample.count)));
+    } else {
+      item.Set("value", FloatImm(DataType::Float(64), sample.value));
+    }
+    ret.push_back(item);
+  }
+  return ret;
+});
+
+RAF_REGISTER_GLOBAL("raf.metrics.ExportPrometheus").set_body_typed([]() {
+  return Registry::Get()->ExportPrometheus();
+});
+
+RAF_REGISTER_GLOBAL("raf.metrics.Reset").set_body_typed([]() { Registry::Get()->Reset(); });
+
+}  // namespace metrics
+}  // namespace raf
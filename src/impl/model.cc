@@ -8,6 +8,7 @@
  * \brief Helpers for running models.
  */
 #include "raf/binding.h"
+#include "raf/cache.h"
 #include "raf/ir.h"
 #include "raf/value.h"
 #include "raf/registry.h"
@@ -31,6 +32,68 @@ using pass::BindParam;
 using pass::CanonicalizeOps;
 using pass::FoldConstant;
 
+/*!
+ * \brief The metrics of the executor caches of the Python models, which keep the executable and the
+ * VM compiled for each input signature. The entries are kept by the models, which report their
+ * lookups and releases here, and each model keeps at most the capacity of this cache.
+ */
+class ModelExecutorCacheMetric : public op::MetaCacheMetric {
+ public:
+  ModelExecutorCacheMetric() {
+    Register("model_executor");
+  }
+
+  ~ModelExecutorCacheMetric() {
+    Unregister();
+  }
+
+  void RecordGet(bool hit) {
+    AddMetric(kCacheGet);
+    AddMetric(hit ? kCacheHit : kCacheMiss);
+  }
+
+  void RecordSet() {
+    AddMetric(kCacheSet);
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void RecordRelease(size_t num, bool evicted) {
+    size_.fetch_sub(num, std::memory_order_relaxed);
+    if (evicted) {
+      num_evictions_.fetch_add(num, std::memory_order_relaxed);
+    }
+  }
+
+  size_t Capacity() const {
+    return capacity_.load();
+  }
+
+  void SetCapacity(size_t capacity) override {
+    capacity_.store(capacity);
+  }
+
+  size_t Size() override {
+    return size_.load();
+  }
+
+  size_t NumEvictions() const override {
+    return num_evictions_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  /*! \brief The maximum number of entries per model, or 0 for unbounded. */
+  std::atomic<size_t> capacity_{kDefaultCapacity};
+  /*! \brief The number of entries kept by all models. */
+  std::atomic<size_t> size_{0};
+  /*! \brief The number of evicted entries. */
+  std::atomic<size_t> num_evictions_{0};
+  /*! \brief The default capacity, as each entry keeps the buffers of a VM. */
+  static constexpr size_t kDefaultCapacity = 8;
+};
+
+// Registered on loading, so that its metrics are available before the first lookup.
+ModelExecutorCacheMetric ModelExecutorCache;
+
 ObjectRef RunModel(ir::IRModule mod, Array<Expr> args) {
   ir::IRModule updated_mod = ir::IRModule(mod->functions);
   std::vector<GradTape> grads;
@@ -92,6 +155,19 @@ ObjectRef RunModel(ir::IRModule mod, Array<Expr> args) {
 }
 
 RAF_REGISTER_GLOBAL("raf.model.RunModel").set_body_typed(RunModel);
+RAF_REGISTER_GLOBAL("raf.model.RecordExecutorCacheGet").set_body_typed([](bool hit) {
+  ModelExecutorCache.RecordGet(hit);
+});
+RAF_REGISTER_GLOBAL("raf.model.RecordExecutorCacheSet").set_body_typed([]() {
+  ModelExecutorCache.RecordSet();
+});
+RAF_REGISTER_GLOBAL("raf.model.RecordExecutorCacheRelease")
+    .set_body_typed([](int64_t num, bool evicted) {
+      ModelExecutorCache.RecordRelease(num, evicted);
+    });
+RAF_REGISTER_GLOBAL("raf.model.GetExecutorCacheCapacity").set_body_typed([]() {
+  return static_cast<int64_t>(ModelExecutorCache.Capacity());
+});
 
 }  // namespace model
 }  // namespace raf
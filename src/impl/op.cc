@@ -8,6 +8,11 @@
  * \brief RAF operator interface underlying implementation
  */
 #include <tvm/runtime/device_api.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include "dmlc/registry.h"
 #include "raf/executor.h"
 #include "raf/ir.h"
@@ -214,7 +219,52 @@ OpEnvPtr Dispatch(const CallValues& call) {
   return nullptr;
 }
 
+std::vector<OpEnvPtr> DispatchParallel(const std::vector<CallValues>& calls, int num_threads) {
+  std::vector<OpEnvPtr> op_envs(calls.size());
+  std::atomic<size_t> next(0);
+  std::exception_ptr error = nullptr;
+  std::mutex error_mu;
+  auto workload = [&]() {
+    for (size_t i = next++; i < calls.size(); i = next++) {
+      try {
+        op_envs[i] = Dispatch(calls[i]);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mu);
+        if (error == nullptr) {
+          error = std::current_exception();
+        }
+      }
+    }
+  };
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  num_threads = std::max(1, std::min(num_threads, static_cast<int>(calls.size())));
+  if (num_threads == 1) {
+    workload();
+  } else {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.emplace_back(workload);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+  return op_envs;
+}
+
 CallValues CreateDummyCallValues(Call call, Device device) {
+  return CreateDummyCallValues(call, device, [&device](const Type& type) {
+    return value::CreateDummyValueFromType(type, device);
+  });
+}
+
+CallValues CreateDummyCallValues(Call call, Device device,
+                                 const std::function<Value(const Type&)>& make_dummy) {
   auto call_node = call.as<CallNode>();
   CHECK(call_node != nullptr);
   std::vector<Value> inputs(call_node->args.size());
@@ -225,10 +275,10 @@ CallValues CreateDummyCallValues(Call call, Device device) {
       CHECK(node != nullptr);
       inputs[i] = Downcast<Value>(node->value);
     } else {
-      inputs[i] = value::CreateDummyValueFromType(arg_expr->checked_type(), device);
+      inputs[i] = make_dummy(arg_expr->checked_type());
     }
   }
-  Value output = value::CreateDummyValueFromType(call->checked_type(), device);
+  Value output = make_dummy(call->checked_type());
   CallValues call_values = CallValues::make();
   Expr callee = call_node->op;
   if (auto fused_op_node = callee.as<FunctionNode>()) {
@@ -262,6 +312,8 @@ Array<Value> GetListArgs(const Attrs& attrs) {
 
 std::string GetUniqueName(std::string name) {
   static std::unordered_map<std::string, int> name_map;
+  static std::mutex mu;
+  std::lock_guard<std::mutex> lock(mu);
   for (size_t i = 0; i < name.length(); ++i) {
     if (name[i] == '.') name[i] = '_';
   }
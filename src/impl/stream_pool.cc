@@ -34,8 +34,9 @@ int Tag::GetTagIndex_(const std::string& tag) {
 
 class Stream::Impl {
  public:
-  explicit Impl(const Device& dev) : device(dev), api(DeviceAPI::Get(dev.device_type())) {
-    this->stream = api->CreateStream(dev);
+  explicit Impl(const Device& dev, int priority)
+      : device(dev), api(DeviceAPI::Get(dev.device_type())), priority(priority) {
+    this->stream = api->CreateStream(dev, priority);
   }
 
   ~Impl() {
@@ -48,6 +49,7 @@ class Stream::Impl {
   Device device;
   std::shared_ptr<DeviceAPI> api;
   void* stream;
+  int priority;
 };
 
 class StreamPool {
@@ -56,15 +58,18 @@ class StreamPool {
   }
 
   ~StreamPool() {
-    for (auto& i : pool) {
-      for (auto& j : i) {
-        j = nullptr;
+    for (auto& kv : pools) {
+      for (auto& i : kv.second) {
+        for (auto& j : i) {
+          j = nullptr;
+        }
       }
     }
   }
 
-  std::shared_ptr<Stream> GetStream(int tag_index, int index) {
+  std::shared_ptr<Stream> GetStream(int tag_index, int index, int priority) {
     std::lock_guard<std::mutex> lock(mutex);
+    auto& pool = pools[priority];
     if (tag_index >= static_cast<int>(pool.size())) {
       pool.resize(tag_index + 1);
     }
@@ -72,7 +77,7 @@ class StreamPool {
       pool[tag_index].resize(index + 1);
     }
     if (pool[tag_index][index] == nullptr) {
-      pool[tag_index][index] = std::make_shared<Stream>(new Stream::Impl(device));
+      pool[tag_index][index] = std::make_shared<Stream>(new Stream::Impl(device, priority));
     }
     return pool[tag_index][index];
   }
@@ -93,7 +98,8 @@ class StreamPool {
  public:
   Device device;
   std::shared_ptr<DeviceAPI> api;
-  std::vector<std::vector<std::shared_ptr<Stream>>> pool;
+  /*! \brief The streams of each priority, indexed by the tag and the index. */
+  std::unordered_map<int, std::vector<std::vector<std::shared_ptr<Stream>>>> pools;
   std::mutex mutex;
 };
 
@@ -106,12 +112,20 @@ void* Stream::data() const {
   return impl ? impl->stream : nullptr;
 }
 
+int Stream::priority() const {
+  return impl ? impl->priority : kDefaultPriority;
+}
+
 void Stream::Wait() const {
   impl->api->WaitStream(data());
 }
 
-std::shared_ptr<Stream> Stream::Get(const Device& dev, int tag_index, int index) {
-  return StreamPool::Get(dev)->GetStream(tag_index, index);
+std::shared_ptr<Stream> Stream::Get(const Device& dev, int tag_index, int index, int priority) {
+  return StreamPool::Get(dev)->GetStream(tag_index, index, priority);
+}
+
+std::shared_ptr<Stream> Stream::Create(const Device& dev, int priority) {
+  return std::make_shared<Stream>(new Stream::Impl(dev, priority));
 }
 
 }  // namespace stream_pool
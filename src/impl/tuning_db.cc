@@ -0,0 +1,239 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/tuning_db.cc
+ * \brief Implementation of the tuning database.
+ */
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include "dmlc/logging.h"
+#include "raf/file.h"
+#include "raf/registry.h"
+#include "raf/tuning_db.h"
+
+namespace raf {
+namespace op {
+
+namespace {
+
+/*! \brief The magic number at the beginning of each record. */
+constexpr uint32_t kRecordMagic = 0x54464152;  // "RAFT"
+
+/*! \brief The header of a record, which is followed by the key and the value. */
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t key_size;
+  uint32_t value_size;
+  /*! \brief The FNV-1a hash of the key and the value to detect corruption. */
+  uint32_t checksum;
+};
+
+uint32_t Checksum(const std::string& key, const std::string& value) {
+  uint32_t hash = 2166136261u;
+  for (const std::string* str : {&key, &value}) {
+    for (unsigned char c : *str) {
+      hash = (hash ^ c) * 16777619u;
+    }
+  }
+  return hash;
+}
+
+/*! \brief RAII wrapper of a file descriptor locked by flock(2). */
+class LockedFile {
+ public:
+  LockedFile(const std::string& path, int flags, int lock) {
+    fd_ = open(path.c_str(), flags, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd_ != -1 && flock(fd_, lock) == -1) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  ~LockedFile() {
+    if (fd_ != -1) {
+      flock(fd_, LOCK_UN);
+      close(fd_);
+    }
+  }
+
+  int fd() const {
+    return fd_;
+  }
+
+ private:
+  int fd_;
+};
+
+}  // namespace
+
+TuningDatabase::TuningDatabase(const std::string& path) : path_(path) {
+  if (!path_.empty()) {
+    int64_t n = ReadLog(path_, &offset_);
+    DLOG(INFO) << "Loaded " << n << " records from tuning database " << path_;
+  }
+}
+
+TuningDatabase* TuningDatabase::Global() {
+  static TuningDatabase* db = []() {
+    std::string path;
+    const char* db_path = getenv("RAF_TUNING_DB");
+    const char* enable_persist = getenv("RAF_PERSIST_CACHE");
+    if (db_path != nullptr) {
+      path = db_path;
+    } else if (enable_persist != nullptr && strcmp(enable_persist, "1") == 0) {
+      const char* cache_path = getenv("RAF_PERSIST_CACHE_PATH");
+      std::string root;
+      if (cache_path == nullptr) {
+        const char* home = getenv("HOME");
+        CHECK(home != nullptr) << "HOME environment variable is not set";
+        root = std::string(home) + "/.raf_cache";
+      } else {
+        root = cache_path;
+      }
+      CreateDir(root);
+      path = root + "/tuning.db";
+    }
+    auto* db = new TuningDatabase(path);
+    const char* imports = getenv("RAF_TUNING_DB_IMPORT");
+    if (imports != nullptr) {
+      std::istringstream is(imports);
+      std::string import_path;
+      while (std::getline(is, import_path, ':')) {
+        if (!import_path.empty()) {
+          db->Import(import_path);
+        }
+      }
+    }
+    return db;
+  }();
+  return db;
+}
+
+bool TuningDatabase::Get(const std::string& key, std::string* value) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto it = index_.find(key);
+  if (it == index_.end() && !path_.empty() && ReadLog(path_, &offset_) > 0) {
+    // The record may have been appended by another process.
+    it = index_.find(key);
+  }
+  if (it == index_.end()) {
+    return false;
+  }
+  *value = it->second;
+  return true;
+}
+
+void TuningDatabase::Put(const std::string& key, const std::string& value) {
+  std::lock_guard<std::mutex> lock(mu_);
+  index_[key] = value;
+  if (path_.empty()) {
+    return;
+  }
+  RecordHeader header{kRecordMagic, static_cast<uint32_t>(key.size()),
+                      static_cast<uint32_t>(value.size()), Checksum(key, value)};
+  std::string record(reinterpret_cast<const char*>(&header), sizeof(header));
+  record += key;
+  record += value;
+
+  // The exclusive lock keeps the records of concurrent processes from interleaving.
+  LockedFile file(path_, O_WRONLY | O_APPEND | O_CREAT, LOCK_EX);
+  if (file.fd() == -1) {
+    LOG(WARNING) << "Failed to open tuning database " << path_ << ": " << strerror(errno);
+    return;
+  }
+  size_t written = 0;
+  while (written < record.size()) {
+    ssize_t n = write(file.fd(), record.data() + written, record.size() - written);
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG(WARNING) << "Failed to append to tuning database " << path_ << ": " << strerror(errno);
+      return;
+    }
+    written += n;
+  }
+}
+
+int64_t TuningDatabase::Import(const std::string& path) {
+  std::lock_guard<std::mutex> lock(mu_);
+  int64_t offset = 0;
+  int64_t n = ReadLog(path, &offset);
+  DLOG(INFO) << "Imported " << n << " records from tuning database " << path;
+  return n;
+}
+
+size_t TuningDatabase::Size() {
+  std::lock_guard<std::mutex> lock(mu_);
+  return index_.size();
+}
+
+int64_t TuningDatabase::ReadLog(const std::string& path, int64_t* offset) {
+  // The shared lock makes sure no record is half written.
+  LockedFile file(path, O_RDONLY, LOCK_SH);
+  if (file.fd() == -1) {
+    return 0;
+  }
+  struct stat st;
+  if (fstat(file.fd(), &st) == -1 || st.st_size <= *offset) {
+    return 0;
+  }
+  std::string data(st.st_size - *offset, '\0');
+  ssize_t n_read = pread(file.fd(), &data[0], data.size(), *offset);
+  if (n_read < 0) {
+    LOG(WARNING) << "Failed to read tuning database " << path << ": " << strerror(errno);
+    return 0;
+  }
+  data.resize(n_read);
+
+  int64_t n_records = 0;
+  size_t pos = 0;
+  while (pos + sizeof(RecordHeader) <= data.size()) {
+    RecordHeader header;
+    memcpy(&header, data.data() + pos, sizeof(header));
+    size_t end = pos + sizeof(header) + header.key_size + header.value_size;
+    if (header.magic != kRecordMagic || end > data.size()) {
+      LOG(WARNING) << "Corrupted tuning database " << path << " at offset " << *offset + pos
+                   << ", the remaining records are ignored";
+      pos = data.size();
+      break;
+    }
+    std::string key = data.substr(pos + sizeof(header), header.key_size);
+    std::string value = data.substr(pos + sizeof(header) + header.key_size, header.value_size);
+    if (Checksum(key, value) == header.checksum) {
+      index_[key] = value;
+      ++n_records;
+    } else {
+      LOG(WARNING) << "Skipped a corrupted record in tuning database " << path << " at offset "
+                   << *offset + pos;
+    }
+    pos = end;
+  }
+  *offset += pos;
+  return n_records;
+}
+
+RAF_REGISTER_GLOBAL("raf.cache.ImportTuningDB").set_body_typed([](std::string path) {
+  return TuningDatabase::Global()->Import(path);
+});
+
+RAF_REGISTER_GLOBAL("raf.cache.GetTuningRecord").set_body_typed([](std::string key) {
+  std::string value;
+  return TuningDatabase::Global()->Get(key, &value) ? value : std::string();
+});
+
+RAF_REGISTER_GLOBAL("raf.cache.PutTuningRecord")
+    .set_body_typed([](std::string key, std::string value) {
+      TuningDatabase::Global()->Put(key, value);
+    });
+
+}  // namespace op
+}  // namespace raf
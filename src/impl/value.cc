@@ -27,7 +27,9 @@
 namespace raf {
 namespace value {
 
+using common::shape_utils::BytesCompactTensor;
 using common::shape_utils::GetShape;
+using common::shape_utils::IsCompact;
 using common::shape_utils::MakeShape;
 using executor::Executor;
 using tensor::Tensor;
@@ -343,7 +345,18 @@ Value CopyTo(Value src, const Device& dev) {
   }
   if (src.as<TensorValueObj>()) {
     auto tensor = Downcast<TensorValue>(src)->tensor;
-    if (tensor->device.device_type != dev.device_type()) {
+    if (dev.device_type() == DevType::kCPU() && tensor->device.device_type == kDLCUDA &&
+        IsCompact(*tensor.operator->())) {
+      // Fetch the tensor to pinned memory so that the copy runs at full bandwidth.
+      std::vector<int64_t> shape(tensor->shape, tensor->shape + tensor->ndim);
+      auto mem = memory_pool::Memory::AllocHost(Device(tensor->device),
+                                                BytesCompactTensor(*tensor.operator->()));
+      auto ret = TensorValue::Assemble(dev, tensor->dtype, shape, {}, mem->data, mem);
+      tensor.CopyTo(ret->tensor);
+      return ret;
+    }
+    if (tensor->device.device_type != dev.device_type() ||
+        tensor->device.device_id != dev.device_id()) {
       return TensorValue::make(tensor::Tensor(tensor.CopyTo(dev)));
     }
     return src;
@@ -428,6 +441,9 @@ RAF_REGISTER_GLOBAL("raf.value.AssembleTensorValue")
 RAF_REGISTER_GLOBAL("raf.value.DeTuple").set_body_typed(DeTuple);
 RAF_REGISTER_GLOBAL("raf.value.FromTVM").set_body_typed(FromTVM);
 RAF_REGISTER_GLOBAL("raf.value.ToTVM").set_body_typed(ToTVM);
+RAF_REGISTER_GLOBAL("raf.value.CopyTo").set_body_typed([](Value src, const Device& dev) {
+  return CopyTo(src, dev);
+});
 RAF_REGISTER_GLOBAL("raf.value._make.TupleValue").set_body_typed(TupleValue::make);
 RAF_REGISTER_GLOBAL("raf.value._make.IntValue").set_body_typed(IntValue::make);
 RAF_REGISTER_GLOBAL("raf.value._make.FloatValue").set_body_typed(FloatValue::make);
@@ -0,0 +1,100 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/async_dispatcher.cc
+ * \brief The implementation of the asynchronous dispatcher.
+ */
+#include <utility>
+
+#include "raf/device_api.h"
+#include "./async_dispatcher.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using device_api::DeviceAPI;
+
+AsyncDispatcher::AsyncDispatcher(const Device& device, int depth)
+    : device_(device), ring_(depth) {
+  CHECK_GE(depth, 1) << "The dispatch depth must be positive";
+  worker_ = std::thread([this]() { DispatchLoop(); });
+}
+
+AsyncDispatcher::~AsyncDispatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  not_empty_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+FutureValue AsyncDispatcher::Submit(Launch launch) {
+  auto future = make_object<FutureValueObj>();
+  future->device = device_;
+  std::lock_guard<std::mutex> submit_lock(submit_mu_);
+  std::unique_lock<std::mutex> lock(mu_);
+  not_full_.wait(lock, [this]() { return tail_ - head_ < ring_.size(); });
+  Request& request = ring_[tail_ % ring_.size()];
+  request.launch = std::move(launch);
+  request.future = future;
+  request.launched = std::promise<void>();
+  future->launched = request.launched.get_future().share();
+  ++tail_;
+  lock.unlock();
+  not_empty_.notify_one();
+  return FutureValue(future);
+}
+
+void AsyncDispatcher::Wait() {
+  std::unique_lock<std::mutex> lock(mu_);
+  not_full_.wait(lock, [this]() { return head_ == tail_ && !busy_; });
+}
+
+void AsyncDispatcher::DispatchLoop() {
+  DeviceAPI::Get(device_.device_type())->SetDevice(device_.device_id());
+  while (true) {
+    Launch launch;
+    ObjectPtr<FutureValueObj> future;
+    std::promise<void> launched;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      // The pending executions are still launched once the dispatcher is stopped.
+      not_empty_.wait(lock, [this]() { return head_ != tail_ || stop_; });
+      if (head_ == tail_) {
+        return;
+      }
+      Request& request = ring_[head_ % ring_.size()];
+      launch = std::move(request.launch);
+      future = std::move(request.future);
+      launched = std::move(request.launched);
+      ++head_;
+      busy_ = true;
+    }
+    not_full_.notify_all();
+    try {
+      FutureValue result = launch();
+      // The fields are published to the readers of the future by the promise.
+      future->value = result->value;
+      future->event = result->event;
+      launched.set_value();
+    } catch (...) {
+      launched.set_exception(std::current_exception());
+    }
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      busy_ = false;
+    }
+    not_full_.notify_all();
+  }
+}
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
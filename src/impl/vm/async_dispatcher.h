@@ -0,0 +1,97 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/async_dispatcher.h
+ * \brief The dispatcher that runs the VM executions on a dedicated host thread.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "raf/device.h"
+#include "raf/vm/value.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+/*!
+ * \brief The dispatcher that runs the VM executions in order on a dedicated host thread, so that
+ * the host overhead of launching the kernels of execution N + 1 overlaps with the work of the
+ * caller after submitting execution N (e.g., the Python bookkeeping of a training step).
+ *
+ * The executions are passed through a bounded single-producer single-consumer ring. A submitted
+ * execution returns a FutureValue immediately, which completes once the execution is launched
+ * and its kernels are finished. The producer blocks if there are already depth executions
+ * waiting to be launched. Concurrent producers are serialized.
+ */
+class AsyncDispatcher {
+ public:
+  /*! \brief An execution to launch, which returns the future of its outputs. */
+  using Launch = std::function<FutureValue()>;
+
+  /*!
+   * \param device The device of the executions, which is set on the dispatch thread.
+   * \param depth The max number of executions waiting to be launched.
+   */
+  AsyncDispatcher(const Device& device, int depth);
+
+  /*! \brief Launch the pending executions and stop the dispatch thread. */
+  ~AsyncDispatcher();
+
+  /*!
+   * \brief Submit an execution to launch on the dispatch thread.
+   * \param launch The execution.
+   * \return The future of the outputs. The errors of the launch are rethrown by its Get.
+   */
+  FutureValue Submit(Launch launch);
+
+  /*! \brief Wait until all submitted executions are launched. */
+  void Wait();
+
+ private:
+  /*! \brief An execution in the ring. */
+  struct Request {
+    Launch launch;
+    /*! \brief The future returned to the caller, which is filled once launched. */
+    ObjectPtr<FutureValueObj> future;
+    std::promise<void> launched;
+  };
+
+  /*! \brief The loop of the dispatch thread. */
+  void DispatchLoop();
+
+  /*! \brief The device of the executions. */
+  Device device_;
+  /*! \brief The ring of the executions, of which [head_, tail_) are pending. */
+  std::vector<Request> ring_;
+  /*! \brief The number of popped executions. */
+  uint64_t head_ = 0;
+  /*! \brief The number of pushed executions. */
+  uint64_t tail_ = 0;
+  /*! \brief Indicates whether an execution is being launched. */
+  bool busy_ = false;
+  /*! \brief Indicates whether the dispatch thread should exit. */
+  bool stop_ = false;
+  /*! \brief Serializes the producers. */
+  std::mutex submit_mu_;
+  std::mutex mu_;
+  /*! \brief Notifies the dispatch thread of a new execution. */
+  std::condition_variable not_empty_;
+  /*! \brief Notifies the producers of a free slot, or the waiters of an empty ring. */
+  std::condition_variable not_full_;
+  std::thread worker_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,293 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/batching_executor.cc
+ * \brief The implementation of the dynamic request batching executor.
+ */
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+#include "./batching_executor.h"
+#include "../../common/shape_utils.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using common::shape_utils::BytesCompactTensor;
+using common::shape_utils::IsCompact;
+
+/*!
+ * \brief Copy rows along axis 0 between two compact tensors of the same row shape.
+ * \param src The source tensor.
+ * \param src_row The first row to copy from.
+ * \param dst The destination tensor.
+ * \param dst_row The first row to copy to.
+ * \param num_rows The number of rows to copy.
+ */
+void CopyRows(const DLTensor* src, int64_t src_row, DLTensor* dst, int64_t dst_row,
+              int64_t num_rows) {
+  CHECK(IsCompact(*src) && IsCompact(*dst)) << "Only compact tensors can be batched";
+  int64_t row_bytes = BytesCompactTensor(*src) / src->shape[0];
+  std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+  shape[0] = num_rows;
+  DLTensor src_view = *src;
+  src_view.shape = shape.data();
+  src_view.strides = nullptr;
+  src_view.byte_offset += src_row * row_bytes;
+  DLTensor dst_view = *dst;
+  dst_view.shape = shape.data();
+  dst_view.strides = nullptr;
+  dst_view.byte_offset += dst_row * row_bytes;
+  tvm::runtime::NDArray::CopyFromTo(&src_view, &dst_view);
+}
+
+/*!
+ * \brief Allocate a tensor with the same row shape as the given tensor.
+ * \param like The tensor to follow.
+ * \param num_rows The number of rows.
+ * \return The allocated tensor.
+ */
+TensorValue AllocRows(const DLTensor* like, int64_t num_rows) {
+  std::vector<int64_t> shape(like->shape, like->shape + like->ndim);
+  shape[0] = num_rows;
+  int64_t nbytes = BytesCompactTensor(*like) / like->shape[0] * num_rows;
+  Device dev = like->device;
+  auto mem = memory_pool::Memory::Alloc(dev, nbytes);
+  return TensorValue::Assemble(dev, like->dtype, shape, {}, mem->data, mem);
+}
+
+/*!
+ * \brief Take the rows of a request from the batched output. Tensors that are not batched (i.e.,
+ * whose first dimension is not the batch size) are shared by all requests.
+ */
+Value SliceOutput(const Value& output, int64_t offset, int64_t batch_size,
+                  int64_t padded_batch_size) {
+  if (const auto* tuple = output.as<TupleValueObj>()) {
+    Array<Value> fields;
+    for (const auto& field : tuple->fields) {
+      fields.push_back(SliceOutput(field, offset, batch_size, padded_batch_size));
+    }
+    return TupleValue::make(fields);
+  }
+  if (const auto* tensor = output.as<TensorValueObj>()) {
+    const DLTensor* dl_tensor = tensor->tensor.operator->();
+    if (dl_tensor->ndim > 0 && dl_tensor->shape[0] == padded_batch_size) {
+      TensorValue ret = AllocRows(dl_tensor, batch_size);
+      CopyRows(dl_tensor, offset, ret, 0, batch_size);
+      return ret;
+    }
+  }
+  return output;
+}
+
+BatchingExecutor::BatchingExecutor(tvm::runtime::Module vm, std::string func_name,
+                                   std::vector<int> batched_args, int64_t max_batch_size,
+                                   int64_t max_delay_us, std::vector<int64_t> batch_buckets)
+    : vm_module_(vm),
+      func_name_(std::move(func_name)),
+      max_batch_size_(max_batch_size),
+      max_delay_(max_delay_us),
+      batch_buckets_(std::move(batch_buckets)) {
+  vm_ = dynamic_cast<VirtualMachine*>(vm_module_.operator->());
+  CHECK(vm_) << "The batching executor requires a virtual machine.";
+  CHECK(!batched_args.empty()) << "At least one argument should be batched.";
+  CHECK_GT(max_batch_size_, 0);
+  first_batched_arg_ = *std::min_element(batched_args.begin(), batched_args.end());
+  CHECK_GE(first_batched_arg_, 0);
+  for (int i : batched_args) {
+    if (is_batched_.size() <= i) {
+      is_batched_.resize(i + 1, false);
+    }
+    is_batched_[i] = true;
+  }
+  std::sort(batch_buckets_.begin(), batch_buckets_.end());
+  worker_ = std::thread([this]() { WorkerLoop(); });
+}
+
+BatchingExecutor::~BatchingExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+Value BatchingExecutor::Infer(const std::vector<Value>& inputs) {
+  CHECK_GT(inputs.size(), first_batched_arg_) << "Missing the batched arguments";
+  const auto* tensor = inputs[first_batched_arg_].as<TensorValueObj>();
+  CHECK(tensor && tensor->tensor->ndim > 0) << "The batched arguments should be tensors";
+  auto request = std::make_shared<Request>();
+  request->inputs = inputs;
+  request->batch_size = tensor->tensor->shape[0];
+  request->arrival = std::chrono::steady_clock::now();
+  std::future<Value> future = request->promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    CHECK(!stop_) << "The batching executor has been stopped";
+    queued_batch_size_ += request->batch_size;
+    queue_.push_back(std::move(request));
+  }
+  cv_.notify_all();
+  return future.get();
+}
+
+bool BatchingExecutor::CanCoalesce(const Request& a, const Request& b) const {
+  if (a.inputs.size() != b.inputs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.inputs.size(); ++i) {
+    if (i < is_batched_.size() && is_batched_[i]) {
+      continue;
+    }
+    if (!a.inputs[i].same_as(b.inputs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int64_t BatchingExecutor::GetPaddedBatchSize(int64_t batch_size) const {
+  auto it = std::lower_bound(batch_buckets_.begin(), batch_buckets_.end(), batch_size);
+  return it == batch_buckets_.end() ? batch_size : *it;
+}
+
+void BatchingExecutor::WorkerLoop() {
+  while (true) {
+    std::vector<std::shared_ptr<Request>> batch;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      // Wait for more requests until the batch is full or the oldest request hits the deadline.
+      auto deadline = queue_.front()->arrival + max_delay_;
+      cv_.wait_until(lock, deadline,
+                     [this]() { return stop_ || queued_batch_size_ >= max_batch_size_; });
+      // Take the requests in the arrival order. Requests that cannot be coalesced with the first
+      // one are left for the following batches.
+      int64_t total_batch_size = 0;
+      for (auto it = queue_.begin(); it != queue_.end();) {
+        const auto& request = *it;
+        if (!batch.empty() && total_batch_size + request->batch_size > max_batch_size_) {
+          break;
+        }
+        if (!batch.empty() && !CanCoalesce(*batch[0], *request)) {
+          ++it;
+          continue;
+        }
+        total_batch_size += request->batch_size;
+        queued_batch_size_ -= request->batch_size;
+        batch.push_back(request);
+        it = queue_.erase(it);
+      }
+    }
+    RunBatch(batch);
+  }
+}
+
+void BatchingExecutor::RunBatch(const std::vector<std::shared_ptr<Request>>& batch) {
+  int64_t total_batch_size = 0;
+  for (const auto& request : batch) {
+    total_batch_size += request->batch_size;
+  }
+  int64_t padded_batch_size = GetPaddedBatchSize(total_batch_size);
+  std::vector<Value> results;
+  try {
+    const auto& first_inputs = batch[0]->inputs;
+    std::vector<Value> inputs(first_inputs.size());
+    for (size_t i = 0; i < first_inputs.size(); ++i) {
+      if (i >= is_batched_.size() || !is_batched_[i]) {
+        inputs[i] = first_inputs[i];
+        continue;
+      }
+      const DLTensor* first = Downcast<TensorValue>(first_inputs[i]);
+      TensorValue batched = AllocRows(first, padded_batch_size);
+      int64_t offset = 0;
+      const DLTensor* last = nullptr;
+      for (const auto& request : batch) {
+        last = Downcast<TensorValue>(request->inputs[i]);
+        CHECK_EQ(last->ndim, first->ndim) << "Mismatched rank of the batched argument " << i;
+        CHECK(last->dtype == first->dtype) << "Mismatched dtype of the batched argument " << i;
+        for (int d = 1; d < first->ndim; ++d) {
+          CHECK_EQ(last->shape[d], first->shape[d]) << "Mismatched shape of argument " << i;
+        }
+        CopyRows(last, 0, batched, offset, last->shape[0]);
+        offset += last->shape[0];
+      }
+      // Pad with the rows of the last request, so that the padded rows still hold valid data.
+      while (offset < padded_batch_size) {
+        int64_t num_rows = std::min(last->shape[0], padded_batch_size - offset);
+        CopyRows(last, 0, batched, offset, num_rows);
+        offset += num_rows;
+      }
+      inputs[i] = batched;
+    }
+    auto ctx = vm_->PrepareVMContext(func_name_, inputs);
+    Value output = vm_->Run(ctx);
+    vm_->ReleaseVMContext(ctx);
+    int64_t offset = 0;
+    for (const auto& request : batch) {
+      results.push_back(SliceOutput(output, offset, request->batch_size, padded_batch_size));
+      offset += request->batch_size;
+    }
+  } catch (...) {
+    for (const auto& request : batch) {
+      request->promise.set_exception(std::current_exception());
+    }
+    return;
+  }
+  for (size_t i = 0; i < batch.size(); ++i) {
+    batch[i]->promise.set_value(results[i]);
+  }
+}
+
+PackedFunc BatchingExecutor::GetFunction(const std::string& name,
+                                         const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "infer") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::vector<Value> inputs(args.size());
+      for (int i = 0; i < args.size(); ++i) {
+        inputs[i] = args[i];
+      }
+      *rv = Infer(inputs);
+    });
+  } else {
+    LOG(FATAL) << "Unknown packed function: " << name;
+    return PackedFunc([sptr_to_self, name](registry::TVMArgs args, registry::TVMRetValue* rv) {});
+  }
+}
+
+RAF_REGISTER_GLOBAL("raf.vm.BatchingExecutor")
+    .set_body([](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
+      tvm::runtime::Module vm = args[0];
+      std::string func_name = args[1];
+      Array<Integer> batched_args = args[2];
+      int64_t max_batch_size = args[3];
+      int64_t max_delay_us = args[4];
+      Array<Integer> batch_buckets = args[5];
+      std::vector<int> batched_arg_indices;
+      for (const auto& i : batched_args) {
+        batched_arg_indices.push_back(i->value);
+      }
+      std::vector<int64_t> buckets;
+      for (const auto& i : batch_buckets) {
+        buckets.push_back(i->value);
+      }
+      auto executor =
+          make_object<BatchingExecutor>(vm, func_name, std::move(batched_arg_indices),
+                                        max_batch_size, max_delay_us, std::move(buckets));
+      *rv = tvm::runtime::Module(executor);
+    });
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,113 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/batching_executor.h
+ * \brief The dynamic request batching executor on top of the RAF virtual machine.
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "raf/vm/vm.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+/*!
+ * \brief The executor that coalesces the concurrent requests along the batch dimension (axis 0),
+ * runs them as one execution of the virtual machine, and scatters the outputs back.
+ *
+ * A batch is launched when it reaches the maximal batch size, or when the oldest request has
+ * waited for the maximal delay. The coalesced batch is padded to the smallest batch bucket that
+ * fits, so that the executions only see a few shapes (e.g., the shapes of the cached CUDA graphs).
+ * The arguments that are not batched (e.g., the model parameters) are taken from the requests
+ * as is, and only the requests that share them are coalesced.
+ */
+class BatchingExecutor : public tvm::runtime::ModuleNode {
+ public:
+  BatchingExecutor(tvm::runtime::Module vm, std::string func_name, std::vector<int> batched_args,
+                   int64_t max_batch_size, int64_t max_delay_us,
+                   std::vector<int64_t> batch_buckets);
+
+  ~BatchingExecutor();
+
+  const char* type_key() const final {
+    return "BatchingExecutor";
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+
+  /*!
+   * \brief Submit a request and wait for its outputs. This function is thread-safe.
+   * \param inputs The inputs of the request.
+   * \return The outputs of the request.
+   */
+  Value Infer(const std::vector<Value>& inputs);
+
+ private:
+  /*! \brief A request waiting in the queue. */
+  struct Request {
+    /*! \brief The inputs of the request. */
+    std::vector<Value> inputs;
+    /*! \brief The batch size of the request. */
+    int64_t batch_size;
+    /*! \brief The time when the request arrives. */
+    std::chrono::steady_clock::time_point arrival;
+    /*! \brief The promise of the outputs. */
+    std::promise<Value> promise;
+  };
+
+  /*! \brief The loop of the worker thread that forms and runs the batches. */
+  void WorkerLoop();
+  /*! \brief Run a batch of requests and fulfill their promises. */
+  void RunBatch(const std::vector<std::shared_ptr<Request>>& batch);
+  /*! \brief Check whether two requests can be coalesced. */
+  bool CanCoalesce(const Request& a, const Request& b) const;
+  /*! \brief Get the batch size after padding to the batch buckets. */
+  int64_t GetPaddedBatchSize(int64_t batch_size) const;
+
+  /*! \brief The virtual machine module. */
+  tvm::runtime::Module vm_module_;
+  /*! \brief The virtual machine. */
+  VirtualMachine* vm_;
+  /*! \brief The name of the function to run. */
+  std::string func_name_;
+  /*! \brief Whether each argument is batched along axis 0. */
+  std::vector<bool> is_batched_;
+  /*! \brief The index of the first batched argument, which determines the request batch size. */
+  int first_batched_arg_;
+  /*! \brief The maximal batch size of an execution. */
+  int64_t max_batch_size_;
+  /*! \brief The maximal delay of a request before its batch is launched. */
+  std::chrono::microseconds max_delay_;
+  /*! \brief The sorted batch buckets to pad to. Batches are not padded if empty. */
+  std::vector<int64_t> batch_buckets_;
+  /*! \brief The queue of the waiting requests. */
+  std::deque<std::shared_ptr<Request>> queue_;
+  /*! \brief The total batch size of the waiting requests. */
+  int64_t queued_batch_size_ = 0;
+  /*! \brief Whether the worker has been asked to stop. */
+  bool stop_ = false;
+  /*! \brief The mutex for the queue. */
+  std::mutex mu_;
+  /*! \brief The condition variable to notify the worker. */
+  std::condition_variable cv_;
+  /*! \brief The worker thread. */
+  std::thread worker_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
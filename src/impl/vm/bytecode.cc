@@ -128,12 +128,14 @@ Instruction::Instruction(const Instruction& instr) {
     case Opcode::CudaSetStream:
       this->cuda_set_stream.device_id = instr.cuda_set_stream.device_id;
       this->cuda_set_stream.stream_id = instr.cuda_set_stream.stream_id;
+      this->cuda_set_stream.priority = instr.cuda_set_stream.priority;
       return;
     case Opcode::CudaAddEvent:
     case Opcode::CudaWaitEvent:
       this->cuda_event.event_id = instr.cuda_event.event_id;
       this->cuda_event.stream_id = instr.cuda_event.stream_id;
       return;
+    case Opcode::KillRegister:
     case Opcode::CudaStreamBarrier:
       return;
     default:
@@ -253,12 +255,14 @@ Instruction& Instruction::operator=(const Instruction& instr) {
     case Opcode::CudaSetStream:
       this->cuda_set_stream.device_id = instr.cuda_set_stream.device_id;
       this->cuda_set_stream.stream_id = instr.cuda_set_stream.stream_id;
+      this->cuda_set_stream.priority = instr.cuda_set_stream.priority;
       return *this;
     case Opcode::CudaAddEvent:
     case Opcode::CudaWaitEvent:
       this->cuda_event.event_id = instr.cuda_event.event_id;
       this->cuda_event.stream_id = instr.cuda_event.stream_id;
       return *this;
+    case Opcode::KillRegister:
     case Opcode::CudaStreamBarrier:
       return *this;
     default:
@@ -280,6 +284,7 @@ Instruction::~Instruction() {
     case Opcode::LoadConsti:
     case Opcode::AllocStorage:
     case Opcode::Free:
+    case Opcode::KillRegister:
     case Opcode::SetShape:
     case Opcode::Fatal:
     case Opcode::CudaSetStream:
@@ -397,6 +402,13 @@ Instruction Instruction::Free(RegName memory) {
   return instr;
 }
 
+Instruction Instruction::KillRegister(RegName dst) {
+  Instruction instr;
+  instr.op = Opcode::KillRegister;
+  instr.dst = dst;
+  return instr;
+}
+
 Instruction Instruction::AllocTuple(const std::vector<RegName>& fields, Index dst) {
   Instruction instr;
   instr.op = Opcode::AllocTuple;
@@ -537,11 +549,12 @@ Instruction Instruction::InferType(RegName op_reg, const std::vector<RegName>& a
   return instr;
 }
 
-Instruction Instruction::CudaSetStream(Index device_id, Index stream_id) {
+Instruction Instruction::CudaSetStream(Index device_id, Index stream_id, Index priority) {
   Instruction instr;
   instr.op = Opcode::CudaSetStream;
   instr.cuda_set_stream.device_id = device_id;
   instr.cuda_set_stream.stream_id = stream_id;
+  instr.cuda_set_stream.priority = priority;
   return instr;
 }
 
@@ -706,6 +719,10 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
       os << "free $" << instr.free.memory;
       break;
     }
+    case Opcode::KillRegister: {
+      os << "kill_register $" << instr.dst;
+      break;
+    }
     case Opcode::InvokeJit: {
       Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
       os << "invoke_jit $" << instr.invoke_jit.op_reg << " (in: $"
@@ -722,6 +739,9 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
     case Opcode::CudaSetStream: {
       os << "cuda_set_stream " << instr.cuda_set_stream.device_id << " "
          << instr.cuda_set_stream.stream_id;
+      if (instr.cuda_set_stream.priority >= 0) {
+        os << " " << instr.cuda_set_stream.priority;
+      }
       break;
     }
     case Opcode::CudaAddEvent: {
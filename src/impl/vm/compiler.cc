@@ -14,12 +14,20 @@
 #include <tvm/relay/transform.h>
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/attrs/memory.h>
+#include <fstream>
+#include <set>
 #include "raf/op.h"
 #include "raf/ir.h"
 #include "raf/binding.h"
 #include "raf/type.h"
 #include "raf/pass.h"
+#include "raf/profiler.h"
+#include "raf/op_profiler.h"
+#include "raf/op_utils.h"
 #include "raf/dist_config.h"
+#include "raf/communicator.h"
+#include "raf/cache.h"
+#include "raf/serialization.h"
 #include "./compiler.h"
 
 namespace tvm {
@@ -40,6 +48,7 @@ using namespace raf::value;
 using binding::LookupBinding;
 using binding::NDArrayBinding;
 using raf::distributed::DistConfig;
+using raf::distributed::communicator::GetGlobalCommunicator;
 using tvm::relay::Shape;
 
 /*!
@@ -197,13 +206,256 @@ struct TagCompare : ConditionNode {
   }
 };
 
+/*!
+ * \brief Call f(reg, is_def) on each register operand of the instruction, with the uses before
+ * the definition.
+ */
+template <typename F>
+void ForEachRegister(Instruction* instr, F f) {
+  auto each = [&f](RegName* regs, Index num_regs) {
+    for (Index i = 0; i < num_regs; ++i) {
+      f(&regs[i], false);
+    }
+  };
+  switch (instr->op) {
+    case Opcode::Move:
+      f(&instr->from, false);
+      f(&instr->dst, true);
+      break;
+    case Opcode::Ret:
+      f(&instr->result, false);
+      break;
+    case Opcode::GetField:
+      f(&instr->get_field.object, false);
+      f(&instr->dst, true);
+      break;
+    case Opcode::If:
+      f(&instr->if_op.test, false);
+      f(&instr->if_op.target, false);
+      break;
+    case Opcode::AllocStorage:
+      f(&instr->alloc_storage.allocation_size, false);
+      f(&instr->dst, true);
+      break;
+    case Opcode::AllocTensor:
+      f(&instr->alloc_tensor.storage, false);
+      f(&instr->dst, true);
+      break;
+    case Opcode::AllocTensorReg:
+      f(&instr->alloc_tensor_reg.storage, false);
+      f(&instr->alloc_tensor_reg.shape_register, false);
+      f(&instr->dst, true);
+      break;
+    case Opcode::AllocTuple:
+      each(instr->alloc_tuple.fields, instr->alloc_tuple.num_fields);
+      f(&instr->dst, true);
+      break;
+    case Opcode::AllocClosure:
+      each(instr->alloc_closure.free_vars, instr->alloc_closure.num_free_vars);
+      f(&instr->dst, true);
+      break;
+    case Opcode::SetShape:
+      f(&instr->set_shape.data, false);
+      f(&instr->set_shape.shape, false);
+      f(&instr->dst, true);
+      break;
+    case Opcode::Free:
+      f(&instr->free.memory, false);
+      break;
+    case Opcode::KillRegister:
+      f(&instr->dst, false);
+      break;
+    case Opcode::InvokeFunc:
+      each(instr->invoke_func.args, instr->invoke_func.num_args);
+      f(&instr->dst, true);
+      break;
+    case Opcode::InvokeClosure:
+      f(&instr->invoke_closure.closure, false);
+      each(instr->invoke_closure.args, instr->invoke_closure.num_args);
+      f(&instr->dst, true);
+      break;
+    case Opcode::InvokePacked:
+      each(instr->invoke_packed.args, instr->invoke_packed.arity);
+      break;
+    case Opcode::InvokeJit:
+      // The outputs are allocated beforehand and written in place, so they are uses as well.
+      f(&instr->invoke_jit.op_reg, false);
+      each(instr->invoke_jit.args, instr->invoke_jit.arity);
+      break;
+    case Opcode::InferType:
+      f(&instr->infer_type.op_reg, false);
+      each(instr->infer_type.args, instr->infer_type.num_args);
+      f(&instr->dst, true);
+      break;
+    case Opcode::LoadConst:
+    case Opcode::LoadConsti:
+      f(&instr->dst, true);
+      break;
+    case Opcode::Fatal:
+    case Opcode::Goto:
+    case Opcode::CudaSetStream:
+    case Opcode::CudaAddEvent:
+    case Opcode::CudaWaitEvent:
+    case Opcode::CudaStreamBarrier:
+      break;
+  }
+}
+
+/*!
+ * \brief Map the virtual registers of a function to as few registers as possible by a linear scan
+ * over the live intervals, and release each register after the last use of its value.
+ *
+ * Without loops the bytecode only jumps forward, so a value is live from its first to its last
+ * occurrence in the instruction order on every path, and values with disjoint intervals can share
+ * a register. The parameters keep their registers. The constants are cached in their registers
+ * across calls and the storages are identified by their registers (see InitPersistentStorages),
+ * so they get registers of their own. Functions that switch CUDA streams are left as is, since a
+ * value released on the host may still be used by a kernel on another stream. Functions with
+ * loops (see VMFunctionCompiler::EmitLoopJump) are left as is as well, since the values carried
+ * by the back edges would be live beyond their last occurrence.
+ *
+ * \param instructions The instructions to rewrite.
+ * \param num_params The number of parameters, which occupy the first registers.
+ * \param num_registers The number of virtual registers.
+ * \param register_names The names of the registers, updated to the new registers.
+ * \return The number of registers after the allocation.
+ */
+Index AllocateRegisters(std::vector<Instruction>* instructions, Index num_params,
+                        Index num_registers,
+                        std::unordered_map<Index, std::string>* register_names) {
+  auto& code = *instructions;
+  Index num_instrs = code.size();
+  std::vector<Index> last(num_registers, -1);
+  std::vector<bool> pinned(num_registers, false);
+  std::vector<bool> is_const(num_registers, false);
+  for (Index pc = 0; pc < num_instrs; ++pc) {
+    auto& instr = code[pc];
+    switch (instr.op) {
+      case Opcode::CudaSetStream:
+      case Opcode::CudaAddEvent:
+      case Opcode::CudaWaitEvent:
+      case Opcode::CudaStreamBarrier:
+        return num_registers;
+      case Opcode::If:
+        CHECK(instr.if_op.true_offset > 0 && instr.if_op.false_offset > 0);
+        break;
+      case Opcode::Goto:
+        if (instr.pc_offset <= 0) {
+          return num_registers;
+        }
+        break;
+      case Opcode::LoadConst:
+      case Opcode::LoadConsti:
+        is_const[instr.dst] = true;
+        pinned[instr.dst] = true;
+        break;
+      case Opcode::AllocStorage:
+        pinned[instr.dst] = true;
+        break;
+      default:
+        break;
+    }
+    ForEachRegister(&instr, [&](RegName* reg, bool is_def) { last[*reg] = pc; });
+  }
+
+  // The registers whose values are dead after each instruction.
+  std::vector<std::vector<RegName>> dead(num_instrs);
+  for (RegName reg = num_params; reg < num_registers; ++reg) {
+    if (last[reg] >= 0) {
+      dead[last[reg]].push_back(reg);
+    }
+  }
+  std::vector<RegName> new_reg(num_registers, -1);
+  for (RegName reg = 0; reg < num_params; ++reg) {
+    new_reg[reg] = reg;
+  }
+  Index num_new_regs = num_params;
+  std::set<RegName> free_regs;
+  std::vector<std::vector<RegName>> kills(num_instrs);
+  for (Index pc = 0; pc < num_instrs; ++pc) {
+    ForEachRegister(&code[pc], [&](RegName* reg, bool is_def) {
+      if (new_reg[*reg] >= 0) {
+        return;
+      }
+      if (pinned[*reg] || free_regs.empty()) {
+        new_reg[*reg] = num_new_regs++;
+      } else {
+        new_reg[*reg] = *free_regs.begin();
+        free_regs.erase(free_regs.begin());
+      }
+    });
+    // A register is reused from the next instruction on, so an instruction never reads and
+    // writes the same register.
+    bool falls_through = code[pc].op != Opcode::If && code[pc].op != Opcode::Goto &&
+                         code[pc].op != Opcode::Ret && code[pc].op != Opcode::Fatal;
+    for (RegName reg : dead[pc]) {
+      if (!pinned[reg]) {
+        free_regs.insert(new_reg[reg]);
+      }
+      if (!is_const[reg] && falls_through) {
+        kills[pc].push_back(new_reg[reg]);
+      }
+    }
+  }
+
+  // Rewrite the registers, insert the kills and patch the jump offsets.
+  std::vector<Index> new_pc(num_instrs + 1);
+  std::vector<Instruction> new_code;
+  for (Index pc = 0; pc < num_instrs; ++pc) {
+    new_pc[pc] = new_code.size();
+    ForEachRegister(&code[pc], [&](RegName* reg, bool is_def) { *reg = new_reg[*reg]; });
+    new_code.push_back(code[pc]);
+    for (RegName reg : kills[pc]) {
+      new_code.push_back(Instruction::KillRegister(reg));
+    }
+  }
+  new_pc[num_instrs] = new_code.size();
+  for (Index pc = 0; pc < num_instrs; ++pc) {
+    auto& instr = new_code[new_pc[pc]];
+    if (instr.op == Opcode::If) {
+      instr.if_op.true_offset = new_pc[pc + instr.if_op.true_offset] - new_pc[pc];
+      instr.if_op.false_offset = new_pc[pc + instr.if_op.false_offset] - new_pc[pc];
+    } else if (instr.op == Opcode::Goto) {
+      instr.pc_offset = new_pc[pc + instr.pc_offset] - new_pc[pc];
+    }
+  }
+  *instructions = std::move(new_code);
+
+  // A register keeps its name only if a single named value is assigned to it.
+  std::unordered_map<Index, std::string> new_names;
+  std::unordered_set<Index> shared;
+  for (const auto& it : *register_names) {
+    Index reg = new_reg[it.first];
+    if (reg < 0 || shared.count(reg)) {
+      continue;
+    }
+    if (new_names.count(reg)) {
+      new_names.erase(reg);
+      shared.insert(reg);
+    } else {
+      new_names[reg] = it.second;
+    }
+  }
+  *register_names = std::move(new_names);
+  return num_new_regs;
+}
+
 class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
  public:
-  VMFunctionCompiler(VMCompilerContext* context, DeviceMap device_map)
-      : last_register_(0), registers_num_(0), context_(context), device_map_(device_map) {
+  VMFunctionCompiler(VMCompilerContext* context, DeviceMap device_map,
+                     bool reuse_registers = false, bool lower_tail_calls = false)
+      : last_register_(0),
+        registers_num_(0),
+        context_(context),
+        device_map_(device_map),
+        reuse_registers_(reuse_registers),
+        lower_tail_calls_(lower_tail_calls) {
   }
 
   VMFunction Compile(const GlobalVar& var, const Function& func) {
+    func_name_ = var->name_hint;
+    self_ = var;
+    func_ = func;
     size_t i = 0;
     // We then assign register num to the free variables
     for (auto param : func->params) {
@@ -229,12 +481,25 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
         params_.push_back(param->name_hint());
         ++i;
       }
+      loop_params_begin_ = func->params.size();
+      if (lower_tail_calls_) {
+        CollectTailCalls(inner_func->body);
+      }
       this->VisitExpr(inner_func->body);
     } else {
+      if (lower_tail_calls_) {
+        CollectTailCalls(func->body);
+      }
       this->VisitExpr(func->body);
     }
     instructions_.push_back(Instruction::Ret(last_register_));
-    return VMFunction(var->name_hint, params_, instructions_, registers_num_);
+    if (reuse_registers_) {
+      registers_num_ =
+          AllocateRegisters(&instructions_, params_.size(), registers_num_, &register_names_);
+    }
+    VMFunction vm_func(var->name_hint, params_, instructions_, registers_num_);
+    vm_func.register_names = std::move(register_names_);
+    return vm_func;
   }
 
  protected:
@@ -242,8 +507,94 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
     return registers_num_++;
   }
 
+  /*!
+   * \brief Collect the calls in the tail position of a function body, i.e., whose results are
+   * returned as is, through the let bindings and the branches of if.
+   */
+  void CollectTailCalls(const Expr& body) {
+    Expr tail = body;
+    const LetNode* last_let = nullptr;
+    while (const auto* let = tail.as<LetNode>()) {
+      last_let = let;
+      tail = let->body;
+    }
+    if (last_let != nullptr && tail.same_as(last_let->var)) {
+      tail = last_let->value;
+    }
+    if (const auto* call = tail.as<CallNode>()) {
+      tail_calls_.insert(call);
+    } else if (const auto* if_node = tail.as<IfNode>()) {
+      CollectTailCalls(if_node->true_branch);
+      CollectTailCalls(if_node->false_branch);
+    }
+  }
+
+  /*!
+   * \brief Check whether the callee is the function being compiled, with the same free variables
+   * if it is a closure. A callee variable is resolved to its bound value.
+   */
+  bool IsSelfCallee(Expr callee) {
+    if (const auto* var = callee.as<VarNode>()) {
+      auto it = expr_map_.find(GetRef<Var>(var));
+      if (it == expr_map_.end()) {
+        return false;
+      }
+      callee = it->second;
+    }
+    if (!tvm::relay::vm::IsClosure(func_)) {
+      return callee.same_as(self_);
+    }
+    // The closure of the function is allocated with its own free variables.
+    const auto* alloc = callee.as<CallNode>();
+    if (alloc == nullptr || !alloc->op.same_as(self_) ||
+        alloc->args.size() != func_->params.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < alloc->args.size(); ++i) {
+      if (!alloc->args[i].same_as(func_->params[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*!
+   * \brief Emit a tail call of the function itself as a jump back to its entry, where the
+   * parameters are overwritten by the arguments. A recursive function, e.g., a loop lowered from
+   * python/raf/hybrid, is then run as a loop in a single frame, instead of allocating a closure and
+   * pushing a frame per iteration. The jump is a Goto with a non-positive offset.
+   */
+  void EmitLoopJump(const std::vector<Index>& args_registers) {
+    CHECK_EQ(loop_params_begin_ + args_registers.size(), params_.size());
+    auto is_param = [this](Index reg) {
+      return reg >= static_cast<Index>(loop_params_begin_) &&
+             reg < static_cast<Index>(params_.size());
+    };
+    // The parameters are updated in parallel, so the arguments that read a parameter are saved
+    // before any parameter is overwritten.
+    std::vector<Index> src(args_registers);
+    for (size_t i = 0; i < src.size(); ++i) {
+      Index param = loop_params_begin_ + i;
+      if (src[i] != param && is_param(src[i])) {
+        Emit(Instruction::Move(src[i], NewRegister()));
+        src[i] = last_register_;
+      }
+    }
+    for (size_t i = 0; i < src.size(); ++i) {
+      Index param = loop_params_begin_ + i;
+      if (src[i] != param) {
+        Emit(Instruction::Move(src[i], param));
+      }
+    }
+    Emit(Instruction::Goto(-static_cast<Index>(instructions_.size())));
+    // The result is never assigned, since the control does not fall through the jump.
+    last_register_ = NewRegister();
+    reachable_ = false;
+  }
+
   inline void Emit(const Instruction& instr) {
     DLOG(INFO) << "VMCompiler::Emit: instr=" << instr;
+    reachable_ = true;
     CHECK((int)instr.op < 100) << "Invalid opcode " << (int)instr.op;
     switch (instr.op) {
       case Opcode::AllocTuple:
@@ -264,6 +615,7 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
       case Opcode::InvokePacked:
       case Opcode::InvokeJit:
       case Opcode::Free:
+      case Opcode::KillRegister:
       case Opcode::If:
       case Opcode::Ret:
       case Opcode::Goto:
@@ -279,8 +631,16 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
   }
 
   void VisitExpr_(const ConstantNode* const_node) {
-    size_t konst_idx = context_->constants.size();
-    context_->constants.push_back(Downcast<Value>(const_node->value));
+    // The uses of the same value share the constant, which is uploaded to the device once.
+    auto it = context_->const_index.find(const_node->value.get());
+    size_t konst_idx;
+    if (it != context_->const_index.end()) {
+      konst_idx = it->second;
+    } else {
+      konst_idx = context_->constants.size();
+      context_->constants.push_back(Downcast<Value>(const_node->value));
+      context_->const_index[const_node->value.get()] = konst_idx;
+    }
     Emit(Instruction::LoadConst(konst_idx, NewRegister()));
   }
 
@@ -320,6 +680,7 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
       expr_map_[let->var] = let->value;
       this->VisitExpr(let->value);
       var_register_map_.insert({let->var, this->last_register_});
+      register_names_.insert({this->last_register_, let->var->name_hint()});
       body = let->body;
     }
     this->VisitExpr(body);
@@ -354,19 +715,28 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
 
     // It saves the result of If-Else expression.
     auto merge_register = NewRegister();
-    Emit(Instruction::Move(last_register_, merge_register));
-    Emit(Instruction::Goto(0));
+    // A branch that ends with a loop jump does not reach the merge.
+    bool true_jumps = !reachable_;
+    if (!true_jumps) {
+      Emit(Instruction::Move(last_register_, merge_register));
+      Emit(Instruction::Goto(0));
+    }
 
     // Finally store how many instructions there are in the
     // true branch.
     auto after_true = this->instructions_.size();
 
+    // The false branch is reachable by the If, even if the true branch jumps away.
+    reachable_ = true;
     this->VisitExpr(if_node->false_branch);
 
     size_t false_register = last_register_;
 
     // In else-branch, override the then-branch register
-    Emit(Instruction::Move(false_register, merge_register));
+    bool false_jumps = !reachable_;
+    if (!false_jumps) {
+      Emit(Instruction::Move(false_register, merge_register));
+    }
     // Compute the total number of instructions
     // after generating false.
     auto after_false = this->instructions_.size();
@@ -383,7 +753,10 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
     instructions_[after_cond].if_op.false_offset = false_offset;
 
     // Patch the Goto.
-    this->instructions_[after_true - 1].pc_offset = (after_false - after_true) + 1;
+    if (!true_jumps) {
+      this->instructions_[after_true - 1].pc_offset = (after_false - after_true) + 1;
+    }
+    reachable_ = !true_jumps || !false_jumps;
 
     this->last_register_ = merge_register;
   }
@@ -410,8 +783,9 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
           .Match("raf.op.vm.alloc_tensor",
                  [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
                    bool own = true;
-                   if (args.size() == 5) {
-                     // The last "own" argument is usually specified by the MemoryPlan pass
+                   Index offset = 0;
+                   if (args.size() >= 5) {
+                     // The "own" argument is usually specified by the MemoryPlan pass
                      // to indicate that this tensor is not the final output so it should not
                      // own the memory pointer.
                      CHECK(args[4].as<ConstantNode>());
@@ -421,6 +795,14 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                    } else {
                      CHECK_EQ(args.size(), 4);
                    }
+                   if (args.size() == 6) {
+                     // The "offset" argument is specified by the MemoryPlan pass when the
+                     // tensor is placed in an arena.
+                     CHECK(args[5].as<ConstantNode>());
+                     auto offset_val = args[5].as<ConstantNode>()->value;
+                     CHECK(offset_val->IsInstance<IntValueObj>());
+                     offset = offset_val.as<IntValueObj>()->value;
+                   }
 
                    // The storage will be passed dynamically.
                    this->VisitExpr(args[0]);
@@ -446,12 +828,12 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                        raw_shape.push_back(imm->value);
                      }
                      // Add context field.
-                     Emit(Instruction::AllocTensor(storage_register, 0, raw_shape, dtype,
+                     Emit(Instruction::AllocTensor(storage_register, offset, raw_shape, dtype,
                                                    NewRegister(), own));
                    } else {
                      this->VisitExpr(args[1]);
-                     Emit(Instruction::AllocTensorReg(storage_register, 0, last_register_, dtype,
-                                                      NewRegister(), own));
+                     Emit(Instruction::AllocTensorReg(storage_register, offset, last_register_,
+                                                      dtype, NewRegister(), own));
                    }
                  })
           .Match("raf.op.vm.alloc_storage",
@@ -519,7 +901,7 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
           .Match(
               "raf.op.set_stream",
               [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
-                CHECK_EQ(args.size(), 2);
+                CHECK(args.size() == 2 || args.size() == 3);
                 this->VisitExpr(args[0]);
                 Expr device_id_expr;
                 if (args[0].as<VarNode>()) {
@@ -536,7 +918,16 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                   stream_id_expr = args[1];
                 }
                 Index stream_id = stream_id_expr.as<ConstantNode>()->value.as<IntValueObj>()->value;
-                Emit(Instruction::CudaSetStream(device_id, stream_id));
+                Index priority = -1;
+                if (args.size() == 3) {
+                  this->VisitExpr(args[2]);
+                  Expr priority_expr = args[2];
+                  if (args[2].as<VarNode>()) {
+                    priority_expr = expr_map_[GetRef<Var>(args[2].as<VarNode>())];
+                  }
+                  priority = priority_expr.as<ConstantNode>()->value.as<IntValueObj>()->value;
+                }
+                Emit(Instruction::CudaSetStream(device_id, stream_id, priority));
               })
           .Match("raf.op.add_event",
                  [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
@@ -608,6 +999,11 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
       args_registers.push_back(last_register_);
     }
 
+    if (tail_calls_.count(call_node) && IsSelfCallee(op)) {
+      EmitLoopJump(args_registers);
+      return;
+    }
+
     if (auto global_node = op.as<GlobalVarNode>()) {
       // In the case we are invoking a global we need to find its
       // global ID, and then check whether it is closure invocation
@@ -631,9 +1027,22 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
         Emit(Instruction::InvokeFunc(it->second, args_registers, NewRegister()));
       }
     } else if (auto var_node = op.as<VarNode>()) {
+      auto var = GetRef<Var>(var_node);
+      auto it = expr_map_.find(var);
+      if (it != expr_map_.end() && it->second->IsInstance<GlobalVarNode>()) {
+        // The variable is bound to a global function, e.g., a layer body after LambdaLift, so
+        // it is called directly instead of through its closure.
+        auto global = Downcast<GlobalVar>(it->second);
+        auto func = Downcast<Function>(context_->module->Lookup(global));
+        if (!tvm::relay::vm::IsClosure(func)) {
+          Emit(Instruction::InvokeFunc(context_->global_map.at(global), args_registers,
+                                       NewRegister()));
+          return;
+        }
+      }
       // If we are calling a variable, it must be the case that it is a closure so we
       // emit invoke closure here.
-      VisitExpr(GetRef<Var>(var_node));
+      VisitExpr(var);
       Emit(Instruction::InvokeClosure(last_register_, args_registers, NewRegister()));
     } else if (auto inner_call_node = op.as<CallNode>()) {
       VisitExpr(GetRef<Call>(inner_call_node));
@@ -720,8 +1129,47 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
 
     CHECK_EQ(device_map_.size(), 1U)
         << "Currently VM compiler doesn't support heterogeneous compilation";
+    Index pc = instructions_.size();
     Emit(Instruction::InvokeJit(op_reg, argument_registers.size(), output_tuple->fields.size(),
                                 argument_registers));
+    AddJitCall(pc, op, input_tuple->fields, output_tuple->fields);
+  }
+
+  /*!
+   * \brief Record the call of an InvokeJit instruction for the JIT warmup and the op work
+   * estimation, if its callee and the shapes of its arguments are known at compile time.
+   */
+  void AddJitCall(Index pc, Expr callee, const Array<Expr>& inputs, const Array<Expr>& outputs) {
+    if (auto var = callee.as<VarNode>()) {
+      auto it = expr_map_.find(GetRef<Var>(var));
+      if (it == expr_map_.end()) {
+        return;
+      }
+      callee = it->second;
+    }
+    if (auto func = callee.as<FunctionNode>()) {
+      if (!pass::FreeVars(GetRef<Function>(func)).empty()) {
+        return;
+      }
+    } else if (!callee->IsInstance<OpNode>()) {
+      return;
+    }
+    for (const auto& expr : inputs) {
+      if (!expr->checked_type_.defined() || tvm::relay::IsDynamic(expr->checked_type())) {
+        return;
+      }
+    }
+    Array<Type> out_types;
+    for (const auto& expr : outputs) {
+      if (!expr->checked_type_.defined() || tvm::relay::IsDynamic(expr->checked_type())) {
+        return;
+      }
+      out_types.push_back(expr->checked_type());
+    }
+    Call call = Call(callee, inputs);
+    call->checked_type_ = out_types.size() == 1 ? out_types[0] : TupleType(out_types);
+    context_->jit_calls.push_back(call);
+    context_->jit_call_sites.emplace_back(func_name_, pc);
   }
 
   void EmitInferType(const Expr& op, const Expr& inputs, RegName dst) {
@@ -757,12 +1205,16 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
  protected:
   /*! \brief Store the expression a variable points to. */
   std::unordered_map<Var, Expr, ObjectPtrHash, ObjectPtrEqual> expr_map_;
+  /*! \brief The name of the function being compiled. */
+  std::string func_name_;
   /*! \brief Instructions in the VMFunction. */
   std::vector<Instruction> instructions_;
   /*! \brief Parameter names of the function. */
   std::vector<std::string> params_;
   /*! \brief Map from var to register number. */
   std::unordered_map<Var, RegName, ObjectPtrHash, ObjectPtrEqual> var_register_map_;
+  /*! \brief Map from register number to the name of the first var bound to it. */
+  std::unordered_map<Index, std::string> register_names_;
   /*! \brief Last used register number. */
   Index last_register_;
   /*! \brief Total number of virtual registers allocated. */
@@ -771,8 +1223,124 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
   VMCompilerContext* context_;
   /*! \brief Device map. */
   DeviceMap device_map_;
+  /*! \brief Whether to share the registers among the values with disjoint live ranges. */
+  bool reuse_registers_;
+  /*! \brief Whether to lower the tail calls of the function itself to loops. */
+  bool lower_tail_calls_;
+  /*! \brief The function being compiled. */
+  GlobalVar self_;
+  Function func_;
+  /*! \brief The calls in the tail position of the function body. */
+  std::unordered_set<const CallNode*> tail_calls_;
+  /*! \brief The first register of the parameters updated by a loop jump, which skips the free
+   * variables of a closure. */
+  size_t loop_params_begin_ = 0;
+  /*! \brief Whether the end of the emitted instructions is reachable, i.e., not after a loop
+   * jump on every path. */
+  bool reachable_ = true;
+};
+
+/*!
+ * \brief The cache entry of a compiled module, which holds the serialized executable and the IR
+ * after the VM pass pipeline.
+ */
+class CompiledModuleCacheEntry {
+ public:
+  explicit CompiledModuleCacheEntry() {
+  }
+
+  CompiledModuleCacheEntry(const std::string& code, const IRModule& mod) : code_(code), mod_(mod) {
+  }
+
+  const std::string& GetCode() const {
+    return code_;
+  }
+
+  IRModule GetModule() const {
+    return mod_;
+  }
+
+  static CompiledModuleCacheEntry Load(const std::string path) {
+    auto code = ReadFile(path + "/" + CODE_FILE);
+    auto mod = Downcast<IRModule>(tvm::LoadJSON(ReadFile(path + "/" + MODULE_FILE)));
+    return CompiledModuleCacheEntry(code, mod);
+  }
+
+  bool Save(const std::string& path) {
+    std::ofstream code_ofs(path + "/" + CODE_FILE, std::ios::out | std::ios::binary);
+    std::ofstream mod_ofs(path + "/" + MODULE_FILE, std::ios::out);
+    if (!code_ofs.is_open() || !mod_ofs.is_open()) {
+      return false;
+    }
+    code_ofs.write(code_.data(), code_.size());
+    mod_ofs << ir::serialization::SaveJSON(mod_);
+    return true;
+  }
+
+ private:
+  static std::string ReadFile(const std::string& path) {
+    std::ifstream ifs(path, std::ios::in | std::ios::binary);
+    if (!ifs.is_open()) {
+      LOG(FATAL) << "Compiled module file does not exist: " << path;
+      throw;
+    }
+    std::string data;
+    ifs.seekg(0, std::ios::end);
+    data.resize(static_cast<size_t>(ifs.tellg()));
+    ifs.seekg(0, std::ios::beg);
+    ifs.read(&data[0], data.size());
+    return data;
+  }
+
+  /*! \brief The persist file name of the executable. */
+  static constexpr const char* CODE_FILE = "code.ro";
+  /*! \brief The persist file name of the IR after the pass pipeline. */
+  static constexpr const char* MODULE_FILE = "module.json";
+  /*! \brief The serialized executable. */
+  std::string code_;
+  /*! \brief The IR after the pass pipeline. */
+  IRModule mod_;
 };
 
+using CompiledModuleCache = MetaPersistCache<CompiledModuleCacheEntry>;
+
+CompiledModuleCache* GetCompiledModuleCache() {
+  static CompiledModuleCache cache("compiled_module");
+  return &cache;
+}
+
+/*!
+ * \brief Compute the key of the compiled module cache, which covers everything that affects the
+ * compilation: the module with the params bound, the device, the pass context, the distributed
+ * config and the version of RAF.
+ */
+std::string CompiledModuleKey(const IRModule& mod, const Device& device) {
+  static const auto* fgit_version = tvm::runtime::Registry::Get("raf.build_info.git_version");
+  auto pass_ctx = tvm::transform::PassContext::Current();
+  auto dcfg = DistConfig::Global();
+  HashKey key;
+  key << (fgit_version ? (*fgit_version)().operator std::string() : std::string("unknown"));
+  // The serialized module includes the data of the tensor constants, e.g., the bound params.
+  key << ir::serialization::SaveJSON(mod);
+  key << device.c_str();
+  key << static_cast<int32_t>(pass_ctx->opt_level);
+  key << tvm::SaveJSON(pass_ctx->config) << tvm::SaveJSON(pass_ctx->required_pass)
+      << tvm::SaveJSON(pass_ctx->disabled_pass);
+  key << dcfg->enable_data_parallel << static_cast<int32_t>(dcfg->zero_opt_level)
+      << dcfg->enable_auto_dp_profiling << static_cast<int32_t>(dcfg->auto_dp_profiling_start_iter)
+      << static_cast<int32_t>(dcfg->auto_dp_profiling_end_iter) << dcfg->group_bucket_size
+      << dcfg->gradient_compression << dcfg->enable_hierarchical_allreduce
+      << dcfg->enable_allreduce_bucketing << dcfg->zero_defer_allgather
+      << dcfg->enable_group_collectives << static_cast<int32_t>(dcfg->num_comm_streams);
+  if (dcfg->enable_data_parallel || dcfg->zero_opt_level > 0) {
+    // The collectives and the partitions depend on the ranks.
+    auto comm = GetGlobalCommunicator();
+    key << static_cast<int32_t>(comm->rank) << static_cast<int32_t>(comm->size)
+        << static_cast<int32_t>(comm->local_rank) << static_cast<int32_t>(comm->local_size);
+  }
+  return std::string(key.byte_vector.begin(), key.byte_vector.end());
+}
+
 void VMCompiler::SetParam(const std::string& name, Value data_in) {
   params_[name] = data_in;
 }
@@ -791,9 +1359,37 @@ void VMCompiler::Lower(IRModule mod, const DeviceMap& device_map) {
 
   exec_ = make_object<Executable>();
   device_map_ = device_map;
+  Device host(DevType::kCPU(), 0);
+
+  // Skip the pass pipeline and the code generation if the same module has been compiled with the
+  // same configs, e.g., by a previous run of the job when the persistent cache is enabled.
+  auto pass_ctx = tvm::transform::PassContext::Current();
+  bool use_cache = pass_ctx->GetConfig("raf.vm.compile_cache", Bool(false)).value();
+  std::string cache_key;
+  if (use_cache) {
+    cache_key = CompiledModuleKey(mod, device_map_.begin()->second);
+    if (auto entry = GetCompiledModuleCache()->Get(cache_key)) {
+      WITH_BASE_PROFILER(host, "LoadCompiledModule", "Compile", {}, {
+        context_.module = entry->GetModule();
+        auto exec = Executable::Load(entry->GetCode(), tvm::runtime::Module());
+        exec_ = GetObjectPtr<Executable>(static_cast<Executable*>(exec.operator->()));
+      });
+      return;
+    }
+  }
 
   // Run the optimizations necessary to target the VM.
-  context_.module = OptimizeModule(mod, device_map_);
+  WITH_BASE_PROFILER(host, "OptimizeModule", "Compile", {},
+                     { context_.module = OptimizeModule(mod, device_map_); });
+
+  // Compile a static version of the main function for each declared shape bucket, which is
+  // dispatched by the input shapes at runtime.
+  auto buckets = pass_ctx->GetConfig("raf.vm.shape_buckets", ShapeBuckets()).value();
+  std::vector<std::pair<std::string, ShapeBucket>> shape_buckets;
+  if (!buckets.empty()) {
+    WITH_BASE_PROFILER(host, "OptimizeShapeBuckets", "Compile", {},
+                       { shape_buckets = AddShapeBuckets(mod, buckets); });
+  }
 
   // Populate the global map.
   //
@@ -805,18 +1401,23 @@ void VMCompiler::Lower(IRModule mod, const DeviceMap& device_map) {
   // the global state.
   exec_->functions.resize(context_.module->functions.size());
 
-  for (auto named_func : context_.module->functions) {
-    auto gvar = named_func.first;
-    if (auto* n = named_func.second.as<FunctionNode>()) {
-      auto func = GetRef<Function>(n);
-      VMFunctionCompiler func_compiler(&context_, device_map_);
-      auto vm_func = func_compiler.Compile(gvar, func);
-
-      size_t func_index = context_.global_map.at(gvar);
-      CHECK(func_index < exec_->functions.size());
-      exec_->functions[func_index] = vm_func;
+  bool reuse_registers = pass_ctx->GetConfig("raf.vm.reuse_registers", Bool(true)).value();
+  bool lower_tail_calls = pass_ctx->GetConfig("raf.vm.lower_tail_calls", Bool(true)).value();
+  WITH_BASE_PROFILER(host, "CodeGen", "Compile", {}, {
+    for (auto named_func : context_.module->functions) {
+      auto gvar = named_func.first;
+      if (auto* n = named_func.second.as<FunctionNode>()) {
+        auto func = GetRef<Function>(n);
+        VMFunctionCompiler func_compiler(&context_, device_map_, reuse_registers,
+                                         lower_tail_calls);
+        auto vm_func = func_compiler.Compile(gvar, func);
+
+        size_t func_index = context_.global_map.at(gvar);
+        CHECK(func_index < exec_->functions.size());
+        exec_->functions[func_index] = vm_func;
+      }
     }
-  }
+  });
 
 #if USE_RELAY_DEBUG
   for (auto vm_func : exec_->functions) {
@@ -833,6 +1434,158 @@ void VMCompiler::Lower(IRModule mod, const DeviceMap& device_map) {
   for (auto gv : context_.global_map) {
     exec_->global_map.insert({gv.first->name_hint, gv.second});
   }
+  for (auto& it : shape_buckets) {
+    it.second.func_index = exec_->global_map.at(it.first);
+    exec_->shape_buckets["main"].push_back(it.second);
+  }
+
+  if (pass_ctx->GetConfig("raf.vm.estimate_op_work", Bool(false)).value()) {
+    WITH_BASE_PROFILER(host, "EstimateOpWork", "Compile", {}, { EstimateOpWork(); });
+  }
+
+  if (use_cache) {
+    auto code = exec_->Save();
+    GetCompiledModuleCache()->Set(
+        cache_key, CompiledModuleCacheEntry(std::string(code.data, code.size), context_.module));
+  }
+
+  int warmup_threads = pass_ctx->GetConfig("raf.vm.jit_warmup_threads", Integer(static_cast<int>(0)))
+                           .value()
+                           .IntValue();
+  if (warmup_threads != 0) {
+    WITH_BASE_PROFILER(host, "JITWarmup", "Compile", {}, { WarmupJIT(warmup_threads); });
+  }
+  context_.jit_calls.clear();
+  context_.jit_call_sites.clear();
+}
+
+std::vector<std::pair<std::string, ShapeBucket>> VMCompiler::AddShapeBuckets(
+    const IRModule& mod, const ShapeBuckets& buckets) {
+  std::vector<std::pair<std::string, ShapeBucket>> ret;
+  auto main_gvar = mod->GetGlobalVar("main");
+  auto main_func = Downcast<Function>(mod->Lookup(main_gvar));
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    // Copy the function deeply, since the type inference writes the types to the nodes in place.
+    auto func = Downcast<Function>(tvm::LoadJSON(ir::serialization::SaveJSON(main_func)));
+    const auto& bucket_shapes = buckets[i];
+    ShapeBucket bucket;
+    Array<Var> params;
+    tvm::Map<Var, Expr> bind_map;
+    for (size_t j = 0; j < func->params.size(); ++j) {
+      const auto& param = func->params[j];
+      if (!bucket_shapes.count(param->name_hint())) {
+        params.push_back(param);
+        continue;
+      }
+      auto shape = bucket_shapes[param->name_hint()];
+      auto ttype = param->type_annotation.as<TensorTypeNode>();
+      CHECK(ttype && ttype->shape.size() == shape.size())
+          << "The shape bucket " << i << " does not match the rank of " << param->name_hint();
+      Array<PrimExpr> static_shape;
+      std::vector<int64_t> dims;
+      for (size_t k = 0; k < shape.size(); ++k) {
+        auto dim = ttype->shape[k].as<IntImmNode>();
+        CHECK(dim == nullptr || dim->value == shape[k]->value)
+            << "The shape bucket " << i << " does not match the static dimension " << k << " of "
+            << param->name_hint();
+        static_shape.push_back(Integer(shape[k]->value));
+        dims.push_back(shape[k]->value);
+      }
+      auto new_param = MakeVar(param->name_hint(), TensorType(static_shape, ttype->dtype));
+      params.push_back(new_param);
+      bind_map.Set(param, new_param);
+      bucket.param_indices.push_back(j);
+      bucket.shapes.push_back(dims);
+    }
+    CHECK_EQ(bucket.param_indices.size(), bucket_shapes.size())
+        << "Some parameters of the shape bucket " << i << " are not found in the main function";
+    func = Function(params, tvm::relay::Bind(func->body, bind_map), Type(), func->type_params,
+                    func->attrs);
+
+    IRModule bucket_mod(mod->functions, mod->type_definitions, mod->Imports());
+    bucket_mod->Add(main_gvar, func, true);
+    bucket_mod = OptimizeModule(bucket_mod, device_map_);
+    CHECK_EQ(bucket_mod->functions.size(), 1U)
+        << "The shape buckets only support the modules with a single function";
+    std::string name = "main_bucket" + std::to_string(i);
+    context_.module->Add(GlobalVar(name), bucket_mod->Lookup("main"));
+    ret.emplace_back(name, bucket);
+  }
+  return ret;
+}
+
+void VMCompiler::EstimateOpWork() {
+  Device device = device_map_.begin()->second;
+  if (device.device_type() != DevType::kCPU() && device.device_type() != DevType::kCUDA()) {
+    LOG(WARNING) << "The op work cannot be estimated on " << device.c_str();
+    return;
+  }
+  auto* cost_model = op_profiler::AnalyticalOpProfiler::Get(device);
+  for (size_t i = 0; i < context_.jit_calls.size(); ++i) {
+    const auto& call = context_.jit_calls[i];
+    if (IsCollectiveOp(call->op)) {
+      // The collectives move data across devices instead of using the device throughput.
+      continue;
+    }
+    try {
+      auto work = cost_model->GetOpWork(call);
+      const auto& site = context_.jit_call_sites[i];
+      exec_->op_work[site.first][site.second] = {work.gflops, work.bytes};
+    } catch (const dmlc::Error& e) {
+      DLOG(WARNING) << "Failed to estimate the work of an op: " << e.what();
+    }
+  }
+}
+
+void VMCompiler::WarmupJIT(int num_threads) {
+  Device device = device_map_.begin()->second;
+  // Dedup the calls by the callee and the argument types. Fused functions are compared
+  // structurally since identical functions may be fused at different places.
+  std::vector<Call> calls;
+  std::unordered_set<std::string> seen;
+  for (const auto& call : context_.jit_calls) {
+    HashKey key;
+    if (auto op_node = call->op.as<OpNode>()) {
+      key << op_node->name;
+    } else {
+      key << static_cast<uint64_t>(tvm::StructuralHash()(call->op));
+    }
+    for (const auto& arg : call->args) {
+      if (arg->IsInstance<ConstantNode>()) {
+        // The constants (e.g., the axis of a reduction) are a part of the kernel.
+        key << static_cast<uint64_t>(ObjectPtrHash()(arg));
+      } else {
+        key << static_cast<uint64_t>(tvm::StructuralHash()(arg->checked_type()));
+      }
+    }
+    key << static_cast<uint64_t>(tvm::StructuralHash()(call->checked_type()));
+    if (seen.insert(std::string(key.byte_vector.begin(), key.byte_vector.end())).second) {
+      calls.push_back(call);
+    }
+  }
+  if (calls.empty()) {
+    return;
+  }
+
+  // Building the kernels does not need meaningful data, so all calls share the same dummy arena.
+  int64_t arena_bytes = 0;
+  for (const auto& call : calls) {
+    arena_bytes = std::max(arena_bytes, op_profiler::DummyArena::CallBytes(call));
+  }
+  op_profiler::DummyArena arena(device, arena_bytes);
+  std::vector<op::CallValues> call_values;
+  for (const auto& call : calls) {
+    arena.Rewind();
+    call_values.push_back(op::CreateDummyCallValues(
+        call, device, [&arena](const Type& type) { return arena.Create(type); }));
+  }
+  try {
+    op::DispatchParallel(call_values, num_threads);
+  } catch (const dmlc::Error& e) {
+    // The warmup is best effort. The failed calls are JITed again in the first execution.
+    LOG(WARNING) << "Failed to warm up the JIT of some ops: " << e.what();
+  }
+  DLOG(INFO) << "Warmed up the JIT of " << calls.size() << " unique calls";
 }
 
 IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device_map) {
@@ -850,10 +1603,28 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
   pass_seqs.push_back(pass::GradInputSelect());
   pass_seqs.push_back(pass::InlineLet());
   pass_seqs.push_back(pass::DeadCodeElimination());
+  // keep one copy of the identical bound params and constants.
+  pass_seqs.push_back(pass::DedupConstant());
   // enable group all gather for ZeRO.
   if (dcfg->zero_opt_level > 1 && dcfg->group_bucket_size > 1 && device_t == DevType::kCUDA()) {
     pass_seqs.push_back(pass::GroupAllgather());
   }
+  // batch the independent matmuls with the same shapes.
+  if (pass_ctx->GetConfig("raf.vm.optimize.horizontal_fuse", Bool(false)).value()) {
+    pass_seqs.push_back(pass::HorizontalFuse());
+  }
+  // run the conv2d regions in NHWC, which Tensor Cores prefer.
+  if (pass_ctx->GetConfig("raf.vm.optimize.convert_layout", Bool(false)).value()) {
+    pass_seqs.push_back(pass::ConvertLayout());
+  }
+  // run the dense ops with 2:4 sparse weights on the sparse tensor cores.
+  if (pass_ctx->GetConfig("raf.sparsity_24", tvm::String("none")).value() != "none") {
+    pass_seqs.push_back(pass::Sparsify24());
+  }
+  // fold the layout transforms of the bound weights, and pre-pack them for the kernels.
+  if (pass_ctx->GetConfig("raf.fold_const.prepack_weights", Bool(false)).value()) {
+    pass_seqs.push_back(pass::FoldConstant());
+  }
 
   bool enable_stream_schedule = true;
   if (!pass_ctx->GetConfig("raf.vm.optimize.anf_only", Bool(false)).value()) {
@@ -880,8 +1651,14 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
         // identical order of the operators across different devices. (There is a potential problem
         // if NCCL collectives are executed in parallel, see e.g.
         // https://github.com/NVIDIA/nccl/issues/522, https://github.com/NVIDIA/nccl/issues/195).
+        // With DistConfig::num_comm_streams > 1, the collectives are spread over multiple
+        // communication streams, where each stream has its own communicators and the collectives
+        // of a stream are still in the identical order on all devices.
         // Thus currently distributed learning and the multi-stream passes are mutually exclusive.
         pass_seqs.push_back(pass::DataParallelSchedule());
+        if (dcfg->enable_group_collectives) {
+          pass_seqs.push_back(pass::GroupCollectives());
+        }
         pass_seqs.push_back(pass::AnnotateCollectiveOps());
         pass_seqs.push_back(pass::EnforceSync());
       } else {
@@ -902,6 +1679,10 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
                      << "  sequential, wavefront, asap, and ios" << std::endl;
         }
       }
+    } else if (pass_ctx->GetConfig<tvm::String>("raf.stream_schedule.policy", "sequential") ==
+               "wavefront") {
+      // The chains of each wave are run concurrently by the CPU workers of the VM.
+      pass_seqs.push_back(pass::WavefrontStreamSchedule());
     } else {
       enable_stream_schedule = false;
       pass_seqs.push_back(pass::ToANormalForm());
@@ -923,6 +1704,7 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
 
   if (!enable_stream_schedule) {
     // TODO(@comaniac): Support rematerialization with multi-streaming.
+    pass_seqs.push_back(pass::CompressActivation());
     pass_seqs.push_back(pass::InferType());
     pass_seqs.push_back(pass::MemorySchedule());
     pass_seqs.push_back(pass::InferType());
@@ -998,7 +1780,15 @@ PackedFunc VMCompiler::GetFunction(const std::string& name, const ObjectPtr<Obje
 }
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.anf_only", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.horizontal_fuse", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.convert_layout", Bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.use_multi_func", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.jit_warmup_threads", Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.compile_cache", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.reuse_registers", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.lower_tail_calls", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.shape_buckets", ShapeBuckets);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.estimate_op_work", Bool);
 
 RAF_REGISTER_GLOBAL("raf.vm.VMCompiler").set_body_typed(CreateVMCompiler);
 
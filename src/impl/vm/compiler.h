@@ -38,6 +38,8 @@ using TagMap = NodeMap<tvm::relay::Constructor, Index>;
 using TagNameMap = std::unordered_map<size_t, tvm::relay::Constructor>;
 using GlobalMap = NodeMap<GlobalVar, Index>;
 using ConstMap = NodeMap<Constant, Index>;
+/*! \brief The shape buckets, each mapping parameter names to their static shapes. */
+using ShapeBuckets = Array<Map<String, Array<Integer>>>;
 using ConstTensorShapeMap = NodeMap<TensorType, std::pair<Index, NDArray>>;
 using DeviceMap = Map<tvm::Integer, Device>;
 
@@ -54,6 +56,12 @@ struct VMCompilerContext {
   GlobalMap global_map;
   // List of constants
   std::vector<Value> constants;
+  // Map from a constant value to its index in the constants
+  std::unordered_map<const Object*, Index> const_index;
+  // The calls of the InvokeJit instructions with static shapes, to be JITed ahead of time
+  std::vector<Call> jit_calls;
+  // The function name and the pc of the InvokeJit instruction of each call in jit_calls
+  std::vector<std::pair<std::string, Index>> jit_call_sites;
 };
 
 class VMCompiler : public tvm::runtime::ModuleNode {
@@ -92,6 +100,29 @@ class VMCompiler : public tvm::runtime::ModuleNode {
 
   void PopulateGlobalMap();
 
+  /*!
+   * \brief Optimize a version of the main function specialized to each shape bucket, and add them
+   * to context_.module as the functions named main_bucket<i>.
+   * \param mod The module before the optimizations.
+   * \param buckets The shape buckets.
+   * \return The names of the specialized functions and the shapes of their buckets.
+   */
+  std::vector<std::pair<std::string, ShapeBucket>> AddShapeBuckets(const IRModule& mod,
+                                                                   const ShapeBuckets& buckets);
+
+  /*!
+   * \brief Build the kernels of the unique calls in context_.jit_calls concurrently, so that the
+   * first execution of the executable finds them in the kernel caches instead of JITing serially.
+   * \param num_threads The number of threads. All cores are used if it is not positive.
+   */
+  void WarmupJIT(int num_threads);
+
+  /*!
+   * \brief Estimate the FLOPs and bytes of the calls in context_.jit_calls with the analytical
+   * cost model, and record them in the executable by their InvokeJit instructions.
+   */
+  void EstimateOpWork();
+
  protected:
   /*! \brief Device map. */
   DeviceMap device_map_;
@@ -0,0 +1,160 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/cpu_lane_executor.cc
+ * \brief The implementation of the executor that runs the lanes of CPU ops concurrently.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include "raf/ir.h"
+#include "raf/registry.h"
+#include "../../common/numa_utils.h"
+#include "./cpu_lane_executor.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+CpuLaneExecutor* CpuLaneExecutor::Global() {
+  static CpuLaneExecutor* executor = []() {
+    int num_workers = std::min(4, static_cast<int>(std::thread::hardware_concurrency()));
+    if (const char* val = getenv("RAF_CPU_LANE_WORKERS")) {
+      num_workers = std::stoi(val);
+    }
+    return new CpuLaneExecutor(num_workers);
+  }();
+  return executor;
+}
+
+CpuLaneExecutor::CpuLaneExecutor(int num_workers) {
+  int num_cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  num_workers = std::max(1, num_workers);
+  int intra_op_threads = std::max(1, num_cores / num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    int node = -1;
+    if (common::numa_utils::PinEnabled()) {
+      // Spread the workers over the nodes, each sharing the cores of its node.
+      int num_nodes = common::numa_utils::NumNodes();
+      node = i % num_nodes;
+      int node_workers = num_workers / num_nodes + (node < num_workers % num_nodes ? 1 : 0);
+      int node_cores = common::numa_utils::GetTopology().node_cpus[node].size();
+      intra_op_threads = std::max(1, node_cores / node_workers);
+    }
+    workers_.emplace_back([this, intra_op_threads, node]() { WorkerLoop(intra_op_threads, node); });
+  }
+}
+
+CpuLaneExecutor::~CpuLaneExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void CpuLaneExecutor::Run(const std::vector<Lane>& lanes) {
+  size_t num_lanes = std::count_if(lanes.begin(), lanes.end(),
+                                   [](const Lane& lane) { return !lane.empty(); });
+  if (num_lanes <= 1) {
+    // Nothing to overlap, so the ops run on the calling thread with all the cores.
+    for (const auto& lane : lanes) {
+      for (const auto& op : lane) {
+        op();
+      }
+    }
+    return;
+  }
+  std::lock_guard<std::mutex> run_lock(run_mu_);
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    lanes_ = &lanes;
+    next_lane_ = 0;
+    num_pending_ = lanes.size();
+    error_ = nullptr;
+    ++generation_;
+    cv_.notify_all();
+    done_cv_.wait(lock, [this]() { return num_pending_ == 0 && num_active_ == 0; });
+    lanes_ = nullptr;
+    error = error_;
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+void CpuLaneExecutor::RunLanes(const std::vector<Lane>& lanes) {
+  while (true) {
+    size_t index = next_lane_.fetch_add(1);
+    if (index >= lanes.size()) {
+      return;
+    }
+    try {
+      for (const auto& op : lanes[index]) {
+        op();
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (error_ == nullptr) {
+        error_ = std::current_exception();
+      }
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    if (--num_pending_ == 0) {
+      done_cv_.notify_all();
+    }
+  }
+}
+
+void CpuLaneExecutor::WorkerLoop(int intra_op_threads, int node) {
+  // Limit the threads of the TVM kernels launched by this worker. The mode 1 (kBig) uses all the
+  // cores of a homogeneous machine.
+  if (const auto* config = tvm::runtime::Registry::Get("runtime.config_threadpool")) {
+    if (node >= 0) {
+      // The mode -3 (kSpecifyThreadShareAllCore) lets the TVM threads share the cores of the node,
+      // so the kernels of this worker read the memory of its own node.
+      common::numa_utils::PinThreadToNode(node);
+      ir::Array<ir::String> cpus;
+      for (int cpu : common::numa_utils::GetTopology().node_cpus[node]) {
+        cpus.push_back(std::to_string(cpu));
+      }
+      (*config)(-3, intra_op_threads, cpus);
+    } else {
+      (*config)(1, intra_op_threads);
+    }
+  }
+  uint64_t seen = 0;
+  while (true) {
+    const std::vector<Lane>* lanes;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      // A worker that wakes up after the batch is finished skips it.
+      cv_.wait(lock, [this, seen]() {
+        return stop_ || (generation_ != seen && lanes_ != nullptr);
+      });
+      if (stop_) {
+        return;
+      }
+      seen = generation_;
+      lanes = lanes_;
+      ++num_active_;
+    }
+    RunLanes(*lanes);
+    std::lock_guard<std::mutex> lock(mu_);
+    if (--num_active_ == 0 && num_pending_ == 0) {
+      done_cv_.notify_all();
+    }
+  }
+}
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,96 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/cpu_lane_executor.h
+ * \brief The executor that runs the lanes of CPU ops concurrently.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+/*!
+ * \brief The executor that runs the independent lanes of CPU ops concurrently, which are the
+ * chains of a wave in the wavefront schedule. The ops of a lane run in order on one thread, while
+ * the lanes are claimed by the idle workers one at a time, so a worker that finishes its lane
+ * early takes over the remaining ones.
+ *
+ * The workers are shared by all the executions. The number of workers is min(4, #cores) by
+ * default, which can be configured by the environment variable RAF_CPU_LANE_WORKERS. Each worker
+ * configures the TVM thread pool it launches the kernels with to an equal share of the cores, so
+ * that the intra-op parallelism of the concurrent kernels does not oversubscribe the cores. With
+ * RAF_CPU_NUMA_PIN, the workers are spread over the NUMA nodes and pinned to the cores of their
+ * nodes.
+ */
+class CpuLaneExecutor {
+ public:
+  /*! \brief A lane is a list of ops to run in order. */
+  using Lane = std::vector<std::function<void()>>;
+
+  /*!
+   * \brief Get the executor shared by all the executions.
+   * \return The executor.
+   */
+  static CpuLaneExecutor* Global();
+
+  explicit CpuLaneExecutor(int num_workers);
+
+  ~CpuLaneExecutor();
+
+  /*!
+   * \brief Run the lanes concurrently and wait for all of them. The first error thrown by the ops
+   * is rethrown after all lanes are finished.
+   * \param lanes The lanes to run. The empty lanes are skipped.
+   */
+  void Run(const std::vector<Lane>& lanes);
+
+ private:
+  /*! \brief Claim and run the given lanes until none is left. */
+  void RunLanes(const std::vector<Lane>& lanes);
+
+  /*!
+   * \brief The loop of the workers.
+   * \param intra_op_threads The number of threads of the TVM kernels launched by the worker.
+   * \param node The NUMA node to pin the worker to, or -1 to not pin it.
+   */
+  void WorkerLoop(int intra_op_threads, int node);
+
+  /*! \brief The worker threads. */
+  std::vector<std::thread> workers_;
+  /*! \brief The lanes of the current batch. */
+  const std::vector<Lane>* lanes_ = nullptr;
+  /*! \brief The index of the next lane to claim. */
+  std::atomic<size_t> next_lane_{0};
+  /*! \brief The number of lanes that are not finished yet. */
+  size_t num_pending_ = 0;
+  /*! \brief The number of workers running the lanes of the current batch. */
+  int num_active_ = 0;
+  /*! \brief The first error of the current batch. */
+  std::exception_ptr error_;
+  /*! \brief The batch counter, which wakes up the workers. */
+  uint64_t generation_ = 0;
+  /*! \brief Indicates whether the workers should exit. */
+  bool stop_ = false;
+  /*! \brief Serializes the batches from different executions. */
+  std::mutex run_mu_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::condition_variable done_cv_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,394 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/dtr.cc
+ * \brief The implementation of dynamic tensor rematerialization in the VM.
+ */
+#include <algorithm>
+#include <limits>
+#include "raf/memory_profiler.h"
+#include "../../common/shape_utils.h"
+#include "./dtr.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using namespace raf::value;
+using memory_pool::Memory;
+
+namespace {
+
+/*!
+ * \brief The storages smaller than this are never evicted. Evicting them saves little, and they
+ * may hold the shapes and conditions that the VM reads directly.
+ */
+constexpr int64_t kMinEvictBytes = 4096;
+
+void CollectTensors(const Value& value, std::vector<TensorValue>* tensors) {
+  if (const auto* tensor = value.as<TensorValueObj>()) {
+    tensors->push_back(GetRef<TensorValue>(tensor));
+  } else if (const auto* tuple = value.as<TupleValueObj>()) {
+    for (const auto& field : tuple->fields) {
+      CollectTensors(field, tensors);
+    }
+  }
+}
+
+int64_t TensorBytes(const TensorValue& tensor) {
+  const DLTensor* dlt = tensor;
+  return common::shape_utils::BytesCompactTensor(*dlt);
+}
+
+}  // namespace
+
+DTRManager::~DTRManager() = default;
+
+void DTRManager::Reserve(int64_t nbytes) {
+  while (resident_bytes_ + nbytes > budget_) {
+    Storage* victim = nullptr;
+    double min_score = 0;
+    for (const auto& kv : storages_) {
+      Storage* storage = kv.second.get();
+      if (!IsEvictable(storage)) {
+        continue;
+      }
+      // Evicting a storage whose inputs are evicted makes it more expensive to rematerialize.
+      double cost = storage->cost;
+      for (Buffer* input : storage->inputs) {
+        if (input->storage != nullptr && input->storage->evicted) {
+          cost += input->storage->cost;
+        }
+      }
+      double staleness = static_cast<double>(clock_ - storage->last_access + 1);
+      double score = cost / (static_cast<double>(storage->nbytes) * staleness);
+      if (victim == nullptr || score < min_score) {
+        victim = storage;
+        min_score = score;
+      }
+    }
+    if (victim == nullptr) {
+      DLOG(INFO) << "DTR: no storage can be evicted for " << nbytes << " bytes, "
+                 << resident_bytes_ << " bytes are resident";
+      return;
+    }
+    Evict(victim);
+  }
+}
+
+void DTRManager::TrackStorage(const StorageValue& storage, const Device& device,
+                              int64_t alignment) {
+  if (storage->size < 0 || storage->buffer == nullptr) {
+    return;
+  }
+  auto& entry = storages_[storage.get()];
+  CHECK(entry == nullptr) << "The storage is already tracked";
+  entry = std::make_unique<Storage>();
+  entry->storage = entry.get();
+  entry->value = storage;
+  entry->device = device;
+  entry->nbytes = storage->size;
+  entry->alignment = alignment;
+  entry->last_access = clock_;
+  resident_bytes_ += entry->nbytes;
+}
+
+void DTRManager::Touch(const StorageValue& storage) {
+  auto it = storages_.find(storage.get());
+  if (it == storages_.end()) {
+    return;
+  }
+  Rematerialize(it->second.get());
+  it->second->last_access = clock_;
+}
+
+void DTRManager::AddView(const StorageValue& storage, const TensorValue& tensor) {
+  auto it = storages_.find(storage.get());
+  if (it == storages_.end()) {
+    return;
+  }
+  Storage* s = it->second.get();
+  const DLTensor* dlt = tensor;
+  const auto& buffer = s->value->buffer;
+  int64_t offset = static_cast<char*>(dlt->data) - static_cast<char*>(buffer->data);
+  s->views.push_back({tensor, offset, tensor->mem != nullptr && tensor->mem == buffer});
+  tensor_storages_[tensor.get()] = s;
+}
+
+void DTRManager::AddAlias(const TensorValue& src, const TensorValue& alias) {
+  Storage* s = GetStorage(src);
+  if (s == nullptr) {
+    return;
+  }
+  if (s->evicted) {
+    // The alias is made from the data pointer of the source.
+    Rematerialize(s);
+    DLTensor* dlt = alias;
+    dlt->data = static_cast<const DLTensor*>(src)->data;
+    if (src->mem != nullptr) {
+      alias->mem = src->mem;
+    }
+  }
+  AddView(s->value, alias);
+}
+
+void DTRManager::BeforeOp(const std::vector<Value>& inputs, const std::vector<Value>& outputs) {
+  ++clock_;
+  std::vector<TensorValue> tensors;
+  for (const auto& input : inputs) {
+    CollectTensors(input, &tensors);
+  }
+  size_t num_input_tensors = tensors.size();
+  for (const auto& output : outputs) {
+    CollectTensors(output, &tensors);
+  }
+  // Keep all the buffers of the op first, so that they do not evict each other.
+  for (const auto& tensor : tensors) {
+    if (Storage* s = GetStorage(tensor)) {
+      Pin(s);
+      op_pins_.push_back(s);
+      s->last_access = clock_;
+    }
+  }
+  for (Storage* s : op_pins_) {
+    Rematerialize(s);
+  }
+  // The evicted storages that read the buffers to be overwritten have to be rematerialized now.
+  for (size_t i = num_input_tensors; i < tensors.size(); ++i) {
+    if (Buffer* buffer = GetBuffer(tensors[i], false)) {
+      Invalidate(buffer);
+    }
+  }
+}
+
+void DTRManager::AfterOp(const op::OpEnvPtr& op_env, const std::vector<Value>& inputs,
+                         const Value& output, bool recomputable) {
+  std::vector<TensorValue> input_tensors, output_tensors;
+  for (const auto& input : inputs) {
+    CollectTensors(input, &input_tensors);
+  }
+  CollectTensors(output, &output_tensors);
+  std::vector<Storage*> written;
+  double cost = 0;
+  for (const auto& tensor : output_tensors) {
+    cost += TensorBytes(tensor);
+    Storage* s = GetStorage(tensor);
+    if (s != nullptr && std::find(written.begin(), written.end(), s) == written.end()) {
+      written.push_back(s);
+    }
+  }
+  for (const auto& tensor : input_tensors) {
+    cost += TensorBytes(tensor);
+  }
+  for (Storage* s : written) {
+    if (!recomputable || !s->recomputable) {
+      DropLineage(s);
+      continue;
+    }
+    s->writes.push_back({op_env, inputs, output});
+    s->cost += cost;
+    for (const auto& tensor : input_tensors) {
+      Buffer* buffer = GetBuffer(tensor, true);
+      if (buffer != s) {
+        buffer->readers.insert(s);
+        s->inputs.insert(buffer);
+      }
+    }
+  }
+  for (Storage* s : op_pins_) {
+    Unpin(s);
+  }
+  op_pins_.clear();
+}
+
+void DTRManager::Release(const Value& value) {
+  Storage* s = nullptr;
+  if (const auto* storage = value.as<StorageValueObj>()) {
+    auto it = storages_.find(storage);
+    s = it == storages_.end() ? nullptr : it->second.get();
+  } else if (const auto* tensor = value.as<TensorValueObj>()) {
+    s = GetStorage(value);
+    if (s == nullptr) {
+      auto it = untracked_.find(tensor->tensor->data);
+      if (it != untracked_.end()) {
+        Invalidate(it->second.get());
+        untracked_.erase(it);
+      }
+      return;
+    }
+  }
+  if (s == nullptr) {
+    return;
+  }
+  Invalidate(s);
+  DropLineage(s);
+  for (const auto& view : s->views) {
+    tensor_storages_.erase(view.tensor.get());
+  }
+  if (!s->evicted) {
+    resident_bytes_ -= s->nbytes;
+  }
+  storages_.erase(s->value.get());
+}
+
+void DTRManager::Finish() {
+  // Nothing is evicted any more, so each storage is rematerialized at most once.
+  budget_ = std::numeric_limits<int64_t>::max();
+  for (const auto& kv : storages_) {
+    Rematerialize(kv.second.get());
+  }
+  storages_.clear();
+  tensor_storages_.clear();
+  untracked_.clear();
+  op_pins_.clear();
+  resident_bytes_ = 0;
+}
+
+DTRManager::Buffer* DTRManager::GetBuffer(const TensorValue& tensor, bool create) {
+  if (Storage* s = GetStorage(tensor)) {
+    return s;
+  }
+  const void* data = tensor->tensor->data;
+  auto it = untracked_.find(data);
+  if (it != untracked_.end()) {
+    return it->second.get();
+  }
+  if (!create) {
+    return nullptr;
+  }
+  auto& buffer = untracked_[data];
+  buffer = std::make_unique<Buffer>();
+  return buffer.get();
+}
+
+DTRManager::Storage* DTRManager::GetStorage(const Value& tensor) {
+  auto it = tensor_storages_.find(tensor.as<TensorValueObj>());
+  return it == tensor_storages_.end() ? nullptr : it->second;
+}
+
+bool DTRManager::IsEvictable(const Storage* storage) const {
+  return !storage->evicted && storage->recomputable && storage->pins == 0 &&
+         !storage->writes.empty() && storage->nbytes >= kMinEvictBytes;
+}
+
+void DTRManager::Evict(Storage* storage) {
+  auto& buffer = storage->value->buffer;
+  if (memory_profiler::MemoryProfiler::Get()->IsProfiling()) {
+    memory_profiler::MemoryProfiler::Get()->RecordFree(buffer->device, buffer.get());
+  }
+  for (auto& view : storage->views) {
+    if (view.own) {
+      view.tensor->mem = nullptr;
+    }
+    DLTensor* dlt = view.tensor;
+    dlt->data = nullptr;
+  }
+  buffer = nullptr;
+  storage->evicted = true;
+  resident_bytes_ -= storage->nbytes;
+  ++num_evictions_;
+}
+
+void DTRManager::Rematerialize(Storage* storage) {
+  if (!storage->evicted) {
+    return;
+  }
+  CHECK(storage->recomputable) << "DTR: an evicted storage cannot be rematerialized";
+  CHECK(!storage->rematerializing) << "DTR: the lineage of a storage depends on itself";
+  storage->rematerializing = true;
+  Pin(storage);
+  std::vector<Storage*> inputs;
+  for (Buffer* input : storage->inputs) {
+    if (input->storage != nullptr) {
+      Pin(input->storage);
+      inputs.push_back(input->storage);
+    }
+  }
+  for (Storage* input : inputs) {
+    Rematerialize(input);
+  }
+
+  auto buffer = falloc_(storage->device, storage->nbytes, storage->alignment);
+  storage->value->buffer = buffer;
+  for (auto& view : storage->views) {
+    DLTensor* dlt = view.tensor;
+    dlt->data = static_cast<char*>(buffer->data) + view.offset;
+    if (view.own) {
+      view.tensor->mem = buffer;
+    }
+  }
+  storage->evicted = false;
+  resident_bytes_ += storage->nbytes;
+
+  // Replay the ops in order. The outputs on the other storages are redirected to scratch
+  // buffers, since those storages may have been overwritten since.
+  std::vector<std::shared_ptr<Memory>> scratch;
+  std::function<Value(const Value&)> redirect = [&](const Value& value) -> Value {
+    if (const auto* tensor = value.as<TensorValueObj>()) {
+      if (GetStorage(value) == storage) {
+        return value;
+      }
+      const DLTensor* dlt = tensor->tensor.operator->();
+      std::vector<int64_t> shape(dlt->shape, dlt->shape + dlt->ndim);
+      auto mem = falloc_(dlt->device, TensorBytes(GetRef<TensorValue>(tensor)),
+                         kDefaultMemoryAlignment);
+      scratch.push_back(mem);
+      return TensorValue::Assemble(dlt->device, dlt->dtype, shape, {}, mem->data, mem);
+    }
+    const auto* tuple = value.as<TupleValueObj>();
+    CHECK(tuple != nullptr) << "Unsupported output type: " << value->GetTypeKey();
+    Array<Value> fields;
+    for (const auto& field : tuple->fields) {
+      fields.push_back(redirect(field));
+    }
+    return TupleValue::make(fields);
+  };
+  for (const auto& write : storage->writes) {
+    fexecute_(write.op_env, write.inputs, redirect(write.output));
+  }
+  ++num_rematerializations_;
+
+  for (Storage* input : inputs) {
+    Unpin(input);
+  }
+  Unpin(storage);
+  storage->rematerializing = false;
+}
+
+void DTRManager::Invalidate(Buffer* buffer) {
+  auto readers = std::move(buffer->readers);
+  buffer->readers.clear();
+  for (Storage* reader : readers) {
+    if (reader == buffer) {
+      continue;
+    }
+    Rematerialize(reader);
+    DropLineage(reader);
+  }
+}
+
+void DTRManager::DropLineage(Storage* storage) {
+  for (Buffer* input : storage->inputs) {
+    input->readers.erase(storage);
+  }
+  storage->inputs.clear();
+  storage->writes.clear();
+  storage->cost = 0;
+  storage->recomputable = false;
+}
+
+void DTRManager::Pin(Storage* storage) {
+  ++storage->pins;
+}
+
+void DTRManager::Unpin(Storage* storage) {
+  CHECK_GT(storage->pins, 0);
+  --storage->pins;
+}
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,194 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/dtr.h
+ * \brief Dynamic tensor rematerialization (DTR) of the storages in a VM execution.
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "raf/memory_pool.h"
+#include "raf/op.h"
+#include "raf/value.h"
+#include "raf/vm/value.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+/*!
+ * \brief Dynamic tensor rematerialization (DTR) of an execution, which keeps the storages
+ * allocated by the program within a memory budget at runtime instead of planning ahead with
+ * accurate shapes. Once an allocation would exceed the budget, the storages with the lowest
+ * cost / (size * staleness) are evicted, where the cost of a storage is the bytes read and written
+ * by the ops that wrote it, plus the cost of its evicted inputs. The ops are recorded as the
+ * lineage of the storage, and are replayed in order to rematerialize it once it is accessed.
+ *
+ * The unit of eviction is a storage, which may hold several tensors by the memory plan. A storage
+ * can only be rematerialized while the buffers its ops read are unchanged. So before a buffer is
+ * written or freed, the evicted storages that read it are rematerialized, and the storages that
+ * read it are no longer evictable. The storages written by ops with side effects, e.g., the
+ * collectives, are never evicted, neither are the tiny storages that may be read by the VM, e.g.,
+ * shape tensors.
+ */
+class DTRManager {
+ public:
+  /*! \brief Allocate a buffer, evicting the storages over the budget if needed. */
+  using FAlloc = std::function<std::shared_ptr<memory_pool::Memory>(const Device& device,
+                                                                    int64_t nbytes,
+                                                                    int64_t alignment)>;
+  /*! \brief Execute an op with its workspace. */
+  using FExecute = std::function<void(const op::OpEnvPtr& op_env,
+                                      const std::vector<value::Value>& inputs,
+                                      const value::Value& output)>;
+
+  /*!
+   * \brief Create the manager of an execution.
+   * \param budget The budget of the storages in bytes.
+   * \param falloc The function to allocate buffers for rematerialization.
+   * \param fexecute The function to replay the ops.
+   */
+  DTRManager(int64_t budget, FAlloc falloc, FExecute fexecute)
+      : budget_(budget), falloc_(std::move(falloc)), fexecute_(std::move(fexecute)) {
+  }
+
+  ~DTRManager();
+
+  /*! \brief Evict the storages until nbytes more fit in the budget, if possible. */
+  void Reserve(int64_t nbytes);
+
+  /*! \brief Track a storage allocated by the program. */
+  void TrackStorage(const StorageValue& storage, const Device& device, int64_t alignment);
+
+  /*! \brief Rematerialize the storage before a tensor is placed on it. */
+  void Touch(const StorageValue& storage);
+
+  /*! \brief Track a tensor placed on the storage, whose data pointer follows the storage. */
+  void AddView(const StorageValue& storage, const value::TensorValue& tensor);
+
+  /*! \brief Track a tensor sharing the data of another tensor, e.g., reshaped by set_shape. */
+  void AddAlias(const value::TensorValue& src, const value::TensorValue& alias);
+
+  /*!
+   * \brief Prepare the buffers before an op runs: rematerialize its evicted inputs and outputs,
+   * keep them until the op is recorded, and rematerialize the evicted storages that read the
+   * buffers the op is about to overwrite.
+   */
+  void BeforeOp(const std::vector<value::Value>& inputs, const std::vector<value::Value>& outputs);
+
+  /*!
+   * \brief Record the op as the lineage of the storages of its outputs.
+   * \param op_env The OpEnv that has run.
+   * \param inputs The inputs the OpEnv has run with.
+   * \param output The output the OpEnv has written.
+   * \param recomputable Whether the op can be replayed, i.e., has no side effects.
+   */
+  void AfterOp(const op::OpEnvPtr& op_env, const std::vector<value::Value>& inputs,
+               const value::Value& output, bool recomputable);
+
+  /*! \brief Stop tracking a storage or tensor freed by the program. */
+  void Release(const value::Value& value);
+
+  /*! \brief Rematerialize the evicted storages, e.g., the outputs, at the end of the execution. */
+  void Finish();
+
+  /*! \brief The number of evictions so far. */
+  uint64_t NumEvictions() const {
+    return num_evictions_;
+  }
+
+  /*! \brief The number of rematerializations so far. */
+  uint64_t NumRematerializations() const {
+    return num_rematerializations_;
+  }
+
+ private:
+  struct Storage;
+
+  /*! \brief A buffer read by the recorded ops, either a tracked storage or untracked data. */
+  struct Buffer {
+    /*! \brief The tracked storage, or nullptr if the buffer is untracked. */
+    Storage* storage = nullptr;
+    /*! \brief The storages whose recorded ops read this buffer. */
+    std::unordered_set<Storage*> readers;
+  };
+
+  /*! \brief An op recorded in the lineage of a storage. */
+  struct Write {
+    op::OpEnvPtr op_env;
+    std::vector<value::Value> inputs;
+    value::Value output;
+  };
+
+  struct Storage : Buffer {
+    StorageValue value;
+    Device device;
+    int64_t nbytes;
+    int64_t alignment;
+    /*! \brief The tensors on the storage, their offsets and whether they own the buffer. */
+    struct View {
+      value::TensorValue tensor;
+      int64_t offset;
+      bool own;
+    };
+    std::vector<View> views;
+    /*! \brief The recorded ops in order, which rewrite the storage from scratch. */
+    std::vector<Write> writes;
+    /*! \brief The buffers read by the recorded ops. */
+    std::unordered_set<Buffer*> inputs;
+    /*! \brief The bytes read and written by the recorded ops. */
+    double cost = 0;
+    /*! \brief The logical time of the last access. */
+    uint64_t last_access = 0;
+    /*! \brief The number of holds that keep the storage resident. */
+    int pins = 0;
+    bool evicted = false;
+    bool recomputable = true;
+    bool rematerializing = false;
+  };
+
+  /*! \brief The buffer of a tensor. An untracked one is created if needed and create is true. */
+  Buffer* GetBuffer(const value::TensorValue& tensor, bool create);
+  /*! \brief The tracked storage of a tensor, or nullptr. */
+  Storage* GetStorage(const value::Value& tensor);
+  bool IsEvictable(const Storage* storage) const;
+  void Evict(Storage* storage);
+  void Rematerialize(Storage* storage);
+  /*! \brief Rematerialize the evicted readers of the buffer, which are no longer evictable. */
+  void Invalidate(Buffer* buffer);
+  /*! \brief Drop the lineage of a storage, which is then never evicted. */
+  void DropLineage(Storage* storage);
+  void Pin(Storage* storage);
+  void Unpin(Storage* storage);
+
+  /*! \brief The budget of the resident storages in bytes. */
+  int64_t budget_;
+  FAlloc falloc_;
+  FExecute fexecute_;
+  /*! \brief The bytes of the resident tracked storages. */
+  int64_t resident_bytes_ = 0;
+  /*! \brief The logical clock, advanced by each op. */
+  uint64_t clock_ = 0;
+  /*! \brief The tracked storages. */
+  std::unordered_map<const StorageValueObj*, std::unique_ptr<Storage>> storages_;
+  /*! \brief The tracked storage of each tensor on it. */
+  std::unordered_map<const value::TensorValueObj*, Storage*> tensor_storages_;
+  /*! \brief The untracked buffers read by the recorded ops, by their data pointers. */
+  std::unordered_map<const void*, std::unique_ptr<Buffer>> untracked_;
+  /*! \brief The storages kept resident for the current op. */
+  std::vector<Storage*> op_pins_;
+  uint64_t num_evictions_ = 0;
+  uint64_t num_rematerializations_ = 0;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -13,14 +13,19 @@
 #include <tvm/runtime/object.h>
 
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <vector>
 
+#include "raf/memory_pool.h"
 #include "raf/serialization.h"
 #include "raf/vm/vm.h"
 #include "./serialize_util.h"
+#include "../../common/mapped_file.h"
 
 namespace raf {
 namespace executor {
@@ -28,6 +33,8 @@ namespace vm {
 
 using namespace raf::ir;
 using namespace raf::registry;
+using common::mapped_file::MappedFile;
+using common::mapped_file::MappedMemory;
 
 #define STREAM_CHECK(val, section)                                         \
   CHECK(val) << "Invalid VM file format in the " << section << " section." \
@@ -191,6 +198,12 @@ TVMByteArray Executable::Save() {
   // Code section.
   SaveCodeSection(&strm);
 
+  // Shape bucket section.
+  SaveShapeBucketSection(&strm);
+
+  // Op work section.
+  SaveOpWorkSection(&strm);
+
   TVMByteArray arr;
   arr.data = code_.c_str();
   arr.size = code_.length();
@@ -334,6 +347,10 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       fields.push_back(instr.free.memory);
       break;
     }
+    case Opcode::KillRegister: {
+      fields.push_back(instr.dst);
+      break;
+    }
     case Opcode::AllocTuple: {
       // Number of fields = 2 + instr.num_fields
       fields.assign({instr.alloc_tuple.num_fields, instr.dst});
@@ -424,9 +441,10 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       break;
     }
     case Opcode::CudaSetStream: {
-      // Number of fields = 2
+      // Number of fields = 3
       fields.push_back(instr.cuda_set_stream.device_id);
       fields.push_back(instr.cuda_set_stream.stream_id);
+      fields.push_back(instr.cuda_set_stream.priority);
       break;
     }
     case Opcode::CudaAddEvent:
@@ -465,6 +483,32 @@ void Executable::SaveCodeSection(dmlc::Stream* strm) {
   }
 }
 
+void Executable::SaveShapeBucketSection(dmlc::Stream* strm) {
+  strm->Write(static_cast<uint64_t>(this->shape_buckets.size()));
+  for (const auto& it : this->shape_buckets) {
+    strm->Write(it.first);
+    strm->Write(static_cast<uint64_t>(it.second.size()));
+    for (const auto& bucket : it.second) {
+      strm->Write(static_cast<int64_t>(bucket.func_index));
+      strm->Write(bucket.param_indices);
+      strm->Write(bucket.shapes);
+    }
+  }
+}
+
+void Executable::SaveOpWorkSection(dmlc::Stream* strm) {
+  strm->Write(static_cast<uint64_t>(this->op_work.size()));
+  for (const auto& it : this->op_work) {
+    strm->Write(it.first);
+    strm->Write(static_cast<uint64_t>(it.second.size()));
+    for (const auto& work : it.second) {
+      strm->Write(static_cast<int64_t>(work.first));
+      strm->Write(work.second.gflops);
+      strm->Write(work.second.bytes);
+    }
+  }
+}
+
 void LoadHeader(dmlc::Stream* strm) {
   // Check header.
   uint64_t header;
@@ -498,6 +542,102 @@ tvm::runtime::Module Executable::Load(const std::string& code, const tvm::runtim
   // Code section.
   exec->LoadCodeSection(&strm);
 
+  // Shape bucket section.
+  exec->LoadShapeBucketSection(&strm);
+
+  // Op work section.
+  exec->LoadOpWorkSection(&strm);
+
+  return tvm::runtime::Module(exec);
+}
+
+/*!
+ * \brief Deserialize a constant from a mapped executable file. The tensors refer to their data in
+ * the file instead of being copied, and the other values are deserialized as usual.
+ * \param strm The stream over the mapped file.
+ * \param file The mapped file.
+ * \return The constant.
+ */
+Value DeserializeMappedValue(dmlc::MemoryFixedSizeStream* strm,
+                             const std::shared_ptr<MappedFile>& file) {
+  size_t begin = strm->Tell();
+  uint8_t v_type;
+  STREAM_CHECK(strm->Read(&v_type, sizeof(v_type)), "constant");
+  if (v_type == value::kTupleValue) {
+    uint64_t size;
+    STREAM_CHECK(strm->Read(&size), "constant");
+    Array<Value> fields;
+    for (uint64_t i = 0; i < size; ++i) {
+      fields.push_back(DeserializeMappedValue(strm, file));
+    }
+    return TupleValue::make(fields);
+  }
+  if (v_type != value::kTensorValue || !DMLC_IO_NO_ENDIAN_SWAP) {
+    strm->Seek(begin);
+    return serialization::DeserializeValue(strm);
+  }
+  // Follow the format of tvm::runtime::SaveDLTensor.
+  uint64_t header, reserved;
+  DLDevice dev;
+  int ndim;
+  DLDataType dtype;
+  STREAM_CHECK(strm->Read(&header) && header == kTVMNDArrayMagic, "constant");
+  STREAM_CHECK(strm->Read(&reserved), "constant");
+  STREAM_CHECK(strm->Read(&dev), "constant");
+  STREAM_CHECK(strm->Read(&ndim), "constant");
+  STREAM_CHECK(strm->Read(&dtype), "constant");
+  std::vector<int64_t> shape(ndim);
+  if (ndim != 0) {
+    STREAM_CHECK(strm->ReadArray(shape.data(), ndim), "constant");
+  }
+  int64_t num_elems = 1;
+  for (int64_t dim : shape) {
+    num_elems *= dim;
+  }
+  int64_t data_byte_size;
+  STREAM_CHECK(strm->Read(&data_byte_size), "constant");
+  STREAM_CHECK(data_byte_size == num_elems * ((dtype.bits + 7) / 8) * dtype.lanes, "constant");
+  size_t offset = strm->Tell();
+  STREAM_CHECK(offset + data_byte_size <= file->size, "constant");
+  strm->Seek(offset + data_byte_size);
+  void* data = file->data + offset;
+  return TensorValue::Assemble(Device(DevType::kCPU(), 0), dtype, shape, {}, data,
+                               std::make_shared<MappedMemory>(file, data));
+}
+
+tvm::runtime::Module Executable::LoadFromFile(const std::string& path,
+                                              const tvm::runtime::Module lib) {
+  auto file = std::make_shared<MappedFile>(path);
+  auto exec = make_object<Executable>();
+  exec->lib = lib;
+  dmlc::MemoryFixedSizeStream strm(file->data, file->size);
+
+  // Load header.
+  LoadHeader(&strm);
+
+  // Global section.
+  exec->LoadGlobalSection(&strm);
+
+  // Constant section. The tensors are left in the mapped file, and are copied to the device when
+  // they are loaded by the virtual machine for the first time.
+  uint64_t num_constants;
+  STREAM_CHECK(strm.Read(&num_constants), "constant");
+  for (uint64_t i = 0; i < num_constants; ++i) {
+    exec->constants.push_back(DeserializeMappedValue(&strm, file));
+  }
+
+  // Primitive names that will be invoked by `InvokePacked` instructions.
+  exec->LoadPrimitiveOpNames(&strm);
+
+  // Code section.
+  exec->LoadCodeSection(&strm);
+
+  // Shape bucket section.
+  exec->LoadShapeBucketSection(&strm);
+
+  // Op work section.
+  exec->LoadOpWorkSection(&strm);
+
   return tvm::runtime::Module(exec);
 }
 
@@ -657,6 +797,11 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
       RegName memory_reg = instr.fields[0];
       return Instruction::Free(memory_reg);
     }
+    case Opcode::KillRegister: {
+      DCHECK_EQ(instr.fields.size(), 1U);
+      RegName dst = instr.fields[0];
+      return Instruction::KillRegister(dst);
+    }
     case Opcode::SetShape: {
       DCHECK_GE(instr.fields.size(), 3U);
       RegName data = instr.fields[0];
@@ -742,9 +887,10 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
       return Instruction::InferType(op_reg, args, dst);
     }
     case Opcode::CudaSetStream: {
-      // Number of fields = 2
-      DCHECK_EQ(instr.fields.size(), 2U);
-      return Instruction::CudaSetStream(instr.fields[0], instr.fields[1]);
+      // Number of fields = 3, or 2 for the executables saved without the priority
+      DCHECK(instr.fields.size() == 2U || instr.fields.size() == 3U);
+      Index priority = instr.fields.size() == 3U ? instr.fields[2] : -1;
+      return Instruction::CudaSetStream(instr.fields[0], instr.fields[1], priority);
     }
     case Opcode::CudaAddEvent: {
       // Number of fields = 2
@@ -798,6 +944,47 @@ void Executable::LoadCodeSection(dmlc::Stream* strm) {
   }
 }
 
+void Executable::LoadShapeBucketSection(dmlc::Stream* strm) {
+  uint64_t num_funcs;
+  STREAM_CHECK(strm->Read(&num_funcs), "shape bucket");
+  for (uint64_t i = 0; i < num_funcs; ++i) {
+    std::string name;
+    uint64_t num_buckets;
+    STREAM_CHECK(strm->Read(&name), "shape bucket");
+    STREAM_CHECK(strm->Read(&num_buckets), "shape bucket");
+    auto& buckets = this->shape_buckets[name];
+    buckets.resize(num_buckets);
+    for (auto& bucket : buckets) {
+      int64_t func_index;
+      STREAM_CHECK(strm->Read(&func_index), "shape bucket");
+      STREAM_CHECK(strm->Read(&bucket.param_indices), "shape bucket");
+      STREAM_CHECK(strm->Read(&bucket.shapes), "shape bucket");
+      CHECK_LT(static_cast<size_t>(func_index), this->functions.size());
+      bucket.func_index = func_index;
+    }
+  }
+}
+
+void Executable::LoadOpWorkSection(dmlc::Stream* strm) {
+  uint64_t num_funcs;
+  STREAM_CHECK(strm->Read(&num_funcs), "op work");
+  for (uint64_t i = 0; i < num_funcs; ++i) {
+    std::string name;
+    uint64_t num_instrs;
+    STREAM_CHECK(strm->Read(&name), "op work");
+    STREAM_CHECK(strm->Read(&num_instrs), "op work");
+    auto& func_work = this->op_work[name];
+    for (uint64_t j = 0; j < num_instrs; ++j) {
+      int64_t pc;
+      OpWorkEstimate work;
+      STREAM_CHECK(strm->Read(&pc), "op work");
+      STREAM_CHECK(strm->Read(&work.gflops), "op work");
+      STREAM_CHECK(strm->Read(&work.bytes), "op work");
+      func_work[pc] = work;
+    }
+  }
+}
+
 RAF_REGISTER_GLOBAL("raf.vm.GetNumOfGlobals").set_body([](TVMArgs args, TVMRetValue* rv) {
   tvm::runtime::Module mod = args[0];
   const auto* exec = dynamic_cast<Executable*>(mod.operator->());
@@ -848,6 +1035,11 @@ RAF_REGISTER_GLOBAL("raf.vm.Load_Executable")
       return Executable::Load(code, lib);
     });
 
+RAF_REGISTER_GLOBAL("raf.vm.Load_ExecutableFromFile")
+    .set_body_typed([](std::string path, tvm::runtime::Module lib) {
+      return Executable::LoadFromFile(path, lib);
+    });
+
 }  // namespace vm
 }  // namespace executor
 }  // namespace raf
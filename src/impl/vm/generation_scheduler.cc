@@ -0,0 +1,319 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/generation_scheduler.cc
+ * \brief The implementation of the continuous batching scheduler.
+ */
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <utility>
+
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+#include "./generation_scheduler.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+/*!
+ * \brief Copy a host array to a tensor on the device.
+ * \param data The host array.
+ * \param dtype The dtype of the array.
+ * \param shape The shape of the tensor.
+ * \param device The device of the tensor.
+ * \return The tensor on the device.
+ */
+template <typename T>
+TensorValue HostToDevice(const std::vector<T>& data, DType dtype,
+                         const std::vector<int64_t>& shape, const Device& device) {
+  Device cpu(DevType::kCPU(), 0);
+  auto mem = memory_pool::Memory::Alloc(cpu, data.size() * sizeof(T));
+  std::memcpy(mem->data, data.data(), data.size() * sizeof(T));
+  auto tensor = TensorValue::Assemble(cpu, dtype, shape, {}, mem->data, mem);
+  return Downcast<TensorValue>(CopyTo(tensor, device));
+}
+
+GenerationScheduler::GenerationScheduler(tvm::runtime::Module vm, std::string func_name,
+                                         const Device& device, DType dtype, int num_layers,
+                                         int64_t num_blocks, int64_t block_size,
+                                         std::vector<int64_t> token_shape, int64_t max_num_tokens,
+                                         int64_t max_num_seqs, int64_t max_seq_len,
+                                         int64_t eos_token_id, std::vector<Value> params)
+    : vm_module_(vm),
+      func_name_(std::move(func_name)),
+      device_(device),
+      kv_cache_(device, dtype, num_layers, num_blocks, block_size, token_shape),
+      block_size_(block_size),
+      max_num_tokens_(max_num_tokens),
+      max_num_seqs_(max_num_seqs),
+      max_seq_len_(max_seq_len),
+      max_blocks_((max_seq_len + block_size - 1) / block_size),
+      eos_token_id_(eos_token_id),
+      params_(std::move(params)) {
+  vm_ = dynamic_cast<VirtualMachine*>(vm_module_.operator->());
+  CHECK(vm_) << "The generation scheduler requires a virtual machine.";
+  CHECK_GT(max_num_tokens_, 0);
+  CHECK_GT(max_num_seqs_, 0);
+  CHECK_GT(max_seq_len_, 0);
+  CHECK_GE(num_blocks, max_blocks_) << "The caches cannot hold a sequence of the maximal length";
+  worker_ = std::thread([this]() { WorkerLoop(); });
+}
+
+GenerationScheduler::~GenerationScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+std::vector<int64_t> GenerationScheduler::Generate(std::vector<int64_t> prompt,
+                                                   int64_t max_new_tokens) {
+  CHECK(!prompt.empty()) << "The prompt is empty";
+  CHECK_LE(prompt.size(), max_num_tokens_)
+      << "The prompt of " << prompt.size() << " tokens exceeds the token budget of a step";
+  CHECK_LT(prompt.size(), max_seq_len_) << "The prompt reaches the maximal sequence length";
+  auto seq = std::make_shared<Sequence>();
+  seq->tokens = std::move(prompt);
+  seq->num_prompt_tokens = seq->tokens.size();
+  seq->max_new_tokens = max_new_tokens;
+  if (max_new_tokens <= 0) {
+    return {};
+  }
+  std::future<std::vector<int64_t>> future = seq->promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    CHECK(!stop_) << "The generation scheduler has been stopped";
+    seq->id = next_seq_id_++;
+    waiting_.push_back(std::move(seq));
+  }
+  cv_.notify_all();
+  return future.get();
+}
+
+int64_t GenerationScheduler::BlocksToAppend(const Sequence& seq, int64_t n) const {
+  int64_t length = kv_cache_.SeqLen(seq.id);
+  return (length + n + block_size_ - 1) / block_size_ - (length + block_size_ - 1) / block_size_;
+}
+
+void GenerationScheduler::Preempt(std::shared_ptr<Sequence> seq) {
+  // The keys and values of all its tokens are recomputed once it is admitted again.
+  kv_cache_.Free(seq->id);
+  seq->num_cached = 0;
+  std::lock_guard<std::mutex> lock(mu_);
+  waiting_.push_front(std::move(seq));
+}
+
+void GenerationScheduler::Admit() {
+  int64_t num_tokens = 0;
+  int64_t free_blocks = kv_cache_.NumFreeBlocks();
+  for (const auto& seq : running_) {
+    int64_t n = seq->tokens.size() - seq->num_cached;
+    num_tokens += n;
+    free_blocks -= BlocksToAppend(*seq, n);
+  }
+  std::lock_guard<std::mutex> lock(mu_);
+  // Admit in the arrival order, so that a long prompt is not starved by the short ones.
+  while (!waiting_.empty() && running_.size() < max_num_seqs_) {
+    const auto& seq = waiting_.front();
+    int64_t n = seq->tokens.size();
+    int64_t blocks = (n + block_size_ - 1) / block_size_;
+    // A sequence longer than the budget, e.g., a preempted one, is computed in chunks alone.
+    bool fits = num_tokens + n <= max_num_tokens_ || running_.empty();
+    if (!fits || blocks > free_blocks) {
+      break;
+    }
+    num_tokens += n;
+    free_blocks -= blocks;
+    running_.push_back(seq);
+    waiting_.pop_front();
+  }
+}
+
+std::vector<std::vector<int64_t>> GenerationScheduler::ReserveSlots() {
+  std::vector<std::vector<int64_t>> slots;
+  int64_t num_tokens = 0;
+  for (size_t i = 0; i < running_.size(); ++i) {
+    const auto& seq = running_[i];
+    int64_t n = std::min<int64_t>(seq->tokens.size() - seq->num_cached,
+                                  max_num_tokens_ - num_tokens);
+    while (BlocksToAppend(*seq, n) > kv_cache_.NumFreeBlocks() && running_.size() > i + 1) {
+      Preempt(running_.back());
+      running_.pop_back();
+    }
+    if (BlocksToAppend(*seq, n) > kv_cache_.NumFreeBlocks()) {
+      // Only the earlier sequences hold blocks, so this one waits for them to finish.
+      Preempt(seq);
+      running_.erase(running_.begin() + i);
+      break;
+    }
+    slots.push_back(kv_cache_.Append(seq->id, n));
+    num_tokens += n;
+  }
+  return slots;
+}
+
+void GenerationScheduler::Step() {
+  auto slots = ReserveSlots();
+  if (running_.empty()) {
+    return;
+  }
+  int64_t max_len = max_blocks_ * block_size_;
+  std::vector<int64_t> tokens(max_num_tokens_, 0);
+  std::vector<int64_t> positions(max_num_tokens_, 0);
+  std::vector<int64_t> token_slots(max_num_tokens_, -1);
+  std::vector<int64_t> tables(max_num_tokens_ * max_blocks_, 0);
+  // A padded token only sees the first position, so that its softmax stays finite.
+  std::vector<float> mask(max_num_tokens_ * max_len, -std::numeric_limits<float>::infinity());
+  for (int64_t t = 0; t < max_num_tokens_; ++t) {
+    mask[t * max_len] = 0;
+  }
+  std::vector<int64_t> last_tokens;
+  int64_t t = 0;
+  for (size_t i = 0; i < running_.size(); ++i) {
+    const auto& seq = running_[i];
+    int64_t max_blocks;
+    auto table = kv_cache_.BlockTables({seq->id}, &max_blocks);
+    for (int64_t j = 0; j < static_cast<int64_t>(slots[i].size()); ++j, ++t) {
+      int64_t pos = seq->num_cached + j;
+      tokens[t] = seq->tokens[pos];
+      positions[t] = pos;
+      token_slots[t] = slots[i][j];
+      std::copy(table.begin(), table.end(), tables.begin() + t * max_blocks_);
+      std::fill(mask.begin() + t * max_len, mask.begin() + t * max_len + pos + 1, 0.0f);
+    }
+    last_tokens.push_back(std::max<int64_t>(t - 1, 0));
+  }
+
+  DType int64(DTypeCode::kInt(), 64);
+  std::vector<Value> inputs{
+      HostToDevice(tokens, int64, {max_num_tokens_}, device_),
+      HostToDevice(positions, int64, {max_num_tokens_}, device_),
+      HostToDevice(token_slots, int64, {max_num_tokens_}, device_),
+      HostToDevice(tables, int64, {max_num_tokens_, max_blocks_}, device_),
+      HostToDevice(mask, DType(DTypeCode::kFloat(), 32), {max_num_tokens_, max_len}, device_)};
+  for (const auto& cache : kv_cache_.Caches()) {
+    inputs.push_back(cache);
+  }
+  inputs.insert(inputs.end(), params_.begin(), params_.end());
+  std::vector<int64_t> next_tokens;
+  try {
+    auto ctx = vm_->PrepareVMContext(func_name_, inputs);
+    Value output = vm_->Run(ctx);
+    vm_->ReleaseVMContext(ctx);
+    auto logits = Downcast<TensorValue>(CopyTo(output, Device(DevType::kCPU(), 0)));
+    const DLTensor* dl_logits = logits;
+    CHECK_EQ(dl_logits->ndim, 2) << "The logits should be in shape [max_num_tokens, vocab_size]";
+    CHECK_EQ(dl_logits->shape[0], max_num_tokens_);
+    CHECK(DType(dl_logits->dtype) == DType(DTypeCode::kFloat(), 32))
+        << "The logits should be float32";
+    int64_t vocab_size = dl_logits->shape[1];
+    const float* data = static_cast<const float*>(dl_logits->data) + dl_logits->byte_offset / 4;
+    for (int64_t row : last_tokens) {
+      const float* begin = data + row * vocab_size;
+      next_tokens.push_back(std::max_element(begin, begin + vocab_size) - begin);
+    }
+  } catch (...) {
+    for (const auto& seq : running_) {
+      kv_cache_.Free(seq->id);
+      seq->promise.set_exception(std::current_exception());
+    }
+    running_.clear();
+    return;
+  }
+
+  std::vector<std::shared_ptr<Sequence>> running;
+  for (size_t i = 0; i < running_.size(); ++i) {
+    const auto& seq = running_[i];
+    seq->num_cached += slots[i].size();
+    if (seq->num_cached < static_cast<int64_t>(seq->tokens.size())) {
+      // Only a chunk of the sequence is computed in this step.
+      running.push_back(seq);
+      continue;
+    }
+    seq->tokens.push_back(next_tokens[i]);
+    int64_t num_new_tokens = seq->tokens.size() - seq->num_prompt_tokens;
+    if (next_tokens[i] == eos_token_id_ || num_new_tokens >= seq->max_new_tokens ||
+        static_cast<int64_t>(seq->tokens.size()) >= max_seq_len_) {
+      kv_cache_.Free(seq->id);
+      seq->promise.set_value(
+          std::vector<int64_t>(seq->tokens.begin() + seq->num_prompt_tokens, seq->tokens.end()));
+    } else {
+      running.push_back(seq);
+    }
+  }
+  running_ = std::move(running);
+}
+
+void GenerationScheduler::WorkerLoop() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [this]() { return stop_ || !waiting_.empty() || !running_.empty(); });
+      if (stop_) {
+        return;
+      }
+    }
+    Admit();
+    Step();
+  }
+}
+
+PackedFunc GenerationScheduler::GetFunction(const std::string& name,
+                                            const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "generate") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      Array<Integer> prompt = args[0];
+      int64_t max_new_tokens = args[1];
+      std::vector<int64_t> tokens;
+      for (const auto& token : prompt) {
+        tokens.push_back(token->value);
+      }
+      Array<Integer> ret;
+      for (int64_t token : Generate(std::move(tokens), max_new_tokens)) {
+        ret.push_back(Integer(token));
+      }
+      *rv = ret;
+    });
+  } else {
+    LOG(FATAL) << "Unknown packed function: " << name;
+    return PackedFunc([sptr_to_self, name](registry::TVMArgs args, registry::TVMRetValue* rv) {});
+  }
+}
+
+RAF_REGISTER_GLOBAL("raf.vm.GenerationScheduler")
+    .set_body([](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
+      tvm::runtime::Module vm = args[0];
+      std::string func_name = args[1];
+      Device device = args[2];
+      std::string dtype = args[3];
+      int num_layers = args[4];
+      int64_t num_blocks = args[5];
+      int64_t block_size = args[6];
+      Array<Integer> token_shape = args[7];
+      int64_t max_num_tokens = args[8];
+      int64_t max_num_seqs = args[9];
+      int64_t max_seq_len = args[10];
+      int64_t eos_token_id = args[11];
+      Array<Value> params = args[12];
+      std::vector<int64_t> shape;
+      for (const auto& i : token_shape) {
+        shape.push_back(i->value);
+      }
+      auto scheduler = make_object<GenerationScheduler>(
+          vm, func_name, device, String2DLDataType(dtype), num_layers, num_blocks, block_size,
+          std::move(shape), max_num_tokens, max_num_seqs, max_seq_len, eos_token_id,
+          std::vector<Value>(params.begin(), params.end()));
+      *rv = tvm::runtime::Module(scheduler);
+    });
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,135 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/generation_scheduler.h
+ * \brief The continuous batching scheduler of autoregressive generation on top of the RAF virtual
+ * machine.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "raf/kv_cache.h"
+#include "raf/vm/vm.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+/*!
+ * \brief The scheduler that generates the tokens of the concurrent requests with iteration-level
+ * batching: the sequences are admitted and retired at every decoding step instead of per batch,
+ * so a finished sequence frees its slot for a waiting one right away.
+ *
+ * Each step packs the new tokens of the running sequences, i.e., the whole prompt of a newly
+ * admitted sequence and the last generated token of the others, into one execution of the step
+ * function:
+ *
+ *   step(tokens, positions, slots, block_tables, mask, k_cache_0, v_cache_0, ..., params...)
+ *
+ * where tokens, positions and slots are in shape [max_num_tokens], block_tables is the block table
+ * of the sequence of each token in shape [max_num_tokens, max_blocks], and mask is the additive
+ * attention mask over the gathered cache in shape [max_num_tokens, max_blocks * block_size], which
+ * makes the ragged attention of each token only see the earlier tokens of its sequence. The step
+ * is expected to append the keys and values of the tokens to the caches by their slots, gather
+ * the caches by the block tables, and return the logits of the tokens in shape
+ * [max_num_tokens, vocab_size]. The unused tokens are padded with negative slots. The next token
+ * of a sequence is the argmax of the logits of its last token.
+ *
+ * The inputs are padded to fixed shapes, so the step runs with the same shapes every iteration.
+ * A sequence is admitted when the token budget of the step and the free cache blocks allow. When
+ * the blocks run out, the latest admitted sequences are preempted and requeued, and their
+ * tokens are recomputed once they are admitted again. A sequence with more new tokens than the
+ * budget is computed in chunks over the steps.
+ */
+class GenerationScheduler : public tvm::runtime::ModuleNode {
+ public:
+  GenerationScheduler(tvm::runtime::Module vm, std::string func_name, const Device& device,
+                      DType dtype, int num_layers, int64_t num_blocks, int64_t block_size,
+                      std::vector<int64_t> token_shape, int64_t max_num_tokens,
+                      int64_t max_num_seqs, int64_t max_seq_len, int64_t eos_token_id,
+                      std::vector<Value> params);
+
+  ~GenerationScheduler();
+
+  const char* type_key() const final {
+    return "GenerationScheduler";
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+
+  /*!
+   * \brief Submit a prompt and wait for the generated tokens. This function is thread-safe.
+   * \param prompt The tokens of the prompt.
+   * \param max_new_tokens The maximal number of tokens to generate.
+   * \return The generated tokens, ending with the EOS token if it is generated.
+   */
+  std::vector<int64_t> Generate(std::vector<int64_t> prompt, int64_t max_new_tokens);
+
+ private:
+  /*! \brief A request being generated. */
+  struct Sequence {
+    int64_t id;
+    /*! \brief The prompt followed by the generated tokens. */
+    std::vector<int64_t> tokens;
+    int64_t num_prompt_tokens;
+    /*! \brief The number of tokens whose keys and values are in the caches. */
+    int64_t num_cached = 0;
+    int64_t max_new_tokens;
+    std::promise<std::vector<int64_t>> promise;
+  };
+
+  /*! \brief The loop of the worker thread that runs the steps. */
+  void WorkerLoop();
+  /*! \brief Admit the waiting sequences to run within the token budget and the free blocks. */
+  void Admit();
+  /*! \brief Reserve the slots of the new tokens, preempting the latest sequences if needed. */
+  std::vector<std::vector<int64_t>> ReserveSlots();
+  /*! \brief Run a step of the running sequences, and retire the finished ones. */
+  void Step();
+  /*! \brief The number of blocks to take for n more tokens of a sequence. */
+  int64_t BlocksToAppend(const Sequence& seq, int64_t n) const;
+  /*! \brief Return the blocks of a sequence and put it back to the front of the queue. */
+  void Preempt(std::shared_ptr<Sequence> seq);
+
+  tvm::runtime::Module vm_module_;
+  VirtualMachine* vm_;
+  std::string func_name_;
+  Device device_;
+  /*! \brief The paged caches, which are only accessed by the worker. */
+  kv_cache::KVCacheManager kv_cache_;
+  int64_t block_size_;
+  /*! \brief The token budget of a step. */
+  int64_t max_num_tokens_;
+  int64_t max_num_seqs_;
+  int64_t max_seq_len_;
+  /*! \brief The number of blocks of the longest sequence. */
+  int64_t max_blocks_;
+  /*! \brief The token that ends a sequence, or -1 for none. */
+  int64_t eos_token_id_;
+  /*! \brief The trailing arguments of the step, e.g., the model parameters. */
+  std::vector<Value> params_;
+  /*! \brief The running sequences in the admission order, which are only accessed by the worker. */
+  std::vector<std::shared_ptr<Sequence>> running_;
+  /*! \brief The waiting sequences. */
+  std::deque<std::shared_ptr<Sequence>> waiting_;
+  int64_t next_seq_id_ = 0;
+  bool stop_ = false;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::thread worker_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
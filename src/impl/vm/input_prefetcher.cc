@@ -0,0 +1,190 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/input_prefetcher.cc
+ * \brief The implementation of the input prefetcher.
+ */
+#include <cstring>
+#include <utility>
+
+#include "raf/device_api.h"
+#include "raf/event_pool.h"
+#include "raf/registry.h"
+#include "./input_prefetcher.h"
+#include "../../common/shape_utils.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using common::shape_utils::BytesCompactTensor;
+using common::shape_utils::IsCompact;
+using device_api::DeviceAPI;
+
+InputPrefetcher::InputPrefetcher(const Device& device, int depth)
+    : device_(device), host_(DevType::kCUDAHost(), device.device_id()), depth_(depth) {
+  CHECK_GE(depth_, 1) << "The prefetch depth must be positive";
+  if (device_.device_type() != DevType::kCUDA()) {
+    // The host inputs are used by the VM as is.
+    return;
+  }
+  auto device_api = DeviceAPI::Get(device_.device_type());
+  device_api->SetDevice(device_.device_id());
+  slots_.resize(depth_);
+  for (auto& slot : slots_) {
+    slot.event = device_api->CreateEvent(device_, event_pool::kEventDisableTiming);
+  }
+  stream_ = Stream::Get(device_, stream_pool::kMemCpyCpuToCuda, 0);
+  worker_ = std::thread([this]() { WorkerLoop(); });
+}
+
+InputPrefetcher::~InputPrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  if (!slots_.empty()) {
+    auto device_api = DeviceAPI::Get(device_.device_type());
+    device_api->WaitStream(stream_->data());
+    for (auto& slot : slots_) {
+      device_api->FreeEvent(device_, slot.event);
+    }
+  }
+}
+
+void InputPrefetcher::Push(std::vector<Value> inputs) {
+  auto batch = std::make_shared<Batch>();
+  batch->values = std::move(inputs);
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this]() { return static_cast<int>(batches_.size()) < depth_; });
+  batch->slot = static_cast<int>(num_pushed_++ % depth_);
+  batch->issued = slots_.empty();
+  batches_.push_back(batch);
+  lock.unlock();
+  cv_.notify_all();
+}
+
+std::vector<Value> InputPrefetcher::Pop() {
+  std::shared_ptr<Batch> batch;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    CHECK(!batches_.empty()) << "No batch has been pushed to the prefetcher";
+    batch = batches_.front();
+    cv_.wait(lock, [&batch]() { return batch->issued; });
+  }
+  if (batch->error == nullptr && !slots_.empty()) {
+    // The batch stays in the queue until its copies finish, so the next batch of the same slot
+    // cannot be pushed and record the event again in the meantime.
+    DeviceAPI::Get(device_.device_type())->WaitEvent(slots_[batch->slot].event);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    batches_.pop_front();
+  }
+  cv_.notify_all();
+  if (batch->error != nullptr) {
+    std::rethrow_exception(batch->error);
+  }
+  return std::move(batch->values);
+}
+
+void InputPrefetcher::WorkerLoop() {
+  DeviceAPI::Get(device_.device_type())->SetDevice(device_.device_id());
+  while (true) {
+    std::shared_ptr<Batch> batch;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [this, &batch]() {
+        for (const auto& b : batches_) {
+          if (!b->issued) {
+            batch = b;
+            return true;
+          }
+        }
+        return stop_;
+      });
+      if (stop_) {
+        return;
+      }
+    }
+    try {
+      Upload(batch.get());
+    } catch (...) {
+      batch->error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      batch->issued = true;
+    }
+    cv_.notify_all();
+  }
+}
+
+void InputPrefetcher::Upload(Batch* batch) {
+  auto device_api = DeviceAPI::Get(device_.device_type());
+  Slot& slot = slots_[batch->slot];
+  // Make sure the copies from the staging buffers of the slot have finished.
+  device_api->WaitEvent(slot.event);
+  slot.buffers.resize(batch->values.size());
+  slot.sizes.resize(batch->values.size(), 0);
+  for (size_t i = 0; i < batch->values.size(); ++i) {
+    const Value& value = batch->values[i];
+    if (!value.defined() || !value->IsInstance<TensorValueObj>()) {
+      continue;
+    }
+    DLTensor* src = value;
+    if (src->device.device_type != kDLCPU) {
+      continue;
+    }
+    CHECK(IsCompact(*src)) << "Only compact host tensors can be prefetched";
+    int64_t nbytes = BytesCompactTensor(*src);
+    if (slot.buffers[i] == nullptr || slot.sizes[i] < nbytes) {
+      slot.buffers[i] = Memory::Alloc(host_, nbytes);
+      slot.sizes[i] = nbytes;
+    }
+    std::memcpy(slot.buffers[i]->data, static_cast<char*>(src->data) + src->byte_offset, nbytes);
+
+    std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+    auto staged = TensorValue::Assemble(host_, src->dtype, shape, {}, slot.buffers[i]->data);
+    auto mem = Memory::Alloc(device_, nbytes);
+    auto dst = TensorValue::Assemble(device_, src->dtype, shape, {}, mem->data, mem);
+    device_api->CopyDataFromTo(staged, dst, stream_->data());
+    batch->values[i] = dst;
+  }
+  device_api->EventRecordOnStream(slot.event, stream_->data());
+}
+
+PackedFunc InputPrefetcher::GetFunction(const std::string& name,
+                                        const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "push") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::vector<Value> inputs(args.size());
+      for (int i = 0; i < args.size(); ++i) {
+        inputs[i] = args[i];
+      }
+      Push(std::move(inputs));
+    });
+  } else if (name == "pop") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      *rv = Array<Value>(Pop());
+    });
+  } else {
+    LOG(FATAL) << "Unknown packed function: " << name;
+    return PackedFunc([sptr_to_self, name](registry::TVMArgs args, registry::TVMRetValue* rv) {});
+  }
+}
+
+RAF_REGISTER_GLOBAL("raf.vm.InputPrefetcher").set_body_typed([](Device device, int depth) {
+  return tvm::runtime::Module(make_object<InputPrefetcher>(device, depth));
+});
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
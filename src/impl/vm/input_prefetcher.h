@@ -0,0 +1,123 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/input_prefetcher.h
+ * \brief The prefetcher that uploads the inputs of the next executions to the device.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "raf/device.h"
+#include "raf/memory_pool.h"
+#include "raf/stream_pool.h"
+#include "raf/value.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using memory_pool::Memory;
+using stream_pool::Stream;
+using namespace raf::value;
+
+/*!
+ * \brief The prefetcher that copies the host inputs of the next executions to the device in the
+ * background, so that the copies of batch N + 1 overlap with the computation of batch N.
+ *
+ * The host tensors of a pushed batch are staged into a ring of pinned host buffers, one slot per
+ * batch in flight, and copied to newly allocated device buffers on the kMemCpyCpuToCuda stream.
+ * The staging buffers of a slot are reused once the copies from it are finished. A popped batch
+ * holds device-resident tensors that are ready to be passed to the VM. The values that are not
+ * host tensors are passed through as is.
+ */
+class InputPrefetcher : public tvm::runtime::ModuleNode {
+ public:
+  InputPrefetcher(const Device& device, int depth);
+
+  ~InputPrefetcher();
+
+  const char* type_key() const final {
+    return "InputPrefetcher";
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+
+  /*!
+   * \brief Submit a batch to upload. It blocks if there are already depth batches in flight.
+   * \param inputs The inputs of the batch.
+   */
+  void Push(std::vector<Value> inputs);
+
+  /*!
+   * \brief Take the oldest batch, waiting for its copies to finish. There should be only one
+   * thread taking the batches.
+   * \return The device-resident inputs of the batch.
+   */
+  std::vector<Value> Pop();
+
+ private:
+  /*! \brief A batch in the pipeline. */
+  struct Batch {
+    /*! \brief The inputs, which are replaced by the device tensors once uploaded. */
+    std::vector<Value> values;
+    /*! \brief The staging slot of the batch. */
+    int slot;
+    /*! \brief Whether the copies have been issued. */
+    bool issued = false;
+    /*! \brief The error while uploading the batch. */
+    std::exception_ptr error;
+  };
+
+  /*! \brief The pinned staging buffers of a batch in flight. */
+  struct Slot {
+    /*! \brief The pinned buffer of each input. */
+    std::vector<std::shared_ptr<Memory>> buffers;
+    /*! \brief The size in bytes of each pinned buffer. */
+    std::vector<int64_t> sizes;
+    /*! \brief The event recorded after the copies from the buffers. */
+    void* event = nullptr;
+  };
+
+  /*! \brief The loop of the worker thread that stages and uploads the batches. */
+  void WorkerLoop();
+  /*! \brief Stage a batch into its slot and issue the copies to the device. */
+  void Upload(Batch* batch);
+
+  /*! \brief The target device. */
+  Device device_;
+  /*! \brief The pinned host device to stage the inputs. */
+  Device host_;
+  /*! \brief The max number of batches in flight, i.e., the number of slots. */
+  int depth_;
+  /*! \brief The ring of staging slots. */
+  std::vector<Slot> slots_;
+  /*! \brief The stream to copy the inputs. */
+  std::shared_ptr<Stream> stream_;
+  /*! \brief The batches in flight in the order they are pushed. */
+  std::deque<std::shared_ptr<Batch>> batches_;
+  /*! \brief The number of pushed batches, which determines the slot of the next batch. */
+  int64_t num_pushed_ = 0;
+  /*! \brief Whether the worker has been asked to stop. */
+  bool stop_ = false;
+  /*! \brief The mutex for the batches. */
+  std::mutex mu_;
+  /*! \brief The condition variable to notify the worker and the consumer. */
+  std::condition_variable cv_;
+  /*! \brief The worker thread. */
+  std::thread worker_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,107 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/output_stager.cc
+ * \brief The implementation of the output stager.
+ */
+#include "raf/device_api.h"
+#include "./output_stager.h"
+#include "../../common/shape_utils.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using common::shape_utils::BytesCompactTensor;
+using common::shape_utils::IsCompact;
+using device_api::DeviceAPI;
+
+OutputStager::OutputStager(const Device& device, int depth) : device_(device) {
+  CHECK_GE(depth, 1) << "The staging depth must be positive";
+  CHECK(device_.device_type() == DevType::kCUDA()) << "Only the CUDA outputs are staged";
+  auto device_api = DeviceAPI::Get(device_.device_type());
+  device_api->SetDevice(device_.device_id());
+  slots_.resize(depth);
+  for (auto& slot : slots_) {
+    slot.event = device_api->CreateEvent(device_, event_pool::kEventDisableTiming);
+  }
+  ready_event_ = device_api->CreateEvent(device_, event_pool::kEventDisableTiming);
+  stream_ = Stream::Get(device_, stream_pool::kMemCpyCudaToCpu, 0);
+}
+
+OutputStager::~OutputStager() {
+  auto device_api = DeviceAPI::Get(device_.device_type());
+  device_api->WaitStream(stream_->data());
+  for (auto& slot : slots_) {
+    device_api->FreeEvent(device_, slot.event);
+  }
+  device_api->FreeEvent(device_, ready_event_);
+}
+
+std::pair<Value, std::shared_ptr<event_pool::Event>> OutputStager::Stage(const Value& value,
+                                                                         void* stream) {
+  auto device_api = DeviceAPI::Get(device_.device_type());
+  std::lock_guard<std::mutex> lock(mu_);
+  Slot& slot = slots_[num_staged_++ % slots_.size()];
+  // The device outputs of the previous execution of the slot can be released once the copies from
+  // them are finished.
+  device_api->WaitEvent(slot.event);
+  slot.sources.clear();
+  // Without a given stream, the event is recorded on the legacy default stream, which is ordered
+  // after the work issued to any blocking stream before.
+  device_api->EventRecordOnStream(ready_event_, stream);
+  device_api->StreamWaitEvent(stream_->data(), ready_event_);
+  size_t index = 0;
+  Value ret = StageValue(value, &slot, &index);
+  device_api->EventRecordOnStream(slot.event, stream_->data());
+  auto event = event_pool::EventPool::Get(device_)->GetEvent(event_pool::kEventDisableTiming);
+  device_api->EventRecordOnStream(event->data(), stream_->data());
+  return {ret, event};
+}
+
+Value OutputStager::StageValue(const Value& value, Slot* slot, size_t* index) {
+  if (!value.defined()) {
+    return value;
+  }
+  if (const auto* tup = value.as<TupleValueObj>()) {
+    std::vector<Value> fields;
+    fields.reserve(tup->fields.size());
+    for (const auto& field : tup->fields) {
+      fields.push_back(StageValue(field, slot, index));
+    }
+    return TupleValue::make(fields);
+  }
+  if (!value->IsInstance<TensorValueObj>()) {
+    return value;
+  }
+  DLTensor* src = value;
+  if (src->device.device_type != kDLCUDA || !IsCompact(*src)) {
+    return value;
+  }
+  int64_t nbytes = BytesCompactTensor(*src);
+  if (slot->buffers.size() <= *index) {
+    slot->buffers.resize(*index + 1);
+    slot->sizes.resize(*index + 1, 0);
+  }
+  auto& buffer = slot->buffers[*index];
+  int64_t& size = slot->sizes[*index];
+  ++*index;
+  // The buffer is still held by the caller if it is referenced by a host tensor.
+  if (buffer == nullptr || buffer.use_count() > 1 || size < nbytes) {
+    buffer = Memory::AllocHost(device_, nbytes);
+    size = nbytes;
+  }
+  std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+  auto dst = TensorValue::Assemble(Device(DevType::kCPU(), 0), src->dtype, shape, {}, buffer->data,
+                                   buffer);
+  DeviceAPI::Get(device_.device_type())->CopyDataFromTo(src, dst, stream_->data());
+  slot->sources.push_back(value);
+  return dst;
+}
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,92 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/output_stager.h
+ * \brief The stager that copies the outputs of the VM executions to pinned host buffers.
+ */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "raf/device.h"
+#include "raf/event_pool.h"
+#include "raf/memory_pool.h"
+#include "raf/stream_pool.h"
+#include "raf/value.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using memory_pool::Memory;
+using stream_pool::Stream;
+using namespace raf::value;
+
+/*!
+ * \brief The stager that copies the device outputs of the executions to the host on the
+ * kMemCpyCudaToCpu stream right after their kernels are issued, so that the copies of execution N
+ * overlap with the computation of execution N + 1, and run at full bandwidth from pinned memory.
+ *
+ * The outputs of an execution are staged into a slot of a ring of pinned host buffers, one slot
+ * per execution in flight. A buffer is reused by a later execution of the same slot only if the
+ * caller has released the host tensor on it, otherwise a new buffer is taken. A slot also keeps
+ * the device outputs alive until the copies from them are finished. The values that are not
+ * compact device tensors are passed through as is.
+ */
+class OutputStager {
+ public:
+  /*!
+   * \param device The device of the executions.
+   * \param depth The number of slots.
+   */
+  OutputStager(const Device& device, int depth);
+
+  ~OutputStager();
+
+  /*!
+   * \brief Issue the copies of the outputs to the host after the work issued to the stream.
+   * \param value The outputs of an execution.
+   * \param stream The stream computing the outputs. Null means all the work issued before.
+   * \return The host outputs, and the event recorded after the copies.
+   */
+  std::pair<Value, std::shared_ptr<event_pool::Event>> Stage(const Value& value, void* stream);
+
+ private:
+  /*! \brief The pinned buffers of an execution in flight. */
+  struct Slot {
+    /*! \brief The pinned buffer of each output tensor. */
+    std::vector<std::shared_ptr<Memory>> buffers;
+    /*! \brief The size in bytes of each pinned buffer. */
+    std::vector<int64_t> sizes;
+    /*! \brief The device outputs, which are kept until the copies from them are finished. */
+    std::vector<Value> sources;
+    /*! \brief The event recorded after the copies of the slot. */
+    void* event = nullptr;
+  };
+
+  /*! \brief Stage the tensors of a value into the slot recursively. */
+  Value StageValue(const Value& value, Slot* slot, size_t* index);
+
+  /*! \brief The device of the executions. */
+  Device device_;
+  /*! \brief The ring of staging slots. */
+  std::vector<Slot> slots_;
+  /*! \brief The number of staged executions, which determines the slot of the next one. */
+  int64_t num_staged_ = 0;
+  /*! \brief The event to order the copies after the computation. */
+  void* ready_event_ = nullptr;
+  /*! \brief The stream to copy the outputs. */
+  std::shared_ptr<Stream> stream_;
+  /*! \brief The mutex to stage the outputs, since the executions may run concurrently. */
+  std::mutex mu_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
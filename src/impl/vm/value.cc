@@ -8,6 +8,9 @@
  * \brief The implementation for vm values.
  */
 
+#include <chrono>
+#include "raf/device_api.h"
+#include "raf/registry.h"
 #include "raf/vm/value.h"
 
 namespace raf {
@@ -21,13 +24,54 @@ VMClosureValue VMClosureValue::make(size_t func_index, std::vector<Value> free_v
   return VMClosureValue(ptr);
 }
 
-StorageValue StorageValue::make(std::shared_ptr<memory_pool::Memory> buffer) {
+StorageValue StorageValue::make(std::shared_ptr<memory_pool::Memory> buffer, int64_t size) {
   auto node = make_object<StorageValueObj>();
   node->buffer = std::move(buffer);
+  node->size = size;
   return StorageValue(node);
 }
 
+FutureValue FutureValue::make(Value value, Device device,
+                              std::shared_ptr<event_pool::Event> event) {
+  auto node = make_object<FutureValueObj>();
+  node->value = std::move(value);
+  node->device = device;
+  node->event = std::move(event);
+  return FutureValue(node);
+}
+
+bool FutureValueObj::IsReady() const {
+  if (launched.valid() &&
+      launched.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return false;
+  }
+  if (event == nullptr) {
+    return true;
+  }
+  return device_api::DeviceAPI::Get(device.device_type())->QueryEvent(event->data());
+}
+
+Value FutureValueObj::Get() const {
+  if (launched.valid()) {
+    // Rethrow the error of the launch.
+    launched.get();
+  }
+  if (event != nullptr) {
+    device_api::DeviceAPI::Get(device.device_type())->WaitEvent(event->data());
+  }
+  return value;
+}
+
 RAF_REGISTER_OBJECT_REFLECT(VMClosureValueObj);
+RAF_REGISTER_OBJECT_NO_REFLECT(FutureValueObj);
+
+RAF_REGISTER_GLOBAL("raf.vm.FutureValueIsReady").set_body_typed([](FutureValue future) {
+  return future->IsReady();
+});
+
+RAF_REGISTER_GLOBAL("raf.vm.FutureValueGet").set_body_typed([](FutureValue future) {
+  return future->Get();
+});
 
 }  // namespace vm
 }  // namespace executor
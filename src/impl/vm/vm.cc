@@ -14,15 +14,19 @@
 #include <tvm/runtime/device_api.h>
 
 #include <algorithm>
+#include <cctype>
 #include <chrono>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
+#include <unordered_set>
 #include <vector>
 
+#include "raf/cache.h"
 #include "raf/communicator.h"
 #include "raf/memory_pool.h"
+#include "raf/alloc_trace.h"
 #include "raf/ir.h"
 #include "raf/op.h"
 #include "raf/op_utils.h"
@@ -34,16 +38,25 @@
 #include "raf/device_api.h"
 #include "raf/profiler.h"
 #include "raf/memory_profiler.h"
+#include "raf/metrics.h"
 #include "raf/stream_pool.h"
 #include "../../requests.h"
 #include "../../op/ty/utils.h"
+#include "../../common/numa_utils.h"
 #include "../../common/shape_utils.h"
+#include "./async_dispatcher.h"
+#include "./output_stager.h"
+#include "./cpu_lane_executor.h"
+#include "./dtr.h"
 
 #include "raf/device_api.h"
 #include "raf/registry.h"
 
 #include "../../profiler/cuda/cuda_profiler.h"
+#include "../../profiler/cupti/cupti_profiler.h"
+#include "../../profiler/nvtx/nvtx.h"
 #ifdef RAF_USE_CUDA
+#include "../../common/cuda_ipc.h"
 #include "../../common/cuda_utils.h"
 #include "../../op/dialect/cudnn/cudnn_utils.h"
 #include "../../op/dialect/cublas/cublas_utils.h"
@@ -73,30 +86,83 @@ inline std::shared_ptr<Event> GetEventById(const VMContext& ctx, Index device_id
   if (ctx->events[device_id][event_id] == nullptr) {
     Device device(DevType::kCUDA(), static_cast<int>(device_id));
     ctx->events[device_id][event_id] =
-        EventPool::Get(device)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+        EventPool::Get(device)->GetEvent(event_pool::kEventDisableTiming);
   }
   return ctx->events[device_id][event_id];
 }
 
+/*!
+ * \brief Get the stream of the given id. A non-negative priority switches the id to the stream of
+ * that priority, and -1 means using the stream of the id as is. Stream 0 is the default stream that
+ * has no priority.
+ */
 inline std::shared_ptr<Stream> GetStreamById(const VMContext& ctx, Index device_id,
-                                             Index stream_id) {
+                                             Index stream_id, Index priority = -1) {
   if (device_id >= ctx->streams.size()) {
     ctx->streams.resize(device_id + 1);
   }
   if (stream_id >= ctx->streams[device_id].size()) {
     ctx->streams[device_id].resize(stream_id + 1);
   }
-  if (ctx->streams[device_id][stream_id] == nullptr) {
-    if (stream_id == 0) {
-      ctx->streams[device_id][stream_id] = std::make_shared<Stream>(nullptr);
-    } else {
-      Device device(DevType::kCUDA(), static_cast<int>(device_id));
-      ctx->streams[device_id][stream_id] =
-          Stream::Get(device, kCudaCompute, static_cast<int>(stream_id));
+  auto& stream = ctx->streams[device_id][stream_id];
+  if (stream == nullptr && stream_id == 0) {
+    stream = std::make_shared<Stream>(nullptr);
+  } else if (stream_id != 0 &&
+             (stream == nullptr || (priority >= 0 && stream->priority() != priority))) {
+    Device device(DevType::kCUDA(), static_cast<int>(device_id));
+    stream = Stream::Get(device, kCudaCompute, static_cast<int>(stream_id),
+                         static_cast<int>(std::max<Index>(priority, kDefaultPriority)));
+  }
+  return stream;
+}
+
+#ifdef RAF_USE_CUDA
+/*!
+ * \brief Get the maximal number of CUDA graphs to be cached for a function or a static segment,
+ * which can be configured by the environment variable RAF_CUDA_GRAPH_CACHE_SIZE.
+ */
+inline size_t GetCudaGraphCacheSize() {
+  static size_t cache_size = []() {
+    int64_t size = 8;
+    if (const char* val = getenv("RAF_CUDA_GRAPH_CACHE_SIZE")) {
+      size = atol(val);
+    }
+    return static_cast<size_t>(std::max<int64_t>(size, 1));
+  }();
+  return cache_size;
+}
+
+/*!
+ * \brief Instantiate a captured CUDA graph. If a graph executable to be discarded is given, try to
+ * update it with the new graph first, which is much cheaper than instantiation when only the
+ * kernel parameters (e.g., pointers and shapes) are changed.
+ * \param graph The captured graph.
+ * \param reusable The graph executable to be updated. It is reset to null if the update succeeds.
+ * \return The graph executable.
+ */
+inline cudaGraphExec_t InstantiateCudaGraph(cudaGraph_t graph, cudaGraphExec_t* reusable) {
+  if (reusable != nullptr && *reusable != nullptr) {
+#if CUDA_VERSION >= 12000
+    cudaGraphExecUpdateResultInfo result_info;
+    cudaError_t status = cudaGraphExecUpdate(*reusable, graph, &result_info);
+#else
+    cudaGraphNode_t error_node;
+    cudaGraphExecUpdateResult result;
+    cudaError_t status = cudaGraphExecUpdate(*reusable, graph, &error_node, &result);
+#endif
+    if (status == cudaSuccess) {
+      cudaGraphExec_t exec = *reusable;
+      *reusable = nullptr;
+      return exec;
     }
+    // The topology is changed, so clear the error and instantiate the graph instead.
+    cudaGetLastError();
   }
-  return ctx->streams[device_id][stream_id];
+  cudaGraphExec_t exec;
+  CUDA_CALL(cudaGraphInstantiate(&exec, graph, NULL, NULL, 0));
+  return exec;
 }
+#endif
 
 const char* GetStreamName(Index stream_id) {
   static std::vector<std::string> names = {"Default Stream"};
@@ -106,6 +172,18 @@ const char* GetStreamName(Index stream_id) {
   return names[stream_id].c_str();
 }
 
+/*! \brief Append the dtype, rank and dims of a tensor to an OpEnv signature. */
+inline void TensorSignature(OpEnvSignature* sig, const TensorValueObj* tensor) {
+  const DLTensor* t = tensor->tensor.operator->();
+  int64_t header = (static_cast<int64_t>(t->dtype.code) << 40) |
+                   (static_cast<int64_t>(t->dtype.bits) << 32) |
+                   (static_cast<int64_t>(t->dtype.lanes) << 16) | t->ndim;
+  sig->Push(header);
+  for (int i = 0; i < t->ndim; ++i) {
+    sig->Push(t->shape[i]);
+  }
+}
+
 void TensorRepr(std::ostringstream& os, const TensorValueObj* tensor) {
   const DLTensor* t = tensor->tensor.operator->();
   os << "T<";
@@ -139,6 +217,239 @@ void TensorRepr(std::ostringstream& os, const TensorValueObj* tensor) {
   }
   os << ">";
 }
+
+/*!
+ * \brief Materialize a constant on the given device. The tensors of a memory-mapped executable
+ * stay in the mapped file until their first use. The ones that are not aligned for the kernels
+ * are copied as well, even if they are already on the device.
+ * \param constant The constant in the executable.
+ * \param dev The device to materialize on.
+ * \return The materialized constant.
+ */
+Value MaterializeConstant(const Value& constant, const Device& dev) {
+  if (const auto* tensor = constant.as<TensorValueObj>()) {
+    const DLTensor* dlt = tensor->tensor.operator->();
+    if (dlt->device.device_type == dev.device_type() &&
+        reinterpret_cast<uintptr_t>(dlt->data) % kDefaultMemoryAlignment != 0) {
+      std::vector<int64_t> shape(dlt->shape, dlt->shape + dlt->ndim);
+      auto mem = memory_pool::Memory::Alloc(dev, common::shape_utils::BytesCompactTensor(*dlt));
+      auto ret = TensorValue::Assemble(dev, dlt->dtype, shape, {}, mem->data, mem);
+      tensor->tensor.CopyTo(ret->tensor);
+      return ret;
+    }
+  } else if (const auto* tuple = constant.as<TupleValueObj>()) {
+    Array<Value> fields;
+    for (const auto& field : tuple->fields) {
+      fields.push_back(MaterializeConstant(field, dev));
+    }
+    return TupleValue::make(fields);
+  }
+  return CopyTo(constant, dev);
+}
+
+/*!
+ * \brief Replicate a CPU constant to the memory of a NUMA node.
+ * \param constant The materialized constant.
+ * \param node The NUMA node.
+ * \return The replica.
+ */
+Value ReplicateConstant(const Value& constant, int node) {
+  if (const auto* tensor = constant.as<TensorValueObj>()) {
+    const DLTensor* dlt = tensor->tensor.operator->();
+    Device dev = dlt->device;
+    int64_t nbytes = common::shape_utils::BytesCompactTensor(*dlt);
+    if (dev.device_type() != DevType::kCPU() || nbytes == 0) {
+      return constant;
+    }
+    std::vector<int64_t> shape(dlt->shape, dlt->shape + dlt->ndim);
+    auto mem = memory_pool::Memory::Alloc(dev, nbytes, 4096);
+    common::numa_utils::BindMemory(mem->data, nbytes, node);
+    auto ret = TensorValue::Assemble(dev, dlt->dtype, shape, {}, mem->data, mem);
+    tensor->tensor.CopyTo(ret->tensor);
+    return ret;
+  } else if (const auto* tuple = constant.as<TupleValueObj>()) {
+    Array<Value> fields;
+    for (const auto& field : tuple->fields) {
+      fields.push_back(ReplicateConstant(field, node));
+    }
+    return TupleValue::make(fields);
+  }
+  return constant;
+}
+
+const char* OpcodeName(Opcode op) {
+  switch (op) {
+    case Opcode::Move:
+      return "Move";
+    case Opcode::Ret:
+      return "Ret";
+    case Opcode::Fatal:
+      return "Fatal";
+    case Opcode::LoadConst:
+      return "LoadConst";
+    case Opcode::LoadConsti:
+      return "LoadConsti";
+    case Opcode::GetField:
+      return "GetField";
+    case Opcode::If:
+      return "If";
+    case Opcode::Goto:
+      return "Goto";
+    case Opcode::AllocStorage:
+      return "AllocStorage";
+    case Opcode::AllocTensor:
+      return "AllocTensor";
+    case Opcode::AllocTensorReg:
+      return "AllocTensorReg";
+    case Opcode::AllocTuple:
+      return "AllocTuple";
+    case Opcode::AllocClosure:
+      return "AllocClosure";
+    case Opcode::SetShape:
+      return "SetShape";
+    case Opcode::Free:
+      return "Free";
+    case Opcode::KillRegister:
+      return "KillRegister";
+    case Opcode::InvokeFunc:
+      return "InvokeFunc";
+    case Opcode::InvokeClosure:
+      return "InvokeClosure";
+    case Opcode::InvokePacked:
+      return "InvokePacked";
+    case Opcode::InvokeJit:
+      return "InvokeJit";
+    case Opcode::InferType:
+      return "InferType";
+    case Opcode::CudaSetStream:
+      return "CudaSetStream";
+    case Opcode::CudaAddEvent:
+      return "CudaAddEvent";
+    case Opcode::CudaWaitEvent:
+      return "CudaWaitEvent";
+    case Opcode::CudaStreamBarrier:
+      return "CudaStreamBarrier";
+  }
+  return "Unknown";
+}
+
+/*! \brief Accumulate the elapsed host time of a scope to a counter, unless it is nullptr. */
+class ScopedCounterTimer {
+ public:
+  explicit ScopedCounterTimer(uint64_t* counter) : counter_(counter) {
+    if (counter_ != nullptr) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ScopedCounterTimer() {
+    if (counter_ != nullptr) {
+      *counter_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start_)
+                       .count();
+    }
+  }
+
+ private:
+  uint64_t* counter_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/*!
+ * \brief Append the signature of an argument of InferType to a key, which is what the type
+ * inference reads from the argument: the dtype and shape of a tensor, and the value of a scalar. A
+ * small 1-D int32 tensor on CPU may be a shape (e.g., from shape_as_tensor), so its content is
+ * included too.
+ * \return Whether the argument has a signature. Otherwise, the inference cannot be memoized.
+ */
+bool InferTypeArgSignature(HashKey* key, const Value& value) {
+  constexpr int64_t kMaxShapeTensorSize = 16;
+  if (const auto* tensor = value.as<TensorValueObj>()) {
+    const DLTensor* t = tensor->tensor.operator->();
+    *key << *t;
+    if (t->ndim == 1 && t->shape[0] <= kMaxShapeTensorSize && t->dtype.code == kDLInt &&
+        t->dtype.bits == 32 && t->device.device_type == kDLCPU) {
+      const int32_t* data = static_cast<const int32_t*>(t->data);
+      for (int64_t i = 0; i < t->shape[0]; ++i) {
+        *key << data[i];
+      }
+    }
+  } else if (const auto* scalar = value.as<IntValueObj>()) {
+    *key << scalar->value;
+  } else if (const auto* scalar = value.as<FloatValueObj>()) {
+    *key << scalar->value;
+  } else if (const auto* scalar = value.as<BoolValueObj>()) {
+    *key << scalar->value;
+  } else if (const auto* str = value.as<StringValueObj>()) {
+    *key << str->value;
+  } else if (const auto* tup = value.as<TupleValueObj>()) {
+    *key << static_cast<int64_t>(tup->fields.size());
+    for (const auto& field : tup->fields) {
+      if (!InferTypeArgSignature(key, field)) {
+        return false;
+      }
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/*!
+ * \brief Find the first shape bucket that matches the shapes of the inputs.
+ * \param buckets The shape buckets of the function.
+ * \param inputs The inputs of the function.
+ * \param func_index The index of the general version of the function.
+ * \return The index of the specialized function, or func_index if no bucket matches.
+ */
+Index MatchShapeBucket(const std::vector<ShapeBucket>& buckets, const std::vector<Value>& inputs,
+                       Index func_index) {
+  for (const auto& bucket : buckets) {
+    bool match = true;
+    for (size_t i = 0; match && i < bucket.param_indices.size(); ++i) {
+      const auto* tensor = inputs[bucket.param_indices[i]].as<TensorValueObj>();
+      const auto& shape = bucket.shapes[i];
+      match = tensor != nullptr && tensor->tensor->ndim == static_cast<int>(shape.size()) &&
+              std::equal(shape.begin(), shape.end(), tensor->tensor->shape);
+    }
+    if (match) {
+      return bucket.func_index;
+    }
+  }
+  return func_index;
+}
+
+/*!
+ * \brief Record the estimated work of an InvokeJit instruction to the profiler by the name of the
+ * OpEnv, so the utilization analysis can relate it to the profiled latency of the op.
+ */
+inline void RecordOpWork(const Executable* exec, const VMContext& ctx, const OpEnv* op_env) {
+  auto func_it = exec->op_work.find(exec->functions[ctx->func_index].name);
+  if (func_it == exec->op_work.end()) {
+    return;
+  }
+  auto it = func_it->second.find(ctx->pc);
+  if (it == func_it->second.end()) {
+    return;
+  }
+  // The OpEnvs of the same kernel are named by GetUniqueName with a "_<N>" suffix.
+  std::string name = op_env->name();
+  std::string type = name;
+  size_t pos = type.rfind('_');
+  if (pos != std::string::npos && pos + 1 < type.size() &&
+      std::all_of(type.begin() + pos + 1, type.end(), ::isdigit)) {
+    type = type.substr(0, pos);
+  }
+  raf::profiler::Profiler::Get()->SetOpWork(name, {type, it->second.gflops, it->second.bytes});
+}
+
+/*! \brief The counter of the OpEnv cache lookups with the given result. */
+inline metrics::Counter* OpEnvCacheCounter(const std::string& result) {
+  return metrics::Registry::Get()->GetCounter(
+      "raf_op_env_cache_total", "The lookups of the OpEnv cache by the result.",
+      {{"result", result}});
+}
+
 }  // namespace utils
 
 RAF_REGISTER_OBJECT_REFLECT(VMContextObj);
@@ -146,10 +457,52 @@ RAF_REGISTER_OBJECT_REFLECT(VMContextObj);
 VMContext VMContext::make(const Executable* exec) {
   auto ptr = make_object<VMContextObj>();
   ptr->exec = exec;
+  ptr->recycled_frames.resize(exec->functions.size());
+  // The frames are moved into the stack on calls, which rarely grows beyond this depth.
+  ptr->frames.reserve(kInitialFrameStackDepth);
   return VMContext(ptr);
 }
 
-inline Value VMContext::ReadRegister(Index reg) const {
+VMCounters::VMCounters(const Executable* exec) {
+  for (const auto& func : exec->functions) {
+    pc_counts.emplace_back(func.instructions.size(), 0);
+  }
+}
+
+void VMCounters::Merge(const VMCounters& other) {
+  for (int i = 0; i < kNumOpcodes; ++i) {
+    opcode_counts[i] += other.opcode_counts[i];
+  }
+  CHECK_EQ(pc_counts.size(), other.pc_counts.size());
+  for (size_t i = 0; i < pc_counts.size(); ++i) {
+    for (size_t pc = 0; pc < pc_counts[i].size(); ++pc) {
+      pc_counts[i][pc] += other.pc_counts[i][pc];
+    }
+  }
+  prepare_op_env_ns += other.prepare_op_env_ns;
+  num_allocs += other.num_allocs;
+  alloc_ns += other.alloc_ns;
+  wait_event_ns += other.wait_event_ns;
+  stream_barrier_ns += other.stream_barrier_ns;
+  num_dtr_evictions += other.num_dtr_evictions;
+  num_dtr_rematerializations += other.num_dtr_rematerializations;
+}
+
+void VMCounters::Clear() {
+  opcode_counts.fill(0);
+  for (auto& counts : pc_counts) {
+    std::fill(counts.begin(), counts.end(), 0);
+  }
+  prepare_op_env_ns = 0;
+  num_allocs = 0;
+  alloc_ns = 0;
+  wait_event_ns = 0;
+  stream_barrier_ns = 0;
+  num_dtr_evictions = 0;
+  num_dtr_rematerializations = 0;
+}
+
+inline const Value& VMContext::ReadRegister(Index reg) const {
   auto self = this->operator->();
   return self->frames.back().register_file[reg];
 }
@@ -202,35 +555,438 @@ inline bool VMContext::IsConst(Index reg) const {
   return self->frames.back().is_const[reg];
 }
 
+/*!
+ * \brief Take a recycled frame of the function for a call from the current frame, or create one if
+ * there is none. The frame is not pushed yet, so the registers of the caller can still be read.
+ */
+inline VMFrame AcquireFrame(VMContextObj* self, Index func_index, RegName ret_reg,
+                            Index num_args) {
+  const auto& func = self->exec->functions[func_index];
+  CHECK_EQ(func.params.size(), num_args)
+      << "Number of arguments mismatches: " << func.params.size() << " vs " << num_args;
+  auto ret_pc = self->pc + 1;
+  auto& recycled = self->recycled_frames[func_index];
+  if (recycled.empty()) {
+    return VMFrame(self->func_index, ret_pc, ret_reg, num_args, func.register_file_size);
+  }
+  VMFrame frame = std::move(recycled.back());
+  recycled.pop_back();
+  frame.caller_func_index = self->func_index;
+  frame.caller_return_pc = ret_pc;
+  frame.caller_return_register = ret_reg;
+  frame.num_args = num_args;
+  return frame;
+}
+
 inline void VMContext::PushFrame(Index func_index, const std::vector<Value>& args,
                                  RegName ret_reg) {
   auto self = this->operator->();
-  const auto& func = self->exec->functions[func_index];
-  CHECK_EQ(func.params.size(), args.size())
-      << "Number of arguments mismatches: " << func.params.size() << " vs " << args.size();
-  auto ret_pc = self->pc + 1;
-  auto frame = VMFrame(self->func_index, ret_pc, ret_reg, args.size(), func.register_file_size);
-  self->frames.push_back(frame);
+  VMFrame frame = AcquireFrame(self, func_index, ret_reg, args.size());
   for (size_t i = 0; i < args.size(); ++i) {
-    WriteRegister(i, args[i]);
+    frame.register_file[i] = args[i];
+  }
+  self->frames.push_back(std::move(frame));
+  self->func_index = func_index;
+  self->code = self->exec->functions[func_index].instructions.data();
+  self->pc = 0;
+}
+
+inline void VMContext::PushFrame(Index func_index, const Array<Value>* free_vars,
+                                 const RegName* arg_regs, Index num_args, RegName ret_reg) {
+  auto self = this->operator->();
+  Index num_free_vars = free_vars != nullptr ? free_vars->size() : 0;
+  VMFrame frame = AcquireFrame(self, func_index, ret_reg, num_free_vars + num_args);
+  for (Index i = 0; i < num_free_vars; ++i) {
+    frame.register_file[i] = (*free_vars)[i];
   }
+  const VMFrame& caller = self->frames.back();
+  for (Index i = 0; i < num_args; ++i) {
+    frame.register_file[num_free_vars + i] = caller.register_file[arg_regs[i]];
+  }
+  self->frames.push_back(std::move(frame));
   self->func_index = func_index;
-  self->code = func.instructions.data();
+  self->code = self->exec->functions[func_index].instructions.data();
   self->pc = 0;
 }
 
+/*!
+ * \brief Release the value of a register. The tuples only referred by the register are kept with
+ * their fields released, so that the next AllocTuple to the register refills them instead of
+ * allocating new ones.
+ */
+inline void ReleaseRegister(Value* reg) {
+  auto* tuple = reg->unique() ? const_cast<TupleValueObj*>(reg->as<TupleValueObj>()) : nullptr;
+  if (tuple != nullptr && tuple->fields.unique()) {
+    for (size_t j = 0; j < tuple->fields.size(); ++j) {
+      tuple->fields.Set(j, Value());
+    }
+  } else {
+    *reg = Value();
+  }
+}
+
 inline Index VMContext::PopFrame() {
   auto self = this->operator->();
   CHECK_GT(self->frames.size(), 0);
-  const VMFrame& fr = self->frames.back();
-  self->func_index = fr.caller_func_index;
-  self->pc = fr.caller_return_pc;
-  self->code = self->exec->functions[self->func_index].instructions.data();
+  VMFrame& fr = self->frames.back();
+  Index ret_reg = fr.caller_return_register;
+  // Release the values of the frame except the constants, and keep the frame for the next call.
+  for (size_t i = 0; i < fr.register_file.size(); ++i) {
+    if (!fr.is_const[i]) {
+      ReleaseRegister(&fr.register_file[i]);
+    }
+  }
+  auto& recycled = self->recycled_frames[self->func_index];
+  recycled.push_back(std::move(fr));
   self->frames.pop_back();
-  return fr.caller_return_register;
+  self->func_index = recycled.back().caller_func_index;
+  self->pc = recycled.back().caller_return_pc;
+  self->code =
+      self->func_index >= 0 ? self->exec->functions[self->func_index].instructions.data() : nullptr;
+  return ret_reg;
+}
+
+VMContextPool::VMContextPool(size_t capacity)
+    : slots_(std::make_unique<Slot[]>(capacity)), capacity_(capacity) {
+}
+
+VMContext VMContextPool::Acquire(Index func_index) {
+  for (size_t i = 0; i < capacity_; ++i) {
+    Slot& slot = slots_[i];
+    if (slot.busy.exchange(true, std::memory_order_acquire)) {
+      continue;
+    }
+    VMContext ctx;
+    if (slot.ctx.defined() && slot.ctx->entry_func_index == func_index) {
+      ctx = std::move(slot.ctx);
+      slot.ctx = VMContext();
+    }
+    slot.busy.store(false, std::memory_order_release);
+    if (ctx.defined()) {
+      return ctx;
+    }
+  }
+  return VMContext();
+}
+
+void VMContextPool::Release(VMContext ctx) {
+  for (size_t i = 0; i < capacity_; ++i) {
+    Slot& slot = slots_[i];
+    if (slot.busy.exchange(true, std::memory_order_acquire)) {
+      continue;
+    }
+    bool stored = false;
+    if (!slot.ctx.defined()) {
+      slot.ctx = std::move(ctx);
+      stored = true;
+    }
+    slot.busy.store(false, std::memory_order_release);
+    if (stored) {
+      return;
+    }
+  }
+}
+
+DeviceConstantPool::DeviceConstantPool(tvm::runtime::Module exec, const Device& dev)
+    : exec_module_(exec), dev_(dev) {
+  exec_ = static_cast<const Executable*>(exec_module_.operator->());
+  values_.resize(exec_->constants.size());
+  states_.resize(exec_->constants.size(), kPending);
+}
+
+DeviceConstantPool::~DeviceConstantPool() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  if (prefetcher_.joinable()) {
+    prefetcher_.join();
+  }
+}
+
+std::shared_ptr<DeviceConstantPool> DeviceConstantPool::Get(const Executable* exec,
+                                                            const Device& dev) {
+  using PoolKey = std::tuple<const Executable*, int, int>;
+  static std::mutex mu;
+  static std::map<PoolKey, std::weak_ptr<DeviceConstantPool>> pools;
+  std::lock_guard<std::mutex> lock(mu);
+  auto key = std::make_tuple(exec, static_cast<int>(dev.device_type()), dev.device_id());
+  auto pool = pools[key].lock();
+  if (pool == nullptr) {
+    for (auto it = pools.begin(); it != pools.end();) {
+      it = it->second.expired() ? pools.erase(it) : std::next(it);
+    }
+    auto exec_module = tvm::runtime::Module(GetObjectPtr<Object>(const_cast<Executable*>(exec)));
+    pool = std::make_shared<DeviceConstantPool>(exec_module, dev);
+    pools[key] = pool;
+  }
+  return pool;
+}
+
+void DeviceConstantPool::Prefetch() {
+  if (dev_.device_type() != DevType::kCUDA()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mu_);
+  if (!prefetcher_.joinable() && !stop_) {
+    prefetcher_ = std::thread([this]() { PrefetchLoop(); });
+  }
+}
+
+Value DeviceConstantPool::Get(Index const_index) {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this, const_index]() { return states_[const_index] != kUploading; });
+  if (states_[const_index] == kReady) {
+    return values_[const_index];
+  }
+  states_[const_index] = kUploading;
+  lock.unlock();
+  Value value;
+  try {
+    value = utils::MaterializeConstant(exec_->constants[const_index], dev_);
+  } catch (...) {
+    lock.lock();
+    states_[const_index] = kPending;
+    cv_.notify_all();
+    throw;
+  }
+  lock.lock();
+  values_[const_index] = value;
+  states_[const_index] = kReady;
+  cv_.notify_all();
+  return value;
+}
+
+Value DeviceConstantPool::GetReplica(Index const_index, int node) {
+  Value value = Get(const_index);
+  std::lock_guard<std::mutex> lock(mu_);
+  if (replicas_.size() <= static_cast<size_t>(node)) {
+    replicas_.resize(node + 1);
+  }
+  auto& replicas = replicas_[node];
+  if (replicas.empty()) {
+    replicas.resize(values_.size());
+  }
+  if (!replicas[const_index].defined()) {
+    // The copy is done under the lock, which only happens on the first use on each node.
+    replicas[const_index] = utils::ReplicateConstant(value, node);
+  }
+  return replicas[const_index];
+}
+
+void DeviceConstantPool::StopUploading(std::unique_lock<std::mutex>* lock) {
+  lock->lock();
+  stop_ = true;
+  lock->unlock();
+  if (prefetcher_.joinable()) {
+    prefetcher_.join();
+  }
+  lock->lock();
+  cv_.wait(*lock, [this]() {
+    return std::find(states_.begin(), states_.end(), kUploading) == states_.end();
+  });
+}
+
+/*! \brief The magic number of the serialized IPC handle of the constants. */
+constexpr uint64_t kIpcConstantsMagic = 0x7261665F69706331;
+
+std::string DeviceConstantPool::ExportIpc() {
+#ifdef RAF_USE_CUDA
+  using common::cuda_ipc::IpcBuffer;
+  using common::cuda_ipc::IpcMemory;
+  CHECK(dev_.device_type() == DevType::kCUDA())
+      << "Only the constants on a CUDA device can be exported, but got " << dev_.c_str();
+  std::unique_lock<std::mutex> lock(mu_, std::defer_lock);
+  StopUploading(&lock);
+  CHECK(ipc_handle_.empty()) << "The constants are already shared by CUDA IPC";
+  // The locations of the compact tensor constants in the buffer, or -1 if not exported.
+  size_t n = exec_->constants.size();
+  std::vector<int64_t> offsets(n, -1), nbytes(n, 0);
+  int64_t size = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const auto* tensor = exec_->constants[i].as<TensorValueObj>();
+    if (tensor == nullptr || !common::shape_utils::IsCompact(*tensor->tensor.operator->())) {
+      continue;
+    }
+    nbytes[i] = common::shape_utils::BytesCompactTensor(*tensor->tensor.operator->());
+    offsets[i] = size;
+    size += (nbytes[i] + kDefaultMemoryAlignment - 1) / kDefaultMemoryAlignment *
+            kDefaultMemoryAlignment;
+  }
+  auto device_api = DeviceAPI::Get(dev_.device_type());
+  device_api->SetDevice(dev_.device_id());
+  auto buffer = std::make_shared<IpcBuffer>(std::max<int64_t>(size, 1));
+  auto stream = Stream::Get(dev_, kMemCpyCpuToCuda, 0);
+  for (size_t i = 0; i < n; ++i) {
+    if (offsets[i] < 0) {
+      continue;
+    }
+    DLTensor* src = Downcast<TensorValue>(exec_->constants[i]);
+    std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+    auto mem =
+        std::make_shared<IpcMemory>(buffer, static_cast<char*>(buffer->data) + offsets[i], dev_);
+    auto dst = TensorValue::Assemble(dev_, src->dtype, shape, {}, mem->data, mem);
+    device_api->CopyDataFromTo(src, dst, stream->data());
+    // The copies that were materialized before are released once no VM holds them.
+    values_[i] = dst;
+    states_[i] = kReady;
+  }
+  device_api->WaitStream(stream->data());
+
+  dmlc::MemoryStringStream strm(&ipc_handle_);
+  strm.Write(kIpcConstantsMagic);
+  strm.Write(std::string(reinterpret_cast<const char*>(&buffer->handle), sizeof(buffer->handle)));
+  strm.Write(static_cast<uint64_t>(buffer->size));
+  strm.Write(offsets);
+  strm.Write(nbytes);
+  cv_.notify_all();
+  return ipc_handle_;
+#else
+  LOG(FATAL) << "Exporting the constants requires CUDA. Please build with RAF_USE_CUDA=ON";
+  throw;
+#endif
+}
+
+void DeviceConstantPool::ImportIpc(const std::string& handle) {
+#ifdef RAF_USE_CUDA
+  using common::cuda_ipc::IpcBuffer;
+  using common::cuda_ipc::IpcMemory;
+  CHECK(dev_.device_type() == DevType::kCUDA())
+      << "Only the constants on a CUDA device can be imported, but got " << dev_.c_str();
+  std::string buf = handle;
+  dmlc::MemoryStringStream strm(&buf);
+  uint64_t magic, size;
+  std::string ipc_handle;
+  std::vector<int64_t> offsets, nbytes;
+  CHECK(strm.Read(&magic) && magic == kIpcConstantsMagic) << "Invalid IPC handle of constants";
+  CHECK(strm.Read(&ipc_handle) && ipc_handle.size() == sizeof(cudaIpcMemHandle_t) &&
+        strm.Read(&size) && strm.Read(&offsets) && strm.Read(&nbytes))
+      << "Truncated IPC handle of constants";
+  CHECK_EQ(offsets.size(), exec_->constants.size())
+      << "The constants are exported from a different executable";
+  std::unique_lock<std::mutex> lock(mu_, std::defer_lock);
+  StopUploading(&lock);
+  if (ipc_handle_ == handle) {
+    // Imported by another VM in this process.
+    return;
+  }
+  CHECK(ipc_handle_.empty()) << "The constants are already shared by CUDA IPC";
+  auto device_api = DeviceAPI::Get(dev_.device_type());
+  device_api->SetDevice(dev_.device_id());
+  cudaIpcMemHandle_t mem_handle;
+  std::memcpy(&mem_handle, ipc_handle.data(), sizeof(mem_handle));
+  auto buffer = std::make_shared<IpcBuffer>(mem_handle, size);
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    if (offsets[i] < 0) {
+      continue;
+    }
+    const auto* tensor = exec_->constants[i].as<TensorValueObj>();
+    CHECK(tensor != nullptr &&
+          common::shape_utils::BytesCompactTensor(*tensor->tensor.operator->()) == nbytes[i] &&
+          offsets[i] + nbytes[i] <= static_cast<int64_t>(size))
+        << "Constant " << i << " does not match the exported one";
+    const DLTensor* src = tensor->tensor.operator->();
+    std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+    auto mem =
+        std::make_shared<IpcMemory>(buffer, static_cast<char*>(buffer->data) + offsets[i], dev_);
+    values_[i] = TensorValue::Assemble(dev_, src->dtype, shape, {}, mem->data, mem);
+    states_[i] = kReady;
+  }
+  ipc_handle_ = handle;
+  cv_.notify_all();
+#else
+  LOG(FATAL) << "Importing the constants requires CUDA. Please build with RAF_USE_CUDA=ON";
+  throw;
+#endif
+}
+
+void DeviceConstantPool::PrefetchLoop() {
+  auto device_api = DeviceAPI::Get(dev_.device_type());
+  device_api->SetDevice(dev_.device_id());
+  auto stream = Stream::Get(dev_, kMemCpyCpuToCuda, 0);
+  for (size_t i = 0; i < values_.size(); ++i) {
+    const Value& constant = exec_->constants[i];
+    // Only the compact host tensors are uploaded here. The others are left to the loading threads.
+    const auto* tensor = constant.as<TensorValueObj>();
+    if (tensor == nullptr || tensor->tensor->device.device_type != kDLCPU ||
+        !common::shape_utils::IsCompact(*tensor->tensor.operator->())) {
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (stop_) {
+        return;
+      }
+      if (states_[i] != kPending) {
+        continue;
+      }
+      states_[i] = kUploading;
+    }
+    Value value;
+    try {
+      DLTensor* src = Downcast<TensorValue>(constant);
+      std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+      auto mem = memory_pool::Memory::Alloc(dev_, common::shape_utils::BytesCompactTensor(*src));
+      auto dst = TensorValue::Assemble(dev_, src->dtype, shape, {}, mem->data, mem);
+      device_api->CopyDataFromTo(src, dst, stream->data());
+      device_api->WaitStream(stream->data());
+      value = dst;
+    } catch (const dmlc::Error& e) {
+      LOG(WARNING) << "Failed to prefetch constant " << i << ": " << e.what();
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    values_[i] = value;
+    states_[i] = value.defined() ? kReady : kPending;
+    cv_.notify_all();
+  }
+}
+
+VMFuncOpEnvCache::VMFuncOpEnvCache(const VMFunction& func) {
+  pc_caches_.resize(func.instructions.size());
+  pc_last_.resize(func.instructions.size());
+  for (size_t pc = 0; pc < func.instructions.size(); ++pc) {
+    if (func.instructions[pc].op == Opcode::InvokeJit) {
+      pc_caches_[pc] = std::make_shared<OpEnvCache>();
+      pc_last_[pc] = std::make_unique<LastOpEnv>();
+    }
+  }
+}
+
+OpEnvPtr VMFuncOpEnvCache::GetLast(Index pc, const OpEnvSignature& signature, std::string* key) {
+  if (pc >= pc_last_.size() || pc_last_[pc] == nullptr) {
+    return nullptr;
+  }
+  LastOpEnv* last = pc_last_[pc].get();
+  std::lock_guard<std::mutex> lock(last->mu);
+  if (last->op_env == nullptr || !last->signature.Matches(signature)) {
+    return nullptr;
+  }
+  if (key != nullptr) {
+    *key = last->key;
+  }
+  return last->op_env;
+}
+
+void VMFuncOpEnvCache::SetLast(Index pc, const OpEnvSignature& signature, const OpEnvPtr& op_env,
+                               const std::string& key) {
+  if (pc >= pc_last_.size() || pc_last_[pc] == nullptr || signature.overflow) {
+    return;
+  }
+  LastOpEnv* last = pc_last_[pc].get();
+  std::lock_guard<std::mutex> lock(last->mu);
+  last->signature = signature;
+  last->op_env = op_env;
+  last->key = key;
+}
+
+OpEnvCache* VMFuncOpEnvCache::GetPreCreated(Index pc) const {
+  return pc < pc_caches_.size() ? pc_caches_[pc].get() : nullptr;
 }
 
 std::shared_ptr<OpEnvCache> VMFuncOpEnvCache::Get(Index pc) {
+  if (pc < pc_caches_.size() && pc_caches_[pc] != nullptr) {
+    return pc_caches_[pc];
+  }
   std::lock_guard<std::mutex> lock(mu_);
   auto it = cache_map_.find(pc);
   if (it != cache_map_.end()) {
@@ -243,6 +999,20 @@ std::shared_ptr<OpEnvCache> VMFuncOpEnvCache::Get(Index pc) {
 
 void VMFuncOpEnvCache::Clear() {
   std::lock_guard<std::mutex> lock(mu_);
+  // The per-pc caches are read without the lock, so they are cleared in place instead of being
+  // replaced.
+  for (auto& cache : pc_caches_) {
+    if (cache != nullptr) {
+      cache->Clear();
+    }
+  }
+  for (auto& last : pc_last_) {
+    if (last != nullptr) {
+      std::lock_guard<std::mutex> last_lock(last->mu);
+      last->op_env = nullptr;
+      last->key.clear();
+    }
+  }
   cache_map_.clear();
 }
 
@@ -254,9 +1024,12 @@ class VirtualMachine::CudaGraphImpl {
   }
 
   ~CudaGraphImpl() {
-    CUDA_CALL(cudaGraphDestroy(graph_));
-    CUDA_CALL(cudaGraphExecDestroy(exec_));
-    CUDA_CALL(cudaStreamDestroy(stream_for_graph_));
+    if (graph_ != nullptr) {
+      CUDA_CALL(cudaGraphDestroy(graph_));
+    }
+    if (exec_ != nullptr) {
+      CUDA_CALL(cudaGraphExecDestroy(exec_));
+    }
   }
 
   void GetKernelInfo() {
@@ -269,32 +1042,123 @@ class VirtualMachine::CudaGraphImpl {
   }
 
   void BeginCapture() {
-    stream_for_graph_ = static_cast<cudaStream_t>(
-        raf::device_api::DeviceAPI::Get(device_.device_type())->CreateStream(device_));
-
-    OpEnv::SetStreamForAllBackends(device_, stream_for_graph_);
-    CUDA_CALL(cudaStreamBeginCapture(stream_for_graph_, cudaStreamCaptureModeRelaxed));
+    stream_ = Stream::Create(device_);
+    OpEnv::SetStreamForAllBackends(device_, stream_->data());
+    CUDA_CALL(cudaStreamBeginCapture(static_cast<cudaStream_t>(stream_->data()),
+                                     cudaStreamCaptureModeRelaxed));
   }
 
-  void EndCapture() {
-    CUDA_CALL(cudaStreamEndCapture(stream_for_graph_, &graph_));
-    CUDA_CALL(cudaGraphInstantiate(&exec_, graph_, NULL, NULL, 0));
+  /*!
+   * \brief End capturing and instantiate the graph.
+   * \param reusable The evicted graph whose executable can be updated for this graph, if any.
+   */
+  void EndCapture(CudaGraphImpl* reusable = nullptr) {
+    CUDA_CALL(cudaStreamEndCapture(static_cast<cudaStream_t>(stream_->data()), &graph_));
+    exec_ = utils::InstantiateCudaGraph(graph_, reusable ? &reusable->exec_ : nullptr);
     GetKernelInfo();
     is_captured_ = true;
   }
 
   void Invoke() {
-    CUDA_CALL(cudaGraphLaunch(exec_, NULL));
-    CUDA_CALL(cudaStreamSynchronize(stream_for_graph_));
+    auto stream = static_cast<cudaStream_t>(stream_->data());
+    CUDA_CALL(cudaGraphLaunch(exec_, stream));
+    CUDA_CALL(cudaStreamSynchronize(stream));
+  }
+
+  /*! \brief The stream that captures the graph, which is stream 0 of the captured context. */
+  const std::shared_ptr<Stream>& stream() const {
+    return stream_;
   }
 
  private:
   bool is_captured_ = false;
-  cudaStream_t stream_for_graph_;
-  cudaGraph_t graph_;
-  cudaGraphExec_t exec_;
+  std::shared_ptr<Stream> stream_;
+  cudaGraph_t graph_ = nullptr;
+  cudaGraphExec_t exec_ = nullptr;
   Device device_;
 };
+
+/*! \brief The minimal number of kernels in a static segment to be captured as a CUDA graph. */
+constexpr int kMinCudaGraphSegmentKernels = 2;
+class VirtualMachine::CudaGraphSegment {
+ public:
+  /*!
+   * \brief A captured and instantiated CUDA graph of the segment. The graph executable is null if
+   * the segment has been executed only once with the key, which warms up the OpEnvs before
+   * capturing.
+   */
+  struct Graph {
+    ~Graph() {
+      if (exec != nullptr) {
+        CUDA_CALL(cudaGraphExecDestroy(exec));
+      }
+      if (graph != nullptr) {
+        CUDA_CALL(cudaGraphDestroy(graph));
+      }
+    }
+    cudaGraph_t graph = nullptr;
+    cudaGraphExec_t exec = nullptr;
+    /*! \brief The workspaces referred by the captured kernels. */
+    std::vector<std::shared_ptr<Memory>> workspaces;
+    /*! \brief The logical time of the last use. */
+    uint64_t last_use = 0;
+  };
+
+  CudaGraphSegment(Index begin, Index end, std::vector<Index> regs)
+      : begin(begin), end(end), regs(std::move(regs)) {
+  }
+
+  /*!
+   * \brief Get the key of the segment for the current execution. Since the captured kernels refer
+   * to the buffers directly, the key includes the addresses as well as the shapes of the tensors.
+   * \param ctx The VM context.
+   * \param key The key to be generated.
+   * \return Whether the key can be generated. It fails if any register is not a tensor.
+   */
+  bool GetKey(const VMContext& ctx, std::string* key) const {
+    HashKey hash_key;
+    auto add_tensor = [&hash_key](const TensorValueObj* tensor) {
+      const DLTensor* dl_tensor = tensor->tensor.operator->();
+      hash_key << *dl_tensor << reinterpret_cast<uint64_t>(dl_tensor->data)
+               << dl_tensor->byte_offset;
+    };
+    for (Index reg : regs) {
+      Value val = ctx.ReadRegister(reg);
+      if (const auto* tensor = val.as<TensorValueObj>()) {
+        add_tensor(tensor);
+      } else if (const auto* tuple = val.as<TupleValueObj>()) {
+        for (const auto& field : tuple->fields) {
+          const auto* field_tensor = field.as<TensorValueObj>();
+          if (field_tensor == nullptr) {
+            return false;
+          }
+          add_tensor(field_tensor);
+        }
+      } else {
+        return false;
+      }
+    }
+    *key = std::string(hash_key.byte_vector.begin(), hash_key.byte_vector.end());
+    return true;
+  }
+
+  /*! \brief The index of the first instruction. */
+  Index begin;
+  /*! \brief The index after the last instruction. */
+  Index end;
+  /*! \brief The registers of the InvokeJit arguments. */
+  std::vector<Index> regs;
+  /*! \brief Indicates whether the segment failed to be captured. */
+  bool disabled = false;
+  /*! \brief The captured graphs, which are evicted in the least recently used order. */
+  std::unordered_map<std::string, std::shared_ptr<Graph>> graphs;
+  /*! \brief The evicted graph whose executable can be updated for the next captured graph. */
+  std::shared_ptr<Graph> evicted;
+  /*! \brief The logical clock for the graph uses. */
+  uint64_t clock = 0;
+  /*! \brief The mutex to access the segment. */
+  std::mutex mu;
+};
 #endif
 
 PackedFunc VirtualMachine::GetFunction(const std::string& name,
@@ -302,16 +1166,89 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
   if (name == "run") {
     return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
       VMContext ctx = args[0];
+      if (async_dispatcher_ != nullptr) {
+        // Launched after the pending executions.
+        *rv = RunAsync(ctx)->Get();
+        return;
+      }
       *rv = Run(ctx);
     });
+  } else if (name == "reset_context") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      VMContext ctx = args[0];
+      std::vector<Value> inputs(args.size() - 1);
+      for (int i = 1; i < args.size(); ++i) {
+        inputs[i - 1] = args[i];
+      }
+      ResetVMContext(ctx, inputs);
+    });
+  } else if (name == "run_steps") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      VMContext ctx = args[0];
+      int num_steps = args[1];
+      Array<Integer> batch_indices = args[2];
+      PackedFunc fnext = args[3];
+      std::vector<int> indices;
+      for (const auto& index : batch_indices) {
+        indices.push_back(index->value);
+      }
+      if (async_dispatcher_ != nullptr) {
+        async_dispatcher_->Wait();
+      }
+      *rv = RunSteps(ctx, num_steps, indices, fnext);
+    });
+  } else if (name == "run_future") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      VMContext ctx = args[0];
+      if (async_dispatcher_ != nullptr) {
+        *rv = RunAsync(ctx);
+        return;
+      }
+      *rv = Run(ctx, true);
+    });
+  } else if (name == "release_context") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      VMContext ctx = args[0];
+      ReleaseVMContext(ctx);
+    });
   } else if (name == "profile") {
     return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
       VMContext ctx = args[0];
       int warmup = args[1];
       int number = args[2];
       int repeat = args[3];
+      if (async_dispatcher_ != nullptr) {
+        async_dispatcher_->Wait();
+      }
       *rv = Profile(ctx, warmup, number, repeat);
     });
+  } else if (name == "set_counters") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      bool enabled = args[0];
+      EnableCounters(enabled);
+    });
+  } else if (name == "get_counters") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      *rv = GetCounters();
+    });
+  } else if (name == "reset_counters") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      ResetCounters();
+    });
+  } else if (name == "set_alloc_batching") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      bool enabled = args[0];
+      EnableAllocBatching(enabled);
+    });
+  } else if (name == "get_alloc_batches") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      Array<Array<Integer>> ret;
+      for (const auto& batch : GetAllocBatches()) {
+        ret.push_back({Integer(std::get<0>(batch)), Integer(std::get<1>(batch)),
+                       Integer(std::get<2>(batch))});
+      }
+      *rv = ret;
+    });
   } else if (name == "set_devices") {
     return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
       std::vector<Device> devices;
@@ -321,6 +1258,21 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       }
       this->SetDevices(devices);
     });
+  } else if (name == "export_constants") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::string handle = ExportConstants();
+      *rv = TVMByteArray{handle.data(), handle.size()};
+    });
+  } else if (name == "import_constants") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::string handle = args[0];
+      ImportConstants(handle);
+    });
+  } else if (name == "set_tenant") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::string tenant = args[0];
+      SetTenant(tenant);
+    });
   } else if (name == "prepare_context") {
     return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
       CHECK(exec_) << "The executable is not loaded yet.";
@@ -340,8 +1292,45 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
 void VirtualMachine::LoadExecutable(const Executable* exec) {
   CHECK(exec) << "The executable is not created yet.";
   exec_ = exec;
+  const_pool_.resize(exec_->constants.size());
   for (int i = 0; i < exec_->functions.size(); ++i) {
-    op_env_cache_.push_back(std::make_shared<VMFuncOpEnvCache>());
+    op_env_cache_.push_back(std::make_shared<VMFuncOpEnvCache>(exec_->functions[i]));
+  }
+  infer_type_cache_.resize(exec_->functions.size());
+  if (persistent_storage_) {
+    InitPersistentStorages();
+  }
+  InitAllocBatches();
+  if (frozen_) {
+    for (const auto& func : exec_->functions) {
+      for (const auto& instr : func.instructions) {
+        if (instr.op == Opcode::If || instr.op == Opcode::InferType ||
+            instr.op == Opcode::SetShape) {
+          frozen_ = false;
+        }
+      }
+    }
+    LOG_IF(WARNING, !frozen_) << "Frozen mode is disabled because the executable has control flow "
+                              << "or dynamic shapes.";
+  }
+#ifdef RAF_USE_CUDA
+  if (enable_cuda_graph_) {
+    BuildCudaGraphSegments();
+  }
+#endif
+  if (fork_join_) {
+    BuildForkPlan();
+  }
+  if (dtr_budget_ > 0) {
+    for (const auto& func : exec_->functions) {
+      for (const auto& instr : func.instructions) {
+        if (instr.op == Opcode::CudaSetStream) {
+          dtr_budget_ = 0;
+        }
+      }
+    }
+    LOG_IF(WARNING, dtr_budget_ == 0) << "DTR is disabled because the executable runs on "
+                                      << "multiple streams or CPU lanes.";
   }
 
   tvm::runtime::Module lib = exec_->lib;
@@ -363,12 +1352,19 @@ void VirtualMachine::LoadExecutable(const Executable* exec) {
 
 VMContext VirtualMachine::PrepareVMContext(const std::string& func_name,
                                            const std::vector<Value>& inputs) {
+  RAF_NVTX_RANGE(kVM, "PrepareVMContext " + func_name);
   auto gvit = exec_->global_map.find(func_name);
   CHECK(gvit != exec_->global_map.end()) << "Cannot find function " << func_name;
   auto func_index = gvit->second;
   const auto& vm_func = exec_->functions[func_index];
   CHECK_EQ(inputs.size(), vm_func.params.size())
       << "The number of inputs doesn't match the number of parameters for function " << func_name;
+  // Dispatch to the version specialized to the input shapes if any, and fall back to the general
+  // version otherwise.
+  auto bucket_it = exec_->shape_buckets.find(func_name);
+  if (bucket_it != exec_->shape_buckets.end()) {
+    func_index = utils::MatchShapeBucket(bucket_it->second, inputs, func_index);
+  }
 
   auto fcreate_ctx = [&]() {
     auto ctx = VMContext::make(exec_);
@@ -386,17 +1382,48 @@ VMContext VirtualMachine::PrepareVMContext(const std::string& func_name,
     std::lock_guard<std::mutex> lock(cuda_graph_mutex_);
     // Check if there is another context using the CUDA graph
     CHECK(!cuda_graph_occupied_) << "VM in CUDA graph mode doesn't support concurrent execution";
-    if (!cuda_graph_ctx_.defined() || cuda_graph_ctx_->entry_func_index != func_index) {
-      // Initialize the cuda graph context for the first time, or reset the cuda graph context
-      // because this time invokes a different function
-      cuda_graph_impl_ = nullptr;
-      cuda_graph_ctx_ = fcreate_ctx();
+    // The graphs are cached by the function and the input shapes.
+    HashKey hash_key;
+    hash_key << static_cast<int64_t>(func_index);
+    for (const auto& input : inputs) {
+      if (const auto* tensor = input.as<TensorValueObj>()) {
+        hash_key << *tensor->tensor.operator->();
+      } else {
+        hash_key << input->GetTypeKey();
+      }
+    }
+    std::string key(hash_key.byte_vector.begin(), hash_key.byte_vector.end());
+    auto it = std::find_if(cuda_graph_buckets_.begin(), cuda_graph_buckets_.end(),
+                           [&key](const CudaGraphBucket& bucket) { return bucket.key == key; });
+    if (it == cuda_graph_buckets_.end()) {
+      // Initialize the cuda graph context for the input shapes for the first time. If the cache
+      // is full, evict the least recently used graph, whose executable may be updated for the new
+      // graph instead of instantiating from scratch.
+      if (cuda_graph_buckets_.size() >= utils::GetCudaGraphCacheSize()) {
+        auto lru = std::min_element(cuda_graph_buckets_.begin(), cuda_graph_buckets_.end(),
+                                    [](const CudaGraphBucket& a, const CudaGraphBucket& b) {
+                                      return a.last_use < b.last_use;
+                                    });
+        if (lru->impl != nullptr) {
+          cuda_graph_evicted_ = lru->impl;
+        }
+        cuda_graph_buckets_.erase(lru);
+      }
+      cuda_graph_buckets_.push_back({key, fcreate_ctx(), nullptr, 0});
+      it = cuda_graph_buckets_.end() - 1;
     } else {
       for (int i = 0; i < inputs.size(); i++) {
         Value new_arg = inputs[i];
-        Value graph_arg = cuda_graph_ctx_->inputs[i];
+        Value graph_arg = it->ctx->inputs[i];
         if (new_arg.as<TensorValueObj>()) {
           CHECK(graph_arg.as<TensorValueObj>()) << "Value type mismatch, cannot copy";
+          const DLTensor* src = Downcast<TensorValue>(new_arg)->tensor.operator->();
+          const DLTensor* dst = Downcast<TensorValue>(graph_arg)->tensor.operator->();
+          if (src->data == dst->data && src->byte_offset == dst->byte_offset) {
+            // The graph is bound to this tensor, e.g., a parameter or an optimizer state that is
+            // updated in place by the captured step, so it is used without copy.
+            continue;
+          }
           Downcast<TensorValue>(new_arg)->tensor.CopyTo(Downcast<TensorValue>(graph_arg)->tensor);
         } else {
           LOG(FATAL) << "Unsupported Value Type for reusing CUDA Graph";
@@ -404,47 +1431,349 @@ VMContext VirtualMachine::PrepareVMContext(const std::string& func_name,
       }
       DLOG(INFO) << "Updated the inputs to the cached CUDA Graph.";
     }
+    it->last_use = ++cuda_graph_clock_;
+    cuda_graph_bucket_index_ = it - cuda_graph_buckets_.begin();
     cuda_graph_occupied_ = true;
-    return cuda_graph_ctx_;
+    return it->ctx;
   }
 #endif
+  if (frozen_) {
+    auto ctx = PrepareFrozenContext(func_index, inputs);
+    if (ctx.defined()) {
+      return ctx;
+    }
+  }
+  if (serving_mode_) {
+    // Recycle a context of the same function, which keeps its own stream and events.
+    auto ctx = context_pool_->Acquire(func_index);
+    if (ctx.defined()) {
+      Device dev = devices_[0];
+      ctx->inputs.resize(inputs.size());
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        ctx->inputs[i] = CopyTo(inputs[i], dev);
+      }
+      return ctx;
+    }
+    ctx = fcreate_ctx();
+#ifdef RAF_USE_CUDA
+    if (use_cuda_) {
+      // Each context launches kernels to its own stream instead of the default stream, so that
+      // the contexts driven by different threads can run concurrently.
+      ctx->streams.resize(1);
+      ctx->streams[0].push_back(Stream::Create(devices_[0]));
+    }
+#endif
+    return ctx;
+  }
   auto ctx = fcreate_ctx();
   return ctx;
 }
 
-Value VirtualMachine::Run(VMContext ctx) {
+Value VirtualMachine::Run(VMContext ctx, bool future) {
+  memory_pool::TenantScope tenant_scope(tenant_);
+  RAF_NVTX_RANGE(kVM, "Run " + exec_->functions[ctx->entry_func_index].name);
+  // The host time of a run, which includes the device time unless the run is asynchronous.
+  static auto* run_latency = metrics::Registry::Get()->GetHistogram(
+      "raf_vm_run_latency_us", "The host latency of VirtualMachine::Run in microseconds.",
+      metrics::ExponentialBuckets(10, 2, 20));
+  metrics::ScopedLatency run_timer(run_latency);
   auto frun = [&]() {
+    if (ctx->frozen_plan != nullptr) {
+      RunFrozenPlan(ctx);
+      return;
+    }
     // ctx->pc will be reset to 0 in the PushFrame
     ctx.PushFrame(ctx->entry_func_index, ctx->inputs, -1);
     RunLoop(ctx);
   };
 #ifdef RAF_USE_CUDA
   if (enable_cuda_graph_) {
-    CHECK(ctx.get() == cuda_graph_ctx_.get()) << "Wrong VMContext provided for CUDA graph.";
-    if (!cuda_graph_impl_) {
-      cuda_graph_impl_ = new CudaGraphImpl(devices_[0]);
+    CHECK(cuda_graph_bucket_index_ >= 0 &&
+          ctx.get() == cuda_graph_buckets_[cuda_graph_bucket_index_].ctx.get())
+        << "Wrong VMContext provided for CUDA graph.";
+    CudaGraphBucket& bucket = cuda_graph_buckets_[cuda_graph_bucket_index_];
+    if (!bucket.impl) {
+      bucket.impl = std::make_shared<CudaGraphImpl>(devices_[0]);
       DLOG(INFO) << "Begin capturing CUDA graph.";
-      cuda_graph_impl_->BeginCapture();
+      bucket.impl->BeginCapture();
+      // The instructions on stream 0 are captured by the capture stream, and the other streams
+      // are forked from it once used, so a multi-stream step is captured as one graph.
+      Index device_id = devices_[0].device_id();
+      utils::GetStreamById(ctx, device_id, 0);
+      ctx->streams[device_id][0] = bucket.impl->stream();
+      ctx->capture_stream = bucket.impl->stream()->data();
       frun();
-      cuda_graph_impl_->EndCapture();
+      JoinCaptureStreams(ctx);
+      ctx->capture_stream = nullptr;
+      bucket.impl->EndCapture(cuda_graph_evicted_.get());
+      OpEnv::SetStreamForAllBackends(devices_[0], nullptr);
+      cuda_graph_evicted_ = nullptr;
       DLOG(INFO) << "CUDA graph captured.";
     }
-    cuda_graph_impl_->Invoke();
+    bucket.impl->Invoke();
     std::lock_guard<std::mutex> lock(cuda_graph_mutex_);
     cuda_graph_occupied_ = false;
     // TODO(@icemelon9, @zhiics): May need to copy the return register to the host device to
     // avoid data race
-    return ctx->return_register;
+    return future ? MakeFutureValue(ctx, nullptr) : ctx->return_register;
   }
 #endif
+#ifdef RAF_USE_CUDA
+  if (serving_mode_ && use_cuda_) {
+    // The stream setting of the backends is thread local.
+    OpEnv::SetStreamForAllBackends(devices_[0], utils::GetStreamById(ctx, 0, 0)->data());
+  }
+#endif
+  if (counters_enabled_) {
+    // The counters of a recycled context are reused without allocation.
+    if (ctx->counters == nullptr) {
+      ctx->counters = std::make_shared<VMCounters>(exec_);
+    } else {
+      ctx->counters->Clear();
+    }
+  } else {
+    ctx->counters = nullptr;
+  }
+  if (dtr_budget_ > 0 && ctx->frozen_plan == nullptr) {
+    // The callbacks hold the context by a raw pointer, since the context owns the manager.
+    VMContextObj* ctx_ptr = ctx.get();
+    ctx->dtr = std::make_shared<DTRManager>(
+        dtr_budget_,
+        [this, ctx_ptr](const Device& dev, int64_t nbytes, int64_t alignment) {
+          return Alloc(GetRef<VMContext>(ctx_ptr), dev, nbytes, alignment, false);
+        },
+        [this, ctx_ptr](const OpEnvPtr& op_env, const std::vector<Value>& inputs,
+                        const Value& output) {
+          VMContext ctx = GetRef<VMContext>(ctx_ptr);
+          PrepareWorkspace(ctx, op_env);
+          op_env->Execute(inputs, output);
+          ReleaseWorkspace(ctx, op_env);
+        });
+  }
   frun();
+  if (ctx->dtr != nullptr) {
+    ctx->dtr->Finish();
+    if (ctx->counters != nullptr) {
+      ctx->counters->num_dtr_evictions = ctx->dtr->NumEvictions();
+      ctx->counters->num_dtr_rematerializations = ctx->dtr->NumRematerializations();
+    }
+    ctx->dtr = nullptr;
+  }
+  if (ctx->counters != nullptr) {
+    std::lock_guard<std::mutex> lock(counters_mutex_);
+    if (counters_ == nullptr) {
+      counters_ = std::make_unique<VMCounters>(exec_);
+    }
+    counters_->Merge(*ctx->counters);
+  }
+  std::shared_ptr<event_pool::Event> output_event;
+#ifdef RAF_USE_CUDA
+  if (output_stager_ != nullptr) {
+    // Issue the copies of the outputs to the host right away, which overlap with the next
+    // executions. The outputs of the context stream are copied once it finishes in serving mode.
+    void* stream = serving_mode_ ? utils::GetStreamById(ctx, 0, 0)->data() : nullptr;
+    std::tie(ctx->return_register, output_event) =
+        output_stager_->Stage(ctx->return_register, stream);
+    if (frozen_ || persistent_storage_) {
+      // The next executions write the same buffers, so they wait for the copies from them.
+      DeviceAPI::Get(DevType::kCUDA())->StreamWaitEvent(stream, output_event->data());
+    }
+  }
+#endif
+  if (stream_ordered_alloc_ && !ctx->deferred_releases.empty()) {
+    ReclaimDeferredMemory(ctx, false);
+    auto api = DeviceAPI::Get(DevType::kCUDA());
+    for (auto& kv : ctx->deferred_releases) {
+      // Work issued later to any (blocking) stream is ordered after the legacy default stream, so
+      // it is safe to release the memory once the default stream waits for the recorded event.
+      api->StreamWaitEvent(nullptr, kv.first->data());
+    }
+    ctx->deferred_releases.clear();
+  }
+#ifdef RAF_USE_CUDA
+  if (serving_mode_ && use_cuda_) {
+    // Wait for the stream of this context only, so that the outputs are ready for the caller
+    // without blocking the other threads. A future waits for the stream lazily instead.
+    auto stream = utils::GetStreamById(ctx, 0, 0);
+    OpEnv::SetStreamForAllBackends(devices_[0], nullptr);
+    if (future) {
+      return MakeFutureValue(ctx, stream->data(), output_event);
+    }
+    if (output_event != nullptr) {
+      DeviceAPI::Get(DevType::kCUDA())->WaitEvent(output_event->data());
+    } else {
+      stream->Wait();
+    }
+    return ctx->return_register;
+  }
+#endif
   if (ctx->current_stream_id != 0) {
     // reset the working stream to default stream.
     OpEnv::SetStreamForAllBackends(devices_[0], nullptr);
   }
+  if (future) {
+    return MakeFutureValue(ctx, nullptr, output_event);
+  }
+  if (output_event != nullptr) {
+    // The host outputs are ready for the caller once the copies finish.
+    DeviceAPI::Get(DevType::kCUDA())->WaitEvent(output_event->data());
+  }
   return ctx->return_register;
 }
 
+FutureValue VirtualMachine::RunAsync(VMContext ctx) {
+  CHECK(async_dispatcher_ != nullptr) << "Asynchronous dispatch is not enabled.";
+  return async_dispatcher_->Submit(
+      [this, ctx]() { return Downcast<FutureValue>(Run(ctx, true)); });
+}
+
+FutureValue VirtualMachine::MakeFutureValue(const VMContext& ctx, void* stream,
+                                            std::shared_ptr<event_pool::Event> event) {
+  Device device = devices_[0];
+  if (event == nullptr && device.device_type() == DevType::kCUDA()) {
+    // Without a given stream, the event is recorded on the legacy default stream, which is ordered
+    // after the work issued to any blocking stream before, i.e., all kernels of this execution.
+    event = event_pool::EventPool::Get(device)->GetEvent(event_pool::kEventDisableTiming);
+    DeviceAPI::Get(device.device_type())->EventRecordOnStream(event->data(), stream);
+  }
+  return FutureValue::make(ctx->return_register, device, std::move(event));
+}
+
+Array<Value> VirtualMachine::RunSteps(VMContext ctx, int num_steps,
+                                      const std::vector<int>& batch_indices,
+                                      const PackedFunc& fnext) {
+  Array<Value> outputs;
+  for (int step = 0; step < num_steps; ++step) {
+    if (fnext != nullptr) {
+      Array<Value> batch = fnext();
+      CHECK_EQ(batch.size(), batch_indices.size())
+          << "The batch of step " << step << " has " << batch.size() << " values, but "
+          << batch_indices.size() << " inputs are rebound";
+      for (size_t i = 0; i < batch_indices.size(); ++i) {
+        RebindInput(ctx, batch_indices[i], batch[i]);
+      }
+    }
+    outputs.push_back(Run(ctx));
+  }
+  return outputs;
+}
+
+void VirtualMachine::RebindInput(VMContext& ctx, int index, const Value& value) {
+  CHECK(index >= 0 && index < static_cast<int>(ctx->inputs.size()))
+      << "The input index " << index << " is out of range";
+  bool bound_to_buffers = ctx->frozen_plan != nullptr;
+#ifdef RAF_USE_CUDA
+  bound_to_buffers = bound_to_buffers || enable_cuda_graph_;
+#endif
+  if (bound_to_buffers) {
+    // The recorded kernels read the input buffers owned by the context.
+    CopyTo(value, ctx->inputs[index]);
+  } else {
+    ctx->inputs[index] = CopyTo(value, devices_[0]);
+  }
+}
+
+void VirtualMachine::ResetVMContext(VMContext ctx, const std::vector<Value>& inputs) {
+  CHECK(ctx->deferred_releases.empty()) << "The context is still running.";
+  CHECK_EQ(inputs.size(), ctx->inputs.size())
+      << "The number of inputs doesn't match the number of parameters";
+  ctx->frames.clear();
+  ctx->func_index = -1;
+  ctx->pc = 0;
+  ctx->code = nullptr;
+  ctx->return_register = Value();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    RebindInput(ctx, i, inputs[i]);
+  }
+}
+
+void VirtualMachine::ReleaseVMContext(VMContext ctx) {
+  if (!serving_mode_) {
+    return;
+  }
+  CHECK(ctx->deferred_releases.empty()) << "The context is still running.";
+  ctx->frames.clear();
+  ctx->func_index = -1;
+  ctx->pc = 0;
+  ctx->code = nullptr;
+  ctx->return_register = Value();
+  for (auto& input : ctx->inputs) {
+    input = Value();
+  }
+  context_pool_->Release(std::move(ctx));
+}
+
+void VirtualMachine::EnableCounters(bool enabled) {
+  counters_enabled_ = enabled;
+}
+
+void VirtualMachine::EnableAllocBatching(bool enabled) {
+  alloc_batching_ = enabled;
+}
+
+std::vector<std::tuple<Index, Index, Index>> VirtualMachine::GetAllocBatches() const {
+  std::vector<std::tuple<Index, Index, Index>> ret;
+  for (size_t i = 0; i < alloc_batches_.size(); ++i) {
+    for (const auto& kv : alloc_batches_[i]) {
+      ret.emplace_back(i, kv.first, kv.second);
+    }
+  }
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
+
+Map<String, ObjectRef> VirtualMachine::GetCounters() {
+  std::lock_guard<std::mutex> lock(counters_mutex_);
+  Map<String, ObjectRef> ret;
+  Map<String, Integer> opcode_counts;
+  Array<ObjectRef> pc_counts;
+  auto to_us = [](uint64_t ns) { return FloatImm(DataType::Float(64), ns / 1000.0); };
+  auto to_int = [](uint64_t v) { return IntImm(DataType::Int(64), static_cast<int64_t>(v)); };
+  if (counters_ != nullptr) {
+    for (int i = 0; i < VMCounters::kNumOpcodes; ++i) {
+      if (counters_->opcode_counts[i] > 0) {
+        opcode_counts.Set(utils::OpcodeName(static_cast<Opcode>(i)),
+                          to_int(counters_->opcode_counts[i]));
+      }
+    }
+    for (size_t i = 0; i < counters_->pc_counts.size(); ++i) {
+      const auto& func = exec_->functions[i];
+      for (size_t pc = 0; pc < counters_->pc_counts[i].size(); ++pc) {
+        if (counters_->pc_counts[i][pc] == 0) {
+          continue;
+        }
+        std::ostringstream os;
+        os << func.instructions[pc];
+        Map<String, ObjectRef> item;
+        item.Set("func", String(func.name));
+        item.Set("pc", to_int(pc));
+        item.Set("instruction", String(os.str()));
+        item.Set("count", to_int(counters_->pc_counts[i][pc]));
+        pc_counts.push_back(item);
+      }
+    }
+  }
+  VMCounters empty(exec_);
+  const VMCounters& counters = counters_ != nullptr ? *counters_ : empty;
+  ret.Set("opcode_counts", opcode_counts);
+  ret.Set("pc_counts", pc_counts);
+  ret.Set("prepare_op_env_us", to_us(counters.prepare_op_env_ns));
+  ret.Set("num_allocs", to_int(counters.num_allocs));
+  ret.Set("alloc_us", to_us(counters.alloc_ns));
+  ret.Set("wait_event_us", to_us(counters.wait_event_ns));
+  ret.Set("stream_barrier_us", to_us(counters.stream_barrier_ns));
+  ret.Set("num_dtr_evictions", to_int(counters.num_dtr_evictions));
+  ret.Set("num_dtr_rematerializations", to_int(counters.num_dtr_rematerializations));
+  return ret;
+}
+
+void VirtualMachine::ResetCounters() {
+  std::lock_guard<std::mutex> lock(counters_mutex_);
+  if (counters_ != nullptr) {
+    counters_->Clear();
+  }
+}
+
 Array<FloatValue> VirtualMachine::Profile(VMContext ctx, int warmup, int number, int repeat) {
   Array<FloatValue> results;
   Device device = devices_[0];
@@ -493,27 +1822,190 @@ void VirtualMachine::SetDevices(const std::vector<Device>& devices) {
   }
   if (!use_cuda_) {
     enable_cuda_graph_ = false;
+#ifdef RAF_USE_CUDA
+    use_cuda_graph_segments_ = false;
+#endif
+  } else if (serving_mode_ && !stream_ordered_alloc_) {
+    // Memory released by a context may be reused by another context on a different stream.
+    DLOG(INFO) << "Stream-ordered allocation is enabled in serving mode.";
+    stream_ordered_alloc_ = true;
+  }
+  if (exec_ != nullptr && !devices_.empty()) {
+    device_constants_ = DeviceConstantPool::Get(exec_, devices_[0]);
+    if (!ipc_constants_.empty()) {
+      device_constants_->ImportIpc(ipc_constants_);
+    } else if (!dryrun_) {
+      device_constants_->Prefetch();
+    }
+  }
+  if (async_dispatch_ && !devices_.empty()) {
+    // The dispatch thread sets the device once, so it is recreated for the new devices.
+    async_dispatcher_ = nullptr;
+    async_dispatcher_ = std::make_shared<AsyncDispatcher>(devices_[0], kAsyncDispatchDepth);
+  }
+  output_stager_ = nullptr;
+  if (host_outputs_ && !dryrun_ && !devices_.empty() &&
+      devices_[0].device_type() == DevType::kCUDA()) {
+    output_stager_ = std::make_shared<OutputStager>(devices_[0], kOutputStagingDepth);
+  }
+}
+
+std::string VirtualMachine::ExportConstants() {
+  CHECK(device_constants_ != nullptr) << "The devices are not set yet.";
+  std::string handle = device_constants_->ExportIpc();
+  std::lock_guard<std::mutex> lock(const_pool_mutex_);
+  std::fill(const_pool_.begin(), const_pool_.end(), Value());
+  return handle;
+}
+
+void VirtualMachine::ImportConstants(const std::string& handle) {
+  ipc_constants_ = handle;
+  if (device_constants_ != nullptr) {
+    device_constants_->ImportIpc(handle);
+    std::lock_guard<std::mutex> lock(const_pool_mutex_);
+    std::fill(const_pool_.begin(), const_pool_.end(), Value());
   }
 }
 
 inline std::shared_ptr<Memory> VirtualMachine::Alloc(const VMContext& ctx, Device dev,
                                                      int64_t nbytes, int64_t alignment,
                                                      bool alloc_async) const {
+  if (ctx->dtr != nullptr && ctx->cpu_lane < 0) {
+    // Evict the storages over the budget before allocating more.
+    ctx->dtr->Reserve(nbytes);
+  }
+  VMCounters* counters = ctx->counters.get();
+  utils::ScopedCounterTimer timer(counters ? &counters->alloc_ns : nullptr);
+  if (counters != nullptr) {
+    ++counters->num_allocs;
+  }
+  std::shared_ptr<Memory> mem;
   if (dev.device_type() == DevType::kCUDA()) {
 #if CUDA_VERSION >= 11030
     if (enable_cuda_graph_ || !alloc_async) {
       // We can not use async memory allocation in cuda graph tracing mode
-      return memory_pool::Memory::Alloc(dev, nbytes, alignment);
+      mem = memory_pool::Memory::Alloc(dev, nbytes, alignment);
     } else {
       auto stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id);
-      return memory_pool::Memory::AllocAsync(dev, nbytes, stream->data(), alignment);
+      mem = memory_pool::Memory::AllocAsync(dev, nbytes, stream->data(), alignment);
     }
 #else
-    return memory_pool::Memory::Alloc(dev, nbytes, alignment);
+    mem = memory_pool::Memory::Alloc(dev, nbytes, alignment);
 #endif
   } else {
-    return memory_pool::Memory::Alloc(dev, nbytes, alignment);
+    mem = memory_pool::Memory::Alloc(dev, nbytes, alignment);
+  }
+  auto tracer = memory_pool::AllocTracer::Get();
+  if (tracer->IsTracing()) {
+    mem = tracer->Track(mem, nbytes, alignment, alloc_async ? ctx->current_stream_id : -1);
+  }
+  if (memory_profiler::MemoryProfiler::Get()->IsProfiling()) {
+    ProfileAllocation(ctx, mem, nbytes);
+  }
+  if (ctx->capture_stream != nullptr) {
+    // The captured kernels keep using the buffer in the replays.
+    ctx->graph_buffers.push_back(mem);
+  }
+  return mem;
+}
+
+void VirtualMachine::ProfileAllocation(const VMContext& ctx, const std::shared_ptr<Memory>& mem,
+                                       int64_t nbytes) const {
+  std::string var = "<workspace>";
+  if (ctx->func_index >= 0 && static_cast<size_t>(ctx->func_index) < exec_->functions.size()) {
+    const auto& func = exec_->functions[ctx->func_index];
+    if (static_cast<size_t>(ctx->pc) < func.instructions.size()) {
+      const auto& instr = func.instructions[ctx->pc];
+      if (instr.op == Opcode::AllocStorage || instr.op == Opcode::AllocTensorReg) {
+        auto it = func.register_names.find(instr.dst);
+        var = it != func.register_names.end() ? it->second : "$" + std::to_string(instr.dst);
+      }
+    }
+  }
+  memory_profiler::MemoryProfiler::Get()->RecordAlloc(mem->device, mem.get(), nbytes, var,
+                                                      ctx->current_stream_id);
+}
+
+void VirtualMachine::ReleaseMemory(const VMContext& ctx, std::shared_ptr<Memory>* mem) {
+  if (*mem == nullptr) {
+    return;
+  }
+  if (memory_profiler::MemoryProfiler::Get()->IsProfiling()) {
+    memory_profiler::MemoryProfiler::Get()->RecordFree((*mem)->device, mem->get());
+  }
+  ReleaseMemoryImpl(ctx, mem);
+}
+
+void VirtualMachine::ReleaseMemoryImpl(const VMContext& ctx, std::shared_ptr<Memory>* mem) {
+  if (!stream_ordered_alloc_ || (*mem)->device.device_type() != DevType::kCUDA()) {
+    if (ctx->in_fork) {
+      // Keep the memory until the join, since the other forks may run concurrently.
+      ctx->fork_buffers.push_back(std::move(*mem));
+    } else if (ctx->cpu_lane >= 0) {
+      // Keep the memory until the end of the wave, since the deferred ops may still use it.
+      ctx->cpu_wave_buffers.push_back(std::move(*mem));
+    }
+    mem->reset();
+    return;
+  }
+  void* curr_stream =
+      utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data();
+  void* alloc_stream = (*mem)->stream;
+  if (curr_stream == nullptr || curr_stream == alloc_stream) {
+    // The release is ordered after the pending workloads of the current stream, either because
+    // the memory is freed asynchronously on the same stream, or because the legacy default stream
+    // is implicitly synchronized with all blocking streams.
+    mem->reset();
+    return;
+  }
+  Device device(DevType::kCUDA(), static_cast<int>(ctx->current_device_id));
+  auto event = EventPool::Get(device)->GetEvent(event_pool::kEventDisableTiming);
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  api->EventRecordOnStream(event->data(), curr_stream);
+  if (alloc_stream != nullptr) {
+    // Let the allocation stream wait for the current stream, so cudaFreeAsync on the allocation
+    // stream takes place after the pending workloads that may still use this memory.
+    api->StreamWaitEvent(alloc_stream, event->data());
+    mem->reset();
+  } else {
+    // The memory will be recycled by the pool immediately once released, so keep it alive until
+    // the workloads on the current stream have finished.
+    ctx->deferred_releases.emplace_back(std::move(event), std::move(*mem));
+    mem->reset();
+  }
+}
+
+void VirtualMachine::ReclaimDeferredMemory(const VMContext& ctx, bool wait) {
+  auto& pending = ctx->deferred_releases;
+  if (pending.empty()) {
+    return;
   }
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  auto it = std::remove_if(pending.begin(), pending.end(), [&](const auto& kv) {
+    if (wait) {
+      api->WaitEvent(kv.first->data());
+      return true;
+    }
+    return api->QueryEvent(kv.first->data());
+  });
+  pending.erase(it, pending.end());
+}
+
+void* VirtualMachine::GetWorkspaceFromArena(const VMContext& ctx, Device dev, int64_t nbytes) {
+  CHECK(dev.device_type() == DevType::kCUDA()) << "Only the CUDA workspaces are kept in arenas";
+  void* stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data();
+  std::lock_guard<std::mutex> lock(workspace_mutex_);
+  auto key = std::make_tuple(static_cast<int>(dev.device_type()), dev.device_id(), stream);
+  WorkspaceArena& arena = workspace_arenas_[key];
+  if (arena.nbytes < nbytes) {
+    // Grow the arena to the maximum workspace size required by any OpEnv so far, so that each
+    // arena is reallocated at most a few times during the first iterations.
+    max_workspace_nbytes_ = std::max(max_workspace_nbytes_, nbytes);
+    ReleaseMemory(ctx, &arena.memory);
+    arena.memory = Alloc(ctx, dev, max_workspace_nbytes_, kDefaultMemoryAlignment, false);
+    arena.nbytes = max_workspace_nbytes_;
+  }
+  return arena.memory->data;
 }
 
 void VirtualMachine::RunLoop(VMContext& ctx) {
@@ -529,31 +2021,39 @@ void VirtualMachine::RunLoop(VMContext& ctx) {
   ctx->current_device_id = 0;
   ctx->current_stream_id = 0;
   ctx->current_barrier_event_index = 0;
+  VMCounters* counters = ctx->counters.get();
+  if (threaded_dispatch_ && !profiler::Profiler::Get()->IsProfiling(2) && counters == nullptr) {
+    RunThreadedLoop(ctx);
+    return;
+  }
+// The instruction names are literals, which are interned by their addresses.
+#define WITH_VM_INSTRUCTION_PROFILER(NAME, CODE_SNIPPET)                        \
+  WITH_BASE_PROFILER_LEVEL(2, host_device_, RAF_PROFILER_LITERAL(NAME),         \
+                           RAF_PROFILER_LITERAL("VMInstruction"), {}, CODE_SNIPPET)
   while (true) {
   main_loop:
     auto const& instr = ctx->code[ctx->pc];
+    if (counters != nullptr) {
+      counters->Count(ctx->func_index, ctx->pc, instr.op);
+    }
     switch (instr.op) {
       case Opcode::Move: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "Move", "VMInstruction", {},
-                                 { HandleMove(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("Move", { HandleMove(ctx, instr); });
         goto main_loop;
       }
       case Opcode::Fatal: {
         throw std::runtime_error("VM encountered fatal error");
       }
       case Opcode::LoadConst: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "LoadConst", "VMInstruction", {},
-                                 { HandleLoadConst(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("LoadConst", { HandleLoadConst(ctx, instr); });
         goto main_loop;
       }
       case Opcode::LoadConsti: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "LoadConsti", "VMInstruction", {},
-                                 { HandleLoadConsti(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("LoadConsti", { HandleLoadConsti(ctx, instr); });
         goto main_loop;
       }
       case Opcode::GetField: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "GetField", "VMInstruction", {},
-                                 { HandleGetField(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("GetField", { HandleGetField(ctx, instr); });
         goto main_loop;
       }
       case Opcode::Goto: {
@@ -561,100 +2061,433 @@ void VirtualMachine::RunLoop(VMContext& ctx) {
         goto main_loop;
       }
       case Opcode::If: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "If", "VMInstruction", {},
-                                 { HandleIf(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("If", { HandleIf(ctx, instr); });
         goto main_loop;
       }
       case Opcode::AllocStorage: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "AllocStorage", "VMInstruction", {},
-                                 { HandleAllocStorage(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("AllocStorage", { HandleAllocStorage(ctx, instr); });
         goto main_loop;
       }
       case Opcode::AllocTensor: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "AllocTensor", "VMInstruction", {},
-                                 { HandleAllocTensor(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("AllocTensor", { HandleAllocTensor(ctx, instr); });
         goto main_loop;
       }
       case Opcode::AllocTensorReg: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "AllocTensorReg", "VMInstruction", {},
-                                 { HandleAllocTensorReg(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("AllocTensorReg", { HandleAllocTensorReg(ctx, instr); });
         goto main_loop;
       }
       case Opcode::AllocTuple: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "AllocTuple", "VMInstruction", {},
-                                 { HandleAllocTuple(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("AllocTuple", { HandleAllocTuple(ctx, instr); });
         goto main_loop;
       }
       case Opcode::AllocClosure: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "AllocClosure", "VMInstruction", {},
-                                 { HandleAllocClosure(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("AllocClosure", { HandleAllocClosure(ctx, instr); });
         goto main_loop;
       }
       case Opcode::Free: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "Free", "VMInstruction", {},
-                                 { HandleFree(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("Free", { HandleFree(ctx, instr); });
+        goto main_loop;
+      }
+      case Opcode::KillRegister: {
+        HandleKillRegister(ctx, instr);
         goto main_loop;
       }
       case Opcode::SetShape: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "SetShape", "VMInstruction", {},
-                                 { HandleSetShape(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("SetShape", { HandleSetShape(ctx, instr); });
         goto main_loop;
       }
       case Opcode::InvokeFunc: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "InvokeFunc", "VMInstruction", {},
-                                 { HandleInvokeFunc(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("InvokeFunc", { HandleInvokeFunc(ctx, instr); });
         goto main_loop;
       }
       case Opcode::InvokePacked: {
         LOG(FATAL) << "Not supported.";
       }
       case Opcode::InvokeClosure: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "InvokeClosure", "VMInstruction", {},
-                                 { HandleInvokeClosure(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("InvokeClosure", { HandleInvokeClosure(ctx, instr); });
         goto main_loop;
       }
       case Opcode::InvokeJit: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "InvokeJit", "VMInstruction", {},
-                                 { HandleInvokeJit(ctx, instr); });
+#ifdef RAF_USE_CUDA
+        if (use_cuda_graph_segments_ && RunCudaGraphSegment(ctx)) {
+          goto main_loop;
+        }
+#endif
+        WITH_VM_INSTRUCTION_PROFILER("InvokeJit", { HandleInvokeJit(ctx, instr); });
         goto main_loop;
       }
       case Opcode::InferType: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "InferType", "VMInstruction", {},
-                                 { HandleInferType(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("InferType", { HandleInferType(ctx, instr); });
         goto main_loop;
       }
       case Opcode::Ret: {
         bool final_ret;
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "Ret", "VMInstruction", {},
-                                 { final_ret = HandleRet(ctx, instr); });
+        WITH_VM_INSTRUCTION_PROFILER("Ret", { final_ret = HandleRet(ctx, instr); });
         if (final_ret) {
           return;
         }
         goto main_loop;
       }
       case Opcode::CudaSetStream: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "CudaSetStream", "VMInstruction", {},
-                                 HandleCudaSetStream(ctx, instr););
+        WITH_VM_INSTRUCTION_PROFILER("CudaSetStream", HandleCudaSetStream(ctx, instr););
         goto main_loop;
       }
       case Opcode::CudaAddEvent: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "CudaAddEvent", "VMInstruction", {},
-                                 HandleCudaAddEvent(ctx, instr););
+        WITH_VM_INSTRUCTION_PROFILER("CudaAddEvent", HandleCudaAddEvent(ctx, instr););
         goto main_loop;
       }
       case Opcode::CudaWaitEvent: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "CudaWaitEvent", "VMInstruction", {},
-                                 HandleCudaWaitEvent(ctx, instr););
+        utils::ScopedCounterTimer timer(counters ? &counters->wait_event_ns : nullptr);
+        WITH_VM_INSTRUCTION_PROFILER("CudaWaitEvent", HandleCudaWaitEvent(ctx, instr););
         goto main_loop;
       }
       case Opcode::CudaStreamBarrier: {
-        WITH_BASE_PROFILER_LEVEL(2, host_device_, "CudaStreamBarrier", "VMInstruction", {},
-                                 HandleCudaStreamBarrier(ctx, instr););
+        utils::ScopedCounterTimer timer(counters ? &counters->stream_barrier_ns : nullptr);
+        WITH_VM_INSTRUCTION_PROFILER("CudaStreamBarrier", HandleCudaStreamBarrier(ctx, instr););
         goto main_loop;
       }
     }
   }
 }
+#undef WITH_VM_INSTRUCTION_PROFILER
+
+void VirtualMachine::RunThreadedLoop(VMContext& ctx) {
+#if defined(__GNUC__) || defined(__clang__)
+  // The addresses of labels are constant, so the decoded instructions can be reused across runs.
+  constexpr int kNumOpcodes = static_cast<int>(Opcode::CudaStreamBarrier) + 1;
+  const void* dispatch_table[kNumOpcodes];
+  std::fill(dispatch_table, dispatch_table + kNumOpcodes, &&op_invalid);
+  dispatch_table[static_cast<int>(Opcode::Move)] = &&op_move;
+  dispatch_table[static_cast<int>(Opcode::Ret)] = &&op_ret;
+  dispatch_table[static_cast<int>(Opcode::Fatal)] = &&op_fatal;
+  dispatch_table[static_cast<int>(Opcode::LoadConst)] = &&op_load_const;
+  dispatch_table[static_cast<int>(Opcode::LoadConsti)] = &&op_load_consti;
+  dispatch_table[static_cast<int>(Opcode::GetField)] = &&op_get_field;
+  dispatch_table[static_cast<int>(Opcode::If)] = &&op_if;
+  dispatch_table[static_cast<int>(Opcode::Goto)] = &&op_goto;
+  dispatch_table[static_cast<int>(Opcode::AllocStorage)] = &&op_alloc_storage;
+  dispatch_table[static_cast<int>(Opcode::AllocTensor)] = &&op_alloc_tensor;
+  dispatch_table[static_cast<int>(Opcode::AllocTensorReg)] = &&op_alloc_tensor_reg;
+  dispatch_table[static_cast<int>(Opcode::AllocTuple)] = &&op_alloc_tuple;
+  dispatch_table[static_cast<int>(Opcode::AllocClosure)] = &&op_alloc_closure;
+  dispatch_table[static_cast<int>(Opcode::SetShape)] = &&op_set_shape;
+  dispatch_table[static_cast<int>(Opcode::Free)] = &&op_free;
+  dispatch_table[static_cast<int>(Opcode::KillRegister)] = &&op_kill_register;
+  dispatch_table[static_cast<int>(Opcode::InvokeFunc)] = &&op_invoke_func;
+  dispatch_table[static_cast<int>(Opcode::InvokeClosure)] = &&op_invoke_closure;
+  dispatch_table[static_cast<int>(Opcode::InvokeJit)] = &&op_invoke_jit;
+  dispatch_table[static_cast<int>(Opcode::InferType)] = &&op_infer_type;
+  dispatch_table[static_cast<int>(Opcode::CudaSetStream)] = &&op_cuda_set_stream;
+  dispatch_table[static_cast<int>(Opcode::CudaAddEvent)] = &&op_cuda_add_event;
+  dispatch_table[static_cast<int>(Opcode::CudaWaitEvent)] = &&op_cuda_wait_event;
+  dispatch_table[static_cast<int>(Opcode::CudaStreamBarrier)] = &&op_cuda_stream_barrier;
+
+  std::call_once(decode_once_, [&]() {
+    decoded_code_.resize(exec_->functions.size());
+    for (size_t i = 0; i < exec_->functions.size(); ++i) {
+      const auto& instructions = exec_->functions[i].instructions;
+      decoded_code_[i].reserve(instructions.size());
+      for (const auto& instr : instructions) {
+        Index pc = decoded_code_[i].size();
+        DecodedInstruction decoded{dispatch_table[static_cast<int>(instr.op)], &instr, {}};
+        if (instr.op == Opcode::InvokeJit) {
+          decoded.jit = ResolveJitOperands(i, pc);
+          decoded.jit.op_env_cache = decoded.jit.func_op_env_cache->GetPreCreated(pc);
+        }
+        decoded_code_[i].push_back(decoded);
+      }
+    }
+  });
+
+  const DecodedInstruction* code = decoded_code_[ctx->func_index].data();
+#define RAF_VM_DISPATCH() goto* code[ctx->pc].handler
+#define RAF_VM_RELOAD_AND_DISPATCH()              \
+  code = decoded_code_[ctx->func_index].data(); \
+  RAF_VM_DISPATCH()
+#define RAF_VM_INSTR (*code[ctx->pc].instr)
+#define RAF_VM_JIT_OPERANDS (code[ctx->pc].jit)
+
+  RAF_VM_DISPATCH();
+op_move:
+  HandleMove(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_ret:
+  if (HandleRet(ctx, RAF_VM_INSTR)) {
+    return;
+  }
+  RAF_VM_RELOAD_AND_DISPATCH();
+op_fatal:
+  throw std::runtime_error("VM encountered fatal error");
+op_load_const:
+  HandleLoadConst(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_load_consti:
+  HandleLoadConsti(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_get_field:
+  HandleGetField(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_if:
+  HandleIf(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_goto:
+  ctx->pc += RAF_VM_INSTR.pc_offset;
+  RAF_VM_DISPATCH();
+op_alloc_storage:
+  HandleAllocStorage(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_alloc_tensor:
+  HandleAllocTensor(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_alloc_tensor_reg:
+  HandleAllocTensorReg(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_alloc_tuple:
+  HandleAllocTuple(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_alloc_closure:
+  HandleAllocClosure(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_set_shape:
+  HandleSetShape(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_free:
+  HandleFree(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_kill_register:
+  HandleKillRegister(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_invoke_func:
+  HandleInvokeFunc(ctx, RAF_VM_INSTR);
+  RAF_VM_RELOAD_AND_DISPATCH();
+op_invoke_closure:
+  HandleInvokeClosure(ctx, RAF_VM_INSTR);
+  RAF_VM_RELOAD_AND_DISPATCH();
+op_invoke_jit:
+#ifdef RAF_USE_CUDA
+  if (use_cuda_graph_segments_ && RunCudaGraphSegment(ctx)) {
+    RAF_VM_DISPATCH();
+  }
+#endif
+  // The VM debugger overrides HandleInvokeJit, but it never runs the threaded loop.
+  InvokeJit(ctx, RAF_VM_INSTR, RAF_VM_JIT_OPERANDS);
+  RAF_VM_DISPATCH();
+op_infer_type:
+  HandleInferType(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_cuda_set_stream:
+  HandleCudaSetStream(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_cuda_add_event:
+  HandleCudaAddEvent(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_cuda_wait_event:
+  HandleCudaWaitEvent(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_cuda_stream_barrier:
+  HandleCudaStreamBarrier(ctx, RAF_VM_INSTR);
+  RAF_VM_DISPATCH();
+op_invalid:
+  LOG(FATAL) << "Not supported opcode: " << static_cast<int>(RAF_VM_INSTR.op);
+  throw;
+#undef RAF_VM_JIT_OPERANDS
+#undef RAF_VM_INSTR
+#undef RAF_VM_RELOAD_AND_DISPATCH
+#undef RAF_VM_DISPATCH
+#else
+  LOG(FATAL) << "Threaded dispatch requires the labels-as-values extension of GCC or Clang.";
+  throw;
+#endif
+}
+
+#ifdef RAF_USE_CUDA
+void VirtualMachine::BuildCudaGraphSegments() {
+  bool is_static = true;
+  for (const auto& func : exec_->functions) {
+    for (const auto& instr : func.instructions) {
+      if (instr.op == Opcode::If || instr.op == Opcode::InferType ||
+          instr.op == Opcode::SetShape) {
+        is_static = false;
+      }
+    }
+  }
+  if (is_static) {
+    // The whole function can be captured.
+    return;
+  }
+  LOG(INFO) << "The executable has control flow or dynamic shapes. "
+            << "CUDA graphs will be captured for its static segments.";
+  enable_cuda_graph_ = false;
+  use_cuda_graph_segments_ = true;
+  cuda_graph_segments_.resize(exec_->functions.size());
+  for (size_t i = 0; i < exec_->functions.size(); ++i) {
+    const auto& instructions = exec_->functions[i].instructions;
+    Index num_instrs = instructions.size();
+    cuda_graph_segments_[i].resize(num_instrs);
+    Index pc = 0;
+    while (pc < num_instrs) {
+      if (instructions[pc].op != Opcode::InvokeJit) {
+        ++pc;
+        continue;
+      }
+      // A segment only contains kernel launches and memory and register releases. The releases
+      // are performed after launching the graph, and any other instruction ends the segment.
+      Index end = pc;
+      int num_kernels = 0;
+      std::vector<Index> regs;
+      while (end < num_instrs && (instructions[end].op == Opcode::InvokeJit ||
+                                  instructions[end].op == Opcode::Free ||
+                                  instructions[end].op == Opcode::KillRegister)) {
+        const auto& instr = instructions[end];
+        if (instr.op == Opcode::InvokeJit) {
+          ++num_kernels;
+          regs.insert(regs.end(), instr.invoke_jit.args,
+                      instr.invoke_jit.args + instr.invoke_jit.arity);
+        }
+        ++end;
+      }
+      if (num_kernels >= kMinCudaGraphSegmentKernels) {
+        cuda_graph_segments_[i][pc] = std::make_shared<CudaGraphSegment>(pc, end, std::move(regs));
+      }
+      pc = end;
+    }
+  }
+}
+
+bool VirtualMachine::RunCudaGraphSegment(VMContext& ctx) {
+  if (dryrun_ || profiler::Profiler::Get()->IsProfiling(1)) {
+    return false;
+  }
+  const auto& segment = cuda_graph_segments_[ctx->func_index][ctx->pc];
+  if (segment == nullptr || segment->disabled) {
+    return false;
+  }
+  std::string key;
+  if (!segment->GetKey(ctx, &key)) {
+    std::lock_guard<std::mutex> lock(segment->mu);
+    segment->disabled = true;
+    return false;
+  }
+
+  std::shared_ptr<CudaGraphSegment::Graph> graph;
+  std::shared_ptr<CudaGraphSegment::Graph> reusable;
+  {
+    std::lock_guard<std::mutex> lock(segment->mu);
+    auto it = segment->graphs.find(key);
+    if (it == segment->graphs.end()) {
+      if (segment->graphs.size() >= utils::GetCudaGraphCacheSize()) {
+        auto lru = std::min_element(
+            segment->graphs.begin(), segment->graphs.end(),
+            [](const auto& a, const auto& b) { return a.second->last_use < b.second->last_use; });
+        if (lru->second->exec != nullptr) {
+          segment->evicted = lru->second;
+        }
+        segment->graphs.erase(lru);
+      }
+      // Execute the segment as usual for the first time to initialize the OpEnvs, which may
+      // perform operations that are not allowed during stream capture.
+      auto warmup = std::make_shared<CudaGraphSegment::Graph>();
+      warmup->last_use = ++segment->clock;
+      segment->graphs.emplace(key, warmup);
+      return false;
+    }
+    graph = it->second;
+    graph->last_use = ++segment->clock;
+    if (graph->exec == nullptr) {
+      reusable = std::move(segment->evicted);
+    }
+  }
+
+  Device dev = devices_[0];
+  auto stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id);
+  if (graph->exec == nullptr) {
+    uint64_t last_use = graph->last_use;
+    graph = std::make_shared<CudaGraphSegment::Graph>();
+    graph->last_use = last_use;
+    auto api = DeviceAPI::Get(DevType::kCUDA());
+    void* capture_stream = api->CreateStream(dev);
+    OpEnv::SetStreamForAllBackends(dev, capture_stream);
+    CUDA_CALL(cudaStreamBeginCapture(static_cast<cudaStream_t>(capture_stream),
+                                     cudaStreamCaptureModeRelaxed));
+    bool captured = true;
+    try {
+      for (Index pc = segment->begin; pc < segment->end && captured; ++pc) {
+        const auto& instr = ctx->code[pc];
+        if (instr.op != Opcode::InvokeJit) {
+          continue;
+        }
+        ctx->pc = pc;
+        OpEnvPtr op_env;
+        std::vector<Value> inputs;
+        Value output;
+        std::string op_env_cache_key;
+        std::tie(op_env, inputs, output, op_env_cache_key) = PrepareOpEnv(ctx, instr);
+        std::shared_ptr<Requests> requests = op_env->GetRequests();
+        // OpEnvs that launch kernels on their own streams, or whose workspaces are released right
+        // after the execution, cannot be replayed from a graph.
+        captured = requests->stream.empty();
+        for (auto& entry : requests->workspace) {
+          if (entry.memory != nullptr) {
+            captured = false;
+            *entry.dest = nullptr;
+            ReleaseMemory(ctx, &entry.memory);
+          }
+        }
+        if (!captured) {
+          break;
+        }
+        if (!requests->workspace.empty()) {
+          // Keep the workspace arena alive for the graph, even if the arena grows later.
+          std::lock_guard<std::mutex> lock(workspace_mutex_);
+          const Device& ws_dev = requests->workspace[0].device;
+          auto arena_it = workspace_arenas_.find(std::make_tuple(
+              static_cast<int>(ws_dev.device_type()), ws_dev.device_id(), stream->data()));
+          if (arena_it != workspace_arenas_.end()) {
+            graph->workspaces.push_back(arena_it->second.memory);
+          }
+        }
+        op_env->Execute(inputs, output);
+      }
+    } catch (const dmlc::Error& e) {
+      LOG(WARNING) << "Failed to capture CUDA graph for the segment starting at instruction "
+                   << segment->begin << ": " << e.what();
+      captured = false;
+    }
+    cudaError_t status =
+        cudaStreamEndCapture(static_cast<cudaStream_t>(capture_stream), &graph->graph);
+    captured &= status == cudaSuccess;
+    OpEnv::SetStreamForAllBackends(dev, stream->data());
+    if (captured) {
+      graph->exec =
+          utils::InstantiateCudaGraph(graph->graph, reusable ? &reusable->exec : nullptr);
+    }
+    api->FreeStream(dev, capture_stream);
+    ctx->pc = segment->begin;
+
+    std::lock_guard<std::mutex> lock(segment->mu);
+    if (!captured) {
+      segment->disabled = true;
+      return false;
+    }
+    segment->graphs[key] = graph;
+  }
+
+  CUDA_CALL(cudaGraphLaunch(graph->exec, static_cast<cudaStream_t>(stream->data())));
+  // Release the memory and the registers in the segment after the kernels are issued, which is
+  // still ordered before any later kernel on the stream.
+  for (Index pc = segment->begin; pc < segment->end; ++pc) {
+    const auto& instr = ctx->code[pc];
+    ctx->pc = pc;
+    if (instr.op == Opcode::Free) {
+      HandleFree(ctx, instr);
+    } else if (instr.op == Opcode::KillRegister) {
+      HandleKillRegister(ctx, instr);
+    }
+  }
+  ctx->pc = segment->end;
+  return true;
+}
+#endif
 
 void VirtualMachine::HandleMove(VMContext& ctx, const Instruction& instr) {
   Value from_obj = ctx.ReadRegister(instr.from);
@@ -663,50 +2496,190 @@ void VirtualMachine::HandleMove(VMContext& ctx, const Instruction& instr) {
 }
 
 void VirtualMachine::HandleLoadConst(VMContext& ctx, const Instruction& instr) {
-  auto constant_obj = exec_->constants[instr.const_index];
   // We cache the allocated object in the constant pool. To measure, the
   // first iteration will set the pool up. The other iterations will
-  // directly reuse the allocated objects.
-  if (const_pool_.size() <= static_cast<size_t>(instr.const_index)) {
-    const_pool_.resize(instr.const_index + 1);
+  // directly reuse the allocated objects. The objects are materialized by the device constant
+  // pool shared with the other VMs, which may have uploaded them in the background.
+  VMFrame& frame = ctx->frames.back();
+  if (frame.is_const[instr.dst] && frame.register_file[instr.dst].defined()) {
+    // The constant is kept in the register of a recycled frame.
+    ctx->pc++;
+    return;
   }
+  Value constant;
+  if (host_device_.device_type() == devices_[0].device_type() &&
+      common::numa_utils::ReplicateEnabled()) {
+    // The replicas are per NUMA node, so they are not cached in the pool of the VM.
+    constant = device_constants_->GetReplica(instr.const_index, common::numa_utils::CurrentNode());
+  } else {
+    std::lock_guard<std::mutex> lock(const_pool_mutex_);
+    if (const_pool_.size() <= static_cast<size_t>(instr.const_index)) {
+      const_pool_.resize(instr.const_index + 1);
+    }
 
-  if (!const_pool_[instr.const_index].defined()) {
-    // TODO(@zhiics): device could be obtained from the device list.
-    const_pool_[instr.const_index] = CopyTo(constant_obj, devices_[0]);
+    if (!const_pool_[instr.const_index].defined()) {
+      // TODO(@zhiics): device could be obtained from the device list.
+      const_pool_[instr.const_index] = device_constants_->Get(instr.const_index);
+    }
+    constant = const_pool_[instr.const_index];
   }
-  ctx.WriteRegister(instr.dst, const_pool_[instr.const_index]);
+  ctx.WriteRegister(instr.dst, constant);
   ctx->frames.back().is_const[instr.dst] = true;
   ctx->pc++;
 }
 
 void VirtualMachine::HandleLoadConsti(VMContext& ctx, const Instruction& instr) {
-  ctx.WriteRegister(instr.dst, ScalarValue::make(instr.load_consti.val));
+  auto& frame = ctx->frames.back();
+  // The scalar is kept in the register of a recycled frame like the other constants.
+  if (!frame.is_const[instr.dst] || !frame.register_file[instr.dst].defined()) {
+    ctx.WriteRegister(instr.dst, ScalarValue::make(instr.load_consti.val));
+    frame.is_const[instr.dst] = true;
+  }
+  ctx->pc++;
+}
+
+void VirtualMachine::HandleGetField(VMContext& ctx, const Instruction& instr) {
+  const auto* tuple = ctx.ReadRegister(instr.get_field.object).as<TupleValueObj>();
+  CHECK(tuple != nullptr) << "GetField expects a tuple in register " << instr.get_field.object;
+  ctx.WriteRegister(instr.dst, tuple->fields[instr.get_field.field_index]);
   ctx->pc++;
 }
 
-void VirtualMachine::HandleGetField(VMContext& ctx, const Instruction& instr) {
-  auto object = ctx.ReadRegister(instr.get_field.object);
-  const auto& tuple = Downcast<TupleValue>(object);
-  auto field = tuple->fields[instr.get_field.field_index];
-  ctx.WriteRegister(instr.dst, field);
-  ctx->pc++;
+void VirtualMachine::HandleIf(VMContext& ctx, const Instruction& instr) {
+  if (ctx->cpu_lane >= 0) {
+    RunCpuLanes(ctx);
+  }
+  int32_t test_val = ctx.LoadTensorInt(instr.if_op.test);
+  int32_t target_val = ctx.LoadScalarInt(instr.if_op.target);
+
+  if (test_val == target_val) {
+    CHECK_NE(instr.if_op.true_offset, 0);
+    ctx->pc += instr.if_op.true_offset;
+  } else {
+    CHECK_NE(instr.if_op.false_offset, 0);
+    ctx->pc += instr.if_op.false_offset;
+  }
+}
+
+void VirtualMachine::InitPersistentStorages() {
+  persistent_buffers_.resize(exec_->functions.size());
+  for (size_t i = 0; i < exec_->functions.size(); ++i) {
+    const auto& instructions = exec_->functions[i].instructions;
+    std::unordered_set<RegName> freed_regs;
+    for (const auto& instr : instructions) {
+      if (instr.op == Opcode::Free) {
+        freed_regs.insert(instr.free.memory);
+      }
+    }
+    for (size_t pc = 0; pc < instructions.size(); ++pc) {
+      const auto& instr = instructions[pc];
+      if (instr.op == Opcode::AllocStorage && freed_regs.count(instr.dst) == 0) {
+        persistent_buffers_[i][pc] = PersistentBuffer();
+      }
+    }
+  }
+}
+
+void VirtualMachine::InitAllocBatches() {
+  alloc_batches_.clear();
+  alloc_batches_.resize(exec_->functions.size());
+  for (size_t i = 0; i < exec_->functions.size(); ++i) {
+    const auto& instructions = exec_->functions[i].instructions;
+    auto batchable = [&](Index pc) {
+      const auto& instr = instructions[pc];
+      if (instr.op != Opcode::AllocStorage) {
+        return false;
+      }
+      if (instr.alloc_storage.alloc_async &&
+          instr.alloc_storage.device_type == DevType::kCUDA()) {
+        return false;
+      }
+      return persistent_buffers_.empty() || persistent_buffers_[i].count(pc) == 0;
+    };
+    Index n = instructions.size();
+    for (Index start = 0; start < n;) {
+      if (!batchable(start)) {
+        ++start;
+        continue;
+      }
+      const auto& first = instructions[start].alloc_storage;
+      Index end = start + 1;
+      while (end < n && batchable(end)) {
+        const auto& next = instructions[end].alloc_storage;
+        if (next.device_type != first.device_type || next.device_id != first.device_id ||
+            next.alignment != first.alignment) {
+          break;
+        }
+        ++end;
+      }
+      if (end - start > 1) {
+        alloc_batches_[i][start] = end - start;
+      }
+      start = end;
+    }
+  }
+}
+
+void VirtualMachine::AllocStorageBatch(VMContext& ctx, Index count) {
+  const auto& first = ctx->code[ctx->pc].alloc_storage;
+  auto dev = Device(first.device_type, first.device_id);
+  std::vector<int64_t> sizes(count);
+  for (Index i = 0; i < count; ++i) {
+    sizes[i] = ctx.LoadScalarInt(ctx->code[ctx->pc + i].alloc_storage.allocation_size);
+  }
+  DLOG(INFO) << "AllocStorage: batch of " << count << " storages on " << dev.c_str();
+
+  std::vector<std::shared_ptr<Memory>> buffers;
+  {
+    VMCounters* counters = ctx->counters.get();
+    utils::ScopedCounterTimer timer(counters ? &counters->alloc_ns : nullptr);
+    if (counters != nullptr) {
+      counters->num_allocs += count;
+    }
+    buffers = memory_pool::Memory::AllocBatch(dev, sizes, first.alignment);
+  }
+  bool profiling = memory_profiler::MemoryProfiler::Get()->IsProfiling();
+  for (Index i = 0; i < count; ++i) {
+    if (profiling) {
+      ProfileAllocation(ctx, buffers[i], sizes[i]);
+    }
+    ctx.WriteRegister(ctx->code[ctx->pc].dst, StorageValue::make(buffers[i], sizes[i]));
+    ctx->pc++;
+  }
 }
 
-void VirtualMachine::HandleIf(VMContext& ctx, const Instruction& instr) {
-  int32_t test_val = ctx.LoadTensorInt(instr.if_op.test);
-  int32_t target_val = ctx.LoadScalarInt(instr.if_op.target);
-
-  if (test_val == target_val) {
-    CHECK_NE(instr.if_op.true_offset, 0);
-    ctx->pc += instr.if_op.true_offset;
-  } else {
-    CHECK_NE(instr.if_op.false_offset, 0);
-    ctx->pc += instr.if_op.false_offset;
+std::shared_ptr<Memory> VirtualMachine::GetPersistentBuffer(const VMContext& ctx, Device dev,
+                                                            int64_t nbytes, int64_t alignment) {
+  if (!persistent_storage_) {
+    return nullptr;
+  }
+  auto& buffers = persistent_buffers_[ctx->func_index];
+  auto it = buffers.find(ctx->pc);
+  if (it == buffers.end()) {
+    return nullptr;
   }
+  std::lock_guard<std::mutex> lock(persistent_mutex_);
+  auto& buffer = it->second;
+  // The buffer cannot be overwritten if it is still held by the outputs of the previous execution
+  // or by another context.
+  if (buffer.memory == nullptr || buffer.memory.use_count() > 1 || buffer.memory->device != dev ||
+      buffer.nbytes < nbytes) {
+    buffer.memory = Alloc(ctx, dev, nbytes, alignment, false);
+    buffer.nbytes = nbytes;
+  }
+  return buffer.memory;
 }
 
 void VirtualMachine::HandleAllocStorage(VMContext& ctx, const Instruction& instr) {
+  if (alloc_batching_ && ctx->dtr == nullptr && !stream_ordered_alloc_) {
+    // The storages tracked by DTR or released in the stream order are allocated one by one.
+    const auto& batches = alloc_batches_[ctx->func_index];
+    auto it = batches.find(ctx->pc);
+    if (it != batches.end()) {
+      AllocStorageBatch(ctx, it->second);
+      return;
+    }
+  }
   auto size = ctx.LoadScalarInt(instr.alloc_storage.allocation_size);
   auto alignment = instr.alloc_storage.alignment;
   bool alloc_async = instr.alloc_storage.alloc_async;
@@ -716,8 +2689,23 @@ void VirtualMachine::HandleAllocStorage(VMContext& ctx, const Instruction& instr
              << " alloc_async=" << alloc_async;
 
   auto dev = Device(instr.alloc_storage.device_type, instr.alloc_storage.device_id);
-  auto buffer = Alloc(ctx, dev, size, alignment, alloc_async);
-  auto storage = StorageValue::make(buffer);
+  if (stream_ordered_alloc_) {
+    // Recycle the deferred memory that is no longer used by any stream before allocating more.
+    ReclaimDeferredMemory(ctx, false);
+  }
+  auto buffer = GetPersistentBuffer(ctx, dev, size, alignment);
+  bool persistent = buffer != nullptr;
+  if (!persistent) {
+    buffer = Alloc(ctx, dev, size, alignment, alloc_async);
+  } else if (memory_profiler::MemoryProfiler::Get()->IsProfiling()) {
+    // A reused persistent buffer is still live since the previous execution, so it is only
+    // recorded if it has not been tracked yet.
+    ProfileAllocation(ctx, buffer, size);
+  }
+  auto storage = StorageValue::make(buffer, size);
+  if (ctx->dtr != nullptr && !persistent) {
+    ctx->dtr->TrackStorage(storage, dev, alignment);
+  }
   ctx.WriteRegister(instr.dst, storage);
   ctx->pc++;
 }
@@ -730,12 +2718,19 @@ void VirtualMachine::HandleAllocTensor(VMContext& ctx, const Instruction& instr)
 
   auto storage_obj = ctx.ReadRegister(instr.alloc_tensor.storage);
   auto storage = Downcast<StorageValue>(storage_obj);
+  if (ctx->dtr != nullptr) {
+    ctx->dtr->Touch(storage);
+  }
   std::shared_ptr<memory_pool::Memory> mem = nullptr;
   if (instr.alloc_tensor.own) {
     mem = storage->buffer;
   }
-  auto tensor = TensorValue::Assemble(storage->buffer->device, instr.alloc_tensor.dtype, shape, {},
-                                      storage->buffer->data, mem);
+  void* data = static_cast<char*>(storage->buffer->data) + instr.alloc_tensor.offset;
+  auto tensor =
+      TensorValue::Assemble(storage->buffer->device, instr.alloc_tensor.dtype, shape, {}, data, mem);
+  if (ctx->dtr != nullptr) {
+    ctx->dtr->AddView(storage, tensor);
+  }
   ctx.WriteRegister(instr.dst, tensor);
   ctx->pc++;
 }
@@ -750,22 +2745,56 @@ void VirtualMachine::HandleAllocTensorReg(VMContext& ctx, const Instruction& ins
 
   auto storage_obj = ctx.ReadRegister(instr.alloc_tensor_reg.storage);
   auto storage = Downcast<StorageValue>(storage_obj);
+  if (ctx->dtr != nullptr) {
+    ctx->dtr->Touch(storage);
+  }
   std::shared_ptr<memory_pool::Memory> mem = nullptr;
   if (instr.alloc_tensor_reg.own) {
     mem = storage->buffer;
   }
-  auto tensor = TensorValue::Assemble(storage->buffer->device, instr.alloc_tensor_reg.dtype, shape,
-                                      {}, storage->buffer->data, mem);
+  void* data = static_cast<char*>(storage->buffer->data) + instr.alloc_tensor_reg.offset;
+
+  // The memory plan may place a dynamic tensor in the storage of another dynamic tensor whose size
+  // is symbolically no smaller. If the storage turns out to be insufficient at runtime, then the
+  // tensor falls back to its own buffer.
+  const auto& dtype = instr.alloc_tensor_reg.dtype;
+  int64_t nbytes = (dtype.bits * dtype.lanes + 7) / 8;
+  for (auto dim : shape) {
+    nbytes *= dim;
+  }
+  bool fallback = storage->size >= 0 && instr.alloc_tensor_reg.offset + nbytes > storage->size;
+  if (fallback) {
+    DLOG(INFO) << "AllocTensorReg: storage of " << storage->size << " bytes is insufficient for "
+               << nbytes << " bytes, allocate a new buffer";
+    mem = Alloc(ctx, storage->buffer->device, nbytes, kDefaultMemoryAlignment, false);
+    data = mem->data;
+  }
+  auto tensor = TensorValue::Assemble(storage->buffer->device, dtype, shape, {}, data, mem);
+  if (ctx->dtr != nullptr && !fallback) {
+    ctx->dtr->AddView(storage, tensor);
+  }
   ctx.WriteRegister(instr.dst, tensor);
   ctx->pc++;
 }
 
 void VirtualMachine::HandleAllocTuple(VMContext& ctx, const Instruction& instr) {
-  Array<Value> fields;
-  for (Index i = 0; i < instr.alloc_tuple.num_fields; ++i) {
-    fields.push_back(ctx.ReadRegister(instr.alloc_tuple.fields[i]));
+  Index num_fields = instr.alloc_tuple.num_fields;
+  const Value& reg = ctx.ReadRegister(instr.dst);
+  auto* tuple = reg.unique() ? const_cast<TupleValueObj*>(reg.as<TupleValueObj>()) : nullptr;
+  if (tuple != nullptr && tuple->fields.unique() &&
+      tuple->fields.size() == static_cast<size_t>(num_fields)) {
+    // Refill the tuple kept by the recycled frame in place.
+    for (Index i = 0; i < num_fields; ++i) {
+      tuple->fields.Set(i, ctx.ReadRegister(instr.alloc_tuple.fields[i]));
+    }
+  } else {
+    Array<Value> fields;
+    fields.reserve(num_fields);
+    for (Index i = 0; i < num_fields; ++i) {
+      fields.push_back(ctx.ReadRegister(instr.alloc_tuple.fields[i]));
+    }
+    ctx.WriteRegister(instr.dst, TupleValue::make(fields));
   }
-  ctx.WriteRegister(instr.dst, TupleValue::make(fields));
   ctx->pc++;
 }
 
@@ -782,28 +2811,65 @@ void VirtualMachine::HandleAllocClosure(VMContext& ctx, const Instruction& instr
 void VirtualMachine::HandleFree(VMContext& ctx, const Instruction& instr) {
   RegName reg = instr.free.memory;
   auto reg_val = ctx.ReadRegister(reg);
+  if (ctx->dtr != nullptr) {
+    ctx->dtr->Release(reg_val);
+  }
   if (reg_val->IsInstance<StorageValueObj>()) {
     auto storage_val = Downcast<StorageValue>(reg_val);
-    storage_val->buffer.reset();
+    ReleaseMemory(ctx, &storage_val->buffer);
   } else {
     CHECK(reg_val->IsInstance<TensorValueObj>())
         << "Expected StorageValue or TensorValue, but got " << reg_val->GetTypeKey();
     auto tensor_val = Downcast<TensorValue>(reg_val);
-    tensor_val->mem.reset();
+    ReleaseMemory(ctx, &tensor_val->mem);
+  }
+  ctx->pc++;
+}
+
+void VirtualMachine::HandleKillRegister(VMContext& ctx, const Instruction& instr) {
+  VMFrame& frame = ctx->frames.back();
+  // The constants are kept in their registers for the next call.
+  if (!frame.is_const[instr.dst]) {
+    Value& reg = frame.register_file[instr.dst];
+    if (ctx->in_fork && reg.defined()) {
+      // Keep the value until the join, since the kernels of the fork may still be using it.
+      ctx->fork_values.push_back(reg);
+    }
+    ReleaseRegister(&reg);
   }
   ctx->pc++;
 }
 
 void VirtualMachine::HandleInvokeFunc(VMContext& ctx, const Instruction& instr) {
+  if (ctx->cpu_lane >= 0) {
+    RunCpuLanes(ctx);
+  }
+  if (fork_plan_.empty() || !use_cuda_) {
+    // The arguments are copied from the registers of the caller to the callee directly.
+    ctx.PushFrame(instr.invoke_func.func_index, nullptr, instr.invoke_func.args,
+                  instr.invoke_func.num_args, instr.dst);
+    return;
+  }
   std::vector<Value> args;
   for (Index i = 0; i < instr.invoke_func.num_args; ++i) {
     args.push_back(ctx.ReadRegister(instr.invoke_func.args[i]));
   }
-  ctx.PushFrame(instr.invoke_func.func_index, args, instr.dst);
+  if (!ForkCall(ctx, instr.invoke_func.func_index, args, instr.dst)) {
+    ctx.PushFrame(instr.invoke_func.func_index, args, instr.dst);
+  }
 }
 
 void VirtualMachine::HandleInvokeClosure(VMContext& ctx, const Instruction& instr) {
+  if (ctx->cpu_lane >= 0) {
+    RunCpuLanes(ctx);
+  }
   auto closure = Downcast<VMClosureValue>(ctx.ReadRegister(instr.invoke_closure.closure));
+  if (fork_plan_.empty() || !use_cuda_) {
+    // The free variables and the arguments are written to the callee without concatenation.
+    ctx.PushFrame(closure->func_index, &closure->free_vars, instr.invoke_closure.args,
+                  instr.invoke_closure.num_args, instr.dst);
+    return;
+  }
   std::vector<Value> args;
   for (auto free_var : closure->free_vars) {
     args.push_back(free_var);
@@ -811,49 +2877,120 @@ void VirtualMachine::HandleInvokeClosure(VMContext& ctx, const Instruction& inst
   for (Index i = 0; i < instr.invoke_closure.num_args; ++i) {
     args.push_back(ctx.ReadRegister(instr.invoke_closure.args[i]));
   }
-  ctx.PushFrame(closure->func_index, args, instr.dst);
+  if (!ForkCall(ctx, closure->func_index, args, instr.dst)) {
+    ctx.PushFrame(closure->func_index, args, instr.dst);
+  }
 }
 
 void VirtualMachine::HandleInvokeJit(VMContext& ctx, const Instruction& instr) {
+  InvokeJit(ctx, instr, ResolveJitOperands(ctx->func_index, ctx->pc));
+}
+
+VirtualMachine::JitOperands VirtualMachine::ResolveJitOperands(Index func_index, Index pc) {
+  JitOperands operands;
+  operands.func_op_env_cache = op_env_cache_[func_index].get();
+  if (serving_mode_) {
+    operands.op_env_lock = &op_env_locks_[(func_index * 31 + pc) % op_env_locks_.size()];
+  }
+  return operands;
+}
+
+void VirtualMachine::InvokeJit(VMContext& ctx, const Instruction& instr,
+                               const JitOperands& operands) {
+  std::unique_lock<std::mutex> op_env_lock;
+  if (operands.op_env_lock != nullptr) {
+    // The OpEnvs are shared by all contexts, so the same instruction is not executed concurrently.
+    op_env_lock = std::unique_lock<std::mutex>(*operands.op_env_lock);
+  }
   OpEnvPtr op_env;
   std::vector<Value> inputs;
   Value output;
   std::string op_env_cache_key;
 
-  std::tie(op_env, inputs, output, op_env_cache_key) = PrepareOpEnv(ctx, instr);
+  if (ctx->dtr != nullptr) {
+    // The OpEnv reads the data pointers of the arguments, so they are rematerialized first.
+    Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
+    std::vector<Value> args, outs;
+    for (Index i = 0; i < instr.invoke_jit.arity; ++i) {
+      (i < num_inputs ? args : outs).push_back(ctx.ReadRegister(instr.invoke_jit.args[i]));
+    }
+    ctx->dtr->BeforeOp(args, outs);
+  }
+  {
+    VMCounters* counters = ctx->counters.get();
+    utils::ScopedCounterTimer timer(counters ? &counters->prepare_op_env_ns : nullptr);
+    std::tie(op_env, inputs, output, op_env_cache_key) = PrepareJitOpEnv(ctx, instr, operands);
+  }
+  if (ctx->frozen_plan != nullptr) {
+    RecordFrozenStep(ctx, instr, op_env, inputs, output);
+  }
+  if (!exec_->op_work.empty() && raf::profiler::Profiler::Get()->IsProfiling(1)) {
+    utils::RecordOpWork(exec_, ctx, op_env.get());
+  }
   if (!dryrun_) {  // Skip the execution in dryrun mode
+    RAF_NVTX_RANGE(kOp, op_env->name() + " " + op_env_cache_key);
 #ifdef RAF_USE_CUDA
+    if (ctx->capture_stream != nullptr) {
+      // The OpEnvs with their own streams, e.g., the NCCL collectives, launch to the captured
+      // streams.
+      for (const auto& entry : op_env->GetRequests()->stream) {
+        ForkCaptureStream(ctx, *entry.dest);
+      }
+    }
     if (use_cuda_) {
       WITH_CUDA_PROFILER(
           devices_[0],
           utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data(),
-          op_env->name(), utils::GetStreamName(ctx->current_stream_id), {op_env_cache_key},
-          { op_env->Execute(inputs, output); });
+          op_env->name(), utils::GetStreamName(ctx->current_stream_id), {op_env_cache_key}, {
+            WITH_CUPTI_TRACE(ctx->func_index, ctx->pc, op_env->name(),
+                             { op_env->Execute(inputs, output); });
+          });
     } else
 #endif
-    {  // cpu
+    if (ctx->cpu_lane >= 0) {
+      // Defer the op to its lane, and keep the workspace until the lanes of the wave finish.
+      ctx->cpu_lanes[ctx->cpu_lane].push_back(
+          [op_env, inputs, output]() { op_env->Execute(inputs, output); });
+      ctx->cpu_wave_op_envs.push_back(op_env);
+      ctx->pc++;
+      return;
+    } else {  // cpu
       WITH_BASE_PROFILER(devices_[0], op_env->name(), "ComputationOperator", {op_env_cache_key},
                          { op_env->Execute(inputs, output); });
     }
   }
-  PROFILE_MEMORY(devices_[0], op_env->name());
-
-  // Release workspace memory.
-  // TODO(yaoyaoding): It seems that we can not release the workspace once we launched the
-  //   kernel. Because the kernel may be in the executing status at this point due to
-  //   asynchronous execution. This would cause problem for multi-stream execution.
-  std::shared_ptr<Requests> requests = op_env->GetRequests();
-  for (size_t i = 0; i < requests->workspace.size(); ++i) {
-    Requests::WorkspaceRequest& entry = requests->workspace[i];
-    if (entry.nbytes > 0 && entry.memory != nullptr) {
-      *entry.dest = nullptr;
-      entry.memory.reset();
+  if (ctx->dtr != nullptr) {
+    // The ops with side effects, e.g., the collectives, cannot be replayed.
+    std::shared_ptr<Requests> requests = op_env->GetRequests();
+    bool recomputable = requests->distributed.empty() && requests->stream.empty();
+    if (const auto* op = ctx.ReadRegister(instr.invoke_jit.op_reg).as<OpValueObj>()) {
+      recomputable &= !GetOpAttrOrDefault<TRAFSideEffect>(op->op, "TRAFSideEffect", false) &&
+                      !GetOpAttrOrDefault<TRAFCollective>(op->op, "TRAFCollective", false);
     }
+    ctx->dtr->AfterOp(op_env, inputs, output, recomputable);
   }
+  PROFILE_MEMORY(devices_[0], op_env->name());
+  ReleaseWorkspace(ctx, op_env);
   ctx->pc++;
 }
 
+void VirtualMachine::RunCpuLanes(VMContext& ctx) {
+  CpuLaneExecutor::Global()->Run(ctx->cpu_lanes);
+  for (auto& lane : ctx->cpu_lanes) {
+    lane.clear();
+  }
+  for (const auto& op_env : ctx->cpu_wave_op_envs) {
+    ReleaseWorkspace(ctx, op_env);
+  }
+  ctx->cpu_wave_op_envs.clear();
+  ctx->cpu_wave_buffers.clear();
+  ctx->cpu_lane = -1;
+}
+
 void VirtualMachine::HandleSetShape(VMContext& ctx, const Instruction& instr) {
+  if (ctx->cpu_lane >= 0) {
+    RunCpuLanes(ctx);
+  }
   auto data = Downcast<TensorValue>(ctx.ReadRegister(instr.set_shape.data));
   auto raw_shape = ctx.ReadRegister(instr.set_shape.shape);
   std::vector<int64_t> shape;
@@ -865,12 +3002,23 @@ void VirtualMachine::HandleSetShape(VMContext& ctx, const Instruction& instr) {
     raw_shape = CopyTo(raw_shape, Device(DevType::kCPU(), 0));
     shape = common::shape_utils::GetShapeVecFromData(raw_shape);
   }
-  ctx.WriteRegister(instr.dst, data.CreateView(shape));
+  auto view = data.CreateView(shape);
+  if (ctx->dtr != nullptr) {
+    ctx->dtr->AddAlias(data, view);
+  }
+  ctx.WriteRegister(instr.dst, view);
   ctx->pc++;
 }
 
 bool VirtualMachine::HandleRet(VMContext& ctx, const Instruction& instr) {
+  if (ctx->cpu_lane >= 0) {
+    RunCpuLanes(ctx);
+  }
   auto ret_val = ctx.ReadRegister(instr.result);
+  if (ctx->in_fork && ctx->frames.size() == ctx->fork_frame_depth) {
+    ReturnFromFork(ctx, ret_val);
+    return false;
+  }
   auto caller_return_register = ctx.PopFrame();
   if (caller_return_register < 0) {
     // We have hit the point from which we started running, we should return to the caller breaking
@@ -883,13 +3031,204 @@ bool VirtualMachine::HandleRet(VMContext& ctx, const Instruction& instr) {
   }
 }
 
+void VirtualMachine::BuildForkPlan() {
+  fork_plan_.resize(exec_->functions.size());
+  func_uses_streams_.assign(exec_->functions.size(), false);
+  for (size_t f = 0; f < exec_->functions.size(); ++f) {
+    const auto& code = exec_->functions[f].instructions;
+    fork_plan_[f].assign(code.size(), kNoFork);
+    // The forked calls of the current run and the registers written by them.
+    std::vector<size_t> run;
+    std::unordered_set<RegName> run_dsts;
+    auto close_run = [&]() {
+      // A single call is not worth forking.
+      if (run.size() >= 2) {
+        for (size_t pc : run) {
+          fork_plan_[f][pc] = kFork;
+        }
+        fork_plan_[f][run.back()] = kForkAndJoin;
+      }
+      run.clear();
+      run_dsts.clear();
+    };
+    auto reads_run = [&](const RegName* regs, Index num_regs) {
+      for (Index i = 0; i < num_regs; ++i) {
+        if (run_dsts.count(regs[i])) {
+          return true;
+        }
+      }
+      return false;
+    };
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+      const Instruction& instr = code[pc];
+      switch (instr.op) {
+        case Opcode::InvokeFunc:
+        case Opcode::InvokeClosure: {
+          bool dependent =
+              instr.op == Opcode::InvokeFunc
+                  ? reads_run(instr.invoke_func.args, instr.invoke_func.num_args)
+                  : (run_dsts.count(instr.invoke_closure.closure) ||
+                     reads_run(instr.invoke_closure.args, instr.invoke_closure.num_args));
+          if (dependent || run_dsts.count(instr.dst)) {
+            close_run();
+          }
+          run.push_back(pc);
+          run_dsts.insert(instr.dst);
+          break;
+        }
+        case Opcode::AllocClosure:
+        case Opcode::LoadConst:
+        case Opcode::LoadConsti:
+        case Opcode::Move:
+        case Opcode::KillRegister: {
+          // The host instructions are kept in the run unless they touch the results of the run.
+          bool touches = run_dsts.count(instr.dst) > 0;
+          if (instr.op == Opcode::AllocClosure) {
+            touches |= reads_run(instr.alloc_closure.free_vars, instr.alloc_closure.num_free_vars);
+          } else if (instr.op == Opcode::Move) {
+            touches |= run_dsts.count(instr.from) > 0;
+          }
+          if (touches) {
+            close_run();
+          }
+          break;
+        }
+        case Opcode::CudaSetStream:
+        case Opcode::CudaAddEvent:
+        case Opcode::CudaWaitEvent:
+        case Opcode::CudaStreamBarrier:
+          func_uses_streams_[f] = true;
+          close_run();
+          break;
+        default:
+          close_run();
+          break;
+      }
+    }
+    close_run();
+  }
+  // A function also switches streams if any function it calls does.
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (size_t f = 0; f < exec_->functions.size(); ++f) {
+      for (const auto& instr : exec_->functions[f].instructions) {
+        if (!func_uses_streams_[f] && instr.op == Opcode::InvokeFunc &&
+            func_uses_streams_[instr.invoke_func.func_index]) {
+          func_uses_streams_[f] = true;
+          changed = true;
+        }
+      }
+    }
+  }
+}
+
+bool VirtualMachine::ForkCall(VMContext& ctx, Index func_index, const std::vector<Value>& args,
+                              RegName dst) {
+  if (fork_plan_.empty() || !use_cuda_) {
+    return false;
+  }
+  int8_t plan = fork_plan_[ctx->func_index][ctx->pc];
+  if (plan == kNoFork || ctx->in_fork || ctx->current_stream_id != 0 ||
+      func_uses_streams_[func_index]) {
+    // The call runs inline on the current stream, after the pending forks.
+    if (!ctx->join_events.empty()) {
+      JoinForks(ctx);
+    }
+    return false;
+  }
+  Index device_id = ctx->current_device_id;
+  Device device(DevType::kCUDA(), static_cast<int>(device_id));
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  if (ctx->join_events.empty()) {
+    // The forks of a run start after the work issued to the parent stream so far.
+    ctx->fork_event = EventPool::Get(device)->GetEvent(event_pool::kEventDisableTiming);
+    api->EventRecordOnStream(ctx->fork_event->data(),
+                             utils::GetStreamById(ctx, device_id, 0)->data());
+  }
+  Index stream_id = kForkStreamIdBase + ctx->join_events.size() % kNumForkStreams;
+  auto stream = utils::GetStreamById(ctx, device_id, stream_id);
+  api->StreamWaitEvent(stream->data(), ctx->fork_event->data());
+  OpEnv::SetStreamForAllBackends(device, stream->data());
+  ctx->current_stream_id = stream_id;
+  ctx.PushFrame(func_index, args, dst);
+  ctx->in_fork = true;
+  ctx->fork_frame_depth = ctx->frames.size();
+  ctx->join_after_fork = plan == kForkAndJoin;
+  return true;
+}
+
+void VirtualMachine::ReturnFromFork(VMContext& ctx, const Value& ret_val) {
+  Index device_id = ctx->current_device_id;
+  Device device(DevType::kCUDA(), static_cast<int>(device_id));
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  auto event = EventPool::Get(device)->GetEvent(event_pool::kEventDisableTiming);
+  api->EventRecordOnStream(
+      event->data(), utils::GetStreamById(ctx, device_id, ctx->current_stream_id)->data());
+  ctx->join_events.push_back(std::move(event));
+  // The kernels of the fork may still be using the registers of its frame.
+  const VMFrame& frame = ctx->frames.back();
+  for (size_t i = 0; i < frame.register_file.size(); ++i) {
+    if (!frame.is_const[i] && frame.register_file[i].defined()) {
+      ctx->fork_values.push_back(frame.register_file[i]);
+    }
+  }
+  auto caller_return_register = ctx.PopFrame();
+  ctx.WriteRegister(caller_return_register, ret_val);
+  ctx->in_fork = false;
+  ctx->current_stream_id = 0;
+  OpEnv::SetStreamForAllBackends(device, utils::GetStreamById(ctx, device_id, 0)->data());
+  if (ctx->join_after_fork) {
+    JoinForks(ctx);
+  }
+}
+
+void VirtualMachine::JoinForks(VMContext& ctx) {
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  void* parent = utils::GetStreamById(ctx, ctx->current_device_id, 0)->data();
+  for (const auto& event : ctx->join_events) {
+    api->StreamWaitEvent(parent, event->data());
+  }
+  // The work issued to the parent stream from now on is ordered after the forks, so what they
+  // kept can be reused by it.
+  ctx->join_events.clear();
+  ctx->fork_event = nullptr;
+  ctx->fork_values.clear();
+  ctx->fork_buffers.clear();
+}
+
 void VirtualMachine::HandleInferType(VMContext& ctx, const Instruction& instr) {
+  if (ctx->cpu_lane >= 0) {
+    RunCpuLanes(ctx);
+  }
   Array<Value> args;
   for (Index i = 0; i < instr.infer_type.num_args; i++) {
     args.push_back(ctx.ReadRegister(instr.infer_type.args[i]));
   }
-  // infer type
   const Value& callee = ctx.ReadRegister(instr.infer_type.op_reg);
+  // The inferred types of each instruction are memoized by the callee and the argument signatures,
+  // so the repeated dynamic shapes skip the type inference.
+  HashKey hash_key;
+  bool memoizable = true;
+  if (const auto* opv = callee.as<OpValueObj>()) {
+    hash_key << opv->op->name;
+  } else {
+    hash_key << reinterpret_cast<int64_t>(callee.as<ClosureValueObj>()->func.get());
+  }
+  for (const auto& arg : args) {
+    memoizable = memoizable && utils::InferTypeArgSignature(&hash_key, arg);
+  }
+  std::string key(hash_key.byte_vector.begin(), hash_key.byte_vector.end());
+  if (memoizable) {
+    std::lock_guard<std::mutex> lock(infer_type_mutex_);
+    auto& pc_cache = infer_type_cache_[ctx->func_index][ctx->pc];
+    auto it = pc_cache.find(key);
+    if (it != pc_cache.end()) {
+      ctx.WriteRegister(instr.dst, it->second);
+      ctx->pc++;
+      return;
+    }
+  }
+  // infer type
   Type ret_type;
   Array<Value> ret_tup;
   if (const auto* opv = callee.as<OpValueObj>()) {
@@ -929,15 +3268,41 @@ void VirtualMachine::HandleInferType(VMContext& ctx, const Instruction& instr) {
   } else {
     LOG(FATAL) << "Unknown type " << ret_type->_type_key;
   }
-  ctx.WriteRegister(instr.dst, TupleValue::make(ret_tup));
+  Value ret = TupleValue::make(ret_tup);
+  if (memoizable) {
+    std::lock_guard<std::mutex> lock(infer_type_mutex_);
+    auto& pc_cache = infer_type_cache_[ctx->func_index][ctx->pc];
+    if (pc_cache.size() >= kMaxInferTypeCacheEntries) {
+      // Too many distinct shapes at this instruction, so start over to bound the memory.
+      pc_cache.clear();
+    }
+    pc_cache.emplace(key, ret);
+  }
+  ctx.WriteRegister(instr.dst, ret);
   ctx->pc++;
 }
 
 void VirtualMachine::HandleCudaSetStream(VMContext& ctx, const Instruction& instr) {
+  if (ctx->frozen_plan != nullptr) {
+    RecordFrozenStep(ctx, instr);
+  }
   Index device_id = instr.cuda_set_stream.device_id;
   Index stream_id = instr.cuda_set_stream.stream_id;
+  if (!use_cuda_) {
+    // On CPU, the streams are the lanes of the ops run concurrently at the end of the wave. The
+    // OpEnvs shared by the serving contexts are not executed out of their locks.
+    if (!dryrun_ && !serving_mode_ && ctx->frozen_plan == nullptr) {
+      ctx->cpu_lane = stream_id;
+      if (ctx->cpu_lanes.size() <= static_cast<size_t>(stream_id)) {
+        ctx->cpu_lanes.resize(stream_id + 1);
+      }
+    }
+    ctx->pc++;
+    return;
+  }
   Device device(DevType::kCUDA(), static_cast<int>(device_id));
-  auto stream = utils::GetStreamById(ctx, device_id, stream_id);
+  auto stream = utils::GetStreamById(ctx, device_id, stream_id, instr.cuda_set_stream.priority);
+  ForkCaptureStream(ctx, stream->data());
   OpEnv::SetStreamForAllBackends(device, stream->data());
   ctx->current_device_id = device_id;
   ctx->current_stream_id = stream_id;
@@ -945,6 +3310,14 @@ void VirtualMachine::HandleCudaSetStream(VMContext& ctx, const Instruction& inst
 }
 
 void VirtualMachine::HandleCudaAddEvent(VMContext& ctx, const Instruction& instr) {
+  if (ctx->frozen_plan != nullptr) {
+    RecordFrozenStep(ctx, instr);
+  }
+  if (!use_cuda_) {
+    // The lanes of a wave only depend on the previous waves, which are finished by the barrier.
+    ctx->pc++;
+    return;
+  }
   Index device_id = ctx->current_device_id;
   Index stream_id = instr.cuda_event.stream_id;
   if (stream_id == -1) {
@@ -955,11 +3328,22 @@ void VirtualMachine::HandleCudaAddEvent(VMContext& ctx, const Instruction& instr
   auto stream = utils::GetStreamById(ctx, device_id, stream_id);
   auto api = DeviceAPI::Get(DevType::kCUDA());
   Device device(DevType::kCUDA(), static_cast<int>(device_id));
+  ForkCaptureStream(ctx, stream->data());
   api->EventRecordOnStream(event->data(), stream->data());
   ctx->pc++;
 }
 
 void VirtualMachine::HandleCudaWaitEvent(VMContext& ctx, const Instruction& instr) {
+  if (ctx->frozen_plan != nullptr) {
+    RecordFrozenStep(ctx, instr);
+  }
+  if (!use_cuda_) {
+    if (ctx->cpu_lane >= 0) {
+      RunCpuLanes(ctx);
+    }
+    ctx->pc++;
+    return;
+  }
   Index device_id = ctx->current_device_id;
   Index stream_id = instr.cuda_event.stream_id;
   if (instr.cuda_event.stream_id == -1) {
@@ -969,16 +3353,34 @@ void VirtualMachine::HandleCudaWaitEvent(VMContext& ctx, const Instruction& inst
   auto event = utils::GetEventById(ctx, device_id, event_id);
   auto stream = utils::GetStreamById(ctx, device_id, stream_id);
   auto api = DeviceAPI::Get(DevType::kCUDA());
+  ForkCaptureStream(ctx, stream->data());
   api->StreamWaitEvent(stream->data(), event->data());
   ctx->pc++;
 }
 
 void VirtualMachine::HandleCudaStreamBarrier(VMContext& ctx, const Instruction& instr) {
+  if (ctx->frozen_plan != nullptr) {
+    RecordFrozenStep(ctx, instr);
+  }
+  if (!use_cuda_) {
+    if (ctx->cpu_lane >= 0) {
+      RunCpuLanes(ctx);
+    }
+    ctx->pc++;
+    return;
+  }
+  if (ctx->capture_stream != nullptr) {
+    // The legacy default stream cannot be used while capturing, so the barrier is captured as a
+    // join of all the streams followed by a fork.
+    JoinCaptureStreams(ctx);
+    ctx->pc++;
+    return;
+  }
   if (ctx->current_barrier_event_index >= ctx->barrier_events.size()) {
     Device device(DevType::kCUDA(), static_cast<int>(ctx->current_device_id));
     ctx->barrier_events.resize(ctx->current_barrier_event_index + 1);
     ctx->barrier_events[ctx->current_barrier_event_index] =
-        EventPool::Get(device)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+        EventPool::Get(device)->GetEvent(event_pool::kEventDisableTiming);
   }
   auto api = DeviceAPI::Get(DevType::kCUDA());
   /*
@@ -996,13 +3398,108 @@ void VirtualMachine::HandleCudaStreamBarrier(VMContext& ctx, const Instruction&
   ctx->pc++;
 }
 
+void VirtualMachine::ForkCaptureStream(const VMContext& ctx, void* stream) {
+  if (ctx->capture_stream == nullptr || stream == ctx->capture_stream ||
+      std::find(ctx->captured_streams.begin(), ctx->captured_streams.end(), stream) !=
+          ctx->captured_streams.end()) {
+    return;
+  }
+  CHECK(stream != nullptr) << "The legacy default stream cannot be used in CUDA graph capture.";
+  // Waiting for an event recorded by the capture stream brings the stream into the capture.
+  Device device(DevType::kCUDA(), static_cast<int>(ctx->current_device_id));
+  auto event = EventPool::Get(device)->GetEvent(event_pool::kEventDisableTiming);
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  api->EventRecordOnStream(event->data(), ctx->capture_stream);
+  api->StreamWaitEvent(stream, event->data());
+  ctx->captured_streams.push_back(stream);
+}
+
+void VirtualMachine::JoinCaptureStreams(const VMContext& ctx) {
+  Device device(DevType::kCUDA(), static_cast<int>(ctx->current_device_id));
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  for (void* stream : ctx->captured_streams) {
+    auto event = EventPool::Get(device)->GetEvent(event_pool::kEventDisableTiming);
+    api->EventRecordOnStream(event->data(), stream);
+    api->StreamWaitEvent(ctx->capture_stream, event->data());
+  }
+  ctx->captured_streams.clear();
+}
+
 std::tuple<std::shared_ptr<OpEnv>, std::vector<Value>, Value, std::string>
 VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
+  return PrepareJitOpEnv(ctx, instr, ResolveJitOperands(ctx->func_index, ctx->pc));
+}
+
+std::tuple<std::shared_ptr<OpEnv>, std::vector<Value>, Value, std::string>
+VirtualMachine::PrepareJitOpEnv(const VMContext& ctx, const Instruction& instr,
+                                const JitOperands& operands) {
   Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
-  Array<Value> args;
   Value output;
 
+  // Build the binary signature of the non-constant inputs and the outputs, which is compared
+  // against the previous invocation of this instruction without allocating the string key.
+  OpEnvSignature signature;
+  for (Index i = 0; i < num_inputs; i++) {
+    Index reg_idx = instr.invoke_jit.args[i];
+    if (ctx.IsConst(reg_idx)) {
+      continue;
+    }
+    auto reg = ctx.ReadRegister(reg_idx);
+    if (auto tensor = reg.as<TensorValueObj>()) {
+      utils::TensorSignature(&signature, tensor);
+    } else if (auto tup = reg.as<TupleValueObj>()) {
+      // Tensor headers are non-negative, so the negative markers cannot be confused with them.
+      signature.Push(-1);
+      signature.Push(tup->fields.size());
+      for (auto field : tup->fields) {
+        if (auto t = field.as<TensorValueObj>()) {
+          utils::TensorSignature(&signature, t);
+        } else {
+          signature.Push(-2);
+        }
+      }
+    } else {
+      LOG(FATAL) << "Unsupported non-const register type: " << reg->GetTypeKey();
+    }
+  }
+  if (instr.invoke_jit.output_size == 1) {
+    output = ctx.ReadRegister(instr.invoke_jit.args[num_inputs]);
+    utils::TensorSignature(&signature, output.as<TensorValueObj>());
+  } else {
+    Array<Value> outs;
+    for (Index i = num_inputs; i < instr.invoke_jit.arity; i++) {
+      Value val = ctx.ReadRegister(instr.invoke_jit.args[i]);
+      outs.push_back(val);
+      utils::TensorSignature(&signature, val.as<TensorValueObj>());
+    }
+    output = TupleValue::make(outs);
+  }
+
+  // The string key is only used by the profiler on the fast path.
+  std::string op_env_cache_key;
+  bool need_key = raf::profiler::Profiler::Get()->IsProfiling(1) || RAF_NVTX_ENABLED();
+  static auto* fast_hits = utils::OpEnvCacheCounter("fast_hit");
+  static auto* hits = utils::OpEnvCacheCounter("hit");
+  static auto* misses = utils::OpEnvCacheCounter("miss");
+  VMFuncOpEnvCache* func_op_env_cache = operands.func_op_env_cache;
+  std::shared_ptr<OpEnv> op_env =
+      func_op_env_cache->GetLast(ctx->pc, signature, need_key ? &op_env_cache_key : nullptr);
+  if (op_env != nullptr) {
+    // Fast path: the shapes match the previous invocation, so the inputs are read from the
+    // registers directly.
+    std::vector<Value> inputs;
+    inputs.reserve(op_env->arg_indices.size());
+    for (int i : op_env->arg_indices) {
+      CHECK(i >= 0 && i < num_inputs) << "Invalid input index: " << i;
+      inputs.push_back(ctx.ReadRegister(instr.invoke_jit.args[i]));
+    }
+    PrepareWorkspace(ctx, op_env);
+    fast_hits->Inc();
+    return std::make_tuple(op_env, std::move(inputs), std::move(output), op_env_cache_key);
+  }
+
   // extract the input args and prepare the hash key to query op env
+  Array<Value> args;
   std::ostringstream os;
   for (Index i = 0; i < num_inputs; i++) {
     Index reg_idx = instr.invoke_jit.args[i];
@@ -1024,8 +3521,6 @@ VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
         os << ",";
       }
       os << ")";
-    } else {
-      LOG(FATAL) << "Unsupported non-const register type: " << reg->GetTypeKey();
     }
     os << ",";
   }
@@ -1033,30 +3528,31 @@ VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
   // extract the output
   os << "|";
   if (instr.invoke_jit.output_size == 1) {
-    output = ctx.ReadRegister(instr.invoke_jit.args[num_inputs]);
     utils::TensorRepr(os, output.as<TensorValueObj>());
   } else {
     os << "(";
-    Array<Value> outs;
-    for (Index i = num_inputs; i < instr.invoke_jit.arity; i++) {
-      Value val = ctx.ReadRegister(instr.invoke_jit.args[i]);
-      outs.push_back(val);
+    for (const auto& val : Downcast<TupleValue>(output)->fields) {
       utils::TensorRepr(os, val.as<TensorValueObj>());
       os << ",";
     }
     os << ")";
-    output = TupleValue::make(outs);
   }
-  std::string op_env_cache_key = os.str();
+  op_env_cache_key = os.str();
 
   // check the OpEnv cache
-  std::shared_ptr<OpEnv> op_env;
-  auto op_env_cache = op_env_cache_[ctx->func_index]->Get(ctx->pc);
+  std::shared_ptr<OpEnvCache> looked_up_cache;
+  OpEnvCache* op_env_cache = operands.op_env_cache;
+  if (op_env_cache == nullptr) {
+    looked_up_cache = func_op_env_cache->Get(ctx->pc);
+    op_env_cache = looked_up_cache.get();
+  }
   if (auto p = op_env_cache->Get(op_env_cache_key)) {
     // Cache hit. Reuse the OpEnv from the cache.
     op_env = *p;
+    hits->Inc();
   } else {
     // Create a new OpEnv.
+    misses->Inc();
     auto call_values = CallValues::make();
     Value callee = ctx.ReadRegister(instr.invoke_jit.op_reg);
     const auto* op = callee.as<OpValueObj>();
@@ -1069,24 +3565,42 @@ VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
     }
     call_values->device = devices_[0];
     call_values->out = output;
-    op_env = Dispatch(call_values);
+    // Build time of the kernels (e.g., TVM builds, cuDNN/CUTLASS tuning), named after the op or
+    // the dialect of the fused function.
+    std::string jit_name;
+    if (op) {
+      jit_name = op->op->name;
+    } else {
+      auto dialect = closure->func->GetAttr<String>(attr::kDialect, String("tvm")).value();
+      jit_name = "raf.op." + std::string(dialect) + "._fused_op";
+    }
+    WITH_BASE_PROFILER(devices_[0], jit_name, "JIT", {}, { op_env = Dispatch(call_values); });
     CHECK(op_env != nullptr) << "ValueError: Cannot dispatch "
                              << (op ? op->op->name : PrettyPrint(closure->func)) << " @"
                              << call_values->device.c_str();
     std::shared_ptr<Requests> requests = op_env->GetRequests();
+    // A collective launched on a communication stream (see EnforceSync) uses the communicators
+    // of the stream. The OpEnvs are cached per instruction, so the lane never changes.
+    int comm_lane = use_cuda_ ? CommStreamLane(ctx->current_stream_id) : -1;
     // prepare distributed requests
     for (size_t i = 0; i < requests->distributed.size(); i++) {
       Requests::DistributedRequest& entry = requests->distributed[i];
-      *entry.dest = (void*)(Communicator::Get(entry.name, entry.rank_list).as<CommunicatorObj>());
+      *entry.dest = (void*)(Communicator::Get(entry.name, entry.rank_list, std::max(comm_lane, 0))
+                                .as<CommunicatorObj>());
     }
 #ifdef RAF_USE_CUDA
     // prepare cuda stream requests
     for (size_t i = 0; i < requests->stream.size(); i++) {
       Requests::StreamRequest& entry = requests->stream[i];
       // currently ignores the stream_idx field in requests, all requests with the same tag_idx will
-      // get the same cuda stream in vm
+      // get the same cuda stream in vm, except that the communication requests get the current
+      // communication stream
+      Index stream_id = entry.tag_idx;
+      if (entry.tag_idx == StreamTagEnum::CudaCommunicate() && comm_lane >= 0) {
+        stream_id = ctx->current_stream_id;
+      }
       std::shared_ptr<Stream> stream =
-          utils::GetStreamById(ctx, entry.device.device_id(), entry.tag_idx);
+          utils::GetStreamById(ctx, entry.device.device_id(), stream_id);
       *entry.dest = stream->data();
       entry.stream = stream;
     }
@@ -1094,14 +3608,8 @@ VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
     // add to cache
     op_env_cache->Set(op_env_cache_key, op_env);
   }
-
-  std::shared_ptr<Requests> requests = op_env->GetRequests();
-  for (size_t i = 0; i < requests->workspace.size(); i++) {
-    Requests::WorkspaceRequest& entry = requests->workspace[i];
-    auto buf = Alloc(ctx, entry.device, entry.nbytes);
-    entry.memory = buf;
-    *entry.dest = buf->data;
-  }
+  func_op_env_cache->SetLast(ctx->pc, signature, op_env, op_env_cache_key);
+  PrepareWorkspace(ctx, op_env);
 
   std::vector<Value> inputs;
   for (int i : op_env->arg_indices) {
@@ -1111,9 +3619,184 @@ VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
   return std::make_tuple(op_env, std::move(inputs), std::move(output), op_env_cache_key);
 }
 
+void VirtualMachine::PrepareWorkspace(const VMContext& ctx, const OpEnvPtr& op_env) {
+  std::shared_ptr<Requests> requests = op_env->GetRequests();
+  if (!requests->workspace.empty()) {
+    // OpEnvs that request their own streams may launch kernels on streams other than the current
+    // one, so they cannot share the workspace arena of the current stream. The CPU ops of
+    // different contexts and CPU lanes run concurrently without a stream to order them, so their
+    // workspaces are allocated per call.
+    bool use_arena = requests->stream.empty() &&
+                     requests->workspace[0].device.device_type() == DevType::kCUDA();
+    int64_t total_nbytes = 0;
+    for (auto& entry : requests->workspace) {
+      use_arena &= entry.device == requests->workspace[0].device;
+      int64_t aligned = (entry.nbytes + kDefaultMemoryAlignment - 1) / kDefaultMemoryAlignment;
+      total_nbytes += aligned * kDefaultMemoryAlignment;
+    }
+    if (use_arena && total_nbytes > 0) {
+      auto base = static_cast<char*>(
+          GetWorkspaceFromArena(ctx, requests->workspace[0].device, total_nbytes));
+      int64_t offset = 0;
+      for (auto& entry : requests->workspace) {
+        *entry.dest = base + offset;
+        int64_t aligned = (entry.nbytes + kDefaultMemoryAlignment - 1) / kDefaultMemoryAlignment;
+        offset += aligned * kDefaultMemoryAlignment;
+      }
+    } else {
+      for (auto& entry : requests->workspace) {
+        auto buf = Alloc(ctx, entry.device, entry.nbytes);
+        entry.memory = buf;
+        *entry.dest = buf->data;
+      }
+    }
+  }
+}
+
+void VirtualMachine::ReleaseWorkspace(const VMContext& ctx, const OpEnvPtr& op_env) {
+  // Note that the kernel may still be running at this point due to asynchronous execution, so the
+  // release has to be stream-ordered for multi-stream execution.
+  std::shared_ptr<Requests> requests = op_env->GetRequests();
+  for (size_t i = 0; i < requests->workspace.size(); ++i) {
+    Requests::WorkspaceRequest& entry = requests->workspace[i];
+    if (entry.nbytes > 0 && entry.memory != nullptr) {
+      *entry.dest = nullptr;
+      ReleaseMemory(ctx, &entry.memory);
+    }
+  }
+}
+
+VMContext VirtualMachine::PrepareFrozenContext(Index func_index, const std::vector<Value>& inputs) {
+  // The contexts are cached by the function and the input shapes.
+  HashKey hash_key;
+  hash_key << static_cast<int64_t>(func_index);
+  for (const auto& input : inputs) {
+    const auto* tensor = input.as<TensorValueObj>();
+    if (tensor == nullptr) {
+      return VMContext();
+    }
+    hash_key << *tensor->tensor.operator->();
+  }
+  std::string key(hash_key.byte_vector.begin(), hash_key.byte_vector.end());
+  Device dev = devices_[0];
+
+  std::lock_guard<std::mutex> lock(frozen_mutex_);
+  CHECK(!frozen_occupied_) << "VM in frozen mode doesn't support concurrent execution";
+  auto it = frozen_contexts_.find(key);
+  if (it == frozen_contexts_.end()) {
+    auto ctx = VMContext::make(exec_);
+    ctx->entry_func_index = func_index;
+    ctx->frozen_plan = std::make_shared<VMFrozenPlan>();
+    // The recorded steps are bound to the input buffers owned by the context, instead of the
+    // tensors given by the caller, which may be released or reused after this execution.
+    for (const auto& input : inputs) {
+      const DLTensor* dlt = input.as<TensorValueObj>()->tensor.operator->();
+      std::vector<int64_t> shape(dlt->shape, dlt->shape + dlt->ndim);
+      auto mem = Alloc(ctx, dev, common::shape_utils::BytesCompactTensor(*dlt));
+      ctx->inputs.push_back(TensorValue::Assemble(dev, dlt->dtype, shape, {}, mem->data, mem));
+    }
+    it = frozen_contexts_.emplace(key, ctx).first;
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    CopyTo(inputs[i], it->second->inputs[i]);
+  }
+  frozen_occupied_ = true;
+  return it->second;
+}
+
+void VirtualMachine::RecordFrozenStep(const VMContext& ctx, const Instruction& instr,
+                                      const OpEnvPtr& op_env, const std::vector<Value>& inputs,
+                                      const Value& output) {
+  VMFrozenPlan* plan = ctx->frozen_plan.get();
+  if (plan->ready) {
+    return;
+  }
+  auto keep_buffer = [plan](const Value& value) {
+    if (const auto* tensor = value.as<TensorValueObj>()) {
+      if (tensor->mem != nullptr) {
+        plan->buffers.push_back(tensor->mem);
+      }
+    } else if (const auto* tuple = value.as<TupleValueObj>()) {
+      for (const auto& field : tuple->fields) {
+        if (const auto* field_tensor = field.as<TensorValueObj>()) {
+          if (field_tensor->mem != nullptr) {
+            plan->buffers.push_back(field_tensor->mem);
+          }
+        }
+      }
+    }
+  };
+  for (const auto& input : inputs) {
+    keep_buffer(input);
+  }
+  keep_buffer(output);
+  plan->steps.push_back({op_env, inputs, output, &instr});
+}
+
+void VirtualMachine::RunFrozenPlan(VMContext& ctx) {
+  VMFrozenPlan* plan = ctx->frozen_plan.get();
+  auto finterpret = [&]() {
+    ctx.PushFrame(ctx->entry_func_index, ctx->inputs, -1);
+    RunLoop(ctx);
+  };
+  try {
+    // The bytecode is interpreted as usual when it is profiled or counted.
+    if (!plan->ready) {
+      plan->steps.clear();
+      plan->buffers.clear();
+      finterpret();
+      plan->ret = ctx->return_register;
+      plan->ready = true;
+    } else if (ctx->counters != nullptr || profiler::Profiler::Get()->IsProfiling(1)) {
+      finterpret();
+    } else {
+      ctx->current_device_id = 0;
+      ctx->current_stream_id = 0;
+      ctx->current_barrier_event_index = 0;
+      for (const auto& step : plan->steps) {
+        if (step.op_env == nullptr) {
+          switch (step.instr->op) {
+            case Opcode::CudaSetStream:
+              HandleCudaSetStream(ctx, *step.instr);
+              break;
+            case Opcode::CudaAddEvent:
+              HandleCudaAddEvent(ctx, *step.instr);
+              break;
+            case Opcode::CudaWaitEvent:
+              HandleCudaWaitEvent(ctx, *step.instr);
+              break;
+            case Opcode::CudaStreamBarrier:
+              HandleCudaStreamBarrier(ctx, *step.instr);
+              break;
+            default:
+              LOG(FATAL) << "Unexpected instruction in the frozen plan: " << *step.instr;
+          }
+          continue;
+        }
+        PrepareWorkspace(ctx, step.op_env);
+        step.op_env->Execute(step.inputs, step.output);
+        ReleaseWorkspace(ctx, step.op_env);
+      }
+      ctx->return_register = plan->ret;
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(frozen_mutex_);
+    frozen_occupied_ = false;
+    throw;
+  }
+  std::lock_guard<std::mutex> lock(frozen_mutex_);
+  frozen_occupied_ = false;
+}
+
 tvm::runtime::Module CreateVirtualMachine(const Executable* exec, bool enable_cuda_graph,
-                                          bool dryrun) {
-  auto vm = make_object<VirtualMachine>(enable_cuda_graph, dryrun);
+                                          bool dryrun, bool stream_ordered_alloc,
+                                          bool threaded_dispatch, bool serving_mode,
+                                          bool persistent_storage, bool frozen, bool fork_join,
+                                          int64_t dtr_budget, bool async_dispatch,
+                                          bool host_outputs) {
+  auto vm = make_object<VirtualMachine>(enable_cuda_graph, dryrun, stream_ordered_alloc,
+                                        threaded_dispatch, serving_mode, persistent_storage, frozen,
+                                        fork_join, dtr_budget, async_dispatch, host_outputs);
   vm->LoadExecutable(exec);
   return tvm::runtime::Module(vm);
 }
@@ -1122,9 +3805,20 @@ RAF_REGISTER_GLOBAL("raf.vm.VirtualMachine").set_body([](tvm::TVMArgs args, tvm:
   tvm::runtime::Module mod = args[0];
   bool enable_cuda_graph = args[1];
   bool dryrun = args[2];
+  bool stream_ordered_alloc = args.size() > 3 ? static_cast<bool>(args[3]) : false;
+  bool threaded_dispatch = args.size() > 4 ? static_cast<bool>(args[4]) : false;
+  bool serving_mode = args.size() > 5 ? static_cast<bool>(args[5]) : false;
+  bool persistent_storage = args.size() > 6 ? static_cast<bool>(args[6]) : false;
+  bool frozen = args.size() > 7 ? static_cast<bool>(args[7]) : false;
+  bool fork_join = args.size() > 8 ? static_cast<bool>(args[8]) : false;
+  int64_t dtr_budget = args.size() > 9 ? static_cast<int64_t>(args[9]) : 0;
+  bool async_dispatch = args.size() > 10 ? static_cast<bool>(args[10]) : false;
+  bool host_outputs = args.size() > 11 ? static_cast<bool>(args[11]) : false;
   const auto* exec = dynamic_cast<Executable*>(mod.operator->());
   CHECK(exec) << "The virtual machine executable has not been defined yet.";
-  *rv = CreateVirtualMachine(exec, enable_cuda_graph, dryrun);
+  *rv = CreateVirtualMachine(exec, enable_cuda_graph, dryrun, stream_ordered_alloc,
+                             threaded_dispatch, serving_mode, persistent_storage, frozen,
+                             fork_join, dtr_budget, async_dispatch, host_outputs);
 });
 
 }  // namespace vm
@@ -0,0 +1,291 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/huge_page_pool/huge_page_pool.cc
+ * \brief A CPU memory pool that serves the memory from pre-faulted huge page arenas
+ */
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "raf/device.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace memory_pool {
+namespace huge_page_pool {
+
+/*! \brief The size of a transparent huge page or a hugetlbfs page. */
+constexpr int64_t kHugePageSize = 2 << 20;
+/*! \brief The size of a base page. */
+constexpr int64_t kPageSize = 4096;
+
+inline int64_t RoundUp(int64_t nbytes, int64_t unit) {
+  return (nbytes + unit - 1) / unit * unit;
+}
+
+/*!
+ * \brief A mapping of huge pages that is faulted in when it is created, so that the chunks carved
+ * from it never take a page fault and take few TLB entries.
+ */
+class Arena {
+ public:
+  /*!
+   * \brief Map and pre-fault an arena.
+   * \param nbytes The size of the arena, which is a multiple of kHugePageSize.
+   * \param use_hugetlb Whether to map the pages reserved in hugetlbfs. Transparent huge pages are
+   * used instead if there are not enough reserved pages.
+   * \return The arena, or nullptr if it cannot be mapped.
+   */
+  static std::shared_ptr<Arena> Create(int64_t nbytes, bool use_hugetlb) {
+#ifdef MAP_HUGETLB
+    if (use_hugetlb) {
+      void* ptr = mmap(nullptr, nbytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+      if (ptr != MAP_FAILED) {
+        return std::make_shared<Arena>(static_cast<char*>(ptr), nbytes);
+      }
+      DLOG(WARNING) << "Cannot map " << (nbytes >> 20) << " MBs from hugetlbfs: "
+                    << strerror(errno) << ". Use transparent huge pages instead.";
+    }
+#endif
+    // Over-map by one huge page to align the arena, since only the aligned huge page ranges can be
+    // backed by transparent huge pages.
+    size_t map_bytes = nbytes + kHugePageSize;
+    void* ptr =
+        mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+      return nullptr;
+    }
+    char* raw = static_cast<char*>(ptr);
+    char* base = reinterpret_cast<char*>(RoundUp(reinterpret_cast<int64_t>(raw), kHugePageSize));
+    if (base != raw) {
+      munmap(raw, base - raw);
+    }
+    char* end = base + nbytes;
+    if (end != raw + map_bytes) {
+      munmap(end, raw + map_bytes - end);
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(base, nbytes, MADV_HUGEPAGE);
+#endif
+    // Pre-fault the arena. MADV_POPULATE_WRITE (Linux 5.14) does it without touching the pages.
+    constexpr int kMadvPopulateWrite = 23;
+    if (madvise(base, nbytes, kMadvPopulateWrite) != 0) {
+      for (int64_t offset = 0; offset < nbytes; offset += kPageSize) {
+        static_cast<volatile char*>(base)[offset] = 0;
+      }
+    }
+    return std::make_shared<Arena>(base, nbytes);
+  }
+
+  Arena(char* base, int64_t nbytes) : base(base), nbytes(nbytes) {
+  }
+
+  ~Arena() {
+    munmap(base, nbytes);
+  }
+
+  /*!
+   * \brief Carve a chunk from the unused tail of the arena.
+   * \param nbytes The size of the chunk.
+   * \param alignment The alignment of the chunk.
+   * \return The chunk, or nullptr if the arena does not have enough space.
+   */
+  void* Carve(int64_t nbytes, int64_t alignment) {
+    int64_t offset = RoundUp(used, alignment);
+    if (offset + nbytes > this->nbytes) {
+      return nullptr;
+    }
+    used = offset + nbytes;
+    return base + offset;
+  }
+
+  /*! \brief The start address of the arena. */
+  char* base;
+  /*! \brief The size of the arena in bytes. */
+  int64_t nbytes;
+  /*! \brief The size of the carved head of the arena in bytes. */
+  int64_t used = 0;
+};
+
+/*!
+ * \brief A chunk of an arena. The arena is unmapped when all its chunks are released.
+ */
+class ArenaMemory final : public Memory {
+ public:
+  explicit ArenaMemory(void* data, const Device& dev, std::shared_ptr<Arena> arena)
+      : arena(std::move(arena)) {
+    this->data = data;
+    this->device = dev;
+  }
+
+ public:
+  /*! \brief The arena that the chunk is carved from. */
+  std::shared_ptr<Arena> arena;
+};
+
+/*!
+ * \brief A CPU memory pool that serves the memory from the arenas of huge pages. The arenas are
+ * faulted in when they are mapped, so the planned storages of the steps never take a page fault,
+ * and the large activation buffers take few TLB entries.
+ *
+ * Like PageUnitPool, the chunks are rounded to the page size and cached by their sizes, so the
+ * storages of the same sizes in the following steps reuse the chunks. A new chunk is carved from
+ * the current arena, and a new arena is mapped when it is full.
+ *
+ * The arena size is 64 MBs by default, which can be configured in MBs by the environment variable
+ * RAF_HUGE_PAGE_ARENA_SIZE. The pages reserved in hugetlbfs are used if RAF_HUGE_PAGE_HUGETLB is
+ * set, and the transparent huge pages are used otherwise.
+ *
+ * \sa PageUnitPool
+ */
+class HugePagePool final : public MemoryPool {
+ public:
+  explicit HugePagePool(Device dev, int64_t arena_bytes, bool use_hugetlb, int64_t pool_limit)
+      : device(dev), arena_bytes(arena_bytes), use_hugetlb(use_hugetlb), max_pool_size(pool_limit) {
+    CHECK(dev.device_type() == DevType::kCPU()) << "huge_page_pool only supports CPU";
+  }
+
+  std::string GetName() {
+    return "huge_page_pool";
+  }
+
+  int64_t GetAllocBytes(int64_t nbytes) override {
+    return RoundUp(nbytes, kPageSize);
+  }
+
+  std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    nbytes = GetAllocBytes(nbytes);
+    CHECK_GE(nbytes, 0);
+    if (nbytes == 0) {
+      return std::make_shared<ArenaMemory>(nullptr, device, nullptr);
+    }
+    auto& chunks = _pool[nbytes];
+    for (const auto& it : chunks) {
+      if (it.use_count() == 1 && reinterpret_cast<int64_t>(it->data) % alignment == 0) {
+        return it;
+      }
+    }
+    void* data = current_arena ? current_arena->Carve(nbytes, alignment) : nullptr;
+    if (data == nullptr) {
+      if (max_pool_size > 0 && curr_pool_size >= max_pool_size) {
+        FreeUnusedChunks();
+      }
+      int64_t size = std::max(arena_bytes, RoundUp(nbytes + alignment, kHugePageSize));
+      current_arena = Arena::Create(size, use_hugetlb);
+      if (current_arena == nullptr) {
+        // The unused chunks keep their arenas mapped, so release them and try again.
+        FreeUnusedChunks();
+        current_arena = Arena::Create(size, use_hugetlb);
+      }
+      if (current_arena == nullptr) {
+        float used, allocated;
+        std::tie(used, allocated) = GetPoolSize();
+        LOG(FATAL) << "Out-Of-Memory. Tried to map " << BytesToMegaBytes(size)
+                   << " MBs; Already allocated " << allocated << " MBs and used " << used << " MBs";
+        throw;
+      }
+      data = current_arena->Carve(nbytes, alignment);
+    }
+    curr_pool_size += nbytes;
+    auto mem = std::make_shared<ArenaMemory>(data, device, current_arena);
+    chunks.push_back(mem);
+    return mem;
+  }
+
+  std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
+                                     int64_t alignment = kDefaultMemoryAlignment) override {
+    LOG(FATAL) << "Please use NoPool to use AllocAsync.";
+    throw;
+  }
+
+  std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
+                                                  int64_t alignment) override {
+    std::vector<std::shared_ptr<Memory>> ret;
+    ret.reserve(nbytes.size());
+    for (int64_t bytes : nbytes) {
+      ret.emplace_back(Alloc(bytes, alignment));
+    }
+    return ret;
+  }
+
+  std::pair<float, float> GetPoolSize() override {
+    float used_total = 0, pool_total = 0;
+    for (const auto& kv : _pool) {
+      size_t used_chunks = 0;
+      for (const auto& it : kv.second) {
+        used_chunks += (it.use_count() > 1) ? 1 : 0;
+      }
+      used_total += BytesToMegaBytes(kv.first * used_chunks);
+      pool_total += BytesToMegaBytes(kv.first * kv.second.size());
+    }
+    return std::make_pair(used_total, pool_total);
+  }
+
+  /*!
+   * \brief Remove the unused chunks from the pool. An arena is unmapped once all its chunks are
+   * removed or released, except the current one.
+   * \return The size of the removed chunks in bytes.
+   */
+  int64_t FreeUnusedChunks() {
+    int64_t total_free = 0;
+    curr_pool_size = 0;
+    for (auto& kv : _pool) {
+      auto nchunk = kv.second.size();
+      kv.second.remove_if([](std::shared_ptr<Memory>& mem) { return mem.use_count() == 1; });
+      total_free += kv.first * (nchunk - kv.second.size());
+      curr_pool_size += kv.first * kv.second.size();
+    }
+    return total_free;
+  }
+
+ public:
+  static void* make(const Device& dev) {
+    int64_t arena_bytes = 64 << 20;
+    if (const char* val = getenv("RAF_HUGE_PAGE_ARENA_SIZE")) {
+      arena_bytes = RoundUp(atol(val) << 20, kHugePageSize);
+    }
+    bool use_hugetlb = false;
+    if (const char* val = getenv("RAF_HUGE_PAGE_HUGETLB")) {
+      use_hugetlb = atoi(val) != 0;
+    }
+    int64_t max_pool_limit = 0;
+    if (const char* val = getenv("RAF_MEMORY_POOL_SIZE_LIMIT")) {
+      max_pool_limit = atol(val);
+    }
+    return new HugePagePool(dev, arena_bytes, use_hugetlb, max_pool_limit);
+  }
+
+ protected:
+  Device device;
+  /*! \brief The default size of the arenas in bytes. */
+  int64_t arena_bytes;
+  /*! \brief Whether to map the arenas from hugetlbfs. */
+  bool use_hugetlb;
+  /*! \brief The current pool size in bytes. */
+  int64_t curr_pool_size = 0;
+  /*! \brief The maximum allowed size (bytes) in the pool. 0 means no limit. */
+  int64_t max_pool_size = 0;
+  /*! \brief The arena to carve the new chunks from. */
+  std::shared_ptr<Arena> current_arena;
+  /*! \brief The pool that holds the chunks keyed by their sizes. */
+  std::unordered_map<int64_t, std::list<std::shared_ptr<Memory>>> _pool;
+};
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.huge_page_pool").set_body_typed([](const Device& dev) {
+  return HugePagePool::make(dev);
+});
+
+}  // namespace huge_page_pool
+}  // namespace memory_pool
+}  // namespace raf
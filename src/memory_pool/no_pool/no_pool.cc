@@ -55,7 +55,6 @@ class NonOwnedAsyncMemory final : public Memory {
 
  public:
   std::shared_ptr<DeviceAPI> api;
-  void* stream;
 };
 
 class NoPool final : public MemoryPool {
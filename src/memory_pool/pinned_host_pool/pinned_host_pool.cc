@@ -0,0 +1,364 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/pinned_host_pool/pinned_host_pool.cc
+ * \brief A memory pool of pinned host memory with size classes and stream-aware reuse
+ */
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "raf/device_api.h"
+#include "raf/event_pool.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace memory_pool {
+namespace pinned_host_pool {
+
+using device_api::DeviceAPI;
+
+/*! \brief The minimal block size (and size class) in bytes. */
+static constexpr int64_t kMinBlockSize = 512;
+/*! \brief The number of size classes in each power-of-two range. */
+static constexpr int64_t kClassesPerRange = 4;
+
+/*! \brief A pinned buffer allocated from the device API. */
+struct Block {
+  /*! \brief The pinned buffer. */
+  void* ptr;
+  /*! \brief The size class of this block in bytes. */
+  int64_t size;
+  /*! \brief The stream that the last uses of this block are ordered on, if any. */
+  void* stream = nullptr;
+  /*! \brief The event recorded on the stream when this block is released. */
+  void* event = nullptr;
+
+  Block(void* ptr, int64_t size) : ptr(ptr), size(size) {
+  }
+};
+
+/*!
+ * \brief The allocator state shared by the pool and all memory handed out by the pool, so that
+ * the memory can be returned correctly even if the pool has been removed from the manager.
+ */
+class PinnedAllocator {
+ public:
+  PinnedAllocator(Device dev, int64_t pool_limit)
+      : device_(dev),
+        api_(DeviceAPI::Get(dev.device_type())),
+        gpu_(DevType::kCUDA(), dev.device_id()),
+        max_pool_size_(pool_limit) {
+  }
+
+  ~PinnedAllocator() {
+    for (auto& block : pending_) {
+      gpu_api_->WaitEvent(block->event);
+      events_.push_back(block->event);
+      free_[block->size].push_back(block);
+    }
+    for (auto& kv : free_) {
+      for (auto block : kv.second) {
+        api_->FreeMemory(block->ptr);
+        delete block;
+      }
+    }
+    for (auto event : events_) {
+      gpu_api_->FreeEvent(gpu_, event);
+    }
+  }
+
+  /*!
+   * \brief Round the size up to its size class. Each power-of-two range is evenly divided into
+   * kClassesPerRange classes, so that at most 1 / kClassesPerRange of a block is wasted.
+   */
+  static int64_t RoundSize(int64_t nbytes) {
+    if (nbytes <= kMinBlockSize) {
+      return kMinBlockSize;
+    }
+    int64_t range = kMinBlockSize;
+    while (range * 2 < nbytes) {
+      range *= 2;
+    }
+    int64_t step = range / kClassesPerRange;
+    return (nbytes + step - 1) / step * step;
+  }
+
+  Block* Malloc(int64_t nbytes, void* stream, int64_t alignment) {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t size = RoundSize(nbytes);
+    Block* block = FindFreeBlock(size, stream);
+    if (block == nullptr) {
+      if (max_pool_size_ > 0 && reserved_bytes_ + size > max_pool_size_) {
+        ReleaseCachedBlocks();
+      }
+      block = AllocBlock(size, alignment);
+    }
+    if (block == nullptr) {
+      // Out of memory. Release all cached blocks and try again.
+      int64_t free_nbytes = ReleaseCachedBlocks();
+      DLOG(WARNING) << "Failed to allocate " << size << " bytes of pinned memory. Released "
+                    << free_nbytes << " bytes of cached blocks";
+      block = AllocBlock(size, alignment);
+    }
+    if (block == nullptr) {
+      LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << (size / 1048576.0)
+                 << " MBs of pinned memory; Already reserved " << (reserved_bytes_ / 1048576.0)
+                 << " MBs and used " << (used_bytes_ / 1048576.0) << " MBs";
+      throw;
+    }
+    block->stream = stream;
+    used_bytes_ += block->size;
+    return block;
+  }
+
+  void Free(Block* block) {
+    std::lock_guard<std::mutex> lock(mu_);
+    used_bytes_ -= block->size;
+    if (block->stream == nullptr) {
+      free_[block->size].push_back(block);
+      return;
+    }
+    // The copies issued on the stream may still access the block, so it is not reused by other
+    // streams or the host until they are finished.
+    if (events_.empty()) {
+      block->event = gpu_api_->CreateEvent(gpu_, event_pool::kEventDisableTiming);
+    } else {
+      block->event = events_.back();
+      events_.pop_back();
+    }
+    gpu_api_->EventRecordOnStream(block->event, block->stream);
+    pending_.push_back(block);
+  }
+
+  int64_t ReleaseCachedBlocksWithLock() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return ReleaseCachedBlocks();
+  }
+
+  std::pair<int64_t, int64_t> GetPoolSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {used_bytes_, reserved_bytes_};
+  }
+
+  const Device& device() const {
+    return device_;
+  }
+
+ private:
+  Block* FindFreeBlock(int64_t size, void* stream) {
+    CollectPendingBlocks();
+    if (stream != nullptr) {
+      // A block released on the same stream can be reused right away, because the new uses are
+      // ordered after the previous ones on the stream.
+      for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+        Block* block = *it;
+        if (block->size == size && block->stream == stream) {
+          pending_.erase(it);
+          events_.push_back(block->event);
+          block->event = nullptr;
+          return block;
+        }
+      }
+    }
+    auto it = free_.find(size);
+    if (it == free_.end() || it->second.empty()) {
+      return nullptr;
+    }
+    Block* block = it->second.back();
+    it->second.pop_back();
+    return block;
+  }
+
+  /*! \brief Move the pending blocks whose uses on their streams are finished to the free lists. */
+  void CollectPendingBlocks() {
+    for (auto it = pending_.begin(); it != pending_.end();) {
+      Block* block = *it;
+      if (gpu_api_->QueryEvent(block->event)) {
+        events_.push_back(block->event);
+        block->event = nullptr;
+        block->stream = nullptr;
+        free_[block->size].push_back(block);
+        it = pending_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  Block* AllocBlock(int64_t size, int64_t alignment) {
+    void* data = nullptr;
+    try {
+      data = api_->AllocMemory(size, alignment);
+    } catch (const dmlc::Error& e) {
+      return nullptr;
+    }
+    if (data == nullptr) {
+      return nullptr;
+    }
+    reserved_bytes_ += size;
+    return new Block(data, size);
+  }
+
+  /*! \brief Return all cached free blocks to the device, and return the freed bytes. */
+  int64_t ReleaseCachedBlocks() {
+    CollectPendingBlocks();
+    int64_t total_free = 0;
+    for (auto& kv : free_) {
+      for (auto block : kv.second) {
+        api_->FreeMemory(block->ptr);
+        total_free += block->size;
+        delete block;
+      }
+      kv.second.clear();
+    }
+    reserved_bytes_ -= total_free;
+    return total_free;
+  }
+
+  /*! \brief The pinned host device of this allocator. */
+  Device device_;
+  /*! \brief The pointer to the DeviceAPI which allocates the pinned memory. */
+  std::shared_ptr<DeviceAPI> api_;
+  /*! \brief The GPU whose streams use the memory, which owns the events. */
+  Device gpu_;
+  /*! \brief The pointer to the DeviceAPI which manages the events. */
+  std::shared_ptr<DeviceAPI> gpu_api_ = DeviceAPI::Get(DevType::kCUDA());
+  /*! \brief The maximum allowed reserved size (bytes). 0 means no limit. */
+  int64_t max_pool_size_ = 0;
+  /*! \brief The bytes currently handed out to users. */
+  int64_t used_bytes_ = 0;
+  /*! \brief The bytes currently reserved from the device. */
+  int64_t reserved_bytes_ = 0;
+  /*! \brief The free blocks of each size class. */
+  std::unordered_map<int64_t, std::vector<Block*>> free_;
+  /*! \brief The released blocks that may still be used by their streams. */
+  std::list<Block*> pending_;
+  /*! \brief The idle events to be recorded for the released blocks. */
+  std::vector<void*> events_;
+  /*! \brief The mutex to protect the allocator state. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief A wrapper which holds a block in the pinned host pool. The block is returned to the
+ * allocator when this object is destructed.
+ *
+ * \sa PinnedMemory
+ */
+class PinnedMemory final : public Memory {
+ public:
+  explicit PinnedMemory(Block* block, std::shared_ptr<PinnedAllocator> allocator)
+      : block(block), allocator(std::move(allocator)) {
+    this->data = block ? block->ptr : nullptr;
+    this->device = this->allocator->device();
+    this->stream = block ? block->stream : nullptr;
+  }
+
+  ~PinnedMemory() {
+    if (block != nullptr) {
+      allocator->Free(block);
+    }
+  }
+
+ public:
+  /*! \brief The held block. */
+  Block* block;
+  /*! \brief The allocator that owns the block. */
+  std::shared_ptr<PinnedAllocator> allocator;
+};
+
+/*!
+ * \brief A Memory Pool of pinned (page-locked) host memory, which is used to stage the copies
+ * between the host and CUDA GPUs. Pinning and unpinning memory (cudaMallocHost / cudaFreeHost)
+ * is very slow and synchronizes the device, so the released buffers are cached and reused.
+ *
+ * The requests are rounded up to size classes, where each power-of-two range is divided into 4
+ * classes, and a request is served by a cached buffer of the same class. The memory allocated by
+ * AllocAsync is bound to the given stream. Once it is released, it is reused right away by the
+ * requests on the same stream, while the other requests only reuse it after the work issued to
+ * the stream before the release is finished. Cached buffers are returned to the device when an
+ * allocation fails or the pool exceeds the limit specified by RAF_MEMORY_POOL_SIZE_LIMIT.
+ *
+ * \sa PinnedHostPool
+ */
+class PinnedHostPool final : public MemoryPool {
+ public:
+  explicit PinnedHostPool(Device dev, int64_t pool_limit = 0) {
+    CHECK(dev.device_type() == DevType::kCUDAHost())
+        << "The pinned host pool only supports cuda_host, but got " << dev.c_str();
+    this->device = dev;
+    this->allocator = std::make_shared<PinnedAllocator>(dev, pool_limit);
+  }
+
+  std::string GetName() {
+    return "pinned_host_pool";
+  }
+
+  int64_t GetAllocBytes(int64_t nbytes) override {
+    return PinnedAllocator::RoundSize(nbytes);
+  }
+
+  std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    return AllocAsync(nbytes, nullptr, alignment);
+  }
+
+  std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
+                                     int64_t alignment = kDefaultMemoryAlignment) override {
+    CHECK_GE(nbytes, 0);
+    if (nbytes == 0) {
+      return std::make_shared<PinnedMemory>(nullptr, allocator);
+    }
+    return std::make_shared<PinnedMemory>(allocator->Malloc(nbytes, stream, alignment),
+                                          allocator);
+  }
+
+  std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
+                                                  int64_t alignment) override {
+    std::vector<std::shared_ptr<Memory>> ret;
+    ret.reserve(nbytes.size());
+    for (int64_t bytes : nbytes) {
+      ret.emplace_back(Alloc(bytes, alignment));
+    }
+    return ret;
+  }
+
+  std::pair<float, float> GetPoolSize() override {
+    auto ret = allocator->GetPoolSize();
+    return {BytesToMegaBytes(ret.first), BytesToMegaBytes(ret.second)};
+  }
+
+  /*!
+   * \brief Return all cached buffers that are not in use to the device.
+   * \return The freed memory in bytes.
+   */
+  int64_t FreeUnusedChunks() {
+    return allocator->ReleaseCachedBlocksWithLock();
+  }
+
+ public:
+  static void* make(const Device& dev) {
+    int64_t max_pool_limit = 0;
+    if (const char* val = getenv("RAF_MEMORY_POOL_SIZE_LIMIT")) {
+      max_pool_limit = atol(val);
+    }
+    return new PinnedHostPool(dev, max_pool_limit);
+  }
+
+ protected:
+  Device device;
+  /*! \brief The allocator shared with the allocated memory. */
+  std::shared_ptr<PinnedAllocator> allocator;
+};
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.pinned_host_pool").set_body_typed([](const Device& dev) {
+  return PinnedHostPool::make(dev);
+});
+
+}  // namespace pinned_host_pool
+}  // namespace memory_pool
+}  // namespace raf
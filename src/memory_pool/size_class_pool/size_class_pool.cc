@@ -0,0 +1,422 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/size_class_pool/size_class_pool.cc
+ * \brief A memory pool that splits and coalesces blocks organized in size-class bins
+ */
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace memory_pool {
+namespace size_class_pool {
+
+using device_api::DeviceAPI;
+
+/*! \brief The minimal block size (and granularity) in bytes. */
+static constexpr int64_t kMinBlockSize = 512;
+/*! \brief Requests no larger than this size are served from small segments. */
+static constexpr int64_t kSmallSize = 1 << 20;
+/*! \brief The size of a segment reserved for small requests. */
+static constexpr int64_t kSmallSegmentSize = 2 << 20;
+/*! \brief Requests smaller than this size are served from medium segments. */
+static constexpr int64_t kMediumSize = 10 << 20;
+/*! \brief The size of a segment reserved for medium requests. */
+static constexpr int64_t kMediumSegmentSize = 20 << 20;
+/*! \brief Large segments are rounded up to this granularity. */
+static constexpr int64_t kLargeRoundSize = 2 << 20;
+/*! \brief The number of size-class bins, where bin i holds blocks in [2^i, 2^(i+1)). */
+static constexpr int kNumBins = 64;
+
+/*!
+ * \brief A block is a contiguous range in a segment. Blocks of the same segment form a doubly
+ * linked list sorted by address so that adjacent free blocks can be coalesced.
+ */
+struct Block {
+  /*! \brief The start address of this block. */
+  char* ptr;
+  /*! \brief The size of this block in bytes. */
+  int64_t size;
+  /*! \brief Whether this block is handed out to a user. */
+  bool allocated = false;
+  /*! \brief The previous block in the same segment. */
+  Block* prev = nullptr;
+  /*! \brief The next block in the same segment. */
+  Block* next = nullptr;
+
+  Block(char* ptr, int64_t size) : ptr(ptr), size(size) {
+  }
+};
+
+/*! \brief Order free blocks by size first, and then by address, to perform best-fit search. */
+struct BlockComparator {
+  bool operator()(const Block* a, const Block* b) const {
+    if (a->size != b->size) {
+      return a->size < b->size;
+    }
+    return reinterpret_cast<uintptr_t>(a->ptr) < reinterpret_cast<uintptr_t>(b->ptr);
+  }
+};
+
+/*!
+ * \brief The allocator state shared by the pool and all memory handed out by the pool, so that
+ * the memory can be returned correctly even if the pool has been removed from the manager.
+ */
+class BlockAllocator {
+ public:
+  BlockAllocator(Device dev, std::shared_ptr<DeviceAPI> api, int64_t pool_limit)
+      : device_(dev), api_(std::move(api)), max_pool_size_(pool_limit) {
+  }
+
+  ~BlockAllocator() {
+    for (auto& kv : segments_) {
+      FreeSegmentChain(kv.second);
+      api_->FreeMemory(kv.first);
+    }
+  }
+
+  static int64_t RoundSize(int64_t nbytes) {
+    if (nbytes < kMinBlockSize) {
+      return kMinBlockSize;
+    }
+    return (nbytes + kMinBlockSize - 1) / kMinBlockSize * kMinBlockSize;
+  }
+
+  static int64_t GetSegmentSize(int64_t nbytes) {
+    if (nbytes <= kSmallSize) {
+      return kSmallSegmentSize;
+    } else if (nbytes < kMediumSize) {
+      return kMediumSegmentSize;
+    }
+    return (nbytes + kLargeRoundSize - 1) / kLargeRoundSize * kLargeRoundSize;
+  }
+
+  Block* Malloc(int64_t nbytes, int64_t alignment) {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t size = RoundSize(nbytes);
+    // Reserve extra space so that an aligned address can always be carved out of the block.
+    int64_t search_size = size + (alignment > kMinBlockSize ? alignment - kMinBlockSize : 0);
+
+    Block* block = FindFreeBlock(search_size);
+    if (block == nullptr) {
+      block = AllocSegment(search_size, alignment);
+    }
+    if (block == nullptr) {
+      // Out of memory or exceed the user-specified limitation, release all idle segments.
+      int64_t free_nbytes = ReleaseIdleSegments();
+      DLOG(WARNING) << "Failed to allocate " << search_size << " bytes. Released "
+                    << free_nbytes << " bytes of idle segments";
+      block = AllocSegment(search_size, alignment);
+    }
+    if (block == nullptr) {
+      LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << (search_size / 1048576.0)
+                 << " MBs; Already reserved " << (reserved_bytes_ / 1048576.0) << " MBs and used "
+                 << (used_bytes_ / 1048576.0) << " MBs";
+      throw;
+    }
+
+    // Split the front padding to meet the alignment requirement.
+    uintptr_t addr = reinterpret_cast<uintptr_t>(block->ptr);
+    int64_t pad = (alignment - static_cast<int64_t>(addr % alignment)) % alignment;
+    if (pad > 0) {
+      Block* aligned = Split(block, pad);
+      InsertFree(block);
+      block = aligned;
+    }
+    // Split the tail remainder and return it to the free bins.
+    if (block->size - size >= kMinBlockSize) {
+      Block* remaining = Split(block, size);
+      InsertFree(remaining);
+    }
+    block->allocated = true;
+    used_bytes_ += block->size;
+    return block;
+  }
+
+  void Free(Block* block) {
+    std::lock_guard<std::mutex> lock(mu_);
+    CHECK(block->allocated) << "Double free of block at " << static_cast<void*>(block->ptr);
+    block->allocated = false;
+    used_bytes_ -= block->size;
+    // Coalesce with adjacent free blocks in the same segment.
+    if (block->prev && !block->prev->allocated) {
+      Block* prev = block->prev;
+      EraseFree(prev);
+      prev->size += block->size;
+      prev->next = block->next;
+      if (block->next) {
+        block->next->prev = prev;
+      }
+      delete block;
+      block = prev;
+    }
+    if (block->next && !block->next->allocated) {
+      Block* next = block->next;
+      EraseFree(next);
+      block->size += next->size;
+      block->next = next->next;
+      if (next->next) {
+        next->next->prev = block;
+      }
+      delete next;
+    }
+    InsertFree(block);
+  }
+
+  int64_t ReleaseIdleSegments() {
+    int64_t total_free = 0;
+    for (auto it = segments_.begin(); it != segments_.end();) {
+      Block* head = it->second;
+      if (!head->allocated && head->prev == nullptr && head->next == nullptr) {
+        EraseFree(head);
+        total_free += head->size;
+        reserved_bytes_ -= head->size;
+        api_->FreeMemory(it->first);
+        delete head;
+        it = segments_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return total_free;
+  }
+
+  int64_t ReleaseIdleSegmentsWithLock() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return ReleaseIdleSegments();
+  }
+
+  std::pair<int64_t, int64_t> GetPoolSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {used_bytes_, reserved_bytes_};
+  }
+
+  const Device& device() const {
+    return device_;
+  }
+
+ private:
+  static int GetBinIndex(int64_t size) {
+    int bin = 0;
+    while (bin < kNumBins - 1 && (static_cast<uint64_t>(size) >> (bin + 1)) != 0) {
+      ++bin;
+    }
+    return bin;
+  }
+
+  Block* FindFreeBlock(int64_t size) {
+    Block key(nullptr, size);
+    for (int bin = GetBinIndex(size); bin < kNumBins; ++bin) {
+      auto& free_set = bins_[bin];
+      auto it = free_set.lower_bound(&key);
+      if (it != free_set.end()) {
+        Block* block = *it;
+        // Avoid splitting a large block only to serve a tiny request, which fragments the
+        // segments for large requests.
+        if (size <= kSmallSize && block->size > kMediumSegmentSize) {
+          return nullptr;
+        }
+        free_set.erase(it);
+        return block;
+      }
+    }
+    return nullptr;
+  }
+
+  Block* AllocSegment(int64_t size, int64_t alignment) {
+    int64_t segment_size = GetSegmentSize(size);
+    if (max_pool_size_ > 0 && reserved_bytes_ + segment_size > max_pool_size_) {
+      return nullptr;
+    }
+    void* data = nullptr;
+    try {
+      data = api_->AllocMemory(segment_size, std::max(alignment, kDefaultMemoryAlignment));
+    } catch (const dmlc::Error& e) {
+      return nullptr;
+    } catch (const std::bad_alloc& e) {
+      return nullptr;
+    }
+    if (data == nullptr) {
+      return nullptr;
+    }
+    Block* block = new Block(static_cast<char*>(data), segment_size);
+    segments_[data] = block;
+    reserved_bytes_ += segment_size;
+    return block;
+  }
+
+  /*! \brief Split the block at the given offset and return the newly created tail block. */
+  Block* Split(Block* block, int64_t offset) {
+    CHECK_LT(offset, block->size);
+    Block* tail = new Block(block->ptr + offset, block->size - offset);
+    tail->prev = block;
+    tail->next = block->next;
+    if (block->next) {
+      block->next->prev = tail;
+    }
+    block->next = tail;
+    block->size = offset;
+    return tail;
+  }
+
+  void InsertFree(Block* block) {
+    bins_[GetBinIndex(block->size)].insert(block);
+  }
+
+  void EraseFree(Block* block) {
+    bins_[GetBinIndex(block->size)].erase(block);
+  }
+
+  void FreeSegmentChain(Block* head) {
+    while (head) {
+      Block* next = head->next;
+      delete head;
+      head = next;
+    }
+  }
+
+  /*! \brief The device of this allocator. */
+  Device device_;
+  /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
+  std::shared_ptr<DeviceAPI> api_;
+  /*! \brief The maximum allowed reserved size (bytes). 0 means no limit. */
+  int64_t max_pool_size_ = 0;
+  /*! \brief The bytes currently handed out to users. */
+  int64_t used_bytes_ = 0;
+  /*! \brief The bytes currently reserved from the device. */
+  int64_t reserved_bytes_ = 0;
+  /*! \brief Free blocks in each size-class bin. */
+  std::set<Block*, BlockComparator> bins_[kNumBins];
+  /*! \brief Map from the segment base address to its first block. */
+  std::unordered_map<void*, Block*> segments_;
+  /*! \brief The mutex to protect the allocator state. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief A wrapper which holds a block in the size class pool. The block is returned to the
+ * allocator when this object is destructed.
+ *
+ * \sa BlockMemory
+ */
+class BlockMemory final : public Memory {
+ public:
+  explicit BlockMemory(Block* block, std::shared_ptr<BlockAllocator> allocator)
+      : block(block), allocator(std::move(allocator)) {
+    this->data = block ? block->ptr : nullptr;
+    this->device = this->allocator->device();
+  }
+
+  ~BlockMemory() {
+    if (block != nullptr) {
+      allocator->Free(block);
+    }
+  }
+
+ public:
+  /*! \brief The held block. */
+  Block* block;
+  /*! \brief The allocator that owns the block. */
+  std::shared_ptr<BlockAllocator> allocator;
+};
+
+/*!
+ * \brief A Memory Pool that reserves large segments from the device and serves requests by
+ * splitting blocks out of them. Free blocks are segregated into power-of-two size-class bins
+ * and the smallest fitting block is chosen (best-fit). When a block is freed, it is coalesced
+ * with its free neighbors in the same segment, so variable-sized requests (e.g., dynamic sequence
+ * lengths) can reuse the memory of each other instead of requiring exactly the same sizes.
+ *
+ * Small requests (<= 1MB) are served from 2MB segments, medium requests (< 10MB) from 20MB
+ * segments, and large requests get their own segments rounded up to 2MB. Segments are returned
+ * to the device only when they are completely free and an allocation fails or exceeds the limit
+ * specified by RAF_MEMORY_POOL_SIZE_LIMIT.
+ *
+ * \sa SizeClassPool
+ */
+class SizeClassPool final : public MemoryPool {
+ public:
+  explicit SizeClassPool(Device dev, int64_t pool_limit = 0) {
+    this->device = dev;
+    auto api = DeviceAPI::Get(dev.device_type());
+    if (dev.device_type() == DevType::kCUDA()) {
+      api->SetDevice(dev.device_id());
+    }
+    this->allocator = std::make_shared<BlockAllocator>(dev, std::move(api), pool_limit);
+  }
+
+  std::string GetName() {
+    return "size_class_pool";
+  }
+
+  int64_t GetAllocBytes(int64_t nbytes) override {
+    return BlockAllocator::RoundSize(nbytes);
+  }
+
+  std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    CHECK_GE(nbytes, 0);
+    if (nbytes == 0) {
+      return std::make_shared<BlockMemory>(nullptr, allocator);
+    }
+    return std::make_shared<BlockMemory>(allocator->Malloc(nbytes, alignment), allocator);
+  }
+
+  std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
+                                     int64_t alignment = kDefaultMemoryAlignment) override {
+    LOG(FATAL) << "Please use NoPool to use AllocAsync.";
+    throw;
+  }
+
+  std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
+                                                  int64_t alignment) override {
+    std::vector<std::shared_ptr<Memory>> ret;
+    ret.reserve(nbytes.size());
+    for (int64_t bytes : nbytes) {
+      ret.emplace_back(Alloc(bytes, alignment));
+    }
+    return ret;
+  }
+
+  std::pair<float, float> GetPoolSize() override {
+    auto ret = allocator->GetPoolSize();
+    return {BytesToMegaBytes(ret.first), BytesToMegaBytes(ret.second)};
+  }
+
+  /*!
+   * \brief Return all completely free segments to the device.
+   * \return The freed memory in bytes.
+   */
+  int64_t FreeUnusedChunks() {
+    return allocator->ReleaseIdleSegmentsWithLock();
+  }
+
+ public:
+  static void* make(const Device& dev) {
+    int64_t max_pool_limit = 0;
+    if (const char* val = getenv("RAF_MEMORY_POOL_SIZE_LIMIT")) {
+      max_pool_limit = atol(val);
+    }
+    return new SizeClassPool(dev, max_pool_limit);
+  }
+
+ protected:
+  Device device;
+  /*! \brief The block allocator shared with the allocated memory. */
+  std::shared_ptr<BlockAllocator> allocator;
+};
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.size_class_pool").set_body_typed([](const Device& dev) {
+  return SizeClassPool::make(dev);
+});
+
+}  // namespace size_class_pool
+}  // namespace memory_pool
+}  // namespace raf
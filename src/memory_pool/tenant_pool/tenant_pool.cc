@@ -0,0 +1,393 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/tenant_pool/tenant_pool.cc
+ * \brief A memory pool shared by several tenants with reservations, quotas and per-tenant caches
+ */
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace memory_pool {
+namespace tenant_pool {
+
+using device_api::DeviceAPI;
+
+/*! \brief The size of each memory page (exponent). */
+static constexpr int64_t kPageSizeExp = 12;
+
+/*! \brief A tenant of the pool, e.g., the VM of a model. */
+struct Tenant {
+  explicit Tenant(std::string name) : name(std::move(name)) {
+  }
+
+  /*! \brief The name of the tenant. */
+  std::string name;
+  /*! \brief The configuration and the memory usage. */
+  TenantStats stats;
+  /*! \brief The chunks released by the tenant, by their sizes. */
+  std::unordered_map<int64_t, std::vector<void*>> cache;
+};
+
+/*!
+ * \brief The allocator state shared by the pool and all memory handed out by the pool, so that
+ * the memory can be returned correctly even if the pool has been removed from the manager.
+ */
+class TenantAllocator {
+ public:
+  TenantAllocator(Device dev, std::shared_ptr<DeviceAPI> api, int64_t pool_limit)
+      : device_(dev), api_(std::move(api)), max_pool_size_(pool_limit) {
+  }
+
+  ~TenantAllocator() {
+    for (auto& kv : tenants_) {
+      for (auto& chunks : kv.second->cache) {
+        for (void* data : chunks.second) {
+          api_->FreeMemory(data);
+        }
+      }
+    }
+  }
+
+  static int64_t RoundSize(int64_t nbytes) {
+    return !!(nbytes & ((1 << kPageSizeExp) - 1)) + (nbytes >> kPageSizeExp) << kPageSizeExp;
+  }
+
+  void SetTenant(const std::string& name, int64_t reserved_bytes, int64_t quota_bytes) {
+    std::lock_guard<std::mutex> lock(mu_);
+    CHECK_GE(reserved_bytes, 0);
+    CHECK(quota_bytes == 0 || reserved_bytes <= quota_bytes)
+        << "The reservation of tenant \"" << name << "\" exceeds its quota";
+    Tenant* tenant = GetTenant(name);
+    int64_t total_reserved = reserved_bytes;
+    for (const auto& kv : tenants_) {
+      if (kv.second.get() != tenant) {
+        total_reserved += kv.second->stats.reserved_bytes;
+      }
+    }
+    CHECK(max_pool_size_ == 0 || total_reserved <= max_pool_size_)
+        << "The reservations of the tenants (" << total_reserved
+        << " bytes) exceed the pool limit (" << max_pool_size_ << " bytes)";
+    tenant->stats.reserved_bytes = reserved_bytes;
+    tenant->stats.quota_bytes = quota_bytes;
+  }
+
+  /*!
+   * \brief Allocate a chunk for the tenant of the current thread.
+   * \param size The rounded size of the chunk.
+   * \param alignment The alignment of the chunk.
+   * \param owner The tenant that owns the chunk.
+   * \return The start address of the chunk.
+   */
+  void* Malloc(int64_t size, int64_t alignment, Tenant** owner) {
+    std::lock_guard<std::mutex> lock(mu_);
+    Tenant* tenant = GetTenant(TenantScope::Current());
+    TenantStats& stats = tenant->stats;
+    if (stats.quota_bytes > 0 && stats.used_bytes + size > stats.quota_bytes) {
+      LOG(FATAL) << "Out-Of-Memory. Tenant \"" << tenant->name << "\" tried to allocate "
+                 << (size / 1048576.0) << " MBs, exceeding its quota of "
+                 << (stats.quota_bytes / 1048576.0) << " MBs with "
+                 << (stats.used_bytes / 1048576.0) << " MBs used";
+      throw;
+    }
+    stats.num_allocs++;
+
+    // Reuse a cached chunk of the tenant with the same size.
+    void* data = nullptr;
+    auto it = tenant->cache.find(size);
+    if (it != tenant->cache.end()) {
+      auto& chunks = it->second;
+      for (auto chunk = chunks.rbegin(); chunk != chunks.rend(); ++chunk) {
+        if (reinterpret_cast<uintptr_t>(*chunk) % alignment == 0) {
+          data = *chunk;
+          chunks.erase(std::next(chunk).base());
+          stats.cached_bytes -= size;
+          break;
+        }
+      }
+    }
+
+    if (data == nullptr) {
+      // The unused reservations of the other tenants are kept available to them.
+      int64_t shortage = 0;
+      if (max_pool_size_ > 0) {
+        shortage = held_bytes_ + size + UnusedReservations(tenant) - max_pool_size_;
+        if (shortage > 0) {
+          shortage -= Reclaim(tenant, shortage);
+        }
+      }
+      if (shortage <= 0) {
+        data = AllocDeviceMemory(size, alignment);
+        if (data == nullptr) {
+          int64_t free_nbytes = Reclaim(tenant, std::numeric_limits<int64_t>::max());
+          DLOG(WARNING) << "Failed to allocate " << (size / 1048576.0) << " MBs. Released "
+                        << (free_nbytes / 1048576.0) << " MBs of cached chunks";
+          data = AllocDeviceMemory(size, alignment);
+        }
+      }
+      if (data == nullptr) {
+        LOG(FATAL) << "Out-Of-Memory. Tenant \"" << tenant->name << "\" tried to allocate "
+                   << (size / 1048576.0) << " MBs; The pool already reserved "
+                   << (held_bytes_ / 1048576.0) << " MBs, and the tenant used "
+                   << (stats.used_bytes / 1048576.0) << " MBs";
+        throw;
+      }
+      held_bytes_ += size;
+    }
+    stats.used_bytes += size;
+    stats.peak_bytes = std::max(stats.peak_bytes, stats.used_bytes);
+    *owner = tenant;
+    return data;
+  }
+
+  void Free(Tenant* tenant, void* data, int64_t size) {
+    std::lock_guard<std::mutex> lock(mu_);
+    tenant->stats.used_bytes -= size;
+    tenant->stats.cached_bytes += size;
+    tenant->cache[size].push_back(data);
+  }
+
+  std::pair<int64_t, int64_t> GetPoolSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t used_bytes = 0;
+    for (const auto& kv : tenants_) {
+      used_bytes += kv.second->stats.used_bytes;
+    }
+    return {used_bytes, held_bytes_};
+  }
+
+  std::unordered_map<std::string, TenantStats> GetTenantStats() {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::unordered_map<std::string, TenantStats> ret;
+    for (const auto& kv : tenants_) {
+      ret[kv.first] = kv.second->stats;
+    }
+    return ret;
+  }
+
+  const Device& device() const {
+    return device_;
+  }
+
+ private:
+  Tenant* GetTenant(const std::string& name) {
+    std::unique_ptr<Tenant>& tenant = tenants_[name];
+    if (tenant == nullptr) {
+      tenant = std::make_unique<Tenant>(name);
+    }
+    return tenant.get();
+  }
+
+  /*! \brief The reserved bytes of the tenants other than the given one that are not held yet. */
+  int64_t UnusedReservations(const Tenant* requester) {
+    int64_t ret = 0;
+    for (const auto& kv : tenants_) {
+      const TenantStats& stats = kv.second->stats;
+      if (kv.second.get() != requester) {
+        ret += std::max<int64_t>(0, stats.reserved_bytes - stats.used_bytes - stats.cached_bytes);
+      }
+    }
+    return ret;
+  }
+
+  /*!
+   * \brief Return cached chunks to the device, first the ones of the requester, and then the ones
+   * of the other tenants beyond their reservations, the idle tenants first.
+   * \param requester The tenant that needs the memory.
+   * \param nbytes The bytes to release.
+   * \return The released bytes.
+   */
+  int64_t Reclaim(Tenant* requester, int64_t nbytes) {
+    std::vector<Tenant*> victims;
+    for (const auto& kv : tenants_) {
+      if (kv.second.get() != requester && kv.second->stats.cached_bytes > 0) {
+        victims.push_back(kv.second.get());
+      }
+    }
+    std::stable_sort(victims.begin(), victims.end(), [](const Tenant* a, const Tenant* b) {
+      return a->stats.used_bytes < b->stats.used_bytes;
+    });
+    victims.insert(victims.begin(), requester);
+
+    int64_t total_free = 0;
+    for (Tenant* tenant : victims) {
+      TenantStats& stats = tenant->stats;
+      for (auto& kv : tenant->cache) {
+        int64_t size = kv.first;
+        auto& chunks = kv.second;
+        while (!chunks.empty() && total_free < nbytes) {
+          if (tenant != requester &&
+              stats.used_bytes + stats.cached_bytes - size < stats.reserved_bytes) {
+            break;
+          }
+          api_->FreeMemory(chunks.back());
+          chunks.pop_back();
+          stats.cached_bytes -= size;
+          held_bytes_ -= size;
+          total_free += size;
+          if (tenant != requester) {
+            stats.reclaimed_bytes += size;
+          }
+        }
+      }
+      if (total_free >= nbytes) {
+        break;
+      }
+    }
+    return total_free;
+  }
+
+  void* AllocDeviceMemory(int64_t nbytes, int64_t alignment) {
+    try {
+      return api_->AllocMemory(nbytes, alignment);
+    } catch (const dmlc::Error& e) {
+      return nullptr;
+    }
+  }
+
+  /*! \brief The device of this allocator. */
+  Device device_;
+  /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
+  std::shared_ptr<DeviceAPI> api_;
+  /*! \brief The maximum allowed size (bytes) held from the device. 0 means no limit. */
+  int64_t max_pool_size_ = 0;
+  /*! \brief The bytes currently held from the device, either used or cached. */
+  int64_t held_bytes_ = 0;
+  /*! \brief The tenants by their names. */
+  std::unordered_map<std::string, std::unique_ptr<Tenant>> tenants_;
+  /*! \brief The mutex to protect the allocator state. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief A wrapper which holds a chunk of a tenant. The chunk is returned to the cache of the
+ * tenant when this object is destructed.
+ *
+ * \sa TenantMemory
+ */
+class TenantMemory final : public Memory {
+ public:
+  TenantMemory(void* data, int64_t size, Tenant* tenant, std::shared_ptr<TenantAllocator> allocator)
+      : size(size), tenant(tenant), allocator(std::move(allocator)) {
+    this->data = data;
+    this->device = this->allocator->device();
+  }
+
+  ~TenantMemory() {
+    if (data != nullptr) {
+      allocator->Free(tenant, data, size);
+    }
+  }
+
+ public:
+  /*! \brief The size of the chunk. */
+  int64_t size;
+  /*! \brief The tenant that owns the chunk. */
+  Tenant* tenant;
+  /*! \brief The allocator that owns the tenant. */
+  std::shared_ptr<TenantAllocator> allocator;
+};
+
+/*!
+ * \brief A Memory Pool shared by several tenants, e.g., the VMs of the models co-located on a GPU.
+ * The memory allocated in the scope of TenantScope belongs to the tenant. Like PageUnitPool, each
+ * tenant caches its released chunks by page-rounded sizes for its later requests.
+ *
+ * A tenant can have a reservation and a quota. The reservation is guaranteed: the other tenants
+ * cannot allocate into the unused reservations, and the cached chunks within the reservation are
+ * kept for the tenant. The quota bounds the memory used by the tenant at a time, so that a bursty
+ * tenant fails instead of starving the others. When the pool would exceed the limit specified by
+ * RAF_MEMORY_POOL_SIZE_LIMIT, or the device is out of memory, the cached chunks of the requester
+ * are released, and then the cached chunks of the other tenants beyond their reservations, the
+ * idle tenants first.
+ *
+ * \sa TenantPool
+ */
+class TenantPool final : public MemoryPool {
+ public:
+  explicit TenantPool(Device dev, int64_t pool_limit = 0) {
+    auto api = DeviceAPI::Get(dev.device_type());
+    if (dev.device_type() == DevType::kCUDA()) {
+      api->SetDevice(dev.device_id());
+    }
+    this->allocator = std::make_shared<TenantAllocator>(dev, std::move(api), pool_limit);
+  }
+
+  std::string GetName() {
+    return "tenant_pool";
+  }
+
+  int64_t GetAllocBytes(int64_t nbytes) override {
+    return TenantAllocator::RoundSize(nbytes);
+  }
+
+  std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    CHECK_GE(nbytes, 0);
+    int64_t size = TenantAllocator::RoundSize(nbytes);
+    if (size == 0) {
+      return std::make_shared<TenantMemory>(nullptr, 0, nullptr, allocator);
+    }
+    Tenant* tenant = nullptr;
+    void* data = allocator->Malloc(size, alignment, &tenant);
+    return std::make_shared<TenantMemory>(data, size, tenant, allocator);
+  }
+
+  std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
+                                     int64_t alignment = kDefaultMemoryAlignment) override {
+    LOG(FATAL) << "Please use NoPool to use AllocAsync.";
+    throw;
+  }
+
+  std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
+                                                  int64_t alignment) override {
+    std::vector<std::shared_ptr<Memory>> ret;
+    ret.reserve(nbytes.size());
+    for (int64_t bytes : nbytes) {
+      ret.emplace_back(Alloc(bytes, alignment));
+    }
+    return ret;
+  }
+
+  std::pair<float, float> GetPoolSize() override {
+    auto ret = allocator->GetPoolSize();
+    return {BytesToMegaBytes(ret.first), BytesToMegaBytes(ret.second)};
+  }
+
+  void SetTenant(const std::string& tenant, int64_t reserved_bytes, int64_t quota_bytes) override {
+    allocator->SetTenant(tenant, reserved_bytes, quota_bytes);
+  }
+
+  std::unordered_map<std::string, TenantStats> GetTenantStats() override {
+    return allocator->GetTenantStats();
+  }
+
+ public:
+  static void* make(const Device& dev) {
+    int64_t max_pool_limit = 0;
+    if (const char* val = getenv("RAF_MEMORY_POOL_SIZE_LIMIT")) {
+      max_pool_limit = atol(val);
+    }
+    return new TenantPool(dev, max_pool_limit);
+  }
+
+ protected:
+  /*! \brief The tenant allocator shared with the allocated memory. */
+  std::shared_ptr<TenantAllocator> allocator;
+};
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.tenant_pool").set_body_typed([](const Device& dev) {
+  return TenantPool::make(dev);
+});
+
+}  // namespace tenant_pool
+}  // namespace memory_pool
+}  // namespace raf
@@ -169,6 +169,47 @@ RAF_OP_DECLARE("raf.op._group_reduce_scatter", GroupReduceScatter)
     .set_attr<TOpPattern>("TOpPattern", kOpaque)
     .set_attr<TRAFCollective>("TRAFCollective", true);
 
+/*!
+ * \brief The shape of each output of a _group_comm op, where the allgather concatenates on the
+ * first axis and the reduce-scatter scatters on the first axis.
+ */
+std::vector<int64_t> GroupCommShape(const DLTensor* x, int64_t kind, int size) {
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  if (kind == kGroupAllGather) {
+    shape[0] *= size;
+  } else if (kind == kGroupReduceScatter) {
+    CHECK(shape[0] % size == 0) << "Input tensor with first dim shape " << shape[0]
+                                << " cannot be scattered to " << size << " devices evenly";
+    shape[0] /= size;
+  } else {
+    CHECK_EQ(kind, kGroupAllReduce) << "Unknown collective kind " << kind;
+  }
+  return shape;
+}
+
+void GroupComm(const CallValues& call) {
+  const auto* args = call->args.as<GroupCommArgs>();
+  CHECK(args != nullptr);
+  CHECK_EQ(args->tensor_list.size(), args->kinds.size())
+      << "Expected one collective kind for each tensor";
+  CHECK(!args->tensor_list.empty());
+  int size = GetGlobalCommunicator()->size;
+  std::vector<TensorValue> ret;
+  for (size_t i = 0; i < args->tensor_list.size(); ++i) {
+    const DLTensor* x = args->tensor_list[i];
+    ret.push_back(TensorValue::Assemble(/*dev=*/x->device,
+                                        /*dtype=*/x->dtype,
+                                        /*shape=*/GroupCommShape(x, args->kinds[i], size)));
+  }
+  const DLTensor* first_tensor = args->tensor_list[0];
+  call->device = first_tensor->device;
+  call->out = TupleValue::make(ir::Array<Value>(ret.begin(), ret.end()));
+}
+
+RAF_OP_DECLARE("raf.op._group_comm", GroupComm)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFCollective>("TRAFCollective", true);
+
 void Broadcast(const CallValues& call) {
   const auto* args = call->args.as<BroadcastArgs>();
   CHECK(args != nullptr);
@@ -230,6 +271,31 @@ RAF_OP_DECLARE("raf.op._all_to_all", AllToAll)
     .set_attr<TOpPattern>("TOpPattern", kOpaque)
     .set_attr<TRAFCollective>("TRAFCollective", true);
 
+void AllToAllv(const CallValues& call) {
+  const auto* args = call->args.as<AllToAllvArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* send_counts = args->send_counts;
+  CHECK_EQ(send_counts->ndim, 1) << "The send counts of all_to_allv should be a 1-D tensor";
+  CHECK(send_counts->dtype.code == kDLInt && send_counts->dtype.bits == 64)
+      << "The send counts of all_to_allv should be int64";
+  int64_t n_block = send_counts->shape[0];
+  CHECK_EQ(n_block % GetGlobalCommunicator()->size, 0)
+      << "The number of blocks " << n_block << " cannot be distributed to all ranks evenly";
+  CHECK(x->ndim > 0 && x->shape[0] % n_block == 0)
+      << "The first axis of the input cannot be split into " << n_block << " blocks evenly";
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->device = x->device;
+  call->out = TupleValue::make(
+      {TensorValue::Assemble(/*dev=*/x->device, /*dtype=*/x->dtype, /*shape=*/shape),
+       TensorValue::Assemble(/*dev=*/send_counts->device, /*dtype=*/send_counts->dtype,
+                             /*shape=*/{n_block})});
+}
+
+RAF_OP_DECLARE("raf.op._all_to_allv", AllToAllv)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFCollective>("TRAFCollective", true);
+
 RAF_OP_DECLARE("raf.op._send", Send)
     .set_attr<TOpPattern>("TOpPattern", kOpaque)
     .set_attr<TRAFCollective>("TRAFCollective", true);
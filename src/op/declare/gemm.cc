@@ -10,6 +10,7 @@
 #include "raf/op.h"
 #include "raf/tensor.h"
 #include "../schema/ufunc.h"
+#include "../schema/nn.h"
 
 namespace raf {
 namespace op {
@@ -128,6 +129,94 @@ RAF_OP_DECLARE("raf.op.dense", [](const CallValues& call) {
   }
 });
 
+RAF_OP_DECLARE("raf.op.quantized_dense", [](const CallValues& call) {
+  // N.B.: int8 x int8 -> int32
+  const auto* args = call->args.as<schema::BinaryArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* a = args->x1;
+  const DLTensor* b = args->x2;
+  CHECK_EQ(a->ndim, 2);
+  CHECK_EQ(b->ndim, 2);
+  CHECK(a->dtype.code == kDLInt && a->dtype.bits == 8) << "quantized_dense expects int8 inputs";
+  CHECK(b->dtype.code == kDLInt && b->dtype.bits == 8) << "quantized_dense expects int8 weights";
+  int64_t n1 = a->shape[0];
+  int64_t m1 = a->shape[1];
+  int64_t n2 = b->shape[0];
+  int64_t m2 = b->shape[1];
+  CHECK_EQ(m1, m2);
+  call->out = TensorValue::Assemble(/*dev=*/a->device, /*dtype=*/DType(DTypeCode::kInt(), 32),
+                                    /*shape=*/std::vector<int64_t>{n1, n2});
+  call->device = a->device;
+});
+
+/*!
+ * \brief The dense whose weight in shape [n, k] is 2:4 sparse along k, i.e., at most two of every
+ * four consecutive elements in a row are nonzeros, which runs on the sparse tensor cores.
+ */
+RAF_OP_DECLARE("raf.op.sparse24_dense", [](const CallValues& call) {
+  const auto* args = call->args.as<schema::BinaryArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* a = args->x1;
+  const DLTensor* b = args->x2;
+  CHECK_EQ(a->ndim, 2);
+  CHECK_EQ(b->ndim, 2);
+  CHECK(a->dtype == b->dtype) << "sparse24_dense expects the same dtype for the inputs";
+  int64_t n1 = a->shape[0];
+  int64_t m1 = a->shape[1];
+  int64_t n2 = b->shape[0];
+  int64_t m2 = b->shape[1];
+  CHECK_EQ(m1, m2);
+  CHECK_EQ(m2 % 4, 0) << "sparse24_dense expects the reduction dim to be a multiple of 4";
+  call->out = TensorValue::Assemble(/*dev=*/a->device, /*dtype=*/a->dtype,
+                                    /*shape=*/std::vector<int64_t>{n1, n2});
+  call->device = a->device;
+});
+
+/*!
+ * \brief Prune a weight in shape [n, k] to 2:4 sparse along k, by zeroing the two elements with
+ * the smallest magnitudes in every four consecutive elements of a row.
+ */
+RAF_OP_DECLARE("raf.op.prune_24", [](const CallValues& call) {
+  const auto* args = call->args.as<schema::UnaryArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  CHECK_EQ(x->ndim, 2);
+  CHECK_EQ(x->shape[1] % 4, 0) << "prune_24 expects the last dim to be a multiple of 4";
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device, /*dtype=*/x->dtype, /*shape=*/shape);
+  call->device = x->device;
+});
+
+/*!
+ * \brief A list of differently shaped matmuls, e.g., the expert FFNs of a mixture of experts with
+ * uneven numbers of tokens. Problem i multiplies a[i] in shape [m_i, k_i] and b[i] in shape
+ * [k_i, n_i] ([n_i, k_i] if transpose_b), and the output is a tuple of [m_i, n_i].
+ */
+RAF_OP_DECLARE("raf.op.grouped_matmul", [](const CallValues& call) {
+  const auto* args = call->args.as<schema::GroupedMatmulArgs>();
+  CHECK(args != nullptr);
+  CHECK_EQ(args->a.size(), args->b.size()) << "The a and b should have the same length";
+  CHECK_GE(args->a.size(), 1U);
+  const DLTensor* a0 = args->a[0];
+  CHECK(a0->dtype.code == kDLFloat) << "Only float types are supported!";
+  std::vector<TensorValue> ret;
+  for (size_t i = 0; i < args->a.size(); ++i) {
+    const DLTensor* a = args->a[i];
+    const DLTensor* b = args->b[i];
+    CHECK_EQ(a->ndim, 2);
+    CHECK_EQ(b->ndim, 2);
+    CHECK(a->dtype == a0->dtype && b->dtype == a0->dtype)
+        << "All problems should be in the same dtype";
+    int64_t k = args->transpose_b ? b->shape[1] : b->shape[0];
+    int64_t n = args->transpose_b ? b->shape[0] : b->shape[1];
+    CHECK_EQ(a->shape[1], k) << "The shapes of problem " << i << " are inconsistent";
+    ret.push_back(TensorValue::Assemble(/*dev=*/a0->device, /*dtype=*/a0->dtype,
+                                        /*shape=*/std::vector<int64_t>{a->shape[0], n}));
+  }
+  call->out = TupleValue::make(ir::Array<Value>(ret.begin(), ret.end()));
+  call->device = a0->device;
+});
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
@@ -128,6 +128,38 @@ RAF_OP_DECLARE("raf.op.cross_entropy_dtrue", [](const CallValues& call) {
   call->device = true_->device;
 });
 
+RAF_OP_DECLARE("raf.op.softmax_cross_entropy", [](const CallValues& call) {
+  const auto* args = call->args.as<SoftmaxCrossEntropyArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* pred = args->y_pred;
+  const DLTensor* true_ = args->y_true;
+  CHECK_EQ(pred->ndim, 2) << "Expected y_pred in shape [batch, num_classes], but got "
+                          << pred->ndim << "-D";
+  CHECK_EQ(true_->ndim, 1) << "Expected y_true of the class indices in shape [batch]";
+  CHECK_EQ(pred->shape[0], true_->shape[0]);
+  CHECK(true_->dtype.code == kDLInt) << "Expected integer class indices in y_true";
+  CHECK(args->label_smoothing >= 0 && args->label_smoothing <= 1)
+      << "The label smoothing must be in [0, 1], but got " << args->label_smoothing;
+  // The loss is accumulated and returned in float32 even if the logits are in a lower precision.
+  call->out = TensorValue::Assemble(/*dev=*/pred->device,
+                                    /*dtype=*/DType(DTypeCode::kFloat(), 32),
+                                    /*shape=*/std::vector<int64_t>{1});
+  call->device = pred->device;
+}).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+RAF_OP_DECLARE("raf.op.softmax_cross_entropy_dpred", [](const CallValues& call) {
+  const auto* args = call->args.as<SoftmaxCrossEntropyDpredArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* pred = args->y_pred;
+  const DLTensor* true_ = args->y_true;
+  CHECK_EQ(pred->ndim, 2);
+  CHECK_EQ(true_->ndim, 1);
+  CHECK_EQ(pred->shape[0], true_->shape[0]);
+  call->out = TensorValue::Assemble(pred->device, pred->dtype,
+                                    std::vector<int64_t>{pred->shape[0], pred->shape[1]});
+  call->device = pred->device;
+}).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
@@ -34,9 +34,21 @@ RAF_OP_DECLARE("raf.op.device_copy", [](const CallValues& call) {
   auto dst_device = Device((tvm::Device)(*str2dev)(args->dst_device));
   CHECK(data_device == src_device);
 
-  call->out = TensorValue::Assemble(/*dev=*/dst_device,
-                                    /*dtype=*/data->dtype,
-                                    /*shape=*/shape);
+  if (dst_device.device_type() == DevType::kCPU() &&
+      src_device.device_type() == DevType::kCUDA() && IsCompact(*data)) {
+    // Copy to pinned memory so that the copy runs at full bandwidth.
+    auto mem = memory_pool::Memory::AllocHost(src_device, BytesCompactTensor(*data));
+    call->out = TensorValue::Assemble(/*dev=*/dst_device,
+                                      /*dtype=*/data->dtype,
+                                      /*shape=*/shape,
+                                      /*strides=*/{},
+                                      /*data=*/mem->data,
+                                      /*mem=*/mem);
+  } else {
+    call->out = TensorValue::Assemble(/*dev=*/dst_device,
+                                      /*dtype=*/data->dtype,
+                                      /*shape=*/shape);
+  }
   call->device = dst_device;
 }).set_attr<TOpPattern>("TOpPattern", kOpaque);
 
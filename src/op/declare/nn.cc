@@ -95,6 +95,21 @@ void Conv2D(const CallValues& call) {
 
 RAF_OP_DECLARE("raf.op.conv2d", Conv2D);
 
+RAF_OP_DECLARE("raf.op.quantized_conv2d", [](const CallValues& call) {
+  // N.B.: int8 x int8 -> int32, whose shape is the same as conv2d
+  const auto* args = call->args.as<ConvArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* w = args->w;
+  CHECK(x->dtype.code == kDLInt && x->dtype.bits == 8) << "quantized_conv2d expects int8 inputs";
+  CHECK(w->dtype.code == kDLInt && w->dtype.bits == 8) << "quantized_conv2d expects int8 weights";
+  Conv2D(call);
+  const DLTensor* out = Downcast<TensorValue>(call->out);
+  std::vector<int64_t> shape(out->shape, out->shape + out->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device, /*dtype=*/DType(DTypeCode::kInt(), 32),
+                                    /*shape=*/shape);
+});
+
 void Conv2dTrans(const CallValues& call) {
   // N.B.: NCHW + IOHW
   const auto* args = call->args.as<ConvTransArgs>();
@@ -292,6 +307,32 @@ RAF_OP_DECLARE("raf.op.batch_norm_train", [](const CallValues& call) {
   call->device = x->device;
 }).set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{1, 1}, {2, 2}});
 
+RAF_OP_DECLARE("raf.op.batch_norm_relu_train", [](const CallValues& call) {
+  const auto* args = call->args.as<BatchNormReluArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  TensorValue y = TensorValue::Assemble(/*dev=*/x->device,
+                                        /*dtype=*/x->dtype,
+                                        /*shape=*/shape);
+  TensorValue running_mean = Downcast<TensorValue>(args->running_mean);
+  std::vector<int64_t> running_mean_shape(running_mean->tensor.Shape().begin(),
+                                          running_mean->tensor.Shape().end());
+  running_mean = running_mean.CreateView(running_mean_shape);
+  TensorValue running_var = Downcast<TensorValue>(args->running_var);
+  std::vector<int64_t> running_var_shape(running_var->tensor.Shape().begin(),
+                                         running_var->tensor.Shape().end());
+  running_var = running_var.CreateView(running_var_shape);
+  // The reserve space keeps the activation mask for the backward.
+  int64_t reserve_space_bytes =
+      GetBatchNormReluReserveSpaceBytes(GetType(args->x), args->layout, args->z.defined());
+  TensorValue reserve_space = TensorValue::Assemble(/*dev=*/x->device,
+                                                    /*dtype=*/DType(DTypeCode::kUInt(), 8),
+                                                    /*shape=*/{reserve_space_bytes});
+  call->out = TupleValue::make(tvm::Array<Value>({y, running_mean, running_var, reserve_space}));
+  call->device = x->device;
+}).set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{1, 1}, {2, 2}});
+
 RAF_OP_DECLARE("raf.op.batch_norm_infer", [](const CallValues& call) {
   // FIXME(@were): please fix this: bn-infer should only output y
   const auto* args = call->args.as<BatchNormArgs>();
@@ -375,6 +416,33 @@ RAF_OP_DECLARE("raf.op.batch_norm_train_dxwb", [](const CallValues& call) {
   call->device = x->device;
 });
 
+RAF_OP_DECLARE("raf.op.batch_norm_relu_train_dxwb", [](const CallValues& call) {
+  const auto* args = call->args.as<BatchNormReluDxwbArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  std::vector<int64_t> xshape(x->shape, x->shape + x->ndim);
+  TensorValue dx = TensorValue::Assemble(/*dev=*/x->device,
+                                         /*dtype=*/x->dtype,
+                                         /*shape=*/xshape);
+  const DLTensor* w = args->w;
+  std::vector<int64_t> wshape(w->shape, w->shape + w->ndim);
+  TensorValue dw = TensorValue::Assemble(/*dev=*/w->device,
+                                         /*dtype=*/w->dtype,
+                                         /*shape=*/wshape);
+  TensorValue db = TensorValue::Assemble(/*dev=*/w->device,
+                                         /*dtype=*/w->dtype,
+                                         /*shape=*/wshape);
+  tvm::Array<Value> fields({dx, dw, db});
+  if (args->with_z) {
+    // The gradient of the residual input, which is the masked dy.
+    fields.push_back(TensorValue::Assemble(/*dev=*/x->device,
+                                           /*dtype=*/x->dtype,
+                                           /*shape=*/xshape));
+  }
+  call->out = TupleValue::make(fields);
+  call->device = x->device;
+});
+
 void BiasAdd(const CallValues& call) {
   const auto* args = call->args.as<BiasAddArgs>();
   CHECK(args != nullptr);
@@ -397,15 +465,11 @@ void ContribDropout(const CallValues& call) {
   const DLTensor* x = args->x;
   std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
   std::vector<int64_t> reserve_space_shape;
-  // The CUDNN compute generates reserve_space for backward usage.
-#ifdef RAF_USE_CUDA
-  const tvm::runtime::PackedFunc* pf =
-      tvm::runtime::Registry::Get("raf.backend.cudnn.GetDropoutReserveSpaceSizeInBytes");
-  if (include_reserve_space && pf) {
-    Integer reserve_space_size_in_bytes = (*pf)(GetType(args->x));
-    reserve_space_shape.push_back(reserve_space_size_in_bytes->value);
+  // The CUDNN and CUDA computes generate reserve_space for backward usage.
+  int64_t reserve_space_bytes = GetDropoutReserveSpaceBytes(GetType(args->x));
+  if (include_reserve_space && reserve_space_bytes > 0) {
+    reserve_space_shape.push_back(reserve_space_bytes);
   }
-#endif
   TensorValue output = TensorValue::Assemble(/*dev=*/x->device,
                                              /*dtype=*/x->dtype,
                                              /*shape=*/shape);
@@ -432,6 +496,27 @@ RAF_OP_DECLARE("raf.op._contrib_dropout", ContribDropoutBase);
 RAF_OP_DECLARE("raf.op.tvm._contrib_dropout", ContribDropoutTVM);
 RAF_OP_DECLARE("raf.op.cudnn._contrib_dropout", ContribDropoutCudnn);
 
+/*! \brief The CUDA dropout regenerates the mask from the Philox state in the reserve space. */
+void ContribDropoutCUDA(const CallValues& call) {
+  const auto* args = call->args.as<DropoutArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  TensorValue output = TensorValue::Assemble(/*dev=*/x->device,
+                                             /*dtype=*/x->dtype,
+                                             /*shape=*/shape);
+  TensorValue mask = TensorValue::Assemble(/*dev=*/x->device,
+                                           /*dtype=*/DType(DTypeCode::kFloat(), 32),
+                                           /*shape=*/{});
+  TensorValue reserve_space = TensorValue::Assemble(/*dev=*/x->device,
+                                                    /*dtype=*/DType(DTypeCode::kUInt(), 8),
+                                                    /*shape=*/{kDropoutPhiloxStateBytes});
+  call->out = TupleValue::make(tvm::Array<Value>({output, mask, reserve_space}));
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op.cuda._contrib_dropout", ContribDropoutCUDA);
+
 void DropoutDx(const CallValues& call) {
   const auto* args = call->args.as<DropoutDxArgs>();
   CHECK(args != nullptr);
@@ -611,6 +696,198 @@ void LayerNormTrain(const CallValues& call) {
 }
 RAF_OP_DECLARE("raf.op.layer_norm_train", LayerNormTrain);
 
+void AddDropoutLayerNorm(const CallValues& call) {
+  const auto* args = call->args.as<AddDropoutLayerNormArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* residual = args->residual;
+  CHECK_EQ(x->ndim, residual->ndim) << "x and residual must have the same rank";
+  for (int i = 0; i < x->ndim; ++i) {
+    CHECK_EQ(x->shape[i], residual->shape[i]) << "x and residual must have the same shape";
+  }
+  CHECK_EQ(args->scale.defined(), args->bias.defined())
+      << "scale and bias must be either both given or both omitted";
+  if (args->scale.defined()) {
+    const DLTensor* scale = args->scale.value();
+    CHECK(scale->ndim == 1 && scale->shape[0] == x->shape[x->ndim - 1])
+        << "scale must be in the shape of the last dimension of x";
+  }
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  int64_t n = 1;
+  for (int i = 0; i < x->ndim - 1; ++i) {
+    n *= x->shape[i];
+  }
+  TensorValue y = TensorValue::Assemble(/*dev=*/x->device,
+                                        /*dtype=*/x->dtype,
+                                        /*shape=*/shape);
+  TensorValue z = TensorValue::Assemble(/*dev=*/x->device,
+                                        /*dtype=*/x->dtype,
+                                        /*shape=*/shape);
+  TensorValue mean = TensorValue::Assemble(/*dev=*/x->device,
+                                           /*dtype=*/String2DLDataType("float32"),
+                                           /*shape=*/{n});
+  TensorValue invvar = TensorValue::Assemble(/*dev=*/x->device,
+                                             /*dtype=*/String2DLDataType("float32"),
+                                             /*shape=*/{n});
+  TensorValue rng_state = TensorValue::Assemble(/*dev=*/x->device,
+                                                /*dtype=*/DType(DTypeCode::kInt(), 64),
+                                                /*shape=*/{1});
+  call->out = TupleValue::make(tvm::Array<Value>({y, z, mean, invvar, rng_state}));
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op.add_dropout_layer_norm", AddDropoutLayerNorm)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+void AddDropoutLayerNormDx(const CallValues& call) {
+  const auto* args = call->args.as<AddDropoutLayerNormDxArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* z = args->z;
+  std::vector<int64_t> shape(z->shape, z->shape + z->ndim);
+  TensorValue dx = TensorValue::Assemble(/*dev=*/z->device,
+                                         /*dtype=*/z->dtype,
+                                         /*shape=*/shape);
+  TensorValue dresidual = TensorValue::Assemble(/*dev=*/z->device,
+                                                /*dtype=*/z->dtype,
+                                                /*shape=*/shape);
+  if (args->scale.defined()) {
+    const DLTensor* w = args->scale.value();
+    std::vector<int64_t> wshape(w->shape, w->shape + w->ndim);
+    TensorValue dw = TensorValue::Assemble(/*dev=*/w->device,
+                                           /*dtype=*/w->dtype,
+                                           /*shape=*/wshape);
+    TensorValue db = TensorValue::Assemble(/*dev=*/w->device,
+                                           /*dtype=*/w->dtype,
+                                           /*shape=*/wshape);
+    call->out = TupleValue::make(tvm::Array<Value>({dx, dresidual, dw, db}));
+  } else {
+    call->out = TupleValue::make(tvm::Array<Value>({dx, dresidual}));
+  }
+  call->device = z->device;
+}
+
+RAF_OP_DECLARE("raf.op.add_dropout_layer_norm_dx", AddDropoutLayerNormDx)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+void RMSNorm(const CallValues& call) {
+  const auto* args = call->args.as<RmsNormArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  if (args->scale.defined()) {
+    const DLTensor* scale = args->scale.value();
+    CHECK(scale->ndim == 1 && scale->shape[0] == x->shape[x->ndim - 1])
+        << "scale must be in the shape of the last dimension of x";
+  }
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/x->dtype,
+                                    /*shape=*/shape);
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op.rms_norm", RMSNorm).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+void RMSNormDx(const CallValues& call) {
+  const auto* args = call->args.as<RmsNormDxArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  TensorValue dx = TensorValue::Assemble(/*dev=*/x->device,
+                                         /*dtype=*/x->dtype,
+                                         /*shape=*/shape);
+  if (args->scale.defined()) {
+    const DLTensor* w = args->scale.value();
+    std::vector<int64_t> wshape(w->shape, w->shape + w->ndim);
+    TensorValue dw = TensorValue::Assemble(/*dev=*/w->device,
+                                           /*dtype=*/w->dtype,
+                                           /*shape=*/wshape);
+    call->out = TupleValue::make(tvm::Array<Value>({dx, dw}));
+  } else {
+    call->out = dx;
+  }
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op.rms_norm_dx", RMSNormDx).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+void RotaryEmbedding(const CallValues& call) {
+  const auto* args = call->args.as<RotaryEmbeddingArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* cos = args->cos;
+  const DLTensor* sin = args->sin;
+  int seq_axis = args->seq_axis < 0 ? args->seq_axis + x->ndim : args->seq_axis;
+  CHECK(seq_axis >= 0 && seq_axis < x->ndim - 1)
+      << "seq_axis must be an axis of x other than the last (head) axis, but got "
+      << args->seq_axis;
+  CHECK(cos->ndim == 2 && sin->ndim == 2) << "cos and sin must be in shape [seq, rot_dim / 2]";
+  CHECK(cos->shape[0] == sin->shape[0] && cos->shape[1] == sin->shape[1])
+      << "cos and sin must have the same shape";
+  CHECK_EQ(cos->shape[0], x->shape[seq_axis]) << "cos and sin must have a row per position";
+  CHECK_LE(cos->shape[1] * 2, x->shape[x->ndim - 1])
+      << "The rotary dimension must not exceed the head dimension";
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/x->dtype,
+                                    /*shape=*/shape);
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op.rotary_embedding", RotaryEmbedding)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+void Attention(const CallValues& call) {
+  const auto* args = call->args.as<AttentionArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* q = args->q;
+  const DLTensor* k = args->k;
+  const DLTensor* v = args->v;
+  CHECK_GE(q->ndim, 3) << "Expected q in shape [..., seq_q, head_dim], but got " << q->ndim
+                       << "-D";
+  CHECK(q->ndim == k->ndim && q->ndim == v->ndim) << "q, k and v must have the same rank";
+  for (int i = 0; i < q->ndim - 2; ++i) {
+    CHECK(q->shape[i] == k->shape[i] && q->shape[i] == v->shape[i])
+        << "q, k and v must have the same batch dimensions";
+  }
+  CHECK_EQ(k->shape[k->ndim - 2], v->shape[v->ndim - 2]) << "k and v must have the same length";
+  CHECK(q->shape[q->ndim - 1] == k->shape[k->ndim - 1] &&
+        q->shape[q->ndim - 1] == v->shape[v->ndim - 1])
+      << "q, k and v must have the same head dimension";
+  std::vector<int64_t> shape(q->shape, q->shape + q->ndim);
+  std::vector<int64_t> lse_shape(q->shape, q->shape + q->ndim - 1);
+  TensorValue out = TensorValue::Assemble(/*dev=*/q->device,
+                                          /*dtype=*/q->dtype,
+                                          /*shape=*/shape);
+  TensorValue lse = TensorValue::Assemble(/*dev=*/q->device,
+                                          /*dtype=*/DType(DTypeCode::kFloat(), 32),
+                                          /*shape=*/lse_shape);
+  TensorValue rng_state = TensorValue::Assemble(/*dev=*/q->device,
+                                                /*dtype=*/DType(DTypeCode::kInt(), 64),
+                                                /*shape=*/{1});
+  call->out = TupleValue::make(tvm::Array<Value>({out, lse, rng_state}));
+  call->device = q->device;
+}
+
+RAF_OP_DECLARE("raf.op.attention", Attention).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+void AttentionDx(const CallValues& call) {
+  const auto* args = call->args.as<AttentionDxArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* q = args->q;
+  const DLTensor* k = args->k;
+  const DLTensor* v = args->v;
+  auto grad_like = [](const DLTensor* x) {
+    std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+    return TensorValue::Assemble(/*dev=*/x->device,
+                                 /*dtype=*/x->dtype,
+                                 /*shape=*/shape);
+  };
+  call->out = TupleValue::make(tvm::Array<Value>({grad_like(q), grad_like(k), grad_like(v)}));
+  call->device = q->device;
+}
+
+RAF_OP_DECLARE("raf.op.attention_dx", AttentionDx).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
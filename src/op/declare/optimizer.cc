@@ -60,6 +60,92 @@ void LansDecl(const CallValues& call) {
 RAF_OP_DECLARE("raf.op.lans", LansDecl)
     .set_attr<TOpPattern>("TOpPattern", kOpaque)
     .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+/*!
+ * \brief Check the tensor list of a multi-tensor optimizer, which consists of `num_groups` groups
+ * of tensors (e.g., gradients, weights and states), and a trailing group of float16 parameters
+ * if fp16_params is true. All tensors in the same position of each group have the same shape.
+ * The whole tensor list is updated in place and returned.
+ */
+void MultiTensorOptimizerDecl(const CallValues& call, const std::vector<BaseTensorValue>& tensors,
+                              int num_groups, bool fp16_params) {
+  if (fp16_params) {
+    num_groups += 1;
+  }
+  CHECK(!tensors.empty());
+  CHECK_EQ(tensors.size() % num_groups, 0)
+      << "Expected " << num_groups << " groups of tensors, but got " << tensors.size();
+  int ntensors = tensors.size() / num_groups;
+  for (int i = 0; i < ntensors; ++i) {
+    const DLTensor* g = tensors[i];
+    for (int j = 1; j < num_groups; ++j) {
+      const DLTensor* t = tensors[j * ntensors + i];
+      CHECK_EQ(t->ndim, g->ndim);
+      for (int k = 0; k < g->ndim; ++k) {
+        CHECK_EQ(t->shape[k], g->shape[k]);
+      }
+    }
+  }
+  const DLTensor* x = tensors[0];
+  call->device = x->device;
+  Array<Value> output;
+  for (const auto& tensor : tensors) {
+    output.push_back(tensor);
+  }
+  call->out = TupleValue::make(output);
+}
+
+RAF_OP_DECLARE("raf.op.multi_tensor_sgd", [](const CallValues& call) {
+  const auto* args = call->args.as<MultiTensorSgdArgs>();
+  CHECK(args != nullptr);
+  MultiTensorOptimizerDecl(call, args->tensor_list, 3, args->fp16_params);
+})
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+RAF_OP_DECLARE("raf.op.multi_tensor_adam", [](const CallValues& call) {
+  const auto* args = call->args.as<MultiTensorAdamArgs>();
+  CHECK(args != nullptr);
+  CHECK(args->mode == 0 || args->mode == 1) << "Unknown Adam mode " << args->mode;
+  MultiTensorOptimizerDecl(call, args->tensor_list, 4, args->fp16_params);
+})
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+RAF_OP_DECLARE("raf.op.global_norm_and_check", [](const CallValues& call) {
+  const auto* args = call->args.as<GlobalNormAndCheckArgs>();
+  CHECK(args != nullptr);
+  CHECK(!args->tensor_list.empty());
+  const DLTensor* x = args->tensor_list[0];
+  call->device = x->device;
+  auto norm = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/DType(DTypeCode::kFloat(), 32),
+                                    /*shape=*/std::vector<int64_t>());
+  auto found_inf = TensorValue::Assemble(/*dev=*/x->device,
+                                         /*dtype=*/DType(DTypeCode::kUInt(), 1),
+                                         /*shape=*/std::vector<int64_t>());
+  call->out = TupleValue::make(tvm::Array<Value>({norm, found_inf}));
+}).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+RAF_OP_DECLARE("raf.op.update_loss_scale", [](const CallValues& call) {
+  const auto* args = call->args.as<UpdateLossScaleArgs>();
+  CHECK(args != nullptr);
+  for (const DLTensor* t : {args->grad_norm, args->loss_scale, args->good_steps}) {
+    CHECK(t->ndim == 0 && t->dtype.code == kDLFloat && t->dtype.bits == 32)
+        << "update_loss_scale expects float32 scalars";
+  }
+  CHECK_GT(args->growth_factor, 1.0f);
+  CHECK(args->backoff_factor > 0.0f && args->backoff_factor < 1.0f);
+  CHECK_GT(args->growth_interval, 0);
+  const DLTensor* x = args->loss_scale;
+  call->device = x->device;
+  auto scalar = [&]() {
+    return TensorValue::Assemble(/*dev=*/x->device,
+                                 /*dtype=*/DType(DTypeCode::kFloat(), 32),
+                                 /*shape=*/std::vector<int64_t>());
+  };
+  call->out = TupleValue::make(tvm::Array<Value>({scalar(), scalar()}));
+}).set_attr<TOpPattern>("TOpPattern", kOpaque);
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
@@ -54,6 +54,37 @@ RAF_OP_DECLARE("raf.op.threefry_split", [](const CallValues& call) {
   call->device = key->device;
 });
 
+/*!
+ * \brief Declare a tensor of the given shape and dtype drawn from a distribution by the
+ * counter-based Threefry generator, where the value at each position only depends on the key and
+ * the position. The key is not updated, so a fresh key is expected from threefry_split.
+ */
+void ThreefryDistributionDecl(const CallValues& call, const DLTensor* key,
+                              const std::vector<int64_t>& shape, const std::string& dtype) {
+  CHECK_EQ(tvm::runtime::DLDataType2String(key->dtype), "uint64")
+      << "The type of key must be uint64";
+  CHECK_EQ(key->ndim, 1) << "The key must be 1-D";
+  CHECK(dtype == "float32" || dtype == "float16")
+      << "Only float32 and float16 are supported, but got " << dtype;
+  call->out = TensorValue::Assemble(/*dev=*/key->device,
+                                    /*dtype=*/ir::String2DLDataType(dtype),
+                                    /*shape=*/shape);
+  call->device = key->device;
+}
+
+RAF_OP_DECLARE("raf.op.threefry_uniform", [](const CallValues& call) {
+  const auto* args = call->args.as<ThreefryUniformArgs>();
+  CHECK(args != nullptr);
+  ThreefryDistributionDecl(call, args->key, args->shape, args->dtype);
+});
+
+RAF_OP_DECLARE("raf.op.threefry_normal", [](const CallValues& call) {
+  const auto* args = call->args.as<ThreefryNormalArgs>();
+  CHECK(args != nullptr);
+  CHECK_GE(args->stddev, 0) << "The standard deviation must be non-negative";
+  ThreefryDistributionDecl(call, args->key, args->shape, args->dtype);
+});
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
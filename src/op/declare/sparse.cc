@@ -0,0 +1,105 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/declare/sparse.cc
+ * \brief Declaration of sparse matrix operators. A sparse matrix A in shape [m, k] is in the CSR
+ * format of three tensors: indptr in shape [m + 1], and indices and values in shape [nnz], where
+ * the non-zeros of row i are values[indptr[i]:indptr[i + 1]] at columns
+ * indices[indptr[i]:indptr[i + 1]].
+ */
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/tensor.h"
+#include "../schema/sparse.h"
+
+namespace raf {
+namespace op {
+namespace declare {
+
+using namespace raf::op::schema;
+using namespace raf::value;
+
+void CheckCSR(const DLTensor* indptr, const DLTensor* indices, const DLTensor* values) {
+  CHECK_EQ(indptr->ndim, 1) << "The indptr should be in shape [m + 1]";
+  CHECK_GE(indptr->shape[0], 1) << "The indptr should be in shape [m + 1]";
+  CHECK_EQ(indices->ndim, 1) << "The indices should be in shape [nnz]";
+  CHECK(indptr->dtype.code == kDLInt && indices->dtype.code == kDLInt)
+      << "The indptr and indices should be integers";
+  CHECK(indptr->dtype == indices->dtype) << "The indptr and indices should be in the same dtype";
+  if (values != nullptr) {
+    CHECK_EQ(values->ndim, 1) << "The values should be in shape [nnz]";
+    CHECK_EQ(values->shape[0], indices->shape[0]) << "Each non-zero should have a column";
+  }
+}
+
+/*!
+ * \brief The product of a CSR matrix A in shape [m, k] and a dense matrix in shape [k, n]. The
+ * output is a dense matrix in shape [m, n].
+ */
+RAF_OP_DECLARE("raf.op.csr_spmm", [](const CallValues& call) {
+  const auto* args = call->args.as<CsrSpmmArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* values = args->values;
+  const DLTensor* dense = args->dense;
+  CheckCSR(args->indptr, args->indices, values);
+  CHECK_EQ(dense->ndim, 2);
+  CHECK(values->dtype == dense->dtype) << "The values should be in the same dtype as the dense";
+  CHECK(dense->dtype.code == kDLFloat) << "Only float types are supported!";
+  int64_t m = static_cast<const DLTensor*>(args->indptr)->shape[0] - 1;
+  call->out = TensorValue::Assemble(/*dev=*/dense->device, /*dtype=*/dense->dtype,
+                                    /*shape=*/std::vector<int64_t>{m, dense->shape[1]});
+  call->device = dense->device;
+});
+
+/*!
+ * \brief The product of the transpose of a CSR matrix A in shape [m, k] and a dense matrix in
+ * shape [m, n], e.g., the gradient of the dense operand of csr_spmm. The output shape [k, n] is
+ * given because k is not known from the CSR tensors.
+ */
+RAF_OP_DECLARE("raf.op.csr_spmm_tn", [](const CallValues& call) {
+  const auto* args = call->args.as<CsrSpmmTnArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* values = args->values;
+  const DLTensor* dense = args->dense;
+  CheckCSR(args->indptr, args->indices, values);
+  CHECK_EQ(dense->ndim, 2);
+  CHECK_EQ(static_cast<const DLTensor*>(args->indptr)->shape[0] - 1, dense->shape[0]);
+  CHECK(values->dtype == dense->dtype) << "The values should be in the same dtype as the dense";
+  CHECK(dense->dtype.code == kDLFloat) << "Only float types are supported!";
+  std::vector<int64_t> shape = GetShapeVecFromValue(args->shape);
+  CHECK_EQ(shape.size(), 2);
+  CHECK_EQ(shape[1], dense->shape[1]);
+  call->out = TensorValue::Assemble(/*dev=*/dense->device, /*dtype=*/dense->dtype,
+                                    /*shape=*/shape);
+  call->device = dense->device;
+});
+
+/*!
+ * \brief The sampled dense-dense matrix product: the product of x1 in shape [m, d] and the
+ * transpose of x2 in shape [k, d], sampled at the non-zeros of a CSR matrix in shape [m, k]. The
+ * output is the values of the product in shape [nnz], in the order of the indices.
+ */
+RAF_OP_DECLARE("raf.op.csr_sddmm", [](const CallValues& call) {
+  const auto* args = call->args.as<CsrSddmmArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* indices = args->indices;
+  const DLTensor* x1 = args->x1;
+  const DLTensor* x2 = args->x2;
+  CheckCSR(args->indptr, indices, nullptr);
+  CHECK_EQ(x1->ndim, 2);
+  CHECK_EQ(x2->ndim, 2);
+  CHECK_EQ(static_cast<const DLTensor*>(args->indptr)->shape[0] - 1, x1->shape[0]);
+  CHECK_EQ(x1->shape[1], x2->shape[1]);
+  CHECK(x1->dtype == x2->dtype);
+  CHECK(x1->dtype.code == kDLFloat) << "Only float types are supported!";
+  call->out = TensorValue::Assemble(/*dev=*/x1->device, /*dtype=*/x1->dtype,
+                                    /*shape=*/std::vector<int64_t>{indices->shape[0]});
+  call->device = x1->device;
+});
+
+}  // namespace declare
+}  // namespace op
+}  // namespace raf
@@ -290,6 +290,127 @@ RAF_OP_DECLARE("raf.op.embedding_dx", [](const CallValues& call) {
   call->device = dy->device;
 });
 
+/*!
+ * \brief The sparse gradient of embedding, in which the row of each distinct index is summed only
+ * once. The output is a tuple of (rows, values), where rows is in shape [n] and values is in shape
+ * [n, hidden...] for n indices. The first #distinct rows are the distinct indices in ascending
+ * order, and the rest are padded with -1 whose values are zeros.
+ */
+RAF_OP_DECLARE("raf.op.embedding_dx_sparse", [](const CallValues& call) {
+  const auto* args = call->args.as<EmbeddingDxArgs>();
+  CHECK(args != nullptr);
+  DLTensor* dy = args->dy;
+  DLTensor* indices = args->indices;
+  std::vector<int64_t> num_weight = GetShapeVecFromValue(args->num_weight);
+  CHECK_EQ(dy->ndim, indices->ndim + num_weight.size() - 1);
+  int64_t n = 1;
+  for (int i = 0; i < indices->ndim; ++i) {
+    CHECK_EQ(dy->shape[i], indices->shape[i]);
+    n *= indices->shape[i];
+  }
+  std::vector<int64_t> shape{n};
+  shape.insert(shape.end(), num_weight.begin() + 1, num_weight.end());
+  auto rows = TensorValue::Assemble(/*dev=*/dy->device,
+                                    /*dtype=*/DType(DTypeCode::kInt(), 64),
+                                    /*shape=*/{n});
+  auto values = TensorValue::Assemble(/*dev=*/dy->device,
+                                      /*dtype=*/dy->dtype,
+                                      /*shape=*/shape);
+  call->out = TupleValue::make(tvm::Array<Value>({rows, values}));
+  call->device = dy->device;
+}).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+/*!
+ * \brief The sum of the embedding lookups of the tokens and of their positions, i.e.,
+ * take(x, indices) + take(position, position_ids), where position_ids is in the same shape as
+ * indices.
+ */
+RAF_OP_DECLARE("raf.op.embedding_position", [](const CallValues& call) {
+  const auto* args = call->args.as<EmbeddingPositionArgs>();
+  CHECK(args != nullptr);
+  DLTensor* x = args->x;
+  DLTensor* indices = args->indices;
+  DLTensor* position = args->position;
+  DLTensor* position_ids = args->position_ids;
+  CHECK_EQ(x->ndim, position->ndim);
+  for (int i = 1; i < x->ndim; ++i) {
+    CHECK_EQ(x->shape[i], position->shape[i]);
+  }
+  CHECK_EQ(indices->ndim, position_ids->ndim);
+  for (int i = 0; i < indices->ndim; ++i) {
+    CHECK_EQ(indices->shape[i], position_ids->shape[i])
+        << "position_ids should be in the same shape as indices";
+  }
+  CHECK(x->dtype == position->dtype);
+  std::vector<int64_t> shape(indices->shape, indices->shape + indices->ndim);
+  shape.insert(shape.end(), x->shape + 1, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/x->dtype,
+                                    /*shape=*/shape);
+  call->device = x->device;
+}).set_attr<TOpPattern>("TOpPattern", kInjective);
+
+/*! \brief Check the table and the row cache of embedding_cache and embedding_cache_sgd. */
+void CheckEmbeddingCache(const DLTensor* table, const DLTensor* tags, const DLTensor* rows) {
+  CHECK_GE(table->ndim, 2) << "The table should be in shape [num_rows, hidden...]";
+  CHECK(tags->ndim == 3 && tags->shape[1] >= 2 && tags->shape[2] == 3)
+      << "The tags should be in shape [num_sets, 1 + num_ways, 3]";
+  CHECK(tags->dtype.code == kDLInt && tags->dtype.bits == 64) << "The tags should be int64";
+  CHECK_LE(tags->shape[1] - 1, 32) << "A set has at most 32 ways";
+  CHECK_EQ(rows->ndim, table->ndim);
+  CHECK_EQ(rows->shape[0], tags->shape[0] * (tags->shape[1] - 1))
+      << "The cache should have a row per way";
+  for (int i = 1; i < table->ndim; ++i) {
+    CHECK_EQ(rows->shape[i], table->shape[i])
+        << "The cached rows should be in the same shape as those in the table";
+  }
+  CHECK(rows->dtype == table->dtype) << "The cache should be in the same dtype as the table";
+}
+
+/*!
+ * \brief The embedding lookup of a table through its set-associative row cache on the device,
+ * i.e., take(table, indices). The table is usually in pinned host memory mapped to the device. The
+ * missed rows are read from the table and then filled into the cache, replacing the least recently
+ * used row of the set, which is written back to the table if dirty. The tags, the cached rows and
+ * the table are updated in place. The op only has a CUDA implementation.
+ */
+RAF_OP_DECLARE("raf.op.embedding_cache", [](const CallValues& call) {
+  const auto* args = call->args.as<EmbeddingCacheArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* table = args->table;
+  const DLTensor* indices = args->indices;
+  const DLTensor* rows = args->rows;
+  CheckEmbeddingCache(table, args->tags, rows);
+  std::vector<int64_t> shape(indices->shape, indices->shape + indices->ndim);
+  shape.insert(shape.end(), table->shape + 1, table->shape + table->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/rows->device,
+                                    /*dtype=*/rows->dtype,
+                                    /*shape=*/shape);
+  call->device = rows->device;
+}).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+/*!
+ * \brief Apply the SGD update of the gradient dy of embedding_cache to the table. The rows kept by
+ * the cache are updated there and marked dirty, so they reach the table once evicted, and the
+ * others are updated in the table directly. The updated cache is the output.
+ */
+RAF_OP_DECLARE("raf.op.embedding_cache_sgd", [](const CallValues& call) {
+  const auto* args = call->args.as<EmbeddingCacheSgdArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* table = args->table;
+  const DLTensor* dy = args->dy;
+  const DLTensor* indices = args->indices;
+  CheckEmbeddingCache(table, args->tags, args->rows);
+  CHECK_EQ(dy->ndim, indices->ndim + table->ndim - 1);
+  for (int i = 0; i < indices->ndim; ++i) {
+    CHECK_EQ(dy->shape[i], indices->shape[i]);
+  }
+  CHECK(dy->dtype == table->dtype) << "The gradient should be in the same dtype as the table";
+  call->out = args->rows;
+  call->device = args->rows->device;
+}).set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{4, 0}});
+
 RAF_OP_DECLARE("raf.op.expand_dims", [](const CallValues& call) {
   const auto* args = call->args.as<ExpandDimsArgs>();
   CHECK(args != nullptr);
@@ -557,8 +678,14 @@ RAF_OP_DECLARE("raf.op.transpose", [](const CallValues& call) {
       oshape[i] = ishape[ndim - i - 1];
     }
   }
-  call->out = TensorValue::Assemble(x->device, x->dtype, oshape);
   call->device = x->device;
+  if (IsCompact(*x) && IsOrderPreservingTranspose({ishape, ishape + ndim}, axes)) {
+    // Only the axes of size 1 are moved, so the output is a view of the input.
+    call->callee = ir::NullValue<OpValue>();
+    call->out = Downcast<TensorValue>(args->x).CreateView(oshape);
+    return;
+  }
+  call->out = TensorValue::Assemble(x->device, x->dtype, oshape);
 });
 
 RAF_OP_DECLARE("raf.op.transpose_dx", [](const CallValues& call) {
@@ -621,8 +748,16 @@ RAF_OP_DECLARE("raf.op.swap_axis", [](const CallValues& call) {
   int temp = shape[axis2];
   shape[axis2] = shape[axis1];
   shape[axis1] = temp;
-  call->out = TensorValue::Assemble(x->device, x->dtype, shape);
   call->device = x->device;
+  std::vector<int64_t> axes(ndim);
+  std::iota(axes.begin(), axes.end(), 0);
+  std::swap(axes[axis1], axes[axis2]);
+  if (IsCompact(*x) && IsOrderPreservingTranspose({x->shape, x->shape + ndim}, axes)) {
+    call->callee = ir::NullValue<OpValue>();
+    call->out = Downcast<TensorValue>(args->x).CreateView(shape);
+    return;
+  }
+  call->out = TensorValue::Assemble(x->device, x->dtype, shape);
 });
 
 void BinaryShapeLike(const CallValues& call) {
@@ -843,6 +978,55 @@ RAF_OP_DECLARE("raf.op.scatter_dx", [](const CallValues& call) {
   call->device = x->device;
 });
 
+/*!
+ * \brief Write the keys or values of new tokens to a paged cache in place. The cache is in shape
+ * [num_blocks, block_size, ...] and data is in shape [num_tokens, ...]. Token i is written to the
+ * flat slot slots[i], i.e., at offset slots[i] % block_size of block slots[i] / block_size, or
+ * skipped if the slot is negative, e.g., for padding. The updated cache is the output.
+ */
+RAF_OP_DECLARE("raf.op.kv_cache_append", [](const CallValues& call) {
+  const auto* args = call->args.as<KvCacheAppendArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* cache = args->cache;
+  const DLTensor* data = args->data;
+  const DLTensor* slots = args->slots;
+  CHECK_GE(cache->ndim, 2) << "The cache should be in shape [num_blocks, block_size, ...]";
+  CHECK_EQ(data->ndim, cache->ndim - 1);
+  for (int i = 1; i < data->ndim; ++i) {
+    CHECK_EQ(data->shape[i], cache->shape[i + 1])
+        << "The tokens should be in the same shape as those in the cache";
+  }
+  CHECK(data->dtype == cache->dtype) << "The data should be in the same dtype as the cache";
+  CHECK_EQ(slots->ndim, 1);
+  CHECK_EQ(slots->shape[0], data->shape[0]) << "Each token should have a slot";
+  CHECK_EQ(slots->dtype.code, kDLInt) << "The slots should be integers";
+  call->out = args->cache;
+  call->device = cache->device;
+}).set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+/*!
+ * \brief Gather the cached keys or values of a batch of sequences from a paged cache in shape
+ * [num_blocks, block_size, ...] by their block tables in shape [batch_size, max_blocks]. The output
+ * is in shape [batch_size, max_blocks * block_size, ...], whose positions past the length of each
+ * sequence are to be masked out by the attention.
+ */
+RAF_OP_DECLARE("raf.op.kv_cache_gather", [](const CallValues& call) {
+  const auto* args = call->args.as<KvCacheGatherArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* cache = args->cache;
+  const DLTensor* block_table = args->block_table;
+  CHECK_GE(cache->ndim, 2) << "The cache should be in shape [num_blocks, block_size, ...]";
+  CHECK_EQ(block_table->ndim, 2) << "The block table should be in shape [batch_size, max_blocks]";
+  CHECK_EQ(block_table->dtype.code, kDLInt) << "The block table should be integers";
+  std::vector<int64_t> shape{block_table->shape[0], block_table->shape[1] * cache->shape[1]};
+  shape.insert(shape.end(), cache->shape + 2, cache->shape + cache->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/cache->device,
+                                    /*dtype=*/cache->dtype,
+                                    /*shape=*/shape);
+  call->device = cache->device;
+});
+
 RAF_OP_DECLARE("raf.op.clip", [](const CallValues& call) {
   const auto* args = call->args.as<ClipArgs>();
   CHECK(args != nullptr);
@@ -0,0 +1,350 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/multi_tensor_optimizer.cc
+ * \brief Adam over a list of tensors on CPU, which updates the optimizer status kept in the host
+ * memory by ZeRO-Offload, and the update of the dynamic loss scale on CPU.
+ */
+#include <tvm/runtime/c_backend_api.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "raf/op.h"
+#include "../../schema/optimizer.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+using namespace raf::value;
+using namespace raf::op::schema;
+#define CHUNK_SIZE 65536
+
+RAF_REGISTER_DIALECT("cpu").set_enable(DevType::kCPU());
+
+/*! \brief A chunk of a tensor in the tensor list, which is the unit of work of a thread. */
+struct TensorChunk {
+  int tensor;
+  int64_t begin;
+  int64_t end;
+};
+
+/*!
+ * \brief The closure of a multi-tensor Adam step. The tensor lists are [grads, weights, exp_avgs,
+ * exp_avg_sqs] with an optional trailing group of float16 params, the same as the CUDA kernel.
+ */
+struct AdamClosure {
+  std::vector<TensorChunk> chunks;
+  std::vector<void*> tlist;
+  int ntensors;
+  bool fp16_grads;
+  bool fp16_params;
+  float lr;
+  float beta1;
+  float beta2;
+  float eps;
+  float weight_decay;
+  int mode;
+  float scale;
+  float bias_correction1;
+  float bias_correction2;
+};
+
+inline float ToFloat(float x) {
+  return x;
+}
+
+inline float ToFloat(uint16_t x) {
+  return __extendXfYf2__<uint16_t, uint16_t, 10, float, uint32_t, 23>(x);
+}
+
+inline uint16_t FloatToHalf(float x) {
+  return __truncXfYf2__<float, uint32_t, 23, uint16_t, uint16_t, 10>(x);
+}
+
+/*!
+ * \brief Update one chunk, where grad_t is float or uint16_t (the storage of float16). The loop is
+ * branch-free over contiguous arrays so that the compiler vectorizes it with the SIMD width of the
+ * target.
+ */
+template <typename grad_t>
+inline void AdamChunk(const AdamClosure* c, const TensorChunk& chunk) {
+  int i = chunk.tensor;
+  int n = c->ntensors;
+  float* w = static_cast<float*>(c->tlist[n + i]);
+  float* m = static_cast<float*>(c->tlist[2 * n + i]);
+  float* v = static_cast<float*>(c->tlist[3 * n + i]);
+  const grad_t* g = static_cast<const grad_t*>(c->tlist[i]);
+  float decay_l2 = c->mode == 0 ? c->weight_decay : 0.0f;
+  float decay_w = c->mode == 1 ? c->weight_decay : 0.0f;
+  for (int64_t j = chunk.begin; j < chunk.end; ++j) {
+    float grad = c->scale * ToFloat(g[j]);
+    float weight = w[j];
+    grad += decay_l2 * weight;
+    float next_m = c->beta1 * m[j] + (1.0f - c->beta1) * grad;
+    float next_v = c->beta2 * v[j] + (1.0f - c->beta2) * grad * grad;
+    float denom = std::sqrt(next_v / c->bias_correction2) + c->eps;
+    float update = (next_m / c->bias_correction1) / denom + decay_w * weight;
+    m[j] = next_m;
+    v[j] = next_v;
+    w[j] = weight - c->lr * update;
+  }
+  if (c->fp16_params) {
+    uint16_t* p = static_cast<uint16_t*>(c->tlist[4 * n + i]);
+    for (int64_t j = chunk.begin; j < chunk.end; ++j) {
+      p[j] = FloatToHalf(w[j]);
+    }
+  }
+}
+
+/*! \brief The task of a thread in the TVM thread pool, which takes every num_task-th chunk. */
+int AdamTask(int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+  const auto* closure = static_cast<const AdamClosure*>(cdata);
+  for (size_t i = task_id; i < closure->chunks.size(); i += penv->num_task) {
+    if (closure->fp16_grads) {
+      AdamChunk<uint16_t>(closure, closure->chunks[i]);
+    } else {
+      AdamChunk<float>(closure, closure->chunks[i]);
+    }
+  }
+  return 0;
+}
+
+class MultiTensorAdamImpl : public raf::op::OpEnv {
+ public:
+  explicit MultiTensorAdamImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.multi_tensor_adam");
+    auto args = cv->args.as<MultiTensorAdamArgs>();
+    this->arg_indices = {
+        fschema_index[op]("tensor_list"),
+        fschema_index[op]("step"),
+    };
+    closure_.lr = args->learning_rate;
+    closure_.beta1 = args->beta1;
+    closure_.beta2 = args->beta2;
+    closure_.eps = args->eps;
+    closure_.weight_decay = args->weight_decay;
+    closure_.mode = args->mode;
+    closure_.fp16_params = args->fp16_params;
+    bias_correction_ = args->bias_correction;
+    has_grad_norm_ = args->grad_norm.defined();
+    max_grad_norm_ = args->max_grad_norm;
+    has_loss_scale_ = args->loss_scale.defined();
+
+    std::string msg = CheckDTypes(args);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CPU] multi_tensor_adam: " + msg);
+      return;
+    }
+    if (has_grad_norm_) {
+      this->arg_indices.push_back(fschema_index[op]("grad_norm"));
+    }
+    if (has_loss_scale_) {
+      this->arg_indices.push_back(fschema_index[op]("loss_scale"));
+    }
+    int num_groups = closure_.fp16_params ? 5 : 4;
+    closure_.ntensors = args->tensor_list.size() / num_groups;
+    for (int i = 0; i < closure_.ntensors; ++i) {
+      const DLTensor* t = args->tensor_list[i];
+      int64_t numel = 1;
+      for (int j = 0; j < t->ndim; ++j) {
+        numel *= t->shape[j];
+      }
+      for (int64_t begin = 0; begin < numel; begin += CHUNK_SIZE) {
+        closure_.chunks.push_back({i, begin, std::min(begin + CHUNK_SIZE, numel)});
+      }
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<MultiTensorAdamArgs>();
+    Array<Value> tvalue = {args->tensor_list.begin(), args->tensor_list.end()};
+    std::vector<Value> inputs{TupleValue::make(tvalue), args->step};
+    if (has_grad_norm_) {
+      inputs.push_back(args->grad_norm.value());
+    }
+    if (has_loss_scale_) {
+      inputs.push_back(args->loss_scale.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    TupleValue tuple = ir::Downcast<TupleValue>(inputs[0]);
+    DLTensor* step = ir::Downcast<TensorValue>(inputs[1]);
+    closure_.tlist.clear();
+    for (const auto& field : tuple->fields) {
+      DLTensor* tensor = ir::Downcast<TensorValue>(field);
+      closure_.tlist.push_back(tensor->data);
+    }
+    // Clip the gradients to max_grad_norm given their global norm, and skip the step if the norm
+    // is inf or nan, which is the same as GradClipScale of the CUDA kernels. So is the unscaling
+    // by the loss scale.
+    closure_.scale = 1.0f;
+    if (has_grad_norm_) {
+      DLTensor* norm_tensor = ir::Downcast<TensorValue>(inputs[2]);
+      float norm = *static_cast<const float*>(norm_tensor->data);
+      if (!std::isfinite(norm)) {
+        return;
+      }
+      if (has_loss_scale_) {
+        DLTensor* scale_tensor = ir::Downcast<TensorValue>(inputs[3]);
+        closure_.scale = 1.0f / *static_cast<const float*>(scale_tensor->data);
+        norm *= closure_.scale;
+      }
+      if (max_grad_norm_ > 0.0f && norm > max_grad_norm_) {
+        closure_.scale *= max_grad_norm_ / (norm + 1e-6f);
+      }
+    }
+    float step_val = *static_cast<const float*>(step->data);
+    closure_.bias_correction1 = 1.0f;
+    closure_.bias_correction2 = 1.0f;
+    if (bias_correction_) {
+      closure_.bias_correction1 = 1.0f - std::pow(closure_.beta1, step_val);
+      closure_.bias_correction2 = 1.0f - std::pow(closure_.beta2, step_val);
+    }
+    int ret = TVMBackendParallelLaunch(AdamTask, &closure_, 0);
+    CHECK_EQ(ret, 0) << "Failed to launch multi_tensor_adam on CPU";
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cpu.multi_tensor_adam"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MultiTensorAdamImpl(cv);
+  }
+
+ private:
+  /*! \brief Check the dtypes and set whether the gradients are in float16. */
+  std::string CheckDTypes(const MultiTensorAdamArgs* args) {
+    auto is_float = [](DLDataType dtype, int bits) {
+      return dtype.code == kDLFloat && dtype.bits == bits && dtype.lanes == 1;
+    };
+    const DLTensor* step = args->step;
+    if (step->ndim != 0 || !is_float(step->dtype, 32)) {
+      return "step should be a float32 scalar";
+    }
+    if (has_grad_norm_) {
+      const DLTensor* norm = args->grad_norm.value();
+      if (norm->ndim != 0 || !is_float(norm->dtype, 32)) {
+        return "grad_norm should be a float32 scalar";
+      }
+    }
+    if (has_loss_scale_) {
+      const DLTensor* scale = args->loss_scale.value();
+      if (scale->ndim != 0 || !is_float(scale->dtype, 32)) {
+        return "loss_scale should be a float32 scalar";
+      }
+      if (!has_grad_norm_) {
+        return "loss_scale requires grad_norm";
+      }
+    }
+    int num_groups = closure_.fp16_params ? 5 : 4;
+    int ntensors = args->tensor_list.size() / num_groups;
+    const DLTensor* g0 = args->tensor_list[0];
+    if (!is_float(g0->dtype, 32) && !is_float(g0->dtype, 16)) {
+      return "gradients should be in float32 or float16";
+    }
+    closure_.fp16_grads = g0->dtype.bits == 16;
+    for (int i = 0; i < args->tensor_list.size(); ++i) {
+      const DLTensor* t = args->tensor_list[i];
+      int group = i / ntensors;
+      if (group == 0) {
+        if (t->dtype != g0->dtype) {
+          return "gradients should have the same dtype";
+        }
+      } else if (closure_.fp16_params && group == num_groups - 1) {
+        if (!is_float(t->dtype, 16)) {
+          return "params should be in float16";
+        }
+      } else if (!is_float(t->dtype, 32)) {
+        return "weights and optimizer states should be in float32";
+      }
+    }
+    return "";
+  }
+
+  AdamClosure closure_;
+  bool bias_correction_;
+  bool has_grad_norm_;
+  float max_grad_norm_;
+  bool has_loss_scale_;
+};
+
+RAF_REGISTER_DIALECT_OP(cpu, multi_tensor_adam, 10);
+RAF_OP_ENV_MAKER("raf.op.cpu.multi_tensor_adam", MultiTensorAdamImpl::make);
+
+/*! \brief The update of the dynamic loss scale, which is the same as the CUDA kernel. */
+class UpdateLossScaleImpl : public raf::op::OpEnv {
+ public:
+  explicit UpdateLossScaleImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.update_loss_scale");
+    auto args = cv->args.as<UpdateLossScaleArgs>();
+    this->arg_indices = {
+        fschema_index[op]("grad_norm"),
+        fschema_index[op]("loss_scale"),
+        fschema_index[op]("good_steps"),
+    };
+    growth_factor_ = args->growth_factor;
+    backoff_factor_ = args->backoff_factor;
+    growth_interval_ = args->growth_interval;
+    min_scale_ = args->min_scale;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<UpdateLossScaleArgs>();
+    Execute({args->grad_norm, args->loss_scale, args->good_steps}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    auto scalar = [](const Value& value) {
+      DLTensor* tensor = ir::Downcast<TensorValue>(value);
+      return static_cast<float*>(tensor->data);
+    };
+    TupleValue out = ir::Downcast<TupleValue>(output);
+    float scale = *scalar(inputs[1]);
+    float steps = *scalar(inputs[2]);
+    if (!std::isfinite(*scalar(inputs[0]))) {
+      scale = std::max(scale * backoff_factor_, min_scale_);
+      steps = 0.0f;
+    } else if (steps + 1.0f >= growth_interval_) {
+      float grown = scale * growth_factor_;
+      scale = std::isfinite(grown) ? grown : scale;
+      steps = 0.0f;
+    } else {
+      steps += 1.0f;
+    }
+    *scalar(out->fields[0]) = scale;
+    *scalar(out->fields[1]) = steps;
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cpu.update_loss_scale"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new UpdateLossScaleImpl(cv);
+  }
+
+ private:
+  float growth_factor_;
+  float backoff_factor_;
+  int growth_interval_;
+  float min_scale_;
+};
+
+RAF_REGISTER_DIALECT_OP(cpu, update_loss_scale, 10);
+RAF_OP_ENV_MAKER("raf.op.cpu.update_loss_scale", UpdateLossScaleImpl::make);
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
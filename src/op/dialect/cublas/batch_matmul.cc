@@ -59,6 +59,14 @@ void GemmBatchedImpl(DLTensor* a, bool transpose_a, DLTensor* b, bool transpose_
     strideB = 0;
   }
 
+  if (c->dtype.code == kDLBfloat) {
+    CUBLAS_CALL(cublasGemmStridedBatchedEx(
+        handle, transb, transa, m, n, k, const_addr<1>(CUDA_R_32F), b->data,
+        cudaDataType_t(DType(b->dtype)), ldb, strideB, a->data, cudaDataType_t(DType(a->dtype)),
+        lda, strideA, const_addr<0>(CUDA_R_32F), c->data, cudaDataType_t(DType(c->dtype)), m,
+        strideC, batch_count, CUDA_R_32F, CUBLAS_GEMM_DEFAULT_TENSOR_OP));
+    return;
+  }
   if (c->dtype.code == kDLFloat) {
     switch (c->dtype.bits) {
       case 16: {
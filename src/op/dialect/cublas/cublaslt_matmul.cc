@@ -0,0 +1,413 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cublas/cublaslt_matmul.cc
+ * \brief cuBLASLt matmul with the bias and activation fused as the epilogue.
+ */
+#include <cublasLt.h>
+#include <limits>
+#include <unordered_map>
+#include "dmlc/memory_io.h"
+#include "dmlc/thread_local.h"
+#include "raf/cache.h"
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/value.h"
+#include "./cublas_utils.h"
+#include "../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cublas {
+
+using namespace raf::ir;
+using namespace raf::value;
+using memory_pool::Memory;
+
+/*! \brief The max workspace size that a cuBLASLt algorithm can use. */
+static constexpr size_t kCuBlasLtMaxWorkspaceSize = 4 << 20;
+/*! \brief The max number of the heuristic algorithms to be timed. */
+static constexpr int kCuBlasLtMaxAlgos = 8;
+/*! \brief The number of runs to time an algorithm. */
+static constexpr int kCuBlasLtTimingRuns = 10;
+
+class CUBlasLtThreadEntry {
+ public:
+  CUBlasLtThreadEntry() {
+    CUBLAS_CALL(cublasLtCreate(&handle));
+  }
+
+  static CUBlasLtThreadEntry* ThreadLocal() {
+    return dmlc::ThreadLocalStore<CUBlasLtThreadEntry>::Get();
+  }
+
+ public:
+  cublasLtHandle_t handle{nullptr};
+};
+
+/*! \brief The tuning cache entry of the best cuBLASLt matmul algorithm. */
+class CuBlasLtAlgoCacheEntry {
+ public:
+  CuBlasLtAlgoCacheEntry(const cublasLtMatmulAlgo_t& algo) : algo_(algo) {
+  }
+
+  cublasLtMatmulAlgo_t Value() const {
+    return algo_;
+  }
+
+  static CuBlasLtAlgoCacheEntry Deserialize(const std::string& data) {
+    std::string buf = data;
+    dmlc::MemoryStringStream reader(&buf);
+    dmlc::Stream* stream = &reader;
+
+    cublasLtMatmulAlgo_t algo;
+    for (auto& field : algo.data) {
+      CHECK(stream->Read(&field)) << "Truncated cuBLASLt algorithm record";
+    }
+    return CuBlasLtAlgoCacheEntry(algo);
+  }
+
+  std::string Serialize() const {
+    std::string data;
+    dmlc::MemoryStringStream writer(&data);
+    dmlc::SeekStream* stream = &writer;
+    for (auto field : algo_.data) {
+      stream->Write(field);
+    }
+    return data;
+  }
+
+ private:
+  cublasLtMatmulAlgo_t algo_;
+};
+
+MetaTuningCache<CuBlasLtAlgoCacheEntry> CacheCublasLtAlgo("cublaslt_matmul_algo", []() {
+  return GetCUDADeviceFingerprint() + "/cublaslt_" + std::to_string(cublasLtGetVersion());
+});
+
+inline cudaStream_t GetStream() {
+  static auto cuda_device_api = device_api::DeviceAPI::Get(DevType::kCUDA());
+  return static_cast<cudaStream_t>(cuda_device_api->GetStream());
+}
+
+/*!
+ * \brief OpEnv for the fused functions in the following patterns, where the bias and the
+ * activation are computed by the epilogue of the cuBLASLt matmul kernel:
+ *   - matmul_op(a, b) + bias
+ *   - act_op(matmul_op(a, b) + bias)
+ *   - act_op(matmul_op(a, b))
+ * where matmul_op = dense | matmul | matmul_nt | matmul_tn | matmul_tt, and act_op = relu | gelu.
+ * The bias is either a vector of the output features, i.e., in shape [n] or [1, n] for the output
+ * in shape [m, n], or a tensor in the output shape (e.g., a residual). Note that the GELU epilogue
+ * of cuBLASLt uses the tanh approximation.
+ */
+class CuBlasLtMatmulOpEnv : public raf::op::OpEnv {
+  enum class Activation { kNone, kRelu, kGelu };
+  enum class BiasKind { kNone, kVector, kTensor };
+
+ public:
+  explicit CuBlasLtMatmulOpEnv(const CallValues& cv) {
+    auto func = Downcast<ClosureValue>(cv->callee)->func;
+    if (!Match(func)) {
+      error_msgs.push_back("[cuBLASLt] Cannot JIT: unsupported pattern");
+      return;
+    }
+    std::vector<Var> params = {a_, b_};
+    if (bias_.defined()) {
+      params.push_back(bias_);
+    }
+    for (const auto& param : params) {
+      auto it = std::find(func->params.begin(), func->params.end(), param);
+      CHECK(it != func->params.end());
+      arg_indices.push_back(it - func->params.begin());
+    }
+    try {
+      Init(cv);
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[cuBLASLt] Failed to JIT: " << e.what();
+      error_msgs.push_back(ss.str());
+    }
+  }
+
+  ~CuBlasLtMatmulOpEnv() {
+    if (op_desc_) CUBLAS_CALL(cublasLtMatmulDescDestroy(op_desc_));
+    if (a_desc_) CUBLAS_CALL(cublasLtMatrixLayoutDestroy(a_desc_));
+    if (b_desc_) CUBLAS_CALL(cublasLtMatrixLayoutDestroy(b_desc_));
+    if (c_desc_) CUBLAS_CALL(cublasLtMatrixLayoutDestroy(c_desc_));
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cublaslt.matmul"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (int i : arg_indices) {
+      inputs.push_back(args[i]);
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* a = Downcast<TensorValue>(inputs[0]);
+    DLTensor* b = Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = Downcast<TensorValue>(output);
+    void* bias = bias_kind_ != BiasKind::kNone ? Downcast<TensorValue>(inputs[2])->data : nullptr;
+    CUBLAS_CALL(Run(algo_, a->data, b->data, bias, out->data, workspace_, workspace_size_));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new CuBlasLtMatmulOpEnv(cv);
+  }
+
+ private:
+  /*! \brief Match the fused function and record its operands. Returns false if unsupported. */
+  bool Match(const Function& func) {
+    static const std::unordered_map<Op, std::pair<bool, bool>, ObjectPtrHash, ObjectPtrEqual>
+        matmul_ops = {{Op::Get("raf.op.cublaslt.dense"), {false, true}},
+                      {Op::Get("raf.op.cublaslt.matmul"), {false, false}},
+                      {Op::Get("raf.op.cublaslt.matmul_nt"), {false, true}},
+                      {Op::Get("raf.op.cublaslt.matmul_tn"), {true, false}},
+                      {Op::Get("raf.op.cublaslt.matmul_tt"), {true, true}}};
+    static const Op& relu_op = Op::Get("raf.op.cublaslt.relu");
+    static const Op& gelu_op = Op::Get("raf.op.cublaslt.gelu");
+    static const Op& add_op = Op::Get("raf.op.cublaslt.add");
+
+    const auto* call = func->body.as<CallNode>();
+    if (call && (call->op == relu_op || call->op == gelu_op)) {
+      activation_ = call->op == relu_op ? Activation::kRelu : Activation::kGelu;
+      call = call->args[0].as<CallNode>();
+    }
+    if (call && call->op == add_op) {
+      // Add is commutative, so the matmul may be either of the operands.
+      int matmul_idx = call->args[0].as<CallNode>() ? 0 : 1;
+      bias_ = Downcast<Var>(call->args[1 - matmul_idx]);
+      call = call->args[matmul_idx].as<CallNode>();
+    }
+    if (call == nullptr || !call->op.as<OpNode>()) {
+      return false;
+    }
+    auto it = matmul_ops.find(Downcast<Op>(call->op));
+    if (it == matmul_ops.end() || !call->args[0].as<VarNode>() || !call->args[1].as<VarNode>()) {
+      return false;
+    }
+    std::tie(transpose_a_, transpose_b_) = it->second;
+    a_ = Downcast<Var>(call->args[0]);
+    b_ = Downcast<Var>(call->args[1]);
+    return true;
+  }
+
+  void Init(const CallValues& cv) {
+    Array<Value> args = GetListArgs(cv->args);
+    DLTensor* a = Downcast<TensorValue>(args[arg_indices[0]]);
+    DLTensor* b = Downcast<TensorValue>(args[arg_indices[1]]);
+    DLTensor* c = cv->out;
+    CHECK(a->ndim == 2 && b->ndim == 2 && c->ndim == 2) << "Only support 2-D matmul";
+    DType dtype(c->dtype);
+    CHECK((dtype.code == DTypeCode::kFloat() && (dtype.bits == 16 || dtype.bits == 32)) ||
+          (dtype.code == DTypeCode::kBFloat() && dtype.bits == 16))
+        << "Only support float16, bfloat16 and float32, but got " << dtype;
+    CHECK(DType(a->dtype) == dtype && DType(b->dtype) == dtype);
+
+    // Same as GemmImpl, the row-major output [n, m] is computed as its column-major transpose,
+    // so the cuBLASLt operand A is b and B is a.
+    int64_t m = c->shape[1];
+    int64_t n = c->shape[0];
+    int64_t k = b->shape[transpose_b_];
+    void* bias = nullptr;
+    if (bias_.defined()) {
+      DLTensor* bias_tensor = Downcast<TensorValue>(args[arg_indices[2]]);
+      CHECK(DType(bias_tensor->dtype) == dtype);
+      int64_t numel = 1;
+      for (int i = 0; i < bias_tensor->ndim; ++i) {
+        numel *= bias_tensor->shape[i];
+      }
+      int ndim = bias_tensor->ndim;
+      if (numel == m && ndim >= 1 && ndim <= 2 && bias_tensor->shape[ndim - 1] == m) {
+        bias_kind_ = BiasKind::kVector;
+      } else if (ndim == 2 && bias_tensor->shape[0] == n && bias_tensor->shape[1] == m) {
+        bias_kind_ = BiasKind::kTensor;
+      } else {
+        LOG(FATAL) << "Unsupported bias shape for the output shape (" << n << ", " << m << ")";
+      }
+      bias = bias_tensor->data;
+    }
+
+    cudaDataType_t data_type = cudaDataType_t(dtype);
+    cublasComputeType_t compute_type = CUBLAS_COMPUTE_32F;
+    bool allow_tf32 = pass::PassContext::Current()
+                          ->GetConfig<tvm::Bool>("raf.cublas.allow_tf32", tvm::Bool(true))
+                          .value();
+    if (dtype.bits == 32 && allow_tf32) {
+      compute_type = CUBLAS_COMPUTE_32F_FAST_TF32;
+    }
+    cublasOperation_t transa = transpose_b_ ? CUBLAS_OP_T : CUBLAS_OP_N;
+    cublasOperation_t transb = transpose_a_ ? CUBLAS_OP_T : CUBLAS_OP_N;
+    CUBLAS_CALL(cublasLtMatmulDescCreate(&op_desc_, compute_type, CUDA_R_32F));
+    CUBLAS_CALL(cublasLtMatmulDescSetAttribute(op_desc_, CUBLASLT_MATMUL_DESC_TRANSA, &transa,
+                                               sizeof(transa)));
+    CUBLAS_CALL(cublasLtMatmulDescSetAttribute(op_desc_, CUBLASLT_MATMUL_DESC_TRANSB, &transb,
+                                               sizeof(transb)));
+    cublasLtEpilogue_t epilogue = GetEpilogue();
+    CUBLAS_CALL(cublasLtMatmulDescSetAttribute(op_desc_, CUBLASLT_MATMUL_DESC_EPILOGUE, &epilogue,
+                                               sizeof(epilogue)));
+    int64_t rows_a = transpose_b_ ? k : m, cols_a = transpose_b_ ? m : k;
+    int64_t rows_b = transpose_a_ ? n : k, cols_b = transpose_a_ ? k : n;
+    CUBLAS_CALL(cublasLtMatrixLayoutCreate(&a_desc_, data_type, rows_a, cols_a, rows_a));
+    CUBLAS_CALL(cublasLtMatrixLayoutCreate(&b_desc_, data_type, rows_b, cols_b, rows_b));
+    CUBLAS_CALL(cublasLtMatrixLayoutCreate(&c_desc_, data_type, m, n, m));
+
+    HashKey key;
+    key << m << n << k << transpose_a_ << transpose_b_ << c->dtype
+        << static_cast<int>(activation_) << static_cast<int>(bias_kind_)
+        << static_cast<int>(compute_type);
+    auto handle = CUBlasLtThreadEntry::ThreadLocal()->handle;
+    if (auto entry = CacheCublasLtAlgo.Get(key.byte_vector)) {
+      algo_ = entry->Value();
+    } else {
+      algo_ = FindBestAlgo(a->data, b->data, bias, c->data, cv->device);
+      CacheCublasLtAlgo.Set(key.byte_vector, CuBlasLtAlgoCacheEntry(algo_));
+    }
+    cublasLtMatmulHeuristicResult_t result;
+    CUBLAS_CALL(cublasLtMatmulAlgoCheck(handle, op_desc_, a_desc_, b_desc_, c_desc_, c_desc_,
+                                        &algo_, &result));
+    workspace_size_ = result.workspaceSize;
+    RequestWorkspace(&workspace_, cv->device, workspace_size_);
+  }
+
+  cublasLtEpilogue_t GetEpilogue() const {
+    bool with_bias = bias_kind_ == BiasKind::kVector;
+    switch (activation_) {
+      case Activation::kRelu:
+        return with_bias ? CUBLASLT_EPILOGUE_RELU_BIAS : CUBLASLT_EPILOGUE_RELU;
+      case Activation::kGelu:
+#if CUDA_VERSION >= 11030
+        return with_bias ? CUBLASLT_EPILOGUE_GELU_BIAS : CUBLASLT_EPILOGUE_GELU;
+#else
+        LOG(FATAL) << "The GELU epilogue requires CUDA 11.3 or later";
+#endif
+      default:
+        return with_bias ? CUBLASLT_EPILOGUE_BIAS : CUBLASLT_EPILOGUE_DEFAULT;
+    }
+  }
+
+  /*!
+   * \brief Get the candidate algorithms from the cuBLASLt heuristic, and choose the fastest one
+   * by timing them with the actual operands.
+   */
+  cublasLtMatmulAlgo_t FindBestAlgo(void* a, void* b, void* bias, void* out,
+                                    const Device& device) {
+    auto handle = CUBlasLtThreadEntry::ThreadLocal()->handle;
+    cublasLtMatmulPreference_t preference;
+    size_t max_workspace_size = kCuBlasLtMaxWorkspaceSize;
+    CUBLAS_CALL(cublasLtMatmulPreferenceCreate(&preference));
+    CUBLAS_CALL(cublasLtMatmulPreferenceSetAttribute(preference,
+                                                     CUBLASLT_MATMUL_PREF_MAX_WORKSPACE_BYTES,
+                                                     &max_workspace_size, sizeof(size_t)));
+    if (bias_kind_ == BiasKind::kVector) {
+      // Let the heuristic skip the algorithms that cannot read the bias in place.
+      CUBLAS_CALL(cublasLtMatmulDescSetAttribute(op_desc_, CUBLASLT_MATMUL_DESC_BIAS_POINTER,
+                                                 &bias, sizeof(bias)));
+    }
+    cublasLtMatmulHeuristicResult_t results[kCuBlasLtMaxAlgos];
+    int n_results = 0;
+    CUBLAS_CALL(cublasLtMatmulAlgoGetHeuristic(handle, op_desc_, a_desc_, b_desc_, c_desc_,
+                                               c_desc_, preference, kCuBlasLtMaxAlgos, results,
+                                               &n_results));
+    CUBLAS_CALL(cublasLtMatmulPreferenceDestroy(preference));
+    CHECK_GT(n_results, 0) << "cuBLASLt found no algorithm for the matmul";
+    if (n_results == 1) {
+      return results[0].algo;
+    }
+
+    auto workspace = Memory::Alloc(device, max_workspace_size);
+    cudaStream_t stream = GetStream();
+    cudaEvent_t start, stop;
+    CUDA_CALL(cudaEventCreate(&start));
+    CUDA_CALL(cudaEventCreate(&stop));
+    int best = 0;
+    float best_time = std::numeric_limits<float>::max();
+    for (int i = 0; i < n_results; ++i) {
+      // Warm up, which also skips the algorithms failing to run.
+      if (Run(results[i].algo, a, b, bias, out, workspace->data, max_workspace_size) !=
+          CUBLAS_STATUS_SUCCESS) {
+        continue;
+      }
+      CUDA_CALL(cudaEventRecord(start, stream));
+      for (int j = 0; j < kCuBlasLtTimingRuns; ++j) {
+        Run(results[i].algo, a, b, bias, out, workspace->data, max_workspace_size);
+      }
+      CUDA_CALL(cudaEventRecord(stop, stream));
+      CUDA_CALL(cudaEventSynchronize(stop));
+      float time = 0;
+      CUDA_CALL(cudaEventElapsedTime(&time, start, stop));
+      DLOG(INFO) << "cuBLASLt algorithm " << i << ": " << time / kCuBlasLtTimingRuns << " ms";
+      if (time < best_time) {
+        best_time = time;
+        best = i;
+      }
+    }
+    CUDA_CALL(cudaEventDestroy(start));
+    CUDA_CALL(cudaEventDestroy(stop));
+    return results[best].algo;
+  }
+
+  cublasStatus_t Run(const cublasLtMatmulAlgo_t& algo, void* a, void* b, void* bias, void* out,
+                     void* workspace, size_t workspace_size) {
+    const void* c = out;
+    const void* beta = const_addr<0>(CUDA_R_32F);
+    if (bias_kind_ == BiasKind::kVector) {
+      CUBLAS_CALL(cublasLtMatmulDescSetAttribute(op_desc_, CUBLASLT_MATMUL_DESC_BIAS_POINTER,
+                                                 &bias, sizeof(bias)));
+    } else if (bias_kind_ == BiasKind::kTensor) {
+      c = bias;
+      beta = const_addr<1>(CUDA_R_32F);
+    }
+    return cublasLtMatmul(CUBlasLtThreadEntry::ThreadLocal()->handle, op_desc_,
+                          const_addr<1>(CUDA_R_32F), b, a_desc_, a, b_desc_, beta, c, c_desc_, out,
+                          c_desc_, &algo, workspace, workspace_size, GetStream());
+  }
+
+  /*! \brief The matmul operands. */
+  Var a_, b_;
+  /*! \brief The bias, which is undefined if there is no bias. */
+  Var bias_;
+  /*! \brief Whether to transpose the matmul operands. */
+  bool transpose_a_{false}, transpose_b_{false};
+  /*! \brief The activation of the epilogue. */
+  Activation activation_{Activation::kNone};
+  /*! \brief How the bias is added. */
+  BiasKind bias_kind_{BiasKind::kNone};
+  /*! \brief The cuBLASLt descriptors. */
+  cublasLtMatmulDesc_t op_desc_{nullptr};
+  cublasLtMatrixLayout_t a_desc_{nullptr}, b_desc_{nullptr}, c_desc_{nullptr};
+  /*! \brief The chosen algorithm. */
+  cublasLtMatmulAlgo_t algo_;
+  /*! \brief The workspace of the chosen algorithm. */
+  void* workspace_{nullptr};
+  size_t workspace_size_{0};
+};
+
+RAF_REGISTER_DIALECT("cublaslt").set_enable(DevType::kCUDA());
+RAF_OP_ENV_MAKER("raf.op.cublaslt._fused_op", CuBlasLtMatmulOpEnv::make);
+
+// The ops in the fused functions, which are only executed by the fused op.
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul, 0);
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul_nt, 0);
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul_tn, 0);
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul_tt, 0);
+RAF_REGISTER_DIALECT_OP(cublaslt, dense, 0);
+RAF_REGISTER_DIALECT_OP(cublaslt, add, 0);
+RAF_REGISTER_DIALECT_OP(cublaslt, relu, 0);
+RAF_REGISTER_DIALECT_OP(cublaslt, gelu, 0);
+
+}  // namespace cublas
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,258 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cublas/cusparse.cc
+ * \brief The sparse matrix operators by the cuSPARSE generic API, which ships with cuBLAS in the
+ * CUDA toolkit.
+ */
+#include <cusparse.h>
+#include "dmlc/thread_local.h"
+#include "raf/device_api.h"
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/value.h"
+#include "../../schema/sparse.h"
+#include "../../../common/cuda_utils.h"
+
+#define CUSPARSE_CALL(func)                                                            \
+  do {                                                                                 \
+    cusparseStatus_t e = (func);                                                       \
+    CHECK_EQ(e, CUSPARSE_STATUS_SUCCESS) << "cusparse: " << cusparseGetErrorString(e); \
+  } while (false)
+
+namespace raf {
+namespace op {
+namespace cusparse {
+
+using namespace raf::ir;
+using namespace raf::value;
+using namespace raf::op::schema;
+
+class CUSparseThreadEntry {
+ public:
+  CUSparseThreadEntry() {
+    CUSPARSE_CALL(cusparseCreate(&handle));
+  }
+
+  static CUSparseThreadEntry* ThreadLocal() {
+    return dmlc::ThreadLocalStore<CUSparseThreadEntry>::Get();
+  }
+
+ public:
+  cusparseHandle_t handle{nullptr};
+};
+
+/*! \brief Get the cuSPARSE handle bound to the current stream. */
+inline cusparseHandle_t GetHandle() {
+  static auto cuda_device_api = device_api::DeviceAPI::Get(DevType::kCUDA());
+  auto handle = CUSparseThreadEntry::ThreadLocal()->handle;
+  CUSPARSE_CALL(cusparseSetStream(handle, static_cast<cudaStream_t>(cuda_device_api->GetStream())));
+  return handle;
+}
+
+inline cusparseIndexType_t IndexType(const DLTensor* indices) {
+  CHECK_EQ(indices->dtype.code, kDLInt);
+  switch (indices->dtype.bits) {
+    case 32:
+      return CUSPARSE_INDEX_32I;
+    case 64:
+      return CUSPARSE_INDEX_64I;
+  }
+  LOG(FATAL) << "Unsupported index dtype: " << DType(indices->dtype).c_str();
+  throw;
+}
+
+/*! \brief The dtype to accumulate in, where half precision accumulates in float. */
+inline cudaDataType_t ComputeType(const DLTensor* x) {
+  return x->dtype.bits == 64 ? CUDA_R_64F : CUDA_R_32F;
+}
+
+/*! \brief Describe a CSR matrix in shape [rows, cols]. */
+inline cusparseSpMatDescr_t CreateCsr(int64_t rows, int64_t cols, const DLTensor* indptr,
+                                      const DLTensor* indices, const DLTensor* values) {
+  cusparseSpMatDescr_t desc;
+  CUSPARSE_CALL(cusparseCreateCsr(&desc, rows, cols, indices->shape[0], indptr->data,
+                                  indices->data, values->data, IndexType(indptr),
+                                  IndexType(indices), CUSPARSE_INDEX_BASE_ZERO,
+                                  cudaDataType_t(DType(values->dtype))));
+  return desc;
+}
+
+/*! \brief Describe a row-major dense matrix. */
+inline cusparseDnMatDescr_t CreateDense(const DLTensor* x) {
+  cusparseDnMatDescr_t desc;
+  CUSPARSE_CALL(cusparseCreateDnMat(&desc, x->shape[0], x->shape[1], x->shape[1], x->data,
+                                    cudaDataType_t(DType(x->dtype)), CUSPARSE_ORDER_ROW));
+  return desc;
+}
+
+/*!
+ * \brief out = op(A) * dense, where A is a CSR matrix and op is the identity or the transpose.
+ * The descriptors are created once, and only their pointers are updated for each execution.
+ */
+template <bool transpose_a>
+class CsrSpmmImpl : public raf::op::OpEnv {
+ public:
+  explicit CsrSpmmImpl(const CallValues& cv) {
+    auto op = Op::Get(transpose_a ? "raf.op.csr_spmm_tn" : "raf.op.csr_spmm");
+    auto fschema_index = GetOpAttr<op::FRAFSchemaFieldIndex>(op, "FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index("indptr"), fschema_index("indices"),
+                         fschema_index("values"), fschema_index("dense")};
+    std::vector<Value> inputs = GetInputs(cv);
+    const DLTensor* indptr = Downcast<TensorValue>(inputs[0]);
+    const DLTensor* dense = Downcast<TensorValue>(inputs[3]);
+    const DLTensor* out = Downcast<TensorValue>(cv->out);
+    int64_t rows = indptr->shape[0] - 1;
+    int64_t cols = transpose_a ? out->shape[0] : dense->shape[0];
+    a_desc_ = CreateCsr(rows, cols, indptr, Downcast<TensorValue>(inputs[1]),
+                        Downcast<TensorValue>(inputs[2]));
+    b_desc_ = CreateDense(dense);
+    c_desc_ = CreateDense(out);
+    compute_type_ = ComputeType(out);
+    CUSPARSE_CALL(cusparseSpMM_bufferSize(GetHandle(), op_a_, CUSPARSE_OPERATION_NON_TRANSPOSE,
+                                          const_addr<1>(compute_type_), a_desc_, b_desc_,
+                                          const_addr<0>(compute_type_), c_desc_, compute_type_,
+                                          CUSPARSE_SPMM_ALG_DEFAULT, &workspace_size_));
+    RequestWorkspace(&workspace_, cv->device, workspace_size_);
+  }
+
+  ~CsrSpmmImpl() {
+    cusparseDestroySpMat(a_desc_);
+    cusparseDestroyDnMat(b_desc_);
+    cusparseDestroyDnMat(c_desc_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName(transpose_a ? "raf.op.cusparse.csr_spmm_tn"
+                                                  : "raf.op.cusparse.csr_spmm"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    Execute(GetInputs(cv), cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    const DLTensor* indptr = Downcast<TensorValue>(inputs[0]);
+    const DLTensor* indices = Downcast<TensorValue>(inputs[1]);
+    const DLTensor* values = Downcast<TensorValue>(inputs[2]);
+    const DLTensor* dense = Downcast<TensorValue>(inputs[3]);
+    const DLTensor* out = Downcast<TensorValue>(output);
+    CUSPARSE_CALL(cusparseCsrSetPointers(a_desc_, indptr->data, indices->data, values->data));
+    CUSPARSE_CALL(cusparseDnMatSetValues(b_desc_, dense->data));
+    CUSPARSE_CALL(cusparseDnMatSetValues(c_desc_, out->data));
+    CUSPARSE_CALL(cusparseSpMM(GetHandle(), op_a_, CUSPARSE_OPERATION_NON_TRANSPOSE,
+                               const_addr<1>(compute_type_), a_desc_, b_desc_,
+                               const_addr<0>(compute_type_), c_desc_, compute_type_,
+                               CUSPARSE_SPMM_ALG_DEFAULT, workspace_));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new CsrSpmmImpl<transpose_a>(cv);
+  }
+
+ private:
+  static std::vector<Value> GetInputs(const CallValues& cv) {
+    if (transpose_a) {
+      auto args = cv->args.as<CsrSpmmTnArgs>();
+      return {args->indptr, args->indices, args->values, args->dense};
+    }
+    auto args = cv->args.as<CsrSpmmArgs>();
+    return {args->indptr, args->indices, args->values, args->dense};
+  }
+
+  const cusparseOperation_t op_a_ =
+      transpose_a ? CUSPARSE_OPERATION_TRANSPOSE : CUSPARSE_OPERATION_NON_TRANSPOSE;
+  cudaDataType_t compute_type_;
+  cusparseSpMatDescr_t a_desc_{nullptr};
+  cusparseDnMatDescr_t b_desc_{nullptr}, c_desc_{nullptr};
+  void* workspace_{nullptr};
+  size_t workspace_size_{0};
+};
+
+RAF_REGISTER_DIALECT("cusparse").set_enable(DevType::kCUDA());
+RAF_REGISTER_DIALECT_OP(cusparse, csr_spmm, 15);
+RAF_REGISTER_DIALECT_OP(cusparse, csr_spmm_tn, 15);
+RAF_OP_ENV_MAKER("raf.op.cusparse.csr_spmm", CsrSpmmImpl<false>::make);
+RAF_OP_ENV_MAKER("raf.op.cusparse.csr_spmm_tn", CsrSpmmImpl<true>::make);
+
+// cusparseSDDMM is available since CUDA 11.2. The TVM kernel is used otherwise.
+#if CUDART_VERSION >= 11020
+
+/*! \brief out = (x1 * x2^T) sampled at the non-zeros of a CSR matrix, whose values are out. */
+class CsrSddmmImpl : public raf::op::OpEnv {
+ public:
+  explicit CsrSddmmImpl(const CallValues& cv) {
+    auto op = Op::Get("raf.op.csr_sddmm");
+    auto fschema_index = GetOpAttr<op::FRAFSchemaFieldIndex>(op, "FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index("indptr"), fschema_index("indices"), fschema_index("x1"),
+                         fschema_index("x2")};
+    auto args = cv->args.as<CsrSddmmArgs>();
+    CHECK(args != nullptr);
+    const DLTensor* indptr = args->indptr;
+    const DLTensor* x2 = args->x2;
+    const DLTensor* out = Downcast<TensorValue>(cv->out);
+    a_desc_ = CreateDense(args->x1);
+    b_desc_ = CreateDense(x2);
+    c_desc_ = CreateCsr(indptr->shape[0] - 1, x2->shape[0], indptr, args->indices, out);
+    compute_type_ = ComputeType(out);
+    CUSPARSE_CALL(cusparseSDDMM_bufferSize(GetHandle(), CUSPARSE_OPERATION_NON_TRANSPOSE,
+                                           CUSPARSE_OPERATION_TRANSPOSE,
+                                           const_addr<1>(compute_type_), a_desc_, b_desc_,
+                                           const_addr<0>(compute_type_), c_desc_, compute_type_,
+                                           CUSPARSE_SDDMM_ALG_DEFAULT, &workspace_size_));
+    RequestWorkspace(&workspace_, cv->device, workspace_size_);
+  }
+
+  ~CsrSddmmImpl() {
+    cusparseDestroyDnMat(a_desc_);
+    cusparseDestroyDnMat(b_desc_);
+    cusparseDestroySpMat(c_desc_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cusparse.csr_sddmm"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<CsrSddmmArgs>();
+    Execute({args->indptr, args->indices, args->x1, args->x2}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    const DLTensor* indptr = Downcast<TensorValue>(inputs[0]);
+    const DLTensor* indices = Downcast<TensorValue>(inputs[1]);
+    const DLTensor* x1 = Downcast<TensorValue>(inputs[2]);
+    const DLTensor* x2 = Downcast<TensorValue>(inputs[3]);
+    const DLTensor* out = Downcast<TensorValue>(output);
+    CUSPARSE_CALL(cusparseDnMatSetValues(a_desc_, x1->data));
+    CUSPARSE_CALL(cusparseDnMatSetValues(b_desc_, x2->data));
+    CUSPARSE_CALL(cusparseCsrSetPointers(c_desc_, indptr->data, indices->data, out->data));
+    CUSPARSE_CALL(cusparseSDDMM(GetHandle(), CUSPARSE_OPERATION_NON_TRANSPOSE,
+                                CUSPARSE_OPERATION_TRANSPOSE, const_addr<1>(compute_type_),
+                                a_desc_, b_desc_, const_addr<0>(compute_type_), c_desc_,
+                                compute_type_, CUSPARSE_SDDMM_ALG_DEFAULT, workspace_));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new CsrSddmmImpl(cv);
+  }
+
+ private:
+  cudaDataType_t compute_type_;
+  cusparseDnMatDescr_t a_desc_{nullptr}, b_desc_{nullptr};
+  cusparseSpMatDescr_t c_desc_{nullptr};
+  void* workspace_{nullptr};
+  size_t workspace_size_{0};
+};
+
+RAF_REGISTER_DIALECT_OP(cusparse, csr_sddmm, 15);
+RAF_OP_ENV_MAKER("raf.op.cusparse.csr_sddmm", CsrSddmmImpl::make);
+
+#endif
+
+}  // namespace cusparse
+}  // namespace op
+}  // namespace raf
@@ -36,6 +36,15 @@ void GemmImpl(DLTensor* a, bool transpose_a, DLTensor* b, bool transpose_b, DLTe
   int ldb = std::max(1, transpose_b ? k : m);
   int lda = std::max(1, transpose_a ? n : k);
 
+  if (c->dtype.code == kDLBfloat) {
+    // Like fp16, bf16 runs on the tensor cores and accumulates in fp32.
+    CUBLAS_CALL(cublasGemmEx(handle, transb, transa, m, n, k, const_addr<1>(CUDA_R_32F), b->data,
+                             cudaDataType_t(DType(b->dtype)), ldb, a->data,
+                             cudaDataType_t(DType(a->dtype)), lda, const_addr<0>(CUDA_R_32F),
+                             c->data, cudaDataType_t(DType(c->dtype)), m, CUDA_R_32F,
+                             CUBLAS_GEMM_DEFAULT_TENSOR_OP));
+    return;
+  }
   if (c->dtype.code == kDLFloat) {
     switch (c->dtype.bits) {
       case 16: {
@@ -128,11 +137,14 @@ RAF_REGISTER_DIALECT_OP(cublas, matmul_nt, 15);
 RAF_REGISTER_DIALECT_OP(cublas, matmul_tn, 15);
 RAF_REGISTER_DIALECT_OP(cublas, matmul_tt, 15);
 RAF_REGISTER_DIALECT_OP(cublas, dense, 15);
+// The fallback of the 2:4 sparse dense, e.g., before sm80.
+RAF_REGISTER_DIALECT_OP(cublas, sparse24_dense, 15);
 RAF_OP_ENV_MAKER("raf.op.cublas.matmul", MatmulNN::make);
 RAF_OP_ENV_MAKER("raf.op.cublas.matmul_nt", MatmulNT::make);
 RAF_OP_ENV_MAKER("raf.op.cublas.matmul_tn", MatmulTN::make);
 RAF_OP_ENV_MAKER("raf.op.cublas.matmul_tt", MatmulTT::make);
 RAF_OP_ENV_MAKER("raf.op.cublas.dense", MatmulNT::make);
+RAF_OP_ENV_MAKER("raf.op.cublas.sparse24_dense", MatmulNT::make);
 
 }  // namespace manual
 }  // namespace cublas
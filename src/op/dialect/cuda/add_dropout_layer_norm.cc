@@ -0,0 +1,367 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/add_dropout_layer_norm.cc
+ * \brief Fused residual add, dropout and layer norm cuda backend
+ */
+#include <algorithm>
+#include <random>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "raf/value.h"
+#include "../../schema/nn.h"
+#include "../../../common/shape_utils.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+using common::shape_utils::BytesCompactTensor;
+
+/*! \brief Get the number of rows n1 and the row size n2 of x, which is normalized over the last
+ * dimension. */
+void GetRowShape(const DLTensor* x, int* n1, int* n2) {
+  CHECK(x->dtype.code == kDLFloat && (x->dtype.bits == 32 || x->dtype.bits == 16))
+      << "Unsupported dtype: " << DType(x->dtype).c_str();
+  *n2 = x->shape[x->ndim - 1];
+  *n1 = 1;
+  for (int i = 0; i < x->ndim - 1; ++i) {
+    *n1 *= x->shape[i];
+  }
+}
+
+template <typename T>
+const T* DataOrNull(const DLTensor* tensor) {
+  return tensor ? static_cast<const T*>(tensor->data) : nullptr;
+}
+
+template <typename T>
+T* MutableDataOrNull(DLTensor* tensor) {
+  return tensor ? static_cast<T*>(tensor->data) : nullptr;
+}
+
+/*! \brief Launch the forward, where z, mean, invvar and rng_state may be nullptr if they are not
+ * needed. */
+void AddDropoutLayerNormForward(const DLTensor* x, const DLTensor* residual,
+                                const DLTensor* scale, const DLTensor* bias, DLTensor* y, void* z,
+                                float* mean, float* invvar, int64_t* rng_state, int n1, int n2,
+                                float p, float eps, uint64_t seed) {
+  static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+  void* stream = cuda_device_api->GetStream();
+  switch (x->dtype.bits) {
+    case 32:
+      add_dropout_layer_norm_forward_cuda<float>(
+          DataOrNull<float>(x), DataOrNull<float>(residual), DataOrNull<float>(scale),
+          DataOrNull<float>(bias), MutableDataOrNull<float>(y), static_cast<float*>(z), mean,
+          invvar, rng_state, n1, n2, p, eps, seed, stream);
+      return;
+    case 16:
+      add_dropout_layer_norm_forward_cuda<__half>(
+          DataOrNull<__half>(x), DataOrNull<__half>(residual), DataOrNull<__half>(scale),
+          DataOrNull<__half>(bias), MutableDataOrNull<__half>(y), static_cast<__half*>(z), mean,
+          invvar, rng_state, n1, n2, p, eps, seed, stream);
+      return;
+  }
+}
+
+class AddDropoutLayerNormImpl : public raf::op::OpEnv {
+ public:
+  explicit AddDropoutLayerNormImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.add_dropout_layer_norm");
+    auto args = cv->args.as<op::schema::AddDropoutLayerNormArgs>();
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("residual"),
+    };
+    has_affine_ = args->scale.defined();
+    if (has_affine_) {
+      this->arg_indices.push_back(fschema_index[op]("scale"));
+      this->arg_indices.push_back(fschema_index[op]("bias"));
+    }
+    GetRowShape(args->x, &n1_, &n2_);
+    p_ = args->p;
+    eps_ = args->eps;
+    CHECK(p_ >= 0 && p_ < 1) << "The dropout probability must be in [0, 1), but got " << p_;
+    seed_ = std::random_device()();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AddDropoutLayerNormArgs>();
+    std::vector<Value> inputs{args->x, args->residual};
+    if (has_affine_) {
+      inputs.push_back(args->scale.value());
+      inputs.push_back(args->bias.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = Downcast<TensorValue>(inputs[0]);
+    DLTensor* residual = Downcast<TensorValue>(inputs[1]);
+    DLTensor* scale = has_affine_ ? static_cast<DLTensor*>(Downcast<TensorValue>(inputs[2]))
+                                  : nullptr;
+    DLTensor* bias = has_affine_ ? static_cast<DLTensor*>(Downcast<TensorValue>(inputs[3]))
+                                 : nullptr;
+    TupleValue out_tuple = Downcast<TupleValue>(output);
+    DLTensor* y = Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* z = Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* mean = Downcast<TensorValue>(out_tuple->fields[2]);
+    DLTensor* invvar = Downcast<TensorValue>(out_tuple->fields[3]);
+    DLTensor* rng_state = Downcast<TensorValue>(out_tuple->fields[4]);
+    // Each execution draws a new dropout mask.
+    AddDropoutLayerNormForward(x, residual, scale, bias, y, z->data,
+                               static_cast<float*>(mean->data), static_cast<float*>(invvar->data),
+                               static_cast<int64_t*>(rng_state->data), n1_, n2_, p_, eps_,
+                               seed_++);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.add_dropout_layer_norm"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AddDropoutLayerNormImpl(cv);
+  }
+
+ private:
+  bool has_affine_;
+  int n1_, n2_;
+  float p_;
+  float eps_;
+  uint64_t seed_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, add_dropout_layer_norm, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.add_dropout_layer_norm", AddDropoutLayerNormImpl::make);
+
+class AddDropoutLayerNormDxImpl : public raf::op::OpEnv {
+ public:
+  explicit AddDropoutLayerNormDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.add_dropout_layer_norm_dx");
+    auto args = cv->args.as<op::schema::AddDropoutLayerNormDxArgs>();
+    has_dz_ = args->dz.defined();
+    has_affine_ = args->scale.defined();
+    this->arg_indices = {fschema_index[op]("dy")};
+    if (has_dz_) {
+      this->arg_indices.push_back(fschema_index[op]("dz"));
+    }
+    this->arg_indices.push_back(fschema_index[op]("z"));
+    if (has_affine_) {
+      this->arg_indices.push_back(fschema_index[op]("scale"));
+    }
+    this->arg_indices.push_back(fschema_index[op]("mean"));
+    this->arg_indices.push_back(fschema_index[op]("invvar"));
+    this->arg_indices.push_back(fschema_index[op]("rng_state"));
+    GetRowShape(args->z, &n1_, &n2_);
+    p_ = args->p;
+    if (has_affine_) {
+      RequestWorkspace(&part_grad_, cv->device, add_dropout_layer_norm_gamma_beta_workspace(n2_));
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AddDropoutLayerNormDxArgs>();
+    std::vector<Value> inputs{args->dy};
+    if (has_dz_) {
+      inputs.push_back(args->dz.value());
+    }
+    inputs.push_back(args->z);
+    if (has_affine_) {
+      inputs.push_back(args->scale.value());
+    }
+    inputs.push_back(args->mean);
+    inputs.push_back(args->invvar);
+    inputs.push_back(args->rng_state);
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    int i = 0;
+    auto next_input = [&]() -> DLTensor* { return Downcast<TensorValue>(inputs[i++]); };
+    DLTensor* dy = next_input();
+    DLTensor* dz = has_dz_ ? next_input() : nullptr;
+    DLTensor* z = next_input();
+    DLTensor* scale = has_affine_ ? next_input() : nullptr;
+    const float* mean = static_cast<const float*>(next_input()->data);
+    const float* invvar = static_cast<const float*>(next_input()->data);
+    const int64_t* rng_state = static_cast<const int64_t*>(next_input()->data);
+
+    TupleValue out_tuple = Downcast<TupleValue>(output);
+    DLTensor* dx = Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* dresidual = Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* dscale = nullptr;
+    DLTensor* dbias = nullptr;
+    if (has_affine_) {
+      dscale = Downcast<TensorValue>(out_tuple->fields[2]);
+      dbias = Downcast<TensorValue>(out_tuple->fields[3]);
+    }
+    float* part_grad = static_cast<float*>(part_grad_);
+    void* stream = cuda_device_api->GetStream();
+    switch (z->dtype.bits) {
+      case 32:
+        add_dropout_layer_norm_backward_cuda<float>(
+            DataOrNull<float>(dy), DataOrNull<float>(dz), DataOrNull<float>(z),
+            DataOrNull<float>(scale), mean, invvar, rng_state, MutableDataOrNull<float>(dx),
+            MutableDataOrNull<float>(dresidual), MutableDataOrNull<float>(dscale),
+            MutableDataOrNull<float>(dbias), part_grad, n1_, n2_, p_, stream);
+        return;
+      case 16:
+        add_dropout_layer_norm_backward_cuda<__half>(
+            DataOrNull<__half>(dy), DataOrNull<__half>(dz), DataOrNull<__half>(z),
+            DataOrNull<__half>(scale), mean, invvar, rng_state, MutableDataOrNull<__half>(dx),
+            MutableDataOrNull<__half>(dresidual), MutableDataOrNull<__half>(dscale),
+            MutableDataOrNull<__half>(dbias), part_grad, n1_, n2_, p_, stream);
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.add_dropout_layer_norm_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AddDropoutLayerNormDxImpl(cv);
+  }
+
+ private:
+  bool has_dz_;
+  bool has_affine_;
+  int n1_, n2_;
+  float p_;
+  void* part_grad_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, add_dropout_layer_norm_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.add_dropout_layer_norm_dx", AddDropoutLayerNormDxImpl::make);
+
+/*!
+ * \brief OpEnv for the fused functions in the following patterns, which are computed by the
+ * forward kernel of add_dropout_layer_norm in one pass:
+ *   - layer_norm(residual + dropout(x)[0], scale, bias)
+ *   - layer_norm(residual + x, scale, bias)
+ * where layer_norm normalizes the last axis. Only the layer norm output is produced, so the
+ * residual sum stays in shared memory unless the rows are too large for it.
+ */
+class AddDropoutLayerNormFusedImpl : public raf::op::OpEnv {
+ public:
+  explicit AddDropoutLayerNormFusedImpl(const CallValues& cv) {
+    auto func = Downcast<ClosureValue>(cv->callee)->func;
+    if (!Match(func)) {
+      error_msgs.push_back("[CUDA] Cannot JIT: unsupported pattern");
+      return;
+    }
+    Array<Value> args = GetListArgs(cv->args);
+    auto param_index = [&](const Var& param) {
+      auto it = std::find(func->params.begin(), func->params.end(), param);
+      CHECK(it != func->params.end());
+      return static_cast<int>(it - func->params.begin());
+    };
+    for (const auto& param : {x_, residual_, scale_, bias_}) {
+      arg_indices.push_back(param_index(param));
+    }
+    p_ = p_var_.defined() ? GetScalarValueData<double>(args[param_index(p_var_)]) : 0.0;
+    eps_ = GetScalarValueData<double>(args[param_index(eps_var_)]);
+    CHECK(p_ >= 0 && p_ < 1) << "The dropout probability must be in [0, 1), but got " << p_;
+    DLTensor* x = Downcast<TensorValue>(args[arg_indices[0]]);
+    GetRowShape(x, &n1_, &n2_);
+    if (n2_ > kAddDropoutLayerNormMaxCachedCols) {
+      RequestWorkspace(&z_, cv->device, BytesCompactTensor(*x));
+    }
+    seed_ = std::random_device()();
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.add_dropout_layer_norm"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (int i : arg_indices) {
+      inputs.push_back(args[i]);
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = Downcast<TensorValue>(inputs[0]);
+    DLTensor* residual = Downcast<TensorValue>(inputs[1]);
+    DLTensor* scale = Downcast<TensorValue>(inputs[2]);
+    DLTensor* bias = Downcast<TensorValue>(inputs[3]);
+    DLTensor* y = Downcast<TensorValue>(output);
+    // Each execution draws a new dropout mask.
+    AddDropoutLayerNormForward(x, residual, scale, bias, y, z_, nullptr, nullptr, nullptr, n1_,
+                               n2_, p_, eps_, seed_++);
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AddDropoutLayerNormFusedImpl(cv);
+  }
+
+ private:
+  /*! \brief Match the fused function and record its operands. Returns false if unsupported. */
+  bool Match(const Function& func) {
+    static const Op& layer_norm_op = Op::Get("raf.op.cuda.layer_norm");
+    static const Op& add_op = Op::Get("raf.op.cuda.add");
+    static const Op& dropout_op = Op::Get("raf.op.cuda._contrib_dropout");
+
+    const auto* ln = func->body.as<CallNode>();
+    if (!ln || ln->op != layer_norm_op) {
+      return false;
+    }
+    const auto* add = ln->args[0].as<CallNode>();
+    if (!add || add->op != add_op) {
+      return false;
+    }
+    // Add is commutative, so the dropout may be either of the operands.
+    int dropout_idx = add->args[0].as<TupleGetItemNode>() ? 0 : 1;
+    if (const auto* tgi = add->args[dropout_idx].as<TupleGetItemNode>()) {
+      const auto* dropout = tgi->tuple.as<CallNode>();
+      if (!dropout || dropout->op != dropout_op || tgi->index != 0) {
+        return false;
+      }
+      x_ = Downcast<Var>(dropout->args[0]);
+      p_var_ = Downcast<Var>(dropout->args[1]);
+    } else {
+      x_ = Downcast<Var>(add->args[dropout_idx]);
+    }
+    residual_ = Downcast<Var>(add->args[1 - dropout_idx]);
+    scale_ = Downcast<Var>(ln->args[1]);
+    bias_ = Downcast<Var>(ln->args[2]);
+    eps_var_ = Downcast<Var>(ln->args[4]);
+    return true;
+  }
+
+  /*! \brief The operands in the fused function. p_var_ is undefined if there is no dropout. */
+  Var x_, residual_, scale_, bias_, p_var_, eps_var_;
+  int n1_, n2_;
+  float p_;
+  float eps_;
+  uint64_t seed_;
+  /*! \brief The residual sum when it does not fit in shared memory. */
+  void* z_ = nullptr;
+};
+
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_op.add_dropout_layer_norm",
+                 AddDropoutLayerNormFusedImpl::make);
+
+// The ops in the fused functions, which are only executed by the fused op. The dropout in the
+// fused functions is the standalone cuda dropout in dropout.cc.
+RAF_REGISTER_DIALECT_OP(cuda, add, 0);
+RAF_REGISTER_DIALECT_OP(cuda, layer_norm, 0);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
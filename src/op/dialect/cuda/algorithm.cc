@@ -0,0 +1,262 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/algorithm.cc
+ * \brief Sort, argsort and top-k cuda backend
+ */
+#include <climits>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "raf/value.h"
+#include "../../schema/algorithm.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*!
+ * \brief Returns an error message if the rows of data cannot be sorted by the CUDA kernels, which
+ * sort along the last axis only.
+ */
+std::string CheckSortArgs(const DLTensor* data, int axis, const DLDataType* index_dtype) {
+  if (axis != -1 && axis != data->ndim - 1) {
+    return "only the last axis is supported, but got axis " + std::to_string(axis);
+  }
+  DLDataType dtype = data->dtype;
+  bool is_float = dtype.code == kDLFloat && (dtype.bits == 16 || dtype.bits == 32);
+  bool is_int = dtype.code == kDLInt && (dtype.bits == 32 || dtype.bits == 64);
+  if (!is_float && !is_int) {
+    return "unsupported dtype " + tvm::runtime::DLDataType2String(dtype);
+  }
+  if (index_dtype && (index_dtype->code != kDLInt ||
+                      (index_dtype->bits != 32 && index_dtype->bits != 64))) {
+    return "unsupported index dtype " + tvm::runtime::DLDataType2String(*index_dtype);
+  }
+  int64_t num = 1;
+  for (int i = 0; i < data->ndim; ++i) {
+    num *= data->shape[i];
+  }
+  if (num >= INT_MAX) {
+    return "too many elements: " + std::to_string(num);
+  }
+  return "";
+}
+
+template <typename I, typename T>
+void TopkTyped(const DLTensor* data, DLTensor* values, DLTensor* indices, int num_rows,
+               int num_cols, int k, bool is_ascend, void* workspace) {
+  static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+  topk_cuda<T, I>(static_cast<const T*>(data->data),
+                  values ? static_cast<T*>(values->data) : nullptr,
+                  indices ? static_cast<I*>(indices->data) : nullptr, num_rows, num_cols, k,
+                  is_ascend, workspace, cuda_device_api->GetStream());
+}
+
+template <typename T>
+void TopkDispatchIndex(const DLTensor* data, DLTensor* values, DLTensor* indices, int num_rows,
+                       int num_cols, int k, bool is_ascend, void* workspace) {
+  if (indices && indices->dtype.bits == 32) {
+    TopkTyped<int32_t, T>(data, values, indices, num_rows, num_cols, k, is_ascend, workspace);
+  } else {
+    TopkTyped<int64_t, T>(data, values, indices, num_rows, num_cols, k, is_ascend, workspace);
+  }
+}
+
+/*! \brief Sort the rows of data and write the first k elements, or their positions, or both. */
+void Topk(const DLTensor* data, DLTensor* values, DLTensor* indices, int num_rows, int num_cols,
+          int k, bool is_ascend, void* workspace) {
+  DLDataType dtype = data->dtype;
+  if (dtype.code == kDLFloat && dtype.bits == 32) {
+    TopkDispatchIndex<float>(data, values, indices, num_rows, num_cols, k, is_ascend, workspace);
+  } else if (dtype.code == kDLFloat) {
+    TopkDispatchIndex<__half>(data, values, indices, num_rows, num_cols, k, is_ascend, workspace);
+  } else if (dtype.bits == 32) {
+    TopkDispatchIndex<int32_t>(data, values, indices, num_rows, num_cols, k, is_ascend, workspace);
+  } else {
+    TopkDispatchIndex<int64_t>(data, values, indices, num_rows, num_cols, k, is_ascend, workspace);
+  }
+}
+
+int64_t TopkWorkspace(const DLTensor* data, int num_rows, int num_cols, bool is_ascend) {
+  DLDataType dtype = data->dtype;
+  if (dtype.code == kDLFloat) {
+    return dtype.bits == 32 ? topk_workspace<float>(num_rows, num_cols, is_ascend)
+                            : topk_workspace<__half>(num_rows, num_cols, is_ascend);
+  }
+  return dtype.bits == 32 ? topk_workspace<int32_t>(num_rows, num_cols, is_ascend)
+                          : topk_workspace<int64_t>(num_rows, num_cols, is_ascend);
+}
+
+/*! \brief The common part of the sorting ops, which sort the rows along the last axis. */
+class SortOpEnv : public raf::op::OpEnv {
+ protected:
+  void Init(const CallValues& cv, const DLTensor* data, bool is_ascend) {
+    num_cols_ = data->ndim == 0 ? 1 : data->shape[data->ndim - 1];
+    num_rows_ = 1;
+    for (int i = 0; i < data->ndim - 1; ++i) {
+      num_rows_ *= data->shape[i];
+    }
+    is_ascend_ = is_ascend;
+    RequestWorkspace(&workspace_, cv->device,
+                     TopkWorkspace(data, num_rows_, num_cols_, is_ascend_));
+  }
+
+  int num_rows_, num_cols_;
+  bool is_ascend_;
+  void* workspace_ = nullptr;
+};
+
+class ArgsortImpl : public SortOpEnv {
+ public:
+  explicit ArgsortImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.argsort");
+    auto args = cv->args.as<op::schema::ArgsortArgs>();
+    const DLTensor* data = args->data;
+    DLDataType index_dtype = ir::String2DLDataType(args->dtype);
+    std::string msg = CheckSortArgs(data, args->axis, &index_dtype);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] argsort: " + msg);
+      return;
+    }
+    this->arg_indices = {fschema_index[op]("data")};
+    Init(cv, data, args->is_ascend);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::ArgsortArgs>();
+    Execute({args->data}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* data = Downcast<TensorValue>(inputs[0]);
+    DLTensor* indices = Downcast<TensorValue>(output);
+    Topk(data, nullptr, indices, num_rows_, num_cols_, num_cols_, is_ascend_, workspace_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.argsort"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new ArgsortImpl(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, argsort, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.argsort", ArgsortImpl::make);
+
+class SortImpl : public SortOpEnv {
+ public:
+  explicit SortImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.sort");
+    auto args = cv->args.as<op::schema::SortArgs>();
+    const DLTensor* data = args->data;
+    std::string msg = CheckSortArgs(data, args->axis, nullptr);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] sort: " + msg);
+      return;
+    }
+    this->arg_indices = {fschema_index[op]("data")};
+    Init(cv, data, args->is_ascend);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::SortArgs>();
+    Execute({args->data}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* data = Downcast<TensorValue>(inputs[0]);
+    DLTensor* values = Downcast<TensorValue>(output);
+    Topk(data, values, nullptr, num_rows_, num_cols_, num_cols_, is_ascend_, workspace_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.sort"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new SortImpl(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, sort, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.sort", SortImpl::make);
+
+class TopkImpl : public SortOpEnv {
+ public:
+  explicit TopkImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.topk");
+    auto args = cv->args.as<op::schema::TopkArgs>();
+    const DLTensor* data = args->data;
+    DLDataType index_dtype = ir::String2DLDataType(args->dtype);
+    std::string msg = CheckSortArgs(data, args->axis, &index_dtype);
+    int64_t k = args->k.defined() ? GetScalarValueData<int64_t>(args->k) : 1;
+    if (msg.empty() && k < 0) {
+      msg = "k must be non-negative, but got " + std::to_string(k);
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] topk: " + msg);
+      return;
+    }
+    // k is the attribute of the kernel rather than an input.
+    this->arg_indices = {fschema_index[op]("data")};
+    Init(cv, data, args->is_ascend);
+    k_ = k;
+    ret_type_ = args->ret_type;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::TopkArgs>();
+    Execute({args->data}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* data = Downcast<TensorValue>(inputs[0]);
+    DLTensor* values = nullptr;
+    DLTensor* indices = nullptr;
+    if (ret_type_ == "both") {
+      TupleValue out_tuple = Downcast<TupleValue>(output);
+      values = Downcast<TensorValue>(out_tuple->fields[0]);
+      indices = Downcast<TensorValue>(out_tuple->fields[1]);
+    } else if (ret_type_ == "values") {
+      values = Downcast<TensorValue>(output);
+    } else {
+      indices = Downcast<TensorValue>(output);
+    }
+    Topk(data, values, indices, num_rows_, num_cols_, k_, is_ascend_, workspace_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.topk"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new TopkImpl(cv);
+  }
+
+ private:
+  int k_;
+  std::string ret_type_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, topk, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.topk", TopkImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,210 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/attention.cc
+ * \brief Fused attention cuda backend
+ */
+#include <cmath>
+#include <random>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*! \brief The shape of the attention inputs in [batch, seq, head_dim], where batch is the product
+ * of all leading dimensions. */
+struct AttentionShape {
+  int batch;
+  int seq_q;
+  int seq_k;
+  int head_dim;
+  float scale;
+};
+
+AttentionShape GetAttentionShape(const DLTensor* q, const DLTensor* k, double scale) {
+  AttentionShape ret;
+  ret.batch = 1;
+  for (int i = 0; i < q->ndim - 2; ++i) {
+    ret.batch *= q->shape[i];
+  }
+  ret.seq_q = q->shape[q->ndim - 2];
+  ret.seq_k = k->shape[k->ndim - 2];
+  ret.head_dim = q->shape[q->ndim - 1];
+  // A non-positive scale means the default 1 / sqrt(head_dim).
+  ret.scale = scale > 0 ? scale : 1.0 / std::sqrt(static_cast<double>(ret.head_dim));
+  CHECK_LE(ret.head_dim, kAttentionMaxHeadDim)
+      << "The fused attention only supports head dimensions up to " << kAttentionMaxHeadDim;
+  // The batch is the y dimension of the grid.
+  CHECK_LE(ret.batch, 65535) << "The fused attention only supports batch * heads up to 65535";
+  CHECK(q->dtype.code == kDLFloat && (q->dtype.bits == 32 || q->dtype.bits == 16))
+      << "Unsupported dtype: " << DType(q->dtype).c_str();
+  return ret;
+}
+
+class AttentionImpl : public raf::op::OpEnv {
+ public:
+  explicit AttentionImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.attention");
+    auto args = cv->args.as<op::schema::AttentionArgs>();
+    this->arg_indices = {
+        fschema_index[op]("q"),
+        fschema_index[op]("k"),
+        fschema_index[op]("v"),
+    };
+    shape_ = GetAttentionShape(args->q, args->k, args->scale);
+    causal_ = args->causal;
+    p_ = args->p;
+    CHECK(p_ >= 0 && p_ < 1) << "The dropout probability must be in [0, 1), but got " << p_;
+    seed_ = std::random_device()();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AttentionArgs>();
+    Execute(std::vector<Value>{args->q, args->k, args->v}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* q = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* k = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* v = ir::Downcast<TensorValue>(inputs[2]);
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* out = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* lse = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* rng_state = ir::Downcast<TensorValue>(out_tuple->fields[2]);
+    // Each execution draws a new dropout mask.
+    uint64_t seed = seed_++;
+    const auto& s = shape_;
+    switch (q->dtype.bits) {
+      case 32:
+        attention_forward_cuda<float>(
+            static_cast<const float*>(q->data), static_cast<const float*>(k->data),
+            static_cast<const float*>(v->data), static_cast<float*>(out->data),
+            static_cast<float*>(lse->data), static_cast<int64_t*>(rng_state->data), s.batch,
+            s.seq_q, s.seq_k, s.head_dim, s.scale, causal_, p_, seed, cuda_device_api->GetStream());
+        return;
+      case 16:
+        attention_forward_cuda<__half>(
+            static_cast<const __half*>(q->data), static_cast<const __half*>(k->data),
+            static_cast<const __half*>(v->data), static_cast<__half*>(out->data),
+            static_cast<float*>(lse->data), static_cast<int64_t*>(rng_state->data), s.batch,
+            s.seq_q, s.seq_k, s.head_dim, s.scale, causal_, p_, seed, cuda_device_api->GetStream());
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.attention"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AttentionImpl(cv);
+  }
+
+ private:
+  AttentionShape shape_;
+  bool causal_;
+  float p_;
+  uint64_t seed_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, attention, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.attention", AttentionImpl::make);
+
+class AttentionDxImpl : public raf::op::OpEnv {
+ public:
+  explicit AttentionDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.attention_dx");
+    auto args = cv->args.as<op::schema::AttentionDxArgs>();
+    this->arg_indices = {
+        fschema_index[op]("q"),   fschema_index[op]("k"),   fschema_index[op]("v"),
+        fschema_index[op]("out"), fschema_index[op]("dy"),  fschema_index[op]("lse"),
+        fschema_index[op]("rng_state"),
+    };
+    shape_ = GetAttentionShape(args->q, args->k, args->scale);
+    causal_ = args->causal;
+    p_ = args->p;
+    // The row sums of dy * out.
+    RequestWorkspace(&delta_, cv->device,
+                     static_cast<int64_t>(shape_.batch) * shape_.seq_q * sizeof(float));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AttentionDxArgs>();
+    Execute(std::vector<Value>{args->q, args->k, args->v, args->out, args->dy, args->lse,
+                               args->rng_state},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    std::vector<void*> in_data;
+    for (const auto& input : inputs) {
+      DLTensor* tensor = ir::Downcast<TensorValue>(input);
+      in_data.push_back(tensor->data);
+    }
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* dq = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* dk = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* dv = ir::Downcast<TensorValue>(out_tuple->fields[2]);
+    const float* lse = static_cast<const float*>(in_data[5]);
+    const int64_t* rng_state = static_cast<const int64_t*>(in_data[6]);
+    float* delta = static_cast<float*>(delta_);
+    const auto& s = shape_;
+    switch (dq->dtype.bits) {
+      case 32: {
+        auto data = [&](int i) { return static_cast<const float*>(in_data[i]); };
+        attention_backward_cuda<float>(
+            data(0), data(1), data(2), data(3), data(4), lse, rng_state,
+            static_cast<float*>(dq->data), static_cast<float*>(dk->data),
+            static_cast<float*>(dv->data), delta, s.batch, s.seq_q, s.seq_k, s.head_dim, s.scale,
+            causal_, p_, cuda_device_api->GetStream());
+        return;
+      }
+      case 16: {
+        auto data = [&](int i) { return static_cast<const __half*>(in_data[i]); };
+        attention_backward_cuda<__half>(
+            data(0), data(1), data(2), data(3), data(4), lse, rng_state,
+            static_cast<__half*>(dq->data), static_cast<__half*>(dk->data),
+            static_cast<__half*>(dv->data), delta, s.batch, s.seq_q, s.seq_k, s.head_dim, s.scale,
+            causal_, p_, cuda_device_api->GetStream());
+        return;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.attention_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AttentionDxImpl(cv);
+  }
+
+ private:
+  AttentionShape shape_;
+  bool causal_;
+  float p_;
+  void* delta_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, attention_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.attention_dx", AttentionDxImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
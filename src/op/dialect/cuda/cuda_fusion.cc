@@ -0,0 +1,41 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/cuda_fusion.cc
+ * \brief Dispatch the fused functions of the cuda dialect by their patterns
+ */
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/value.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+/*!
+ * \brief Make the OpEnv of a fused function of the cuda dialect. The OpEnv of the fused functions
+ * in the pattern <name> is registered to raf.op.cuda._fused_op.<name>.
+ * \param call the call value to be dispatched
+ * \return the OpEnv of the pattern
+ */
+OpEnv* FusedFuncBuild(const op::CallValues& call) {
+  Function func = Downcast<ClosureValue>(call->callee)->func;
+  auto attr = func->GetAttr<String>(attr::kPatternName);
+  ICHECK(attr.defined()) << "No pattern name marked for the function";
+  std::string pattern_name = attr.value();
+  auto maker = OpEnvMaker::Get("raf.op.cuda._fused_op." + pattern_name);
+  CHECK(maker) << "Unknown cuda fusion pattern: " << pattern_name;
+  return (*maker)(call);
+}
+
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_op", FusedFuncBuild);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
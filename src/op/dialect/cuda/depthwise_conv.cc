@@ -0,0 +1,275 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/depthwise_conv.cc
+ * \brief Depthwise conv2d, conv2d_dx and conv2d_dw cuda backend. The convolutions whose groups
+ * are not the input channels are left to cuDNN.
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "raf/value.h"
+#include "../../schema/nn.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using op::schema::ConvArgs;
+using op::schema::ConvDxwArgs;
+using device_api::DeviceAPI;
+
+/*! \brief The most filter elements the kernels stage in shared memory. */
+constexpr int64_t kDepthwiseMaxFilter = 8192;
+
+/*! \brief Returns a pair of the values of a 1 or 2 element stride, padding or dilation. */
+bool DepthwisePair(const std::vector<int64_t>& v, int* a, int* b) {
+  if (v.size() != 1 && v.size() != 2) {
+    return false;
+  }
+  *a = v[0];
+  *b = v.back();
+  return true;
+}
+
+/*!
+ * \brief Fill the params of the conv2d of the NCHW x, [out_channels, 1, kh, kw] w and NCHW y, or
+ * the NHWC ones with an OHWI filter if nhwc is true. Returns an error message if unsupported.
+ */
+std::string MakeDepthwiseConvParams(const DLTensor* x, const DLTensor* w, const DLTensor* y,
+                                    const std::vector<int64_t>& stride,
+                                    const std::vector<int64_t>& padding,
+                                    const std::vector<int64_t>& dilation, int64_t groups,
+                                    bool nhwc, DepthwiseConvParams* p) {
+  if (x->ndim != 4 || w->ndim != 4 || y->ndim != 4) {
+    return "only 2-D convolutions are supported";
+  }
+  const DLDataType dtype = x->dtype;
+  for (const DLTensor* t : {w, y}) {
+    if (t->dtype.code != dtype.code || t->dtype.bits != dtype.bits) {
+      return "mixed dtypes are not supported";
+    }
+  }
+  if (dtype.code != kDLFloat || (dtype.bits != 16 && dtype.bits != 32)) {
+    return "unsupported dtype " + tvm::runtime::DLDataType2String(dtype);
+  }
+  const int c_axis = nhwc ? 3 : 1;
+  const int h_axis = nhwc ? 1 : 2;
+  p->batch = x->shape[0];
+  p->in_channels = x->shape[c_axis];
+  p->in_h = x->shape[h_axis];
+  p->in_w = x->shape[h_axis + 1];
+  p->out_channels = y->shape[c_axis];
+  p->out_h = y->shape[h_axis];
+  p->out_w = y->shape[h_axis + 1];
+  p->kernel_h = w->shape[nhwc ? 1 : 2];
+  p->kernel_w = w->shape[nhwc ? 2 : 3];
+  if (groups != p->in_channels || w->shape[nhwc ? 3 : 1] != 1 ||
+      p->out_channels % p->in_channels != 0) {
+    return "only depthwise convolutions (groups == in_channels) are supported";
+  }
+  if (nhwc && p->out_channels != p->in_channels) {
+    return "NHWC with a channel multiplier is not supported";
+  }
+  if (!DepthwisePair(stride, &p->stride_h, &p->stride_w) ||
+      !DepthwisePair(padding, &p->pad_h, &p->pad_w) ||
+      !DepthwisePair(dilation, &p->dilation_h, &p->dilation_w)) {
+    return "stride, padding and dilation must have 1 or 2 elements";
+  }
+  const int64_t multiplier = p->out_channels / p->in_channels;
+  if (multiplier * p->kernel_h * p->kernel_w > kDepthwiseMaxFilter) {
+    return "the filter is too large";
+  }
+  return "";
+}
+
+/*! \brief Launch the kernel of the dtype of tensor, with T bound to float or __half. */
+template <typename F>
+void DispatchHalfOrFloat(const DLTensor* tensor, F launch) {
+  if (tensor->dtype.bits == 32) {
+    launch(float());
+  } else {
+    launch(__half());
+  }
+}
+
+/*!
+ * \brief The depthwise conv2d, where a thread computes several adjacent outputs of a row in
+ * registers for NCHW, or several adjacent channels with vectorized accesses for NHWC.
+ */
+class DepthwiseConv2dImpl : public raf::op::OpEnv {
+ public:
+  explicit DepthwiseConv2dImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.conv2d");
+    auto args = cv->args.as<ConvArgs>();
+    std::string msg;
+    if (args->layout == "NCHW" && args->kernel_layout == "OIHW" && args->out_layout == "NCHW") {
+      nhwc_ = false;
+    } else if (args->layout == "NHWC" && args->kernel_layout == "OHWI" &&
+               args->out_layout == "NHWC") {
+      nhwc_ = true;
+    } else {
+      msg = "unsupported layouts " + args->layout + ", " + args->kernel_layout + ", " +
+            args->out_layout;
+    }
+    if (msg.empty()) {
+      msg = MakeDepthwiseConvParams(args->x, args->w, cv->out, args->stride, args->padding,
+                                    args->dilation, args->groups, nhwc_, &params_);
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] conv2d: " + msg);
+      return;
+    }
+    this->arg_indices = {fschema_index[op]("x"), fschema_index[op]("w")};
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<ConvArgs>();
+    Execute({args->x, args->w}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x = Downcast<TensorValue>(inputs[0]);
+    DLTensor* w = Downcast<TensorValue>(inputs[1]);
+    DLTensor* y = Downcast<TensorValue>(output);
+    DispatchHalfOrFloat(x, [&](auto dummy) {
+      using T = decltype(dummy);
+      depthwise_conv2d_cuda<T>(static_cast<const T*>(x->data), static_cast<const T*>(w->data),
+                               static_cast<T*>(y->data), params_, nhwc_,
+                               cuda_device_api->GetStream());
+    });
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.conv2d"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new DepthwiseConv2dImpl(cv);
+  }
+
+ private:
+  DepthwiseConvParams params_;
+  bool nhwc_ = false;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, conv2d, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.conv2d", DepthwiseConv2dImpl::make);
+
+/*! \brief The input gradient of the NCHW depthwise conv2d, gathered from dy without atomics. */
+class DepthwiseConv2dDxImpl : public raf::op::OpEnv {
+ public:
+  explicit DepthwiseConv2dDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.conv2d_dx");
+    auto args = cv->args.as<ConvDxwArgs>();
+    std::string msg = MakeDepthwiseConvParams(cv->out, args->x_or_w, args->dy, args->stride,
+                                              args->padding, args->dilation, args->groups, false,
+                                              &params_);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] conv2d_dx: " + msg);
+      return;
+    }
+    this->arg_indices = {fschema_index[op]("x_or_w"), fschema_index[op]("dy")};
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<ConvDxwArgs>();
+    Execute({args->x_or_w, args->dy}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* w = Downcast<TensorValue>(inputs[0]);
+    DLTensor* dy = Downcast<TensorValue>(inputs[1]);
+    DLTensor* dx = Downcast<TensorValue>(output);
+    DispatchHalfOrFloat(dy, [&](auto dummy) {
+      using T = decltype(dummy);
+      depthwise_conv2d_dx_cuda<T>(static_cast<const T*>(dy->data), static_cast<const T*>(w->data),
+                                  static_cast<T*>(dx->data), params_,
+                                  cuda_device_api->GetStream());
+    });
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.conv2d_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new DepthwiseConv2dDxImpl(cv);
+  }
+
+ private:
+  DepthwiseConvParams params_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, conv2d_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.conv2d_dx", DepthwiseConv2dDxImpl::make);
+
+/*!
+ * \brief The filter gradient of the NCHW depthwise conv2d, reduced in parts whose partial sums
+ * are added in a fixed order, so the result is deterministic.
+ */
+class DepthwiseConv2dDwImpl : public raf::op::OpEnv {
+ public:
+  explicit DepthwiseConv2dDwImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.conv2d_dw");
+    auto args = cv->args.as<ConvDxwArgs>();
+    std::string msg = MakeDepthwiseConvParams(args->x_or_w, cv->out, args->dy, args->stride,
+                                              args->padding, args->dilation, args->groups, false,
+                                              &params_);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] conv2d_dw: " + msg);
+      return;
+    }
+    this->arg_indices = {fschema_index[op]("x_or_w"), fschema_index[op]("dy")};
+    RequestWorkspace(&workspace_, cv->device, depthwise_conv2d_dw_workspace(params_));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<ConvDxwArgs>();
+    Execute({args->x_or_w, args->dy}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x = Downcast<TensorValue>(inputs[0]);
+    DLTensor* dy = Downcast<TensorValue>(inputs[1]);
+    DLTensor* dw = Downcast<TensorValue>(output);
+    DispatchHalfOrFloat(x, [&](auto dummy) {
+      using T = decltype(dummy);
+      depthwise_conv2d_dw_cuda<T>(static_cast<const T*>(x->data), static_cast<const T*>(dy->data),
+                                  static_cast<T*>(dw->data), params_, workspace_,
+                                  cuda_device_api->GetStream());
+    });
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.conv2d_dw"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new DepthwiseConv2dDwImpl(cv);
+  }
+
+ private:
+  DepthwiseConvParams params_;
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, conv2d_dw, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.conv2d_dw", DepthwiseConv2dDwImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,204 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/dropout.cc
+ * \brief Philox dropout cuda backend
+ */
+#include <random>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "../../ty/utils.h"
+#include "../../../common/shape_utils.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+using common::shape_utils::BytesCompactTensor;
+using common::shape_utils::GetNumel;
+
+/*! \brief Returns an error message if the dropout cannot be computed by the CUDA kernels. */
+std::string CheckDropoutDType(const DLTensor* x) {
+  if (x->dtype.code != kDLFloat || (x->dtype.bits != 16 && x->dtype.bits != 32 &&
+                                    x->dtype.bits != 64)) {
+    return "only float16, float32 and float64 are supported, but got " +
+           tvm::runtime::DLDataType2String(x->dtype);
+  }
+  return "";
+}
+
+template <typename T>
+void DropoutForward(const DLTensor* x, DLTensor* y, DLTensor* state, const DLTensor* in_state,
+                    int64_t n, float p, uint64_t seed, uint64_t offset) {
+  static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+  dropout_forward_cuda<T>(static_cast<const T*>(x->data), static_cast<T*>(y->data),
+                          static_cast<int64_t*>(state->data),
+                          in_state ? static_cast<const int64_t*>(in_state->data) : nullptr, n, p,
+                          seed, offset, cuda_device_api->GetStream());
+}
+
+template <typename T>
+void DropoutBackward(const DLTensor* dy, DLTensor* dx, const DLTensor* state, int64_t n,
+                     float p) {
+  static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+  dropout_backward_cuda<T>(static_cast<const T*>(dy->data), static_cast<T*>(dx->data),
+                           static_cast<const int64_t*>(state->data), n, p,
+                           cuda_device_api->GetStream());
+}
+
+class DropoutImpl : public raf::op::OpEnv {
+ public:
+  explicit DropoutImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op._contrib_dropout");
+    auto args = cv->args.as<op::schema::DropoutArgs>();
+    const DLTensor* x = args->x;
+    std::string msg = CheckDropoutDType(x);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] _contrib_dropout: " + msg);
+      return;
+    }
+    // The given state replays an earlier dropout, e.g., when the dropout is rematerialized.
+    // Other states, such as the cuDNN dropout states, are left to other dialects.
+    has_in_state_ = args->in_states.defined();
+    if (has_in_state_) {
+      const DLTensor* in_state = args->in_states.value();
+      if (BytesCompactTensor(*in_state) != kDropoutPhiloxStateBytes) {
+        error_msgs.push_back("[CUDA] _contrib_dropout: in_states is not a Philox state");
+        return;
+      }
+    }
+    this->arg_indices = {fschema_index[op]("x")};
+    if (has_in_state_) {
+      this->arg_indices.push_back(fschema_index[op]("in_states"));
+    }
+    p_ = args->p;
+    n_ = GetNumel(*x);
+    seed_ = std::random_device()();
+    offset_ = 0;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::DropoutArgs>();
+    std::vector<Value> inputs{args->x};
+    if (has_in_state_) {
+      inputs.push_back(args->in_states.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = Downcast<TensorValue>(inputs[0]);
+    DLTensor* in_state =
+        has_in_state_ ? static_cast<DLTensor*>(Downcast<TensorValue>(inputs[1])) : nullptr;
+    TupleValue out_tuple = Downcast<TupleValue>(output);
+    DLTensor* y = Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* state = Downcast<TensorValue>(out_tuple->fields[2]);
+    CHECK_GE(BytesCompactTensor(*state), kDropoutPhiloxStateBytes);
+    // Each execution draws a new mask with the next Philox offset.
+    uint64_t offset = offset_++;
+    switch (x->dtype.bits) {
+      case 16:
+        DropoutForward<__half>(x, y, state, in_state, n_, p_, seed_, offset);
+        return;
+      case 32:
+        DropoutForward<float>(x, y, state, in_state, n_, p_, seed_, offset);
+        return;
+      case 64:
+        DropoutForward<double>(x, y, state, in_state, n_, p_, seed_, offset);
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda._contrib_dropout"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new DropoutImpl(cv);
+  }
+
+ private:
+  bool has_in_state_;
+  int64_t n_;
+  float p_;
+  uint64_t seed_;
+  uint64_t offset_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, _contrib_dropout, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda._contrib_dropout", DropoutImpl::make);
+
+class DropoutDxImpl : public raf::op::OpEnv {
+ public:
+  explicit DropoutDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op._contrib_dropout_dx");
+    auto args = cv->args.as<op::schema::DropoutDxArgs>();
+    const DLTensor* dy = args->dy;
+    std::string msg = CheckDropoutDType(dy);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] _contrib_dropout_dx: " + msg);
+      return;
+    }
+    const DLTensor* reserve_space = args->reserve_space;
+    if (BytesCompactTensor(*reserve_space) < kDropoutPhiloxStateBytes) {
+      error_msgs.push_back("[CUDA] _contrib_dropout_dx: reserve_space is not a Philox state");
+      return;
+    }
+    this->arg_indices = {fschema_index[op]("dy"), fschema_index[op]("reserve_space")};
+    p_ = args->p;
+    n_ = GetNumel(*dy);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::DropoutDxArgs>();
+    Execute(std::vector<Value>{args->dy, args->reserve_space}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* dy = Downcast<TensorValue>(inputs[0]);
+    DLTensor* state = Downcast<TensorValue>(inputs[1]);
+    DLTensor* dx = Downcast<TensorValue>(output);
+    switch (dy->dtype.bits) {
+      case 16:
+        DropoutBackward<__half>(dy, dx, state, n_, p_);
+        return;
+      case 32:
+        DropoutBackward<float>(dy, dx, state, n_, p_);
+        return;
+      case 64:
+        DropoutBackward<double>(dy, dx, state, n_, p_);
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda._contrib_dropout_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new DropoutDxImpl(cv);
+  }
+
+ private:
+  int64_t n_;
+  float p_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, _contrib_dropout_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda._contrib_dropout_dx", DropoutDxImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -5,8 +5,9 @@
 
 /*!
  * \file src/op/dialect/cuda/embedding.cc
- * \brief embedding_dx cuda backend
+ * \brief embedding cuda backend
  */
+#include <limits>
 #include "raf/op.h"
 #include "raf/op_utils.h"
 #include "raf/device_api.h"
@@ -20,6 +21,32 @@ namespace cuda {
 using namespace raf::value;
 using device_api::DeviceAPI;
 
+/*! \brief Returns an error message if the embedding cannot be computed by the CUDA kernels. */
+std::string CheckEmbeddingDTypes(const DLTensor* data, const DLTensor* indices) {
+  if (data->dtype.code != kDLFloat || (data->dtype.bits != 32 && data->dtype.bits != 16)) {
+    return "only float32 and float16 are supported, but got " +
+           tvm::runtime::DLDataType2String(data->dtype);
+  }
+  if (indices->dtype.code != kDLInt || indices->dtype.bits != 64) {
+    return "only int64 indices are supported, but got " +
+           tvm::runtime::DLDataType2String(indices->dtype);
+  }
+  return "";
+}
+
+/*! \brief The number of indices and the size of each embedding row. */
+void GetEmbeddingShape(const DLTensor* indices, const std::vector<int64_t>& num_weight, int* num,
+                       int* stride) {
+  *num = 1;
+  for (int i = 0; i < indices->ndim; ++i) {
+    *num *= indices->shape[i];
+  }
+  *stride = 1;
+  for (int i = 1; i < num_weight.size(); ++i) {
+    *stride *= num_weight[i];
+  }
+}
+
 class EmbeddingDxImpl : public raf::op::OpEnv {
  public:
   explicit EmbeddingDxImpl(const CallValues& cv) {
@@ -27,15 +54,19 @@ class EmbeddingDxImpl : public raf::op::OpEnv {
         ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
     static auto op = ir::Op::Get("raf.op.embedding_dx");
     auto args = cv->args.as<op::schema::EmbeddingDxArgs>();
-    n_out_elements_ = 1;
-    std::vector<int64_t> num_weight = GetShapeVecFromValue(args->num_weight);
-    for (int i = 0; i < num_weight.size(); ++i) {
-      n_out_elements_ *= num_weight[i];
+    std::string msg = CheckEmbeddingDTypes(args->dy, args->indices);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] embedding_dx: " + msg);
+      return;
     }
+    std::vector<int64_t> num_weight = GetShapeVecFromValue(args->num_weight);
+    GetEmbeddingShape(args->indices, num_weight, &num_, &stride_);
+    range_ = num_weight[0];
     this->arg_indices = {
         fschema_index[op]("dy"),
         fschema_index[op]("indices"),
     };
+    RequestWorkspace(&workspace_, cv->device, embedding_backward_workspace(num_, range_, stride_));
   }
 
   void Execute(const CallValues& cv) override {
@@ -48,27 +79,18 @@ class EmbeddingDxImpl : public raf::op::OpEnv {
     DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
     DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
     DLTensor* out = ir::Downcast<TensorValue>(output);
-    int stride = dy->shape[dy->ndim - 1];
-    int index_range = out->shape[0];
-    int n_indices = 1;
-    for (int i = 0; i < indices->ndim; ++i) {
-      n_indices *= indices->shape[i];
-    }
-
-    CHECK(out->dtype.code == kDLFloat);
-    CHECK((out->dtype.bits == 32) || (out->dtype.bits == 16));
+    const int64_t* indices_data = static_cast<const int64_t*>(indices->data);
+    void* stream = cuda_device_api->GetStream();
     switch (out->dtype.bits) {
       case 32:
-        embedding_dense_backward_cuda<float, float>(
-            static_cast<const float*>(dy->data), static_cast<float*>(out->data),
-            static_cast<const int64_t*>(indices->data), n_indices, index_range, stride,
-            cuda_device_api->GetStream(), n_out_elements_);
+        embedding_dense_backward_cuda<float>(static_cast<const float*>(dy->data),
+                                             static_cast<float*>(out->data), indices_data, num_,
+                                             range_, stride_, workspace_, stream);
         return;
       case 16:
-        embedding_dense_backward_cuda<__half, __half>(
-            static_cast<const __half*>(dy->data), static_cast<__half*>(out->data),
-            static_cast<const int64_t*>(indices->data), n_indices, index_range, stride,
-            cuda_device_api->GetStream(), n_out_elements_);
+        embedding_dense_backward_cuda<__half>(static_cast<const __half*>(dy->data),
+                                              static_cast<__half*>(out->data), indices_data, num_,
+                                              range_, stride_, workspace_, stream);
         return;
     }
   }
@@ -82,12 +104,321 @@ class EmbeddingDxImpl : public raf::op::OpEnv {
   }
 
  private:
-  int64_t n_out_elements_;
+  int num_, range_, stride_;
+  void* workspace_ = nullptr;
 };
 
 RAF_REGISTER_DIALECT_OP(cuda, embedding_dx, 20);
 RAF_OP_ENV_MAKER("raf.op.cuda.embedding_dx", EmbeddingDxImpl::make);
 
+class EmbeddingDxSparseImpl : public raf::op::OpEnv {
+ public:
+  explicit EmbeddingDxSparseImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.embedding_dx_sparse");
+    auto args = cv->args.as<op::schema::EmbeddingDxArgs>();
+    std::string msg = CheckEmbeddingDTypes(args->dy, args->indices);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] embedding_dx_sparse: " + msg);
+      return;
+    }
+    std::vector<int64_t> num_weight = GetShapeVecFromValue(args->num_weight);
+    GetEmbeddingShape(args->indices, num_weight, &num_, &stride_);
+    range_ = num_weight[0];
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("indices"),
+    };
+    RequestWorkspace(&workspace_, cv->device, embedding_backward_workspace(num_, range_, stride_));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::EmbeddingDxArgs>();
+    Execute(std::vector<value::Value>{args->dy, args->indices}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* rows = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* values = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    const int64_t* indices_data = static_cast<const int64_t*>(indices->data);
+    int64_t* rows_data = static_cast<int64_t*>(rows->data);
+    void* stream = cuda_device_api->GetStream();
+    switch (values->dtype.bits) {
+      case 32:
+        embedding_sparse_backward_cuda<float>(static_cast<const float*>(dy->data), rows_data,
+                                              static_cast<float*>(values->data), indices_data,
+                                              num_, range_, stride_, workspace_, stream);
+        return;
+      case 16:
+        embedding_sparse_backward_cuda<__half>(static_cast<const __half*>(dy->data), rows_data,
+                                               static_cast<__half*>(values->data), indices_data,
+                                               num_, range_, stride_, workspace_, stream);
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.embedding_dx_sparse"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new EmbeddingDxSparseImpl(cv);
+  }
+
+ private:
+  int num_, range_, stride_;
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, embedding_dx_sparse, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.embedding_dx_sparse", EmbeddingDxSparseImpl::make);
+
+class EmbeddingPositionImpl : public raf::op::OpEnv {
+ public:
+  explicit EmbeddingPositionImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.embedding_position");
+    auto args = cv->args.as<op::schema::EmbeddingPositionArgs>();
+    std::string msg = CheckEmbeddingDTypes(args->x, args->indices);
+    if (msg.empty()) {
+      msg = CheckEmbeddingDTypes(args->position, args->position_ids);
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] embedding_position: " + msg);
+      return;
+    }
+    const DLTensor* x = args->x;
+    const DLTensor* position = args->position;
+    GetEmbeddingShape(args->indices, std::vector<int64_t>(x->shape, x->shape + x->ndim), &num_,
+                      &stride_);
+    range_ = x->shape[0];
+    position_range_ = position->shape[0];
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("indices"),
+        fschema_index[op]("position"),
+        fschema_index[op]("position_ids"),
+    };
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::EmbeddingPositionArgs>();
+    Execute(std::vector<value::Value>{args->x, args->indices, args->position, args->position_ids},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* position = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* position_ids = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    const int64_t* indices_data = static_cast<const int64_t*>(indices->data);
+    const int64_t* position_ids_data = static_cast<const int64_t*>(position_ids->data);
+    void* stream = cuda_device_api->GetStream();
+    switch (out->dtype.bits) {
+      case 32:
+        embedding_position_cuda<float>(static_cast<const float*>(x->data), indices_data,
+                                       static_cast<const float*>(position->data),
+                                       position_ids_data, static_cast<float*>(out->data), num_,
+                                       range_, position_range_, stride_, stream);
+        return;
+      case 16:
+        embedding_position_cuda<__half>(static_cast<const __half*>(x->data), indices_data,
+                                        static_cast<const __half*>(position->data),
+                                        position_ids_data, static_cast<__half*>(out->data), num_,
+                                        range_, position_range_, stride_, stream);
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.embedding_position"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new EmbeddingPositionImpl(cv);
+  }
+
+ private:
+  int num_, range_, position_range_, stride_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, embedding_position, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.embedding_position", EmbeddingPositionImpl::make);
+
+/*! \brief The geometry of a row cache in shape [num_sets, 1 + num_ways, 3]. */
+void GetEmbeddingCacheShape(const DLTensor* tags, int* num_sets, int* num_ways) {
+  *num_sets = tags->shape[0];
+  *num_ways = tags->shape[1] - 1;
+}
+
+class EmbeddingCacheImpl : public raf::op::OpEnv {
+ public:
+  explicit EmbeddingCacheImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.embedding_cache");
+    auto args = cv->args.as<op::schema::EmbeddingCacheArgs>();
+    std::string msg = CheckEmbeddingDTypes(args->table, args->indices);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] embedding_cache: " + msg);
+      return;
+    }
+    const DLTensor* table = args->table;
+    GetEmbeddingShape(args->indices, std::vector<int64_t>(table->shape, table->shape + table->ndim),
+                      &num_, &stride_);
+    GetEmbeddingCacheShape(args->tags, &num_sets_, &num_ways_);
+    range_ = table->shape[0];
+    this->arg_indices = {
+        fschema_index[op]("table"),
+        fschema_index[op]("indices"),
+        fschema_index[op]("tags"),
+        fschema_index[op]("rows"),
+    };
+    RequestWorkspace(&workspace_, cv->device, embedding_cache_lookup_workspace(num_));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::EmbeddingCacheArgs>();
+    Execute(std::vector<value::Value>{args->table, args->indices, args->tags, args->rows},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* table = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* tags = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* rows = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    const int64_t* indices_data = static_cast<const int64_t*>(indices->data);
+    int64_t* tags_data = static_cast<int64_t*>(tags->data);
+    void* stream = cuda_device_api->GetStream();
+    switch (out->dtype.bits) {
+      case 32:
+        embedding_cache_lookup_cuda<float>(
+            static_cast<float*>(table->data), indices_data, tags_data,
+            static_cast<float*>(rows->data), static_cast<float*>(out->data), num_, range_,
+            num_sets_, num_ways_, stride_, workspace_, stream);
+        return;
+      case 16:
+        embedding_cache_lookup_cuda<__half>(
+            static_cast<__half*>(table->data), indices_data, tags_data,
+            static_cast<__half*>(rows->data), static_cast<__half*>(out->data), num_, range_,
+            num_sets_, num_ways_, stride_, workspace_, stream);
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.embedding_cache"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new EmbeddingCacheImpl(cv);
+  }
+
+ private:
+  int num_, stride_, num_sets_, num_ways_;
+  int64_t range_;
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, embedding_cache, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.embedding_cache", EmbeddingCacheImpl::make);
+
+class EmbeddingCacheSgdImpl : public raf::op::OpEnv {
+ public:
+  explicit EmbeddingCacheSgdImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.embedding_cache_sgd");
+    auto args = cv->args.as<op::schema::EmbeddingCacheSgdArgs>();
+    std::string msg = CheckEmbeddingDTypes(args->table, args->indices);
+    if (msg.empty() && args->table->shape[0] > std::numeric_limits<int>::max()) {
+      // The distinct rows are found by the int32 radix sort of the embedding backward.
+      msg = "the table has more than INT_MAX rows";
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] embedding_cache_sgd: " + msg);
+      return;
+    }
+    const DLTensor* table = args->table;
+    GetEmbeddingShape(args->indices, std::vector<int64_t>(table->shape, table->shape + table->ndim),
+                      &num_, &stride_);
+    GetEmbeddingCacheShape(args->tags, &num_sets_, &num_ways_);
+    range_ = table->shape[0];
+    learning_rate_ = args->learning_rate;
+    this->arg_indices = {
+        fschema_index[op]("table"),
+        fschema_index[op]("dy"),
+        fschema_index[op]("indices"),
+        fschema_index[op]("tags"),
+        fschema_index[op]("rows"),
+    };
+    RequestWorkspace(&workspace_, cv->device,
+                     embedding_cache_sgd_workspace(num_, range_, stride_, table->dtype.bits / 8));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::EmbeddingCacheSgdArgs>();
+    Execute(std::vector<value::Value>{args->table, args->dy, args->indices, args->tags, args->rows},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* table = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* tags = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* rows = ir::Downcast<TensorValue>(inputs[4]);
+    const int64_t* indices_data = static_cast<const int64_t*>(indices->data);
+    int64_t* tags_data = static_cast<int64_t*>(tags->data);
+    void* stream = cuda_device_api->GetStream();
+    switch (rows->dtype.bits) {
+      case 32:
+        embedding_cache_sgd_cuda<float>(static_cast<float*>(table->data),
+                                        static_cast<const float*>(dy->data), indices_data,
+                                        tags_data, static_cast<float*>(rows->data), learning_rate_,
+                                        num_, range_, num_sets_, num_ways_, stride_, workspace_,
+                                        stream);
+        return;
+      case 16:
+        embedding_cache_sgd_cuda<__half>(static_cast<__half*>(table->data),
+                                         static_cast<const __half*>(dy->data), indices_data,
+                                         tags_data, static_cast<__half*>(rows->data),
+                                         learning_rate_, num_, range_, num_sets_, num_ways_,
+                                         stride_, workspace_, stream);
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.embedding_cache_sgd"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new EmbeddingCacheSgdImpl(cv);
+  }
+
+ private:
+  int num_, range_, stride_, num_sets_, num_ways_;
+  float learning_rate_;
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, embedding_cache_sgd, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.embedding_cache_sgd", EmbeddingCacheSgdImpl::make);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
@@ -0,0 +1,117 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/group_cast.cc
+ * \brief Cast a group of tensors between float32 and float16 with the multi-tensor CUDA kernel.
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/transform.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using namespace raf::op::schema;
+using device_api::DeviceAPI;
+#define CHUNK_SIZE 65536
+
+class GroupCastImpl : public raf::op::OpEnv {
+ public:
+  explicit GroupCastImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto group_cast_op = ir::Op::Get("raf.op.group_cast");
+    auto args = cv->args.as<GroupCastArgs>();
+    this->arg_indices = {fschema_index[group_cast_op]("tensor_list")};
+
+    DLDataType out_dtype = ir::String2DLDataType(args->dtype);
+    CHECK(!args->tensor_list.empty());
+    DLTensor* t0 = args->tensor_list[0];
+    in_dtype_ = t0->dtype;
+    out_dtype_ = out_dtype;
+    if (!IsSupported(in_dtype_, out_dtype_)) {
+      std::stringstream ss;
+      ss << "[CUDA] group_cast only supports float32 <-> float16, but got "
+         << tvm::runtime::DLDataType2String(in_dtype_) << " -> " << args->dtype;
+      error_msgs.push_back(ss.str());
+      return;
+    }
+    for (const auto& tensor : args->tensor_list) {
+      DLTensor* t = tensor;
+      CHECK(t->dtype == in_dtype_) << "All tensors in group_cast should have the same dtype";
+      int numel = 1;
+      for (int j = 0; j < t->ndim; ++j) {
+        numel *= t->shape[j];
+      }
+      numels_.push_back(numel);
+    }
+
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<GroupCastArgs>();
+    Array<Value> tvalue = {args->tensor_list.begin(), args->tensor_list.end()};
+    Execute(std::vector<Value>{TupleValue::make(tvalue)}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    TupleValue in_tuple = ir::Downcast<TupleValue>(inputs[0]);
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    CHECK_EQ(in_tuple->fields.size(), numels_.size());
+    CHECK_EQ(out_tuple->fields.size(), numels_.size());
+
+    // The tensor lists are laid out as [inputs..., outputs...].
+    std::vector<void*> tlist;
+    for (const auto& field : in_tuple->fields) {
+      DLTensor* tensor = ir::Downcast<TensorValue>(field);
+      tlist.push_back(tensor->data);
+    }
+    for (const auto& field : out_tuple->fields) {
+      DLTensor* tensor = ir::Downcast<TensorValue>(field);
+      tlist.push_back(tensor->data);
+    }
+    if (in_dtype_.bits == 32) {
+      multi_tensor_cast_cuda<float, __half>(CHUNK_SIZE, tlist, numels_, compute_stream_);
+    } else {
+      multi_tensor_cast_cuda<__half, float>(CHUNK_SIZE, tlist, numels_, compute_stream_);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.group_cast"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new GroupCastImpl(cv);
+  }
+
+ private:
+  /*! \brief Whether the cast from the input dtype to the output dtype is supported. */
+  static bool IsSupported(DLDataType in_dtype, DLDataType out_dtype) {
+    auto is_float = [](DLDataType dtype, int bits) {
+      return dtype.code == kDLFloat && dtype.bits == bits && dtype.lanes == 1;
+    };
+    return (is_float(in_dtype, 32) && is_float(out_dtype, 16)) ||
+           (is_float(in_dtype, 16) && is_float(out_dtype, 32));
+  }
+
+  DLDataType in_dtype_;
+  DLDataType out_dtype_;
+  std::vector<int> numels_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, group_cast, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.group_cast", GroupCastImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
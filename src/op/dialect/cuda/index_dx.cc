@@ -0,0 +1,404 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/index_dx.cc
+ * \brief The deterministic cuda backward of take, gather, adv_index and scatter
+ */
+#include <climits>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "../../schema/transform.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*! \brief Returns an error message if the gradient cannot be computed by the CUDA kernels. */
+std::string CheckIndexDxDTypes(const DLTensor* data, const DLTensor* indices) {
+  if (data->dtype.code != kDLFloat || (data->dtype.bits != 32 && data->dtype.bits != 16)) {
+    return "only float32 and float16 are supported, but got " +
+           tvm::runtime::DLDataType2String(data->dtype);
+  }
+  if (indices->dtype.code != kDLInt || (indices->dtype.bits != 32 && indices->dtype.bits != 64)) {
+    return "only int32 and int64 indices are supported, but got " +
+           tvm::runtime::DLDataType2String(indices->dtype);
+  }
+  return "";
+}
+
+/*! \brief Returns an error message if the tensor is too large or of too high rank. */
+std::string CheckIndexDxShape(const DLTensor* tensor) {
+  if (tensor->ndim > kIndexMaxDims) {
+    return "only tensors of rank up to " + std::to_string(kIndexMaxDims) + " are supported";
+  }
+  int64_t numel = 1;
+  for (int i = 0; i < tensor->ndim; ++i) {
+    numel *= tensor->shape[i];
+  }
+  if (numel >= INT_MAX) {
+    return "only tensors of less than INT_MAX elements are supported";
+  }
+  return "";
+}
+
+IndexShape MakeIndexShape(const DLTensor* tensor) {
+  IndexShape shape;
+  shape.ndim = tensor->ndim;
+  std::copy(tensor->shape, tensor->shape + tensor->ndim, shape.dims);
+  return shape;
+}
+
+int64_t IndexShapeNumel(const IndexShape& shape) {
+  int64_t numel = 1;
+  for (int i = 0; i < shape.ndim; ++i) {
+    numel *= shape.dims[i];
+  }
+  return numel;
+}
+
+/*!
+ * \brief Launch the kernel of the dtype of the data and the indices. The launch is called with a
+ * value of the element type and a value of the index type.
+ */
+template <typename F>
+void DispatchIndexDx(const DLTensor* data, const DLTensor* indices, F launch) {
+  if (data->dtype.bits == 32) {
+    indices->dtype.bits == 64 ? launch(float(), int64_t()) : launch(float(), int32_t());
+  } else {
+    indices->dtype.bits == 64 ? launch(__half(), int64_t()) : launch(__half(), int32_t());
+  }
+}
+
+class TakeDxImpl : public raf::op::OpEnv {
+ public:
+  explicit TakeDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.take_dx");
+    auto args = cv->args.as<op::schema::TakeDxArgs>();
+    const DLTensor* x = args->x;
+    const DLTensor* indices = args->indices;
+    std::string msg = CheckIndexDxDTypes(x, indices);
+    if (msg.empty()) {
+      msg = CheckIndexDxShape(x);
+    }
+    if (msg.empty() && args->mode != "clip" && args->mode != "wrap" && args->mode != "fast") {
+      msg = "unsupported mode " + args->mode;
+    }
+    int64_t outer = 1, range = 1, inner = 1, num_indices = 1;
+    for (int i = 0; i < indices->ndim; ++i) {
+      num_indices *= indices->shape[i];
+    }
+    if (args->axis.defined()) {
+      int axis = GetScalarValueData<int64_t>(args->axis);
+      axis = axis < 0 ? axis + x->ndim : axis;
+      for (int i = 0; i < x->ndim; ++i) {
+        int64_t& dim = i < axis ? outer : (i == axis ? range : inner);
+        dim *= x->shape[i];
+      }
+    } else {
+      for (int i = 0; i < x->ndim; ++i) {
+        range *= x->shape[i];
+      }
+    }
+    if (msg.empty() && outer * num_indices * inner >= INT_MAX) {
+      msg = "only gradients of less than INT_MAX elements are supported";
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] take_dx: " + msg);
+      return;
+    }
+    num_indices_ = num_indices;
+    outer_ = outer;
+    range_ = range;
+    inner_ = inner;
+    wrap_ = args->mode == "wrap";
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("indices"),
+    };
+    RequestWorkspace(&workspace_, cv->device,
+                     index_backward_workspace(outer_ * num_indices_, outer_ * range_, inner_));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::TakeDxArgs>();
+    Execute(std::vector<value::Value>{args->dy, args->indices}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    DispatchIndexDx(out, indices, [&](auto t, auto i) {
+      using T = decltype(t);
+      using I = decltype(i);
+      take_backward_cuda<T, I>(static_cast<const T*>(dy->data), static_cast<T*>(out->data),
+                               static_cast<const I*>(indices->data), num_indices_, outer_, range_,
+                               inner_, wrap_, workspace_, stream);
+    });
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.take_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new TakeDxImpl(cv);
+  }
+
+ private:
+  int num_indices_, outer_, range_, inner_;
+  bool wrap_;
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, take_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.take_dx", TakeDxImpl::make);
+
+class GatherDxImpl : public raf::op::OpEnv {
+ public:
+  explicit GatherDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.gather_dx");
+    auto args = cv->args.as<op::schema::GatherDxArgs>();
+    const DLTensor* data = args->data;
+    const DLTensor* indices = args->indices;
+    std::string msg = CheckIndexDxDTypes(data, indices);
+    if (msg.empty()) {
+      msg = CheckIndexDxShape(data);
+    }
+    if (msg.empty()) {
+      msg = CheckIndexDxShape(indices);
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] gather_dx: " + msg);
+      return;
+    }
+    data_shape_ = MakeIndexShape(data);
+    index_shape_ = MakeIndexShape(indices);
+    axis_ = args->axis < 0 ? args->axis + data->ndim : args->axis;
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("indices"),
+    };
+    int64_t num = IndexShapeNumel(index_shape_), range = IndexShapeNumel(data_shape_);
+    RequestWorkspace(&workspace_, cv->device, index_backward_workspace(num, range, 1));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::GatherDxArgs>();
+    Execute(std::vector<value::Value>{args->dy, args->indices}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    DispatchIndexDx(out, indices, [&](auto t, auto i) {
+      using T = decltype(t);
+      using I = decltype(i);
+      gather_backward_cuda<T, I>(static_cast<const T*>(dy->data), static_cast<T*>(out->data),
+                                 static_cast<const I*>(indices->data), index_shape_, data_shape_,
+                                 axis_, workspace_, stream);
+    });
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.gather_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new GatherDxImpl(cv);
+  }
+
+ private:
+  IndexShape data_shape_, index_shape_;
+  int axis_;
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, gather_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.gather_dx", GatherDxImpl::make);
+
+class AdvIndexDxImpl : public raf::op::OpEnv {
+ public:
+  explicit AdvIndexDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.adv_index_dx");
+    auto args = cv->args.as<op::schema::AdvIndexDxArgs>();
+    const DLTensor* data = args->inputs[0];
+    std::string msg = CheckIndexDxShape(data);
+    std::vector<int64_t> broadcast_shape;
+    indices_.num = args->inputs.size() - 1;
+    for (int k = 0; msg.empty() && k < indices_.num; ++k) {
+      const DLTensor* index = args->inputs[k + 1];
+      msg = CheckIndexDxDTypes(data, index);
+      if (msg.empty()) {
+        msg = CheckIndexDxShape(index);
+      }
+      if (msg.empty()) {
+        std::vector<int64_t> shape(index->shape, index->shape + index->ndim);
+        broadcast_shape = k == 0 ? shape : BroadcastShapeVec(broadcast_shape, shape);
+        indices_.is_int64[k] = index->dtype.bits == 64;
+        indices_.shapes[k] = MakeIndexShape(index);
+        indices_.ranges[k] = data->shape[k];
+      }
+    }
+    int64_t num = 1, range = 1, inner = 1;
+    if (msg.empty()) {
+      for (int64_t dim : broadcast_shape) {
+        num *= dim;
+      }
+      for (int i = 0; i < data->ndim; ++i) {
+        int64_t& dim = i < indices_.num ? range : inner;
+        dim *= data->shape[i];
+      }
+      if (broadcast_shape.size() > kIndexMaxDims || num * inner >= INT_MAX) {
+        msg = "the broadcast indices are too large";
+      }
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] adv_index_dx: " + msg);
+      return;
+    }
+    indices_.broadcast_shape.ndim = broadcast_shape.size();
+    std::copy(broadcast_shape.begin(), broadcast_shape.end(), indices_.broadcast_shape.dims);
+    inner_ = inner;
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("inputs"),
+    };
+    RequestWorkspace(&workspace_, cv->device, index_backward_workspace(num, range, inner));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AdvIndexDxArgs>();
+    Array<Value> inputs = {args->inputs.begin(), args->inputs.end()};
+    Execute(std::vector<Value>{args->dy, TupleValue::make(inputs)}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    TupleValue tuple = ir::Downcast<TupleValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(ir::Downcast<TupleValue>(output)->fields[0]);
+    AdvIndices indices = indices_;
+    for (int k = 0; k < indices.num; ++k) {
+      DLTensor* index = ir::Downcast<TensorValue>(tuple->fields[k + 1]);
+      indices.data[k] = index->data;
+    }
+    void* stream = cuda_device_api->GetStream();
+    if (out->dtype.bits == 32) {
+      adv_index_backward_cuda<float>(static_cast<const float*>(dy->data),
+                                     static_cast<float*>(out->data), indices, inner_, workspace_,
+                                     stream);
+    } else {
+      adv_index_backward_cuda<__half>(static_cast<const __half*>(dy->data),
+                                      static_cast<__half*>(out->data), indices, inner_,
+                                      workspace_, stream);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.adv_index_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AdvIndexDxImpl(cv);
+  }
+
+ private:
+  /*! \brief The indices without their data, which is filled at execution. */
+  AdvIndices indices_;
+  int inner_;
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, adv_index_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.adv_index_dx", AdvIndexDxImpl::make);
+
+class ScatterDxImpl : public raf::op::OpEnv {
+ public:
+  explicit ScatterDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.scatter_dx");
+    auto args = cv->args.as<op::schema::ScatterDxArgs>();
+    const DLTensor* x = args->x;
+    const DLTensor* index = args->index;
+    std::string msg = CheckIndexDxDTypes(x, index);
+    if (msg.empty()) {
+      msg = CheckIndexDxShape(x);
+    }
+    if (msg.empty()) {
+      msg = CheckIndexDxShape(index);
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] scatter_dx: " + msg);
+      return;
+    }
+    x_shape_ = MakeIndexShape(x);
+    index_shape_ = MakeIndexShape(index);
+    int axis = GetScalarValueData<int64_t>(args->axis);
+    axis_ = axis < 0 ? axis + x->ndim : axis;
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("index"),
+    };
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::ScatterDxArgs>();
+    Execute(std::vector<value::Value>{args->dy, args->index}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* index = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    DispatchIndexDx(out, index, [&](auto t, auto i) {
+      using T = decltype(t);
+      using I = decltype(i);
+      scatter_backward_cuda<T, I>(static_cast<const T*>(dy->data), static_cast<T*>(out->data),
+                                  static_cast<const I*>(index->data), index_shape_, x_shape_,
+                                  axis_, stream);
+    });
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.scatter_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new ScatterDxImpl(cv);
+  }
+
+ private:
+  IndexShape x_shape_, index_shape_;
+  int axis_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, scatter_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.scatter_dx", ScatterDxImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
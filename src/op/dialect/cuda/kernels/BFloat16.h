@@ -0,0 +1,87 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Modifications Copyright (c) Facebook, Inc.
+ * See: https://github.com/pytorch/pytorch/blob/master/c10/util/BFloat16.h
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/BFloat16.h
+ * \brief Defines the BFloat16 type (brain floating-point), which is the upper half of float32.
+ * Like Half, the arithmetic operations are performed in float32.
+ */
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "Macros.h"
+
+#if defined(__CUDACC__) && CUDA_VERSION >= 11000
+#include <cuda_bf16.h>
+#endif
+
+namespace c10 {
+
+namespace detail {
+
+inline C10_HOST_DEVICE float f32_from_bits(uint16_t src) {
+  uint32_t tmp = src;
+  tmp <<= 16;
+  float res;
+#if defined(__CUDA_ARCH__)
+  res = __uint_as_float(tmp);
+#else
+  std::memcpy(&res, &tmp, sizeof(tmp));
+#endif
+  return res;
+}
+
+inline C10_HOST_DEVICE uint16_t round_to_nearest_even(float src) {
+#if defined(__CUDA_ARCH__)
+  if (isnan(src)) {
+#else
+  if (std::isnan(src)) {
+#endif
+    return UINT16_C(0x7FC0);
+  }
+  uint32_t bits;
+#if defined(__CUDA_ARCH__)
+  bits = __float_as_uint(src);
+#else
+  std::memcpy(&bits, &src, sizeof(bits));
+#endif
+  uint32_t rounding_bias = ((bits >> 16) & 1) + UINT32_C(0x7FFF);
+  return static_cast<uint16_t>((bits + rounding_bias) >> 16);
+}
+
+}  // namespace detail
+
+struct alignas(2) BFloat16 {
+  uint16_t x;
+
+  struct from_bits_t {};
+  static constexpr from_bits_t from_bits() {
+    return from_bits_t();
+  }
+
+  BFloat16() = default;
+
+  constexpr C10_HOST_DEVICE BFloat16(unsigned short bits, from_bits_t) : x(bits){};
+  inline C10_HOST_DEVICE BFloat16(float value) : x(detail::round_to_nearest_even(value)) {
+  }
+  inline C10_HOST_DEVICE operator float() const {
+    return detail::f32_from_bits(x);
+  }
+
+#if defined(__CUDACC__) && CUDA_VERSION >= 11000
+  inline C10_HOST_DEVICE BFloat16(const __nv_bfloat16& value) {
+    x = *reinterpret_cast<const unsigned short*>(&value);
+  }
+  inline C10_HOST_DEVICE operator __nv_bfloat16() const {
+    return *reinterpret_cast<const __nv_bfloat16*>(&x);
+  }
+#endif
+};
+
+}  // namespace c10
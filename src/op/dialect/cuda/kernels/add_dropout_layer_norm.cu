@@ -0,0 +1,395 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/add_dropout_layer_norm.cu
+ * \brief Fused residual add, dropout and layer norm cuda kernels.
+ *
+ * Each row is processed by one thread block with 128-bit vectorized loads and stores. The forward
+ * computes z = residual + dropout(x) and normalizes z in the same kernel, so x and the residual
+ * are read only once. The dropout mask is regenerated from a counter-based hash of the seed and
+ * the element index instead of being stored.
+ */
+#include <algorithm>
+#include <initializer_list>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kMaxThreads = 256;
+constexpr unsigned kFullMask = 0xffffffff;
+/*! \brief The number of row parts that the partial gradients of gamma and beta are reduced in. */
+constexpr int kGammaBetaParts = 16;
+/*! \brief The block shape of the partial gradient kernel. */
+constexpr int kGammaBetaCols = 32;
+constexpr int kGammaBetaRows = 8;
+
+__device__ __forceinline__ float WarpSum(float x) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    x += __shfl_xor_sync(kFullMask, x, offset);
+  }
+  return x;
+}
+
+/*! \brief Sum x over the thread block. All threads get the result. */
+__device__ __forceinline__ float BlockSum(float x) {
+  __shared__ float warp_sums[kWarpSize];
+  const int warp = threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  x = WarpSum(x);
+  if (lane == 0) {
+    warp_sums[warp] = x;
+  }
+  __syncthreads();
+  x = lane < blockDim.x / kWarpSize ? warp_sums[lane] : 0.0f;
+  x = WarpSum(x);
+  // Make sure all threads have read the partial sums before the buffer is reused.
+  __syncthreads();
+  return x;
+}
+
+/*!
+ * \brief The forward of one row. When cached is true, z of the row is cached in the dynamic
+ * shared memory in float32, otherwise it is read back from the global memory; both hold the
+ * values rounded to T, so the results are the same.
+ */
+template <typename T, int kVec>
+__global__ void AddDropoutLayerNormForwardKernel(
+    const T* __restrict__ x, const T* __restrict__ residual, const T* __restrict__ gamma,
+    const T* __restrict__ beta, T* __restrict__ y, T* __restrict__ z, float* __restrict__ mean,
+    float* __restrict__ invvar, int64_t* __restrict__ rng_state, int n2, float p, float eps,
+    uint64_t seed, bool cached) {
+  using Vec = AlignedVector<T, kVec>;
+  extern __shared__ float z_cache[];
+  const int64_t offset = static_cast<int64_t>(blockIdx.x) * n2;
+  const int n_vecs = n2 / kVec;
+  const float keep_scale = 1.0f / (1.0f - p);
+  if (rng_state != nullptr && blockIdx.x == 0 && threadIdx.x == 0) {
+    rng_state[0] = static_cast<int64_t>(seed);
+  }
+
+  float sum = 0.0f;
+  for (int i = threadIdx.x; i < n_vecs; i += blockDim.x) {
+    const int col = i * kVec;
+    Vec x_vec = LoadVector<T, kVec>(x, offset + col);
+    Vec r_vec = LoadVector<T, kVec>(residual, offset + col);
+    Vec z_vec;
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      float xf = ToFloat(x_vec.val[k]);
+      if (p > 0) {
+        xf = DropoutKeep(seed, offset + col + k, p) ? xf * keep_scale : 0.0f;
+      }
+      z_vec.val[k] = FromFloat<T>(ToFloat(r_vec.val[k]) + xf);
+      float zf = ToFloat(z_vec.val[k]);
+      if (cached) {
+        z_cache[col + k] = zf;
+      }
+      sum += zf;
+    }
+    if (z != nullptr) {
+      StoreVector<T, kVec>(z, offset + col, z_vec);
+    }
+  }
+  // Each thread only reads back the elements written by itself, so no barrier is needed.
+  auto load_z = [&](int col, float* zf) {
+    if (cached) {
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        zf[k] = z_cache[col + k];
+      }
+    } else {
+      Vec z_vec = LoadVector<T, kVec>(z, offset + col);
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        zf[k] = ToFloat(z_vec.val[k]);
+      }
+    }
+  };
+  const float row_mean = BlockSum(sum) / n2;
+
+  // The variance is computed from the deviations in a second pass, which is numerically more
+  // stable than E[z^2] - E[z]^2.
+  float sq_sum = 0.0f;
+  for (int i = threadIdx.x; i < n_vecs; i += blockDim.x) {
+    float zf[kVec];
+    load_z(i * kVec, zf);
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      float diff = zf[k] - row_mean;
+      sq_sum += diff * diff;
+    }
+  }
+  const float row_invvar = rsqrtf(BlockSum(sq_sum) / n2 + eps);
+
+  for (int i = threadIdx.x; i < n_vecs; i += blockDim.x) {
+    const int col = i * kVec;
+    float zf[kVec];
+    load_z(col, zf);
+    float yf[kVec];
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      yf[k] = (zf[k] - row_mean) * row_invvar;
+    }
+    if (gamma != nullptr) {
+      Vec g_vec = LoadVector<T, kVec>(gamma, col);
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        yf[k] *= ToFloat(g_vec.val[k]);
+      }
+    }
+    if (beta != nullptr) {
+      Vec b_vec = LoadVector<T, kVec>(beta, col);
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        yf[k] += ToFloat(b_vec.val[k]);
+      }
+    }
+    Vec y_vec;
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      y_vec.val[k] = FromFloat<T>(yf[k]);
+    }
+    StoreVector<T, kVec>(y, offset + col, y_vec);
+  }
+  if (threadIdx.x == 0) {
+    if (mean != nullptr) {
+      mean[blockIdx.x] = row_mean;
+    }
+    if (invvar != nullptr) {
+      invvar[blockIdx.x] = row_invvar;
+    }
+  }
+}
+
+/*!
+ * \brief The backward of one row to dresidual = dln + dz and dx = dropout_grad(dresidual), where
+ * dln = invvar * (g - mean(g) - xhat * mean(g * xhat)) and g = dy * gamma.
+ */
+template <typename T, int kVec>
+__global__ void AddDropoutLayerNormBackwardKernel(
+    const T* __restrict__ dy, const T* __restrict__ dz, const T* __restrict__ z,
+    const T* __restrict__ gamma, const float* __restrict__ mean, const float* __restrict__ invvar,
+    const int64_t* __restrict__ rng_state, T* __restrict__ dx, T* __restrict__ dresidual, int n2,
+    float p) {
+  using Vec = AlignedVector<T, kVec>;
+  const int64_t offset = static_cast<int64_t>(blockIdx.x) * n2;
+  const int n_vecs = n2 / kVec;
+  const float row_mean = mean[blockIdx.x];
+  const float row_invvar = invvar[blockIdx.x];
+  const uint64_t seed = static_cast<uint64_t>(rng_state[0]);
+  const float keep_scale = 1.0f / (1.0f - p);
+
+  // Load the row gradients g = dy * gamma and the normalized inputs xhat of a vector.
+  auto load = [&](int col, float* g, float* xhat) {
+    Vec dy_vec = LoadVector<T, kVec>(dy, offset + col);
+    Vec z_vec = LoadVector<T, kVec>(z, offset + col);
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      g[k] = ToFloat(dy_vec.val[k]);
+      xhat[k] = (ToFloat(z_vec.val[k]) - row_mean) * row_invvar;
+    }
+    if (gamma != nullptr) {
+      Vec g_vec = LoadVector<T, kVec>(gamma, col);
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        g[k] *= ToFloat(g_vec.val[k]);
+      }
+    }
+  };
+
+  float sum_g = 0.0f, sum_g_xhat = 0.0f;
+  for (int i = threadIdx.x; i < n_vecs; i += blockDim.x) {
+    float g[kVec], xhat[kVec];
+    load(i * kVec, g, xhat);
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      sum_g += g[k];
+      sum_g_xhat += g[k] * xhat[k];
+    }
+  }
+  const float mean_g = BlockSum(sum_g) / n2;
+  const float mean_g_xhat = BlockSum(sum_g_xhat) / n2;
+
+  for (int i = threadIdx.x; i < n_vecs; i += blockDim.x) {
+    const int col = i * kVec;
+    float g[kVec], xhat[kVec];
+    load(col, g, xhat);
+    float dres[kVec];
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      dres[k] = row_invvar * (g[k] - mean_g - xhat[k] * mean_g_xhat);
+    }
+    if (dz != nullptr) {
+      Vec dz_vec = LoadVector<T, kVec>(dz, offset + col);
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        dres[k] += ToFloat(dz_vec.val[k]);
+      }
+    }
+    Vec dres_vec, dx_vec;
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      dres_vec.val[k] = FromFloat<T>(dres[k]);
+      float dxf = dres[k];
+      if (p > 0) {
+        dxf = DropoutKeep(seed, offset + col + k, p) ? dxf * keep_scale : 0.0f;
+      }
+      dx_vec.val[k] = FromFloat<T>(dxf);
+    }
+    StoreVector<T, kVec>(dresidual, offset + col, dres_vec);
+    StoreVector<T, kVec>(dx, offset + col, dx_vec);
+  }
+}
+
+/*! \brief The partial sums of dgamma = sum(dy * xhat) and dbeta = sum(dy) over a part of rows. */
+template <typename T>
+__global__ void AddDropoutLayerNormGammaBetaPartKernel(
+    const T* __restrict__ dy, const T* __restrict__ z, const float* __restrict__ mean,
+    const float* __restrict__ invvar, int n1, int n2, int rows_per_part,
+    float* __restrict__ part_gamma, float* __restrict__ part_beta) {
+  __shared__ float gamma_s[kGammaBetaRows][kGammaBetaCols + 1];
+  __shared__ float beta_s[kGammaBetaRows][kGammaBetaCols + 1];
+  const int col = blockIdx.x * kGammaBetaCols + threadIdx.x;
+  const int row_begin = blockIdx.y * rows_per_part;
+  const int row_end = min(n1, row_begin + rows_per_part);
+  float sum_gamma = 0.0f, sum_beta = 0.0f;
+  if (col < n2) {
+    for (int row = row_begin + threadIdx.y; row < row_end; row += kGammaBetaRows) {
+      const int64_t i = static_cast<int64_t>(row) * n2 + col;
+      float d = ToFloat(dy[i]);
+      sum_gamma += d * (ToFloat(z[i]) - mean[row]) * invvar[row];
+      sum_beta += d;
+    }
+  }
+  gamma_s[threadIdx.y][threadIdx.x] = sum_gamma;
+  beta_s[threadIdx.y][threadIdx.x] = sum_beta;
+  __syncthreads();
+  if (threadIdx.y == 0 && col < n2) {
+    for (int r = 1; r < kGammaBetaRows; ++r) {
+      sum_gamma += gamma_s[r][threadIdx.x];
+      sum_beta += beta_s[r][threadIdx.x];
+    }
+    part_gamma[blockIdx.y * n2 + col] = sum_gamma;
+    part_beta[blockIdx.y * n2 + col] = sum_beta;
+  }
+}
+
+template <typename T>
+__global__ void AddDropoutLayerNormGammaBetaKernel(const float* __restrict__ part_gamma,
+                                                   const float* __restrict__ part_beta, int n2,
+                                                   T* __restrict__ dgamma, T* __restrict__ dbeta) {
+  const int col = blockIdx.x * blockDim.x + threadIdx.x;
+  if (col >= n2) {
+    return;
+  }
+  float sum_gamma = 0.0f, sum_beta = 0.0f;
+  for (int part = 0; part < kGammaBetaParts; ++part) {
+    sum_gamma += part_gamma[part * n2 + col];
+    sum_beta += part_beta[part * n2 + col];
+  }
+  dgamma[col] = FromFloat<T>(sum_gamma);
+  dbeta[col] = FromFloat<T>(sum_beta);
+}
+
+__host__ __forceinline__ int CeilDiv(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+/*! \brief Whether all the pointers can be accessed by vectors of n_bytes. */
+__host__ __forceinline__ bool IsAligned(std::initializer_list<const void*> ptrs, int n_bytes) {
+  for (const void* ptr : ptrs) {
+    if (reinterpret_cast<uintptr_t>(ptr) % n_bytes != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*! \brief The number of threads to process a row of n_vecs vectors. */
+__host__ __forceinline__ int RowThreads(int n_vecs) {
+  return std::min(kMaxThreads, std::max(1, CeilDiv(n_vecs, kWarpSize)) * kWarpSize);
+}
+
+}  // namespace
+
+int64_t add_dropout_layer_norm_gamma_beta_workspace(int n2) {
+  return 2LL * kGammaBetaParts * n2 * sizeof(float);
+}
+
+template <typename T>
+void add_dropout_layer_norm_forward_cuda(const T* x, const T* residual, const T* gamma,
+                                         const T* beta, T* y, T* z, float* mean, float* invvar,
+                                         int64_t* rng_state, int n1, int n2, float p, float eps,
+                                         uint64_t seed, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  constexpr int kVec = 16 / sizeof(T);
+  const bool cached = n2 <= kAddDropoutLayerNormMaxCachedCols;
+  const size_t smem = cached ? n2 * sizeof(float) : 0;
+  if (n2 % kVec == 0 && IsAligned({x, residual, gamma, beta, y, z}, 16)) {
+    AddDropoutLayerNormForwardKernel<T, kVec><<<n1, RowThreads(n2 / kVec), smem, cu_stream>>>(
+        x, residual, gamma, beta, y, z, mean, invvar, rng_state, n2, p, eps, seed, cached);
+  } else {
+    AddDropoutLayerNormForwardKernel<T, 1><<<n1, RowThreads(n2), smem, cu_stream>>>(
+        x, residual, gamma, beta, y, z, mean, invvar, rng_state, n2, p, eps, seed, cached);
+  }
+}
+
+template <typename T>
+void add_dropout_layer_norm_backward_cuda(const T* dy, const T* dz, const T* z, const T* gamma,
+                                          const float* mean, const float* invvar,
+                                          const int64_t* rng_state, T* dx, T* dresidual,
+                                          T* dgamma, T* dbeta, float* workspace, int n1, int n2,
+                                          float p, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  constexpr int kVec = 16 / sizeof(T);
+  if (n2 % kVec == 0 && IsAligned({dy, dz, z, gamma, dx, dresidual}, 16)) {
+    AddDropoutLayerNormBackwardKernel<T, kVec><<<n1, RowThreads(n2 / kVec), 0, cu_stream>>>(
+        dy, dz, z, gamma, mean, invvar, rng_state, dx, dresidual, n2, p);
+  } else {
+    AddDropoutLayerNormBackwardKernel<T, 1><<<n1, RowThreads(n2), 0, cu_stream>>>(
+        dy, dz, z, gamma, mean, invvar, rng_state, dx, dresidual, n2, p);
+  }
+  if (dgamma == nullptr) {
+    return;
+  }
+  float* part_gamma = workspace;
+  float* part_beta = workspace + kGammaBetaParts * n2;
+  dim3 part_grid(CeilDiv(n2, kGammaBetaCols), kGammaBetaParts);
+  dim3 part_block(kGammaBetaCols, kGammaBetaRows);
+  AddDropoutLayerNormGammaBetaPartKernel<T><<<part_grid, part_block, 0, cu_stream>>>(
+      dy, z, mean, invvar, n1, n2, CeilDiv(n1, kGammaBetaParts), part_gamma, part_beta);
+  AddDropoutLayerNormGammaBetaKernel<T><<<CeilDiv(n2, kMaxThreads), kMaxThreads, 0, cu_stream>>>(
+      part_gamma, part_beta, n2, dgamma, dbeta);
+}
+
+template void add_dropout_layer_norm_forward_cuda<float>(const float*, const float*, const float*,
+                                                         const float*, float*, float*, float*,
+                                                         float*, int64_t*, int, int, float, float,
+                                                         uint64_t, void*);
+template void add_dropout_layer_norm_forward_cuda<__half>(const __half*, const __half*,
+                                                          const __half*, const __half*, __half*,
+                                                          __half*, float*, float*, int64_t*, int,
+                                                          int, float, float, uint64_t, void*);
+template void add_dropout_layer_norm_backward_cuda<float>(const float*, const float*, const float*,
+                                                          const float*, const float*, const float*,
+                                                          const int64_t*, float*, float*, float*,
+                                                          float*, float*, int, int, float, void*);
+template void add_dropout_layer_norm_backward_cuda<__half>(const __half*, const __half*,
+                                                           const __half*, const __half*,
+                                                           const float*, const float*,
+                                                           const int64_t*, __half*, __half*,
+                                                           __half*, __half*, float*, int, int,
+                                                           float, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,459 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/attention.cu
+ * \brief Fused attention cuda kernels in the style of FlashAttention
+ * (https://arxiv.org/abs/2205.14135).
+ *
+ * The keys and values are loaded tile by tile to shared memory, and the scores of a tile never
+ * leave the registers: each lane of a warp computes the score of one key in the tile, and the
+ * softmax is computed online by rescaling the partial outputs with the running row maximum. Only
+ * the logsumexp of each row is written out, so the backward recomputes the probabilities instead
+ * of reading a seq_q x seq_k matrix. The dropout mask is regenerated from a counter-based hash of
+ * the seed and the element position.
+ */
+#include <math.h>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kNumWarps = 4;
+constexpr int kNumThreads = kNumWarps * kWarpSize;
+/*! \brief The number of keys (or queries in the dk/dv kernel) in a tile, one per lane. */
+constexpr int kTileSize = kWarpSize;
+/*! \brief The number of head dimensions held by each lane. */
+constexpr int kDimsPerLane = kAttentionMaxHeadDim / kWarpSize;
+/*! \brief The number of rows processed by each warp in the forward and backward. */
+constexpr int kFwdRowsPerWarp = 4;
+constexpr int kBwdRowsPerWarp = 2;
+/*! \brief The row stride of the tiles accessed by lanes, padded to avoid bank conflicts. */
+constexpr int kPaddedDim = kAttentionMaxHeadDim + 1;
+constexpr unsigned kFullMask = 0xffffffff;
+
+__device__ __forceinline__ float WarpMax(float x) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    x = fmaxf(x, __shfl_xor_sync(kFullMask, x, offset));
+  }
+  return x;
+}
+
+__device__ __forceinline__ float WarpSum(float x) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    x += __shfl_xor_sync(kFullMask, x, offset);
+  }
+  return x;
+}
+
+/*! \brief Whether the query row attends to the key. The causal mask is aligned to the bottom right
+ * corner, i.e., the last query attends to all keys. */
+__device__ __forceinline__ bool IsValid(int row, int key, int seq_q, int seq_k, bool causal) {
+  return row < seq_q && key < seq_k && (!causal || key <= row + seq_k - seq_q);
+}
+
+/*! \brief Load rows [row0, row0 + n_rows) of a [seq, head_dim] matrix to shared memory. */
+template <typename T>
+__device__ __forceinline__ void LoadTile(float* dst, int stride, const T* src, int row0, int n_rows,
+                                         int seq, int head_dim) {
+  for (int i = threadIdx.x; i < n_rows * head_dim; i += kNumThreads) {
+    int r = i / head_dim, d = i % head_dim;
+    dst[r * stride + d] = row0 + r < seq ? ToFloat(src[(row0 + r) * head_dim + d]) : 0.0f;
+  }
+}
+
+/*! \brief The last key + 1 attended by the query rows [row0, row0 + n_rows). */
+__device__ __forceinline__ int KeyEnd(int row0, int n_rows, int seq_q, int seq_k, bool causal) {
+  if (!causal) {
+    return seq_k;
+  }
+  return min(seq_k, max(0, row0 + n_rows + seq_k - seq_q));
+}
+
+template <typename T>
+__global__ void AttentionForwardKernel(const T* __restrict__ q, const T* __restrict__ k,
+                                       const T* __restrict__ v, T* __restrict__ out,
+                                       float* __restrict__ lse, int64_t* __restrict__ rng_state,
+                                       int seq_q, int seq_k, int head_dim, float scale,
+                                       bool causal, float p, uint64_t seed) {
+  constexpr int kRows = kNumWarps * kFwdRowsPerWarp;
+  __shared__ float q_s[kRows * kAttentionMaxHeadDim];
+  __shared__ float k_s[kTileSize * kPaddedDim];
+  __shared__ float v_s[kTileSize * kAttentionMaxHeadDim];
+
+  const int b = blockIdx.y;
+  const int row0 = blockIdx.x * kRows;
+  const int warp = threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  q += static_cast<int64_t>(b) * seq_q * head_dim;
+  k += static_cast<int64_t>(b) * seq_k * head_dim;
+  v += static_cast<int64_t>(b) * seq_k * head_dim;
+  if (b == 0 && blockIdx.x == 0 && threadIdx.x == 0) {
+    rng_state[0] = static_cast<int64_t>(seed);
+  }
+  LoadTile(q_s, kAttentionMaxHeadDim, q, row0, kRows, seq_q, head_dim);
+
+  float m[kFwdRowsPerWarp], l[kFwdRowsPerWarp], acc[kFwdRowsPerWarp][kDimsPerLane];
+#pragma unroll
+  for (int r = 0; r < kFwdRowsPerWarp; ++r) {
+    m[r] = -INFINITY;
+    l[r] = 0.0f;
+#pragma unroll
+    for (int i = 0; i < kDimsPerLane; ++i) {
+      acc[r][i] = 0.0f;
+    }
+  }
+  const float keep_scale = 1.0f / (1.0f - p);
+  const int key_end = KeyEnd(row0, kRows, seq_q, seq_k, causal);
+  for (int key0 = 0; key0 < key_end; key0 += kTileSize) {
+    __syncthreads();
+    LoadTile(k_s, kPaddedDim, k, key0, kTileSize, seq_k, head_dim);
+    LoadTile(v_s, kAttentionMaxHeadDim, v, key0, kTileSize, seq_k, head_dim);
+    __syncthreads();
+    const int key = key0 + lane;
+#pragma unroll
+    for (int r = 0; r < kFwdRowsPerWarp; ++r) {
+      const int local_row = warp * kFwdRowsPerWarp + r;
+      const int row = row0 + local_row;
+      const float* q_row = q_s + local_row * kAttentionMaxHeadDim;
+      float s = 0.0f;
+      for (int d = 0; d < head_dim; ++d) {
+        s += q_row[d] * k_s[lane * kPaddedDim + d];
+      }
+      s = IsValid(row, key, seq_q, seq_k, causal) ? s * scale : -INFINITY;
+      const float m_new = fmaxf(m[r], WarpMax(s));
+      if (m_new == -INFINITY) {
+        // No key in this tile and the previous ones is attended.
+        continue;
+      }
+      float prob = __expf(s - m_new);
+      const float alpha = __expf(m[r] - m_new);
+      l[r] = l[r] * alpha + WarpSum(prob);
+      m[r] = m_new;
+      if (p > 0.0f) {
+        uint64_t index = (static_cast<uint64_t>(b) * seq_q + row) * seq_k + key;
+        prob = DropoutKeep(seed, index, p) ? prob * keep_scale : 0.0f;
+      }
+#pragma unroll
+      for (int i = 0; i < kDimsPerLane; ++i) {
+        acc[r][i] *= alpha;
+      }
+      for (int j = 0; j < kTileSize; ++j) {
+        const float prob_j = __shfl_sync(kFullMask, prob, j);
+#pragma unroll
+        for (int i = 0; i < kDimsPerLane; ++i) {
+          const int d = lane + i * kWarpSize;
+          if (d < head_dim) {
+            acc[r][i] += prob_j * v_s[j * kAttentionMaxHeadDim + d];
+          }
+        }
+      }
+    }
+  }
+
+#pragma unroll
+  for (int r = 0; r < kFwdRowsPerWarp; ++r) {
+    const int row = row0 + warp * kFwdRowsPerWarp + r;
+    if (row >= seq_q) {
+      break;
+    }
+    const int64_t offset = (static_cast<int64_t>(b) * seq_q + row);
+    // A row without any attended key outputs zeros, and its logsumexp is +inf so that the
+    // backward recomputes zero probabilities.
+    const float inv_l = l[r] > 0.0f ? 1.0f / l[r] : 0.0f;
+#pragma unroll
+    for (int i = 0; i < kDimsPerLane; ++i) {
+      const int d = lane + i * kWarpSize;
+      if (d < head_dim) {
+        out[offset * head_dim + d] = FromFloat<T>(acc[r][i] * inv_l);
+      }
+    }
+    if (lane == 0) {
+      lse[offset] = l[r] > 0.0f ? m[r] + logf(l[r]) : INFINITY;
+    }
+  }
+}
+
+/*! \brief Compute delta = rowsum(dy * out), with one warp per row. */
+template <typename T>
+__global__ void AttentionDeltaKernel(const T* __restrict__ out, const T* __restrict__ dy,
+                                     float* __restrict__ delta, int64_t n_rows, int head_dim) {
+  const int64_t row = static_cast<int64_t>(blockIdx.x) * kNumWarps + threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  if (row >= n_rows) {
+    return;
+  }
+  float sum = 0.0f;
+  for (int d = lane; d < head_dim; d += kWarpSize) {
+    sum += ToFloat(out[row * head_dim + d]) * ToFloat(dy[row * head_dim + d]);
+  }
+  sum = WarpSum(sum);
+  if (lane == 0) {
+    delta[row] = sum;
+  }
+}
+
+/*! \brief Compute dq, where each warp owns query rows and each lane computes the gradient of the
+ * score of one key in the tile. */
+template <typename T>
+__global__ void AttentionBackwardDqKernel(const T* __restrict__ q, const T* __restrict__ k,
+                                          const T* __restrict__ v, const T* __restrict__ dy,
+                                          const float* __restrict__ lse,
+                                          const float* __restrict__ delta,
+                                          const int64_t* __restrict__ rng_state,
+                                          T* __restrict__ dq, int seq_q, int seq_k, int head_dim,
+                                          float scale, bool causal, float p) {
+  constexpr int kRows = kNumWarps * kBwdRowsPerWarp;
+  __shared__ float q_s[kRows * kAttentionMaxHeadDim];
+  __shared__ float dy_s[kRows * kAttentionMaxHeadDim];
+  __shared__ float k_s[kTileSize * kPaddedDim];
+  __shared__ float v_s[kTileSize * kPaddedDim];
+
+  const int b = blockIdx.y;
+  const int row0 = blockIdx.x * kRows;
+  const int warp = threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  const uint64_t seed = p > 0.0f ? static_cast<uint64_t>(rng_state[0]) : 0;
+  q += static_cast<int64_t>(b) * seq_q * head_dim;
+  dy += static_cast<int64_t>(b) * seq_q * head_dim;
+  k += static_cast<int64_t>(b) * seq_k * head_dim;
+  v += static_cast<int64_t>(b) * seq_k * head_dim;
+  LoadTile(q_s, kAttentionMaxHeadDim, q, row0, kRows, seq_q, head_dim);
+  LoadTile(dy_s, kAttentionMaxHeadDim, dy, row0, kRows, seq_q, head_dim);
+
+  float row_lse[kBwdRowsPerWarp], row_delta[kBwdRowsPerWarp];
+  float acc[kBwdRowsPerWarp][kDimsPerLane];
+#pragma unroll
+  for (int r = 0; r < kBwdRowsPerWarp; ++r) {
+    const int row = row0 + warp * kBwdRowsPerWarp + r;
+    const int64_t offset = static_cast<int64_t>(b) * seq_q + row;
+    row_lse[r] = row < seq_q ? lse[offset] : INFINITY;
+    row_delta[r] = row < seq_q ? delta[offset] : 0.0f;
+#pragma unroll
+    for (int i = 0; i < kDimsPerLane; ++i) {
+      acc[r][i] = 0.0f;
+    }
+  }
+  const float keep_scale = 1.0f / (1.0f - p);
+  const int key_end = KeyEnd(row0, kRows, seq_q, seq_k, causal);
+  for (int key0 = 0; key0 < key_end; key0 += kTileSize) {
+    __syncthreads();
+    LoadTile(k_s, kPaddedDim, k, key0, kTileSize, seq_k, head_dim);
+    LoadTile(v_s, kPaddedDim, v, key0, kTileSize, seq_k, head_dim);
+    __syncthreads();
+    const int key = key0 + lane;
+#pragma unroll
+    for (int r = 0; r < kBwdRowsPerWarp; ++r) {
+      const int local_row = warp * kBwdRowsPerWarp + r;
+      const int row = row0 + local_row;
+      const float* q_row = q_s + local_row * kAttentionMaxHeadDim;
+      const float* dy_row = dy_s + local_row * kAttentionMaxHeadDim;
+      float s = 0.0f, dp = 0.0f;
+      for (int d = 0; d < head_dim; ++d) {
+        s += q_row[d] * k_s[lane * kPaddedDim + d];
+        dp += dy_row[d] * v_s[lane * kPaddedDim + d];
+      }
+      const float prob =
+          IsValid(row, key, seq_q, seq_k, causal) ? __expf(s * scale - row_lse[r]) : 0.0f;
+      if (p > 0.0f) {
+        uint64_t index = (static_cast<uint64_t>(b) * seq_q + row) * seq_k + key;
+        dp = DropoutKeep(seed, index, p) ? dp * keep_scale : 0.0f;
+      }
+      const float ds = prob * (dp - row_delta[r]);
+      for (int j = 0; j < kTileSize; ++j) {
+        const float ds_j = __shfl_sync(kFullMask, ds, j);
+#pragma unroll
+        for (int i = 0; i < kDimsPerLane; ++i) {
+          const int d = lane + i * kWarpSize;
+          if (d < head_dim) {
+            acc[r][i] += ds_j * k_s[j * kPaddedDim + d];
+          }
+        }
+      }
+    }
+  }
+
+#pragma unroll
+  for (int r = 0; r < kBwdRowsPerWarp; ++r) {
+    const int row = row0 + warp * kBwdRowsPerWarp + r;
+    if (row >= seq_q) {
+      break;
+    }
+    const int64_t offset = static_cast<int64_t>(b) * seq_q + row;
+#pragma unroll
+    for (int i = 0; i < kDimsPerLane; ++i) {
+      const int d = lane + i * kWarpSize;
+      if (d < head_dim) {
+        dq[offset * head_dim + d] = FromFloat<T>(acc[r][i] * scale);
+      }
+    }
+  }
+}
+
+/*! \brief Compute dk and dv, where each warp owns key rows and each lane computes the gradient of
+ * the score of one query in the tile. */
+template <typename T>
+__global__ void AttentionBackwardDkvKernel(const T* __restrict__ q, const T* __restrict__ k,
+                                           const T* __restrict__ v, const T* __restrict__ dy,
+                                           const float* __restrict__ lse,
+                                           const float* __restrict__ delta,
+                                           const int64_t* __restrict__ rng_state,
+                                           T* __restrict__ dk, T* __restrict__ dv, int seq_q,
+                                           int seq_k, int head_dim, float scale, bool causal,
+                                           float p) {
+  constexpr int kKeys = kNumWarps * kBwdRowsPerWarp;
+  __shared__ float k_s[kKeys * kAttentionMaxHeadDim];
+  __shared__ float v_s[kKeys * kAttentionMaxHeadDim];
+  __shared__ float q_s[kTileSize * kPaddedDim];
+  __shared__ float dy_s[kTileSize * kPaddedDim];
+  __shared__ float lse_s[kTileSize];
+  __shared__ float delta_s[kTileSize];
+
+  const int b = blockIdx.y;
+  const int key0 = blockIdx.x * kKeys;
+  const int warp = threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  const uint64_t seed = p > 0.0f ? static_cast<uint64_t>(rng_state[0]) : 0;
+  q += static_cast<int64_t>(b) * seq_q * head_dim;
+  dy += static_cast<int64_t>(b) * seq_q * head_dim;
+  k += static_cast<int64_t>(b) * seq_k * head_dim;
+  v += static_cast<int64_t>(b) * seq_k * head_dim;
+  lse += static_cast<int64_t>(b) * seq_q;
+  delta += static_cast<int64_t>(b) * seq_q;
+  LoadTile(k_s, kAttentionMaxHeadDim, k, key0, kKeys, seq_k, head_dim);
+  LoadTile(v_s, kAttentionMaxHeadDim, v, key0, kKeys, seq_k, head_dim);
+
+  float dk_acc[kBwdRowsPerWarp][kDimsPerLane], dv_acc[kBwdRowsPerWarp][kDimsPerLane];
+#pragma unroll
+  for (int r = 0; r < kBwdRowsPerWarp; ++r) {
+#pragma unroll
+    for (int i = 0; i < kDimsPerLane; ++i) {
+      dk_acc[r][i] = 0.0f;
+      dv_acc[r][i] = 0.0f;
+    }
+  }
+  const float keep_scale = 1.0f / (1.0f - p);
+  // With the causal mask, the queries before the first key of this block do not attend to it.
+  int row_begin = causal ? max(0, key0 - (seq_k - seq_q)) : 0;
+  row_begin = row_begin / kTileSize * kTileSize;
+  for (int row0 = row_begin; row0 < seq_q; row0 += kTileSize) {
+    __syncthreads();
+    LoadTile(q_s, kPaddedDim, q, row0, kTileSize, seq_q, head_dim);
+    LoadTile(dy_s, kPaddedDim, dy, row0, kTileSize, seq_q, head_dim);
+    if (threadIdx.x < kTileSize) {
+      const int row = row0 + threadIdx.x;
+      lse_s[threadIdx.x] = row < seq_q ? lse[row] : INFINITY;
+      delta_s[threadIdx.x] = row < seq_q ? delta[row] : 0.0f;
+    }
+    __syncthreads();
+    const int row = row0 + lane;
+#pragma unroll
+    for (int r = 0; r < kBwdRowsPerWarp; ++r) {
+      const int local_key = warp * kBwdRowsPerWarp + r;
+      const int key = key0 + local_key;
+      const float* k_row = k_s + local_key * kAttentionMaxHeadDim;
+      const float* v_row = v_s + local_key * kAttentionMaxHeadDim;
+      float s = 0.0f, dp = 0.0f;
+      for (int d = 0; d < head_dim; ++d) {
+        s += q_s[lane * kPaddedDim + d] * k_row[d];
+        dp += dy_s[lane * kPaddedDim + d] * v_row[d];
+      }
+      float prob = IsValid(row, key, seq_q, seq_k, causal) ? __expf(s * scale - lse_s[lane]) : 0.0f;
+      float dropped_prob = prob;
+      if (p > 0.0f) {
+        uint64_t index = (static_cast<uint64_t>(b) * seq_q + row) * seq_k + key;
+        bool keep = DropoutKeep(seed, index, p);
+        dropped_prob = keep ? prob * keep_scale : 0.0f;
+        dp = keep ? dp * keep_scale : 0.0f;
+      }
+      const float ds = prob * (dp - delta_s[lane]);
+      for (int j = 0; j < kTileSize; ++j) {
+        const float prob_j = __shfl_sync(kFullMask, dropped_prob, j);
+        const float ds_j = __shfl_sync(kFullMask, ds, j);
+#pragma unroll
+        for (int i = 0; i < kDimsPerLane; ++i) {
+          const int d = lane + i * kWarpSize;
+          if (d < head_dim) {
+            dv_acc[r][i] += prob_j * dy_s[j * kPaddedDim + d];
+            dk_acc[r][i] += ds_j * q_s[j * kPaddedDim + d];
+          }
+        }
+      }
+    }
+  }
+
+#pragma unroll
+  for (int r = 0; r < kBwdRowsPerWarp; ++r) {
+    const int key = key0 + warp * kBwdRowsPerWarp + r;
+    if (key >= seq_k) {
+      break;
+    }
+    const int64_t offset = (static_cast<int64_t>(b) * seq_k + key) * head_dim;
+#pragma unroll
+    for (int i = 0; i < kDimsPerLane; ++i) {
+      const int d = lane + i * kWarpSize;
+      if (d < head_dim) {
+        dk[offset + d] = FromFloat<T>(dk_acc[r][i] * scale);
+        dv[offset + d] = FromFloat<T>(dv_acc[r][i]);
+      }
+    }
+  }
+}
+
+__host__ __forceinline__ int CeilDiv(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+}  // namespace
+
+template <typename T>
+void attention_forward_cuda(const T* q, const T* k, const T* v, T* out, float* lse,
+                            int64_t* rng_state, int batch, int seq_q, int seq_k, int head_dim,
+                            float scale, bool causal, float p, uint64_t seed, void* stream) {
+  dim3 grid(CeilDiv(seq_q, kNumWarps * kFwdRowsPerWarp), batch);
+  AttentionForwardKernel<T><<<grid, kNumThreads, 0, static_cast<cudaStream_t>(stream)>>>(
+      q, k, v, out, lse, rng_state, seq_q, seq_k, head_dim, scale, causal, p, seed);
+}
+
+template <typename T>
+void attention_backward_cuda(const T* q, const T* k, const T* v, const T* out, const T* dy,
+                             const float* lse, const int64_t* rng_state, T* dq, T* dk, T* dv,
+                             float* delta, int batch, int seq_q, int seq_k, int head_dim,
+                             float scale, bool causal, float p, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  int64_t n_rows = static_cast<int64_t>(batch) * seq_q;
+  AttentionDeltaKernel<T>
+      <<<CeilDiv(n_rows, kNumWarps), kNumThreads, 0, cu_stream>>>(out, dy, delta, n_rows, head_dim);
+  dim3 dq_grid(CeilDiv(seq_q, kNumWarps * kBwdRowsPerWarp), batch);
+  AttentionBackwardDqKernel<T><<<dq_grid, kNumThreads, 0, cu_stream>>>(
+      q, k, v, dy, lse, delta, rng_state, dq, seq_q, seq_k, head_dim, scale, causal, p);
+  dim3 dkv_grid(CeilDiv(seq_k, kNumWarps * kBwdRowsPerWarp), batch);
+  AttentionBackwardDkvKernel<T><<<dkv_grid, kNumThreads, 0, cu_stream>>>(
+      q, k, v, dy, lse, delta, rng_state, dk, dv, seq_q, seq_k, head_dim, scale, causal, p);
+}
+
+template void attention_forward_cuda<float>(const float*, const float*, const float*, float*,
+                                            float*, int64_t*, int, int, int, int, float, bool,
+                                            float, uint64_t, void*);
+template void attention_forward_cuda<__half>(const __half*, const __half*, const __half*, __half*,
+                                             float*, int64_t*, int, int, int, int, float, bool,
+                                             float, uint64_t, void*);
+template void attention_backward_cuda<float>(const float*, const float*, const float*,
+                                             const float*, const float*, const float*,
+                                             const int64_t*, float*, float*, float*, float*, int,
+                                             int, int, int, float, bool, float, void*);
+template void attention_backward_cuda<__half>(const __half*, const __half*, const __half*,
+                                              const __half*, const __half*, const float*,
+                                              const int64_t*, __half*, __half*, __half*, float*,
+                                              int, int, int, int, float, bool, float, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
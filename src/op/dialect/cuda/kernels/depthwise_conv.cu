@@ -0,0 +1,314 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/depthwise_conv.cu
+ * \brief Depthwise conv2d cuda kernels.
+ *
+ * A depthwise conv2d reads a few taps per output, so it is bound by the memory traffic rather
+ * than the math, and the kernels are arranged for coalesced loads and reuse in registers:
+ * - NCHW forward: a block owns an output plane tile, whose filter is staged in shared memory.
+ *   Each thread computes kTileW adjacent outputs of a row, so a filter tap in a register is
+ *   reused kTileW times and the adjacent threads read adjacent inputs.
+ * - NHWC forward: each thread computes N adjacent channels of an output pixel with vectorized
+ *   16-byte loads and stores of the inputs and outputs.
+ * - dx: each input gradient gathers from the outputs it contributes to, so there are no atomics.
+ * - dw: a block reduces a tap of a filter over a part of the batch and the output pixels, and the
+ *   parts are summed in a fixed order by a second pass.
+ * The values are accumulated in float, and all the results are deterministic.
+ */
+#include <algorithm>
+#include <cub/cub.cuh>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+/*! \brief The number of adjacent outputs of a row each thread of the NCHW kernels computes. */
+constexpr int kTileW = 4;
+/*! \brief The block of the plane kernels, which covers 32 x kTileW columns and 8 rows. */
+constexpr int kBlockX = 32;
+constexpr int kBlockY = 8;
+constexpr int kThreads = 256;
+/*! \brief The number of blocks that is considered to fill the device. */
+constexpr int64_t kTargetBlocks = 512;
+/*! \brief The fewest output pixels each block of the filter gradient reduces. */
+constexpr int64_t kMinDwChunk = 4096;
+
+__host__ __forceinline__ int64_t CeilDiv(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+/*! \brief Stage the filters of the count output channels from oc in shared memory. */
+template <typename T>
+__device__ __forceinline__ void LoadFilters(const T* w, float* filter, int64_t oc, int count,
+                                            int taps) {
+  const int tid = threadIdx.y * blockDim.x + threadIdx.x;
+  for (int i = tid; i < count * taps; i += blockDim.x * blockDim.y) {
+    filter[i] = ToFloat(w[oc * taps + i]);
+  }
+  __syncthreads();
+}
+
+/*! \brief The NCHW forward. The block (x, y, z) computes the plane x, rows from 8 * y, and the
+ * columns from 32 * kTileW * z. */
+template <typename T>
+__global__ void DepthwiseConvNCHWKernel(const T* x, const T* w, T* y, DepthwiseConvParams p) {
+  extern __shared__ float filter[];
+  const int64_t plane = blockIdx.x;
+  const int64_t oc = plane % p.out_channels;
+  const int64_t n = plane / p.out_channels;
+  const int64_t c = oc / (p.out_channels / p.in_channels);
+  const int taps = p.kernel_h * p.kernel_w;
+  LoadFilters(w, filter, oc, 1, taps);
+  const int oh = blockIdx.y * blockDim.y + threadIdx.y;
+  const int ow0 = (blockIdx.z * blockDim.x + threadIdx.x) * kTileW;
+  if (oh >= p.out_h || ow0 >= p.out_w) {
+    return;
+  }
+  const T* xp = x + (n * p.in_channels + c) * p.in_h * p.in_w;
+  float acc[kTileW] = {};
+  for (int kh = 0; kh < p.kernel_h; ++kh) {
+    const int ih = oh * p.stride_h - p.pad_h + kh * p.dilation_h;
+    if (ih < 0 || ih >= p.in_h) {
+      continue;
+    }
+    const T* row = xp + static_cast<int64_t>(ih) * p.in_w;
+    for (int kw = 0; kw < p.kernel_w; ++kw) {
+      const float wv = filter[kh * p.kernel_w + kw];
+      const int iw0 = ow0 * p.stride_w - p.pad_w + kw * p.dilation_w;
+#pragma unroll
+      for (int t = 0; t < kTileW; ++t) {
+        const int iw = iw0 + t * p.stride_w;
+        if (iw >= 0 && iw < p.in_w) {
+          acc[t] += wv * ToFloat(row[iw]);
+        }
+      }
+    }
+  }
+  T* yp = y + (plane * p.out_h + oh) * p.out_w;
+#pragma unroll
+  for (int t = 0; t < kTileW; ++t) {
+    if (ow0 + t < p.out_w) {
+      yp[ow0 + t] = FromFloat<T>(acc[t]);
+    }
+  }
+}
+
+/*! \brief The NHWC forward without channel multipliers, where each thread computes N channels. */
+template <typename T, int N>
+__global__ void DepthwiseConvNHWCKernel(const T* x, const T* w, T* y, DepthwiseConvParams p) {
+  const int64_t vecs = p.out_channels / N;
+  const int64_t total = static_cast<int64_t>(p.batch) * p.out_h * p.out_w * vecs;
+  const int taps = p.kernel_h * p.kernel_w;
+  for (int64_t idx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x; idx < total;
+       idx += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    const int64_t c = idx % vecs * N;
+    int64_t pixel = idx / vecs;
+    const int ow = pixel % p.out_w;
+    pixel /= p.out_w;
+    const int oh = pixel % p.out_h;
+    const int64_t n = pixel / p.out_h;
+    float acc[N] = {};
+    for (int kh = 0; kh < p.kernel_h; ++kh) {
+      const int ih = oh * p.stride_h - p.pad_h + kh * p.dilation_h;
+      if (ih < 0 || ih >= p.in_h) {
+        continue;
+      }
+      for (int kw = 0; kw < p.kernel_w; ++kw) {
+        const int iw = ow * p.stride_w - p.pad_w + kw * p.dilation_w;
+        if (iw < 0 || iw >= p.in_w) {
+          continue;
+        }
+        AlignedVector<T, N> xv =
+            LoadVector<T, N>(x, ((n * p.in_h + ih) * p.in_w + iw) * p.in_channels + c);
+        const int tap = kh * p.kernel_w + kw;
+#pragma unroll
+        for (int j = 0; j < N; ++j) {
+          acc[j] += ToFloat(xv.val[j]) * ToFloat(w[(c + j) * taps + tap]);
+        }
+      }
+    }
+    AlignedVector<T, N> out;
+#pragma unroll
+    for (int j = 0; j < N; ++j) {
+      out.val[j] = FromFloat<T>(acc[j]);
+    }
+    StoreVector<T, N>(y, ((n * p.out_h + oh) * p.out_w + ow) * p.out_channels + c, out);
+  }
+}
+
+/*! \brief The NCHW input gradient. The block (x, y, z) computes the input plane x, rows from
+ * 8 * y, and the columns from 32 * z. */
+template <typename T>
+__global__ void DepthwiseConvDxKernel(const T* dy, const T* w, T* dx, DepthwiseConvParams p) {
+  extern __shared__ float filter[];
+  const int64_t plane = blockIdx.x;
+  const int64_t c = plane % p.in_channels;
+  const int64_t n = plane / p.in_channels;
+  const int multiplier = p.out_channels / p.in_channels;
+  const int taps = p.kernel_h * p.kernel_w;
+  LoadFilters(w, filter, c * multiplier, multiplier, taps);
+  const int ih = blockIdx.y * blockDim.y + threadIdx.y;
+  const int iw = blockIdx.z * blockDim.x + threadIdx.x;
+  if (ih >= p.in_h || iw >= p.in_w) {
+    return;
+  }
+  float acc = 0.0f;
+  for (int m = 0; m < multiplier; ++m) {
+    const T* dyp = dy + (n * p.out_channels + c * multiplier + m) * p.out_h * p.out_w;
+    const float* fm = filter + m * taps;
+    for (int kh = 0; kh < p.kernel_h; ++kh) {
+      const int h = ih + p.pad_h - kh * p.dilation_h;
+      if (h < 0 || h % p.stride_h != 0 || h / p.stride_h >= p.out_h) {
+        continue;
+      }
+      const T* row = dyp + static_cast<int64_t>(h / p.stride_h) * p.out_w;
+      for (int kw = 0; kw < p.kernel_w; ++kw) {
+        const int v = iw + p.pad_w - kw * p.dilation_w;
+        if (v < 0 || v % p.stride_w != 0 || v / p.stride_w >= p.out_w) {
+          continue;
+        }
+        acc += fm[kh * p.kernel_w + kw] * ToFloat(row[v / p.stride_w]);
+      }
+    }
+  }
+  dx[(plane * p.in_h + ih) * p.in_w + iw] = FromFloat<T>(acc);
+}
+
+/*!
+ * \brief The partial filter gradients. The block x reduces the tap x % taps of the output channel
+ * x / taps over the part y of chunk output pixels of the batch, into partials[x][y].
+ */
+template <typename T>
+__global__ void DepthwiseConvDwKernel(const T* x, const T* dy, float* partials,
+                                      DepthwiseConvParams p, int64_t chunk) {
+  using BlockReduce = cub::BlockReduce<float, kThreads>;
+  __shared__ typename BlockReduce::TempStorage temp;
+  const int taps = p.kernel_h * p.kernel_w;
+  const int64_t oc = blockIdx.x / taps;
+  const int tap = blockIdx.x % taps;
+  const int kh = tap / p.kernel_w;
+  const int kw = tap % p.kernel_w;
+  const int64_t c = oc / (p.out_channels / p.in_channels);
+  const int64_t pixels = static_cast<int64_t>(p.out_h) * p.out_w;
+  const int64_t total = p.batch * pixels;
+  const int64_t start = blockIdx.y * chunk;
+  const int64_t end = start + chunk < total ? start + chunk : total;
+  float acc = 0.0f;
+  for (int64_t i = start + threadIdx.x; i < end; i += kThreads) {
+    const int64_t n = i / pixels;
+    const int64_t pixel = i % pixels;
+    const int oh = pixel / p.out_w;
+    const int ow = pixel % p.out_w;
+    const int ih = oh * p.stride_h - p.pad_h + kh * p.dilation_h;
+    const int iw = ow * p.stride_w - p.pad_w + kw * p.dilation_w;
+    if (ih >= 0 && ih < p.in_h && iw >= 0 && iw < p.in_w) {
+      acc += ToFloat(dy[(n * p.out_channels + oc) * pixels + pixel]) *
+             ToFloat(x[((n * p.in_channels + c) * p.in_h + ih) * p.in_w + iw]);
+    }
+  }
+  acc = BlockReduce(temp).Sum(acc);
+  if (threadIdx.x == 0) {
+    partials[static_cast<int64_t>(blockIdx.x) * gridDim.y + blockIdx.y] = acc;
+  }
+}
+
+/*! \brief Sum the splits partials of each of the n filter elements in order. */
+template <typename T>
+__global__ void SumPartialsKernel(const float* partials, T* dw, int64_t n, int64_t splits) {
+  const int64_t i = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (i >= n) {
+    return;
+  }
+  float acc = 0.0f;
+  for (int64_t s = 0; s < splits; ++s) {
+    acc += partials[i * splits + s];
+  }
+  dw[i] = FromFloat<T>(acc);
+}
+
+/*! \brief The number of parts the output pixels are split into for the filter gradient. */
+int64_t DwSplits(const DepthwiseConvParams& p) {
+  const int64_t blocks = static_cast<int64_t>(p.out_channels) * p.kernel_h * p.kernel_w;
+  const int64_t total = static_cast<int64_t>(p.batch) * p.out_h * p.out_w;
+  const int64_t max_splits = std::max<int64_t>(1, total / kMinDwChunk);
+  return std::min(std::max<int64_t>(1, CeilDiv(kTargetBlocks, blocks)), max_splits);
+}
+
+}  // namespace
+
+template <typename T>
+void depthwise_conv2d_cuda(const T* x, const T* w, T* y, const DepthwiseConvParams& p, bool nhwc,
+                           void* stream) {
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  if (nhwc) {
+    constexpr int kVec = 16 / sizeof(T);
+    const bool vectorize = p.out_channels % kVec == 0 &&
+                           reinterpret_cast<uintptr_t>(x) % 16 == 0 &&
+                           reinterpret_cast<uintptr_t>(y) % 16 == 0;
+    const int64_t vecs = p.out_channels / (vectorize ? kVec : 1);
+    const int64_t total = static_cast<int64_t>(p.batch) * p.out_h * p.out_w * vecs;
+    const int64_t blocks = std::min<int64_t>(CeilDiv(total, kThreads), 65535 * 8);
+    if (vectorize) {
+      DepthwiseConvNHWCKernel<T, kVec><<<blocks, kThreads, 0, s>>>(x, w, y, p);
+    } else {
+      DepthwiseConvNHWCKernel<T, 1><<<blocks, kThreads, 0, s>>>(x, w, y, p);
+    }
+    return;
+  }
+  dim3 grid(static_cast<int64_t>(p.batch) * p.out_channels, CeilDiv(p.out_h, kBlockY),
+            CeilDiv(p.out_w, kBlockX * kTileW));
+  dim3 block(kBlockX, kBlockY);
+  size_t smem = sizeof(float) * p.kernel_h * p.kernel_w;
+  DepthwiseConvNCHWKernel<T><<<grid, block, smem, s>>>(x, w, y, p);
+}
+
+template <typename T>
+void depthwise_conv2d_dx_cuda(const T* dy, const T* w, T* dx, const DepthwiseConvParams& p,
+                              void* stream) {
+  dim3 grid(static_cast<int64_t>(p.batch) * p.in_channels, CeilDiv(p.in_h, kBlockY),
+            CeilDiv(p.in_w, kBlockX));
+  dim3 block(kBlockX, kBlockY);
+  size_t smem = sizeof(float) * p.out_channels / p.in_channels * p.kernel_h * p.kernel_w;
+  DepthwiseConvDxKernel<T><<<grid, block, smem, static_cast<cudaStream_t>(stream)>>>(dy, w, dx, p);
+}
+
+int64_t depthwise_conv2d_dw_workspace(const DepthwiseConvParams& p) {
+  return sizeof(float) * p.out_channels * p.kernel_h * p.kernel_w * DwSplits(p);
+}
+
+template <typename T>
+void depthwise_conv2d_dw_cuda(const T* x, const T* dy, T* dw, const DepthwiseConvParams& p,
+                              void* workspace, void* stream) {
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  const int64_t n = static_cast<int64_t>(p.out_channels) * p.kernel_h * p.kernel_w;
+  const int64_t splits = DwSplits(p);
+  const int64_t chunk = CeilDiv(static_cast<int64_t>(p.batch) * p.out_h * p.out_w, splits);
+  float* partials = static_cast<float*>(workspace);
+  DepthwiseConvDwKernel<T><<<dim3(n, splits), kThreads, 0, s>>>(x, dy, partials, p, chunk);
+  SumPartialsKernel<T><<<CeilDiv(n, kThreads), kThreads, 0, s>>>(partials, dw, n, splits);
+}
+
+template void depthwise_conv2d_cuda<float>(const float*, const float*, float*,
+                                           const DepthwiseConvParams&, bool, void*);
+template void depthwise_conv2d_cuda<__half>(const __half*, const __half*, __half*,
+                                            const DepthwiseConvParams&, bool, void*);
+template void depthwise_conv2d_dx_cuda<float>(const float*, const float*, float*,
+                                              const DepthwiseConvParams&, void*);
+template void depthwise_conv2d_dx_cuda<__half>(const __half*, const __half*, __half*,
+                                               const DepthwiseConvParams&, void*);
+template void depthwise_conv2d_dw_cuda<float>(const float*, const float*, float*,
+                                              const DepthwiseConvParams&, void*, void*);
+template void depthwise_conv2d_dw_cuda<__half>(const __half*, const __half*, __half*,
+                                               const DepthwiseConvParams&, void*, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
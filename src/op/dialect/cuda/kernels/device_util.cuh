@@ -0,0 +1,175 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/device_util.cuh
+ * \brief Device helper functions shared by the CUDA kernels
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+__device__ __forceinline__ float ToFloat(float x) {
+  return x;
+}
+
+__device__ __forceinline__ float ToFloat(__half x) {
+  return __half2float(x);
+}
+
+template <typename T>
+__device__ __forceinline__ T FromFloat(float x);
+
+template <>
+__device__ __forceinline__ float FromFloat<float>(float x) {
+  return x;
+}
+
+template <>
+__device__ __forceinline__ __half FromFloat<__half>(float x) {
+  return __float2half(x);
+}
+
+/*!
+ * \brief The factor to scale the gradients by to clip their global norm grad_norm to max_grad_norm,
+ * which does not clip if it is not positive. Returns false if grad_norm is inf or nan, in which
+ * case the optimizer step is skipped. A null grad_norm neither clips nor skips. If the gradients
+ * are scaled by a loss_scale that is not null, the factor also unscales them, and the norm is
+ * unscaled before clipping.
+ */
+__device__ __forceinline__ bool GradClipScale(const float* grad_norm, float max_grad_norm,
+                                              const float* loss_scale, float* scale) {
+  *scale = 1.0f;
+  if (grad_norm == nullptr) {
+    return true;
+  }
+  float norm = *grad_norm;
+  if (!isfinite(norm)) {
+    return false;
+  }
+  if (loss_scale != nullptr) {
+    *scale = 1.0f / *loss_scale;
+    norm *= *scale;
+  }
+  if (max_grad_norm > 0.0f && norm > max_grad_norm) {
+    *scale *= max_grad_norm / (norm + 1e-6f);
+  }
+  return true;
+}
+
+/*! \brief Whether an element is kept by dropout, hashed from the seed and the element index with
+ * the SplitMix64 finalizer, so the forward and backward agree without storing the mask. */
+__device__ __forceinline__ bool DropoutKeep(uint64_t seed, uint64_t index, float p) {
+  uint64_t z = seed + index * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  return static_cast<float>(z >> 40) * (1.0f / 16777216.0f) >= p;
+}
+
+/*!
+ * \brief The Philox-4x32-10 counter-based generator (Salmon et al., SC'11), which maps a 128-bit
+ * counter and a 64-bit key to four independent 32-bit random numbers.
+ */
+__device__ __forceinline__ uint4 Philox4x32(uint4 ctr, uint2 key) {
+  constexpr uint32_t kMul0 = 0xD2511F53;
+  constexpr uint32_t kMul1 = 0xCD9E8D57;
+  constexpr uint32_t kWeyl0 = 0x9E3779B9;
+  constexpr uint32_t kWeyl1 = 0xBB67AE85;
+#pragma unroll
+  for (int i = 0; i < 10; ++i) {
+    uint32_t hi0 = __umulhi(kMul0, ctr.x);
+    uint32_t lo0 = kMul0 * ctr.x;
+    uint32_t hi1 = __umulhi(kMul1, ctr.z);
+    uint32_t lo1 = kMul1 * ctr.z;
+    ctr = make_uint4(hi1 ^ ctr.y ^ key.x, lo1, hi0 ^ ctr.w ^ key.y, lo0);
+    key.x += kWeyl0;
+    key.y += kWeyl1;
+  }
+  return ctr;
+}
+
+/*! \brief The number of rounds of Threefry-2x64, which is the recommended 20. */
+constexpr int kThreefryRounds = 20;
+
+__device__ __forceinline__ uint64_t RotL64(uint64_t x, int r) {
+  return r == 0 ? x : (x << r) | (x >> (64 - r));
+}
+
+/*!
+ * \brief Fold the words of a Threefry key into the key of Threefry2x64 and the high word of its
+ * counter. Keep in sync with _threefry_key in python/raf/_tvm_op/random.py.
+ */
+__device__ __forceinline__ void ThreefryFoldKey(const uint64_t* key, int key_size, uint64_t* k0,
+                                                uint64_t* k1, uint64_t* c1) {
+  uint64_t key_words[2] = {0, 0};
+  uint64_t sum = 0;
+  for (int i = 0; i < key_size; ++i) {
+    key_words[i % 2] ^= RotL64(key[i], (7 * i) % 64);
+    sum += key[i];
+  }
+  *k0 = key_words[0];
+  *k1 = key_words[1];
+  *c1 = sum;
+}
+
+/*!
+ * \brief The Threefry-2x64-20 generator (Salmon et al., SC'11), which maps the 128-bit counter
+ * (c0, c1) and the 128-bit key (k0, k1) to two independent 64-bit random numbers. Keep in sync
+ * with _threefry in python/raf/_tvm_op/random.py.
+ */
+__device__ __forceinline__ void Threefry2x64(uint64_t k0, uint64_t k1, uint64_t c0, uint64_t c1,
+                                             uint64_t* x0, uint64_t* x1) {
+  constexpr int kRotations[8] = {16, 42, 12, 31, 16, 32, 24, 21};
+  const uint64_t ks[3] = {k0, k1, 0x1BD11BDAA9FC1A22ULL ^ k0 ^ k1};
+  uint64_t y0 = c0 + ks[0];
+  uint64_t y1 = c1 + ks[1];
+#pragma unroll
+  for (int r = 0; r < kThreefryRounds; ++r) {
+    y0 += y1;
+    y1 = RotL64(y1, kRotations[r % 8]) ^ y0;
+    if (r % 4 == 3) {
+      int s = (r + 1) / 4;
+      y0 += ks[s % 3];
+      y1 += ks[(s + 1) % 3] + s;
+    }
+  }
+  *x0 = y0;
+  *x1 = y1;
+}
+
+/*! \brief Map the top 24 bits of a 64-bit random number to a float in [0, 1). */
+__device__ __forceinline__ float Uint64ToUniform(uint64_t x) {
+  return static_cast<float>(x >> 40) * (1.0f / 16777216.0f);
+}
+
+/*! \brief Map a 32-bit random number to a float in [0, 1). */
+__device__ __forceinline__ float Uint32ToUniform(uint32_t x) {
+  return static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+}
+
+/*! \brief A vector of N elements loaded or stored by a single 128-bit (or narrower) access. */
+template <typename T, int N>
+struct alignas(sizeof(T) * N) AlignedVector {
+  T val[N];
+};
+
+template <typename T, int N>
+__device__ __forceinline__ AlignedVector<T, N> LoadVector(const T* ptr, int64_t i) {
+  return *reinterpret_cast<const AlignedVector<T, N>*>(ptr + i);
+}
+
+template <typename T, int N>
+__device__ __forceinline__ void StoreVector(T* ptr, int64_t i, const AlignedVector<T, N>& vec) {
+  *reinterpret_cast<AlignedVector<T, N>*>(ptr + i) = vec;
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,147 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/dropout.cu
+ * \brief Dropout cuda kernels driven by a Philox counter.
+ *
+ * The mask of the element group g (4 consecutive elements) is drawn from Philox with the counter
+ * (offset, g) and the key seed, so it only depends on (seed, offset) and the element index. The
+ * forward writes (seed, offset) to a 16-byte state, from which the backward regenerates the mask
+ * instead of reading a stored one.
+ */
+#include <algorithm>
+#include <initializer_list>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kThreads = 256;
+constexpr int kMaxBlocks = 65535;
+/*! \brief The number of elements that share one Philox draw. */
+constexpr int kGroup = 4;
+
+__host__ __forceinline__ int64_t CeilDiv(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+/*! \brief Whether all the pointers can be accessed by vectors of n_bytes. */
+__host__ __forceinline__ bool IsAligned(std::initializer_list<const void*> ptrs, int n_bytes) {
+  for (const void* ptr : ptrs) {
+    if (reinterpret_cast<uintptr_t>(ptr) % n_bytes != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+__device__ __forceinline__ uint4 DropoutRandom(uint64_t seed, uint64_t offset, uint64_t group) {
+  uint4 ctr = make_uint4(static_cast<uint32_t>(offset), static_cast<uint32_t>(offset >> 32),
+                         static_cast<uint32_t>(group), static_cast<uint32_t>(group >> 32));
+  uint2 key = make_uint2(static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32));
+  return Philox4x32(ctr, key);
+}
+
+template <typename T>
+__device__ __forceinline__ T DropoutValue(T v, bool keep, float p) {
+  return FromFloat<T>(keep ? ToFloat(v) / (1.0f - p) : 0.0f);
+}
+
+template <>
+__device__ __forceinline__ double DropoutValue<double>(double v, bool keep, float p) {
+  return keep ? v / (1.0 - p) : 0.0;
+}
+
+/*!
+ * \brief y = dropout(x) for all element groups. The state is read from in_state if given,
+ * which replays an earlier dropout. The state is written to out_state if given.
+ */
+template <typename T, bool aligned>
+__global__ void DropoutKernel(const T* __restrict__ x, T* __restrict__ y, int64_t n, float p,
+                              uint64_t seed, uint64_t offset, const int64_t* in_state,
+                              int64_t* out_state) {
+  if (in_state != nullptr) {
+    seed = in_state[0];
+    offset = in_state[1];
+  }
+  if (out_state != nullptr && blockIdx.x == 0 && threadIdx.x == 0) {
+    out_state[0] = seed;
+    out_state[1] = offset;
+  }
+  using Vec = AlignedVector<T, kGroup>;
+  const int64_t n_groups = CeilDiv(n, kGroup);
+  for (int64_t g = blockIdx.x * blockDim.x + threadIdx.x; g < n_groups;
+       g += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    uint4 r = DropoutRandom(seed, offset, g);
+    bool keep[kGroup] = {Uint32ToUniform(r.x) >= p, Uint32ToUniform(r.y) >= p,
+                         Uint32ToUniform(r.z) >= p, Uint32ToUniform(r.w) >= p};
+    const int64_t i = g * kGroup;
+    if (aligned && i + kGroup <= n) {
+      Vec x_vec = LoadVector<T, kGroup>(x, i);
+      Vec y_vec;
+#pragma unroll
+      for (int k = 0; k < kGroup; ++k) {
+        y_vec.val[k] = DropoutValue(x_vec.val[k], keep[k], p);
+      }
+      StoreVector<T, kGroup>(y, i, y_vec);
+    } else {
+      for (int k = 0; k < kGroup && i + k < n; ++k) {
+        y[i + k] = DropoutValue(x[i + k], keep[k], p);
+      }
+    }
+  }
+}
+
+template <typename T>
+void LaunchDropout(const T* x, T* y, int64_t n, float p, uint64_t seed, uint64_t offset,
+                   const int64_t* in_state, int64_t* out_state, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  const int blocks = std::max<int64_t>(1, std::min<int64_t>(kMaxBlocks,
+                                                            CeilDiv(CeilDiv(n, kGroup), kThreads)));
+  if (IsAligned({x, y}, sizeof(T) * kGroup)) {
+    DropoutKernel<T, true><<<blocks, kThreads, 0, cu_stream>>>(x, y, n, p, seed, offset, in_state,
+                                                               out_state);
+  } else {
+    DropoutKernel<T, false><<<blocks, kThreads, 0, cu_stream>>>(x, y, n, p, seed, offset,
+                                                                in_state, out_state);
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void dropout_forward_cuda(const T* x, T* y, int64_t* state, const int64_t* in_state, int64_t n,
+                          float p, uint64_t seed, uint64_t offset, void* stream) {
+  LaunchDropout(x, y, n, p, seed, offset, in_state, state, stream);
+}
+
+template <typename T>
+void dropout_backward_cuda(const T* dy, T* dx, const int64_t* state, int64_t n, float p,
+                           void* stream) {
+  // The gradient is dy masked and scaled in the same way as the forward.
+  LaunchDropout(dy, dx, n, p, 0, 0, state, static_cast<int64_t*>(nullptr), stream);
+}
+
+template void dropout_forward_cuda<float>(const float*, float*, int64_t*, const int64_t*, int64_t,
+                                          float, uint64_t, uint64_t, void*);
+template void dropout_forward_cuda<__half>(const __half*, __half*, int64_t*, const int64_t*,
+                                           int64_t, float, uint64_t, uint64_t, void*);
+template void dropout_forward_cuda<double>(const double*, double*, int64_t*, const int64_t*,
+                                           int64_t, float, uint64_t, uint64_t, void*);
+template void dropout_backward_cuda<float>(const float*, float*, const int64_t*, int64_t, float,
+                                           void*);
+template void dropout_backward_cuda<__half>(const __half*, __half*, const int64_t*, int64_t, float,
+                                            void*);
+template void dropout_backward_cuda<double>(const double*, double*, const int64_t*, int64_t, float,
+                                            void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
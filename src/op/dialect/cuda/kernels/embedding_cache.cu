@@ -0,0 +1,266 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/embedding_cache.cu
+ * \brief The kernels of the device row caches of the embedding tables on the host.
+ *
+ * The cache is set-associative: row r can only be kept by the ways of set r % num_sets. The state
+ * of a set is an entry of tags in shape [1 + num_ways, 3]. Its first row is (lock, clock, 0), and
+ * the others are (row, stamp, dirty) of each way, where an empty way has row -1. A way is stamped
+ * with the next clock of its set whenever it is hit or filled, so the way with the smallest stamp
+ * is the least recently used one.
+ *
+ * A lookup is served by one warp, whose lanes compare the tags of all ways at once. The missed
+ * rows are read from the table directly through the mapped host memory, and filled into the cache
+ * by a second kernel afterwards, where a dirty victim is written back to the table first.
+ */
+#include <stdio.h>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+/*! \brief The number of lookups that are served by one thread block. */
+constexpr int kCacheWarps = 4;
+/*! \brief The number of threads that fill a missed row. */
+constexpr int kCacheThreads = 128;
+/*! \brief The alignment of the buffers in the workspace. */
+constexpr int64_t kWorkspaceAlign = 256;
+
+__host__ __forceinline__ int CeilDiv(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+__host__ __forceinline__ int64_t AlignUp(int64_t bytes) {
+  return (bytes + kWorkspaceAlign - 1) / kWorkspaceAlign * kWorkspaceAlign;
+}
+
+__device__ __forceinline__ int64_t* SetState(int64_t* tags, int64_t set, int num_ways) {
+  return tags + set * (num_ways + 1) * 3;
+}
+
+__device__ __forceinline__ unsigned long long* AsUnsigned(int64_t* ptr) {
+  return reinterpret_cast<unsigned long long*>(ptr);
+}
+
+/*! \brief The way of a set that keeps the row, or -1. It is called by all lanes of a warp. */
+__device__ __forceinline__ int FindWay(const int64_t* state, int64_t row, int num_ways) {
+  const int lane = threadIdx.x;
+  bool hit = lane < num_ways && state[(lane + 1) * 3] == row;
+  unsigned mask = __ballot_sync(0xFFFFFFFF, hit);
+  return mask ? __ffs(mask) - 1 : -1;
+}
+
+/*! \brief One lookup per warp, which records the missed rows in misses[1:]. */
+template <typename scalar_t>
+__global__ void EmbeddingCacheLookupKernel(const scalar_t* __restrict__ table,
+                                           const int64_t* __restrict__ indices, int64_t* tags,
+                                           const scalar_t* __restrict__ rows,
+                                           scalar_t* __restrict__ out, int64_t* misses, int num,
+                                           int64_t range, int num_sets, int num_ways, int stride) {
+  const int64_t i = static_cast<int64_t>(blockIdx.x) * kCacheWarps + threadIdx.y;
+  if (i >= num) {
+    return;
+  }
+  const int64_t row = indices[i];
+  if (row < 0 || row >= range) {
+    if (threadIdx.x == 0) {
+      printf("indices[%lld] = %lld is out of range [0, %lld)\n", static_cast<long long>(i),
+             static_cast<long long>(row), static_cast<long long>(range));
+    }
+    asm("trap;");
+  }
+  const int64_t set = row % num_sets;
+  int64_t* state = SetState(tags, set, num_ways);
+  const int way = FindWay(state, row, num_ways);
+  const scalar_t* src;
+  if (way >= 0) {
+    if (threadIdx.x == 0) {
+      state[(way + 1) * 3 + 1] = atomicAdd(AsUnsigned(state + 1), 1ULL) + 1;
+    }
+    src = rows + (set * num_ways + way) * stride;
+  } else {
+    if (threadIdx.x == 0) {
+      misses[1 + atomicAdd(AsUnsigned(misses), 1ULL)] = row;
+    }
+    src = table + row * stride;
+  }
+  for (int col = threadIdx.x; col < stride; col += 32) {
+    out[i * stride + col] = src[col];
+  }
+}
+
+/*!
+ * \brief One missed row per thread block. The set is locked while its least recently used way is
+ * replaced, so that the duplicated misses of a row fill one way only.
+ */
+template <typename scalar_t>
+__global__ void EmbeddingCacheFillKernel(scalar_t* table, const int64_t* misses, int64_t* tags,
+                                         scalar_t* rows, int num_sets, int num_ways, int stride) {
+  __shared__ int way;
+  __shared__ int64_t victim;
+  if (blockIdx.x >= misses[0]) {
+    return;
+  }
+  const int64_t row = misses[1 + blockIdx.x];
+  const int64_t set = row % num_sets;
+  volatile int64_t* state = SetState(tags, set, num_ways);
+  if (threadIdx.x == 0) {
+    while (atomicCAS(AsUnsigned(const_cast<int64_t*>(state)), 0ULL, 1ULL) != 0ULL) {
+    }
+    __threadfence();
+    way = 0;
+    victim = -1;
+    int64_t oldest = INT64_MAX;
+    for (int w = 0; w < num_ways; ++w) {
+      volatile int64_t* entry = state + (w + 1) * 3;
+      if (entry[0] == row) {
+        way = -1;
+        break;
+      }
+      int64_t stamp = entry[0] < 0 ? -1 : entry[1];
+      if (stamp < oldest) {
+        oldest = stamp;
+        way = w;
+      }
+    }
+    if (way >= 0 && state[(way + 1) * 3 + 2]) {
+      victim = state[(way + 1) * 3];
+    }
+  }
+  __syncthreads();
+  if (way >= 0) {
+    scalar_t* slot = rows + (set * num_ways + way) * stride;
+    // Each thread writes back and then fills the same columns, so no barrier is needed between.
+    for (int col = threadIdx.x; col < stride; col += blockDim.x) {
+      if (victim >= 0) {
+        table[victim * stride + col] = slot[col];
+      }
+      slot[col] = table[row * stride + col];
+    }
+    __threadfence();
+  }
+  __syncthreads();
+  if (threadIdx.x == 0) {
+    if (way >= 0) {
+      volatile int64_t* entry = state + (way + 1) * 3;
+      entry[0] = row;
+      entry[1] = atomicAdd(AsUnsigned(const_cast<int64_t*>(state) + 1), 1ULL) + 1;
+      entry[2] = 0;
+    }
+    __threadfence();
+    atomicExch(AsUnsigned(const_cast<int64_t*>(state)), 0ULL);
+  }
+}
+
+/*!
+ * \brief One distinct row per warp. A cached row is updated in the cache and marked dirty, and the
+ * others are updated in the table directly.
+ */
+template <typename scalar_t>
+__global__ void EmbeddingCacheSgdKernel(scalar_t* table, const int64_t* __restrict__ grad_rows,
+                                        const scalar_t* __restrict__ grad_values, int64_t* tags,
+                                        scalar_t* rows, float learning_rate, int num, int num_sets,
+                                        int num_ways, int stride) {
+  const int64_t i = static_cast<int64_t>(blockIdx.x) * kCacheWarps + threadIdx.y;
+  if (i >= num) {
+    return;
+  }
+  const int64_t row = grad_rows[i];
+  // The distinct rows are padded with -1.
+  if (row < 0) {
+    return;
+  }
+  const int64_t set = row % num_sets;
+  int64_t* state = SetState(tags, set, num_ways);
+  const int way = FindWay(state, row, num_ways);
+  scalar_t* dst;
+  if (way >= 0) {
+    if (threadIdx.x == 0) {
+      state[(way + 1) * 3 + 2] = 1;
+    }
+    dst = rows + (set * num_ways + way) * stride;
+  } else {
+    dst = table + row * stride;
+  }
+  for (int col = threadIdx.x; col < stride; col += 32) {
+    float grad = ToFloat(grad_values[i * stride + col]);
+    dst[col] = FromFloat<scalar_t>(ToFloat(dst[col]) - learning_rate * grad);
+  }
+}
+
+}  // namespace
+
+int64_t embedding_cache_lookup_workspace(int num) {
+  return sizeof(int64_t) * (num + 1);
+}
+
+int64_t embedding_cache_sgd_workspace(int num, int range, int stride, int elem_bytes) {
+  return AlignUp(sizeof(int64_t) * num) + AlignUp(static_cast<int64_t>(elem_bytes) * num * stride) +
+         embedding_backward_workspace(num, range, stride);
+}
+
+template <typename scalar_t>
+void embedding_cache_lookup_cuda(scalar_t* table, const int64_t* indices, int64_t* tags,
+                                 scalar_t* rows, scalar_t* out, int num, int64_t range,
+                                 int num_sets, int num_ways, int stride, void* workspace,
+                                 void* stream) {
+  if (num == 0) {
+    return;
+  }
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  int64_t* misses = static_cast<int64_t*>(workspace);
+  CUDA_CALL(cudaMemsetAsync(misses, 0, sizeof(int64_t), cu_stream));
+  EmbeddingCacheLookupKernel<scalar_t>
+      <<<CeilDiv(num, kCacheWarps), dim3(32, kCacheWarps), 0, cu_stream>>>(
+          table, indices, tags, rows, out, misses, num, range, num_sets, num_ways, stride);
+  // The number of misses is only known on the device, so the blocks past it exit at once.
+  EmbeddingCacheFillKernel<scalar_t><<<num, kCacheThreads, 0, cu_stream>>>(
+      table, misses, tags, rows, num_sets, num_ways, stride);
+}
+
+template <typename scalar_t>
+void embedding_cache_sgd_cuda(scalar_t* table, const scalar_t* grad, const int64_t* indices,
+                              int64_t* tags, scalar_t* rows, float learning_rate, int num,
+                              int range, int num_sets, int num_ways, int stride, void* workspace,
+                              void* stream) {
+  if (num == 0) {
+    return;
+  }
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  char* ptr = static_cast<char*>(workspace);
+  int64_t* grad_rows = reinterpret_cast<int64_t*>(ptr);
+  ptr += AlignUp(sizeof(int64_t) * num);
+  scalar_t* grad_values = reinterpret_cast<scalar_t*>(ptr);
+  ptr += AlignUp(sizeof(scalar_t) * num * stride);
+  // Each distinct row is summed once, so the rows are updated without atomics.
+  embedding_sparse_backward_cuda<scalar_t>(grad, grad_rows, grad_values, indices, num, range,
+                                           stride, ptr, stream);
+  EmbeddingCacheSgdKernel<scalar_t>
+      <<<CeilDiv(num, kCacheWarps), dim3(32, kCacheWarps), 0, cu_stream>>>(
+          table, grad_rows, grad_values, tags, rows, learning_rate, num, num_sets, num_ways,
+          stride);
+}
+
+template void embedding_cache_lookup_cuda<float>(float*, const int64_t*, int64_t*, float*, float*,
+                                                 int, int64_t, int, int, int, void*, void*);
+template void embedding_cache_lookup_cuda<__half>(__half*, const int64_t*, int64_t*, __half*,
+                                                  __half*, int, int64_t, int, int, int, void*,
+                                                  void*);
+template void embedding_cache_sgd_cuda<float>(float*, const float*, const int64_t*, int64_t*,
+                                              float*, float, int, int, int, int, int, void*,
+                                              void*);
+template void embedding_cache_sgd_cuda<__half>(__half*, const __half*, const int64_t*, int64_t*,
+                                               __half*, float, int, int, int, int, int, void*,
+                                               void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
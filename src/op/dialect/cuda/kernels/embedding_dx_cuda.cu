@@ -1,152 +1,325 @@
 /*
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0
- * Modifications Copyright (c) Facebook, Inc.
- * See: https://github.com/pytorch/pytorch/blob/master/aten/src/ATen/native/cuda/Embedding.cu
  */
 
 /*!
- * \file src/op/dispatch/cuda/kernels/embedding_dx_cuda.cu
- * \brief embedding backward cuda kernel
+ * \file src/op/dialect/cuda/kernels/embedding_dx_cuda.cu
+ * \brief Embedding cuda kernels.
+ *
+ * The backward sorts the indices with their positions, so the rows of dy that go to the same
+ * embedding row become a contiguous segment. The sorted rows are cut into chunks of
+ * kEmbeddingChunk. A segment is summed by the chunk where it starts, and a segment that spans
+ * several chunks additionally takes the partial sums of the following chunks, which are computed
+ * beforehand. Every output row is written once in a fixed order, so the result is deterministic
+ * and free of atomics, and a hot index only costs one partial sum per chunk.
  */
 #include <stdio.h>
+#include <algorithm>
+#include <initializer_list>
+#include <cub/cub.cuh>
 #include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
 namespace raf {
 namespace op {
 namespace cuda {
 
-template void embedding_dense_backward_cuda<float, float>(const float*, float*, const int64_t*, int,
-                                                          int, int, void*, int64_t);
-template void embedding_dense_backward_cuda<__half, __half>(const __half*, __half*, const int64_t*,
-                                                            int, int, int, void*, int64_t);
-template void embedding_dense_backward_cuda<__half2, __half2>(const __half2*, __half2*,
-                                                              const int64_t*, int, int, int, void*,
-                                                              int64_t);
+namespace {
 
-__device__ __forceinline__ unsigned int WARP_BALLOT(int predicate, unsigned int mask = 0xffffffff) {
-  return __ballot_sync(mask, predicate);
-}
+/*! \brief The number of sorted rows that are processed by one thread block. */
+constexpr int kEmbeddingChunk = 32;
+/*! \brief The number of features that are processed by one thread block. */
+constexpr int kEmbeddingThreads = 128;
+/*! \brief The alignment of the buffers in the workspace. */
+constexpr int64_t kWorkspaceAlign = 256;
 
-__host__ __device__ __forceinline__ int CeilDiv(int a, int b) {
+__host__ __forceinline__ int CeilDiv(int64_t a, int64_t b) {
   return (a + b - 1) / b;
 }
 
-__device__ __forceinline__ float add(float a, float b) {
-  return a + b;
+__host__ __forceinline__ int64_t AlignUp(int64_t bytes) {
+  return (bytes + kWorkspaceAlign - 1) / kWorkspaceAlign * kWorkspaceAlign;
 }
 
-__device__ __forceinline__ __half add(__half a, __half b) {
-  return __hadd(a, b);
+/*! \brief Whether all the pointers can be accessed by vectors of n_bytes. */
+__host__ __forceinline__ bool IsAligned(std::initializer_list<const void*> ptrs, int n_bytes) {
+  for (const void* ptr : ptrs) {
+    if (reinterpret_cast<uintptr_t>(ptr) % n_bytes != 0) {
+      return false;
+    }
+  }
+  return true;
 }
 
-__device__ __forceinline__ __half2 add(__half2 a, __half2 b) {
-  return __hadd2(a, b);
+/*! \brief The number of bits to sort the indices in [0, range) by. */
+__host__ __forceinline__ int SortBits(int range) {
+  int bits = 1;
+  while (bits < 63 && (int64_t(1) << bits) < range) {
+    ++bits;
+  }
+  return bits;
+}
+
+/*! \brief The buffers carved out of the workspace of the backward. */
+struct EmbeddingBackwardWorkspace {
+  int64_t* sorted_keys;
+  int* positions;
+  int* sorted_pos;
+  int* flags;
+  int* seg_ids;
+  float* partial;
+  void* temp;
+  size_t temp_bytes;
+
+  EmbeddingBackwardWorkspace(void* workspace, int num, int stride) {
+    char* ptr = static_cast<char*>(workspace);
+    auto take = [&ptr](int64_t bytes) {
+      char* ret = ptr;
+      ptr += AlignUp(bytes);
+      return ret;
+    };
+    sorted_keys = reinterpret_cast<int64_t*>(take(sizeof(int64_t) * num));
+    positions = reinterpret_cast<int*>(take(sizeof(int) * num));
+    sorted_pos = reinterpret_cast<int*>(take(sizeof(int) * num));
+    flags = reinterpret_cast<int*>(take(sizeof(int) * num));
+    seg_ids = reinterpret_cast<int*>(take(sizeof(int) * num));
+    partial =
+        reinterpret_cast<float*>(take(sizeof(float) * CeilDiv(num, kEmbeddingChunk) * stride));
+    temp = ptr;
+    temp_bytes = 0;
+  }
+
+  /*! \brief The bytes of the temporary storage of cub. */
+  static size_t TempBytes(int num, int range) {
+    size_t sort_bytes = 0;
+    size_t scan_bytes = 0;
+    int64_t* keys = nullptr;
+    int* values = nullptr;
+    CUDA_CALL(cub::DeviceRadixSort::SortPairs(nullptr, sort_bytes, keys, keys, values, values, num,
+                                              0, SortBits(range)));
+    CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, scan_bytes, values, values, num));
+    return std::max(sort_bytes, scan_bytes);
+  }
+};
+
+__global__ void EmbeddingInitPositionsKernel(const int64_t* indices, int* positions, int num,
+                                             int range) {
+  int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < num) {
+    int64_t value = indices[i];
+    if (value < 0 || value >= range) {
+      printf("indices[%d] = %lld is out of range (%d)\n", i, static_cast<long long>(value), range);
+      asm("trap;");
+    }
+    positions[i] = i;
+  }
 }
 
-static const int WARP_SIZE = 32;
-static const int BLOCKDIMY = 32;
+/*! \brief Flag the first row of every segment of the sorted indices. */
+__global__ void EmbeddingSegmentFlagsKernel(const int64_t* sorted_keys, int* flags, int num) {
+  int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < num) {
+    flags[i] = i == 0 || sorted_keys[i] != sorted_keys[i - 1];
+  }
+}
 
-/*! \brief The kernel to perform embedding backward.
- * \param indices The input IDs.
- * \param grad The gradient from forward output (dy).
- * \param output The computed gradient by this kernel (dx).
- * \param n The size of indices.
- * \param range The maximum allowed value in indices.
- * \param stride The stride. It is usually the size of hidden stauts.
+/*!
+ * \brief The partial sum of the rows at the beginning of a chunk that continue the segment of the
+ * previous chunk. Chunks that begin with a new segment are skipped.
  */
-template <typename scalar_t, typename accscalar_t>
-__global__ void embedding_backward_feature_kernel(const int64_t* indices,
-                                                  const scalar_t* __restrict__ grad,
-                                                  accscalar_t* __restrict__ output, int n,
-                                                  int range, int stride) {
-  extern __shared__ char buf[];
-  accscalar_t* smem = (accscalar_t*)buf;
-  accscalar_t* my_s = smem + WARP_SIZE * threadIdx.y;
-  int* indices_batch = (int*)(buf + sizeof(accscalar_t) * WARP_SIZE * blockDim.y);
-
-  const int f = threadIdx.x + blockIdx.x * blockDim.x;  // feature_dim
-
-  for (int batch_start = 0; batch_start < n; batch_start += blockDim.x * blockDim.y) {
-    // Entire block cooperates to load a batch of 1024 indices to process
-    int tid = threadIdx.x + threadIdx.y * blockDim.x;
-    if (batch_start + tid < n) {
-      int value = (int)indices[batch_start + tid];
-      if (value >= range) {
-        printf("indices[%d] = %d is out of range (%d)\n", batch_start + tid, value, range);
-        asm("trap;");
+template <typename scalar_t>
+__global__ void EmbeddingPartialSumKernel(const scalar_t* __restrict__ grad,
+                                          const int* __restrict__ sorted_pos,
+                                          const int* __restrict__ flags, float* partial, int num,
+                                          int stride) {
+  const int chunk = blockIdx.x;
+  const int f = blockIdx.y * blockDim.x + threadIdx.x;
+  const int start = chunk * kEmbeddingChunk;
+  const int end = min(start + kEmbeddingChunk, num);
+  if (f >= stride || flags[start]) {
+    return;
+  }
+  float acc = 0.0f;
+  for (int i = start; i < end && !flags[i]; ++i) {
+    acc += ToFloat(grad[static_cast<int64_t>(sorted_pos[i]) * stride + f]);
+  }
+  partial[static_cast<int64_t>(chunk) * stride + f] = acc;
+}
+
+/*!
+ * \brief Sum the segments that start in a chunk. The dense gradient writes the sum of index k
+ * to row k, and the sparse gradient writes it to the row of the segment id, with the index in
+ * rows.
+ */
+template <typename scalar_t, bool sparse>
+__global__ void EmbeddingSegmentSumKernel(const scalar_t* __restrict__ grad,
+                                          const int64_t* __restrict__ sorted_keys,
+                                          const int* __restrict__ sorted_pos,
+                                          const int* __restrict__ flags,
+                                          const int* __restrict__ seg_ids,
+                                          const float* __restrict__ partial, scalar_t* output,
+                                          int64_t* rows, int num, int stride) {
+  const int chunk = blockIdx.x;
+  const int num_chunks = gridDim.x;
+  const int f = blockIdx.y * blockDim.x + threadIdx.x;
+  const int start = chunk * kEmbeddingChunk;
+  const int end = min(start + kEmbeddingChunk, num);
+  if (f >= stride) {
+    return;
+  }
+  // Skip the rows that continue the segment of the previous chunk.
+  int i = start;
+  while (i < end && !flags[i]) {
+    ++i;
+  }
+  while (i < end) {
+    const int64_t key = sorted_keys[i];
+    const int64_t dst = sparse ? seg_ids[i] : key;
+    float acc = 0.0f;
+    int j = i;
+    do {
+      acc += ToFloat(grad[static_cast<int64_t>(sorted_pos[j]) * stride + f]);
+      ++j;
+    } while (j < end && !flags[j]);
+    if (j == end) {
+      for (int c = chunk + 1; c < num_chunks && !flags[c * kEmbeddingChunk]; ++c) {
+        acc += partial[static_cast<int64_t>(c) * stride + f];
       }
-      indices_batch[tid] = value;
     }
+    output[dst * stride + f] = FromFloat<scalar_t>(acc);
+    if (sparse && blockIdx.y == 0 && threadIdx.x == 0) {
+      rows[dst] = key;
+    }
+    i = j;
+  }
+}
 
-    int batch_end =
-        batch_start + blockDim.x * blockDim.y < n ? batch_start + blockDim.x * blockDim.y : n;
+/*! \brief Sort the indices and sum the segments of the sorted rows of grad into output. */
+template <typename scalar_t, bool sparse>
+void EmbeddingSegmentSum(const scalar_t* grad, scalar_t* output, int64_t* rows,
+                         const int64_t* indices, int num, int range, int stride, void* workspace,
+                         cudaStream_t stream) {
+  EmbeddingBackwardWorkspace ws(workspace, num, stride);
+  ws.temp_bytes = EmbeddingBackwardWorkspace::TempBytes(num, range);
+  const int threads = 256;
+  const int blocks = CeilDiv(num, threads);
+  EmbeddingInitPositionsKernel<<<blocks, threads, 0, stream>>>(indices, ws.positions, num, range);
+  CUDA_CALL(cub::DeviceRadixSort::SortPairs(ws.temp, ws.temp_bytes, indices, ws.sorted_keys,
+                                            ws.positions, ws.sorted_pos, num, 0, SortBits(range),
+                                            stream));
+  EmbeddingSegmentFlagsKernel<<<blocks, threads, 0, stream>>>(ws.sorted_keys, ws.flags, num);
+  if (sparse) {
+    CUDA_CALL(
+        cub::DeviceScan::ExclusiveSum(ws.temp, ws.temp_bytes, ws.flags, ws.seg_ids, num, stream));
+  }
+  dim3 grid(CeilDiv(num, kEmbeddingChunk), CeilDiv(stride, kEmbeddingThreads));
+  EmbeddingPartialSumKernel<scalar_t>
+      <<<grid, kEmbeddingThreads, 0, stream>>>(grad, ws.sorted_pos, ws.flags, ws.partial, num,
+                                               stride);
+  EmbeddingSegmentSumKernel<scalar_t, sparse><<<grid, kEmbeddingThreads, 0, stream>>>(
+      grad, ws.sorted_keys, ws.sorted_pos, ws.flags, ws.seg_ids, ws.partial, output, rows, num,
+      stride);
+}
 
-    // Loop over the batch of <= 1024 loaded indices in chunks of blockDim.y = 32
-    for (int chunk_start = batch_start; chunk_start < batch_end; chunk_start += blockDim.y) {
-      // This does double duty:  it makes sure indices_batch is ready, and it makes sure
-      // match-group leaders are done with their accumulates before other warps start loading
-      // again.
-      __syncthreads();
+/*! \brief One row of the output per thread block. */
+template <typename scalar_t, int kVec>
+__global__ void EmbeddingPositionKernel(const scalar_t* __restrict__ x,
+                                        const int64_t* __restrict__ indices,
+                                        const scalar_t* __restrict__ position,
+                                        const int64_t* __restrict__ position_ids,
+                                        scalar_t* __restrict__ out, int range, int position_range,
+                                        int stride) {
+  using Vec = AlignedVector<scalar_t, kVec>;
+  const int64_t row = blockIdx.x;
+  const int64_t index = indices[row];
+  const int64_t position_id = position_ids[row];
+  if (index < 0 || index >= range || position_id < 0 || position_id >= position_range) {
+    printf("indices[%lld] = %lld or position_ids[%lld] = %lld is out of range (%d, %d)\n",
+           static_cast<long long>(row), static_cast<long long>(index), static_cast<long long>(row),
+           static_cast<long long>(position_id), range, position_range);
+    asm("trap;");
+  }
+  for (int col = threadIdx.x * kVec; col < stride; col += blockDim.x * kVec) {
+    Vec x_vec = LoadVector<scalar_t, kVec>(x, index * stride + col);
+    Vec p_vec = LoadVector<scalar_t, kVec>(position, position_id * stride + col);
+    Vec out_vec;
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      out_vec.val[k] = FromFloat<scalar_t>(ToFloat(x_vec.val[k]) + ToFloat(p_vec.val[k]));
+    }
+    StoreVector<scalar_t, kVec>(out, row * stride + col, out_vec);
+  }
+}
 
-      int n_this_chunk =
-          (batch_end - chunk_start) < blockDim.y ? (batch_end - chunk_start) : blockDim.y;
+}  // namespace
 
-      int src_row = chunk_start + threadIdx.y;
-      int dst_row = indices_batch[src_row - batch_start];  // This warp's target row in grad_weight
+int64_t embedding_backward_workspace(int num, int range, int stride) {
+  int64_t bytes = AlignUp(sizeof(int64_t) * num) + 4 * AlignUp(sizeof(int) * num) +
+                  AlignUp(sizeof(float) * CeilDiv(num, kEmbeddingChunk) * stride);
+  return bytes + EmbeddingBackwardWorkspace::TempBytes(num, range);
+}
 
-      // All warps load their smem segments with incoming grad data
-      if (src_row < n && f < stride) {
-        my_s[threadIdx.x] = static_cast<accscalar_t>(grad[src_row * stride + f]);
-      }
+template <typename scalar_t>
+void embedding_dense_backward_cuda(const scalar_t* grad, scalar_t* output, const int64_t* indices,
+                                   int num, int range, int stride, void* workspace, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  CUDA_CALL(cudaMemsetAsync(output, 0, sizeof(scalar_t) * range * stride, cu_stream));
+  if (num == 0) {
+    return;
+  }
+  EmbeddingSegmentSum<scalar_t, false>(grad, output, nullptr, indices, num, range, stride,
+                                       workspace, cu_stream);
+}
 
-      __syncthreads();
-
-      // To ensure determinism, we can't just have each warp add its grad data to its dst_row.
-      // We need to check if any other warps pulled grad data targeting dst_row.
-      // If so, we elect the first warp in each matching group as the leader.
-      // Each leader warp serializes the accumulates targeting dst_row in shared memory,
-      // then finishes by adding the accumulated buffer to dst_row in grad_weight.
-      if (src_row < n)  // Per-warp exit condition, safe with ballot_sync
-      {
-        int match_found_this_thread =
-            (dst_row == indices_batch[chunk_start - batch_start + threadIdx.x]);
-        if (threadIdx.x >= n_this_chunk) match_found_this_thread = 0;
-        unsigned int matchmask = WARP_BALLOT(match_found_this_thread);
-        int first_remaining_peer = __ffs(matchmask) - 1;
-
-        if (threadIdx.y == first_remaining_peer)  // Nominate lowest-indexed warp as the leader
-        {
-          matchmask ^= (1 << first_remaining_peer);
-          while (matchmask) {
-            first_remaining_peer = __ffs(matchmask) - 1;
-            my_s[threadIdx.x] =
-                add(my_s[threadIdx.x], smem[threadIdx.x + WARP_SIZE * first_remaining_peer]);
-            matchmask ^= (1 << first_remaining_peer);
-          }
-          if (f < stride) {
-            output[dst_row * stride + f] =
-                add(output[dst_row * stride + f], static_cast<scalar_t>(my_s[threadIdx.x]));
-          }
-        }
-      }
-    }
+template <typename scalar_t>
+void embedding_sparse_backward_cuda(const scalar_t* grad, int64_t* rows, scalar_t* values,
+                                    const int64_t* indices, int num, int range, int stride,
+                                    void* workspace, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  // The rows after the distinct indices are padded with -1 and zero values.
+  CUDA_CALL(cudaMemsetAsync(rows, 0xFF, sizeof(int64_t) * num, cu_stream));
+  CUDA_CALL(cudaMemsetAsync(values, 0, sizeof(scalar_t) * num * stride, cu_stream));
+  if (num == 0) {
+    return;
   }
+  EmbeddingSegmentSum<scalar_t, true>(grad, values, rows, indices, num, range, stride, workspace,
+                                      cu_stream);
 }
 
-template <typename scalar_t, typename accscalar_t>
-void embedding_dense_backward_cuda(const scalar_t* grad, accscalar_t* output,
-                                   const int64_t* indices, int num, int range, int stride,
-                                   void* stream, int64_t element) {
-  dim3 grid(CeilDiv(stride, (int64_t)WARP_SIZE));
-  dim3 block(WARP_SIZE, BLOCKDIMY);
-  CUDA_CALL(cudaMemsetAsync(output, 0, element * sizeof(accscalar_t), static_cast<cudaStream_t>(stream)));
-  embedding_backward_feature_kernel<scalar_t, accscalar_t>
-      <<<grid, block,
-         sizeof(accscalar_t) * WARP_SIZE * BLOCKDIMY + sizeof(int) * WARP_SIZE * BLOCKDIMY,
-         static_cast<cudaStream_t>(stream)>>>(
-          indices, grad, output, num, range, stride);
+template <typename scalar_t>
+void embedding_position_cuda(const scalar_t* x, const int64_t* indices, const scalar_t* position,
+                             const int64_t* position_ids, scalar_t* out, int num, int range,
+                             int position_range, int stride, void* stream) {
+  if (num == 0) {
+    return;
+  }
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  constexpr int kVec = 16 / sizeof(scalar_t);
+  if (stride % kVec == 0 && IsAligned({x, position, out}, 16)) {
+    int threads = std::min(kEmbeddingThreads, std::max(32, CeilDiv(stride / kVec, 32) * 32));
+    EmbeddingPositionKernel<scalar_t, kVec><<<num, threads, 0, cu_stream>>>(
+        x, indices, position, position_ids, out, range, position_range, stride);
+  } else {
+    int threads = std::min(kEmbeddingThreads, std::max(32, CeilDiv(stride, 32) * 32));
+    EmbeddingPositionKernel<scalar_t, 1><<<num, threads, 0, cu_stream>>>(
+        x, indices, position, position_ids, out, range, position_range, stride);
+  }
 }
 
+template void embedding_dense_backward_cuda<float>(const float*, float*, const int64_t*, int, int,
+                                                   int, void*, void*);
+template void embedding_dense_backward_cuda<__half>(const __half*, __half*, const int64_t*, int,
+                                                    int, int, void*, void*);
+template void embedding_sparse_backward_cuda<float>(const float*, int64_t*, float*,
+                                                    const int64_t*, int, int, int, void*, void*);
+template void embedding_sparse_backward_cuda<__half>(const __half*, int64_t*, __half*,
+                                                     const int64_t*, int, int, int, void*, void*);
+template void embedding_position_cuda<float>(const float*, const int64_t*, const float*,
+                                             const int64_t*, float*, int, int, int, int, void*);
+template void embedding_position_cuda<__half>(const __half*, const int64_t*, const __half*,
+                                              const int64_t*, __half*, int, int, int, int, void*);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
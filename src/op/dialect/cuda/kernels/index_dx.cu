@@ -0,0 +1,241 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/index_dx.cu
+ * \brief The backward cuda kernels of take, gather, adv_index and scatter.
+ *
+ * The gradients of take, gather and adv_index sum the rows of dy into the rows of dx they were
+ * read from. Each row of dy is given the flat index of its destination row, and the rows are
+ * summed by the embedding backward, which sorts them by the destination and reduces the segments
+ * without atomics. So the gradients are deterministic and a hot index costs no contention.
+ */
+#include <stdio.h>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kThreads = 256;
+/*! \brief The alignment of the buffers in the workspace. */
+constexpr int64_t kWorkspaceAlign = 256;
+
+__host__ __forceinline__ int64_t CeilDiv(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+__host__ __forceinline__ int64_t AlignUp(int64_t bytes) {
+  return (bytes + kWorkspaceAlign - 1) / kWorkspaceAlign * kWorkspaceAlign;
+}
+
+__device__ __forceinline__ int64_t Numel(const IndexShape& shape) {
+  int64_t n = 1;
+  for (int d = 0; d < shape.ndim; ++d) {
+    n *= shape.dims[d];
+  }
+  return n;
+}
+
+__device__ __forceinline__ void CheckIndex(int64_t value, int64_t range) {
+  if (value < 0 || value >= range) {
+    printf("index %lld is out of range (%lld)\n", static_cast<long long>(value),
+           static_cast<long long>(range));
+    asm("trap;");
+  }
+}
+
+/*!
+ * \brief The destination of element e of the indices of gather, i.e., its own coordinates in the
+ * data with the coordinate on axis replaced by its value.
+ */
+template <typename I>
+__device__ __forceinline__ int64_t GatherDestination(const I* indices, int64_t e,
+                                                     const IndexShape& index_shape,
+                                                     const IndexShape& data_shape, int axis) {
+  int64_t dst = 0, stride = 1, rest = e;
+  for (int d = index_shape.ndim - 1; d >= 0; --d) {
+    int64_t coord = rest % index_shape.dims[d];
+    rest /= index_shape.dims[d];
+    if (d == axis) {
+      coord = indices[e];
+      CheckIndex(coord, data_shape.dims[d]);
+    }
+    dst += coord * stride;
+    stride *= data_shape.dims[d];
+  }
+  return dst;
+}
+
+/*! \brief The destination rows of the rows of dy of take, which is [outer, num, inner]. */
+template <typename I>
+__global__ void TakeKeysKernel(const I* indices, int64_t* keys, int64_t num, int64_t outer,
+                               int64_t range, bool wrap) {
+  int64_t i = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (i >= outer * num) {
+    return;
+  }
+  int64_t value = indices[i % num];
+  if (wrap) {
+    value = (value % range + range) % range;
+  } else {
+    value = min(max(value, int64_t(0)), range - 1);
+  }
+  keys[i] = i / num * range + value;
+}
+
+template <typename I>
+__global__ void GatherKeysKernel(const I* indices, int64_t* keys, IndexShape index_shape,
+                                 IndexShape data_shape, int axis) {
+  int64_t e = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (e < Numel(index_shape)) {
+    keys[e] = GatherDestination(indices, e, index_shape, data_shape, axis);
+  }
+}
+
+/*!
+ * \brief The destination rows of the rows of dy of adv_index. The row at coordinates c of the
+ * broadcast shape goes to the row (indices[0][c], indices[1][c], ...) of the indexed dims.
+ */
+__global__ void AdvIndexKeysKernel(AdvIndices indices, int64_t* keys) {
+  const IndexShape& bshape = indices.broadcast_shape;
+  int64_t b = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (b >= Numel(bshape)) {
+    return;
+  }
+  int64_t key = 0;
+  for (int k = 0; k < indices.num; ++k) {
+    // The index tensors are right-aligned to the broadcast shape.
+    const IndexShape& shape = indices.shapes[k];
+    int64_t offset = 0, stride = 1, rest = b;
+    for (int d = bshape.ndim - 1, s = shape.ndim - 1; s >= 0; --d, --s) {
+      int64_t coord = rest % bshape.dims[d];
+      rest /= bshape.dims[d];
+      offset += (shape.dims[s] == 1 ? 0 : coord) * stride;
+      stride *= shape.dims[s];
+    }
+    int64_t value = indices.is_int64[k] ? static_cast<const int64_t*>(indices.data[k])[offset]
+                                        : static_cast<const int32_t*>(indices.data[k])[offset];
+    int64_t range = indices.ranges[k];
+    value = value < 0 ? value + range : value;
+    CheckIndex(value, range);
+    key = key * range + value;
+  }
+  keys[b] = key;
+}
+
+/*! \brief Zero the gradient of the elements of x that are overwritten by the scatter. */
+template <typename T, typename I>
+__global__ void ScatterZeroKernel(T* dx, const I* index, IndexShape index_shape,
+                                  IndexShape x_shape, int axis) {
+  int64_t e = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (e < Numel(index_shape)) {
+    dx[GatherDestination(index, e, index_shape, x_shape, axis)] = FromFloat<T>(0.0f);
+  }
+}
+
+/*! \brief Sum the rows of dy into dx by the keys at the beginning of the workspace. */
+template <typename T>
+void IndexSegmentSum(const T* dy, T* dx, int num, int range, int stride, void* workspace,
+                     void* stream) {
+  const int64_t* keys = static_cast<const int64_t*>(workspace);
+  void* ws = static_cast<char*>(workspace) + AlignUp(sizeof(int64_t) * num);
+  embedding_dense_backward_cuda<T>(dy, dx, keys, num, range, stride, ws, stream);
+}
+
+}  // namespace
+
+int64_t index_backward_workspace(int num, int range, int stride) {
+  return AlignUp(sizeof(int64_t) * num) + embedding_backward_workspace(num, range, stride);
+}
+
+template <typename T, typename I>
+void take_backward_cuda(const T* dy, T* dx, const I* indices, int num_indices, int outer,
+                        int range, int inner, bool wrap, void* workspace, void* stream) {
+  int64_t num = static_cast<int64_t>(outer) * num_indices;
+  if (num > 0) {
+    cudaStream_t s = static_cast<cudaStream_t>(stream);
+    TakeKeysKernel<I><<<CeilDiv(num, kThreads), kThreads, 0, s>>>(
+        indices, static_cast<int64_t*>(workspace), num_indices, outer, range, wrap);
+  }
+  IndexSegmentSum<T>(dy, dx, num, outer * range, inner, workspace, stream);
+}
+
+template <typename T, typename I>
+void gather_backward_cuda(const T* dy, T* dx, const I* indices, IndexShape index_shape,
+                          IndexShape data_shape, int axis, void* workspace, void* stream) {
+  int64_t num = 1, range = 1;
+  for (int d = 0; d < index_shape.ndim; ++d) {
+    num *= index_shape.dims[d];
+    range *= data_shape.dims[d];
+  }
+  if (num > 0) {
+    cudaStream_t s = static_cast<cudaStream_t>(stream);
+    GatherKeysKernel<I><<<CeilDiv(num, kThreads), kThreads, 0, s>>>(
+        indices, static_cast<int64_t*>(workspace), index_shape, data_shape, axis);
+  }
+  IndexSegmentSum<T>(dy, dx, num, range, 1, workspace, stream);
+}
+
+template <typename T>
+void adv_index_backward_cuda(const T* dy, T* dx, const AdvIndices& indices, int inner,
+                             void* workspace, void* stream) {
+  int64_t num = 1, range = 1;
+  for (int d = 0; d < indices.broadcast_shape.ndim; ++d) {
+    num *= indices.broadcast_shape.dims[d];
+  }
+  for (int k = 0; k < indices.num; ++k) {
+    range *= indices.ranges[k];
+  }
+  if (num > 0) {
+    cudaStream_t s = static_cast<cudaStream_t>(stream);
+    AdvIndexKeysKernel<<<CeilDiv(num, kThreads), kThreads, 0, s>>>(
+        indices, static_cast<int64_t*>(workspace));
+  }
+  IndexSegmentSum<T>(dy, dx, num, range, inner, workspace, stream);
+}
+
+template <typename T, typename I>
+void scatter_backward_cuda(const T* dy, T* dx, const I* index, IndexShape index_shape,
+                           IndexShape x_shape, int axis, void* stream) {
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  int64_t numel = 1, num = 1;
+  for (int d = 0; d < x_shape.ndim; ++d) {
+    numel *= x_shape.dims[d];
+    num *= index_shape.dims[d];
+  }
+  CUDA_CALL(cudaMemcpyAsync(dx, dy, sizeof(T) * numel, cudaMemcpyDeviceToDevice, s));
+  if (num > 0) {
+    ScatterZeroKernel<T, I>
+        <<<CeilDiv(num, kThreads), kThreads, 0, s>>>(dx, index, index_shape, x_shape, axis);
+  }
+}
+
+#define RAF_INDEX_DX_INSTANTIATE(T, I)                                                         \
+  template void take_backward_cuda<T, I>(const T*, T*, const I*, int, int, int, int, bool,     \
+                                         void*, void*);                                        \
+  template void gather_backward_cuda<T, I>(const T*, T*, const I*, IndexShape, IndexShape, int, \
+                                           void*, void*);                                      \
+  template void scatter_backward_cuda<T, I>(const T*, T*, const I*, IndexShape, IndexShape,    \
+                                            int, void*);
+
+RAF_INDEX_DX_INSTANTIATE(float, int32_t);
+RAF_INDEX_DX_INSTANTIATE(float, int64_t);
+RAF_INDEX_DX_INSTANTIATE(__half, int32_t);
+RAF_INDEX_DX_INSTANTIATE(__half, int64_t);
+
+#undef RAF_INDEX_DX_INSTANTIATE
+
+template void adv_index_backward_cuda<float>(const float*, float*, const AdvIndices&, int, void*,
+                                             void*);
+template void adv_index_backward_cuda<__half>(const __half*, __half*, const AdvIndices&, int,
+                                              void*, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
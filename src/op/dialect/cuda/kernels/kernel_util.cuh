@@ -17,10 +17,86 @@ namespace raf {
 namespace op {
 namespace cuda {
 
-template <typename scalar_t, typename accscalar_t>
-void embedding_dense_backward_cuda(const scalar_t* grad, accscalar_t* output,
-                                   const int64_t* indices, int num, int range,
-                                   int stride, void* stream, int64_t element);
+/*! \brief The workspace size in bytes of the embedding backward of num indices in [0, range). */
+int64_t embedding_backward_workspace(int num, int range, int stride);
+
+template <typename scalar_t>
+void embedding_dense_backward_cuda(const scalar_t* grad, scalar_t* output, const int64_t* indices,
+                                   int num, int range, int stride, void* workspace, void* stream);
+
+template <typename scalar_t>
+void embedding_sparse_backward_cuda(const scalar_t* grad, int64_t* rows, scalar_t* values,
+                                    const int64_t* indices, int num, int range, int stride,
+                                    void* workspace, void* stream);
+
+template <typename scalar_t>
+void embedding_position_cuda(const scalar_t* x, const int64_t* indices, const scalar_t* position,
+                             const int64_t* position_ids, scalar_t* out, int num, int range,
+                             int position_range, int stride, void* stream);
+
+/*! \brief The workspace size in bytes of the embedding cache lookup of num indices. */
+int64_t embedding_cache_lookup_workspace(int num);
+
+/*! \brief The workspace size in bytes of the embedding cache SGD of num indices. */
+int64_t embedding_cache_sgd_workspace(int num, int range, int stride, int elem_bytes);
+
+template <typename scalar_t>
+void embedding_cache_lookup_cuda(scalar_t* table, const int64_t* indices, int64_t* tags,
+                                 scalar_t* rows, scalar_t* out, int num, int64_t range,
+                                 int num_sets, int num_ways, int stride, void* workspace,
+                                 void* stream);
+
+template <typename scalar_t>
+void embedding_cache_sgd_cuda(scalar_t* table, const scalar_t* grad, const int64_t* indices,
+                              int64_t* tags, scalar_t* rows, float learning_rate, int num,
+                              int range, int num_sets, int num_ways, int stride, void* workspace,
+                              void* stream);
+
+/*! \brief The maximal rank of the tensors of the index backward kernels. */
+constexpr int kIndexMaxDims = 8;
+
+/*! \brief A tensor shape that is passed to the index backward kernels by value. */
+struct IndexShape {
+  int ndim;
+  int64_t dims[kIndexMaxDims];
+};
+
+/*! \brief The index tensors of adv_index, which are broadcast to broadcast_shape. */
+struct AdvIndices {
+  int num;
+  const void* data[kIndexMaxDims];
+  bool is_int64[kIndexMaxDims];
+  IndexShape shapes[kIndexMaxDims];
+  IndexShape broadcast_shape;
+  /*! \brief The sizes of the dims of the data that are indexed. */
+  int64_t ranges[kIndexMaxDims];
+};
+
+/*! \brief The workspace size in bytes of the index backward of num rows into range rows. */
+int64_t index_backward_workspace(int num, int range, int stride);
+
+/*!
+ * \brief The gradient of take, where dy is [outer, num_indices, inner] and dx is
+ * [outer, range, inner]. The indices are clipped, or wrapped if wrap is true.
+ */
+template <typename T, typename I>
+void take_backward_cuda(const T* dy, T* dx, const I* indices, int num_indices, int outer,
+                        int range, int inner, bool wrap, void* workspace, void* stream);
+
+/*! \brief The gradient of gather along axis, where dy is of the shape of the indices. */
+template <typename T, typename I>
+void gather_backward_cuda(const T* dy, T* dx, const I* indices, IndexShape index_shape,
+                          IndexShape data_shape, int axis, void* workspace, void* stream);
+
+/*! \brief The gradient of adv_index, where each indexed row of dx has inner elements. */
+template <typename T>
+void adv_index_backward_cuda(const T* dy, T* dx, const AdvIndices& indices, int inner,
+                             void* workspace, void* stream);
+
+/*! \brief The gradient of x of scatter, which is dy except at the overwritten elements. */
+template <typename T, typename I>
+void scatter_backward_cuda(const T* dy, T* dx, const I* index, IndexShape index_shape,
+                           IndexShape x_shape, int axis, void* stream);
 
 template <typename T>
 void multi_tensor_lans_cuda(int chunk_size, std::vector<T*> tensor_lists, const float lr,
@@ -33,6 +109,257 @@ void multi_tensor_lans_cuda(int chunk_size, std::vector<T*> tensor_lists, const
                             float* param_norm_tensor, float* update_m_norm, float* q_norm_tensor,
                             int max_chunks_per_tensor);
 
+template <typename in_t, typename out_t>
+void multi_tensor_cast_cuda(int chunk_size, std::vector<void*> tensor_lists,
+                            const std::vector<int> numels, void* stream);
+
+/*! \brief The workspace size in bytes of the global norm of tensors of numels elements. */
+int64_t global_norm_workspace(int chunk_size, const std::vector<int>& numels);
+
+/*!
+ * \brief The L2 norm of all elements of the tensors as a float32 scalar, and whether the norm is
+ * inf or nan. The tensors are of type T.
+ */
+template <typename T>
+void global_norm_and_check_cuda(int chunk_size, std::vector<void*> tensor_list,
+                                const std::vector<int>& numels, float* norm, bool* found_inf,
+                                void* workspace, void* stream);
+
+/*
+ * The optimizers below clip the gradients to max_grad_norm given their global norm grad_norm,
+ * and skip the step if grad_norm is inf or nan. Both are off if grad_norm is null. If loss_scale
+ * is not null, the gradients and grad_norm are unscaled by it.
+ */
+template <typename grad_t>
+void multi_tensor_sgd_cuda(int chunk_size, std::vector<void*> tensor_lists, float lr,
+                           float momentum, bool fp16_params, const float* grad_norm,
+                           float max_grad_norm, const float* loss_scale,
+                           const std::vector<int> numels, void* stream);
+
+template <typename grad_t>
+void multi_tensor_adam_cuda(int chunk_size, std::vector<void*> tensor_lists, const float* step,
+                            float lr, float beta1, float beta2, float eps, float weight_decay,
+                            bool bias_correction, int mode, bool fp16_params,
+                            const float* grad_norm, float max_grad_norm,
+                            const float* loss_scale, const std::vector<int> numels,
+                            void* stream);
+
+/*!
+ * \brief Update the loss scale of the dynamic loss scaling on the device. The scale is multiplied
+ * by backoff_factor (but not below min_scale) if grad_norm is inf or nan, and by growth_factor
+ * after growth_interval steps in a row without overflow, which are counted by good_steps.
+ */
+void update_loss_scale_cuda(const float* grad_norm, const float* loss_scale,
+                            const float* good_steps, float* new_loss_scale, float* new_good_steps,
+                            float growth_factor, float backoff_factor, int growth_interval,
+                            float min_scale, void* stream);
+
+/*! \brief The maximal head dimension supported by the fused attention kernels. */
+constexpr int kAttentionMaxHeadDim = 128;
+
+template <typename T>
+void attention_forward_cuda(const T* q, const T* k, const T* v, T* out, float* lse,
+                            int64_t* rng_state, int batch, int seq_q, int seq_k, int head_dim,
+                            float scale, bool causal, float p, uint64_t seed, void* stream);
+
+template <typename T>
+void attention_backward_cuda(const T* q, const T* k, const T* v, const T* out, const T* dy,
+                             const float* lse, const int64_t* rng_state, T* dq, T* dk, T* dv,
+                             float* delta, int batch, int seq_q, int seq_k, int head_dim,
+                             float scale, bool causal, float p, void* stream);
+
+/*! \brief The maximal row size whose residual sum is cached in shared memory by the fused add,
+ * dropout and layer norm forward. Larger rows read the sum back from z instead. */
+constexpr int kAddDropoutLayerNormMaxCachedCols = 8192;
+
+/*! \brief The workspace size in bytes of the partial gradients of gamma and beta. */
+int64_t add_dropout_layer_norm_gamma_beta_workspace(int n2);
+
+template <typename T>
+void add_dropout_layer_norm_forward_cuda(const T* x, const T* residual, const T* gamma,
+                                         const T* beta, T* y, T* z, float* mean, float* invvar,
+                                         int64_t* rng_state, int n1, int n2, float p, float eps,
+                                         uint64_t seed, void* stream);
+
+template <typename T>
+void add_dropout_layer_norm_backward_cuda(const T* dy, const T* dz, const T* z, const T* gamma,
+                                          const float* mean, const float* invvar,
+                                          const int64_t* rng_state, T* dx, T* dresidual,
+                                          T* dgamma, T* dbeta, float* workspace, int n1, int n2,
+                                          float p, void* stream);
+
+/*! \brief The workspace size in bytes of the row rstd and the partial gradients of gamma. */
+int64_t rms_norm_backward_workspace(int n1, int n2);
+
+template <typename T>
+void rms_norm_forward_cuda(const T* x, const T* gamma, T* y, int n1, int n2, float eps,
+                           void* stream);
+
+template <typename T>
+void rms_norm_backward_cuda(const T* x, const T* gamma, const T* dy, T* dx, T* dgamma,
+                            float* workspace, int n1, int n2, float eps, void* stream);
+
+/*!
+ * \brief Rotate x viewed as [outer, seq_len, inner, head_dim] by the tables cos and sin in shape
+ * [seq_len, rot_half].
+ */
+template <typename T>
+void rotary_embedding_cuda(const T* x, const T* cos, const T* sin, T* y, int64_t numel,
+                           int head_dim, int rot_half, int seq_len, int64_t inner, bool interleaved,
+                           void* stream);
+
+/*! \brief The workspace size in bytes of the softmax cross entropy of num_rows rows. */
+int64_t softmax_cross_entropy_workspace(int64_t num_rows);
+
+/*!
+ * \brief The mean softmax cross entropy over the rows whose labels are not ignore_index, where
+ * the loss is a float32 scalar. The labels out of [0, num_classes) are ignored as well.
+ */
+template <typename T, typename L>
+void softmax_cross_entropy_forward_cuda(const T* logits, const L* labels, float* loss,
+                                        int64_t num_rows, int64_t num_classes,
+                                        int64_t ignore_index, float smoothing, void* workspace,
+                                        void* stream);
+
+/*! \brief The gradient of the softmax cross entropy, which recomputes the softmax of the rows. */
+template <typename T, typename L>
+void softmax_cross_entropy_backward_cuda(const float* dy, const T* logits, const L* labels, T* dx,
+                                         int64_t num_rows, int64_t num_classes,
+                                         int64_t ignore_index, float smoothing, void* workspace,
+                                         void* stream);
+
+/*! \brief The workspace size in bytes of the top-k of num_rows rows of num_cols elements. */
+template <typename T>
+int64_t topk_workspace(int num_rows, int num_cols, bool is_ascend);
+
+/*!
+ * \brief The first k elements of each row of num_cols elements after sorting, and their positions
+ * in the row. values or indices may be null if they are not needed. Sort and argsort are top-k
+ * with k = num_cols.
+ */
+template <typename T, typename I>
+void topk_cuda(const T* data, T* values, I* indices, int num_rows, int num_cols, int k,
+               bool is_ascend, void* workspace, void* stream);
+
+/*! \brief The reductions of the reduce kernels. Mean and l2norm are sums with an epilogue. */
+enum class ReduceMode { kSum, kMean, kMax, kMin, kL2Norm };
+
+/*! \brief The workspace size in bytes of the reduction of [outer, n, inner] over n. */
+int64_t reduce_workspace(int64_t outer, int64_t n, int64_t inner);
+
+/*!
+ * \brief Reduce x of [outer, n, inner] over n into out of [outer, inner]. The strategy is chosen by
+ * the shape, and the values are accumulated in float.
+ */
+template <typename T>
+void reduce_cuda(const T* x, T* out, int64_t outer, int64_t n, int64_t inner, ReduceMode mode,
+                 void* workspace, void* stream);
+
+/*!
+ * \brief Move the boxes whose scores are greater than score_threshold and whose class ids are
+ * non-negative to the front of each batch. The other boxes and their indices are -1.
+ */
+template <typename T>
+void get_valid_counts_cuda(const T* data, const float* score_threshold, int* valid_count, T* out,
+                           int* out_indices, int batch, int num_anchors, int box_size,
+                           int id_index, int score_index, void* stream);
+
+/*! \brief The attributes of the non-maximum suppression. */
+struct NmsAttrs {
+  int top_k;
+  int coord_start;
+  int score_index;
+  int id_index;
+  bool force_suppress;
+  bool invalid_to_bottom;
+};
+
+/*! \brief The workspace size in bytes of the non-maximum suppression. */
+template <typename T>
+int64_t nms_workspace(int batch, int num_anchors, int box_size);
+
+/*!
+ * \brief The non-maximum suppression of the first valid_count boxes of each batch. If valid_count
+ * is null, the boxes are selected by score_threshold as get_valid_counts does, and indices must be
+ * null as well. If out_indices is not null, the indices of the kept boxes are written to it and
+ * their number to out_count instead of the boxes to out.
+ */
+template <typename T>
+void nms_cuda(const T* data, const int* valid_count, const int* indices,
+              const float* score_threshold, const int* max_output_size,
+              const float* iou_threshold, T* out, int* out_indices, int* out_count, int batch,
+              int num_anchors, int box_size, NmsAttrs attrs, void* workspace, void* stream);
+
+/*! \brief The roi align of NCHW data in the avg or max mode. */
+template <typename T>
+void roi_align_forward_cuda(const T* data, const T* rois, T* out, int channels, int height,
+                            int width, int num_rois, int pooled_h, int pooled_w,
+                            float spatial_scale, int sample_ratio, bool max_mode, void* stream);
+
+/*! \brief The gradient of the avg roi align of NCHW data, which does not use atomics. */
+template <typename T>
+void roi_align_backward_cuda(const T* dy, const T* rois, T* dx, int batch, int channels,
+                             int height, int width, int num_rois, int pooled_h, int pooled_w,
+                             float spatial_scale, int sample_ratio, void* stream);
+
+/*!
+ * \brief The Philox dropout of n elements. The (seed, offset) state is written to state, or read
+ * from in_state instead of seed and offset if in_state is not null.
+ */
+template <typename T>
+void dropout_forward_cuda(const T* x, T* y, int64_t* state, const int64_t* in_state, int64_t n,
+                          float p, uint64_t seed, uint64_t offset, void* stream);
+
+/*! \brief The dropout backward that regenerates the mask from the state of the forward. */
+template <typename T>
+void dropout_backward_cuda(const T* dy, T* dx, const int64_t* state, int64_t n, float p,
+                           void* stream);
+
+/*!
+ * \brief Fill the n elements of out with low + scale * u, where u is uniform in [0, 1) and drawn
+ * from the Threefry key of key_size words by the position of the element.
+ */
+template <typename T>
+void threefry_uniform_cuda(const uint64_t* key, int key_size, T* out, int64_t n, float low,
+                           float scale, void* stream);
+
+/*! \brief Fill the n elements of out with normal numbers drawn as threefry_uniform_cuda does. */
+template <typename T>
+void threefry_normal_cuda(const uint64_t* key, int key_size, T* out, int64_t n, float mean,
+                          float stddev, void* stream);
+
+/*!
+ * \brief The shapes and the attributes of a depthwise conv2d, where out_channels is a multiple
+ * of in_channels and the output channel oc reads the input channel oc / multiplier.
+ */
+struct DepthwiseConvParams {
+  int batch, in_channels, in_h, in_w;
+  int out_channels, out_h, out_w;
+  int kernel_h, kernel_w;
+  int stride_h, stride_w, pad_h, pad_w, dilation_h, dilation_w;
+};
+
+/*!
+ * \brief The depthwise conv2d with the filter w of [out_channels, 1, kernel_h, kernel_w]. x and y
+ * are NCHW, or NHWC with an OHWI filter if nhwc is true, in which case the multiplier must be 1.
+ */
+template <typename T>
+void depthwise_conv2d_cuda(const T* x, const T* w, T* y, const DepthwiseConvParams& p, bool nhwc,
+                           void* stream);
+
+/*! \brief The gradient of the NCHW input of the depthwise conv2d. */
+template <typename T>
+void depthwise_conv2d_dx_cuda(const T* dy, const T* w, T* dx, const DepthwiseConvParams& p,
+                              void* stream);
+
+/*! \brief The workspace size in bytes of the filter gradient of the depthwise conv2d. */
+int64_t depthwise_conv2d_dw_workspace(const DepthwiseConvParams& p);
+
+/*! \brief The gradient of the filter of the NCHW depthwise conv2d. */
+template <typename T>
+void depthwise_conv2d_dw_cuda(const T* x, const T* dy, T* dw, const DepthwiseConvParams& p,
+                              void* workspace, void* stream);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
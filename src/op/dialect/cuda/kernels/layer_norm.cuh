@@ -12,6 +12,7 @@
 #include <stdint.h>
 #include <vector>
 #include "./Half.h"
+#include "./BFloat16.h"
 #include "../../../../common/cuda_utils.h"
 
 
@@ -31,6 +31,11 @@ template void HostApplyLayerNorm<float, float, float>(float* output, float* mean
                                                       double epsilon, void* stream,
                                                       const uint64_t maxGridY);
 
+template void HostApplyLayerNorm<BFloat16, float, BFloat16>(
+    BFloat16* output, float* mean, float* invvar, const BFloat16* input, int n1, int n2,
+    const BFloat16* gamma, const BFloat16* beta, double epsilon, void* stream,
+    const uint64_t maxGridY);
+
 template void HostLayerNormGradient<Half, Half>(const Half* dout, const float* mean,
                                                 const float* invvar, Half* input, int n1, int n2,
                                                 const Half* gamma, double epsilon, Half* grad_input,
@@ -38,6 +43,12 @@ template void HostLayerNormGradient<Half, Half>(const Half* dout, const float* m
                                                 float* part_gard_gamma, float* part_grad_beta,
                                                 void* compute_stream, const uint64_t maxGridY);
 
+template void HostLayerNormGradient<BFloat16, BFloat16>(
+    const BFloat16* dout, const float* mean, const float* invvar, BFloat16* input, int n1, int n2,
+    const BFloat16* gamma, double epsilon, BFloat16* grad_input, BFloat16* grad_gamma,
+    BFloat16* grad_beta, float* part_gard_gamma, float* part_grad_beta, void* compute_stream,
+    const uint64_t maxGridY);
+
 template void HostLayerNormGradient<float, float>(
     const float* dout, const float* mean, const float* invvar, float* input, int n1, int n2,
     const float* gamma, double epsilon, float* grad_input, float* grad_gamma, float* grad_beta,
@@ -0,0 +1,53 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/loss_scale.cu
+ * \brief The update of the dynamic loss scale, which stays on the device so that mixed precision
+ * training does not read the overflow flag back to the host every step.
+ */
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+__global__ void UpdateLossScaleKernel(const float* grad_norm, const float* loss_scale,
+                                      const float* good_steps, float* new_loss_scale,
+                                      float* new_good_steps, float growth_factor,
+                                      float backoff_factor, int growth_interval, float min_scale) {
+  float scale = *loss_scale;
+  float steps = *good_steps;
+  if (!isfinite(*grad_norm)) {
+    scale = fmaxf(scale * backoff_factor, min_scale);
+    steps = 0.0f;
+  } else if (steps + 1.0f >= growth_interval) {
+    // Keep the scale if it would overflow by itself.
+    float grown = scale * growth_factor;
+    scale = isfinite(grown) ? grown : scale;
+    steps = 0.0f;
+  } else {
+    steps += 1.0f;
+  }
+  *new_loss_scale = scale;
+  *new_good_steps = steps;
+}
+
+}  // namespace
+
+void update_loss_scale_cuda(const float* grad_norm, const float* loss_scale,
+                            const float* good_steps, float* new_loss_scale, float* new_good_steps,
+                            float growth_factor, float backoff_factor, int growth_interval,
+                            float min_scale, void* stream) {
+  UpdateLossScaleKernel<<<1, 1, 0, static_cast<cudaStream_t>(stream)>>>(
+      grad_norm, loss_scale, good_steps, new_loss_scale, new_good_steps, growth_factor,
+      backoff_factor, growth_interval, min_scale);
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
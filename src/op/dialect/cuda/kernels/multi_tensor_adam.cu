@@ -0,0 +1,130 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/multi_tensor_adam.cu
+ * \brief Adam and AdamW over a list of tensors with one kernel launch per chunk batch.
+ */
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+#include "./multi_tensor_apply.cuh"
+#define BLOCK_SIZE 512
+#define ILP 4
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+typedef enum {
+  ADAM_MODE_0 = 0,  // L2 regularization mode (Adam)
+  ADAM_MODE_1 = 1   // Decoupled weight decay mode (AdamW)
+} adamMode_t;
+
+/*!
+ * \brief The tensor lists are [grads, weights, exp_avgs, exp_avg_sqs] with an optional trailing
+ * group of float16 params, which receive a copy of the updated float32 weights. The step is read
+ * on the device so that the bias corrections do not need a host synchronization. So are the global
+ * norm of the gradients, by which the gradients are clipped, and the decision to skip the step,
+ * as well as the loss scale that the gradients are unscaled by.
+ */
+template <typename grad_t, int depth>
+struct AdamFunctor {
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<depth>& tl,
+                                             const float* step, float lr, float beta1, float beta2,
+                                             float eps, float weight_decay, bool bias_correction,
+                                             adamMode_t mode, const float* grad_norm,
+                                             float max_grad_norm, const float* loss_scale) {
+    float scale;
+    if (!GradClipScale(grad_norm, max_grad_norm, loss_scale, &scale)) {
+      return;
+    }
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int n = tl.sizes[tensor_loc];
+
+    int offset = chunk_idx * chunk_size;
+    const grad_t* g = static_cast<const grad_t*>(tl.addresses[0][tensor_loc]) + offset;
+    float* w = static_cast<float*>(tl.addresses[1][tensor_loc]) + offset;
+    float* m = static_cast<float*>(tl.addresses[2][tensor_loc]) + offset;
+    float* v = static_cast<float*>(tl.addresses[3][tensor_loc]) + offset;
+    __half* p = depth == 5 ? static_cast<__half*>(tl.addresses[depth - 1][tensor_loc]) + offset
+                           : nullptr;
+    n -= offset;
+    n = n < chunk_size ? n : chunk_size;
+
+    float bias_correction1 = 1.0f;
+    float bias_correction2 = 1.0f;
+    if (bias_correction) {
+      bias_correction1 = 1.0f - powf(beta1, *step);
+      bias_correction2 = 1.0f - powf(beta2, *step);
+    }
+
+    for (int i_start = 0; i_start < n; i_start += blockDim.x * ILP) {
+#pragma unroll
+      for (int ii = 0; ii < ILP; ii++) {
+        int i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n) {
+          float grad = scale * static_cast<float>(g[i]);
+          float weight = w[i];
+          if (mode == ADAM_MODE_0) {
+            grad += weight_decay * weight;
+          }
+          float next_m = beta1 * m[i] + (1.0f - beta1) * grad;
+          float next_v = beta2 * v[i] + (1.0f - beta2) * grad * grad;
+          float denom = sqrtf(next_v / bias_correction2) + eps;
+          float update = (next_m / bias_correction1) / denom;
+          if (mode == ADAM_MODE_1) {
+            update += weight_decay * weight;
+          }
+          weight -= lr * update;
+          m[i] = next_m;
+          v[i] = next_v;
+          w[i] = weight;
+          if (depth == 5) {
+            p[i] = __float2half(weight);
+          }
+        }
+      }
+    }
+  }
+};
+
+template <typename grad_t>
+void multi_tensor_adam_cuda(int chunk_size, std::vector<void*> tensor_lists, const float* step,
+                            float lr, float beta1, float beta2, float eps, float weight_decay,
+                            bool bias_correction, int mode, bool fp16_params,
+                            const float* grad_norm, float max_grad_norm,
+                            const float* loss_scale, const std::vector<int> numels,
+                            void* stream) {
+  adamMode_t adam_mode = static_cast<adamMode_t>(mode);
+  if (fp16_params) {
+    multi_tensor_apply<5>(BLOCK_SIZE, chunk_size, tensor_lists, numels, stream,
+                          AdamFunctor<grad_t, 5>(), step, lr, beta1, beta2, eps, weight_decay,
+                          bias_correction, adam_mode, grad_norm, max_grad_norm,
+                          loss_scale);
+  } else {
+    multi_tensor_apply<4>(BLOCK_SIZE, chunk_size, tensor_lists, numels, stream,
+                          AdamFunctor<grad_t, 4>(), step, lr, beta1, beta2, eps, weight_decay,
+                          bias_correction, adam_mode, grad_norm, max_grad_norm,
+                          loss_scale);
+  }
+}
+
+template void multi_tensor_adam_cuda<float>(int chunk_size, std::vector<void*> tensor_lists,
+                                            const float* step, float lr, float beta1, float beta2,
+                                            float eps, float weight_decay, bool bias_correction,
+                                            int mode, bool fp16_params, const float* grad_norm,
+                                            float max_grad_norm, const float* loss_scale,
+                                            const std::vector<int> numels, void* stream);
+template void multi_tensor_adam_cuda<__half>(int chunk_size, std::vector<void*> tensor_lists,
+                                             const float* step, float lr, float beta1, float beta2,
+                                             float eps, float weight_decay, bool bias_correction,
+                                             int mode, bool fp16_params, const float* grad_norm,
+                                             float max_grad_norm, const float* loss_scale,
+                                             const std::vector<int> numels, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
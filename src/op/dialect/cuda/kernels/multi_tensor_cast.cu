@@ -0,0 +1,71 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/multi_tensor_cast.cu
+ * \brief Cast a list of tensors with one kernel launch per chunk batch.
+ */
+#include "./kernel_util.cuh"
+#include "./multi_tensor_apply.cuh"
+#define BLOCK_SIZE 512
+#define ILP 4
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+template <typename T>
+__device__ __forceinline__ T cast_to(float x);
+
+template <>
+__device__ __forceinline__ float cast_to<float>(float x) {
+  return x;
+}
+
+template <>
+__device__ __forceinline__ __half cast_to<__half>(float x) {
+  return __float2half(x);
+}
+
+template <typename in_t, typename out_t>
+struct CastFunctor {
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<2>& tl) {
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int n = tl.sizes[tensor_loc];
+
+    const in_t* in = static_cast<const in_t*>(tl.addresses[0][tensor_loc]) + chunk_idx * chunk_size;
+    out_t* out = static_cast<out_t*>(tl.addresses[1][tensor_loc]) + chunk_idx * chunk_size;
+    n -= chunk_idx * chunk_size;
+    n = n < chunk_size ? n : chunk_size;
+
+    // Each thread handles ILP elements per iteration to hide the memory latency.
+    for (int i_start = 0; i_start < n; i_start += blockDim.x * ILP) {
+#pragma unroll
+      for (int ii = 0; ii < ILP; ii++) {
+        int i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n) {
+          out[i] = cast_to<out_t>(static_cast<float>(in[i]));
+        }
+      }
+    }
+  }
+};
+
+template <typename in_t, typename out_t>
+void multi_tensor_cast_cuda(int chunk_size, std::vector<void*> tensor_lists,
+                            const std::vector<int> numels, void* stream) {
+  multi_tensor_apply<2>(BLOCK_SIZE, chunk_size, tensor_lists, numels, stream,
+                        CastFunctor<in_t, out_t>());
+}
+
+template void multi_tensor_cast_cuda<float, __half>(int chunk_size, std::vector<void*> tensor_lists,
+                                                    const std::vector<int> numels, void* stream);
+template void multi_tensor_cast_cuda<__half, float>(int chunk_size, std::vector<void*> tensor_lists,
+                                                    const std::vector<int> numels, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,131 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/multi_tensor_global_norm.cu
+ * \brief The global L2 norm of a list of tensors and whether it overflows.
+ *
+ * Each block of the multi-tensor kernel writes the sum of squares of its chunk to a slot of the
+ * workspace, and a single block then sums the slots in a fixed order, so the norm is
+ * deterministic. A norm that is inf or nan means some element is inf or nan (or the sum of
+ * squares overflows), which is the overflow flag.
+ */
+#include <algorithm>
+#include "./kernel_util.cuh"
+#include "./multi_tensor_apply.cuh"
+#define BLOCK_SIZE 512
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr unsigned kFullMask = 0xffffffff;
+
+__device__ __forceinline__ float WarpSum(float x) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    x += __shfl_xor_sync(kFullMask, x, offset);
+  }
+  return x;
+}
+
+/*! \brief Sum over the thread block. All threads get the result. */
+__device__ __forceinline__ float BlockSum(float x) {
+  __shared__ float warp_sums[kWarpSize];
+  const int warp = threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  x = WarpSum(x);
+  if (lane == 0) {
+    warp_sums[warp] = x;
+  }
+  __syncthreads();
+  x = lane < blockDim.x / kWarpSize ? warp_sums[lane] : 0.0f;
+  x = WarpSum(x);
+  __syncthreads();
+  return x;
+}
+
+/*! \brief The most chunks of a tensor, which is the number of slots per tensor. */
+int MaxChunks(int chunk_size, const std::vector<int>& numels) {
+  int max_chunks = 1;
+  for (int numel : numels) {
+    max_chunks = std::max(max_chunks, (numel + chunk_size - 1) / chunk_size);
+  }
+  return max_chunks;
+}
+
+/*! \brief Write the sum of squares of a chunk to the slot of the chunk in partials. */
+template <typename T>
+struct SquareSumFunctor {
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<1>& tl,
+                                             float* partials, int max_chunks) {
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int n = tl.sizes[tensor_loc];
+
+    int offset = chunk_idx * chunk_size;
+    const T* x = static_cast<const T*>(tl.addresses[0][tensor_loc]) + offset;
+    n -= offset;
+    n = n < chunk_size ? n : chunk_size;
+
+    float sum = 0.0f;
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+      float v = static_cast<float>(x[i]);
+      sum += v * v;
+    }
+    sum = BlockSum(sum);
+    if (threadIdx.x == 0) {
+      partials[(tl.start_tensor_this_launch + tensor_loc) * max_chunks + chunk_idx] = sum;
+    }
+  }
+};
+
+__global__ void GlobalNormKernel(const float* partials, int num_partials, float* norm,
+                                 bool* found_inf) {
+  float sum = 0.0f;
+  for (int i = threadIdx.x; i < num_partials; i += blockDim.x) {
+    sum += partials[i];
+  }
+  sum = BlockSum(sum);
+  if (threadIdx.x == 0) {
+    float result = sqrtf(sum);
+    *norm = result;
+    *found_inf = !isfinite(result);
+  }
+}
+
+}  // namespace
+
+int64_t global_norm_workspace(int chunk_size, const std::vector<int>& numels) {
+  return static_cast<int64_t>(numels.size()) * MaxChunks(chunk_size, numels) * sizeof(float);
+}
+
+template <typename T>
+void global_norm_and_check_cuda(int chunk_size, std::vector<void*> tensor_list,
+                                const std::vector<int>& numels, float* norm, bool* found_inf,
+                                void* workspace, void* stream) {
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  int max_chunks = MaxChunks(chunk_size, numels);
+  int num_partials = numels.size() * max_chunks;
+  float* partials = static_cast<float*>(workspace);
+  // The slots past the last chunk of each tensor are not written.
+  CUDA_CALL(cudaMemsetAsync(partials, 0, num_partials * sizeof(float), s));
+  multi_tensor_apply<1>(BLOCK_SIZE, chunk_size, tensor_list, numels, stream,
+                        SquareSumFunctor<T>(), partials, max_chunks);
+  GlobalNormKernel<<<1, BLOCK_SIZE, 0, s>>>(partials, num_partials, norm, found_inf);
+}
+
+template void global_norm_and_check_cuda<float>(int chunk_size, std::vector<void*> tensor_list,
+                                                const std::vector<int>& numels, float* norm,
+                                                bool* found_inf, void* workspace, void* stream);
+template void global_norm_and_check_cuda<__half>(int chunk_size, std::vector<void*> tensor_list,
+                                                 const std::vector<int>& numels, float* norm,
+                                                 bool* found_inf, void* workspace, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,95 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/multi_tensor_sgd.cu
+ * \brief SGD with momentum over a list of tensors with one kernel launch per chunk batch.
+ */
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+#include "./multi_tensor_apply.cuh"
+#define BLOCK_SIZE 512
+#define ILP 4
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*!
+ * \brief The tensor lists are [grads, weights, momentums] or [grads, weights, momentums, params],
+ * where the weights and the momentums are in float32, and the float16 params receive a copy of
+ * the updated weights. The gradients are clipped, or the step is skipped, by their global norm,
+ * and are unscaled by the loss scale if it is given.
+ */
+template <typename grad_t, int depth>
+struct SgdFunctor {
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<depth>& tl,
+                                             float lr, float momentum, const float* grad_norm,
+                                             float max_grad_norm, const float* loss_scale) {
+    float scale;
+    if (!GradClipScale(grad_norm, max_grad_norm, loss_scale, &scale)) {
+      return;
+    }
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int n = tl.sizes[tensor_loc];
+
+    int offset = chunk_idx * chunk_size;
+    const grad_t* g = static_cast<const grad_t*>(tl.addresses[0][tensor_loc]) + offset;
+    float* w = static_cast<float*>(tl.addresses[1][tensor_loc]) + offset;
+    float* v = static_cast<float*>(tl.addresses[2][tensor_loc]) + offset;
+    __half* p = depth == 4 ? static_cast<__half*>(tl.addresses[depth - 1][tensor_loc]) + offset
+                           : nullptr;
+    n -= offset;
+    n = n < chunk_size ? n : chunk_size;
+
+    for (int i_start = 0; i_start < n; i_start += blockDim.x * ILP) {
+#pragma unroll
+      for (int ii = 0; ii < ILP; ii++) {
+        int i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n) {
+          float next_v = momentum * v[i] + scale * static_cast<float>(g[i]);
+          float next_w = w[i] - lr * next_v;
+          v[i] = next_v;
+          w[i] = next_w;
+          if (depth == 4) {
+            p[i] = __float2half(next_w);
+          }
+        }
+      }
+    }
+  }
+};
+
+template <typename grad_t>
+void multi_tensor_sgd_cuda(int chunk_size, std::vector<void*> tensor_lists, float lr,
+                           float momentum, bool fp16_params, const float* grad_norm,
+                           float max_grad_norm, const float* loss_scale,
+                           const std::vector<int> numels, void* stream) {
+  if (fp16_params) {
+    multi_tensor_apply<4>(BLOCK_SIZE, chunk_size, tensor_lists, numels, stream,
+                          SgdFunctor<grad_t, 4>(), lr, momentum, grad_norm, max_grad_norm,
+                          loss_scale);
+  } else {
+    multi_tensor_apply<3>(BLOCK_SIZE, chunk_size, tensor_lists, numels, stream,
+                          SgdFunctor<grad_t, 3>(), lr, momentum, grad_norm, max_grad_norm,
+                          loss_scale);
+  }
+}
+
+template void multi_tensor_sgd_cuda<float>(int chunk_size, std::vector<void*> tensor_lists,
+                                           float lr, float momentum, bool fp16_params,
+                                           const float* grad_norm, float max_grad_norm,
+                                           const float* loss_scale, const std::vector<int> numels,
+                                           void* stream);
+template void multi_tensor_sgd_cuda<__half>(int chunk_size, std::vector<void*> tensor_lists,
+                                            float lr, float momentum, bool fp16_params,
+                                            const float* grad_norm, float max_grad_norm,
+                                            const float* loss_scale, const std::vector<int> numels,
+                                            void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
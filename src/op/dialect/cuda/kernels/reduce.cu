@@ -0,0 +1,349 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/reduce.cu
+ * \brief Reduction cuda kernels.
+ *
+ * The input is viewed as [outer, n, inner] and reduced over n. The strategy is chosen by shape:
+ * - inner == 1 and short rows: one warp per row, which reads the row with vectorized loads.
+ * - inner == 1 and long rows: one thread block per row.
+ * - inner == 1 and a few long rows: each row is split over several blocks, which write partial
+ *   results to the workspace, and a second pass reduces the partials of each row.
+ * - inner > 1: the threads of a block cover 32 adjacent columns and 8 rows, so the loads are
+ *   coalesced. The rows are split over several blocks as above if the columns are too few.
+ * The partials are reduced in a fixed order, so the results are deterministic. The values are
+ * accumulated in float, and the epilogue (the scale of mean and the sqrt of l2norm) is fused into
+ * the final write.
+ */
+#include <algorithm>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kThreads = 256;
+constexpr int kWarpsPerBlock = kThreads / kWarpSize;
+constexpr unsigned kFullMask = 0xffffffff;
+/*! \brief The longest rows that are reduced by a single warp. */
+constexpr int64_t kWarpRowMax = 1024;
+/*! \brief The number of blocks that is considered to fill the device. */
+constexpr int64_t kTargetBlocks = 512;
+/*! \brief The shortest part of a row that is worth a block of its own. */
+constexpr int64_t kMinSplitRow = 16384;
+/*! \brief The number of rows covered by a block of the column reduction. */
+constexpr int kColumnRows = kThreads / kWarpSize;
+/*! \brief The fewest rows each block of a split column reduction reduces. */
+constexpr int64_t kMinSplitColumn = 256;
+/*! \brief The largest grid dimension in y and z. */
+constexpr int64_t kMaxGridYZ = 65535;
+
+__host__ __forceinline__ int64_t CeilDiv(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+struct SumOp {
+  __device__ __forceinline__ static float Init() {
+    return 0.0f;
+  }
+  __device__ __forceinline__ static float Map(float x) {
+    return x;
+  }
+  __device__ __forceinline__ static float Combine(float a, float b) {
+    return a + b;
+  }
+};
+
+struct SquareSumOp : SumOp {
+  __device__ __forceinline__ static float Map(float x) {
+    return x * x;
+  }
+};
+
+struct MaxOp {
+  __device__ __forceinline__ static float Init() {
+    return -INFINITY;
+  }
+  __device__ __forceinline__ static float Map(float x) {
+    return x;
+  }
+  __device__ __forceinline__ static float Combine(float a, float b) {
+    return fmaxf(a, b);
+  }
+};
+
+struct MinOp {
+  __device__ __forceinline__ static float Init() {
+    return INFINITY;
+  }
+  __device__ __forceinline__ static float Map(float x) {
+    return x;
+  }
+  __device__ __forceinline__ static float Combine(float a, float b) {
+    return fminf(a, b);
+  }
+};
+
+/*! \brief Reduces the partial results of Op, which are already mapped. */
+template <typename Op>
+struct PartialOp : Op {
+  __device__ __forceinline__ static float Map(float x) {
+    return x;
+  }
+};
+
+/*! \brief The transform of the reduced value before it is written. */
+struct Epilogue {
+  float scale;
+  bool sqrt;
+
+  __device__ __forceinline__ float Apply(float x) const {
+    x *= scale;
+    return sqrt ? sqrtf(x) : x;
+  }
+};
+
+constexpr Epilogue kIdentity = {1.0f, false};
+
+template <typename Op>
+__device__ __forceinline__ float WarpReduce(float x) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    x = Op::Combine(x, __shfl_xor_sync(kFullMask, x, offset));
+  }
+  return x;
+}
+
+/*! \brief Reduce x over the thread block. Only thread 0 gets the result. */
+template <typename Op>
+__device__ __forceinline__ float BlockReduce(float x) {
+  __shared__ float warp_results[kWarpSize];
+  const int warp = threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  x = WarpReduce<Op>(x);
+  if (lane == 0) {
+    warp_results[warp] = x;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    x = lane < blockDim.x / kWarpSize ? warp_results[lane] : Op::Init();
+    x = WarpReduce<Op>(x);
+  }
+  return x;
+}
+
+/*! \brief Reduce the elements [start, end) of a row that are assigned to this thread. */
+template <typename T, typename Op, int N>
+__device__ __forceinline__ float ThreadReduce(const T* row, int64_t start, int64_t end, int tid,
+                                              int num_threads) {
+  float acc = Op::Init();
+  for (int64_t i = start + static_cast<int64_t>(tid) * N; i < end;
+       i += static_cast<int64_t>(num_threads) * N) {
+    AlignedVector<T, N> vec = LoadVector<T, N>(row, i);
+#pragma unroll
+    for (int j = 0; j < N; ++j) {
+      acc = Op::Combine(acc, Op::Map(ToFloat(vec.val[j])));
+    }
+  }
+  return acc;
+}
+
+/*! \brief Reduce each row of n elements with a warp. */
+template <typename T, typename O, typename Op, int N>
+__global__ void WarpRowReduceKernel(const T* x, O* out, int64_t rows, int64_t n, Epilogue ep) {
+  const int64_t row = static_cast<int64_t>(blockIdx.x) * kWarpsPerBlock + threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  // The condition is uniform over the warp, so the warp may return as a whole.
+  if (row >= rows) {
+    return;
+  }
+  float acc = ThreadReduce<T, Op, N>(x + row * n, 0, n, lane, kWarpSize);
+  acc = WarpReduce<Op>(acc);
+  if (lane == 0) {
+    out[row] = FromFloat<O>(ep.Apply(acc));
+  }
+}
+
+/*!
+ * \brief Reduce a part of chunk elements of each row of n elements with a block. The block
+ * blockIdx.x reduces the part blockIdx.x % splits of the row blockIdx.x / splits.
+ */
+template <typename T, typename O, typename Op, int N>
+__global__ void BlockRowReduceKernel(const T* x, O* out, int64_t n, int64_t chunk, int64_t splits,
+                                     Epilogue ep) {
+  const int64_t row = blockIdx.x / splits;
+  const int64_t start = blockIdx.x % splits * chunk;
+  const int64_t end = min(start + chunk, n);
+  float acc = ThreadReduce<T, Op, N>(x + row * n, start, end, threadIdx.x, blockDim.x);
+  acc = BlockReduce<Op>(acc);
+  if (threadIdx.x == 0) {
+    out[blockIdx.x] = FromFloat<O>(ep.Apply(acc));
+  }
+}
+
+/*!
+ * \brief Reduce the columns of [outer, n, inner]. The block (x, y, z) reduces the rows of part z
+ * of chunk rows of the 32 columns from 32 * x of the outer indices y, y + gridDim.y, ..., and
+ * writes to [outer, splits, inner] where splits = gridDim.z.
+ */
+template <typename T, typename O, typename Op>
+__global__ void ColumnReduceKernel(const T* x, O* out, int64_t outer, int64_t n, int64_t inner,
+                                   int64_t chunk, Epilogue ep) {
+  __shared__ float partials[kColumnRows][kWarpSize + 1];
+  const int64_t col = static_cast<int64_t>(blockIdx.x) * kWarpSize + threadIdx.x;
+  const int64_t start = blockIdx.z * chunk;
+  const int64_t end = min(start + chunk, n);
+  for (int64_t o = blockIdx.y; o < outer; o += gridDim.y) {
+    float acc = Op::Init();
+    if (col < inner) {
+      const T* base = x + o * n * inner + col;
+      for (int64_t r = start + threadIdx.y; r < end; r += kColumnRows) {
+        acc = Op::Combine(acc, Op::Map(ToFloat(base[r * inner])));
+      }
+    }
+    partials[threadIdx.y][threadIdx.x] = acc;
+    __syncthreads();
+    if (threadIdx.y == 0 && col < inner) {
+      for (int r = 1; r < kColumnRows; ++r) {
+        acc = Op::Combine(acc, partials[r][threadIdx.x]);
+      }
+      out[(o * gridDim.z + blockIdx.z) * inner + col] = FromFloat<O>(ep.Apply(acc));
+    }
+    // Make sure the partials are read before they are overwritten by the next outer index.
+    __syncthreads();
+  }
+}
+
+/*! \brief The number of parts each row (or column) is split into. */
+int64_t ReduceSplits(int64_t outer, int64_t n, int64_t inner) {
+  if (inner == 1) {
+    if (n <= kWarpRowMax || outer >= kTargetBlocks / 4) {
+      return 1;
+    }
+    return std::max<int64_t>(1, std::min(n / kMinSplitRow, CeilDiv(kTargetBlocks, outer)));
+  }
+  int64_t blocks = outer * CeilDiv(inner, kWarpSize);
+  if (blocks >= kTargetBlocks / 4) {
+    return 1;
+  }
+  return std::max<int64_t>(1, std::min(n / kMinSplitColumn, CeilDiv(kTargetBlocks, blocks)));
+}
+
+/*! \brief Whether the rows of n elements can be read with 16-byte vectors. */
+template <typename T>
+bool CanVectorize(const T* x, int64_t n) {
+  return reinterpret_cast<uintptr_t>(x) % 16 == 0 && n % (16 / sizeof(T)) == 0;
+}
+
+/*! \brief Reduce each part of chunk elements of the rows of n elements. */
+template <typename T, typename O, typename Op>
+void LaunchRowReduce(const T* x, O* out, int64_t outer, int64_t n, int64_t chunk, Epilogue ep,
+                     cudaStream_t stream) {
+  constexpr int kVec = 16 / sizeof(T);
+  const bool vectorize = CanVectorize(x, n) && chunk % kVec == 0;
+  if (n <= kWarpRowMax) {
+    const int64_t blocks = CeilDiv(outer, kWarpsPerBlock);
+    if (vectorize) {
+      WarpRowReduceKernel<T, O, Op, kVec><<<blocks, kThreads, 0, stream>>>(x, out, outer, n, ep);
+    } else {
+      WarpRowReduceKernel<T, O, Op, 1><<<blocks, kThreads, 0, stream>>>(x, out, outer, n, ep);
+    }
+    return;
+  }
+  const int64_t splits = CeilDiv(n, chunk);
+  const int64_t blocks = outer * splits;
+  if (vectorize) {
+    BlockRowReduceKernel<T, O, Op, kVec>
+        <<<blocks, kThreads, 0, stream>>>(x, out, n, chunk, splits, ep);
+  } else {
+    BlockRowReduceKernel<T, O, Op, 1>
+        <<<blocks, kThreads, 0, stream>>>(x, out, n, chunk, splits, ep);
+  }
+}
+
+/*! \brief Reduce each part of chunk rows of the columns of [outer, n, inner]. */
+template <typename T, typename O, typename Op>
+void LaunchColumnReduce(const T* x, O* out, int64_t outer, int64_t n, int64_t inner,
+                        int64_t chunk, Epilogue ep, cudaStream_t stream) {
+  dim3 grid(CeilDiv(inner, kWarpSize), std::min(outer, kMaxGridYZ), CeilDiv(n, chunk));
+  dim3 block(kWarpSize, kColumnRows);
+  ColumnReduceKernel<T, O, Op><<<grid, block, 0, stream>>>(x, out, outer, n, inner, chunk, ep);
+}
+
+template <typename T, typename Op>
+void Reduce(const T* x, T* out, int64_t outer, int64_t n, int64_t inner, Epilogue ep,
+            void* workspace, cudaStream_t stream) {
+  const int64_t splits = ReduceSplits(outer, n, inner);
+  float* partials = static_cast<float*>(workspace);
+  if (inner == 1) {
+    // Each part is a multiple of the vector width, so that the vectors of all parts are aligned.
+    constexpr int kVec = 16 / sizeof(T);
+    int64_t chunk = CeilDiv(n, splits);
+    chunk = splits > 1 && CanVectorize(x, n) ? CeilDiv(chunk, kVec) * kVec : chunk;
+    if (chunk >= n) {
+      LaunchRowReduce<T, T, Op>(x, out, outer, n, n, ep, stream);
+      return;
+    }
+    const int64_t parts = CeilDiv(n, chunk);
+    LaunchRowReduce<T, float, Op>(x, partials, outer, n, chunk, kIdentity, stream);
+    LaunchRowReduce<float, T, PartialOp<Op>>(partials, out, outer, parts, parts, ep, stream);
+    return;
+  }
+  const int64_t chunk = CeilDiv(n, splits);
+  if (chunk >= n) {
+    LaunchColumnReduce<T, T, Op>(x, out, outer, n, inner, n, ep, stream);
+    return;
+  }
+  const int64_t parts = CeilDiv(n, chunk);
+  LaunchColumnReduce<T, float, Op>(x, partials, outer, n, inner, chunk, kIdentity, stream);
+  LaunchColumnReduce<float, T, PartialOp<Op>>(partials, out, outer, parts, inner, parts, ep,
+                                              stream);
+}
+
+}  // namespace
+
+int64_t reduce_workspace(int64_t outer, int64_t n, int64_t inner) {
+  int64_t splits = ReduceSplits(outer, n, inner);
+  return splits > 1 ? sizeof(float) * outer * splits * inner : 0;
+}
+
+template <typename T>
+void reduce_cuda(const T* x, T* out, int64_t outer, int64_t n, int64_t inner, ReduceMode mode,
+                 void* workspace, void* stream) {
+  if (outer * inner == 0) {
+    return;
+  }
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  switch (mode) {
+    case ReduceMode::kSum:
+      Reduce<T, SumOp>(x, out, outer, n, inner, kIdentity, workspace, s);
+      return;
+    case ReduceMode::kMean:
+      Reduce<T, SumOp>(x, out, outer, n, inner, {1.0f / n, false}, workspace, s);
+      return;
+    case ReduceMode::kMax:
+      Reduce<T, MaxOp>(x, out, outer, n, inner, kIdentity, workspace, s);
+      return;
+    case ReduceMode::kMin:
+      Reduce<T, MinOp>(x, out, outer, n, inner, kIdentity, workspace, s);
+      return;
+    case ReduceMode::kL2Norm:
+      Reduce<T, SquareSumOp>(x, out, outer, n, inner, {1.0f, true}, workspace, s);
+      return;
+  }
+}
+
+template void reduce_cuda<float>(const float*, float*, int64_t, int64_t, int64_t, ReduceMode,
+                                 void*, void*);
+template void reduce_cuda<__half>(const __half*, __half*, int64_t, int64_t, int64_t, ReduceMode,
+                                  void*, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,276 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/rms_norm.cu
+ * \brief RMS norm cuda kernels.
+ *
+ * Like the layer norm kernels, each row of the RMS norm is processed by one thread block with
+ * 128-bit vectorized loads and stores, and the gradient of the scale is reduced over row parts in
+ * two small kernels. The forward keeps no statistics: the backward recomputes the root mean
+ * square of a row in the same pass that reduces sum(g * x).
+ */
+#include <algorithm>
+#include <initializer_list>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kMaxThreads = 256;
+constexpr unsigned kFullMask = 0xffffffff;
+/*! \brief The number of row parts that the partial gradients of gamma are reduced in. */
+constexpr int kGammaParts = 16;
+/*! \brief The block shape of the partial gradient kernel. */
+constexpr int kGammaCols = 32;
+constexpr int kGammaRows = 8;
+
+__device__ __forceinline__ float WarpSum(float x) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    x += __shfl_xor_sync(kFullMask, x, offset);
+  }
+  return x;
+}
+
+/*! \brief Sum x over the thread block. All threads get the result. */
+__device__ __forceinline__ float BlockSum(float x) {
+  __shared__ float warp_sums[kWarpSize];
+  const int warp = threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  x = WarpSum(x);
+  if (lane == 0) {
+    warp_sums[warp] = x;
+  }
+  __syncthreads();
+  x = lane < blockDim.x / kWarpSize ? warp_sums[lane] : 0.0f;
+  x = WarpSum(x);
+  // Make sure all threads have read the partial sums before the buffer is reused.
+  __syncthreads();
+  return x;
+}
+
+/*! \brief The forward of one row, y = x * rsqrt(mean(x^2) + eps) * gamma. */
+template <typename T, int kVec>
+__global__ void RMSNormForwardKernel(const T* __restrict__ x, const T* __restrict__ gamma,
+                                     T* __restrict__ y, int n2, float eps) {
+  using Vec = AlignedVector<T, kVec>;
+  const int64_t offset = static_cast<int64_t>(blockIdx.x) * n2;
+  const int n_vecs = n2 / kVec;
+
+  float sq_sum = 0.0f;
+  for (int i = threadIdx.x; i < n_vecs; i += blockDim.x) {
+    Vec x_vec = LoadVector<T, kVec>(x, offset + i * kVec);
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      float xf = ToFloat(x_vec.val[k]);
+      sq_sum += xf * xf;
+    }
+  }
+  const float row_rstd = rsqrtf(BlockSum(sq_sum) / n2 + eps);
+
+  // The row is read again from the global memory, where it is likely still cached.
+  for (int i = threadIdx.x; i < n_vecs; i += blockDim.x) {
+    const int col = i * kVec;
+    Vec x_vec = LoadVector<T, kVec>(x, offset + col);
+    float yf[kVec];
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      yf[k] = ToFloat(x_vec.val[k]) * row_rstd;
+    }
+    if (gamma != nullptr) {
+      Vec g_vec = LoadVector<T, kVec>(gamma, col);
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        yf[k] *= ToFloat(g_vec.val[k]);
+      }
+    }
+    Vec y_vec;
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      y_vec.val[k] = FromFloat<T>(yf[k]);
+    }
+    StoreVector<T, kVec>(y, offset + col, y_vec);
+  }
+}
+
+/*!
+ * \brief The backward of one row, dx = rstd * g - x * rstd^3 * mean(g * x), where g = dy * gamma.
+ * The rstd of the row is written to rstd for the gradient of gamma if it is not nullptr.
+ */
+template <typename T, int kVec>
+__global__ void RMSNormBackwardKernel(const T* __restrict__ x, const T* __restrict__ gamma,
+                                      const T* __restrict__ dy, T* __restrict__ dx,
+                                      float* __restrict__ rstd, int n2, float eps) {
+  using Vec = AlignedVector<T, kVec>;
+  const int64_t offset = static_cast<int64_t>(blockIdx.x) * n2;
+  const int n_vecs = n2 / kVec;
+
+  // Load the row gradients g = dy * gamma and the inputs x of a vector.
+  auto load = [&](int col, float* g, float* xf) {
+    Vec dy_vec = LoadVector<T, kVec>(dy, offset + col);
+    Vec x_vec = LoadVector<T, kVec>(x, offset + col);
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      g[k] = ToFloat(dy_vec.val[k]);
+      xf[k] = ToFloat(x_vec.val[k]);
+    }
+    if (gamma != nullptr) {
+      Vec g_vec = LoadVector<T, kVec>(gamma, col);
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        g[k] *= ToFloat(g_vec.val[k]);
+      }
+    }
+  };
+
+  float sq_sum = 0.0f, sum_g_x = 0.0f;
+  for (int i = threadIdx.x; i < n_vecs; i += blockDim.x) {
+    float g[kVec], xf[kVec];
+    load(i * kVec, g, xf);
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      sq_sum += xf[k] * xf[k];
+      sum_g_x += g[k] * xf[k];
+    }
+  }
+  const float row_rstd = rsqrtf(BlockSum(sq_sum) / n2 + eps);
+  const float coef = row_rstd * row_rstd * row_rstd * BlockSum(sum_g_x) / n2;
+
+  for (int i = threadIdx.x; i < n_vecs; i += blockDim.x) {
+    const int col = i * kVec;
+    float g[kVec], xf[kVec];
+    load(col, g, xf);
+    Vec dx_vec;
+#pragma unroll
+    for (int k = 0; k < kVec; ++k) {
+      dx_vec.val[k] = FromFloat<T>(row_rstd * g[k] - xf[k] * coef);
+    }
+    StoreVector<T, kVec>(dx, offset + col, dx_vec);
+  }
+  if (rstd != nullptr && threadIdx.x == 0) {
+    rstd[blockIdx.x] = row_rstd;
+  }
+}
+
+/*! \brief The partial sums of dgamma = sum(dy * x * rstd) over a part of rows. */
+template <typename T>
+__global__ void RMSNormGammaPartKernel(const T* __restrict__ dy, const T* __restrict__ x,
+                                       const float* __restrict__ rstd, int n1, int n2,
+                                       int rows_per_part, float* __restrict__ part_gamma) {
+  __shared__ float gamma_s[kGammaRows][kGammaCols + 1];
+  const int col = blockIdx.x * kGammaCols + threadIdx.x;
+  const int row_begin = blockIdx.y * rows_per_part;
+  const int row_end = min(n1, row_begin + rows_per_part);
+  float sum_gamma = 0.0f;
+  if (col < n2) {
+    for (int row = row_begin + threadIdx.y; row < row_end; row += kGammaRows) {
+      const int64_t i = static_cast<int64_t>(row) * n2 + col;
+      sum_gamma += ToFloat(dy[i]) * ToFloat(x[i]) * rstd[row];
+    }
+  }
+  gamma_s[threadIdx.y][threadIdx.x] = sum_gamma;
+  __syncthreads();
+  if (threadIdx.y == 0 && col < n2) {
+    for (int r = 1; r < kGammaRows; ++r) {
+      sum_gamma += gamma_s[r][threadIdx.x];
+    }
+    part_gamma[blockIdx.y * n2 + col] = sum_gamma;
+  }
+}
+
+template <typename T>
+__global__ void RMSNormGammaKernel(const float* __restrict__ part_gamma, int n2,
+                                   T* __restrict__ dgamma) {
+  const int col = blockIdx.x * blockDim.x + threadIdx.x;
+  if (col >= n2) {
+    return;
+  }
+  float sum_gamma = 0.0f;
+  for (int part = 0; part < kGammaParts; ++part) {
+    sum_gamma += part_gamma[part * n2 + col];
+  }
+  dgamma[col] = FromFloat<T>(sum_gamma);
+}
+
+__host__ __forceinline__ int CeilDiv(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+/*! \brief Whether all the pointers can be accessed by vectors of n_bytes. */
+__host__ __forceinline__ bool IsAligned(std::initializer_list<const void*> ptrs, int n_bytes) {
+  for (const void* ptr : ptrs) {
+    if (reinterpret_cast<uintptr_t>(ptr) % n_bytes != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*! \brief The number of threads to process a row of n_vecs vectors. */
+__host__ __forceinline__ int RowThreads(int n_vecs) {
+  return std::min(kMaxThreads, std::max(1, CeilDiv(n_vecs, kWarpSize)) * kWarpSize);
+}
+
+}  // namespace
+
+int64_t rms_norm_backward_workspace(int n1, int n2) {
+  return (static_cast<int64_t>(n1) + kGammaParts * n2) * sizeof(float);
+}
+
+template <typename T>
+void rms_norm_forward_cuda(const T* x, const T* gamma, T* y, int n1, int n2, float eps,
+                           void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  constexpr int kVec = 16 / sizeof(T);
+  if (n2 % kVec == 0 && IsAligned({x, gamma, y}, 16)) {
+    RMSNormForwardKernel<T, kVec><<<n1, RowThreads(n2 / kVec), 0, cu_stream>>>(x, gamma, y, n2,
+                                                                               eps);
+  } else {
+    RMSNormForwardKernel<T, 1><<<n1, RowThreads(n2), 0, cu_stream>>>(x, gamma, y, n2, eps);
+  }
+}
+
+template <typename T>
+void rms_norm_backward_cuda(const T* x, const T* gamma, const T* dy, T* dx, T* dgamma,
+                            float* workspace, int n1, int n2, float eps, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  constexpr int kVec = 16 / sizeof(T);
+  float* rstd = dgamma != nullptr ? workspace : nullptr;
+  if (n2 % kVec == 0 && IsAligned({x, gamma, dy, dx}, 16)) {
+    RMSNormBackwardKernel<T, kVec><<<n1, RowThreads(n2 / kVec), 0, cu_stream>>>(
+        x, gamma, dy, dx, rstd, n2, eps);
+  } else {
+    RMSNormBackwardKernel<T, 1><<<n1, RowThreads(n2), 0, cu_stream>>>(x, gamma, dy, dx, rstd, n2,
+                                                                       eps);
+  }
+  if (dgamma == nullptr) {
+    return;
+  }
+  float* part_gamma = workspace + n1;
+  dim3 part_grid(CeilDiv(n2, kGammaCols), kGammaParts);
+  dim3 part_block(kGammaCols, kGammaRows);
+  RMSNormGammaPartKernel<T><<<part_grid, part_block, 0, cu_stream>>>(
+      dy, x, rstd, n1, n2, CeilDiv(n1, kGammaParts), part_gamma);
+  RMSNormGammaKernel<T><<<CeilDiv(n2, kMaxThreads), kMaxThreads, 0, cu_stream>>>(part_gamma, n2,
+                                                                                 dgamma);
+}
+
+template void rms_norm_forward_cuda<float>(const float*, const float*, float*, int, int, float,
+                                           void*);
+template void rms_norm_forward_cuda<__half>(const __half*, const __half*, __half*, int, int, float,
+                                            void*);
+template void rms_norm_backward_cuda<float>(const float*, const float*, const float*, float*,
+                                            float*, float*, int, int, float, void*);
+template void rms_norm_backward_cuda<__half>(const __half*, const __half*, const __half*, __half*,
+                                             __half*, float*, int, int, float, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
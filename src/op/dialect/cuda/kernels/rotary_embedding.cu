@@ -0,0 +1,83 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/rotary_embedding.cu
+ * \brief Rotary position embedding cuda kernels.
+ *
+ * The rotation of a head is computed in one elementwise pass, instead of slicing the two halves,
+ * rotating and concatenating them, which materializes the halves and their products.
+ */
+#include <algorithm>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kThreads = 256;
+constexpr int kMaxBlocks = 65535;
+
+/*!
+ * \brief Rotate the first 2 * rot_half elements of each head by the angles of its position, and
+ * copy the rest. The pair of element d is d +/- rot_half, or d ^ 1 if interleaved.
+ */
+template <typename T>
+__global__ void RotaryEmbeddingKernel(const T* __restrict__ x, const T* __restrict__ cos,
+                                      const T* __restrict__ sin, T* __restrict__ y, int64_t numel,
+                                      int head_dim, int rot_half, int seq_len, int64_t inner,
+                                      bool interleaved) {
+  const int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  for (int64_t idx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x; idx < numel;
+       idx += stride) {
+    const int d = idx % head_dim;
+    if (d >= 2 * rot_half) {
+      y[idx] = x[idx];
+      continue;
+    }
+    const int64_t pos = (idx / head_dim / inner) % seq_len;
+    int i, pair;
+    bool first;
+    if (interleaved) {
+      i = d / 2;
+      first = d % 2 == 0;
+      pair = first ? d + 1 : d - 1;
+    } else {
+      first = d < rot_half;
+      i = first ? d : d - rot_half;
+      pair = first ? d + rot_half : d - rot_half;
+    }
+    const float c = ToFloat(cos[pos * rot_half + i]);
+    const float s = ToFloat(sin[pos * rot_half + i]);
+    const float xf = ToFloat(x[idx]);
+    const float pf = ToFloat(x[idx - d + pair]);
+    y[idx] = FromFloat<T>(first ? xf * c - pf * s : xf * c + pf * s);
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void rotary_embedding_cuda(const T* x, const T* cos, const T* sin, T* y, int64_t numel,
+                           int head_dim, int rot_half, int seq_len, int64_t inner, bool interleaved,
+                           void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  const int64_t needed = std::max<int64_t>(1, (numel + kThreads - 1) / kThreads);
+  const int blocks = std::min<int64_t>(kMaxBlocks, needed);
+  RotaryEmbeddingKernel<T><<<blocks, kThreads, 0, cu_stream>>>(
+      x, cos, sin, y, numel, head_dim, rot_half, seq_len, inner, interleaved);
+}
+
+template void rotary_embedding_cuda<float>(const float*, const float*, const float*, float*,
+                                           int64_t, int, int, int, int64_t, bool, void*);
+template void rotary_embedding_cuda<__half>(const __half*, const __half*, const __half*, __half*,
+                                            int64_t, int, int, int, int64_t, bool, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,275 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/softmax_cross_entropy.cu
+ * \brief Fused softmax cross entropy cuda kernels.
+ *
+ * Each row of the logits is processed by one thread block, which strides over the classes and
+ * keeps the running max and sum of the exponentials (the online softmax), so neither the softmax
+ * nor the log-softmax is ever stored. The forward writes the loss of each row to the workspace, and
+ * a single block then averages them over the rows that are not ignored in a fixed order, so the
+ * result is deterministic. The backward recomputes the logsumexp of each row and writes the
+ * gradient in a second pass over the row.
+ */
+#include <algorithm>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kMaxThreads = 256;
+constexpr unsigned kFullMask = 0xffffffff;
+
+/*! \brief The running max and the sum of exp(x - max) of a part of a row. */
+struct SoftmaxStats {
+  float max;
+  float sum;
+};
+
+__device__ __forceinline__ SoftmaxStats Combine(SoftmaxStats a, SoftmaxStats b) {
+  if (a.max < b.max) {
+    SoftmaxStats t = a;
+    a = b;
+    b = t;
+  }
+  // An empty part has a zero sum and a max of -inf, which must not be rescaled.
+  if (b.sum == 0.0f) {
+    return a;
+  }
+  return {a.max, a.sum + b.sum * __expf(b.max - a.max)};
+}
+
+__device__ __forceinline__ SoftmaxStats WarpStats(SoftmaxStats x) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    SoftmaxStats other = {__shfl_xor_sync(kFullMask, x.max, offset),
+                          __shfl_xor_sync(kFullMask, x.sum, offset)};
+    x = Combine(x, other);
+  }
+  return x;
+}
+
+__device__ __forceinline__ float WarpSum(float x) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    x += __shfl_xor_sync(kFullMask, x, offset);
+  }
+  return x;
+}
+
+/*! \brief Combine the stats over the thread block. All threads get the result. */
+__device__ __forceinline__ SoftmaxStats BlockStats(SoftmaxStats x) {
+  __shared__ float warp_max[kWarpSize];
+  __shared__ float warp_sum[kWarpSize];
+  const int warp = threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  x = WarpStats(x);
+  if (lane == 0) {
+    warp_max[warp] = x.max;
+    warp_sum[warp] = x.sum;
+  }
+  __syncthreads();
+  if (lane < blockDim.x / kWarpSize) {
+    x = {warp_max[lane], warp_sum[lane]};
+  } else {
+    x = {-INFINITY, 0.0f};
+  }
+  x = WarpStats(x);
+  // Make sure all threads have read the partial stats before the buffers are reused.
+  __syncthreads();
+  return x;
+}
+
+/*! \brief Sum x over the thread block. All threads get the result. */
+__device__ __forceinline__ float BlockSum(float x) {
+  __shared__ float warp_sums[kWarpSize];
+  const int warp = threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  x = WarpSum(x);
+  if (lane == 0) {
+    warp_sums[warp] = x;
+  }
+  __syncthreads();
+  x = lane < blockDim.x / kWarpSize ? warp_sums[lane] : 0.0f;
+  x = WarpSum(x);
+  __syncthreads();
+  return x;
+}
+
+/*! \brief Whether the row of the label counts in the loss. Invalid labels are ignored as well. */
+template <typename L>
+__device__ __forceinline__ bool IsCounted(L label, int64_t num_classes, int64_t ignore_index) {
+  return label != ignore_index && label >= 0 && label < num_classes;
+}
+
+/*! \brief The logsumexp of a row and, if needed, the sum of its logits. */
+template <typename T>
+__device__ __forceinline__ float RowLogSumExp(const T* x, int64_t num_classes, bool need_sum,
+                                              float* x_sum) {
+  SoftmaxStats stats = {-INFINITY, 0.0f};
+  float sum = 0.0f;
+  for (int64_t c = threadIdx.x; c < num_classes; c += blockDim.x) {
+    const float v = ToFloat(x[c]);
+    stats = Combine(stats, {v, 1.0f});
+    sum += v;
+  }
+  stats = BlockStats(stats);
+  if (need_sum) {
+    *x_sum = BlockSum(sum);
+  }
+  return stats.max + __logf(stats.sum);
+}
+
+/*!
+ * \brief The loss of each row, which is (1 - smoothing) * (lse - x[label]) plus
+ * smoothing * mean(lse - x), i.e., lse - (1 - smoothing) * x[label] - smoothing * mean(x).
+ */
+template <typename T, typename L>
+__global__ void SoftmaxCrossEntropyRowKernel(const T* logits, const L* labels, float* row_loss,
+                                             int64_t num_classes, int64_t ignore_index,
+                                             float smoothing) {
+  const int64_t row = blockIdx.x;
+  const L label = labels[row];
+  // The condition is uniform over the block, so the block may return as a whole.
+  if (!IsCounted(label, num_classes, ignore_index)) {
+    if (threadIdx.x == 0) {
+      row_loss[row] = 0.0f;
+    }
+    return;
+  }
+  const T* x = logits + row * num_classes;
+  float x_sum = 0.0f;
+  const float lse = RowLogSumExp(x, num_classes, smoothing > 0.0f, &x_sum);
+  if (threadIdx.x == 0) {
+    row_loss[row] = lse - (1.0f - smoothing) * ToFloat(x[label]) - smoothing * x_sum / num_classes;
+  }
+}
+
+/*! \brief Average the row losses over the counted rows in a single block. */
+template <typename L>
+__global__ void SoftmaxCrossEntropyMeanKernel(const float* row_loss, const L* labels, float* loss,
+                                              int64_t num_rows, int64_t num_classes,
+                                              int64_t ignore_index) {
+  float sum = 0.0f;
+  float count = 0.0f;
+  for (int64_t i = threadIdx.x; i < num_rows; i += blockDim.x) {
+    if (IsCounted(labels[i], num_classes, ignore_index)) {
+      sum += row_loss[i];
+      count += 1.0f;
+    }
+  }
+  sum = BlockSum(sum);
+  count = BlockSum(count);
+  if (threadIdx.x == 0) {
+    loss[0] = count > 0.0f ? sum / count : 0.0f;
+  }
+}
+
+/*! \brief Compute dy / (the number of counted rows) in a single block. */
+template <typename L>
+__global__ void SoftmaxCrossEntropyScaleKernel(const float* dy, const L* labels, float* scale,
+                                               int64_t num_rows, int64_t num_classes,
+                                               int64_t ignore_index) {
+  float count = 0.0f;
+  for (int64_t i = threadIdx.x; i < num_rows; i += blockDim.x) {
+    count += IsCounted(labels[i], num_classes, ignore_index) ? 1.0f : 0.0f;
+  }
+  count = BlockSum(count);
+  if (threadIdx.x == 0) {
+    scale[0] = count > 0.0f ? dy[0] / count : 0.0f;
+  }
+}
+
+/*! \brief The gradient of each row, which is (softmax(x) - target) * scale. */
+template <typename T, typename L>
+__global__ void SoftmaxCrossEntropyBackwardKernel(const T* logits, const L* labels,
+                                                  const float* scale, T* dx, int64_t num_classes,
+                                                  int64_t ignore_index, float smoothing) {
+  const int64_t row = blockIdx.x;
+  const L label = labels[row];
+  const T* x = logits + row * num_classes;
+  T* out = dx + row * num_classes;
+  if (!IsCounted(label, num_classes, ignore_index)) {
+    for (int64_t c = threadIdx.x; c < num_classes; c += blockDim.x) {
+      out[c] = FromFloat<T>(0.0f);
+    }
+    return;
+  }
+  const float lse = RowLogSumExp(x, num_classes, false, nullptr);
+  const float s = scale[0];
+  const float off = smoothing / num_classes;
+  for (int64_t c = threadIdx.x; c < num_classes; c += blockDim.x) {
+    float g = __expf(ToFloat(x[c]) - lse) - off;
+    if (c == label) {
+      g -= 1.0f - smoothing;
+    }
+    out[c] = FromFloat<T>(g * s);
+  }
+}
+
+/*! \brief The threads of a row block, which are fewer for the small rows. */
+int RowThreads(int64_t num_classes) {
+  int64_t threads = (num_classes + kWarpSize - 1) / kWarpSize * kWarpSize;
+  return static_cast<int>(std::min<int64_t>(std::max<int64_t>(threads, kWarpSize), kMaxThreads));
+}
+
+}  // namespace
+
+int64_t softmax_cross_entropy_workspace(int64_t num_rows) {
+  return std::max<int64_t>(num_rows, 1) * sizeof(float);
+}
+
+template <typename T, typename L>
+void softmax_cross_entropy_forward_cuda(const T* logits, const L* labels, float* loss,
+                                        int64_t num_rows, int64_t num_classes,
+                                        int64_t ignore_index, float smoothing, void* workspace,
+                                        void* stream) {
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  float* row_loss = static_cast<float*>(workspace);
+  if (num_rows > 0) {
+    SoftmaxCrossEntropyRowKernel<T, L><<<num_rows, RowThreads(num_classes), 0, s>>>(
+        logits, labels, row_loss, num_classes, ignore_index, smoothing);
+  }
+  SoftmaxCrossEntropyMeanKernel<L><<<1, kMaxThreads, 0, s>>>(row_loss, labels, loss, num_rows,
+                                                             num_classes, ignore_index);
+}
+
+template <typename T, typename L>
+void softmax_cross_entropy_backward_cuda(const float* dy, const T* logits, const L* labels, T* dx,
+                                         int64_t num_rows, int64_t num_classes,
+                                         int64_t ignore_index, float smoothing, void* workspace,
+                                         void* stream) {
+  if (num_rows == 0) {
+    return;
+  }
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  float* scale = static_cast<float*>(workspace);
+  SoftmaxCrossEntropyScaleKernel<L><<<1, kMaxThreads, 0, s>>>(dy, labels, scale, num_rows,
+                                                              num_classes, ignore_index);
+  SoftmaxCrossEntropyBackwardKernel<T, L><<<num_rows, RowThreads(num_classes), 0, s>>>(
+      logits, labels, scale, dx, num_classes, ignore_index, smoothing);
+}
+
+#define RAF_SOFTMAX_CROSS_ENTROPY_INSTANTIATE(T, L)                                              \
+  template void softmax_cross_entropy_forward_cuda<T, L>(const T*, const L*, float*, int64_t,    \
+                                                         int64_t, int64_t, float, void*, void*); \
+  template void softmax_cross_entropy_backward_cuda<T, L>(const float*, const T*, const L*, T*,  \
+                                                          int64_t, int64_t, int64_t, float,      \
+                                                          void*, void*);
+
+RAF_SOFTMAX_CROSS_ENTROPY_INSTANTIATE(float, int64_t);
+RAF_SOFTMAX_CROSS_ENTROPY_INSTANTIATE(float, int32_t);
+RAF_SOFTMAX_CROSS_ENTROPY_INSTANTIATE(__half, int64_t);
+RAF_SOFTMAX_CROSS_ENTROPY_INSTANTIATE(__half, int32_t);
+
+#undef RAF_SOFTMAX_CROSS_ENTROPY_INSTANTIATE
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
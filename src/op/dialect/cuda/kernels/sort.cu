@@ -0,0 +1,264 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/sort.cu
+ * \brief Sort and top-k cuda kernels along the last axis.
+ *
+ * A row of up to kBitonicMaxCols elements is sorted by one thread block with a bitonic sort in
+ * shared memory, which takes a single launch for the whole batch. A row of up to 64 elements is
+ * sorted by a single warp. Longer rows are sorted by the cub segmented radix sort, or by the cub
+ * radix sort if there is only one row, and the first k elements of each row are gathered after.
+ * Both ways order the equal keys by their positions, so the results are deterministic.
+ */
+#include <algorithm>
+#include <cub/cub.cuh>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kMaxThreads = 1024;
+/*! \brief The maximal row size that is sorted in shared memory. */
+constexpr int kBitonicMaxCols = 2048;
+/*! \brief The threads of the elementwise kernels. */
+constexpr int kThreads = 256;
+/*! \brief The alignment of the buffers in the workspace. */
+constexpr int64_t kWorkspaceAlign = 256;
+
+__host__ __forceinline__ int64_t CeilDiv(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+__host__ __forceinline__ int64_t AlignUp(int64_t bytes) {
+  return (bytes + kWorkspaceAlign - 1) / kWorkspaceAlign * kWorkspaceAlign;
+}
+
+__host__ __forceinline__ int NextPowerOfTwo(int64_t n) {
+  int p = 1;
+  while (p < n) {
+    p <<= 1;
+  }
+  return p;
+}
+
+template <typename T>
+__device__ __forceinline__ bool KeyLess(T a, T b) {
+  return a < b;
+}
+
+template <>
+__device__ __forceinline__ bool KeyLess<__half>(__half a, __half b) {
+  return __half2float(a) < __half2float(b);
+}
+
+/*!
+ * \brief Whether (key a, position ia) goes before (key b, position ib). The padding positions,
+ * which are not less than num_cols, go after all elements.
+ */
+template <typename T>
+__device__ __forceinline__ bool Before(T a, int ia, T b, int ib, int num_cols, bool is_ascend) {
+  if (ia >= num_cols || ib >= num_cols) {
+    return ib >= num_cols && ia < num_cols;
+  }
+  if (is_ascend ? KeyLess(a, b) : KeyLess(b, a)) {
+    return true;
+  }
+  if (is_ascend ? KeyLess(b, a) : KeyLess(a, b)) {
+    return false;
+  }
+  return ia < ib;
+}
+
+/*!
+ * \brief Sort each row in a block with the bitonic sort of padded_cols elements in shared memory,
+ * and write the first k elements. values or indices may be null if they are not needed.
+ */
+template <typename T, typename I>
+__global__ void BitonicTopkKernel(const T* data, T* values, I* indices, int num_cols,
+                                  int padded_cols, int k, bool is_ascend) {
+  extern __shared__ __align__(sizeof(int64_t)) unsigned char smem[];
+  T* keys = reinterpret_cast<T*>(smem);
+  int* pos = reinterpret_cast<int*>(keys + padded_cols);
+  const int64_t row = blockIdx.x;
+  const T* x = data + row * num_cols;
+  for (int i = threadIdx.x; i < padded_cols; i += blockDim.x) {
+    keys[i] = i < num_cols ? x[i] : x[0];
+    pos[i] = i;
+  }
+  for (int size = 2; size <= padded_cols; size <<= 1) {
+    for (int stride = size / 2; stride > 0; stride >>= 1) {
+      __syncthreads();
+      for (int t = threadIdx.x; t < padded_cols / 2; t += blockDim.x) {
+        int lo = 2 * t - (t & (stride - 1));
+        int hi = lo + stride;
+        // The subsequences are sorted in the alternating directions, and the last merge sorts the
+        // whole row in the given order.
+        bool forward = (lo & size) == 0;
+        bool hi_first = Before(keys[hi], pos[hi], keys[lo], pos[lo], num_cols, is_ascend);
+        if (hi_first == forward) {
+          T key = keys[lo];
+          keys[lo] = keys[hi];
+          keys[hi] = key;
+          int p = pos[lo];
+          pos[lo] = pos[hi];
+          pos[hi] = p;
+        }
+      }
+    }
+  }
+  __syncthreads();
+  for (int i = threadIdx.x; i < k; i += blockDim.x) {
+    if (values) {
+      values[row * k + i] = keys[i];
+    }
+    if (indices) {
+      indices[row * k + i] = static_cast<I>(pos[i]);
+    }
+  }
+}
+
+/*! \brief Initialize the positions of the elements in their rows and the row offsets. */
+__global__ void SegmentInitKernel(int* positions, int* offsets, int num_rows, int num_cols) {
+  int64_t i = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (i < static_cast<int64_t>(num_rows) * num_cols) {
+    positions[i] = i % num_cols;
+  }
+  if (i <= num_rows) {
+    offsets[i] = i * num_cols;
+  }
+}
+
+/*! \brief Gather the first k elements of each sorted row. */
+template <typename T, typename I>
+__global__ void GatherTopkKernel(const T* sorted_keys, const int* sorted_pos, T* values,
+                                 I* indices, int num_rows, int num_cols, int k) {
+  int64_t i = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (i >= static_cast<int64_t>(num_rows) * k) {
+    return;
+  }
+  int64_t src = i / k * num_cols + i % k;
+  if (values) {
+    values[i] = sorted_keys[src];
+  }
+  if (indices) {
+    indices[i] = static_cast<I>(sorted_pos[src]);
+  }
+}
+
+/*! \brief The buffers carved out of the workspace of the radix sort. */
+template <typename T>
+struct SortWorkspace {
+  T* sorted_keys;
+  int* positions;
+  int* sorted_pos;
+  int* offsets;
+  void* temp;
+
+  SortWorkspace(void* workspace, int num_rows, int num_cols) {
+    char* ptr = static_cast<char*>(workspace);
+    auto take = [&ptr](int64_t bytes) {
+      char* ret = ptr;
+      ptr += AlignUp(bytes);
+      return ret;
+    };
+    int64_t num = static_cast<int64_t>(num_rows) * num_cols;
+    sorted_keys = reinterpret_cast<T*>(take(sizeof(T) * num));
+    positions = reinterpret_cast<int*>(take(sizeof(int) * num));
+    sorted_pos = reinterpret_cast<int*>(take(sizeof(int) * num));
+    offsets = reinterpret_cast<int*>(take(sizeof(int) * (num_rows + 1)));
+    temp = ptr;
+  }
+
+  /*! \brief The bytes of the buffers before the temporary storage of cub. */
+  static int64_t BufferBytes(int num_rows, int num_cols) {
+    int64_t num = static_cast<int64_t>(num_rows) * num_cols;
+    return AlignUp(sizeof(T) * num) + 2 * AlignUp(sizeof(int) * num) +
+           AlignUp(sizeof(int) * (num_rows + 1));
+  }
+
+  /*! \brief Launch the radix sort, or get the bytes of its temporary storage if temp is null. */
+  static cudaError_t Sort(void* temp, size_t& temp_bytes, const T* keys, T* sorted_keys,
+                          const int* positions, int* sorted_pos, const int* offsets, int num_rows,
+                          int num_cols, bool is_ascend, cudaStream_t stream) {
+    int num = num_rows * num_cols;
+    if (num_rows == 1) {
+      return is_ascend ? cub::DeviceRadixSort::SortPairs(temp, temp_bytes, keys, sorted_keys,
+                                                         positions, sorted_pos, num, 0,
+                                                         sizeof(T) * 8, stream)
+                       : cub::DeviceRadixSort::SortPairsDescending(
+                             temp, temp_bytes, keys, sorted_keys, positions, sorted_pos, num, 0,
+                             sizeof(T) * 8, stream);
+    }
+    return is_ascend ? cub::DeviceSegmentedRadixSort::SortPairs(
+                           temp, temp_bytes, keys, sorted_keys, positions, sorted_pos, num,
+                           num_rows, offsets, offsets + 1, 0, sizeof(T) * 8, stream)
+                     : cub::DeviceSegmentedRadixSort::SortPairsDescending(
+                           temp, temp_bytes, keys, sorted_keys, positions, sorted_pos, num,
+                           num_rows, offsets, offsets + 1, 0, sizeof(T) * 8, stream);
+  }
+};
+
+}  // namespace
+
+template <typename T>
+int64_t topk_workspace(int num_rows, int num_cols, bool is_ascend) {
+  if (num_cols <= kBitonicMaxCols || num_rows == 0) {
+    return 0;
+  }
+  size_t temp_bytes = 0;
+  CUDA_CALL(SortWorkspace<T>::Sort(nullptr, temp_bytes, nullptr, nullptr, nullptr, nullptr,
+                                   nullptr, num_rows, num_cols, is_ascend, nullptr));
+  return SortWorkspace<T>::BufferBytes(num_rows, num_cols) + temp_bytes;
+}
+
+template <typename T, typename I>
+void topk_cuda(const T* data, T* values, I* indices, int num_rows, int num_cols, int k,
+               bool is_ascend, void* workspace, void* stream) {
+  if (num_rows == 0 || k == 0) {
+    return;
+  }
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  if (num_cols <= kBitonicMaxCols) {
+    int padded_cols = NextPowerOfTwo(num_cols);
+    int threads = std::min(std::max(padded_cols / 2, kWarpSize), kMaxThreads);
+    int smem_bytes = padded_cols * (sizeof(T) + sizeof(int));
+    BitonicTopkKernel<T, I><<<num_rows, threads, smem_bytes, s>>>(
+        data, values, indices, num_cols, padded_cols, k, is_ascend);
+    return;
+  }
+  SortWorkspace<T> ws(workspace, num_rows, num_cols);
+  int64_t num = static_cast<int64_t>(num_rows) * num_cols;
+  SegmentInitKernel<<<CeilDiv(std::max<int64_t>(num, num_rows + 1), kThreads), kThreads, 0, s>>>(
+      ws.positions, ws.offsets, num_rows, num_cols);
+  size_t temp_bytes = topk_workspace<T>(num_rows, num_cols, is_ascend) -
+                      SortWorkspace<T>::BufferBytes(num_rows, num_cols);
+  CUDA_CALL(SortWorkspace<T>::Sort(ws.temp, temp_bytes, data, ws.sorted_keys, ws.positions,
+                                   ws.sorted_pos, ws.offsets, num_rows, num_cols, is_ascend, s));
+  int64_t num_out = static_cast<int64_t>(num_rows) * k;
+  GatherTopkKernel<T, I><<<CeilDiv(num_out, kThreads), kThreads, 0, s>>>(
+      ws.sorted_keys, ws.sorted_pos, values, indices, num_rows, num_cols, k);
+}
+
+#define RAF_TOPK_INSTANTIATE(T)                                                                  \
+  template int64_t topk_workspace<T>(int, int, bool);                                            \
+  template void topk_cuda<T, int32_t>(const T*, T*, int32_t*, int, int, int, bool, void*, void*); \
+  template void topk_cuda<T, int64_t>(const T*, T*, int64_t*, int, int, int, bool, void*, void*);
+
+RAF_TOPK_INSTANTIATE(float);
+RAF_TOPK_INSTANTIATE(__half);
+RAF_TOPK_INSTANTIATE(int32_t);
+RAF_TOPK_INSTANTIATE(int64_t);
+
+#undef RAF_TOPK_INSTANTIATE
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
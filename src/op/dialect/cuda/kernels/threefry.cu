@@ -0,0 +1,93 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/threefry.cu
+ * \brief Distributions drawn from a Threefry key with the counter-based Threefry generator.
+ *
+ * The element i is drawn from Threefry2x64 with the counter (i, c1), where the key and c1 are
+ * folded from the words of the Threefry key. The key is read on the device and folded once per
+ * thread. The numbers match the TVM computes in python/raf/_tvm_op/random.py.
+ */
+#include <algorithm>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kThreads = 256;
+constexpr int kMaxBlocks = 65535;
+
+__host__ __forceinline__ int64_t CeilDiv(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+/*!
+ * \brief Write low + scale * u for a uniform u in [0, 1), or mean + stddev * z for a standard
+ * normal z if normal is true, where (a, b) is (low, scale) or (mean, stddev).
+ */
+template <typename T, bool normal>
+__global__ void ThreefryDistributionKernel(const uint64_t* key, int key_size, T* out, int64_t n,
+                                           float a, float b) {
+  uint64_t k0, k1, c1;
+  ThreefryFoldKey(key, key_size, &k0, &k1, &c1);
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < n;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    uint64_t x0, x1;
+    Threefry2x64(k0, k1, static_cast<uint64_t>(i), c1, &x0, &x1);
+    float value;
+    if (normal) {
+      // Box-Muller, where u1 is in (0, 1] so that its log is finite.
+      float u1 = Uint64ToUniform(x0) + 1.0f / 16777216.0f;
+      float u2 = Uint64ToUniform(x1);
+      value = sqrtf(-2.0f * logf(u1)) * cosf(6.283185307179586f * u2);
+    } else {
+      value = Uint64ToUniform(x0);
+    }
+    out[i] = FromFloat<T>(a + b * value);
+  }
+}
+
+template <typename T, bool normal>
+void ThreefryDistribution(const uint64_t* key, int key_size, T* out, int64_t n, float a, float b,
+                          void* stream) {
+  if (n == 0) {
+    return;
+  }
+  int blocks = static_cast<int>(std::min<int64_t>(CeilDiv(n, kThreads), kMaxBlocks));
+  ThreefryDistributionKernel<T, normal>
+      <<<blocks, kThreads, 0, static_cast<cudaStream_t>(stream)>>>(key, key_size, out, n, a, b);
+}
+
+}  // namespace
+
+template <typename T>
+void threefry_uniform_cuda(const uint64_t* key, int key_size, T* out, int64_t n, float low,
+                           float scale, void* stream) {
+  ThreefryDistribution<T, false>(key, key_size, out, n, low, scale, stream);
+}
+
+template <typename T>
+void threefry_normal_cuda(const uint64_t* key, int key_size, T* out, int64_t n, float mean,
+                          float stddev, void* stream) {
+  ThreefryDistribution<T, true>(key, key_size, out, n, mean, stddev, stream);
+}
+
+template void threefry_uniform_cuda<float>(const uint64_t*, int, float*, int64_t, float, float,
+                                           void*);
+template void threefry_uniform_cuda<__half>(const uint64_t*, int, __half*, int64_t, float, float,
+                                            void*);
+template void threefry_normal_cuda<float>(const uint64_t*, int, float*, int64_t, float, float,
+                                          void*);
+template void threefry_normal_cuda<__half>(const uint64_t*, int, __half*, int64_t, float, float,
+                                           void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,697 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/vision.cu
+ * \brief Box filtering, non-maximum suppression and roi align cuda kernels.
+ *
+ * The non-maximum suppression sorts the boxes of each batch by the cub segmented radix sort, and
+ * computes the suppression of every pair of the kept boxes in parallel as a bitmask, where the
+ * bit k of the row j is set if box j suppresses box k. A single block per batch then walks the
+ * sorted boxes greedily and ORs the rows of the kept boxes, so the sequential part only takes
+ * a few word operations per box. Valid boxes can be selected inline, which fuses get_valid_counts
+ * into the suppression without compacting the boxes first.
+ *
+ * The roi align backward gathers instead of scattering. A thread block owns a tile of the input
+ * gradient, collects the rois that overlap the tile and sums their contributions to each pixel of
+ * the tile, so there are no atomics and the result is deterministic.
+ */
+#include <float.h>
+#include <algorithm>
+#include <cub/cub.cuh>
+#include "./kernel_util.cuh"
+#include "./device_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kThreads = 256;
+/*! \brief The number of boxes in a word of the suppression mask. */
+constexpr int kMaskBits = 64;
+/*! \brief The side of the input gradient tile of the roi align backward. */
+constexpr int kRoiTile = 16;
+/*! \brief The alignment of the buffers in the workspace. */
+constexpr int64_t kWorkspaceAlign = 256;
+
+using MaskWord = unsigned long long;
+
+__host__ __device__ __forceinline__ int64_t CeilDiv(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+__host__ __forceinline__ int64_t AlignUp(int64_t bytes) {
+  return (bytes + kWorkspaceAlign - 1) / kWorkspaceAlign * kWorkspaceAlign;
+}
+
+template <typename T>
+__device__ __forceinline__ bool IsValidBox(const T* box, float threshold, int id_index,
+                                           int score_index) {
+  return ToFloat(box[score_index]) > threshold &&
+         (id_index < 0 || ToFloat(box[id_index]) >= 0.0f);
+}
+
+/*! \brief Compact the valid boxes of a batch to the front, one block per batch. */
+template <typename T>
+__global__ void GetValidCountsKernel(const T* data, const float* score_threshold, int* valid_count,
+                                     T* out, int* out_indices, int num_anchors, int box_size,
+                                     int id_index, int score_index) {
+  using BlockScan = cub::BlockScan<int, kThreads>;
+  __shared__ typename BlockScan::TempStorage temp;
+  __shared__ int base;
+  const int64_t b = blockIdx.x;
+  const T* x = data + b * num_anchors * box_size;
+  T* y = out + b * num_anchors * box_size;
+  int* idx = out_indices + b * num_anchors;
+  const float threshold = score_threshold[0];
+  if (threadIdx.x == 0) {
+    base = 0;
+  }
+  __syncthreads();
+  for (int start = 0; start < num_anchors; start += kThreads) {
+    int j = start + threadIdx.x;
+    int valid =
+        j < num_anchors && IsValidBox(x + j * box_size, threshold, id_index, score_index);
+    int offset, total;
+    BlockScan(temp).ExclusiveSum(valid, offset, total);
+    if (valid) {
+      int dst = base + offset;
+      for (int k = 0; k < box_size; ++k) {
+        y[dst * box_size + k] = x[j * box_size + k];
+      }
+      idx[dst] = j;
+    }
+    __syncthreads();
+    if (threadIdx.x == 0) {
+      base += total;
+    }
+    __syncthreads();
+  }
+  for (int j = base + threadIdx.x; j < num_anchors; j += kThreads) {
+    for (int k = 0; k < box_size; ++k) {
+      y[j * box_size + k] = FromFloat<T>(-1.0f);
+    }
+    idx[j] = -1;
+  }
+  if (threadIdx.x == 0) {
+    valid_count[b] = base;
+  }
+}
+
+/*!
+ * \brief Compute the sort keys of the boxes, one block per batch. The boxes to consider are the
+ * first valid_count boxes, or the valid boxes under score_threshold if valid_count is null. The
+ * other boxes go to the end. Without suppression, i.e., iou_threshold <= 0, the boxes keep their
+ * order instead of being sorted by the scores.
+ */
+template <typename T>
+__global__ void NmsPrepareKernel(const T* data, const int* valid_count,
+                                 const float* score_threshold, const float* iou_threshold,
+                                 float* keys, int* positions, int* offsets, int* valid_count_out,
+                                 int batch, int num_anchors, int box_size, int score_index,
+                                 int id_index) {
+  using BlockReduce = cub::BlockReduce<int, kThreads>;
+  __shared__ typename BlockReduce::TempStorage temp;
+  const int64_t b = blockIdx.x;
+  const T* x = data + b * num_anchors * box_size;
+  const bool sort_by_score = iou_threshold[0] > 0.0f;
+  int count = 0;
+  for (int j = threadIdx.x; j < num_anchors; j += kThreads) {
+    bool valid = valid_count ? j < valid_count[b]
+                             : IsValidBox(x + j * box_size, score_threshold[0], id_index,
+                                          score_index);
+    float score = sort_by_score ? ToFloat(x[j * box_size + score_index]) : 0.0f;
+    keys[b * num_anchors + j] = valid ? score : -INFINITY;
+    positions[b * num_anchors + j] = j;
+    count += valid;
+  }
+  count = BlockReduce(temp).Sum(count);
+  if (threadIdx.x == 0) {
+    valid_count_out[b] = count;
+    offsets[b] = b * num_anchors;
+    if (b == batch - 1) {
+      offsets[batch] = batch * num_anchors;
+    }
+  }
+}
+
+/*!
+ * \brief Gather the first nkeep sorted boxes of each batch, where nkeep is valid_count capped by
+ * top_k. The corners of the boxes are normalized to (left, top, right, bottom).
+ */
+template <typename T>
+__global__ void NmsGatherKernel(const T* data, const int* sorted_pos, const int* valid_count,
+                                const float* iou_threshold, T* rows, float4* boxes, float* scores,
+                                float* ids, int* sorted_idx, int* nkeep, int batch,
+                                int num_anchors, int box_size, NmsAttrs attrs) {
+  int64_t i = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (i >= static_cast<int64_t>(batch) * num_anchors) {
+    return;
+  }
+  int64_t b = i / num_anchors;
+  int j = i % num_anchors;
+  int vc = valid_count[b];
+  int keep = iou_threshold[0] > 0.0f && attrs.top_k > 0 && attrs.top_k < vc ? attrs.top_k : vc;
+  if (j == 0) {
+    nkeep[b] = keep;
+  }
+  if (j >= keep) {
+    sorted_idx[i] = -1;
+    return;
+  }
+  int src = sorted_pos[i];
+  const T* row = data + (b * num_anchors + src) * box_size;
+  sorted_idx[i] = src;
+  float x1 = ToFloat(row[attrs.coord_start]);
+  float y1 = ToFloat(row[attrs.coord_start + 1]);
+  float x2 = ToFloat(row[attrs.coord_start + 2]);
+  float y2 = ToFloat(row[attrs.coord_start + 3]);
+  boxes[i] = make_float4(fminf(x1, x2), fminf(y1, y2), fmaxf(x1, x2), fmaxf(y1, y2));
+  scores[i] = ToFloat(row[attrs.score_index]);
+  ids[i] = attrs.id_index >= 0 ? ToFloat(row[attrs.id_index]) : 0.0f;
+  if (rows) {
+    for (int k = 0; k < box_size; ++k) {
+      rows[i * box_size + k] = row[k];
+    }
+  }
+}
+
+__device__ __forceinline__ float IoU(float4 a, float4 b) {
+  float w = fmaxf(0.0f, fminf(a.z, b.z) - fmaxf(a.x, b.x));
+  float h = fmaxf(0.0f, fminf(a.w, b.w) - fmaxf(a.y, b.y));
+  float area = w * h;
+  float u = (a.z - a.x) * (a.w - a.y) + (b.z - b.x) * (b.w - b.y) - area;
+  return u <= 0.0f ? 0.0f : area / u;
+}
+
+/*!
+ * \brief Compute the suppression mask of a kMaskBits x kMaskBits block of box pairs. The bit k of
+ * the row j is set if box j suppresses box k, which requires k > j.
+ */
+__global__ void NmsMaskKernel(const float4* boxes, const float* scores, const float* ids,
+                              const int* nkeep, const float* iou_threshold, MaskWord* mask,
+                              int num_anchors, int col_blocks, int id_index, bool force_suppress) {
+  __shared__ float4 col_boxes[kMaskBits];
+  __shared__ float col_scores[kMaskBits];
+  __shared__ float col_ids[kMaskBits];
+  const int64_t b = blockIdx.z;
+  const int row_block = blockIdx.y;
+  const int col_block = blockIdx.x;
+  const int keep = nkeep[b];
+  const int row_start = row_block * kMaskBits;
+  const int col_start = col_block * kMaskBits;
+  if (col_block < row_block || row_start >= keep || col_start >= keep) {
+    return;
+  }
+  const int64_t base = b * num_anchors;
+  const int num_cols = min(kMaskBits, keep - col_start);
+  if (threadIdx.x < num_cols) {
+    col_boxes[threadIdx.x] = boxes[base + col_start + threadIdx.x];
+    col_scores[threadIdx.x] = scores[base + col_start + threadIdx.x];
+    col_ids[threadIdx.x] = ids[base + col_start + threadIdx.x];
+  }
+  __syncthreads();
+  const int j = row_start + threadIdx.x;
+  if (j >= keep) {
+    return;
+  }
+  const float4 box = boxes[base + j];
+  const float id = ids[base + j];
+  const float threshold = iou_threshold[0];
+  // A box suppresses the later boxes of positive scores and, unless forced, of the same class.
+  const bool can_suppress = id_index < 0 || id >= 0.0f;
+  MaskWord bits = 0;
+  for (int u = 0; u < num_cols; ++u) {
+    int k = col_start + u;
+    if (k > j && can_suppress && col_scores[u] > 0.0f &&
+        (force_suppress || id_index < 0 || col_ids[u] == id) &&
+        IoU(box, col_boxes[u]) >= threshold) {
+      bits |= MaskWord(1) << u;
+    }
+  }
+  mask[(base + j) * col_blocks + col_block] = bits;
+}
+
+__device__ __forceinline__ bool IsMasked(const MaskWord* mask, int j) {
+  return (mask[j / kMaskBits] >> (j % kMaskBits)) & 1;
+}
+
+/*!
+ * \brief Select the boxes greedily and write the outputs, one block per batch. A box is kept
+ * unless it is suppressed by a kept box or max_output_size boxes have been kept before it. Like
+ * TVM, the boxes of non-positive scores are neither counted nor suppressed.
+ */
+template <typename T>
+__global__ void NmsSelectKernel(const T* rows, const int* sorted_idx, const float* scores,
+                                const int* nkeep, const MaskWord* mask,
+                                const float* iou_threshold, const int* max_output_size,
+                                const int* indices, T* out, int* out_indices, int* out_count,
+                                int num_anchors, int box_size, int col_blocks,
+                                bool invalid_to_bottom) {
+  using BlockScan = cub::BlockScan<int, kThreads>;
+  __shared__ typename BlockScan::TempStorage temp;
+  __shared__ int keep_box, limit, base;
+  extern __shared__ MaskWord removed[];
+  const int64_t b = blockIdx.x;
+  const int64_t offset = b * num_anchors;
+  const int keep = nkeep[b];
+  const int words = CeilDiv(keep, kMaskBits);
+  for (int w = threadIdx.x; w < words; w += kThreads) {
+    removed[w] = 0;
+  }
+  if (threadIdx.x == 0) {
+    limit = num_anchors;
+    base = 0;
+  }
+  __syncthreads();
+  if (iou_threshold[0] > 0.0f) {
+    const int max_output = max_output_size[0];
+    int num_kept = 0;
+    for (int j = 0; j < keep; ++j) {
+      if (threadIdx.x == 0) {
+        keep_box = 0;
+        if (num_kept == max_output) {
+          limit = j;
+        } else if (scores[offset + j] > 0.0f && !IsMasked(removed, j)) {
+          keep_box = 1;
+          ++num_kept;
+        }
+      }
+      __syncthreads();
+      if (limit < num_anchors) {
+        break;
+      }
+      if (keep_box) {
+        const MaskWord* row = mask + (offset + j) * col_blocks;
+        for (int w = j / kMaskBits + threadIdx.x; w < words; w += kThreads) {
+          removed[w] |= row[w];
+        }
+      }
+      __syncthreads();
+    }
+  }
+  // Write the kept boxes in the sorted order, compacted to the front if needed.
+  const bool compact = out_indices != nullptr || invalid_to_bottom;
+  for (int start = 0; start < num_anchors; start += kThreads) {
+    int j = start + threadIdx.x;
+    int kept = j < keep && j < limit && !IsMasked(removed, j);
+    int dst = j, total = 0;
+    if (compact) {
+      int rank;
+      BlockScan(temp).ExclusiveSum(kept, rank, total);
+      dst = base + rank;
+    }
+    if (out_indices) {
+      if (kept) {
+        int idx = sorted_idx[offset + j];
+        out_indices[offset + dst] = indices ? indices[offset + idx] : idx;
+      }
+    } else if (kept) {
+      for (int k = 0; k < box_size; ++k) {
+        out[(offset + dst) * box_size + k] = rows[(offset + j) * box_size + k];
+      }
+    } else if (!compact && j < num_anchors) {
+      for (int k = 0; k < box_size; ++k) {
+        out[(offset + j) * box_size + k] = FromFloat<T>(-1.0f);
+      }
+    }
+    if (compact) {
+      __syncthreads();
+      if (threadIdx.x == 0) {
+        base += total;
+      }
+      __syncthreads();
+    }
+  }
+  if (!compact) {
+    return;
+  }
+  for (int j = base + threadIdx.x; j < num_anchors; j += kThreads) {
+    if (out_indices) {
+      out_indices[offset + j] = -1;
+    } else {
+      for (int k = 0; k < box_size; ++k) {
+        out[(offset + j) * box_size + k] = FromFloat<T>(-1.0f);
+      }
+    }
+  }
+  if (out_count && threadIdx.x == 0) {
+    out_count[b] = base;
+  }
+}
+
+/*! \brief The buffers carved out of the workspace of the non-maximum suppression. */
+template <typename T>
+struct NmsWorkspace {
+  float* keys;
+  float* sorted_keys;
+  int* positions;
+  int* sorted_pos;
+  int* offsets;
+  int* valid_count;
+  int* nkeep;
+  int* sorted_idx;
+  float4* boxes;
+  float* scores;
+  float* ids;
+  T* rows;
+  MaskWord* mask;
+  void* temp;
+  /*! \brief The bytes of the buffers before the temporary storage of cub. */
+  int64_t buffer_bytes;
+
+  NmsWorkspace(void* workspace, int batch, int num_anchors, int box_size) {
+    char* ptr = static_cast<char*>(workspace);
+    int64_t bytes = 0;
+    auto take = [&ptr, &bytes](int64_t n) {
+      char* ret = ptr + bytes;
+      bytes += AlignUp(n);
+      return ret;
+    };
+    int64_t num = static_cast<int64_t>(batch) * num_anchors;
+    keys = reinterpret_cast<float*>(take(sizeof(float) * num));
+    sorted_keys = reinterpret_cast<float*>(take(sizeof(float) * num));
+    positions = reinterpret_cast<int*>(take(sizeof(int) * num));
+    sorted_pos = reinterpret_cast<int*>(take(sizeof(int) * num));
+    offsets = reinterpret_cast<int*>(take(sizeof(int) * (batch + 1)));
+    valid_count = reinterpret_cast<int*>(take(sizeof(int) * batch));
+    nkeep = reinterpret_cast<int*>(take(sizeof(int) * batch));
+    sorted_idx = reinterpret_cast<int*>(take(sizeof(int) * num));
+    boxes = reinterpret_cast<float4*>(take(sizeof(float4) * num));
+    scores = reinterpret_cast<float*>(take(sizeof(float) * num));
+    ids = reinterpret_cast<float*>(take(sizeof(float) * num));
+    rows = reinterpret_cast<T*>(take(sizeof(T) * num * box_size));
+    int64_t col_blocks = CeilDiv(num_anchors, kMaskBits);
+    mask = reinterpret_cast<MaskWord*>(take(sizeof(MaskWord) * num * col_blocks));
+    temp = ptr + bytes;
+    buffer_bytes = bytes;
+  }
+
+  /*! \brief Launch the sort of the keys, or get the bytes of its temporary storage if temp is
+   * null. */
+  static cudaError_t Sort(void* temp, size_t& temp_bytes, const float* keys, float* sorted_keys,
+                          const int* positions, int* sorted_pos, const int* offsets, int batch,
+                          int num_anchors, cudaStream_t stream) {
+    int num = batch * num_anchors;
+    if (batch == 1) {
+      return cub::DeviceRadixSort::SortPairsDescending(temp, temp_bytes, keys, sorted_keys,
+                                                       positions, sorted_pos, num, 0,
+                                                       sizeof(float) * 8, stream);
+    }
+    return cub::DeviceSegmentedRadixSort::SortPairsDescending(
+        temp, temp_bytes, keys, sorted_keys, positions, sorted_pos, num, batch, offsets,
+        offsets + 1, 0, sizeof(float) * 8, stream);
+  }
+};
+
+/*! \brief The sampling grid of a roi, which matches the roi align of TVM. */
+struct RoiGrid {
+  int batch;
+  float start_h, start_w, bin_h, bin_w;
+  int grid_h, grid_w;
+
+  template <typename T>
+  __device__ __forceinline__ RoiGrid(const T* roi, float spatial_scale, int pooled_h,
+                                     int pooled_w, int sample_ratio) {
+    batch = static_cast<int>(ToFloat(roi[0]));
+    start_w = ToFloat(roi[1]) * spatial_scale;
+    start_h = ToFloat(roi[2]) * spatial_scale;
+    // The malformed rois are forced to be 1x1.
+    float roi_w = fmaxf(ToFloat(roi[3]) * spatial_scale - start_w, 1.0f);
+    float roi_h = fmaxf(ToFloat(roi[4]) * spatial_scale - start_h, 1.0f);
+    bin_h = roi_h / pooled_h;
+    bin_w = roi_w / pooled_w;
+    grid_h = sample_ratio > 0 ? sample_ratio : static_cast<int>(ceilf(roi_h / pooled_h));
+    grid_w = sample_ratio > 0 ? sample_ratio : static_cast<int>(ceilf(roi_w / pooled_w));
+  }
+
+  __device__ __forceinline__ float SampleY(int ph, int iy) const {
+    return start_h + ph * bin_h + (iy + 0.5f) * bin_h / grid_h;
+  }
+
+  __device__ __forceinline__ float SampleX(int pw, int ix) const {
+    return start_w + pw * bin_w + (ix + 0.5f) * bin_w / grid_w;
+  }
+};
+
+/*!
+ * \brief The weight of the pixel at index i along an axis of the given size in the bilinear
+ * interpolation at p. The samples out of [-1, size] are zeros, and the others are clamped.
+ */
+__device__ __forceinline__ float BilinearWeight(float p, int i, int size) {
+  if (p < -1.0f || p > size) {
+    return 0.0f;
+  }
+  p = fminf(fmaxf(p, 0.0f), size - 1.0f);
+  int low = static_cast<int>(floorf(p));
+  int high = min(static_cast<int>(ceilf(p)), size - 1);
+  float frac = p - low;
+  return (low == i ? 1.0f - frac : 0.0f) + (high == i ? frac : 0.0f);
+}
+
+template <typename T>
+__device__ __forceinline__ float BilinearSample(const T* plane, int height, int width, float y,
+                                                float x) {
+  if (y < -1.0f || x < -1.0f || y > height || x > width) {
+    return 0.0f;
+  }
+  y = fminf(fmaxf(y, 0.0f), height - 1.0f);
+  x = fminf(fmaxf(x, 0.0f), width - 1.0f);
+  int y_low = static_cast<int>(floorf(y));
+  int x_low = static_cast<int>(floorf(x));
+  int y_high = min(static_cast<int>(ceilf(y)), height - 1);
+  int x_high = min(static_cast<int>(ceilf(x)), width - 1);
+  float ly = y - y_low;
+  float lx = x - x_low;
+  float low = (1.0f - lx) * ToFloat(plane[y_low * width + x_low]) +
+              lx * ToFloat(plane[y_low * width + x_high]);
+  float high = (1.0f - lx) * ToFloat(plane[y_high * width + x_low]) +
+               lx * ToFloat(plane[y_high * width + x_high]);
+  return (1.0f - ly) * low + ly * high;
+}
+
+/*! \brief The roi align of NCHW data, one thread per output element. */
+template <typename T>
+__global__ void RoiAlignForwardKernel(const T* data, const T* rois, T* out, int channels,
+                                      int height, int width, int num_rois, int pooled_h,
+                                      int pooled_w, float spatial_scale, int sample_ratio,
+                                      bool max_mode) {
+  int64_t i = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (i >= static_cast<int64_t>(num_rois) * channels * pooled_h * pooled_w) {
+    return;
+  }
+  int pw = i % pooled_w;
+  int ph = (i / pooled_w) % pooled_h;
+  int c = (i / pooled_w / pooled_h) % channels;
+  int r = i / pooled_w / pooled_h / channels;
+  RoiGrid grid(rois + r * 5, spatial_scale, pooled_h, pooled_w, sample_ratio);
+  const T* plane = data + (static_cast<int64_t>(grid.batch) * channels + c) * height * width;
+  float acc = max_mode ? -FLT_MAX : 0.0f;
+  for (int iy = 0; iy < grid.grid_h; ++iy) {
+    float y = grid.SampleY(ph, iy);
+    for (int ix = 0; ix < grid.grid_w; ++ix) {
+      float v = BilinearSample(plane, height, width, y, grid.SampleX(pw, ix));
+      acc = max_mode ? fmaxf(acc, v) : acc + v;
+    }
+  }
+  out[i] = FromFloat<T>(max_mode ? acc : acc / (grid.grid_h * grid.grid_w));
+}
+
+/*! \brief The range of the samples along an axis that may touch the pixel i. */
+__device__ __forceinline__ void SampleRange(float start, float step, int num_samples, int i,
+                                            int size, int* first, int* last) {
+  // A sample touches the pixels around it, or the border pixels if it is clamped.
+  float lo = i == 0 ? -1.0f : i - 1.0f;
+  float hi = i == size - 1 ? static_cast<float>(size) : i + 1.0f;
+  *first = max(0, static_cast<int>(floorf((lo - start) / step - 0.5f)) - 1);
+  *last = min(num_samples - 1, static_cast<int>(ceilf((hi - start) / step - 0.5f)) + 1);
+}
+
+/*!
+ * \brief The avg roi align backward of NCHW data. A block owns a kRoiTile x kRoiTile tile of an
+ * image and a thread owns a pixel. The rois are filtered by the tile kThreads at a time, and each
+ * thread sums the contributions of the filtered rois to its pixel over all channels.
+ */
+template <typename T>
+__global__ void RoiAlignBackwardKernel(const T* dy, const T* rois, T* dx, int channels,
+                                       int height, int width, int num_rois, int pooled_h,
+                                       int pooled_w, float spatial_scale, int sample_ratio) {
+  using BlockScan = cub::BlockScan<int, kThreads>;
+  __shared__ typename BlockScan::TempStorage temp;
+  __shared__ int tile_rois[kThreads];
+  const int n = blockIdx.z;
+  const int h0 = blockIdx.y * kRoiTile;
+  const int w0 = blockIdx.x * kRoiTile;
+  const int h1 = min(h0 + kRoiTile, height) - 1;
+  const int w1 = min(w0 + kRoiTile, width) - 1;
+  const int h = h0 + threadIdx.x / kRoiTile;
+  const int w = w0 + threadIdx.x % kRoiTile;
+  const bool inside = h < height && w < width;
+  const int64_t plane = static_cast<int64_t>(height) * width;
+  T* grad = dx + static_cast<int64_t>(n) * channels * plane + h * width + w;
+  if (inside) {
+    for (int c = 0; c < channels; ++c) {
+      grad[c * plane] = FromFloat<T>(0.0f);
+    }
+  }
+  for (int start = 0; start < num_rois; start += kThreads) {
+    int r = start + threadIdx.x;
+    int hit = 0;
+    if (r < num_rois) {
+      RoiGrid grid(rois + r * 5, spatial_scale, pooled_h, pooled_w, sample_ratio);
+      // The rows and columns that the samples of the roi may touch after clamping.
+      float y0 = fminf(fmaxf(grid.start_h, 0.0f), height - 1.0f);
+      float y1 = fminf(fmaxf(grid.start_h + pooled_h * grid.bin_h, 0.0f), height - 1.0f);
+      float x0 = fminf(fmaxf(grid.start_w, 0.0f), width - 1.0f);
+      float x1 = fminf(fmaxf(grid.start_w + pooled_w * grid.bin_w, 0.0f), width - 1.0f);
+      hit = grid.batch == n && floorf(y0) <= h1 && ceilf(y1) >= h0 && floorf(x0) <= w1 &&
+            ceilf(x1) >= w0;
+    }
+    int rank, total;
+    BlockScan(temp).ExclusiveSum(hit, rank, total);
+    if (hit) {
+      tile_rois[rank] = r;
+    }
+    __syncthreads();
+    for (int t = 0; inside && t < total; ++t) {
+      const int roi = tile_rois[t];
+      RoiGrid grid(rois + roi * 5, spatial_scale, pooled_h, pooled_w, sample_ratio);
+      int ty0, ty1, tx0, tx1;
+      SampleRange(grid.start_h, grid.bin_h / grid.grid_h, pooled_h * grid.grid_h, h, height, &ty0,
+                  &ty1);
+      SampleRange(grid.start_w, grid.bin_w / grid.grid_w, pooled_w * grid.grid_w, w, width, &tx0,
+                  &tx1);
+      if (ty0 > ty1 || tx0 > tx1) {
+        continue;
+      }
+      const float scale = 1.0f / (grid.grid_h * grid.grid_w);
+      const T* g = dy + static_cast<int64_t>(roi) * channels * pooled_h * pooled_w;
+      for (int c = 0; c < channels; ++c) {
+        float acc = 0.0f;
+        for (int ty = ty0; ty <= ty1; ++ty) {
+          int ph = ty / grid.grid_h;
+          float wy = BilinearWeight(grid.SampleY(ph, ty % grid.grid_h), h, height);
+          if (wy == 0.0f) {
+            continue;
+          }
+          for (int tx = tx0; tx <= tx1; ++tx) {
+            int pw = tx / grid.grid_w;
+            float wx = BilinearWeight(grid.SampleX(pw, tx % grid.grid_w), w, width);
+            acc += wy * wx * ToFloat(g[(c * pooled_h + ph) * pooled_w + pw]);
+          }
+        }
+        if (acc != 0.0f) {
+          grad[c * plane] = FromFloat<T>(ToFloat(grad[c * plane]) + acc * scale);
+        }
+      }
+    }
+    __syncthreads();
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void get_valid_counts_cuda(const T* data, const float* score_threshold, int* valid_count, T* out,
+                           int* out_indices, int batch, int num_anchors, int box_size,
+                           int id_index, int score_index, void* stream) {
+  if (batch == 0) {
+    return;
+  }
+  GetValidCountsKernel<T><<<batch, kThreads, 0, static_cast<cudaStream_t>(stream)>>>(
+      data, score_threshold, valid_count, out, out_indices, num_anchors, box_size, id_index,
+      score_index);
+}
+
+template <typename T>
+int64_t nms_workspace(int batch, int num_anchors, int box_size) {
+  NmsWorkspace<T> ws(nullptr, batch, num_anchors, box_size);
+  size_t temp_bytes = 0;
+  CUDA_CALL(NmsWorkspace<T>::Sort(nullptr, temp_bytes, nullptr, nullptr, nullptr, nullptr,
+                                  nullptr, batch, num_anchors, nullptr));
+  return ws.buffer_bytes + temp_bytes;
+}
+
+template <typename T>
+void nms_cuda(const T* data, const int* valid_count, const int* indices,
+              const float* score_threshold, const int* max_output_size,
+              const float* iou_threshold, T* out, int* out_indices, int* out_count, int batch,
+              int num_anchors, int box_size, NmsAttrs attrs, void* workspace, void* stream) {
+  if (batch == 0 || num_anchors == 0) {
+    return;
+  }
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  NmsWorkspace<T> ws(workspace, batch, num_anchors, box_size);
+  int64_t num = static_cast<int64_t>(batch) * num_anchors;
+  int col_blocks = CeilDiv(num_anchors, kMaskBits);
+  NmsPrepareKernel<T><<<batch, kThreads, 0, s>>>(
+      data, valid_count, score_threshold, iou_threshold, ws.keys, ws.positions, ws.offsets,
+      ws.valid_count, batch, num_anchors, box_size, attrs.score_index, attrs.id_index);
+  size_t temp_bytes = nms_workspace<T>(batch, num_anchors, box_size) - ws.buffer_bytes;
+  CUDA_CALL(NmsWorkspace<T>::Sort(ws.temp, temp_bytes, ws.keys, ws.sorted_keys, ws.positions,
+                                  ws.sorted_pos, ws.offsets, batch, num_anchors, s));
+  NmsGatherKernel<T><<<CeilDiv(num, kThreads), kThreads, 0, s>>>(
+      data, ws.sorted_pos, ws.valid_count, iou_threshold, out_indices ? nullptr : ws.rows,
+      ws.boxes, ws.scores, ws.ids, ws.sorted_idx, ws.nkeep, batch, num_anchors, box_size, attrs);
+  dim3 mask_grid(col_blocks, col_blocks, batch);
+  NmsMaskKernel<<<mask_grid, kMaskBits, 0, s>>>(ws.boxes, ws.scores, ws.ids, ws.nkeep,
+                                                iou_threshold, ws.mask, num_anchors, col_blocks,
+                                                attrs.id_index, attrs.force_suppress);
+  NmsSelectKernel<T><<<batch, kThreads, sizeof(MaskWord) * col_blocks, s>>>(
+      ws.rows, ws.sorted_idx, ws.scores, ws.nkeep, ws.mask, iou_threshold, max_output_size,
+      indices, out, out_indices, out_count, num_anchors, box_size, col_blocks,
+      attrs.invalid_to_bottom);
+}
+
+template <typename T>
+void roi_align_forward_cuda(const T* data, const T* rois, T* out, int channels, int height,
+                            int width, int num_rois, int pooled_h, int pooled_w,
+                            float spatial_scale, int sample_ratio, bool max_mode, void* stream) {
+  int64_t num = static_cast<int64_t>(num_rois) * channels * pooled_h * pooled_w;
+  if (num == 0) {
+    return;
+  }
+  RoiAlignForwardKernel<T>
+      <<<CeilDiv(num, kThreads), kThreads, 0, static_cast<cudaStream_t>(stream)>>>(
+          data, rois, out, channels, height, width, num_rois, pooled_h, pooled_w, spatial_scale,
+          sample_ratio, max_mode);
+}
+
+template <typename T>
+void roi_align_backward_cuda(const T* dy, const T* rois, T* dx, int batch, int channels,
+                             int height, int width, int num_rois, int pooled_h, int pooled_w,
+                             float spatial_scale, int sample_ratio, void* stream) {
+  if (batch == 0 || height == 0 || width == 0) {
+    return;
+  }
+  dim3 grid(CeilDiv(width, kRoiTile), CeilDiv(height, kRoiTile), batch);
+  static_assert(kRoiTile * kRoiTile == kThreads, "A thread owns a pixel of the tile");
+  RoiAlignBackwardKernel<T><<<grid, kThreads, 0, static_cast<cudaStream_t>(stream)>>>(
+      dy, rois, dx, channels, height, width, num_rois, pooled_h, pooled_w, spatial_scale,
+      sample_ratio);
+}
+
+#define RAF_VISION_INSTANTIATE(T)                                                              \
+  template void get_valid_counts_cuda<T>(const T*, const float*, int*, T*, int*, int, int, int, \
+                                         int, int, void*);                                     \
+  template int64_t nms_workspace<T>(int, int, int);                                            \
+  template void nms_cuda<T>(const T*, const int*, const int*, const float*, const int*,        \
+                            const float*, T*, int*, int*, int, int, int, NmsAttrs, void*,      \
+                            void*);                                                            \
+  template void roi_align_forward_cuda<T>(const T*, const T*, T*, int, int, int, int, int,     \
+                                          int, float, int, bool, void*);                       \
+  template void roi_align_backward_cuda<T>(const T*, const T*, T*, int, int, int, int, int,    \
+                                           int, int, float, int, void*);
+
+RAF_VISION_INSTANTIATE(float);
+RAF_VISION_INSTANTIATE(__half);
+
+#undef RAF_VISION_INSTANTIATE
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -75,8 +75,8 @@ class LayerNormTrainImpl : public raf::op::OpEnv {
       n1_ *= x->shape[i];
     }
     auto datatype = x->dtype;
-    CHECK(datatype.code == kDLFloat);
-    CHECK((datatype.bits == 32) || (datatype.bits == 16));
+    CHECK((datatype.code == kDLFloat && (datatype.bits == 32 || datatype.bits == 16)) ||
+          (datatype.code == kDLBfloat && datatype.bits == 16));
   }
 
   void Execute(const CallValues& cv) override {
@@ -95,6 +95,13 @@ class LayerNormTrainImpl : public raf::op::OpEnv {
     float* mean_p = static_cast<float*>(mean->data);
     DLTensor* invvar = ir::Downcast<TensorValue>(out_tuple->fields[2]);
     float* invvar_p = static_cast<float*>(invvar->data);
+    if (x->dtype.code == kDLBfloat) {
+      HostApplyLayerNorm<BFloat16, float, BFloat16>(
+          static_cast<BFloat16*>(out->data), mean_p, invvar_p, static_cast<BFloat16*>(x->data), n1_,
+          n2_, static_cast<BFloat16*>(scale->data), static_cast<BFloat16*>(bias->data), eps_,
+          compute_stream_, maxGridY_);
+      return;
+    }
     switch (x->dtype.bits) {
       case 16: {
         HostApplyLayerNorm<Half, float, Half>(
@@ -192,8 +199,8 @@ class LayerNormTrainDxImpl : public raf::op::OpEnv {
     compute_stream_ = cuda_device_api->GetStream();
 
     auto datatype = x->dtype;
-    CHECK(datatype.code == kDLFloat);
-    CHECK((datatype.bits == 32) || (datatype.bits == 16));
+    CHECK((datatype.code == kDLFloat && (datatype.bits == 32 || datatype.bits == 16)) ||
+          (datatype.code == kDLBfloat && datatype.bits == 16));
   }
 
   void Execute(const CallValues& cv) override {
@@ -215,9 +222,16 @@ class LayerNormTrainDxImpl : public raf::op::OpEnv {
     DLTensor* dx = ir::Downcast<TensorValue>(out_tuple->fields[0]);
     DLTensor* dw = ir::Downcast<TensorValue>(out_tuple->fields[1]);
     DLTensor* db = ir::Downcast<TensorValue>(out_tuple->fields[2]);
-    CHECK(x->dtype.code == kDLFloat);
-    CHECK((x->dtype.bits == 32) || (x->dtype.bits == 16));
-
+    if (x->dtype.code == kDLBfloat) {
+      HostLayerNormGradient<BFloat16, BFloat16>(
+          static_cast<BFloat16*>(dy->data), mean_p, invvar_p, static_cast<BFloat16*>(x->data), n1_,
+          n2_, static_cast<BFloat16*>(scale->data), eps_, static_cast<BFloat16*>(dx->data),
+          static_cast<BFloat16*>(dw->data), static_cast<BFloat16*>(db->data),
+          part_grad_gamma_ != NULL ? static_cast<float*>(part_grad_gamma_) : NULL,
+          part_grad_beta_ != NULL ? static_cast<float*>(part_grad_beta_) : NULL, compute_stream_,
+          maxGridY_);
+      return;
+    }
     switch (x->dtype.bits) {
       case 16: {
         HostLayerNormGradient<Half, Half>(
@@ -0,0 +1,462 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/multi_tensor_optimizer.cc
+ * \brief SGD and Adam over a list of tensors, and the global norm of a list of tensors, with the
+ * multi-tensor CUDA kernels, and the update of the dynamic loss scale.
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/optimizer.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using namespace raf::op::schema;
+using device_api::DeviceAPI;
+#define CHUNK_SIZE 65536
+
+/*!
+ * \brief Check the dtypes of the tensor list of a multi-tensor optimizer, where the first group
+ * is the gradients in float32 or float16, the following groups are the float32 weights and
+ * states, and the optional last group is the float16 params.
+ * \return The error message, or an empty string if the dtypes are supported.
+ */
+std::string CheckMultiTensorOptimizerDTypes(const std::vector<BaseTensorValue>& tensors,
+                                            int num_groups, bool fp16_params,
+                                            DLDataType* grad_dtype) {
+  auto is_float = [](DLDataType dtype, int bits) {
+    return dtype.code == kDLFloat && dtype.bits == bits && dtype.lanes == 1;
+  };
+  int ntensors = tensors.size() / num_groups;
+  const DLTensor* g0 = tensors[0];
+  *grad_dtype = g0->dtype;
+  if (!is_float(*grad_dtype, 32) && !is_float(*grad_dtype, 16)) {
+    return "gradients should be in float32 or float16";
+  }
+  for (int i = 0; i < tensors.size(); ++i) {
+    const DLTensor* t = tensors[i];
+    int group = i / ntensors;
+    if (group == 0) {
+      if (t->dtype != *grad_dtype) {
+        return "gradients should have the same dtype";
+      }
+    } else if (fp16_params && group == num_groups - 1) {
+      if (!is_float(t->dtype, 16)) {
+        return "params should be in float16";
+      }
+    } else if (!is_float(t->dtype, 32)) {
+      return "weights and optimizer states should be in float32";
+    }
+  }
+  return "";
+}
+
+/*! \brief The number of elements of each of the first ntensors tensors. */
+std::vector<int> GetMultiTensorNumels(const std::vector<BaseTensorValue>& tensors, int ntensors) {
+  std::vector<int> numels;
+  for (int i = 0; i < ntensors; ++i) {
+    const DLTensor* t = tensors[i];
+    int numel = 1;
+    for (int j = 0; j < t->ndim; ++j) {
+      numel *= t->shape[j];
+    }
+    numels.push_back(numel);
+  }
+  return numels;
+}
+
+/*! \brief Check the optional global norm of the gradients, which is a float32 scalar. */
+std::string CheckGradNorm(const ir::Optional<BaseTensorValue>& grad_norm) {
+  if (grad_norm.defined()) {
+    const DLTensor* norm = grad_norm.value();
+    if (norm->ndim != 0 || norm->dtype.code != kDLFloat || norm->dtype.bits != 32) {
+      return "grad_norm should be a float32 scalar";
+    }
+  }
+  return "";
+}
+
+/*!
+ * \brief Check the optional loss scale that the gradients are scaled by, which is a float32 scalar
+ * and requires the global norm to detect the overflow.
+ */
+std::string CheckLossScale(const ir::Optional<BaseTensorValue>& grad_norm,
+                           const ir::Optional<BaseTensorValue>& loss_scale) {
+  if (loss_scale.defined()) {
+    const DLTensor* scale = loss_scale.value();
+    if (scale->ndim != 0 || scale->dtype.code != kDLFloat || scale->dtype.bits != 32) {
+      return "loss_scale should be a float32 scalar";
+    }
+    if (!grad_norm.defined()) {
+      return "loss_scale requires grad_norm";
+    }
+  }
+  return "";
+}
+
+class MultiTensorSgdImpl : public raf::op::OpEnv {
+ public:
+  explicit MultiTensorSgdImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.multi_tensor_sgd");
+    auto args = cv->args.as<MultiTensorSgdArgs>();
+    this->arg_indices = {fschema_index[op]("tensor_list")};
+    learning_rate_ = args->learning_rate;
+    momentum_ = args->momentum;
+    fp16_params_ = args->fp16_params;
+    has_grad_norm_ = args->grad_norm.defined();
+    max_grad_norm_ = args->max_grad_norm;
+    has_loss_scale_ = args->loss_scale.defined();
+
+    int num_groups = fp16_params_ ? 4 : 3;
+    std::string msg = CheckGradNorm(args->grad_norm);
+    if (msg.empty()) {
+      msg = CheckLossScale(args->grad_norm, args->loss_scale);
+    }
+    if (msg.empty()) {
+      msg = CheckMultiTensorOptimizerDTypes(args->tensor_list, num_groups, fp16_params_,
+                                            &grad_dtype_);
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] multi_tensor_sgd: " + msg);
+      return;
+    }
+    if (has_grad_norm_) {
+      this->arg_indices.push_back(fschema_index[op]("grad_norm"));
+    }
+    if (has_loss_scale_) {
+      this->arg_indices.push_back(fschema_index[op]("loss_scale"));
+    }
+    numels_ = GetMultiTensorNumels(args->tensor_list, args->tensor_list.size() / num_groups);
+
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<MultiTensorSgdArgs>();
+    Array<Value> tvalue = {args->tensor_list.begin(), args->tensor_list.end()};
+    std::vector<Value> inputs{TupleValue::make(tvalue)};
+    if (has_grad_norm_) {
+      inputs.push_back(args->grad_norm.value());
+    }
+    if (has_loss_scale_) {
+      inputs.push_back(args->loss_scale.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    TupleValue tuple = ir::Downcast<TupleValue>(inputs[0]);
+    std::vector<void*> tlist;
+    for (const auto& field : tuple->fields) {
+      DLTensor* tensor = ir::Downcast<TensorValue>(field);
+      tlist.push_back(tensor->data);
+    }
+    const float* grad_norm = nullptr;
+    const float* loss_scale = nullptr;
+    if (has_grad_norm_) {
+      DLTensor* norm = ir::Downcast<TensorValue>(inputs[1]);
+      grad_norm = static_cast<const float*>(norm->data);
+    }
+    if (has_loss_scale_) {
+      DLTensor* scale = ir::Downcast<TensorValue>(inputs[2]);
+      loss_scale = static_cast<const float*>(scale->data);
+    }
+    if (grad_dtype_.bits == 32) {
+      multi_tensor_sgd_cuda<float>(CHUNK_SIZE, tlist, learning_rate_, momentum_, fp16_params_,
+                                   grad_norm, max_grad_norm_, loss_scale, numels_,
+                                   compute_stream_);
+    } else {
+      multi_tensor_sgd_cuda<__half>(CHUNK_SIZE, tlist, learning_rate_, momentum_, fp16_params_,
+                                    grad_norm, max_grad_norm_, loss_scale, numels_,
+                                    compute_stream_);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.multi_tensor_sgd"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MultiTensorSgdImpl(cv);
+  }
+
+ private:
+  float learning_rate_;
+  float momentum_;
+  bool fp16_params_;
+  bool has_grad_norm_;
+  float max_grad_norm_;
+  bool has_loss_scale_;
+  DLDataType grad_dtype_;
+  std::vector<int> numels_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, multi_tensor_sgd, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.multi_tensor_sgd", MultiTensorSgdImpl::make);
+
+class MultiTensorAdamImpl : public raf::op::OpEnv {
+ public:
+  explicit MultiTensorAdamImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.multi_tensor_adam");
+    auto args = cv->args.as<MultiTensorAdamArgs>();
+    this->arg_indices = {
+        fschema_index[op]("tensor_list"),
+        fschema_index[op]("step"),
+    };
+    learning_rate_ = args->learning_rate;
+    beta1_ = args->beta1;
+    beta2_ = args->beta2;
+    eps_ = args->eps;
+    weight_decay_ = args->weight_decay;
+    bias_correction_ = args->bias_correction;
+    mode_ = args->mode;
+    fp16_params_ = args->fp16_params;
+    has_grad_norm_ = args->grad_norm.defined();
+    max_grad_norm_ = args->max_grad_norm;
+    has_loss_scale_ = args->loss_scale.defined();
+
+    const DLTensor* step = args->step;
+    if (step->ndim != 0 || step->dtype.code != kDLFloat || step->dtype.bits != 32) {
+      error_msgs.push_back("[CUDA] multi_tensor_adam: step should be a float32 scalar");
+      return;
+    }
+    int num_groups = fp16_params_ ? 5 : 4;
+    std::string msg = CheckGradNorm(args->grad_norm);
+    if (msg.empty()) {
+      msg = CheckLossScale(args->grad_norm, args->loss_scale);
+    }
+    if (msg.empty()) {
+      msg = CheckMultiTensorOptimizerDTypes(args->tensor_list, num_groups, fp16_params_,
+                                            &grad_dtype_);
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] multi_tensor_adam: " + msg);
+      return;
+    }
+    if (has_grad_norm_) {
+      this->arg_indices.push_back(fschema_index[op]("grad_norm"));
+    }
+    if (has_loss_scale_) {
+      this->arg_indices.push_back(fschema_index[op]("loss_scale"));
+    }
+    numels_ = GetMultiTensorNumels(args->tensor_list, args->tensor_list.size() / num_groups);
+
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<MultiTensorAdamArgs>();
+    Array<Value> tvalue = {args->tensor_list.begin(), args->tensor_list.end()};
+    std::vector<Value> inputs{TupleValue::make(tvalue), args->step};
+    if (has_grad_norm_) {
+      inputs.push_back(args->grad_norm.value());
+    }
+    if (has_loss_scale_) {
+      inputs.push_back(args->loss_scale.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    TupleValue tuple = ir::Downcast<TupleValue>(inputs[0]);
+    DLTensor* step = ir::Downcast<TensorValue>(inputs[1]);
+    std::vector<void*> tlist;
+    for (const auto& field : tuple->fields) {
+      DLTensor* tensor = ir::Downcast<TensorValue>(field);
+      tlist.push_back(tensor->data);
+    }
+    const float* step_ptr = static_cast<const float*>(step->data);
+    const float* grad_norm = nullptr;
+    const float* loss_scale = nullptr;
+    if (has_grad_norm_) {
+      DLTensor* norm = ir::Downcast<TensorValue>(inputs[2]);
+      grad_norm = static_cast<const float*>(norm->data);
+    }
+    if (has_loss_scale_) {
+      DLTensor* scale = ir::Downcast<TensorValue>(inputs[3]);
+      loss_scale = static_cast<const float*>(scale->data);
+    }
+    if (grad_dtype_.bits == 32) {
+      multi_tensor_adam_cuda<float>(CHUNK_SIZE, tlist, step_ptr, learning_rate_, beta1_, beta2_,
+                                    eps_, weight_decay_, bias_correction_, mode_, fp16_params_,
+                                    grad_norm, max_grad_norm_, loss_scale, numels_,
+                                    compute_stream_);
+    } else {
+      multi_tensor_adam_cuda<__half>(CHUNK_SIZE, tlist, step_ptr, learning_rate_, beta1_, beta2_,
+                                     eps_, weight_decay_, bias_correction_, mode_, fp16_params_,
+                                     grad_norm, max_grad_norm_, loss_scale, numels_,
+                                     compute_stream_);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.multi_tensor_adam"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MultiTensorAdamImpl(cv);
+  }
+
+ private:
+  float learning_rate_;
+  float beta1_;
+  float beta2_;
+  float eps_;
+  float weight_decay_;
+  bool bias_correction_;
+  int mode_;
+  bool fp16_params_;
+  bool has_grad_norm_;
+  float max_grad_norm_;
+  bool has_loss_scale_;
+  DLDataType grad_dtype_;
+  std::vector<int> numels_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, multi_tensor_adam, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.multi_tensor_adam", MultiTensorAdamImpl::make);
+
+class GlobalNormAndCheckImpl : public raf::op::OpEnv {
+ public:
+  explicit GlobalNormAndCheckImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.global_norm_and_check");
+    auto args = cv->args.as<GlobalNormAndCheckArgs>();
+    this->arg_indices = {fschema_index[op]("tensor_list")};
+    // The tensors share the constraints of the gradients of the optimizers.
+    std::string msg = CheckMultiTensorOptimizerDTypes(args->tensor_list, 1, false, &dtype_);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] global_norm_and_check: " + msg);
+      return;
+    }
+    numels_ = GetMultiTensorNumels(args->tensor_list, args->tensor_list.size());
+    RequestWorkspace(&workspace_, cv->device, global_norm_workspace(CHUNK_SIZE, numels_));
+
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<GlobalNormAndCheckArgs>();
+    Array<Value> tvalue = {args->tensor_list.begin(), args->tensor_list.end()};
+    Execute(std::vector<Value>{TupleValue::make(tvalue)}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    TupleValue tuple = ir::Downcast<TupleValue>(inputs[0]);
+    TupleValue out = ir::Downcast<TupleValue>(output);
+    DLTensor* norm = ir::Downcast<TensorValue>(out->fields[0]);
+    DLTensor* found_inf = ir::Downcast<TensorValue>(out->fields[1]);
+    std::vector<void*> tlist;
+    for (const auto& field : tuple->fields) {
+      DLTensor* tensor = ir::Downcast<TensorValue>(field);
+      tlist.push_back(tensor->data);
+    }
+    float* norm_ptr = static_cast<float*>(norm->data);
+    bool* found_inf_ptr = static_cast<bool*>(found_inf->data);
+    if (dtype_.bits == 32) {
+      global_norm_and_check_cuda<float>(CHUNK_SIZE, tlist, numels_, norm_ptr, found_inf_ptr,
+                                        workspace_, compute_stream_);
+    } else {
+      global_norm_and_check_cuda<__half>(CHUNK_SIZE, tlist, numels_, norm_ptr, found_inf_ptr,
+                                         workspace_, compute_stream_);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.global_norm_and_check"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new GlobalNormAndCheckImpl(cv);
+  }
+
+ private:
+  DLDataType dtype_;
+  std::vector<int> numels_;
+  void* workspace_ = nullptr;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, global_norm_and_check, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.global_norm_and_check", GlobalNormAndCheckImpl::make);
+
+class UpdateLossScaleImpl : public raf::op::OpEnv {
+ public:
+  explicit UpdateLossScaleImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.update_loss_scale");
+    auto args = cv->args.as<UpdateLossScaleArgs>();
+    this->arg_indices = {
+        fschema_index[op]("grad_norm"),
+        fschema_index[op]("loss_scale"),
+        fschema_index[op]("good_steps"),
+    };
+    growth_factor_ = args->growth_factor;
+    backoff_factor_ = args->backoff_factor;
+    growth_interval_ = args->growth_interval;
+    min_scale_ = args->min_scale;
+
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<UpdateLossScaleArgs>();
+    Execute({args->grad_norm, args->loss_scale, args->good_steps}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* grad_norm = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* loss_scale = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* good_steps = ir::Downcast<TensorValue>(inputs[2]);
+    TupleValue out = ir::Downcast<TupleValue>(output);
+    DLTensor* new_loss_scale = ir::Downcast<TensorValue>(out->fields[0]);
+    DLTensor* new_good_steps = ir::Downcast<TensorValue>(out->fields[1]);
+    update_loss_scale_cuda(static_cast<const float*>(grad_norm->data),
+                           static_cast<const float*>(loss_scale->data),
+                           static_cast<const float*>(good_steps->data),
+                           static_cast<float*>(new_loss_scale->data),
+                           static_cast<float*>(new_good_steps->data), growth_factor_,
+                           backoff_factor_, growth_interval_, min_scale_, compute_stream_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.update_loss_scale"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new UpdateLossScaleImpl(cv);
+  }
+
+ private:
+  float growth_factor_;
+  float backoff_factor_;
+  int growth_interval_;
+  float min_scale_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, update_loss_scale, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.update_loss_scale", UpdateLossScaleImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
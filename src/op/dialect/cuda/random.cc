@@ -0,0 +1,112 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/random.cc
+ * \brief Threefry distributions cuda backend
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/random.h"
+#include "../../../common/shape_utils.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+using common::shape_utils::GetNumel;
+using op::schema::ThreefryNormalArgs;
+using op::schema::ThreefryUniformArgs;
+
+/*! \brief The name and the affine parameters (a, b) of a distribution, which is a + b * x. */
+void GetThreefryDistribution(const ThreefryUniformArgs* args, std::string* name, float* a,
+                             float* b) {
+  *name = "threefry_uniform";
+  *a = args->low;
+  *b = args->high - args->low;
+}
+
+void GetThreefryDistribution(const ThreefryNormalArgs* args, std::string* name, float* a,
+                             float* b) {
+  *name = "threefry_normal";
+  *a = args->mean;
+  *b = args->stddev;
+}
+
+/*!
+ * \brief The distributions drawn by the counter-based Threefry generator, which are only
+ * dispatched here when FuseTVM has not fused them into their consumers, e.g., for initializers.
+ */
+template <typename Args, bool normal>
+class ThreefryDistributionImpl : public raf::op::OpEnv {
+ public:
+  explicit ThreefryDistributionImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto args = cv->args.as<Args>();
+    GetThreefryDistribution(args, &name_, &a_, &b_);
+    static auto op = ir::Op::Get("raf.op." + name_);
+    this->arg_indices = {fschema_index[op]("key")};
+    const DLTensor* key = args->key;
+    key_size_ = key->shape[0];
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<Args>();
+    Execute(std::vector<Value>{args->key}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* key = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    const uint64_t* key_ptr = static_cast<const uint64_t*>(key->data);
+    int64_t n = GetNumel(*out);
+    void* stream = cuda_device_api->GetStream();
+    if (out->dtype.bits == 32) {
+      float* out_ptr = static_cast<float*>(out->data);
+      if (normal) {
+        threefry_normal_cuda<float>(key_ptr, key_size_, out_ptr, n, a_, b_, stream);
+      } else {
+        threefry_uniform_cuda<float>(key_ptr, key_size_, out_ptr, n, a_, b_, stream);
+      }
+    } else {
+      __half* out_ptr = static_cast<__half*>(out->data);
+      if (normal) {
+        threefry_normal_cuda<__half>(key_ptr, key_size_, out_ptr, n, a_, b_, stream);
+      } else {
+        threefry_uniform_cuda<__half>(key_ptr, key_size_, out_ptr, n, a_, b_, stream);
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda." + name_));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new ThreefryDistributionImpl(cv);
+  }
+
+ private:
+  std::string name_;
+  float a_, b_;
+  int key_size_;
+};
+
+using ThreefryUniformImpl = ThreefryDistributionImpl<ThreefryUniformArgs, false>;
+using ThreefryNormalImpl = ThreefryDistributionImpl<ThreefryNormalArgs, true>;
+
+RAF_REGISTER_DIALECT_OP(cuda, threefry_uniform, 20);
+RAF_REGISTER_DIALECT_OP(cuda, threefry_normal, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.threefry_uniform", ThreefryUniformImpl::make);
+RAF_OP_ENV_MAKER("raf.op.cuda.threefry_normal", ThreefryNormalImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,187 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/reduce.cc
+ * \brief Reduction cuda backend
+ */
+#include <algorithm>
+#include <numeric>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "raf/value.h"
+#include "../../schema/likes.h"
+#include "../../schema/reduce.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using op::schema::L2NormArgs;
+using op::schema::ReduceArgs;
+using op::schema::SumArgs;
+using device_api::DeviceAPI;
+
+std::string ReduceOpName(ReduceMode mode) {
+  switch (mode) {
+    case ReduceMode::kSum:
+      return "sum";
+    case ReduceMode::kMean:
+      return "mean";
+    case ReduceMode::kMax:
+      return "max";
+    case ReduceMode::kMin:
+      return "min";
+    case ReduceMode::kL2Norm:
+      return "l2norm";
+  }
+  return "";
+}
+
+/*! \brief The normalized, sorted axes, or their complement if exclude is true. */
+std::vector<int64_t> NormalizeReduceAxes(const std::vector<int64_t>& axis, bool exclude,
+                                         int ndim) {
+  std::vector<bool> reduced(ndim, false);
+  for (int64_t i : axis) {
+    reduced[i < 0 ? i + ndim : i] = true;
+  }
+  std::vector<int64_t> ret;
+  for (int i = 0; i < ndim; ++i) {
+    if (reduced[i] != exclude) {
+      ret.push_back(i);
+    }
+  }
+  return ret;
+}
+
+/*! \brief The reduced axes of max, min and mean, where no axis means all axes. */
+std::vector<int64_t> GetReducedAxes(const ReduceArgs* args, int ndim) {
+  if (args->axis.empty()) {
+    std::vector<int64_t> axis(ndim);
+    std::iota(axis.begin(), axis.end(), 0);
+    return NormalizeReduceAxes(axis, args->exclude, ndim);
+  }
+  return NormalizeReduceAxes(args->axis, args->exclude, ndim);
+}
+
+/*! \brief The reduced axes of sum, where no axis means all axes unless keepdims is empty. */
+std::vector<int64_t> GetReducedAxes(const SumArgs* args, int ndim) {
+  std::vector<int64_t> axis = NormalizeReduceAxes(args->axis, args->exclude, ndim);
+  if (axis.empty() && !args->keepdims.empty()) {
+    return NormalizeReduceAxes({}, true, ndim);
+  }
+  return axis;
+}
+
+std::vector<int64_t> GetReducedAxes(const L2NormArgs* args, int ndim) {
+  return NormalizeReduceAxes({}, true, ndim);
+}
+
+/*!
+ * \brief View x as [outer, n, inner] to be reduced over n. Returns false if the reduced axes are
+ * not adjacent once the axes of size 1 are ignored.
+ */
+bool GetReduceShape(const DLTensor* x, const std::vector<int64_t>& axis, int64_t* outer,
+                    int64_t* n, int64_t* inner) {
+  *outer = *n = *inner = 1;
+  for (int i = 0; i < x->ndim; ++i) {
+    if (x->shape[i] == 1) {
+      continue;
+    }
+    if (std::find(axis.begin(), axis.end(), i) != axis.end()) {
+      if (*inner > 1) {
+        return false;
+      }
+      *n *= x->shape[i];
+    } else if (*n > 1) {
+      *inner *= x->shape[i];
+    } else {
+      *outer *= x->shape[i];
+    }
+  }
+  return true;
+}
+
+template <typename Args, ReduceMode mode>
+class ReduceImpl : public raf::op::OpEnv {
+ public:
+  explicit ReduceImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op." + ReduceOpName(mode));
+    auto args = cv->args.as<Args>();
+    const DLTensor* x = args->x;
+    std::string msg;
+    if (x->dtype.code != kDLFloat || (x->dtype.bits != 32 && x->dtype.bits != 16)) {
+      msg = "only float32 and float16 are supported, but got " +
+            tvm::runtime::DLDataType2String(x->dtype);
+    } else if (!GetReduceShape(x, GetReducedAxes(args, x->ndim), &outer_, &n_, &inner_)) {
+      msg = "only adjacent axes can be reduced";
+    } else if (n_ == 0 || outer_ * n_ * inner_ == 0) {
+      msg = "empty tensors are not supported";
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] " + ReduceOpName(mode) + ": " + msg);
+      return;
+    }
+    this->arg_indices = {fschema_index[op]("x")};
+    RequestWorkspace(&workspace_, cv->device, reduce_workspace(outer_, n_, inner_));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<Args>();
+    Execute(std::vector<Value>{args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    if (x->dtype.bits == 32) {
+      reduce_cuda<float>(static_cast<const float*>(x->data), static_cast<float*>(out->data),
+                         outer_, n_, inner_, mode, workspace_, stream);
+    } else {
+      reduce_cuda<__half>(static_cast<const __half*>(x->data), static_cast<__half*>(out->data),
+                          outer_, n_, inner_, mode, workspace_, stream);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda." + ReduceOpName(mode)));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new ReduceImpl(cv);
+  }
+
+ private:
+  int64_t outer_, n_, inner_;
+  void* workspace_ = nullptr;
+};
+
+using SumImpl = ReduceImpl<SumArgs, ReduceMode::kSum>;
+using MeanImpl = ReduceImpl<ReduceArgs, ReduceMode::kMean>;
+using MaxImpl = ReduceImpl<ReduceArgs, ReduceMode::kMax>;
+using MinImpl = ReduceImpl<ReduceArgs, ReduceMode::kMin>;
+using L2NormImpl = ReduceImpl<L2NormArgs, ReduceMode::kL2Norm>;
+
+// Registered above cublas, whose l2norm only remains for float64.
+RAF_REGISTER_DIALECT_OP(cuda, sum, 20);
+RAF_REGISTER_DIALECT_OP(cuda, mean, 20);
+RAF_REGISTER_DIALECT_OP(cuda, max, 20);
+RAF_REGISTER_DIALECT_OP(cuda, min, 20);
+RAF_REGISTER_DIALECT_OP(cuda, l2norm, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.sum", SumImpl::make);
+RAF_OP_ENV_MAKER("raf.op.cuda.mean", MeanImpl::make);
+RAF_OP_ENV_MAKER("raf.op.cuda.max", MaxImpl::make);
+RAF_OP_ENV_MAKER("raf.op.cuda.min", MinImpl::make);
+RAF_OP_ENV_MAKER("raf.op.cuda.l2norm", L2NormImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,276 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/rms_norm.cc
+ * \brief RMS norm and rotary position embedding cuda backend
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "raf/value.h"
+#include "../../schema/nn.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+namespace {
+
+void CheckFloatDType(const DLTensor* x) {
+  CHECK(x->dtype.code == kDLFloat && (x->dtype.bits == 32 || x->dtype.bits == 16))
+      << "Unsupported dtype: " << DType(x->dtype).c_str();
+}
+
+/*! \brief Get the number of rows n1 and the row size n2 of x, which is normalized over the last
+ * dimension. */
+void GetRMSNormRowShape(const DLTensor* x, int* n1, int* n2) {
+  CheckFloatDType(x);
+  *n2 = x->shape[x->ndim - 1];
+  *n1 = 1;
+  for (int i = 0; i < x->ndim - 1; ++i) {
+    *n1 *= x->shape[i];
+  }
+}
+
+template <typename T>
+const T* DataOrNull(const DLTensor* tensor) {
+  return tensor ? static_cast<const T*>(tensor->data) : nullptr;
+}
+
+template <typename T>
+T* MutableDataOrNull(DLTensor* tensor) {
+  return tensor ? static_cast<T*>(tensor->data) : nullptr;
+}
+
+}  // namespace
+
+class RMSNormImpl : public raf::op::OpEnv {
+ public:
+  explicit RMSNormImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.rms_norm");
+    auto args = cv->args.as<op::schema::RmsNormArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    has_scale_ = args->scale.defined();
+    if (has_scale_) {
+      this->arg_indices.push_back(fschema_index[op]("scale"));
+    }
+    GetRMSNormRowShape(args->x, &n1_, &n2_);
+    eps_ = args->eps;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::RmsNormArgs>();
+    std::vector<Value> inputs{args->x};
+    if (has_scale_) {
+      inputs.push_back(args->scale.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x = Downcast<TensorValue>(inputs[0]);
+    DLTensor* scale = has_scale_ ? static_cast<DLTensor*>(Downcast<TensorValue>(inputs[1]))
+                                 : nullptr;
+    DLTensor* y = Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    switch (x->dtype.bits) {
+      case 32:
+        rms_norm_forward_cuda<float>(DataOrNull<float>(x), DataOrNull<float>(scale),
+                                     MutableDataOrNull<float>(y), n1_, n2_, eps_, stream);
+        return;
+      case 16:
+        rms_norm_forward_cuda<__half>(DataOrNull<__half>(x), DataOrNull<__half>(scale),
+                                      MutableDataOrNull<__half>(y), n1_, n2_, eps_, stream);
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.rms_norm"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new RMSNormImpl(cv);
+  }
+
+ private:
+  bool has_scale_;
+  int n1_, n2_;
+  float eps_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, rms_norm, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.rms_norm", RMSNormImpl::make);
+
+class RMSNormDxImpl : public raf::op::OpEnv {
+ public:
+  explicit RMSNormDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.rms_norm_dx");
+    auto args = cv->args.as<op::schema::RmsNormDxArgs>();
+    has_scale_ = args->scale.defined();
+    this->arg_indices = {fschema_index[op]("x")};
+    if (has_scale_) {
+      this->arg_indices.push_back(fschema_index[op]("scale"));
+    }
+    this->arg_indices.push_back(fschema_index[op]("dy"));
+    GetRMSNormRowShape(args->x, &n1_, &n2_);
+    eps_ = args->eps;
+    if (has_scale_) {
+      RequestWorkspace(&workspace_, cv->device, rms_norm_backward_workspace(n1_, n2_));
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::RmsNormDxArgs>();
+    std::vector<Value> inputs{args->x};
+    if (has_scale_) {
+      inputs.push_back(args->scale.value());
+    }
+    inputs.push_back(args->dy);
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    int i = 0;
+    auto next_input = [&]() -> DLTensor* { return Downcast<TensorValue>(inputs[i++]); };
+    DLTensor* x = next_input();
+    DLTensor* scale = has_scale_ ? next_input() : nullptr;
+    DLTensor* dy = next_input();
+    DLTensor* dx = nullptr;
+    DLTensor* dscale = nullptr;
+    if (has_scale_) {
+      TupleValue out_tuple = Downcast<TupleValue>(output);
+      dx = Downcast<TensorValue>(out_tuple->fields[0]);
+      dscale = Downcast<TensorValue>(out_tuple->fields[1]);
+    } else {
+      dx = Downcast<TensorValue>(output);
+    }
+    float* workspace = static_cast<float*>(workspace_);
+    void* stream = cuda_device_api->GetStream();
+    switch (x->dtype.bits) {
+      case 32:
+        rms_norm_backward_cuda<float>(DataOrNull<float>(x), DataOrNull<float>(scale),
+                                      DataOrNull<float>(dy), MutableDataOrNull<float>(dx),
+                                      MutableDataOrNull<float>(dscale), workspace, n1_, n2_, eps_,
+                                      stream);
+        return;
+      case 16:
+        rms_norm_backward_cuda<__half>(DataOrNull<__half>(x), DataOrNull<__half>(scale),
+                                       DataOrNull<__half>(dy), MutableDataOrNull<__half>(dx),
+                                       MutableDataOrNull<__half>(dscale), workspace, n1_, n2_,
+                                       eps_, stream);
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.rms_norm_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new RMSNormDxImpl(cv);
+  }
+
+ private:
+  bool has_scale_;
+  int n1_, n2_;
+  float eps_;
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, rms_norm_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.rms_norm_dx", RMSNormDxImpl::make);
+
+class RotaryEmbeddingImpl : public raf::op::OpEnv {
+ public:
+  explicit RotaryEmbeddingImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.rotary_embedding");
+    auto args = cv->args.as<op::schema::RotaryEmbeddingArgs>();
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("cos"),
+        fschema_index[op]("sin"),
+    };
+    const DLTensor* x = args->x;
+    const DLTensor* cos = args->cos;
+    CheckFloatDType(x);
+    CHECK(cos->dtype.code == x->dtype.code && cos->dtype.bits == x->dtype.bits)
+        << "cos and sin must have the same dtype as x";
+    int seq_axis = args->seq_axis < 0 ? args->seq_axis + x->ndim : args->seq_axis;
+    numel_ = 1;
+    for (int i = 0; i < x->ndim; ++i) {
+      numel_ *= x->shape[i];
+    }
+    inner_ = 1;
+    for (int i = seq_axis + 1; i < x->ndim - 1; ++i) {
+      inner_ *= x->shape[i];
+    }
+    head_dim_ = x->shape[x->ndim - 1];
+    seq_len_ = x->shape[seq_axis];
+    rot_half_ = cos->shape[1];
+    interleaved_ = args->interleaved;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::RotaryEmbeddingArgs>();
+    Execute({args->x, args->cos, args->sin}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x = Downcast<TensorValue>(inputs[0]);
+    DLTensor* cos = Downcast<TensorValue>(inputs[1]);
+    DLTensor* sin = Downcast<TensorValue>(inputs[2]);
+    DLTensor* y = Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    switch (x->dtype.bits) {
+      case 32:
+        rotary_embedding_cuda<float>(DataOrNull<float>(x), DataOrNull<float>(cos),
+                                     DataOrNull<float>(sin), MutableDataOrNull<float>(y), numel_,
+                                     head_dim_, rot_half_, seq_len_, inner_, interleaved_,
+                                     stream);
+        return;
+      case 16:
+        rotary_embedding_cuda<__half>(DataOrNull<__half>(x), DataOrNull<__half>(cos),
+                                      DataOrNull<__half>(sin), MutableDataOrNull<__half>(y),
+                                      numel_, head_dim_, rot_half_, seq_len_, inner_,
+                                      interleaved_, stream);
+        return;
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.rotary_embedding"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new RotaryEmbeddingImpl(cv);
+  }
+
+ private:
+  int64_t numel_, inner_;
+  int head_dim_, seq_len_, rot_half_;
+  bool interleaved_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, rotary_embedding, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.rotary_embedding", RotaryEmbeddingImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,190 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/softmax_cross_entropy.cc
+ * \brief Fused softmax cross entropy cuda backend
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "raf/value.h"
+#include "../../schema/loss.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*! \brief Returns an error message if the logits and labels are not supported by the kernels. */
+std::string CheckSoftmaxCrossEntropyDType(const DLTensor* pred, const DLTensor* true_) {
+  if (pred->dtype.code != kDLFloat || (pred->dtype.bits != 16 && pred->dtype.bits != 32)) {
+    return "only float16 and float32 logits are supported, but got " +
+           tvm::runtime::DLDataType2String(pred->dtype);
+  }
+  if (true_->dtype.code != kDLInt || (true_->dtype.bits != 32 && true_->dtype.bits != 64)) {
+    return "only int32 and int64 labels are supported, but got " +
+           tvm::runtime::DLDataType2String(true_->dtype);
+  }
+  return "";
+}
+
+template <typename T, typename L>
+void SoftmaxCrossEntropyForward(const DLTensor* pred, const DLTensor* true_, DLTensor* loss,
+                                int64_t ignore_index, float smoothing, void* workspace) {
+  static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+  softmax_cross_entropy_forward_cuda<T, L>(
+      static_cast<const T*>(pred->data), static_cast<const L*>(true_->data),
+      static_cast<float*>(loss->data), pred->shape[0], pred->shape[1], ignore_index, smoothing,
+      workspace, cuda_device_api->GetStream());
+}
+
+template <typename T, typename L>
+void SoftmaxCrossEntropyBackward(const DLTensor* dy, const DLTensor* pred, const DLTensor* true_,
+                                 DLTensor* dx, int64_t ignore_index, float smoothing,
+                                 void* workspace) {
+  static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+  softmax_cross_entropy_backward_cuda<T, L>(
+      static_cast<const float*>(dy->data), static_cast<const T*>(pred->data),
+      static_cast<const L*>(true_->data), static_cast<T*>(dx->data), pred->shape[0],
+      pred->shape[1], ignore_index, smoothing, workspace, cuda_device_api->GetStream());
+}
+
+class SoftmaxCrossEntropyImpl : public raf::op::OpEnv {
+ public:
+  explicit SoftmaxCrossEntropyImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.softmax_cross_entropy");
+    auto args = cv->args.as<op::schema::SoftmaxCrossEntropyArgs>();
+    const DLTensor* pred = args->y_pred;
+    std::string msg = CheckSoftmaxCrossEntropyDType(pred, args->y_true);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] softmax_cross_entropy: " + msg);
+      return;
+    }
+    this->arg_indices = {fschema_index[op]("y_true"), fschema_index[op]("y_pred")};
+    ignore_index_ = args->ignore_index;
+    smoothing_ = args->label_smoothing;
+    RequestWorkspace(&workspace_, cv->device, softmax_cross_entropy_workspace(pred->shape[0]));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::SoftmaxCrossEntropyArgs>();
+    Execute({args->y_true, args->y_pred}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* true_ = Downcast<TensorValue>(inputs[0]);
+    DLTensor* pred = Downcast<TensorValue>(inputs[1]);
+    DLTensor* loss = Downcast<TensorValue>(output);
+    bool is_half = pred->dtype.bits == 16;
+    bool is_int64 = true_->dtype.bits == 64;
+    if (is_half && is_int64) {
+      SoftmaxCrossEntropyForward<__half, int64_t>(pred, true_, loss, ignore_index_, smoothing_,
+                                                  workspace_);
+    } else if (is_half) {
+      SoftmaxCrossEntropyForward<__half, int32_t>(pred, true_, loss, ignore_index_, smoothing_,
+                                                  workspace_);
+    } else if (is_int64) {
+      SoftmaxCrossEntropyForward<float, int64_t>(pred, true_, loss, ignore_index_, smoothing_,
+                                                 workspace_);
+    } else {
+      SoftmaxCrossEntropyForward<float, int32_t>(pred, true_, loss, ignore_index_, smoothing_,
+                                                 workspace_);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.softmax_cross_entropy"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new SoftmaxCrossEntropyImpl(cv);
+  }
+
+ private:
+  int64_t ignore_index_;
+  float smoothing_;
+  /*! \brief The loss of each row before the mean. */
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, softmax_cross_entropy, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.softmax_cross_entropy", SoftmaxCrossEntropyImpl::make);
+
+class SoftmaxCrossEntropyDpredImpl : public raf::op::OpEnv {
+ public:
+  explicit SoftmaxCrossEntropyDpredImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.softmax_cross_entropy_dpred");
+    auto args = cv->args.as<op::schema::SoftmaxCrossEntropyDpredArgs>();
+    const DLTensor* dy = args->dy;
+    std::string msg = CheckSoftmaxCrossEntropyDType(args->y_pred, args->y_true);
+    if (msg.empty() && (dy->dtype.code != kDLFloat || dy->dtype.bits != 32)) {
+      msg = "only float32 dy is supported";
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] softmax_cross_entropy_dpred: " + msg);
+      return;
+    }
+    this->arg_indices = {fschema_index[op]("dy"), fschema_index[op]("y_true"),
+                         fschema_index[op]("y_pred")};
+    ignore_index_ = args->ignore_index;
+    smoothing_ = args->label_smoothing;
+    RequestWorkspace(&workspace_, cv->device, sizeof(float));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::SoftmaxCrossEntropyDpredArgs>();
+    Execute({args->dy, args->y_true, args->y_pred}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* dy = Downcast<TensorValue>(inputs[0]);
+    DLTensor* true_ = Downcast<TensorValue>(inputs[1]);
+    DLTensor* pred = Downcast<TensorValue>(inputs[2]);
+    DLTensor* dx = Downcast<TensorValue>(output);
+    bool is_half = pred->dtype.bits == 16;
+    bool is_int64 = true_->dtype.bits == 64;
+    if (is_half && is_int64) {
+      SoftmaxCrossEntropyBackward<__half, int64_t>(dy, pred, true_, dx, ignore_index_, smoothing_,
+                                                   workspace_);
+    } else if (is_half) {
+      SoftmaxCrossEntropyBackward<__half, int32_t>(dy, pred, true_, dx, ignore_index_, smoothing_,
+                                                   workspace_);
+    } else if (is_int64) {
+      SoftmaxCrossEntropyBackward<float, int64_t>(dy, pred, true_, dx, ignore_index_, smoothing_,
+                                                  workspace_);
+    } else {
+      SoftmaxCrossEntropyBackward<float, int32_t>(dy, pred, true_, dx, ignore_index_, smoothing_,
+                                                  workspace_);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.softmax_cross_entropy_dpred"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new SoftmaxCrossEntropyDpredImpl(cv);
+  }
+
+ private:
+  int64_t ignore_index_;
+  float smoothing_;
+  /*! \brief The scale of the gradient, which is dy over the number of the counted rows. */
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, softmax_cross_entropy_dpred, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.softmax_cross_entropy_dpred", SoftmaxCrossEntropyDpredImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
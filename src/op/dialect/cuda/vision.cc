@@ -0,0 +1,519 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/vision.cc
+ * \brief get_valid_counts, non_max_suppression and roi_align cuda backend
+ */
+#include <algorithm>
+#include <climits>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/device_api.h"
+#include "raf/value.h"
+#include "../../schema/vision.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*! \brief The maximal number of anchors whose suppression state fits in shared memory. */
+constexpr int64_t kNmsMaxAnchors = 48 * 1024 * 8;
+
+bool IsFloat16Or32(const DLTensor* tensor) {
+  return tensor->dtype.code == kDLFloat && (tensor->dtype.bits == 16 || tensor->dtype.bits == 32);
+}
+
+/*! \brief Returns an error message if the [batch, num_anchors, box_size] boxes are unsupported. */
+std::string CheckBoxes(const DLTensor* data) {
+  if (!IsFloat16Or32(data)) {
+    return "unsupported dtype " + tvm::runtime::DLDataType2String(data->dtype);
+  }
+  if (data->ndim != 3) {
+    return "the boxes must be 3-D, but got " + std::to_string(data->ndim) + "-D";
+  }
+  if (data->shape[1] > kNmsMaxAnchors || data->shape[0] * data->shape[1] >= INT_MAX) {
+    return "too many boxes: " + std::to_string(data->shape[0] * data->shape[1]);
+  }
+  return "";
+}
+
+/*!
+ * \brief Returns an error message if the scalar tensor is not of the given dtype on the GPU,
+ * where the kernels read it from.
+ */
+std::string CheckScalar(const DLTensor* tensor, const std::string& name, DLDataType dtype) {
+  if (tensor->device.device_type != kDLCUDA) {
+    return name + " must be on the GPU";
+  }
+  if (tensor->dtype.code != dtype.code || tensor->dtype.bits != dtype.bits) {
+    return name + " must be " + tvm::runtime::DLDataType2String(dtype) + ", but got " +
+           tvm::runtime::DLDataType2String(tensor->dtype);
+  }
+  return "";
+}
+
+/*! \brief Launch get_valid_counts on the [batch, num_anchors, box_size] boxes. */
+void GetValidCounts(const DLTensor* data, const DLTensor* score_threshold, DLTensor* valid_count,
+                    DLTensor* out, DLTensor* out_indices, int id_index, int score_index) {
+  static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+  void* stream = cuda_device_api->GetStream();
+  int batch = data->shape[0], num_anchors = data->shape[1], box_size = data->shape[2];
+  auto launch = [&](auto dummy) {
+    using T = decltype(dummy);
+    get_valid_counts_cuda<T>(static_cast<const T*>(data->data),
+                             static_cast<const float*>(score_threshold->data),
+                             static_cast<int*>(valid_count->data), static_cast<T*>(out->data),
+                             static_cast<int*>(out_indices->data), batch, num_anchors, box_size,
+                             id_index, score_index, stream);
+  };
+  if (data->dtype.bits == 32) {
+    launch(float());
+  } else {
+    launch(__half());
+  }
+}
+
+int64_t NmsWorkspaceBytes(const DLTensor* data) {
+  int batch = data->shape[0], num_anchors = data->shape[1], box_size = data->shape[2];
+  return data->dtype.bits == 32 ? nms_workspace<float>(batch, num_anchors, box_size)
+                                : nms_workspace<__half>(batch, num_anchors, box_size);
+}
+
+/*!
+ * \brief Launch the non-maximum suppression, where valid_count and indices are null if the valid
+ * boxes are selected by score_threshold inline. output is the suppressed boxes, or the tuple of
+ * the kept indices and their counts if return_indices is true.
+ */
+void NonMaxSuppression(const DLTensor* data, const DLTensor* valid_count, const DLTensor* indices,
+                       const DLTensor* score_threshold, const DLTensor* max_output_size,
+                       const DLTensor* iou_threshold, const Value& output, bool return_indices,
+                       const NmsAttrs& attrs, void* workspace) {
+  static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+  void* stream = cuda_device_api->GetStream();
+  int batch = data->shape[0], num_anchors = data->shape[1], box_size = data->shape[2];
+  DLTensor* out = nullptr;
+  DLTensor* out_indices = nullptr;
+  DLTensor* out_count = nullptr;
+  if (return_indices) {
+    TupleValue out_tuple = Downcast<TupleValue>(output);
+    out_indices = Downcast<TensorValue>(out_tuple->fields[0]);
+    out_count = Downcast<TensorValue>(out_tuple->fields[1]);
+  } else {
+    out = Downcast<TensorValue>(output);
+  }
+  auto launch = [&](auto dummy) {
+    using T = decltype(dummy);
+    nms_cuda<T>(static_cast<const T*>(data->data),
+                valid_count ? static_cast<const int*>(valid_count->data) : nullptr,
+                indices ? static_cast<const int*>(indices->data) : nullptr,
+                score_threshold ? static_cast<const float*>(score_threshold->data) : nullptr,
+                static_cast<const int*>(max_output_size->data),
+                static_cast<const float*>(iou_threshold->data),
+                out ? static_cast<T*>(out->data) : nullptr,
+                out_indices ? static_cast<int*>(out_indices->data) : nullptr,
+                out_count ? static_cast<int*>(out_count->data) : nullptr, batch, num_anchors,
+                box_size, attrs, workspace, stream);
+  };
+  if (data->dtype.bits == 32) {
+    launch(float());
+  } else {
+    launch(__half());
+  }
+}
+
+/*! \brief Check the thresholds of the non-maximum suppression. */
+std::string CheckNmsThresholds(const DLTensor* max_output_size, const DLTensor* iou_threshold) {
+  std::string msg = CheckScalar(max_output_size, "max_output_size", DLDataType{kDLInt, 32, 1});
+  if (msg.empty()) {
+    msg = CheckScalar(iou_threshold, "iou_threshold", DLDataType{kDLFloat, 32, 1});
+  }
+  return msg;
+}
+
+class GetValidCountsImpl : public raf::op::OpEnv {
+ public:
+  explicit GetValidCountsImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.get_valid_counts");
+    auto args = cv->args.as<op::schema::GetValidCountsArgs>();
+    std::string msg = CheckBoxes(args->data);
+    if (msg.empty()) {
+      msg = CheckScalar(args->score_threshold, "score_threshold", DLDataType{kDLFloat, 32, 1});
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] get_valid_counts: " + msg);
+      return;
+    }
+    this->arg_indices = {fschema_index[op]("data"), fschema_index[op]("score_threshold")};
+    id_index_ = args->id_index;
+    score_index_ = args->score_index;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::GetValidCountsArgs>();
+    Execute({args->data, args->score_threshold}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    TupleValue out_tuple = Downcast<TupleValue>(output);
+    GetValidCounts(Downcast<TensorValue>(inputs[0]), Downcast<TensorValue>(inputs[1]),
+                   Downcast<TensorValue>(out_tuple->fields[0]),
+                   Downcast<TensorValue>(out_tuple->fields[1]),
+                   Downcast<TensorValue>(out_tuple->fields[2]), id_index_, score_index_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.get_valid_counts"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new GetValidCountsImpl(cv);
+  }
+
+ private:
+  int id_index_, score_index_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, get_valid_counts, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.get_valid_counts", GetValidCountsImpl::make);
+
+class NonMaxSuppressionImpl : public raf::op::OpEnv {
+ public:
+  explicit NonMaxSuppressionImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.non_max_suppression");
+    auto args = cv->args.as<op::schema::NonMaxSuppressionArgs>();
+    std::string msg = CheckBoxes(args->data);
+    if (msg.empty()) {
+      msg = CheckNmsThresholds(args->max_output_size, args->iou_threshold);
+    }
+    const DLTensor* valid_count = args->valid_count;
+    const DLTensor* indices = args->indices;
+    if (msg.empty() && (valid_count->dtype.code != kDLInt || valid_count->dtype.bits != 32 ||
+                        indices->dtype.code != kDLInt || indices->dtype.bits != 32)) {
+      msg = "valid_count and indices must be int32";
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] non_max_suppression: " + msg);
+      return;
+    }
+    this->arg_indices = {
+        fschema_index[op]("data"),         fschema_index[op]("valid_count"),
+        fschema_index[op]("indices"),      fschema_index[op]("max_output_size"),
+        fschema_index[op]("iou_threshold")};
+    attrs_ = NmsAttrs{static_cast<int>(args->top_k),       static_cast<int>(args->coord_start),
+                      static_cast<int>(args->score_index), static_cast<int>(args->id_index),
+                      args->force_suppress,                args->invalid_to_bottom};
+    return_indices_ = args->return_indices;
+    RequestWorkspace(&workspace_, cv->device, NmsWorkspaceBytes(args->data));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::NonMaxSuppressionArgs>();
+    Execute({args->data, args->valid_count, args->indices, args->max_output_size,
+             args->iou_threshold},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    NonMaxSuppression(Downcast<TensorValue>(inputs[0]), Downcast<TensorValue>(inputs[1]),
+                      Downcast<TensorValue>(inputs[2]), nullptr, Downcast<TensorValue>(inputs[3]),
+                      Downcast<TensorValue>(inputs[4]), output, return_indices_, attrs_,
+                      workspace_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.non_max_suppression"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new NonMaxSuppressionImpl(cv);
+  }
+
+ private:
+  NmsAttrs attrs_;
+  bool return_indices_;
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, non_max_suppression, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.non_max_suppression", NonMaxSuppressionImpl::make);
+
+/*!
+ * \brief OpEnv for the fused functions in the following pattern, where the valid boxes are
+ * selected inline by the suppression instead of being compacted by get_valid_counts first:
+ *   - non_max_suppression(gvc.1, gvc.0, gvc.2, ...) where gvc = get_valid_counts(data, ...)
+ */
+class GetValidCountsNmsFusedImpl : public raf::op::OpEnv {
+ public:
+  explicit GetValidCountsNmsFusedImpl(const CallValues& cv) {
+    auto func = Downcast<ClosureValue>(cv->callee)->func;
+    const CallNode* gvc = nullptr;
+    const CallNode* nms = Match(func, &gvc);
+    if (!nms) {
+      error_msgs.push_back("[CUDA] Cannot JIT: unsupported pattern");
+      return;
+    }
+    Array<Value> args = GetListArgs(cv->args);
+    auto arg = [&](const Expr& expr) {
+      auto it = std::find(func->params.begin(), func->params.end(), Downcast<Var>(expr));
+      CHECK(it != func->params.end());
+      return static_cast<int>(it - func->params.begin());
+    };
+    // The inputs are data, score_threshold, max_output_size and iou_threshold.
+    arg_indices = {arg(gvc->args[0]), arg(gvc->args[1]), arg(nms->args[3]), arg(nms->args[4])};
+    const DLTensor* data = Downcast<TensorValue>(args[arg_indices[0]]);
+    std::string msg = CheckBoxes(data);
+    if (msg.empty()) {
+      msg = CheckScalar(Downcast<TensorValue>(args[arg_indices[1]]), "score_threshold",
+                        DLDataType{kDLFloat, 32, 1});
+    }
+    if (msg.empty()) {
+      msg = CheckNmsThresholds(Downcast<TensorValue>(args[arg_indices[2]]),
+                               Downcast<TensorValue>(args[arg_indices[3]]));
+    }
+    auto scalar = [&](const Expr& expr) {
+      return GetScalarValueData<int64_t>(args[arg(expr)]);
+    };
+    int64_t id_index = scalar(gvc->args[2]), score_index = scalar(gvc->args[3]);
+    attrs_ = NmsAttrs{static_cast<int>(scalar(nms->args[6])),
+                      static_cast<int>(scalar(nms->args[7])),
+                      static_cast<int>(scalar(nms->args[8])),
+                      static_cast<int>(scalar(nms->args[9])),
+                      static_cast<bool>(scalar(nms->args[5])),
+                      static_cast<bool>(scalar(nms->args[11]))};
+    if (msg.empty() && (id_index != attrs_.id_index || score_index != attrs_.score_index)) {
+      msg = "get_valid_counts and non_max_suppression must use the same id and score indices";
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] get_valid_counts_nms: " + msg);
+      return;
+    }
+    return_indices_ = scalar(nms->args[10]);
+    RequestWorkspace(&workspace_, cv->device, NmsWorkspaceBytes(data));
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.get_valid_counts_nms"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (int i : arg_indices) {
+      inputs.push_back(args[i]);
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    NonMaxSuppression(Downcast<TensorValue>(inputs[0]), nullptr, nullptr,
+                      Downcast<TensorValue>(inputs[1]), Downcast<TensorValue>(inputs[2]),
+                      Downcast<TensorValue>(inputs[3]), output, return_indices_, attrs_,
+                      workspace_);
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new GetValidCountsNmsFusedImpl(cv);
+  }
+
+ private:
+  /*! \brief Match the fused function and return the nms call, or null if unsupported. */
+  static const CallNode* Match(const Function& func, const CallNode** gvc) {
+    static const Op& gvc_op = Op::Get("raf.op.cuda.get_valid_counts");
+    static const Op& nms_op = Op::Get("raf.op.cuda.non_max_suppression");
+    const auto* nms = func->body.as<CallNode>();
+    if (!nms || nms->op != nms_op || nms->args.size() != 12) {
+      return nullptr;
+    }
+    // The boxes, the valid counts and the indices are the outputs 1, 0 and 2 of get_valid_counts.
+    for (int i = 0; i < 3; ++i) {
+      const auto* tgi = nms->args[i].as<TupleGetItemNode>();
+      const auto* call = tgi ? tgi->tuple.as<CallNode>() : nullptr;
+      if (!call || call->op != gvc_op || tgi->index != (i == 0 ? 1 : i == 1 ? 0 : 2) ||
+          (*gvc && *gvc != call)) {
+        return nullptr;
+      }
+      *gvc = call;
+    }
+    for (const auto& arg : (*gvc)->args) {
+      if (!arg.as<VarNode>()) {
+        return nullptr;
+      }
+    }
+    for (size_t i = 3; i < nms->args.size(); ++i) {
+      if (!nms->args[i].as<VarNode>()) {
+        return nullptr;
+      }
+    }
+    return nms;
+  }
+
+  NmsAttrs attrs_;
+  bool return_indices_;
+  void* workspace_ = nullptr;
+};
+
+RAF_OP_ENV_MAKER("raf.op.cuda._fused_op.get_valid_counts_nms", GetValidCountsNmsFusedImpl::make);
+
+/*! \brief Get the pooled height and width of roi_align. */
+void GetPooledSize(const std::vector<int64_t>& pooled_size, int* pooled_h, int* pooled_w) {
+  CHECK(pooled_size.size() == 1 || pooled_size.size() == 2)
+      << "pooled_size must have 1 or 2 elements, but got " << pooled_size.size();
+  *pooled_h = pooled_size[0];
+  *pooled_w = pooled_size.back();
+}
+
+/*! \brief Returns an error message if the roi align of data and rois is unsupported. */
+std::string CheckRoiAlign(const DLTensor* data, const DLTensor* rois, const std::string& layout) {
+  if (layout != "NCHW") {
+    return "only the NCHW layout is supported, but got " + layout;
+  }
+  if (!IsFloat16Or32(data) || data->dtype.bits != rois->dtype.bits || rois->ndim != 2 ||
+      rois->shape[1] != 5) {
+    return "unsupported data or rois";
+  }
+  return "";
+}
+
+class RoiAlignImpl : public raf::op::OpEnv {
+ public:
+  explicit RoiAlignImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.roi_align");
+    auto args = cv->args.as<op::schema::RoiAlignArgs>();
+    std::string msg = CheckRoiAlign(args->data, args->rois, args->layout);
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] roi_align: " + msg);
+      return;
+    }
+    this->arg_indices = {fschema_index[op]("data"), fschema_index[op]("rois")};
+    GetPooledSize(args->pooled_size, &pooled_h_, &pooled_w_);
+    spatial_scale_ = args->spatial_scale;
+    sample_ratio_ = args->sample_ratio;
+    max_mode_ = args->mode == "max";
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::RoiAlignArgs>();
+    Execute({args->data, args->rois}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    void* stream = cuda_device_api->GetStream();
+    DLTensor* data = Downcast<TensorValue>(inputs[0]);
+    DLTensor* rois = Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = Downcast<TensorValue>(output);
+    auto launch = [&](auto dummy) {
+      using T = decltype(dummy);
+      roi_align_forward_cuda<T>(static_cast<const T*>(data->data),
+                                static_cast<const T*>(rois->data), static_cast<T*>(out->data),
+                                data->shape[1], data->shape[2], data->shape[3], rois->shape[0],
+                                pooled_h_, pooled_w_, spatial_scale_, sample_ratio_, max_mode_,
+                                stream);
+    };
+    if (data->dtype.bits == 32) {
+      launch(float());
+    } else {
+      launch(__half());
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.roi_align"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new RoiAlignImpl(cv);
+  }
+
+ private:
+  int pooled_h_, pooled_w_;
+  float spatial_scale_;
+  int sample_ratio_;
+  bool max_mode_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, roi_align, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.roi_align", RoiAlignImpl::make);
+
+class RoiAlignDxImpl : public raf::op::OpEnv {
+ public:
+  explicit RoiAlignDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.roi_align_dx");
+    auto args = cv->args.as<op::schema::RoiAlignDxArgs>();
+    std::string msg = CheckRoiAlign(args->data, args->rois, args->layout);
+    if (msg.empty() && args->mode != "avg") {
+      msg = "only the avg mode is supported, but got " + args->mode;
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDA] roi_align_dx: " + msg);
+      return;
+    }
+    // The data is only needed for its shape.
+    this->arg_indices = {fschema_index[op]("rois"), fschema_index[op]("dy")};
+    GetPooledSize(args->pooled_size, &pooled_h_, &pooled_w_);
+    spatial_scale_ = args->spatial_scale;
+    sample_ratio_ = args->sample_ratio;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::RoiAlignDxArgs>();
+    Execute({args->rois, args->dy}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    void* stream = cuda_device_api->GetStream();
+    DLTensor* rois = Downcast<TensorValue>(inputs[0]);
+    DLTensor* dy = Downcast<TensorValue>(inputs[1]);
+    DLTensor* dx = Downcast<TensorValue>(output);
+    auto launch = [&](auto dummy) {
+      using T = decltype(dummy);
+      roi_align_backward_cuda<T>(static_cast<const T*>(dy->data),
+                                 static_cast<const T*>(rois->data), static_cast<T*>(dx->data),
+                                 dx->shape[0], dx->shape[1], dx->shape[2], dx->shape[3],
+                                 rois->shape[0], pooled_h_, pooled_w_, spatial_scale_,
+                                 sample_ratio_, stream);
+    };
+    if (dx->dtype.bits == 32) {
+      launch(float());
+    } else {
+      launch(__half());
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.roi_align_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new RoiAlignDxImpl(cv);
+  }
+
+ private:
+  int pooled_h_, pooled_w_;
+  float spatial_scale_;
+  int sample_ratio_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, roi_align_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.roi_align_dx", RoiAlignDxImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
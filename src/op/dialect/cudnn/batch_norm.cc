@@ -11,6 +11,7 @@
 #include "./cudnn_utils.h"
 #include "raf/ir.h"
 #include "raf/op_utils.h"
+#include "raf/registry.h"
 
 namespace raf {
 namespace op {
@@ -18,6 +19,7 @@ namespace cudnn {
 
 using namespace raf::value;
 using namespace raf::ir;
+using common::shape_utils::BytesCompactTensor;
 
 static auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
 
@@ -265,6 +267,264 @@ RAF_REGISTER_DIALECT_OP(cudnn, batch_norm_train_dxwb, 15);
 RAF_OP_ENV_MAKER("raf.op.cudnn.batch_norm_train_dxwb",
                  BatchNormTrainDxwbImplementedByCUDNNBatchNormalizationBackward::make);
 
+/*!
+ * \brief Returns an error message if the fused batch_norm_relu cannot be computed by the cuDNN
+ * persistent NHWC kernels, which only take 4D float16 NHWC tensors with channels of multiples of 4.
+ */
+std::string CheckBatchNormReluEx(const TensorType& x, const std::string& layout) {
+  if (layout != "NHWC") {
+    return "only NHWC is supported, but got " + layout;
+  }
+  if (x->shape.size() != 4) {
+    return "only 4D inputs are supported";
+  }
+  if (!x->dtype.is_float16()) {
+    return "only float16 inputs are supported";
+  }
+  const auto* channels = x->shape[3].as<tvm::IntImmNode>();
+  if (channels == nullptr || channels->value % 4 != 0) {
+    return "the number of channels must be a multiple of 4";
+  }
+  return "";
+}
+
+inline cudnnBatchNormOps_t GetBatchNormReluOps(bool with_z) {
+  return with_z ? CUDNN_BATCHNORM_OPS_BN_ADD_ACTIVATION : CUDNN_BATCHNORM_OPS_BN_ACTIVATION;
+}
+
+inline cudnnActivationDescriptor_t MakeReluDescriptor() {
+  cudnnActivationDescriptor_t res;
+  CUDNN_CALL(cudnnCreateActivationDescriptor(&res));
+  CUDNN_CALL(cudnnSetActivationDescriptor(res, CUDNN_ACTIVATION_RELU, CUDNN_PROPAGATE_NAN, 0));
+  return res;
+}
+
+RAF_REGISTER_GLOBAL("raf.backend.cudnn.GetBatchNormReluReserveSpaceSizeInBytes")
+    .set_body_typed([](TensorType x, std::string layout, bool with_z) {
+      if (!CheckBatchNormReluEx(x, layout).empty()) {
+        return (int64_t)0;
+      }
+      size_t reserveSpaceSizeInBytes;
+      cudnnTensorDescriptor_t xDesc = NormalizeTensorType(x, layout);
+      cudnnActivationDescriptor_t activationDesc = MakeReluDescriptor();
+      CUDNN_CALL(cudnnGetBatchNormalizationTrainingExReserveSpaceSize(
+          CUDNNThreadEntry::ThreadLocal()->handle, CUDNN_BATCHNORM_SPATIAL_PERSISTENT,
+          GetBatchNormReluOps(with_z), activationDesc, xDesc, &reserveSpaceSizeInBytes));
+      CUDNN_CALL(cudnnDestroyActivationDescriptor(activationDesc));
+      CUDNN_CALL(cudnnDestroyTensorDescriptor(xDesc));
+      return (int64_t)reserveSpaceSizeInBytes;
+    });
+
+class BatchNormReluTrainImplementedByCUDNNBatchNormalizationForwardTrainingEx
+    : public raf::op::OpEnv {
+  cudnnTensorDescriptor_t xDesc = nullptr;
+  cudnnTensorDescriptor_t bnScaleBiasMeanVarDesc = nullptr;
+  cudnnActivationDescriptor_t activationDesc = nullptr;
+  cudnnBatchNormOps_t bnOps;
+  bool with_z;
+  double epsilon;
+  double exponentialAverageFactor;
+  size_t workSpaceSizeInBytes;
+  void* workSpace;
+
+  explicit BatchNormReluTrainImplementedByCUDNNBatchNormalizationForwardTrainingEx(
+      const CallValues& cv) {
+    auto op = Op::Get("raf.op.batch_norm_relu_train");
+    auto args = cv->args.as<raf::op::schema::BatchNormReluArgs>();
+    DLTensor* x = args->x;
+    DLTensor* w = args->w;
+    auto xDesc_tt = SquashTensorShape(x, {});
+    std::string msg = CheckBatchNormReluEx(xDesc_tt, args->layout);
+    if (msg.empty() && (w->dtype.code != kDLFloat || w->dtype.bits != 32)) {
+      msg = "only float32 scale and bias are supported";
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDNN] batch_norm_relu_train: " + msg);
+      return;
+    }
+    with_z = args->z.defined();
+    this->arg_indices = {
+        fschema_index[op]("x"),           fschema_index[op]("running_mean"),
+        fschema_index[op]("running_var"), fschema_index[op]("w"),
+        fschema_index[op]("b"),
+    };
+    if (with_z) {
+      this->arg_indices.push_back(fschema_index[op]("z"));
+    }
+    // x, z and y are all in the same type and layout, so they share the descriptor.
+    xDesc = NormalizeTensorType(xDesc_tt, args->layout);
+    CUDNN_CALL(cudnnCreateTensorDescriptor(&bnScaleBiasMeanVarDesc));
+    CUDNN_CALL(cudnnDeriveBNTensorDescriptor(bnScaleBiasMeanVarDesc, xDesc,
+                                             CUDNN_BATCHNORM_SPATIAL_PERSISTENT));
+    activationDesc = MakeReluDescriptor();
+    bnOps = GetBatchNormReluOps(with_z);
+    epsilon = args->eps;
+    exponentialAverageFactor = args->momentum;
+    CUDNN_CALL(cudnnGetBatchNormalizationForwardTrainingExWorkspaceSize(
+        CUDNNThreadEntry::ThreadLocal()->handle, CUDNN_BATCHNORM_SPATIAL_PERSISTENT, bnOps, xDesc,
+        with_z ? xDesc : nullptr, xDesc, bnScaleBiasMeanVarDesc, activationDesc,
+        &workSpaceSizeInBytes));
+    RequestWorkspace(&workSpace, cv->device, workSpaceSizeInBytes);
+  }
+
+ public:
+  ~BatchNormReluTrainImplementedByCUDNNBatchNormalizationForwardTrainingEx() {
+    if (xDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyTensorDescriptor(xDesc));
+    }
+    if (bnScaleBiasMeanVarDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyTensorDescriptor(bnScaleBiasMeanVarDesc));
+    }
+    if (activationDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyActivationDescriptor(activationDesc));
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cudnn.batch_norm_relu_train"));
+  }
+
+  void Execute(const CallValues& cv) {
+    auto args = cv->args.as<raf::op::schema::BatchNormReluArgs>();
+    std::vector<Value> inputs{args->x, args->running_mean, args->running_var, args->w, args->b};
+    if (with_z) {
+      inputs.push_back(args->z.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) {
+    CHECK_EQ(inputs.size(), with_z ? 6 : 5);
+    TupleValue tv = Downcast<TupleValue>(output);
+    DLTensor* x = Downcast<TensorValue>(inputs[0]);
+    DLTensor* running_mean = Downcast<TensorValue>(inputs[1]);
+    DLTensor* running_var = Downcast<TensorValue>(inputs[2]);
+    DLTensor* w = Downcast<TensorValue>(inputs[3]);
+    DLTensor* b = Downcast<TensorValue>(inputs[4]);
+    void* z_data = with_z ? Downcast<TensorValue>(inputs[5]).operator DLTensor*()->data : nullptr;
+    DLTensor* out0 = Downcast<TensorValue>(tv->fields[0]);
+    DLTensor* reserve_space = Downcast<TensorValue>(tv->fields[3]);
+    // The saved mean and inverse variance are not kept, so the backward recomputes them.
+    CUDNN_CALL(cudnnBatchNormalizationForwardTrainingEx(
+        CUDNNThreadEntry::ThreadLocal()->handle, CUDNN_BATCHNORM_SPATIAL_PERSISTENT, bnOps,
+        CUDNNDType(x->dtype).const_addr<1>(), CUDNNDType(x->dtype).const_addr<0>(), xDesc, x->data,
+        with_z ? xDesc : nullptr, z_data, xDesc, out0->data, bnScaleBiasMeanVarDesc, w->data,
+        b->data, exponentialAverageFactor, running_mean->data, running_var->data, epsilon, nullptr,
+        nullptr, activationDesc, workSpace, workSpaceSizeInBytes, reserve_space->data,
+        BytesCompactTensor(*reserve_space)));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new BatchNormReluTrainImplementedByCUDNNBatchNormalizationForwardTrainingEx(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cudnn, batch_norm_relu_train, 15);
+RAF_OP_ENV_MAKER("raf.op.cudnn.batch_norm_relu_train",
+                 BatchNormReluTrainImplementedByCUDNNBatchNormalizationForwardTrainingEx::make);
+
+class BatchNormReluTrainDxwbImplementedByCUDNNBatchNormalizationBackwardEx
+    : public raf::op::OpEnv {
+  cudnnTensorDescriptor_t xDesc = nullptr;
+  cudnnTensorDescriptor_t dBnScaleBiasDesc = nullptr;
+  cudnnActivationDescriptor_t activationDesc = nullptr;
+  cudnnBatchNormOps_t bnOps;
+  bool with_z;
+  double epsilon;
+  size_t workSpaceSizeInBytes;
+  void* workSpace;
+
+  explicit BatchNormReluTrainDxwbImplementedByCUDNNBatchNormalizationBackwardEx(
+      const CallValues& cv) {
+    auto op = Op::Get("raf.op.batch_norm_relu_train_dxwb");
+    auto args = cv->args.as<raf::op::schema::BatchNormReluDxwbArgs>();
+    DLTensor* x = args->x;
+    DLTensor* w = args->w;
+    auto xDesc_tt = SquashTensorShape(x, {});
+    std::string msg = CheckBatchNormReluEx(xDesc_tt, args->layout);
+    if (msg.empty() && (w->dtype.code != kDLFloat || w->dtype.bits != 32)) {
+      msg = "only float32 scale and bias are supported";
+    }
+    if (!msg.empty()) {
+      error_msgs.push_back("[CUDNN] batch_norm_relu_train_dxwb: " + msg);
+      return;
+    }
+    this->arg_indices = {
+        fschema_index[op]("dy"), fschema_index[op]("x"), fschema_index[op]("w"),
+        fschema_index[op]("b"),  fschema_index[op]("y"), fschema_index[op]("reserve_space"),
+    };
+    with_z = args->with_z;
+    // dy, x, y, dx and dz are all in the same type and layout, so they share the descriptor.
+    xDesc = NormalizeTensorType(xDesc_tt, args->layout);
+    CUDNN_CALL(cudnnCreateTensorDescriptor(&dBnScaleBiasDesc));
+    CUDNN_CALL(cudnnDeriveBNTensorDescriptor(dBnScaleBiasDesc, xDesc,
+                                             CUDNN_BATCHNORM_SPATIAL_PERSISTENT));
+    activationDesc = MakeReluDescriptor();
+    bnOps = GetBatchNormReluOps(with_z);
+    epsilon = args->eps;
+    CUDNN_CALL(cudnnGetBatchNormalizationBackwardExWorkspaceSize(
+        CUDNNThreadEntry::ThreadLocal()->handle, CUDNN_BATCHNORM_SPATIAL_PERSISTENT, bnOps, xDesc,
+        xDesc, xDesc, with_z ? xDesc : nullptr, xDesc, dBnScaleBiasDesc, activationDesc,
+        &workSpaceSizeInBytes));
+    RequestWorkspace(&workSpace, cv->device, workSpaceSizeInBytes);
+  }
+
+ public:
+  ~BatchNormReluTrainDxwbImplementedByCUDNNBatchNormalizationBackwardEx() {
+    if (xDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyTensorDescriptor(xDesc));
+    }
+    if (dBnScaleBiasDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyTensorDescriptor(dBnScaleBiasDesc));
+    }
+    if (activationDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyActivationDescriptor(activationDesc));
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cudnn.batch_norm_relu_train_dxwb"));
+  }
+
+  void Execute(const CallValues& cv) {
+    auto args = cv->args.as<raf::op::schema::BatchNormReluDxwbArgs>();
+    Execute(std::vector<Value>{args->dy, args->x, args->w, args->b, args->y, args->reserve_space},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) {
+    CHECK_EQ(inputs.size(), 6);
+    TupleValue tv = Downcast<TupleValue>(output);
+    DLTensor* dy = Downcast<TensorValue>(inputs[0]);
+    DLTensor* x = Downcast<TensorValue>(inputs[1]);
+    DLTensor* w = Downcast<TensorValue>(inputs[2]);
+    DLTensor* b = Downcast<TensorValue>(inputs[3]);
+    DLTensor* y = Downcast<TensorValue>(inputs[4]);
+    DLTensor* reserve_space = Downcast<TensorValue>(inputs[5]);
+    DLTensor* dx = Downcast<TensorValue>(tv->fields[0]);
+    DLTensor* dw = Downcast<TensorValue>(tv->fields[1]);
+    DLTensor* db = Downcast<TensorValue>(tv->fields[2]);
+    void* dz_data = with_z ? Downcast<TensorValue>(tv->fields[3]).operator DLTensor*()->data
+                           : nullptr;
+    CUDNN_CALL(cudnnBatchNormalizationBackwardEx(
+        CUDNNThreadEntry::ThreadLocal()->handle, CUDNN_BATCHNORM_SPATIAL_PERSISTENT, bnOps,
+        CUDNNDType(dx->dtype).const_addr<1>(), CUDNNDType(dx->dtype).const_addr<0>(),
+        CUDNNDType(dw->dtype).const_addr<1>(), CUDNNDType(dw->dtype).const_addr<0>(), xDesc,
+        x->data, xDesc, y->data, xDesc, dy->data, with_z ? xDesc : nullptr, dz_data, xDesc,
+        dx->data, dBnScaleBiasDesc, w->data, b->data, dw->data, db->data, epsilon, nullptr,
+        nullptr, activationDesc, workSpace, workSpaceSizeInBytes, reserve_space->data,
+        BytesCompactTensor(*reserve_space)));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new BatchNormReluTrainDxwbImplementedByCUDNNBatchNormalizationBackwardEx(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cudnn, batch_norm_relu_train_dxwb, 15);
+RAF_OP_ENV_MAKER("raf.op.cudnn.batch_norm_relu_train_dxwb",
+                 BatchNormReluTrainDxwbImplementedByCUDNNBatchNormalizationBackwardEx::make);
+
 }  // namespace cudnn
 }  // namespace op
 }  // namespace raf
@@ -9,7 +9,6 @@
  */
 #include <queue>
 #include "../../schema/nn.h"
-#include "../3rdparty/tvm/src/runtime/file_utils.h"
 #include "./cudnn_utils.h"
 #include "raf/ir.h"
 #include "raf/memory_pool.h"
@@ -37,24 +36,22 @@ class CuDNNConvAlgoCacheEntry {
     return algo_perf_;
   }
 
-  static CuDNNConvAlgoCacheEntry Load(const std::string& path) {
-    std::string data;
-    tvm::runtime::LoadBinaryFromFile(path + "/value.bin", &data);
-    dmlc::MemoryStringStream reader(&data);
+  static CuDNNConvAlgoCacheEntry Deserialize(const std::string& data) {
+    std::string buf = data;
+    dmlc::MemoryStringStream reader(&buf);
     dmlc::Stream* stream = &reader;
 
     T algo_perf;
-    stream->Read(&algo_perf.algo);
-    stream->Read(&algo_perf.status);
-    stream->Read(&algo_perf.time);
-    stream->Read(&algo_perf.memory);
-    stream->Read(&algo_perf.determinism);
-    stream->Read(&algo_perf.mathType);
-    stream->Read(algo_perf.reserved);
+    CHECK(stream->Read(&algo_perf.algo) && stream->Read(&algo_perf.status) &&
+          stream->Read(&algo_perf.time) && stream->Read(&algo_perf.memory) &&
+          stream->Read(&algo_perf.determinism) && stream->Read(&algo_perf.mathType) &&
+          stream->Read(algo_perf.reserved, sizeof(algo_perf.reserved)) ==
+              sizeof(algo_perf.reserved))
+        << "Truncated cuDNN algorithm record";
     return CuDNNConvAlgoCacheEntry(algo_perf);
   }
 
-  bool Save(const std::string& path) {
+  std::string Serialize() const {
     std::string data;
     dmlc::MemoryStringStream writer(&data);
     dmlc::SeekStream* stream = &writer;
@@ -64,9 +61,8 @@ class CuDNNConvAlgoCacheEntry {
     stream->Write(algo_perf_.memory);
     stream->Write(algo_perf_.determinism);
     stream->Write(algo_perf_.mathType);
-    stream->Write(algo_perf_.reserved);
-    tvm::runtime::SaveBinaryToFile(path + "/value.bin", data);
-    return true;
+    stream->Write(algo_perf_.reserved, sizeof(algo_perf_.reserved));
+    return data;
   }
 
  private:
@@ -100,14 +96,19 @@ void GetMaxWorkspaceSize(const Algo* algos, int n_algos, F fget_workspace, size_
   CHECK(*memory != nullptr);
 }
 
-MetaPersistCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionFwdAlgoPerf_t>> CacheCudnnConvFwdAlgoPerf(
-    "cudnn_conv_fwd_algo_perf");
+/*! \brief The chosen algorithms depend on the GPU, the driver and the cuDNN version. */
+inline std::string GetCuDNNFingerprint() {
+  return GetCUDADeviceFingerprint() + "/cudnn_" + std::to_string(cudnnGetVersion());
+}
+
+MetaTuningCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionFwdAlgoPerf_t>> CacheCudnnConvFwdAlgoPerf(
+    "cudnn_conv_fwd_algo_perf", GetCuDNNFingerprint);
 
 cudnnConvolutionFwdAlgoPerf_t FindcudnnConvolutionFwdAlgoPerf_tExWrapper(
     const std::vector<uint8_t>& key, const cudnnTensorDescriptor_t xDesc, const void* x,
     const cudnnFilterDescriptor_t wDesc, const void* w, const cudnnConvolutionDescriptor_t convDesc,
     const cudnnTensorDescriptor_t yDesc, void* y, const Device& device) {
-  if (auto* val = CacheCudnnConvFwdAlgoPerf.Get(key)) {
+  if (auto val = CacheCudnnConvFwdAlgoPerf.Get(key)) {
     return val->Value();
   }
   static const cudnnConvolutionFwdAlgo_t algos[] = {
@@ -159,15 +160,15 @@ cudnnConvolutionFwdAlgoPerf_t FindcudnnConvolutionFwdAlgoPerf_tExWrapper(
   return res[0];
 }
 
-MetaPersistCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdDataAlgoPerf_t>>
-    CacheCudnnConvBwdDataAlgoPerf("cudnn_conv_bwd_data_algo_perf");
+MetaTuningCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdDataAlgoPerf_t>>
+    CacheCudnnConvBwdDataAlgoPerf("cudnn_conv_bwd_data_algo_perf", GetCuDNNFingerprint);
 
 cudnnConvolutionBwdDataAlgoPerf_t FindcudnnConvolutionBwdDataAlgoPerf_tExWrapper(
     const std::vector<uint8_t>& key, const cudnnFilterDescriptor_t wDesc, const void* w,
     const cudnnTensorDescriptor_t dyDesc, const void* dy,
     const cudnnConvolutionDescriptor_t convDesc, const cudnnTensorDescriptor_t dxDesc, void* dx,
     const Device& device) {
-  if (auto* val = CacheCudnnConvBwdDataAlgoPerf.Get(key)) {
+  if (auto val = CacheCudnnConvBwdDataAlgoPerf.Get(key)) {
     return val->Value();
   }
   static const cudnnConvolutionBwdDataAlgo_t algos[] = {
@@ -215,15 +216,15 @@ cudnnConvolutionBwdDataAlgoPerf_t FindcudnnConvolutionBwdDataAlgoPerf_tExWrapper
   return res[0];
 }
 
-MetaPersistCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdFilterAlgoPerf_t>>
-    CacheCudnnConvBwdFilterAlgoPerf("cudnn_conv_bwd_filter_algo_perf");
+MetaTuningCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdFilterAlgoPerf_t>>
+    CacheCudnnConvBwdFilterAlgoPerf("cudnn_conv_bwd_filter_algo_perf", GetCuDNNFingerprint);
 
 cudnnConvolutionBwdFilterAlgoPerf_t FindcudnnConvolutionBwdFilterAlgoPerf_tExWrapper(
     const std::vector<uint8_t>& key, const cudnnTensorDescriptor_t xDesc, const void* x,
     const cudnnTensorDescriptor_t dyDesc, const void* dy,
     const cudnnConvolutionDescriptor_t convDesc, const cudnnFilterDescriptor_t dwDesc, void* dw,
     const Device& device) {
-  if (auto* val = CacheCudnnConvBwdFilterAlgoPerf.Get(key)) {
+  if (auto val = CacheCudnnConvBwdFilterAlgoPerf.Get(key)) {
     return val->Value();
   }
   static const cudnnConvolutionBwdFilterAlgo_t algos[] = {
@@ -271,11 +272,21 @@ cudnnConvolutionBwdFilterAlgoPerf_t FindcudnnConvolutionBwdFilterAlgoPerf_tExWra
   return res[0];
 }
 
+/*!
+ * \brief Whether cuDNN supports the conv2d layouts. NHWC with OHWI lets Tensor Cores run the
+ * implicit GEMM without transposing the tensors internally.
+ */
+inline bool IsCuDNNConvLayout(const std::string& layout, const std::string& kernel_layout,
+                              const std::string& out_layout) {
+  return (layout == "NCHW" && kernel_layout == "OIHW" && out_layout == "NCHW") ||
+         (layout == "NHWC" && kernel_layout == "OHWI" && out_layout == "NHWC");
+}
+
 class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
-  cudnnTensorDescriptor_t xDesc;
-  cudnnFilterDescriptor_t wDesc;
-  cudnnTensorDescriptor_t yDesc;
-  cudnnConvolutionDescriptor_t convDesc;
+  cudnnTensorDescriptor_t xDesc = nullptr;
+  cudnnFilterDescriptor_t wDesc = nullptr;
+  cudnnTensorDescriptor_t yDesc = nullptr;
+  cudnnConvolutionDescriptor_t convDesc = nullptr;
   cudnnConvolutionFwdAlgoPerf_t algo;
   size_t workSpaceSizeInBytes;
   void* workSpace;
@@ -287,17 +298,27 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
         fschema_index[op]("w"),
     };
     auto args = cv->args.as<raf::op::schema::ConvArgs>();
+    if (!IsCuDNNConvLayout(args->layout, args->kernel_layout, args->out_layout)) {
+      error_msgs.push_back("[CUDNN] conv2d: unsupported layouts " + args->layout + ", " +
+                           args->kernel_layout + ", " + args->out_layout);
+      return;
+    }
+    if (!IsSymmetricPadding(args->padding)) {
+      error_msgs.push_back("[CUDNN] conv2d: asymmetric padding is not supported");
+      return;
+    }
     DLTensor* x = args->x;
     DLTensor* w = args->w;
     DLTensor* out = cv->out;
     auto xDesc_tt = SquashTensorShape(x, {});
-    xDesc = NormalizeTensorType(xDesc_tt);
+    xDesc = NormalizeTensorType(xDesc_tt, args->layout);
     auto wDesc_tt = SquashTensorShape(args->w, {});
-    wDesc = NormalizeFilter(args->w);
+    wDesc = NormalizeFilter(args->w, args->kernel_layout);
     auto yDesc_tt = SquashTensorShape(out, {});
-    yDesc = NormalizeTensorType(yDesc_tt);
+    yDesc = NormalizeTensorType(yDesc_tt, args->out_layout);
     std::vector<int> stride = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->stride));
-    std::vector<int> padding = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->padding));
+    // The padding is symmetric, of which cuDNN reads the (top, left) values.
+    std::vector<int> padding = CastVector<int, int64_t>(GetPadTLBR(args->padding));
     std::vector<int> dilation = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->dilation));
     cudnnDataType_t conv_dtype = CUDNNDType(w->dtype);
     // Use data type fp32 in the convolution descriptor when data type is fp16
@@ -314,6 +335,9 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
     HashKey algo_hasher;
     algo_hasher << args->stride << args->padding << args->dilation << wDesc_tt << xDesc_tt
                 << yDesc_tt;
+    if (args->layout != "NCHW") {
+      algo_hasher << args->layout;
+    }
     const auto& algo_key = algo_hasher.byte_vector;
     algo = FindcudnnConvolutionFwdAlgoPerf_tExWrapper(algo_key, xDesc, x->data, wDesc, w->data,
                                                       convDesc, yDesc, out->data, cv->device);
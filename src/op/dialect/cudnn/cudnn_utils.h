@@ -329,6 +329,48 @@ inline cudnnFilterDescriptor_t NormalizeFilter(const DLTensor* tv,
   return res;
 }
 
+/*!
+ * \brief Make the descriptor of a 4D tensor in the given layout, which is NCHW or NHWC.
+ * cuDNN always takes the dimensions in the NCHW order, so the NHWC shape is permuted.
+ */
+inline cudnnTensorDescriptor_t NormalizeTensorType(ir::TensorType tt, const std::string& layout) {
+  if (layout == "NCHW") {
+    return NormalizeTensorType(tt);
+  }
+  CHECK_EQ(layout, "NHWC") << "ValueError: unsupported layout " << layout;
+  CHECK_EQ(tt->shape.size(), 4U);
+  DLDataType dtype{(uint8_t)tt->dtype.code(), (uint8_t)tt->dtype.bits(),
+                   (uint16_t)tt->dtype.lanes()};
+  int shape[4];
+  for (int i = 0; i < 4; ++i) {
+    shape[i] = tvm::Downcast<ir::Integer>(tt->shape[i]).IntValue();
+  }
+  cudnnTensorDescriptor_t res;
+  CUDNN_CALL(cudnnCreateTensorDescriptor(&res));
+  CUDNN_CALL(cudnnSetTensor4dDescriptor(res, CUDNN_TENSOR_NHWC, CUDNNDType(dtype), shape[0],
+                                        shape[3], shape[1], shape[2]));
+  return res;
+}
+
+/*!
+ * \brief Make the descriptor of a 4D filter in the given layout, which is OIHW or OHWI.
+ * cuDNN always takes the dimensions in the OIHW order, so the OHWI shape is permuted.
+ */
+inline cudnnFilterDescriptor_t NormalizeFilter(const DLTensor* tv,
+                                               const std::string& kernel_layout) {
+  if (kernel_layout == "OIHW") {
+    return NormalizeFilter(tv);
+  }
+  CHECK_EQ(kernel_layout, "OHWI") << "ValueError: unsupported kernel layout " << kernel_layout;
+  CHECK_EQ(tv->ndim, 4);
+  int shape[4] = {static_cast<int>(tv->shape[0]), static_cast<int>(tv->shape[3]),
+                  static_cast<int>(tv->shape[1]), static_cast<int>(tv->shape[2])};
+  cudnnFilterDescriptor_t res;
+  CUDNN_CALL(cudnnCreateFilterDescriptor(&res));
+  CUDNN_CALL(cudnnSetFilterNdDescriptor(res, CUDNNDType(tv->dtype), CUDNN_TENSOR_NHWC, 4, shape));
+  return res;
+}
+
 inline std::vector<int64_t> MakeAlgoKey(const std::vector<std::vector<int64_t>>& vs) {
   std::vector<int64_t> res;
   for (auto& v : vs) {
@@ -23,9 +23,9 @@ using dmlc::BeginPtr;
 static auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
 
 class AvgPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
-  cudnnTensorDescriptor_t xDesc;
-  cudnnTensorDescriptor_t yDesc;
-  cudnnPoolingDescriptor_t poolingDesc;
+  cudnnTensorDescriptor_t xDesc = nullptr;
+  cudnnTensorDescriptor_t yDesc = nullptr;
+  cudnnPoolingDescriptor_t poolingDesc = nullptr;
 
   explicit AvgPool2DImplementedByCUDNNPoolingForward(const CallValues& cv) {
     auto op = Op::Get("raf.op.avg_pool2d");
@@ -33,15 +33,24 @@ class AvgPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
         fschema_index[op]("x"),
     };
     auto args = cv->args.as<raf::op::schema::PoolArgs>();
+    if (args->layout != "NCHW" && args->layout != "NHWC") {
+      error_msgs.push_back("[CUDNN] avg_pool2d: unsupported layout " + args->layout);
+      return;
+    }
+    if (!IsSymmetricPadding(args->padding)) {
+      error_msgs.push_back("[CUDNN] avg_pool2d: asymmetric padding is not supported");
+      return;
+    }
     DLTensor* x = args->x;
     DLTensor* out = cv->out;
     auto xDesc_tt = SquashTensorShape(x, {});
-    xDesc = NormalizeTensorType(xDesc_tt);
+    xDesc = NormalizeTensorType(xDesc_tt, args->layout);
     auto yDesc_tt = SquashTensorShape(out, {});
-    yDesc = NormalizeTensorType(yDesc_tt);
+    yDesc = NormalizeTensorType(yDesc_tt, args->layout);
     std::vector<int> kernel = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->kernel));
     std::vector<int> stride = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->stride));
-    std::vector<int> padding = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->padding));
+    // The padding is symmetric, of which cuDNN reads the (top, left) values.
+    std::vector<int> padding = CastVector<int, int64_t>(GetPadTLBR(args->padding));
     std::vector<int> dilation = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->dilation));
     CUDNN_CALL(cudnnCreatePoolingDescriptor(&poolingDesc));
     CUDNN_CALL(cudnnSetPoolingNdDescriptor(
@@ -172,9 +181,9 @@ RAF_REGISTER_DIALECT_OP(cudnn, avg_pool2d_dx, 15);
 RAF_OP_ENV_MAKER("raf.op.cudnn.avg_pool2d_dx", AvgPool2DDxImplementedByCUDNNPoolingBackward::make);
 
 class MaxPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
-  cudnnTensorDescriptor_t xDesc;
-  cudnnTensorDescriptor_t yDesc;
-  cudnnPoolingDescriptor_t poolingDesc;
+  cudnnTensorDescriptor_t xDesc = nullptr;
+  cudnnTensorDescriptor_t yDesc = nullptr;
+  cudnnPoolingDescriptor_t poolingDesc = nullptr;
 
   explicit MaxPool2DImplementedByCUDNNPoolingForward(const CallValues& cv) {
     auto op = Op::Get("raf.op.max_pool2d");
@@ -182,15 +191,24 @@ class MaxPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
         fschema_index[op]("x"),
     };
     auto args = cv->args.as<raf::op::schema::PoolArgs>();
+    if (args->layout != "NCHW" && args->layout != "NHWC") {
+      error_msgs.push_back("[CUDNN] max_pool2d: unsupported layout " + args->layout);
+      return;
+    }
+    if (!IsSymmetricPadding(args->padding)) {
+      error_msgs.push_back("[CUDNN] max_pool2d: asymmetric padding is not supported");
+      return;
+    }
     DLTensor* x = args->x;
     DLTensor* out = cv->out;
     auto xDesc_tt = SquashTensorShape(x, {});
-    xDesc = NormalizeTensorType(xDesc_tt);
+    xDesc = NormalizeTensorType(xDesc_tt, args->layout);
     auto yDesc_tt = SquashTensorShape(out, {});
-    yDesc = NormalizeTensorType(yDesc_tt);
+    yDesc = NormalizeTensorType(yDesc_tt, args->layout);
     std::vector<int> kernel = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->kernel));
     std::vector<int> stride = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->stride));
-    std::vector<int> padding = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->padding));
+    // The padding is symmetric, of which cuDNN reads the (top, left) values.
+    std::vector<int> padding = CastVector<int, int64_t>(GetPadTLBR(args->padding));
     std::vector<int> dilation = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->dilation));
     CUDNN_CALL(cudnnCreatePoolingDescriptor(&poolingDesc));
     CUDNN_CALL(cudnnSetPoolingNdDescriptor(poolingDesc, CUDNN_POOLING_MAX, CUDNN_PROPAGATE_NAN, 2,
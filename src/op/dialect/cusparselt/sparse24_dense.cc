@@ -0,0 +1,232 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cusparselt/sparse24_dense.cc
+ * \brief The 2:4 sparse dense by cuSPARSELt, which runs on the sparse tensor cores of sm80+.
+ */
+#include <cusparseLt.h>
+#include "dmlc/thread_local.h"
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/value.h"
+#include "../../schema/ufunc.h"
+#include "../../../common/cuda_utils.h"
+
+#define CUSPARSELT_CALL(func)                                                            \
+  do {                                                                                   \
+    cusparseStatus_t e = (func);                                                         \
+    CHECK_EQ(e, CUSPARSE_STATUS_SUCCESS) << "cusparseLt: " << cusparseGetErrorString(e); \
+  } while (false)
+
+namespace raf {
+namespace op {
+namespace cusparselt {
+
+using namespace raf::ir;
+using namespace raf::value;
+using namespace raf::memory_pool;
+using raf::op::schema::BinaryArgs;
+
+class CUSparseLtThreadEntry {
+ public:
+  CUSparseLtThreadEntry() {
+    CUSPARSELT_CALL(cusparseLtInit(&handle));
+  }
+
+  ~CUSparseLtThreadEntry() {
+    cusparseLtDestroy(&handle);
+  }
+
+  static CUSparseLtThreadEntry* ThreadLocal() {
+    return dmlc::ThreadLocalStore<CUSparseLtThreadEntry>::Get();
+  }
+
+ public:
+  cusparseLtHandle_t handle;
+};
+
+/*!
+ * \brief out = x * w^T, where x is in [M, K], and w is in [N, K] with 2:4 sparsity along K. In the
+ * column-major view of cuSPARSELt, out^T (N x M) = w (N x K) * x^T (K x M), so that the sparse
+ * operand is A, given as the transpose of the column-major [K, N].
+ *
+ * The weight is checked and compressed in the first execution, and the compressed copy is reused
+ * as long as the weight is in the same buffer, i.e., the weight is assumed not to be updated in
+ * place, which holds for the parameters in inference. The first execution also searches for the
+ * fastest algorithm.
+ */
+class Sparse24DenseImpl : public raf::op::OpEnv {
+ public:
+  explicit Sparse24DenseImpl(const CallValues& cv) : device_(cv->device) {
+    auto op = Op::Get("raf.op.sparse24_dense");
+    auto fschema_index = GetOpAttr<op::FRAFSchemaFieldIndex>(op, "FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index("x1"), fschema_index("x2")};
+  }
+
+  ~Sparse24DenseImpl() {
+    if (initialized_) {
+      cusparseLtMatmulPlanDestroy(&plan_);
+      cusparseLtMatmulAlgSelectionDestroy(&alg_sel_);
+      cusparseLtMatDescriptorDestroy(&a_desc_);
+      cusparseLtMatDescriptorDestroy(&b_desc_);
+      cusparseLtMatDescriptorDestroy(&c_desc_);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cusparselt.sparse24_dense"));
+  }
+
+  void Init(const CallValues& cv) {
+    const auto* args = cv->args.as<BinaryArgs>();
+    const DLTensor* x = args->x1;
+    const DLTensor* w = args->x2;
+    int64_t m = x->shape[0], k = x->shape[1], n = w->shape[0];
+    auto& handle = CUSparseLtThreadEntry::ThreadLocal()->handle;
+    cudaDataType_t dtype = cudaDataType_t(DType(x->dtype));
+    constexpr uint32_t kAlignment = 16;
+    CUSPARSELT_CALL(cusparseLtStructuredDescriptorInit(&handle, &a_desc_, k, n, k, kAlignment,
+                                                       dtype, CUSPARSE_ORDER_COL,
+                                                       CUSPARSELT_SPARSITY_50_PERCENT));
+    CUSPARSELT_CALL(cusparseLtDenseDescriptorInit(&handle, &b_desc_, k, m, k, kAlignment, dtype,
+                                                  CUSPARSE_ORDER_COL));
+    CUSPARSELT_CALL(cusparseLtDenseDescriptorInit(&handle, &c_desc_, n, m, n, kAlignment, dtype,
+                                                  CUSPARSE_ORDER_COL));
+    CUSPARSELT_CALL(cusparseLtMatmulDescriptorInit(
+        &handle, &matmul_, CUSPARSE_OPERATION_TRANSPOSE, CUSPARSE_OPERATION_NON_TRANSPOSE, &a_desc_,
+        &b_desc_, &c_desc_, &c_desc_, CUSPARSE_COMPUTE_16F));
+    CUSPARSELT_CALL(cusparseLtMatmulAlgSelectionInit(&handle, &alg_sel_, &matmul_,
+                                                     CUSPARSELT_MATMUL_ALG_DEFAULT));
+    CUSPARSELT_CALL(cusparseLtMatmulPlanInit(&handle, &plan_, &matmul_, &alg_sel_));
+    initialized_ = true;
+    size_t workspace_size = 0;
+    CUSPARSELT_CALL(cusparseLtMatmulGetWorkspace(&handle, &plan_, &workspace_size));
+    if (workspace_size > 0) {
+      workspace_mem_ = Memory::Alloc(device_, workspace_size);
+    }
+    CUSPARSELT_CALL(cusparseLtSpMMACompressedSize(&handle, &plan_, &compressed_size_,
+                                                  &compress_buffer_size_));
+  }
+
+  void Execute(const CallValues& cv) override {
+    const auto* args = cv->args.as<BinaryArgs>();
+    Execute({args->x1, args->x2}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = Downcast<TensorValue>(inputs[0]);
+    DLTensor* w = Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = Downcast<TensorValue>(output);
+    auto& handle = CUSparseLtThreadEntry::ThreadLocal()->handle;
+    cudaStream_t stream = GetStream();
+    if (w->data != compressed_from_) {
+      Compress(w, stream);
+    }
+    float alpha = 1.0f, beta = 0.0f;
+    void* workspace = workspace_mem_ ? workspace_mem_->data : nullptr;
+    if (!searched_) {
+      // Search for the fastest algorithm and split-k, which also computes the output.
+      CUSPARSELT_CALL(cusparseLtMatmulSearch(&handle, &plan_, &alpha, compressed_mem_->data,
+                                             x->data, &beta, out->data, out->data, workspace,
+                                             &stream, 1));
+      searched_ = true;
+      return;
+    }
+    CUSPARSELT_CALL(cusparseLtMatmul(&handle, &plan_, &alpha, compressed_mem_->data, x->data,
+                                     &beta, out->data, out->data, workspace, &stream, 1));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto* op_env = new Sparse24DenseImpl(cv);
+    const auto* args = cv->args.as<BinaryArgs>();
+    const DLTensor* x = args->x1;
+    const DLTensor* w = args->x2;
+    if (!(x->dtype.code == kDLFloat && x->dtype.bits == 16) && x->dtype.code != kDLBfloat) {
+      op_env->error_msgs.push_back("[cuSPARSELt] sparse24_dense only supports 16-bit floats");
+      return op_env;
+    }
+    cudaDeviceProp prop;
+    CUDA_CALL(cudaGetDeviceProperties(&prop, cv->device.device_id()));
+    if (prop.major < 8) {
+      op_env->error_msgs.push_back("[cuSPARSELt] The sparse tensor cores need sm80+");
+      return op_env;
+    }
+    int64_t m = x->shape[0], k = x->shape[1], n = w->shape[0];
+    if (m % 16 != 0 || n % 16 != 0 || k % 16 != 0) {
+      op_env->error_msgs.push_back("[cuSPARSELt] The dims of sparse24_dense should be multiples "
+                                   "of 16");
+      return op_env;
+    }
+    try {
+      op_env->Init(cv);
+    } catch (const dmlc::Error& e) {
+      op_env->error_msgs.push_back(std::string("[cuSPARSELt] Failed to JIT: ") + e.what());
+    }
+    return op_env;
+  }
+
+ private:
+  static cudaStream_t GetStream() {
+    static auto cuda_device_api = device_api::DeviceAPI::Get(DevType::kCUDA());
+    return static_cast<cudaStream_t>(cuda_device_api->GetStream());
+  }
+
+  /*! \brief Check the 2:4 sparsity of the weight and compress it. */
+  void Compress(const DLTensor* w, cudaStream_t stream) {
+    auto& handle = CUSparseLtThreadEntry::ThreadLocal()->handle;
+    auto valid = Memory::Alloc(device_, sizeof(int));
+    CUSPARSELT_CALL(cusparseLtSpMMAPruneCheck(&handle, &matmul_, w->data,
+                                              static_cast<int*>(valid->data), stream));
+    int invalid = 0;
+    CUDA_CALL(cudaMemcpyAsync(&invalid, valid->data, sizeof(int), cudaMemcpyDeviceToHost, stream));
+    CUDA_CALL(cudaStreamSynchronize(stream));
+    CHECK_EQ(invalid, 0) << "The weight of sparse24_dense is not 2:4 sparse. Please prune it, "
+                         << "e.g., by setting \"raf.sparsity_24\" to \"prune\"";
+    if (compressed_mem_ == nullptr) {
+      compressed_mem_ = Memory::Alloc(device_, compressed_size_);
+    }
+    std::shared_ptr<Memory> buffer;
+    if (compress_buffer_size_ > 0) {
+      buffer = Memory::Alloc(device_, compress_buffer_size_);
+    }
+    CUSPARSELT_CALL(cusparseLtSpMMACompress(&handle, &plan_, w->data, compressed_mem_->data,
+                                            buffer ? buffer->data : nullptr, stream));
+    // The compression buffer is freed after the compression finishes.
+    CUDA_CALL(cudaStreamSynchronize(stream));
+    compressed_from_ = w->data;
+  }
+
+  /*! \brief The device to run on. */
+  Device device_;
+  /*! \brief The descriptors of the sparse weight, the input, and the output. */
+  cusparseLtMatDescriptor_t a_desc_, b_desc_, c_desc_;
+  /*! \brief The descriptor of the matmul. */
+  cusparseLtMatmulDescriptor_t matmul_;
+  /*! \brief The algorithm selection and the plan. */
+  cusparseLtMatmulAlgSelection_t alg_sel_;
+  cusparseLtMatmulPlan_t plan_;
+  /*! \brief Whether the descriptors are initialized. */
+  bool initialized_{false};
+  /*! \brief Whether the algorithm has been searched. */
+  bool searched_{false};
+  /*! \brief The sizes of the compressed weight and of the buffer to compress it. */
+  size_t compressed_size_{0}, compress_buffer_size_{0};
+  /*! \brief The compressed weight, and the buffer of the weight it is compressed from. */
+  std::shared_ptr<Memory> compressed_mem_;
+  const void* compressed_from_{nullptr};
+  /*! \brief The workspace of the matmul. */
+  std::shared_ptr<Memory> workspace_mem_;
+};
+
+RAF_REGISTER_DIALECT("cusparselt").set_enable(DevType::kCUDA());
+RAF_REGISTER_DIALECT_OP(cusparselt, sparse24_dense, 20);
+RAF_OP_ENV_MAKER("raf.op.cusparselt.sparse24_dense", Sparse24DenseImpl::make);
+
+}  // namespace cusparselt
+}  // namespace op
+}  // namespace raf
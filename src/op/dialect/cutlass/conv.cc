@@ -54,7 +54,8 @@ bool CutlassConv2dOpEnv::Pattern(const CallValues& cv) {
         x_ = GetPattern<Var>(node_map, x);
         w_ = GetPattern<Var>(node_map, w);
         stride_ = Pad<2>(TupleInt(GetValue<TupleValue>(cv, GetPattern<Var>(node_map, stride))));
-        padding_ = Pad<2>(TupleInt(GetValue<TupleValue>(cv, GetPattern<Var>(node_map, padding))));
+        padding_ =
+            GetPadTLBR(TupleInt(GetValue<TupleValue>(cv, GetPattern<Var>(node_map, padding))));
         dilation_ = Pad<2>(TupleInt(GetValue<TupleValue>(cv, GetPattern<Var>(node_map, dilation))));
         layout_ = GetValue<StringValue>(cv, GetPattern<Var>(node_map, layout))->value;
         out_layout_ = GetValue<StringValue>(cv, GetPattern<Var>(node_map, out_layout))->value;
@@ -83,9 +84,10 @@ void CutlassConv2dOpEnv::Init(const CallValues& cv) {
   DLTensor* bias = with_bias_ ? GetValue<TensorValue>(cv, bias_) : out;
   int N = x->shape[0], H = x->shape[1], W = x->shape[2], C = x->shape[3];
   int K = w->shape[0], R = w->shape[1], S = w->shape[2];
-  InitConvOperation(SplitKMode::kSerial, N, H, W, C, K, R, S, padding_[0], padding_[1], stride_[0],
-                    stride_[1], dilation_[0], dilation_[1], GetNumericTypeID(out->dtype),
-                    NumericTypeID::kF32, const_addr<1>(cudaDataType_t(DType(out->dtype))),
+  InitConvOperation(SplitKMode::kSerial, N, H, W, C, K, R, S, padding_[0], padding_[1],
+                    padding_[2], padding_[3], stride_[0], stride_[1], dilation_[0], dilation_[1],
+                    GetNumericTypeID(out->dtype), NumericTypeID::kF32,
+                    const_addr<1>(cudaDataType_t(DType(out->dtype))),
                     GetNumericTypeID(x->dtype), LayoutTypeID::kTensorNHWC, x->data,
                     GetNumericTypeID(w->dtype), LayoutTypeID::kTensorNHWC, w->data,
                     with_bias_ ? const_addr<1>(cudaDataType_t(DType(out->dtype)))
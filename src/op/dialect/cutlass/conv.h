@@ -70,7 +70,7 @@ class CutlassConv2dOpEnv : public CutlassConvOpEnv {
   Var bias_;
   /*! \brief convolution stride */
   std::vector<int64_t> stride_;
-  /*! \brief convolution padding */
+  /*! \brief convolution padding of (top, left, bottom, right) */
   std::vector<int64_t> padding_;
   /*! \brief convolution dilation */
   std::vector<int64_t> dilation_;
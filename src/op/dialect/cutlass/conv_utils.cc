@@ -15,15 +15,16 @@ namespace op {
 namespace cutlass {
 
 void CutlassConvOpEnv::InitConvOperation(
-    SplitKMode mode, int N, int H, int W, int C, int K, int R, int S, int pad_h, int pad_w,
-    int stride_h, int stride_w, int dilation_h, int dilation_w, NumericTypeID element_accumulator,
+    SplitKMode mode, int N, int H, int W, int C, int K, int R, int S, int pad_t, int pad_l,
+    int pad_b, int pad_r, int stride_h, int stride_w, int dilation_h, int dilation_w,
+    NumericTypeID element_accumulator,
     NumericTypeID element_compute, void const* alpha, NumericTypeID element_A,
     LayoutTypeID layout_A, void const* ptr_A, NumericTypeID element_B, LayoutTypeID layout_B,
     void const* ptr_B, void const* beta, NumericTypeID element_C, void const* ptr_C, void* ptr_D,
     EpilogueKindExt epilogue_math_op, const std::string& preferred_name) {
-  int P = (H + 2 * pad_h - ((R - 1) * dilation_h + 1)) / stride_h + 1;
+  int P = (H + pad_t + pad_b - ((R - 1) * dilation_h + 1)) / stride_h + 1;
 
-  int Q = (W + 2 * pad_w - ((S - 1) * dilation_w + 1)) / stride_w + 1;
+  int Q = (W + pad_l + pad_r - ((S - 1) * dilation_w + 1)) / stride_w + 1;
 
   functional_key_ = std::make_shared<ConvFunctionalKeyExt>(
       provider_, ConvKind::kFprop, element_A, layout_A, element_B, layout_B, element_C, layout_A,
@@ -43,9 +44,11 @@ void CutlassConvOpEnv::InitConvOperation(
 
   operation_ = operation;
 
-  // Configure operation
+  // Configure operation. The problem only takes the top and left padding, and the iterators read
+  // zeros beyond the bottom and right borders, which covers any bottom and right padding for the
+  // given output size.
   conv::Conv2dProblemSize problem_size =
-      conv::Conv2dProblemSize(N, H, W, C, K, R, S, P, Q, pad_h, pad_w, stride_h, stride_w,
+      conv::Conv2dProblemSize(N, H, W, C, K, R, S, P, Q, pad_t, pad_l, stride_h, stride_w,
                               dilation_h, dilation_w, conv::Mode::kCrossCorrelation);
   // NHWC
   std::vector<int> stride_a = {C, C * W, C * W * H};
@@ -48,8 +48,10 @@ class CutlassConvOpEnv : public CutlassOpEnv {
    * \param K Output channel
    * \param R Filter height
    * \param S Filter width
-   * \param pad_h Height padding
-   * \param pad_w Width padding
+   * \param pad_t Top padding
+   * \param pad_l Left padding
+   * \param pad_b Bottom padding
+   * \param pad_r Right padding
    * \param stride_h Height stride
    * \param stride_w Width stride
    * \param dilation_h Height dilation
@@ -72,8 +74,8 @@ class CutlassConvOpEnv : public CutlassOpEnv {
                            See the implementation of find_conv2d_operation for details
    */
   void InitConvOperation(SplitKMode mode, int N, int H, int W, int C, int K, int R, int S,
-                         int pad_h, int pad_w, int stride_h, int stride_w, int dilation_h,
-                         int dilation_w, NumericTypeID element_accumulator,
+                         int pad_t, int pad_l, int pad_b, int pad_r, int stride_h, int stride_w,
+                         int dilation_h, int dilation_w, NumericTypeID element_accumulator,
                          NumericTypeID element_compute, void const* alpha, NumericTypeID element_A,
                          LayoutTypeID layout_A, void const* ptr_A, NumericTypeID element_B,
                          LayoutTypeID layout_B, void const* ptr_B, void const* beta,
@@ -7,7 +7,9 @@
  * \file ./src/op/dialect/cutlass/cutlass_fusion.cc
  * \brief Implementation of cutlass dispatch for fused functions
  */
+#include <algorithm>
 #include <limits>
+#include <sstream>
 
 #include "raf/cache.h"
 #include "raf/value.h"
@@ -31,35 +33,43 @@ using namespace raf::ir;
 using namespace raf::value;
 using raf::registry::TypedPackedFunc;
 
-/*! \brief The persist cache entry of the best CUTLASS tuned config. */
+/*!
+ * \brief The tuning cache entry of the best CUTLASS tuned config, which is recorded by the text
+ * form of the config and matched against the tunable configs when it is loaded.
+ */
 class CUTLASSConfigCacheEntry {
  public:
   explicit CUTLASSConfigCacheEntry() {
   }
 
-  CUTLASSConfigCacheEntry(std::shared_ptr<TunableConfig> config) : config_(config) {
+  CUTLASSConfigCacheEntry(const std::string& config_text) : config_text_(config_text) {
   }
 
-  std::shared_ptr<TunableConfig> GetConfig() {
-    return config_;
+  const std::string& GetConfigText() const {
+    return config_text_;
   }
 
-  static CUTLASSConfigCacheEntry Load(const std::string path) {
-    // Not support deserialization yet.
-    throw;
+  static CUTLASSConfigCacheEntry Deserialize(const std::string& data) {
+    return CUTLASSConfigCacheEntry(data);
   }
 
-  bool Save(const std::string& path) {
-    // Not support serialization yet.
-    return false;
+  std::string Serialize() const {
+    return config_text_;
   }
 
  private:
-  /*! \brief The tunable config. */
-  std::shared_ptr<TunableConfig> config_;
+  /*! \brief The text form of the tunable config. */
+  std::string config_text_;
 };
 
-MetaPersistCache<CUTLASSConfigCacheEntry> CacheConfig("cutlass_fusion_config");
+MetaTuningCache<CUTLASSConfigCacheEntry> CacheConfig("cutlass_fusion_config",
+                                                     GetCUDADeviceFingerprint);
+
+std::string ConfigToText(const std::shared_ptr<TunableConfig>& config) {
+  std::ostringstream os;
+  config->AsText(os);
+  return os.str();
+}
 
 HashKey HashFusedFunc(const Function& func) {
   HashKey key;
@@ -67,32 +77,82 @@ HashKey HashFusedFunc(const Function& func) {
   return key;
 }
 
-OpEnv* Tune(const op::CallValues& call, OpEnv* op_env) {
-  CutlassOpEnv* env = static_cast<CutlassOpEnv*>(op_env);
-  auto key = HashFusedFunc(Downcast<ClosureValue>(call->callee)->func);
-  std::shared_ptr<TunableConfig> best;
+/*! \brief The number of runs to time each candidate in the first round of tuning. */
+static constexpr int kCutlassTuneMinNumber = 2;
+/*! \brief The number of runs to time each candidate in the last round of tuning. */
+static constexpr int kCutlassTuneMaxNumber = 16;
 
-  if (const auto* compiled = CacheConfig.Get(key.byte_vector)) {
-    CUTLASSConfigCacheEntry entry = *compiled;
-    best = entry.GetConfig();
-  } else {
-    std::vector<std::shared_ptr<TunableConfig>> tunable = env->ListTunableConfigs();
-    const int number = 10, repeat = 1, min_repeat_ms = 0, cooldown_interval_ms = 0,
-              repeats_to_cooldow = 1;
-    double min_time = std::numeric_limits<double>::max();
-    for (auto& config : tunable) {
-      env->SetTunableConfig(config);
-      env->Init(call);
+/*!
+ * \brief Pick the fastest config by successive halving. All candidates are timed with a few runs
+ * in the first round, then only the faster half survives to the next round, which times them with
+ * twice as many runs. The noise of the short rounds only affects the obviously slow candidates,
+ * which would be dropped anyway, so the tuning time is dominated by the first round instead of
+ * timing every candidate with the full number of runs.
+ * \param call The call to be tuned.
+ * \param env The OpEnv to run the configs.
+ * \param tunable The candidate configs.
+ * \return The fastest config.
+ */
+std::shared_ptr<TunableConfig> SuccessiveHalving(
+    const op::CallValues& call, CutlassOpEnv* env,
+    const std::vector<std::shared_ptr<TunableConfig>>& tunable) {
+  const int repeat = 1, min_repeat_ms = 0, cooldown_interval_ms = 0, repeats_to_cooldow = 1;
+  std::vector<std::pair<double, std::shared_ptr<TunableConfig>>> candidates;
+  for (const auto& config : tunable) {
+    candidates.emplace_back(0.0, config);
+  }
+  for (int number = kCutlassTuneMinNumber; candidates.size() > 1; number *= 2) {
+    std::vector<std::pair<double, std::shared_ptr<TunableConfig>>> timed;
+    for (const auto& candidate : candidates) {
+      auto config = candidate.second;
+      try {
+        env->SetTunableConfig(config);
+        env->Init(call);
+      } catch (const dmlc::Error& e) {
+        DLOG(WARNING) << "Skipped CUTLASS config " << config << ": " << e.what();
+        continue;
+      }
       Array<FloatValue> result =
           TimeEvaluator(TypedPackedFunc<void()>([&]() { env->Execute(call); }), call->device,
                         number, repeat, min_repeat_ms, cooldown_interval_ms, repeats_to_cooldow)();
       CHECK_EQ(result.size(), 1U);
-      if (result[0]->value < min_time) {
-        min_time = result[0]->value;
+      timed.emplace_back(result[0]->value, config);
+    }
+    CHECK(!timed.empty()) << "No CUTLASS config is applicable";
+    std::stable_sort(timed.begin(), timed.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    if (number >= kCutlassTuneMaxNumber) {
+      return timed[0].second;
+    }
+    timed.resize((timed.size() + 1) / 2);
+    candidates = std::move(timed);
+  }
+  CHECK(!candidates.empty()) << "No CUTLASS config is applicable";
+  return candidates[0].second;
+}
+
+OpEnv* Tune(const op::CallValues& call, OpEnv* op_env, const HashKey& key) {
+  CutlassOpEnv* env = static_cast<CutlassOpEnv*>(op_env);
+  std::shared_ptr<TunableConfig> best;
+
+  std::vector<std::shared_ptr<TunableConfig>> tunable = env->ListTunableConfigs();
+  auto compiled = CacheConfig.Get(key.byte_vector);
+  if (compiled) {
+    for (auto& config : tunable) {
+      if (ConfigToText(config) == compiled->GetConfigText()) {
         best = config;
+        break;
       }
     }
-    CacheConfig.Set(key.byte_vector, CUTLASSConfigCacheEntry(best));
+    if (!best) {
+      DLOG(WARNING) << "The cached CUTLASS config is not available, re-tuning";
+    }
+  }
+  if (!best) {
+    best = SuccessiveHalving(call, env, tunable);
+    if (!compiled) {
+      CacheConfig.Set(key.byte_vector, CUTLASSConfigCacheEntry(ConfigToText(best)));
+    }
   }
 
   env->SetTunableConfig(best);
@@ -124,7 +184,7 @@ OpEnv* FusedFuncBuild(const op::CallValues& call) {
   auto fmake_tune = [&env, &call](FMaker maker) {
     env = maker(call);
     if (!env->HasError()) {
-      Tune(call, env);
+      Tune(call, env, HashFusedFunc(Downcast<ClosureValue>(call->callee)->func));
     }
   };
   if (!pattern_name.compare(0, 6, "matmul") || !pattern_name.compare(0, 12, "batch_matmul")) {
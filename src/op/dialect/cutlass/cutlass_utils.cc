@@ -76,6 +76,9 @@ NumericTypeID GetNumericTypeID(DType dtype) {
         return NumericTypeID::kF64;
     }
   }
+  if (dtype.code == DTypeCode::kBFloat() && dtype.bits == 16) {
+    return NumericTypeID::kBF16;
+  }
   return NumericTypeID::kUnknown;
 }
 
@@ -107,6 +110,9 @@ DType GetAccumulationDType(DType dtype) {
         return dtype;
     }
   }
+  if (dtype.code == DTypeCode::kBFloat() && dtype.bits == 16) {
+    return DType(DTypeCode::kFloat(), 32);
+  }
   return DType();
 }
 
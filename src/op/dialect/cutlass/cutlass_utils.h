@@ -16,6 +16,7 @@
 #include "cutlass_ext/library/operation_table_ext.h"
 #include "cutlass_ext/library/singleton_ext.h"
 
+#include "raf/cache.h"
 #include "raf/ir.h"
 #include "raf/value.h"
 #include "raf/registry.h"
@@ -145,6 +146,16 @@ T GetValue(const op::CallValues& call, const Var& var) {
   return T{};
 }
 
+/*!
+ * \brief Apply the best tunable config of the key to the OpEnv, which is looked up in the tuning
+ * cache, or tuned and cached if missed, and then initialize the OpEnv with it.
+ * \param call The call to be tuned.
+ * \param op_env The CutlassOpEnv of the call.
+ * \param key The key of the problem in the tuning cache.
+ * \return The OpEnv.
+ */
+OpEnv* Tune(const op::CallValues& call, OpEnv* op_env, const HashKey& key);
+
 inline cudaStream_t GetStream() {
   static auto cuda_device_api = device_api::DeviceAPI::Get(DevType::kCUDA());
   return static_cast<cudaStream_t>(cuda_device_api->GetStream());
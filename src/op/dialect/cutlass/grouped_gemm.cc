@@ -0,0 +1,237 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file ./src/op/dialect/cutlass/grouped_gemm.cc
+ * \brief Implementation of cutlass grouped gemm dispatch
+ */
+#include <cstring>
+#include <sstream>
+#include "raf/cache.h"
+#include "raf/op.h"
+#include "raf/value.h"
+#include "./cutlass_utils.h"
+#include "../../schema/nn.h"
+
+namespace raf {
+namespace op {
+namespace cutlass {
+
+using namespace raf::ir;
+using namespace raf::value;
+using raf::op::schema::GroupedMatmulArgs;
+
+/*!
+ * \brief OpEnv for grouped_matmul, which runs all problems in one launch of a CUTLASS grouped
+ * gemm: the persistent threadblocks iterate over the tiles of all problems, so the problems with
+ * few rows (e.g., the experts with few tokens) do not occupy the whole GPU as separate launches.
+ * The problem sizes, the leading dims and the pointers are kept in one device buffer, where the
+ * pointers are updated in each execution.
+ */
+class CutlassGroupedMatmulOpEnv : public CutlassOpEnv {
+ public:
+  explicit CutlassGroupedMatmulOpEnv(const CallValues& cv) : CutlassOpEnv(cv) {
+    static auto fschema_index = Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = Op::Get("raf.op.grouped_matmul");
+    arg_indices = {fschema_index[op]("a"), fschema_index[op]("b")};
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cutlass.grouped_matmul"));
+  }
+
+  std::vector<std::shared_ptr<TunableConfig>> ListTunableConfigs() override {
+    std::vector<std::shared_ptr<TunableConfig>> rets;
+    for (const auto* op : Candidates()) {
+      rets.push_back(std::make_shared<TunableConfig>(op->description().name));
+    }
+    return rets;
+  }
+
+  void SetTunableConfig(const std::shared_ptr<TunableConfig>& tunable) override {
+    tunable_ = *tunable;
+  }
+
+  void Init(const CallValues& cv) override {
+    const auto* args = cv->args.as<GroupedMatmulArgs>();
+    int count = args->a.size();
+    const DLTensor* a0 = args->a[0];
+    element_ = GetNumericTypeID(a0->dtype);
+    element_bytes_ = (a0->dtype.bits + 7) / 8;
+    layout_B_ = args->transpose_b ? LayoutTypeID::kColumnMajor : LayoutTypeID::kRowMajor;
+    problems_.resize(count);
+    std::vector<int64_t> lds;
+    for (int i = 0; i < count; ++i) {
+      const DLTensor* a = args->a[i];
+      const DLTensor* b = args->b[i];
+      int m = a->shape[0], k = a->shape[1];
+      int n = args->transpose_b ? b->shape[0] : b->shape[1];
+      problems_[i] = gemm::GemmCoord(m, n, k);
+      lds.push_back(k);
+      lds.push_back(args->transpose_b ? k : n);
+      lds.push_back(n);
+    }
+    // The largest alignment (in units of elements) of the leading dims, up to 16 bytes.
+    alignment_ = 16 / element_bytes_;
+    for (int64_t ld : lds) {
+      while (alignment_ > 1 && ld % alignment_ != 0) {
+        alignment_ /= 2;
+      }
+    }
+
+    grouped_op_ = nullptr;
+    for (const auto* op : Candidates()) {
+      if (grouped_op_ == nullptr || op->description().name == tunable_.kernel_name) {
+        grouped_op_ = op;
+      }
+    }
+    CHECK(grouped_op_ != nullptr) << "No CUTLASS grouped gemm is applicable to "
+                                  << to_string(element_) << " with alignment " << alignment_;
+
+    // The device buffer: problem sizes, the pointers of A, B, C and D, the leading dims of A, B,
+    // C and D, and then the workspace of the kernel.
+    size_t sizes_bytes = count * sizeof(gemm::GemmCoord);
+    size_t ptrs_bytes = 4 * count * sizeof(void*);
+    size_t lds_bytes = 4 * count * sizeof(int64_t);
+    host_buffer_.resize(sizes_bytes + ptrs_bytes + lds_bytes);
+    char* host = host_buffer_.data();
+    std::memcpy(host, problems_.data(), sizes_bytes);
+    auto* host_lds = reinterpret_cast<int64_t*>(host + sizes_bytes + ptrs_bytes);
+    for (int i = 0; i < count; ++i) {
+      host_lds[i] = lds[3 * i];
+      host_lds[count + i] = lds[3 * i + 1];
+      host_lds[2 * count + i] = lds[3 * i + 2];
+      host_lds[3 * count + i] = lds[3 * i + 2];
+    }
+
+    arguments_.problem_count = count;
+    size_t kernel_workspace_size = grouped_op_->get_workspace_size(arguments_);
+    RequestWorkspace(&workspace_, device_, host_buffer_.size() + kernel_workspace_size);
+    char* device = static_cast<char*>(workspace_);
+    auto* device_ptrs = reinterpret_cast<void**>(device + sizes_bytes);
+    auto* device_lds = reinterpret_cast<int64_t*>(device + sizes_bytes + ptrs_bytes);
+    arguments_.problem_sizes = reinterpret_cast<gemm::GemmCoord*>(device);
+    arguments_.ptr_A = device_ptrs;
+    arguments_.ptr_B = device_ptrs + count;
+    arguments_.ptr_C = device_ptrs + 2 * count;
+    arguments_.ptr_D = device_ptrs + 3 * count;
+    arguments_.lda = device_lds;
+    arguments_.ldb = device_lds + count;
+    arguments_.ldc = device_lds + 2 * count;
+    arguments_.ldd = device_lds + 3 * count;
+    kernel_workspace_ = kernel_workspace_size > 0 ? device + host_buffer_.size() : nullptr;
+  }
+
+  void Execute(const CallValues& cv) override {
+    const auto* args = cv->args.as<GroupedMatmulArgs>();
+    Execute({TupleValue::make(Array<Value>(args->a.begin(), args->a.end())),
+             TupleValue::make(Array<Value>(args->b.begin(), args->b.end()))},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    auto a = Downcast<TupleValue>(inputs[0]);
+    auto b = Downcast<TupleValue>(inputs[1]);
+    int count = arguments_.problem_count;
+    Array<Value> outs;
+    if (const auto* tuple = output.as<TupleValueObj>()) {
+      outs = tuple->fields;
+    } else {
+      outs.push_back(output);
+    }
+    CHECK_EQ(outs.size(), count);
+    char* host = host_buffer_.data();
+    auto* host_ptrs = reinterpret_cast<void**>(host + count * sizeof(gemm::GemmCoord));
+    uintptr_t alignment_bytes = grouped_op_->description().alignment * element_bytes_;
+    for (int i = 0; i < count; ++i) {
+      DLTensor* x = Downcast<TensorValue>(a->fields[i]);
+      DLTensor* y = Downcast<TensorValue>(b->fields[i]);
+      DLTensor* out = Downcast<TensorValue>(outs[i]);
+      host_ptrs[i] = x->data;
+      host_ptrs[count + i] = y->data;
+      host_ptrs[2 * count + i] = out->data;
+      host_ptrs[3 * count + i] = out->data;
+      for (int j = 0; j < 4; ++j) {
+        CHECK_EQ(reinterpret_cast<uintptr_t>(host_ptrs[j * count + i]) % alignment_bytes, 0)
+            << "The operands of problem " << i << " are not aligned to " << alignment_bytes
+            << " bytes";
+      }
+    }
+    cudaStream_t stream = GetStream();
+    CUDA_CALL(cudaMemcpyAsync(workspace_, host_buffer_.data(), host_buffer_.size(),
+                              cudaMemcpyHostToDevice, stream));
+    CUTLASS_CALL(grouped_op_->run(arguments_, kernel_workspace_, stream));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto* op_env = new CutlassGroupedMatmulOpEnv(cv);
+    const auto* args = cv->args.as<GroupedMatmulArgs>();
+    const DLTensor* a0 = args->a[0];
+    if (GetNumericTypeID(a0->dtype) != NumericTypeID::kF32 &&
+        GetNumericTypeID(a0->dtype) != NumericTypeID::kF16) {
+      op_env->error_msgs.push_back("[CUTLASS] grouped_matmul only supports float32 and float16");
+      return op_env;
+    }
+    HashKey key;
+    key << std::string("raf.op.cutlass.grouped_matmul") << args->transpose_b;
+    for (size_t i = 0; i < args->a.size(); ++i) {
+      key << *static_cast<const DLTensor*>(args->a[i]) << *static_cast<const DLTensor*>(args->b[i]);
+    }
+    try {
+      // Initialize with the default config, which determines the tunable configs.
+      op_env->Init(cv);
+      Tune(cv, op_env, key);
+    } catch (const dmlc::Error& e) {
+      std::stringstream ss;
+      ss << "[CUTLASS] Failed to JIT: " << e.what();
+      op_env->error_msgs.push_back(ss.str());
+    }
+    return op_env;
+  }
+
+ private:
+  /*! \brief The grouped gemm operations applicable to the dtype, layout and alignment. */
+  std::vector<const GroupedGemmOperationExt*> Candidates() const {
+    std::vector<const GroupedGemmOperationExt*> ret;
+    int cc = compute_capability();
+    for (const auto& op : SingletonExt::get().grouped_gemm_operations) {
+      const auto& desc = op->description();
+      if (desc.element == element_ && desc.layout_B == layout_B_ &&
+          desc.minimum_compute_capability <= cc && cc <= desc.maximum_compute_capability &&
+          alignment_ % desc.alignment == 0) {
+        ret.push_back(op.get());
+      }
+    }
+    return ret;
+  }
+
+  /*! \brief The data type of the operands */
+  NumericTypeID element_;
+  /*! \brief The size of an element in bytes */
+  int element_bytes_;
+  /*! \brief The layout of b */
+  LayoutTypeID layout_B_;
+  /*! \brief The alignment (in units of elements) the leading dims satisfy */
+  int alignment_;
+  /*! \brief The {m, n, k} of each problem */
+  std::vector<gemm::GemmCoord> problems_;
+  /*! \brief The host copy of the problem sizes, pointers and leading dims */
+  std::vector<char> host_buffer_;
+  /*! \brief The selected operation */
+  const GroupedGemmOperationExt* grouped_op_{nullptr};
+  /*! \brief The arguments pointing to the device buffer */
+  GroupedGemmArgumentsExt arguments_;
+  /*! \brief The workspace of the kernel */
+  void* kernel_workspace_{nullptr};
+  /*! \brief The tunable config, which is the kernel name */
+  TunableConfig tunable_;
+};
+
+RAF_REGISTER_DIALECT_OP(cutlass, grouped_matmul, 15);
+RAF_OP_ENV_MAKER("raf.op.cutlass.grouped_matmul", CutlassGroupedMatmulOpEnv::make);
+
+}  // namespace cutlass
+}  // namespace op
+}  // namespace raf
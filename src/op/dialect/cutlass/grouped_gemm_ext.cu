@@ -0,0 +1,136 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cutlass/grouped_gemm_ext.cu
+ * \brief Grouped gemm operations. The cutlass library manifest has no grouped gemm, so the
+ * kernels are instantiated here with a few tile shapes, which are the candidates of tuning.
+ */
+
+#include "cutlass/cutlass.h"
+#include "cutlass/gemm/gemm.h"
+#include "cutlass/gemm/kernel/default_gemm_grouped.h"
+#include "cutlass/gemm/device/gemm_grouped.h"
+#include "cutlass/epilogue/thread/linear_combination.h"
+
+#include "library_internal.h"
+#include "cutlass_ext/library/grouped_gemm_ext.h"
+
+namespace cutlass {
+namespace library {
+
+template <typename Gemm_>
+class GroupedGemmOperationExtImpl : public GroupedGemmOperationExt {
+ public:
+  using Gemm = Gemm_;
+  using ElementA = typename Gemm::ElementA;
+  using ElementB = typename Gemm::ElementB;
+  using ElementC = typename Gemm::ElementC;
+  using LayoutB = typename Gemm::LayoutB;
+  using EpilogueOutputOp = typename Gemm::EpilogueOutputOp;
+  using ElementCompute = typename EpilogueOutputOp::ElementCompute;
+
+  GroupedGemmOperationExtImpl(char const *name, int min_cc, int max_cc) {
+    description_.name = name;
+    description_.element = NumericTypeMap<ElementA>::kId;
+    description_.layout_B = LayoutMap<LayoutB>::kId;
+    description_.alignment = Gemm::kAlignmentA;
+    description_.minimum_compute_capability = min_cc;
+    description_.maximum_compute_capability = max_cc;
+  }
+
+  GroupedGemmDescriptionExt const &description() const override {
+    return description_;
+  }
+
+  size_t get_workspace_size(GroupedGemmArgumentsExt const &args) const override {
+    return Gemm::get_workspace_size(make_arguments(args));
+  }
+
+  Status run(GroupedGemmArgumentsExt const &args, void *workspace,
+             cudaStream_t stream) const override {
+    Gemm gemm;
+    Status status = gemm.initialize(make_arguments(args), workspace);
+    if (status != Status::kSuccess) {
+      return status;
+    }
+    return gemm.run(stream);
+  }
+
+ private:
+  typename Gemm::Arguments make_arguments(GroupedGemmArgumentsExt const &args) const {
+    // The persistent threadblocks iterate over the tiles of all problems.
+    int threadblock_count = Gemm::sufficient();
+    typename EpilogueOutputOp::Params epilogue(ElementCompute(1), ElementCompute(0));
+    return typename Gemm::Arguments(
+      args.problem_sizes, args.problem_count, threadblock_count, epilogue,
+      reinterpret_cast<ElementA **>(args.ptr_A), reinterpret_cast<ElementB **>(args.ptr_B),
+      reinterpret_cast<ElementC **>(args.ptr_C), reinterpret_cast<ElementC **>(args.ptr_D),
+      args.lda, args.ldb, args.ldc, args.ldd);
+  }
+
+  GroupedGemmDescriptionExt description_;
+};
+
+/*! \brief The float32 grouped gemm with SIMT instructions */
+template <typename LayoutB, typename ThreadblockShape, typename WarpShape>
+using SimtGroupedGemm = gemm::device::GemmGrouped<
+  typename gemm::kernel::DefaultGemmGrouped<
+    float, layout::RowMajor, ComplexTransform::kNone, 1,
+    float, LayoutB, ComplexTransform::kNone, 1,
+    float, layout::RowMajor,
+    float,
+    arch::OpClassSimt, arch::Sm50,
+    ThreadblockShape, WarpShape, gemm::GemmShape<1, 1, 1>,
+    epilogue::thread::LinearCombination<float, 1, float, float>,
+    gemm::threadblock::GemmBatchedIdentityThreadblockSwizzle,
+    2>::GemmKernel>;
+
+#if defined(CUTLASS_ARCH_MMA_SM80_SUPPORTED)
+/*! \brief The float16 grouped gemm with tensor cores, accumulated in float32 */
+template <typename LayoutB, typename ThreadblockShape, typename WarpShape>
+using TensorOpGroupedGemm = gemm::device::GemmGrouped<
+  typename gemm::kernel::DefaultGemmGrouped<
+    half_t, layout::RowMajor, ComplexTransform::kNone, 8,
+    half_t, LayoutB, ComplexTransform::kNone, 8,
+    half_t, layout::RowMajor,
+    float,
+    arch::OpClassTensorOp, arch::Sm80,
+    ThreadblockShape, WarpShape, gemm::GemmShape<16, 8, 16>,
+    epilogue::thread::LinearCombination<half_t, 8, float, float>,
+    gemm::threadblock::GemmBatchedIdentityThreadblockSwizzle,
+    4>::GemmKernel>;
+#endif
+
+template <typename LayoutB>
+void initialize_grouped_gemm_operations_with_layout(
+    std::vector<std::unique_ptr<GroupedGemmOperationExt const>> *operations, char const *tag) {
+  using gemm::GemmShape;
+  std::string simt = std::string("cutlass_simt_sgemm_grouped_") + tag;
+  operations->emplace_back(new GroupedGemmOperationExtImpl<
+    SimtGroupedGemm<LayoutB, GemmShape<128, 128, 8>, GemmShape<32, 64, 8>>>(
+      (simt + "_128x128_8x2").c_str(), 50, 1024));
+  operations->emplace_back(new GroupedGemmOperationExtImpl<
+    SimtGroupedGemm<LayoutB, GemmShape<64, 64, 8>, GemmShape<32, 64, 8>>>(
+      (simt + "_64x64_8x2").c_str(), 50, 1024));
+#if defined(CUTLASS_ARCH_MMA_SM80_SUPPORTED)
+  std::string tensorop = std::string("cutlass_tensorop_f16_s16816gemm_grouped_") + tag;
+  operations->emplace_back(new GroupedGemmOperationExtImpl<
+    TensorOpGroupedGemm<LayoutB, GemmShape<128, 128, 32>, GemmShape<64, 64, 32>>>(
+      (tensorop + "_128x128_32x4").c_str(), 80, 1024));
+  operations->emplace_back(new GroupedGemmOperationExtImpl<
+    TensorOpGroupedGemm<LayoutB, GemmShape<64, 64, 32>, GemmShape<32, 32, 32>>>(
+      (tensorop + "_64x64_32x4").c_str(), 80, 1024));
+#endif
+}
+
+void initialize_grouped_gemm_operations_ext(
+    std::vector<std::unique_ptr<GroupedGemmOperationExt const>> *operations) {
+  initialize_grouped_gemm_operations_with_layout<layout::RowMajor>(operations, "nn");
+  initialize_grouped_gemm_operations_with_layout<layout::ColumnMajor>(operations, "nt");
+}
+
+} // namespace library
+} // namespace cutlass
@@ -12,18 +12,17 @@
 namespace cutlass {
 namespace library {
 
-static std::unique_ptr<SingletonExt> instance;
-
 SingletonExt::SingletonExt() {
   manifest.initialize();
   operation_table.append(manifest);
+  initialize_grouped_gemm_operations_ext(&grouped_gemm_operations);
 }
 
 SingletonExt const & SingletonExt::get() {
-  if (!instance.get()) {
-    instance.reset(new SingletonExt);
-  }
-  return *instance.get();
+  // The manifest is built on the first call. The function-local static makes that thread safe for
+  // the parallel JIT of dialect ops.
+  static SingletonExt instance;
+  return instance;
 }
 
 } // namespace library
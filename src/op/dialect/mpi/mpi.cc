@@ -0,0 +1,295 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/mpi/mpi.cc
+ * \brief Communication operators on CPU implemented by MPI.
+ */
+#include <mpi.h>
+#include <cstring>
+#include <vector>
+#include "raf/op_utils.h"
+#include "raf/communicator.h"
+#include "raf/mpi_communicator.h"
+#include "../../schema/communication.h"
+#include "../../../common/shape_utils.h"
+
+namespace raf {
+
+template <>
+inline DType::operator MPI_Datatype() const {
+  switch (code) {
+    case kDLInt:
+      if (bits == 8) return MPI_INT8_T;
+      if (bits == 32) return MPI_INT32_T;
+      if (bits == 64) return MPI_INT64_T;
+      break;
+    case kDLUInt:
+      if (bits == 8) return MPI_UINT8_T;
+      break;
+    case kDLFloat:
+      if (bits == 32) return MPI_FLOAT;
+      if (bits == 64) return MPI_DOUBLE;
+      break;
+  }
+  LOG(FATAL) << "NotImplementedError: MPI collectives on " << c_str();
+  throw;
+}
+
+namespace op {
+namespace communication {
+namespace mpi {
+using namespace distributed;
+using namespace distributed::communicator;
+using common::shape_utils::BytesCompactTensor;
+
+RAF_REGISTER_DIALECT("mpi").set_enable(DevType::kCPU());
+
+/*! \brief The number of elements in a tensor. */
+inline int64_t NumElements(const DLTensor* x) {
+  return BytesCompactTensor(*x) / (x->dtype.bits / 8);
+}
+
+/*!
+ * \brief The base of the MPI collectives. The collectives are blocking and run on the global
+ * communicator, i.e., MPI_COMM_WORLD, as MPICommunicator does not create sub-communicators.
+ */
+class MPIOpEnv : public raf::op::OpEnv {
+ protected:
+  void* communicator;
+  MPI_Op compute = MPI_SUM;
+  /*! \brief Whether to divide the sum by the number of ranks, as MPI has no average. */
+  bool average = false;
+
+  explicit MPIOpEnv(const Value& rank_list) {
+    if (rank_list.defined()) {
+      error_msgs.push_back("[MPI] The collectives on the sub-communicators are not supported");
+      return;
+    }
+    RequestDistributed(&communicator, "mpi", NullValue<Value>());
+  }
+
+  void SetComputation(const std::string& computation) {
+    if (computation == "sum") {
+      compute = MPI_SUM;
+    } else if (computation == "prod") {
+      compute = MPI_PROD;
+    } else if (computation == "min") {
+      compute = MPI_MIN;
+    } else if (computation == "max") {
+      compute = MPI_MAX;
+    } else if (computation == "avg") {
+      compute = MPI_SUM;
+      average = true;
+    } else {
+      LOG(FATAL) << "Invalid computation " << computation;
+    }
+  }
+
+  /*! \brief Divide the sum in place by the number of ranks for the average. */
+  void Average(DLTensor* x) {
+    if (!average) {
+      return;
+    }
+    int64_t n = NumElements(x);
+    int size = reinterpret_cast<CommunicatorObj*>(communicator)->size;
+    DType dtype = x->dtype;
+    if (dtype == DType(DTypeCode::kFloat(), 32)) {
+      float* data = static_cast<float*>(x->data);
+      for (int64_t i = 0; i < n; ++i) {
+        data[i] /= size;
+      }
+    } else if (dtype == DType(DTypeCode::kFloat(), 64)) {
+      double* data = static_cast<double*>(x->data);
+      for (int64_t i = 0; i < n; ++i) {
+        data[i] /= size;
+      }
+    } else {
+      LOG(FATAL) << "AllReduce with avg only supports float32 and float64, but got "
+                 << dtype.c_str();
+    }
+  }
+};
+
+class MPIAllReduce : public MPIOpEnv {
+  explicit MPIAllReduce(const CallValues& cv)
+      : MPIOpEnv(cv->args.as<raf::op::schema::AllreduceArgs>()->rank_list) {
+    auto op = ir::Op::Get("raf.op._allreduce");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto args = cv->args.as<raf::op::schema::AllreduceArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    SetComputation(args->computation);
+  }
+
+ public:
+  ~MPIAllReduce() {
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.mpi._allreduce"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::AllreduceArgs>();
+    Execute({TupleValue::make(ir::Array<Value>(args->x.begin(), args->x.end()))}, cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    auto tv = Downcast<value::TupleValue>(inputs[0]);
+    ir::Array<Value> outs;
+    if (tv->fields.size() == 1) {
+      outs.push_back(output);
+    } else {
+      outs = Downcast<value::TupleValue>(output)->fields;
+    }
+    for (size_t i = 0; i < tv->fields.size(); ++i) {
+      DLTensor* x = tv->fields[i];
+      DLTensor* out = outs[i];
+      const void* send = x->data == out->data ? MPI_IN_PLACE : x->data;
+      MPI_CALL(MPI_Allreduce(send, out->data, NumElements(x), DType(x->dtype), compute,
+                             MPI_COMM_WORLD));
+      Average(out);
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MPIAllReduce(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(mpi, _allreduce, 10);
+RAF_OP_ENV_MAKER("raf.op.mpi._allreduce", MPIAllReduce::make);
+
+class MPIAllGather : public MPIOpEnv {
+  explicit MPIAllGather(const CallValues& cv)
+      : MPIOpEnv(cv->args.as<raf::op::schema::AllgatherArgs>()->rank_list) {
+    auto op = ir::Op::Get("raf.op._allgather");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index[op]("x")};
+  }
+
+ public:
+  ~MPIAllGather() {
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.mpi._allgather"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::AllgatherArgs>();
+    Execute({args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    DLTensor* x = inputs[0];
+    DLTensor* out = output;
+    int64_t count = NumElements(x);
+    MPI_CALL(MPI_Allgather(x->data, count, DType(x->dtype), out->data, count, DType(x->dtype),
+                           MPI_COMM_WORLD));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MPIAllGather(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(mpi, _allgather, 10);
+RAF_OP_ENV_MAKER("raf.op.mpi._allgather", MPIAllGather::make);
+
+class MPIReduceScatter : public MPIOpEnv {
+  explicit MPIReduceScatter(const CallValues& cv)
+      : MPIOpEnv(cv->args.as<raf::op::schema::ReduceScatterArgs>()->rank_list) {
+    auto op = ir::Op::Get("raf.op._reduce_scatter");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto args = cv->args.as<raf::op::schema::ReduceScatterArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    SetComputation(args->computation);
+  }
+
+ public:
+  ~MPIReduceScatter() {
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.mpi._reduce_scatter"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::ReduceScatterArgs>();
+    Execute({args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    DLTensor* x = inputs[0];
+    DLTensor* out = output;
+    MPI_CALL(MPI_Reduce_scatter_block(x->data, out->data, NumElements(out), DType(x->dtype),
+                                      compute, MPI_COMM_WORLD));
+    Average(out);
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MPIReduceScatter(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(mpi, _reduce_scatter, 10);
+RAF_OP_ENV_MAKER("raf.op.mpi._reduce_scatter", MPIReduceScatter::make);
+
+class MPIBroadcast : public MPIOpEnv {
+  int root;
+
+  explicit MPIBroadcast(const CallValues& cv) : MPIOpEnv(NullValue<Value>()) {
+    auto op = ir::Op::Get("raf.op._broadcast");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto args = cv->args.as<raf::op::schema::BroadcastArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    root = args->root;
+  }
+
+ public:
+  ~MPIBroadcast() {
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.mpi._broadcast"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::BroadcastArgs>();
+    Execute({TupleValue::make(ir::Array<Value>(args->x.begin(), args->x.end()))}, cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    auto tv = Downcast<value::TupleValue>(inputs[0]);
+    ir::Array<Value> outs;
+    if (tv->fields.size() == 1) {
+      outs.push_back(output);
+    } else {
+      outs = Downcast<value::TupleValue>(output)->fields;
+    }
+    int rank = reinterpret_cast<CommunicatorObj*>(communicator)->rank;
+    for (size_t i = 0; i < tv->fields.size(); ++i) {
+      DLTensor* x = tv->fields[i];
+      DLTensor* out = outs[i];
+      if (rank == root && x->data != out->data) {
+        std::memcpy(out->data, x->data, BytesCompactTensor(*x));
+      }
+      MPI_CALL(MPI_Bcast(out->data, NumElements(out), DType(out->dtype), root, MPI_COMM_WORLD));
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MPIBroadcast(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(mpi, _broadcast, 10);
+RAF_OP_ENV_MAKER("raf.op.mpi._broadcast", MPIBroadcast::make);
+
+}  // namespace mpi
+}  // namespace communication
+}  // namespace op
+}  // namespace raf
@@ -42,6 +42,12 @@ inline DType::operator ncclDataType_t() const {
       if (bits == 16) return ncclFloat16;
       if (bits == 32) return ncclFloat32;
       if (bits == 64) return ncclFloat64;
+      break;
+#if NCCL_VERSION_CODE >= 21000
+    case kDLBfloat:
+      if (bits == 16) return ncclBfloat16;
+      break;
+#endif
   }
   LOG(FATAL) << "NotImplementedError: " << c_str();
   throw;
@@ -7,15 +7,19 @@
  * \file src/op/dialect/cuda/nccl.cc
  * \brief Communication operators implmentated by NCCL
  */
+#include <algorithm>
+#include <map>
 #include <vector>
 #include <chrono>
 #include <thread>
 #include "raf/op_utils.h"
 #include "raf/dist_config.h"
+#include "raf/metrics.h"
 #include "raf/nccl_communicator.h"
 #include "../../../src/common/cuda_utils.h"
 #include "../../schema/communication.h"
 #include "./communication_utils.h"
+#include "../../../profiler/nvtx/nvtx.h"
 
 namespace raf {
 namespace op {
@@ -28,21 +32,93 @@ using stream_pool::StreamTagEnum;
 
 RAF_REGISTER_DIALECT("nccl").set_enable(DevType::kCUDA());
 
+/*!
+ * \brief Check whether the tensors are placed back to back in memory, in which case the
+ * collective can work on them as one buffer without fusing them into a workspace.
+ * \param tensors The tensors to be checked.
+ * \param sizes The size in bytes of each tensor.
+ * \return Whether the tensors are contiguous.
+ */
+bool IsContiguous(const ir::Array<Value>& tensors, const std::vector<size_t>& sizes) {
+  const uint8_t* next = nullptr;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const DLTensor* x = tensors[i];
+    const uint8_t* data = static_cast<const uint8_t*>(x->data) + x->byte_offset;
+    if (next != nullptr && data != next) {
+      return false;
+    }
+    next = data + sizes[i];
+  }
+  return true;
+}
+
+/*! \brief Get the data pointer of the first tensor, including its byte offset. */
+inline void* GetBufferBase(const ir::Array<Value>& tensors) {
+  const DLTensor* x = tensors[0];
+  return static_cast<uint8_t*>(x->data) + x->byte_offset;
+}
+
+/*! \brief The compact size in bytes of a tensor or a tuple of tensors. */
+int64_t ValueBytes(const Value& value) {
+  if (value.as<TensorValueObj>()) {
+    const DLTensor* x = value;
+    return BytesCompactTensor(*x);
+  }
+  int64_t bytes = 0;
+  if (const auto* tuple = value.as<TupleValueObj>()) {
+    for (const auto& field : tuple->fields) {
+      bytes += ValueBytes(field);
+    }
+  }
+  return bytes;
+}
+
+/*!
+ * \brief The bytes moved by a collective, which are the larger of its input and output sizes, so
+ * a send is counted by its input and a recv or an allgather is counted by its output.
+ */
+int64_t CollectiveBytes(const std::vector<Value>& inputs, const Value& output) {
+  int64_t in_bytes = 0;
+  for (const auto& input : inputs) {
+    in_bytes += ValueBytes(input);
+  }
+  return std::max(in_bytes, ValueBytes(output));
+}
+
+/*! \brief The counter of the bytes moved by the collective of the callee, e.g., "_allreduce". */
+metrics::Counter* CollectiveBytesCounter(const CallValues& cv) {
+  std::string op_name = "unknown";
+  if (const auto* op = cv->callee.as<OpValueObj>()) {
+    ir::Op base_op = IsDialectOp(op->op) ? GetBaseOp(op->op) : op->op;
+    op_name = base_op->name.substr(base_op->name.rfind('.') + 1);
+  }
+  return metrics::Registry::Get()->GetCounter(
+      "raf_collective_bytes_total", "The bytes moved by the NCCL collectives.", {{"op", op_name}});
+}
+
 class NCCLOpEnv : public raf::op::OpEnv {
  protected:
   void* stream;
   void* communicator;
-  explicit NCCLOpEnv(const CallValues& cv) {
+  metrics::Counter* bytes_counter;
+  explicit NCCLOpEnv(const CallValues& cv) : bytes_counter(CollectiveBytesCounter(cv)) {
     CUDA_CALL(cudaSetDevice(cv->device.device_id()));
   }
 };
 
 class NCCLAllReduce : public NCCLOpEnv {
-  void* fused_data;
+  void* fused_data = nullptr;
+  std::shared_ptr<memory_pool::Memory> fused_buf;
+  Device device;
   size_t total_size = 0;
   std::vector<size_t> tuple_sizes;
   DType dtype;
   ncclRedOp_t compute;
+  // The communicators inside the node and across the nodes for the hierarchical schedule.
+  void* local_communicator = nullptr;
+  void* cross_communicator = nullptr;
+  int local_size = 1;
+  int local_rank = 0;
 
   explicit NCCLAllReduce(const CallValues& cv) : NCCLOpEnv(cv) {
     auto op = ir::Op::Get("raf.op._allreduce");
@@ -79,9 +155,94 @@ class NCCLAllReduce : public NCCLOpEnv {
       total_size += size;
       dtype = x->dtype;
     }
+    device = cv->device;
+    // The workspace is not needed if the memory planner has placed the tensors contiguously
+    // (see raf.memory_plan.contiguous_collectives).
     if (tv.size() > 1) {
-      RequestWorkspace(&fused_data, cv->device, total_size);
+      auto out = ir::Downcast<value::TupleValue>(cv->out);
+      ir::Array<Value> in_fields(tv.begin(), tv.end());
+      if (!IsContiguous(in_fields, tuple_sizes) || !IsContiguous(out->fields, tuple_sizes)) {
+        RequestWorkspace(&fused_data, cv->device, total_size);
+      }
+    }
+    if (!args->rank_list.defined() && DistConfig::Global()->enable_hierarchical_allreduce) {
+      InitHierarchical();
+    }
+  }
+
+  /*!
+   * \brief Request the communicators of the hierarchical schedule if the global communicator
+   * spans multiple nodes with the same number of ranks. The ranks on each node form a local
+   * communicator, and the ranks with the same local rank on all nodes form a cross communicator.
+   */
+  void InitHierarchical() {
+    auto global_comm = GetGlobalCommunicator();
+    std::vector<std::vector<int64_t>> nodes;
+    std::map<uint64_t, int> node_ids;
+    for (int r = 0; r < global_comm->size; ++r) {
+      uint64_t host = global_comm->host_ids.at(r);
+      if (node_ids.count(host) == 0) {
+        node_ids[host] = nodes.size();
+        nodes.emplace_back();
+      }
+      auto& node = nodes[node_ids[host]];
+      if (r == global_comm->rank) {
+        local_rank = node.size();
+      }
+      node.push_back(r);
+    }
+    if (nodes.size() < 2 || nodes[0].size() < 2) {
+      return;
+    }
+    for (const auto& node : nodes) {
+      if (node.size() != nodes[0].size()) {
+        DLOG(INFO) << "Fall back to the flat allreduce as the nodes have different #ranks";
+        return;
+      }
+    }
+    local_size = nodes[0].size();
+    ir::Array<Value> local_groups, cross_groups;
+    for (const auto& node : nodes) {
+      ir::Array<Value> group;
+      for (auto r : node) {
+        group.push_back(ScalarValue::make(r));
+      }
+      local_groups.push_back(TupleValue::make(group));
+    }
+    for (int i = 0; i < local_size; ++i) {
+      ir::Array<Value> group;
+      for (const auto& node : nodes) {
+        group.push_back(ScalarValue::make(node[i]));
+      }
+      cross_groups.push_back(TupleValue::make(group));
     }
+    RequestDistributed(&local_communicator, "nccl", TupleValue::make(local_groups));
+    RequestDistributed(&cross_communicator, "nccl", TupleValue::make(cross_groups));
+  }
+
+  /*!
+   * \brief Allreduce a buffer. With the hierarchical schedule, the buffer is reduce-scattered
+   * inside the node, allreduced across the nodes on the 1/local_size chunk of each rank, and then
+   * allgathered inside the node, so that the inter-node links only carry 1/local_size of the data.
+   */
+  void AllReduce(void* send, void* recv, size_t count, size_t dtype_size, ncclComm_t nccl_comm) {
+    if (local_communicator == nullptr || count % local_size != 0) {
+      NCCL_CALL(ncclAllReduce(send, recv, count, dtype, compute, nccl_comm, (cudaStream_t)stream));
+      return;
+    }
+    auto get_nccl_comm = [](void* comm) {
+      auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(comm));
+      return Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
+    };
+    ncclComm_t local_comm = get_nccl_comm(local_communicator);
+    ncclComm_t cross_comm = get_nccl_comm(cross_communicator);
+    size_t chunk = count / local_size;
+    void* recv_chunk = reinterpret_cast<uint8_t*>(recv) + local_rank * chunk * dtype_size;
+    NCCL_CALL(ncclReduceScatter(send, recv_chunk, chunk, dtype, compute, local_comm,
+                                (cudaStream_t)stream));
+    NCCL_CALL(ncclAllReduce(recv_chunk, recv_chunk, chunk, dtype, compute, cross_comm,
+                            (cudaStream_t)stream));
+    NCCL_CALL(ncclAllGather(recv_chunk, recv, chunk, dtype, local_comm, (cudaStream_t)stream));
   }
 
  public:
@@ -99,6 +260,8 @@ class NCCLAllReduce : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
     // We can use sleep to test communication scheduling locally.
     // using namespace std::this_thread;
     // using namespace std::chrono;
@@ -113,10 +276,22 @@ class NCCLAllReduce : public NCCLOpEnv {
       DLTensor* x = tv->fields[0];
       DLTensor* out = output;
       dtype_size = GetSizeInBytes(x->dtype);
-      NCCL_CALL(ncclAllReduce(x->data, out->data, total_size / dtype_size, dtype, compute,
-                              nccl_comm, (cudaStream_t)stream));
+      AllReduce(x->data, out->data, total_size / dtype_size, dtype_size, nccl_comm);
 
     } else {
+      value::TupleValue out = tvm::runtime::Downcast<value::TupleValue>(output);
+      if (IsContiguous(tv->fields, tuple_sizes) && IsContiguous(out->fields, tuple_sizes)) {
+        // Allreduce the bucket directly.
+        DLTensor* x = tv->fields[0];
+        dtype_size = GetSizeInBytes(x->dtype);
+        AllReduce(GetBufferBase(tv->fields), GetBufferBase(out->fields), total_size / dtype_size,
+                  dtype_size, nccl_comm);
+        return;
+      }
+      if (fused_data == nullptr) {
+        fused_buf = memory_pool::Memory::Alloc(device, total_size);
+        fused_data = fused_buf->data;
+      }
       size_t offset = 0;
       for (int i = 0; i < tv->fields.size(); ++i) {
         DLTensor* x = tv->fields[i];
@@ -131,10 +306,8 @@ class NCCLAllReduce : public NCCLOpEnv {
       }
 
       // Allreduce
-      NCCL_CALL(ncclAllReduce(fused_data, fused_data, total_size / dtype_size, dtype, compute,
-                              nccl_comm, (cudaStream_t)stream));
+      AllReduce(fused_data, fused_data, total_size / dtype_size, dtype_size, nccl_comm);
       // UnFuse Tensor
-      value::TupleValue out = tvm::runtime::Downcast<value::TupleValue>(output);
       auto& of = out->fields;
       for (int i = of.size() - 1; i >= 0; --i) {
         DLTensor* x = of[i];
@@ -178,6 +351,8 @@ class NCCLAllGather : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     DLTensor* x = inputs[0];
@@ -223,6 +398,8 @@ class NCCLGroupAllGather : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
     auto comm_ptr = reinterpret_cast<NCCLCommunicatorObj*>(communicator);
     ncclComm_t nccl_comm = comm_ptr->nccl_comm;
     value::TupleValue out = tvm::runtime::Downcast<value::TupleValue>(output);
@@ -298,6 +475,8 @@ class NCCLReduceScatter : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     DLTensor* out = output;
@@ -373,6 +552,8 @@ class NCCLGroupReduceScatter : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
     auto comm_ptr = reinterpret_cast<NCCLCommunicatorObj*>(communicator);
     ncclComm_t nccl_comm = comm_ptr->nccl_comm;
     auto tv = Downcast<value::TupleValue>(inputs[0]);
@@ -398,6 +579,100 @@ class NCCLGroupReduceScatter : public NCCLOpEnv {
 RAF_REGISTER_DIALECT_OP(nccl, _group_reduce_scatter, 10);
 RAF_OP_ENV_MAKER("raf.op.nccl._group_reduce_scatter", NCCLGroupReduceScatter::make);
 
+/*!
+ * \brief Launch a mix of independent allreduce, allgather and reduce-scatter ops on the global
+ * communicator as one NCCL group, so that NCCL schedules them as one launch instead of paying the
+ * launch latency and the synchronization of each of them.
+ */
+class NCCLGroupComm : public NCCLOpEnv {
+  std::vector<int64_t> kinds;
+  std::vector<size_t> counts;
+  ncclRedOp_t compute;
+
+  explicit NCCLGroupComm(const CallValues& cv) : NCCLOpEnv(cv) {
+    auto op = ir::Op::Get("raf.op._group_comm");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index[op]("tensor_list")};
+    RequestStream(&stream, cv->device, StreamTagEnum::CudaCommunicate());
+    RequestDistributed(&communicator, "nccl", NullValue<Value>());
+    auto args = cv->args.as<raf::op::schema::GroupCommArgs>();
+    if (args->computation.compare("sum") == 0) {
+      compute = ncclSum;
+    } else if (args->computation.compare("prod") == 0) {
+      compute = ncclProd;
+    } else if (args->computation.compare("min") == 0) {
+      compute = ncclMin;
+    } else if (args->computation.compare("max") == 0) {
+      compute = ncclMax;
+    } else if (args->computation.compare("avg") == 0) {
+#if NCCL_VERSION_CODE >= 21000
+      compute = ncclAvg;
+#else
+      LOG(FATAL) << "GroupComm with avg is not supported in NCCL < 2.10";
+#endif
+    } else {
+      LOG(FATAL) << "Invalid computation " << args->computation;
+    }
+
+    kinds = args->kinds;
+    // The element count of each collective: the input of allreduce and allgather, and the output
+    // of reduce-scatter.
+    auto out = Downcast<value::TupleValue>(cv->out);
+    for (size_t i = 0; i < kinds.size(); ++i) {
+      const DLTensor* x = kinds[i] == kGroupReduceScatter ? out->fields[i] : args->tensor_list[i];
+      counts.push_back(BytesCompactTensor(*x) / (x->dtype.bits / 8));
+    }
+  }
+
+ public:
+  ~NCCLGroupComm() {
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.nccl._group_comm"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::GroupCommArgs>();
+    Execute(
+        {TupleValue::make(ir::Array<Value>(args->tensor_list.begin(), args->tensor_list.end()))},
+        cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
+    auto comm_ptr = reinterpret_cast<NCCLCommunicatorObj*>(communicator);
+    ncclComm_t nccl_comm = comm_ptr->nccl_comm;
+    auto tv = Downcast<value::TupleValue>(inputs[0]);
+    auto out = Downcast<value::TupleValue>(output);
+    NCCL_CALL(ncclGroupStart());
+    for (size_t i = 0; i < kinds.size(); ++i) {
+      DLTensor* x = tv->fields[i];
+      DLTensor* ot = out->fields[i];
+      DType dtype = x->dtype;
+      if (kinds[i] == kGroupAllReduce) {
+        NCCL_CALL(ncclAllReduce(x->data, ot->data, counts[i], dtype, compute, nccl_comm,
+                                (cudaStream_t)stream));
+      } else if (kinds[i] == kGroupAllGather) {
+        NCCL_CALL(
+            ncclAllGather(x->data, ot->data, counts[i], dtype, nccl_comm, (cudaStream_t)stream));
+      } else {
+        NCCL_CALL(ncclReduceScatter(x->data, ot->data, counts[i], dtype, compute, nccl_comm,
+                                    (cudaStream_t)stream));
+      }
+    }
+    NCCL_CALL(ncclGroupEnd());
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new NCCLGroupComm(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(nccl, _group_comm, 10);
+RAF_OP_ENV_MAKER("raf.op.nccl._group_comm", NCCLGroupComm::make);
+
 class NCCLBroadcast : public NCCLOpEnv {
   void* fused_data;
   size_t total_size = 0;
@@ -440,6 +715,8 @@ class NCCLBroadcast : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     auto tv = Downcast<value::TupleValue>(inputs[0]);
@@ -497,8 +774,9 @@ class NCCLAllToAll : public raf::op::OpEnv {
   bool group_use_memcpy = false;
   size_t total_input_size = 0;
   std::vector<size_t> tuple_sizes;
+  metrics::Counter* bytes_counter;
 
-  explicit NCCLAllToAll(const CallValues& cv) {
+  explicit NCCLAllToAll(const CallValues& cv) : bytes_counter(CollectiveBytesCounter(cv)) {
     auto op = ir::Op::Get("raf.op._all_to_all");
     auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
     this->arg_indices = {fschema_index[op]("x")};
@@ -537,6 +815,8 @@ class NCCLAllToAll : public raf::op::OpEnv {
   }
 
   void Execute(const std::vector<Value>& inputs, value::Value output) {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     auto input_x = Downcast<value::TupleValue>(inputs[0]);
@@ -640,6 +920,123 @@ class NCCLAllToAll : public raf::op::OpEnv {
 RAF_REGISTER_DIALECT_OP(nccl, _all_to_all, 10);
 RAF_OP_ENV_MAKER("raf.op.nccl._all_to_all", NCCLAllToAll::make);
 
+/*!
+ * \brief All-to-all with variable-size splits. The input is split into equal blocks along the first
+ * axis, which are evenly distributed to the ranks in order, and only the first send_counts[i] rows
+ * of block i are sent. The counts are exchanged on device, so the caller only needs to allocate
+ * the blocks by their capacity. However, NCCL takes the message sizes on host, so the counts are
+ * copied to host on the communication stream, and the host waits for them before issuing the
+ * data transfers.
+ */
+class NCCLAllToAllv : public NCCLOpEnv {
+  int64_t n_block;
+  int64_t block_rows;
+  int64_t row_size;
+  int64_t block_bytes;
+  std::vector<int64_t> host_send_counts;
+  std::vector<int64_t> host_recv_counts;
+
+  explicit NCCLAllToAllv(const CallValues& cv) : NCCLOpEnv(cv) {
+    auto op = ir::Op::Get("raf.op._all_to_allv");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index[op]("x"), fschema_index[op]("send_counts")};
+    RequestStream(&stream, cv->device, StreamTagEnum::CudaCommunicate());
+    RequestDistributed(&communicator, "nccl", NullValue<Value>());
+    auto args = cv->args.as<raf::op::schema::AllToAllvArgs>();
+    DLTensor* x = args->x;
+    DLTensor* send_counts = args->send_counts;
+    n_block = send_counts->shape[0];
+    block_rows = x->shape[0] / n_block;
+    row_size = 1;
+    for (int i = 1; i < x->ndim; ++i) {
+      row_size *= x->shape[i];
+    }
+    block_bytes = block_rows * row_size * GetSizeInBytes(x->dtype);
+    host_send_counts.resize(n_block);
+    host_recv_counts.resize(n_block);
+#if NCCL_VERSION_CODE < 20700
+    LOG(FATAL) << "AllToAllv is not supported in NCCL < 2.7.0";
+#endif
+  }
+
+ public:
+  ~NCCLAllToAllv() {
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.nccl._all_to_allv"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::AllToAllvArgs>();
+    Execute({args->x, args->send_counts}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, value::Value output) {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
+    auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
+    ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
+    DLTensor* x = inputs[0];
+    DLTensor* send_counts = inputs[1];
+    auto out_tuple = Downcast<value::TupleValue>(output);
+    DLTensor* out = out_tuple->fields[0];
+    DLTensor* recv_counts = out_tuple->fields[1];
+    auto cuda_stream = (cudaStream_t)stream;
+    int64_t n_ranks = comm_ref->size;
+    int64_t block_per_rank = n_block / n_ranks;
+    DType counts_dtype = send_counts->dtype;
+
+    // Exchange the counts on device.
+    auto* send_counts_data = reinterpret_cast<int64_t*>(send_counts->data);
+    auto* recv_counts_data = reinterpret_cast<int64_t*>(recv_counts->data);
+    NCCL_CALL(ncclGroupStart());
+    for (int64_t i = 0; i < n_ranks; ++i) {
+      NCCL_CALL(ncclSend(send_counts_data + i * block_per_rank, block_per_rank, counts_dtype, i,
+                         nccl_comm, cuda_stream));
+      NCCL_CALL(ncclRecv(recv_counts_data + i * block_per_rank, block_per_rank, counts_dtype, i,
+                         nccl_comm, cuda_stream));
+    }
+    NCCL_CALL(ncclGroupEnd());
+    size_t counts_bytes = n_block * sizeof(int64_t);
+    CUDA_CALL(cudaMemcpyAsync(host_send_counts.data(), send_counts_data, counts_bytes,
+                              cudaMemcpyDeviceToHost, cuda_stream));
+    CUDA_CALL(cudaMemcpyAsync(host_recv_counts.data(), recv_counts_data, counts_bytes,
+                              cudaMemcpyDeviceToHost, cuda_stream));
+    CUDA_CALL(cudaStreamSynchronize(cuda_stream));
+    for (int64_t i = 0; i < n_block; ++i) {
+      CHECK(0 <= host_send_counts[i] && host_send_counts[i] <= block_rows)
+          << "Cannot send " << host_send_counts[i] << " rows in a block of " << block_rows;
+    }
+
+    // The rows after the received ones are zeros.
+    CUDA_CALL(cudaMemsetAsync(out->data, 0, block_bytes * n_block, cuda_stream));
+    DType dtype = x->dtype;
+    char* send_buffer = reinterpret_cast<char*>(x->data);
+    char* recv_buffer = reinterpret_cast<char*>(out->data);
+    NCCL_CALL(ncclGroupStart());
+    for (int64_t i = 0; i < n_block; ++i) {
+      int peer = i / block_per_rank;
+      if (host_send_counts[i] > 0) {
+        NCCL_CALL(ncclSend(send_buffer + i * block_bytes, host_send_counts[i] * row_size, dtype,
+                           peer, nccl_comm, cuda_stream));
+      }
+      if (host_recv_counts[i] > 0) {
+        NCCL_CALL(ncclRecv(recv_buffer + i * block_bytes, host_recv_counts[i] * row_size, dtype,
+                           peer, nccl_comm, cuda_stream));
+      }
+    }
+    NCCL_CALL(ncclGroupEnd());
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new NCCLAllToAllv(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(nccl, _all_to_allv, 10);
+RAF_OP_ENV_MAKER("raf.op.nccl._all_to_allv", NCCLAllToAllv::make);
+
 class NCCLSend : public NCCLOpEnv {
   int peer;
 
@@ -669,6 +1066,8 @@ class NCCLSend : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     const DLTensor* x = inputs[0];
@@ -714,6 +1113,8 @@ class NCCLRecv : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     DLTensor* out = output;
@@ -792,6 +1193,8 @@ class NCCLReduce : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    RAF_NVTX_RANGE(kComm, name());
+    bytes_counter->Inc(CollectiveBytes(inputs, output));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     auto input_x = Downcast<value::TupleValue>(inputs[0]);
@@ -0,0 +1,775 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/nvrtc/nvrtc_fusion.cc
+ * \brief Generate CUDA C for the fused elementwise, broadcast and reduction functions, and build
+ * them by NVRTC, which takes milliseconds instead of the seconds of the TVM lowering.
+ */
+#include <cuda.h>
+#include <nvrtc.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "raf/cache.h"
+#include "raf/device_api.h"
+#include "raf/ir.h"
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/pass.h"
+#include "raf/registry.h"
+#include "raf/value.h"
+#include "../../../common/cuda_utils.h"
+#include "../../ty/utils.h"
+
+#define NVRTC_CALL(func)                                                                \
+  do {                                                                                  \
+    nvrtcResult e = (func);                                                             \
+    CHECK(e == NVRTC_SUCCESS) << "NVRTC error " << e << ": " << nvrtcGetErrorString(e); \
+  } while (false)
+
+#define CU_CALL(func)                                                        \
+  do {                                                                       \
+    CUresult e = (func);                                                     \
+    if (e != CUDA_SUCCESS) {                                                 \
+      const char* msg = nullptr;                                             \
+      cuGetErrorString(e, &msg);                                             \
+      LOG(FATAL) << "CUDA driver error " << e << ": " << (msg ? msg : "");   \
+    }                                                                        \
+  } while (false)
+
+namespace raf {
+namespace op {
+namespace nvrtc {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+RAF_REGISTER_DIALECT("nvrtc").set_enable(DevType::kCUDA());
+
+/*! \brief The number of threads per block of the generated kernels. */
+constexpr int kNumThreads = 256;
+/*! \brief The maximum number of blocks, beyond which the kernels loop over the grid. */
+constexpr int64_t kMaxBlocks = 65535;
+
+/*!
+ * \brief The CUDA C expressions of the supported elementwise ops, where $0 and $1 are the
+ * operands. All ops are computed in float.
+ */
+const std::unordered_map<std::string, std::string>& ElemwiseExprs() {
+  static const std::unordered_map<std::string, std::string> exprs = {
+      {"raf.op.add", "$0 + $1"},
+      {"raf.op.subtract", "$0 - $1"},
+      {"raf.op.multiply", "$0 * $1"},
+      {"raf.op.divide", "$0 / $1"},
+      {"raf.op.maximum", "fmaxf($0, $1)"},
+      {"raf.op.minimum", "fminf($0, $1)"},
+      {"raf.op.power", "powf($0, $1)"},
+      {"raf.op.relu", "fmaxf($0, 0.f)"},
+      {"raf.op.exp", "expf($0)"},
+      {"raf.op.log", "logf($0)"},
+      {"raf.op.tanh", "tanhf($0)"},
+      {"raf.op.sigmoid", "1.f / (1.f + expf(-$0))"},
+      {"raf.op.negative", "-$0"},
+      {"raf.op.sqrt", "sqrtf($0)"},
+      {"raf.op.rsqrt", "rsqrtf($0)"},
+      {"raf.op.abs", "fabsf($0)"},
+      {"raf.op.erf", "erff($0)"},
+      {"raf.op.sin", "sinf($0)"},
+      {"raf.op.cos", "cosf($0)"},
+      {"raf.op.gelu", "0.5f * $0 * (1.f + erff($0 * 0.70710678f))"},
+      {"raf.op.copy", "$0"},
+      {"raf.op.cast", "$0"},
+  };
+  return exprs;
+}
+
+/*! \brief The initial value and the combiner of the supported reductions. */
+struct ReduceInfo {
+  std::string init;
+  std::string combine;
+};
+
+const std::unordered_map<std::string, ReduceInfo>& ReduceInfos() {
+  static const std::unordered_map<std::string, ReduceInfo> infos = {
+      {"raf.op.sum", {"0.f", "$0 + $1"}},
+      {"raf.op.mean", {"0.f", "$0 + $1"}},
+      {"raf.op.max", {"-__int_as_float(0x7f800000)", "fmaxf($0, $1)"}},
+      {"raf.op.min", {"__int_as_float(0x7f800000)", "fminf($0, $1)"}},
+  };
+  return infos;
+}
+
+/*! \brief Replace $0 and $1 in the pattern with the operands. */
+std::string Format(const std::string& pattern, const std::vector<std::string>& operands) {
+  std::string ret;
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    if (pattern[i] == '$' && i + 1 < pattern.size() && std::isdigit(pattern[i + 1])) {
+      ret += operands[pattern[i + 1] - '0'];
+      ++i;
+    } else {
+      ret += pattern[i];
+    }
+  }
+  return ret;
+}
+
+inline bool IsNullArg(const Expr& expr) {
+  const auto* konst = expr.as<ConstantNode>();
+  return konst != nullptr && !konst->value.defined();
+}
+
+/*! \brief Get the base op name of an op call, or an empty string if it is not an op call. */
+std::string GetBaseOpName(const CallNode* call) {
+  const auto* node = call->op.as<OpNode>();
+  if (node == nullptr) {
+    return "";
+  }
+  Op op = GetRef<Op>(node);
+  op = IsDialectOp(op) ? GetBaseOp(op) : op;
+  return op->name;
+}
+
+/*! \brief Whether the type is a float32 or float16 tensor. */
+inline bool IsSupportedTensor(const Type& type) {
+  const auto* ttype = type.as<TensorTypeNode>();
+  return ttype != nullptr &&
+         (ttype->dtype == DataType::Float(32) || ttype->dtype == DataType::Float(16));
+}
+
+/*!
+ * \brief Generate a CUDA kernel for a typed primitive function, which consists of elementwise and
+ * broadcast ops, with an optional sum/mean/max/min over the trailing axes as its output. Each
+ * thread computes the output elements in float, and reads the inputs by projecting the output
+ * index to them with the right-aligned broadcast. A reduction is done by a block per row. The
+ * output of a function without a reduction can also be a tuple of the same shape.
+ *
+ * Without shapes, only the ops and dtypes are checked, so that the functions with the dynamic
+ * shapes can be marked before the shapes are known. The kernel is then generated at dispatch by
+ * the function specialized to the argument shapes.
+ */
+class NVRTCCodegen : public ExprFunctor<std::string(const Expr&)> {
+ public:
+  NVRTCCodegen(const Function& func, bool with_shapes) : func_(func), with_shapes_(with_shapes) {
+  }
+
+  /*! \brief Generate the kernel, or return false if the function is not supported. */
+  bool Generate() {
+    for (size_t i = 0; i < func_->params.size(); ++i) {
+      if (!IsSupportedTensor(func_->params[i]->checked_type())) {
+        return false;
+      }
+      param_index_[func_->params[i].get()] = i;
+    }
+    Expr root = func_->body;
+    while (const auto* let = root.as<LetNode>()) {
+      let_values_[let->var.get()] = let->value;
+      root = let->body;
+    }
+    while (const auto* var = root.as<VarNode>()) {
+      if (!let_values_.count(var)) {
+        break;
+      }
+      root = let_values_.at(var);
+    }
+
+    Array<Expr> outputs;
+    const auto* call = root.as<CallNode>();
+    std::string reduce_op = call ? GetBaseOpName(call) : "";
+    if (!ReduceInfos().count(reduce_op)) {
+      reduce_op = "";
+    }
+    if (!reduce_op.empty()) {
+      if (!SetReduction(call, reduce_op)) {
+        return false;
+      }
+      outputs.push_back(call->args[0]);
+    } else {
+      if (const auto* tuple = root.as<TupleNode>()) {
+        outputs = tuple->fields;
+      } else {
+        outputs.push_back(root);
+      }
+      if (!SetIterShape(outputs)) {
+        return false;
+      }
+    }
+
+    std::vector<std::string> values;
+    for (const auto& output : outputs) {
+      std::string value = VisitExpr(output);
+      if (failed_) {
+        return false;
+      }
+      values.push_back(value);
+    }
+    Type out_type = reduce_op.empty() ? root->checked_type() : call->checked_type();
+    std::vector<Type> out_types;
+    if (const auto* tuple_type = out_type.as<TupleTypeNode>()) {
+      out_types.assign(tuple_type->fields.begin(), tuple_type->fields.end());
+    } else {
+      out_types.push_back(out_type);
+    }
+    for (const auto& type : out_types) {
+      if (!IsSupportedTensor(type)) {
+        return false;
+      }
+    }
+    if (!with_shapes_) {
+      return true;
+    }
+    EmitKernel(values, out_types, reduce_op);
+    return true;
+  }
+
+  /*! \brief The generated CUDA C source. */
+  std::string source;
+  /*! \brief The name of the kernel. */
+  std::string func_name;
+  /*! \brief The number of threads to launch, or the number of rows of a reduction. */
+  int64_t num_elements = 1;
+  /*! \brief Whether the kernel ends with a reduction, which is launched with a block per row. */
+  bool reduce = false;
+
+ private:
+  std::string VisitExpr(const Expr& expr) final {
+    if (failed_) {
+      return "";
+    }
+    auto it = memo_.find(expr.get());
+    if (it != memo_.end()) {
+      return it->second;
+    }
+    std::string ret = ExprFunctor::VisitExpr(expr);
+    memo_[expr.get()] = ret;
+    return ret;
+  }
+
+  std::string VisitExpr_(const VarNode* var) final {
+    if (let_values_.count(var)) {
+      return VisitExpr(let_values_.at(var));
+    }
+    if (!param_index_.count(var)) {
+      return Fail();
+    }
+    int index = param_index_.at(var);
+    std::string name = NewValue();
+    std::string idx = "i";
+    if (with_shapes_) {
+      idx = ProjectIndex(var->checked_type());
+      if (idx.empty()) {
+        return Fail();
+      }
+    }
+    body_ << "      float " << name << " = " << Load(var->checked_type(), index) << "[" << idx
+          << "]);\n";
+    return name;
+  }
+
+  std::string VisitExpr_(const ConstantNode* node) final {
+    double value;
+    if (const auto* fv = node->value.as<FloatValueObj>()) {
+      value = fv->value;
+    } else if (const auto* iv = node->value.as<IntValueObj>()) {
+      value = iv->value;
+    } else {
+      return Fail();
+    }
+    if (!std::isfinite(value)) {
+      return Fail();
+    }
+    std::ostringstream os;
+    os << "((float)" << std::setprecision(17) << value << ")";
+    return os.str();
+  }
+
+  std::string VisitExpr_(const CallNode* call) final {
+    std::string op_name = GetBaseOpName(call);
+    const auto& exprs = ElemwiseExprs();
+    auto it = exprs.find(op_name);
+    if (it == exprs.end() || !IsSupportedTensor(call->checked_type())) {
+      return Fail();
+    }
+    // The operands are the leading arguments used by the pattern, and the rest must be omitted,
+    // except for the dtype of cast, which is checked by the type of the call.
+    size_t arity = it->second.find("$1") != std::string::npos ? 2 : 1;
+    if (call->args.size() < arity) {
+      return Fail();
+    }
+    size_t num_extra = op_name == "raf.op.cast" ? 1 : 0;
+    for (size_t i = arity + num_extra; i < call->args.size(); ++i) {
+      if (!IsNullArg(call->args[i])) {
+        return Fail();
+      }
+    }
+    std::vector<std::string> operands;
+    for (size_t i = 0; i < arity; ++i) {
+      operands.push_back(VisitExpr(call->args[i]));
+    }
+    if (failed_) {
+      return "";
+    }
+    op_names_.push_back(op_name.substr(op_name.rfind('.') + 1));
+    std::string name = NewValue();
+    body_ << "      float " << name << " = " << Format(it->second, operands) << ";\n";
+    return name;
+  }
+
+  std::string VisitExprDefault_(const Object* node) final {
+    return Fail();
+  }
+
+  std::string Fail() {
+    failed_ = true;
+    return "";
+  }
+
+  std::string NewValue() {
+    return "v" + std::to_string(num_values_++);
+  }
+
+  /*! \brief The load of a parameter in float, which is closed by the caller after the index. */
+  static std::string Load(const Type& type, int index) {
+    bool fp16 = type.as<TensorTypeNode>()->dtype == DataType::Float(16);
+    return std::string(fp16 ? "h2f(" : "(") + "in" + std::to_string(index);
+  }
+
+  static std::string CType(const Type& type) {
+    bool fp16 = type.as<TensorTypeNode>()->dtype == DataType::Float(16);
+    return fp16 ? "unsigned short" : "float";
+  }
+
+  /*! \brief Get the static shape of a tensor type, or return false if it is dynamic. */
+  static bool GetShape(const Type& type, std::vector<int64_t>* shape) {
+    const auto* ttype = type.as<TensorTypeNode>();
+    shape->clear();
+    for (const auto& dim : ttype->shape) {
+      const auto* imm = dim.as<IntImmNode>();
+      if (imm == nullptr) {
+        return false;
+      }
+      shape->push_back(imm->value);
+    }
+    return true;
+  }
+
+  /*! \brief Set the iteration shape to the shape of the outputs, which must be the same. */
+  bool SetIterShape(const Array<Expr>& outputs) {
+    iter_ndim_ = -1;
+    for (const auto& output : outputs) {
+      const auto* ttype = output->checked_type().as<TensorTypeNode>();
+      if (ttype == nullptr) {
+        return false;
+      }
+      std::vector<int64_t> shape;
+      if (with_shapes_ && !GetShape(output->checked_type(), &shape)) {
+        return false;
+      }
+      if (iter_ndim_ == -1) {
+        iter_ndim_ = ttype->shape.size();
+        iter_shape_ = shape;
+      } else if (iter_ndim_ != static_cast<int64_t>(ttype->shape.size()) || iter_shape_ != shape) {
+        return false;
+      }
+    }
+    return iter_ndim_ != -1;
+  }
+
+  /*!
+   * \brief Set the iteration shape to the shape of the reduced tensor, where the reduced axes must
+   * be the trailing ones, so that each output element reduces a contiguous row.
+   */
+  bool SetReduction(const CallNode* call, const std::string& op_name) {
+    if (call->args.empty() || !SetIterShape({call->args[0]})) {
+      return false;
+    }
+    std::vector<int64_t> axes;
+    if (call->args.size() > 1 && !IsNullArg(call->args[1])) {
+      const auto* konst = call->args[1].as<ConstantNode>();
+      if (konst == nullptr) {
+        return false;
+      }
+      for (int64_t axis : GetShapeVecFromValue(Downcast<Value>(konst->value))) {
+        axes.push_back(axis < 0 ? axis + iter_ndim_ : axis);
+      }
+    }
+    if (call->args.size() > 3 && !IsNullArg(call->args[3])) {
+      const auto* konst = call->args[3].as<ConstantNode>();
+      if (konst == nullptr || GetScalarValueData<bool>(Downcast<Value>(konst->value))) {
+        return false;
+      }
+    }
+    std::sort(axes.begin(), axes.end());
+    axes.resize(std::unique(axes.begin(), axes.end()) - axes.begin());
+    reduce_axis_ = axes.empty() ? 0 : axes[0];
+    for (size_t i = 0; i < axes.size(); ++i) {
+      if (axes[i] != reduce_axis_ + static_cast<int64_t>(i)) {
+        return false;
+      }
+    }
+    if (!axes.empty() && axes.back() != iter_ndim_ - 1) {
+      return false;
+    }
+    op_names_.push_back(op_name.substr(op_name.rfind('.') + 1));
+    return true;
+  }
+
+  /*!
+   * \brief Get the index of a parameter from the coordinates c<i> of the iteration shape, or an
+   * empty string if the parameter does not broadcast to it.
+   */
+  std::string ProjectIndex(const Type& type) {
+    std::vector<int64_t> shape;
+    if (!GetShape(type, &shape) || shape.size() > iter_shape_.size()) {
+      return "";
+    }
+    if (shape == iter_shape_) {
+      return "i";
+    }
+    size_t offset = iter_shape_.size() - shape.size();
+    std::ostringstream os;
+    os << "0";
+    int64_t stride = 1;
+    for (int64_t d = shape.size() - 1; d >= 0; --d) {
+      if (shape[d] == iter_shape_[d + offset]) {
+        os << " + c" << d + offset << " * " << stride << "LL";
+      } else if (shape[d] != 1) {
+        return "";
+      }
+      stride *= shape[d];
+    }
+    return os.str();
+  }
+
+  void EmitKernel(const std::vector<std::string>& values, const std::vector<Type>& out_types,
+                  const std::string& reduce_op) {
+    std::ostringstream name;
+    name << "fused";
+    for (const auto& op_name : op_names_) {
+      name << "_" << op_name;
+    }
+    func_name = name.str();
+    reduce = !reduce_op.empty();
+
+    int64_t num_iters = 1;
+    for (int64_t dim : iter_shape_) {
+      num_iters *= dim;
+    }
+    int64_t row_size = 1;
+    for (size_t d = reduce_axis_; reduce && d < iter_shape_.size(); ++d) {
+      row_size *= iter_shape_[d];
+    }
+    num_elements = reduce ? (row_size == 0 ? 0 : num_iters / row_size) : num_iters;
+
+    // The coordinates of the flat index i in the iteration shape.
+    std::ostringstream coords;
+    coords << "      long long r = i;\n";
+    for (int64_t d = iter_shape_.size() - 1; d >= 0; --d) {
+      coords << "      long long c" << d << " = r % " << iter_shape_[d] << "LL; r /= "
+             << iter_shape_[d] << "LL;\n";
+    }
+
+    std::ostringstream os;
+    os << "__device__ __forceinline__ float h2f(unsigned short x) {\n"
+       << "  float f;\n"
+       << "  asm(\"cvt.f32.f16 %0, %1;\" : \"=f\"(f) : \"h\"(x));\n"
+       << "  return f;\n"
+       << "}\n"
+       << "__device__ __forceinline__ unsigned short f2h(float f) {\n"
+       << "  unsigned short x;\n"
+       << "  asm(\"cvt.rn.f16.f32 %0, %1;\" : \"=h\"(x) : \"f\"(f));\n"
+       << "  return x;\n"
+       << "}\n"
+       << "extern \"C\" __global__ void " << func_name << "(";
+    for (size_t i = 0; i < func_->params.size(); ++i) {
+      os << "const " << CType(func_->params[i]->checked_type()) << "* __restrict__ in" << i
+         << ", ";
+    }
+    for (size_t i = 0; i < out_types.size(); ++i) {
+      os << CType(out_types[i]) << "* __restrict__ out" << i
+         << (i + 1 < out_types.size() ? ", " : ") {\n");
+    }
+    auto store = [&](size_t i, const std::string& value) {
+      bool fp16 = out_types[i].as<TensorTypeNode>()->dtype == DataType::Float(16);
+      return fp16 ? "f2h(" + value + ")" : value;
+    };
+
+    if (!reduce) {
+      os << "  for (long long i = blockIdx.x * (long long)blockDim.x + threadIdx.x; i < "
+         << num_iters << "LL; i += (long long)blockDim.x * gridDim.x) {\n"
+         << "    {\n"
+         << coords.str() << body_.str();
+      for (size_t i = 0; i < values.size(); ++i) {
+        os << "      out" << i << "[i] = " << store(i, values[i]) << ";\n";
+      }
+      os << "    }\n"
+         << "  }\n"
+         << "}\n";
+      source = os.str();
+      return;
+    }
+
+    const ReduceInfo& info = ReduceInfos().at(reduce_op);
+    std::string acc = reduce_op == "raf.op.mean" ? "acc / " + std::to_string(row_size) + ".f"
+                                                 : std::string("acc");
+    std::string shfl = Format(info.combine, {"acc", "__shfl_down_sync(0xffffffff, acc, o)"});
+    os << "  __shared__ float smem[32];\n"
+       << "  for (long long row = blockIdx.x; row < " << num_elements
+       << "LL; row += gridDim.x) {\n"
+       << "    float acc = " << info.init << ";\n"
+       << "    for (long long j = threadIdx.x; j < " << row_size << "LL; j += blockDim.x) {\n"
+       << "      long long i = row * " << row_size << "LL + j;\n"
+       << coords.str() << body_.str() << "      acc = " << Format(info.combine, {"acc", values[0]})
+       << ";\n"
+       << "    }\n"
+       << "    for (int o = 16; o > 0; o >>= 1) acc = " << shfl << ";\n"
+       << "    if ((threadIdx.x & 31) == 0) smem[threadIdx.x >> 5] = acc;\n"
+       << "    __syncthreads();\n"
+       << "    if (threadIdx.x < 32) {\n"
+       << "      acc = threadIdx.x < (blockDim.x >> 5) ? smem[threadIdx.x] : " << info.init
+       << ";\n"
+       << "      for (int o = 16; o > 0; o >>= 1) acc = " << shfl << ";\n"
+       << "      if (threadIdx.x == 0) out0[row] = " << store(0, acc) << ";\n"
+       << "    }\n"
+       << "    __syncthreads();\n"
+       << "  }\n"
+       << "}\n";
+    source = os.str();
+  }
+
+  /*! \brief The function to generate the kernel for. */
+  Function func_;
+  /*! \brief Whether to generate the kernel with the static shapes, or only check the ops. */
+  bool with_shapes_;
+  /*! \brief Whether the function has an unsupported expression. */
+  bool failed_ = false;
+  /*! \brief Mapping from the parameters to their indices. */
+  std::unordered_map<const VarNode*, int> param_index_;
+  /*! \brief Mapping from the let-bound variables to their values. */
+  std::unordered_map<const VarNode*, Expr> let_values_;
+  /*! \brief Mapping from the visited expressions to their values in the kernel. */
+  std::unordered_map<const Object*, std::string> memo_;
+  /*! \brief The statements computing the values of an element. */
+  std::ostringstream body_;
+  /*! \brief The number of values in the kernel. */
+  int num_values_ = 0;
+  /*! \brief The names of the fused ops. */
+  std::vector<std::string> op_names_;
+  /*! \brief The shape iterated by the threads, which is the reduced tensor of a reduction. */
+  std::vector<int64_t> iter_shape_;
+  /*! \brief The rank of the iteration shape. */
+  int64_t iter_ndim_ = -1;
+  /*! \brief The first reduced axis. */
+  int64_t reduce_axis_ = 0;
+};
+
+/*! \brief The PTX built by NVRTC, which is persisted as text. */
+class NVRTCModuleCacheEntry {
+ public:
+  NVRTCModuleCacheEntry() {
+  }
+
+  NVRTCModuleCacheEntry(const std::string& ptx, const std::string& func_name)
+      : ptx_(ptx), func_name_(func_name) {
+  }
+
+  static NVRTCModuleCacheEntry Load(const std::string path) {
+    std::ifstream ptx_ifs(path + "/" + PTX_FILE);
+    std::stringstream ptx;
+    ptx << ptx_ifs.rdbuf();
+    std::ifstream name_ifs(path + "/" + FUNC_NAME_FILE);
+    std::string func_name;
+    name_ifs >> func_name;
+    CHECK(!ptx.str().empty() && !func_name.empty()) << "Incomplete NVRTC cache entry " << path;
+    return NVRTCModuleCacheEntry(ptx.str(), func_name);
+  }
+
+  bool Save(const std::string& path) {
+    std::ofstream ptx_ofs(path + "/" + PTX_FILE);
+    ptx_ofs << ptx_;
+    std::ofstream name_ofs(path + "/" + FUNC_NAME_FILE);
+    name_ofs << func_name_;
+    return ptx_ofs.good() && name_ofs.good();
+  }
+
+  const std::string& GetPTX() const {
+    return ptx_;
+  }
+
+  const std::string& GetFuncName() const {
+    return func_name_;
+  }
+
+ private:
+  /*! \brief The persist PTX file. */
+  static constexpr const char* PTX_FILE = "kernel.ptx";
+  /*! \brief The persist function name file. */
+  static constexpr const char* FUNC_NAME_FILE = "func_name.txt";
+  /*! \brief The built PTX. */
+  std::string ptx_;
+  /*! \brief The name of the kernel. */
+  std::string func_name_;
+};
+
+MetaPersistCache<NVRTCModuleCacheEntry> CacheBuildNVRTC("nvrtc");
+
+/*! \brief Compile the source to PTX for the compute capability of the current device. */
+NVRTCModuleCacheEntry Compile(const std::string& source, const std::string& func_name,
+                              const std::string& arch) {
+  nvrtcProgram prog;
+  NVRTC_CALL(nvrtcCreateProgram(&prog, source.c_str(), (func_name + ".cu").c_str(), 0, nullptr,
+                                nullptr));
+  std::string arch_opt = "--gpu-architecture=" + arch;
+  std::vector<const char*> opts = {arch_opt.c_str(), "--use_fast_math"};
+  nvrtcResult ret = nvrtcCompileProgram(prog, opts.size(), opts.data());
+  if (ret != NVRTC_SUCCESS) {
+    size_t log_size;
+    NVRTC_CALL(nvrtcGetProgramLogSize(prog, &log_size));
+    std::string log(log_size, '\0');
+    NVRTC_CALL(nvrtcGetProgramLog(prog, &log[0]));
+    NVRTC_CALL(nvrtcDestroyProgram(&prog));
+    LOG(FATAL) << "Failed to compile " << func_name << " by NVRTC: " << log << "\n" << source;
+  }
+  size_t ptx_size;
+  NVRTC_CALL(nvrtcGetPTXSize(prog, &ptx_size));
+  std::string ptx(ptx_size, '\0');
+  NVRTC_CALL(nvrtcGetPTX(prog, &ptx[0]));
+  NVRTC_CALL(nvrtcDestroyProgram(&prog));
+  return NVRTCModuleCacheEntry(ptx, func_name);
+}
+
+/*! \brief Get the virtual architecture of the current device, such as compute_70. */
+std::string GetArch() {
+  int device, major, minor;
+  CUDA_CALL(cudaGetDevice(&device));
+  CUDA_CALL(cudaDeviceGetAttribute(&major, cudaDevAttrComputeCapabilityMajor, device));
+  CUDA_CALL(cudaDeviceGetAttribute(&minor, cudaDevAttrComputeCapabilityMinor, device));
+  return "compute_" + std::to_string(major * 10 + minor);
+}
+
+/*! \brief Specialize the parameter types of a fused function to its arguments. */
+Function Specialize(const Function& func, const Array<Value>& args) {
+  Array<Var> params;
+  Map<Var, Expr> params_map;
+  for (size_t i = 0; i < func->params.size(); ++i) {
+    Var param = MakeVar(func->params[i]->name_hint(), op::GetType(args[i]));
+    params.push_back(param);
+    params_map.Set(func->params[i], param);
+  }
+  Function ret(params, pass::Substitute(func->body, params_map), {}, {});
+  return Downcast<Function>(pass::InferType(ret));
+}
+
+class NVRTCOpEnv : public OpEnv {
+ public:
+  ~NVRTCOpEnv() {
+    if (module_ != nullptr) {
+      cuModuleUnload(module_);
+    }
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  void Execute(const CallValues& cv) override {
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (int i : arg_indices) {
+      inputs.push_back(args[i]);
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    if (num_elements_ == 0) {
+      return;
+    }
+    std::vector<void*> ptrs;
+    for (const auto& input : inputs) {
+      DLTensor* tensor = Downcast<TensorValue>(input);
+      ptrs.push_back(tensor->data);
+    }
+    if (const auto* tuple = output.as<TupleValueObj>()) {
+      for (const auto& field : tuple->fields) {
+        DLTensor* tensor = Downcast<TensorValue>(field);
+        ptrs.push_back(tensor->data);
+      }
+    } else {
+      DLTensor* tensor = Downcast<TensorValue>(output);
+      ptrs.push_back(tensor->data);
+    }
+    std::vector<void*> kernel_args;
+    for (auto& ptr : ptrs) {
+      kernel_args.push_back(&ptr);
+    }
+    int64_t num_blocks =
+        reduce_ ? num_elements_ : (num_elements_ + kNumThreads - 1) / kNumThreads;
+    num_blocks = std::min(num_blocks, kMaxBlocks);
+    auto stream = static_cast<CUstream>(cuda_device_api->GetStream());
+    CU_CALL(cuLaunchKernel(function_, num_blocks, 1, 1, kNumThreads, 1, 1, 0, stream,
+                           kernel_args.data(), nullptr));
+  }
+
+  static OpEnv* make(const CallValues& call) {
+    auto env = std::make_unique<NVRTCOpEnv>();
+    Function func = Downcast<ClosureValue>(call->callee)->func;
+    Array<Value> args = GetListArgs(call->args);
+    NVRTCCodegen codegen(Specialize(func, args), true);
+    if (!codegen.Generate()) {
+      env->error_msgs.push_back("[NVRTC] Unsupported fused function");
+      return env.release();
+    }
+    env->env_name_ = TruncateName(GetUniqueName("raf.op.nvrtc." + codegen.func_name));
+    env->num_elements_ = codegen.num_elements;
+    env->reduce_ = codegen.reduce;
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      env->arg_indices.push_back(i);
+    }
+
+    // The PTX is determined by the source, which is specialized to the shapes, and the device.
+    std::string arch = GetArch();
+    HashKey key;
+    key << codegen.source << arch;
+    std::shared_ptr<const NVRTCModuleCacheEntry> entry = CacheBuildNVRTC.Get(key.byte_vector);
+    if (entry == nullptr) {
+      CacheBuildNVRTC.Set(key.byte_vector, Compile(codegen.source, codegen.func_name, arch));
+      entry = CacheBuildNVRTC.Get(key.byte_vector);
+    }
+    CU_CALL(cuModuleLoadData(&env->module_, entry->GetPTX().c_str()));
+    CU_CALL(cuModuleGetFunction(&env->function_, env->module_, entry->GetFuncName().c_str()));
+    return env.release();
+  }
+
+ private:
+  /*! \brief The name of the OpEnv. */
+  std::string env_name_;
+  /*! \brief The loaded module of the PTX. */
+  CUmodule module_ = nullptr;
+  /*! \brief The kernel. */
+  CUfunction function_ = nullptr;
+  /*! \brief The number of elements, or rows of a reduction. */
+  int64_t num_elements_ = 0;
+  /*! \brief Whether the kernel is a reduction, which is launched with a block per row. */
+  bool reduce_ = false;
+};
+
+RAF_OP_ENV_MAKER("raf.op.nvrtc._fused_op", NVRTCOpEnv::make);
+
+RAF_REGISTER_GLOBAL("raf.op.nvrtc.IsFusible").set_body_typed([](Function func) {
+  return NVRTCCodegen(Downcast<Function>(pass::InferType(func)), false).Generate();
+});
+
+}  // namespace nvrtc
+}  // namespace op
+}  // namespace raf
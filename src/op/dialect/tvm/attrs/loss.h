@@ -0,0 +1,32 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file loss.h
+ * \brief Extra TVM attributes for loss operators
+ */
+#pragma once
+#include <tvm/ir/attrs.h>
+#include "raf/ir.h"
+
+namespace raf {
+namespace op {
+namespace tvm_dialect {
+
+using namespace raf::ir;
+
+struct SoftmaxCrossEntropyAttrs : public tvm::AttrsNode<SoftmaxCrossEntropyAttrs> {
+  int64_t ignore_index;
+  double label_smoothing;
+  // declare attribute fields in header file
+  TVM_DECLARE_ATTRS(SoftmaxCrossEntropyAttrs, "attrs.SoftmaxCrossEntropyAttrs") {
+    TVM_ATTR_FIELD(ignore_index);
+    TVM_ATTR_FIELD(label_smoothing);
+  }
+};
+
+}  // namespace tvm_dialect
+}  // namespace op
+}  // namespace raf
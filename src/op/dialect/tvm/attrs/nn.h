@@ -193,6 +193,20 @@ struct BatchNormAttrs : public tvm::AttrsNode<BatchNormAttrs> {
   }
 };
 
+/*! \brief Attributes used in the fused batch_norm_relu operators */
+struct BatchNormReluAttrs : public tvm::AttrsNode<BatchNormReluAttrs> {
+  double momentum;
+  double eps;
+  std::string layout;
+  bool with_z;
+  TVM_DECLARE_ATTRS(BatchNormReluAttrs, "raf.attrs.BatchNormReluAttrs") {
+    TVM_ATTR_FIELD(momentum);
+    TVM_ATTR_FIELD(eps);
+    TVM_ATTR_FIELD(layout).set_default("NCHW");
+    TVM_ATTR_FIELD(with_z).set_default(false).describe("whether the residual input is added");
+  }
+};
+
 /*! \brief Attributes used in pad operator */
 struct PadAttrs : public tvm::AttrsNode<PadAttrs> {
   double pad_value;
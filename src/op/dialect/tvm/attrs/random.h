@@ -0,0 +1,42 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file random.h
+ * \brief Extra TVM attributes for random operators
+ */
+#pragma once
+#include <tvm/ir/attrs.h>
+#include "raf/ir.h"
+
+namespace raf {
+namespace op {
+namespace tvm_dialect {
+
+using namespace raf::ir;
+
+struct ThreefryUniformAttrs : public tvm::AttrsNode<ThreefryUniformAttrs> {
+  double low;
+  double high;
+  // declare attribute fields in header file
+  TVM_DECLARE_ATTRS(ThreefryUniformAttrs, "attrs.ThreefryUniformAttrs") {
+    TVM_ATTR_FIELD(low);
+    TVM_ATTR_FIELD(high);
+  }
+};
+
+struct ThreefryNormalAttrs : public tvm::AttrsNode<ThreefryNormalAttrs> {
+  double mean;
+  double stddev;
+  // declare attribute fields in header file
+  TVM_DECLARE_ATTRS(ThreefryNormalAttrs, "attrs.ThreefryNormalAttrs") {
+    TVM_ATTR_FIELD(mean);
+    TVM_ATTR_FIELD(stddev);
+  }
+};
+
+}  // namespace tvm_dialect
+}  // namespace op
+}  // namespace raf
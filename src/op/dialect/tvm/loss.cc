@@ -19,6 +19,8 @@ namespace tvm_dialect {
 using namespace raf::ir;
 using schema::LossArgs;
 using schema::LossDtpArgs;
+using schema::SoftmaxCrossEntropyArgs;
+using schema::SoftmaxCrossEntropyDpredArgs;
 
 std::vector<Value> LossSchema2Args(const LossArgs* args) {
   return {args->y_true, args->y_pred};
@@ -63,6 +65,48 @@ RAF_TVM(cross_entropy_dpred, CrossEntropyDpred, LossDtpArgs, LossDtpSchema2Args,
 RAF_TVM(cross_entropy_dtrue, CrossEntropyDtrue, LossDtpArgs, LossDtpSchema2Args,
         LossDtpSchemaArgNames, GenericAttrs, GenericHasher, kElemWise);
 
+std::vector<Value> SoftmaxCrossEntropySchema2Args(const SoftmaxCrossEntropyArgs* args) {
+  return {args->y_true, args->y_pred};
+}
+
+std::vector<std::string> SoftmaxCrossEntropySchemaArgNames(const op::CallValues& call) {
+  return {"y_true", "y_pred"};
+}
+
+template <typename T>
+Attrs SoftmaxCrossEntropySchema2Attrs(const T* args) {
+  auto attrs = make_object<SoftmaxCrossEntropyAttrs>();
+  attrs->ignore_index = args->ignore_index;
+  attrs->label_smoothing = args->label_smoothing;
+  return Attrs(attrs);
+}
+
+template <typename T>
+HashKey SoftmaxCrossEntropyHasher(const std::vector<Type>& param_types, const Type& y_type,
+                                  const T* args) {
+  HashKey key = GenericHasher<std::nullptr_t>(param_types, y_type, nullptr);
+  key << args->ignore_index;
+  key << args->label_smoothing;
+  return key;
+}
+
+std::vector<Value> SoftmaxCrossEntropyDpredSchema2Args(const SoftmaxCrossEntropyDpredArgs* args) {
+  return {args->dy, args->y_true, args->y_pred};
+}
+
+std::vector<std::string> SoftmaxCrossEntropyDpredSchemaArgNames(const op::CallValues& call) {
+  return {"dy", "y_true", "y_pred"};
+}
+
+RAF_TVM(softmax_cross_entropy, SoftmaxCrossEntropy, SoftmaxCrossEntropyArgs,
+        SoftmaxCrossEntropySchema2Args, SoftmaxCrossEntropySchemaArgNames,
+        SoftmaxCrossEntropySchema2Attrs<SoftmaxCrossEntropyArgs>,
+        SoftmaxCrossEntropyHasher<SoftmaxCrossEntropyArgs>, kCommReduce);
+RAF_TVM(softmax_cross_entropy_dpred, SoftmaxCrossEntropyDpred, SoftmaxCrossEntropyDpredArgs,
+        SoftmaxCrossEntropyDpredSchema2Args, SoftmaxCrossEntropyDpredSchemaArgNames,
+        SoftmaxCrossEntropySchema2Attrs<SoftmaxCrossEntropyDpredArgs>,
+        SoftmaxCrossEntropyHasher<SoftmaxCrossEntropyDpredArgs>, kElemWise);
+
 }  // namespace tvm_dialect
 }  // namespace op
 }  // namespace raf
@@ -47,6 +47,18 @@ RAF_TVM(matmul_tt, MatmulTT, BinaryArgs, BinarySchema2Args, BinarySchemaArgNames
         BinarySchema2DenseAttrs, GenericHasher, kOutEWiseFusable);
 RAF_TVM(dense, Dense, BinaryArgs, BinarySchema2Args, BinarySchemaArgNames, BinarySchema2DenseAttrs,
         GenericHasher, kOutEWiseFusable);
+// The fallback of the 2:4 sparse dense, which computes it as a dense one.
+RAF_TVM(sparse24_dense, Sparse24Dense, BinaryArgs, BinarySchema2Args, BinarySchemaArgNames,
+        BinarySchema2DenseAttrs, GenericHasher, kOutEWiseFusable);
+
+Attrs BinarySchema2QuantizedDenseAttrs(const BinaryArgs* args) {
+  auto attrs = make_object<tvm::relay::DenseAttrs>();
+  attrs->out_dtype = DataType::Int(32);
+  return Attrs(attrs);
+}
+
+RAF_TVM(quantized_dense, QuantizedDense, BinaryArgs, BinarySchema2Args, BinarySchemaArgNames,
+        BinarySchema2QuantizedDenseAttrs, GenericHasher, kOutEWiseFusable);
 RAF_TVM(batch_matmul, BatchMatmul, BinaryArgs, BinarySchema2Args, BinarySchemaArgNames,
         (BinarySchema2BatchMatmulAttrs<false, false>), GenericHasher, kOutEWiseFusable);
 RAF_TVM(batch_matmul_nt, BatchMatmulNT, BinaryArgs, BinarySchema2Args, BinarySchemaArgNames,
@@ -56,6 +68,34 @@ RAF_TVM(batch_matmul_tn, BatchMatmulTN, BinaryArgs, BinarySchema2Args, BinarySch
 RAF_TVM(batch_matmul_tt, BatchMatmulTT, BinaryArgs, BinarySchema2Args, BinarySchemaArgNames,
         (BinarySchema2BatchMatmulAttrs<true, true>), GenericHasher, kOutEWiseFusable);
 
+std::vector<Value> GroupedMatmulSchema2Args(const GroupedMatmulArgs* args) {
+  std::vector<Value> ret(args->a.begin(), args->a.end());
+  ret.insert(ret.end(), args->b.begin(), args->b.end());
+  return ret;
+}
+
+std::vector<std::string> GroupedMatmulSchemaArgNames(const op::CallValues& call) {
+  return {"a", "b"};
+}
+
+Attrs GroupedMatmulSchema2Attrs(const GroupedMatmulArgs* args) {
+  auto attrs = make_object<tvm::relay::BatchMatmulAttrs>();
+  attrs->out_dtype = NullValue<DataType>();
+  attrs->transpose_a = false;
+  attrs->transpose_b = args->transpose_b;
+  return Attrs(attrs);
+}
+
+HashKey GroupedMatmulHasher(const std::vector<Type>& param_types, const Type& y_type,
+                            const GroupedMatmulArgs* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->transpose_b;
+  return key;
+}
+
+RAF_TVM(grouped_matmul, GroupedMatmul, GroupedMatmulArgs, GroupedMatmulSchema2Args,
+        GroupedMatmulSchemaArgNames, GroupedMatmulSchema2Attrs, GroupedMatmulHasher, kOpaque);
+
 std::vector<Value> ConvSchema2Args(const ConvArgs* args) {
   return {args->x, args->w};
 }
@@ -101,6 +141,15 @@ HashKey Conv2dHasher(const std::vector<Type>& param_types, const Type& y_type,
 RAF_TVM(conv2d, Conv2d, ConvArgs, ConvSchema2Args, ConvSchemaArgNames, ConvSchema2Attrs,
         Conv2dHasher, kOutEWiseFusable);
 
+Attrs QuantizedConvSchema2Attrs(const ConvArgs* args) {
+  auto attrs = make_object<Conv2DAttrs>(*ConvSchema2Attrs(args).as<Conv2DAttrs>());
+  attrs->out_dtype = DataType::Int(32);
+  return Attrs(attrs);
+}
+
+RAF_TVM(quantized_conv2d, QuantizedConv2d, ConvArgs, ConvSchema2Args, ConvSchemaArgNames,
+        QuantizedConvSchema2Attrs, Conv2dHasher, kOutEWiseFusable);
+
 std::vector<Value> ConvTransSchema2Args(const ConvTransArgs* args) {
   return {args->x, args->w};
 }
@@ -850,6 +899,74 @@ RAF_TVM(batch_norm_train_dxwb, BatchNormTrainDxwb, BatchNormTrainDxwbArgs,
         BatchNormTrainDxwbSchema2Args, BatchNormTrainDxwbSchemaArgNames,
         BatchNormTrainDxwbSchema2Attrs, BatchNormTrainDxwbHasher, kOpaque);
 
+std::vector<Value> BatchNormReluSchema2Args(const BatchNormReluArgs* args) {
+  std::vector<Value> ret{args->x, args->running_mean, args->running_var, args->w, args->b};
+  if (args->z.defined()) {
+    ret.push_back(args->z.value());
+  }
+  return ret;
+}
+
+std::vector<std::string> BatchNormReluSchemaArgNames(const op::CallValues& call) {
+  const auto* args = call->args.as<BatchNormReluArgs>();
+  std::vector<std::string> ret{"x", "running_mean", "running_var", "w", "b"};
+  if (args->z.defined()) {
+    ret.push_back("z");
+  }
+  return ret;
+}
+
+Attrs BatchNormReluSchema2Attrs(const BatchNormReluArgs* args) {
+  auto attrs = make_object<BatchNormReluAttrs>();
+  attrs->momentum = args->momentum;
+  attrs->eps = args->eps;
+  attrs->layout = args->layout;
+  attrs->with_z = args->z.defined();
+  return Attrs(attrs);
+}
+
+HashKey BatchNormReluHasher(const std::vector<Type>& param_types, const Type& ret_type,
+                            const BatchNormReluArgs* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, ret_type, nullptr);
+  key << args->momentum;
+  key << args->eps;
+  key << args->layout;
+  return key;
+}
+
+RAF_TVM(batch_norm_relu_train, BatchNormReluTrain, BatchNormReluArgs, BatchNormReluSchema2Args,
+        BatchNormReluSchemaArgNames, BatchNormReluSchema2Attrs, BatchNormReluHasher, kOpaque);
+
+std::vector<Value> BatchNormReluDxwbSchema2Args(const BatchNormReluDxwbArgs* args) {
+  return {args->dy, args->x, args->w, args->b, args->y};
+}
+
+std::vector<std::string> BatchNormReluDxwbSchemaArgNames(const op::CallValues& call) {
+  return {"dy", "x", "w", "b", "y"};
+}
+
+Attrs BatchNormReluDxwbSchema2Attrs(const BatchNormReluDxwbArgs* args) {
+  auto attrs = make_object<BatchNormReluAttrs>();
+  attrs->momentum = 0;  // momentum is not used in the gradient
+  attrs->eps = args->eps;
+  attrs->layout = args->layout;
+  attrs->with_z = args->with_z;
+  return Attrs(attrs);
+}
+
+HashKey BatchNormReluDxwbHasher(const std::vector<Type>& param_types, const Type& ret_type,
+                                const BatchNormReluDxwbArgs* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, ret_type, nullptr);
+  key << args->eps;
+  key << args->layout;
+  key << args->with_z;
+  return key;
+}
+
+RAF_TVM(batch_norm_relu_train_dxwb, BatchNormReluTrainDxwb, BatchNormReluDxwbArgs,
+        BatchNormReluDxwbSchema2Args, BatchNormReluDxwbSchemaArgNames,
+        BatchNormReluDxwbSchema2Attrs, BatchNormReluDxwbHasher, kOpaque);
+
 std::vector<Value> ThresholdSchema2Args(const ThresholdArgs* args) {
   return {args->x};
 }
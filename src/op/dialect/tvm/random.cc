@@ -63,6 +63,53 @@ std::vector<std::string> ThreefrySplitSchemaArgNames(const op::CallValues& call)
 RAF_TVM(threefry_split, ThreefrySplit, ThreefrySplitArgs, ThreefrySplitSchema2Args,
         ThreefrySplitSchemaArgNames, GenericAttrs, GenericHasher, kOpaque);
 
+template <typename T>
+std::vector<Value> ThreefryDistributionSchema2Args(const T* args) {
+  return {args->key};
+}
+
+std::vector<std::string> ThreefryDistributionSchemaArgNames(const op::CallValues& call) {
+  return {"key"};
+}
+
+Attrs ThreefryUniformSchema2Attrs(const ThreefryUniformArgs* args) {
+  auto attrs = make_object<ThreefryUniformAttrs>();
+  attrs->low = args->low;
+  attrs->high = args->high;
+  return Attrs(attrs);
+}
+
+HashKey ThreefryUniformHasher(const std::vector<Type>& param_types, const Type& y_type,
+                              const ThreefryUniformArgs* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->low << args->high;
+  return key;
+}
+
+Attrs ThreefryNormalSchema2Attrs(const ThreefryNormalArgs* args) {
+  auto attrs = make_object<ThreefryNormalAttrs>();
+  attrs->mean = args->mean;
+  attrs->stddev = args->stddev;
+  return Attrs(attrs);
+}
+
+HashKey ThreefryNormalHasher(const std::vector<Type>& param_types, const Type& y_type,
+                             const ThreefryNormalArgs* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->mean << args->stddev;
+  return key;
+}
+
+// Unlike threefry_generate, each output element is computed from the key and its own position, so
+// the distributions are injective and fused into their consumers by FuseTVM.
+RAF_TVM(threefry_uniform, ThreefryUniform, ThreefryUniformArgs,
+        ThreefryDistributionSchema2Args<ThreefryUniformArgs>, ThreefryDistributionSchemaArgNames,
+        ThreefryUniformSchema2Attrs, ThreefryUniformHasher, kInjective);
+
+RAF_TVM(threefry_normal, ThreefryNormal, ThreefryNormalArgs,
+        ThreefryDistributionSchema2Args<ThreefryNormalArgs>, ThreefryDistributionSchemaArgNames,
+        ThreefryNormalSchema2Attrs, ThreefryNormalHasher, kInjective);
+
 }  // namespace tvm_dialect
 }  // namespace op
 }  // namespace raf
@@ -0,0 +1,67 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file ./src/op/dialect/tvm/sparse.cc
+ * \brief Sparse matrix operators bridged from TVM.
+ */
+#include <vector>
+#include "raf/op_utils.h"
+#include "./tvm_utils.h"
+#include "./tvm_attrs.h"
+#include "../../schema/sparse.h"
+
+namespace raf {
+namespace op {
+namespace tvm_dialect {
+
+using namespace raf::ir;
+using namespace raf::value;
+using namespace schema;
+
+std::vector<Value> CsrSpmmSchema2Args(const CsrSpmmArgs* args) {
+  return {args->indptr, args->indices, args->values, args->dense};
+}
+
+std::vector<std::string> CsrSpmmSchemaArgNames(const op::CallValues& call) {
+  return {"indptr", "indices", "values", "dense"};
+}
+
+RAF_TVM(csr_spmm, CsrSpmm, CsrSpmmArgs, CsrSpmmSchema2Args, CsrSpmmSchemaArgNames, GenericAttrs,
+        GenericHasher, kOpaque);
+
+std::vector<Value> CsrSpmmTnSchema2Args(const CsrSpmmTnArgs* args) {
+  return {args->indptr, args->indices, args->values, args->dense};
+}
+
+std::vector<std::string> CsrSpmmTnSchemaArgNames(const op::CallValues& call) {
+  return {"indptr", "indices", "values", "dense"};
+}
+
+Attrs CsrSpmmTnSchema2Attrs(const CsrSpmmTnArgs* args) {
+  auto attrs = make_object<DimAttrs>();
+  for (auto v : GetShapeVecFromValue(args->shape)) {
+    attrs->dims.push_back(Integer(v));
+  }
+  return Attrs(attrs);
+}
+
+RAF_TVM(csr_spmm_tn, CsrSpmmTn, CsrSpmmTnArgs, CsrSpmmTnSchema2Args, CsrSpmmTnSchemaArgNames,
+        CsrSpmmTnSchema2Attrs, GenericHasher, kOpaque);
+
+std::vector<Value> CsrSddmmSchema2Args(const CsrSddmmArgs* args) {
+  return {args->indptr, args->indices, args->x1, args->x2};
+}
+
+std::vector<std::string> CsrSddmmSchemaArgNames(const op::CallValues& call) {
+  return {"indptr", "indices", "x1", "x2"};
+}
+
+RAF_TVM(csr_sddmm, CsrSddmm, CsrSddmmArgs, CsrSddmmSchema2Args, CsrSddmmSchemaArgNames,
+        GenericAttrs, GenericHasher, kOpaque);
+
+}  // namespace tvm_dialect
+}  // namespace op
+}  // namespace raf
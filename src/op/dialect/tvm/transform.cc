@@ -204,6 +204,18 @@ RAF_TVM(take, Take, TakeArgs, TakeSchema2Args<TakeArgs>, TakeSchemaArgNames, Tak
 RAF_TVM(embedding, Embedding, EmbeddingArgs, TakeSchema2Args<EmbeddingArgs>, TakeSchemaArgNames,
         GenericAttrs, GenericHasher, kInjective);
 
+std::vector<Value> EmbeddingPositionSchema2Args(const EmbeddingPositionArgs* args) {
+  return {args->x, args->indices, args->position, args->position_ids};
+}
+
+std::vector<std::string> EmbeddingPositionSchemaArgNames(const op::CallValues& call) {
+  return {"x", "indices", "position", "position_ids"};
+}
+
+RAF_TVM(embedding_position, EmbeddingPosition, EmbeddingPositionArgs,
+        EmbeddingPositionSchema2Args, EmbeddingPositionSchemaArgNames, GenericAttrs, GenericHasher,
+        kInjective);
+
 std::vector<Value> TakeDxSchema2Args(const TakeDxArgs* args) {
   return {args->x, args->dy, args->indices};
 }
@@ -496,6 +508,30 @@ HashKey ScatterDxHasher(const std::vector<Type>& param_types, const Type& y_type
 RAF_TVM(scatter_dx, ScatterDx, ScatterDxArgs, ScatterDxSchema2Args, ScatterDxSchemaArgNames,
         ScatterDxSchema2Attrs, ScatterDxHasher, kInjective);
 
+std::vector<Value> KvCacheAppendSchema2Args(const KvCacheAppendArgs* args) {
+  return {args->cache, args->data, args->slots};
+}
+
+std::vector<std::string> KvCacheAppendSchemaArgNames(const op::CallValues& call) {
+  return {"cache", "data", "slots"};
+}
+
+// The kernel only writes the slots of the new tokens, relying on the output sharing the buffer of
+// the cache, so the cost of an append does not grow with the cached tokens.
+RAF_TVM(kv_cache_append, KvCacheAppend, KvCacheAppendArgs, KvCacheAppendSchema2Args,
+        KvCacheAppendSchemaArgNames, GenericAttrs, GenericHasher, kOpaque);
+
+std::vector<Value> KvCacheGatherSchema2Args(const KvCacheGatherArgs* args) {
+  return {args->cache, args->block_table};
+}
+
+std::vector<std::string> KvCacheGatherSchemaArgNames(const op::CallValues& call) {
+  return {"cache", "block_table"};
+}
+
+RAF_TVM(kv_cache_gather, KvCacheGather, KvCacheGatherArgs, KvCacheGatherSchema2Args,
+        KvCacheGatherSchemaArgNames, GenericAttrs, GenericHasher, kInjective);
+
 std::vector<Value> ConcatenateSchema2Args(const ConcatenateArgs* args) {
   std::vector<Value> ret;
   for (auto v : args->x) {
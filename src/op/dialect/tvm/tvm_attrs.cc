@@ -31,13 +31,21 @@ RAF_REGISTER_OBJECT_REFLECT(Conv2dDxwAttrs);
 RAF_REGISTER_OBJECT_REFLECT(Conv2dTransposeDxwAttrs);
 RAF_REGISTER_OBJECT_REFLECT(LayerNormAttrs);
 RAF_REGISTER_OBJECT_REFLECT(BatchNormAttrs);
+RAF_REGISTER_OBJECT_REFLECT(BatchNormReluAttrs);
 RAF_REGISTER_OBJECT_REFLECT(PadAttrs);
 RAF_REGISTER_OBJECT_REFLECT(ThresholdAttrs);
 RAF_REGISTER_OBJECT_REFLECT(ThresholdDxAttrs);
 
+// loss attrs
+RAF_REGISTER_OBJECT_REFLECT(SoftmaxCrossEntropyAttrs);
+
 // optimizer attrs
 RAF_REGISTER_OBJECT_REFLECT(SgdAttrs);
 
+// random attrs
+RAF_REGISTER_OBJECT_REFLECT(ThreefryUniformAttrs);
+RAF_REGISTER_OBJECT_REFLECT(ThreefryNormalAttrs);
+
 }  // namespace tvm_dialect
 }  // namespace op
 }  // namespace raf
@@ -20,8 +20,10 @@
 #include "raf/ir.h"
 #include "raf/value.h"
 #include "raf/op.h"
+#include "./attrs/loss.h"
 #include "./attrs/nn.h"
 #include "./attrs/optimizer.h"
+#include "./attrs/random.h"
 #include "./attrs/reduce.h"
 #include "./attrs/transform.h"
 #include "./attrs/unary.h"
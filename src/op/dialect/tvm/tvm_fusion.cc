@@ -278,17 +278,30 @@ OpEnv* FusedFuncBuild(const op::CallValues& call) {
       << "NotImplementedError: target is not supported " << dev.device_type().c_str();
   RAF2TVM raf_to_tvm(call, dev.device_type());
   Function func = Downcast<Function>(raf_to_tvm());
+  // Query the tuned schedules of the fused function, which falls back to the default schedule
+  // when the function is not tuned.
+  ForceEnableAutoScheduler();
   env->env_name = TruncateName(GetUniqueName(raf_to_tvm.func_name));
 
-  auto key = HashFusedFunc(Downcast<ClosureValue>(call->callee)->func);
+  HashKey key;
+  Function relaxed = RelaxShapes(func, &key);
+  if (relaxed.defined()) {
+    func = relaxed;
+  } else {
+    key = HashFusedFunc(Downcast<ClosureValue>(call->callee)->func);
+  }
+  HashFastMath(&key);
   TVMModuleCacheEntry entry;
-  if (const auto* compiled = cache->Get(key.byte_vector)) {
+  if (auto compiled = cache->Get(key.byte_vector)) {
     entry = *compiled;
   } else {
     te_compiler->Clear();
     try {
+      RAF_NVTX_RANGE(kJIT, env->env_name);
+      metrics::ScopedLatency jit_timer(JitCompileLatency());
       auto cached_key = tvm::relay::tec::CCacheKey(func, target);
-      auto cached_func = te_compiler->Lower(cached_key, [](String name) { return name; });
+      auto cached_func = te_compiler->Lower(
+          cached_key, [&](String name) { return String(MangleKernelName(name, func, target)); });
       auto mod = tvm::build(cached_func->funcs, cached_key->target, Target(nullptr));
       entry = TVMModuleCacheEntry(mod, cached_func->prim_fn_var->name_hint);
       cache->Set(key.byte_vector, entry);
@@ -7,6 +7,7 @@
  * \file ./src/op/dialect/tvm/tvm_utils.cc
  * \brief Implementation of utility methods for TVM dialect.
  */
+#include <unordered_set>
 #include "raf/value.h"
 #include "raf/registry.h"
 #include "./tvm_utils.h"
@@ -69,6 +70,162 @@ Function LowerOp(const Op& op, const Attrs& attrs, const std::vector<Type>& para
   return func;
 }
 
+/*! \brief Relax the non-unit dims of a tensor or tuple type to Any. */
+Type RelaxType(const Type& type) {
+  if (const auto* tuple = type.as<TupleTypeNode>()) {
+    Array<Type> fields;
+    for (const auto& field : tuple->fields) {
+      fields.push_back(RelaxType(field));
+    }
+    return TupleType(fields);
+  }
+  const auto* ttype = type.as<TensorTypeNode>();
+  if (ttype == nullptr) {
+    return type;
+  }
+  Array<PrimExpr> shape;
+  for (const auto& dim : ttype->shape) {
+    const auto* imm = dim.as<IntImmNode>();
+    shape.push_back(imm != nullptr && imm->value == 1 ? dim : tvm::tir::Any());
+  }
+  return TensorType(shape, ttype->dtype);
+}
+
+/*! \brief Collect the concrete dims of a type, or return false if it has a dynamic dim. */
+bool CollectDims(const Type& type, std::vector<int64_t>* dims) {
+  if (const auto* tuple = type.as<TupleTypeNode>()) {
+    for (const auto& field : tuple->fields) {
+      if (!CollectDims(field, dims)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  const auto* ttype = type.as<TensorTypeNode>();
+  if (ttype == nullptr) {
+    return false;
+  }
+  for (const auto& dim : ttype->shape) {
+    const auto* imm = dim.as<IntImmNode>();
+    if (imm == nullptr) {
+      return false;
+    }
+    dims->push_back(imm->value);
+  }
+  return true;
+}
+
+/*!
+ * \brief Check whether the shapes of a function can be relaxed, i.e., its ops are elementwise,
+ * broadcast or reductions, and the dims of its calls all come from the dims of its params.
+ */
+class ShapeRelaxChecker : public ExprVisitor {
+ public:
+  bool operator()(const Function& func) {
+    std::vector<int64_t> dims;
+    for (const auto& param : func->params) {
+      if (!CollectDims(param->checked_type(), &dims)) {
+        return false;
+      }
+    }
+    param_dims_.insert(dims.begin(), dims.end());
+    VisitExpr(func->body);
+    return relaxable_;
+  }
+
+  void VisitExpr_(const CallNode* call) final {
+    static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+    const auto* op = call->op.as<OpNode>();
+    if (op == nullptr || !fpattern.count(GetRef<Op>(op))) {
+      relaxable_ = false;
+      return;
+    }
+    TOpPattern pattern = fpattern[GetRef<Op>(op)];
+    if (pattern != tvm::relay::kElemWise && pattern != tvm::relay::kBroadcast &&
+        pattern != tvm::relay::kCommReduce) {
+      relaxable_ = false;
+      return;
+    }
+    std::vector<int64_t> dims;
+    if (!CollectDims(call->checked_type(), &dims)) {
+      relaxable_ = false;
+      return;
+    }
+    for (int64_t dim : dims) {
+      if (dim != 1 && !param_dims_.count(dim)) {
+        relaxable_ = false;
+        return;
+      }
+    }
+    ExprVisitor::VisitExpr_(call);
+  }
+
+ private:
+  /*! \brief The dims of the params. */
+  std::unordered_set<int64_t> param_dims_;
+  /*! \brief Whether the function can be relaxed. */
+  bool relaxable_ = true;
+};
+
+/*! \brief Copy a function with all types relaxed. */
+class ShapeRelaxer : public ExprMutator {
+ public:
+  Expr VisitExpr(const Expr& expr) final {
+    auto ret = ExprMutator::VisitExpr(expr);
+    if (expr->checked_type_.defined() && !ret.same_as(expr)) {
+      ret->checked_type_ = RelaxType(expr->checked_type());
+    }
+    return ret;
+  }
+
+  Expr VisitExpr_(const VarNode* var) final {
+    auto type = RelaxType(var->checked_type());
+    auto ret = MakeVar(var->name_hint(), type);
+    ret->checked_type_ = type;
+    return ret;
+  }
+
+};
+
+ir::Function RelaxShapes(const ir::Function& func, HashKey* key) {
+  String mode = tvm::relay::transform::PassContext::Current()
+                    ->GetConfig<String>("raf.tvm.symbolic_shape", String("none"))
+                    .value();
+  CHECK(mode == "none" || mode == "pow2" || mode == "any")
+      << "Unsupported raf.tvm.symbolic_shape: " << mode
+      << ". Expected one of \"none\", \"pow2\", and \"any\"";
+  if (mode == "none" || !ShapeRelaxChecker()(func)) {
+    return ir::Function();
+  }
+  auto relaxed = Downcast<Function>(ShapeRelaxer().Mutate(func));
+  relaxed = Function(relaxed->params, relaxed->body, relaxed->body->checked_type(),
+                     relaxed->type_params, relaxed->attrs);
+  Array<Type> param_types;
+  for (const auto& param : relaxed->params) {
+    param_types.push_back(param->checked_type());
+  }
+  relaxed->checked_type_ = FuncType(param_types, relaxed->body->checked_type(), {}, {});
+  // The relaxed function includes the attrs of the ops, which may depend on the shapes.
+  *key << "symbolic" << raf::ir::AsText(relaxed, true);
+  if (mode == "pow2") {
+    // One kernel per power-of-two range of each relaxed dim, e.g., (64, 128].
+    std::vector<int64_t> buckets;
+    for (const auto& param : func->params) {
+      std::vector<int64_t> dims;
+      CollectDims(param->checked_type(), &dims);
+      for (int64_t dim : dims) {
+        int64_t bucket = 0;
+        while ((int64_t(1) << bucket) < dim) {
+          ++bucket;
+        }
+        buckets.push_back(bucket);
+      }
+    }
+    *key << buckets;
+  }
+  return relaxed;
+}
+
 void SetArgs(std::vector<DLTensor>* i, std::vector<DLTensor>* o, std::vector<TVMValue>* values,
              std::vector<int>* codes) {
   int arity = i->size() + o->size();
@@ -129,29 +286,83 @@ void TVMOpEnv::Execute(const std::vector<Value>& inputs, Value output) {
 }
 
 PackedMetricMap DumpTVMCacheMetric(const std::string& cache_name) {
-  static std::unordered_map<std::string, MetaCacheMetric*> name_to_cache = {
-      {"tvm_cpu", &CacheBuildCpu},
-      {"tvm_cuda", &CacheBuildCuda},
-      {"tvm_lower", &CacheLoweredFunc},
-  };
-
-  PackedMetricMap ret;
-  if (name_to_cache.count(cache_name) == 0) {
-    LOG(WARNING) << "Cannot find cache " << cache_name << " for dumping metric";
-    return ret;
+  return DumpMetric(cache_name);
+}
+
+RAF_REGISTER_GLOBAL("raf.cache.DumpTVMCacheMetric").set_body_typed(DumpTVMCacheMetric);
+
+MetaPersistCache<TVMModuleCacheEntry>* GetBuildCache(const std::string& cache_name) {
+  if (cache_name == "tvm_cpu") {
+    return &CacheBuildCpu;
+  } else if (cache_name == "tvm_cuda") {
+    return &CacheBuildCuda;
   }
+  LOG(FATAL) << "Unknown kernel cache " << cache_name << ", expected tvm_cpu or tvm_cuda";
+  throw;
+}
 
-  auto metrics = name_to_cache[cache_name]->GetMetric();
-  for (const auto& it : metrics) {
-    ret.Set(it.first, it.second);
+/*! \brief Encode the binary cache key in hex so that it can be stored in a manifest. */
+std::string KeyToHex(const std::string& key) {
+  static const char* digits = "0123456789abcdef";
+  std::string ret;
+  ret.reserve(key.size() * 2);
+  for (unsigned char c : key) {
+    ret.push_back(digits[c >> 4]);
+    ret.push_back(digits[c & 15]);
   }
   return ret;
 }
 
-RAF_REGISTER_GLOBAL("raf.cache.DumpTVMCacheMetric").set_body_typed(DumpTVMCacheMetric);
+std::string HexToKey(const std::string& hex) {
+  CHECK_EQ(hex.size() % 2, 0) << "Invalid cache key " << hex;
+  std::string ret;
+  ret.reserve(hex.size() / 2);
+  for (size_t i = 0; i < hex.size(); i += 2) {
+    ret.push_back(static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+  }
+  return ret;
+}
+
+/*!
+ * \brief Get the keys and the kernel names of the kernels built (or loaded) in this process.
+ * \param cache_name The kernel cache, "tvm_cpu" or "tvm_cuda".
+ * \return A list of (hex key, kernel name) pairs.
+ */
+Array<Array<String>> GetTVMCacheEntries(const std::string& cache_name) {
+  Array<Array<String>> ret;
+  for (const auto& kv : GetBuildCache(cache_name)->GetEntries()) {
+    ret.push_back(Array<String>{KeyToHex(kv.first), kv.second.GetFuncName()});
+  }
+  return ret;
+}
+
+tvm::runtime::Module GetTVMCacheModule(const std::string& cache_name, const std::string& key) {
+  auto entry = GetBuildCache(cache_name)->MetaCache<TVMModuleCacheEntry>::Get(HexToKey(key));
+  CHECK(entry != nullptr) << "Cannot find " << key << " in kernel cache " << cache_name;
+  return entry->GetModule();
+}
+
+/*!
+ * \brief Register a prebuilt kernel to the in-memory kernel cache, so the op with the key is
+ * dispatched to the kernel without JIT. The entry is not written to the persistent cache.
+ */
+void SetTVMCacheEntry(const std::string& cache_name, const std::string& key,
+                      tvm::runtime::Module mod, const std::string& func_name) {
+  auto* cache = GetBuildCache(cache_name);
+  auto key_bytes = HexToKey(key);
+  if (!cache->Has(key_bytes)) {
+    cache->MetaCache<TVMModuleCacheEntry>::Set(key_bytes, TVMModuleCacheEntry(mod, func_name));
+  }
+}
+
+RAF_REGISTER_GLOBAL("raf.cache.GetTVMCacheEntries").set_body_typed(GetTVMCacheEntries);
+RAF_REGISTER_GLOBAL("raf.cache.GetTVMCacheModule").set_body_typed(GetTVMCacheModule);
+RAF_REGISTER_GLOBAL("raf.cache.SetTVMCacheEntry").set_body_typed(SetTVMCacheEntry);
 
 RAF_REGISTER_DIALECT("tvm").set_enable(DevType::kCPU()).set_enable(DevType::kCUDA());
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.tvm.allow_jit_failure", tvm::Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.tvm.symbolic_shape", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.tvm.fast_math", Array<String>);
 
 }  // namespace tvm_dialect
 }  // namespace op
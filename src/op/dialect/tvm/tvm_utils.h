@@ -10,8 +10,10 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <sstream>
 #include <dmlc/filesystem.h>
 #include <tvm/node/serialization.h>
+#include <tvm/node/structural_hash.h>
 #include "dlpack/dlpack.h"
 #include "tvm/relay/transform.h"
 #include "tvm/ir/expr.h"
@@ -20,11 +22,13 @@
 #include "relay/backend/te_compiler_cache.h"
 #include "raf/cache.h"
 #include "raf/ir.h"
+#include "raf/metrics.h"
 #include "raf/value.h"
 #include "raf/registry.h"
 #include "raf/op.h"
 #include "raf/op_utils.h"
 #include "raf/serialization.h"
+#include "../../../profiler/nvtx/nvtx.h"
 
 namespace raf {
 namespace op {
@@ -39,6 +43,16 @@ ir::Function LowerOp(const ir::Op& op, const ir::Attrs& attrs,
                      const std::vector<ir::Type>& param_types, const ir::Type& ret_type);
 float CalcFuncGFLOPS(const op::CallValues& call, const Array<Type>& param_types,
                      const Type& ret_type, const Device& device);
+/*!
+ * \brief Relax the non-unit dims of a function with the concrete shapes to symbolic dims, so that
+ * its kernel is reused by the other shapes, when enabled by raf.tvm.symbolic_shape. Only the
+ * functions of elementwise, broadcast and reduction ops, whose output dims all come from the
+ * input dims, are relaxed, since the others may compute with the concrete shapes in their attrs.
+ * \param func The function of TVM ops with the checked types.
+ * \param key The cache key to append the relaxed function and the shape buckets to.
+ * \return The relaxed function, or an undefined function if it is not relaxed.
+ */
+ir::Function RelaxShapes(const ir::Function& func, HashKey* key);
 
 class TVMOpEnv : public op::OpEnv {
  public:
@@ -81,6 +95,14 @@ class TVMModuleCacheEntry {
     return mod_->GetFunction(func_name_);
   }
 
+  const tvm::runtime::Module& GetModule() const {
+    return mod_;
+  }
+
+  const std::string& GetFuncName() const {
+    return func_name_;
+  }
+
   bool Save(const std::string& path) {
     static auto f_export = registry::GetPackedFunc("raf._tvm_op.utils.export_library");
     auto bin_path = path + "/" + MOD_SO_FILE;
@@ -179,6 +201,24 @@ inline bool AllowJitFailure() {
       .value();
 }
 
+/*!
+ * \brief Append the base ops to lower with fast math approximations, i.e., the "raf.tvm.fast_math"
+ * config of the current PassContext, to a kernel cache key. Nothing is appended when fast math is
+ * off, so the keys of the precise kernels are unchanged.
+ */
+inline void HashFastMath(HashKey* key) {
+  auto ops = tvm::relay::transform::PassContext::Current()
+                 ->GetConfig<ir::Array<ir::String>>("raf.tvm.fast_math", ir::Array<ir::String>())
+                 .value();
+  if (ops.empty()) {
+    return;
+  }
+  *key << "fast_math";
+  for (const auto& op : ops) {
+    *key << std::string(op);
+  }
+}
+
 /*!
  * \brief Modify the configs of the current PassContext to enable auto-scheduler for TVM ops.
  */
@@ -187,6 +227,30 @@ inline void ForceEnableAutoScheduler() {
                                                             tvm::Bool(true));
 }
 
+/*!
+ * \brief Make the kernel name unique with the target and the structural hash of the lowered
+ * function, so the kernels of all ops and shapes can be linked into one module without symbol
+ * conflicts when exporting an AOT executable.
+ * \param name The name hint of the kernel.
+ * \param func The lowered function.
+ * \param target The target of the kernel.
+ * \return The mangled name.
+ */
+inline std::string MangleKernelName(const std::string& name, const ir::Function& func,
+                                    const tvm::Target& target) {
+  std::ostringstream os;
+  os << name << "_" << target->kind->name << "_" << std::hex << tvm::StructuralHash()(func);
+  return os.str();
+}
+
+/*! \brief The histogram of the time to lower and build a TVM op, which only counts cache misses. */
+inline metrics::Histogram* JitCompileLatency() {
+  static auto* histogram = metrics::Registry::Get()->GetHistogram(
+      "raf_jit_compile_latency_us", "The time to lower and build a TVM op in microseconds.",
+      metrics::ExponentialBuckets(1000, 2, 16));
+  return histogram;
+}
+
 using FRAFLower = registry::TypedPackedFunc<ir::Function(const CallValues& call)>;
 using FRAFAttr = registry::TypedPackedFunc<ir::Attrs(const CallValues& call)>;
 using FRAFArgIndices =
@@ -205,7 +269,8 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
   template <typename RType>                                                                        \
   inline RType FUNC##CacheCompile(TVMOpEnv* env, const op::CallValues call,                        \
                                   MetaPersistCache<RType>* cache,                                  \
-                                  std::function<RType(const ir::Function&)> f_post_lower) {        \
+                                  std::function<RType(const ir::Function&)> f_post_lower,          \
+                                  bool symbolic = false) {                                         \
     raf::op::tvm_dialect::ForceEnableAutoScheduler();                                              \
     static const auto op = Op::Get(RAF_DIALECT_OP_NAME(tvm, OP));                                  \
     const auto* schema = call->args.as<SCHEMA>();                                                  \
@@ -227,11 +292,17 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
     }                                                                                              \
     RType ret;                                                                                     \
     HashKey key;                                                                                   \
-    key << #OP << HASH(param_types, ret_type, schema);                                             \
-    if (const auto* compiled = cache->Get(key.byte_vector)) {                                      \
+    HashFastMath(&key);                                                                            \
+    auto lowered = LowerOp(op, attrs, param_types, ret_type);                                      \
+    auto relaxed = symbolic ? RelaxShapes(lowered, &key) : ir::Function();                         \
+    if (relaxed.defined()) {                                                                       \
+      lowered = relaxed;                                                                           \
+    } else {                                                                                       \
+      key << #OP << HASH(param_types, ret_type, schema);                                           \
+    }                                                                                              \
+    if (auto compiled = cache->Get(key.byte_vector)) {                                             \
       ret = *compiled;                                                                             \
     } else {                                                                                       \
-      auto lowered = LowerOp(op, attrs, param_types, ret_type);                                    \
       ret = f_post_lower(lowered);                                                                 \
       cache->Set(key.byte_vector, ret);                                                            \
     }                                                                                              \
@@ -262,14 +333,17 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
     env->env_name = TruncateName(GetUniqueName(RAF_DIALECT_OP_NAME(tvm, OP)));                     \
     std::function<TVMModuleCacheEntry(const ir::Function&)> f_post_lower(                          \
         [&](const ir::Function& f) {                                                               \
+          metrics::ScopedLatency jit_timer(JitCompileLatency());                                   \
           te_compiler->Clear();                                                                    \
           auto key = tvm::relay::tec::CCacheKey(f, target);                                        \
-          auto cached_func = te_compiler->Lower(key, [](String name) { return name; });            \
+          auto cached_func = te_compiler->Lower(                                                   \
+              key, [&](String name) { return String(MangleKernelName(name, f, target)); });        \
           auto mod = tvm::build(cached_func->funcs, key->target, Target(nullptr));                 \
           return TVMModuleCacheEntry(mod, cached_func->prim_fn_var->name_hint);                    \
         });                                                                                        \
     try {                                                                                          \
-      auto module_cache_entry = FUNC##CacheCompile(env, call, cache, f_post_lower);                \
+      RAF_NVTX_RANGE(kJIT, env->env_name);                                                         \
+      auto module_cache_entry = FUNC##CacheCompile(env, call, cache, f_post_lower, true);          \
       env->f = module_cache_entry.GetFunction();                                                   \
     } catch (const dmlc::Error& e) {                                                               \
       /* Invalid implementation. Return nullptr to let dispatcher select the next one */           \
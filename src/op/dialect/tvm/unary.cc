@@ -105,6 +105,9 @@ RAF_TVM_UNARY(zeros_like, ZerosLike);
 RAF_TVM_UNARY(ones_like, OnesLike);
 RAF_TVM_UNARY(trunc, Trunc);
 RAF_TVM_UNARY(reciprocal, Reciprocal);
+// Each output element reads the group of four elements it belongs to.
+RAF_TVM(prune_24, Prune24, UnaryArgs, UnarySchema2Args, UnarySchemaArgNames, GenericAttrs,
+        GenericHasher, kInjective);
 
 RAF_TVM_UNARY_DX(gelu_dx, GeluDx);
 RAF_TVM_UNARY_DX(erf_dx, ErfDx);
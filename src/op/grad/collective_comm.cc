@@ -10,6 +10,7 @@
 #include "./grad_utils.h"
 #include "raf/pass.h"
 #include "raf/ir.h"
+#include "raf/value.h"
 
 namespace raf {
 namespace op {
@@ -35,6 +36,92 @@ Array<Expr> AllToAllGrad(const Expr& orig_call, const Array<Expr> orig_args, con
 
 RAF_OP_GRAD("raf.op._all_to_all", AllToAllGrad);
 
+Array<Expr> AllToAllvGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                          const Expr& dy) {
+  // Send the gradients of the received rows back with the received counts.
+  static auto op_all_to_allv = Op::Get("raf.op._all_to_allv");
+  Expr dx = Call(op_all_to_allv, {TupleGetItem(dy, 0), TupleGetItem(y, 1)});
+  return {TupleGetItem(dx, 0), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op._all_to_allv", AllToAllvGrad);
+
+Array<Expr> AllReduceGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                          const Expr& dy) {
+  // Every rank outputs the reduction of the inputs of all ranks, so the gradient of an input is
+  // the same reduction of the output gradients of all ranks.
+  static auto op_allreduce = Op::Get("raf.op._allreduce");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK_EQ(call->args.size(), 3);
+  const auto* computation = call->args[1].as<ConstantNode>();
+  CHECK(computation != nullptr);
+  std::string reduction = computation->value.as<value::StringValueObj>()->value;
+  CHECK(reduction == "sum" || reduction == "avg")
+      << "Gradient of allreduce is only supported for sum and avg, but got " << reduction;
+  const Expr& rank_list = call->args[2];
+  if (orig_args[0]->checked_type_.defined()) {
+    auto orig_arg_tt = Downcast<TupleType>(orig_args[0]->checked_type());
+    if (orig_arg_tt->fields.size() > 1) {
+      return {Call(op_allreduce, {dy, call->args[1], rank_list})};
+    }
+  }
+  // assume input tuple size is 1
+  return {Tuple({Call(op_allreduce, {Tuple({dy}), call->args[1], rank_list})})};
+}
+
+RAF_OP_GRAD("raf.op._allreduce", AllReduceGrad);
+
+Array<Expr> AllGatherGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                          const Expr& dy) {
+  // Every rank outputs the concatenation of the inputs of all ranks, so the gradient of the input
+  // of a rank is its slice of the output gradients summed over all ranks.
+  static auto op_reduce_scatter = Op::Get("raf.op._reduce_scatter");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK_EQ(call->args.size(), 3);
+  const auto* axis = call->args[1].as<ConstantNode>();
+  CHECK(axis != nullptr && axis->value.as<value::IntValueObj>()->value == 0)
+      << "Gradient of allgather is only supported for axis 0";
+  return {Call(op_reduce_scatter, {dy, MakeConstant(value::StringValue::make("sum")),
+                                   call->args[2]})};
+}
+
+RAF_OP_GRAD("raf.op._allgather", AllGatherGrad);
+
+Array<Expr> ReduceScatterGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                              const Expr& dy) {
+  // Each rank outputs its slice of the sum of the inputs of all ranks, so the gradient of an
+  // input is the concatenation of the output gradients of all ranks.
+  static auto op_allgather = Op::Get("raf.op._allgather");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK_EQ(call->args.size(), 3);
+  const auto* computation = call->args[1].as<ConstantNode>();
+  CHECK(computation != nullptr && computation->value.as<value::StringValueObj>()->value == "sum")
+      << "Gradient of reduce_scatter is only supported for sum";
+  return {Call(op_allgather, {dy, MakeConstant(value::ScalarValue::make(0)), call->args[2]})};
+}
+
+RAF_OP_GRAD("raf.op._reduce_scatter", ReduceScatterGrad);
+
+Array<Expr> BroadcastGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                          const Expr& dy) {
+  // The inputs of broadcast are expected to be the replicas of the same tensor on all ranks, so
+  // the gradient of each replica is the sum of the output gradients of all ranks. This keeps the
+  // replicas identical after they are updated with their gradients.
+  static auto op_allreduce = Op::Get("raf.op._allreduce");
+  auto computation = MakeConstant(value::StringValue::make("sum"));
+  auto rank_list = MakeConstant(NullValue<value::Value>());
+  if (orig_args[0]->checked_type_.defined()) {
+    auto orig_arg_tt = Downcast<TupleType>(orig_args[0]->checked_type());
+    if (orig_arg_tt->fields.size() > 1) {
+      return {Call(op_allreduce, {dy, computation, rank_list})};
+    }
+  }
+  // assume input tuple size is 1
+  return {Tuple({Call(op_allreduce, {Tuple({dy}), computation, rank_list})})};
+}
+
+RAF_OP_GRAD("raf.op._broadcast", BroadcastGrad);
+
 }  // namespace grad
 }  // namespace op
 }  // namespace raf
@@ -68,6 +68,19 @@ Array<Expr> CrossEntropyGrad(const Expr& orig_call, const Array<Expr> orig_args,
 
 RAF_OP_GRAD("raf.op.cross_entropy", CrossEntropyGrad);
 
+Array<Expr> SoftmaxCrossEntropyGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                    const Expr& y, const Expr& ograds) {
+  static auto dpred = Op::Get("raf.op.softmax_cross_entropy_dpred");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK_EQ(call->args.size(), 4);
+  const Array<Expr>& args = call->args;
+  // The softmax is recomputed from the logits instead of being kept from the forward.
+  return {NullValue<Expr>(), Call(dpred, {ograds, args[0], args[1], args[2], args[3]}),
+          NullValue<Expr>(), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.softmax_cross_entropy", SoftmaxCrossEntropyGrad);
+
 }  // namespace grad
 }  // namespace op
 }  // namespace raf
@@ -357,6 +357,38 @@ Array<Expr> BatchNormTrainGrad(const Expr& orig_call, const Var& y, const Expr&
 
 RAF_OP_FUSED_GRAD("raf.op.batch_norm_train", BatchNormTrainGrad);
 
+Array<Expr> BatchNormReluTrainGrad(const Expr& orig_call, const Var& y, const Expr& dymv,
+                                   const Array<Expr>& igrads) {
+  // schema for batch_norm_relu_train is:
+  //    x, running_mean, running_var, w, b, z, momentum, eps, layout
+  // schema for batch_norm_relu_train_dxwb is:
+  //    dy, x, w, b, y, reserve_space, with_z, eps, layout
+  static auto op_dxwb = Op::Get("raf.op.batch_norm_relu_train_dxwb");
+  const Expr& dy = AsTupleExpr(dymv, 4)[0];
+  const CallNode* call = orig_call.as<CallNode>();
+  const Expr& x = call->args[0];
+  const Expr& w = call->args[3];
+  const Expr& b = call->args[4];
+  const Expr& z = call->args[5];
+  const Expr& eps = call->args[7];
+  const Expr& layout = call->args[8];
+  const auto* kz = z.as<ConstantNode>();
+  bool with_z = !(kz && !kz->value.defined());
+  // The backward reads the output for the relu mask, and the reserve space for cuDNN.
+  const Expr& ret = Call(op_dxwb, {dy, x, w, b, TupleGetItem(y, 0), TupleGetItem(y, 3),
+                                   MakeConstant(BoolValue::make(with_z)), eps, layout});
+  return {
+      TupleGetItem(ret, 0),
+      NullValue<Expr>(),
+      NullValue<Expr>(),
+      TupleGetItem(ret, 1),
+      TupleGetItem(ret, 2),
+      with_z ? TupleGetItem(ret, 3) : NullValue<Expr>(),
+  };
+}
+
+RAF_OP_FUSED_GRAD("raf.op.batch_norm_relu_train", BatchNormReluTrainGrad);
+
 template <const char* GradOp>
 Array<Expr> SoftmaxGradImpl(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
                             const Expr& dy) {
@@ -450,6 +482,89 @@ Array<Expr> LayerNormTrainGrad(const Expr& orig_call, const Array<Expr> orig_arg
 
 RAF_OP_GRAD("raf.op.layer_norm_train", LayerNormTrainGrad);
 
+Array<Expr> AddDropoutLayerNormGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                    const Var& y, const Expr& dymv) {
+  static auto op_dx = Op::Get("raf.op.add_dropout_layer_norm_dx");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK(call != nullptr);
+  // The output and the residual sum are differentiable. The dropout seed is kept to regenerate
+  // the mask in the backward.
+  Array<Expr> dys = AsTupleExpr(dymv, 5);
+  const Expr& scale = call->args[2];
+  const Expr& p = call->args[4];
+  auto z = TupleGetItem(y, 1);
+  auto mean = TupleGetItem(y, 2);
+  auto invvar = TupleGetItem(y, 3);
+  auto rng_state = TupleGetItem(y, 4);
+  const Expr& ret = Call(op_dx, {dys[0], dys[1], z, scale, mean, invvar, rng_state, p});
+  const auto* kscale = scale.as<tvm::relay::ConstantNode>();
+  if (kscale && !static_cast<const ConstantNode*>(kscale)->value.defined()) {
+    // scale and bias are not learnable parameters.
+    return {TupleGetItem(ret, 0), TupleGetItem(ret, 1), NullValue<Expr>(), NullValue<Expr>(),
+            NullValue<Expr>(), NullValue<Expr>()};
+  }
+  return {TupleGetItem(ret, 0), TupleGetItem(ret, 1), TupleGetItem(ret, 2),
+          TupleGetItem(ret, 3), NullValue<Expr>(), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.add_dropout_layer_norm", AddDropoutLayerNormGrad);
+
+Array<Expr> AttentionGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                          const Expr& dymv) {
+  static auto op_dx = Op::Get("raf.op.attention_dx");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK(call != nullptr);
+  // Only the attention output is differentiable. The logsumexp of the scores and the dropout
+  // seed are kept to recompute the probabilities in the backward.
+  const Expr& dy = AsTupleExpr(dymv, 3)[0];
+  auto out = TupleGetItem(y, 0);
+  auto lse = TupleGetItem(y, 1);
+  auto rng_state = TupleGetItem(y, 2);
+  const Array<Expr>& args = call->args;
+  auto ret = Call(op_dx, {args[0], args[1], args[2], out, dy, lse, rng_state, args[3], args[4],
+                          args[5]});
+  return {TupleGetItem(ret, 0), TupleGetItem(ret, 1), TupleGetItem(ret, 2), NullValue<Expr>(),
+          NullValue<Expr>(), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.attention", AttentionGrad);
+
+Array<Expr> RMSNormGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                        const Expr& dy) {
+  static auto op_dx = Op::Get("raf.op.rms_norm_dx");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK(call != nullptr);
+  // The root mean square of each row is recomputed from x in the backward, so the forward keeps
+  // no statistics.
+  const Expr& x = call->args[0];
+  const Expr& scale = call->args[1];
+  const Expr& eps = call->args[2];
+  const Expr& ret = Call(op_dx, {x, scale, dy, eps});
+  const auto* kscale = scale.as<tvm::relay::ConstantNode>();
+  if (kscale && !static_cast<const ConstantNode*>(kscale)->value.defined()) {
+    return {ret, NullValue<Expr>(), NullValue<Expr>()};
+  }
+  return {TupleGetItem(ret, 0), TupleGetItem(ret, 1), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.rms_norm", RMSNormGrad);
+
+Array<Expr> RotaryEmbeddingGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                const Var& y, const Expr& dy) {
+  static auto op_rotary = Op::Get("raf.op.rotary_embedding");
+  static auto op_negative = Op::Get("raf.op.negative");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK(call != nullptr);
+  // The rotation is orthogonal, so dx is dy rotated by the opposite angles. The position tables
+  // are not differentiable.
+  const Array<Expr>& args = call->args;
+  Expr neg_sin = Call(op_negative, {args[2]});
+  return {Call(op_rotary, {dy, args[1], neg_sin, args[3], args[4]}), NullValue<Expr>(),
+          NullValue<Expr>(), NullValue<Expr>(), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.rotary_embedding", RotaryEmbeddingGrad);
+
 Array<Expr> ReciprocalGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
                            const Expr& dy) {
   static auto op_div = Op::Get("raf.op.divide");
@@ -0,0 +1,71 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/grad/sparse.cc
+ * \brief Declaration of gradients of sparse matrix operators. The sparsity pattern (indptr and
+ * indices) has no gradient, and the gradient of the values is only taken at the non-zeros.
+ */
+#include "./grad_utils.h"
+
+namespace raf {
+namespace op {
+namespace grad {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+Array<Expr> CsrSpmmGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                        const Expr& dy) {
+  static auto op_spmm_tn = Op::Get("raf.op.csr_spmm_tn");
+  static auto op_sddmm = Op::Get("raf.op.csr_sddmm");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK_EQ(call->args.size(), 4);
+  const Expr& indptr = call->args[0];
+  const Expr& indices = call->args[1];
+  const Expr& values = call->args[2];
+  const Expr& dense = call->args[3];
+  return {NullValue<Expr>(), NullValue<Expr>(), Call(op_sddmm, {indptr, indices, dy, dense}),
+          Call(op_spmm_tn, {indptr, indices, values, dy, GetShape(dense)})};
+}
+
+RAF_OP_GRAD("raf.op.csr_spmm", CsrSpmmGrad);
+
+Array<Expr> CsrSpmmTnGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                          const Expr& dy) {
+  static auto op_spmm = Op::Get("raf.op.csr_spmm");
+  static auto op_sddmm = Op::Get("raf.op.csr_sddmm");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK_EQ(call->args.size(), 5);
+  const Expr& indptr = call->args[0];
+  const Expr& indices = call->args[1];
+  const Expr& values = call->args[2];
+  const Expr& dense = call->args[3];
+  return {NullValue<Expr>(), NullValue<Expr>(), Call(op_sddmm, {indptr, indices, dense, dy}),
+          Call(op_spmm, {indptr, indices, values, dy}), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.csr_spmm_tn", CsrSpmmTnGrad);
+
+Array<Expr> CsrSddmmGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                         const Expr& dy) {
+  static auto op_spmm = Op::Get("raf.op.csr_spmm");
+  static auto op_spmm_tn = Op::Get("raf.op.csr_spmm_tn");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK_EQ(call->args.size(), 4);
+  const Expr& indptr = call->args[0];
+  const Expr& indices = call->args[1];
+  const Expr& x1 = call->args[2];
+  const Expr& x2 = call->args[3];
+  // dy is the values of a CSR matrix in the same sparsity pattern.
+  return {NullValue<Expr>(), NullValue<Expr>(), Call(op_spmm, {indptr, indices, dy, x2}),
+          Call(op_spmm_tn, {indptr, indices, dy, x1, GetShape(x2)})};
+}
+
+RAF_OP_GRAD("raf.op.csr_sddmm", CsrSddmmGrad);
+
+}  // namespace grad
+}  // namespace op
+}  // namespace raf
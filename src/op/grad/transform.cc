@@ -249,16 +249,34 @@ Array<Expr> EmbeddingGrad(const Expr& orig_call, const Array<Expr> orig_args, co
 
 RAF_OP_GRAD("raf.op.embedding", EmbeddingGrad);
 
+Array<Expr> EmbeddingPositionGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                  const Var& y, const Expr& dy) {
+  static auto op_dx = Op::Get("raf.op.embedding_dx");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK_EQ(call->args.size(), 4);
+  const Expr& x = call->args[0];
+  const Expr& indices = call->args[1];
+  const Expr& position = call->args[2];
+  const Expr& position_ids = call->args[3];
+  return {Call(op_dx, {dy, indices, GetShape(x)}), NullValue<Expr>(),
+          Call(op_dx, {dy, position_ids, GetShape(position)}), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.embedding_position", EmbeddingPositionGrad);
+
 Array<Expr> ScatterGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
                         const Expr& dy) {
   static auto op_dx = Op::Get("raf.op.scatter_dx");
+  static auto gather = Op::Get("raf.op.gather");
   const CallNode* call = orig_call.as<CallNode>();
   CHECK_EQ(call->args.size(), 4);
   const Expr& x = call->args[0];
   const Expr& index = call->args[1];
   const Expr& src = call->args[2];
   const Expr& axis = call->args[3];
-  return {Call(op_dx, {x, y, dy, index, src, axis})};
+  // The elements of src are written to y at index, so their gradients are gathered from dy.
+  return {Call(op_dx, {x, y, dy, index, src, axis}), NullValue<Expr>(),
+          Call(gather, {dy, axis, index}), NullValue<Expr>()};
 }
 
 RAF_OP_GRAD("raf.op.scatter", ScatterGrad);
@@ -401,6 +419,8 @@ RAF_OP_GRAD("raf.op.resize2d", Resize2dGrad);
 RAF_OP_GRAD("raf.op.arange", NoGrads<0>);
 RAF_OP_GRAD("raf.op.zeros", NoGrads<0>);
 RAF_OP_GRAD("raf.op.ones", NoGrads<0>);
+RAF_OP_GRAD("raf.op.zeros_like", NoGrads<1>);
+RAF_OP_GRAD("raf.op.ones_like", NoGrads<1>);
 
 Array<Expr> CumsumGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
                        const Expr& dy) {
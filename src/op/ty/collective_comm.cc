@@ -39,6 +39,14 @@ Type IdentityType(const CallValues& value) {
 RAF_OP_TYPE("raf.op._allreduce", "NCCLAllReduce", IdentityType<AllreduceArgs>);
 RAF_OP_TYPE("raf.op._all_to_all", "NCCLAllToAll", IdentityType<AllToAllArgs>);
 RAF_OP_TYPE("raf.op._broadcast", "NCCLBroadcast", IdentityType<BroadcastArgs>);
+
+Type AllToAllvInfer(const CallValues& value) {
+  const auto* args = value->args.as<AllToAllvArgs>();
+  CHECK(args != nullptr);
+  return TupleType({GetType(args->x), GetType(args->send_counts)});
+}
+
+RAF_OP_TYPE("raf.op._all_to_allv", "NCCLAllToAllv", AllToAllvInfer);
 RAF_OP_TYPE("raf.op._reduce", "NCCLReduce", IdentityType<CommReduceArgs>);
 
 Type ReduceScatterInfer(const CallValues& value) {
@@ -137,5 +145,28 @@ Type GroupAllGatherInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op._group_allgather", "NCCLGroupAllGather", GroupAllGatherInfer);
 
+Type GroupCommInfer(const CallValues& value) {
+  const auto* args = value->args.as<GroupCommArgs>();
+  CHECK(args != nullptr);
+  CHECK_EQ(args->tensor_list.size(), args->kinds.size());
+  int size = GetGlobalCommunicator()->size;
+  Array<Type> ret;
+  for (size_t i = 0; i < args->tensor_list.size(); ++i) {
+    auto ttype = GetType(args->tensor_list[i]).as<TensorTypeNode>();
+    auto shape = ttype->shape;
+    auto first_dim = shape[0].as<IntImmNode>()->value;
+    if (args->kinds[i] == kGroupAllGather) {
+      shape.Set(0, Integer(first_dim * size));
+    } else if (args->kinds[i] == kGroupReduceScatter) {
+      CHECK(first_dim % size == 0);
+      shape.Set(0, Integer(first_dim / size));
+    }
+    ret.push_back(TensorType(shape, DataType(ttype->dtype)));
+  }
+  return TupleType(ret);
+}
+
+RAF_OP_TYPE("raf.op._group_comm", "NCCLGroupComm", GroupCommInfer);
+
 }  // namespace op
 }  // namespace raf
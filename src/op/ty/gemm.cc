@@ -10,6 +10,7 @@
 #include <tvm/relay/type.h>
 #include "raf/type.h"
 #include "../schema/ufunc.h"
+#include "../schema/nn.h"
 #include "./utils.h"
 
 namespace raf {
@@ -43,6 +44,11 @@ Type MatmulInfer(const CallValues& value) {
   return TensorType(oshape, x->dtype);
 }
 
+Type QuantizedDenseInfer(const CallValues& value) {
+  TensorType out = Downcast<TensorType>(MatmulInfer<false, true>(value));
+  return TensorType(out->shape, DataType::Int(32));
+}
+
 template <bool transpose_a, bool transpose_b>
 Type BatchMatmulInfer(const CallValues& value) {
   const auto* args = value->args.as<BinaryArgs>();
@@ -76,10 +82,41 @@ RAF_OP_TYPE("raf.op.matmul_nt", "MatmulNT", (MatmulInfer<false, true>));
 RAF_OP_TYPE("raf.op.matmul_tn", "MatmulTN", (MatmulInfer<true, false>));
 RAF_OP_TYPE("raf.op.matmul_tt", "MatmulTT", (MatmulInfer<true, true>));
 RAF_OP_TYPE("raf.op.dense", "DenseInfer", (MatmulInfer<false, true>));
+RAF_OP_TYPE("raf.op.quantized_dense", "QuantizedDenseInfer", QuantizedDenseInfer);
+RAF_OP_TYPE("raf.op.sparse24_dense", "Sparse24DenseInfer", (MatmulInfer<false, true>));
 RAF_OP_TYPE("raf.op.batch_matmul", "BatchMatmulNN", (BatchMatmulInfer<false, false>));
 RAF_OP_TYPE("raf.op.batch_matmul_nt", "BatchMatmulNT", (BatchMatmulInfer<false, true>));
 RAF_OP_TYPE("raf.op.batch_matmul_tn", "BatchMatmulTN", (BatchMatmulInfer<true, false>));
 RAF_OP_TYPE("raf.op.batch_matmul_tt", "BatchMatmulTT", (BatchMatmulInfer<true, true>));
 
+Type Prune24Infer(const CallValues& value) {
+  const auto* args = value->args.as<schema::UnaryArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->x);
+}
+
+RAF_OP_TYPE("raf.op.prune_24", "Identity", Prune24Infer);
+
+Type GroupedMatmulInfer(const CallValues& value) {
+  const auto* args = value->args.as<schema::GroupedMatmulArgs>();
+  CHECK(args != nullptr);
+  CHECK_EQ(args->a.size(), args->b.size()) << "GroupedMatmul: a and b should have the same length";
+  Array<Type> ret;
+  for (size_t i = 0; i < args->a.size(); ++i) {
+    TensorType x = Downcast<TensorType>(GetType(args->a[i]));
+    TensorType y = Downcast<TensorType>(GetType(args->b[i]));
+    CHECK(x->shape.size() == 2 && y->shape.size() == 2);
+    PrimExpr k = args->transpose_b ? y->shape[1] : y->shape[0];
+    PrimExpr n = args->transpose_b ? y->shape[0] : y->shape[1];
+    CHECK(TypeCheckCompare(x->shape[1], k, std::equal_to<int>()))
+        << "GroupedMatmul: shapes of problem " << i << " is inconsistent, "
+        << " a shape=" << x->shape << ", b shape=" << y->shape;
+    ret.push_back(TensorType({x->shape[0], n}, x->dtype));
+  }
+  return TupleType(ret);
+}
+
+RAF_OP_TYPE("raf.op.grouped_matmul", "GroupedMatmul", GroupedMatmulInfer);
+
 }  // namespace op
 }  // namespace raf
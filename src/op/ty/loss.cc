@@ -18,6 +18,8 @@ namespace op {
 using namespace raf::ir;
 using schema::LossArgs;
 using schema::LossDtpArgs;
+using schema::SoftmaxCrossEntropyArgs;
+using schema::SoftmaxCrossEntropyDpredArgs;
 
 Type NLLLossInfer(const CallValues& value) {
   const auto* args = value->args.as<LossArgs>();
@@ -74,5 +76,30 @@ RAF_OP_TYPE("raf.op.cross_entropy", "CrossEntropy", NLLLossInfer);
 RAF_OP_TYPE("raf.op.cross_entropy_dpred", "CrossEntropyDpred", NLLLossBack);
 RAF_OP_TYPE("raf.op.cross_entropy_dtrue", "CrossEntropyDtrue", NLLLossBack);
 
+Type SoftmaxCrossEntropyInfer(const CallValues& value) {
+  const auto* args = value->args.as<SoftmaxCrossEntropyArgs>();
+  CHECK(args != nullptr);
+  TensorType pred = Downcast<TensorType>(GetType(args->y_pred));
+  TensorType true_ = Downcast<TensorType>(GetType(args->y_true));
+  CHECK_EQ(pred->shape.size(), 2U);
+  CHECK_EQ(true_->shape.size(), 1U);
+  CHECK(TypeCheckCompare(pred->shape[0], true_->shape[0], std::equal_to<int>()));
+  Array<tvm::PrimExpr> oshape = {1};
+  return TensorType(oshape, DataType::Float(32));
+}
+
+Type SoftmaxCrossEntropyDpredInfer(const CallValues& value) {
+  const auto* args = value->args.as<SoftmaxCrossEntropyDpredArgs>();
+  CHECK(args != nullptr);
+  TensorType pred = Downcast<TensorType>(GetType(args->y_pred));
+  TensorType true_ = Downcast<TensorType>(GetType(args->y_true));
+  CHECK(TypeCheckCompare(pred->shape[0], true_->shape[0], std::equal_to<int>()));
+  return pred;
+}
+
+RAF_OP_TYPE("raf.op.softmax_cross_entropy", "SoftmaxCrossEntropy", SoftmaxCrossEntropyInfer);
+RAF_OP_TYPE("raf.op.softmax_cross_entropy_dpred", "SoftmaxCrossEntropyDpred",
+            SoftmaxCrossEntropyDpredInfer);
+
 }  // namespace op
 }  // namespace raf
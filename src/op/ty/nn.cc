@@ -81,6 +81,13 @@ Type Conv2DInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.conv2d", "Conv2d", Conv2DInfer);
 
+Type QuantizedConv2DInfer(const CallValues& value) {
+  TensorType out = Downcast<TensorType>(Conv2DInfer(value));
+  return TensorType(out->shape, DataType::Int(32));
+}
+
+RAF_OP_TYPE("raf.op.quantized_conv2d", "QuantizedConv2d", QuantizedConv2DInfer);
+
 Type Conv2DTransInfer(const CallValues& value) {
   const auto* args = value->args.as<ConvTransArgs>();
   CHECK(args != nullptr);
@@ -253,6 +260,25 @@ Type BatchNormTrainInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.batch_norm_train", "BatchNormTrain", BatchNormTrainInfer);
 
+Type BatchNormReluTrainInfer(const CallValues& value) {
+  const auto* args = value->args.as<BatchNormReluArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType running_mean = Downcast<TensorType>(GetType(args->running_mean));
+  TensorType running_var = Downcast<TensorType>(GetType(args->running_var));
+  if (args->z.defined()) {
+    TensorType z = Downcast<TensorType>(GetType(args->z.value()));
+    CHECK_EQ(x->shape.size(), z->shape.size())
+        << "ValueError: the residual input of batch_norm_relu_train must have the shape of x";
+  }
+  int64_t reserve_space_bytes =
+      GetBatchNormReluReserveSpaceBytes(x, args->layout, args->z.defined());
+  TensorType reserve_space({Integer(reserve_space_bytes)}, DataType::UInt(8));
+  return TupleType({x, running_mean, running_var, reserve_space});
+}
+
+RAF_OP_TYPE("raf.op.batch_norm_relu_train", "BatchNormReluTrain", BatchNormReluTrainInfer);
+
 template <typename T>
 Type GeneralAxisInfer(const CallValues& value) {
   const auto* args = value->args.as<T>();
@@ -291,6 +317,22 @@ Type BatchNormTrainDxwbInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.batch_norm_train_dxwb", "BatchNormTrainDxwb", BatchNormTrainDxwbInfer);
 
+Type BatchNormReluTrainDxwbInfer(const CallValues& value) {
+  const auto* args = value->args.as<BatchNormReluDxwbArgs>();
+  CHECK(args != nullptr);
+  TensorType dx = Downcast<TensorType>(GetType(args->x));
+  TensorType dw = Downcast<TensorType>(GetType(args->w));
+  TensorType db = Downcast<TensorType>(GetType(args->b));
+  Array<Type> res{dx, dw, db};
+  if (args->with_z) {
+    res.push_back(dx);
+  }
+  return TupleType(res);
+}
+
+RAF_OP_TYPE("raf.op.batch_norm_relu_train_dxwb", "BatchNormReluTrainDxwb",
+            BatchNormReluTrainDxwbInfer);
+
 Type BiasAddInfer(const CallValues& value) {
   const auto* args = value->args.as<BiasAddArgs>();
   return GetType(args->x);
@@ -303,15 +345,11 @@ Type ContribDropoutInfer(const CallValues& value) {
   const auto* args = value->args.as<DropoutArgs>();
   TensorType x_ty = Downcast<TensorType>(GetType(args->x));
   TensorType reserve_space({}, DataType::UInt(8));
-#ifdef RAF_USE_CUDA
-  const tvm::runtime::PackedFunc* pf =
-      tvm::runtime::Registry::Get("raf.backend.cudnn.GetDropoutReserveSpaceSizeInBytes");
-  if (include_reserve_space && pf) {
-    Integer reserve_space_size_in_bytes = (*pf)(GetType(args->x));
-    Array<PrimExpr> reserve_space_shape = {reserve_space_size_in_bytes};
+  int64_t reserve_space_bytes = GetDropoutReserveSpaceBytes(x_ty);
+  if (include_reserve_space && reserve_space_bytes > 0) {
+    Array<PrimExpr> reserve_space_shape = {Integer(reserve_space_bytes)};
     reserve_space = TensorType(reserve_space_shape, DataType::UInt(8));
   }
-#endif
   Array<PrimExpr> mask_shape;
   if (include_mask) {
     mask_shape = x_ty->shape;
@@ -327,6 +365,16 @@ RAF_OP_TYPE("raf.op._contrib_dropout", "ContribDropout", ContribDropoutBase);
 RAF_OP_TYPE("raf.op.tvm._contrib_dropout", "ContribDropoutTVM", ContribDropoutTVM);
 RAF_OP_TYPE("raf.op.cudnn._contrib_dropout", "ContribDropoutCudnn", ContribDropoutCudnn);
 
+Type ContribDropoutCUDAInfer(const CallValues& value) {
+  const auto* args = value->args.as<DropoutArgs>();
+  TensorType x_ty = Downcast<TensorType>(GetType(args->x));
+  TensorType mask_ty({}, DataType::Float(32));
+  TensorType reserve_space({Integer(kDropoutPhiloxStateBytes)}, DataType::UInt(8));
+  return TupleType(Array<Type>{x_ty, mask_ty, reserve_space});
+}
+
+RAF_OP_TYPE("raf.op.cuda._contrib_dropout", "ContribDropoutCUDA", ContribDropoutCUDAInfer);
+
 Type ContribDropoutDxInfer(const CallValues& value) {
   const auto* args = value->args.as<DropoutDxArgs>();
   return GetType(args->dy);
@@ -444,5 +492,86 @@ Type LayerNormTrainDxbInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.layer_norm_train_dx", "LayerNormTrainDx", LayerNormTrainDxbInfer);
 
+Type AddDropoutLayerNormInfer(const CallValues& value) {
+  const auto* args = value->args.as<AddDropoutLayerNormArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  PrimExpr n = Integer(1);
+  for (size_t i = 0; i + 1 < x->shape.size(); ++i) {
+    n *= x->shape[i];
+  }
+  TensorType mean = TensorType({n}, DataType(ir::String2DLDataType("float32")));
+  TensorType invvar = TensorType({n}, DataType(ir::String2DLDataType("float32")));
+  TensorType rng_state = TensorType({Integer(1)}, DataType::Int(64));
+  return TupleType({x, x, mean, invvar, rng_state});
+}
+
+RAF_OP_TYPE("raf.op.add_dropout_layer_norm", "AddDropoutLayerNorm", AddDropoutLayerNormInfer);
+
+Type AddDropoutLayerNormDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<AddDropoutLayerNormDxArgs>();
+  CHECK(args != nullptr);
+  Type dx = GetType(args->z);
+  if (args->scale.defined()) {
+    Type dw = GetType(args->scale.value());
+    return TupleType({dx, dx, dw, dw});
+  }
+  return TupleType({dx, dx});
+}
+
+RAF_OP_TYPE("raf.op.add_dropout_layer_norm_dx", "AddDropoutLayerNormDx",
+            AddDropoutLayerNormDxInfer);
+
+Type RMSNormInfer(const CallValues& value) {
+  const auto* args = value->args.as<RmsNormArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->x);
+}
+
+RAF_OP_TYPE("raf.op.rms_norm", "RMSNorm", RMSNormInfer);
+
+Type RMSNormDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<RmsNormDxArgs>();
+  CHECK(args != nullptr);
+  Type dx = GetType(args->x);
+  if (args->scale.defined()) {
+    return TupleType({dx, GetType(args->scale.value())});
+  }
+  return dx;
+}
+
+RAF_OP_TYPE("raf.op.rms_norm_dx", "RMSNormDx", RMSNormDxInfer);
+
+Type RotaryEmbeddingInfer(const CallValues& value) {
+  const auto* args = value->args.as<RotaryEmbeddingArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->x);
+}
+
+RAF_OP_TYPE("raf.op.rotary_embedding", "RotaryEmbedding", RotaryEmbeddingInfer);
+
+Type AttentionInfer(const CallValues& value) {
+  const auto* args = value->args.as<AttentionArgs>();
+  CHECK(args != nullptr);
+  TensorType q = Downcast<TensorType>(GetType(args->q));
+  Array<PrimExpr> lse_shape;
+  for (size_t i = 0; i + 1 < q->shape.size(); ++i) {
+    lse_shape.push_back(q->shape[i]);
+  }
+  TensorType lse = TensorType(lse_shape, DataType::Float(32));
+  TensorType rng_state = TensorType({Integer(1)}, DataType::Int(64));
+  return TupleType({q, lse, rng_state});
+}
+
+RAF_OP_TYPE("raf.op.attention", "Attention", AttentionInfer);
+
+Type AttentionDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<AttentionDxArgs>();
+  CHECK(args != nullptr);
+  return TupleType({GetType(args->q), GetType(args->k), GetType(args->v)});
+}
+
+RAF_OP_TYPE("raf.op.attention_dx", "AttentionDx", AttentionDxInfer);
+
 }  // namespace op
 }  // namespace raf
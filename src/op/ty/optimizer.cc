@@ -53,5 +53,54 @@ Type LansInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.lans", "Lans", LansInfer);
 
+Type MultiTensorOptimizerInfer(const std::vector<BaseTensorValue>& tensors) {
+  Array<Type> res;
+  for (const auto& tensor : tensors) {
+    res.push_back(Downcast<TensorType>(GetType(tensor)));
+  }
+  return TupleType(res);
+}
+
+Type MultiTensorSgdInfer(const CallValues& value) {
+  const auto* args = value->args.as<MultiTensorSgdArgs>();
+  CHECK(args != nullptr);
+  CHECK_EQ(args->tensor_list.size() % (args->fp16_params ? 4 : 3), 0);
+  return MultiTensorOptimizerInfer(args->tensor_list);
+}
+
+RAF_OP_TYPE("raf.op.multi_tensor_sgd", "MultiTensorSgd", MultiTensorSgdInfer);
+
+Type MultiTensorAdamInfer(const CallValues& value) {
+  const auto* args = value->args.as<MultiTensorAdamArgs>();
+  CHECK(args != nullptr);
+  CHECK_EQ(args->tensor_list.size() % (args->fp16_params ? 5 : 4), 0);
+  return MultiTensorOptimizerInfer(args->tensor_list);
+}
+
+RAF_OP_TYPE("raf.op.multi_tensor_adam", "MultiTensorAdam", MultiTensorAdamInfer);
+
+Type GlobalNormAndCheckInfer(const CallValues& value) {
+  const auto* args = value->args.as<GlobalNormAndCheckArgs>();
+  CHECK(args != nullptr);
+  CHECK(!args->tensor_list.empty());
+  Array<Type> res;
+  res.push_back(TensorType({}, DataType::Float(32)));
+  res.push_back(TensorType({}, DataType::Bool()));
+  return TupleType(res);
+}
+
+RAF_OP_TYPE("raf.op.global_norm_and_check", "GlobalNormAndCheck", GlobalNormAndCheckInfer);
+
+Type UpdateLossScaleInfer(const CallValues& value) {
+  const auto* args = value->args.as<UpdateLossScaleArgs>();
+  CHECK(args != nullptr);
+  Array<Type> res;
+  res.push_back(TensorType({}, DataType::Float(32)));
+  res.push_back(TensorType({}, DataType::Float(32)));
+  return TupleType(res);
+}
+
+RAF_OP_TYPE("raf.op.update_loss_scale", "UpdateLossScale", UpdateLossScaleInfer);
+
 }  // namespace op
 }  // namespace raf
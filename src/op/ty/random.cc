@@ -46,5 +46,21 @@ Type ThreefrySplitInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.threefry_split", "ThreefrySplit", ThreefrySplitInfer);
 
+template <typename T>
+Type ThreefryDistributionInfer(const CallValues& value) {
+  const auto* args = value->args.as<T>();
+  CHECK(args != nullptr);
+  Array<PrimExpr> shape;
+  for (auto& s : args->shape) {
+    shape.push_back(Integer(s));
+  }
+  return TensorType(shape, DataType(ir::String2DLDataType(args->dtype)));
+}
+
+RAF_OP_TYPE("raf.op.threefry_uniform", "ThreefryUniform",
+            ThreefryDistributionInfer<ThreefryUniformArgs>);
+RAF_OP_TYPE("raf.op.threefry_normal", "ThreefryNormal",
+            ThreefryDistributionInfer<ThreefryNormalArgs>);
+
 }  // namespace op
 }  // namespace raf
@@ -0,0 +1,62 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/ty/sparse.cc
+ * \brief Typing of sparse matrix operators
+ */
+#include <tvm/relay/type.h>
+#include "raf/op_utils.h"
+#include "raf/type.h"
+#include "../schema/sparse.h"
+#include "./utils.h"
+
+namespace raf {
+namespace op {
+
+using namespace raf::ir;
+using namespace raf::value;
+using namespace schema;
+
+Type CsrSpmmInfer(const CallValues& value) {
+  const auto* args = value->args.as<CsrSpmmArgs>();
+  CHECK(args != nullptr);
+  TensorType indptr = Downcast<TensorType>(GetType(args->indptr));
+  TensorType dense = Downcast<TensorType>(GetType(args->dense));
+  CHECK_EQ(indptr->shape.size(), 1);
+  CHECK_EQ(dense->shape.size(), 2);
+  Array<PrimExpr> oshape = {indptr->shape[0] - 1, dense->shape[1]};
+  return TensorType(oshape, dense->dtype);
+}
+
+RAF_OP_TYPE("raf.op.csr_spmm", "CsrSpmm", CsrSpmmInfer);
+
+Type CsrSpmmTnInfer(const CallValues& value) {
+  const auto* args = value->args.as<CsrSpmmTnArgs>();
+  CHECK(args != nullptr);
+  TensorType dense = Downcast<TensorType>(GetType(args->dense));
+  return TensorType(GetShapeExprFromValue(args->shape), dense->dtype);
+}
+
+RAF_OP_TYPE("raf.op.csr_spmm_tn", "CsrSpmmTN", CsrSpmmTnInfer);
+
+Type CsrSddmmInfer(const CallValues& value) {
+  const auto* args = value->args.as<CsrSddmmArgs>();
+  CHECK(args != nullptr);
+  TensorType indices = Downcast<TensorType>(GetType(args->indices));
+  TensorType x1 = Downcast<TensorType>(GetType(args->x1));
+  TensorType x2 = Downcast<TensorType>(GetType(args->x2));
+  CHECK_EQ(indices->shape.size(), 1);
+  CHECK(x1->shape.size() == 2 && x2->shape.size() == 2);
+  CHECK(TypeCheckCompare(x1->shape[1], x2->shape[1], std::equal_to<int>()))
+      << "CsrSddmm: shapes of x1 and x2 is inconsistent, "
+      << " x1 shape=" << x1->shape << ", x2 shape=" << x2->shape;
+  return TensorType(indices->shape, x1->dtype);
+}
+
+RAF_OP_TYPE("raf.op.csr_sddmm", "CsrSddmm", CsrSddmmInfer);
+
+}  // namespace op
+}  // namespace raf
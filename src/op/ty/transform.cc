@@ -328,6 +328,61 @@ Type EmbeddingDxInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.embedding_dx", "EmbeddingDx", EmbeddingDxInfer);
 
+Type EmbeddingDxSparseInfer(const CallValues& value) {
+  const auto* args = value->args.as<EmbeddingDxArgs>();
+  CHECK(args != nullptr);
+  TensorType dy = Downcast<TensorType>(GetType(args->dy));
+  TensorType indices = Downcast<TensorType>(GetType(args->indices));
+  auto num_weight = GetShapeExprFromValue(args->num_weight);
+  PrimExpr n = 1;
+  for (const auto& s : indices->shape) {
+    n = n * s;
+  }
+  Array<PrimExpr> shape{n};
+  for (size_t i = 1; i < num_weight.size(); ++i) {
+    shape.push_back(num_weight[i]);
+  }
+  return TupleType({TensorType({n}, DataType::Int(64)), TensorType(shape, dy->dtype)});
+}
+
+RAF_OP_TYPE("raf.op.embedding_dx_sparse", "EmbeddingDxSparse", EmbeddingDxSparseInfer);
+
+Type EmbeddingPositionInfer(const CallValues& value) {
+  const auto* args = value->args.as<EmbeddingPositionArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType indices = Downcast<TensorType>(GetType(args->indices));
+  Array<PrimExpr> shape = indices->shape;
+  for (size_t i = 1; i < x->shape.size(); ++i) {
+    shape.push_back(x->shape[i]);
+  }
+  return TensorType(shape, x->dtype);
+}
+
+RAF_OP_TYPE("raf.op.embedding_position", "EmbeddingPosition", EmbeddingPositionInfer);
+
+Type EmbeddingCacheInfer(const CallValues& value) {
+  const auto* args = value->args.as<EmbeddingCacheArgs>();
+  CHECK(args != nullptr);
+  TensorType table = Downcast<TensorType>(GetType(args->table));
+  TensorType indices = Downcast<TensorType>(GetType(args->indices));
+  Array<PrimExpr> shape = indices->shape;
+  for (size_t i = 1; i < table->shape.size(); ++i) {
+    shape.push_back(table->shape[i]);
+  }
+  return TensorType(shape, table->dtype);
+}
+
+RAF_OP_TYPE("raf.op.embedding_cache", "EmbeddingCache", EmbeddingCacheInfer);
+
+Type EmbeddingCacheSgdInfer(const CallValues& value) {
+  const auto* args = value->args.as<EmbeddingCacheSgdArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->rows);
+}
+
+RAF_OP_TYPE("raf.op.embedding_cache_sgd", "EmbeddingCacheSgd", EmbeddingCacheSgdInfer);
+
 Type ConcatenateInfer(const CallValues& value) {
   const auto* args = value->args.as<ConcatenateArgs>();
   CHECK(args != nullptr);
@@ -459,6 +514,30 @@ Type ScatterDxInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.scatter_dx", "ScatterDx", ScatterDxInfer);
 
+Type KvCacheAppendInfer(const CallValues& value) {
+  const auto* args = value->args.as<KvCacheAppendArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->cache);
+}
+
+RAF_OP_TYPE("raf.op.kv_cache_append", "KvCacheAppend", KvCacheAppendInfer);
+
+Type KvCacheGatherInfer(const CallValues& value) {
+  const auto* args = value->args.as<KvCacheGatherArgs>();
+  CHECK(args != nullptr);
+  TensorType cache = Downcast<TensorType>(GetType(args->cache));
+  TensorType block_table = Downcast<TensorType>(GetType(args->block_table));
+  CHECK_GE(cache->shape.size(), 2);
+  CHECK_EQ(block_table->shape.size(), 2);
+  Array<PrimExpr> shape{block_table->shape[0], block_table->shape[1] * cache->shape[1]};
+  for (size_t i = 2; i < cache->shape.size(); ++i) {
+    shape.push_back(cache->shape[i]);
+  }
+  return TensorType(shape, cache->dtype);
+}
+
+RAF_OP_TYPE("raf.op.kv_cache_gather", "KvCacheGather", KvCacheGatherInfer);
+
 Type CastInfer(const CallValues& value) {
   const auto* args = value->args.as<CastArgs>();
   CHECK(args != nullptr);
@@ -7,7 +7,9 @@
  * \file src/op/ty/utils.cc
  * \brief Typing utils
  */
+#include <algorithm>
 #include "./utils.h"
+#include "raf/registry.h"
 #include "raf/value_functor.h"
 #include "raf/pass.h"
 
@@ -77,6 +79,34 @@ Type GetType(Value value) {
   return typer(value);
 }
 
+int64_t GetDropoutReserveSpaceBytes(const Type& x) {
+  int64_t bytes = -1;
+#ifdef RAF_USE_CUDA
+  bytes = kDropoutPhiloxStateBytes;
+  const tvm::runtime::PackedFunc* pf =
+      tvm::runtime::Registry::Get("raf.backend.cudnn.GetDropoutReserveSpaceSizeInBytes");
+  if (pf) {
+    Integer cudnn_bytes = (*pf)(x);
+    bytes = std::max(bytes, cudnn_bytes->value);
+  }
+#endif
+  return bytes;
+}
+
+int64_t GetBatchNormReluReserveSpaceBytes(const Type& x, const std::string& layout,
+                                          bool with_z) {
+  int64_t bytes = 1;
+#ifdef RAF_USE_CUDA
+  const tvm::runtime::PackedFunc* pf =
+      tvm::runtime::Registry::Get("raf.backend.cudnn.GetBatchNormReluReserveSpaceSizeInBytes");
+  if (pf) {
+    Integer cudnn_bytes = (*pf)(x, layout, with_z);
+    bytes = std::max(bytes, cudnn_bytes->value);
+  }
+#endif
+  return bytes;
+}
+
 bool TypeCheck(const PrimExpr& cond) {
   if (const int64_t* pdiff = tvm::tir::as_const_int(cond)) {
     return pdiff[0];
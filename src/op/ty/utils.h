@@ -27,6 +27,32 @@ namespace op {
  */
 tvm::Type GetType(value::Value value);
 
+/*! \brief The bytes of the Philox (seed, offset) state of the CUDA dropout in int64. */
+constexpr int64_t kDropoutPhiloxStateBytes = 2 * sizeof(int64_t);
+
+/*!
+ * \brief The bytes of the reserve space of the base dropout op, which fits both the cuDNN reserve
+ * space and the Philox state of the CUDA dropout.
+ *
+ * \param x The type of the dropout input
+ *
+ * \return The size in bytes, or -1 if the reserve space is not used
+ */
+int64_t GetDropoutReserveSpaceBytes(const tvm::Type& x);
+
+/*!
+ * \brief The bytes of the reserve space of the fused batch_norm_relu_train, which the cuDNN
+ * kernels use to keep the activation mask for the backward.
+ *
+ * \param x The type of the batch_norm input
+ * \param layout The layout of the batch_norm input
+ * \param with_z Whether the residual input is added before the relu
+ *
+ * \return The size in bytes, which is at least 1
+ */
+int64_t GetBatchNormReluReserveSpaceBytes(const tvm::Type& x, const std::string& layout,
+                                          bool with_z);
+
 /*! \brief Get the value in a DLTensor.
  *
  *  \param v BaseTensorValue which only contains one item
@@ -0,0 +1,117 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file accumulate_gradient.cc
+ * \brief Accumulate the gradients of a micro-batch to the gradients of the previous micro-batches.
+ */
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace accumulate_gradient {
+
+using namespace raf::ir;
+using namespace raf::op;
+
+/*!
+ * \brief Accumulate the gradients in the backward closure generated by AutoDiff. For each
+ * accumulated gradient, the forward function takes the accumulated gradient of the previous
+ * micro-batches as an extra parameter, and the backward closure adds it to the local gradient
+ * right after the local gradient is computed. As a result, the passes that aggregate the returned
+ * gradients across ranks, e.g., AutoDataParallel, only communicate the accumulated gradients,
+ * and the communication still overlaps with the rest of the backward.
+ */
+class GradientAccumulator {
+ public:
+  GradientAccumulator(const FunctionNode* func, const Array<Bool>& accumulate)
+      : func_(func), accumulate_(accumulate) {
+  }
+
+  Function Run() {
+    static const Op& op_add = Op::Get("raf.op.add");
+    auto fp_ell = ExplicitLetList::make(func_->body);
+    size_t fp_n = fp_ell->vars.size();
+    const auto* closure = fp_n >= 2 ? fp_ell->exprs[fp_n - 2].as<FunctionNode>() : nullptr;
+    CHECK(closure != nullptr) << "AccumulateGradient must be applied right after AutoDiff";
+    auto bp_ell = ExplicitLetList::make(closure->body);
+    size_t bp_n = bp_ell->vars.size();
+    auto bp_ret = bp_ell->exprs[bp_n - 1];
+    const auto* ret_tuple = bp_ret.as<TupleNode>();
+    Array<Expr> grads = ret_tuple ? ret_tuple->fields : Array<Expr>{bp_ret};
+    CHECK_EQ(grads.size(), accumulate_.size())
+        << "Expected one accumulation flag for each gradient";
+
+    // The accumulated gradients of the previous micro-batches become the extra parameters.
+    Array<Var> params = func_->params;
+    std::vector<Var> acc_grads(grads.size());
+    for (size_t i = 0; i < grads.size(); ++i) {
+      if (accumulate_[i]) {
+        acc_grads[i] = MakeVar("acc_grad", grads[i]->checked_type());
+        params.push_back(acc_grads[i]);
+      }
+    }
+
+    Array<Expr> new_grads = grads;
+    std::vector<bool> done(grads.size(), false);
+    auto accumulate = [&](size_t i, std::vector<Var>* vars, std::vector<Expr>* exprs) {
+      vars->push_back(MakeVar("grad_sum", {}));
+      exprs->push_back(Call(op_add, {grads[i], acc_grads[i], MakeNull(), MakeNull()}));
+      new_grads.Set(i, vars->back());
+      done[i] = true;
+    };
+    std::vector<Var> vars;
+    std::vector<Expr> exprs;
+    for (size_t j = 0; j + 1 < bp_n; ++j) {
+      vars.push_back(bp_ell->vars[j]);
+      exprs.push_back(bp_ell->exprs[j]);
+      for (size_t i = 0; i < grads.size(); ++i) {
+        if (accumulate_[i] && grads[i].same_as(bp_ell->vars[j])) {
+          accumulate(i, &vars, &exprs);
+        }
+      }
+    }
+    // The gradients that are not computed in the backward closure, e.g., the closure parameters.
+    for (size_t i = 0; i < grads.size(); ++i) {
+      if (accumulate_[i] && !done[i]) {
+        accumulate(i, &vars, &exprs);
+      }
+    }
+    vars.push_back(bp_ell->vars[bp_n - 1]);
+    exprs.push_back(ret_tuple ? Tuple(new_grads) : new_grads[0]);
+    bp_ell->vars = std::move(vars);
+    bp_ell->exprs = std::move(exprs);
+
+    fp_ell->exprs[fp_n - 2] = Function(closure->params, bp_ell->AsExpr(), {}, {});
+    return Function(params, fp_ell->AsExpr(), {}, {});
+  }
+
+ private:
+  /*! \brief The forward function with the backward closure. */
+  const FunctionNode* func_;
+  /*! \brief Whether to accumulate each gradient returned by the backward closure. */
+  Array<Bool> accumulate_;
+};
+
+}  // namespace accumulate_gradient
+
+Pass AccumulateGradient(Array<Bool> accumulate) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return accumulate_gradient::GradientAccumulator(f.operator->(), accumulate).Run();
+  };
+  return CreateRAFFunctionPass(pass_func, 0, "AccumulateGradient", {"InferType"});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.AccumulateGradient").set_body_typed(AccumulateGradient);
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.optim.grad_accumulation_steps", Integer);
+
+}  // namespace pass
+}  // namespace raf
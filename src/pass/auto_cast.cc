@@ -9,7 +9,9 @@
  */
 #include <tvm/ir/transform.h>
 
+#include <map>
 #include <stack>
+#include <unordered_set>
 #include "raf/op.h"
 #include "raf/cache.h"
 #include "raf/ir.h"
@@ -68,6 +70,9 @@ inline Expr GenCastCall(Expr expr, DataType dtype) {
     case DataType::kFloat:
       target_dtype = "float";
       break;
+    case DataType::kBFloat:
+      target_dtype = "bfloat";
+      break;
     case DataType::kUInt:
       target_dtype = "uint";
       break;
@@ -620,15 +625,173 @@ class AutoCastMutator : public ExprMutator {
   /*! \brief Map from ops that the miss casting rule to appearance. */
   std::unordered_map<Op, int, ObjectPtrHash, ObjectPtrEqual> miss_rule_ops_;
 };
+
+/*!
+ * \brief Batch the cast ops in an ANF function into group_cast ops, so that a group of tensors is
+ * cast by one (multi-tensor) kernel instead of one kernel per tensor. The casts of the function
+ * parameters (e.g., the model weights) are hoisted to the beginning of the function and
+ * deduplicated, so each parameter is cast only once per execution no matter how many ops use it.
+ * Other consecutive casts to the same dtype (e.g., the casts of the arguments of one op) are
+ * batched in place. For example:
+ *   fn (%x, %w1, %w2) {
+ *     let %a = raf.op.relu(%x);
+ *     let %b = raf.op.cast(%a, "float16");
+ *     let %c = raf.op.cast(%w1, "float16");
+ *     let %d = raf.op.matmul(%b, %c);
+ *     let %e = raf.op.cast(%w2, "float16");
+ *     let %f = raf.op.matmul(%d, %e);
+ *     %f
+ *   }
+ *
+ * becomes:
+ *   fn (%x, %w1, %w2) {
+ *     let %x_0 = (%w1, %w2);
+ *     let %x_1 = raf.op.group_cast(%x_0, "float16");
+ *     let %c = %x_1.0;
+ *     let %e = %x_1.1;
+ *     let %a = raf.op.relu(%x);
+ *     let %b = raf.op.cast(%a, "float16");
+ *     let %d = raf.op.matmul(%b, %c);
+ *     let %f = raf.op.matmul(%d, %e);
+ *     %f
+ *   }
+ */
+class CastGrouper {
+ public:
+  explicit CastGrouper(const Function& func) : func_(func) {
+  }
+
+  Function Run() {
+    if (!func_->body.as<LetNode>()) {
+      return func_;
+    }
+    std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> params(func_->params.begin(),
+                                                                  func_->params.end());
+    auto ell = ExplicitLetList::make(func_->body);
+    const auto& vars = ell->vars;
+    const auto& exprs = ell->exprs;
+
+    // Collect the casts of the parameters, grouped by the target dtype.
+    std::map<std::string, std::vector<std::pair<Var, Call>>> param_casts;
+    std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> dup_casts;
+    std::map<std::pair<const Object*, std::string>, Var> param_cast_vars;
+    std::vector<bool> hoisted(exprs.size(), false);
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      auto call = GetCast(vars[i], exprs[i]);
+      if (!call.defined() || params.count(Downcast<Var>(call->args[0])) == 0) {
+        continue;
+      }
+      auto dtype = GetDType(call);
+      auto key = std::make_pair(call->args[0].get(), dtype);
+      hoisted[i] = true;
+      if (param_cast_vars.count(key) > 0) {
+        dup_casts[vars[i]] = param_cast_vars[key];
+        continue;
+      }
+      param_cast_vars[key] = vars[i];
+      param_casts[dtype].emplace_back(vars[i], call);
+    }
+
+    LetList ll;
+    for (const auto& kv : param_casts) {
+      EmitCasts(&ll, kv.second);
+    }
+    std::vector<std::pair<Var, Call>> pending;
+    std::unordered_set<const Object*> pending_vars;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      if (hoisted[i]) {
+        if (dup_casts.count(vars[i]) > 0) {
+          // Keep the binding as an alias to the deduplicated cast.
+          FlushCasts(&ll, &pending, &pending_vars);
+          ll.Push(vars[i], dup_casts[vars[i]]);
+        }
+        continue;
+      }
+      auto call = GetCast(vars[i], exprs[i]);
+      // A cast joins the pending group if it casts to the same dtype and does not depend on it.
+      if (call.defined() && !pending.empty() &&
+          (GetDType(call) != GetDType(pending[0].second) ||
+           pending_vars.count(call->args[0].get()) > 0)) {
+        FlushCasts(&ll, &pending, &pending_vars);
+      }
+      if (call.defined()) {
+        pending.emplace_back(vars[i], call);
+        pending_vars.insert(vars[i].get());
+        continue;
+      }
+      FlushCasts(&ll, &pending, &pending_vars);
+      ll.Push(vars[i], exprs[i]);
+    }
+    FlushCasts(&ll, &pending, &pending_vars);
+    auto body = ll.Get(ell->ret);
+    return Function(func_->params, body, func_->ret_type, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Get the cast call bound to the var if it can be batched, or an undefined call. */
+  Call GetCast(const Var& var, const Expr& expr) {
+    static const Op& cast_op = Op::Get("raf.op.cast");
+    auto call = expr.as<CallNode>();
+    if (call == nullptr || call->op != cast_op || !call->args[0]->IsInstance<VarNode>() ||
+        var.as<ExtendedVarNode>()->may_share.defined()) {
+      return Call();
+    }
+    auto in_type = call->args[0]->checked_type().as<TensorTypeNode>();
+    if (in_type == nullptr) {
+      return Call();
+    }
+    return GetRef<Call>(call);
+  }
+
+  /*! \brief Get the target dtype of a cast call. */
+  std::string GetDType(const Call& call) {
+    return DLDataType2String(Downcast<TensorType>(call->checked_type())->dtype);
+  }
+
+  /*! \brief Emit the given casts to the same dtype, batched into a group_cast if more than one. */
+  void EmitCasts(LetList* ll, const std::vector<std::pair<Var, Call>>& casts) {
+    static const Op& group_cast_op = Op::Get("raf.op.group_cast");
+    if (casts.size() == 1) {
+      ll->Push(casts[0].first, casts[0].second);
+      return;
+    }
+    Array<Expr> fields;
+    for (const auto& kv : casts) {
+      fields.push_back(kv.second->args[0]);
+    }
+    auto tuple = ll->Push(Tuple(fields));
+    auto group_cast = ll->Push(Call(group_cast_op, {tuple, casts[0].second->args[1]}));
+    for (size_t i = 0; i < casts.size(); ++i) {
+      ll->Push(casts[i].first, TupleGetItem(group_cast, i));
+    }
+  }
+
+  /*! \brief Emit the pending casts and clear them. */
+  void FlushCasts(LetList* ll, std::vector<std::pair<Var, Call>>* pending,
+                  std::unordered_set<const Object*>* pending_vars) {
+    if (!pending->empty()) {
+      EmitCasts(ll, *pending);
+    }
+    pending->clear();
+    pending_vars->clear();
+  }
+
+  /*! \brief The function to be processed. */
+  Function func_;
+};
+
 }  // namespace auto_cast
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.amp.dtype", String);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.amp.out_dtype", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.amp.group_cast", Bool);
 
 Pass AutoCast() {
   PassContext pass_ctx = PassContext::Current();
   String amp_dtype = pass_ctx->GetConfig("raf.amp.dtype", String("float16")).value();
-  String out_dtype = pass_ctx->GetConfig("raf.amp.out_dtype", String("float16")).value();
+  // The outputs are in the AMP dtype by default.
+  String out_dtype = pass_ctx->GetConfig("raf.amp.out_dtype", amp_dtype).value();
+  bool group_cast = pass_ctx->GetConfig("raf.amp.group_cast", Bool(false)).value();
   DLOG(INFO) << "AMP dtype: " << amp_dtype << ", output dtype: " << out_dtype;
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
@@ -642,7 +805,16 @@ Pass AutoCast() {
     return Downcast<Function>(ret);
   };
   auto insert_cast = CreateRAFFunctionPass(pass_func, 0, "AutoCastFunc", {});
-  return RAFSequential({InferType(), insert_cast, InferType(), DeadCodeElimination()}, "AutoCast");
+  if (!group_cast) {
+    return RAFSequential({InferType(), insert_cast, InferType(), DeadCodeElimination()},
+                         "AutoCast");
+  }
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> group_func =
+      [=](Function f, IRModule m, PassContext pc) { return auto_cast::CastGrouper(f).Run(); };
+  auto group_casts = CreateRAFFunctionPass(group_func, 0, "AutoCastGroupCast", {});
+  return RAFSequential({InferType(), insert_cast, InferType(), DeadCodeElimination(), InferType(),
+                        group_casts, InferType()},
+                       "AutoCast");
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.AutoCast").set_body_typed(AutoCast);
@@ -9,9 +9,12 @@
  */
 #pragma once
 
+#include <numeric>
+#include <string>
 #include <vector>
 #include <tvm/ir/type_functor.h>
 #include "raf/ir.h"
+#include "raf/op_utils.h"
 #include "raf/value.h"
 #include "../op/schema/init.h"
 #include "../op/schema/memory.h"
@@ -320,6 +323,57 @@ inline Value GetValue(Expr expr) {
   return ValueGetter()(expr);
 }
 
+/*!
+ * \brief Check whether the call creates a view of its first argument instead of a new tensor,
+ * i.e., it is a reshape op, or a transpose/swap_axis of a statically shaped tensor that only
+ * moves the axes of size 1. Such calls are lowered to vm.set_shape without kernels.
+ * \param call The call to check.
+ * \return Whether the output of the call is a view of its first argument.
+ */
+inline bool IsViewCall(const CallNode* call) {
+  static const Op& transpose_op = Op::Get("raf.op.transpose");
+  static const op::OpSet transpose_ops = {transpose_op, Op::Get("raf.op.swap_axis")};
+  const auto* op_node = call->op.as<OpNode>();
+  if (op_node == nullptr) {
+    return false;
+  }
+  Op op = GetRef<Op>(op_node);
+  if (op::IsReshapeOp(op)) {
+    return true;
+  }
+  if (!op::IsInOpSet(op, transpose_ops)) {
+    return false;
+  }
+  const auto* ttype = call->args[0]->checked_type_.as<TensorTypeNode>();
+  if (ttype == nullptr || tvm::relay::IsDynamic(GetRef<Type>(ttype))) {
+    return false;
+  }
+  for (size_t i = 1; i < call->args.size(); ++i) {
+    if (!call->args[i]->IsInstance<ConstantNode>()) {
+      return false;
+    }
+  }
+  std::vector<int64_t> shape;
+  for (const auto& dim : ttype->shape) {
+    shape.push_back(dim.as<IntImmNode>()->value);
+  }
+  std::vector<int64_t> axes;
+  if ((op::IsDialectOp(op) ? op::GetBaseOp(op) : op) == transpose_op) {
+    Value value = GetValue(call->args[1]);
+    if (value.defined()) {
+      axes = op::GetShapeVecFromValue(value);
+    }
+  } else {
+    int64_t ndim = shape.size();
+    int64_t axis1 = op::GetScalarValueData<int64_t>(GetValue(call->args[1]));
+    int64_t axis2 = op::GetScalarValueData<int64_t>(GetValue(call->args[2]));
+    axes.resize(ndim);
+    std::iota(axes.begin(), axes.end(), 0);
+    std::swap(axes[axis1 >= 0 ? axis1 : axis1 + ndim], axes[axis2 >= 0 ? axis2 : axis2 + ndim]);
+  }
+  return op::IsOrderPreservingTranspose(shape, axes);
+}
+
 /*!
  * \brief Return the device that the given call node should be on.
  * Note that if the op is *_like(t) (e.g., zeros_like) and t.device != current_device,
@@ -355,9 +409,23 @@ inline Device GetOutputDevice(const Call& call) {
     GET_DEVICE_FROM_SCHEMA(base_op, "raf.op.one_hot", call->args, op::schema::OneHotArgs, device);
     GET_DEVICE_FROM_SCHEMA(base_op, "raf.op.device_copy", call->args, op::schema::DeviceCopyArgs,
                            dst_device);
+    if (op::IsHostShapeOp(base_op)) {
+      return Device(DevType::kCPU(), 0);
+    }
   }
   return device;
 }
 
+/*!
+ * \brief Select the dialect of a base op call by profiling its candidate dialect ops with the
+ * argument types of the call. The decision is persisted by the (op, types, device) of the call, so
+ * each call signature is only profiled once. Defined in dispatch_dialect.cc.
+ * \param call The base op call, whose types have been inferred.
+ * \param device The target device.
+ * \return The fastest dialect, or an empty string if the call is not profiled, e.g., it has dynamic
+ * shapes or at most one candidate dialect op.
+ */
+std::string ProfileGuidedDialect(const Call& call, const Device& device);
+
 };  // namespace pass
 };  // namespace raf
@@ -0,0 +1,282 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file compress_activation.cc
+ * \brief Compress the activations saved for the backward, and decompress them right before their
+ * backward consumers.
+ */
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace compress_activation {
+
+using namespace raf::op;
+
+/*!
+ * \brief The backward ops and the indices of their arguments that are activations saved from the
+ * forward: the inputs and outputs of the activation functions, and the input of conv2d.
+ */
+const std::unordered_map<const OpNode*, std::vector<int>>& BackwardConsumers() {
+  static const std::unordered_map<const OpNode*, std::vector<int>> consumers = {
+      {Op::Get("raf.op.relu_dx").operator->(), {0, 1}},
+      {Op::Get("raf.op.gelu_dx").operator->(), {0, 1}},
+      {Op::Get("raf.op.sigmoid_dx").operator->(), {0, 1}},
+      {Op::Get("raf.op.tanh_dx").operator->(), {0, 1}},
+      {Op::Get("raf.op.conv2d_dw").operator->(), {0}},
+  };
+  return consumers;
+}
+
+/*! \brief Get the argument indices of the saved activations if the call is a backward op. */
+const std::vector<int>* GetSavedArgIndices(const CallNode* call) {
+  const auto* node = call->op.as<OpNode>();
+  if (node == nullptr) {
+    return nullptr;
+  }
+  Op op = GetRef<Op>(node);
+  op = IsDialectOp(op) ? GetBaseOp(op) : op;
+  const auto& consumers = BackwardConsumers();
+  auto it = consumers.find(op.operator->());
+  return it == consumers.end() ? nullptr : &it->second;
+}
+
+/*! \brief Collect the parameters of a fused function that are saved activations of its ops. */
+class SavedParamCollector : public ExprVisitor {
+ public:
+  explicit SavedParamCollector(const FunctionNode* func) {
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      param_index_[func->params[i].get()] = i;
+    }
+    VisitExpr(func->body);
+  }
+
+  void VisitExpr_(const CallNode* call) final {
+    if (const auto* indices = GetSavedArgIndices(call)) {
+      for (int i : *indices) {
+        if (i >= call->args.size()) {
+          continue;
+        }
+        if (const auto* var = call->args[i].as<VarNode>()) {
+          if (param_index_.count(var)) {
+            saved_params.insert(param_index_.at(var));
+          }
+        }
+      }
+    }
+    ExprVisitor::VisitExpr_(call);
+  }
+
+  /*! \brief The indices of the parameters that are saved activations. */
+  std::unordered_set<size_t> saved_params;
+
+ private:
+  std::unordered_map<const VarNode*, size_t> param_index_;
+};
+
+/*!
+ * \brief Compress the float32 activations saved for the backward to a 16-bit dtype, which runs on
+ * the scheduled ANF. The backward consumers are the ops in BackwardConsumers, either called
+ * directly or fused into a primitive function. An activation is compressed right after its last
+ * use in the forward, so that its full precision copy can be freed there, and is decompressed
+ * right before its first backward consumer:
+ *
+ *   let %a = raf.op.relu(%x);
+ *   let %b = raf.op.conv2d(%a, %w, ...);  // The last use of %a in the forward.
+ *   ...
+ *   let %da = raf.op.relu_dx(%x, %a, %dy);
+ * becomes
+ *   let %a = raf.op.relu(%x);
+ *   let %b = raf.op.conv2d(%a, %w, ...);
+ *   let %a_c = raf.op.cast(%a, "float16");
+ *   ...
+ *   let %a_d = raf.op.cast(%a_c, "float32");
+ *   let %da = raf.op.relu_dx(%x, %a_d, %dy);
+ *
+ * Compared to Rematerialization, this trades the precision of the saved activations for neither
+ * recomputing them nor copying them to the host.
+ */
+class ActivationCompressor {
+ public:
+  ActivationCompressor(const FunctionNode* func, const std::string& dtype)
+      : func_(func), dtype_(dtype) {
+  }
+
+  Function Run() {
+    auto ell = ExplicitLetList::make(func_->body);
+    const auto& vars = ell->vars;
+    const auto& exprs = ell->exprs;
+    std::unordered_map<const VarNode*, const FunctionNode*> funcs;
+    std::unordered_map<const VarNode*, size_t> def_pos;
+    // The positions of the backward consumers and the other uses of each variable.
+    std::unordered_map<const VarNode*, std::vector<size_t>> saved_uses;
+    std::unordered_map<const VarNode*, std::vector<size_t>> other_uses;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      def_pos[vars[i].get()] = i;
+      if (const auto* func = exprs[i].as<FunctionNode>()) {
+        funcs[vars[i].get()] = func;
+        continue;
+      }
+      auto saved = GetSavedArgs(exprs[i], funcs);
+      for (const auto& var : FreeVars(exprs[i])) {
+        if (saved.count(var.get())) {
+          saved_uses[var.get()].push_back(i);
+        } else {
+          other_uses[var.get()].push_back(i);
+        }
+      }
+    }
+    // The return value is also a use in the forward.
+    for (const auto& var : FreeVars(ell->ret)) {
+      other_uses[var.get()].push_back(vars.size());
+    }
+
+    // Mapping from a position to the casts inserted after and before it.
+    std::unordered_map<size_t, std::vector<std::pair<Var, Expr>>> after;
+    std::unordered_map<size_t, std::vector<std::pair<Var, Expr>>> before;
+    // Mapping from a backward consumer position to the replaced activations.
+    std::unordered_map<size_t, Map<Var, Expr>> replace;
+    for (const auto& kv : saved_uses) {
+      const VarNode* var = kv.first;
+      if (!def_pos.count(var) || !IsFloat32Tensor(var)) {
+        continue;
+      }
+      size_t first_saved = kv.second.front();
+      size_t last_fwd = def_pos.at(var);
+      bool used_in_backward = false;
+      for (size_t pos : other_uses[var]) {
+        if (pos > first_saved) {
+          used_in_backward = true;
+          break;
+        }
+        last_fwd = std::max(last_fwd, pos);
+      }
+      if (used_in_backward || first_saved - last_fwd < 2) {
+        // The full precision copy is still needed, or is freed soon anyway.
+        continue;
+      }
+      Var orig = GetRef<Var>(var);
+      Var compressed = MakeVar(var->name_hint() + "_c", {});
+      Var decompressed = MakeVar(var->name_hint() + "_d", {});
+      after[last_fwd].emplace_back(compressed, Cast(orig, dtype_));
+      before[first_saved].emplace_back(decompressed, Cast(compressed, "float32"));
+      for (size_t pos : kv.second) {
+        replace[pos].Set(orig, decompressed);
+      }
+      ++num_compressed_;
+    }
+    if (num_compressed_ == 0) {
+      return GetRef<Function>(func_);
+    }
+
+    std::vector<Var> new_vars;
+    std::vector<Expr> new_exprs;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      for (const auto& binding : before[i]) {
+        new_vars.push_back(binding.first);
+        new_exprs.push_back(binding.second);
+      }
+      new_vars.push_back(vars[i]);
+      new_exprs.push_back(replace.count(i) ? Substitute(exprs[i], replace.at(i)) : exprs[i]);
+      for (const auto& binding : after[i]) {
+        new_vars.push_back(binding.first);
+        new_exprs.push_back(binding.second);
+      }
+    }
+    ell->vars = std::move(new_vars);
+    ell->exprs = std::move(new_exprs);
+    DLOG(INFO) << "Compressed " << num_compressed_ << " saved activations to " << dtype_;
+    return Function(func_->params, ell->AsExpr(), {}, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Get the variables passed to a call as the saved activations of a backward op. */
+  std::unordered_set<const VarNode*> GetSavedArgs(
+      const Expr& expr, const std::unordered_map<const VarNode*, const FunctionNode*>& funcs) {
+    std::unordered_set<const VarNode*> ret;
+    const auto* call = expr.as<CallNode>();
+    if (call == nullptr) {
+      return ret;
+    }
+    if (const auto* indices = GetSavedArgIndices(call)) {
+      for (int i : *indices) {
+        if (i < call->args.size() && call->args[i].as<VarNode>()) {
+          ret.insert(call->args[i].as<VarNode>());
+        }
+      }
+      return ret;
+    }
+    const FunctionNode* func = call->op.as<FunctionNode>();
+    if (const auto* var = call->op.as<VarNode>()) {
+      func = funcs.count(var) ? funcs.at(var) : nullptr;
+    }
+    if (func == nullptr) {
+      return ret;
+    }
+    for (size_t i : SavedParamCollector(func).saved_params) {
+      if (const auto* var = call->args[i].as<VarNode>()) {
+        ret.insert(var);
+      }
+    }
+    return ret;
+  }
+
+  static bool IsFloat32Tensor(const VarNode* var) {
+    if (!var->checked_type_.defined()) {
+      return false;
+    }
+    const auto* ttype = var->checked_type().as<TensorTypeNode>();
+    return ttype != nullptr && ttype->dtype == DataType::Float(32);
+  }
+
+  static Expr Cast(const Expr& data, const std::string& dtype) {
+    static const Op& cast_op = Op::Get("raf.op.cast");
+    return Call(cast_op, {data, MakeConstant(StringValue::make(dtype))});
+  }
+
+  /*! \brief The function to be transformed. */
+  const FunctionNode* func_;
+  /*! \brief The dtype to compress the activations to. */
+  std::string dtype_;
+  /*! \brief The number of compressed activations. */
+  int num_compressed_ = 0;
+};
+
+}  // namespace compress_activation
+
+Pass CompressActivation() {
+  PassContext pass_ctx = PassContext::Current();
+  String dtype = pass_ctx->GetConfig("raf.activation_compression", String("none")).value();
+  CHECK(dtype == "none" || dtype == "float16" || dtype == "bfloat16")
+      << "Unsupported activation compression: " << dtype
+      << ". Expected one of \"none\", \"float16\", and \"bfloat16\"";
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    if (dtype == "none") {
+      return f;
+    }
+    return compress_activation::ActivationCompressor(f.operator->(), dtype).Run();
+  };
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "CompressActivationHelper", {});
+  PassInfo pass_info(2, "CompressActivation", {});
+  return RAFSequential({InferType(), func_pass}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.CompressActivation").set_body_typed(CompressActivation);
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.activation_compression", String);
+
+}  // namespace pass
+}  // namespace raf
@@ -23,6 +23,10 @@
  * needed. The context of the input would be propagated from its other
  * consumers or fallback to the default device.
  *
+ * The ops that compute shape-related integer tensors, e.g., shape_as_tensor and size, only read
+ * the shape of their inputs as well. Their outputs are pinned to CPU, so that the shape
+ * computations and the control flow depending on them do not copy scalars from the device.
+ *
  * Another type of dialect is used fo memory allocation, namely, alloc_storage
  * and alloc_tensor. alloc_storage contains a context field to indicate where
  * the chunk of memory is allocated. Therefore, we unify the context of
@@ -38,6 +42,7 @@
 #include <raf/binding.h>
 #include <raf/ir.h>
 #include <raf/op.h>
+#include <raf/op_utils.h>
 #include <raf/pass.h>
 #include <raf/value.h>
 #include <tvm/relay/attrs/memory.h>
@@ -258,6 +263,9 @@ class ContextAnalyzer : public MixedModeVisitor {
 
     if (IsDeviceCopy(call)) {
       UnifyDeviceCopyCall(cn);
+    } else if (op::IsHostShapeOp(call->op)) {
+      UnifyHostShapeCall(cn->args, {call});
+      MixedModeVisitor::VisitExpr_(cn);
     } else if (call->op == alloc_storage_op) {
       UnifyAllocStorageCall(cn);
     } else if (call->op == alloc_tensor_op) {
@@ -289,6 +297,10 @@ class ContextAnalyzer : public MixedModeVisitor {
         closures_[let->var] = Downcast<GlobalVar>(gv);
       }
 
+      if (let->value->IsInstance<OpNode>()) {
+        bound_ops_[let->var] = let->value;
+      }
+
       // Unify let var, value, and body
       Unify(DeviceFor(let->var), DeviceFor(let->value));
       UnifyExpr(let, let->body);
@@ -484,10 +496,26 @@ class ContextAnalyzer : public MixedModeVisitor {
     CHECK_EQ(call->args.size(), 3U);
     Tuple inps = Downcast<Tuple>(call->args[1]);
     Tuple outputs = Downcast<Tuple>(call->args[2]);
-    UnifyCall(call->args[0], inps->fields, outputs->fields, Bottom());
+    auto op_it = bound_ops_.find(call->args[0]);
+    if (op::IsHostShapeOp(op_it != bound_ops_.end() ? op_it->second : call->args[0])) {
+      UnifyHostShapeCall(inps->fields, outputs->fields);
+    } else {
+      UnifyCall(call->args[0], inps->fields, outputs->fields, Bottom());
+    }
     MixedModeVisitor::VisitExpr_(call);
   }
 
+  // Pin the outputs of a host shape op to CPU. The inputs are not unified with the outputs, as
+  // only their shapes are read, which is similar to shape_of.
+  void UnifyHostShapeCall(const Array<Expr>& inps, const Array<Expr>& outputs) {
+    for (const auto& it : inps) {
+      DeviceFor(it);
+    }
+    for (const auto& it : outputs) {
+      Unify(DeviceFor(it), DeviceType(cpu_ctx_));
+    }
+  }
+
   void UnifyFunctionCall(const CallNode* call) {
     auto device = DeviceFor(GetRef<Call>(call));
     // Unify the arguments of the caller.
@@ -618,6 +646,8 @@ class ContextAnalyzer : public MixedModeVisitor {
    * will be invoked lazily.
    */
   std::unordered_map<Expr, GlobalVar, tvm::ObjectHash, tvm::ObjectEqual> closures_;
+  /* \brief The let-bound vars of ops, which are invoked by invoke_op. */
+  std::unordered_map<Expr, Expr, tvm::ObjectHash, tvm::ObjectEqual> bound_ops_;
 };
 
 }  // namespace context_analysis
@@ -0,0 +1,267 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file convert_layout.cc
+ * \brief Convert the NCHW conv2d regions to NHWC, which Tensor Cores run without internal
+ * transposes.
+ */
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace convert_layout {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+template <typename T>
+using VarMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
+
+/*! \brief The permutations between NCHW and NHWC. */
+const std::vector<int64_t> kToNHWC = {0, 2, 3, 1};
+const std::vector<int64_t> kToNCHW = {0, 3, 1, 2};
+
+/*!
+ * \brief Get the string of a constant argument.
+ * \param expr The argument.
+ * \param value The string value of the argument.
+ * \return Whether the argument is a constant string.
+ */
+inline bool GetStringArg(const Expr& expr, std::string* value) {
+  if (const auto* konst = expr.as<ConstantNode>()) {
+    if (const auto* str = ConstantExtractValue(GetRef<Constant>(konst)).as<StringValueObj>()) {
+      *value = str->value;
+      return true;
+    }
+    return false;
+  }
+  return false;
+}
+
+/*! \brief Whether the argument is a null constant, such as the omitted out of add. */
+inline bool IsNullArg(const Expr& expr) {
+  const auto* konst = expr.as<ConstantNode>();
+  return konst != nullptr && !ConstantExtractValue(GetRef<Constant>(konst)).defined();
+}
+
+/*! \brief The number of dimensions of a tensor argument, or -1 if it is not a tensor. */
+inline int GetNDim(const Expr& expr) {
+  if (const auto* ttype = expr->checked_type().as<TensorTypeNode>()) {
+    return ttype->shape.size();
+  }
+  return -1;
+}
+
+/*!
+ * \brief Convert the regions of an ANF function that start at the NCHW conv2d to NHWC.
+ *
+ * A region grows from a conv2d through the ops that are layout-agnostic (unary and binary
+ * elementwise ops), or that take the layout as an argument (pools and bias_add). The ops in a
+ * region take and produce NHWC tensors, and the NCHW tensors are only produced for the uses
+ * outside of the region, e.g., batch_norm or the backward ops. Those transposes are dead if all
+ * the uses are in the region, and are removed by the dead code elimination. For example:
+ *   let %a = raf.op.conv2d(%x, %w, 1, 1, 1, 1, "NCHW", "OIHW", "NCHW");
+ *   let %b = raf.op.relu(%a);
+ *   let %c = raf.op.batch_norm_infer(%b, ...);
+ *
+ * becomes:
+ *   let %x_0 = raf.op.transpose(%x, [0, 2, 3, 1]);
+ *   let %x_1 = raf.op.transpose(%w, [0, 2, 3, 1]);
+ *   let %x_2 = raf.op.conv2d(%x_0, %x_1, 1, 1, 1, 1, "NHWC", "OHWI", "NHWC");
+ *   let %x_3 = raf.op.relu(%x_2);
+ *   let %b = raf.op.transpose(%x_3, [0, 3, 1, 2]);
+ *   let %c = raf.op.batch_norm_infer(%b, ...);
+ */
+class LayoutConverter {
+ public:
+  explicit LayoutConverter(const Function& func) : func_(func) {
+  }
+
+  Function Run() {
+    if (!func_->body.as<LetNode>()) {
+      return func_;
+    }
+    ell_ = ExplicitLetList::make(func_->body);
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    bool changed = false;
+    LetList ll;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      Expr nhwc = ConvertCall(&ll, exprs[i]);
+      if (!nhwc.defined()) {
+        ll.Push(vars[i], exprs[i]);
+        continue;
+      }
+      changed = true;
+      auto nhwc_var = ll.Push(nhwc);
+      nhwc_[vars[i]] = nhwc_var;
+      ll.Push(vars[i], Transpose(nhwc_var, kToNCHW));
+    }
+    if (!changed) {
+      return func_;
+    }
+    Expr body = ll.Get(ell_->ret);
+    return Function(func_->params, body, func_->ret_type, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*!
+   * \brief Convert the call to NHWC if it is in a region.
+   * \return The NHWC call, or undefined if the call is not converted.
+   */
+  Expr ConvertCall(LetList* ll, const Expr& expr) {
+    static const Op& conv2d_op = Op::Get("raf.op.conv2d");
+    static const Op& bias_add_op = Op::Get("raf.op.bias_add");
+    static const std::unordered_set<std::string> unary_ops = {
+        "raf.op.relu", "raf.op.gelu", "raf.op.tanh", "raf.op.sigmoid", "raf.op.copy"};
+    static const std::unordered_set<std::string> binary_ops = {
+        "raf.op.add", "raf.op.subtract", "raf.op.multiply", "raf.op.divide"};
+    // The index of the layout argument.
+    static const std::unordered_map<std::string, int> pool_ops = {
+        {"raf.op.max_pool2d", 7},
+        {"raf.op.avg_pool2d", 7},
+        {"raf.op.adaptive_max_pool2d", 2},
+        {"raf.op.adaptive_avg_pool2d", 2}};
+
+    const auto* call = expr.as<CallNode>();
+    const auto* op_node = call ? call->op.as<OpNode>() : nullptr;
+    if (op_node == nullptr) {
+      return Expr();
+    }
+    const auto& op = GetRef<Op>(op_node);
+    const auto& args = call->args;
+    Array<Expr> new_args = args;
+
+    if (op == conv2d_op) {
+      std::string layout, kernel_layout, out_layout;
+      if (!GetStringArg(args[6], &layout) || !GetStringArg(args[7], &kernel_layout) ||
+          !GetStringArg(args[8], &out_layout) || layout != "NCHW" || kernel_layout != "OIHW" ||
+          out_layout != "NCHW" || GetNDim(args[0]) != 4 || GetNDim(args[1]) != 4) {
+        return Expr();
+      }
+      new_args.Set(0, GetNHWC(ll, args[0]));
+      // OIHW to OHWI is the same permutation as NCHW to NHWC.
+      new_args.Set(1, GetNHWC(ll, args[1]));
+      new_args.Set(6, MakeConstant(StringValue::make("NHWC")));
+      new_args.Set(7, MakeConstant(StringValue::make("OHWI")));
+      new_args.Set(8, MakeConstant(StringValue::make("NHWC")));
+    } else if (unary_ops.count(op_node->name)) {
+      if (!InRegion(args[0])) {
+        return Expr();
+      }
+      new_args.Set(0, nhwc_.at(Downcast<Var>(args[0])));
+    } else if (binary_ops.count(op_node->name)) {
+      // The optional out and where of add and subtract must be omitted.
+      for (size_t i = 2; i < args.size(); ++i) {
+        if (!IsNullArg(args[i])) {
+          return Expr();
+        }
+      }
+      if (!InRegion(args[0]) && !InRegion(args[1])) {
+        return Expr();
+      }
+      // Permuting both 4D operands keeps the broadcasting, but a lower-rank operand is
+      // broadcast to the trailing axes, which are permuted.
+      for (int i = 0; i < 2; ++i) {
+        int ndim = GetNDim(args[i]);
+        if (ndim != 4 && ndim != 0) {
+          return Expr();
+        }
+      }
+      for (int i = 0; i < 2; ++i) {
+        if (GetNDim(args[i]) == 4) {
+          new_args.Set(i, GetNHWC(ll, args[i]));
+        }
+      }
+    } else if (pool_ops.count(op_node->name)) {
+      int layout_idx = pool_ops.at(op_node->name);
+      std::string layout;
+      if (!InRegion(args[0]) || !GetStringArg(args[layout_idx], &layout) || layout != "NCHW") {
+        return Expr();
+      }
+      new_args.Set(0, nhwc_.at(Downcast<Var>(args[0])));
+      new_args.Set(layout_idx, MakeConstant(StringValue::make("NHWC")));
+    } else if (op == bias_add_op) {
+      const auto* axis = args[2].as<ConstantNode>();
+      if (!InRegion(args[0]) || axis == nullptr) {
+        return Expr();
+      }
+      auto axis_value = GetScalarValueData<int64_t>(ConstantExtractValue(GetRef<Constant>(axis)));
+      if (axis_value != 1 && axis_value != -3) {
+        return Expr();
+      }
+      new_args.Set(0, nhwc_.at(Downcast<Var>(args[0])));
+      new_args.Set(2, MakeConstant(ScalarValue::make(3)));
+    } else {
+      return Expr();
+    }
+    return Call(op, new_args, call->attrs, call->type_args);
+  }
+
+  /*! \brief Whether the argument is produced by a converted call. */
+  bool InRegion(const Expr& expr) const {
+    const auto* var = expr.as<VarNode>();
+    return var != nullptr && nhwc_.count(GetRef<Var>(var));
+  }
+
+  /*! \brief Get the NHWC version of the NCHW tensor, which is transposed if not in a region. */
+  Expr GetNHWC(LetList* ll, const Expr& expr) {
+    if (InRegion(expr)) {
+      return nhwc_.at(Downcast<Var>(expr));
+    }
+    if (const auto* var = expr.as<VarNode>()) {
+      auto it = transposed_.find(GetRef<Var>(var));
+      if (it != transposed_.end()) {
+        return it->second;
+      }
+      auto nhwc_var = ll->Push(Transpose(expr, kToNHWC));
+      transposed_[GetRef<Var>(var)] = nhwc_var;
+      return nhwc_var;
+    }
+    return ll->Push(Transpose(expr, kToNHWC));
+  }
+
+  static Expr Transpose(const Expr& x, const std::vector<int64_t>& axes) {
+    static const Op& transpose_op = Op::Get("raf.op.transpose");
+    return Call(transpose_op, {x, MakeConstant(ArrayToIntTuple(axes))});
+  }
+
+  /*! \brief The function to be converted. */
+  Function func_;
+  /*! \brief The let list of the function body. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The mapping from the outputs of the converted calls to their NHWC versions. */
+  VarMap<Var> nhwc_;
+  /*! \brief The NHWC transposes of the tensors outside of the regions, so each is made once. */
+  VarMap<Var> transposed_;
+};
+
+}  // namespace convert_layout
+
+Pass ConvertLayout() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return convert_layout::LayoutConverter(f).Run();
+      };
+  auto convert_layout_pass = CreateRAFFunctionPass(pass_func, 1, "ConvertLayoutHelper", {});
+  return RAFSequential({InferType(), convert_layout_pass, InferType(), DeadCodeElimination()},
+                       "ConvertLayout");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.ConvertLayout").set_body_typed(ConvertLayout);
+
+}  // namespace pass
+}  // namespace raf
@@ -7,13 +7,18 @@
  * \file data_parallel.cc
  * \brief Data Parallel pass
  */
+#include <algorithm>
+#include <numeric>
 #include <set>
 #include <sstream>
 #include "raf/op.h"
+#include "raf/op_utils.h"
 #include "raf/ir.h"
 #include "raf/pass.h"
+#include "raf/comm_cost_model.h"
 #include "raf/communicator.h"
 #include "raf/dist_config.h"
+#include "raf/op_profiler.h"
 #include "raf/profiler.h"
 #include "raf/stream_pool.h"
 #include "./common.h"
@@ -35,6 +40,178 @@ using raf::distributed::DistConfig;
 using raf::value::NoGradValue;
 using stream_pool::StreamTagEnum;
 
+/*!
+ * \brief The running time of an allreduce of n elements and b bytes, which is modeled as alpha +
+ * beta_elem * n + beta_byte * b.
+ */
+struct AllreduceCost {
+  /*! \brief The fixed latency. */
+  double alpha = 0;
+  /*! \brief The latency per element. */
+  double beta_elem = 0;
+  /*! \brief The latency per byte. */
+  double beta_byte = 0;
+};
+
+/*!
+ * \brief Get the numbers of elements and the communicated bytes of the local gradients. The bytes
+ * are in the compressed dtype if the gradient compression is enabled.
+ * \param grad_types The types of the local gradients in the backward order.
+ * \param compress_dtype The dtype of the gradient compression, or "none".
+ * \param grad_sizes The numbers of elements.
+ * \param grad_bytes The communicated bytes.
+ * \return Whether all the gradients have static shapes. Both outputs are left empty otherwise.
+ */
+bool GetGradSizes(const std::vector<Type>& grad_types, const std::string& compress_dtype,
+                  std::vector<int64_t>* grad_sizes, std::vector<int64_t>* grad_bytes) {
+  grad_sizes->clear();
+  grad_bytes->clear();
+  for (const auto& type : grad_types) {
+    const auto* tt = type.as<TensorTypeNode>();
+    if (tt == nullptr) {
+      grad_sizes->clear();
+      grad_bytes->clear();
+      return false;
+    }
+    int64_t numel = 1;
+    for (const auto& dim : tt->shape) {
+      const auto* dim_imm = dim.as<IntImmNode>();
+      if (dim_imm == nullptr) {
+        grad_sizes->clear();
+        grad_bytes->clear();
+        return false;
+      }
+      numel *= dim_imm->value;
+    }
+    DataType dtype = tt->dtype;
+    if (compress_dtype != "none" && dtype == DataType::Float(32)) {
+      dtype = DataType(tvm::runtime::String2DLDataType(compress_dtype));
+    }
+    grad_sizes->push_back(numel);
+    grad_bytes->push_back(numel * ((dtype.bits() * dtype.lanes() + 7) / 8));
+  }
+  return true;
+}
+
+/*!
+ * \brief Fit the running time of an allreduce of n elements as alpha + beta * n with least
+ * squares. Both are clamped to be non-negative.
+ * \param grad_sizes The numbers of elements of the allreduces.
+ * \param comm_time The running time of the allreduces.
+ * \return The fitted cost.
+ */
+AllreduceCost FitAllreduceCost(const std::vector<int64_t>& grad_sizes,
+                               const std::vector<double>& comm_time) {
+  CHECK_EQ(grad_sizes.size(), comm_time.size());
+  AllreduceCost cost;
+  size_t n = grad_sizes.size();
+  if (n == 0) {
+    return cost;
+  }
+  double mean_size = 0, mean_time = 0;
+  for (size_t i = 0; i < n; ++i) {
+    mean_size += grad_sizes[i];
+    mean_time += comm_time[i];
+  }
+  mean_size /= n;
+  mean_time /= n;
+  double cov = 0, var = 0;
+  for (size_t i = 0; i < n; ++i) {
+    cov += (grad_sizes[i] - mean_size) * (comm_time[i] - mean_time);
+    var += (grad_sizes[i] - mean_size) * (grad_sizes[i] - mean_size);
+  }
+  cost.beta_elem = var > 0 ? std::max(cov / var, 0.0) : 0.0;
+  cost.alpha = std::max(mean_time - cost.beta_elem * mean_size, 0.0);
+  return cost;
+}
+
+/*!
+ * \brief Search the maximum number of elements in a gradient allreduce bucket.
+ *
+ * For each power-of-two bucket size, the bucketing in DataParallelSchedule is simulated: the
+ * gradients are put into buckets in the backward order, and a bucket is launched on the
+ * communication stream once it is full, or at the end of the backward pass otherwise. The bucket
+ * size that minimizes the communication time exposed after the last computation op is taken, and
+ * the larger one is preferred on ties since it launches fewer collectives.
+ * \param ready_time The time when each gradient is ready.
+ * \param comp_time The end time of the backward computation.
+ * \param grad_sizes The numbers of elements of the local gradients in the backward order.
+ * \param grad_bytes The communicated bytes of the local gradients in the backward order.
+ * \param cost The running time of an allreduce.
+ * \return The bucket size, or 0 if there is no gradient or the inputs do not match.
+ */
+int64_t SearchBucketSize(const std::vector<double>& ready_time, double comp_time,
+                         const std::vector<int64_t>& grad_sizes,
+                         const std::vector<int64_t>& grad_bytes, const AllreduceCost& cost) {
+  size_t n = grad_sizes.size();
+  if (n == 0 || ready_time.size() != n || grad_bytes.size() != n) {
+    return 0;
+  }
+  auto simulate = [&](int64_t bucket_size) {
+    double comm_end = 0;
+    int64_t curr_size = 0, curr_bytes = 0;
+    for (size_t i = 0; i < n; ++i) {
+      curr_size += grad_sizes[i];
+      curr_bytes += grad_bytes[i];
+      if (curr_size >= bucket_size || i + 1 == n) {
+        double launch_time = curr_size >= bucket_size ? ready_time[i] : comp_time;
+        comm_end = std::max(comm_end, launch_time) + cost.alpha + cost.beta_elem * curr_size +
+                   cost.beta_byte * curr_bytes;
+        curr_size = 0;
+        curr_bytes = 0;
+      }
+    }
+    return std::max(comm_end - comp_time, 0.0);
+  };
+
+  int64_t total_size = std::accumulate(grad_sizes.begin(), grad_sizes.end(), int64_t(0));
+  int64_t best_size = 1;
+  double best_exposed = simulate(best_size);
+  for (int64_t bucket_size = 2; bucket_size < total_size * 2; bucket_size *= 2) {
+    double exposed = simulate(bucket_size);
+    if (exposed <= best_exposed) {
+      best_exposed = exposed;
+      best_size = bucket_size;
+    }
+  }
+  return best_size;
+}
+
+/*!
+ * \brief Search the bucket size with the profiled op running time. The allreduce time is from
+ * the calibrated cost if given, otherwise it is fitted from the profiled allreduces.
+ * \param op_durations The profiled running time of the ops in the execution order, which is
+ * negative for the communication ops.
+ * \param num_iters The number of iterations the running time is accumulated over.
+ * \param grad_sizes The numbers of elements of the local gradients in the backward order, which
+ * is empty if any gradient has a dynamic shape.
+ * \param grad_bytes The communicated bytes of the local gradients in the backward order.
+ * \param calibrated The calibrated allreduce cost, or null.
+ * \return The bucket size, or 0 if the tuning is skipped, i.e., a gradient has a dynamic shape or
+ * the profiled allreduces cannot be matched with the gradients.
+ */
+int64_t SearchBucketSizeFromProfile(const std::vector<int64_t>& op_durations, int num_iters,
+                                    const std::vector<int64_t>& grad_sizes,
+                                    const std::vector<int64_t>& grad_bytes,
+                                    const AllreduceCost* calibrated) {
+  // The time when each gradient is ready, and the running time of its allreduce.
+  std::vector<double> ready_time, comm_time;
+  double comp_time = 0;
+  for (int64_t duration : op_durations) {
+    if (duration >= 0) {
+      comp_time += static_cast<double>(duration) / num_iters;
+    } else {
+      ready_time.push_back(comp_time);
+      comm_time.push_back(static_cast<double>(-duration) / num_iters);
+    }
+  }
+  if (grad_sizes.empty() || ready_time.size() != grad_sizes.size()) {
+    return 0;
+  }
+  AllreduceCost cost = calibrated ? *calibrated : FitAllreduceCost(grad_sizes, comm_time);
+  return SearchBucketSize(ready_time, comp_time, grad_sizes, grad_bytes, cost);
+}
+
 struct DataParallel {
   /* =================================================================
   Description:
@@ -42,6 +219,9 @@ struct DataParallel {
       1) adding communication op after the op which generate the local gradient.
       2) update the returned gradient from local gradient to aggregated global gradient.
       3) adding a stream_sync op before the end of backward closure to ensure communication is done.
+      The gradient of an embedding produced by embedding_dx is aggregated by allgathering its
+      distinct rows and values instead, if that sends fewer bytes than the allreduce (see
+      UseSparseGrad). It can be disabled by "raf.data_parallel.sparse_embedding_grad".
   Example:
         Backward closure before DataParallel Pass:
         ```
@@ -135,16 +315,20 @@ struct DataParallel {
         ```
    */
  public:
-  explicit DataParallel(const FunctionNode* func)
-      : func(func), fp_ell(ExplicitLetList::make(func->body)) {
+  DataParallel(const FunctionNode* func, const Array<Bool>& local_grads)
+      : func(func), local_grads(local_grads), fp_ell(ExplicitLetList::make(func->body)) {
   }
 
   // Compute the dcfg->scheduling_param according to the analysis of op profiling.
-  void GetSchedulingParameters() {
+  // grad_sizes and grad_bytes are the numbers of elements and the communicated bytes of the local
+  // gradients in the backward order, which are used to tune dcfg->group_bucket_size.
+  void GetSchedulingParameters(const std::vector<int64_t>& grad_sizes,
+                               const std::vector<int64_t>& grad_bytes) {
     auto dcfg = DistConfig::Global();
     static int prof_level = Profiler::Get()->profile_level();  // Store user's config
-    // Store the running time of all ops.
+    // Store the running time of all ops, accumulated over num_profiled iterations.
     static std::vector<std::pair<std::string, int64_t> > op_running_time;
+    static int num_profiled = 0;
     if (dcfg->iteration < dcfg->auto_dp_profiling_start_iter) {
       Profiler::Get()->GetProfileStats();
       Profiler::Get()->ClearProfile();
@@ -164,6 +348,7 @@ struct DataParallel {
             }
           }
         }
+        num_profiled = 1;
         Profiler::Get()->ClearProfile();
       } else {
         int op_count = 0;
@@ -176,6 +361,7 @@ struct DataParallel {
             op_count++;
           }
         }
+        num_profiled++;
         Profiler::Get()->ClearProfile();
       }
     } else if (dcfg->iteration == dcfg->auto_dp_profiling_end_iter + 1) {
@@ -206,6 +392,7 @@ struct DataParallel {
       }
       // Currently we only have one scheduling parameter, set it here.
       dcfg->scheduling_param = bp_order_grad_count;
+      TuneBucketSize(op_running_time, std::max(num_profiled, 1), grad_sizes, grad_bytes);
 
       // clear the cached profiling analysis.
       op_running_time.clear();
@@ -216,11 +403,6 @@ struct DataParallel {
     auto dcfg = DistConfig::Global();
     auto comm = GetGlobalCommunicator();
 
-    // If we want to overlap communication and forward pass,
-    // we need to analyze the running time of Ops
-    if (dcfg->iteration <= dcfg->auto_dp_profiling_end_iter + 1) {
-      GetSchedulingParameters();
-    }
     size_t fp_n = fp_ell->vars.size();
     auto closure_expr = fp_ell->exprs.at(fp_n - 2);
     Array<Var> bp_params;
@@ -232,95 +414,90 @@ struct DataParallel {
     auto bp_grads = bp_ell->exprs.at(bp_n - 1);
     std::set<const VarNode*> gradset;  // All the gradients that returned by backward IR.
     if (const auto* tuple = bp_grads.as<TupleNode>()) {
-      for (auto g : tuple->fields) {
-        if (const auto* var = g.as<VarNode>()) {
+      for (size_t i = 0; i < tuple->fields.size(); ++i) {
+        // The gradients of the partitioned parameters are complete on their own ranks.
+        if (i < local_grads.size() && local_grads[i]) {
+          continue;
+        }
+        if (const auto* var = tuple->fields[i].as<VarNode>()) {
           gradset.insert(var);
         }
       }
     } else if (const auto* var = bp_grads.as<VarNode>()) {
-      gradset.insert(var);
+      if (local_grads.empty() || !local_grads[0]) {
+        gradset.insert(var);
+      }
     } else {
       LOG(FATAL) << "Return of backward IR must be Var or tuple of Vars in Data Parallel Pass.";
     }
-    if (gradset.empty()) {
+    // The embedding gradients that are aggregated sparsely instead of by allreduce.
+    std::set<const VarNode*> sparse_grads;
+    for (size_t i = 0; i + 1 < bp_n; ++i) {
+      if (gradset.count(bp_ell->vars[i].operator->()) &&
+          UseSparseGrad(bp_ell->vars[i], bp_ell->exprs[i], comm->size)) {
+        sparse_grads.insert(bp_ell->vars[i].operator->());
+        gradset.erase(bp_ell->vars[i].operator->());
+      }
+    }
+    // The vars that are used by the backward bindings other than the returned gradients.
+    std::unordered_set<const VarNode*> used_vars;
+    for (size_t i = 0; i + 1 < bp_n; ++i) {
+      for (const auto& var : FreeVars(bp_ell->exprs[i])) {
+        used_vars.insert(var.operator->());
+      }
+    }
+    // If we want to overlap communication and forward pass,
+    // we need to analyze the running time of Ops
+    std::vector<int64_t> grad_sizes, grad_bytes;
+    GetGradSizes(gradset, &grad_sizes, &grad_bytes);
+    if (dcfg->iteration <= dcfg->auto_dp_profiling_end_iter + 1) {
+      GetSchedulingParameters(grad_sizes, grad_bytes);
+    }
+    auto pass_ctx = tvm::transform::PassContext::Current();
+    if (!dcfg->enable_auto_dp_profiling &&
+        pass_ctx->GetConfig<Bool>("raf.data_parallel.tune_bucket_size", Bool(false)).value()) {
+      EstimateBucketSize(gradset, grad_sizes, grad_bytes);
+    }
+    if (gradset.empty() && sparse_grads.empty()) {
       return Function(func->params, fp_ell->AsExpr(), {}, {});
     }
     // The map from original local gradient to aggregated global gradient.
     std::map<raf::ir::Expr, raf::ir::Var> var_var_map;
-    // Enlarge the size of bp_ell to fit the allreduce ops.
-    // p1 tracks the processing var/expr (from end to begin)
-    // p2 tracks the next vacant position to paste the processing var/expr or allreduce op.
-    int p1 = bp_n - 1;
-    // If NCCL version is 2.10+, then average allreduce is going to be inserted
-    // otherwise, a sum allreduce is used and then a divied op is followed
-    // So for NCCL version less than 2.10, the let list size is one more item(i.e. divide op)
-    // for each gradient
-
-#if defined RAF_USE_NCCL && NCCL_VERSION_CODE >= 21000
-    bp_ell->vars.resize(bp_n + 2 * gradset.size());
-    bp_ell->exprs.resize(bp_n + 2 * gradset.size());
-    int p2 = bp_n - 1 + 2 * gradset.size();
-#else
-    bp_ell->vars.resize(bp_n + 3 * gradset.size());
-    bp_ell->exprs.resize(bp_n + 3 * gradset.size());
-    int p2 = bp_n - 1 + 3 * gradset.size();
-#endif
-
-    bp_ell->vars[p2] = bp_ell->vars[p1];
-    bp_ell->exprs[p2] = bp_ell->exprs[p1];
-    --p2;
-    --p1;
-
-    for (int i = p1; i >= 0; --i) {
+    // Rebuild the let list with the allreduce ops inserted right after the local gradients. The
+    // last binding is the returned gradient tuple, which is updated later.
+    std::vector<Var> new_vars;
+    std::vector<Expr> new_exprs;
+    for (size_t i = 0; i + 1 < bp_n; ++i) {
+      if (sparse_grads.count(bp_ell->vars[i].operator->())) {
+        // The dense local gradient is dropped unless it is used by other ops.
+        if (used_vars.count(bp_ell->vars[i].operator->())) {
+          new_vars.push_back(bp_ell->vars[i]);
+          new_exprs.push_back(bp_ell->exprs[i]);
+        }
+        auto global_grad = EmitSparseAllgather(bp_ell->exprs[i].as<CallNode>(), comm->size,
+                                               &new_vars, &new_exprs);
+        var_var_map.insert({bp_ell->vars[i], global_grad});
+        continue;
+      }
+      new_vars.push_back(bp_ell->vars[i]);
+      new_exprs.push_back(bp_ell->exprs[i]);
       if (gradset.find(bp_ell->vars[i].operator->()) != gradset.end()) {
         // If the current expr is an op-expr which generate local gradient,
         // we should add a allreduce op after it.
-        static Op op_allreduce = Op::Get("raf.op._allreduce");
-        auto input_var = raf::ir::MakeVar("allreduce_in", {});
-        auto rank_list = MakeConstant(NullValue<Value>());
-
-#if defined RAF_USE_NCCL && NCCL_VERSION_CODE >= 21000
-        bp_ell->vars[p2 - 1] = input_var;
-        bp_ell->exprs[p2 - 1] = Tuple({bp_ell->vars[i]});
-        // Here we name the var as 'g'(global gradient), to help us identify it easier.
-        bp_ell->vars[p2] = raf::ir::MakeVar("g", {});
-        bp_ell->exprs[p2] = Call(op_allreduce, {bp_ell->vars[p2 - 1],
-                                                MakeConstant(StringValue::make("avg")), rank_list});
-        var_var_map.insert({bp_ell->vars[i], bp_ell->vars[p2]});
-        p2 -= 2;
-#else
-        static Op op_div = Op::Get("raf.op.divide");
-        bp_ell->vars[p2 - 2] = input_var;
-        bp_ell->exprs[p2 - 2] = Tuple({bp_ell->vars[i]});
-        bp_ell->vars[p2 - 1] = raf::ir::MakeVar("g_sum", {});
-        bp_ell->exprs[p2 - 1] =
-            Call(op_allreduce,
-                 {bp_ell->vars[p2 - 2], MakeConstant(StringValue::make("sum")), rank_list});
-        bp_ell->vars[p2] = raf::ir::MakeVar("g", {});
-        auto tt = bp_ell->vars[i]->checked_type().as<TensorTypeNode>();
-        if (tt->dtype.code() == kDLFloat) {
-          bp_ell->exprs[p2] = Call(
-              op_div, {bp_ell->vars[p2 - 1], MakeConstant(ScalarValue::make(float(comm->size)))});
-        } else if (tt->dtype.code() == kDLInt) {
-          bp_ell->exprs[p2] = Call(
-              op_div, {bp_ell->vars[p2 - 1], MakeConstant(ScalarValue::make(int64_t(comm->size)))});
-        } else {
-          LOG(FATAL) << "Do not support type other than KDLFloat  and KDLInt. \n";
-        }
-        var_var_map.insert({bp_ell->vars[i], bp_ell->vars[p2]});
-        p2 -= 3;
-#endif
+        auto global_grad = EmitAllreduce(bp_ell->vars[i], comm->size, &new_vars, &new_exprs);
+        var_var_map.insert({bp_ell->vars[i], global_grad});
       }
-      bp_ell->vars[p2] = bp_ell->vars[i];
-      bp_ell->exprs[p2] = bp_ell->exprs[i];
-      --p2;
     }
+    new_vars.push_back(bp_ell->vars[bp_n - 1]);
+    new_exprs.push_back(bp_ell->exprs[bp_n - 1]);
+    bp_ell->vars = std::move(new_vars);
+    bp_ell->exprs = std::move(new_exprs);
 
     Array<Expr> new_bp_rt;
     if (const auto* tuple = bp_grads.as<TupleNode>()) {
       for (int i = 0; i < tuple->fields.size(); ++i) {
-        if (tuple->fields[i]->IsInstance<VarNode>()) {
-          auto it = var_var_map.find(tuple->fields[i]);
+        auto it = var_var_map.find(tuple->fields[i]);
+        if (it != var_var_map.end()) {
           new_bp_rt.push_back(it->second);
         } else {
           new_bp_rt.push_back(tuple->fields[i]);
@@ -328,7 +505,7 @@ struct DataParallel {
       }
     } else if (bp_grads->IsInstance<VarNode>()) {
       auto it = var_var_map.find(bp_grads);
-      new_bp_rt.push_back(it->second);
+      new_bp_rt.push_back(it != var_var_map.end() ? it->second : Downcast<Var>(bp_grads));
     } else {
       LOG(FATAL) << "Return of backward IR must be Var or tuple of Vars in Data Parallel Pass.";
     }
@@ -348,9 +525,262 @@ struct DataParallel {
     return Function(func->params, fp_ell->AsExpr(), {}, {});
   }
 
+  /*!
+   * \brief Get the numbers of elements and the communicated bytes of the local gradients in the
+   * backward order. Both are left empty if any gradient has a dynamic shape.
+   * \param gradset The local gradients.
+   * \param grad_sizes The numbers of elements.
+   * \param grad_bytes The communicated bytes.
+   */
+  void GetGradSizes(const std::set<const VarNode*>& gradset, std::vector<int64_t>* grad_sizes,
+                    std::vector<int64_t>* grad_bytes) {
+    std::vector<Type> grad_types;
+    for (const auto& var : bp_ell->vars) {
+      if (gradset.find(var.operator->()) != gradset.end()) {
+        grad_types.push_back(var->checked_type_);
+      }
+    }
+    data_parallel::GetGradSizes(grad_types, DistConfig::Global()->gradient_compression,
+                                grad_sizes, grad_bytes);
+  }
+
+  /*!
+   * \brief Tune dcfg->group_bucket_size at compile time without profiling, where the computation
+   * time of the backward ops is estimated by the analytical cost model and the allreduce time by
+   * the calibrated CommCostModel. It does nothing if the allreduce is not calibrated.
+   * \param gradset The local gradients.
+   * \param grad_sizes The numbers of elements of the local gradients in the backward order.
+   * \param grad_bytes The communicated bytes of the local gradients in the backward order.
+   */
+  void EstimateBucketSize(const std::set<const VarNode*>& gradset,
+                          const std::vector<int64_t>& grad_sizes,
+                          const std::vector<int64_t>& grad_bytes) {
+    distributed::CommCost cost;
+    if (!distributed::CommCostModel::Get()->Find("raf.op._allreduce", "global", &cost)) {
+      LOG(WARNING) << "The allreduce is not calibrated. Skip tuning the bucket size.";
+      return;
+    }
+    auto device = Device::Current();
+    if (device.device_type() != DevType::kCUDA() && device.device_type() != DevType::kCPU()) {
+      LOG(WARNING) << "Target device is undefined. Skip tuning the bucket size.";
+      return;
+    }
+    auto profiler = op_profiler::AnalyticalOpProfiler::Get(device);
+    std::vector<double> ready_time;
+    double comp_time = 0;
+    for (size_t i = 0; i + 1 < bp_ell->vars.size(); ++i) {
+      const auto& expr = bp_ell->exprs[i];
+      if (expr->IsInstance<CallNode>() && expr->checked_type_.defined()) {
+        comp_time += profiler->ProfileOp(expr, 0, 0, 1).first[0];
+      }
+      if (gradset.find(bp_ell->vars[i].operator->()) != gradset.end()) {
+        ready_time.push_back(comp_time);
+      }
+    }
+    AllreduceCost allreduce_cost;
+    allreduce_cost.alpha = cost.alpha_us;
+    allreduce_cost.beta_byte = cost.beta_us_per_byte;
+    SetBucketSize(SearchBucketSize(ready_time, comp_time, grad_sizes, grad_bytes, allreduce_cost));
+  }
+
+  /*!
+   * \brief Tune dcfg->group_bucket_size with the profiled op running time. The allreduce time is
+   * from the calibrated CommCostModel if available, otherwise the running time of an allreduce of
+   * n elements is fitted as alpha + beta * n from the profiled allreduces.
+   * \param op_running_time The profiled running time of ops, which is negative for the
+   * communication ops.
+   * \param num_iters The number of iterations the running time is accumulated over.
+   * \param grad_sizes The numbers of elements of the local gradients in the backward order.
+   * \param grad_bytes The communicated bytes of the local gradients in the backward order.
+   */
+  void TuneBucketSize(const std::vector<std::pair<std::string, int64_t> >& op_running_time,
+                      int num_iters, const std::vector<int64_t>& grad_sizes,
+                      const std::vector<int64_t>& grad_bytes) {
+    std::vector<int64_t> op_durations;
+    for (const auto& it : op_running_time) {
+      op_durations.push_back(it.second);
+    }
+    distributed::CommCost cost;
+    AllreduceCost calibrated;
+    bool is_calibrated =
+        distributed::CommCostModel::Get()->Find("raf.op._allreduce", "global", &cost);
+    if (is_calibrated) {
+      calibrated.alpha = cost.alpha_us;
+      calibrated.beta_byte = cost.beta_us_per_byte;
+    }
+    SetBucketSize(SearchBucketSizeFromProfile(op_durations, num_iters, grad_sizes, grad_bytes,
+                                              is_calibrated ? &calibrated : nullptr));
+  }
+
+  /*!
+   * \brief Set dcfg->group_bucket_size to the tuned bucket size and enable the bucketing, so the
+   * next compilation uses it. Note that group_bucket_size is also the bucket size of
+   * GroupAllgather.
+   * \param bucket_size The tuned bucket size. 0 means the tuning is skipped.
+   */
+  void SetBucketSize(int64_t bucket_size) {
+    if (bucket_size <= 0) {
+      return;
+    }
+    auto dcfg = DistConfig::Global();
+    dcfg->group_bucket_size = bucket_size;
+    dcfg->enable_allreduce_bucketing = true;
+    DLOG(INFO) << "Tuned the allreduce bucket size to " << bucket_size << " elements";
+  }
+
+  /*!
+   * \brief Check whether a local gradient is the embedding_dx of a static shape, whose sparse
+   * aggregation communicates fewer bytes than the allreduce. Each rank allgathers the rows and
+   * the values of the n indices, i.e., world_size * n * (8 + row_bytes) bytes, while a ring
+   * allreduce of the dense gradient of V rows sends about 2 * V * row_bytes bytes.
+   * \param grad The local gradient.
+   * \param expr The expr bound to the local gradient.
+   * \param world_size The number of ranks.
+   * \return Whether to aggregate the gradient sparsely.
+   */
+  bool UseSparseGrad(const Var& grad, const Expr& expr, int64_t world_size) {
+    static Op op_embedding_dx = Op::Get("raf.op.embedding_dx");
+    auto pass_ctx = tvm::transform::PassContext::Current();
+    if (!pass_ctx->GetConfig<Bool>("raf.data_parallel.sparse_embedding_grad", Bool(true))
+             .value()) {
+      return false;
+    }
+    const auto* call = expr.as<CallNode>();
+    if (call == nullptr || !call->op.same_as(op_embedding_dx)) {
+      return false;
+    }
+    auto get_numel = [](const Type& type, int64_t* numel) {
+      const auto* tt = type.as<TensorTypeNode>();
+      if (tt == nullptr) {
+        return false;
+      }
+      *numel = 1;
+      for (const auto& dim : tt->shape) {
+        const auto* dim_imm = dim.as<IntImmNode>();
+        if (dim_imm == nullptr) {
+          return false;
+        }
+        *numel *= dim_imm->value;
+      }
+      return true;
+    };
+    int64_t num_indices, numel;
+    if (!get_numel(call->args[1]->checked_type_, &num_indices) ||
+        !get_numel(grad->checked_type_, &numel)) {
+      return false;
+    }
+    const auto* tt = grad->checked_type_.as<TensorTypeNode>();
+    if (tt->dtype.code() != kDLFloat || numel == 0) {
+      return false;
+    }
+    int64_t num_rows = tt->shape[0].as<IntImmNode>()->value;
+    int64_t row_bytes = numel / num_rows * ((tt->dtype.bits() + 7) / 8);
+    return world_size * num_indices * (8 + row_bytes) < 2 * num_rows * row_bytes;
+  }
+
+  /*!
+   * \brief Emit the ops that aggregate the gradient of embedding_dx(dy, indices, num_weight)
+   * sparsely. The distinct rows of the local gradient and their values are computed by
+   * embedding_dx_sparse and allgathered, and are then coalesced into the dense gradient by
+   * embedding_dx on the device and averaged. The padded rows of -1 are redirected to row 0, whose
+   * values are zeros.
+   * \param call The embedding_dx call of the local gradient.
+   * \param world_size The number of ranks to average the gradient over.
+   * \param vars The let binding vars to append to.
+   * \param exprs The let binding exprs to append to.
+   * \return The var of the aggregated global gradient.
+   */
+  Var EmitSparseAllgather(const CallNode* call, int64_t world_size, std::vector<Var>* vars,
+                          std::vector<Expr>* exprs) {
+    static Op op_sparse = Op::Get("raf.op.embedding_dx_sparse");
+    static Op op_embedding_dx = Op::Get("raf.op.embedding_dx");
+    static Op op_maximum = Op::Get("raf.op.maximum");
+    static Op op_allgather = Op::Get("raf.op._allgather");
+    static Op op_div = Op::Get("raf.op.divide");
+    auto push = [&](const std::string& name, const Expr& expr) {
+      vars->push_back(raf::ir::MakeVar(name, {}));
+      exprs->push_back(expr);
+      return vars->back();
+    };
+    const Expr& num_weight = call->args[2];
+    auto axis = MakeConstant(ScalarValue::make(0));
+    auto rank_list = MakeConstant(NullValue<Value>());
+    Var sparse = push("sparse_grad", Call(op_sparse, call->args));
+    Var rows = push("sparse_rows", TupleGetItem(sparse, 0));
+    Var values = push("sparse_values", TupleGetItem(sparse, 1));
+    auto zero = MakeConstant(ScalarValue::make(int64_t(0)));
+    rows = push("sparse_rows_padded", Call(op_maximum, {rows, zero}));
+    Var all_rows = push("g_rows", Call(op_allgather, {rows, axis, rank_list}));
+    Var all_values = push("g_values", Call(op_allgather, {values, axis, rank_list}));
+    Var grad_sum = push("g_sum", Call(op_embedding_dx, {all_values, all_rows, num_weight}));
+    auto deno = MakeConstant(ScalarValue::make(float(world_size)));
+    return push("g", Call(op_div, {grad_sum, deno}));
+  }
+
+  /*!
+   * \brief Emit the ops that aggregate a local gradient. If the gradient compression is enabled in
+   * DistConfig, a float32 gradient is cast to the compressed dtype before the allreduce and cast
+   * back afterwards, which halves the communicated bytes. If NCCL version is 2.10+, then average
+   * allreduce is going to be inserted, otherwise, a sum allreduce is used and then a divide op is
+   * followed.
+   * \param grad The local gradient.
+   * \param world_size The number of ranks to average the gradient over.
+   * \param vars The let binding vars to append to.
+   * \param exprs The let binding exprs to append to.
+   * \return The var of the aggregated global gradient.
+   */
+  Var EmitAllreduce(const Var& grad, int64_t world_size, std::vector<Var>* vars,
+                    std::vector<Expr>* exprs) {
+    static Op op_allreduce = Op::Get("raf.op._allreduce");
+    static Op op_cast = Op::Get("raf.op.cast");
+    auto push = [&](const std::string& name, const Expr& expr) {
+      vars->push_back(raf::ir::MakeVar(name, {}));
+      exprs->push_back(expr);
+      return vars->back();
+    };
+    auto tt = grad->checked_type().as<TensorTypeNode>();
+    std::string compress_dtype = DistConfig::Global()->gradient_compression;
+    bool compress = compress_dtype != "none" && tt && tt->dtype == DataType::Float(32);
+
+    Var local_grad = grad;
+    if (compress) {
+      auto dtype = MakeConstant(StringValue::make(compress_dtype));
+      local_grad = push("compress_in", Call(op_cast, {grad, dtype}));
+    }
+    auto input_var = push("allreduce_in", Tuple({local_grad}));
+    auto rank_list = MakeConstant(NullValue<Value>());
+    // Here we name the var as 'g'(global gradient), to help us identify it easier.
+    std::string global_name = compress ? "g_compressed" : "g";
+#if defined RAF_USE_NCCL && NCCL_VERSION_CODE >= 21000
+    auto computation = MakeConstant(StringValue::make("avg"));
+    Var global_grad = push(global_name, Call(op_allreduce, {input_var, computation, rank_list}));
+#else
+    static Op op_div = Op::Get("raf.op.divide");
+    auto computation = MakeConstant(StringValue::make("sum"));
+    Var grad_sum = push("g_sum", Call(op_allreduce, {input_var, computation, rank_list}));
+    Var global_grad;
+    if (tt->dtype.code() == kDLFloat) {
+      auto deno = MakeConstant(ScalarValue::make(float(world_size)));
+      global_grad = push(global_name, Call(op_div, {grad_sum, deno}));
+    } else if (tt->dtype.code() == kDLInt) {
+      auto deno = MakeConstant(ScalarValue::make(int64_t(world_size)));
+      global_grad = push(global_name, Call(op_div, {grad_sum, deno}));
+    } else {
+      LOG(FATAL) << "Do not support type other than KDLFloat  and KDLInt. \n";
+    }
+#endif
+    if (compress) {
+      auto dtype = MakeConstant(StringValue::make("float32"));
+      global_grad = push("g", Call(op_cast, {global_grad, dtype}));
+    }
+    return global_grad;
+  }
+
  private:
   // initialized in constructor
   const FunctionNode* func;
+  // Whether the gradient of each parameter is local to the rank, in the order of func->params.
+  Array<Bool> local_grads;
   std::unique_ptr<ExplicitLetList> fp_ell{nullptr};
   // initialized in Run
   std::unique_ptr<ExplicitLetList> bp_ell{nullptr};
@@ -362,15 +792,83 @@ struct DataParallel {
 
 }  // namespace data_parallel
 
-Pass AutoDataParallel() {
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.data_parallel.tune_bucket_size", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.data_parallel.sparse_embedding_grad", Bool);
+
+Pass AutoDataParallel(Array<Bool> local_grads) {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return data_parallel::DataParallel(f.operator->()).Run();
+    return data_parallel::DataParallel(f.operator->(), local_grads).Run();
   };
   return CreateRAFFunctionPass(pass_func, 0, "AutoDataParallel", {"InferType"});
 }
 
-RAF_REGISTER_GLOBAL("raf.pass_.AutoDataParallel").set_body_typed(AutoDataParallel);
+RAF_REGISTER_GLOBAL("raf.pass_.AutoDataParallel").set_body([](tvm::TVMArgs args,
+                                                                 tvm::TVMRetValue* rv) {
+  Array<Bool> local_grads;
+  if (args.size() == 1) {
+    local_grads = args[0];
+  }
+  *rv = AutoDataParallel(local_grads);
+});
+
+namespace data_parallel {
+
+std::vector<double> ArrayToDouble(const Array<FloatImm>& arr) {
+  std::vector<double> ret;
+  for (const auto& x : arr) {
+    ret.push_back(x->value);
+  }
+  return ret;
+}
+
+Array<Integer> IntToArray(const std::vector<int64_t>& vec) {
+  Array<Integer> ret;
+  for (int64_t x : vec) {
+    ret.push_back(IntImm(DataType::Int(64), x));
+  }
+  return ret;
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.data_parallel.GetGradSizes")
+    .set_body_typed([](Array<Type> grad_types, String compress_dtype) {
+      std::vector<int64_t> grad_sizes, grad_bytes;
+      GetGradSizes({grad_types.begin(), grad_types.end()}, compress_dtype, &grad_sizes,
+                   &grad_bytes);
+      return Array<Array<Integer>>{IntToArray(grad_sizes), IntToArray(grad_bytes)};
+    });
+
+RAF_REGISTER_GLOBAL("raf.pass_.data_parallel.FitAllreduceCost")
+    .set_body_typed([](Array<Integer> grad_sizes, Array<FloatImm> comm_time) {
+      AllreduceCost cost = FitAllreduceCost(ArrayToInt(grad_sizes), ArrayToDouble(comm_time));
+      return Array<FloatImm>{FloatImm(DataType::Float(64), cost.alpha),
+                             FloatImm(DataType::Float(64), cost.beta_elem)};
+    });
+
+RAF_REGISTER_GLOBAL("raf.pass_.data_parallel.SearchBucketSize")
+    .set_body_typed([](Array<FloatImm> ready_time, double comp_time, Array<Integer> grad_sizes,
+                       Array<Integer> grad_bytes, double alpha, double beta_elem,
+                       double beta_byte) {
+      AllreduceCost cost{alpha, beta_elem, beta_byte};
+      return SearchBucketSize(ArrayToDouble(ready_time), comp_time, ArrayToInt(grad_sizes),
+                              ArrayToInt(grad_bytes), cost);
+    });
+
+RAF_REGISTER_GLOBAL("raf.pass_.data_parallel.SearchBucketSizeFromProfile")
+    .set_body_typed([](Array<Integer> op_durations, int num_iters, Array<Integer> grad_sizes,
+                       Array<Integer> grad_bytes, Array<FloatImm> calibrated) {
+      // The calibrated cost is given as [alpha, beta_elem, beta_byte], or empty to fit it.
+      AllreduceCost cost;
+      if (!calibrated.empty()) {
+        CHECK_EQ(calibrated.size(), 3U);
+        cost = AllreduceCost{calibrated[0]->value, calibrated[1]->value, calibrated[2]->value};
+      }
+      return SearchBucketSizeFromProfile(ArrayToInt(op_durations), num_iters,
+                                         ArrayToInt(grad_sizes), ArrayToInt(grad_bytes),
+                                         calibrated.empty() ? nullptr : &cost);
+    });
+
+}  // namespace data_parallel
 
 }  // namespace pass
 }  // namespace raf
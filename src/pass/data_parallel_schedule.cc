@@ -7,7 +7,9 @@
  * \file data_parallel_schedule.cc
  * \brief Schedules ops during data parallel training.
  */
+#include <map>
 #include <queue>
+#include <string>
 #include <unordered_set>
 #include <relay/transforms/pass_utils.h>
 #include "raf/ir.h"
@@ -39,6 +41,14 @@ using stream_schedule::StreamSchedulerBase;
 
 class FIFOScheduler : public StreamSchedulerBase {
  public:
+  /*!
+   * \brief Create the scheduler.
+   * \param bucket_size The maximum number of elements in an allreduce bucket. If it is not
+   * positive, the allreduce ops are scheduled as they are.
+   */
+  explicit FIFOScheduler(int64_t bucket_size = 0) : bucket_size_(bucket_size) {
+  }
+
   /*! This scheduler schedules the execution order of ops so communication ops can better overlap
    * with computation ops. It works on BBNF/GNF and outputs the scheduled expression in ANF.
    *
@@ -101,6 +111,23 @@ class FIFOScheduler : public StreamSchedulerBase {
    *
    * By using a separate queue for ops that directly depends on a communication,
    * those ops are delayed until no other op is available, leaving more room for overlap.
+   *
+   * When the bucket size is positive, the allreduce ops are further grouped into buckets. An
+   * allreduce that becomes ready joins the open bucket with the same computation, rank list and
+   * dtype instead of being launched. Since gradients become ready in the reverse layer order
+   * during the backward pass, each bucket collects the gradients of adjacent layers. A bucket is
+   * launched as one allreduce over all its tensors as soon as it holds bucket_size elements, i.e.,
+   * right after its last gradient is produced, or when no other op can be scheduled. The ops that
+   * depend on a bucketed allreduce only become ready after the bucket is launched.
+   *
+   * With ZeRO, the delayed ops are mostly the optimizer updates of the gradient partitions, and
+   * the updated partitions are gathered back by allgather ops. If all delayed ops were launched
+   * together, every allgather would wait for every update. Instead, the delayed ops are launched
+   * one at a time, and the ops released by each of them are scheduled before the next one. The
+   * updates are thus launched in the order their reduce-scatters finish, and each allgather is
+   * launched right after the updates of its partitions, so the update of a chunk overlaps the
+   * reduce-scatter of the next chunk and the allgather of the previous one on the communication
+   * stream.
    */
   Expr Schedule(Expr e) {
     // create the data flow graph
@@ -140,50 +167,253 @@ class FIFOScheduler : public StreamSchedulerBase {
         out_degree[(*node_it)]++;
       }
     }
+    // ZeRO-3 and the deferred allgather of ZeRO-1/2 gather the partitioned parameters with
+    // allgather ops that have no predecessors. Scheduling them right away would gather all
+    // parameters at the beginning, so they are held back until one of their successors is only
+    // waiting for them.
+    std::unordered_set<Node*> lazy_gathers;
+    std::unordered_map<Node*, int> num_lazy_children;
+    auto dcfg = DistConfig::Global();
+    if (dcfg->zero_opt_level > 2 || (dcfg->zero_opt_level > 0 && dcfg->zero_defer_allgather)) {
+      for (auto& node : nodes) {
+        if (out_degree[node] == 0 && IsAllgather(node_expr[node])) {
+          lazy_gathers.insert(node);
+          for (auto parent = node->parents.head; parent; parent = parent->next) {
+            num_lazy_children[parent->value]++;
+          }
+        }
+      }
+    }
+    auto release_lazy_gathers = [&](Node* node) {
+      for (auto child = node->children.head; child; child = child->next) {
+        if (lazy_gathers.erase(child->value)) {
+          ready_queue.push(child->value);
+          for (auto parent = child->value->parents.head; parent; parent = parent->next) {
+            num_lazy_children[parent->value]--;
+          }
+        }
+      }
+    };
     // push nodes with zero predecessors into the queue
     for (auto& node : nodes) {
-      if (out_degree[node] == 0) {
+      if (out_degree[node] == 0 && !lazy_gathers.count(node)) {
         ready_queue.push(node);
+      } else if (out_degree[node] > 0 && out_degree[node] == num_lazy_children[node]) {
+        release_lazy_gathers(node);
       }
     }
 
     Expr ret;
+    // mark the op as scheduled and push all its ready successors into the corresponding queue
+    auto release_successors = [&](Node* node) {
+      for (auto parent = node->parents.head; parent; parent = parent->next) {
+        out_degree[parent->value]--;
+        if (out_degree[parent->value] == 0) {
+          if (comm_successor_nodes.count(parent->value)) {
+            comm_successor_ready_queue.push(parent->value);
+          } else {
+            ready_queue.push(parent->value);
+          }
+        } else if (out_degree[parent->value] == num_lazy_children[parent->value]) {
+          release_lazy_gathers(parent->value);
+        }
+      }
+    };
+    // launch a bucket and release the successors of all allreduce ops in it
+    auto launch_bucket = [&](const std::string& key) {
+      auto& bucket = open_buckets_.at(key);
+      ret = LaunchBucket(bucket.calls);
+      for (auto node : bucket.nodes) {
+        release_successors(node);
+      }
+      open_buckets_.erase(key);
+    };
     // in each step, we pop an op out of the queue, add it to the ANF and
     // push all its ready successors into the corresponding ready queue
-    auto process_queue_element = [&](std::queue<Node*>& q) {
+    auto process_queue_element = [&](std::queue<Node*>& q, bool one_at_a_time) {
       while (!q.empty()) {
         Node* node = q.front();
-        ret = VisitExpr(node_expr.at(node));
-        for (auto parent = node->parents.head; parent; parent = parent->next) {
-          out_degree[parent->value]--;
-          if (out_degree[parent->value] == 0) {
-            if (comm_successor_nodes.count(parent->value)) {
-              comm_successor_ready_queue.push(parent->value);
-            } else {
-              ready_queue.push(parent->value);
-            }
+        q.pop();
+        const Expr& expr = node_expr.at(node);
+        std::string key;
+        int64_t size = 0;
+        if (bucket_size_ > 0 && GetBucketKey(expr, &key, &size)) {
+          auto& bucket = open_buckets_[key];
+          bucket.calls.push_back(Downcast<Call>(expr));
+          bucket.nodes.push_back(node);
+          bucket.size += size;
+          if (bucket.size >= bucket_size_) {
+            launch_bucket(key);
           }
+          continue;
+        }
+        ret = VisitExpr(expr);
+        release_successors(node);
+        if (one_at_a_time) {
+          break;
         }
-        q.pop();
       }
     };
 
-    while (!ready_queue.empty() || !comm_successor_ready_queue.empty()) {
-      process_queue_element(ready_queue);
-      process_queue_element(comm_successor_ready_queue);
+    bool pipeline_comm_successors = dcfg->zero_opt_level > 0;
+    while (!ready_queue.empty() || !comm_successor_ready_queue.empty() || !open_buckets_.empty() ||
+           !lazy_gathers.empty()) {
+      process_queue_element(ready_queue, false);
+      process_queue_element(comm_successor_ready_queue, pipeline_comm_successors);
+      if (ready_queue.empty() && comm_successor_ready_queue.empty()) {
+        // no other op can be scheduled, so launch the open buckets to make progress
+        while (!open_buckets_.empty()) {
+          launch_bucket(open_buckets_.begin()->first);
+        }
+      }
+      if (ready_queue.empty() && comm_successor_ready_queue.empty() && !lazy_gathers.empty()) {
+        // the remaining gathers have no successors
+        for (auto node : lazy_gathers) {
+          ready_queue.push(node);
+        }
+        lazy_gathers.clear();
+      }
     }
 
+    if (bucket_size_ > 0) {
+      // the root may be replaced when it is a bucketed allreduce
+      ret = VisitExpr(e);
+    }
     return let_list_.Get(ret);
   }
+
+ private:
+  /*! \brief Check whether the expression is an allgather. */
+  static bool IsAllgather(const Expr& expr) {
+    static const Op& allgather_op = Op::Get("raf.op._allgather");
+    const auto* call = expr.as<CallNode>();
+    if (call == nullptr || !call->op->IsInstance<OpNode>()) {
+      return false;
+    }
+    Op op = Downcast<Op>(call->op);
+    return (op::IsDialectOp(op) ? op::GetBaseOp(op) : op) == allgather_op;
+  }
+
+  /*! \brief The allreduce ops waiting to be launched together. */
+  struct Bucket {
+    std::vector<Call> calls;
+    std::vector<Node*> nodes;
+    int64_t size = 0;
+  };
+
+  /*!
+   * \brief Check whether the expression is an allreduce that can be bucketed. If so, get the key
+   * of its bucket and the number of elements it reduces.
+   */
+  bool GetBucketKey(const Expr& expr, std::string* key, int64_t* size) {
+    static const Op& allreduce_op = Op::Get("raf.op._allreduce");
+    const auto* call = expr.as<CallNode>();
+    if (call == nullptr || !call->op->IsInstance<OpNode>()) {
+      return false;
+    }
+    Op op = Downcast<Op>(call->op);
+    if ((op::IsDialectOp(op) ? op::GetBaseOp(op) : op) != allreduce_op) {
+      return false;
+    }
+    const auto* tuple = call->args[0].as<TupleNode>();
+    if (tuple == nullptr || tuple->fields.empty()) {
+      return false;
+    }
+    std::string dtype;
+    *size = 0;
+    for (const auto& field : tuple->fields) {
+      const auto* ttype = field->checked_type_.as<TensorTypeNode>();
+      if (ttype == nullptr) {
+        return false;
+      }
+      int64_t numel = 1;
+      for (const auto& dim : ttype->shape) {
+        const auto* dim_imm = dim.as<IntImmNode>();
+        if (dim_imm == nullptr) {
+          return false;
+        }
+        numel *= dim_imm->value;
+      }
+      std::string field_dtype = tvm::runtime::DLDataType2String(ttype->dtype);
+      if (!dtype.empty() && dtype != field_dtype) {
+        return false;
+      }
+      dtype = field_dtype;
+      *size += numel;
+    }
+    std::stringstream ss;
+    ss << op->name << "|" << dtype;
+    for (size_t i = 1; i < call->args.size(); ++i) {
+      ss << "|" << raf::ir::AsText(call->args[i]);
+    }
+    *key = ss.str();
+    return true;
+  }
+
+  /*!
+   * \brief Launch the allreduce ops in a bucket as one allreduce, and replace the output of each
+   * allreduce op with the corresponding fields of the bucket output.
+   */
+  Expr LaunchBucket(const std::vector<Call>& calls) {
+    if (calls.size() == 1) {
+      return VisitExpr(calls[0]);
+    }
+    Array<Expr> fields;
+    for (const auto& call : calls) {
+      for (const auto& field : call->args[0].as<TupleNode>()->fields) {
+        fields.push_back(VisitExpr(field));
+      }
+    }
+    Array<Expr> args{let_list_.Push(Tuple(fields))};
+    for (size_t i = 1; i < calls[0]->args.size(); ++i) {
+      args.push_back(VisitExpr(calls[0]->args[i]));
+    }
+    Expr out = let_list_.Push(Call(calls[0]->op, args, calls[0]->attrs, calls[0]->type_args));
+    Expr ret;
+    int index = 0;
+    for (const auto& call : calls) {
+      size_t num_fields = call->args[0].as<TupleNode>()->fields.size();
+      if (num_fields == 1) {
+        ret = let_list_.Push(TupleGetItem(out, index++));
+      } else {
+        Array<Expr> outs;
+        for (size_t i = 0; i < num_fields; ++i) {
+          outs.push_back(let_list_.Push(TupleGetItem(out, index++)));
+        }
+        ret = let_list_.Push(Tuple(outs));
+      }
+      memo_[call] = ret;
+    }
+    return ret;
+  }
+
+  /*! \brief The maximum number of elements in an allreduce bucket. */
+  int64_t bucket_size_;
+  /*! \brief The open buckets keyed by the allreduce op, dtype, computation and rank list. */
+  std::map<std::string, Bucket> open_buckets_;
 };
 
 Expr FIFOScheduleTransform(const Expr& e) {
   return FIFOScheduler().Schedule(e);
 }
 
+Expr BucketScheduleTransform(const Expr& e) {
+  return FIFOScheduler(DistConfig::Global()->group_bucket_size).Schedule(e);
+}
+
 }  // namespace data_parallel_schedule
 
 Pass DataParallelSchedule() {
+  if (distributed::DistConfig::Global()->enable_allreduce_bucketing) {
+    // The bucket sizes are computed from the types, which may have been erased.
+    TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+        [=](Function f, IRModule m, PassContext pc) {
+          return Downcast<Function>(
+              tvm::relay::TransformF(data_parallel_schedule::BucketScheduleTransform, f));
+        };
+    auto bucket_pass = CreateRAFFunctionPass(pass_func, 0, "DataParallelBucketSchedule", {});
+    return RAFSequential({InferType(), bucket_pass}, "DataParallelSchedule");
+  }
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
     return Downcast<Function>(
@@ -0,0 +1,172 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file dedup_constant.cc
+ * \brief Deduplicate the tensor constants with the same content, e.g., the bound params of the
+ * tied embeddings, so that the executable keeps and uploads only one copy of them.
+ */
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "raf/cache.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace dedup_constant {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+/*! \brief Collect the tensor constants in all the functions of a module. */
+class ConstantCollector : public ExprVisitor {
+ public:
+  void VisitExpr_(const ConstantNode* node) final {
+    if (node->value.defined() && node->value->IsInstance<TensorValueObj>()) {
+      if (seen_.insert(node->value.get()).second) {
+        constants.push_back(GetRef<Constant>(node));
+      }
+    }
+  }
+
+  /*! \brief The first constant of each distinct tensor value, in the visiting order. */
+  std::vector<Constant> constants;
+
+ private:
+  std::unordered_set<const Object*> seen_;
+};
+
+/*! \brief Get the key of the metadata that identical tensors must share. */
+std::string GetMetaKey(const DLTensor* tensor) {
+  HashKey key;
+  key << tensor->dtype << tensor->device;
+  key << std::vector<int64_t>(tensor->shape, tensor->shape + tensor->ndim);
+  return std::string(key.byte_vector.begin(), key.byte_vector.end());
+}
+
+/*! \brief The data of a tensor on the CPU, which is copied from the device if needed. */
+struct HostData {
+  explicit HostData(const TensorValue& value) {
+    tensor::Tensor tensor = value->tensor;
+    if (tensor->device.device_type != kDLCPU) {
+      DLDevice cpu_dev;
+      cpu_dev.device_type = kDLCPU;
+      cpu_dev.device_id = 0;
+      host = tensor.CopyTo(cpu_dev);
+    } else {
+      host = tensor;
+    }
+    data = static_cast<const char*>(host->data) + host->byte_offset;
+    nbytes = common::shape_utils::BytesCompactTensor(*host.operator->());
+  }
+
+  /*! \brief Compare the bytes, where different weights usually differ early on. */
+  bool operator==(const HostData& other) const {
+    return nbytes == other.nbytes && std::memcmp(data, other.data, nbytes) == 0;
+  }
+
+  tvm::runtime::NDArray host;
+  const char* data;
+  int64_t nbytes;
+};
+
+class ConstantDeduplicator : public ExprMutator {
+ public:
+  explicit ConstantDeduplicator(const IRModule& mod) : mod_(mod) {
+  }
+
+  IRModule Run() {
+    ConstantCollector collector;
+    for (const auto& kv : mod_->functions) {
+      if (kv.second->IsInstance<FunctionNode>()) {
+        collector.VisitExpr(Downcast<Function>(kv.second));
+      }
+    }
+
+    // Only the tensors with the same metadata are compared by their content, so that the data of
+    // the others are not copied to the host.
+    std::unordered_map<std::string, std::vector<Constant>> groups;
+    std::vector<std::string> group_keys;
+    for (const auto& konst : collector.constants) {
+      const DLTensor* tensor = Downcast<TensorValue>(konst->value);
+      if (!common::shape_utils::IsCompact(*tensor)) {
+        continue;
+      }
+      auto key = GetMetaKey(tensor);
+      auto& group = groups[key];
+      if (group.empty()) {
+        group_keys.push_back(key);
+      }
+      group.push_back(konst);
+    }
+    for (const auto& key : group_keys) {
+      const auto& group = groups.at(key);
+      if (group.size() < 2) {
+        continue;
+      }
+      std::vector<std::pair<Constant, HostData>> uniques;
+      for (const auto& konst : group) {
+        HostData data(Downcast<TensorValue>(konst->value));
+        bool found = false;
+        for (const auto& unique : uniques) {
+          if (unique.second == data) {
+            canonical_[konst->value.get()] = unique.first;
+            found = true;
+            break;
+          }
+        }
+        if (!found) {
+          uniques.emplace_back(konst, std::move(data));
+        }
+      }
+    }
+    if (canonical_.empty()) {
+      return mod_;
+    }
+    DLOG(INFO) << "Deduplicated " << canonical_.size() << " tensor constants";
+
+    IRModule updated_mod = IRModule(mod_->functions);
+    for (const auto& kv : mod_->functions) {
+      if (kv.second->IsInstance<FunctionNode>()) {
+        updated_mod->Add(kv.first, Downcast<Function>(Mutate(kv.second)), true);
+      }
+    }
+    return updated_mod;
+  }
+
+  Expr VisitExpr_(const ConstantNode* node) final {
+    auto it = canonical_.find(node->value.get());
+    if (it != canonical_.end()) {
+      return it->second;
+    }
+    return GetRef<Constant>(node);
+  }
+
+ private:
+  /*! \brief The module to deduplicate. */
+  IRModule mod_;
+  /*! \brief The constant to replace each duplicated tensor value with. */
+  std::unordered_map<const Object*, Constant> canonical_;
+};
+
+}  // namespace dedup_constant
+
+Pass DedupConstant() {
+  TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule m, PassContext pc) {
+    return dedup_constant::ConstantDeduplicator(m).Run();
+  };
+  return CreateModulePass(pass_func, 1, "DedupConstant", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.DedupConstant").set_body_typed(DedupConstant);
+
+}  // namespace pass
+}  // namespace raf
@@ -8,6 +8,7 @@
  * \brief Deduplicate the same structure in a GNF IR.
  */
 
+#include <queue>
 #include "raf/ir.h"
 #include "raf/registry.h"
 #include "raf/pass.h"
@@ -233,6 +234,49 @@ DataflowGraph CreateDataflowGraph(const Expr& expr) {
   return Annotator(Creator().CreateGraph(expr)).Annotate();
 }
 
+/*!
+ * \brief Whether the node can be a part of a deduplicated subgraph. A tuple node must have no
+ * more than 10 fields, and a call node should not call a non-primitive function or an inplace op.
+ */
+bool IsValidNode(const Node* n) {
+  bool ret = true;
+  if (auto* tuple = n->ref_.as<TupleNode>()) {
+    if (tuple->fields.size() > 10) {
+      ret = false;
+    }
+  } else if (auto* call = n->ref_.as<CallNode>()) {
+    if (const FunctionNode* fn = call->op.as<FunctionNode>()) {
+      if (!fn->HasNonzeroAttr(attr::kPrimitive)) {
+        ret = false;
+      }
+    } else if (const OpNode* opnode = call->op.as<OpNode>()) {
+      // TODO(@hgt312): let's revisit this part after having new inplace mechanism
+      // Do not merge call nodes with inplace op
+      static auto finplace = Op::GetAttrMap<op::TRAFInplaceUpdate>("TRAFInplaceUpdate");
+      static auto add_op = Op::Get("raf.op.add");
+      static auto subtract_op = Op::Get("raf.op.subtract");
+      auto op = GetRef<Op>(opnode);
+      if (op::IsDialectOp(op)) {
+        op = op::GetBaseOp(op);
+      }
+      if (finplace.count(op)) {
+        ret = false;
+      } else if (op == add_op || op == subtract_op) {
+        CHECK_GT(call->args.size(), 2);
+        auto out = call->args[2];
+        if (out.defined()) {
+          auto konst = out.as<ConstantNode>();
+          // Inplace update when out is not constant or konst->value is defined
+          if (!konst || konst->value.defined()) {
+            ret = false;
+          }
+        }
+      }
+    }
+  }
+  return ret;
+}
+
 /*!
  * \brief Enumerate valid subgraphs from a dataflow graph.
  *
@@ -284,44 +328,6 @@ std::pair<std::vector<Nodes>, DomMasks> EnumerateValidSubgraph(const DataflowGra
                                                                bool must_dominate) {
   std::vector<Nodes> ret_nodes;
   DomMasks ret_masks;
-  auto is_valid_node = [](Node* n) {
-    bool ret = true;
-    if (auto* tuple = n->ref_.as<TupleNode>()) {
-      if (tuple->fields.size() > 10) {
-        ret = false;
-      }
-    } else if (auto* call = n->ref_.as<CallNode>()) {
-      if (const FunctionNode* fn = call->op.as<FunctionNode>()) {
-        if (!fn->HasNonzeroAttr(attr::kPrimitive)) {
-          ret = false;
-        }
-      } else if (const OpNode* opnode = call->op.as<OpNode>()) {
-        // TODO(@hgt312): let's revisit this part after having new inplace mechanism
-        // Do not merge call nodes with inplace op
-        static auto finplace = Op::GetAttrMap<op::TRAFInplaceUpdate>("TRAFInplaceUpdate");
-        static auto add_op = Op::Get("raf.op.add");
-        static auto subtract_op = Op::Get("raf.op.subtract");
-        auto op = GetRef<Op>(opnode);
-        if (op::IsDialectOp(op)) {
-          op = op::GetBaseOp(op);
-        }
-        if (finplace.count(op)) {
-          ret = false;
-        } else if (op == add_op || op == subtract_op) {
-          CHECK_GT(call->args.size(), 2);
-          auto out = call->args[2];
-          if (out.defined()) {
-            auto konst = out.as<ConstantNode>();
-            // Inplace update when out is not constant or konst->value is defined
-            if (!konst || konst->value.defined()) {
-              ret = false;
-            }
-          }
-        }
-      }
-    }
-    return ret;
-  };
   std::function<void(Nodes subgraph, Nodes extension, Node * v)> extend_subgraph =
       [&](Nodes subgraph, Nodes extension, Node* v) {
         if (subgraph.size() == k) {
@@ -408,7 +414,7 @@ std::pair<std::vector<Nodes>, DomMasks> EnumerateValidSubgraph(const DataflowGra
           }
           Nodes new_extension = extension;
           for (auto child : w->inputs_) {
-            if (is_valid_node(child) && excludes.count(child) == 0) {
+            if (IsValidNode(child) && excludes.count(child) == 0) {
               if (!must_dominate || v->Dominates(child)) {
                 new_extension.push_back(child);
               }
@@ -422,12 +428,12 @@ std::pair<std::vector<Nodes>, DomMasks> EnumerateValidSubgraph(const DataflowGra
 
   for (auto it = graph.topological_order_.rbegin(); it != graph.topological_order_.rend(); ++it) {
     auto node = *it;
-    if (!is_valid_node(node.get()) || node->ref_->IsInstance<TupleGetItemNode>()) {
+    if (!IsValidNode(node.get()) || node->ref_->IsInstance<TupleGetItemNode>()) {
       continue;
     }
     Nodes extenstion;
     for (auto child : node->inputs_) {
-      if (is_valid_node(child)) {
+      if (IsValidNode(child)) {
         if (!must_dominate || node->Dominates(child)) {
           extenstion.push_back(child);
         }
@@ -699,12 +705,248 @@ class DeduplicateMutator : public MixedModeMutator {
   std::unordered_map<int, Expr> func_call_cache_;
 };
 
+inline uint64_t CombineHash(uint64_t seed, uint64_t value) {
+  return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+/*!
+ * \brief Get the label of a node, which covers the node kind, the op, the constant arguments, the
+ * positions of the inputs from and outside the graph, and optionally the type.
+ */
+uint64_t NodeLabel(const DataflowGraph& graph, const Node* node, bool consider_type) {
+  uint64_t label = node->ref_->GetTypeKeyHash();
+  Array<Expr> args;
+  if (const auto* call = node->ref_.as<CallNode>()) {
+    if (const auto* op = call->op.as<OpNode>()) {
+      label = CombineHash(label, std::hash<std::string>()(op->name));
+    } else {
+      label = CombineHash(label, ObjectPtrHash()(call->op));
+    }
+    args = call->args;
+  } else if (const auto* tuple = node->ref_.as<TupleNode>()) {
+    args = tuple->fields;
+  } else if (const auto* tgi = node->ref_.as<TupleGetItemNode>()) {
+    label = CombineHash(label, std::hash<int>()(tgi->index));
+    args = {tgi->tuple};
+  }
+  label = CombineHash(label, args.size());
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (const auto* konst = args[i].as<ConstantNode>()) {
+      label = CombineHash(label, tvm::StructuralHash()(konst->value));
+      continue;
+    }
+    // Encode which arguments are the same expression, as the extracted function has a parameter
+    // per argument of the outside inputs.
+    size_t first = 0;
+    while (!args[first].same_as(args[i])) {
+      ++first;
+    }
+    label = CombineHash(label, first);
+    label = CombineHash(label, graph.node_map_.count(args[i]));
+  }
+  if (consider_type) {
+    label = CombineHash(label, tvm::StructuralHash()(node->ref_->checked_type_));
+  }
+  return label;
+}
+
+/*!
+ * \brief Find the largest group of repeated subgraphs with the structural fingerprints of nodes,
+ * which avoids enumerating the subgraphs of each size.
+ *
+ * 1. Compute the label of each node, and the fingerprint of each node bottom up, where the
+ *    fingerprint of depth d combines the label with the fingerprints of depth d - 1 of the
+ *    inputs. It takes O(n * depth) time.
+ * 2. Bucket the nodes by the fingerprint, so nodes with the same structure within `depth` hops
+ *    are the candidate roots of repeated subgraphs.
+ * 3. For each bucket, grow the subgraphs of all members in lockstep from the roots to the inputs
+ *    in reverse topological order. A tuple of inputs at the same position is added when their
+ *    labels are the same, none of them is in any subgraph, and each of them is only used by its
+ *    own subgraph, so the root dominates the subgraph. Only the bucket members are compared.
+ * 4. Drop the leaf tuple get item nodes and the subgraphs whose outside inputs are shared in a
+ *    different way from the first subgraph.
+ * 5. Return the group with the largest score: (k - 1) * num of subgraphs.
+ *
+ * \param graph The dataflow graph.
+ * \param depth The depth of the fingerprints.
+ * \param consider_type Whether considering the type information.
+ * \return The group, or nullptr if there is no repeated subgraphs.
+ */
+std::shared_ptr<SubgraphGroup> FindGroupByFingerprint(const DataflowGraph& graph, int depth,
+                                                      bool consider_type) {
+  const auto& nodes = graph.topological_order_;
+  size_t n = nodes.size();
+  std::vector<uint64_t> labels(n);
+  for (size_t i = 0; i < n; ++i) {
+    labels[i] = NodeLabel(graph, nodes[i].get(), consider_type);
+  }
+  std::vector<uint64_t> prints = labels;
+  for (int d = 0; d < depth; ++d) {
+    std::vector<uint64_t> next(n);
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t print = labels[i];
+      for (auto input : nodes[i]->inputs_) {
+        print = CombineHash(print, prints[input->index_]);
+      }
+      next[i] = print;
+    }
+    prints.swap(next);
+  }
+
+  // Bucket the valid roots in reverse topological order.
+  std::unordered_map<uint64_t, Nodes> buckets;
+  std::vector<uint64_t> bucket_order;
+  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+    Node* node = it->get();
+    if (!IsValidNode(node) || node->ref_->IsInstance<TupleGetItemNode>()) {
+      continue;
+    }
+    auto& bucket = buckets[prints[node->index_]];
+    if (bucket.empty()) {
+      bucket_order.push_back(prints[node->index_]);
+    }
+    bucket.push_back(node);
+  }
+
+  // The pattern of outside inputs in the order of SubgraphGroup::GenHelpInfo.
+  auto input_pattern = [](const Nodes& subgraph) {
+    std::unordered_set<Expr, ObjectPtrHash, ObjectPtrEqual> exprs;
+    for (auto node : subgraph) {
+      exprs.insert(node->ref_);
+    }
+    std::vector<Expr> inputs;
+    std::vector<size_t> pattern;
+    for (auto node : subgraph) {
+      Array<Expr> args;
+      if (auto tuple = node->ref_.as<TupleNode>()) {
+        args = tuple->fields;
+      } else if (auto call = node->ref_.as<CallNode>()) {
+        args = call->args;
+      } else if (auto tgi = node->ref_.as<TupleGetItemNode>()) {
+        args = {tgi->tuple};
+      }
+      for (const auto& arg : args) {
+        if (arg->IsInstance<RelayConstantNode>() || exprs.count(arg)) {
+          continue;
+        }
+        size_t first = 0;
+        while (first < inputs.size() && !inputs[first].same_as(arg)) {
+          ++first;
+        }
+        inputs.push_back(arg);
+        pattern.push_back(first);
+      }
+    }
+    return pattern;
+  };
+
+  std::shared_ptr<SubgraphGroup> best{nullptr};
+  size_t best_score = 0;
+  for (auto print : bucket_order) {
+    const Nodes& roots = buckets[print];
+    size_t m = roots.size();
+    if (m < 2) {
+      continue;
+    }
+    std::unordered_map<const Node*, size_t> owner;
+    std::vector<Nodes> subgraphs(m);
+    for (size_t i = 0; i < m; ++i) {
+      owner[roots[i]] = i;
+      subgraphs[i].push_back(roots[i]);
+    }
+    // Candidate tuples of aligned nodes, ordered by the index of the first member.
+    std::vector<Nodes> candidates;
+    std::priority_queue<std::pair<size_t, size_t>> queue;
+    auto push_inputs = [&](const Nodes& aligned) {
+      for (size_t j = 0; j < aligned[0]->inputs_.size(); ++j) {
+        Nodes inputs;
+        for (auto node : aligned) {
+          CHECK_EQ(node->inputs_.size(), aligned[0]->inputs_.size());
+          inputs.push_back(node->inputs_[j]);
+        }
+        queue.emplace(inputs[0]->index_, candidates.size());
+        candidates.push_back(inputs);
+      }
+    };
+    push_inputs(roots);
+    while (!queue.empty()) {
+      Nodes aligned = candidates[queue.top().second];
+      queue.pop();
+      bool accept = true;
+      for (size_t i = 0; i < m && accept; ++i) {
+        Node* node = aligned[i];
+        accept = owner.count(node) == 0 && IsValidNode(node) &&
+                 labels[node->index_] == labels[aligned[0]->index_] &&
+                 std::find(aligned.begin(), aligned.begin() + i, node) == aligned.begin() + i;
+        for (auto output : node->outputs_) {
+          if (!accept) {
+            break;
+          }
+          auto it = owner.find(output);
+          accept = it != owner.end() && it->second == i;
+        }
+      }
+      if (!accept) {
+        continue;
+      }
+      for (size_t i = 0; i < m; ++i) {
+        owner[aligned[i]] = i;
+        subgraphs[i].push_back(aligned[i]);
+      }
+      push_inputs(aligned);
+    }
+
+    // Drop the leaf tuple get item nodes, which are usually meaningless.
+    for (size_t k = subgraphs[0].size(); k > 1; --k) {
+      Node* node = subgraphs[0][k - 1];
+      if (!node->ref_->IsInstance<TupleGetItemNode>()) {
+        continue;
+      }
+      auto it = node->inputs_.empty() ? owner.end() : owner.find(node->inputs_[0]);
+      if (it == owner.end() || it->second != 0) {
+        for (auto& subgraph : subgraphs) {
+          owner.erase(subgraph[k - 1]);
+          subgraph.erase(subgraph.begin() + k - 1);
+        }
+      }
+    }
+    if (subgraphs[0].size() < 2) {
+      continue;
+    }
+
+    auto group = std::make_shared<SubgraphGroup>();
+    auto pattern = input_pattern(subgraphs[0]);
+    for (const auto& subgraph : subgraphs) {
+      if (input_pattern(subgraph) == pattern) {
+        group->subgraphs.push_back(subgraph);
+      }
+    }
+    size_t score = group->subgraphs.size() * (subgraphs[0].size() - 1);
+    if (group->IsValid() && score > best_score) {
+      best = group;
+      best_score = score;
+    }
+  }
+  if (best) {
+    DLOG(INFO) << "Max score: " << best_score;
+  }
+  return best;
+}
+
 /*!
  * \brief Extract one function and use it to merge the origin IR.
  */
 Expr MergeOneFunction(const Expr& expr, int forward_steps, bool consider_type, bool must_dominate,
-                      const ir::Optional<ir::String>& salt) {
+                      const ir::Optional<ir::String>& salt, int fingerprint_depth) {
   DataflowGraph graph = CreateDataflowGraph(expr);
+  if (fingerprint_depth > 0) {
+    auto group = FindGroupByFingerprint(graph, fingerprint_depth, consider_type);
+    if (!group) {
+      return expr;
+    }
+    group->GenHelpInfo();
+    return DeduplicateMutator(group.get()).Mutate(expr);
+  }
 
   int k = 2;
   std::shared_ptr<SubgraphGroup> current_group{nullptr};
@@ -825,6 +1067,12 @@ Expr MergeOneFunction(const Expr& expr, int forward_steps, bool consider_type, b
  * 8. 1-7 is the process of MergeOneFunction, run this function with the just updated IR until
  *    the IR no longer changed
  *
+ * Since the number of subgraphs grows exponentially with k, steps 2-6 are slow on deep models.
+ * When the pass config "raf.deduplicate.fingerprint_depth" is positive, they are replaced by
+ * bucketing the nodes with their structural fingerprints of the given depth and growing the
+ * subgraphs from each bucket (see FindGroupByFingerprint). In this case, `forward_steps` is unused
+ * and the extracted subgraphs are always dominated by their roots.
+ *
  * \param forward_steps The additional num of steps to search.
  * \param consider_type Whether considering the type information.
  * \param must_dominate Whether the root node of a subgraph must dominate other nodes in the
@@ -836,6 +1084,10 @@ Pass Deduplicate(int forward_steps, bool consider_type, bool must_dominate,
                  ir::Optional<ir::String> salt) {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
+    int fingerprint_depth =
+        pc->GetConfig("raf.deduplicate.fingerprint_depth", Integer(static_cast<int>(0)))
+            .value()
+            .IntValue();
     auto expr = f->body;
     auto post = expr;
     auto last = post;
@@ -846,7 +1098,8 @@ Pass Deduplicate(int forward_steps, bool consider_type, bool must_dominate,
     ICHECK(structural_equal) << "node.StructuralEqual is not registered.";
     do {
       last = post;
-      post = deduplicate::MergeOneFunction(post, forward_steps, consider_type, must_dominate, salt);
+      post = deduplicate::MergeOneFunction(post, forward_steps, consider_type, must_dominate, salt,
+                                           fingerprint_depth);
       if (consider_type) {
         post = InferType(post);
       }
@@ -866,5 +1119,7 @@ Pass Deduplicate(int forward_steps, bool consider_type, bool must_dominate,
 
 RAF_REGISTER_GLOBAL("raf.pass_.Deduplicate").set_body_typed(Deduplicate);
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.deduplicate.fingerprint_depth", Integer);
+
 }  // namespace pass
 }  // namespace raf
@@ -7,13 +7,19 @@
  * \file src/pass/dispatch_dialect.cc
  * \brief Dispatch the base ops to device-specific dialect ops based on predefined plevels. Note
  * that some ops such as VM related ops do not have dialect ops, and they will remain the same after
- * this pass.
+ * this pass. With the pass config "raf.dispatch_dialect.profile_guided", the dialect of each call
+ * is instead selected by profiling its candidate dialect ops with the argument types of the call.
  */
+#include <limits>
 #include <vector>
+#include "raf/cache.h"
 #include "raf/device.h"
 #include "raf/op.h"
+#include "raf/op_profiler.h"
 #include "raf/ir.h"
 #include "raf/pass.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
+#include "./common.h"
 
 namespace raf {
 namespace pass {
@@ -22,9 +28,146 @@ namespace dispatch_dialect {
 using namespace raf::ir;
 using namespace raf::op;
 
+class DialectDecisionCacheEntry {
+ public:
+  explicit DialectDecisionCacheEntry(const std::string& dialect) : dialect_(dialect) {
+  }
+
+  const std::string& Value() const {
+    return dialect_;
+  }
+
+  static DialectDecisionCacheEntry Load(const std::string& path) {
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/value.bin", &data);
+    dmlc::MemoryStringStream reader(&data);
+    dmlc::Stream* stream = &reader;
+    std::string dialect;
+    stream->Read(&dialect);
+    return DialectDecisionCacheEntry(dialect);
+  }
+
+  bool Save(const std::string& path) {
+    std::string data;
+    dmlc::MemoryStringStream writer(&data);
+    dmlc::SeekStream* stream = &writer;
+    stream->Write(dialect_);
+    tvm::runtime::SaveBinaryToFile(path + "/value.bin", data);
+    return true;
+  }
+
+ private:
+  std::string dialect_;
+};
+
+MetaPersistCache<DialectDecisionCacheEntry> CacheDialectDecision("dispatch_dialect_decision");
+
+/*!
+ * \brief Wrap a call into a function of its non-constant arguments, whose text is the signature of
+ * the call, i.e., the op, the argument types and the constant arguments such as strides.
+ */
+std::string CallSignature(const Call& call) {
+  Array<Var> params;
+  Array<Expr> args;
+  for (const auto& arg : call->args) {
+    if (arg.as<ConstantNode>()) {
+      args.push_back(arg);
+    } else {
+      std::ostringstream os;
+      os << "p" << params.size();
+      auto var = MakeVar(os.str(), arg->checked_type());
+      params.push_back(var);
+      args.push_back(var);
+    }
+  }
+  return raf::ir::AsText(Function(params, Call(call->op, args, call->attrs), Type(), {}));
+}
+
+/*! \brief Whether the types of the call and its arguments are known and static. */
+bool IsStaticallyTyped(const Call& call) {
+  if (!call->checked_type_.defined() || tvm::relay::IsDynamic(call->checked_type())) {
+    return false;
+  }
+  for (const auto& arg : call->args) {
+    if (!arg->checked_type_.defined() || tvm::relay::IsDynamic(arg->checked_type())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ * \brief Profile a dialect op with the arguments of a base op call.
+ * \return The latency in microseconds, or the max float if the dialect op does not support the
+ * call. Note that OpProfiler falls back to the other dialects when the op cannot be built, so the
+ * OpEnv of the dialect op is built first to exclude the unsupported ones.
+ */
+float ProfileDialectOp(const Call& call, const Op& dialect_op, const Device& device) {
+  const float kUnsupported = std::numeric_limits<float>::max();
+  auto maker = OpEnvMaker::Get(dialect_op->name);
+  if (maker == nullptr) {
+    return kUnsupported;
+  }
+  Call dialect_call(dialect_op, call->args, call->attrs);
+  dialect_call->checked_type_ = call->checked_type();
+  try {
+    auto env = OpEnvPtr((*maker)(CreateDummyCallValues(dialect_call, device)));
+    if (env == nullptr || env->HasError()) {
+      return kUnsupported;
+    }
+    auto latency = op_profiler::OpProfiler::Get(device)->ProfileOp(dialect_call).first;
+    return latency.empty() ? kUnsupported : latency[0];
+  } catch (const dmlc::Error& e) {
+    DLOG(INFO) << dialect_op->name << " is not profiled: " << e.what();
+    return kUnsupported;
+  }
+}
+
+/*! \brief See ProfileGuidedDialect in common.h. */
+std::string SelectDialectByProfile(const Call& call, const Device& device) {
+  auto op = Downcast<Op>(call->op);
+  if (!IsStaticallyTyped(call)) {
+    return "";
+  }
+  std::vector<OpDialect::DialectOpEntry> candidates;
+  for (const auto& entry : OpDialect::GetDispatchList(op, device.device_type())) {
+    if (entry.plevel > 0) {
+      candidates.push_back(entry);
+    }
+  }
+  if (candidates.size() < 2) {
+    return "";
+  }
+
+  HashKey key;
+  key << std::string(device.c_str()) << CallSignature(call);
+  if (auto entry = CacheDialectDecision.Get(key.byte_vector)) {
+    return entry->Value();
+  }
+  std::string best_dialect = "";
+  float best_latency = std::numeric_limits<float>::max();
+  for (const auto& entry : candidates) {
+    auto dialect_op = Op::Get(entry.dialect_op);
+    dialect_op->op_type = op->op_type;
+    float latency = ProfileDialectOp(call, dialect_op, device);
+    DLOG(INFO) << entry.dialect_op << ": " << latency << " us";
+    if (latency < best_latency) {
+      best_latency = latency;
+      best_dialect = entry.dialect;
+    }
+  }
+  // Leave the call to the static priority if no dialect op supports it, and do not cache it.
+  if (!best_dialect.empty()) {
+    DialectDecisionCacheEntry decision(best_dialect);
+    CacheDialectDecision.Set(key.byte_vector, decision);
+  }
+  return best_dialect;
+}
+
 class DispatchMutator : public MixedModeMutator {
  public:
-  DispatchMutator(DevType dev_type) : dev_type_(dev_type) {
+  DispatchMutator(const Device& device, bool profile_guided)
+      : device_(device), dev_type_(device.device_type()), profile_guided_(profile_guided) {
   }
 
   Expr VisitExpr_(const FunctionNode* node) final {
@@ -46,28 +189,60 @@ class DispatchMutator : public MixedModeMutator {
     return op;
   }
 
+  Expr Rewrite_(const CallNode* pre, const Expr& post) final {
+    auto op = pre->op.as<OpNode>();
+    if (!profile_guided_ || op == nullptr || IsDialectOp(GetRef<Op>(op))) {
+      return post;
+    }
+    auto dialect = SelectDialectByProfile(GetRef<Call>(pre), device_);
+    if (dialect.empty()) {
+      return post;
+    }
+    auto dialect_op = OpDialect::Lower(GetRef<Op>(op), dialect);
+    dialect_op->op_type = op->op_type;
+    auto call = Downcast<Call>(post);
+    return Call(dialect_op, call->args, call->attrs, call->type_args, call->span);
+  }
+
  private:
+  Device device_;
   DevType dev_type_;
+  /*! \brief Whether to select the dialects of the calls by profiling. */
+  bool profile_guided_;
 };
 
-Expr Dispatch(const Expr& expr) {
+Expr Dispatch(const Expr& expr, bool profile_guided) {
   auto dev = Device::Current(true);
   if (dev->device_type == DevType::kUnknown() || dev->device_id < 0) {
     LOG(WARNING) << "Device is not specified, skip DispatchDialect pass.";
     return expr;
   }
-  DevType dev_type = dev.device_type();
-  return DispatchMutator(dev_type).Mutate(expr);
+  return DispatchMutator(dev, profile_guided).Mutate(expr);
 }
 
 }  // namespace dispatch_dialect
 
+std::string ProfileGuidedDialect(const Call& call, const Device& device) {
+  return dispatch_dialect::SelectDialectByProfile(call, device);
+}
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.dispatch_dialect.profile_guided", Bool);
+
 Pass DispatchDialect() {
+  PassContext pass_ctx = PassContext::Current();
+  bool profile_guided =
+      pass_ctx->GetConfig("raf.dispatch_dialect.profile_guided", Bool(false)).value();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(dispatch_dialect::Dispatch(f));
+    return Downcast<Function>(dispatch_dialect::Dispatch(f, profile_guided));
   };
-  return CreateRAFFunctionPass(pass_func, 1, "DispatchDialect", {});
+  if (!profile_guided) {
+    return CreateRAFFunctionPass(pass_func, 1, "DispatchDialect", {});
+  }
+  // Profiling the dialect ops needs the types of the calls, and is not safe to run concurrently.
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 1, "DispatchDialect", {});
+  PassInfo pass_info(1, "DispatchDialect", {});
+  return RAFSequential({InferType(), func_pass}, pass_info);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.DispatchDialect").set_body_typed(DispatchDialect);
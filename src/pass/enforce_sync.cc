@@ -26,6 +26,7 @@ using namespace raf::op;
 using namespace raf::value;
 using namespace raf::distributed::communicator;
 using namespace raf::analysis;
+using raf::distributed::DistConfig;
 using stream_pool::StreamTagEnum;
 
 using OpSet = std::unordered_set<Op, ObjectPtrHash, ObjectPtrEqual>;
@@ -60,18 +61,39 @@ static std::unordered_map<int64_t, std::string> stream_name_hint = {
     {defuse_tensor_stream_idx, "defuse"},
 };
 
-int IdentifyStream(const Expr& op) {
-  int stream_idx = compute_stream_idx;
-  if (op->IsInstance<CallNode>() && IsCollectiveOp(op.as<CallNode>()->op)) {
-    stream_idx = communication_stream_idx;
-    // if need fuse_tensor before collective op, previous stream should be memory copy stream
-  } else if (op->IsInstance<CallNode>() && IsFuseTensorOp(op.as<CallNode>()->op)) {
-    // if already have memcpy ops in the graph.
-    stream_idx = fuse_tensor_stream_idx;
-  } else if (op->IsInstance<CallNode>() && IsDefuseTensorOp(op.as<CallNode>()->op)) {
-    stream_idx = defuse_tensor_stream_idx;
+std::string GetStreamNameHint(int64_t stream_idx) {
+  int lane = stream_pool::CommStreamLane(stream_idx);
+  if (lane > 0) {
+    return "comm" + std::to_string(lane);
   }
-  return stream_idx;
+  return stream_name_hint[stream_idx];
+}
+
+/*!
+ * \brief Get the class of a collective, i.e., its op and ranks. The collectives of a class are
+ * launched on the same communication stream, so they run in the program order.
+ */
+std::string GetCollectiveClass(const CallNode* call) {
+  static auto fschema_index = Op::GetAttrMap<FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+  auto op = Downcast<Op>(call->op);
+  auto base_op = IsDialectOp(op) ? GetBaseOp(op) : op;
+  std::ostringstream os;
+  os << base_op->name;
+  int index = fschema_index.count(base_op) ? fschema_index[base_op]("rank_list") : -1;
+  if (index >= 0 && index < static_cast<int>(call->args.size())) {
+    if (const auto* node = call->args[index].as<ConstantNode>()) {
+      auto value = ConstantExtractValue(GetRef<Constant>(node));
+      if (const auto* groups = value.as<TupleValueObj>()) {
+        for (const auto& group : groups->fields) {
+          os << "|";
+          for (const auto& rank : Downcast<TupleValue>(group)->fields) {
+            os << Downcast<IntValue>(rank)->value << ",";
+          }
+        }
+      }
+    }
+  }
+  return os.str();
 }
 
 class SyncAnalyzer : ExprVisitor {
@@ -156,7 +178,7 @@ class SyncAnalyzer : ExprVisitor {
   // (previous_op_stream_idx_) is different from the executing stream
   // of the current op. It also updates previous_op_stream_idx_.
   void UpdateStreamInfo_(const Expr& op) {
-    idx_stream_map[current_idx_] = IdentifyStream(op);
+    idx_stream_map[current_idx_] = IdentifyStream_(op);
     int expected_stream_idx = idx_stream_map[current_idx_];
     if (previous_op_stream_idx_ == -1 || previous_op_stream_idx_ != expected_stream_idx) {
       // if the current op is the first op or last op's stream is not the stream for current op
@@ -165,6 +187,32 @@ class SyncAnalyzer : ExprVisitor {
     }
   }
 
+  // Identify the stream of an op. The collectives are spread over the communication streams by
+  // their classes in the order of the first appearance, which is the same on all ranks. Each
+  // stream uses its own communicator instances (see Communicator::Get), so the collectives on
+  // different streams can run concurrently without interleaving on one NCCL communicator.
+  int IdentifyStream_(const Expr& op) {
+    const auto* call = op.as<CallNode>();
+    if (call == nullptr) {
+      return compute_stream_idx;
+    }
+    if (IsCollectiveOp(call->op)) {
+      auto cls = GetCollectiveClass(call);
+      auto it = collective_lanes_.find(cls);
+      if (it == collective_lanes_.end()) {
+        int lane = collective_lanes_.size() % num_comm_streams_;
+        it = collective_lanes_.emplace(cls, lane).first;
+      }
+      return stream_pool::CommStreamIndex(it->second);
+    } else if (IsFuseTensorOp(call->op)) {
+      // if need fuse_tensor before collective op, previous stream should be memory copy stream
+      return fuse_tensor_stream_idx;
+    } else if (IsDefuseTensorOp(call->op)) {
+      return defuse_tensor_stream_idx;
+    }
+    return compute_stream_idx;
+  }
+
   // This function is called once for every op during ANF expansion. It updates the
   // last input producer and first output consumer in each stream for each op.
   // The last input producer map is updated as we iterate through the input
@@ -334,10 +382,22 @@ class SyncAnalyzer : ExprVisitor {
     return idx_stream_map[i] == idx_stream_map[j];
   }
 
+  // Create the events of the pruned dependencies. An event recorded after an op covers all the
+  // consumers of the op, so the consumers on different streams wait for the same event instead of
+  // one event per dependency. The events are numbered in the ANF order of their producers, so the
+  // result does not depend on the iteration order of dep_set.
   void CreateEventsUsingDepSet_(DepSet& dep_set) {
-    for (auto& dep_pair : dep_set) {
-      add_event_after_op[dep_pair.first].push_back(GetUniqueEventId());
-      wait_event_before_op[dep_pair.second].push_back(add_event_after_op[dep_pair.first].back());
+    std::vector<std::pair<int, int>> deps(dep_set.begin(), dep_set.end());
+    std::sort(deps.begin(), deps.end());
+    for (auto& dep_pair : deps) {
+      auto& events = add_event_after_op[dep_pair.first];
+      if (events.empty()) {
+        events.push_back(GetUniqueEventId());
+      }
+      wait_event_before_op[dep_pair.second].push_back(events.back());
+    }
+    for (auto& op_and_events : wait_event_before_op) {
+      std::sort(op_and_events.second.begin(), op_and_events.second.end());
     }
   }
 
@@ -353,6 +413,11 @@ class SyncAnalyzer : ExprVisitor {
 
   // counter to generate unique event ids.
   int next_unique_event_id_ = 1;
+  // the number of communication streams.
+  int num_comm_streams_ = std::min(DistConfig::Global()->num_comm_streams,
+                                   stream_pool::kMaxCommStreams);
+  // maps the class of each collective to its communication lane.
+  std::unordered_map<std::string, int> collective_lanes_;
 
   // index refers to the order of an op in the input ANF expression.
   // map each Call, Tuple or TupleGetItem op to the index of the last producer of the op's inputs
@@ -372,10 +437,16 @@ class SyncEnforcer : ExprVisitor {
    *
    * Specifically,
    *    1. It inserts a set_stream(device_id, stream_idx) if the op requires the stream be switched
-   *       before its execution.
+   *       before its execution. If "raf.stream_schedule.use_priority" is set, the communication
+   *       stream is set with the high priority, i.e., set_stream(device_id, stream_idx, 1), so that
+   *       the collectives are not delayed by the computation. With DistConfig::num_comm_streams
+   *       larger than 1, the classes of collectives (the op and the ranks) are spread over the
+   *       communication streams, and the collectives on different streams only wait for each
+   *       other through the events of their data dependencies.
    *
    *    2. It inserts an add_event(unique_event_id, stream_idx) after an op if the following op
-   * depends on it executes on a different stream.
+   * depends on it executes on a different stream. The consumers on all the other streams share
+   * the event.
    *
    *    3. It inserts a wait_event(unique_event_id, stream_idx) before an op if the previous op it
    * depends on executes on a different stream.
@@ -490,6 +561,9 @@ class SyncEnforcer : ExprVisitor {
       return GetRef<Function>(func_);
     }
 
+    use_priority_ = PassContext::Current()
+                        ->GetConfig("raf.stream_schedule.use_priority", tvm::Bool(false))
+                        .value();
     ell_ = std::make_unique<ExplicitLetList>();
     VisitExpr(func_->body);
 
@@ -497,9 +571,15 @@ class SyncEnforcer : ExprVisitor {
   }
 
  protected:
-  Expr CreateSetStreamOp(int64_t device_id, int64_t stream_id) {
+  Expr CreateSetStreamOp(int64_t device_id, int64_t stream_id, int64_t priority = 0) {
     static Op set_stream_op = Op::Get("raf.op.set_stream");
-    return CreateSetStreamOrEventOp_(set_stream_op, device_id, stream_id);
+    Expr call = CreateSetStreamOrEventOp_(set_stream_op, device_id, stream_id);
+    if (priority == 0) {
+      return call;
+    }
+    Array<Expr> args = call.as<CallNode>()->args;
+    args.push_back(MakeConstant(value::ScalarValue::make(priority)));
+    return Call(set_stream_op, args);
   }
 
   Expr CreateAddEventOp(int64_t event_id, int64_t stream_id) {
@@ -515,7 +595,7 @@ class SyncEnforcer : ExprVisitor {
   inline void AddEvent(int idx) {
     if (analyzer_.add_event_after_op.count(idx)) {
       int stream = analyzer_.idx_stream_map[idx];
-      std::string add_event_var_name = stream_name_hint[stream] + "_add_event";
+      std::string add_event_var_name = GetStreamNameHint(stream) + "_add_event";
       for (auto event_id : analyzer_.add_event_after_op[idx]) {
         Var add_event_var = raf::ir::MakeVar(add_event_var_name, {});
         Expr add_event_value = CreateAddEventOp(event_id, stream);
@@ -526,11 +606,14 @@ class SyncEnforcer : ExprVisitor {
 
   inline void SetStreamAndWaitEvent(int idx) {
     int stream = analyzer_.idx_stream_map[idx];
-    std::string var_name_hint = stream_name_hint[stream];
+    std::string var_name_hint = GetStreamNameHint(stream);
     if (analyzer_.set_stream_before_op[idx]) {
       std::string set_stream_var_name = var_name_hint + "_set_stream";
       Var set_stream_var = raf::ir::MakeVar(set_stream_var_name, {});
-      Expr set_stream_value = CreateSetStreamOp(device_id_, stream);
+      int64_t priority = use_priority_ && stream_pool::CommStreamLane(stream) >= 0
+                             ? stream_pool::kHighPriority
+                             : stream_pool::kDefaultPriority;
+      Expr set_stream_value = CreateSetStreamOp(device_id_, stream, priority);
       ell_->Push(set_stream_var, set_stream_value);
     }
     if (analyzer_.wait_event_before_op.count(idx)) {
@@ -552,6 +635,8 @@ class SyncEnforcer : ExprVisitor {
   }
 
   int device_id_ = -1;
+  /*! \brief Whether to launch the collectives on a high-priority stream. */
+  bool use_priority_ = false;
   const FunctionNode* func_;
   SyncAnalyzer analyzer_;
   std::unique_ptr<ExplicitLetList> ell_;
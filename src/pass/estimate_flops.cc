@@ -55,16 +55,15 @@ void FLOPSEstimater::VisitExpr_(const LetNode* op) {
   ExpandANormalForm(op, pre_visit, post_visit);
 }
 
-void FLOPSEstimater::VisitExpr_(const CallNode* call) {
+float EstimateCallGFLOPS(const Call& call, const Device& device, const IRModule& mod) {
   if (call->op.as<OpNode>()) {
     const Op& op = Downcast<Op>(call->op);
     auto base_op = IsDialectOp(op) ? GetBaseOp(op) : op;
     auto tvm_op = OpDialect::Lower(base_op, "tvm");
     // skip this op if it does not have a TVM dialect
     if (!tvm_op.defined()) {
-      var_flops_map_[curr_let_] = std::numeric_limits<float>::infinity();
       LOG(WARNING) << "Op " << base_op->name << " doesn't have TVM dialect, skip estimating FLOPS";
-      return;
+      return std::numeric_limits<float>::infinity();
     }
   }
   Array<Type> param_types;
@@ -102,13 +101,16 @@ void FLOPSEstimater::VisitExpr_(const CallNode* call) {
   } else if (auto gvn = call->op.as<GlobalVarNode>()) {
     // Look up the function body from the module.
     call_values->callee =
-        ClosureValue::make({}, Downcast<Function>(mod_->Lookup(GetRef<GlobalVar>(gvn))));
+        ClosureValue::make({}, Downcast<Function>(mod->Lookup(GetRef<GlobalVar>(gvn))));
   } else {
     LOG(FATAL) << "Unrecognized call op type: " << call->op->GetTypeKey();
     throw;
   }
-  var_flops_map_[curr_let_] =
-      tvm_dialect::CalcFuncGFLOPS(call_values, param_types, ret_type, device_);
+  return tvm_dialect::CalcFuncGFLOPS(call_values, param_types, ret_type, device);
+}
+
+void FLOPSEstimater::VisitExpr_(const CallNode* call) {
+  var_flops_map_[curr_let_] = EstimateCallGFLOPS(GetRef<Call>(call), device_, mod_);
 }
 
 }  // namespace estimate_flops
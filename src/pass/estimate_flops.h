@@ -24,6 +24,17 @@ namespace estimate_flops {
 template <typename T>
 using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
 
+/*!
+ * \brief Estimate the GFLOPS of a call by analyzing the TVM defined arithmetic expression of its
+ * op or fused function.
+ * \param call The call with its type inferred.
+ * \param device The target device.
+ * \param mod The IR module to look up the functions called by global symbols.
+ * \return The GFLOPS, infinity if the op does not have a TVM dialect, or -1 if the FLOPS cannot be
+ * estimated.
+ */
+float EstimateCallGFLOPS(const Call& call, const Device& device, const IRModule& mod);
+
 /*!
  * \brief A visitor to traverse an ANF graph and esitmate the compute FLOPS of each let var
  * that binds to a call expression on the target device. Since we done that by analyzing
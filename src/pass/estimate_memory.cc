@@ -7,6 +7,9 @@
  * \file estimate_memory.cc
  * \brief Estimate the memory footprint. Note that this can only be used after ManifestAlloc pass.
  */
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "raf/device.h"
 #include "raf/op.h"
 #include "raf/op_profiler.h"
@@ -27,6 +30,13 @@ constexpr float kMegaBytes = 1048576;
 
 /*!
  * \brief A visitor to visit after ManifestAlloc ANF IR and estimate the memory footprint.
+ *
+ * If the IR launches ops on multiple streams (i.e., it has set_stream), then the program order
+ * does not reflect the execution order, and the ops on different streams may run concurrently.
+ * In this case, the happens-before relation of the ops is built from the stream order as well as
+ * add_event, wait_event, and stream_barrier. A storage is considered live at an op unless all its
+ * uses happen before the op, or the op happens before all its uses, so the estimated memory at
+ * each op is the worst case of all possible interleavings.
  */
 class MemoryTracer : public ExprVisitor {
  public:
@@ -42,11 +52,19 @@ class MemoryTracer : public ExprVisitor {
   };
 
   MemoryTrace Run() {
+    static const Op& set_stream_op = Op::Get("raf.op.set_stream");
     const auto& vars = ell_->vars;
     const auto& exprs = ell_->exprs;
     CHECK_EQ(vars.size(), exprs.size());
     int n = exprs.size();
 
+    for (const auto& expr : exprs) {
+      const auto* call = expr.as<CallNode>();
+      if (call && call->op.same_as(set_stream_op)) {
+        return RunConcurrent();
+      }
+    }
+
     LOG(INFO) << "Estimating memory footprint...";
     int next_print = 0;
     for (int i = 0; i < n; ++i) {
@@ -75,19 +93,9 @@ class MemoryTracer : public ExprVisitor {
         << "Found a call node that invokes a clusure/function. Did you run ManifestAlloc?";
     if (GetRef<Op>(op_node) == invoke_op) {
       // Invoke ops are the real call nodes in the IR, so create memory trace based on them.
-      // Build OpEnv to get the op name and the possible workspace memory.
-      auto callee_op = let_map_[Downcast<Var>(call->args[0])];
-      auto args = Downcast<Tuple>(let_map_[Downcast<Var>(call->args[1])])->fields;
-      auto callee = pass::InferType(Call(callee_op, args));
-
-      // Use op profiler to build the OpEnv. Note that we only care workspace memory size
-      // and the op name, so we ignore the latency profiling by setting numbers to 0.
-      auto exec_time_and_ws_size = profiler_->ProfileOp(callee, 0, 0, 0);
-      auto op_env = profiler_->GetOpEnv(callee);
-      std::string name = (op_env != nullptr) ? op_env->name() : "unknown";
-      auto ws_size = exec_time_and_ws_size.second / kMegaBytes;
-
-      trace_.push_back({String(name), FloatImm(DataType::Float(32), curr_memoey_mbs_ + ws_size)});
+      auto name_and_ws_size = GetNameAndWorkspace(call);
+      trace_.push_back({String(name_and_ws_size.first),
+                        FloatImm(DataType::Float(32), curr_memoey_mbs_ + name_and_ws_size.second)});
     } else if (GetRef<Op>(op_node) == alloc_storage_op) {
       // Alloc a new buffer.
       auto size = call->args[0].as<ConstantNode>()->value.as<IntValueObj>()->value / kMegaBytes;
@@ -103,6 +111,189 @@ class MemoryTracer : public ExprVisitor {
   }
 
  private:
+  /*!
+   * \brief Get the op name and the workspace memory size in MBs of an invoke_op by building its
+   * OpEnv.
+   */
+  std::pair<std::string, float> GetNameAndWorkspace(const CallNode* call) {
+    auto callee_op = let_map_[Downcast<Var>(call->args[0])];
+    auto args = Downcast<Tuple>(let_map_[Downcast<Var>(call->args[1])])->fields;
+    auto callee = pass::InferType(Call(callee_op, args));
+
+    // Use op profiler to build the OpEnv. Note that we only care workspace memory size
+    // and the op name, so we ignore the latency profiling by setting numbers to 0.
+    auto exec_time_and_ws_size = profiler_->ProfileOp(callee, 0, 0, 0);
+    auto op_env = profiler_->GetOpEnv(callee);
+    std::string name = (op_env != nullptr) ? op_env->name() : "unknown";
+    return {name, exec_time_and_ws_size.second / kMegaBytes};
+  }
+
+  /*! \brief Get the int value of a constant argument. */
+  int64_t GetIntArg(const Expr& arg) {
+    return arg.as<ConstantNode>()->value.as<IntValueObj>()->value;
+  }
+
+  /*! \brief Estimate the worst-case memory footprint of the IR with multiple streams. */
+  MemoryTrace RunConcurrent() {
+    static const Op& alloc_storage_op = Op::Get("raf.op.vm.alloc_storage");
+    static const Op& alloc_tensor_op = Op::Get("raf.op.vm.alloc_tensor");
+    static const Op& set_shape_op = Op::Get("raf.op.vm.set_shape");
+    static const Op& free_op = Op::Get("raf.op.vm.free");
+    static const Op& invoke_op = Op::Get("raf.op.vm.invoke_op");
+    static const Op& set_stream_op = Op::Get("raf.op.set_stream");
+    static const Op& add_event_op = Op::Get("raf.op.add_event");
+    static const Op& wait_event_op = Op::Get("raf.op.wait_event");
+    static const Op& stream_barrier_op = Op::Get("raf.op.stream_barrier");
+    using VarMap = std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual>;
+
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    LOG(INFO) << "Estimating memory footprint with multiple streams...";
+
+    // The invoke ops with their names, workspace sizes, predecessors, and used storages.
+    std::vector<std::pair<std::string, float>> nodes;
+    std::vector<std::vector<int>> preds;
+    std::unordered_map<Var, std::vector<int>, ObjectPtrHash, ObjectPtrEqual> storage_users;
+    // The storage var of each tensor var.
+    VarMap tensor_to_storage;
+    // The storages that are freed in the IR. Others (e.g., outputs) live until the end.
+    std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> freed_storages;
+    // The last op of each stream, the op of each event, and the ops to wait for each stream.
+    std::unordered_map<int64_t, int> last_node;
+    std::unordered_map<int64_t, int> event_node;
+    std::unordered_map<int64_t, std::vector<int>> pending_waits;
+    int64_t curr_stream = 0;
+
+    auto add_user = [&](const Expr& tensor, int node) {
+      if (const auto* var = tensor.as<VarNode>()) {
+        auto it = tensor_to_storage.find(GetRef<Var>(var));
+        if (it != tensor_to_storage.end()) {
+          storage_users[it->second].push_back(node);
+        }
+      }
+    };
+
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      let_map_.Set(vars[i], exprs[i]);
+      if (const auto* var = exprs[i].as<VarNode>()) {
+        // Aliasing.
+        auto it = tensor_to_storage.find(GetRef<Var>(var));
+        if (it != tensor_to_storage.end()) {
+          tensor_to_storage[vars[i]] = it->second;
+        }
+        continue;
+      }
+      const auto* call = exprs[i].as<CallNode>();
+      if (!call || !call->op.as<OpNode>()) {
+        continue;
+      }
+      auto op = Downcast<Op>(call->op);
+      if (op == alloc_storage_op) {
+        storage_vars_[vars[i]] = GetIntArg(call->args[0]) / kMegaBytes;
+      } else if (op == alloc_tensor_op) {
+        tensor_to_storage[vars[i]] = Downcast<Var>(call->args[0]);
+      } else if (op == set_shape_op) {
+        auto it = tensor_to_storage.find(Downcast<Var>(call->args[0]));
+        if (it != tensor_to_storage.end()) {
+          tensor_to_storage[vars[i]] = it->second;
+        }
+      } else if (op == free_op) {
+        freed_storages.insert(Downcast<Var>(call->args[0]));
+      } else if (op == set_stream_op) {
+        curr_stream = GetIntArg(call->args[1]);
+      } else if (op == add_event_op || op == wait_event_op) {
+        auto event_id = GetIntArg(call->args[0]);
+        auto stream = curr_stream;
+        if (call->args.size() > 1 && GetIntArg(call->args[1]) != -1) {
+          stream = GetIntArg(call->args[1]);
+        }
+        if (op == add_event_op) {
+          auto it = last_node.find(stream);
+          event_node[event_id] = (it != last_node.end()) ? it->second : -1;
+        } else if (event_node.count(event_id) > 0 && event_node[event_id] != -1) {
+          pending_waits[stream].push_back(event_node[event_id]);
+        }
+      } else if (op == stream_barrier_op) {
+        // All streams wait for the last ops of all streams.
+        std::vector<int> barrier;
+        for (const auto& kv : last_node) {
+          barrier.push_back(kv.second);
+        }
+        for (const auto& kv : last_node) {
+          auto& waits = pending_waits[kv.first];
+          waits.insert(waits.end(), barrier.begin(), barrier.end());
+        }
+        barrier_nodes_ = barrier;
+        barrier_streams_.clear();
+      } else if (op == invoke_op) {
+        int node = nodes.size();
+        nodes.push_back(GetNameAndWorkspace(call));
+        std::vector<int> node_preds = pending_waits[curr_stream];
+        pending_waits[curr_stream].clear();
+        if (last_node.count(curr_stream) > 0) {
+          node_preds.push_back(last_node[curr_stream]);
+        } else if (barrier_streams_.insert(curr_stream).second) {
+          // A stream that has no op before the last barrier still waits for the barrier.
+          node_preds.insert(node_preds.end(), barrier_nodes_.begin(), barrier_nodes_.end());
+        }
+        preds.push_back(node_preds);
+        last_node[curr_stream] = node;
+        for (size_t j = 1; j <= 2; ++j) {
+          auto tuple = let_map_[Downcast<Var>(call->args[j])].as<TupleNode>();
+          if (tuple) {
+            for (const auto& field : tuple->fields) {
+              add_user(field, node);
+            }
+          }
+        }
+      }
+    }
+
+    // Build the happens-before relation as the bitsets of ancestors.
+    int n_nodes = nodes.size();
+    int n_words = (n_nodes + 63) / 64;
+    std::vector<std::vector<uint64_t>> ancestors(n_nodes, std::vector<uint64_t>(n_words, 0));
+    for (int i = 0; i < n_nodes; ++i) {
+      for (int pred : preds[i]) {
+        for (int w = 0; w < n_words; ++w) {
+          ancestors[i][w] |= ancestors[pred][w];
+        }
+        ancestors[i][pred / 64] |= (1ULL << (pred % 64));
+      }
+    }
+    auto happens_before = [&](int a, int b) {
+      return (ancestors[b][a / 64] >> (a % 64)) & 1ULL;
+    };
+
+    for (int i = 0; i < n_nodes; ++i) {
+      float curr_mbs = curr_memoey_mbs_;
+      for (const auto& kv : storage_users) {
+        const auto& users = kv.second;
+        bool all_before = freed_storages.count(kv.first) > 0;
+        bool all_after = true;
+        for (int user : users) {
+          all_before = all_before && user != i && happens_before(user, i);
+          all_after = all_after && user != i && happens_before(i, user);
+        }
+        if (!all_before && !all_after) {
+          curr_mbs += storage_vars_[kv.first];
+        }
+      }
+      trace_.push_back(
+          {String(nodes[i].first), FloatImm(DataType::Float(32), curr_mbs + nodes[i].second)});
+    }
+
+    // Add the final trace, which includes the storages that are not freed (i.e., the outputs).
+    float out_mbs = curr_memoey_mbs_;
+    for (const auto& kv : storage_vars_) {
+      if (freed_storages.count(kv.first) == 0) {
+        out_mbs += kv.second;
+      }
+    }
+    trace_.push_back({String("out"), FloatImm(DataType::Float(32), out_mbs)});
+    return trace_;
+  }
+
   /*! \brief The current processing let var. */
   Var curr_let_;
   /*! \brief Let binding vars to the expression. */
@@ -122,6 +313,10 @@ class MemoryTracer : public ExprVisitor {
   MemoryTrace trace_;
   /*! \brief Current memory usage. */
   float curr_memoey_mbs_ = 0;
+  /*! \brief The last ops of all streams at the latest stream barrier. */
+  std::vector<int> barrier_nodes_;
+  /*! \brief The streams that have launched ops after the latest stream barrier. */
+  std::unordered_set<int64_t> barrier_streams_;
 };
 
 }  // namespace estimate_memory
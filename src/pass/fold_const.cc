@@ -8,6 +8,7 @@
  * \brief Folding constants
  */
 #include "raf/op.h"
+#include "raf/op_utils.h"
 #include "raf/ir.h"
 #include "raf/value.h"
 #include "raf/pass.h"
@@ -55,6 +56,15 @@ class ConstantChecker : private ExprVisitor {
 
 class ConstantFolder : public ExprMutator {
  public:
+  /*!
+   * \brief The constant folder.
+   * \param prepack_device The device type to pre-pack the constant weights for, or undefined to
+   * keep the weights in their layouts.
+   */
+  explicit ConstantFolder(DevType prepack_device = DevType::kUnknown())
+      : prepack_device_(prepack_device) {
+  }
+
   Expr VisitExpr_(const LetNode* op) final {
     auto pre_visit = [this](const LetNode* op) {
       // Rely on the Memoizer to cache pre-visit values
@@ -117,7 +127,7 @@ class ConstantFolder : public ExprMutator {
     if (all_const_args) {
       return ConstEvaluate(res);
     } else {
-      return res;
+      return PrepackWeight(res);
     }
   }
 
@@ -138,6 +148,47 @@ class ConstantFolder : public ExprMutator {
  private:
   // Internal constant checker
   ConstantChecker checker_;
+  // The device type to pre-pack the constant weights for
+  DevType prepack_device_;
+
+  /*!
+   * \brief Pre-pack the constant weight of a GEMM into the layout preferred by the kernel of the
+   * target at compile time, so that the kernel neither transposes it at runtime nor picks a slower
+   * path. On CPU, TVM schedules dense (x * w^T) and batch_matmul_nt with the packed templates, but
+   * the other GEMM variants with the generic injective schedule. The GEMM libraries on GPU take
+   * all the variants natively, so the weights are kept as they are.
+   */
+  Expr PrepackWeight(const Expr& expr) {
+    static const Op& matmul_op = Op::Get("raf.op.matmul");
+    static const Op& matmul_nt_op = Op::Get("raf.op.matmul_nt");
+    static const Op& dense_op = Op::Get("raf.op.dense");
+    static const Op& batch_matmul_op = Op::Get("raf.op.batch_matmul");
+    static const Op& batch_matmul_nt_op = Op::Get("raf.op.batch_matmul_nt");
+    if (prepack_device_ != DevType::kCPU()) {
+      return expr;
+    }
+    const auto* call = expr.as<CallNode>();
+    if (call->args.size() != 2 || !call->args[1].as<ConstantNode>()) {
+      return expr;
+    }
+    const auto& op = call->op;
+    const auto& x = call->args[0];
+    const auto& w = call->args[1];
+    if (op == matmul_op) {
+      return Call(dense_op, {x, Transpose(w, {1, 0})});
+    } else if (op == matmul_nt_op) {
+      return Call(dense_op, {x, w});
+    } else if (op == batch_matmul_op) {
+      return Call(batch_matmul_nt_op, {x, Transpose(w, {0, 2, 1})});
+    }
+    return expr;
+  }
+
+  // Transpose a constant at compile time.
+  Expr Transpose(const Expr& konst, const std::vector<int64_t>& axes) {
+    static const Op& transpose_op = Op::Get("raf.op.transpose");
+    return ConstEvaluate(Call(transpose_op, {konst, MakeConstant(ArrayToIntTuple(axes))}));
+  }
 
   // Convert value to expression.
   Expr ObjectToExpr(const ObjectRef& value) {
@@ -223,9 +274,15 @@ ir::Expr BindParam(ir::Function func, ir::Array<ir::Expr> args) {
 }
 
 Pass FoldConstant() {
+  PassContext pass_ctx = PassContext::Current();
+  bool prepack = pass_ctx->GetConfig("raf.fold_const.prepack_weights", Bool(false)).value();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(fold_const::ConstantFolder().Mutate(f));
+    DevType prepack_device = DevType::kUnknown();
+    if (prepack) {
+      prepack_device = Device::Current(true).device_type();
+    }
+    return Downcast<Function>(fold_const::ConstantFolder(prepack_device).Mutate(f));
   };
   return CreateRAFFunctionPass(pass_func, 1, "FoldConstant", {});
 }
@@ -234,5 +291,7 @@ RAF_REGISTER_GLOBAL("raf.pass_.is_constant").set_body_typed(IsConstant);
 RAF_REGISTER_GLOBAL("raf.pass_.FoldConstant").set_body_typed(FoldConstant);
 RAF_REGISTER_GLOBAL("raf.pass_.BindParam").set_body_typed(BindParam);
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.fold_const.prepack_weights", Bool);
+
 }  // namespace pass
 }  // namespace raf
@@ -438,6 +438,25 @@ IRModule ApplyTransformSeq(const IRModule& mod) {
   return seq(mod);
 }
 
+/*! \brief Convert a Relay function to RAF. It only reads the function, so it runs in parallel. */
+Function ConvertFunction(const Function& func) {
+  // Partition RAF-specific Relay simplify patterns
+  auto updated_func = PartitionPatterns(func);
+
+  // Transform to ANF and convert Relay ops to RAF ops
+  auto anf_expr = Downcast<Function>(tvm::relay::transform::ToANormalForm(updated_func));
+  auto mutator = from_relay::FromRelayMutator();
+  updated_func = Downcast<Function>(mutator.Mutate(anf_expr));
+
+  // Check unsupported ops
+  auto unsupported_ops_str = mutator.ListUnsupportedOps();
+  if (!unsupported_ops_str.empty()) {
+    LOG(FATAL) << "One or more ops cannot be converted:\n" << unsupported_ops_str;
+    throw;
+  }
+  return updated_func;
+}
+
 Pass FromRelay(Array<String> disabled_pass) {
   TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule m, PassContext pc) {
     IRModule updated_mod = IRModule(m->functions, m->type_definitions, m->Imports(), m->source_map);
@@ -451,35 +470,15 @@ Pass FromRelay(Array<String> disabled_pass) {
       updated_mod = ApplyTransformSeq(updated_mod);
     }
 
-    // Convert each function
-    std::vector<std::pair<GlobalVar, Function>> updates;
-    for (const auto& it : updated_mod->functions) {
-      if (auto* n = it.second.as<FunctionNode>()) {
-        Function func = GetRef<Function>(n);
-
-        // Partition RAF-specific Relay simplify patterns
-        auto updated_func = PartitionPatterns(func);
-
-        // Transform to ANF and convert Relay ops to RAF ops
-        auto anf_expr = Downcast<Function>(tvm::relay::transform::ToANormalForm(updated_func));
-        auto mutator = from_relay::FromRelayMutator();
-        updated_func = Downcast<Function>(mutator.Mutate(anf_expr));
-
-        // Check unsupported ops
-        auto unsupported_ops_str = mutator.ListUnsupportedOps();
-        if (!unsupported_ops_str.empty()) {
-          LOG(FATAL) << "One or more ops cannot be converted:\n" << unsupported_ops_str;
-          throw;
-        }
-        updates.push_back({it.first, updated_func});
-      }
-    }
-
-    for (const auto& pair : updates) {
-      updated_mod->Add(pair.first, pair.second, true);
-    }
+    // Convert each function, using the threads of raf.pass.function_pass_threads in the outer
+    // pass context to convert the functions in parallel.
+    auto num_threads = pc->GetConfig("raf.pass.function_pass_threads", Integer(1)).value();
+    pass_ctx->config.Set("raf.pass.function_pass_threads", num_threads);
+    TypedPackedFunc<Function(Function, IRModule, PassContext)> convert =
+        [](Function f, IRModule m, PassContext pc) { return ConvertFunction(f); };
     {
       tvm::With<pass::PassContext> ctx_scope(pass_ctx);
+      updated_mod = CreateRAFFunctionPass(convert, 0, "FromRelayConvert", {}, true)(updated_mod);
       updated_mod = DeadCodeElimination()(updated_mod);
     }
     return updated_mod;
@@ -0,0 +1,247 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file fuse_batch_norm_relu.cc
+ * \brief Fuse batch_norm_train followed by relu, and optionally a residual add, into
+ * batch_norm_relu_train, whose backward does not keep the intermediate tensors.
+ */
+#include <unordered_map>
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace fuse_batch_norm_relu {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+template <typename T>
+using VarMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
+
+/*! \brief Count the uses of each variable in the bindings and the return value. */
+class UseCounter : public ExprVisitor {
+ public:
+  void VisitExpr(const Expr& expr) final {
+    // The visited variables are memoized by ExprVisitor, so they are counted here.
+    if (const auto* var = expr.as<VarNode>()) {
+      ++uses[GetRef<Var>(var)];
+      return;
+    }
+    ExprVisitor::VisitExpr(expr);
+  }
+
+  VarMap<int> uses;
+};
+
+/*! \brief Whether the argument is a null constant, such as the omitted out of add. */
+inline bool IsNullArg(const Expr& expr) {
+  const auto* konst = expr.as<ConstantNode>();
+  return konst != nullptr && !konst->value.defined();
+}
+
+/*!
+ * \brief Fuse the batch_norm_train + (add +) relu chains in an ANF function. The output of
+ * batch_norm_train and of the add must only be used by the chain, and the residual input must be
+ * defined before batch_norm_train, where the fused call is placed. The fused call keeps the
+ * running mean and variance at the same fields, so their uses are unchanged. For example:
+ *   let %a = raf.op.batch_norm_train(%x, %m, %v, %w, %b, 0.1, 1e-05);
+ *   let %a0 = %a.0;
+ *   let %s = raf.op.add(%a0, %z, nullptr, nullptr);
+ *   let %r = raf.op.relu(%s);
+ *
+ * becomes:
+ *   let %a = raf.op.batch_norm_relu_train(%x, %m, %v, %w, %b, %z, 0.1, 1e-05, "NCHW");
+ *   let %r = %a.0;
+ */
+class BatchNormReluFuser {
+ public:
+  explicit BatchNormReluFuser(const Function& func) : func_(func) {
+  }
+
+  Function Run() {
+    static const Op& relu_op = Op::Get("raf.op.relu");
+    if (!func_->body.as<LetNode>()) {
+      return func_;
+    }
+    ell_ = ExplicitLetList::make(func_->body);
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    UseCounter counter;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      pos_[vars[i]] = i;
+      counter(exprs[i]);
+      if (const auto* item = exprs[i].as<TupleGetItemNode>()) {
+        if (const auto* tuple = item->tuple.as<VarNode>()) {
+          ++item_uses_[GetRef<Var>(tuple)];
+        }
+      }
+    }
+    counter(ell_->ret);
+    uses_ = std::move(counter.uses);
+
+    new_exprs_ = exprs;
+    removed_.assign(exprs.size(), false);
+    bool changed = false;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      const auto* call = exprs[i].as<CallNode>();
+      if (call && call->op.same_as(relu_op)) {
+        changed |= FuseAt(i);
+      }
+    }
+    if (!changed) {
+      return func_;
+    }
+    LetList ll;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      if (!removed_[i]) {
+        ll.Push(vars[i], new_exprs_[i]);
+      }
+    }
+    Expr body = ll.Get(ell_->ret);
+    return Function(func_->params, body, func_->ret_type, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Fuse the chain that ends at the relu binding. */
+  bool FuseAt(size_t relu_idx) {
+    static const Op& add_op = Op::Get("raf.op.add");
+    static const Op& bn_op = Op::Get("raf.op.batch_norm_train");
+    static const Op& fused_op = Op::Get("raf.op.batch_norm_relu_train");
+
+    const auto& vars = ell_->vars;
+    const Expr& relu_in = Downcast<Call>(new_exprs_[relu_idx])->args[0];
+    int in_idx = GetBindingIndex(relu_in);
+    if (in_idx < 0 || uses_[vars[in_idx]] != 1) {
+      return false;
+    }
+    // The index of the binding of %a.0, and of the add if any.
+    int item_idx = in_idx;
+    int add_idx = -1;
+    Expr z = MakeConstant(NullValue<Value>());
+    if (const auto* add = new_exprs_[in_idx].as<CallNode>()) {
+      if (!add->op.same_as(add_op) || !IsNullArg(add->args[2]) || !IsNullArg(add->args[3])) {
+        return false;
+      }
+      add_idx = in_idx;
+      item_idx = -1;
+      for (int i = 0; i < 2 && item_idx < 0; ++i) {
+        int idx = GetBindingIndex(add->args[i]);
+        if (idx >= 0 && IsBatchNormItem0(idx)) {
+          item_idx = idx;
+          z = add->args[1 - i];
+        }
+      }
+      if (item_idx < 0 || uses_[vars[item_idx]] != 1) {
+        return false;
+      }
+      // The residual input is not broadcast.
+      if (!tvm::StructuralEqual()(z->checked_type(), vars[item_idx]->checked_type())) {
+        return false;
+      }
+    } else if (!IsBatchNormItem0(item_idx)) {
+      return false;
+    }
+
+    const auto& item = Downcast<TupleGetItem>(new_exprs_[item_idx]);
+    const auto& tuple = Downcast<Var>(item->tuple);
+    int bn_idx = pos_.at(tuple);
+    const auto* bn = new_exprs_[bn_idx].as<CallNode>();
+    if (bn == nullptr || !bn->op.same_as(bn_op) || uses_[tuple] != item_uses_[tuple]) {
+      return false;
+    }
+    if (const auto* z_var = z.as<VarNode>()) {
+      auto it = pos_.find(GetRef<Var>(z_var));
+      if (it != pos_.end() && static_cast<int>(it->second) >= bn_idx) {
+        return false;
+      }
+    }
+    const auto& args = bn->args;
+    new_exprs_[bn_idx] = Call(fused_op, {args[0], args[1], args[2], args[3], args[4], z, args[5],
+                                         args[6], MakeConstant(StringValue::make("NCHW"))});
+    removed_[item_idx] = true;
+    if (add_idx >= 0) {
+      removed_[add_idx] = true;
+    }
+    new_exprs_[relu_idx] = TupleGetItem(tuple, 0);
+    return true;
+  }
+
+  /*! \brief The index of the binding of the variable, or -1 if it is not bound in the body. */
+  int GetBindingIndex(const Expr& expr) const {
+    const auto* var = expr.as<VarNode>();
+    if (var == nullptr) {
+      return -1;
+    }
+    auto it = pos_.find(GetRef<Var>(var));
+    return it == pos_.end() ? -1 : static_cast<int>(it->second);
+  }
+
+  /*! \brief Whether the binding is the only %a.0 of an unfused batch_norm_train. */
+  bool IsBatchNormItem0(int idx) const {
+    static const Op& bn_op = Op::Get("raf.op.batch_norm_train");
+    const auto* item = new_exprs_[idx].as<TupleGetItemNode>();
+    if (item == nullptr || item->index != 0) {
+      return false;
+    }
+    int bn_idx = GetBindingIndex(item->tuple);
+    if (bn_idx < 0) {
+      return false;
+    }
+    const auto* bn = new_exprs_[bn_idx].as<CallNode>();
+    if (bn == nullptr || !bn->op.same_as(bn_op)) {
+      return false;
+    }
+    // Another use of %a.0 would see the relu output after the fusion.
+    for (size_t i = 0; i < new_exprs_.size(); ++i) {
+      const auto* other = new_exprs_[i].as<TupleGetItemNode>();
+      if (static_cast<int>(i) != idx && other && other->index == 0 &&
+          other->tuple.same_as(item->tuple)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*! \brief The function to be fused. */
+  Function func_;
+  /*! \brief The let list of the function body. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The bindings, which are updated in place by the fusion. */
+  std::vector<Expr> new_exprs_;
+  /*! \brief Whether each binding is removed by the fusion. */
+  std::vector<bool> removed_;
+  /*! \brief The index of the binding of each variable. */
+  VarMap<size_t> pos_;
+  /*! \brief The number of uses of each variable. */
+  VarMap<int> uses_;
+  /*! \brief The number of the TupleGetItem bindings of each variable. */
+  VarMap<int> item_uses_;
+};
+
+}  // namespace fuse_batch_norm_relu
+
+Pass FuseBatchNormRelu() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return fuse_batch_norm_relu::BatchNormReluFuser(f).Run();
+      };
+  auto fuse_pass = CreateRAFFunctionPass(pass_func, 1, "FuseBatchNormReluHelper", {});
+  return RAFSequential({InferType(), fuse_pass, InferType()}, "FuseBatchNormRelu");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.FuseBatchNormRelu").set_body_typed(FuseBatchNormRelu);
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.optim.fuse_batch_norm_relu", Bool);
+
+}  // namespace pass
+}  // namespace raf
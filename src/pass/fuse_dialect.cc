@@ -5,7 +5,9 @@
 
 /*!
  * \file src/pass/fuse_dialect.cc
- * \brief Fuse the operators using registered dialect fusion patterns.
+ * \brief Fuse the operators using registered dialect fusion patterns. With the pass config
+ * "raf.dispatch_dialect.profile_guided", a pattern of a single call is only applied if its dialect
+ * is the fastest one for the call, as DispatchDialect selects.
  */
 #include <string>
 #include <unordered_map>
@@ -14,6 +16,7 @@
 #include "raf/op.h"
 #include "raf/ir.h"
 #include "raf/pass.h"
+#include "./common.h"
 
 namespace raf {
 namespace pass {
@@ -56,6 +59,13 @@ class FuseMutator : public ExprMutator {
     single_call_ = (call_set.size() == 1);
   }
 
+  /*! \brief Whether the expression gets an output of a matched call, e.g., the output of dropout
+   * in the pattern layer_norm(add(dropout(x)[0], residual)). */
+  bool IsMatchedTupleGetItem(const Expr& expr) {
+    const auto* tgi = expr.as<TupleGetItemNode>();
+    return tgi && call_set_.count(tgi->tuple);
+  }
+
   /*! \brief Rewrite the matched expression to a fused function. */
   Expr Rewrite(Expr expr) {
     auto body = Mutate(expr);
@@ -97,7 +107,7 @@ class FuseMutator : public ExprMutator {
       new_args = call->args;
     } else {
       for (auto arg : call->args) {
-        if (call_set_.count(arg)) {
+        if (call_set_.count(arg) || IsMatchedTupleGetItem(arg)) {
           new_args.push_back(Mutate(arg));
         } else {
           Type ty;
@@ -140,8 +150,13 @@ class FuseMutator : public ExprMutator {
 
 class DialectPatternRewrite {
  public:
-  DialectPatternRewrite(const IRModule& mod, DevType dev_type, DialectFusePattern pattern)
-      : mod_(mod), dev_type_(dev_type), pattern_(pattern) {
+  DialectPatternRewrite(const IRModule& mod, const Device& device, DialectFusePattern pattern,
+                        bool profile_guided)
+      : mod_(mod),
+        device_(device),
+        dev_type_(device.device_type()),
+        pattern_(pattern),
+        profile_guided_(profile_guided) {
     call_patterns_ = CallPatternExtractor().Extract(pattern_.pattern);
   }
 
@@ -153,6 +168,13 @@ class DialectPatternRewrite {
         call_set.insert((*it).second[0]);
       }
     }
+    if (profile_guided_ && call_set.size() == 1 && pre.as<CallNode>()) {
+      // Leave the call to DispatchDialect if another dialect is faster.
+      auto dialect = ProfileGuidedDialect(Downcast<Call>(pre), device_);
+      if (!dialect.empty() && dialect != pattern_.dialect) {
+        return post;
+      }
+    }
     FuseMutator mutator(mod_, dev_type_, pattern_.dialect, call_set, pattern_.name, func_cache_);
     return mutator.Rewrite(post);
   }
@@ -170,17 +192,21 @@ class DialectPatternRewrite {
  private:
   /*! \brief The working module. */
   const IRModule& mod_;
+  /*! \brief The target device. */
+  Device device_;
   /*! \brief The target device type. */
   DevType dev_type_;
   /*! \brief The pattern to be matched. */
   DialectFusePattern pattern_;
+  /*! \brief Whether to check the patterns of single calls against the profiled dialects. */
+  bool profile_guided_;
   /*! \brief A list of variant call patterns extracted from the pattern. */
   std::vector<DFPattern> call_patterns_;
   /*! \brief A cache of already created fused functions. */
   std::unordered_map<std::string, Function> func_cache_;
 };
 
-Expr FuseDialectPatterns(const Expr& expr, const IRModule& mod) {
+Expr FuseDialectPatterns(const Expr& expr, const IRModule& mod, bool profile_guided) {
   auto dev = Device::Current(true);
   if (dev->device_type == DevType::kUnknown() || dev->device_id < 0) {
     LOG(WARNING) << "Device is not specified, skip FuseDialect pass.";
@@ -193,7 +219,7 @@ Expr FuseDialectPatterns(const Expr& expr, const IRModule& mod) {
       continue;
     }
     DLOG(INFO) << "Fuse pattern " << pat.name << " for " << pat.dialect;
-    DialectPatternRewrite rewrite(mod, dev_type, pat);
+    DialectPatternRewrite rewrite(mod, dev, pat, profile_guided);
     ret = RAFRewritePatterns({rewrite.MakeCallback()}, ret, mod);
   }
   return ret;
@@ -202,9 +228,12 @@ Expr FuseDialectPatterns(const Expr& expr, const IRModule& mod) {
 }  // namespace fuse_dialect
 
 Pass FuseDialect() {
+  PassContext pass_ctx = PassContext::Current();
+  bool profile_guided =
+      pass_ctx->GetConfig("raf.dispatch_dialect.profile_guided", Bool(false)).value();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(fuse_dialect::FuseDialectPatterns(f, m));
+    return Downcast<Function>(fuse_dialect::FuseDialectPatterns(f, m, profile_guided));
   };
   return CreateRAFFunctionPass(pass_func, 2, "FuseDialect", {"InferType"});
 }
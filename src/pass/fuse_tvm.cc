@@ -10,9 +10,12 @@
 #include "raf/op.h"
 #include "raf/ir.h"
 #include "raf/binding.h"
+#include "raf/cache.h"
+#include "raf/op_profiler.h"
 #include "raf/pass.h"
 #include "support/arena.h"
 #include "tvm/relay/op_attr_types.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
 #include "./graph_utils.h"
 
 namespace raf {
@@ -655,16 +658,263 @@ class FuseMutator : private ExprMutator {
   }
 };
 
+/*! \brief The cached decision of whether a fused function is faster than its unfused ops. */
+class FusionDecisionCacheEntry {
+ public:
+  FusionDecisionCacheEntry(bool profitable) : profitable_(profitable) {
+  }
+
+  bool Value() const {
+    return profitable_;
+  }
+
+  static FusionDecisionCacheEntry Load(const std::string& path) {
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/value.bin", &data);
+    dmlc::MemoryStringStream reader(&data);
+    dmlc::Stream* stream = &reader;
+    bool profitable;
+    stream->Read(&profitable);
+    return FusionDecisionCacheEntry(profitable);
+  }
+
+  bool Save(const std::string& path) {
+    std::string data;
+    dmlc::MemoryStringStream writer(&data);
+    dmlc::SeekStream* stream = &writer;
+    stream->Write(profitable_);
+    tvm::runtime::SaveBinaryToFile(path + "/value.bin", data);
+    return true;
+  }
+
+ private:
+  bool profitable_;
+};
+
+MetaPersistCache<FusionDecisionCacheEntry> CacheFusionDecision("fuse_tvm_decision");
+
+/*! \brief Count the number of calls in a function body. */
+struct CallCounter : ExprVisitor {
+  int num_calls = 0;
+  void VisitExpr_(const CallNode* call) final {
+    num_calls++;
+    ExprVisitor::VisitExpr_(call);
+  }
+};
+
+/*!
+ * \brief Profile the fused functions generated by the op patterns, and split the ones that are
+ * slower than launching their ops separately. Each op of a split function is wrapped into its own
+ * primitive function, which is the same as what FuseTVM generates for an unfused op.
+ */
+class ProfileGuidedUnfuser : public ExprMutator {
+ public:
+  explicit ProfileGuidedUnfuser(const Device& device)
+      : device_(device), profiler_(op_profiler::OpProfiler::Get(device)) {
+  }
+
+  Expr VisitExpr_(const FunctionNode* fn_node) final {
+    if (fn_node->HasNonzeroAttr(attr::kPrimitive)) {
+      return GetRef<Expr>(fn_node);
+    }
+    return ExprMutator::VisitExpr_(fn_node);
+  }
+
+  Expr VisitExpr_(const CallNode* call) final {
+    auto new_call = Downcast<Call>(ExprMutator::VisitExpr_(call));
+    const auto* func = new_call->op.as<FunctionNode>();
+    if (func == nullptr || !func->HasNonzeroAttr(attr::kPrimitive)) {
+      return new_call;
+    }
+    CallCounter counter;
+    counter(func->body);
+    if (counter.num_calls < 2) {
+      return new_call;
+    }
+    // Infer the types of the ops in the fused function with its parameter types.
+    auto typed_func = Downcast<Function>(pass::InferType(GetRef<Function>(func)));
+    if (IsFusionProfitable(typed_func)) {
+      return new_call;
+    }
+    std::unordered_map<Expr, Expr, ObjectPtrHash, ObjectPtrEqual> param_map;
+    for (size_t i = 0; i < typed_func->params.size(); ++i) {
+      param_map[typed_func->params[i]] = new_call->args[i];
+    }
+    return Unfuse(typed_func->body, &param_map);
+  }
+
+ private:
+  /*! \brief Wrap an op call into a primitive function. Constant arguments are inlined. */
+  Function MakeSingleOpFunction(const CallNode* call) {
+    Array<Var> params;
+    Array<Expr> args;
+    for (const auto& arg : call->args) {
+      if (arg.as<ConstantNode>()) {
+        args.push_back(arg);
+      } else {
+        std::ostringstream os;
+        os << "p" << params.size();
+        auto var = MakeVar(os.str(), arg->checked_type());
+        params.push_back(var);
+        args.push_back(var);
+      }
+    }
+    auto body = Call(call->op, args, call->attrs);
+    auto func = Function(params, body, call->checked_type(), {});
+    func = WithAttr(std::move(func), attr::kPrimitive, Integer(1));
+    func = WithAttr(std::move(func), attr::kDialect, String("tvm"));
+    return func;
+  }
+
+  /*! \brief Get the arguments of a call that are not inlined by MakeSingleOpFunction. */
+  Array<Expr> GetSingleOpArgs(const CallNode* call, const Array<Expr>& new_args) {
+    Array<Expr> args;
+    for (size_t i = 0; i < call->args.size(); ++i) {
+      if (!call->args[i].as<ConstantNode>()) {
+        args.push_back(new_args[i]);
+      }
+    }
+    return args;
+  }
+
+  /*! \brief Profile the function, and return the latency in microseconds. */
+  float ProfileFunction(const Function& func) {
+    Array<Expr> args;
+    for (const auto& param : func->params) {
+      args.push_back(MakeVar(param->name_hint(), param->checked_type()));
+    }
+    auto call = pass::InferType(Call(func, args));
+    auto latency = profiler_->ProfileOp(call).first;
+    CHECK(!latency.empty());
+    return latency[0];
+  }
+
+  /*!
+   * \brief Check whether the fused function is faster than launching its ops separately. The
+   * decision is cached by the function and the device, so the profiling is only done once.
+   */
+  bool IsFusionProfitable(const Function& func) {
+    HashKey key;
+    key << std::string(device_.c_str()) << raf::ir::AsText(func);
+    if (auto entry = CacheFusionDecision.Get(key.byte_vector)) {
+      return entry->Value();
+    }
+    float fused_latency = ProfileFunction(func);
+    float unfused_latency = 0;
+    struct OpCollector : ExprVisitor {
+      std::vector<const CallNode*> calls;
+      void VisitExpr_(const CallNode* call) final {
+        ExprVisitor::VisitExpr_(call);
+        calls.push_back(call);
+      }
+    } collector;
+    collector(func->body);
+    for (const auto* call : collector.calls) {
+      unfused_latency += ProfileFunction(MakeSingleOpFunction(call));
+    }
+    bool profitable = fused_latency <= unfused_latency;
+    DLOG(INFO) << "Fused latency " << fused_latency << " us vs. unfused latency " << unfused_latency
+               << " us for " << collector.calls.size() << " ops";
+    CacheFusionDecision.Set(key.byte_vector, FusionDecisionCacheEntry(profitable));
+    return profitable;
+  }
+
+  /*! \brief Rebuild the body of a fused function with each op wrapped into its own function. */
+  Expr Unfuse(const Expr& expr,
+              std::unordered_map<Expr, Expr, ObjectPtrHash, ObjectPtrEqual>* param_map) {
+    auto it = param_map->find(expr);
+    if (it != param_map->end()) {
+      return it->second;
+    }
+    Expr ret;
+    if (const auto* call = expr.as<CallNode>()) {
+      Array<Expr> new_args;
+      for (const auto& arg : call->args) {
+        new_args.push_back(Unfuse(arg, param_map));
+      }
+      ret = Call(MakeSingleOpFunction(call), GetSingleOpArgs(call, new_args), Attrs());
+    } else if (const auto* tuple = expr.as<TupleNode>()) {
+      Array<Expr> fields;
+      for (const auto& field : tuple->fields) {
+        fields.push_back(Unfuse(field, param_map));
+      }
+      ret = Tuple(fields);
+    } else if (const auto* tuple_get = expr.as<TupleGetItemNode>()) {
+      ret = TupleGetItem(Unfuse(tuple_get->tuple, param_map), tuple_get->index);
+    } else {
+      ret = expr;
+    }
+    param_map->emplace(expr, ret);
+    return ret;
+  }
+
+  /*! \brief The target device. */
+  Device device_;
+  /*! \brief The op profiler. */
+  op_profiler::OpProfiler* profiler_;
+};
+
+/*!
+ * \brief Dispatch the fused functions supported by the nvrtc dialect to it instead of tvm, which
+ * builds the elementwise, broadcast and trailing reduction ops by NVRTC in milliseconds.
+ */
+class NVRTCDialectMarker : public ExprMutator {
+ public:
+  explicit NVRTCDialectMarker(const registry::PackedFunc* fusible) : fusible_(fusible) {
+  }
+
+  Expr VisitExpr_(const FunctionNode* fn_node) final {
+    if (!fn_node->HasNonzeroAttr(attr::kPrimitive)) {
+      return ExprMutator::VisitExpr_(fn_node);
+    }
+    auto func = GetRef<Function>(fn_node);
+    auto dialect = func->GetAttr<String>(attr::kDialect);
+    if (!dialect.defined() || dialect.value() != "tvm") {
+      return func;
+    }
+    bool is_fusible = (*fusible_)(func);
+    return is_fusible ? WithAttr(std::move(func), attr::kDialect, String("nvrtc")) : func;
+  }
+
+ private:
+  /*! \brief Whether a fused function is supported by the nvrtc dialect. */
+  const registry::PackedFunc* fusible_;
+};
+
 }  // namespace fuse_tvm
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.fuse_tvm.profile_guided", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.fuse_tvm.nvrtc", Bool);
+
 Pass FuseTVM() {
   PassContext pass_ctx = PassContext::Current();
+  bool profile_guided = pass_ctx->GetConfig("raf.fuse_tvm.profile_guided", Bool(false)).value();
+  bool nvrtc = pass_ctx->GetConfig("raf.fuse_tvm.nvrtc", Bool(false)).value();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(fuse_tvm::FuseMutator().Transform(f));
+    auto func = Downcast<Function>(fuse_tvm::FuseMutator().Transform(f));
+    if (profile_guided) {
+      auto device = Device::Current();
+      if (device.device_type() == DevType::kUnknown() && device.device_id() == -1) {
+        LOG(WARNING) << "Target device is undefined. Skip profile-guided fusion.";
+        return func;
+      }
+      func = Downcast<Function>(fuse_tvm::ProfileGuidedUnfuser(device).Mutate(func));
+    }
+    if (nvrtc) {
+      // The nvrtc dialect is only registered in the builds with CUDA.
+      const auto* fusible = tvm::runtime::Registry::Get("raf.op.nvrtc.IsFusible");
+      if (fusible == nullptr || Device::Current().device_type() != DevType::kCUDA()) {
+        LOG(WARNING) << "The nvrtc dialect is unavailable on the target device. Skip it.";
+        return func;
+      }
+      func = Downcast<Function>(fuse_tvm::NVRTCDialectMarker(fusible).Mutate(func));
+    }
+    return func;
   };
 
-  Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "FuseTVM", {});
+  // Profiling the fused ops on the device is not safe to run concurrently.
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "FuseTVM", {}, !profile_guided);
   PassInfo pass_info(2, "FuseTVM", {});
   return RAFSequential({InferType(), func_pass}, pass_info);
 }
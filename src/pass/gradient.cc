@@ -113,13 +113,12 @@ struct ReverseAD : public ExprVisitor {
 
   /*!
    * \brief Handling the gradient for the variable node. For var node, we can pass the ograd to
-   * igrads directly
+   * igrads directly, where the undefined (zero) ograds are passed without being materialized.
    */
   void VisitExpr_(const VarNode* node) final {
     Var var = GetRef<Var>(node);
     var_to_primal_expr_[node] = var;
-    const Array<Expr>& ograds = GetOutputGrads();
-    WriteBackInputGrads({GetRef<Expr>(node)}, ograds);
+    WriteBackInputGrads({GetRef<Expr>(node)}, tuple_grads[let_var_.get()]);
   }
 
   /*!
@@ -132,12 +131,12 @@ struct ReverseAD : public ExprVisitor {
 
   /*!
    * \brief Handling the gradient for the Tuple node.
-   * Gradient is a passthrough. We can pass on the ograds directly to igrads.
+   * Gradient is a passthrough. We can pass on the ograds directly to igrads. The undefined
+   * (zero) ograds of the unused fields are not materialized, so the fields get no gradient.
    */
   void VisitExpr_(const TupleNode* node) final {
     var_to_primal_expr_[let_var_.get()] = GetRef<Expr>(node);
-    const Array<Expr>& ograds = GetOutputGrads();
-    WriteBackInputGrads(node->fields, ograds);
+    WriteBackInputGrads(node->fields, tuple_grads[let_var_.get()]);
   }
 
   /*!
@@ -148,11 +147,12 @@ struct ReverseAD : public ExprVisitor {
   void VisitExpr_(const TupleGetItemNode* node) final {
     var_to_primal_expr_[let_var_.get()] = GetRef<Expr>(node);
     const VarNode* tuple = node->tuple.as<VarNode>();
-    const Array<Expr>& ograds = GetOutputGrads();
+    const Array<Expr>& ograds = tuple_grads[let_var_.get()];
     Array<Expr> tuple_igrads = tuple_grads[tuple];
     CHECK_EQ(ograds.size(), 1);
     CHECK_GT(tuple_igrads.size(), node->index);
-    tuple_igrads.Set(node->index, AddTensor(ograds[0], tuple_igrads[node->index]));
+    tuple_igrads.Set(node->index,
+                     AccumulateGrad(tuple, node->index, tuple_igrads[node->index], ograds[0]));
     tuple_grads[tuple] = tuple_igrads;
   }
 
@@ -207,6 +207,9 @@ struct ReverseAD : public ExprVisitor {
     If primal_adjoint_if(node->cond, true_ad_branch, false_ad_branch);
     var_to_primal_expr_[let_var_.get()] = TupleGetItem(primal_adjoint_if, 0);
     var_to_primal_expr_[let_var_.get()]->checked_type_ = node->checked_type();
+    if (IsZeroOutputGrads()) {
+      return;
+    }
 
     // 3) Set up the gradient
     const Array<Expr>& ograds = GetOutputGrads();
@@ -243,11 +246,14 @@ struct ReverseAD : public ExprVisitor {
     if (callee->IsInstance<OpNode>()) {
       // Call node Op is of OpNode Type
       const Op& op = Downcast<Op>(node->op);
+      var_to_primal_expr_[let_var_.get()] = GetRef<Expr>(node);
+      if (IsZeroOutputGrads()) {
+        return;
+      }
       const Array<Expr>& ograds = GetOutputGrads();
       const Array<Expr>& igrads = GetInputGrads(node->args);
       const Array<Expr>& new_igrads = UpdateInputGrads(op, GetRef<Expr>(node), ograds, igrads);
       WriteBackInputGrads(node->args, new_igrads);
-      var_to_primal_expr_[let_var_.get()] = GetRef<Expr>(node);
     } else if (callee->IsInstance<GlobalVarNode>()) {
       // Call node op is global Var node
       // Original
@@ -265,6 +271,9 @@ struct ReverseAD : public ExprVisitor {
       auto primal_adjoint_fn = Call(GetRef<GlobalVar>(gvn), node->args);
       var_to_primal_expr_[let_var_.get()] = TupleGetItem(primal_adjoint_fn, 0);
       var_to_primal_expr_[let_var_.get()]->checked_type_ = node->checked_type();
+      if (IsZeroOutputGrads()) {
+        return;
+      }
       Expr adjoint_func = adjoint_ll_->Push(TupleGetItem(primal_adjoint_fn, 1));
 
       // Now extract ograds, igrads placeholder, update igrads using the adjoint func to get
@@ -301,6 +310,20 @@ struct ReverseAD : public ExprVisitor {
    * for Tuple, we pass on the ograds to igrads as it is.
    * 4) WriteBack - Write the newly computed igrads into igrad placeholders.
    */
+  /*!
+   * \brief Whether all ograds of the current let var are undefined, i.e., symbolic zeros, because
+   * its value is not used by anything that requires gradients. The adjoint of a zero ograd is
+   * zero, so the expression is skipped instead of differentiating materialized zeros.
+   */
+  bool IsZeroOutputGrads() {
+    for (const auto& ograd : tuple_grads[let_var_.get()]) {
+      if (ograd.defined()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   /*!
    * \brief Find the ograds. These have been set by the reverse AD of the operators that come after
    * the current op. Please take a look at the top of this class for high-level description.
@@ -402,10 +425,35 @@ struct ReverseAD : public ExprVisitor {
   }
 
   void WriteBackInputGrad(const VarNode* var, int idx, const Expr& igrad) {
-    Expr grad = AddTensor(tuple_grads[var][idx], igrad);
+    Expr grad = AccumulateGrad(var, idx, tuple_grads[var][idx], igrad);
     tuple_grads[var].Set(idx, grad);
   }
 
+  /*!
+   * \brief Accumulate igrad into the gradient grad of the idx-th field of var. The first sum is
+   * a new tensor owned by the field, so the later igrads are added to it in place, i.e., with the
+   * out argument of add set to the sum, which InplaceUpdate and MemoryPlan turn into a shared
+   * buffer. A sum is never updated in place once it is passed on, as others may read it.
+   */
+  Expr AccumulateGrad(const VarNode* var, int idx, const Expr& grad, const Expr& igrad) {
+    static Op op = Op::Get("raf.op.add");
+    if (!grad.defined() || !igrad.defined()) {
+      return AddTensor(grad, igrad);
+    }
+    auto owner = std::make_pair(var, idx);
+    auto it = accum_owner_.find(grad.get());
+    Expr sum;
+    if (it != accum_owner_.end() && it->second == owner && !igrad.as<TupleNode>()) {
+      sum = adjoint_ll_->Push(Call(op, {grad, igrad, grad, MakeNull()}));
+    } else {
+      sum = AddTensor(grad, igrad);
+    }
+    if (sum->IsInstance<VarNode>()) {
+      accum_owner_[sum.get()] = owner;
+    }
+    return sum;
+  }
+
   bool IsDefined(const Array<Expr>& exprs) {
     for (const auto& e : exprs) {
       if (!e.defined()) {
@@ -766,6 +814,7 @@ struct ReverseAD : public ExprVisitor {
 
  private:  // Init functions
   void Init() {
+    accum_owner_.clear();
     InitRequiresGrad();
     InitTuple();
   }
@@ -896,6 +945,8 @@ struct ReverseAD : public ExprVisitor {
   std::unordered_map<const VarNode*, int> tuple_length;
   /*! \brief A map that tracks the computed grads in reverse AD. */
   std::unordered_map<const VarNode*, Array<Expr>> tuple_grads;
+  /*! \brief A map from the gradient sums to the (var, field index) that owns them. */
+  std::unordered_map<const Object*, std::pair<const VarNode*, int>> accum_owner_;
 };
 
 /*! \brief A helper to canonicalize the IR with AutoDiff if its backward is going to be inlined.
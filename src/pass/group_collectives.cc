@@ -0,0 +1,272 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file group_collectives.cc
+ * \brief Merge the consecutive independent collectives into one NCCL group launch.
+ */
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/ir_ext.h"
+#include "raf/op_utils.h"
+#include "raf/pass.h"
+#include "raf/communicator.h"
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace group_collectives {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+using namespace raf::distributed::communicator;
+
+/*!
+ * \brief Merge the consecutive collectives in the scheduled ANF, e.g., the output of
+ * DataParallelSchedule, into _group_comm ops. Each collective on the communication stream is a
+ * separate NCCL launch with its own latency, which dominates the small collectives such as the
+ * allreduce of a bias gradient. A run of collectives is merged when:
+ *   1. each of them is an allreduce of a single tensor, an allgather along the first axis, or a
+ *      reduce-scatter, on the global communicator;
+ *   2. none of them takes the output of another one in the run as its input;
+ *   3. the reductions in the run use the same computation.
+ * The tuple bindings between the collectives, e.g., the input tuple of an allreduce, are kept in
+ * place, and the other bindings end the run, so that the op order decided by the scheduler is
+ * preserved.
+ *
+ *   let %t0 = (%g0,);
+ *   let %a0 = raf.op._allreduce(%t0, "sum");
+ *   let %a1 = raf.op._reduce_scatter(%g1, "sum");
+ * becomes
+ *   let %t0 = (%g0,);
+ *   let %group_comm_in = (%g0, %g1);
+ *   let %group_comm = raf.op._group_comm(%group_comm_in, [0, 2], "sum");
+ *   let %a0 = %group_comm.0;
+ *   let %a1 = %group_comm.1;
+ */
+class CollectiveGrouper {
+ public:
+  explicit CollectiveGrouper(const FunctionNode* func) : func_(func) {
+  }
+
+  Function Run() {
+    auto ell = ExplicitLetList::make(func_->body);
+    std::vector<Var> vars;
+    std::vector<Expr> exprs;
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      const auto& var = ell->vars[i];
+      const auto& expr = ell->exprs[i];
+      if (const auto* tuple = expr.as<TupleNode>()) {
+        tuples_[var.get()] = tuple;
+      }
+      Member member;
+      if (Match(expr, &member)) {
+        if (!CanJoin(member)) {
+          Flush(&vars, &exprs);
+        }
+        member.var = var;
+        member.value = expr;
+        if (!member.computation.empty()) {
+          computation_ = member.computation;
+        }
+        run_.push_back(member);
+        run_vars_.insert(var.get());
+        continue;
+      }
+      if (expr.as<TupleNode>() && !UsesRun(expr)) {
+        // Keep the tuple bindings in place, as they do not launch anything.
+        vars.push_back(var);
+        exprs.push_back(expr);
+        continue;
+      }
+      Flush(&vars, &exprs);
+      vars.push_back(var);
+      exprs.push_back(expr);
+    }
+    Flush(&vars, &exprs);
+    if (num_groups_ == 0) {
+      return GetRef<Function>(func_);
+    }
+    ell->vars = std::move(vars);
+    ell->exprs = std::move(exprs);
+    DLOG(INFO) << "Merged the collectives into " << num_groups_ << " groups";
+    return Function(func_->params, ell->AsExpr(), {}, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief A collective to be grouped. */
+  struct Member {
+    /*! \brief The variable bound to the output of the collective. */
+    Var var;
+    /*! \brief The collective call. */
+    Expr value;
+    /*! \brief The input tensor of the collective. */
+    Expr input;
+    /*! \brief The collective kind, which is one of GroupCommKind. */
+    int64_t kind;
+    /*! \brief The reduction of the collective, or empty for allgather. */
+    std::string computation;
+  };
+
+  /*! \brief Get the value of a constant argument, or nullptr if it is not a constant. */
+  static Value ConstArg(const CallNode* call, size_t i) {
+    if (i >= call->args.size()) {
+      return Value();
+    }
+    if (const auto* node = call->args[i].as<ConstantNode>()) {
+      return Downcast<Value>(ConstantExtractValue(GetRef<Constant>(node)));
+    }
+    return Value();
+  }
+
+  /*! \brief Get the reduction of a collective, which is "sum" by default. */
+  static bool GetComputation(const CallNode* call, std::string* computation) {
+    if (call->args.size() < 2) {
+      *computation = "sum";
+      return true;
+    }
+    auto value = ConstArg(call, 1);
+    if (const auto* str = value.as<StringValueObj>()) {
+      *computation = str->value;
+      return true;
+    }
+    return false;
+  }
+
+  /*! \brief Check whether a collective runs on the global communicator. */
+  static bool OnGlobalComm(const CallNode* call) {
+    if (call->args.size() < 3) {
+      return true;
+    }
+    return call->args[2].as<ConstantNode>() && !ConstArg(call, 2).defined();
+  }
+
+  /*! \brief Match a collective that can be launched in a group. */
+  bool Match(const Expr& expr, Member* member) {
+    static const Op& allreduce = Op::Get("raf.op._allreduce");
+    static const Op& allgather = Op::Get("raf.op._allgather");
+    static const Op& reduce_scatter = Op::Get("raf.op._reduce_scatter");
+    const auto* call = expr.as<CallNode>();
+    if (call == nullptr || !call->op.as<OpNode>() || call->args.empty() || !OnGlobalComm(call)) {
+      return false;
+    }
+    Op op = Downcast<Op>(call->op);
+    op = IsDialectOp(op) ? GetBaseOp(op) : op;
+    if (op == allreduce) {
+      const TupleNode* tuple = call->args[0].as<TupleNode>();
+      if (const auto* var = call->args[0].as<VarNode>()) {
+        tuple = tuples_.count(var) ? tuples_.at(var) : nullptr;
+      }
+      if (tuple == nullptr || tuple->fields.size() != 1) {
+        return false;
+      }
+      member->input = tuple->fields[0];
+      member->kind = kGroupAllReduce;
+      return GetComputation(call, &member->computation);
+    } else if (op == allgather) {
+      auto axis = ConstArg(call, 1);
+      if (!axis.defined() || GetScalarValueData<int64_t>(axis) != 0) {
+        return false;
+      }
+      member->input = call->args[0];
+      member->kind = kGroupAllGather;
+      member->computation = "";
+      return true;
+    } else if (op == reduce_scatter) {
+      member->input = call->args[0];
+      member->kind = kGroupReduceScatter;
+      return GetComputation(call, &member->computation);
+    }
+    return false;
+  }
+
+  /*! \brief Check whether a collective can join the current run. */
+  bool CanJoin(const Member& member) {
+    if (UsesRun(member.input)) {
+      return false;
+    }
+    return member.computation.empty() || computation_.empty() ||
+           member.computation == computation_;
+  }
+
+  /*! \brief Check whether an expression uses the output of a collective in the current run. */
+  bool UsesRun(const Expr& expr) {
+    if (run_vars_.empty()) {
+      return false;
+    }
+    for (const auto& var : FreeVars(expr)) {
+      if (run_vars_.count(var.get())) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /*! \brief Emit the collectives in the current run, merged if there are more than one. */
+  void Flush(std::vector<Var>* vars, std::vector<Expr>* exprs) {
+    static const Op& group_comm = Op::Get("raf.op._group_comm");
+    if (run_.size() == 1) {
+      vars->push_back(run_[0].var);
+      exprs->push_back(run_[0].value);
+    } else if (run_.size() > 1) {
+      Array<Expr> inputs;
+      Array<Value> kinds;
+      for (const auto& member : run_) {
+        inputs.push_back(member.input);
+        kinds.push_back(ScalarValue::make(member.kind));
+      }
+      auto in_var = MakeVar("group_comm_in", {});
+      auto out_var = MakeVar("group_comm", {});
+      std::string computation = computation_.empty() ? "sum" : computation_;
+      vars->push_back(in_var);
+      exprs->push_back(Tuple(inputs));
+      vars->push_back(out_var);
+      exprs->push_back(Call(group_comm, {in_var, MakeConstant(TupleValue::make(kinds)),
+                                         MakeConstant(StringValue::make(computation))}));
+      for (size_t i = 0; i < run_.size(); ++i) {
+        vars->push_back(run_[i].var);
+        exprs->push_back(TupleGetItem(out_var, i));
+      }
+      ++num_groups_;
+    }
+    run_.clear();
+    run_vars_.clear();
+    computation_.clear();
+  }
+
+  /*! \brief The function to be transformed. */
+  const FunctionNode* func_;
+  /*! \brief The tuples bound in the function body, which are the inputs of allreduce. */
+  std::unordered_map<const VarNode*, const TupleNode*> tuples_;
+  /*! \brief The collectives in the current run. */
+  std::vector<Member> run_;
+  /*! \brief The variables bound to the collectives in the current run. */
+  std::unordered_set<const VarNode*> run_vars_;
+  /*! \brief The reduction of the current run. */
+  std::string computation_;
+  /*! \brief The number of groups created. */
+  int num_groups_ = 0;
+};
+
+}  // namespace group_collectives
+
+Pass GroupCollectives() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return group_collectives::CollectiveGrouper(f.operator->()).Run();
+  };
+  return CreateRAFFunctionPass(pass_func, 0, "GroupCollectives", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.GroupCollectives").set_body_typed(GroupCollectives);
+
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,232 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file horizontal_fuse.cc
+ * \brief Horizontally fuse the independent matmuls with the same shapes into one batch_matmul.
+ */
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace horizontal_fuse {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief The maximum number of matmuls fused into one batch_matmul. */
+constexpr int kMaxGroupSize = 64;
+
+/*!
+ * \brief Check whether the type is a 2D tensor with a static shape.
+ * \param type The type to be checked.
+ * \return Whether the type is a static 2D tensor.
+ */
+inline bool IsStatic2DTensor(const Type& type) {
+  const auto* ttype = type.as<TensorTypeNode>();
+  if (ttype == nullptr || ttype->shape.size() != 2) {
+    return false;
+  }
+  for (const auto& dim : ttype->shape) {
+    if (!dim.as<IntImmNode>()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ * \brief Group the independent matmuls with the same op, shapes, and dtypes in an ANF function,
+ * and replace each group by stacking the operands, a batch_matmul, and splitting the result.
+ *
+ * Two matmuls are independent if they are at the same level of the dataflow graph, where the
+ * level of a binding is one plus the maximum level of the variables it uses. The batched call is
+ * placed at the last matmul of the group, so a group is closed once any of its outputs is used.
+ * For example:
+ *   let %a1 = raf.op.matmul(%x1, %w1);
+ *   let %a2 = raf.op.matmul(%x2, %w2);
+ *   let %b = raf.op.add(%a1, %a2);
+ *
+ * becomes:
+ *   let %x_0 = (%x1, %x2);
+ *   let %x_1 = raf.op.stack(%x_0, 0);
+ *   let %x_2 = (%w1, %w2);
+ *   let %x_3 = raf.op.stack(%x_2, 0);
+ *   let %x_4 = raf.op.batch_matmul(%x_1, %x_3);
+ *   let %x_5 = raf.op.split(%x_4, 2, 0);
+ *   let %x_6 = %x_5.0;
+ *   let %a1 = raf.op.squeeze(%x_6, [0]);
+ *   let %x_7 = %x_5.1;
+ *   let %a2 = raf.op.squeeze(%x_7, [0]);
+ *   let %b = raf.op.add(%a1, %a2);
+ */
+class HorizontalFuser {
+ public:
+  explicit HorizontalFuser(const Function& func) : func_(func) {
+  }
+
+  Function Run() {
+    if (!func_->body.as<LetNode>()) {
+      return func_;
+    }
+    ell_ = ExplicitLetList::make(func_->body);
+    FindGroups();
+    bool changed = false;
+    for (const auto& group : groups_) {
+      changed = changed || group.size() > 1;
+    }
+    if (!changed) {
+      return func_;
+    }
+    return Function(func_->params, Rebuild(), func_->ret_type, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Find the groups of independent matmuls. */
+  void FindGroups() {
+    static const std::unordered_map<std::string, std::string> batched_ops = {
+        {"raf.op.matmul", "raf.op.batch_matmul"},
+        {"raf.op.matmul_nt", "raf.op.batch_matmul_nt"},
+        {"raf.op.matmul_tn", "raf.op.batch_matmul_tn"},
+        {"raf.op.matmul_tt", "raf.op.batch_matmul_tt"}};
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    std::unordered_map<Var, int, ObjectPtrHash, ObjectPtrEqual> level;
+    std::unordered_map<Var, int, ObjectPtrHash, ObjectPtrEqual> var_group;
+    // The open groups keyed by (level, op and operand types).
+    std::map<std::pair<int, std::string>, int> open_groups;
+    auto close_group = [&](int group_id) {
+      for (auto it = open_groups.begin(); it != open_groups.end(); ++it) {
+        if (it->second == group_id) {
+          open_groups.erase(it);
+          return;
+        }
+      }
+    };
+
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      int curr_level = 0;
+      for (const auto& var : FreeVars(exprs[i])) {
+        auto it = level.find(var);
+        if (it != level.end()) {
+          curr_level = std::max(curr_level, it->second + 1);
+        }
+        // The output of a group is used, so no more matmuls can join the group.
+        auto git = var_group.find(var);
+        if (git != var_group.end()) {
+          close_group(git->second);
+        }
+      }
+      level[vars[i]] = curr_level;
+
+      const auto* call = exprs[i].as<CallNode>();
+      const auto* op_node = call ? call->op.as<OpNode>() : nullptr;
+      if (op_node == nullptr || batched_ops.count(op_node->name) == 0) {
+        continue;
+      }
+      CHECK_EQ(call->args.size(), 2U);
+      const auto& a_type = call->args[0]->checked_type();
+      const auto& b_type = call->args[1]->checked_type();
+      if (!IsStatic2DTensor(a_type) || !IsStatic2DTensor(b_type)) {
+        continue;
+      }
+      auto key = std::make_pair(curr_level, op_node->name + "(" + raf::ir::AsText(a_type) + ", " +
+                                                raf::ir::AsText(b_type) + ")");
+      auto it = open_groups.find(key);
+      int group_id;
+      if (it == open_groups.end()) {
+        group_id = groups_.size();
+        groups_.emplace_back();
+        batched_ops_.push_back(Op::Get(batched_ops.at(op_node->name)));
+        open_groups[key] = group_id;
+      } else {
+        group_id = it->second;
+      }
+      groups_[group_id].push_back(i);
+      pos_group_[i] = group_id;
+      var_group[vars[i]] = group_id;
+      if (groups_[group_id].size() == kMaxGroupSize) {
+        close_group(group_id);
+      }
+    }
+  }
+
+  /*! \brief Rebuild the function body with each group replaced by a batch_matmul. */
+  Expr Rebuild() {
+    static const Op& stack_op = Op::Get("raf.op.stack");
+    static const Op& split_op = Op::Get("raf.op.split");
+    static const Op& squeeze_op = Op::Get("raf.op.squeeze");
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    auto axis = MakeConstant(ScalarValue::make(0));
+
+    LetList ll;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      auto it = pos_group_.find(i);
+      if (it == pos_group_.end() || groups_[it->second].size() == 1) {
+        ll.Push(vars[i], exprs[i]);
+        continue;
+      }
+      const auto& group = groups_[it->second];
+      if (group.back() != i) {
+        // The matmul is emitted with the last matmul in the group.
+        continue;
+      }
+      Array<Expr> a_fields, b_fields;
+      for (int pos : group) {
+        const auto* call = exprs[pos].as<CallNode>();
+        a_fields.push_back(call->args[0]);
+        b_fields.push_back(call->args[1]);
+      }
+      auto a = ll.Push(Call(stack_op, {ll.Push(Tuple(a_fields)), axis}));
+      auto b = ll.Push(Call(stack_op, {ll.Push(Tuple(b_fields)), axis}));
+      auto out = ll.Push(Call(batched_ops_[it->second], {a, b}));
+      auto sections = MakeConstant(ScalarValue::make(static_cast<int64_t>(group.size())));
+      auto parts = ll.Push(Call(split_op, {out, sections, axis}));
+      for (size_t j = 0; j < group.size(); ++j) {
+        auto part = ll.Push(TupleGetItem(parts, j));
+        ll.Push(vars[group[j]],
+                Call(squeeze_op, {part, MakeConstant(TupleValue::make({ScalarValue::make(0)}))}));
+      }
+    }
+    return ll.Get(ell_->ret);
+  }
+
+  /*! \brief The function to be fused. */
+  Function func_;
+  /*! \brief The let list of the function body. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The positions of the matmuls in each group. */
+  std::vector<std::vector<int>> groups_;
+  /*! \brief The batched op of each group. */
+  std::vector<Op> batched_ops_;
+  /*! \brief The mapping from the position of a matmul to its group. */
+  std::unordered_map<int, int> pos_group_;
+};
+
+}  // namespace horizontal_fuse
+
+Pass HorizontalFuse() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return horizontal_fuse::HorizontalFuser(f).Run();
+      };
+  auto horizontal_fuse_pass = CreateRAFFunctionPass(pass_func, 1, "HorizontalFuseHelper", {});
+  return RAFSequential({InferType(), horizontal_fuse_pass, InferType()}, "HorizontalFuse");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.HorizontalFuse").set_body_typed(HorizontalFuse);
+
+}  // namespace pass
+}  // namespace raf
@@ -24,11 +24,11 @@ using PackedLiveInMap = Map<Var, Array<Var>>;
 
 namespace liveness_analysis {
 
-MapVSet LivenessAnalyzer::Run() {
+void LivenessAnalyzer::Run() {
   Expr body;
   FormCheck(func_->body);
   if (failure_) {
-    return live_;
+    return;
   }
 
   for (const auto& var : func_->params) {
@@ -56,7 +56,7 @@ MapVSet LivenessAnalyzer::Run() {
 
   // backward analysis
   Var dummy = CreateNull();
-  live_[dummy] = {};
+  live_[dummy] = TensorBitSet();
   Backward(func_->body, dummy);
 
   // init find
@@ -68,16 +68,7 @@ MapVSet LivenessAnalyzer::Run() {
     }
   }
 
-  // init inv
-  for (const auto& kv : live_) {
-    const Var& k = kv.first;
-    const VSet& vs = kv.second;
-    for (const auto& v : vs) {
-      inv_live_[v].insert(k);
-    }
-  }
-
-  // mandatory memory sharing
+  // mandatory memory sharing, where inv_live_ is built by the first Intersect
   CHECK_EQ(var_out_.size(), var_in_.size());
   int m = var_out_.size();
   for (int i = 0; i < m; ++i) {
@@ -99,8 +90,17 @@ MapVSet LivenessAnalyzer::Run() {
       Unite(fin, fout);
     }
   }
+}
 
-  return live_;
+void LivenessAnalyzer::InitInvLive() {
+  if (inv_live_ready_) {
+    return;
+  }
+  inv_live_ready_ = true;
+  for (const auto& kv : live_) {
+    const Var& k = kv.first;
+    kv.second.ForEach([&](size_t i) { inv_live_[tensors_[i]].insert(k); });
+  }
 }
 
 void LivenessAnalyzer::FormChecker::VisitExpr_(const CallNode* node) {
@@ -156,8 +156,8 @@ void LivenessAnalyzer::ForwardAnalyzer::VisitExpr_(const FunctionNode* node) {
 }
 
 void LivenessAnalyzer::ForwardAnalyzer::VisitExpr_(const CallNode* node) {
-  if (node->op->IsInstance<OpNode>() && op::IsReshapeOp(Downcast<Op>(node->op))) {
-    // Reshape ops does not create a new tensor but just a view, so treat them as a direct assign.
+  if (IsViewCall(node)) {
+    // View ops (e.g., reshape) do not create a new tensor, so treat them as a direct assign.
     auto var = node->args[0].as<VarNode>();
     CHECK(var != nullptr) << "Expected the first argument of reshape op to be a Var, but got "
                           << node->args[0]->GetTypeKey();
@@ -252,19 +252,17 @@ Var LivenessAnalyzer::ForwardAnalyzer::Run() {
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const VarNode* node) {
   auto vars = analyzer_->GetTensorVars(GetRef<Var>(node));
   CHECK_EQ(vars.size(), 1U);
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(vars[0])];
+  analyzer_->live_[let_var_] = MergeLive(analyzer_->ToBitSet(vars[0]));
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const FunctionNode* node) {
-  Function f = GetRef<Function>(node);
-  Array<Var> free_vars = FreeVars(f);
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(let_var_)];
+  analyzer_->live_[let_var_] = MergeLive(analyzer_->ToBitSet(let_var_));
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const CallNode* node) {
   const Array<Expr>& args = node->args;
-  if (node->op->IsInstance<OpNode>() && op::IsReshapeOp(Downcast<Op>(node->op))) {
-    // Reshape ops does not create a new tensor but just a view, so treat them as a direct assign.
+  if (IsViewCall(node)) {
+    // View ops (e.g., reshape) do not create a new tensor, so treat them as a direct assign.
     auto var = args[0].as<VarNode>();
     CHECK(var != nullptr) << "Expected the first argument of reshape op to be a Var, but got "
                           << args[0]->GetTypeKey();
@@ -281,9 +279,7 @@ void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const CallNode* node) {
         LOG(FATAL) << "NotImplementedError: unsupported args: " << arg->GetTypeKey();
       }
     }
-    Var d1 = analyzer_->Merge(vargs);
-    Var d2 = MergeLive(d1, let_var_);
-    analyzer_->live_[let_var_] = analyzer_->vset_[d2];
+    analyzer_->live_[let_var_] = MergeLive(analyzer_->ToBitSet(vargs), let_var_);
   }
 }
 
@@ -296,31 +292,29 @@ void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const TupleNode* node) {
       var_fields.push_back(Downcast<Var>(field));
     }
   }
-  Var d1 = analyzer_->Merge(var_fields);
-  Var d2 = MergeLive(d1, let_var_);
-  analyzer_->live_[let_var_] = analyzer_->vset_[d2];
+  analyzer_->live_[let_var_] = MergeLive(analyzer_->ToBitSet(var_fields), let_var_);
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const TupleGetItemNode* node) {
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(let_var_)];
+  analyzer_->live_[let_var_] = MergeLive(analyzer_->ToBitSet(let_var_));
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const IfNode* node) {
-  Var free_true = analyzer_->Merge(FreeVars(node->true_branch));
-  Var free_false = analyzer_->Merge(FreeVars(node->false_branch));
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(
-      analyzer_->Merge({free_true, free_false, Downcast<Var>(node->cond)}), let_var_)];
+  TensorBitSet used = analyzer_->ToBitSet(FreeVars(node->true_branch));
+  used.Union(analyzer_->ToBitSet(FreeVars(node->false_branch)));
+  used.Union(analyzer_->ToBitSet(Downcast<Var>(node->cond)));
+  analyzer_->live_[let_var_] = MergeLive(used, let_var_);
   VisitBranch(node->true_branch, let_var_);
   VisitBranch(node->false_branch, let_var_);
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitBranch(const Expr& branch, const Var& def) {
-  Var total_next = analyzer_->CreateTensorVar("if");
-  // get total live-out variables of true_branch
-  analyzer_->vset_[total_next] = analyzer_->live_[next_var_];
-  // remove the tensors defined at this line
-  Var branch_next = analyzer_->Remove(total_next, def);
-  analyzer_->live_[branch_next] = analyzer_->vset_[branch_next];
+  // the live-out tensors of the branch are the ones at the next line, except the tensors defined
+  // at this line
+  Var branch_next = analyzer_->CreateTensorVar("if");
+  TensorBitSet live_out = analyzer_->live_.at(next_var_);
+  live_out.Subtract(analyzer_->ToBitSet(def));
+  analyzer_->live_[branch_next] = std::move(live_out);
   analyzer_->Backward(branch, branch_next);
 }
 
@@ -333,7 +327,7 @@ void LivenessAnalyzer::BackwardAnalyzer::Run(Var next_var) {
   // Backward analysis
   next_var_ = next_var;
   analyzer_->dummy_output_ = analyzer_->CreateNull();
-  analyzer_->live_[analyzer_->dummy_output_] = analyzer_->vset_[MergeLive(ell_->ret)];
+  analyzer_->live_[analyzer_->dummy_output_] = MergeLive(analyzer_->ToBitSet(ell_->ret));
   for (int i = n - 1; i >= 0; --i) {
     let_var_ = vars[i];
     next_var_ = i == n - 1 ? analyzer_->dummy_output_ : vars[i + 1];
@@ -342,9 +336,7 @@ void LivenessAnalyzer::BackwardAnalyzer::Run(Var next_var) {
     // the same value may point to the same reference, so only the first one will be visited.
     if (exprs[i].as<OpNode>() || exprs[i].as<ConstantNode>() || exprs[i].as<FunctionNode>()) {
       auto dummy_vars = analyzer_->GetTensorVars(next_var_);
-      Var d1 = analyzer_->Merge(dummy_vars);
-      Var d2 = MergeLive(d1, next_var_);
-      analyzer_->live_[let_var_] = analyzer_->vset_[d2];
+      analyzer_->live_[let_var_] = MergeLive(analyzer_->ToBitSet(dummy_vars), next_var_);
     } else {
       CHECK_GT(analyzer_->live_.count(next_var_), 0);
     }
@@ -467,7 +459,8 @@ liveness_analysis::MapVSet LivenessAnalysis(const IRModule& mod) {
   auto entry = mod->GetGlobalVar("main");
   auto func = Downcast<Function>(mod->Lookup(entry));
   auto la = liveness_analysis::LivenessAnalyzer(func);
-  return la.Run();
+  la.Run();
+  return la.GetLiveIn();
 }
 
 // Put the live in set to an Array as std::unordered_set is not in the object system.
@@ -8,6 +8,8 @@
  * \brief A pass for analyzing tensor liveness.
  */
 #pragma once
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include "raf/op.h"
 #include "raf/op_utils.h"
@@ -67,12 +69,65 @@ using MapVar = StdMap<Var>;
 using MapVSet = StdMap<VSet>;
 using MapFunction = StdMap<Function>;
 
+/*!
+ * \brief A dense set of the tensor vars numbered by LivenessAnalyzer. The live-in sets of all lines
+ * are kept in this form, where the unions and differences over 64-bit words are vectorized by the
+ * compiler, instead of copying hash sets of vars at each line.
+ */
+class TensorBitSet {
+ public:
+  void Insert(size_t i) {
+    if ((i >> 6) >= words_.size()) {
+      words_.resize((i >> 6) + 1, 0);
+    }
+    words_[i >> 6] |= uint64_t(1) << (i & 63);
+  }
+
+  bool Contains(size_t i) const {
+    return (i >> 6) < words_.size() && ((words_[i >> 6] >> (i & 63)) & 1);
+  }
+
+  /*! \brief this = this | other */
+  void Union(const TensorBitSet& other) {
+    if (other.words_.size() > words_.size()) {
+      words_.resize(other.words_.size(), 0);
+    }
+    uint64_t* dst = words_.data();
+    const uint64_t* src = other.words_.data();
+    for (size_t i = 0, n = other.words_.size(); i < n; ++i) {
+      dst[i] |= src[i];
+    }
+  }
+
+  /*! \brief this = this & ~other */
+  void Subtract(const TensorBitSet& other) {
+    uint64_t* dst = words_.data();
+    const uint64_t* src = other.words_.data();
+    for (size_t i = 0, n = std::min(words_.size(), other.words_.size()); i < n; ++i) {
+      dst[i] &= ~src[i];
+    }
+  }
+
+  /*! \brief Call f with the index of each element in the ascending order. */
+  template <typename F>
+  void ForEach(F f) const {
+    for (size_t i = 0; i < words_.size(); ++i) {
+      for (uint64_t word = words_[i]; word != 0; word &= word - 1) {
+        f((i << 6) + __builtin_ctzll(word));
+      }
+    }
+  }
+
+ private:
+  std::vector<uint64_t> words_;
+};
+
 class LivenessAnalyzer {
  public:
   LivenessAnalyzer(const Function& func) : func_(func) {
   }
 
-  MapVSet Run();
+  void Run();
 
   bool IsSuccess() {
     return !failure_;
@@ -80,10 +135,20 @@ class LivenessAnalyzer {
 
   /*! \brief Get live in tensors of the given line (var). */
   VSet GetLiveVars(const Var& x) {
-    if (live_.count(x) == 0) {
+    auto it = live_.find(x);
+    if (it == live_.end()) {
       return VSet();
     }
-    return live_.at(x);
+    return ToVSet(it->second);
+  }
+
+  /*! \brief Get live in tensors of all lines, which are materialized from the dense sets. */
+  MapVSet GetLiveIn() {
+    MapVSet ret;
+    for (const auto& kv : live_) {
+      ret[kv.first] = ToVSet(kv.second);
+    }
+    return ret;
   }
 
   /*! \brief Get the dummy tensor variables of the final outputs. */
@@ -139,6 +204,7 @@ class LivenessAnalyzer {
 
   /*! \brief Union-find Forest: Unite two trees in Union-find Forest */
   Var Unite(const Var& x, const Var& y) {
+    InitInvLive();
     Var fx = Find(x);
     Var fy = Find(y);
     union_find_forest_[fx] = fy;
@@ -150,6 +216,7 @@ class LivenessAnalyzer {
 
   /*! \brief check if inv_live_[x] and inv_live_[y] intersects or not */
   bool Intersect(const Var& x, const Var& y) {
+    InitInvLive();
     CHECK_GT(inv_live_.count(x), 0);
     CHECK_GT(inv_live_.count(y), 0);
     const VSet& sx = inv_live_.at(x);
@@ -194,7 +261,7 @@ class LivenessAnalyzer {
 
   /*! \brief Debug output: live_ */
   std::string DebugDumpLiveIn() {
-    return DebugDump(live_);
+    return DebugDump(GetLiveIn());
   }
 
   /*! \brief Debug output: vset_ */
@@ -224,9 +291,38 @@ class LivenessAnalyzer {
   Var CreateTensor(const std::string& name = "t") {
     Var var = CreateTensorVar(name);
     vset_[var] = {var};
+    tensor_ids_[var] = tensors_.size();
+    tensors_.push_back(var);
     return var;
   }
 
+  /*! \brief The dense set of the tensors in vset_[var], which is empty if var is not in vset_. */
+  TensorBitSet ToBitSet(const Var& var) const {
+    TensorBitSet ret;
+    auto it = var.defined() ? vset_.find(var) : vset_.end();
+    if (it != vset_.end()) {
+      for (const auto& tensor : it->second) {
+        ret.Insert(tensor_ids_.at(tensor));
+      }
+    }
+    return ret;
+  }
+
+  /*! \brief The union of the dense sets of vars. */
+  TensorBitSet ToBitSet(const Array<Var>& vars) const {
+    TensorBitSet ret;
+    for (const auto& var : vars) {
+      ret.Union(ToBitSet(var));
+    }
+    return ret;
+  }
+
+  VSet ToVSet(const TensorBitSet& bits) const {
+    VSet ret;
+    bits.ForEach([&](size_t i) { ret.insert(tensors_[i]); });
+    return ret;
+  }
+
   /*! \brief vset1 - vset2 */
   static VSet Remove(const VSet& vset1, const VSet& vset2) {
     VSet ret(vset1);
@@ -350,6 +446,9 @@ class LivenessAnalyzer {
   /*! \brief Create a variable of specified type */
   Var CreateTensorVar(const Type& type);
 
+  /*! \brief Build inv_live_ from live_ on the first use of the union find forest */
+  void InitInvLive();
+
  private:
   /*! \brief the function to be analyzed */
   const Function& func_;
@@ -359,8 +458,11 @@ class LivenessAnalyzer {
   MapVSet vset_;
   /*! \brief maps a variable with TupleType to its constituent (fake) variables */
   Map<Var, Array<Var>> vtuple_;
-  /*! \brief the live-in variables at a specific line */
-  MapVSet live_;
+  /*! \brief the live-in tensors at a specific line */
+  StdMap<TensorBitSet> live_;
+  /*! \brief the tensor vars created by CreateTensor, which are indexed by tensor_ids_ */
+  std::vector<Var> tensors_;
+  StdMap<size_t> tensor_ids_;
   /*! \brief The dummy value of the final output */
   Var dummy_output_;
   /*! \brief count the occurences of a var name, to avoid name collision */
@@ -372,6 +474,8 @@ class LivenessAnalyzer {
   /*! \brief the lines where a variable is live.
              Initially it's the inversion of live_: inv_live_[x] = {y | x \in live_[y]} */
   MapVSet inv_live_;
+  /*! \brief whether inv_live_ has been built */
+  bool inv_live_ready_{false};
 };
 
 class LivenessAnalyzer::FormChecker : public ExprVisitor {
@@ -464,18 +568,16 @@ class LivenessAnalyzer::BackwardAnalyzer : public ExprVisitor {
   void Run(Var next_var);
 
  private:
-  /*! \brief returns live_[next_var_] - vset_[def] + vset_[cur]
+  /*! \brief returns live_[next_var_] - vset_[def] + cur
              it's an instantiation of the following rule:
              live(l + 1, x) && !define(l, x) => live(l, x) */
-  Var MergeLive(const Var& cur, const Var& def = Var()) {
-    Var next_line_var = analyzer_->CreateTensorVar("ml");
+  TensorBitSet MergeLive(const TensorBitSet& cur, const Var& def = Var()) {
     CHECK(analyzer_->live_.find(next_var_) != analyzer_->live_.end());
-    analyzer_->vset_[next_line_var] = analyzer_->live_.at(next_var_);
-    Var remain = next_line_var;
+    TensorBitSet ret = analyzer_->live_.at(next_var_);
     if (def.defined()) {
-      remain = analyzer_->Remove(remain, def);
+      ret.Subtract(analyzer_->ToBitSet(def));
     }
-    Var ret = analyzer_->Merge(remain, cur);
+    ret.Union(cur);
     return ret;
   }
 
@@ -30,6 +30,19 @@ using namespace raf::ir;
 using namespace raf::value;
 using common::shape_utils::BytesCompactTensor;
 
+/*! \brief The mapping from parameter names to their shapes. */
+using ShapeMap = Map<String, Array<Integer>>;
+
+/*! \brief The placement of a tensor in a storage shared with other tensors. */
+struct ViewPlacement {
+  /*! \brief The concatenate or split let var that owns the storage. */
+  Var owner;
+  /*! \brief The type of the whole tensor in the storage. */
+  Type storage_type;
+  /*! \brief The offset of the tensor in the storage in bytes. */
+  int64_t offset;
+};
+
 class InplaceVisitor : public MixedModeVisitor {
  public:
   void VisitExpr_(const LetNode* node) override {
@@ -69,12 +82,162 @@ class InplaceVisitor : public MixedModeVisitor {
   std::unordered_map<Var, std::vector<Var>, ObjectPtrHash, ObjectPtrEqual> var_share_map;
 };
 
+/*!
+ * \brief Copy a function with fresh vars, and annotate its parameters with their upper-bound
+ * shapes. The type inference writes the types to the vars in place, so the copy can be inferred
+ * without touching the types of the original function.
+ */
+class UpperBoundCopier : public ExprMutator {
+ public:
+  explicit UpperBoundCopier(const ShapeMap& bounds) : bounds_(bounds) {
+  }
+
+  Expr VisitExpr_(const VarNode* node) override {
+    auto var = GetRef<Var>(node);
+    Type type = node->type_annotation;
+    auto ttype = type.as<TensorTypeNode>();
+    if (ttype && primitive_depth_ == 0 && bounds_.count(node->name_hint())) {
+      auto bound = bounds_[node->name_hint()];
+      CHECK_EQ(bound.size(), ttype->shape.size())
+          << "The upper-bound shape of " << node->name_hint() << " has " << bound.size()
+          << " dimensions, but the parameter has " << ttype->shape.size();
+      Array<PrimExpr> shape;
+      for (size_t i = 0; i < bound.size(); ++i) {
+        auto dim = ttype->shape[i].as<IntImmNode>();
+        CHECK(dim == nullptr || dim->value <= bound[i]->value)
+            << "The upper bound " << bound[i]->value << " of " << node->name_hint()
+            << " is smaller than its static dimension " << dim->value;
+        shape.push_back(Integer(bound[i]->value));
+      }
+      type = TensorType(shape, ttype->dtype);
+    }
+    auto new_var = MakeVar(node->name_hint(), type);
+    var_map.emplace(var, new_var);
+    return new_var;
+  }
+
+  Expr VisitExpr_(const FunctionNode* node) override {
+    // Only the parameters of the function to be mutated have the upper bounds.
+    bool primitive = node->HasNonzeroAttr(attr::kPrimitive);
+    primitive_depth_ += primitive;
+    auto ret = ExprMutator::VisitExpr_(node);
+    primitive_depth_ -= primitive;
+    return ret;
+  }
+
+  /*! \brief The mapping from the vars of the original function to their copies. */
+  std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> var_map;
+
+ private:
+  /*! \brief The mapping from parameter names to their upper-bound shapes. */
+  ShapeMap bounds_;
+  /*! \brief The number of primitive functions that enclose the visited expr. */
+  int primitive_depth_ = 0;
+};
+
 class ManifestAllocMutator : public ExprMutator {
  public:
   ManifestAllocMutator() {
     scopes_.emplace_back(new LetList);
   }
 
+  /*!
+   * \brief Plan the concatenate and split ops that can be replaced by views, such that their
+   * copies are eliminated. The producers of the concatenate inputs write to the views of the
+   * concatenate output directly, and the split outputs are the views of its input. This only
+   * applies to the ops at the top level of the function where the views are contiguous, i.e., all
+   * the dimensions before the axis are 1, and are aligned. The viewed tensors must not be used
+   * elsewhere or updated in place, so that the writes to the views cannot be observed.
+   */
+  void PlanViews(const Function& func) {
+    static const Op& concat_op = Op::Get("raf.op.concatenate");
+    static const Op& split_op = Op::Get("raf.op.split");
+    inplace_.VisitExpr(func);
+    auto ell = ExplicitLetList::make(func->body);
+    const auto& vars = ell->vars;
+    const auto& exprs = ell->exprs;
+    std::unordered_map<Var, Expr, ObjectPtrHash, ObjectPtrEqual> bound;
+    std::unordered_map<Var, int, ObjectPtrHash, ObjectPtrEqual> use_counts;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      bound[vars[i]] = exprs[i];
+      for (const auto& var : FreeVars(exprs[i])) {
+        ++use_counts[var];
+      }
+    }
+    for (const auto& var : FreeVars(ell->ret)) {
+      ++use_counts[var];
+    }
+    // Whether the var is a static tensor produced by a call that only the given op uses.
+    auto is_viewable = [&](const Expr& expr) {
+      const auto* var = expr.as<VarNode>();
+      if (var == nullptr || use_counts[GetRef<Var>(var)] != 1 || !bound.count(GetRef<Var>(var)) ||
+          inplace_.var_share_map.count(GetRef<Var>(var))) {
+        return false;
+      }
+      const auto* call = bound.at(GetRef<Var>(var)).as<CallNode>();
+      if (call == nullptr || IsViewCall(call) || !IsStaticTensor(call->checked_type())) {
+        return false;
+      }
+      const auto* op = call->op.as<OpNode>();
+      const auto* func = call->op.as<FunctionNode>();
+      if (op != nullptr) {
+        static auto upper_bound_map = Op::GetAttrMap<Op>("TRAFUpperBoundOp");
+        auto base_op = op::IsDialectOp(GetRef<Op>(op)) ? op::GetBaseOp(GetRef<Op>(op))
+                                                       : GetRef<Op>(op);
+        return !upper_bound_map.count(GetRef<Op>(op)) && base_op != concat_op &&
+               base_op != split_op && !op::IsCollectiveOp(base_op);
+      }
+      return func != nullptr && func->HasNonzeroAttr(attr::kPrimitive);
+    };
+
+    for (size_t i = 0; i < vars.size(); ++i) {
+      const auto* call = exprs[i].as<CallNode>();
+      const auto* op_node = call ? call->op.as<OpNode>() : nullptr;
+      if (op_node == nullptr) {
+        continue;
+      }
+      auto op = op::IsDialectOp(GetRef<Op>(op_node)) ? op::GetBaseOp(GetRef<Op>(op_node))
+                                                       : GetRef<Op>(op_node);
+      if (op == concat_op && !inplace_.var_share_map.count(vars[i])) {
+        Expr tuple = call->args[0];
+        if (const auto* tuple_var = tuple.as<VarNode>()) {
+          auto it = bound.find(GetRef<Var>(tuple_var));
+          if (use_counts[GetRef<Var>(tuple_var)] != 1 || it == bound.end()) {
+            continue;
+          }
+          tuple = it->second;
+        }
+        const auto* fields = tuple.as<TupleNode>();
+        if (fields == nullptr ||
+            !std::all_of(fields->fields.begin(), fields->fields.end(), is_viewable)) {
+          continue;
+        }
+        std::vector<Type> types;
+        for (const auto& field : fields->fields) {
+          types.push_back(field->checked_type());
+        }
+        std::vector<int64_t> offsets;
+        if (GetViewOffsets(types, call->checked_type(), call->args[1], &offsets)) {
+          for (size_t j = 0; j < offsets.size(); ++j) {
+            view_placements_[Downcast<Var>(fields->fields[j])] = {vars[i], call->checked_type(),
+                                                                  offsets[j]};
+          }
+          view_ops_.insert(vars[i]);
+        }
+      } else if (op == split_op && is_viewable(call->args[0])) {
+        auto out_types = tvm::relay::FlattenTupleType(call->checked_type());
+        std::vector<Type> types(out_types.begin(), out_types.end());
+        std::vector<int64_t> offsets;
+        if (GetViewOffsets(types, call->args[0]->checked_type(), call->args[2], &offsets)) {
+          view_placements_[Downcast<Var>(call->args[0])] = {vars[i],
+                                                            call->args[0]->checked_type(), 0};
+          view_ops_.insert(vars[i]);
+          split_offsets_[vars[i]] = offsets;
+        }
+      }
+    }
+  }
+
   Expr VisitExpr_(const TupleNode* node) {
     // Previously `scopes_` is defined as `std::vector<LetList>` and
     // `auto& scope = scopes_.back();` is heavily used to access the inner most scope.
@@ -151,8 +314,23 @@ class ManifestAllocMutator : public ExprMutator {
       auto ret_type = call->checked_type();
       auto out_types = tvm::relay::FlattenTupleType(ret_type);
       Array<Expr> new_args;
-      if (op::IsReshapeOp(GetRef<Op>(op))) {
-        // generate vm.set_shape for reshape ops to avoid unnecessary kernels and allocations
+      if (view_ops_.count(bind_var)) {
+        // The concatenate output owns the storage that its inputs have been written to, and the
+        // split outputs are the views of the storage of its input.
+        auto storage = view_storages_.at(bind_var);
+        auto it = split_offsets_.find(bind_var);
+        if (it == split_offsets_.end()) {
+          return MakeStaticView(scope, out_types[0].as<TensorTypeNode>(), storage, 0);
+        }
+        std::vector<Expr> outs;
+        for (size_t i = 0; i < out_types.size(); ++i) {
+          outs.push_back(MakeStaticView(scope, out_types[i].as<TensorTypeNode>(), storage,
+                                        it->second[i]));
+        }
+        return tvm::relay::ToTupleType(ret_type, outs);
+      } else if (IsViewCall(call.as<CallNode>())) {
+        // generate vm.set_shape for reshape ops and layout-only transposes to avoid unnecessary
+        // kernels and allocations
         CHECK_EQ(out_types.size(), 1U);
         // first push the input tensor
         new_args.push_back(VisitExpr(call->args[0]));
@@ -219,6 +397,25 @@ class ManifestAllocMutator : public ExprMutator {
     return Mutate(expr);
   }
 
+  /*!
+   * \brief Infer the types of the let-bound vars of the function when its parameters are at their
+   * upper-bound shapes. The dynamic outputs whose types are static at the bounds then get storages
+   * of static sizes, which can be planned by MemoryPlan.
+   * \param func The function to be mutated.
+   * \param mod The module of the function.
+   * \param bounds The mapping from parameter names to their upper-bound shapes.
+   */
+  void SetUpperBounds(const Function& func, const IRModule& mod, const ShapeMap& bounds) {
+    UpperBoundCopier copier(bounds);
+    auto copy = copier.Mutate(func);
+    pass::InferTypeWithModule(copy, mod);
+    for (const auto& kv : copier.var_map) {
+      if (kv.second->checked_type_.defined() && !tvm::relay::IsDynamic(kv.second->checked_type_)) {
+        bound_types_.emplace(kv.first, kv.second->checked_type_);
+      }
+    }
+  }
+
  private:
   Expr ComputeAlignment(DataType dtype) {
     int64_t align = dtype.bits() / 8 * dtype.lanes();
@@ -262,16 +459,93 @@ class ManifestAllocMutator : public ExprMutator {
     return tensor;
   }
 
+  /*! \brief Whether the type is a tensor type with a static shape. */
+  static bool IsStaticTensor(const Type& type) {
+    return type.as<TensorTypeNode>() != nullptr && !tvm::relay::IsDynamic(type);
+  }
+
+  /*!
+   * \brief Get the offsets of the tensors that are concatenated to, or split from, the whole tensor
+   * along the axis, if they are contiguous and aligned in the whole tensor.
+   */
+  bool GetViewOffsets(const std::vector<Type>& types, const Type& whole_type, const Expr& axis_expr,
+                      std::vector<int64_t>* offsets) {
+    const auto* axis_const = axis_expr.as<ConstantNode>();
+    const auto* axis_value = axis_const ? axis_const->value.as<IntValueObj>() : nullptr;
+    if (axis_value == nullptr || !IsStaticTensor(whole_type)) {
+      return false;
+    }
+    const auto* whole = whole_type.as<TensorTypeNode>();
+    int64_t ndim = whole->shape.size();
+    int64_t axis = axis_value->value < 0 ? axis_value->value + ndim : axis_value->value;
+    for (int64_t i = 0; i < axis; ++i) {
+      if (whole->shape[i].as<IntImmNode>()->value != 1) {
+        return false;
+      }
+    }
+    int64_t alignment = std::max<int64_t>(whole->dtype.bits() / 8 * whole->dtype.lanes(),
+                                          kDefaultMemoryAlignment);
+    int64_t offset = 0;
+    for (const auto& type : types) {
+      if (!IsStaticTensor(type) || offset % alignment != 0) {
+        return false;
+      }
+      offsets->push_back(offset);
+      offset += BytesCompactTensor(type.as<TensorTypeNode>());
+    }
+    return offset == BytesCompactTensor(whole);
+  }
+
+  /*! \brief Get the storage owned by the given let var, which is allocated at the first request. */
+  Var GetViewStorage(LetList* scope, const Var& owner, const Type& type, const Device& device) {
+    auto it = view_storages_.find(owner);
+    if (it != view_storages_.end()) {
+      return it->second;
+    }
+    const auto* ttype = type.as<TensorTypeNode>();
+    Device target_device(DevType::kCPU(), 0);
+    if (device.device_type() != DevType::kUnknown()) {
+      target_device = device;
+    }
+    Expr size = MakeConstant(ScalarValue::make(BytesCompactTensor(ttype)));
+    auto storage = scope->Push(MakeAllocStorage(
+        Array<Expr>{size, ComputeAlignment(ttype->dtype)},
+        static_cast<int>(target_device.device_type()), target_device.device_id(), ttype->dtype));
+    view_storages_[owner] = storage;
+    return storage;
+  }
+
+  /*! \brief Allocate a tensor at the given offset of the storage. */
+  Expr MakeStaticView(LetList* scope, const TensorTypeNode* type, const Var& storage,
+                      int64_t offset) {
+    static const Op& op = Op::Get("raf.op.vm.alloc_tensor");
+    Expr shape = MakeConstant(type->shape);
+    return scope->Push(Call(op, {storage, shape,
+                                 MakeConstant(StringValue::make(DLDataType2String(type->dtype))),
+                                 shape, MakeConstant(BoolValue::make(true)),
+                                 MakeConstant(ScalarValue::make(offset))}));
+  }
+
   Expr MakeStaticAllocation(LetList* scope, const TensorTypeNode* type, const Device& device) {
     Expr shape = MakeConstant(type->shape);
     Expr size = MakeConstant(ScalarValue::make(BytesCompactTensor(type)));
     return MakeAllocationCommon(scope, type, shape, size, device);
   }
 
+  /*!
+   * \brief Allocate a tensor whose shape is inferred at runtime. When the upper-bound type of the
+   * tensor is given, the storage is allocated at the static upper-bound size, and the tensor is a
+   * view of the real shape in it.
+   */
   Expr MakeDynamicAllocation(LetList* scope, const TensorTypeNode* type, const Expr& out_type_expr,
-                             const Device& device) {
+                             const Device& device, const TensorTypeNode* bound_type = nullptr) {
     Expr shape = scope->Push(TupleGetItem(out_type_expr, 0));
-    Expr size = scope->Push(TupleGetItem(out_type_expr, 1));
+    Expr size;
+    if (bound_type != nullptr && bound_type->dtype == type->dtype) {
+      size = MakeConstant(ScalarValue::make(BytesCompactTensor(bound_type)));
+    } else {
+      size = scope->Push(TupleGetItem(out_type_expr, 1));
+    }
     return MakeAllocationCommon(scope, type, shape, size, device);
   }
 
@@ -282,28 +556,27 @@ class ManifestAllocMutator : public ExprMutator {
     auto ins = scope->Push(Tuple(new_args));
     auto infer_type = Call(Op::Get("raf.op.vm.infer_type"), Array<Expr>{op_var, ins});
     auto out_type_exprs = scope->Push(infer_type);
+    std::vector<TensorType> bound_types;
+    auto bound_it = bound_types_.find(bind_var);
+    if (bound_it != bound_types_.end()) {
+      bound_types = tvm::relay::FlattenTupleType(bound_it->second);
+      CHECK_EQ(bound_types.size(), out_types.size());
+    }
     std::vector<Expr> outs;
     auto it = inplace_.var_share_map.find(bind_var);
-    if (it != inplace_.var_share_map.end()) {
-      // some outputs have inplace update
-      auto share = it->second;
-      CHECK_EQ(share.size(), out_types.size());
-      for (size_t i = 0; i < out_types.size(); ++i) {
-        // check if the output shares the memory with input
-        if (share[i].defined()) {
-          outs.push_back(share[i]);
-        } else {
-          Expr out_type_expr = scope->Push(TupleGetItem(out_type_exprs, i + 1));
-          outs.push_back(MakeDynamicAllocation(scope, out_types[i].as<TensorTypeNode>(),
-                                               out_type_expr, device));
+    for (size_t i = 0; i < out_types.size(); ++i) {
+      // check if the output shares the memory with input
+      if (it != inplace_.var_share_map.end()) {
+        CHECK_EQ(it->second.size(), out_types.size());
+        if (it->second[i].defined()) {
+          outs.push_back(it->second[i]);
+          continue;
         }
       }
-    } else {
-      for (size_t i = 0; i < out_types.size(); i++) {
-        Expr out_type_expr = scope->Push(TupleGetItem(out_type_exprs, i + 1));
-        outs.push_back(
-            MakeDynamicAllocation(scope, out_types[i].as<TensorTypeNode>(), out_type_expr, device));
-      }
+      Expr out_type_expr = scope->Push(TupleGetItem(out_type_exprs, i + 1));
+      const TensorTypeNode* bound_type = bound_types.empty() ? nullptr : bound_types[i].get();
+      outs.push_back(MakeDynamicAllocation(scope, out_types[i].as<TensorTypeNode>(), out_type_expr,
+                                           device, bound_type));
     }
     Call invoke_op;
     if (op->IsInstance<OpNode>()) {
@@ -333,7 +606,14 @@ class ManifestAllocMutator : public ExprMutator {
     }
     std::vector<Expr> outs;
     auto it = inplace_.var_share_map.find(bind_var);
-    if (it != inplace_.var_share_map.end()) {
+    auto view_it = view_placements_.find(bind_var);
+    if (view_it != view_placements_.end()) {
+      // write the output to the storage of the concatenate output or the split input
+      const auto& placement = view_it->second;
+      auto storage = GetViewStorage(scope, placement.owner, placement.storage_type, device);
+      outs.push_back(
+          MakeStaticView(scope, out_types[0].as<TensorTypeNode>(), storage, placement.offset));
+    } else if (it != inplace_.var_share_map.end()) {
       // some outputs have inplace update
       auto share = it->second;
       CHECK_EQ(share.size(), out_types.size());
@@ -362,6 +642,16 @@ class ManifestAllocMutator : public ExprMutator {
   std::unordered_map<Expr, Var, ObjectPtrHash, ObjectPtrEqual> let_binding_;
   /*! \breif Inplace visitor to check the may_share information. */
   InplaceVisitor inplace_;
+  /*! \brief The mapping from let-bound vars to their static types at the upper-bound shapes. */
+  std::unordered_map<Var, Type, ObjectPtrHash, ObjectPtrEqual> bound_types_;
+  /*! \brief The placements of the concatenate inputs and the split inputs. */
+  std::unordered_map<Var, ViewPlacement, ObjectPtrHash, ObjectPtrEqual> view_placements_;
+  /*! \brief The concatenate and split ops that are replaced by views. */
+  std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> view_ops_;
+  /*! \brief The offsets of the outputs of the split ops that are replaced by views. */
+  std::unordered_map<Var, std::vector<int64_t>, ObjectPtrHash, ObjectPtrEqual> split_offsets_;
+  /*! \brief The storages shared by the views, keyed by the concatenate or split let vars. */
+  std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> view_storages_;
 };
 
 }  // namespace manifest_alloc
@@ -369,12 +659,26 @@ class ManifestAllocMutator : public ExprMutator {
 Pass ManifestAlloc() {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<ir::Function>(manifest_alloc::ManifestAllocMutator()(f));
+    manifest_alloc::ManifestAllocMutator mutator;
+    auto bounds = pc->GetConfig<manifest_alloc::ShapeMap>("raf.manifest_alloc.upper_bound_shapes",
+                                                          manifest_alloc::ShapeMap())
+                      .value();
+    if (!bounds.empty() && m->ContainGlobalVar("main") && m->Lookup("main").same_as(f)) {
+      mutator.SetUpperBounds(f, m, bounds);
+    }
+    if (pc->GetConfig("raf.manifest_alloc.concat_split_views", Bool(false)).value()) {
+      mutator.PlanViews(f);
+    }
+    return Downcast<ir::Function>(mutator(f));
   };
-  return CreateRAFFunctionPass(pass_func, 0, "ManifestAlloc", {});
+  return CreateRAFFunctionPass(pass_func, 0, "ManifestAlloc", {}, true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.ManifestAlloc").set_body_typed(ManifestAlloc);
 
+using manifest_alloc::ShapeMap;
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.manifest_alloc.upper_bound_shapes", ShapeMap);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.manifest_alloc.concat_split_views", Bool);
+
 }  // namespace pass
 }  // namespace raf
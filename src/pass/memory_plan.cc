@@ -8,7 +8,10 @@
  * \brief Optimized allocated memory in the IR.
  */
 #include <algorithm>
+#include <limits>
+#include <map>
 #include <random>
+#include <utility>
 #include <vector>
 
 #include "raf/op.h"
@@ -19,6 +22,7 @@
 #include "./let_list.h"
 #include "./liveness_analysis.h"
 #include "tvm/relay/attrs/memory.h"
+#include "tvm/tir/expr.h"
 
 namespace raf {
 namespace pass {
@@ -32,6 +36,86 @@ template <typename T>
 using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
 using VSet = std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual>;
 
+/*! \brief A symbolic tensor size in the form of `coeff * prod(dims)`, where dims are the
+ * non-constant dimensions of the tensor shape.
+ */
+struct SymbolicSize {
+  /*! \brief The constant coefficient in bytes. Non-positive means the size is unknown. */
+  int64_t coeff = -1;
+
+  /*! \brief The symbolic dimensions. */
+  std::vector<PrimExpr> dims;
+};
+
+/*! \brief Check whether two dimensions are provably equal. The leaf symbols (e.g., Any) are equal
+ * only if they are the same object, because different symbols may have different values.
+ */
+bool DimEqual(const PrimExpr& lhs, const PrimExpr& rhs) {
+  if (lhs.same_as(rhs)) {
+    return true;
+  }
+  const auto* lhs_imm = lhs.as<IntImmNode>();
+  const auto* rhs_imm = rhs.as<IntImmNode>();
+  if (lhs_imm || rhs_imm) {
+    return lhs_imm && rhs_imm && lhs_imm->value == rhs_imm->value;
+  }
+#define RAF_DIM_EQUAL_BINARY(NodeType)                                      \
+  if (const auto* lhs_node = lhs.as<NodeType>()) {                          \
+    const auto* rhs_node = rhs.as<NodeType>();                              \
+    return rhs_node && DimEqual(lhs_node->a, rhs_node->a) &&                \
+           DimEqual(lhs_node->b, rhs_node->b);                              \
+  }
+  RAF_DIM_EQUAL_BINARY(tvm::tir::AddNode);
+  RAF_DIM_EQUAL_BINARY(tvm::tir::SubNode);
+  RAF_DIM_EQUAL_BINARY(tvm::tir::MulNode);
+  RAF_DIM_EQUAL_BINARY(tvm::tir::DivNode);
+  RAF_DIM_EQUAL_BINARY(tvm::tir::ModNode);
+  RAF_DIM_EQUAL_BINARY(tvm::tir::FloorDivNode);
+  RAF_DIM_EQUAL_BINARY(tvm::tir::FloorModNode);
+  RAF_DIM_EQUAL_BINARY(tvm::tir::MinNode);
+  RAF_DIM_EQUAL_BINARY(tvm::tir::MaxNode);
+#undef RAF_DIM_EQUAL_BINARY
+  return false;
+}
+
+/*! \brief Get the symbolic size of the given tensor type. */
+SymbolicSize GetSymbolicSize(const TensorTypeNode* type) {
+  SymbolicSize ret;
+  ret.coeff = (type->dtype.bits() * type->dtype.lanes() + 7) / 8;
+  for (const auto& dim : type->shape) {
+    if (const auto* imm = dim.as<IntImmNode>()) {
+      ret.coeff *= imm->value;
+    } else {
+      ret.dims.push_back(dim);
+    }
+  }
+  return ret;
+}
+
+/*! \brief Check whether a tensor of the given symbolic size provably fits into the storage of
+ * another symbolic size, i.e., their sizes are proportional with a ratio no larger than 1.
+ */
+bool FitsIn(const SymbolicSize& size, const SymbolicSize& storage_size) {
+  if (size.coeff <= 0 || storage_size.coeff <= 0 || size.coeff > storage_size.coeff ||
+      size.dims.size() != storage_size.dims.size()) {
+    return false;
+  }
+  std::vector<bool> matched(storage_size.dims.size(), false);
+  for (const auto& dim : size.dims) {
+    bool found = false;
+    for (size_t i = 0; i < storage_size.dims.size(); ++i) {
+      if (!matched[i] && DimEqual(dim, storage_size.dims[i])) {
+        matched[i] = found = true;
+        break;
+      }
+    }
+    if (!found) {
+      return false;
+    }
+  }
+  return true;
+}
+
 /*! \brief A tensor group. The intermediate tensors which liveness dummy tensors in a group
  * can be allocated to the same memory buffer.
  */
@@ -48,12 +132,44 @@ struct TensorGroup {
   Var storage;
 
   /*! \brief The buffer size that should be allocated for this group. -1 means the size is
-   * dynamic. In this case, this group should only have one tensor.
+   * dynamic. In this case, this group should only have one tensor, unless the other tensors
+   * provably fit into the storage according to the symbolic size.
    */
   int64_t size = 0;
 
+  /*! \brief The symbolic size of the storage when the size is dynamic. */
+  SymbolicSize symbolic_size;
+
   /*! \brief The alignment of this group. */
   int64_t alignment;
+
+  /*! \brief The device type and ID of the storage. */
+  int device_type = -1, device_id = -1;
+
+  /*! \brief The live interval of this group, in terms of the indices of the top-level let
+   * bindings. The interval is invalid (-1) if the tensor is not allocated at the top level.
+   */
+  int64_t live_begin = -1, live_end = -1;
+
+  /*! \brief The storage of the arena that this group is placed in, or undefined if this group
+   * has its own storage.
+   */
+  Var arena;
+
+  /*! \brief The offset of this group in the arena. */
+  int64_t offset = 0;
+};
+
+/*! \brief An arena that packs multiple tensor groups into one storage by offsets. */
+struct Arena {
+  /*! \brief The size of the arena in bytes. */
+  int64_t size = 0;
+
+  /*! \brief The alignment of the arena. */
+  int64_t alignment = 0;
+
+  /*! \brief The number of groups in the arena that still have live tensors. */
+  int num_live_groups = 0;
 };
 
 /*! \brief A list of tensor groups with manipulation utilities. */
@@ -62,6 +178,14 @@ class TensorGroups {
   /*! \brief A list of storage allocation groups. */
   std::vector<TensorGroup> groups;
 
+  /*! \brief Whether the function launches ops on multiple streams. */
+  bool multi_stream = false;
+
+  /*! \brief The tensor lists of the collectives (e.g., the gradients of an allreduce), each of
+   * which is preferred to be placed contiguously in one storage.
+   */
+  std::vector<std::vector<Var>> buckets;
+
   TensorGroups(liveness_analysis::LivenessAnalyzer* analyzer) : analyzer_(analyzer) {
     dummy_out_vars_ = analyzer_->GetOutputTensorVars();
   }
@@ -137,6 +261,36 @@ class TensorGroups {
     return candidates;
   }
 
+  /*!
+   * \brief Find a dynamic tensor group whose storage can be reused by the given dynamic tensor,
+   * or -1 if not found. A group is valid if none of its members is alive, and the tensor provably
+   * fits into its storage. The group with the smallest storage is preferred.
+   */
+  int FindDynamicGroup(const Var& let_var, const int64_t alignment, int device_type,
+                       int device_id, const SymbolicSize& symbolic_size) {
+    auto live_in_vars = analyzer_->GetLiveVars(let_var);
+    int best = -1;
+    for (size_t i = 0; i < groups.size(); ++i) {
+      const auto& group = groups[i];
+      if (group.size != -1 || group.live_begin < 0 || group.alignment != alignment ||
+          group.device_type != device_type || group.device_id != device_id ||
+          !FitsIn(symbolic_size, group.symbolic_size)) {
+        continue;
+      }
+      bool valid = true;
+      for (const auto& member : group.members) {
+        if (live_in_vars.count(member.first) > 0) {
+          valid = false;
+          break;
+        }
+      }
+      if (valid && (best == -1 || group.symbolic_size.coeff < groups[best].symbolic_size.coeff)) {
+        best = i;
+      }
+    }
+    return best;
+  }
+
   /*! \brief Join the given tensor group. */
   void JoinGroup(size_t group_id, const Var& let_var, int64_t size = 0) {
     const Var target_var = GetTensorVar(let_var);
@@ -190,6 +344,7 @@ class TensorGroups {
         ss2 << member.second.first->name_hint() << "(" << member.second.second << "), ";
       }
       ss1 << "Storage " << group.storage->name_hint() << ", size " << group.size
+          << (group.symbolic_size.coeff > 0 ? " (symbolic)" : "")
           << ", members: " << ss2.str() << std::endl;
     }
     return ss1.str();
@@ -202,6 +357,60 @@ class TensorGroups {
   VSet dummy_out_vars_;
 };
 
+inline int64_t AlignUp(int64_t offset, int64_t alignment) {
+  return alignment > 0 ? (offset + alignment - 1) / alignment * alignment : offset;
+}
+
+/*!
+ * \brief Assign the offsets of the given tensor groups in an arena, such that the groups whose
+ * live intervals overlap do not overlap in the arena. The groups are placed from the largest to
+ * the smallest, and each one takes the tightest gap among the placed groups it conflicts with.
+ * \param groups All tensor groups.
+ * \param group_ids The IDs of the groups to be packed.
+ * \return The size of the arena.
+ */
+int64_t PackArena(std::vector<TensorGroup>* groups, std::vector<int> group_ids) {
+  auto& gs = *groups;
+  std::sort(group_ids.begin(), group_ids.end(), [&gs](int a, int b) {
+    if (gs[a].size != gs[b].size) {
+      return gs[a].size > gs[b].size;
+    }
+    return gs[a].live_begin < gs[b].live_begin;
+  });
+  int64_t arena_size = 0;
+  std::vector<int> placed;
+  for (int gid : group_ids) {
+    auto& group = gs[gid];
+    std::vector<int> conflicts;
+    for (int pid : placed) {
+      if (gs[pid].live_begin <= group.live_end && group.live_begin <= gs[pid].live_end) {
+        conflicts.push_back(pid);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [&gs](int a, int b) { return gs[a].offset < gs[b].offset; });
+    int64_t best_offset = -1;
+    int64_t best_gap = std::numeric_limits<int64_t>::max();
+    int64_t prev_end = 0;
+    for (int pid : conflicts) {
+      int64_t offset = AlignUp(prev_end, group.alignment);
+      int64_t gap = gs[pid].offset - offset;
+      if (gap >= group.size && gap < best_gap) {
+        best_offset = offset;
+        best_gap = gap;
+      }
+      prev_end = std::max(prev_end, gs[pid].offset + gs[pid].size);
+    }
+    if (best_offset == -1) {
+      best_offset = AlignUp(prev_end, group.alignment);
+    }
+    group.offset = best_offset;
+    arena_size = std::max(arena_size, best_offset + group.size);
+    placed.push_back(gid);
+  }
+  return arena_size;
+}
+
 /*! \brief A mutator to perform the following tasks:
  * 1. Run tensor grouper to group the tensors generated by alloc_tensor according to
  *    the liveness analysis. All tensors in a tensor group will use the same storage.
@@ -210,22 +419,47 @@ class TensorGroups {
  *    the largest tensor in the group.
  * 4. Remove alloc_storages that do not be used by any group.
  * 5. Insert free(%x) to free tensor/storage %x at the end of its life-cycle.
+ *
+ * When the arena mode is enabled, the groups of intermediate tensors with static sizes on the same
+ * device are further packed into a single arena by their live intervals, and each tensor becomes a
+ * view of the arena at the assigned offset.
+ *
+ * When the contiguous collective mode is enabled, the groups of the input (or output) tensors of an
+ * allreduce are placed back to back in a single storage, so that the allreduce works on the bucket
+ * directly instead of copying the tensors to and from a fused workspace.
+ *
+ * When the symbolic size mode is enabled, a tensor with a dynamic size may reuse the storage of a
+ * dead tensor whose size is symbolically proportional and no smaller (e.g., (?, 768) float32 in the
+ * storage of (?, 3072) float32 with the same ?). The storage is still sized at runtime by its first
+ * tensor, and the VM falls back to a new buffer if a tensor does not fit.
  */
 class MemoryPlanner : public ExprMutator {
  public:
-  MemoryPlanner(const Function& func, liveness_analysis::LivenessAnalyzer* analyzer)
-      : func_(func), analyzer_(analyzer), tensor_groups_(Group()) {
+  MemoryPlanner(const Function& func, liveness_analysis::LivenessAnalyzer* analyzer,
+                bool use_arena = false, bool use_symbolic_size = false,
+                bool contiguous_collectives = false)
+      : func_(func),
+        analyzer_(analyzer),
+        tensor_groups_(Group(use_symbolic_size)),
+        use_arena_(use_arena),
+        contiguous_collectives_(contiguous_collectives) {
     scopes_.emplace_back(new LetList);
   }
 
   Expr Run() {
+    if (contiguous_collectives_) {
+      PlanBuckets();
+    }
+    if (use_arena_) {
+      PlanArenas();
+    }
     DLOG(INFO) << "Tensor groups:";
     DLOG(INFO) << tensor_groups_.DebugDumpGroups();
 
     // List storage vars that will be used by one or more tensors.
     for (const auto& group : tensor_groups_.groups) {
       if (group.members.size() > 0) {
-        used_storages_.insert(group.storage);
+        used_storages_.insert(group.arena.defined() ? group.arena : group.storage);
       }
     }
 
@@ -259,7 +493,11 @@ class MemoryPlanner : public ExprMutator {
             // Free allocated storages that will not be used anymore.
             auto group = tensor_groups_.groups[group_id];
             if (group.members.size() == 0) {
-              scope->Push(MakeFreeMemory(group.storage));
+              if (!group.arena.defined()) {
+                scope->Push(MakeFreeMemory(group.storage));
+              } else if (--arenas_[group.arena].num_live_groups == 0) {
+                scope->Push(MakeFreeMemory(group.arena));
+              }
             }
           }
           it = live_tensors_.erase(it);
@@ -311,7 +549,13 @@ class MemoryPlanner : public ExprMutator {
         for (auto& arg : call->args) {
           new_args.push_back(VisitExpr(arg));
         }
-        new_args.Set(0, MakeConstant(ScalarValue::make(tensor_groups_.groups[group_id].size)));
+        auto arena_it = arenas_.find(curr_let_);
+        if (arena_it != arenas_.end()) {
+          new_args.Set(0, MakeConstant(ScalarValue::make(arena_it->second.size)));
+          new_args.Set(1, MakeConstant(ScalarValue::make(arena_it->second.alignment)));
+        } else {
+          new_args.Set(0, MakeConstant(ScalarValue::make(tensor_groups_.groups[group_id].size)));
+        }
         if (new_args.size() == 5) {
           new_args.push_back(MakeConstant(BoolValue::make(alloc_async)));
         } else {
@@ -334,12 +578,13 @@ class MemoryPlanner : public ExprMutator {
       auto group_id = tensor_groups_.FindGroupIdByMember(curr_let_);
       CHECK_NE(group_id, -1) << "Internal error: output tensor of " << curr_let_->name_hint()
                              << " does not belong to any tensor group";
+      const auto& group = tensor_groups_.groups[group_id];
       auto storage_var = Downcast<Var>(call->args[0]);
-      if (tensor_groups_.groups[group_id].storage != storage_var) {
-        DLOG(INFO) << "Assign " << curr_let_->name_hint() << " to "
-                   << tensor_groups_.groups[group_id].storage->name_hint() << " from "
-                   << storage_var->name_hint();
-        new_args.Set(0, tensor_groups_.groups[group_id].storage);
+      auto target_storage = group.arena.defined() ? group.arena : group.storage;
+      if (target_storage != storage_var) {
+        DLOG(INFO) << "Assign " << curr_let_->name_hint() << " to " << target_storage->name_hint()
+                   << " from " << storage_var->name_hint();
+        new_args.Set(0, target_storage);
       }
 
       // Override the own memory flag argument.
@@ -350,6 +595,19 @@ class MemoryPlanner : public ExprMutator {
         new_args.Set(4, own);
       }
 
+      // Set the offset in the arena, on top of the offset of the tensor in its group storage.
+      if (group.arena.defined()) {
+        int64_t offset = group.offset;
+        if (call->args.size() > 5) {
+          offset += call->args[5].as<ConstantNode>()->value.as<IntValueObj>()->value;
+        }
+        if (new_args.size() == 5) {
+          new_args.push_back(MakeConstant(ScalarValue::make(offset)));
+        } else {
+          new_args.Set(5, MakeConstant(ScalarValue::make(offset)));
+        }
+      }
+
       return Call(alloc_tensor_op, new_args);
     } else if (op_node && GetRef<Op>(op_node) == reshape_tensor_op) {
       // Other ops that will also create a new tensor/view. We do not need to mutate them,
@@ -362,7 +620,104 @@ class MemoryPlanner : public ExprMutator {
  private:
   class TensorGrouper;
 
-  TensorGroups Group();
+  TensorGroups Group(bool use_symbolic_size);
+
+  /*!
+   * \brief Place the groups of the tensors in each bucket back to back in one storage. The storage
+   * of the first allocated group in a bucket becomes the storage of the whole bucket. A bucket is
+   * skipped if any of its tensors is not allocated at the top level with a static size, is a final
+   * output, or has been placed in another bucket.
+   */
+  void PlanBuckets() {
+    auto& groups = tensor_groups_.groups;
+    for (const auto& bucket : tensor_groups_.buckets) {
+      std::vector<int> group_ids;
+      for (const auto& tensor : bucket) {
+        int gid = tensor_groups_.FindGroupIdByMember(tensor);
+        bool valid = gid != -1 && groups[gid].live_begin >= 0 && groups[gid].size > 0 &&
+                     !groups[gid].arena.defined() && !tensor_groups_.HasOutputTensor(gid) &&
+                     std::find(group_ids.begin(), group_ids.end(), gid) == group_ids.end();
+        if (valid && !group_ids.empty()) {
+          const auto& head = groups[group_ids[0]];
+          valid = groups[gid].device_type == head.device_type &&
+                  groups[gid].device_id == head.device_id;
+        }
+        if (!valid) {
+          group_ids.clear();
+          break;
+        }
+        group_ids.push_back(gid);
+      }
+      if (group_ids.size() < 2) {
+        continue;
+      }
+      Arena arena;
+      arena.num_live_groups = group_ids.size();
+      int first = group_ids[0];
+      for (int gid : group_ids) {
+        auto& group = groups[gid];
+        group.offset = AlignUp(arena.size, group.alignment);
+        arena.size = group.offset + group.size;
+        arena.alignment = std::max(arena.alignment, group.alignment);
+        if (group.live_begin < groups[first].live_begin) {
+          first = gid;
+        }
+      }
+      Var bucket_storage = groups[first].storage;
+      for (int gid : group_ids) {
+        groups[gid].arena = bucket_storage;
+      }
+      DLOG(INFO) << "Place " << group_ids.size() << " tensors contiguously in "
+                 << bucket_storage->name_hint() << " of " << arena.size << " bytes";
+      arenas_.emplace(bucket_storage, arena);
+    }
+  }
+
+  /*!
+   * \brief Pack the groups of intermediate tensors with static sizes into one arena per device.
+   * The storage of the first allocated group on each device becomes the arena.
+   */
+  void PlanArenas() {
+    if (tensor_groups_.multi_stream) {
+      // The program order does not reflect the execution order across streams, so the tensors
+      // with disjoint live intervals may still be accessed at the same time.
+      DLOG(INFO) << "Arenas are not used because the function uses multiple streams";
+      return;
+    }
+    auto& groups = tensor_groups_.groups;
+    std::map<std::pair<int, int>, std::vector<int>> candidates;
+    for (size_t i = 0; i < groups.size(); ++i) {
+      const auto& group = groups[i];
+      if (group.live_begin < 0 || group.size <= 0 || group.members.empty() ||
+          group.arena.defined() || tensor_groups_.HasOutputTensor(i)) {
+        continue;
+      }
+      candidates[std::make_pair(group.device_type, group.device_id)].push_back(i);
+    }
+    for (const auto& kv : candidates) {
+      const auto& group_ids = kv.second;
+      if (group_ids.size() < 2) {
+        continue;
+      }
+      Arena arena;
+      arena.size = PackArena(&groups, group_ids);
+      arena.num_live_groups = group_ids.size();
+      int first = group_ids[0];
+      for (int gid : group_ids) {
+        arena.alignment = std::max(arena.alignment, groups[gid].alignment);
+        if (groups[gid].live_begin < groups[first].live_begin) {
+          first = gid;
+        }
+      }
+      Var arena_storage = groups[first].storage;
+      for (int gid : group_ids) {
+        groups[gid].arena = arena_storage;
+      }
+      DLOG(INFO) << "Pack " << group_ids.size() << " groups into arena "
+                 << arena_storage->name_hint() << " of " << arena.size << " bytes";
+      arenas_.emplace(arena_storage, arena);
+    }
+  }
 
   inline Expr MakeFreeMemory(const Var& memory_var) {
     static const Op& op = Op::Get("raf.op.vm.free");
@@ -386,6 +741,12 @@ class MemoryPlanner : public ExprMutator {
   VSet used_storages_;
   /*! \brief Current live tensor vars. */
   VSet live_tensors_;
+  /*! \brief Whether to pack the tensor groups into arenas. */
+  bool use_arena_;
+  /*! \brief Whether to place the tensor lists of the collectives contiguously. */
+  bool contiguous_collectives_;
+  /*! \brief The arenas keyed by their storage vars. */
+  StdMap<Arena> arenas_;
 };
 
 /*! \brief A visitor to group tensors generated by alloc_tensor according to
@@ -394,11 +755,16 @@ class MemoryPlanner : public ExprMutator {
  * 1) has no other tensors in the live-in set of the current tensor,
  * 2) has the same the alignment, and
  * 3) has the closest storage size as the current tensor.
+ * The tensors with dynamic sizes join a group only if the symbolic size mode is enabled.
  */
 class MemoryPlanner::TensorGrouper : public ExprVisitor {
  public:
-  TensorGrouper(const Expr& body, liveness_analysis::LivenessAnalyzer* analyzer)
-      : analyzer_(analyzer), tensor_groups_(analyzer), ell_(ExplicitLetList::make(body)) {
+  TensorGrouper(const Expr& body, liveness_analysis::LivenessAnalyzer* analyzer,
+                bool use_symbolic_size)
+      : analyzer_(analyzer),
+        tensor_groups_(analyzer),
+        ell_(ExplicitLetList::make(body)),
+        use_symbolic_size_(use_symbolic_size) {
     CHECK(analyzer_->IsSuccess());
   }
 
@@ -412,11 +778,51 @@ class MemoryPlanner::TensorGrouper : public ExprVisitor {
       expr_map_[vars[i]] = exprs[i];
     }
 
+    // Check whether multiple streams are used, and collect the symbolic sizes of the dynamic
+    // tensors from the types of the functions that write them.
+    static const Op& set_stream_op = Op::Get("raf.op.set_stream");
+    static const Op& invoke_op = Op::Get("raf.op.vm.invoke_op");
+    for (size_t i = 0; i < n; ++i) {
+      const auto* call = exprs[i].as<CallNode>();
+      if (call && call->op.same_as(set_stream_op)) {
+        tensor_groups_.multi_stream = true;
+      } else if (call && call->op.same_as(invoke_op)) {
+        CollectBuckets(call);
+        if (use_symbolic_size_) {
+          CollectSymbolicSizes(call);
+        }
+      }
+    }
+    if (tensor_groups_.multi_stream) {
+      // The program order does not reflect the execution order across streams.
+      symbolic_sizes_.clear();
+    }
+
     for (int i = 0; i < n; ++i) {
       curr_let_ = vars[i];
+      curr_index_ = i;
       ExprVisitor::VisitExpr(exprs[i]);
     }
 
+    // Extend the live intervals of the top-level tensor groups to their last uses.
+    StdMap<int> tensor_to_group;
+    for (size_t j = 0; j < tensor_groups_.groups.size(); ++j) {
+      if (tensor_groups_.groups[j].live_begin >= 0) {
+        for (const auto& member : tensor_groups_.groups[j].members) {
+          tensor_to_group[member.first] = j;
+        }
+      }
+    }
+    for (int i = 0; i < n; ++i) {
+      for (const auto& tensor_var : analyzer_->GetLiveVars(vars[i])) {
+        auto it = tensor_to_group.find(tensor_var);
+        if (it != tensor_to_group.end()) {
+          auto& group = tensor_groups_.groups[it->second];
+          group.live_end = std::max(group.live_end, static_cast<int64_t>(i));
+        }
+      }
+    }
+
     return tensor_groups_;
   }
 
@@ -424,6 +830,7 @@ class MemoryPlanner::TensorGrouper : public ExprVisitor {
     static const Op& alloc_storage_op = Op::Get("raf.op.vm.alloc_storage");
     static const Op& alloc_tensor_op = Op::Get("raf.op.vm.alloc_tensor");
     static const Op& reshape_tensor_op = Op::Get("raf.op.vm.set_shape");
+    static const Op& set_stream_op = Op::Get("raf.op.set_stream");
     const auto* op_node = node->op.as<OpNode>();
 
     if (GetRef<Op>(op_node) == alloc_tensor_op) {
@@ -453,10 +860,51 @@ class MemoryPlanner::TensorGrouper : public ExprVisitor {
         storage_nbytes = size_val.as<IntValueObj>()->value;
       }
 
+      // Device, which is only recorded for the tensors bound at the top level, as the nested
+      // scopes are not indexed.
+      auto device_type = storage_node->args[2].as<ConstantNode>();
+      auto device_id = storage_node->args[3].as<ConstantNode>();
+      bool is_top_level = device_type && device_id && expr_map_[curr_let_].get() == node;
+
+      // Reuse the storage of a dead dynamic tensor if this tensor provably fits into it.
+      auto size_it = symbolic_sizes_.find(curr_let_);
+      if (storage_nbytes == -1 && is_top_level && size_it != symbolic_sizes_.end()) {
+        auto group_id = tensor_groups_.FindDynamicGroup(
+            curr_let_, alignment, device_type->value.as<IntValueObj>()->value,
+            device_id->value.as<IntValueObj>()->value, size_it->second);
+        if (group_id != -1) {
+          DLOG(INFO) << curr_let_->name_hint() << " joins dynamic group " << group_id;
+          tensor_groups_.JoinGroup(group_id, curr_let_, storage_nbytes);
+          return;
+        }
+      }
+
+      // The storage is shared by multiple tensors at different offsets, e.g., the concatenate
+      // output and its inputs planned by ManifestAlloc, so they must stay in one group.
+      auto shared_group_id = tensor_groups_.FindGroupIdByStorageVar(storage_var);
+      if (shared_group_id != -1) {
+        DLOG(INFO) << curr_let_->name_hint() << " joins group " << shared_group_id;
+        tensor_groups_.JoinGroup(shared_group_id, curr_let_, storage_nbytes);
+        return;
+      }
+
       // Create a new tensor group.
       auto cand_group_id = tensor_groups_.CreateGroup(storage_var, alignment);
       DLOG(INFO) << "Create a new group " << cand_group_id << " for " << storage_var->name_hint();
       tensor_groups_.JoinGroup(cand_group_id, curr_let_, storage_nbytes);
+
+      // Device and live interval, which are used to pack the groups into arenas or to reuse the
+      // dynamic storages.
+      auto& group = tensor_groups_.groups[cand_group_id];
+      if (is_top_level) {
+        group.device_type = device_type->value.as<IntValueObj>()->value;
+        group.device_id = device_id->value.as<IntValueObj>()->value;
+        group.live_begin = curr_index_;
+        group.live_end = curr_index_;
+      }
+      if (size_it != symbolic_sizes_.end()) {
+        group.symbolic_size = size_it->second;
+      }
     } else if (GetRef<Op>(op_node) == reshape_tensor_op) {
       // set_shape creates a new tensor view so it has to be considered as a new tensor too.
       for (auto& arg : node->args) {
@@ -473,12 +921,112 @@ class MemoryPlanner::TensorGrouper : public ExprVisitor {
         tensor_groups_.JoinGroup(group_id, curr_let_);
       }
     } else {
+      if (op_node && GetRef<Op>(op_node) == set_stream_op) {
+        tensor_groups_.multi_stream = true;
+      }
       ExprVisitor::VisitExpr_(node);
     }
   }
 
+  /*! \brief Get the function invoked by invoke_op, which may be the output of infer_type. */
+  Function GetInvokedFunction(Expr func) {
+    static const Op& infer_type_op = Op::Get("raf.op.vm.infer_type");
+    while (func.as<VarNode>()) {
+      auto it = expr_map_.find(Downcast<Var>(func));
+      if (it == expr_map_.end()) {
+        return Function();
+      }
+      func = it->second;
+      if (const auto* tgi = func.as<TupleGetItemNode>()) {
+        auto tuple_it = tgi->tuple.as<VarNode>() ? expr_map_.find(Downcast<Var>(tgi->tuple))
+                                                  : expr_map_.end();
+        const auto* call =
+            tuple_it != expr_map_.end() ? tuple_it->second.as<CallNode>() : nullptr;
+        if (tgi->index != 0 || !call || !call->op.same_as(infer_type_op)) {
+          return Function();
+        }
+        func = call->args[0];
+      }
+    }
+    return func.as<FunctionNode>() ? Downcast<Function>(func) : Function();
+  }
+
+  /*! \brief Get the expression bound to the given var, or the expression itself if not a var. */
+  Expr GetBoundExpr(const Expr& expr) {
+    if (const auto* var = expr.as<VarNode>()) {
+      auto it = expr_map_.find(GetRef<Var>(var));
+      return it != expr_map_.end() ? it->second : expr;
+    }
+    return expr;
+  }
+
+  /*! \brief Collect the input and output tensor lists of an allreduce as buckets. */
+  void CollectBuckets(const CallNode* invoke_call) {
+    static const Op& allreduce_op = Op::Get("raf.op._allreduce");
+    const auto* op_node = GetBoundExpr(invoke_call->args[0]).as<OpNode>();
+    if (!op_node) {
+      return;
+    }
+    auto op = GetRef<Op>(op_node);
+    if ((IsDialectOp(op) ? GetBaseOp(op) : op) != allreduce_op) {
+      return;
+    }
+    const auto* ins = GetBoundExpr(invoke_call->args[1]).as<TupleNode>();
+    const auto* x = ins && !ins->fields.empty() ? GetBoundExpr(ins->fields[0]).as<TupleNode>()
+                                                : nullptr;
+    const auto* outs = GetBoundExpr(invoke_call->args[2]).as<TupleNode>();
+    for (const auto* tensors : {x, outs}) {
+      if (!tensors || tensors->fields.size() < 2) {
+        continue;
+      }
+      std::vector<Var> bucket;
+      for (const auto& field : tensors->fields) {
+        if (!field.as<VarNode>()) {
+          bucket.clear();
+          break;
+        }
+        bucket.push_back(Downcast<Var>(field));
+      }
+      if (!bucket.empty()) {
+        tensor_groups_.buckets.push_back(bucket);
+      }
+    }
+  }
+
+  /*! \brief Collect the symbolic sizes of the output tensors from the invoked function type. */
+  void CollectSymbolicSizes(const CallNode* invoke_call) {
+    auto func = GetInvokedFunction(invoke_call->args[0]);
+    const auto* outs_var = invoke_call->args[2].as<VarNode>();
+    if (!func.defined() || !func->ret_type.defined() || !outs_var) {
+      return;
+    }
+    auto outs_it = expr_map_.find(GetRef<Var>(outs_var));
+    const auto* outs = outs_it != expr_map_.end() ? outs_it->second.as<TupleNode>() : nullptr;
+    if (!outs) {
+      return;
+    }
+    Array<Type> out_types;
+    if (const auto* tuple_type = func->ret_type.as<TupleTypeNode>()) {
+      out_types = tuple_type->fields;
+    } else {
+      out_types.push_back(func->ret_type);
+    }
+    if (out_types.size() != outs->fields.size()) {
+      return;
+    }
+    for (size_t i = 0; i < out_types.size(); ++i) {
+      const auto* out_var = outs->fields[i].as<VarNode>();
+      const auto* tensor_type = out_types[i].as<TensorTypeNode>();
+      if (out_var && tensor_type) {
+        symbolic_sizes_[GetRef<Var>(out_var)] = GetSymbolicSize(tensor_type);
+      }
+    }
+  }
+
   /*! \brief The current processing let var. */
   Var curr_let_;
+  /*! \brief The index of the current processing let var. */
+  int64_t curr_index_ = -1;
   /*! \brief The let list. */
   std::unique_ptr<ExplicitLetList> ell_{nullptr};
   /*! \brief A map from let varr to its expression. */
@@ -487,19 +1035,31 @@ class MemoryPlanner::TensorGrouper : public ExprVisitor {
   liveness_analysis::LivenessAnalyzer* analyzer_;
   /*! \brief A list of storage allocation groups. */
   TensorGroups tensor_groups_;
+  /*! \brief Whether to reuse the storages of dynamic tensors by their symbolic sizes. */
+  bool use_symbolic_size_;
+  /*! \brief The symbolic sizes of the dynamic tensors. */
+  StdMap<SymbolicSize> symbolic_sizes_;
 };
 
-TensorGroups MemoryPlanner::Group() {
-  return TensorGrouper(func_, analyzer_).Run();
+TensorGroups MemoryPlanner::Group(bool use_symbolic_size) {
+  return TensorGrouper(func_, analyzer_, use_symbolic_size).Run();
 }
 
 }  // namespace memory_plan
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_plan.dump_liveness_stat", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_plan.use_arena", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_plan.use_symbolic_size", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_plan.contiguous_collectives", Bool);
 
 Pass MemoryPlan() {
   PassContext pass_ctx = PassContext::Current();
   Bool dump_stat = pass_ctx->GetConfig("raf.memory_plan.dump_liveness_stat", Bool(false)).value();
+  Bool use_arena = pass_ctx->GetConfig("raf.memory_plan.use_arena", Bool(false)).value();
+  Bool use_symbolic_size =
+      pass_ctx->GetConfig("raf.memory_plan.use_symbolic_size", Bool(false)).value();
+  Bool contiguous_collectives =
+      pass_ctx->GetConfig("raf.memory_plan.contiguous_collectives", Bool(false)).value();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
     auto func = f;
@@ -512,20 +1072,23 @@ Pass MemoryPlan() {
 
     auto analyzer = liveness_analysis::LivenessAnalyzer(func);
     try {
-      auto live_in = analyzer.Run();
+      analyzer.Run();
       if (!analyzer.IsSuccess()) {
         throw;
       }
       if (dump_stat) {
-        liveness_analysis::DumpLivenessStat(live_in);
+        liveness_analysis::DumpLivenessStat(analyzer.GetLiveIn());
       }
     } catch (const dmlc::Error& e) {
       LOG(WARNING) << "Memory planning is disabled because liveness analysis was failed";
       return func;
     }
-    return Downcast<ir::Function>(memory_plan::MemoryPlanner(func, &analyzer).Run());
+    return Downcast<ir::Function>(
+        memory_plan::MemoryPlanner(func, &analyzer, use_arena, use_symbolic_size,
+                                   contiguous_collectives)
+            .Run());
   };
-  return CreateRAFFunctionPass(pass_func, 2, "MemoryPlan", {});
+  return CreateRAFFunctionPass(pass_func, 2, "MemoryPlan", {}, true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.MemoryPlan").set_body_typed(MemoryPlan);
@@ -0,0 +1,290 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file overlap_collective_matmul.cc
+ * \brief Decompose the allgather before and the reduce-scatter after a tensor parallel GEMM into
+ * chunks, so that the collective of a chunk overlaps with the GEMM of another chunk.
+ */
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/ir_ext.h"
+#include "raf/op_utils.h"
+#include "raf/pass.h"
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace overlap_collective_matmul {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*!
+ * \brief Split the collectives inserted by ShardTensorParallel around the GEMMs into n_chunk
+ * chunks along the samples. Each chunk is an independent collective and GEMM, so that when the
+ * collectives run on the communication stream, the GEMM of a chunk only waits for the collective of
+ * the same chunk, and the collectives of the other chunks are hidden behind it.
+ *
+ * An allgather along the first axis whose output is only used as the data of GEMMs (column
+ * parallel) is split into the chunks of the local samples:
+ *   let %g = raf.op._allgather(%x, 0, nullptr);     // [n, k] -> [P * n, k]
+ *   let %y = raf.op.dense(%g, %w);
+ * becomes:
+ *   let %xs = raf.op.split(%x, n_chunk, 0);
+ *   let %g_c = raf.op._allgather(%xs.c, 0, nullptr);  // [P * m, k], m = n / n_chunk
+ *   let %y_c = raf.op.reshape(raf.op.dense(%g_c, %w), [P, m, out]);
+ *   let %y = raf.op.reshape(raf.op.concatenate((%y_0, ...), 1), [P * n, out]);
+ *
+ * A reduce-scatter of the partial output of a GEMM (row parallel) is split into the chunks of the
+ * samples of each rank:
+ *   let %p = raf.op.dense(%d, %w);                  // [P * n, out]
+ *   let %r = raf.op._reduce_scatter(%p, "sum", nullptr);
+ * becomes:
+ *   let %ds = raf.op.split(raf.op.reshape(%d, [P, n, k]), n_chunk, 1);
+ *   let %r_c = raf.op._reduce_scatter(raf.op.dense(raf.op.reshape(%ds.c, [P * m, k]), %w), ...);
+ *   let %r = raf.op.concatenate((%r_0, ...), 0);
+ *
+ * A ring of _send/_recv between the neighbors would avoid the reshapes, but the point-to-point ops
+ * on one stream deadlock without a group launch, so the chunked collectives are used instead.
+ */
+class CollectiveMatmulDecomposer {
+ public:
+  CollectiveMatmulDecomposer(const Function& func, int n_chunk) : func_(func), n_chunk_(n_chunk) {
+  }
+
+  Function Run() {
+    if (n_chunk_ <= 1 || !func_->body.as<LetNode>()) {
+      return func_;
+    }
+    ell_ = ExplicitLetList::make(func_->body);
+    Analyze();
+    if (gathers_.empty() && scatters_.empty()) {
+      return func_;
+    }
+    return Function(func_->params, Rebuild(), {}, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Find the collectives to be decomposed. */
+  void Analyze() {
+    static const Op& allgather_op = Op::Get("raf.op._allgather");
+    static const Op& reduce_scatter_op = Op::Get("raf.op._reduce_scatter");
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    std::unordered_map<const VarNode*, std::vector<int>> uses;
+    std::unordered_map<const VarNode*, int> pos;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      for (const auto& var : FreeVars(exprs[i])) {
+        uses[var.get()].push_back(i);
+      }
+      pos[vars[i].get()] = i;
+    }
+    const auto* ret = ell_->ret.get();
+
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      const auto* call = exprs[i].as<CallNode>();
+      if (call == nullptr || !OnGlobalComm(call)) {
+        continue;
+      }
+      const auto* var = vars[i].get();
+      if (call->op.same_as(allgather_op)) {
+        // Column parallel: every use of the gathered samples is the data of a GEMM.
+        auto axis = ConstArg(call, 1);
+        if (!axis.defined() || GetScalarValueData<int64_t>(axis) != 0 || var == ret ||
+            !IsSplittable(call->args[0], 0)) {
+          continue;
+        }
+        const auto& users = uses[var];
+        bool all_gemm = !users.empty();
+        for (int j : users) {
+          const auto* gemm = exprs[j].as<CallNode>();
+          all_gemm = all_gemm && gemm && IsGemm(gemm) && gemm->args[0].get() == var &&
+                     gemm->args[1].get() != var;
+        }
+        if (all_gemm) {
+          gathers_[i] = {};
+          for (int j : users) {
+            gemm_gather_[j] = i;
+          }
+        }
+      } else if (call->op.same_as(reduce_scatter_op)) {
+        // Row parallel: the reduce-scattered tensor is the partial output of a GEMM.
+        const auto* partial = call->args[0].as<VarNode>();
+        if (partial == nullptr || !pos.count(partial) || uses[partial].size() != 1 ||
+            partial == ret || !IsSplittable(vars[i], 0)) {
+          continue;
+        }
+        int j = pos.at(partial);
+        const auto* gemm = exprs[j].as<CallNode>();
+        if (gemm == nullptr || !IsGemm(gemm) || gemm_gather_.count(j)) {
+          continue;
+        }
+        scatters_[i] = j;
+        skipped_.insert(j);
+      }
+    }
+  }
+
+  /*! \brief Rebuild the function body with the decomposed collectives. */
+  Expr Rebuild() {
+    static const Op& allgather_op = Op::Get("raf.op._allgather");
+    static const Op& reduce_scatter_op = Op::Get("raf.op._reduce_scatter");
+    static const Op& split_op = Op::Get("raf.op.split");
+    static const Op& reshape_op = Op::Get("raf.op.reshape");
+    static const Op& concatenate_op = Op::Get("raf.op.concatenate");
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    auto sections = MakeConstant(ScalarValue::make(static_cast<int64_t>(n_chunk_)));
+
+    LetList ll;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      if (skipped_.count(i)) {
+        // The GEMM is emitted in chunks with the reduce-scatter of its output.
+        continue;
+      }
+      const auto* call = exprs[i].as<CallNode>();
+      if (gathers_.count(i)) {
+        // Issue the allgathers of all chunks here, which overlap with the ops until the GEMMs.
+        auto parts = ll.Push(Call(split_op, {call->args[0], sections, Int(0)}));
+        for (int c = 0; c < n_chunk_; ++c) {
+          auto part = ll.Push(TupleGetItem(parts, c));
+          gathers_[i].push_back(ll.Push(Call(allgather_op, {part, Int(0), call->args[2]})));
+        }
+      } else if (gemm_gather_.count(i)) {
+        int gather_pos = gemm_gather_.at(i);
+        auto shape = GetShape(vars[i]);
+        int64_t n_sample = GetShape(exprs[gather_pos].as<CallNode>()->args[0])[0];
+        int64_t n_part = shape[0] / n_sample;
+        Array<Expr> outs;
+        for (const auto& gathered : gathers_.at(gather_pos)) {
+          auto out =
+              ll.Push(Call(call->op, {gathered, call->args[1]}, call->attrs, call->type_args));
+          outs.push_back(ll.Push(Call(reshape_op, {out, Shape({n_part, -1, shape[1]})})));
+        }
+        auto cat = ll.Push(Call(concatenate_op, {ll.Push(Tuple(outs)), Int(1)}));
+        ll.Push(vars[i], Call(reshape_op, {cat, Shape(shape)}));
+      } else if (scatters_.count(i)) {
+        const auto* gemm = exprs[scatters_.at(i)].as<CallNode>();
+        auto data_shape = GetShape(gemm->args[0]);
+        int64_t n_sample = GetShape(vars[i])[0];
+        int64_t n_part = data_shape[0] / n_sample;
+        auto data = ll.Push(Call(reshape_op, {gemm->args[0], Shape({n_part, n_sample, -1})}));
+        auto parts = ll.Push(Call(split_op, {data, sections, Int(1)}));
+        Array<Expr> outs;
+        for (int c = 0; c < n_chunk_; ++c) {
+          auto part = ll.Push(TupleGetItem(parts, c));
+          part = ll.Push(Call(reshape_op, {part, Shape({n_sample / n_chunk_ * n_part, -1})}));
+          auto partial = ll.Push(Call(gemm->op, {part, gemm->args[1]}, gemm->attrs,
+                                      gemm->type_args));
+          outs.push_back(ll.Push(Call(reduce_scatter_op, {partial, call->args[1], call->args[2]})));
+        }
+        ll.Push(vars[i], Call(concatenate_op, {ll.Push(Tuple(outs)), Int(0)}));
+      } else {
+        ll.Push(vars[i], exprs[i]);
+      }
+    }
+    return ll.Get(ell_->ret);
+  }
+
+  static bool IsGemm(const CallNode* call) {
+    static const Op& dense_op = Op::Get("raf.op.dense");
+    static const Op& matmul_op = Op::Get("raf.op.matmul");
+    static const Op& matmul_nt_op = Op::Get("raf.op.matmul_nt");
+    // The rows of the output are the rows of the data for these GEMMs.
+    return call->op.same_as(dense_op) || call->op.same_as(matmul_op) ||
+           call->op.same_as(matmul_nt_op);
+  }
+
+  /*! \brief Check whether a collective runs on the global communicator. */
+  static bool OnGlobalComm(const CallNode* call) {
+    if (call->args.size() < 3) {
+      return true;
+    }
+    return call->args[2].as<ConstantNode>() && !ConstArg(call, 2).defined();
+  }
+
+  /*! \brief Get the value of a constant argument, or nullptr if it is not a constant. */
+  static Value ConstArg(const CallNode* call, size_t i) {
+    if (i >= call->args.size()) {
+      return Value();
+    }
+    if (const auto* node = call->args[i].as<ConstantNode>()) {
+      return Downcast<Value>(ConstantExtractValue(GetRef<Constant>(node)));
+    }
+    return Value();
+  }
+
+  /*! \brief Check whether a 2-D tensor can be split into the chunks along the first axis. */
+  bool IsSplittable(const Expr& expr, int axis) {
+    const auto* ttype = expr->checked_type_.as<TensorTypeNode>();
+    if (ttype == nullptr || ttype->shape.size() != 2) {
+      return false;
+    }
+    const auto* dim = ttype->shape[axis].as<IntImmNode>();
+    return dim != nullptr && dim->value % n_chunk_ == 0;
+  }
+
+  static std::vector<int64_t> GetShape(const Expr& expr) {
+    const auto* ttype = expr->checked_type().as<TensorTypeNode>();
+    CHECK(ttype != nullptr) << "Expected a tensor, but got " << expr->checked_type();
+    std::vector<int64_t> shape;
+    for (const auto& dim : ttype->shape) {
+      const auto* value = dim.as<IntImmNode>();
+      CHECK(value != nullptr) << "Do not support dynamic shape yet";
+      shape.push_back(value->value);
+    }
+    return shape;
+  }
+
+  static Expr Shape(const std::vector<int64_t>& shape) {
+    Array<Value> fields;
+    for (auto dim : shape) {
+      fields.push_back(ScalarValue::make(dim));
+    }
+    return MakeConstant(TupleValue::make(fields));
+  }
+
+  static Expr Int(int64_t value) {
+    return MakeConstant(ScalarValue::make(value));
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The number of chunks of each collective. */
+  int n_chunk_;
+  /*! \brief The let list of the function body. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief Mapping from the position of a decomposed allgather to its chunks. */
+  std::unordered_map<int, std::vector<Expr>> gathers_;
+  /*! \brief Mapping from the position of a GEMM to the position of the allgather of its data. */
+  std::unordered_map<int, int> gemm_gather_;
+  /*! \brief Mapping from the position of a split reduce-scatter to the position of its GEMM. */
+  std::unordered_map<int, int> scatters_;
+  /*! \brief The positions of the GEMMs that are emitted with their reduce-scatters. */
+  std::unordered_set<int> skipped_;
+};
+
+}  // namespace overlap_collective_matmul
+
+Pass OverlapCollectiveMatmul(int n_chunk) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return overlap_collective_matmul::CollectiveMatmulDecomposer(f, n_chunk).Run();
+  };
+  auto decompose = CreateRAFFunctionPass(pass_func, 0, "OverlapCollectiveMatmulFunc", {});
+  return RAFSequential({InferType(), decompose, EraseType()}, "OverlapCollectiveMatmul");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.OverlapCollectiveMatmul")
+    .set_body_typed(OverlapCollectiveMatmul);
+
+}  // namespace pass
+}  // namespace raf
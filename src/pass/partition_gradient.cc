@@ -11,7 +11,15 @@
  *         consider gradient partitioning if applied; otherwise the result will be incorrect.
  * ZeRO-2: Replace the allreduce inserted by AutoDataParallel with reduce_scatter to obtain only
  *         a partition of gradients.
+ * Offload: In addition to ZeRO-1/2, copy the gradient partitions to the host, where the optimizer
+ *          keeps its status (ZeRO-Offload, https://arxiv.org/abs/2101.06840).
+ * Flat buffers: In addition to ZeRO-1/2, the given buckets of gradients are flattened and packed
+ *          into one flat buffer each, which is padded and partitioned once, instead of padding and
+ *          partitioning each gradient. Each gradient of a bucket is then replaced by the partition
+ *          of the flat buffer in the output gradient tuple.
  */
+#include <unordered_map>
+#include <unordered_set>
 #include "raf/pass.h"
 
 #include "./common.h"
@@ -24,8 +32,14 @@ namespace partition_gradient {
 
 class GradientPartitioner : public ExprMutator {
  public:
-  GradientPartitioner(int opt_level, int n_part, int64_t bucket_size, const Function& func)
-      : opt_level_(opt_level), n_part_(n_part), bucket_size_(bucket_size), func_(func) {
+  GradientPartitioner(int opt_level, int n_part, int64_t bucket_size,
+                      const std::string& offload_device, const Array<Array<Integer>>& flat_buckets,
+                      const Function& func)
+      : opt_level_(opt_level),
+        n_part_(n_part),
+        bucket_size_(bucket_size),
+        offload_device_(offload_device),
+        func_(func) {
     // Build the var to expr map for the ANF.
     Map<Var, Expr> var_to_expr;
     auto ell = ExplicitLetList::make(func->body);
@@ -51,8 +65,32 @@ class GradientPartitioner : public ExprMutator {
       grads = var_to_expr[grad_tuple_var_];
     }
     auto grad_fields = Downcast<Tuple>(grads)->fields;
-    for (auto field : grad_fields) {
-      if (field->IsInstance<VarNode>()) {
+    field_bucket_.resize(grad_fields.size(), -1);
+    for (const auto& bucket : flat_buckets) {
+      int bucket_id = flat_buckets_.size();
+      flat_buckets_.emplace_back();
+      auto& flat = flat_buckets_.back();
+      std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> bucket_vars;
+      for (const auto& index : bucket) {
+        CHECK(index->value >= 0 && index->value < static_cast<int64_t>(grad_fields.size()))
+            << "Gradient index " << index->value << " is out of range";
+        CHECK_EQ(field_bucket_[index->value], -1)
+            << "Gradient " << index->value << " is in more than one flat buffer";
+        field_bucket_[index->value] = bucket_id;
+        auto field = grad_fields[index->value];
+        flat.fields.push_back(field);
+        if (auto var = field.as<VarNode>()) {
+          if (bucket_vars.insert(GetRef<Var>(var)).second) {
+            flat_vars_[GetRef<Var>(var)].push_back(bucket_id);
+          }
+        }
+      }
+      flat.n_pending = bucket_vars.size();
+    }
+    for (size_t i = 0; i < grad_fields.size(); ++i) {
+      auto field = grad_fields[i];
+      if (field->IsInstance<VarNode>() && field_bucket_[i] < 0 &&
+          !flat_vars_.count(Downcast<Var>(field))) {
         grads_.Set(Downcast<Var>(field), Expr());
         last_all_reduce_ = Downcast<Var>(field);
       }
@@ -63,7 +101,7 @@ class GradientPartitioner : public ExprMutator {
 
   /*! \brief Partition the parameters according to the parameter group. */
   Function Partition(int rank) {
-    if (grads_.empty()) {  // No gradients to be partitioned.
+    if (grads_.empty() && flat_buckets_.empty()) {  // No gradients to be partitioned.
       return func_;
     }
 
@@ -86,16 +124,50 @@ class GradientPartitioner : public ExprMutator {
         // The curr_var is a complete gradient.
         CHECK(!grads_[curr_var].defined());
         SliceGrad(scope, curr_var, value, opt_level_);
+      } else if (flat_vars_.count(curr_var) > 0) {
+        // The curr_var is a gradient in flat buffers, which are packed once they are complete.
+        // The allreduce of ZeRO-2 is deferred, as it may be replaced by the reduce_scatter of the
+        // flat buffer.
+        flat_values_.Set(curr_var, value);
+        if (opt_level_ < 2 || !std::get<0>(GetAllReduceExpr(value)).defined()) {
+          scope->Push(curr_var, value);
+          flat_pushed_.insert(curr_var);
+        }
+        for (int bucket_id : flat_vars_[curr_var]) {
+          if (--flat_buckets_[bucket_id].n_pending == 0) {
+            PackFlatBucket(scope, bucket_id);
+          }
+        }
       } else if (curr_var == grad_tuple_var_) {
         // Replace gradients with sliced ones.
         Array<Expr> fields;
-        for (auto field : Downcast<Tuple>(value)->fields) {
+        auto value_fields = Downcast<Tuple>(value)->fields;
+        for (size_t i = 0; i < value_fields.size(); ++i) {
+          auto field = value_fields[i];
+          if (i < field_bucket_.size() && field_bucket_[i] >= 0) {
+            // Flat buffers: The gradient is replaced by the partition of its flat buffer.
+            auto& flat = flat_buckets_[field_bucket_[i]];
+            if (!flat.shard.defined()) {
+              // All gradients of the bucket are constants.
+              PackFlatBucket(scope, field_bucket_[i]);
+            }
+            if (!offload_device_.empty() && !flat.offloaded.defined()) {
+              flat.offloaded = scope->Push(MakeDeviceCopy(flat.shard));
+            }
+            fields.push_back(offload_device_.empty() ? flat.shard : flat.offloaded);
+            continue;
+          }
           if (field->IsInstance<VarNode>()) {
             auto var_node = field.as<VarNode>();
             auto var = GetRef<Var>(var_node);
             if (grads_.count(var) > 0) {
               CHECK(grads_[var].defined())
                   << "Internal error: gradient " << var << " does not map to the sliced one";
+              if (!offload_device_.empty()) {
+                // Offload: Copy the gradient partition to the (pinned) host memory.
+                fields.push_back(scope->Push(MakeDeviceCopy(grads_[var])));
+                continue;
+              }
               fields.push_back(grads_[var]);
               continue;
             }
@@ -310,6 +382,99 @@ class GradientPartitioner : public ExprMutator {
     }
   }
 
+  /*!
+   * \brief Pack the gradients of a flat bucket into a flat buffer and partition it. The desired IR
+   * for ZeRO-2, if all gradients of the bucket are allreduced, is:
+   * let %1 = op(%0);                // A backward op to generate a gradient
+   * let %2 = reshape(%1, [-1]);
+   * ...                             // The other gradients of the bucket
+   * let %5 = (%2, %4);
+   * let %6 = concatenate(%5, 0);
+   * let %7 = pad(%6, ...);
+   * let %8 = reduce_scatter(%7, avg); // Or sum followed by divide if NCCL version is < 2.10
+   * Otherwise, the complete gradients are packed as ZeRO-1, and %8 is split(%7, n_part).rank.
+   */
+  void PackFlatBucket(LetList* scope, int bucket_id) {
+    static const Op& reshape_op = Op::Get("raf.op.reshape");
+    static const Op& concatenate_op = Op::Get("raf.op.concatenate");
+    static const Op& split_op = Op::Get("raf.op.split");
+    static const Op& reduce_scatter_op = Op::Get("raf.op._reduce_scatter");
+    auto& flat = flat_buckets_[bucket_id];
+    CHECK(!flat.fields.empty());
+
+    // ZeRO-2 only applies if all gradients of the bucket are allreduced.
+    bool scatter = opt_level_ > 1 && flat.n_pending == 0;
+    bool has_var = false;
+    for (const auto& field : flat.fields) {
+      if (auto var = field.as<VarNode>()) {
+        auto value = flat_values_[GetRef<Var>(var)];
+        scatter = scatter && std::get<0>(GetAllReduceExpr(value)).defined();
+        has_var = true;
+      }
+    }
+    scatter = scatter && has_var;
+
+    Array<Expr> parts;
+    Expr compute, divide_expr;
+    int64_t size = 0;
+    DataType dtype;
+    for (const auto& field : flat.fields) {
+      Expr grad = field;
+      if (auto var_node = field.as<VarNode>()) {
+        auto var = GetRef<Var>(var_node);
+        auto value = flat_values_[var];
+        Expr allreduce_expr;
+        std::tie(allreduce_expr, divide_expr) = GetAllReduceExpr(value);
+        if (scatter) {
+          // Take the local gradient, and drop the allreduce.
+          compute = GetNArg(allreduce_expr, 1);
+          auto first_arg = Downcast<Var>(GetNArg(allreduce_expr, 0));
+          auto arg_tuple = Downcast<Tuple>(var_to_expr_[first_arg]);
+          CHECK_EQ(arg_tuple->fields.size(), 1U) << "Not supported yet";
+          grad = arg_tuple->fields[0];
+        } else if (!flat_pushed_.count(var)) {
+          scope->Push(var, value);
+          flat_pushed_.insert(var);
+        }
+      }
+      auto ttype = field->checked_type().as<TensorTypeNode>();
+      CHECK(ttype != nullptr) << "Expected a tensor, but got " << field->checked_type();
+      if (parts.empty()) {
+        dtype = ttype->dtype;
+      }
+      CHECK(dtype == ttype->dtype) << "The gradients of a flat buffer must have the same dtype";
+      size += common::shape_utils::GetElementNum(field);
+      parts.push_back(scope->Push(
+          Call(reshape_op, {grad, MakeConstant(op::ArrayToIntTuple(std::vector<int64_t>{-1}))})));
+    }
+    Var flat_var = Downcast<Var>(parts[0]);
+    if (parts.size() > 1) {
+      flat_var = scope->Push(Call(concatenate_op, {scope->Push(Tuple(parts)),
+                                                   MakeConstant(ScalarValue::make(0))}));
+    }
+    flat_var->checked_type_ = TensorType({Integer(size)}, dtype);
+    flat_var = GenPadCall(scope, flat_var);
+
+    if (scatter) {
+      flat.shard = scope->Push(Call(reduce_scatter_op, {flat_var, compute}));
+      if (divide_expr.defined()) {
+        auto divide_call = divide_expr.as<CallNode>();
+        flat.shard = scope->Push(Call(divide_call->op, {flat.shard, divide_call->args[1]}));
+      }
+    } else {
+      auto split = scope->Push(Call(split_op, {flat_var, MakeConstant(ScalarValue::make(n_part_)),
+                                               MakeConstant(ScalarValue::make(0))}));
+      flat.shard = scope->Push(TupleGetItem(split, rank_));
+    }
+  }
+
+  /*! \brief Make a device_copy call to copy a gradient partition to the host. */
+  inline Call MakeDeviceCopy(const Expr& data) {
+    static const Op& device_copy_op = Op::Get("raf.op.device_copy");
+    return Call(device_copy_op, {data, MakeConstant(StringValue::make(offload_device_)),
+                                 MakeConstant(StringValue::make("cpu"))});
+  }
+
   void IssueGroupScatter(LetList* scope, Constant compute) {
     static const Op& group_reduce_scatter = Op::Get("raf.op._group_reduce_scatter");
     auto inputs = scope->Push(Tuple(scatter_input_));
@@ -334,6 +499,8 @@ class GradientPartitioner : public ExprMutator {
   int opt_level_;
   /*! \brief The expected number of partitions. */
   int n_part_;
+  /*! \brief The device of the gradients to be copied to the host, or empty to keep them. */
+  std::string offload_device_;
   /*! \brief The target function. */
   Function func_;
   /*! \brief The rank of the current running device. */
@@ -356,14 +523,38 @@ class GradientPartitioner : public ExprMutator {
   std::vector<Var> scatter_var_;
   /*! \brief Divide expr after allreduce for NCCL version < 2.10. */
   std::vector<Expr> divide_expr_;
+
+  /*! \brief A bucket of gradients packed into a flat buffer. */
+  struct FlatBucket {
+    /*! \brief The gradients in the output gradient tuple, in the order of packing. */
+    std::vector<Expr> fields;
+    /*! \brief The number of gradient vars that have not been visited. */
+    int n_pending = 0;
+    /*! \brief The partition of the flat buffer for this rank. */
+    Expr shard;
+    /*! \brief The partition copied to the host. */
+    Expr offloaded;
+  };
+  /*! \brief The flat buckets. */
+  std::vector<FlatBucket> flat_buckets_;
+  /*! \brief The flat bucket of each field of the gradient tuple, or -1 if not in a flat bucket. */
+  std::vector<int> field_bucket_;
+  /*! \brief Mapping from a gradient var to the flat buckets containing it. */
+  std::unordered_map<Var, std::vector<int>, ObjectPtrHash, ObjectPtrEqual> flat_vars_;
+  /*! \brief Mapping from a gradient var in flat buckets to its expression. */
+  Map<Var, Expr> flat_values_;
+  /*! \brief The gradient vars in flat buckets whose bindings have been pushed. */
+  std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> flat_pushed_;
 };
 
 }  // namespace partition_gradient
 
-Pass PartitionGradient(int opt_level, int n_part, int rank, int64_t bucket_size) {
+Pass PartitionGradient(int opt_level, int n_part, int rank, int64_t bucket_size,
+                       std::string offload_device, Array<Array<Integer>> flat_buckets) {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return partition_gradient::GradientPartitioner(opt_level, n_part, bucket_size, f)
+    return partition_gradient::GradientPartitioner(opt_level, n_part, bucket_size, offload_device,
+                                                   flat_buckets, f)
         .Partition(rank);
   };
   auto partition_gradient = CreateRAFFunctionPass(pass_func, 0, "PartitionGradientFunc", {});
@@ -371,7 +562,15 @@ Pass PartitionGradient(int opt_level, int n_part, int rank, int64_t bucket_size)
                        "PartitionGradient");
 }
 
-RAF_REGISTER_GLOBAL("raf.pass_.PartitionGradient").set_body_typed(PartitionGradient);
+RAF_REGISTER_GLOBAL("raf.pass_.PartitionGradient")
+    .set_body([](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
+      std::string offload_device = args.size() >= 5 ? std::string(args[4]) : "";
+      Array<Array<Integer>> flat_buckets;
+      if (args.size() >= 6) {
+        flat_buckets = args[5];
+      }
+      *rv = PartitionGradient(args[0], args[1], args[2], args[3], offload_device, flat_buckets);
+    });
 
 }  // namespace pass
 }  // namespace raf
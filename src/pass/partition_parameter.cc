@@ -0,0 +1,216 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file partition_parameter.cc
+ * \brief Given a model after AutoDiff and InlineBackward, this pass performs ZeRO-3: the given
+ * parameters are partitioned across ranks, so the function takes only the local partition of each
+ * of them, and the complete parameters are gathered right before they are used.
+ */
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace partition_parameter {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*!
+ * \brief Replace the parameters with their partitions, and gather the complete parameters right
+ * before they are used. A parameter with a first dimension of length N is partitioned to
+ * ceil(N / n_part) rows, where the last partition is padded with zeros, which matches
+ * split_ndarray_with_padding in Python.
+ *
+ * The function body is split into the forward and the backward parts, where the backward part
+ * starts at the first binding that uses the output gradient, i.e., the first function parameter.
+ * Each part gathers the parameters it uses again, so a gathered parameter is dead and freed after
+ * its last use in the part instead of being kept alive from the forward to the backward. If
+ * regather_in_backward is false, the whole body is one part, which gathers each parameter only once
+ * at the cost of keeping it alive until its last use in the backward. Within a
+ * part, the parameters are gathered in the order of their first use, and each gather is issued
+ * right before the first use of the previous parameter, so the communication of one layer ahead
+ * overlaps with the computation. For example, with the parameters %w1 and %w2 used in order:
+ *   let %a1 = raf.op.matmul(%x, %w1);
+ *   let %a2 = raf.op.matmul(%a1, %w2);
+ *
+ * becomes:
+ *   let %x_0 = raf.op._allgather(%w1_shard, 0, nullptr);
+ *   let %x_1 = raf.op._allgather(%w2_shard, 0, nullptr);
+ *   let %a1 = raf.op.matmul(%x, %x_0);
+ *   let %a2 = raf.op.matmul(%a1, %x_1);
+ */
+class ParameterPartitioner {
+ public:
+  ParameterPartitioner(int n_part, const Array<Integer>& param_indices, bool regather_in_backward,
+                       const Function& func)
+      : n_part_(n_part), regather_in_backward_(regather_in_backward), func_(func) {
+    for (const auto& index : param_indices) {
+      CHECK_LT(index->value, func->params.size()) << "Parameter index out of range: " << index;
+      param_indices_.push_back(index->value);
+    }
+  }
+
+  Function Partition() {
+    if (param_indices_.empty() || !func_->body.as<LetNode>()) {
+      return func_;
+    }
+    CHECK_GT(func_->params.size(), 0U);
+    Array<Var> new_params = func_->params;
+    for (int index : param_indices_) {
+      const auto& param = func_->params[index];
+      CHECK_NE(index, 0) << "The output gradient cannot be partitioned";
+      const auto* ttype = param->checked_type().as<TensorTypeNode>();
+      CHECK(ttype != nullptr && !ttype->shape.empty())
+          << "Expected a tensor with at least one dimension, but got " << param->checked_type();
+      const auto* dim0 = ttype->shape[0].as<IntImmNode>();
+      CHECK(dim0 != nullptr) << "Do not support dynamic shape yet";
+      Array<PrimExpr> shape = ttype->shape;
+      int64_t part_dim0 = (dim0->value + n_part_ - 1) / n_part_;
+      shape.Set(0, Integer(part_dim0));
+      auto shard =
+          MakeVar(std::string(param->name_hint()) + "_shard", TensorType(shape, ttype->dtype));
+      new_params.Set(index, shard);
+      shards_[param] = shard;
+      dim0_[param] = dim0->value;
+      padded_[param] = part_dim0 * n_part_ != dim0->value;
+    }
+
+    ell_ = ExplicitLetList::make(func_->body);
+    int n = ell_->vars.size();
+    // The backward part starts with the first binding that uses the output gradient.
+    const Var& dy = func_->params[0];
+    int bwd_start = n;
+    for (int i = 0; i < n; ++i) {
+      auto free_vars = FreeVars(ell_->exprs[i]);
+      if (std::find(free_vars.begin(), free_vars.end(), dy) != free_vars.end()) {
+        bwd_start = i;
+        break;
+      }
+    }
+    if (regather_in_backward_) {
+      PlanGathers(0, bwd_start);
+      PlanGathers(bwd_start, n);
+    } else {
+      PlanGathers(0, n);
+    }
+    auto body = Rebuild();
+    return Function(new_params, body, {}, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*!
+   * \brief Plan the gathers of the parameters used in bindings [begin, end).
+   * \param begin The first binding of the part.
+   * \param end The binding after the last binding of the part.
+   */
+  void PlanGathers(int begin, int end) {
+    // The partitioned parameters in the order of their first use.
+    std::vector<std::pair<int, Var>> first_uses;
+    std::unordered_map<Var, int, ObjectPtrHash, ObjectPtrEqual> seen;
+    for (int i = begin; i < end; ++i) {
+      for (const auto& var : FreeVars(ell_->exprs[i])) {
+        if (shards_.count(var) && !seen.count(var)) {
+          seen[var] = i;
+          first_uses.emplace_back(i, var);
+        }
+      }
+    }
+    for (size_t j = 0; j < first_uses.size(); ++j) {
+      // Prefetch each parameter at the first use of the previous one.
+      int pos = first_uses[j == 0 ? 0 : j - 1].first;
+      gathers_[pos].push_back(first_uses[j].second);
+    }
+    parts_.emplace_back(begin, end);
+  }
+
+  /*! \brief Rebuild the function body with the planned gathers. */
+  Expr Rebuild() {
+    static const Op& allgather_op = Op::Get("raf.op._allgather");
+    static const Op& slice_op = Op::Get("raf.op.strided_slice");
+    auto axis = MakeConstant(ScalarValue::make(0));
+    auto null = MakeConstant(NullValue<Value>());
+    auto make_int_tuple = [](int64_t value) {
+      return MakeConstant(TupleValue::make({ScalarValue::make(value)}));
+    };
+
+    LetList ll;
+    Map<Var, Expr> gathered;
+    size_t part_idx = 0;
+    for (int i = 0; i < static_cast<int>(ell_->vars.size()); ++i) {
+      while (i >= parts_[part_idx].second) {
+        // Enter the next part, which gathers the parameters again.
+        ++part_idx;
+        gathered = {};
+      }
+      auto it = gathers_.find(i);
+      if (it != gathers_.end()) {
+        for (const auto& param : it->second) {
+          Expr full = ll.Push(Call(allgather_op, {shards_.at(param), axis, null}));
+          if (padded_.at(param)) {
+            // Remove the zero-padding of the last partition.
+            auto mode = MakeConstant(StringValue::make("end"));
+            full = ll.Push(Call(slice_op, {full, make_int_tuple(0), make_int_tuple(dim0_.at(param)),
+                                           make_int_tuple(1), mode}));
+          }
+          gathered.Set(param, full);
+        }
+      }
+      ll.Push(ell_->vars[i], Substitute(ell_->exprs[i], gathered));
+    }
+    return ll.Get(ell_->ret);
+  }
+
+  /*! \brief The expected number of partitions. */
+  int n_part_;
+  /*! \brief Whether the backward part gathers the parameters again. */
+  bool regather_in_backward_;
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The indices of the parameters to be partitioned. */
+  std::vector<int> param_indices_;
+  /*! \brief Mapping from a partitioned parameter to the parameter of its partition. */
+  std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> shards_;
+  /*! \brief Mapping from a partitioned parameter to the length of its first dimension. */
+  std::unordered_map<Var, int64_t, ObjectPtrHash, ObjectPtrEqual> dim0_;
+  /*! \brief Whether the partitions of a parameter are padded. */
+  std::unordered_map<Var, bool, ObjectPtrHash, ObjectPtrEqual> padded_;
+  /*! \brief The let list of the function body. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The parameters to gather before each binding position. */
+  std::map<int, std::vector<Var>> gathers_;
+  /*! \brief The [begin, end) binding positions of the forward and backward parts. */
+  std::vector<std::pair<int, int>> parts_;
+};
+
+}  // namespace partition_parameter
+
+Pass PartitionParameter(int n_part, Array<Integer> param_indices, bool regather_in_backward) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return partition_parameter::ParameterPartitioner(n_part, param_indices, regather_in_backward, f)
+        .Partition();
+  };
+  auto partition_parameter = CreateRAFFunctionPass(pass_func, 0, "PartitionParameterFunc", {});
+  return RAFSequential({InferType(), partition_parameter, EraseType()}, "PartitionParameter");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.PartitionParameter").set_body([](tvm::TVMArgs args,
+                                                                   tvm::TVMRetValue* rv) {
+  bool regather_in_backward = args.size() == 3 ? args[2] : true;
+  *rv = PartitionParameter(args[0], args[1], regather_in_backward);
+});
+
+}  // namespace pass
+}  // namespace raf
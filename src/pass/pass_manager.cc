@@ -7,12 +7,24 @@
  * \file src/pass/pass_manager.cc
  * \brief Infrastructure for transformation passes.
  */
+#include <sys/resource.h>
+#include <unistd.h>
 #include <tvm/node/repr_printer.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
 #include "raf/file.h"
 #include "raf/pass.h"
 #include "raf/pass_manager.h"
+#include "raf/profiler.h"
 #include "raf/registry.h"
+#include "../profiler/nvtx/nvtx.h"
 
 namespace raf {
 namespace pass {
@@ -108,6 +120,146 @@ std::string DumpAfterPassIRToFile(std::string dump_ir_path, const IRModule& mod,
   return dump_ir_path;
 }
 
+/*! \brief The measurements of a pass run by RAFSequential. */
+struct PassRecord {
+  /*! \brief The names of the pass and the sequence running it. */
+  std::string name;
+  std::string parent;
+  /*! \brief The nesting depth of the sequence, where the outermost sequence is 0. */
+  int depth;
+  int64_t time_us;
+  /*! \brief The resident set size before and after the pass, and its peak so far, in KBs. */
+  int64_t rss_before_kb;
+  int64_t rss_after_kb;
+  int64_t peak_rss_kb;
+  /*! \brief The numbers of let bindings and calls in the module before and after the pass. */
+  int64_t lets_before;
+  int64_t lets_after;
+  int64_t calls_before;
+  int64_t calls_after;
+};
+
+/*! \brief Count the let bindings and calls in all functions of a module. */
+class IRSizeCounter : public MixedModeVisitor {
+ public:
+  void VisitExpr_(const LetNode* op) final {
+    auto pre_visit = [this](const LetNode* op) {
+      ++num_lets;
+      this->VisitExpr(op->var);
+      this->VisitExpr(op->value);
+    };
+    auto post_visit = [this](const LetNode* op) {
+      this->VisitExpr(op->body);
+      this->visit_counter_[op] += 1;
+    };
+    ExpandANormalForm(op, pre_visit, post_visit);
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    ++num_calls;
+    MixedModeVisitor::VisitExpr_(op);
+  }
+
+  void Count(const IRModule& mod) {
+    for (const auto& kv : mod->functions) {
+      if (kv.second->IsInstance<FunctionNode>()) {
+        VisitExpr(Downcast<Function>(kv.second));
+      }
+    }
+  }
+
+  int64_t num_lets = 0;
+  int64_t num_calls = 0;
+};
+
+/*! \brief The current resident set size in KBs, or 0 if unknown. */
+int64_t CurrentRSSKB() {
+  std::ifstream statm("/proc/self/statm");
+  int64_t size = 0, resident = 0;
+  if (statm >> size >> resident) {
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+  }
+  return 0;
+}
+
+/*! \brief The peak resident set size of the process in KBs. */
+int64_t PeakRSSKB() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+/*!
+ * \brief Records the wall time, memory and IR size of each pass run by RAFSequential, including
+ * the passes of nested sequences and the required passes, in the order they start.
+ */
+class PassInstrument {
+ public:
+  static PassInstrument* Get() {
+    static PassInstrument instrument;
+    return &instrument;
+  }
+
+  IRModule Run(const Pass& pass, IRModule mod, const PassContext& pass_ctx,
+               const std::string& parent) {
+    if (!enabled_) {
+      return pass(std::move(mod), pass_ctx);
+    }
+    IRSizeCounter before;
+    before.Count(mod);
+    size_t index;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      index = records_.size();
+      records_.push_back({pass->Info()->name, parent, depth_, 0, CurrentRSSKB(), 0, 0,
+                          before.num_lets, 0, before.num_calls, 0});
+    }
+    ++depth_;
+    auto start = std::chrono::steady_clock::now();
+    try {
+      mod = pass(std::move(mod), pass_ctx);
+    } catch (...) {
+      --depth_;
+      throw;
+    }
+    auto end = std::chrono::steady_clock::now();
+    --depth_;
+    IRSizeCounter after;
+    after.Count(mod);
+    std::lock_guard<std::mutex> lock(mu_);
+    PassRecord& record = records_[index];
+    record.time_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    record.rss_after_kb = CurrentRSSKB();
+    record.peak_rss_kb = PeakRSSKB();
+    record.lets_after = after.num_lets;
+    record.calls_after = after.num_calls;
+    return mod;
+  }
+
+  void Enable(bool enabled) {
+    enabled_ = enabled;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    records_.clear();
+  }
+
+  std::vector<PassRecord> GetRecords() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return records_;
+  }
+
+ private:
+  std::atomic<bool> enabled_{false};
+  std::vector<PassRecord> records_;
+  std::mutex mu_;
+  /*! \brief The nesting depth of the sequences running on this thread. */
+  static thread_local int depth_;
+};
+
+thread_local int PassInstrument::depth_ = 0;
+
 // TODO(zhiics): we currenlty only sequentially execute each pass in
 // a RAFSequential without the consideration of their orders. The phase
 // ordering problem needs to be handled in the future.
@@ -134,10 +286,19 @@ IRModule RAFSequentialNode::operator()(IRModule mod, const PassContext& pass_ctx
     const PassInfo& pass_info = pass->Info();
     if (!pass_ctx.PassEnabled(pass_info)) continue;
     // resolve dependencies
+    auto* instrument = PassInstrument::Get();
     for (const auto& it : pass_info->required) {
-      mod = GetPass(it)(std::move(mod), pass_ctx);
+      RAF_NVTX_RANGE(kPass, it);
+      mod = instrument->Run(GetPass(it), std::move(mod), pass_ctx, this->pass_info->name);
+    }
+    {
+      RAF_NVTX_RANGE(kPass, pass_info->name);
+      WITH_BASE_PROFILER(Device(DevType::kCPU(), 0), pass_info->name, "Pass",
+                         {this->pass_info->name}, {
+                           mod = instrument->Run(pass, std::move(mod), pass_ctx,
+                                                 this->pass_info->name);
+                         });
     }
-    mod = pass(std::move(mod), pass_ctx);
     DumpAfterPassIRToFile(dump_ir_path, mod, pass_cnt++, pass_info->name);
   }
   return mod;
@@ -168,6 +329,9 @@ class RAFFunctionPassNode : public PassNode {
    */
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func;
 
+  /*! \brief Whether `pass_func` is safe to run on different functions concurrently. */
+  bool parallel = false;
+
   RAFFunctionPassNode() = default;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
@@ -203,6 +367,17 @@ class RAFFunctionPassNode : public PassNode {
    * \return Return true if the function will be skipped, otherwise false.
    */
   bool SkipFunction(const Function& func) const;
+
+  /*!
+   * \brief Run the pass function on the given functions with a thread pool.
+   *
+   * \param funcs The functions to be updated in place.
+   * \param mod The module that the functions belong to.
+   * \param pass_ctx The pass context, which is entered by each thread.
+   * \param num_threads The number of threads.
+   */
+  void RunParallel(std::vector<std::pair<GlobalVar, Function>>* funcs, const IRModule& mod,
+                   const PassContext& pass_ctx, int num_threads) const;
 };
 
 class RAFFunctionPass : public Pass {
@@ -213,16 +388,18 @@ class RAFFunctionPass : public Pass {
    * \param pass_info The pass info.
    */
   RAFFunctionPass(TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func,
-                  PassInfo pass_info);
+                  PassInfo pass_info, bool parallel = false);
 
   RAF_OBJECT_REF(RAFFunctionPass, Pass, RAFFunctionPassNode);
 };
 
 RAFFunctionPass::RAFFunctionPass(
-    TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func, PassInfo pass_info) {
+    TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func, PassInfo pass_info,
+    bool parallel) {
   auto n = make_object<RAFFunctionPassNode>();
   n->pass_func = std::move(pass_func);
   n->pass_info = std::move(pass_info);
+  n->parallel = parallel;
   data_ = std::move(n);
 }
 
@@ -243,12 +420,25 @@ IRModule RAFFunctionPassNode::operator()(IRModule mod, const PassContext& pass_c
   for (const auto& it : updated_mod->functions) {
     // only picks up relay::Function
     if (auto* n = it.second.as<FunctionNode>()) {
-      Function func = GetRef<Function>(n);
-      auto updated_func = SkipFunction(func) ? func : pass_func(func, updated_mod, pass_ctx);
-      updates.push_back({it.first, updated_func});
+      updates.push_back({it.first, GetRef<Function>(n)});
+    }
+  }
+
+  int num_threads =
+      pass_ctx->GetConfig("raf.pass.function_pass_threads", Integer(static_cast<int>(1)))
+          .value()
+          .IntValue();
+  if (parallel && num_threads > 1 && updates.size() > 1) {
+    RunParallel(&updates, updated_mod, pass_ctx, num_threads);
+  } else {
+    for (auto& pair : updates) {
+      if (!SkipFunction(pair.second)) {
+        pair.second = pass_func(pair.second, updated_mod, pass_ctx);
+      }
     }
   }
 
+  // Add the functions in the original order, so the result does not depend on the scheduling.
   for (const auto& pair : updates) {
     updated_mod->Add(pair.first, pair.second, true);
   }
@@ -256,6 +446,44 @@ IRModule RAFFunctionPassNode::operator()(IRModule mod, const PassContext& pass_c
   return updated_mod;
 }
 
+void RAFFunctionPassNode::RunParallel(std::vector<std::pair<GlobalVar, Function>>* funcs,
+                                      const IRModule& mod, const PassContext& pass_ctx,
+                                      int num_threads) const {
+  num_threads = std::min(num_threads, static_cast<int>(funcs->size()));
+  std::atomic<size_t> next{0};
+  std::exception_ptr error = nullptr;
+  std::mutex mu;
+  auto worker = [&]() {
+    // The pass context is thread-local, so the configs are only visible after entering it.
+    tvm::With<PassContext> scope(pass_ctx);
+    for (size_t i = next++; i < funcs->size(); i = next++) {
+      auto& pair = funcs->at(i);
+      if (SkipFunction(pair.second)) {
+        continue;
+      }
+      try {
+        pair.second = pass_func(pair.second, mod, pass_ctx);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mu);
+        if (!error) {
+          error = std::current_exception();
+        }
+        next = funcs->size();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
 bool RAFFunctionPassNode::SkipFunction(const Function& func) const {
   return (func->GetAttr<String>(attr::kCompiler).defined()) ||
          func->GetAttr<Integer>(attr::kSkipOptimization, 0) != 0;
@@ -263,11 +491,13 @@ bool RAFFunctionPassNode::SkipFunction(const Function& func) const {
 
 Pass CreateRAFFunctionPass(
     const TypedPackedFunc<Function(Function, IRModule, PassContext)>& pass_func, int opt_level,
-    String name, tvm::Array<String> required) {
+    String name, tvm::Array<String> required, bool parallel) {
   PassInfo pass_info = PassInfo(opt_level, name, required);
-  return RAFFunctionPass(pass_func, pass_info);
+  return RAFFunctionPass(pass_func, pass_info, parallel);
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.pass.function_pass_threads", Integer);
+
 RAF_REGISTER_OBJECT_REFLECT(RAFFunctionPassNode);
 
 TVM_REGISTER_GLOBAL("raf.pass_.MakeRAFFunctionPass")
@@ -291,6 +521,34 @@ RAF_REGISTER_GLOBAL("raf.pass_.RAFSequential").set_body([](TVMArgs args, TVMRetV
   *ret = RAFSequential(passes, pass_info);
 });
 
+RAF_REGISTER_GLOBAL("raf.pass_.EnablePassInstrument").set_body_typed([](bool enabled) {
+  PassInstrument::Get()->Enable(enabled);
+});
+
+RAF_REGISTER_GLOBAL("raf.pass_.ClearPassInstrument").set_body_typed([]() {
+  PassInstrument::Get()->Clear();
+});
+
+RAF_REGISTER_GLOBAL("raf.pass_.GetPassInstrumentRecords").set_body_typed([]() {
+  Array<Map<String, ObjectRef>> ret;
+  for (const auto& record : PassInstrument::Get()->GetRecords()) {
+    Map<String, ObjectRef> item;
+    item.Set("name", String(record.name));
+    item.Set("parent", String(record.parent));
+    item.Set("depth", IntImm(DataType::Int(64), record.depth));
+    item.Set("time_us", IntImm(DataType::Int(64), record.time_us));
+    item.Set("rss_before_kb", IntImm(DataType::Int(64), record.rss_before_kb));
+    item.Set("rss_after_kb", IntImm(DataType::Int(64), record.rss_after_kb));
+    item.Set("peak_rss_kb", IntImm(DataType::Int(64), record.peak_rss_kb));
+    item.Set("lets_before", IntImm(DataType::Int(64), record.lets_before));
+    item.Set("lets_after", IntImm(DataType::Int(64), record.lets_after));
+    item.Set("calls_before", IntImm(DataType::Int(64), record.calls_before));
+    item.Set("calls_after", IntImm(DataType::Int(64), record.calls_after));
+    ret.push_back(item);
+  }
+  return ret;
+});
+
 TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
     .set_dispatch<RAFSequentialNode>([](const ObjectRef& ref, ReprPrinter* p) {
       auto* node = static_cast<const RAFSequentialNode*>(ref.get());
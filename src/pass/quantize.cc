@@ -0,0 +1,320 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file quantize.cc
+ * \brief Int8 post-training quantization of the conv2d, dense and matmul ops: the calibration
+ * observers of the activations, and the rewriting into the int8 ops with per-channel weight scales.
+ */
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace quantize {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief The largest magnitude of the symmetric int8 range. */
+constexpr double kInt8Max = 127.0;
+/*! \brief The smallest absolute maximum, which avoids the zero scales of all-zero tensors. */
+constexpr double kMinAbsMax = 1e-8;
+
+/*! \brief The kinds of the quantizable ops. */
+enum class QuantKind {
+  /*! \brief dense and matmul_nt, whose weight is in [N, K]. */
+  kDense,
+  /*! \brief matmul, whose weight is in [K, N]. */
+  kMatmul,
+  /*! \brief conv2d in NCHW and OIHW without groups. */
+  kConv2d,
+};
+
+/*! \brief A quantizable op in the body of a function. */
+struct QuantCandidate {
+  /*! \brief The index of the binding of the op. */
+  size_t index;
+  /*! \brief The kind of the op. */
+  QuantKind kind;
+};
+
+/*! \brief Whether the argument is a float32 tensor of the given rank. */
+inline bool IsFloat32Tensor(const Expr& expr, size_t ndim) {
+  const auto* ttype = expr->checked_type().as<TensorTypeNode>();
+  return ttype != nullptr && ttype->dtype == DataType::Float(32) && ttype->shape.size() == ndim;
+}
+
+/*! \brief Whether the argument is a constant of the given integer. */
+inline bool IsConstInt(const Expr& expr, int64_t expected) {
+  if (const auto* konst = expr.as<ConstantNode>()) {
+    const auto* value = ConstantExtractValue(GetRef<Constant>(konst)).as<IntValueObj>();
+    return value != nullptr && value->value == expected;
+  }
+  return false;
+}
+
+/*! \brief Whether the argument is a constant of the given string. */
+inline bool IsConstString(const Expr& expr, const std::string& expected) {
+  if (const auto* konst = expr.as<ConstantNode>()) {
+    const auto* value = ConstantExtractValue(GetRef<Constant>(konst)).as<StringValueObj>();
+    return value != nullptr && value->value == expected;
+  }
+  return false;
+}
+
+/*!
+ * \brief Find the quantizable ops in the bindings of a function, in the order of the bindings. An
+ * op is quantizable if its operands are float32, and its weight is a parameter of the function or
+ * a constant, so that the weight scales are those of the model parameters.
+ * \param func The function.
+ * \param ell The let list of the function body.
+ * \return The quantizable ops.
+ */
+std::vector<QuantCandidate> FindCandidates(const Function& func, const ExplicitLetList& ell) {
+  static const Op& dense_op = Op::Get("raf.op.dense");
+  static const Op& matmul_op = Op::Get("raf.op.matmul");
+  static const Op& matmul_nt_op = Op::Get("raf.op.matmul_nt");
+  static const Op& conv2d_op = Op::Get("raf.op.conv2d");
+  std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> params(func->params.begin(),
+                                                                func->params.end());
+  std::vector<QuantCandidate> ret;
+  for (size_t i = 0; i < ell.exprs.size(); ++i) {
+    const auto* call = ell.exprs[i].as<CallNode>();
+    if (call == nullptr || call->args.size() < 2) {
+      continue;
+    }
+    const Expr& w = call->args[1];
+    const auto* w_var = w.as<VarNode>();
+    if (!w.as<ConstantNode>() && !(w_var && params.count(GetRef<Var>(w_var)))) {
+      continue;
+    }
+    if (call->op.same_as(dense_op) || call->op.same_as(matmul_nt_op)) {
+      if (IsFloat32Tensor(call->args[0], 2) && IsFloat32Tensor(w, 2)) {
+        ret.push_back({i, QuantKind::kDense});
+      }
+    } else if (call->op.same_as(matmul_op)) {
+      if (IsFloat32Tensor(call->args[0], 2) && IsFloat32Tensor(w, 2)) {
+        ret.push_back({i, QuantKind::kMatmul});
+      }
+    } else if (call->op.same_as(conv2d_op)) {
+      // conv2d(x, w, stride, padding, dilation, groups, layout, kernel_layout, out_layout)
+      if (IsFloat32Tensor(call->args[0], 4) && IsFloat32Tensor(w, 4) && call->args.size() == 9 &&
+          IsConstInt(call->args[5], 1) && IsConstString(call->args[6], "NCHW") &&
+          IsConstString(call->args[7], "OIHW") && IsConstString(call->args[8], "NCHW")) {
+        ret.push_back({i, QuantKind::kConv2d});
+      }
+    }
+  }
+  return ret;
+}
+
+/*!
+ * \brief Append the observers of the activations of the quantizable ops in main, i.e., the
+ * absolute maximum of the activation, to the outputs. For example:
+ *   let %a = raf.op.dense(%x, %w);
+ *   %a
+ *
+ * becomes:
+ *   let %a = raf.op.dense(%x, %w);
+ *   let %x_0 = raf.op.abs(%x);
+ *   let %x_1 = raf.op.max(%x_0);
+ *   let %x_2 = (%a, %x_1);
+ *   %x_2
+ */
+IRModule InsertObservers(IRModule mod) {
+  static const Op& abs_op = Op::Get("raf.op.abs");
+  static const Op& max_op = Op::Get("raf.op.max");
+  auto main = mod->GetGlobalVar("main");
+  auto func = Downcast<Function>(mod->Lookup(main));
+  if (!func->body.as<LetNode>()) {
+    return mod;
+  }
+  auto ell = ExplicitLetList::make(func->body);
+  auto candidates = FindCandidates(func, *ell);
+  LetList ll;
+  Array<Expr> outputs{ell->ret};
+  size_t next = 0;
+  for (size_t i = 0; i < ell->exprs.size(); ++i) {
+    ll.Push(ell->vars[i], ell->exprs[i]);
+    if (next < candidates.size() && candidates[next].index == i) {
+      // The observer is placed right after the op, so the activation is not kept alive longer.
+      Expr x = Downcast<Call>(ell->exprs[i])->args[0];
+      auto abs_x = ll.Push(Call(abs_op, {x}));
+      outputs.push_back(ll.Push(Call(max_op, {abs_x})));
+      ++next;
+    }
+  }
+  auto ret = ll.Push(Tuple(outputs));
+  Expr body = ll.Get(ret);
+  auto new_mod = IRModule(mod->functions);
+  new_mod->Add(main, Function(func->params, body, {}, func->type_params, func->attrs), true);
+  return new_mod;
+}
+
+/*!
+ * \brief Rewrite the quantizable ops in main into the int8 ops. The activation is quantized with
+ * the per-tensor scale from its calibrated absolute maximum, and the weight with the per-channel
+ * scales of its output channels computed from itself. The int32 output is dequantized by the
+ * elementwise ops after it, which are fused into the int8 op as its epilogue. For example:
+ *   let %a = raf.op.dense(%x, %w);
+ *
+ * becomes (omitting the abs and clip of the scale computation):
+ *   let %x_0 = raf.op.divide(%x, s_x);
+ *   let %x_1 = raf.op.round(%x_0);
+ *   let %x_2 = raf.op.clip(%x_1, -127, 127);
+ *   let %x_3 = raf.op.cast(%x_2, "int8");
+ *   let %x_4 = raf.op.max(%w_abs, [0], True, True);   // the absolute maximum of each row
+ *   let %x_5 = raf.op.divide(%x_4, 127);               // the weight scales, in [N, 1]
+ *   let %x_6 = (quantize %w by %x_5 as above)
+ *   let %x_7 = raf.op.quantized_dense(%x_3, %x_6);
+ *   let %x_8 = raf.op.cast(%x_7, "float32");
+ *   let %x_9 = raf.op.reshape(%x_5, [N]);
+ *   let %x_10 = raf.op.multiply(%x_9, s_x);
+ *   let %a = raf.op.multiply(%x_8, %x_10);
+ */
+class Quantizer {
+ public:
+  Quantizer(const Function& func, const Array<FloatImm>& act_abs_max)
+      : func_(func), act_abs_max_(act_abs_max) {
+  }
+
+  Function Run() {
+    if (!func_->body.as<LetNode>()) {
+      return func_;
+    }
+    auto ell = ExplicitLetList::make(func_->body);
+    auto candidates = FindCandidates(func_, *ell);
+    CHECK_EQ(candidates.size(), act_abs_max_.size())
+        << "The number of the calibrated activations does not match the quantizable ops";
+    size_t next = 0;
+    for (size_t i = 0; i < ell->exprs.size(); ++i) {
+      if (next < candidates.size() && candidates[next].index == i) {
+        double abs_max = std::max(act_abs_max_[next]->value, kMinAbsMax);
+        ll_.Push(ell->vars[i], Rewrite(Downcast<Call>(ell->exprs[i]), candidates[next].kind,
+                                       abs_max / kInt8Max));
+        ++next;
+      } else {
+        ll_.Push(ell->vars[i], ell->exprs[i]);
+      }
+    }
+    Expr body = ll_.Get(ell->ret);
+    return Function(func_->params, body, func_->ret_type, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Quantize a tensor to int8 by the scales, which are broadcast to it. */
+  Expr QuantizeTensor(const Expr& x, const Expr& scale) {
+    static const Op& divide_op = Op::Get("raf.op.divide");
+    static const Op& round_op = Op::Get("raf.op.round");
+    static const Op& clip_op = Op::Get("raf.op.clip");
+    static const Op& cast_op = Op::Get("raf.op.cast");
+    auto scaled = ll_.Push(Call(divide_op, {x, scale}));
+    auto rounded = ll_.Push(Call(round_op, {scaled}));
+    auto clipped = ll_.Push(Call(clip_op, {rounded, MakeConstant(ScalarValue::make(-kInt8Max)),
+                                           MakeConstant(ScalarValue::make(kInt8Max))}));
+    return ll_.Push(Call(cast_op, {clipped, MakeConstant(StringValue::make("int8"))}));
+  }
+
+  /*! \brief Rewrite a quantizable op, whose activation scale is x_scale. */
+  Expr Rewrite(const Call& call, QuantKind kind, double x_scale) {
+    static const Op& abs_op = Op::Get("raf.op.abs");
+    static const Op& max_op = Op::Get("raf.op.max");
+    static const Op& clip_op = Op::Get("raf.op.clip");
+    static const Op& divide_op = Op::Get("raf.op.divide");
+    static const Op& multiply_op = Op::Get("raf.op.multiply");
+    static const Op& reshape_op = Op::Get("raf.op.reshape");
+    static const Op& transpose_op = Op::Get("raf.op.transpose");
+    static const Op& cast_op = Op::Get("raf.op.cast");
+    static const Op& qdense_op = Op::Get("raf.op.quantized_dense");
+    static const Op& qconv2d_op = Op::Get("raf.op.quantized_conv2d");
+    const Expr& x = call->args[0];
+    const Expr& w = call->args[1];
+    const auto* w_type = w->checked_type().as<TensorTypeNode>();
+    // The output channels are the rows of the dense weight, the columns of the matmul weight, and
+    // the first dimension of the conv2d weight.
+    int64_t channel_axis = kind == QuantKind::kMatmul ? 1 : 0;
+    int64_t num_channels = w_type->shape[channel_axis].as<IntImmNode>()->value;
+
+    auto x_scale_const = MakeConstant(ScalarValue::make(x_scale));
+    auto x_q = QuantizeTensor(x, x_scale_const);
+    auto w_abs = ll_.Push(Call(abs_op, {w}));
+    auto w_abs_max = ll_.Push(Call(max_op, {w_abs, MakeConstant(ArrayToIntTuple({channel_axis})),
+                                            MakeConstant(ScalarValue::make(true)),
+                                            MakeConstant(ScalarValue::make(true))}));
+    w_abs_max = ll_.Push(Call(clip_op, {w_abs_max, MakeConstant(ScalarValue::make(kMinAbsMax)),
+                                        MakeConstant(ScalarValue::make(3.4e38))}));
+    auto w_scale =
+        ll_.Push(Call(divide_op, {w_abs_max, MakeConstant(ScalarValue::make(kInt8Max))}));
+    Expr w_q = QuantizeTensor(w, w_scale);
+
+    Expr acc;
+    std::vector<int64_t> scale_shape{num_channels};
+    if (kind == QuantKind::kConv2d) {
+      Array<Expr> args = call->args;
+      args.Set(0, x_q);
+      args.Set(1, w_q);
+      acc = ll_.Push(Call(qconv2d_op, args));
+      scale_shape = {num_channels, 1, 1};
+    } else {
+      if (kind == QuantKind::kMatmul) {
+        w_q = ll_.Push(Call(transpose_op, {w_q, MakeConstant(ArrayToIntTuple({1, 0}))}));
+      }
+      acc = ll_.Push(Call(qdense_op, {x_q, w_q}));
+    }
+    // The dequantization, which is fused into the int8 op as its epilogue.
+    auto acc_f = ll_.Push(Call(cast_op, {acc, MakeConstant(StringValue::make("float32"))}));
+    auto channel_scale = ll_.Push(Call(
+        reshape_op, {w_scale, MakeConstant(ArrayToIntTuple(scale_shape)),
+                     MakeConstant(ScalarValue::make(false))}));
+    auto out_scale = ll_.Push(Call(multiply_op, {channel_scale, x_scale_const}));
+    return Call(multiply_op, {acc_f, out_scale});
+  }
+
+  /*! \brief The function to be quantized. */
+  Function func_;
+  /*! \brief The calibrated absolute maximum of the activation of each quantizable op. */
+  Array<FloatImm> act_abs_max_;
+  /*! \brief The new bindings. */
+  LetList ll_;
+};
+
+}  // namespace quantize
+
+Pass InsertQuantObservers() {
+  TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule m, PassContext pc) {
+    return quantize::InsertObservers(m);
+  };
+  auto observe = CreateModulePass(pass_func, 0, "InsertQuantObserversHelper", {});
+  return RAFSequential({InferType(), observe, InferType()}, "InsertQuantObservers");
+}
+
+Pass Quantize(Array<FloatImm> act_abs_max) {
+  TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule m, PassContext pc) {
+    auto main = m->GetGlobalVar("main");
+    auto func = quantize::Quantizer(Downcast<Function>(m->Lookup(main)), act_abs_max).Run();
+    auto new_mod = IRModule(m->functions);
+    new_mod->Add(main, func, true);
+    return new_mod;
+  };
+  auto quantize = CreateModulePass(pass_func, 0, "QuantizeHelper", {});
+  return RAFSequential({InferType(), quantize, InferType()}, "Quantize");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.InsertQuantObservers").set_body_typed(InsertQuantObservers);
+RAF_REGISTER_GLOBAL("raf.pass_.Quantize").set_body_typed(Quantize);
+
+}  // namespace pass
+}  // namespace raf
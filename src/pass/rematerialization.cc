@@ -31,6 +31,15 @@ using VSet = std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual>;
 constexpr float kMegaBytes = 1048576;
 constexpr float kGigaBytes = 1073741824;
 
+/*!
+ * \brief Whether the op is the CUDA dropout, which can be recomputed with the same mask by
+ * replaying the Philox state in its reserve space.
+ */
+inline bool IsReplayableDropout(const Expr& op) {
+  static const Op& cuda_dropout_op = Op::Get("raf.op.cuda._contrib_dropout");
+  return op.same_as(cuda_dropout_op);
+}
+
 // Whether to display verbose logging.
 #define SHOW_VERBOSE_LOG 0
 
@@ -41,6 +50,9 @@ constexpr float kGigaBytes = 1073741824;
 // The max number of ops is allowed to rematerialized a tensor.
 #define MAX_REMAT_DEPTH 10
 
+// The max number of size units in the DP table of the planner.
+constexpr int64_t kMaxPlanUnits = 4096;
+
 #if SHOW_VERBOSE_LOG == 1
 #define VERBOSE_LOG LOG(INFO)
 #else
@@ -85,6 +97,10 @@ struct TensorInfo {
   /*! \brief Workspace memory size of this tensor in bytes. -1 means recomputing this tensor is
    * invalid. */
   int64_t workspace_size = -1;
+  /*! \brief The let binding var of the host copy of this tensor, which is defined only when this
+   * tensor has been offloaded. Since tensors are immutable, the host copy remains valid and can be
+   * copied back whenever this tensor is marked as dead again. */
+  Var host_var;
   /*! \brief Only TensorInfos can change this status since TensorInfos has to maintain the live
    * tensor list. */
   bool IsDead() {
@@ -283,9 +299,14 @@ class TensorInfos {
  *    3.4. Mark the tensor with the lowest cost as dead, meaning that later call nodes that use this
  *         tensor need to rematerialize it. The use counts of this tensor's arguments will be
  *         incremented so that the rematerialization cost estimator is aware of the additional uses.
+ *         If offloading is enabled and copying the tensor to the host and back is cheaper than
+ *         recomputing it, then the tensor is copied to the host before being marked as dead, and
+ *         later call nodes that use this tensor copy it back instead.
  *    3.5. Repeat 3.3 - 3.4 until the total memory consumption is lower than the budget. If the
  *         memory still exceeds the budget but no more tensors can be marked as dead, then error out
  *         to let users adjust the budget.
+ *    When the "dp" planner is used, 3.3 - 3.5 instead select the set of tensors with the minimal
+ *    total cost that frees enough memory, which is solved as a 0-1 covering knapsack problem.
  * Assumptions:
  * 1. Memory plan will be applied later to insert "free" properly to reflect the rematerialization.
  *    If memory plan is not applied, then rematerialization simply brings latency overheads.
@@ -296,11 +317,15 @@ class Rematerializer : public ExprMutator {
  public:
   explicit Rematerializer(liveness_analysis::LivenessAnalyzer* analyzer, const Device& device,
                           const Function& func, const IRModule& mod, const int64_t budget,
-                          op_profiler::OpProfiler* profiler)
+                          op_profiler::OpProfiler* profiler, const int64_t offload_bandwidth = 0,
+                          bool use_dp_planner = false)
       : analyzer_(analyzer),
         func_(func),
         budget_(budget),
         profiler_(profiler),
+        device_str_(device.c_str()),
+        offload_bandwidth_(offload_bandwidth),
+        use_dp_planner_(use_dp_planner),
         tensor_infos_(AnalyzeTensors(device, func, mod, analyzer, profiler)) {
     scopes_.emplace_back(new LetList);
     VERBOSE_LOG << "Tensor infos:\n" << tensor_infos_.DebugDump();
@@ -343,6 +368,10 @@ class Rematerializer : public ExprMutator {
     if (profiler_) {
       ss << " with " << std::setw(2) << (total_recompute_cost_ / 1000.0) << " ms latency overhead";
     }
+    if (n_offload_ops_ > 0) {
+      ss << ", and " << n_offload_ops_ << " device copies were inserted to offload tensors with "
+         << std::setw(2) << (total_offload_cost_ / 1000.0) << " ms transfer overhead";
+    }
     LOG(INFO) << ss.str();
     return ret;
   }
@@ -475,6 +504,7 @@ class Rematerializer : public ExprMutator {
     if (curr_mem_trace_ > budget_) {
       // Find candidates to be rematerialized from the live tensors.
       std::vector<std::pair<std::shared_ptr<TensorInfo>, float>> candidate_n_scores;
+      std::unordered_set<std::shared_ptr<TensorInfo>> offload_cands;
       for (const auto tensor_info : tensor_infos_.GetLiveTensorInfos()) {
         // Skip argument and output tensors.
         // Conservatively, we choose not to free tensors that are just rematerialized, because they
@@ -486,6 +516,12 @@ class Rematerializer : public ExprMutator {
         }
 
         auto cost = EstimateRematCost(tensor_info->liveness_var, node);
+        // Offload the tensor instead if it is cheaper than recomputing it.
+        auto offload_cost = EstimateOffloadScore(tensor_info);
+        if (offload_cost != -1 && (cost == -1 || offload_cost < cost)) {
+          cost = offload_cost;
+          offload_cands.insert(tensor_info);
+        }
         // Skip the tensors that cannot be rematerialized.
         if (cost != -1) {
           candidate_n_scores.push_back({tensor_info, cost});
@@ -501,6 +537,9 @@ class Rematerializer : public ExprMutator {
                   return (a.second == b.second) ? a.first->index > b.first->index
                                                 : a.second > b.second;
                 });
+      if (use_dp_planner_) {
+        PlanCandidates(&candidate_n_scores, curr_mem_trace_ - budget_);
+      }
       VERBOSE_LOG << "| |-Cands: " << DebugDumpCandidates(candidate_n_scores);
       while (curr_mem_trace_ > budget_) {
         // Mark a var (tensor) to be dead and remove its size from memory trace. This tensor
@@ -522,6 +561,12 @@ class Rematerializer : public ExprMutator {
         auto liveness_var = cand_tensor_info->liveness_var;
         curr_live_in_vars_.erase(liveness_var);
 
+        // An offloaded tensor is copied back from the host, so its producers are not used again.
+        if (offload_cands.count(cand_tensor_info) > 0) {
+          Offload(scope, cand_tensor_info);
+          continue;
+        }
+
         // When deciding to rematerialize a tensor, increment the use count of its direct
         // producers if they are still live. In this case, these tensors won't be considered
         // "dead" before the rematerialization takes place. This helps in the following case:
@@ -696,31 +741,54 @@ class Rematerializer : public ExprMutator {
       return CorrectType(scope, var);
     }
 
-    // Recursively rematerialize arguments if necessary.
-    Array<Expr> new_args;
-    for (auto arg : call_node->args) {
-      if (auto var_node = arg.as<VarNode>()) {
-        auto arg_var = GetRef<Var>(var_node);
-        // TODO: we should do use count tracking here.
-        new_args.push_back(Rematerialize(scope, arg_var, curr_depth + 1));
-      } else {
-        new_args.push_back(arg);
+    Var remat_var;
+    if (tensor_infos[0]->host_var.defined()) {
+      // Copy the offloaded tensor back from the host.
+      auto copy_call = MakeDeviceCopy(tensor_infos[0]->host_var, "cpu", device_str_);
+      remat_var = scope->Push(copy_call);
+      remat_var->checked_type_ = copy_call->checked_type();
+      let_vars_.emplace(remat_var, copy_call);
+
+      // Record for final report.
+      n_offload_ops_++;
+      total_offload_cost_ += EstimateOffloadCost(tensor_infos[0]);
+    } else {
+      // Recursively rematerialize arguments if necessary.
+      Array<Expr> new_args;
+      for (auto arg : call_node->args) {
+        if (auto var_node = arg.as<VarNode>()) {
+          auto arg_var = GetRef<Var>(var_node);
+          // TODO: we should do use count tracking here.
+          new_args.push_back(Rematerialize(scope, arg_var, curr_depth + 1));
+        } else {
+          new_args.push_back(arg);
+        }
       }
-    }
-
-    auto remat_call = Call(call_node->op, new_args, call_node->attrs, call_node->type_args);
-    auto remat_var = scope->Push(remat_call);
-    remat_var->checked_type_ = call_node->checked_type();
-    remat_call->checked_type_ = call_node->checked_type();
-    let_vars_.emplace(remat_var, remat_call);
 
-    // Record for final report.
-    n_recompute_ops_++;
-    if (profiler_) {
-      auto exec_time_and_ws_size = profiler_->ProfileOp(remat_call);
-      // Default is to repeat once, so we take the first element
-      auto compute_cost = exec_time_and_ws_size.first[0];
-      total_recompute_cost_ += compute_cost;
+      if (IsReplayableDropout(call_node->op) && new_args.size() > 2 &&
+          !new_args[2].as<VarNode>()) {
+        // Replay the Philox state of the dropout, so the recomputed mask is the same as the one
+        // used by the backward. The state is a 16-byte tensor that is kept alive anyway.
+        auto state = TupleGetItem(latest_let_var, 2);
+        auto state_var = scope->Push(state);
+        state->checked_type_ = Downcast<TupleType>(call_node->checked_type())->fields[2];
+        state_var->checked_type_ = state->checked_type();
+        new_args.Set(2, state_var);
+      }
+      auto remat_call = Call(call_node->op, new_args, call_node->attrs, call_node->type_args);
+      remat_var = scope->Push(remat_call);
+      remat_var->checked_type_ = call_node->checked_type();
+      remat_call->checked_type_ = call_node->checked_type();
+      let_vars_.emplace(remat_var, remat_call);
+
+      // Record for final report.
+      n_recompute_ops_++;
+      if (profiler_) {
+        auto exec_time_and_ws_size = profiler_->ProfileOp(remat_call);
+        // Default is to repeat once, so we take the first element
+        auto compute_cost = exec_time_and_ws_size.first[0];
+        total_recompute_cost_ += compute_cost;
+      }
     }
 
     // Update the let_var to be the rematerialized one and mark the tensor as live again.
@@ -804,6 +872,10 @@ class Rematerializer : public ExprMutator {
         if (n_live_tensor == tensor_infos.size()) {
           // All tensors are alive, so no cost.
           continue;
+        } else if (tensor_infos[0]->host_var.defined()) {
+          // The offloaded tensor can be copied back from the host.
+          cost += EstimateOffloadCost(tensor_infos[0]);
+          continue;
         } else if (n_live_tensor > 0) {
           // Only a part of tensors in this tuple are alive. In this case, we heuristically
           // give up rematerializing the dead tensors.
@@ -824,6 +896,140 @@ class Rematerializer : public ExprMutator {
     return (cost * (tensor_info->GetUseCount() + 1)) / (tensor_info->size / kGigaBytes);
   }
 
+  /*!
+   * \brief Select the candidates with the minimal total cost that free at least the given bytes,
+   * and move them to the back of the candidate list so that they are marked as dead first. The
+   * total cost of a candidate is its score multiplied by its size, i.e., the latency overhead of
+   * rematerializing it for all its remaining uses. This is a 0-1 covering knapsack problem solved
+   * by dynamic programming over the quantized sizes. If no selection frees enough memory, then the
+   * candidates are left untouched.
+   * \param candidates The candidates sorted by their scores from high to low.
+   * \param required_size The bytes to be freed.
+   */
+  void PlanCandidates(std::vector<std::pair<std::shared_ptr<TensorInfo>, float>>* candidates,
+                      int64_t required_size) {
+    // Quantize the sizes to bound the DP table. Candidate sizes are rounded down and the required
+    // size is rounded up, so the selected candidates always free enough memory.
+    int64_t unit = std::max(static_cast<int64_t>(kMegaBytes),
+                            (required_size + kMaxPlanUnits - 1) / kMaxPlanUnits);
+    int64_t n_units = (required_size + unit - 1) / unit;
+    size_t n_cands = candidates->size();
+
+    // min_cost[j] is the minimal total cost to free at least j units with the visited candidates.
+    const float inf = std::numeric_limits<float>::max();
+    std::vector<float> min_cost(n_units + 1, inf);
+    std::vector<std::vector<bool>> selected(n_cands, std::vector<bool>(n_units + 1, false));
+    min_cost[0] = 0;
+    for (size_t i = 0; i < n_cands; ++i) {
+      auto tensor_info = (*candidates)[i].first;
+      int64_t units = tensor_info->size / unit;
+      float cost = (*candidates)[i].second * (tensor_info->size / kGigaBytes);
+      for (int64_t j = n_units; j > 0; --j) {
+        float prev_cost = min_cost[std::max(static_cast<int64_t>(0), j - units)];
+        if (prev_cost != inf && prev_cost + cost < min_cost[j]) {
+          min_cost[j] = prev_cost + cost;
+          selected[i][j] = true;
+        }
+      }
+    }
+    if (min_cost[n_units] == inf) {
+      return;
+    }
+
+    // Backtrack the selection.
+    std::vector<bool> is_selected(n_cands, false);
+    for (int64_t i = n_cands - 1, j = n_units; i >= 0 && j > 0; --i) {
+      if (selected[i][j]) {
+        is_selected[i] = true;
+        j = std::max(static_cast<int64_t>(0), j - (*candidates)[i].first->size / unit);
+      }
+    }
+    std::vector<std::pair<std::shared_ptr<TensorInfo>, float>> reordered;
+    for (size_t i = 0; i < n_cands; ++i) {
+      if (!is_selected[i]) {
+        reordered.push_back((*candidates)[i]);
+      }
+    }
+    for (size_t i = 0; i < n_cands; ++i) {
+      if (is_selected[i]) {
+        reordered.push_back((*candidates)[i]);
+      }
+    }
+    *candidates = std::move(reordered);
+    VERBOSE_LOG << "| |-Planned cost: " << min_cost[n_units];
+  }
+
+  /*!
+   * \brief Estimate the latency of copying the given tensor between the device and the host.
+   * \param tensor_info The tensor to be estimated.
+   * \return The latency in microseconds. Note that -1 means offloading this tensor is invalid.
+   */
+  float EstimateOffloadCost(const std::shared_ptr<TensorInfo>& tensor_info) {
+    // Do not offload input parameter, in-place update, small (< 1MB) tensors or tuple fields.
+    if (offload_bandwidth_ <= 0 || tensor_info->is_param || !tensor_info->share_storage.empty() ||
+        tensor_info->size < kMegaBytes || tensor_info->tuple_field_idx != -1 ||
+        !tensor_info->let_var->checked_type().as<TensorTypeNode>()) {
+      return -1;
+    }
+    // The bandwidth is in GB/s, which is 1e3 bytes per microsecond.
+    return tensor_info->size / (offload_bandwidth_ * 1e3f);
+  }
+
+  /*!
+   * \brief Estimate the offloading cost of the given tensor in the same form as EstimateRematCost,
+   * where the latency cost includes copying the tensor to the host (if it does not have a host
+   * copy yet) and copying it back.
+   * \param tensor_info The tensor to be estimated.
+   * \return The cost (lower the better). Note that -1 means offloading this tensor is invalid.
+   */
+  float EstimateOffloadScore(const std::shared_ptr<TensorInfo>& tensor_info) {
+    float cost = EstimateOffloadCost(tensor_info);
+    if (cost == -1) {
+      return -1;
+    }
+    cost = (tensor_info->host_var.defined() ? cost : 2 * cost) + 0.1;
+    return (cost * (tensor_info->GetUseCount() + 1)) / (tensor_info->size / kGigaBytes);
+  }
+
+  /*!
+   * \brief Copy the given tensor to the host so that it can be copied back later instead of being
+   * recomputed. Nothing is generated if the tensor already has a host copy.
+   * \param scope The current let list scope.
+   * \param tensor_info The tensor to be offloaded.
+   */
+  void Offload(LetList* scope, const std::shared_ptr<TensorInfo>& tensor_info) {
+    if (tensor_info->host_var.defined()) {
+      VERBOSE_LOG << "| | |-Reuse host copy " << tensor_info->host_var->name_hint();
+      return;
+    }
+    auto copy_call = MakeDeviceCopy(tensor_info->let_var, device_str_, "cpu");
+    tensor_info->host_var = scope->Push(copy_call);
+    tensor_info->host_var->checked_type_ = copy_call->checked_type();
+    VERBOSE_LOG << "| | |-Offload as " << tensor_info->host_var->name_hint();
+
+    // Record for final report.
+    n_offload_ops_++;
+    total_offload_cost_ += EstimateOffloadCost(tensor_info);
+  }
+
+  /*!
+   * \brief Make a device_copy call. The copy is issued to the current stream, so it is ordered
+   * with the computations and the memory plan can safely free the source tensor after it.
+   * \param data The tensor to be copied.
+   * \param src_device The source device.
+   * \param dst_device The destination device.
+   * \return The device_copy call.
+   */
+  Call MakeDeviceCopy(const Var& data, const std::string& src_device,
+                      const std::string& dst_device) {
+    static const auto device_copy_op = Op::Get("raf.op.device_copy");
+    Array<Expr> args = {data, MakeConstant(value::StringValue::make(src_device)),
+                        MakeConstant(value::StringValue::make(dst_device))};
+    auto copy_call = Call(device_copy_op, args);
+    copy_call->checked_type_ = data->checked_type();
+    return copy_call;
+  }
+
   /*! \brief the function to be muatated. */
   const Function& func_;
   /*! \brief The scope stack of the let list. */
@@ -842,6 +1048,12 @@ class Rematerializer : public ExprMutator {
   op_profiler::OpProfiler* profiler_;
   /*! \brief The memory budget in bytes. */
   int64_t budget_;
+  /*! \brief The string of the target device, which is used by the offloading device copies. */
+  std::string device_str_;
+  /*! \brief The bandwidth between the device and the host in GB/s. 0 means no offloading. */
+  int64_t offload_bandwidth_;
+  /*! \brief Whether to select the tensors to be marked as dead with the DP planner. */
+  bool use_dp_planner_;
   /*! \brief The current memory consumption in bytes. */
   int64_t curr_mem_trace_ = 0;
   /*! \brief Peak mremory. */
@@ -850,6 +1062,10 @@ class Rematerializer : public ExprMutator {
   int64_t n_recompute_ops_ = 0;
   /*! \brief The total recompute cost. */
   float total_recompute_cost_ = 0;
+  /*! \brief The number of inserted device copies for offloading. */
+  int64_t n_offload_ops_ = 0;
+  /*! \brief The total transfer cost of offloading. */
+  float total_offload_cost_ = 0;
   /*! \brief A set of rematerialized tensors before each call. */
   VSet newly_remat_tensors_;
 };
@@ -867,6 +1083,27 @@ class Rematerializer::TensorAnalyzer : public ExprVisitor {
     if (!profiler_) {
       op_flops_estimater_.Run(device, func, mod);
     }
+    PassContext pass_ctx = PassContext::Current();
+    auto get_ops = [&pass_ctx](const std::string& key) {
+      std::unordered_set<std::string> ops;
+      for (const auto& name : pass_ctx->GetConfig(key, Array<String>()).value()) {
+        std::string op_name = name;
+        ops.insert(op_name.rfind("raf.op.", 0) == 0 ? op_name : "raf.op." + op_name);
+      }
+      return ops;
+    };
+    never_recompute_ = get_ops("raf.remat.never_recompute");
+    prefer_recompute_ = get_ops("raf.remat.prefer_recompute");
+    String policy = pass_ctx->GetConfig("raf.remat.policy", String("default")).value();
+    CHECK(policy == "default" || policy == "checkpoint")
+        << "Cannot recognize rematerialization policy: " << policy << ", candidates are \n"
+        << "  default and checkpoint";
+    checkpoint_ = policy == "checkpoint";
+    for (size_t i = 0; i < ell_->vars.size(); ++i) {
+      if (ell_->exprs[i].as<FunctionNode>()) {
+        funcs_[ell_->vars[i]] = Downcast<Function>(ell_->exprs[i]);
+      }
+    }
   }
 
   ~TensorAnalyzer() {
@@ -902,6 +1139,62 @@ class Rematerializer::TensorAnalyzer : public ExprVisitor {
     return result_vars;
   }
 
+  /*! \brief Whether the expression can be recomputed, i.e., not a non-deterministic or collective
+   * op call. */
+  static bool IsRecomputable(const Expr& expr) {
+    if (auto call_node = expr.as<CallNode>()) {
+      if (auto op_node = call_node->op.as<OpNode>()) {
+        auto op = GetRef<Op>(op_node);
+        return !((IsNonDeterministicOp(op) && !IsReplayableDropout(op)) || IsCollectiveOp(op));
+      }
+    }
+    return true;
+  }
+
+  /*! \brief The user-specified policy to recompute a tensor. */
+  enum class RecomputePolicy { kDefault, kNever, kPrefer };
+
+  /*!
+   * \brief Get the policy of a call from the ops it calls, including the ops fused into it. The
+   * tensors of the ops in raf.remat.never_recompute are never recomputed, and the tensors of the
+   * ops in raf.remat.prefer_recompute are freed before the others regardless of their costs. With
+   * the "checkpoint" policy, all tensors other than the never-recompute ones are preferred, so that
+   * only the outputs of those ops, e.g., the inputs of the layers, are kept (full-layer
+   * checkpointing).
+   */
+  RecomputePolicy GetRecomputePolicy(const Expr& expr) {
+    const auto* call = expr.as<CallNode>();
+    if (call == nullptr) {
+      return RecomputePolicy::kDefault;
+    }
+    std::vector<Op> ops;
+    if (const auto* op_node = call->op.as<OpNode>()) {
+      ops.push_back(GetRef<Op>(op_node));
+    } else {
+      Expr callee = call->op;
+      if (const auto* var = call->op.as<VarNode>()) {
+        auto it = funcs_.find(GetRef<Var>(var));
+        callee = it != funcs_.end() ? Expr(it->second) : Expr();
+      }
+      if (callee.defined() && callee.as<FunctionNode>()) {
+        PostOrderVisit(callee, [&ops](const Expr& e) {
+          if (const auto* op_node = e.as<OpNode>()) {
+            ops.push_back(GetRef<Op>(op_node));
+          }
+        });
+      }
+    }
+    bool prefer = checkpoint_;
+    for (auto op : ops) {
+      op = IsDialectOp(op) ? GetBaseOp(op) : op;
+      if (never_recompute_.count(op->name)) {
+        return RecomputePolicy::kNever;
+      }
+      prefer |= prefer_recompute_.count(op->name) > 0;
+    }
+    return prefer ? RecomputePolicy::kPrefer : RecomputePolicy::kDefault;
+  }
+
   /*! \brief Visit each let statement and return the analyzed information of each tensor. */
   TensorInfos Run() {
     // Analyze parameters.
@@ -918,6 +1211,19 @@ class Rematerializer::TensorAnalyzer : public ExprVisitor {
       let_var_set_.insert(var);
     }
 
+    // Profile all recomputable calls in one batch so that they are built concurrently, and
+    // the loop below only hits the profiler cache.
+    if (profiler_) {
+      std::vector<Expr> to_profile;
+      for (const auto& expr : exprs) {
+        if (expr->IsInstance<CallNode>() && IsRecomputable(expr) &&
+            GetRecomputePolicy(expr) == RecomputePolicy::kDefault) {
+          to_profile.push_back(expr);
+        }
+      }
+      profiler_->ProfileOps(to_profile);
+    }
+
     size_t n = exprs.size();
     for (int i = 0; i < n; ++i) {
       curr_let_ = vars[i];
@@ -928,18 +1234,18 @@ class Rematerializer::TensorAnalyzer : public ExprVisitor {
 
       float compute_cost = 0.0f;
       int64_t ws_size = 0;
+      auto policy = GetRecomputePolicy(exprs[i]);
 
-      // Get the call node op if applicable.
-      Op op;
-      if (auto call_node = exprs[i].as<CallNode>()) {
-        if (auto op_node = call_node->op.as<OpNode>()) {
-          op = GetRef<Op>(op_node);
-        }
-      }
-
-      if (op.defined() && IsNonDeterministicOp(op) && IsCollectiveOp(op)) {
+      if (!IsRecomputable(exprs[i])) {
         // Non-deterministic and collective ops cannot be recomputed
         compute_cost = std::numeric_limits<float>::max();
+      } else if (policy == RecomputePolicy::kNever) {
+        // An invalid cost excludes the tensor from recomputation, but it can still be offloaded.
+        compute_cost = -1;
+      } else if (policy == RecomputePolicy::kPrefer) {
+        // A zero cost lets the tensor be freed first. The workspace is not tracked as it is not
+        // profiled, which is the same as the GFLOPS-based estimation.
+        compute_cost = 0.0f;
       } else if (profiler_) {
         // Try to profile the op
         auto exec_time_and_ws_size = profiler_->ProfileOp(exprs[i]);
@@ -985,6 +1291,14 @@ class Rematerializer::TensorAnalyzer : public ExprVisitor {
   op_profiler::OpProfiler* profiler_;
   /*! \brief A set of all let vars in the function. */
   VSet let_var_set_;
+  /*! \brief The fused functions bound to let vars. */
+  StdMap<Function> funcs_;
+  /*! \brief The names of the ops whose tensors are never recomputed. */
+  std::unordered_set<std::string> never_recompute_;
+  /*! \brief The names of the ops whose tensors are recomputed first. */
+  std::unordered_set<std::string> prefer_recompute_;
+  /*! \brief Whether to recompute all tensors other than the never-recompute ones first. */
+  bool checkpoint_ = false;
 };
 
 TensorInfos Rematerializer::AnalyzeTensors(const Device& device, const Function& func,
@@ -998,6 +1312,11 @@ TensorInfos Rematerializer::AnalyzeTensors(const Device& device, const Function&
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_budget", IntImm);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.use_gflops_cost", IntImm);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.offload_bandwidth", IntImm);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.planner", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.never_recompute", Array<String>);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.prefer_recompute", Array<String>);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.policy", String);
 
 Pass Rematerialization() {
   PassContext pass_ctx = PassContext::Current();
@@ -1005,6 +1324,16 @@ Pass Rematerialization() {
       pass_ctx->GetConfig("raf.memory_budget", Integer(static_cast<int>(0))).value().IntValue();
   // Turn profiler on by default. With caching it is pretty fast now.
   bool use_profiler = !(pass_ctx->GetConfig("raf.remat.use_gflops_cost", Bool(false)).value());
+  // The bandwidth between the device and the host in GB/s to offload tensors. 0 means disabled.
+  int64_t offload_bandwidth =
+      pass_ctx->GetConfig("raf.remat.offload_bandwidth", Integer(static_cast<int>(0)))
+          .value()
+          .IntValue();
+  String planner = pass_ctx->GetConfig("raf.remat.planner", String("greedy")).value();
+  CHECK(planner == "greedy" || planner == "dp")
+      << "Cannot recognize rematerialization planner: " << planner << ", candidates are \n"
+      << "  greedy and dp";
+  bool use_dp_planner = planner == "dp";
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
     // We use budget 0 to diable this pass because it is guaranteed to fail.
@@ -1027,16 +1356,25 @@ Pass Rematerialization() {
       return f;
     }
 
+    int64_t bandwidth = offload_bandwidth;
+    if (bandwidth > 0 && (device.device_type() != DevType::kCUDA() || !use_profiler)) {
+      // The offloading cost is in latency, so it is only comparable with the profiled cost.
+      LOG(WARNING) << "Offloading is only supported on CUDA with profiler-based cost estimation";
+      bandwidth = 0;
+    }
+
     op_profiler::OpProfiler* profiler = nullptr;
     if (use_profiler) {
       LOG(INFO)
           << "Using profiler-based cost estimation for rematerialization. This may take a while. ";
-      profiler = op_profiler::OpProfiler::Get(device);
+      profiler = op_profiler::OpProfiler::GetCostModel(device);
     } else {
       LOG(INFO) << "Using GFLOPS-based cost estimation. ";
     }
     return Downcast<Function>(
-        rematerialization::Rematerializer(&analyzer, device, f, m, memory_budget, profiler).Run());
+        rematerialization::Rematerializer(&analyzer, device, f, m, memory_budget, profiler,
+                                          bandwidth, use_dp_planner)
+            .Run());
   };
 
   Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "RematerializationHelper", {});
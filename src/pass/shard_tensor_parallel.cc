@@ -0,0 +1,476 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file shard_tensor_parallel.cc
+ * \brief Given a forward function, this pass performs tensor (Megatron-style) model parallelism:
+ * the weights of the annotated dense, matmul and embedding layers are partitioned across ranks,
+ * and the collectives are inserted at the boundaries of the partitioned layers.
+ */
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace shard_tensor_parallel {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*!
+ * \brief Partition the annotated parameters along the given axes and insert the collectives. A
+ * partitioned weight of dense or matmul_nt, which is in (out_features, in_features), is column
+ * parallel when it is partitioned along axis 0, and row parallel along axis 1. The weight of
+ * matmul, which is in (in_features, out_features), is the opposite. A partitioned 1-D parameter is
+ * a column parallel bias, and a partitioned embedding table is partitioned by the vocabulary, i.e.,
+ * along axis 0. All ranks form one
+ * tensor parallel group, and the activations are partitioned along their first axis (e.g., the
+ * samples or the tokens) across ranks outside of the partitioned layers, as in Megatron sequence
+ * parallelism (https://arxiv.org/abs/2205.05198). That is, the inputs of the function are expected
+ * to be split along the first axis like data parallelism, and:
+ *   - A column parallel dense gathers its input along the first axis, and outputs all the samples
+ *     with the local partition of the output features, which is kept partitioned through the
+ *     following elementwise ops.
+ *   - A row parallel dense takes the partitioned features, and reduce-scatters its partial output
+ *     along the first axis, which brings the activation back to the local samples.
+ *   - A row parallel embedding partitions the vocabulary. It gathers the indices, looks up the
+ *     local partition of the table, masks the indices out of the partition, and reduce-scatters.
+ *   - The replicated parameters are broadcasted, so their gradients are summed across ranks.
+ * With the gradients of the collectives, the gradients of the partitioned parameters are complete
+ * for all samples, and the gradients of the replicated parameters are identical on all ranks.
+ * Other uses of a partitioned tensor gather it back to the layout of the original function first.
+ *
+ * For example, an MLP with the column parallel %w1 and the row parallel %w2:
+ *   let %a1 = raf.op.dense(%x, %w1);
+ *   let %a2 = raf.op.relu(%a1);
+ *   let %a3 = raf.op.dense(%a2, %w2);
+ *
+ * becomes:
+ *   let %x_0 = raf.op._allgather(%x, 0, nullptr);
+ *   let %x_1 = raf.op.dense(%x_0, %w1_shard);
+ *   let %x_2 = raf.op.relu(%x_1);
+ *   let %x_3 = raf.op.dense(%x_2, %w2_shard);
+ *   let %a3 = raf.op._reduce_scatter(%x_3, "sum", nullptr);
+ */
+class TensorParallelSharder {
+ public:
+  TensorParallelSharder(int n_part, int rank, const Array<Integer>& param_indices,
+                        const Array<Integer>& axes, const Function& func)
+      : n_part_(n_part), rank_(rank), func_(func) {
+    CHECK_EQ(param_indices.size(), axes.size());
+    CHECK_GE(rank, 0);
+    CHECK_LT(rank, n_part);
+    for (size_t i = 0; i < param_indices.size(); ++i) {
+      int index = param_indices[i]->value;
+      CHECK_LT(index, func->params.size()) << "Parameter index out of range: " << index;
+      const auto& param = func->params[index];
+      int axis = axes[i]->value;
+      if (axis < 0) {
+        replicated_.push_back(param);
+        continue;
+      }
+      const auto* ttype = param->checked_type().as<TensorTypeNode>();
+      CHECK(ttype != nullptr && static_cast<size_t>(axis) < ttype->shape.size())
+          << "Cannot partition " << param->name_hint() << " along axis " << axis;
+      axes_[param] = axis;
+      param_indices_.push_back(index);
+    }
+  }
+
+  Function Shard() {
+    if ((param_indices_.empty() && replicated_.empty()) || !func_->body.as<LetNode>()) {
+      return func_;
+    }
+    ell_ = ExplicitLetList::make(func_->body);
+
+    static const Op& broadcast_op = Op::Get("raf.op._broadcast");
+    for (const auto& param : replicated_) {
+      auto root = MakeConstant(ScalarValue::make(0));
+      Expr tuple = ll_.Push(Tuple({param}));
+      env_[param] = ll_.Push(Call(broadcast_op, {tuple, root}));
+    }
+    Array<Var> new_params = func_->params;
+    for (int index : param_indices_) {
+      const auto& param = func_->params[index];
+      const auto* ttype = param->checked_type().as<TensorTypeNode>();
+      int axis = axes_.at(param);
+      const auto* dim = ttype->shape[axis].as<IntImmNode>();
+      CHECK(dim != nullptr) << "Do not support dynamic shape yet";
+      CHECK_EQ(dim->value % n_part_, 0) << "Axis " << axis << " of " << param->name_hint()
+                                        << " cannot be partitioned to " << n_part_ << " evenly";
+      Array<PrimExpr> shape = ttype->shape;
+      shape.Set(axis, Integer(dim->value / n_part_));
+      auto shard =
+          MakeVar(std::string(param->name_hint()) + "_shard", TensorType(shape, ttype->dtype));
+      new_params.Set(index, shard);
+      shards_[param] = shard;
+    }
+
+    for (size_t i = 0; i < ell_->vars.size(); ++i) {
+      VisitBinding(ell_->vars[i], ell_->exprs[i]);
+    }
+    auto body = ll_.Get(Local(ell_->ret));
+    return Function(new_params, body, {}, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Get the weight argument of a call to a partitioned layer, or nullptr otherwise. */
+  const VarNode* GetShardedWeight(const CallNode* call) {
+    static const Op& dense_op = Op::Get("raf.op.dense");
+    static const Op& matmul_op = Op::Get("raf.op.matmul");
+    static const Op& matmul_nt_op = Op::Get("raf.op.matmul_nt");
+    static const Op& embedding_op = Op::Get("raf.op.embedding");
+    const Expr* weight = nullptr;
+    if (call->op.same_as(dense_op) || call->op.same_as(matmul_op) ||
+        call->op.same_as(matmul_nt_op)) {
+      weight = &call->args[1];
+    } else if (call->op.same_as(embedding_op)) {
+      weight = &call->args[0];
+    }
+    if (weight == nullptr) {
+      return nullptr;
+    }
+    const auto* var = weight->as<VarNode>();
+    if (var == nullptr || !shards_.count(GetRef<Var>(var))) {
+      return nullptr;
+    }
+    return var;
+  }
+
+  /*! \brief Whether a call to dense or matmul is column parallel with its partitioned weight. */
+  bool IsColumnGemm(const CallNode* call, const Var& weight) {
+    static const Op& matmul_op = Op::Get("raf.op.matmul");
+    // The weight of matmul is in (in_features, out_features), and the weight of dense and
+    // matmul_nt is in (out_features, in_features).
+    return axes_.at(weight) == (call->op.same_as(matmul_op) ? 1 : 0);
+  }
+
+  /*! \brief Whether the expression is an activation partitioned by the features. */
+  bool IsColumnActivation(const Expr& expr) {
+    const auto* var = expr.as<VarNode>();
+    return var && column_.count(GetRef<Var>(var));
+  }
+
+  /*! \brief Whether the expression is a column parallel bias. */
+  bool IsColumnBias(const Expr& expr) {
+    const auto* var = expr.as<VarNode>();
+    if (var == nullptr || !shards_.count(GetRef<Var>(var))) {
+      return false;
+    }
+    return GetRef<Var>(var)->checked_type().as<TensorTypeNode>()->shape.size() == 1;
+  }
+
+  void VisitBinding(const Var& var, const Expr& expr) {
+    static const Op& embedding_op = Op::Get("raf.op.embedding");
+    if (const auto* call = expr.as<CallNode>()) {
+      if (const auto* weight = GetShardedWeight(call)) {
+        if (call->op.same_as(embedding_op)) {
+          CHECK_EQ(axes_.at(GetRef<Var>(weight)), 0)
+              << "Embedding table " << weight->name_hint() << " can only be partitioned by rows";
+          ShardEmbedding(var, call, GetRef<Var>(weight));
+        } else if (IsColumnGemm(call, GetRef<Var>(weight))) {
+          ShardColumnGemm(var, call, GetRef<Var>(weight));
+        } else {
+          ShardRowGemm(var, call, GetRef<Var>(weight));
+        }
+        return;
+      }
+      if (VisitElementwise(var, call)) {
+        return;
+      }
+    }
+    Map<Var, Expr> local_vars;
+    for (const auto& free_var : FreeVars(expr)) {
+      auto local = Local(free_var);
+      if (!local.same_as(free_var)) {
+        local_vars.Set(free_var, local);
+      }
+    }
+    ll_.Push(var, Substitute(expr, local_vars));
+  }
+
+  /*! \brief Keep an elementwise op on the activations partitioned by the features. */
+  bool VisitElementwise(const Var& var, const CallNode* call) {
+    static std::unordered_set<std::string> unary_ops = {
+        "raf.op.relu", "raf.op.gelu", "raf.op.tanh", "raf.op.sigmoid", "raf.op.erf", "raf.op.cast"};
+    static std::unordered_set<std::string> binary_ops = {"raf.op.add", "raf.op.subtract",
+                                                         "raf.op.multiply", "raf.op.divide"};
+    const auto* op = call->op.as<OpNode>();
+    size_t n_tensor_args;
+    if (op == nullptr) {
+      return false;
+    } else if (unary_ops.count(op->name)) {
+      n_tensor_args = 1;
+    } else if (binary_ops.count(op->name)) {
+      n_tensor_args = 2;
+    } else {
+      return false;
+    }
+    if (std::none_of(call->args.begin(), call->args.begin() + n_tensor_args,
+                     [this](const Expr& arg) { return IsColumnActivation(arg); })) {
+      return false;
+    }
+    Array<Expr> args;
+    for (size_t i = 0; i < call->args.size(); ++i) {
+      const auto& arg = call->args[i];
+      if (IsColumnActivation(arg)) {
+        args.push_back(env_.at(Downcast<Var>(arg)));
+      } else if (i < n_tensor_args && IsColumnBias(arg)) {
+        args.push_back(shards_.at(Downcast<Var>(arg)));
+      } else if (arg.as<ConstantNode>()) {
+        // Scalars and the other attributes.
+        args.push_back(arg);
+      } else {
+        return false;
+      }
+    }
+    SetColumn(var, ll_.Push(Call(call->op, args, call->attrs, call->type_args)));
+    return true;
+  }
+
+  /*! \brief Gather the samples to compute the local partition of the output features. */
+  void ShardColumnGemm(const Var& var, const CallNode* call, const Var& weight) {
+    Expr data = GatherSamples(call->args[0]);
+    SetColumn(var, ll_.Push(Call(call->op, {data, shards_.at(weight)})));
+  }
+
+  /*! \brief Compute the partial output with the local input features, and reduce-scatter it. */
+  void ShardRowGemm(const Var& var, const CallNode* call, const Var& weight) {
+    static const Op& slice_op = Op::Get("raf.op.strided_slice");
+    Expr data;
+    if (IsColumnActivation(call->args[0])) {
+      data = env_.at(Downcast<Var>(call->args[0]));
+    } else {
+      // Gather the samples and take the local partition of the input features.
+      data = GatherSamples(call->args[0]);
+      auto shape = GetStaticShape(call->args[0]);
+      std::vector<int64_t> begin(shape.size(), 0);
+      std::vector<int64_t> end = shape;
+      end[0] *= n_part_;
+      int64_t n_feature = shape.back() / n_part_;
+      begin.back() = rank_ * n_feature;
+      end.back() = (rank_ + 1) * n_feature;
+      auto mode = MakeConstant(StringValue::make("end"));
+      data = ll_.Push(Call(slice_op, {data, MakeIntTuple(begin), MakeIntTuple(end),
+                                      MakeIntTuple(std::vector<int64_t>(shape.size(), 1)), mode}));
+    }
+    Expr partial = ll_.Push(Call(call->op, {data, shards_.at(weight)}));
+    ll_.Push(var, Call(ReduceScatterOp(), {partial, Sum(), Null()}));
+  }
+
+  /*!
+   * \brief Look up the local partition of the vocabulary for all samples, mask the indices out of
+   * the partition, and reduce-scatter the partial embeddings.
+   */
+  void ShardEmbedding(const Var& var, const CallNode* call, const Var& table) {
+    static const Op& subtract_op = Op::Get("raf.op.subtract");
+    static const Op& greater_equal_op = Op::Get("raf.op.greater_equal");
+    static const Op& less_op = Op::Get("raf.op.less");
+    static const Op& logical_and_op = Op::Get("raf.op.logical_and");
+    static const Op& clip_op = Op::Get("raf.op.clip");
+    static const Op& cast_op = Op::Get("raf.op.cast");
+    static const Op& expand_dims_op = Op::Get("raf.op.expand_dims");
+    static const Op& multiply_op = Op::Get("raf.op.multiply");
+    const auto& shard = shards_.at(table);
+    const auto* shard_type = shard->type_annotation.as<TensorTypeNode>();
+    int64_t n_vocab = shard_type->shape[0].as<IntImmNode>()->value;
+    auto dtype = shard_type->dtype;
+
+    Expr indices = GatherSamples(call->args[1]);
+    auto offset = MakeConstant(ScalarValue::make(rank_ * n_vocab));
+    indices = ll_.Push(Call(subtract_op, {indices, offset, Null(), Null()}));
+    Expr lower = ll_.Push(Call(greater_equal_op, {indices, MakeConstant(ScalarValue::make(0))}));
+    Expr upper = ll_.Push(Call(less_op, {indices, MakeConstant(ScalarValue::make(n_vocab))}));
+    Expr mask = ll_.Push(Call(logical_and_op, {lower, upper}));
+    auto dtype_str = MakeConstant(StringValue::make(tvm::runtime::DLDataType2String(dtype)));
+    mask = ll_.Push(Call(cast_op, {mask, dtype_str}));
+    mask = ll_.Push(Call(expand_dims_op, {mask, MakeConstant(ScalarValue::make(-1)),
+                                          MakeConstant(ScalarValue::make(1))}));
+    indices = ll_.Push(Call(clip_op, {indices, MakeConstant(ScalarValue::make(0.0)),
+                                      MakeConstant(ScalarValue::make(double(n_vocab - 1)))}));
+    Expr partial = ll_.Push(Call(call->op, {shard, indices}));
+    partial = ll_.Push(Call(multiply_op, {partial, mask}));
+    ll_.Push(var, Call(ReduceScatterOp(), {partial, Sum(), Null()}));
+  }
+
+  /*! \brief Gather the samples of a tensor from all ranks. */
+  Expr GatherSamples(const Expr& expr) {
+    const auto* var = expr.as<VarNode>();
+    if (var && gathered_.count(GetRef<Var>(var))) {
+      return gathered_.at(GetRef<Var>(var));
+    }
+    Expr ret = ll_.Push(Call(AllgatherOp(), {Local(expr), Zero(), Null()}));
+    if (var) {
+      gathered_[GetRef<Var>(var)] = ret;
+    }
+    return ret;
+  }
+
+  /*! \brief Get the expression of a tensor in the layout of the original function. */
+  Expr Local(const Expr& expr) {
+    const auto* node = expr.as<VarNode>();
+    if (node == nullptr) {
+      return expr;
+    }
+    auto var = GetRef<Var>(node);
+    if (local_.count(var)) {
+      return local_.at(var);
+    }
+    Expr ret = var;
+    if (column_.count(var)) {
+      // Gather the features, and take the local samples.
+      static const Op& slice_op = Op::Get("raf.op.strided_slice");
+      auto shape = GetStaticShape(var);
+      int64_t n_sample = shape[0];
+      int ndim = shape.size();
+      CHECK_GE(ndim, 2);
+      std::vector<int64_t> to_front = {ndim - 1}, to_back;
+      for (int i = 0; i < ndim - 1; ++i) {
+        to_front.push_back(i);
+        to_back.push_back(i + 1);
+      }
+      to_back.push_back(0);
+      ret = Gather(env_.at(var), to_front, to_back);
+      auto mode = MakeConstant(StringValue::make("end"));
+      ret = ll_.Push(Call(slice_op, {ret, MakeIntTuple({rank_ * n_sample}),
+                                     MakeIntTuple({(rank_ + 1) * n_sample}), MakeIntTuple({1}),
+                                     mode}));
+    } else if (shards_.count(var)) {
+      // Gather the complete parameter.
+      int axis = axes_.at(var);
+      int ndim = var->checked_type().as<TensorTypeNode>()->shape.size();
+      std::vector<int64_t> swap;
+      for (int i = 0; i < ndim; ++i) {
+        swap.push_back(i);
+      }
+      std::swap(swap[0], swap[axis]);
+      ret = Gather(shards_.at(var), swap, swap);
+    } else if (env_.count(var)) {
+      ret = env_.at(var);
+    }
+    local_[var] = ret;
+    return ret;
+  }
+
+  /*!
+   * \brief Gather a tensor along an axis.
+   * \param expr The tensor to be gathered.
+   * \param to_front The permutation that moves the gathered axis to the first one.
+   * \param to_back The permutation that moves the first axis back to the gathered axis.
+   */
+  Expr Gather(const Expr& expr, const std::vector<int64_t>& to_front,
+              const std::vector<int64_t>& to_back) {
+    static const Op& transpose_op = Op::Get("raf.op.transpose");
+    bool transpose = to_front[0] != 0;
+    Expr ret = expr;
+    if (transpose) {
+      ret = ll_.Push(Call(transpose_op, {ret, MakeIntTuple(to_front)}));
+    }
+    ret = ll_.Push(Call(AllgatherOp(), {ret, Zero(), Null()}));
+    if (transpose) {
+      ret = ll_.Push(Call(transpose_op, {ret, MakeIntTuple(to_back)}));
+    }
+    return ret;
+  }
+
+  void SetColumn(const Var& var, const Expr& expr) {
+    column_.insert(var);
+    env_[var] = expr;
+  }
+
+  std::vector<int64_t> GetStaticShape(const Expr& expr) {
+    const auto* ttype = expr->checked_type().as<TensorTypeNode>();
+    CHECK(ttype != nullptr) << "Expected a tensor, but got " << expr->checked_type();
+    std::vector<int64_t> shape;
+    for (const auto& dim : ttype->shape) {
+      const auto* value = dim.as<IntImmNode>();
+      CHECK(value != nullptr) << "Do not support dynamic shape yet";
+      shape.push_back(value->value);
+    }
+    return shape;
+  }
+
+  static Expr MakeIntTuple(const std::vector<int64_t>& values) {
+    Array<Value> fields;
+    for (auto value : values) {
+      fields.push_back(ScalarValue::make(value));
+    }
+    return MakeConstant(TupleValue::make(fields));
+  }
+
+  static const Op& AllgatherOp() {
+    static const Op& op = Op::Get("raf.op._allgather");
+    return op;
+  }
+
+  static const Op& ReduceScatterOp() {
+    static const Op& op = Op::Get("raf.op._reduce_scatter");
+    return op;
+  }
+
+  static Expr Zero() {
+    return MakeConstant(ScalarValue::make(0));
+  }
+
+  static Expr Sum() {
+    return MakeConstant(StringValue::make("sum"));
+  }
+
+  static Expr Null() {
+    return MakeConstant(NullValue<Value>());
+  }
+
+  /*! \brief The number of ranks in the tensor parallel group. */
+  int n_part_;
+  /*! \brief The rank of this process in the tensor parallel group. */
+  int rank_;
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The indices of the partitioned parameters. */
+  std::vector<int> param_indices_;
+  /*! \brief The replicated parameters. */
+  std::vector<Var> replicated_;
+  /*! \brief Mapping from a partitioned parameter to its partitioned axis. */
+  std::unordered_map<Var, int, ObjectPtrHash, ObjectPtrEqual> axes_;
+  /*! \brief Mapping from a partitioned parameter to the parameter of its partition. */
+  std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> shards_;
+  /*! \brief The original variables whose new values are partitioned by the features. */
+  std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> column_;
+  /*! \brief Mapping from an original variable to its new value. */
+  std::unordered_map<Var, Expr, ObjectPtrHash, ObjectPtrEqual> env_;
+  /*! \brief Mapping from an original variable to its samples gathered from all ranks. */
+  std::unordered_map<Var, Expr, ObjectPtrHash, ObjectPtrEqual> gathered_;
+  /*! \brief Mapping from an original variable to its value in the original layout. */
+  std::unordered_map<Var, Expr, ObjectPtrHash, ObjectPtrEqual> local_;
+  /*! \brief The let list of the function body. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The let list of the new function body. */
+  LetList ll_;
+};
+
+}  // namespace shard_tensor_parallel
+
+Pass ShardTensorParallel(int n_part, int rank, Array<Integer> param_indices, Array<Integer> axes) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return shard_tensor_parallel::TensorParallelSharder(n_part, rank, param_indices, axes, f)
+        .Shard();
+  };
+  auto shard = CreateRAFFunctionPass(pass_func, 0, "ShardTensorParallelFunc", {});
+  return RAFSequential({InferType(), shard, EraseType()}, "ShardTensorParallel");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.ShardTensorParallel").set_body_typed(ShardTensorParallel);
+
+}  // namespace pass
+}  // namespace raf
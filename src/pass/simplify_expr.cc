@@ -9,6 +9,9 @@
  * \file simplify_expr.cc
  * \brief Simplifies the commonly seen patterns.
  */
+#include <cmath>
+#include <unordered_map>
+#include <vector>
 #include "raf/op.h"
 #include "raf/ir.h"
 #include "raf/op_utils.h"
@@ -638,7 +641,536 @@ class SimplifyReshape : public DFPatternRewrite {
   DFPattern data_pat_;
 };
 
+/*!
+ * \brief Get the normalized axes of a transpose call.
+ * \param expr The expression, which may not be a transpose call.
+ * \param axes The axes, where the i-th output axis is the axes[i]-th input axis.
+ * \return Whether the expression is a transpose with known axes.
+ */
+bool GetTransposeAxes(const Expr& expr, std::vector<int64_t>* axes) {
+  static const Op& transpose_op = Op::Get("raf.op.transpose");
+  const auto* call = expr.as<CallNode>();
+  if (call == nullptr || call->op != transpose_op) {
+    return false;
+  }
+  const auto* konst = call->args[1].as<ConstantNode>();
+  if (konst == nullptr || !konst->value.defined()) {
+    return false;
+  }
+  *axes = GetShapeVecFromValue(Downcast<Value>(konst->value));
+  int64_t ndim = axes->size();
+  if (ndim == 0) {
+    // Empty axes reverse the dimensions, which needs the rank of the input.
+    const auto* ttype = call->args[0]->checked_type_.as<TensorTypeNode>();
+    if (ttype == nullptr) {
+      return false;
+    }
+    ndim = ttype->shape.size();
+    for (int64_t i = ndim - 1; i >= 0; --i) {
+      axes->push_back(i);
+    }
+  }
+  for (auto& axis : *axes) {
+    axis = axis < 0 ? axis + ndim : axis;
+  }
+  return true;
+}
+
+/*! \brief Fold transpose(transpose(x)) into one transpose, or remove it if they cancel out. */
+class SimplifyTranspose : public DFPatternRewrite {
+ public:
+  SimplifyTranspose() {
+    data_pat_ = IsWildcard();
+    pattern_ = IsOp("raf.op.transpose")({data_pat_, IsWildcard()});
+    pattern_ = IsOp("raf.op.transpose")({pattern_, IsWildcard()});
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    static auto transpose_op = Op::Get("raf.op.transpose");
+    std::vector<int64_t> inner_axes, outer_axes;
+    if (!GetTransposeAxes(Downcast<Call>(pre)->args[0], &inner_axes) ||
+        !GetTransposeAxes(pre, &outer_axes) || inner_axes.size() != outer_axes.size()) {
+      return post;
+    }
+    std::vector<int64_t> axes;
+    bool identity = true;
+    for (size_t i = 0; i < outer_axes.size(); ++i) {
+      axes.push_back(inner_axes[outer_axes[i]]);
+      identity &= axes.back() == static_cast<int64_t>(i);
+    }
+    auto data = node_map[data_pat_][0];
+    if (identity) {
+      return data;
+    }
+    return Call(transpose_op, {data, MakeConstant(ArrayToIntTuple(axes))});
+  }
+
+ private:
+  /*! \brief Pattern input. */
+  DFPattern data_pat_;
+};
+
+/*!
+ * \brief Fold the transposes of the last two dimensions of the GEMM operands into the GEMM, e.g.,
+ * matmul(transpose(a, [1, 0]), b) -> matmul_tn(a, b), because the GEMM kernels take the
+ * transposed operands without the copies.
+ */
+class SimplifyTransposeMatmul : public DFPatternRewrite {
+ public:
+  SimplifyTransposeMatmul() {
+    matmul_op_ = IsOp("raf.op.dense") || IsOp("raf.op.matmul") || IsOp("raf.op.matmul_nt") ||
+                 IsOp("raf.op.matmul_tn") || IsOp("raf.op.matmul_tt") ||
+                 IsOp("raf.op.batch_matmul") || IsOp("raf.op.batch_matmul_nt") ||
+                 IsOp("raf.op.batch_matmul_tn") || IsOp("raf.op.batch_matmul_tt");
+    auto transpose = IsOp("raf.op.transpose")({IsWildcard(), IsWildcard()});
+    pattern_ = matmul_op_({transpose, IsWildcard()}) || matmul_op_({IsWildcard(), transpose});
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    static const Op& transpose_op = Op::Get("raf.op.transpose");
+    // The ops indexed by whether the operands are transposed.
+    static const std::vector<std::vector<Op>> matmul_ops = {
+        {Op::Get("raf.op.matmul"), Op::Get("raf.op.matmul_nt")},
+        {Op::Get("raf.op.matmul_tn"), Op::Get("raf.op.matmul_tt")}};
+    static const std::vector<std::vector<Op>> batch_matmul_ops = {
+        {Op::Get("raf.op.batch_matmul"), Op::Get("raf.op.batch_matmul_nt")},
+        {Op::Get("raf.op.batch_matmul_tn"), Op::Get("raf.op.batch_matmul_tt")}};
+    Op op = Downcast<Op>(node_map[matmul_op_][0]);
+    if (op->name == "raf.op.dense") {
+      op = matmul_ops[0][1];
+    }
+    bool is_batch = op->name.find("batch_matmul") != std::string::npos;
+    const auto& ops = is_batch ? batch_matmul_ops : matmul_ops;
+    // Recover the flags from the op, where ops[ta][tb] is the op.
+    bool trans[2] = {false, false};
+    for (int ta = 0; ta < 2; ++ta) {
+      for (int tb = 0; tb < 2; ++tb) {
+        if (op == ops[ta][tb]) {
+          trans[0] = ta;
+          trans[1] = tb;
+        }
+      }
+    }
+
+    auto call = Downcast<Call>(post);
+    auto pre_call = Downcast<Call>(pre);
+    Array<Expr> args = call->args;
+    bool changed = false;
+    for (int i = 0; i < 2; ++i) {
+      std::vector<int64_t> axes;
+      if (!GetTransposeAxes(pre_call->args[i], &axes) || !IsLastTwoSwapped(axes, is_batch)) {
+        continue;
+      }
+      const auto* transpose = args[i].as<CallNode>();
+      if (transpose == nullptr || transpose->op != transpose_op) {
+        continue;
+      }
+      args.Set(i, transpose->args[0]);
+      trans[i] = !trans[i];
+      changed = true;
+    }
+    if (!changed) {
+      return post;
+    }
+    return Call(ops[trans[0]][trans[1]], args);
+  }
+
+ private:
+  /*! \brief Whether the transpose only swaps the last two dimensions of a 2D or 3D operand. */
+  static bool IsLastTwoSwapped(const std::vector<int64_t>& axes, bool is_batch) {
+    if (is_batch) {
+      return axes == std::vector<int64_t>{0, 2, 1};
+    }
+    return axes == std::vector<int64_t>{1, 0};
+  }
+
+  /*! \brief Pattern input. */
+  DFPattern matmul_op_;
+};
+
+/*!
+ * \brief Move the reshapes across the unary elementwise ops so that they merge, e.g.,
+ * reshape(gelu(reshape(x, s1)), s2) -> gelu(reshape(x, s2)), where the reshape is removed if s2 is
+ * the shape of x. The intermediate results must not be used elsewhere, otherwise the elementwise op
+ * is computed twice.
+ */
+class SimplifyReshapeElemwise : public DFPatternRewrite {
+ public:
+  explicit SimplifyReshapeElemwise(const Expr& expr) {
+    data_pat_ = IsWildcard();
+    unary_op_ = IsOp("raf.op.relu") || IsOp("raf.op.gelu") || IsOp("raf.op.tanh") ||
+                IsOp("raf.op.sigmoid") || IsOp("raf.op.copy") || IsOp("raf.op.negative") ||
+                IsOp("raf.op.exp");
+    auto reshape = IsOp("raf.op.reshape")({data_pat_, IsWildcard(), IsWildcard()});
+    pattern_ = IsOp("raf.op.reshape")({unary_op_({reshape}), IsWildcard(), IsWildcard()});
+
+    struct UseCounter : public ExprVisitor {
+      void VisitExpr(const Expr& expr) final {
+        ++use_counts[expr.get()];
+        ExprVisitor::VisitExpr(expr);
+      }
+      std::unordered_map<const Object*, int> use_counts;
+    } counter;
+    counter.VisitExpr(expr);
+    use_counts_ = std::move(counter.use_counts);
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    static auto reshape_op = Op::Get("raf.op.reshape");
+    auto unary = Downcast<Call>(pre)->args[0];
+    auto inner_reshape = Downcast<Call>(unary)->args[0];
+    if (!IsSingleUse(unary) || !IsSingleUse(inner_reshape)) {
+      return post;
+    }
+    const auto* out_ty = pre->checked_type().as<TensorTypeNode>();
+    auto inner_data = Downcast<Call>(inner_reshape)->args[0];
+    const auto* data_ty = inner_data->checked_type().as<TensorTypeNode>();
+    if (out_ty == nullptr || data_ty == nullptr) {
+      return post;
+    }
+    Array<Integer> new_shape;
+    for (auto dim : out_ty->shape) {
+      if (dim.as<IntImmNode>() == nullptr) {
+        return post;
+      }
+      new_shape.push_back(Downcast<Integer>(dim));
+    }
+    auto data = node_map[data_pat_][0];
+    Op unary_op = Downcast<Op>(node_map[unary_op_][0]);
+    if (tvm::StructuralEqual()(out_ty->shape, data_ty->shape)) {
+      return Call(unary_op, {data});
+    }
+    auto reshape = Call(reshape_op, {data, MakeConstant(ArrayToIntTuple(new_shape)),
+                                     MakeConstant(BoolValue::make(false))});
+    return Call(unary_op, {reshape});
+  }
+
+ private:
+  bool IsSingleUse(const Expr& expr) const {
+    auto it = use_counts_.find(expr.get());
+    return it != use_counts_.end() && it->second == 1;
+  }
+
+  /*! \brief Pattern input. */
+  DFPattern data_pat_, unary_op_;
+  /*! \brief The number of uses of each node in the original expression. */
+  std::unordered_map<const Object*, int> use_counts_;
+};
+
+/*! \brief Get the value of a constant scalar, or a constant 0-dim float tensor. */
+bool GetConstantScalar(const Expr& arg, double* value) {
+  if (auto node = arg.as<ConstantNode>()) {
+    if (auto val_obj = node->value.as<IntValueObj>()) {
+      *value = val_obj->value;
+      return true;
+    } else if (auto val_obj = node->value.as<FloatValueObj>()) {
+      *value = val_obj->value;
+      return true;
+    } else if (auto val_obj = node->value.as<TensorValueObj>()) {
+      tensor::Tensor tensor = val_obj->tensor;
+      if (tensor->ndim == 0 && (DataType(tensor->dtype) == DataType::Float(32) ||
+                                DataType(tensor->dtype) == DataType::Float(16))) {
+        *value = GetScalarValueData<float>(GetRef<TensorValue>(val_obj));
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/*!
+ * \brief Fuse the decomposed attention into the fused attention op, which does not materialize
+ * the scores in memory:
+ *   batch_matmul(dropout(softmax(batch_matmul_nt(q, k) * scale)), v) -> attention(q, k, v)
+ * where the scaling and the dropout are optional, and the scale can also be a division. The
+ * intermediate results must not be used elsewhere, e.g., by the backward after AutoDiff, because
+ * the fused op does not output them. The fused op is only implemented by the CUDA dialect, so this
+ * rewrite only applies on CUDA devices.
+ */
+class SimplifyAttention : public DFPatternRewrite {
+ public:
+  explicit SimplifyAttention(const Expr& expr) {
+    q_pat_ = IsWildcard();
+    k_pat_ = IsWildcard();
+    v_pat_ = IsWildcard();
+    scale_pat_ = IsWildcard();
+    p_pat_ = IsWildcard();
+    auto scores = IsOp("raf.op.batch_matmul_nt")({q_pat_, k_pat_});
+    mul_pat_ = IsOp("raf.op.multiply")({scores, scale_pat_});
+    div_pat_ = IsOp("raf.op.divide")({scores, scale_pat_});
+    auto probs = IsOp("raf.op.softmax")({mul_pat_ || div_pat_ || scores, IsWildcard()});
+    auto dropout_op = IsOp("raf.op._contrib_dropout");
+    auto dropout = dropout_op({probs, p_pat_}) || dropout_op({probs, p_pat_, IsWildcard()});
+    pattern_ = IsOp("raf.op.batch_matmul")({IsTupleGetItem(dropout, 0) || probs, v_pat_});
+
+    // Count the uses of each node.
+    struct UseCounter : public ExprVisitor {
+      void VisitExpr(const Expr& expr) final {
+        ++use_counts[expr.get()];
+        ExprVisitor::VisitExpr(expr);
+      }
+      std::unordered_map<const Object*, int> use_counts;
+    } counter;
+    counter.VisitExpr(expr);
+    use_counts_ = std::move(counter.use_counts);
+  }
+
+  /*! \brief Whether the fused attention is available on the current device. */
+  static bool IsApplicable() {
+    auto dev = Device::Current(true);
+    return dev.device_type() == DevType::kCUDA() && Dialect::IsEnabled("cuda", DevType::kCUDA());
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    static auto attention_op = Op::Get("raf.op.attention");
+    // Walk from the output to the scores, and check that the intermediate results are only used
+    // by the next op.
+    Expr expr = Downcast<Call>(pre)->args[0];
+    if (auto tgi = expr.as<TupleGetItemNode>()) {
+      if (!IsSingleUse(expr) || !IsSingleUse(tgi->tuple)) {
+        return post;
+      }
+      expr = Downcast<Call>(tgi->tuple)->args[0];
+    }
+    auto softmax = Downcast<Call>(expr);
+    expr = softmax->args[0];
+    if (node_map.count(mul_pat_) || node_map.count(div_pat_)) {
+      if (!IsSingleUse(expr)) {
+        return post;
+      }
+      expr = Downcast<Call>(expr)->args[0];
+    }
+    if (!IsSingleUse(softmax) || !IsSingleUse(expr)) {
+      return post;
+    }
+
+    // Check the softmax axis and the types.
+    auto scores_ty = expr->checked_type().as<TensorTypeNode>();
+    double axis;
+    if (scores_ty == nullptr || !GetConstantScalar(softmax->args[1], &axis) ||
+        (axis != -1 && axis != static_cast<double>(scores_ty->shape.size() - 1))) {
+      return post;
+    }
+    auto scores_call = Downcast<Call>(expr);
+    auto v = Downcast<Call>(pre)->args[1];
+    std::vector<int64_t> q_shape, k_shape, v_shape;
+    DataType dtype = scores_ty->dtype;
+    if (!GetStaticShape(scores_call->args[0], dtype, &q_shape) ||
+        !GetStaticShape(scores_call->args[1], dtype, &k_shape) ||
+        !GetStaticShape(v, dtype, &v_shape) ||
+        !(dtype == DataType::Float(32) || dtype == DataType::Float(16))) {
+      return post;
+    }
+    // The batch_matmuls may broadcast the batch dimension, and the fused kernel supports up to
+    // 128 head dimensions.
+    if (q_shape.size() != 3 || k_shape.size() != 3 || v_shape.size() != 3 ||
+        q_shape[0] != k_shape[0] || q_shape[0] != v_shape[0] || q_shape[2] != k_shape[2] ||
+        q_shape[2] != v_shape[2] || k_shape[1] != v_shape[1] || q_shape[2] > 128) {
+      return post;
+    }
+
+    double scale = 1.0;
+    if (node_map.count(mul_pat_) || node_map.count(div_pat_)) {
+      // The op takes a non-positive scale as the default 1 / sqrt(head_dim).
+      if (!GetConstantScalar(node_map[scale_pat_][0], &scale) || scale <= 0) {
+        return post;
+      }
+      if (node_map.count(div_pat_)) {
+        scale = 1.0 / scale;
+      }
+    }
+    double p = 0.0;
+    if (node_map.count(p_pat_) && !GetConstantScalar(node_map[p_pat_][0], &p)) {
+      return post;
+    }
+    auto ret = Call(attention_op,
+                    {node_map[q_pat_][0], node_map[k_pat_][0], node_map[v_pat_][0],
+                     MakeConstant(ScalarValue::make(scale)), MakeConstant(ScalarValue::make(false)),
+                     MakeConstant(ScalarValue::make(p))});
+    return TupleGetItem(ret, 0);
+  }
+
+ private:
+  /*! \brief Get the static shape of a tensor with the given dtype. */
+  static bool GetStaticShape(const Expr& expr, DataType dtype, std::vector<int64_t>* shape) {
+    auto ttype = expr->checked_type().as<TensorTypeNode>();
+    if (ttype == nullptr || ttype->dtype != dtype) {
+      return false;
+    }
+    for (const auto& dim : ttype->shape) {
+      auto imm = dim.as<IntImmNode>();
+      if (imm == nullptr) {
+        return false;
+      }
+      shape->push_back(imm->value);
+    }
+    return true;
+  }
+
+  bool IsSingleUse(const Expr& expr) const {
+    auto it = use_counts_.find(expr.get());
+    return it != use_counts_.end() && it->second == 1;
+  }
+
+  /*! \brief Pattern inputs. */
+  DFPattern q_pat_, k_pat_, v_pat_, scale_pat_, p_pat_;
+  /*! \brief The optional scaling patterns. */
+  DFPattern mul_pat_, div_pat_;
+  /*! \brief The number of uses of each node in the original expression. */
+  std::unordered_map<const Object*, int> use_counts_;
+};
+
+/*!
+ * \brief Fold the constant pad into the padding of the following conv2d or pooling, which pads on
+ * the fly instead of materializing a padded copy of the input:
+ *   conv2d(pad(x, pad_width, 0), w, padding=p) -> conv2d(x, w, padding=p + pad_width)
+ * The pad must only pad the spatial axes and must not be used elsewhere. The padded value has to
+ * be what the op pads with, i.e., zero for conv2d and avg_pool2d that includes the padding, and
+ * -inf for max_pool2d. The folded padding is (top, left, bottom, right) if the pad is asymmetric.
+ */
+class SimplifyPadConvPool : public DFPatternRewrite {
+ public:
+  explicit SimplifyPadConvPool(const Expr& expr) {
+    data_pat_ = IsWildcard();
+    pad_pat_ = IsOp("raf.op.pad")({data_pat_, IsWildcard(), IsWildcard(), IsWildcard()});
+    auto conv2d = IsOp("raf.op.conv2d")({pad_pat_, IsWildcard(), IsWildcard(), IsWildcard(),
+                                         IsWildcard(), IsWildcard(), IsWildcard(), IsWildcard(),
+                                         IsWildcard()});
+    auto pool_op = IsOp("raf.op.max_pool2d") || IsOp("raf.op.avg_pool2d");
+    auto pool = pool_op({pad_pat_, IsWildcard(), IsWildcard(), IsWildcard(), IsWildcard(),
+                         IsWildcard(), IsWildcard(), IsWildcard()});
+    pattern_ = conv2d || pool;
+
+    struct UseCounter : public ExprVisitor {
+      void VisitExpr(const Expr& expr) final {
+        ++use_counts[expr.get()];
+        ExprVisitor::VisitExpr(expr);
+      }
+      std::unordered_map<const Object*, int> use_counts;
+    } counter;
+    counter.VisitExpr(expr);
+    use_counts_ = std::move(counter.use_counts);
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    static auto conv2d_op = Op::Get("raf.op.conv2d");
+    static auto max_pool2d_op = Op::Get("raf.op.max_pool2d");
+    auto call = Downcast<Call>(pre);
+    auto pad = Downcast<Call>(call->args[0]);
+    if (!IsSingleUse(pad)) {
+      return post;
+    }
+    const auto* pad_mode = GetConstantValue<StringValueObj>(pad->args[3]);
+    double pad_value;
+    if (pad_mode == nullptr || pad_mode->value != "constant" ||
+        !GetConstantScalar(pad->args[2], &pad_value)) {
+      return post;
+    }
+
+    // Check that the op pads with the same value.
+    bool is_conv2d = call->op == conv2d_op;
+    const auto* layout = GetConstantValue<StringValueObj>(call->args[is_conv2d ? 6 : 7]);
+    if (layout == nullptr) {
+      return post;
+    }
+    if (is_conv2d) {
+      if (pad_value != 0) {
+        return post;
+      }
+    } else {
+      // The last window of the ceil mode may cover the padded region differently.
+      const auto* ceil_mode = GetConstantValue<BoolValueObj>(call->args[5]);
+      const auto* include_pad = GetConstantValue<BoolValueObj>(call->args[6]);
+      if (ceil_mode == nullptr || include_pad == nullptr || ceil_mode->value) {
+        return post;
+      }
+      if (call->op == max_pool2d_op ? !(std::isinf(pad_value) && pad_value < 0)
+                                    : (pad_value != 0 || !include_pad->value)) {
+        return post;
+      }
+    }
+
+    // Check that only the spatial axes are padded.
+    int h_axis, w_axis;
+    if (layout->value == "NCHW") {
+      h_axis = 2;
+      w_axis = 3;
+    } else if (layout->value == "NHWC") {
+      h_axis = 1;
+      w_axis = 2;
+    } else {
+      return post;
+    }
+    std::vector<int64_t> pad_width, padding;
+    if (!GetConstantInts(pad->args[1], &pad_width) || pad_width.size() != 8 ||
+        !GetConstantInts(call->args[3], &padding) ||
+        !(padding.size() == 1 || padding.size() == 2 || padding.size() == 4)) {
+      return post;
+    }
+    for (int i = 0; i < 4; ++i) {
+      bool is_spatial = i == h_axis || i == w_axis;
+      if (pad_width[2 * i] < 0 || pad_width[2 * i + 1] < 0 ||
+          (!is_spatial && (pad_width[2 * i] != 0 || pad_width[2 * i + 1] != 0))) {
+        return post;
+      }
+    }
+
+    std::vector<int64_t> new_padding = GetPadTLBR(padding);
+    new_padding[0] += pad_width[2 * h_axis];
+    new_padding[1] += pad_width[2 * w_axis];
+    new_padding[2] += pad_width[2 * h_axis + 1];
+    new_padding[3] += pad_width[2 * w_axis + 1];
+    if (IsSymmetricPadding(new_padding)) {
+      // Keep the symmetric padding in two values, which all the dialects support.
+      new_padding.resize(2);
+    }
+    Array<Expr> args = Downcast<Call>(post)->args;
+    args.Set(0, node_map[data_pat_][0]);
+    args.Set(3, MakeConstant(ArrayToIntTuple(new_padding)));
+    return Call(call->op, args);
+  }
+
+ private:
+  bool IsSingleUse(const Expr& expr) const {
+    auto it = use_counts_.find(expr.get());
+    return it != use_counts_.end() && it->second == 1;
+  }
+
+  template <typename T>
+  static const T* GetConstantValue(const Expr& expr) {
+    const auto* konst = expr.as<ConstantNode>();
+    return konst != nullptr && konst->value.defined() ? konst->value.as<T>() : nullptr;
+  }
+
+  static bool GetConstantInts(const Expr& expr, std::vector<int64_t>* values) {
+    const auto* konst = expr.as<ConstantNode>();
+    if (konst == nullptr || !konst->value.defined() ||
+        !(konst->value->IsInstance<IntValueObj>() || konst->value->IsInstance<TupleValueObj>())) {
+      return false;
+    }
+    *values = GetShapeVecFromValue(Downcast<Value>(konst->value));
+    return true;
+  }
+
+  /*! \brief Pattern input. */
+  DFPattern data_pat_, pad_pat_;
+  /*! \brief The number of uses of each node in the original expression. */
+  std::unordered_map<const Object*, int> use_counts_;
+};
+
 Expr SimplifyExpr(const Expr& expr, const IRModule& mod) {
+  Expr ret = expr;
+  // Phase 0: Fuse the attention, which has to match the original expression to count the uses.
+  if (SimplifyAttention::IsApplicable()) {
+    SimplifyAttention rewrite(expr);
+    ret = raf::ir::RAFRewritePatterns({rewrite.MakeCallback()}, ret, mod);
+  }
+
   // Phase 1: Single-op patterns that only need to be applied once.
   DFPatternRewriteComposer composer;
   composer.AddRewrite<ConcretizeZerosLikeRewrite>();
@@ -648,14 +1180,27 @@ Expr SimplifyExpr(const Expr& expr, const IRModule& mod) {
   composer.AddRewrite<ConcretizeMultiplyRewrite>();
   composer.AddRewrite<ConcretizeAddSubRewrite>();
   composer.AddRewrite<ConcretizeDropoutRewrite>();
-  auto ret = raf::ir::RAFRewritePatterns(composer.MakeCallbacks(), expr, mod);
+  ret = raf::ir::RAFRewritePatterns(composer.MakeCallbacks(), ret, mod);
 
   // Phase 2: Sequence patterns that may need to be applied iteratively.
   composer.Clear();
   composer.AddRewrite<SimplifyMatmulReshapeBiasAct>();
   composer.AddRewrite<SimplifyCast>();
   composer.AddRewrite<SimplifyReshape>();
-  return raf::ir::RAFRewritePatterns(composer.MakeCallbacks(), ret, mod);
+  ret = raf::ir::RAFRewritePatterns(composer.MakeCallbacks(), ret, mod);
+
+  // Phase 3: Eliminate the layout ops and the pads, which are full copies. The reshapes across the
+  // elementwise ops and the pads have to match the expression of this phase to count the uses.
+  SimplifyReshapeElemwise reshape_elemwise(ret);
+  SimplifyPadConvPool pad_conv_pool(ret);
+  composer.Clear();
+  composer.AddRewrite<SimplifyTranspose>();
+  composer.AddRewrite<SimplifyTransposeMatmul>();
+  composer.AddRewrite<SimplifyReshape>();
+  Array<DFPatternCallback> callbacks = composer.MakeCallbacks();
+  callbacks.push_back(reshape_elemwise.MakeCallback());
+  callbacks.push_back(pad_conv_pool.MakeCallback());
+  return raf::ir::RAFRewritePatterns(callbacks, ret, mod);
 }
 
 }  // namespace simplify_expr
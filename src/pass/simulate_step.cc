@@ -0,0 +1,344 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file simulate_step.cc
+ * \brief Simulate the step time by replaying the ops on virtual streams. Note that this can only be
+ * used after ManifestAlloc pass.
+ */
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include "raf/comm_cost_model.h"
+#include "raf/device.h"
+#include "raf/dialect.h"
+#include "raf/op.h"
+#include "raf/op_profiler.h"
+#include "raf/op_utils.h"
+#include "raf/pass.h"
+#include "./let_list.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace simulate_step {
+
+using namespace raf::op;
+
+using StepTrace = Array<Array<ObjectRef>>;
+
+/*! \brief The op names longer than this are truncated by TruncateName. */
+constexpr size_t kMaxFuncNameLength = 80;
+
+/*! \brief The signature of a tensor type, which is the same as the one in the profiled events. */
+void TensorRepr(std::ostringstream& os, const Type& type) {
+  const auto* tensor_type = type.as<TensorTypeNode>();
+  if (tensor_type == nullptr) {
+    return;
+  }
+  os << "T<";
+  for (const auto& dim : tensor_type->shape) {
+    const auto* dim_imm = dim.as<IntImmNode>();
+    if (dim_imm != nullptr) {
+      os << dim_imm->value << "x";
+    } else {
+      os << "?x";
+    }
+  }
+  auto dtype = tensor_type->dtype;
+  if (dtype.is_int()) {
+    os << "i" << dtype.bits();
+  } else if (dtype.is_uint()) {
+    os << "u" << dtype.bits();
+  } else if (dtype.is_float()) {
+    os << "f" << dtype.bits();
+  } else if (dtype.is_bfloat16()) {
+    os << "bf" << dtype.bits();
+  } else {
+    os << "unk";
+  }
+  if (dtype.lanes() > 1) {
+    os << "x" << dtype.lanes();
+  }
+  os << ">";
+}
+
+/*! \brief The signature of an op with its inputs and outputs, where the constants are skipped. */
+std::string GetSignature(const Array<Expr>& inputs, const Array<Expr>& outputs) {
+  std::ostringstream os;
+  for (const auto& input : inputs) {
+    if (input->IsInstance<ConstantNode>()) {
+      continue;
+    }
+    const auto& type = input->checked_type();
+    if (const auto* tuple_type = type.as<TupleTypeNode>()) {
+      os << "(";
+      for (const auto& field : tuple_type->fields) {
+        TensorRepr(os, field);
+        os << ",";
+      }
+      os << ")";
+    } else {
+      TensorRepr(os, type);
+    }
+    os << ",";
+  }
+  os << "|";
+  if (outputs.size() == 1) {
+    TensorRepr(os, outputs[0]->checked_type());
+  } else {
+    os << "(";
+    for (const auto& output : outputs) {
+      TensorRepr(os, output->checked_type());
+      os << ",";
+    }
+    os << ")";
+  }
+  return os.str();
+}
+
+/*! \brief Strip "raf.op." and the dialect of an op name, e.g., "raf.op.cublas.dense" to "dense". */
+std::string GetBaseName(const Op& op) {
+  std::string name = (IsDialectOp(op) ? GetBaseOp(op) : op)->name;
+  if (name.compare(0, 7, "raf.op.") == 0) {
+    name = name.substr(7);
+  }
+  return name;
+}
+
+/*! \brief Collect the readable name of a fused function in the same way as the TVM dialect. */
+class FusedNameGetter : public ExprVisitor {
+ public:
+  std::string Get(const Function& func) {
+    os_ << "fused";
+    VisitExpr(func->body);
+    return os_.str();
+  }
+
+  void VisitExpr_(const CallNode* call) final {
+    if (const auto* op = call->op.as<OpNode>()) {
+      std::string name = op->name;
+      if (name.compare(0, 11, "raf.op.tvm.") == 0) {
+        name = name.substr(11);
+      }
+      os_ << "_" << name;
+    }
+    for (const auto& arg : call->args) {
+      VisitExpr(arg);
+    }
+  }
+
+ private:
+  std::ostringstream os_;
+};
+
+/*!
+ * \brief Normalize an op name so the ones in the IR and the ones in the profiled events can be
+ * matched. The profiled names are OpEnv names (e.g., "raf_op_cublas_matmul_2"), which are made
+ * unique by a suffix and may be truncated.
+ */
+std::string NormalizeName(std::string name, bool profiled) {
+  for (auto& c : name) {
+    if (c == '.') c = '_';
+  }
+  if (profiled) {
+    // Truncated names end with "_<hash>_", and unique names end with "_<index>".
+    if (name.size() > kMaxFuncNameLength && name.back() == '_') {
+      name = name.substr(0, kMaxFuncNameLength);
+    } else {
+      auto pos = name.find_last_of('_');
+      if (pos != std::string::npos && pos + 1 < name.size() &&
+          std::all_of(name.begin() + pos + 1, name.end(), ::isdigit)) {
+        name = name.substr(0, pos);
+      }
+    }
+    if (name.compare(0, 7, "raf_op_") == 0) {
+      name = name.substr(7);
+      for (const auto& dialect : Dialect::Registry()->ListAllNames()) {
+        if (name.compare(0, dialect.size() + 1, dialect + "_") == 0) {
+          name = name.substr(dialect.size() + 1);
+          break;
+        }
+      }
+    }
+  } else if (name.size() > kMaxFuncNameLength) {
+    name = name.substr(0, kMaxFuncNameLength);
+  }
+  return name;
+}
+
+/*!
+ * \brief A simulator that replays the ops of an after ManifestAlloc ANF IR on virtual streams.
+ *
+ * Each stream runs its ops one after another in the program order. The set_stream, add_event,
+ * wait_event and stream_barrier ops synchronize the streams as the VM does, so the ops on
+ * different streams (e.g., the computation and the collectives) overlap. The latency of an op is
+ * the mean latency of the profiled events with the same name and signature (e.g., from a single
+ * device profile), or the one estimated by the analytical cost model, which takes the calibrated
+ * latency of the collectives. The host overhead is not simulated.
+ */
+class StepSimulator {
+ public:
+  StepSimulator(const Device& device, const Function& func, const Map<String, FloatImm>& profiled)
+      : ell_(ExplicitLetList::make(func->body)), device_(device) {
+    std::unordered_map<std::string, std::pair<double, int>> sums;
+    for (const auto& kv : profiled) {
+      std::string key = kv.first;
+      auto pos = key.find('@');
+      CHECK(pos != std::string::npos)
+          << "Expected the profiled key <name>@<signature>, but got " << key;
+      auto norm_key = NormalizeName(key.substr(0, pos), true) + key.substr(pos);
+      auto& sum = sums[norm_key];
+      sum.first += kv.second->value;
+      sum.second += 1;
+    }
+    for (const auto& kv : sums) {
+      profiled_[kv.first] = kv.second.first / kv.second.second;
+    }
+  }
+
+  StepTrace Run() {
+    static const Op& invoke_op = Op::Get("raf.op.vm.invoke_op");
+    static const Op& set_stream_op = Op::Get("raf.op.set_stream");
+    static const Op& add_event_op = Op::Get("raf.op.add_event");
+    static const Op& wait_event_op = Op::Get("raf.op.wait_event");
+    static const Op& stream_barrier_op = Op::Get("raf.op.stream_barrier");
+
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    CHECK_EQ(vars.size(), exprs.size());
+    // The time that each stream is ready to launch the next op, and the time of each event.
+    std::unordered_map<int64_t, double> stream_ready;
+    std::unordered_map<int64_t, double> event_time;
+    int64_t curr_stream = 0;
+
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      let_map_.Set(vars[i], exprs[i]);
+      const auto* call = exprs[i].as<CallNode>();
+      if (!call || !call->op.as<OpNode>()) {
+        continue;
+      }
+      auto op = Downcast<Op>(call->op);
+      if (op == set_stream_op) {
+        curr_stream = GetIntArg(call->args[1]);
+      } else if (op == add_event_op || op == wait_event_op) {
+        auto event_id = GetIntArg(call->args[0]);
+        auto stream = curr_stream;
+        if (call->args.size() > 1 && GetIntArg(call->args[1]) != -1) {
+          stream = GetIntArg(call->args[1]);
+        }
+        if (op == add_event_op) {
+          event_time[event_id] = stream_ready[stream];
+        } else if (event_time.count(event_id) > 0) {
+          stream_ready[stream] = std::max(stream_ready[stream], event_time[event_id]);
+        }
+      } else if (op == stream_barrier_op) {
+        double barrier = 0;
+        for (const auto& kv : stream_ready) {
+          barrier = std::max(barrier, kv.second);
+        }
+        for (auto& kv : stream_ready) {
+          kv.second = barrier;
+        }
+        barrier_ = barrier;
+      } else if (op == invoke_op) {
+        std::string name, kind, source;
+        double latency = GetLatency(call, &name, &kind, &source);
+        if (stream_ready.count(curr_stream) == 0) {
+          // A stream that has no op before the last barrier still waits for the barrier.
+          stream_ready[curr_stream] = barrier_;
+        }
+        double start = stream_ready[curr_stream];
+        stream_ready[curr_stream] = start + latency;
+        trace_.push_back({String(name), Integer(curr_stream),
+                          FloatImm(DataType::Float(64), start),
+                          FloatImm(DataType::Float(64), latency), String(kind), String(source)});
+      }
+    }
+    return trace_;
+  }
+
+ private:
+  /*! \brief Get the int value of a constant argument. */
+  int64_t GetIntArg(const Expr& arg) {
+    return arg.as<ConstantNode>()->value.as<IntValueObj>()->value;
+  }
+
+  /*!
+   * \brief Get the latency in microseconds of an invoke_op, as well as its name, its kind ("comp"
+   * or "comm") and the source of the latency ("profile", "comm_model" or "analytical").
+   */
+  double GetLatency(const CallNode* call, std::string* name, std::string* kind,
+                    std::string* source) {
+    auto callee_op = let_map_[Downcast<Var>(call->args[0])];
+    auto inputs = Downcast<Tuple>(let_map_[Downcast<Var>(call->args[1])])->fields;
+    auto outputs = Downcast<Tuple>(let_map_[Downcast<Var>(call->args[2])])->fields;
+    if (const auto* op = callee_op.as<OpNode>()) {
+      *name = NormalizeName(GetBaseName(GetRef<Op>(op)), false);
+    } else if (const auto* func = callee_op.as<FunctionNode>()) {
+      *name = NormalizeName(FusedNameGetter().Get(GetRef<Function>(func)), false);
+    } else {
+      *name = "unknown";
+    }
+    *kind = IsCollectiveOp(callee_op) ? "comm" : "comp";
+
+    auto it = profiled_.find(*name + "@" + GetSignature(inputs, outputs));
+    if (it != profiled_.end()) {
+      *source = "profile";
+      return it->second;
+    }
+    auto callee = pass::InferType(Call(callee_op, inputs));
+    auto profiler = op_profiler::AnalyticalOpProfiler::Get(device_);
+    if (*kind == "comm") {
+      auto latency = profiler->ProfileOp(callee, 0, 0, 1).first[0];
+      if (distributed::CommCostModel::Get()->Estimate(Downcast<Call>(callee)) >= 0) {
+        *source = "comm_model";
+      } else {
+        LOG(WARNING) << "The collective " << *name << " is not calibrated, so its latency is "
+                     << "estimated by the device throughput. See raf.distributed.comm_cost.";
+        *source = "analytical";
+      }
+      return latency;
+    }
+    *source = "analytical";
+    return profiler->ProfileOp(callee, 0, 0, 1).first[0];
+  }
+
+  /*! \brief Let binding vars to the expression. */
+  Map<Var, Expr> let_map_;
+  /*! \brief the explicit let list of func_ */
+  std::unique_ptr<ExplicitLetList> ell_{nullptr};
+  /*! \brief The target device of the analytical cost model. */
+  Device device_;
+  /*! \brief The mean profiled latency keyed by "<normalized name>@<signature>". */
+  std::unordered_map<std::string, double> profiled_;
+  /*! \brief The time of the latest stream barrier. */
+  double barrier_ = 0;
+  /*! \brief The simulated ops. */
+  StepTrace trace_;
+};
+
+}  // namespace simulate_step
+
+/*!
+ * \brief Simulate the ops of the main function of an after ManifestAlloc module on virtual streams.
+ * \param mod The module.
+ * \param device The device of the analytical cost model for the ops that are not profiled.
+ * \param profiled The profiled latencies in microseconds keyed by "<OpEnv name>@<signature>".
+ * \return The simulated ops of [name, stream_id, start_us, latency_us, kind, source].
+ */
+simulate_step::StepTrace SimulateStep(const IRModule& mod, const Device& device,
+                                      Map<String, FloatImm> profiled) {
+  auto entry = mod->GetGlobalVar("main");
+  auto func = Downcast<Function>(mod->Lookup(entry));
+  return simulate_step::StepSimulator(device, func, profiled).Run();
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.SimulateStep").set_body_typed(SimulateStep);
+
+}  // namespace pass
+}  // namespace raf
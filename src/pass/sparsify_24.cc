@@ -0,0 +1,131 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file sparsify_24.cc
+ * \brief Rewrite the dense ops whose weights are 2:4 sparse into sparse24_dense, which runs on the
+ * sparse tensor cores.
+ */
+#include <string>
+#include <unordered_set>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace sparsify_24 {
+
+using namespace raf::ir;
+using namespace raf::op;
+
+/*! \brief Whether the argument is a 2-D tensor in float16 or bfloat16. */
+inline bool Is16BitMatrix(const Expr& expr) {
+  const auto* ttype = expr->checked_type().as<TensorTypeNode>();
+  return ttype != nullptr && ttype->shape.size() == 2 &&
+         (ttype->dtype == DataType::Float(16) || ttype->dtype == DataType::BFloat(16));
+}
+
+/*!
+ * \brief Rewrite the dense and matmul_nt ops in main, whose weights are parameters of main or
+ * constants, into sparse24_dense. If prune is set, the weights are pruned to 2:4 by prune_24, which
+ * FoldConstant folds for the bound weights; otherwise they should have been pruned. For example:
+ *   let %a = raf.op.dense(%x, %w);
+ *
+ * becomes (with prune):
+ *   let %w_0 = raf.op.prune_24(%w);
+ *   let %a = raf.op.sparse24_dense(%x, %w_0);
+ *
+ * Only the 16-bit operands are rewritten, since the sparse tensor cores have no float32 path
+ * other than TF32, which would change the precision of the model. matmul, whose weight is in
+ * [K, N], is not rewritten, because the sparsity has to be along K of the rows of the weight.
+ */
+class Sparsifier {
+ public:
+  Sparsifier(const Function& func, bool prune) : func_(func), prune_(prune) {
+  }
+
+  Function Run() {
+    static const Op& dense_op = Op::Get("raf.op.dense");
+    static const Op& matmul_nt_op = Op::Get("raf.op.matmul_nt");
+    static const Op& sparse_op = Op::Get("raf.op.sparse24_dense");
+    static const Op& prune_op = Op::Get("raf.op.prune_24");
+    if (!func_->body.as<LetNode>()) {
+      return func_;
+    }
+    std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> params(func_->params.begin(),
+                                                                  func_->params.end());
+    auto ell = ExplicitLetList::make(func_->body);
+    LetList ll;
+    int num_rewritten = 0;
+    for (size_t i = 0; i < ell->exprs.size(); ++i) {
+      const auto* call = ell->exprs[i].as<CallNode>();
+      if (call == nullptr || !(call->op.same_as(dense_op) || call->op.same_as(matmul_nt_op))) {
+        ll.Push(ell->vars[i], ell->exprs[i]);
+        continue;
+      }
+      const Expr& x = call->args[0];
+      Expr w = call->args[1];
+      const auto* w_var = w.as<VarNode>();
+      bool is_weight = w.as<ConstantNode>() || (w_var && params.count(GetRef<Var>(w_var)));
+      if (!is_weight || !Is16BitMatrix(x) || !Is16BitMatrix(w) || !IsReducible(w)) {
+        ll.Push(ell->vars[i], ell->exprs[i]);
+        continue;
+      }
+      if (prune_) {
+        w = ll.Push(Call(prune_op, {w}));
+      }
+      ll.Push(ell->vars[i], Call(sparse_op, {x, w}));
+      ++num_rewritten;
+    }
+    Expr body = ll.Get(ell->ret);
+    DLOG(INFO) << "Rewrote " << num_rewritten << " dense ops into sparse24_dense";
+    return Function(func_->params, body, func_->ret_type, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Whether the reduction dim of the weight in [N, K] is a multiple of the groups. */
+  static bool IsReducible(const Expr& w) {
+    const auto* ttype = w->checked_type().as<TensorTypeNode>();
+    const auto* k = ttype->shape[1].as<IntImmNode>();
+    return k != nullptr && k->value % 4 == 0;
+  }
+
+  /*! \brief The function to be sparsified. */
+  Function func_;
+  /*! \brief Whether to prune the weights to 2:4. */
+  bool prune_;
+};
+
+}  // namespace sparsify_24
+
+Pass Sparsify24() {
+  PassContext pass_ctx = PassContext::Current();
+  String mode = pass_ctx->GetConfig("raf.sparsity_24", String("none")).value();
+  CHECK(mode == "none" || mode == "pruned" || mode == "prune")
+      << "Unsupported 2:4 sparsity mode: " << mode
+      << ". Expected one of \"none\", \"pruned\", and \"prune\"";
+  TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule m, PassContext pc) {
+    if (mode == "none") {
+      return m;
+    }
+    auto main = m->GetGlobalVar("main");
+    auto func = sparsify_24::Sparsifier(Downcast<Function>(m->Lookup(main)), mode == "prune").Run();
+    auto new_mod = IRModule(m->functions);
+    new_mod->Add(main, func, true);
+    return new_mod;
+  };
+  auto sparsify = CreateModulePass(pass_func, 0, "Sparsify24Helper", {});
+  return RAFSequential({InferType(), sparsify, InferType()}, "Sparsify24");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.Sparsify24").set_body_typed(Sparsify24);
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.sparsity_24", String);
+
+}  // namespace pass
+}  // namespace raf
@@ -9,6 +9,7 @@
  */
 #pragma once
 #include "raf/ir.h"
+#include "raf/pass.h"
 #include "./let_list.h"
 
 namespace raf {
@@ -65,11 +66,18 @@ class StreamSchedulerBase : public ExprMutator {
   }
 
  protected:
-  Expr AnnotateSetStream(int64_t device_id, int64_t stream_id) {
+  /*!
+   * \brief Annotate a set_stream. The priority is only passed when it is not the default one, so
+   * the stream is used as is otherwise.
+   */
+  Expr AnnotateSetStream(int64_t device_id, int64_t stream_id, int64_t priority = 0) {
     static Op op = Op::Get("raf.op.set_stream");
     Expr device_id_e = MakeConstant(value::ScalarValue::make(device_id));
     Expr stream_id_e = MakeConstant(value::ScalarValue::make(stream_id));
     Array<Expr> args({device_id_e, stream_id_e});
+    if (priority != 0) {
+      args.push_back(MakeConstant(value::ScalarValue::make(priority)));
+    }
     return let_list_.Push(Call(op, args));
   }
 
@@ -95,6 +103,15 @@ class StreamSchedulerBase : public ExprMutator {
   LetList let_list_;
 };
 
+/*!
+ * \brief Whether the stream schedulers assign high priorities to the streams of the communication
+ * and the critical path, which is configured by "raf.stream_schedule.use_priority".
+ */
+inline bool UseStreamPriority() {
+  auto pass_ctx = tvm::transform::PassContext::Current();
+  return pass_ctx->GetConfig("raf.stream_schedule.use_priority", tvm::Bool(false)).value();
+}
+
 }  // namespace stream_schedule
 }  // namespace pass
 }  // namespace raf
@@ -8,8 +8,11 @@
  * \brief ASAP (As Soon As Possible) stream scheduler.
  */
 #include <relay/transforms/pass_utils.h>
+#include <numeric>
 #include "raf/pass.h"
 #include "raf/analysis.h"
+#include "raf/op_utils.h"
+#include "raf/stream_pool.h"
 #include "./stream_schedule.h"
 
 namespace raf {
@@ -18,7 +21,6 @@ namespace asap_stream_schedule {
 
 using namespace raf::analysis;
 using stream_schedule::StreamSchedulerBase;
-using Node = DependencyGraph::Node;
 
 class ASAPScheduler : public StreamSchedulerBase {
  public:
@@ -42,39 +44,41 @@ class ASAPScheduler : public StreamSchedulerBase {
    *    cuda stream to launch heavy chain B. For each node that has light parents, we will add an
    *    event for that node. Before we launch a node with light children, we will wait for the
    *    events of light children.
+   *
+   * 4. If "raf.stream_schedule.use_priority" is set, the streams launching the collectives and the
+   *    critical path (i.e., the path with the maximum depth) get the high priority, so that the
+   *    kernels on them are not delayed by the kernels of the other chains when the device is full.
    */
   Expr Schedule(const Expr& e) {
     // Initialize dependency graph of e
     InitDependencyGraph(e);
 
+    // Assign the streams and find the events to wait before issuing anything, so that only the
+    // events that are waited for are added.
+    std::vector<int> schedule_order = GetScheduleOrder();
+    std::unordered_map<int, int> node_stream;
+    std::unordered_map<int, std::vector<int>> wait_children;
+    std::unordered_set<int> need_event;
+    AssignStreams(schedule_order, &node_stream, &wait_children, &need_event);
+    std::unordered_map<int, int> stream_priority;
+    if (stream_schedule::UseStreamPriority()) {
+      stream_priority = AssignPriorities(node_stream);
+    }
+
     // Start to schedule
     int event_id_clock = 0;
-    std::unordered_map<Node*, int> finish_event;
-    std::unordered_map<Node*, int> node_stream;
-    std::vector<Node*> schedule_order = GetScheduleOrder();
+    std::unordered_map<int, int> finish_event;
     for (size_t i = 0; i < schedule_order.size(); i++) {
       auto node = schedule_order[i];
-
-      // Get the stream to launch this node
-      int stream_id;
-      if (info_[node].heavy_child) {
-        stream_id = node_stream[info_[node].heavy_child];
-      } else {
-        stream_id = GetNewStream(node);
-      }
-      node_stream[node] = stream_id;
+      int stream_id = node_stream[node];
 
       // Annotate SetStream when it is the first node or last issued node is not its heavy child
       if (i == 0 || schedule_order[i - 1] != info_[node].heavy_child) {
-        AnnotateSetStream(0, stream_id);
+        AnnotateSetStream(0, stream_id, stream_priority[stream_id]);
       }
 
       // Wait dependent events
-      for (auto iit = node->children.head; iit; iit = iit->next) {
-        Node* child = iit->value;
-        if (child == info_[node].heavy_child) {
-          continue;
-        }
+      for (int child : wait_children[node]) {
         CHECK_GT(finish_event.count(child), 0);
         AnnotateWaitEvent(finish_event[child]);
       }
@@ -82,16 +86,11 @@ class ASAPScheduler : public StreamSchedulerBase {
       // Issue this node
       VisitExpr(info_[node].expr);
 
-      // Annotate AddEvent if current node has light parents
-      if (info_[node].num_parents - (info_[node].heavy_parent != nullptr) > 0) {
+      // Annotate AddEvent if a light parent of current node waits for it
+      if (need_event.count(node)) {
         finish_event[node] = event_id_clock++;
         AnnotateAddEvent(finish_event[node]);
       }
-
-      // Mark this node as the last node in stream_id if it does not have heavy parent
-      if (!info_[node].heavy_parent) {
-        SetStreamLastNode(stream_id, node);
-      }
     }
 
     return let_list_.Get(VisitExpr(e));
@@ -111,40 +110,31 @@ class ASAPScheduler : public StreamSchedulerBase {
    * of each path starting from that node.
    */
   void InitDependencyGraph(Expr e) {
-    dg_ = CreateDependencyGraph(&arena_, e, true, true);
-
-    // Get the expression of each node
-    for (auto& it : dg_.expr_node) {
-      const Node* node;
-      Expr expr;
-      std::tie(expr, node) = it;
-      info_[node].expr = expr;
-    }
+    dg_ = CompactDependencyGraph::Create(e, true, true);
+    info_.resize(dg_.size());
 
-    // Get the depth and number of parents of each node.
-    for (size_t i = dg_.post_dfs_order.size(); i != 0; i--) {
-      Node* node = dg_.post_dfs_order[i - 1];
+    // Get the expression, the depth and number of parents of each node.
+    for (int node = dg_.size() - 1; node >= 0; node--) {
+      info_[node].expr = dg_.GetExpr(node);
       info_[node].depth = 1;
-      info_[node].num_parents = 0;
-      for (auto iit = node->parents.head; iit; iit = iit->next) {
-        auto parent = iit->value;
+      info_[node].num_parents = static_cast<int>(dg_.Parents(node).size());
+      for (int parent : dg_.Parents(node)) {
         info_[node].depth = std::max(info_[node].depth, info_[parent].depth + 1);
-        info_[node].num_parents += 1;
       }
     }
 
     // Sort the nodes in descending order, taking node depth as comparison key
-    std::vector<Node*> depth_order(dg_.post_dfs_order);
-    auto node_compare_dec = [&](const Node* lhs, const Node* rhs) {
+    std::vector<int> depth_order(dg_.size());
+    std::iota(depth_order.begin(), depth_order.end(), 0);
+    auto node_compare_dec = [&](int lhs, int rhs) {
       return this->info_[lhs].depth > this->info_[rhs].depth;
     };
     std::sort(depth_order.begin(), depth_order.end(), node_compare_dec);
 
     // Determine the heavy parent and heavy child of each node, if exists
     for (auto node : depth_order) {
-      for (auto iit = node->children.head; iit; iit = iit->next) {
-        Node* child = iit->value;
-        if (info_[child].heavy_parent == nullptr) {
+      for (int child : dg_.Children(node)) {
+        if (info_[child].heavy_parent < 0) {
           info_[child].heavy_parent = node;
           info_[node].heavy_child = child;
           break;
@@ -157,36 +147,31 @@ class ASAPScheduler : public StreamSchedulerBase {
    * \brief Get a schedule order. Any topological order of the dependency graph is a valid order.
    * Here we implement an order that tries to minimize the number of SetStream operators.
    */
-  std::vector<Node*> GetScheduleOrder() {
+  std::vector<int> GetScheduleOrder() {
     // Get all ready-to-execute nodes
-    std::unordered_map<Node*, int> out_degree;
-    for (auto node : dg_.post_dfs_order) {
-      for (auto iit = node->children.head; iit; iit = iit->next) {
-        out_degree[node]++;
-      }
-    }
-    std::vector<Node*> stack;
-    for (auto node : dg_.post_dfs_order) {
+    std::vector<int> out_degree(dg_.size());
+    std::vector<int> stack;
+    for (int node = 0; node < dg_.size(); ++node) {
+      out_degree[node] = static_cast<int>(dg_.Children(node).size());
       if (out_degree[node] == 0) {
         stack.push_back(node);
       }
     }
-    auto node_compare_inc = [&](const Node* lhs, const Node* rhs) {
+    auto node_compare_inc = [&](int lhs, int rhs) {
       return this->info_[lhs].depth < this->info_[rhs].depth;
     };
     // We first launch operator with larger depth
     std::sort(stack.begin(), stack.end(), node_compare_inc);
-    std::vector<Node*> schedule_order;
+    std::vector<int> schedule_order;
 
     // Push each node into schedule_order until all nodes have been pushed.
     while (!stack.empty()) {
-      Node* node = stack.back();
+      int node = stack.back();
       stack.pop_back();
       schedule_order.push_back(node);
 
       // Push new available nodes.
-      for (auto iit = node->parents.head; iit; iit = iit->next) {
-        Node* parent = iit->value;
+      for (int parent : dg_.Parents(node)) {
         if (parent == info_[node].heavy_parent) {
           // process heavy parent outside the loop
           continue;
@@ -196,7 +181,7 @@ class ASAPScheduler : public StreamSchedulerBase {
         }
       }
       std::sort(stack.begin(), stack.end(), node_compare_inc);
-      if (info_[node].heavy_parent) {
+      if (info_[node].heavy_parent >= 0) {
         if (--out_degree[info_[node].heavy_parent] == 0) {
           // If current node has heavy parent, and all its dependent nodes have been executed,
           // put it at the end of stack to avoid stream switch (i.e. calling SetStream).
@@ -207,45 +192,139 @@ class ASAPScheduler : public StreamSchedulerBase {
     return schedule_order;
   }
 
+  /*!
+   * \brief Assign the stream of each node in the schedule order, and find the light children each
+   * node waits for. The waits implied by the previous waits are skipped: we track a vector clock of
+   * each stream, i.e., the last issued position on every stream that is known to finish before the
+   * next node of the stream, so waiting for a light child is redundant if the child is on the same
+   * stream or has already been covered by the clock through the stream order and the earlier
+   * waits. A node needs an event only if some node waits for it.
+   */
+  void AssignStreams(const std::vector<int>& schedule_order,
+                     std::unordered_map<int, int>* node_stream,
+                     std::unordered_map<int, std::vector<int>>* wait_children,
+                     std::unordered_set<int>* need_event) {
+    using VectorClock = std::unordered_map<int, int>;
+    std::unordered_map<int, VectorClock> stream_clock;
+    std::unordered_map<int, VectorClock> node_clock;
+    for (int pos = 0; pos < static_cast<int>(schedule_order.size()); ++pos) {
+      int node = schedule_order[pos];
+
+      // Get the stream to launch this node
+      int stream_id;
+      if (info_[node].heavy_child >= 0) {
+        stream_id = node_stream->at(info_[node].heavy_child);
+      } else {
+        stream_id = GetNewStream(node);
+      }
+      (*node_stream)[node] = stream_id;
+
+      // Wait for the latest light children first, which are the most likely to cover the others.
+      std::vector<int> light_children;
+      for (int child : dg_.Children(node)) {
+        if (child != info_[node].heavy_child) {
+          light_children.push_back(child);
+        }
+      }
+      std::sort(light_children.begin(), light_children.end(),
+                [this](int lhs, int rhs) { return issue_pos_[lhs] > issue_pos_[rhs]; });
+      VectorClock& clock = stream_clock[stream_id];
+      for (int child : light_children) {
+        int child_stream = node_stream->at(child);
+        auto it = clock.find(child_stream);
+        if (child_stream == stream_id || (it != clock.end() && it->second >= issue_pos_[child])) {
+          // The child is known to finish before this node.
+          continue;
+        }
+        (*wait_children)[node].push_back(child);
+        need_event->insert(child);
+        for (const auto& kv : node_clock[child]) {
+          auto jt = clock.find(kv.first);
+          if (jt == clock.end() || jt->second < kv.second) {
+            clock[kv.first] = kv.second;
+          }
+        }
+      }
+      clock[stream_id] = pos;
+      issue_pos_[node] = pos;
+      node_clock[node] = clock;
+
+      // Mark this node as the last node in stream_id if it does not have heavy parent
+      if (info_[node].heavy_parent < 0) {
+        SetStreamLastNode(stream_id, node);
+      }
+    }
+  }
+
+  /*!
+   * \brief Assign the high priority to the streams launching the collectives or the nodes on the
+   * critical path, which goes from the source with the maximum depth through the parents whose
+   * depth is one less. The other streams keep the default priority.
+   */
+  std::unordered_map<int, int> AssignPriorities(const std::unordered_map<int, int>& node_stream) {
+    std::unordered_map<int, int> stream_priority;
+    int node = -1;
+    for (int i = 0; i < static_cast<int>(dg_.size()); ++i) {
+      if (node < 0 || info_[i].depth > info_[node].depth) {
+        node = i;
+      }
+      auto call = info_[i].expr.as<CallNode>();
+      if (call && op::IsCollectiveOp(call->op)) {
+        stream_priority[node_stream.at(i)] = stream_pool::kHighPriority;
+      }
+    }
+    while (node >= 0) {
+      stream_priority[node_stream.at(node)] = stream_pool::kHighPriority;
+      int next = -1;
+      for (int parent : dg_.Parents(node)) {
+        if (info_[parent].depth + 1 == info_[node].depth) {
+          next = parent;
+          break;
+        }
+      }
+      node = next;
+    }
+    return stream_priority;
+  }
+
   /*!
    * \brief Get a new stream to launch given node. We first try to find an existing stream such that
    * the last node of that stream can reach given node. This means we can reuse this stream without
    * sacrifice any performance degradation. If we can not find such a stream, we allocate a new
    * stream.
    */
-  int GetNewStream(Node* node) {
+  int GetNewStream(int node) {
     for (auto kv : stream_last_node_) {
-      if (kv.second == nullptr) {
+      if (kv.second < 0) {
         // There are nodes on this stream not been issued.
         continue;
       }
       CHECK_GE(ancestors_.count(kv.second), 1);
       if (ancestors_[kv.second].count(node)) {
-        stream_last_node_[kv.first] = nullptr;
+        stream_last_node_[kv.first] = -1;
         ancestors_[kv.second].clear();
         return kv.first;
       }
     }
     // Allocate a new stream
     int stream_id = static_cast<int>(stream_last_node_.size()) + 1;
-    stream_last_node_[stream_id] = nullptr;
+    stream_last_node_[stream_id] = -1;
     return stream_id;
   }
   /*!
    * \brief Mark node as the last node in given stream. We compute all ancestors of given node,
    * which helps to determine whether we can reuse this stream when we need new stream.
    */
-  void SetStreamLastNode(int stream_id, Node* node) {
+  void SetStreamLastNode(int stream_id, int node) {
     stream_last_node_[stream_id] = node;
-    std::unordered_set<Node*>& ancestors = ancestors_[node];
-    std::vector<Node*> qu;
+    std::unordered_set<int>& ancestors = ancestors_[node];
+    std::vector<int> qu;
     qu.push_back(node);
     ancestors.insert(node);
     while (!qu.empty()) {
-      Node* nd = qu.back();
+      int nd = qu.back();
       qu.pop_back();
-      for (auto iit = nd->parents.head; iit; iit = iit->next) {
-        Node* parent = iit->value;
+      for (int parent : dg_.Parents(nd)) {
         if (!ancestors.count(parent)) {
           qu.push_back(parent);
           ancestors.insert(parent);
@@ -261,23 +340,23 @@ class ASAPScheduler : public StreamSchedulerBase {
     int depth{};
     /*! \brief The number of parents. */
     int num_parents{};
-    /*! \brief The heavy parent of the node, may be nullptr if it does not exist. */
-    Node* heavy_parent{};
-    /*! \brief The heavy child of the node, may be nullptr if it does not exist. */
-    Node* heavy_child{};
+    /*! \brief The heavy parent of the node, may be -1 if it does not exist. */
+    int heavy_parent{-1};
+    /*! \brief The heavy child of the node, may be -1 if it does not exist. */
+    int heavy_child{-1};
   };
-  /*! \brief Arena used to allocate memory for dependency graph. */
-  Arena arena_;
   /*! \brief Dependency graph of given expr. */
-  DependencyGraph dg_;
+  CompactDependencyGraph dg_;
   /*! \brief The info for each node. */
-  std::unordered_map<const Node*, NodeInfo> info_;
+  std::vector<NodeInfo> info_;
   /*! \brief The last node of each stream. If we have not issues all nodes in the stream, the value
-   * of the stream in this map is nullptr. Used for stream allocation and recycle. */
-  std::unordered_map<int, Node*> stream_last_node_;
+   * of the stream in this map is -1. Used for stream allocation and recycle. */
+  std::unordered_map<int, int> stream_last_node_;
   /*! \brief All ancestors of a node in the dependency graph. Used for stream allocation and
    * recycle. */
-  std::unordered_map<Node*, std::unordered_set<Node*>> ancestors_;
+  std::unordered_map<int, std::unordered_set<int>> ancestors_;
+  /*! \brief The position of each issued node in the schedule order. */
+  std::unordered_map<int, int> issue_pos_;
 };
 
 Expr ASAPStreamSchedule(const Expr& e) {
@@ -298,6 +377,7 @@ Pass ASAPStreamSchedule() {
 
 RAF_REGISTER_GLOBAL("raf.pass_.ASAPStreamSchedule").set_body_typed(ASAPStreamSchedule);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.policy", tvm::String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.use_priority", tvm::Bool);
 
 }  // namespace pass
 }  // namespace raf
@@ -9,8 +9,10 @@
  *  Reference: IOS: Inter Operator Scheduler for CNN Acceleration (MLSys 2021).
  */
 #include <chrono>
+#include <map>
 #include <utility>
 #include <thread>
+#include <dmlc/common.h>
 #include <relay/transforms/pass_utils.h>
 #include <tvm/runtime/device_api.h>
 #include "raf/pass.h"
@@ -22,6 +24,7 @@
 #include "./stream_schedule.h"
 #include "../requests.h"
 #include "../analysis/dependency_graph.h"
+#include "../common/shape_utils.h"
 
 #ifdef RAF_USE_CUDA
 #include "../common/cuda_utils.h"
@@ -47,6 +50,13 @@ using requests::Requests;
 using stream_schedule::StreamSchedulerBase;
 using Node = DependencyGraph::Node;
 
+constexpr float kMegaBytes = 1048576;
+/*!
+ * \brief The latency penalty of each MB exceeding the memory budget. It is large enough to make
+ * any stage within the budget preferable to the stages exceeding it.
+ */
+constexpr float kOverBudgetPenaltyPerMB = 1e6;
+
 /*!
  * \brief Get a integer with ones in the least significant bits and zeros in the other bits.
  * \param num_ones The number of ones.
@@ -59,6 +69,25 @@ uint64_t GetLeastSignificantOnes(size_t num_ones) {
   return state;
 }
 
+/*!
+ * \brief Get the size in bytes of a tensor or a tuple of tensors. Others (e.g., functions) and
+ * tensors with dynamic shapes are considered as 0.
+ * \param type The type to calculate the size of.
+ * \return The size in bytes.
+ */
+int64_t GetTypeBytes(const Type& type) {
+  if (const auto* tuple_type = type.as<TupleTypeNode>()) {
+    int64_t total_size = 0;
+    for (const auto& field : tuple_type->fields) {
+      total_size += GetTypeBytes(field);
+    }
+    return total_size;
+  } else if (const auto* tensor_type = type.as<TensorTypeNode>()) {
+    return common::shape_utils::BytesCompactTensor(tensor_type);
+  }
+  return 0;
+}
+
 /*!
  * \brief Count the number of one bits in an unsigned 64-bit integer.
  * \param v The given integer.
@@ -73,6 +102,35 @@ inline int CountOneBits(uint64_t v) {
   return c;
 }
 
+/*!
+ * \brief Get the structural signature of an expression, which determines the kernel it launches:
+ * the callee (fused functions are compared structurally), the constant arguments, and the types of
+ * the other arguments and the output. The expressions with the same signature at different places
+ * of the model (e.g., in the repeated layers) have the same latency.
+ * \param expr The expression.
+ * \return The signature.
+ */
+uint64_t GetExprSignature(const Expr& expr) {
+  size_t hash = tvm::StructuralHash()(expr->checked_type());
+  if (const auto* call = expr.as<CallNode>()) {
+    if (const auto* op_node = call->op.as<OpNode>()) {
+      hash = dmlc::HashCombine(hash, op_node->name);
+    } else {
+      hash = dmlc::HashCombine(hash, tvm::StructuralHash()(call->op));
+    }
+    for (const auto& arg : call->args) {
+      if (arg->IsInstance<RelayConstantNode>()) {
+        hash = dmlc::HashCombine(hash, std::string(raf::ir::AsText(arg, false)));
+      } else {
+        hash = dmlc::HashCombine(hash, tvm::StructuralHash()(arg->checked_type()));
+      }
+    }
+  } else if (const auto* tuple_get_item = expr.as<TupleGetItemNode>()) {
+    hash = dmlc::HashCombine(hash, tuple_get_item->index);
+  }
+  return hash;
+}
+
 #ifdef RAF_USE_CUDA
 /*!
  * \brief The cost model of IOS scheduler. It profile the latency of IOS proposed stage on device.
@@ -107,7 +165,7 @@ class IOSCostModel {
     this->warmup_ = warmup;
     this->number_ = number;
     this->repeat_ = repeat;
-    this->profiler_ = op_profiler::OpProfiler::Get(device);
+    this->profiler_ = op_profiler::OpProfiler::GetCostModel(device);
   }
 
   /*!
@@ -129,6 +187,15 @@ class IOSCostModel {
     return prof_res.first;
   }
 
+  /*!
+   * \brief Build the ops concurrently and profile each of them, so that the stages consisting of
+   * them are profiled without building the ops again.
+   * \param exprs The ops to be built.
+   */
+  void Prebuild(const std::vector<Expr>& exprs) {
+    profiler_->ProfileOps(exprs, warmup_, number_, repeat_);
+  }
+
  private:
   /*The following data are configs. */
 
@@ -152,6 +219,8 @@ class IOSCostModel {
   std::vector<float> StageLatency(const std::vector<std::vector<Expr>>& groups) {
     return {};
   }
+  void Prebuild(const std::vector<Expr>& exprs) {
+  }
 };
 #endif
 
@@ -195,16 +264,24 @@ class IOSScheduler : public StreamSchedulerBase {
    * \param number The number of executions as a repeat.
    * \param repeat The number of repeat times.
    * \param verbose Whether print the verbose message during scheduling.
+   * \param memory_budget The memory budget in MBs. When it is positive, the stages whose peak
+   * memory exceeds the budget are penalized, so the scheduler prefers the stages within the
+   * budget even if they are slower. 0 means no memory constraint.
+   * \param time_budget The time budget in milliseconds of the exact dynamic programming of a block.
+   * The blocks exceeding it are scheduled by beam search instead. 0 means no time limit.
+   * \param beam_width The number of states kept in each step of the beam search.
    */
   explicit IOSScheduler(Device device, int max_block_size = 20, int max_stream_num = 5,
                         int max_stage_ops = 10, bool search_group_combination = true,
                         Array<Array<Op>> schedule_units = {}, int warmup = 2, int number = 5,
-                        int repeat = 5, bool verbose = false)
+                        int repeat = 5, bool verbose = false, int memory_budget = 0,
+                        int time_budget = 0, int beam_width = 8)
       : cost_model_(device, warmup, number, repeat), verbose_(this, verbose) {
     CHECK_GE(max_stream_num, 1) << "Stream number must be greater or equal to 1, but got "
                                 << max_stream_num;
     CHECK_LE(max_block_size, 64) << "Only support maximum block size less or equal to 64, but got "
                                  << max_block_size;
+    CHECK_GE(beam_width, 1) << "Beam width must be greater or equal to 1, but got " << beam_width;
     for (int i = 0; i < schedule_units.size(); i++) {
       CHECK_GE(schedule_units[i].size(), 2)
           << "Each schedule unit must have at least two operators, but got " << schedule_units[i];
@@ -215,6 +292,9 @@ class IOSScheduler : public StreamSchedulerBase {
     config_.max_stage_ops = max_stage_ops;
     config_.search_group_combination = search_group_combination;
     config_.schedule_units = std::move(schedule_units);
+    config_.memory_budget = static_cast<int64_t>(memory_budget) * kMegaBytes;
+    config_.time_budget = time_budget;
+    config_.beam_width = beam_width;
   }
 
   /*!
@@ -234,6 +314,24 @@ class IOSScheduler : public StreamSchedulerBase {
       LOG_PRINTF("Found %zu schedule units in %zu blocks: %s", graph_.all_nodes.size(),
                  blocks_.size(), ss.str().c_str());
     }
+    if (config_.memory_budget > 0) {
+      InitMemoryInfo();
+    }
+    FindIdenticalBlocks();
+
+    // Build all operators to be scheduled at once, instead of one by one when profiling stages.
+    std::vector<Expr> exprs;
+    for (auto& block : blocks_) {
+      if (block.identical_block >= 0) {
+        continue;
+      }
+      for (Node* node : block.nodes) {
+        for (Expr expr : graph_.node_unit[node]) {
+          exprs.push_back(expr);
+        }
+      }
+    }
+    cost_model_.Prebuild(exprs);
 
     auto stages = ScheduleBlocks();
 
@@ -456,6 +554,131 @@ class IOSScheduler : public StreamSchedulerBase {
     }
   }
 
+  /*!
+   * \brief Initialize the memory information of each block, which is used to estimate the peak
+   * memory of a stage. The output of a schedule unit is alive from the stage that produces it to
+   * the stage of its last user. Outputs of the function are alive until the end.
+   */
+  void InitMemoryInfo() {
+    int num_blocks = static_cast<int>(blocks_.size());
+    std::unordered_map<const Node*, int> node_block;
+    for (int i = 0; i < num_blocks; i++) {
+      for (Node* node : blocks_[i].nodes) {
+        node_block[node] = i;
+      }
+    }
+
+    for (Node* node : graph_.all_nodes) {
+      int64_t bytes = 0;
+      for (const auto& expr : graph_.node_unit[node]) {
+        if (expr->checked_type_.defined()) {
+          bytes += GetTypeBytes(expr->checked_type());
+        }
+      }
+      if (bytes == 0) {
+        continue;
+      }
+      int block_id = node_block[node];
+      // The last block that uses this node. Nodes without users are the outputs.
+      int last_block = (node->parents.head == nullptr) ? num_blocks : block_id;
+      std::unordered_map<int, State> block_users;
+      for (auto iit = node->parents.head; iit; iit = iit->next) {
+        Node* parent = iit->value;
+        if (node_block.count(parent) == 0) {
+          continue;
+        }
+        int user_block = node_block[parent];
+        last_block = std::max(last_block, user_block);
+        block_users[user_block] |= State(1) << blocks_[user_block].node_index[parent];
+      }
+
+      BlockInfo& block = blocks_[block_id];
+      int index = block.node_index[node];
+      block.node_bytes[index] = bytes;
+      block.node_users[index] = block_users[block_id];
+      block.node_escapes[index] = last_block > block_id;
+      for (int i = block_id + 1; i < last_block; i++) {
+        blocks_[i].resident_bytes += bytes;
+      }
+      if (last_block > block_id && last_block < num_blocks) {
+        blocks_[last_block].input_bytes.emplace_back(bytes, block_users[last_block]);
+      }
+    }
+  }
+
+  /*!
+   * \brief Find the earlier block that is structurally identical to each block, e.g., the repeated
+   * layers of a transformer, so the block reuses its schedule instead of being scheduled again.
+   * Two blocks are identical if their nodes in order have the same signatures and the same edges
+   * inside the block. Blocks are not reused with a memory budget, since the memory of a stage also
+   * depends on the tensors alive across the blocks.
+   */
+  void FindIdenticalBlocks() {
+    if (config_.memory_budget > 0) {
+      return;
+    }
+    std::map<std::vector<uint64_t>, int> signature_block;
+    int num_reused = 0;
+    for (int i = 0; i < blocks_.size(); i++) {
+      BlockInfo& block = blocks_[i];
+      std::vector<uint64_t> signature;
+      for (Node* node : block.nodes) {
+        const auto& unit = graph_.node_unit[node];
+        signature.push_back(unit.size());
+        for (const auto& expr : unit) {
+          signature.push_back(GetExprSignature(expr));
+        }
+        std::vector<uint64_t> parents;
+        for (auto iit = node->parents.head; iit; iit = iit->next) {
+          if (block.node_index.count(iit->value)) {
+            parents.push_back(block.node_index[iit->value]);
+          }
+        }
+        std::sort(parents.begin(), parents.end());
+        signature.push_back(parents.size());
+        signature.insert(signature.end(), parents.begin(), parents.end());
+      }
+      auto it = signature_block.emplace(std::move(signature), i);
+      if (!it.second) {
+        block.identical_block = it.first->second;
+        num_reused++;
+      }
+    }
+    if (verbose_.on && num_reused > 0) {
+      LOG_PRINTF("Reuse the schedules of %d blocks identical to the previous ones.", num_reused);
+    }
+  }
+
+  /*!
+   * \brief Estimate the peak memory of a stage. Before the stage, the alive tensors are the ones
+   * produced by the scheduled operators and used by the remaining operators (or the outputs). As
+   * the groups in the stage run concurrently, we conservatively consider all outputs of the stage
+   * to be alive at the same time.
+   * \param block_id The block index.
+   * \param state The remaining operators before the stage.
+   * \param decision The operators in the stage.
+   * \return The estimated peak memory in bytes.
+   */
+  int64_t GetStagePeakMemory(int block_id, State state, Decision decision) {
+    const BlockInfo& block = blocks_[block_id];
+    int64_t bytes = block.resident_bytes;
+    for (const auto& pr : block.input_bytes) {
+      if (pr.second & state) {
+        bytes += pr.first;
+      }
+    }
+    for (const auto& pr : block.node_bytes) {
+      int index = pr.first;
+      if ((decision >> index) & 1) {
+        bytes += pr.second;
+      } else if (((state >> index) & 1) == 0 &&
+                 ((block.node_users.at(index) & state) || block.node_escapes.at(index))) {
+        bytes += pr.second;
+      }
+    }
+    return bytes;
+  }
+
   /*!
    * \brief Schedule all blocks.
    * \return The stages of the whole model.
@@ -466,7 +689,9 @@ class IOSScheduler : public StreamSchedulerBase {
     // Collect dynamic programming statistics.
     std::vector<int> block_order;
     for (int i = 0; i < num_blocks; i++) {
-      block_order.push_back(i);
+      if (blocks_[i].identical_block < 0) {
+        block_order.push_back(i);
+      }
     }
     std::sort(block_order.begin(), block_order.end(), [&](int lhs, int rhs) {
       return blocks_[lhs].nodes.size() < blocks_[rhs].nodes.size();
@@ -474,13 +699,13 @@ class IOSScheduler : public StreamSchedulerBase {
     std::vector<std::thread> threads;
     int num_workers = static_cast<int>(std::thread::hardware_concurrency());
     auto workload = [&](int block_id) { CollectDynamicProgrammingStatistics(block_id); };
-    for (int i = 0; i < num_blocks; i++) {
+    for (int i = 0; i < block_order.size(); i++) {
       if (i - num_workers >= 0) {
         threads[i - num_workers].join();
       }
       threads.emplace_back(workload, block_order[i]);
     }
-    for (int i = 0; i < num_blocks; i++) {
+    for (int i = 0; i < threads.size(); i++) {
       if (threads[i].joinable()) {
         threads[i].join();
       }
@@ -520,18 +745,24 @@ class IOSScheduler : public StreamSchedulerBase {
    * \brief Collect the dynamic programming statistics. This would calculate the states and the
    * decisions for each state. The decisions for each state are cached and can be directly used
    * in our later dynamic programming. The state information can be used to print the progress
-   * messages.
+   * messages. If the states cannot be enumerated within the time budget, the block is scheduled
+   * by beam search.
    * \param block_id The index of block to collect the dynamic programming statistics.
    */
   void CollectDynamicProgrammingStatistics(int block_id) {
     BlockInfo& block = blocks_[block_id];
+    auto start = std::chrono::steady_clock::now();
     std::function<void(State)> DP = [&](State state) {
-      if (state == 0) {
+      if (state == 0 || block.use_beam) {
         return;
       }
       if (block.state_decision_candidates.count(state)) {
         return;
       }
+      if (TimeBudgetExceeded(start)) {
+        block.use_beam = true;
+        return;
+      }
       for (auto candidate : GetStateDecisionCandidates(block_id, state)) {
         DP(state - candidate);
       }
@@ -540,6 +771,18 @@ class IOSScheduler : public StreamSchedulerBase {
     DP(full_state);
   }
 
+  /*!
+   * \brief Check whether the time budget of scheduling a block is exceeded.
+   * \param start The time when scheduling the block starts.
+   */
+  bool TimeBudgetExceeded(std::chrono::steady_clock::time_point start) {
+    if (config_.time_budget <= 0) {
+      return false;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed > std::chrono::milliseconds(config_.time_budget);
+  }
+
   /*!
    * \brief Schedule a block. This function would generate the scheduled stages for given block.
    * \param block_id The index of the block to be scheduled.
@@ -548,11 +791,29 @@ class IOSScheduler : public StreamSchedulerBase {
    * blocks_[block_id].stages.
    */
   void ScheduleBlock(int block_id) {
-    auto& state_latency = blocks_[block_id].state_latency;
-    auto& state_decision = blocks_[block_id].state_decision;
+    BlockInfo& block = blocks_[block_id];
+    if (block.identical_block >= 0) {
+      // Map the stages of the identical block to the nodes of this block by their indices.
+      const BlockInfo& identical = blocks_[block.identical_block];
+      for (const Stage& identical_stage : identical.stages) {
+        Stage stage;
+        for (const Group& identical_group : identical_stage) {
+          stage.emplace_back();
+          for (Node* node : identical_group) {
+            stage.back().push_back(block.nodes[identical.node_index.at(node)]);
+          }
+        }
+        block.stages.push_back(std::move(stage));
+      }
+      return;
+    }
+
+    auto& state_latency = block.state_latency;
+    auto& state_decision = block.state_decision;
+    auto start = std::chrono::steady_clock::now();
 
     std::function<float(State)> DP = [&](State state) {
-      if (state == 0) {
+      if (state == 0 || block.use_beam) {
         // empty state means we have scheduled all operators in the block.
         return 0.0f;
       }
@@ -560,11 +821,15 @@ class IOSScheduler : public StreamSchedulerBase {
         // Return the memorized state latency.
         return state_latency[state];
       }
+      if (TimeBudgetExceeded(start)) {
+        block.use_beam = true;
+        return 0.0f;
+      }
       float best_latency = 1e18;
       Decision best_decision = state;
       for (auto decision : GetStateDecisionCandidates(block_id, state)) {
         DCHECK_EQ((decision & state), decision);
-        float decision_latency = GetDecisionStageLatency(block_id, decision);
+        float decision_latency = GetStageCost(block_id, state, decision);
         float total_latency = DP(state - decision) + decision_latency;
         if (best_latency > total_latency) {
           best_latency = total_latency;
@@ -577,21 +842,123 @@ class IOSScheduler : public StreamSchedulerBase {
       return best_latency;
     };
 
-    State state = GetLeastSignificantOnes(blocks_[block_id].nodes.size());
+    State state = GetLeastSignificantOnes(block.nodes.size());
 
-    DP(state);
+    if (!block.use_beam) {
+      DP(state);
+    }
+    if (block.use_beam) {
+      // The exact search is out of the time budget. The partial results are dropped.
+      state_latency.clear();
+      state_decision.clear();
+      BeamSearch(block_id);
+    }
 
     // construct the optimal schedule for this block
-    auto& decision_stage = blocks_[block_id].decision_stage;
-    auto& stages = blocks_[block_id].stages;
+    auto& decision_stage = block.decision_stage;
+    auto& stages = block.stages;
     while (state) {
       Decision decision = state_decision[state];
+      if (config_.memory_budget > 0) {
+        int64_t peak_memory = GetStagePeakMemory(block_id, state, decision);
+        LOG_IF(WARNING, peak_memory > config_.memory_budget)
+            << "Cannot fit a stage of block " << block_id << " into the memory budget ("
+            << peak_memory / kMegaBytes << " MBs > " << config_.memory_budget / kMegaBytes
+            << " MBs)";
+      }
       stages.push_back(decision_stage[decision]);
       state -= decision;
     }
     std::reverse(stages.begin(), stages.end());
   }
 
+  /*!
+   * \brief Get the cost of a stage, i.e., its latency plus the penalty if it exceeds the memory
+   * budget.
+   * \param block_id The block index.
+   * \param state The remaining operators before the stage.
+   * \param decision The operators in the stage.
+   * \return The cost of the stage.
+   */
+  float GetStageCost(int block_id, State state, Decision decision) {
+    float cost = GetDecisionStageLatency(block_id, decision);
+    if (config_.memory_budget > 0) {
+      int64_t peak_memory = GetStagePeakMemory(block_id, state, decision);
+      if (peak_memory > config_.memory_budget) {
+        cost += kOverBudgetPenaltyPerMB * (peak_memory - config_.memory_budget) / kMegaBytes;
+      }
+    }
+    return cost;
+  }
+
+  /*!
+   * \brief Schedule a block by beam search, which is used when the exact dynamic programming is
+   * out of the time budget. Starting from the full state, each step expands the kept states by
+   * their decision candidates and keeps the config_.beam_width states with the lowest estimated
+   * total latency, i.e., the latency of the scheduled stages plus the latency of running the
+   * remaining operators one by one. It stores the decisions along the best schedule found in
+   * blocks_[block_id].state_decision.
+   * \param block_id The block index.
+   */
+  void BeamSearch(int block_id) {
+    BlockInfo& block = blocks_[block_id];
+    std::vector<float> unit_latency(block.nodes.size());
+    for (int i = 0; i < block.nodes.size(); i++) {
+      unit_latency[i] = GetDecisionStageLatency(block_id, Decision(1) << i);
+    }
+    auto GetSerialLatency = [&](State state) {
+      float latency = 0.0f;
+      for (int i = 0; i < block.nodes.size(); i++) {
+        if ((state >> i) & 1) {
+          latency += unit_latency[i];
+        }
+      }
+      return latency;
+    };
+
+    // The latency to reach each state and the decision of its previous state.
+    std::unordered_map<State, float> latency;
+    std::unordered_map<State, std::pair<State, Decision>> prev;
+    State full_state = GetLeastSignificantOnes(block.nodes.size());
+    latency[full_state] = 0.0f;
+    std::vector<State> beam = {full_state};
+    while (!beam.empty()) {
+      std::vector<State> next;
+      for (State state : beam) {
+        for (auto decision : GetStateDecisionCandidates(block_id, state)) {
+          State rest = state - decision;
+          float total_latency = latency[state] + GetStageCost(block_id, state, decision);
+          auto it = latency.find(rest);
+          if (it == latency.end()) {
+            next.push_back(rest);
+          } else if (it->second <= total_latency) {
+            continue;
+          }
+          latency[rest] = total_latency;
+          prev[rest] = std::make_pair(state, decision);
+        }
+      }
+      // The empty state is finished and not expanded further.
+      next.erase(std::remove(next.begin(), next.end(), State(0)), next.end());
+      std::sort(next.begin(), next.end(), [&](State lhs, State rhs) {
+        return latency[lhs] + GetSerialLatency(lhs) < latency[rhs] + GetSerialLatency(rhs);
+      });
+      if (next.size() > config_.beam_width) {
+        next.resize(config_.beam_width);
+      }
+      beam = std::move(next);
+    }
+
+    CHECK(latency.count(0)) << "Beam search cannot schedule block " << block_id;
+    for (State state = 0; state != full_state; state = prev[state].first) {
+      block.state_decision[prev[state].first] = prev[state].second;
+    }
+    if (verbose_.on) {
+      LOG_PRINTF("Schedule block %d with %zu operators by beam search.", block_id,
+                 block.nodes.size());
+    }
+  }
+
   /*!
    * Get the decision candidates for given state in a block.
    * \param block_id The block id.
@@ -838,6 +1205,12 @@ class IOSScheduler : public StreamSchedulerBase {
      * does not match these pattern would be schedule unit individually.
      */
     Array<Array<Op>> schedule_units;
+    /*! \brief The memory budget in bytes. 0 means no memory constraint. */
+    int64_t memory_budget;
+    /*! \brief The time budget in milliseconds of the exact search of a block. 0 means no limit. */
+    int time_budget;
+    /*! \brief The number of states kept in each step of the beam search. */
+    int beam_width;
   };
   /*! \brief The config of IOS scheduler. */
   Config config_;
@@ -873,6 +1246,20 @@ class IOSScheduler : public StreamSchedulerBase {
     std::unordered_map<Decision, float> decision_latency;
     /*! \brief The stages of this block after scheduling. */
     std::vector<Stage> stages;
+    /*! \brief The size of the tensors that are alive during the whole block. */
+    int64_t resident_bytes = 0;
+    /*! \brief The size and the users in this block of the tensors from the previous blocks. */
+    std::vector<std::pair<int64_t, State>> input_bytes;
+    /*! \brief The mapping from node index to its output size. Nodes with 0 bytes are omitted. */
+    std::unordered_map<int, int64_t> node_bytes;
+    /*! \brief The mapping from node index to its users in this block. */
+    std::unordered_map<int, State> node_users;
+    /*! \brief The mapping from node index to whether it is used by the following blocks. */
+    std::unordered_map<int, bool> node_escapes;
+    /*! \brief The previous block identical to this block whose schedule is reused, or -1. */
+    int identical_block = -1;
+    /*! \brief Whether the block is scheduled by beam search as it is out of the time budget. */
+    bool use_beam = false;
   };
   /*! \brief The data of each block. */
   std::vector<BlockInfo> blocks_;
@@ -900,19 +1287,23 @@ class IOSScheduler : public StreamSchedulerBase {
       std::stringstream ss;
       total_states = 0;
       for (auto& block : scheduler->blocks_) {
-        total_states += block.state_decision_candidates.size();
-        ss << block.state_decision_candidates.size() << " ";
+        if (block.identical_block < 0 && !block.use_beam) {
+          total_states += block.state_decision_candidates.size();
+          ss << block.state_decision_candidates.size() << " ";
+        }
       }
       start_time_stamp = prev_time_stamp = raf::profiler::ProfileStat::NowInMicrosec() / 1000;
       LOG_PRINTF("Total states: %zu", total_states);
     }
     inline void UpdateProgress() {
-      if (!on) {
+      if (!on || total_states == 0) {
         return;
       }
       uint64_t finished_states = 0;
       for (auto& block : scheduler->blocks_) {
-        finished_states += block.state_latency.size();
+        if (!block.use_beam) {
+          finished_states += block.state_latency.size();
+        }
       }
       uint64_t time_stamp = raf::profiler::ProfileStat::NowInMicrosec() / 1000;
       if (finished_states == total_states || time_stamp - prev_time_stamp > msg_interval) {
@@ -946,10 +1337,11 @@ class IOSScheduler : public StreamSchedulerBase {
 Expr IOSStreamSchedule(const Expr& e, Device device, int block_max_size = 20,
                        int max_stream_num = 5, int max_stage_ops = 10,
                        bool search_group_combination = true, Array<Array<Op>> schedule_units = {},
-                       int warmup = 1, int number = 5, int repeat = 5, bool verbose = false) {
+                       int warmup = 1, int number = 5, int repeat = 5, bool verbose = false,
+                       int memory_budget = 0, int time_budget = 0, int beam_width = 8) {
   IOSScheduler scheduler(device, block_max_size, max_stream_num, max_stage_ops,
                          search_group_combination, std::move(schedule_units), warmup, number,
-                         repeat, verbose);
+                         repeat, verbose, memory_budget, time_budget, beam_width);
   return scheduler.Schedule(e);
 }
 
@@ -976,6 +1368,9 @@ Pass IOSStreamSchedule() {
   int number = get_int_config("number", 1);
   int repeat = get_int_config("repeat", 8);
   bool verbose = get_bool_config("verbose", true);
+  int memory_budget = get_int_config("memory_budget", 0);
+  int time_budget = get_int_config("time_budget", 0);
+  int beam_width = get_int_config("beam_width", 8);
   Array<Array<Op>> schedule_units =
       ctx->GetConfig<Array<Array<Op>>>("raf.stream_schedule.ios.schedule_units", Array<Array<Op>>())
           .value();
@@ -991,7 +1386,8 @@ Pass IOSStreamSchedule() {
         auto transform = [=](Expr e) {
           return ios_stream_schedule::IOSStreamSchedule(
               e, Device(DevType::kCUDA(), 0), block_max_size, max_stream_num, max_stage_ops,
-              search_group_combination, schedule_units, warmup, number, repeat, verbose);
+              search_group_combination, schedule_units, warmup, number, repeat, verbose,
+              memory_budget, time_budget, beam_width);
         };
         return Downcast<Function>(tvm::relay::TransformF(transform, f));
       };
@@ -1008,5 +1404,8 @@ TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.number", tvm::Integer);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.repeat", tvm::Integer);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.verbose", tvm::Bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.schedule_units", Array<Array<Op>>);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.memory_budget", tvm::Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.time_budget", tvm::Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.beam_width", tvm::Integer);
 }  // namespace pass
 }  // namespace raf
@@ -11,7 +11,6 @@
 #include "raf/pass.h"
 #include "raf/analysis.h"
 #include "./stream_schedule.h"
-#include "../analysis/dependency_graph.h"
 
 namespace raf {
 namespace pass {
@@ -19,12 +18,9 @@ namespace wavefront_stream_schedule {
 
 using namespace raf::analysis;
 using stream_schedule::StreamSchedulerBase;
-using Node = DependencyGraph::Node;
-using NodeExprMap = std::unordered_map<const Node*, Expr>;
-using analysis::dependency_graph::GetListSize;
 
 /*! Chain, Wave, and Partition are used to describe a wavefront schedule. */
-using Chain = std::vector<Node*>;
+using Chain = std::vector<int>;
 using Wave = std::vector<Chain>;
 using Partition = std::vector<Wave>;
 
@@ -33,20 +29,14 @@ using Partition = std::vector<Wave>;
  * \param dg The dependency graph we want to partition.
  * \return The wavefront partition.
  */
-Partition WavefrontPartition(DependencyGraph* dg) {
-  std::vector<Node*>& nodes = dg->post_dfs_order;
-
-  std::unordered_map<Node*, int> in_degree, out_degree;
-  for (auto& node : nodes) {
-    for (auto child = node->children.head; child; child = child->next) {
-      Node* child_node = child->value;
-      in_degree[child_node]++;
-      out_degree[node]++;
-    }
+Partition WavefrontPartition(const CompactDependencyGraph& dg) {
+  std::vector<int> out_degree(dg.size());
+  for (int node = 0; node < dg.size(); ++node) {
+    out_degree[node] = static_cast<int>(dg.Children(node).size());
   }
 
-  std::vector<Node*> free_nodes;
-  for (auto& node : nodes) {
+  std::vector<int> free_nodes;
+  for (int node = 0; node < dg.size(); ++node) {
     if (out_degree[node] == 0) {
       free_nodes.push_back(node);
     }
@@ -63,24 +53,24 @@ Partition WavefrontPartition(DependencyGraph* dg) {
       // case 2. one parents
       // case 3. two or more parents
       Chain chain;
-      if (GetListSize(node->parents) != 1) {
+      if (dg.Parents(node).size() != 1) {
         // case 1 and case 3. There is only the free node in this chain
         chain.push_back(node);
       } else {
         // case 2. There are more than one nodes in this chain, starting from the free node
         chain.push_back(node);
-        Node* next_node = node->parents.head->value;
-        while (GetListSize(next_node->parents) == 1 && out_degree[next_node] == 1) {
+        int next_node = dg.Parents(node)[0];
+        while (dg.Parents(next_node).size() == 1 && out_degree[next_node] == 1) {
           chain.push_back(next_node);
           node = next_node;
-          next_node = node->parents.head->value;
+          next_node = dg.Parents(node)[0];
           CHECK_GE(out_degree[next_node], 1);
         }
         // There are three sub cases to stop growing this chain:
         // sub case 1. There are two or more nodes next_node depends on after ignoring previous
         //             waves (out_degree[next_node] > 1).
         // sub case 2. The number of nodes that depends on next_node does not equal to 1
-        //             (GetListSize(next_node->parents) != 1).
+        //             (dg.Parents(next_node).size() != 1).
         // sub case 3. Both of sub case 1 and sub case 2.
         // For sub case 2, we should also take next_node into this chain.
         if (out_degree[next_node] == 1) {
@@ -91,11 +81,9 @@ Partition WavefrontPartition(DependencyGraph* dg) {
     }
     free_nodes.clear();
     for (auto& chain : wave) {
-      Node* last_node = chain.back();
-      for (auto parent = last_node->parents.head; parent; parent = parent->next) {
-        Node* parent_node = parent->value;
-        if (--out_degree[parent_node] == 0) {
-          free_nodes.push_back(parent_node);
+      for (int parent : dg.Parents(chain.back())) {
+        if (--out_degree[parent] == 0) {
+          free_nodes.push_back(parent);
         }
       }
     }
@@ -130,24 +118,16 @@ class WavefrontScheduler : public StreamSchedulerBase {
    * \return The schedule expr. Schedule-related operators have been injected.
    */
   Expr Schedule(const Expr& e) {
-    Arena arena;
-    DependencyGraph dg = CreateDependencyGraph(&arena, e, true, true);
-
-    NodeExprMap node_expr;
-    for (auto& it : dg.expr_node) {
-      node_expr[it.second] = it.first;
-    }
-
-    Partition partition = WavefrontPartition(&dg);
+    auto dg = CompactDependencyGraph::Create(e, true, true);
+    Partition partition = WavefrontPartition(dg);
 
     for (int i = 0; i < partition.size(); i++) {
       Wave& wave = partition.at(i);
       for (int j = 0; j < wave.size(); j++) {
         Chain& chain = wave[j];
         AnnotateSetStream(0, j);
-        for (Node* node : chain) {
-          Expr expr = node_expr.at(node);
-          VisitExpr(expr);
+        for (int node : chain) {
+          VisitExpr(dg.GetExpr(node));
         }
       }
       if (i + 1 < partition.size()) {
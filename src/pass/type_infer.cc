@@ -44,6 +44,8 @@ class TypeInferencer : public ExprMutator {
 
  public:
   TypeInferencer(IRModule& mod) : mod_(mod) {
+    auto pass_ctx = PassContext::Current();
+    incremental_ = pass_ctx->GetConfig("raf.type_infer.incremental", Bool(true)).value();
   }
 
   Type GetValueType(const Value& v) {
@@ -72,7 +74,10 @@ class TypeInferencer : public ExprMutator {
         << "Module does not contain " << GetRef<GlobalVar>(op);
     Expr func = mod_->Lookup(GetRef<GlobalVar>(op));
     func = VisitExpr(func);
-    op->checked_type_ = func->checked_type();
+    if (!op->checked_type_.defined() ||
+        !tvm::StructuralEqual()(op->checked_type_, func->checked_type())) {
+      op->checked_type_ = func->checked_type();
+    }
     return std::move(GetRef<GlobalVar>(op));
   }
 
@@ -152,7 +157,11 @@ class TypeInferencer : public ExprMutator {
       Expr op = VisitExpr(call->op);
       ret = Call(op, args, call->attrs, call->type_args);
       if (const OpNode* opn = ret->op.as<OpNode>()) {
-        ret->checked_type_ = InferPrimitive(ret, GetRef<Op>(opn));
+        if (IsCallUnchanged(call, args)) {
+          ret->checked_type_ = call->checked_type_;
+        } else {
+          ret->checked_type_ = InferPrimitive(ret, GetRef<Op>(opn));
+        }
       } else if (ret->op.as<VarNode>() || ret->op.as<LetNode>()) {
         // handle recursive func call when op is a var node
         if (op->checked_type()->IsInstance<IncompleteTypeNode>()) {
@@ -182,6 +191,54 @@ class TypeInferencer : public ExprMutator {
     return ret;
   }
 
+  /*!
+   * \brief Whether the primitive call can reuse its type inferred by a previous run. This is
+   * the case when the call was typed before and its arguments are the same vars and constants
+   * whose types and values are unchanged in this run, i.e., the call is not rewritten by the
+   * passes since then.
+   */
+  bool IsCallUnchanged(const CallNode* call, const Array<Expr>& args) {
+    if (!incremental_ || !call->checked_type_.defined() ||
+        call->checked_type_->IsInstance<IncompleteTypeNode>()) {
+      return false;
+    }
+    for (size_t i = 0; i < args.size(); ++i) {
+      if (!args[i].same_as(call->args[i])) {
+        return false;
+      }
+      if (const auto* var = args[i].as<VarNode>()) {
+        if (dirty_vars_.count(var) || var->checked_type()->IsInstance<IncompleteTypeNode>()) {
+          return false;
+        }
+      } else if (!args[i]->IsInstance<ConstantNode>()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*!
+   * \brief Whether the value bound to a let var with an unchanged type is the same as the
+   * previous run. The value of a call is derived from its type, while a tuple or an alias is
+   * unchanged only if its fields are. Other values (e.g., closures) are always treated as changed.
+   */
+  bool IsValueUnchanged(const Expr& value) {
+    if (value->IsInstance<CallNode>() || value->IsInstance<TupleGetItemNode>()) {
+      return true;
+    } else if (const auto* alias = value.as<VarNode>()) {
+      return !dirty_vars_.count(alias);
+    } else if (const auto* tuple = value.as<TupleNode>()) {
+      for (const auto& field : tuple->fields) {
+        const auto* field_var = field.as<VarNode>();
+        if (!field_var || dirty_vars_.count(field_var)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
   Type InferPrimitive(const Call& call, const Op op) {
     // Only type inference from leaf to root is supported.
     // Thus incomplete inputs will not be inferred from outputs.
@@ -263,6 +320,10 @@ class TypeInferencer : public ExprMutator {
     for (size_t n = args.size(), i = 0; i < n; ++i) {
       Expr arg = VisitExpr(args[i]);
       const auto* v = arg.as<VarNode>();
+      if (!v || dirty_vars_.count(v)) {
+        // The calls in the function body may read the values of the caller arguments.
+        dirty_vars_.insert(fn->params[i].get());
+      }
       if (v && var_value_map_.count(v)) {
         var_value_map_[fn->params[i].get()] = var_value_map_[v];
       } else {
@@ -344,7 +405,18 @@ class TypeInferencer : public ExprMutator {
       }
 
       // If the binded primitive function has not been inferred, then it does not have the type yet.
-      if (infer_body) {
+      if (!infer_body) {
+        dirty_vars_.insert(var.get());
+        return;
+      }
+      bool same_type = var->checked_type_.defined() &&
+                       tvm::StructuralEqual()(var->checked_type_, value->checked_type());
+      if (!same_type || !IsValueUnchanged(value)) {
+        dirty_vars_.insert(var.get());
+      }
+      // Only write the changed types, so inferring a typed function does not write the nodes
+      // that may be read by other threads (see the parallel function passes).
+      if (!same_type) {
         var->checked_type_ = value->checked_type();
       }
     };
@@ -398,7 +470,11 @@ class TypeInferencer : public ExprMutator {
 
   Expr VisitExpr_(const OpNode* node) override {
     auto op = GetRef<Op>(node);
-    op->checked_type_ = GetOpAttr<OpType>(op, "OpType");
+    auto op_type = GetOpAttr<OpType>(op, "OpType");
+    // Ops are shared by all functions, so only write the type once.
+    if (!op->checked_type_.same_as(op_type)) {
+      op->checked_type_ = op_type;
+    }
     return op;
   }
 
@@ -441,6 +517,10 @@ class TypeInferencer : public ExprMutator {
   std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> closure_param_map_;
   /*! \brief Track visited Expr to avoid indefinite recursion in IR with recursive functions */
   std::unordered_set<Expr, ObjectPtrHash, ObjectPtrEqual> visited_;
+  /*! \brief Whether to reuse the types of the calls unchanged since the previous run. */
+  bool incremental_ = true;
+  /*! \brief The vars whose types or values may differ from the previous run. */
+  std::unordered_set<const VarNode*> dirty_vars_;
 };
 
 class Unifier : public TypeFunctor<Type(const Type&, const Type&)> {
@@ -677,5 +757,7 @@ Expr InferTypeWithModule(const Expr& expr, const IRModule& m) {
 
 RAF_REGISTER_GLOBAL("raf.pass_.InferType").set_body_typed([]() { return InferType(); });
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.type_infer.incremental", Bool);
+
 }  // namespace pass
 }  // namespace raf
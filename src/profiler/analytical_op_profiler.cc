@@ -0,0 +1,194 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/analytical_op_profiler.cc
+ * \brief An analytical cost model to estimate the op latency without running the ops
+ */
+#include <tvm/ir/transform.h>
+#include <algorithm>
+#include <cmath>
+#include "raf/comm_cost_model.h"
+#include "raf/op_profiler.h"
+#include "raf/ir.h"
+#include "raf/op_utils.h"
+#include "../common/shape_utils.h"
+#include "../pass/estimate_flops.h"
+
+namespace raf {
+namespace op_profiler {
+
+using namespace raf::op;
+using namespace raf::value;
+
+OpProfiler* OpProfiler::GetCostModel(const Device& device) {
+  auto pass_ctx = tvm::transform::PassContext::Current();
+  auto model = pass_ctx->GetConfig<tvm::String>("raf.op_profiler.cost_model", "profile").value();
+  if (model == "analytical") {
+    return AnalyticalOpProfiler::Get(device);
+  }
+  CHECK(model == "profile") << "Unknown cost model " << model
+                            << ", expected \"profile\" or \"analytical\"";
+  return OpProfiler::Get(device);
+}
+
+AnalyticalOpProfiler* AnalyticalOpProfiler::Get(const Device& device) {
+  if (device.device_type() == DevType::kCPU()) {
+    static AnalyticalOpProfiler profiler(device);
+    return &profiler;
+  } else if (device.device_type() == DevType::kCUDA()) {
+    static AnalyticalOpProfiler profiler(device);
+    return &profiler;
+  }
+  LOG(FATAL) << "The analytical cost model does not support " << device.c_str();
+  throw;
+}
+
+AnalyticalOpProfiler::AnalyticalOpProfiler(const Device& device) : OpProfiler(device) {
+  // The defaults are in the ballpark of a server CPU and a V100 GPU in FP32. They should be
+  // replaced by the calibrated spec of the target device for accurate estimation.
+  if (device.device_type() == DevType::kCUDA()) {
+    spec_ = {14000.0, 800.0, 5.0};
+  } else {
+    spec_ = {500.0, 50.0, 1.0};
+  }
+}
+
+AnalyticalOpProfiler::OpWork AnalyticalOpProfiler::GetOpWork(const Expr& op) {
+  auto call_node = op.as<CallNode>();
+  if (call_node == nullptr) {
+    return {0.0, 0.0};
+  }
+  auto call = GetRef<Call>(call_node);
+  if (IsCollectiveOp(call->op)) {
+    // The calibrated collectives do not use the device throughput. They are not cached, since the
+    // calibration may be set after the op is estimated.
+    double comm_us = distributed::CommCostModel::Get()->Estimate(call);
+    if (comm_us >= 0) {
+      return {0.0, 0.0, comm_us};
+    }
+  }
+  auto key = HashKeyToStr(HashCall(call));
+  auto it = work_cache_.find(key);
+  if (it != work_cache_.end()) {
+    return it->second;
+  }
+
+  double gflops = pass::estimate_flops::EstimateCallGFLOPS(call, device_, IRModule());
+  // Ops without the FLOPS estimation (e.g., the ones without a TVM dialect) are treated as
+  // memory bound.
+  if (!std::isfinite(gflops) || gflops < 0) {
+    gflops = 0.0;
+  }
+  double bytes = common::shape_utils::BytesCompactType(call->checked_type());
+  for (const auto& arg : call->args) {
+    if (!arg->IsInstance<RelayConstantNode>()) {
+      bytes += common::shape_utils::BytesCompactType(arg->checked_type());
+    }
+  }
+  OpWork work{gflops, bytes};
+  work_cache_[key] = work;
+  return work;
+}
+
+float AnalyticalOpProfiler::Latency(const OpWork& work) const {
+  if (work.comm_us >= 0) {
+    return work.comm_us;
+  }
+  // GFLOP / GFLOPS and GB / (GB/s) are in seconds.
+  double compute_us = work.gflops / spec_.peak_gflops * 1e6;
+  double memory_us = work.bytes / 1e9 / spec_.peak_gbps * 1e6;
+  return spec_.launch_us + std::max(compute_us, memory_us);
+}
+
+std::pair<std::vector<float>, float> AnalyticalOpProfiler::ProfileOp(const Expr& op,
+                                                                     int32_t warmup,
+                                                                     int32_t exec_number,
+                                                                     int32_t repeat) {
+  if (!op->IsInstance<CallNode>()) {
+    return std::make_pair(std::vector<float>(repeat, 0.0), 0.0f);
+  }
+  return std::make_pair(std::vector<float>(repeat, Latency(GetOpWork(op))), 0.0f);
+}
+
+std::vector<std::pair<std::vector<float>, float>> AnalyticalOpProfiler::ProfileOps(
+    const std::vector<Expr>& ops, int32_t warmup, int32_t exec_number, int32_t repeat,
+    int num_threads) {
+  std::vector<std::pair<std::vector<float>, float>> ret;
+  for (const auto& op : ops) {
+    ret.push_back(ProfileOp(op, warmup, exec_number, repeat));
+  }
+  return ret;
+}
+
+std::pair<std::vector<float>, float> AnalyticalOpProfiler::ProfileOpGroup(
+    const std::vector<Expr>& ops, const std::vector<int>& stream_ids, int32_t warmup,
+    int32_t exec_number, int32_t repeat) {
+  CHECK(stream_ids.empty() || stream_ids.size() == ops.size())
+      << "The length of stream_ids does not match ops";
+  std::unordered_map<int, float> stream_latency;
+  OpWork total{0.0, 0.0};
+  int num_kernels = 0;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    if (!ops[i]->IsInstance<CallNode>()) {
+      continue;
+    }
+    OpWork work = GetOpWork(ops[i]);
+    stream_latency[stream_ids.empty() ? -1 : stream_ids[i]] += Latency(work);
+    total.gflops += work.gflops;
+    total.bytes += work.bytes;
+    ++num_kernels;
+  }
+  float latency = 0.0f;
+  for (const auto& kv : stream_latency) {
+    latency = std::max(latency, kv.second);
+  }
+  if (num_kernels > 0) {
+    // The streams share the device throughput, while the launch overheads of the streams overlap.
+    latency = std::max(latency, Latency(total));
+  }
+  return std::make_pair(std::vector<float>(repeat, latency), 0.0f);
+}
+
+std::vector<float> AnalyticalOpProfiler::RunOp(const OpWithDataPtr& op_with_data, int32_t warmup,
+                                               int32_t exec_number, int32_t repeat) {
+  LOG(FATAL) << "AnalyticalOpProfiler does not run ops";
+  throw;
+}
+
+std::vector<float> AnalyticalOpProfiler::RunOpGroup(const std::vector<OpWithDataPtr>& op_with_datas,
+                                                    int32_t warmup, int32_t exec_number,
+                                                    int32_t repeat) {
+  LOG(FATAL) << "AnalyticalOpProfiler does not run ops";
+  throw;
+}
+
+RAF_REGISTER_GLOBAL("raf.op_profiler.SetDeviceSpec")
+    .set_body_typed([](const Device& device, double peak_gflops, double peak_gbps,
+                       double launch_us) {
+      CHECK_GT(peak_gflops, 0) << "The peak GFLOPS must be positive";
+      CHECK_GT(peak_gbps, 0) << "The peak bandwidth must be positive";
+      AnalyticalOpProfiler::Get(device)->SetDeviceSpec({peak_gflops, peak_gbps, launch_us});
+    });
+
+RAF_REGISTER_GLOBAL("raf.op_profiler.GetDeviceSpec").set_body_typed([](const Device& device) {
+  const auto& spec = AnalyticalOpProfiler::Get(device)->GetDeviceSpec();
+  Map<String, FloatImm> ret;
+  ret.Set("peak_gflops", FloatImm(DataType::Float(64), spec.peak_gflops));
+  ret.Set("peak_gbps", FloatImm(DataType::Float(64), spec.peak_gbps));
+  ret.Set("launch_us", FloatImm(DataType::Float(64), spec.launch_us));
+  return ret;
+});
+
+RAF_REGISTER_GLOBAL("raf.op_profiler.EstimateLatency")
+    .set_body_typed([](const Expr& expr, const Device& device) {
+      auto lat = AnalyticalOpProfiler::Get(device)->ProfileOp(expr, 0, 0, 1).first[0];
+      return FloatImm(DataType::Float(32), lat);
+    });
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.op_profiler.cost_model", tvm::String);
+
+}  // namespace op_profiler
+}  // namespace raf
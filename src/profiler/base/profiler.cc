@@ -7,16 +7,45 @@
  * \file src/profiler/base/profiler.cc
  * \brief RAF profiler, a simple implementation
  */
+#include <algorithm>
 #include "raf/registry.h"
 #include "raf/profiler.h"
 
 namespace raf {
 namespace profiler {
 
+/*! \brief The number of records in a chunk. */
+static constexpr size_t kChunkSize = 1 << 14;
+
+struct Profiler::RecordChunk {
+  ProfileRecord records[kChunkSize];
+  /*! \brief The number of records written. Published by the owner thread with release. */
+  std::atomic<size_t> size{0};
+  /*! \brief The number of records merged. Only accessed under m_. */
+  size_t consumed = 0;
+};
+
+struct Profiler::ThreadBuffer {
+  /*! \brief The chunk the owner thread is appending to. Only replaced under m_. */
+  RecordChunk* active = nullptr;
+};
+
 Profiler::Profiler() {
+  strings_.emplace_back("");
+  string_ids_.emplace("", 0);
 }
 
 Profiler::~Profiler() {
+  for (auto buffer : thread_buffers_) {
+    delete buffer->active;
+    buffer->active = nullptr;
+  }
+  for (auto chunk : full_chunks_) {
+    delete chunk;
+  }
+  for (auto chunk : free_chunks_) {
+    delete chunk;
+  }
 }
 
 Profiler* Profiler::Get() {
@@ -24,11 +53,141 @@ Profiler* Profiler::Get() {
   return &prof;
 }
 
+uint32_t Profiler::Intern(const std::string& str) {
+  thread_local std::unordered_map<std::string, uint32_t> cache;
+  auto it = cache.find(str);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  uint32_t id = InternGlobal(str);
+  cache.emplace(str, id);
+  return id;
+}
+
+uint32_t Profiler::InternLiteral(const char* str) {
+  thread_local std::unordered_map<const char*, uint32_t> cache;
+  auto it = cache.find(str);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  uint32_t id = InternGlobal(str);
+  cache.emplace(str, id);
+  return id;
+}
+
+uint32_t Profiler::InternArgs(const std::vector<std::string>& args) {
+  if (args.empty()) {
+    return 0;
+  }
+  if (args.size() == 1) {
+    return Intern(args[0]);
+  }
+  std::string joined = args[0];
+  for (size_t i = 1; i < args.size(); ++i) {
+    joined += ";" + args[i];
+  }
+  return Intern(joined);
+}
+
+uint32_t Profiler::InternGlobal(const std::string& str) {
+  std::lock_guard<std::mutex> lock(intern_m_);
+  auto it = string_ids_.find(str);
+  if (it != string_ids_.end()) {
+    return it->second;
+  }
+  uint32_t id = strings_.size();
+  strings_.push_back(str);
+  string_ids_.emplace(str, id);
+  return id;
+}
+
+Profiler::ThreadBuffer* Profiler::GetThreadBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (!buffer) {
+    buffer = std::make_shared<ThreadBuffer>();
+    std::lock_guard<std::recursive_mutex> lock{this->m_};
+    buffer->active = AcquireChunk();
+    thread_buffers_.push_back(buffer);
+  }
+  return buffer.get();
+}
+
+Profiler::RecordChunk* Profiler::AcquireChunk() {
+  if (free_chunks_.empty()) {
+    return new RecordChunk;
+  }
+  RecordChunk* chunk = free_chunks_.back();
+  free_chunks_.pop_back();
+  chunk->size.store(0, std::memory_order_relaxed);
+  chunk->consumed = 0;
+  return chunk;
+}
+
+void Profiler::AddRecord(const ProfileRecord& record) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  RecordChunk* chunk = buffer->active;
+  size_t size = chunk->size.load(std::memory_order_relaxed);
+  chunk->records[size] = record;
+  chunk->size.store(size + 1, std::memory_order_release);
+  if (size + 1 == kChunkSize) {
+    SwapChunk(buffer);
+  }
+}
+
+void Profiler::SwapChunk(ThreadBuffer* buffer) {
+  std::lock_guard<std::recursive_mutex> lock{this->m_};
+  full_chunks_.push_back(buffer->active);
+  buffer->active = AcquireChunk();
+}
+
 void Profiler::AddNewProfileStat(std::string categories, std::string name, uint64_t start_time,
                                  uint64_t end_time, const std::vector<std::string>& args) {
-  std::unique_ptr<ProfileStat> stat =
-      std::unique_ptr<ProfileStat>(new ProfileStat(categories, name, start_time, end_time, args));
-  profile_stats_.opr_exec_stats_->enqueue(stat.release());
+  ProfileRecord record{start_time, end_time, Intern(name), Intern(categories), InternArgs(args)};
+  std::lock_guard<std::recursive_mutex> lock{this->m_};
+  merged_.push_back(record);
+}
+
+void Profiler::CollectStat() {
+  std::lock_guard<std::recursive_mutex> lock{this->m_};
+  for (auto chunk : full_chunks_) {
+    merged_.insert(merged_.end(), chunk->records + chunk->consumed, chunk->records + kChunkSize);
+    free_chunks_.push_back(chunk);
+  }
+  full_chunks_.clear();
+  for (auto it = thread_buffers_.begin(); it != thread_buffers_.end();) {
+    RecordChunk* chunk = (*it)->active;
+    size_t size = chunk->size.load(std::memory_order_acquire);
+    merged_.insert(merged_.end(), chunk->records + chunk->consumed, chunk->records + size);
+    chunk->consumed = size;
+    if (it->use_count() == 1) {
+      // The owner thread has exited.
+      free_chunks_.push_back(chunk);
+      it = thread_buffers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  std::stable_sort(merged_.begin(), merged_.end(),
+                   [](const ProfileRecord& a, const ProfileRecord& b) {
+                     return a.start_time < b.start_time;
+                   });
+}
+
+std::vector<ProfileStat> Profiler::TakeProfileStats(bool consume) {
+  std::vector<ProfileStat> results;
+  results.reserve(merged_.size());
+  {
+    std::lock_guard<std::mutex> lock(intern_m_);
+    for (const auto& record : merged_) {
+      results.emplace_back(strings_[record.category_id], strings_[record.name_id],
+                           record.start_time, record.end_time,
+                           std::vector<std::string>{strings_[record.args_id]});
+    }
+  }
+  if (consume) {
+    merged_.clear();
+  }
+  return results;
 }
 
 std::string Profiler::GetProfile() {
@@ -37,19 +196,14 @@ std::string Profiler::GetProfile() {
   ss << "{" << std::endl;
   ss << "    \"traceEvents\": [" << std::endl;
 
-  if (profile_stats_.opr_exec_stats_->size_approx() == 0 && !helpers_.empty()) {
-    CollectStat();
-  }
-  ProfileStat* stat;
+  CollectStat();
   int stat_count = 0;
-  while (profile_stats_.opr_exec_stats_->try_dequeue(stat)) {
-    CHECK_NOTNULL(stat);
-    std::unique_ptr<ProfileStat> profile_stat(stat);  // manage lifecycle
-    CHECK_NE(profile_stat->categories_.c_str()[0], '\0') << "Category must be set";
+  for (auto& stat : TakeProfileStats(true)) {
+    CHECK_NE(stat.categories_.c_str()[0], '\0') << "Category must be set";
     if (stat_count) {
       ss << ",\n";
     }
-    profile_stat->EmitEvents(&ss);
+    stat.EmitEvents(&ss);
     ++stat_count;
   }
   ss << "\n" << std::endl;
@@ -59,34 +213,34 @@ std::string Profiler::GetProfile() {
   return ss.str();
 }
 
-std::vector<ProfileStat> Profiler::GetProfileStats() {
+std::vector<ProfileStat> Profiler::GetProfileStats(bool consume) {
   std::lock_guard<std::recursive_mutex> lock{this->m_};
-  std::vector<ProfileStat> results;
+  CollectStat();
+  return TakeProfileStats(consume);
+}
 
-  if (profile_stats_.opr_exec_stats_->size_approx() == 0 && !helpers_.empty()) {
-    CollectStat();
+void Profiler::ClearProfile() {
+  std::lock_guard<std::recursive_mutex> lock{this->m_};
+  for (auto chunk : full_chunks_) {
+    free_chunks_.push_back(chunk);
   }
-  ProfileStat* stat;
-  while (profile_stats_.opr_exec_stats_->try_dequeue(stat)) {
-    CHECK_NOTNULL(stat);
-    results.push_back(*stat);
+  full_chunks_.clear();
+  for (auto& buffer : thread_buffers_) {
+    buffer->active->consumed = buffer->active->size.load(std::memory_order_acquire);
   }
-  return results;
+  merged_.clear();
+  std::lock_guard<std::mutex> work_lock{op_work_m_};
+  op_work_.clear();
 }
 
-void Profiler::ClearProfile() {
-  std::lock_guard<std::recursive_mutex> lock{this->m_};
-  helpers_.clear();
+void Profiler::SetOpWork(const std::string& name, const OpWorkStat& work) {
+  std::lock_guard<std::mutex> lock{op_work_m_};
+  op_work_[name] = work;
 }
 
-DeviceStats::~DeviceStats() {
-  std::shared_ptr<TQueue> es = opr_exec_stats_;
-  if (es) {
-    ProfileStat* stat = nullptr;
-    while (es->try_dequeue(stat)) {
-      delete stat;
-    }
-  }
+std::unordered_map<std::string, OpWorkStat> Profiler::GetOpWork() {
+  std::lock_guard<std::mutex> lock{op_work_m_};
+  return op_work_;
 }
 
 ProfileStat::ProfileStat(std::string categories, std::string name, uint64_t start_time,
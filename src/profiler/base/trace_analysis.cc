@@ -0,0 +1,296 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/base/trace_analysis.cc
+ * \brief Critical-path, exposed-communication and utilization analysis of profiled traces
+ */
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+#include "raf/registry.h"
+#include "raf/profiler.h"
+
+namespace raf {
+namespace profiler {
+
+using namespace raf::ir;
+
+namespace {
+
+struct TraceEvent {
+  const ProfileStat* stat;
+  uint64_t start;
+  uint64_t end;
+  bool is_comm;
+};
+
+using Interval = std::pair<uint64_t, uint64_t>;
+
+bool IsStreamCategory(const std::string& category) {
+  static const std::string kStream = "Stream ";
+  static const std::string kCuptiStream = "CUPTI Stream ";
+  return category == "Default Stream" || category.compare(0, kStream.size(), kStream) == 0 ||
+         category.compare(0, kCuptiStream.size(), kCuptiStream) == 0;
+}
+
+/*! \brief Sort and merge the intervals in place. */
+void MergeIntervals(std::vector<Interval>* intervals) {
+  if (intervals->empty()) {
+    return;
+  }
+  std::sort(intervals->begin(), intervals->end());
+  size_t last = 0;
+  for (size_t i = 1; i < intervals->size(); ++i) {
+    if ((*intervals)[i].first <= (*intervals)[last].second) {
+      (*intervals)[last].second = std::max((*intervals)[last].second, (*intervals)[i].second);
+    } else {
+      (*intervals)[++last] = (*intervals)[i];
+    }
+  }
+  intervals->resize(last + 1);
+}
+
+uint64_t TotalLength(const std::vector<Interval>& merged) {
+  uint64_t total = 0;
+  for (const auto& interval : merged) {
+    total += interval.second - interval.first;
+  }
+  return total;
+}
+
+/*! \brief The length of [start, end) covered by the merged intervals. */
+uint64_t OverlapLength(const std::vector<Interval>& merged, uint64_t start, uint64_t end) {
+  // The first interval that ends after start.
+  auto it =
+      std::upper_bound(merged.begin(), merged.end(), start,
+                       [](uint64_t t, const Interval& interval) { return t < interval.second; });
+  uint64_t overlap = 0;
+  for (; it != merged.end() && it->first < end; ++it) {
+    overlap += std::min(end, it->second) - std::max(start, it->first);
+  }
+  return overlap;
+}
+
+}  // namespace
+
+TraceSummary AnalyzeTrace(const std::vector<ProfileStat>& stats,
+                          const std::vector<std::string>& comm_streams) {
+  std::unordered_set<std::string> comm_set(comm_streams.begin(), comm_streams.end());
+  std::vector<TraceEvent> events;
+  for (const auto& stat : stats) {
+    if (!IsStreamCategory(stat.categories_)) {
+      continue;
+    }
+    uint64_t start = stat.items_[ProfileStat::kStart].timestamp_;
+    uint64_t end = stat.items_[ProfileStat::kStop].timestamp_;
+    events.push_back({&stat, start, std::max(start, end), comm_set.count(stat.categories_) > 0});
+  }
+  TraceSummary summary;
+  if (events.empty()) {
+    return summary;
+  }
+
+  uint64_t first_start = events[0].start;
+  uint64_t last_end = events[0].end;
+  std::unordered_map<std::string, std::vector<Interval>> stream_intervals;
+  std::vector<Interval> compute_intervals;
+  for (const auto& e : events) {
+    first_start = std::min(first_start, e.start);
+    last_end = std::max(last_end, e.end);
+    stream_intervals[e.stat->categories_].emplace_back(e.start, e.end);
+    if (!e.is_comm) {
+      compute_intervals.emplace_back(e.start, e.end);
+    }
+  }
+  summary.makespan = last_end - first_start;
+
+  // Per-stream idle time within the makespan.
+  for (auto& kv : stream_intervals) {
+    MergeIntervals(&kv.second);
+    summary.stream_idle[kv.first] = summary.makespan - TotalLength(kv.second);
+  }
+
+  // Exposed communication: the part of each collective not overlapped by any computation.
+  MergeIntervals(&compute_intervals);
+  for (const auto& e : events) {
+    if (e.is_comm) {
+      uint64_t duration = e.end - e.start;
+      uint64_t hidden = OverlapLength(compute_intervals, e.start, e.end);
+      summary.exposed_comm.push_back({e.stat->name_, e.start, duration, duration - hidden});
+    }
+  }
+  std::sort(summary.exposed_comm.begin(), summary.exposed_comm.end(),
+            [](const ExposedCommunication& a, const ExposedCommunication& b) {
+              return a.start_time < b.start_time;
+            });
+
+  // Critical path: walk backwards from the last finishing event, each time to the latest event
+  // that finishes before the current one starts. Ties prefer the same stream.
+  std::vector<size_t> by_end(events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    by_end[i] = i;
+  }
+  std::sort(by_end.begin(), by_end.end(), [&events](size_t a, size_t b) {
+    return events[a].end < events[b].end;
+  });
+  size_t cur = by_end.back();
+  // The events in by_end[0, limit) are the candidates of predecessors.
+  size_t limit = by_end.size() - 1;
+  while (true) {
+    const TraceEvent& e = events[cur];
+    uint64_t duration = e.end - e.start;
+    summary.critical_path += duration;
+    summary.critical_path_ops[e.stat->name_] += duration;
+    auto it = std::upper_bound(by_end.begin(), by_end.begin() + limit, e.start,
+                               [&events](uint64_t t, size_t i) { return t < events[i].end; });
+    if (it == by_end.begin()) {
+      break;
+    }
+    size_t pred_pos = it - by_end.begin() - 1;
+    uint64_t pred_end = events[by_end[pred_pos]].end;
+    for (size_t pos = pred_pos; pos > 0 && events[by_end[pos - 1]].end == pred_end; --pos) {
+      if (events[by_end[pos - 1]].stat->categories_ == e.stat->categories_) {
+        pred_pos = pos - 1;
+        break;
+      }
+    }
+    summary.critical_path_idle += e.start - pred_end;
+    cur = by_end[pred_pos];
+    limit = pred_pos;
+  }
+  return summary;
+}
+
+Map<String, ObjectRef> AnalyzeProfile(Array<String> comm_streams) {
+  std::vector<std::string> streams;
+  for (const auto& stream : comm_streams) {
+    streams.push_back(stream);
+  }
+  // Keep the stats so that the trace can still be dumped afterwards.
+  auto stats = Profiler::Get()->GetProfileStats(false);
+  TraceSummary summary = AnalyzeTrace(stats, streams);
+
+  auto to_ms = [](uint64_t us) { return FloatImm(DataType::Float(32), us / 1000.0); };
+  Map<String, ObjectRef> ret;
+  ret.Set("makespan", to_ms(summary.makespan));
+  ret.Set("critical_path", to_ms(summary.critical_path));
+  ret.Set("critical_path_idle", to_ms(summary.critical_path_idle));
+  Map<String, FloatImm> op_share;
+  for (const auto& kv : summary.critical_path_ops) {
+    double share = summary.critical_path ? 1.0 * kv.second / summary.critical_path : 0.0;
+    op_share.Set(kv.first, FloatImm(DataType::Float(32), share));
+  }
+  ret.Set("critical_path_op_share", op_share);
+  Map<String, FloatImm> stream_idle;
+  for (const auto& kv : summary.stream_idle) {
+    stream_idle.Set(kv.first, to_ms(kv.second));
+  }
+  ret.Set("stream_idle", stream_idle);
+  Array<ObjectRef> exposed_comm;
+  uint64_t total_exposed = 0;
+  for (const auto& comm : summary.exposed_comm) {
+    Map<String, ObjectRef> item;
+    item.Set("name", String(comm.name));
+    item.Set("duration", to_ms(comm.duration));
+    item.Set("exposed", to_ms(comm.exposed));
+    exposed_comm.push_back(item);
+    total_exposed += comm.exposed;
+  }
+  ret.Set("exposed_comm", exposed_comm);
+  ret.Set("total_exposed_comm", to_ms(total_exposed));
+  return ret;
+}
+
+RAF_REGISTER_GLOBAL("raf.profiler.AnalyzeProfile").set_body_typed(AnalyzeProfile);
+
+UtilizationSummary AnalyzeUtilization(const std::vector<ProfileStat>& stats,
+                                      const std::unordered_map<std::string, OpWorkStat>& op_work) {
+  UtilizationSummary summary;
+  std::unordered_map<std::string, OpUtilization> ops;
+  uint64_t first_start = std::numeric_limits<uint64_t>::max();
+  uint64_t last_end = 0;
+  for (const auto& stat : stats) {
+    if (!IsStreamCategory(stat.categories_) && stat.categories_ != "ComputationOperator") {
+      continue;
+    }
+    uint64_t start = stat.items_[ProfileStat::kStart].timestamp_;
+    uint64_t end = std::max(start, stat.items_[ProfileStat::kStop].timestamp_);
+    first_start = std::min(first_start, start);
+    last_end = std::max(last_end, end);
+    summary.op_time += end - start;
+    auto it = op_work.find(stat.name_);
+    if (it == op_work.end()) {
+      continue;
+    }
+    const auto& work = it->second;
+    auto& op = ops[work.type];
+    op.type = work.type;
+    op.count += 1;
+    op.time += end - start;
+    op.gflops += work.gflops;
+    op.bytes += work.bytes;
+    summary.estimated_op_time += end - start;
+    summary.gflops += work.gflops;
+    summary.bytes += work.bytes;
+  }
+  summary.makespan = last_end > first_start ? last_end - first_start : 0;
+  for (auto& kv : ops) {
+    summary.ops.push_back(std::move(kv.second));
+  }
+  std::sort(summary.ops.begin(), summary.ops.end(),
+            [](const OpUtilization& a, const OpUtilization& b) {
+              return a.time != b.time ? a.time > b.time : a.type < b.type;
+            });
+  return summary;
+}
+
+Map<String, ObjectRef> AnalyzeUtilizationPacked(double peak_gflops, double peak_gbps) {
+  CHECK(peak_gflops > 0 && peak_gbps > 0) << "The peak throughputs must be positive";
+  auto summary = AnalyzeUtilization(Profiler::Get()->GetProfileStats(false),
+                                    Profiler::Get()->GetOpWork());
+  auto to_float = [](double value) { return FloatImm(DataType::Float(64), value); };
+  // GFLOP / us * 1e6 is GFLOPS, and bytes / us * 1e6 / 1e9 is GB/s.
+  auto set_rates = [&](Map<String, ObjectRef>* item, double gflops, double bytes, uint64_t us) {
+    double achieved_gflops = us ? gflops / us * 1e6 : 0.0;
+    double achieved_gbps = us ? bytes / us * 1e-3 : 0.0;
+    item->Set("achieved_gflops", to_float(achieved_gflops));
+    item->Set("achieved_gbps", to_float(achieved_gbps));
+    item->Set("mfu", to_float(achieved_gflops / peak_gflops));
+    item->Set("bandwidth_util", to_float(achieved_gbps / peak_gbps));
+  };
+
+  Map<String, ObjectRef> ret;
+  ret.Set("makespan", to_float(summary.makespan / 1000.0));
+  ret.Set("op_time", to_float(summary.op_time / 1000.0));
+  auto share = [&](uint64_t time) {
+    return to_float(summary.op_time ? 1.0 * time / summary.op_time : 0.0);
+  };
+  ret.Set("coverage", share(summary.estimated_op_time));
+  ret.Set("gflops", to_float(summary.gflops));
+  ret.Set("gbytes", to_float(summary.bytes / 1e9));
+  // The utilization of the whole step is over the makespan, so the idle time between the ops
+  // counts against it.
+  set_rates(&ret, summary.gflops, summary.bytes, summary.makespan);
+  Array<ObjectRef> ops;
+  for (const auto& op : summary.ops) {
+    Map<String, ObjectRef> item;
+    item.Set("type", String(op.type));
+    item.Set("count", Integer(static_cast<int64_t>(op.count)));
+    item.Set("time", to_float(op.time / 1000.0));
+    item.Set("time_share", share(op.time));
+    item.Set("gflops", to_float(op.gflops));
+    item.Set("gbytes", to_float(op.bytes / 1e9));
+    set_rates(&item, op.gflops, op.bytes, op.time);
+    ops.push_back(item);
+  }
+  ret.Set("ops", ops);
+  return ret;
+}
+
+RAF_REGISTER_GLOBAL("raf.profiler.AnalyzeUtilization").set_body_typed(AnalyzeUtilizationPacked);
+
+}  // namespace profiler
+}  // namespace raf
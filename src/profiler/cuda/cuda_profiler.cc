@@ -17,10 +17,9 @@ std::shared_ptr<device_api::DeviceAPI> CudaProfilerHelper::cuda_api =
     device_api::DeviceAPI::Get(DevType::kCUDA());
 
 CudaProfilerHelper::CudaProfilerHelper(int dev_id, raf::DevType dev_type, void* stream,
-                                       std::string name, std::string categories,
-                                       std::vector<std::string> args)
-    : ProfilerHelper(dev_id, dev_type, std::move(name), std::move(categories), std::move(args)),
-      stream(stream) {
+                                       const std::string& name, const std::string& categories,
+                                       const std::vector<std::string>& args)
+    : ProfilerHelper(dev_id, dev_type, name, categories, args), stream(stream) {
   Device device(dev_type, dev_id);
   start_event = event_pool::EventPool::Get(device)->GetEvent();
   end_event = event_pool::EventPool::Get(device)->GetEvent();
@@ -31,7 +30,7 @@ void CudaProfilerHelper::collect() {
   auto cuda_profiler = CudaProfiler::Get();
   start_time_ = cuda_profiler->GetElapsedTimeInMicrosec(start_event);
   end_time_ = cuda_profiler->GetElapsedTimeInMicrosec(end_event);
-  Profiler::Get()->AddNewProfileStat(categories_, name_, start_time_, end_time_, args);
+  Profiler::Get()->AddRecord({start_time_, end_time_, name_id_, category_id_, args_id_});
 }
 
 CudaProfiler::CudaProfiler() {
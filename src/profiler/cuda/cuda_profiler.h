@@ -53,8 +53,8 @@ using raf::event_pool::Event;
 
 class CudaProfilerHelper : public ProfilerHelper {
  public:
-  CudaProfilerHelper(int dev_id, raf::DevType dev_type, void* stream, std::string name,
-                     std::string categories, std::vector<std::string> args = {});
+  CudaProfilerHelper(int dev_id, raf::DevType dev_type, void* stream, const std::string& name,
+                     const std::string& categories, const std::vector<std::string>& args = {});
 
   void start() {
     cuda_api->EventRecordOnStream(start_event->data(), stream);
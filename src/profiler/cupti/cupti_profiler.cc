@@ -0,0 +1,285 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/cupti/cupti_profiler.cc
+ * \brief Low-overhead per-kernel tracer based on the CUPTI activity API
+ */
+#include "raf/registry.h"
+#include "raf/profiler.h"
+#include "./cupti_profiler.h"
+
+namespace raf {
+namespace profiler {
+
+/*! \brief The activity kinds traced. Runtime and driver API records are only enabled so that
+ * CUPTI emits the external correlation records of the launches; they are not kept. */
+static const CUpti_ActivityKind kTracedKinds[] = {
+    CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL, CUPTI_ACTIVITY_KIND_MEMCPY,
+    CUPTI_ACTIVITY_KIND_MEMSET,            CUPTI_ACTIVITY_KIND_RUNTIME,
+    CUPTI_ACTIVITY_KIND_DRIVER,            CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION,
+};
+
+inline uint64_t EncodeExternalId(int64_t func_index, int64_t pc) {
+  return (static_cast<uint64_t>(func_index) << 32) | (static_cast<uint64_t>(pc) & 0xffffffffULL);
+}
+
+CuptiProfiler::~CuptiProfiler() {
+  // The CUDA driver may already be unloaded at this point, so errors are ignored.
+  if (enabled_) {
+    for (auto kind : kTracedKinds) {
+      cuptiActivityDisable(kind);
+    }
+  }
+}
+
+CuptiProfiler* CuptiProfiler::Get() {
+  static CuptiProfiler cupti_profiler;
+  return &cupti_profiler;
+}
+
+void CuptiProfiler::Start(int64_t capacity, int64_t num_buffers) {
+  CHECK_GT(capacity, 0) << "The capacity of the CUPTI trace must be positive";
+  CHECK_GT(num_buffers, 0) << "The number of CUPTI buffers must be positive";
+  if (IsTracing()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(ring_mu_);
+    if (ring_.size() != static_cast<size_t>(capacity)) {
+      ring_.assign(capacity, CuptiActivityRecord());
+      num_records_ = 0;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(buffer_mu_);
+    // Buffers still held by CUPTI are returned in BufferCompleted, so only grow the pool.
+    while (buffers_.size() < static_cast<size_t>(num_buffers)) {
+      buffers_.emplace_back(kBufferSize + kBufferAlign);
+      uint8_t* data = buffers_.back().data();
+      free_buffers_.push_back(reinterpret_cast<uint8_t*>(
+          (reinterpret_cast<uintptr_t>(data) + kBufferAlign - 1) & ~(kBufferAlign - 1)));
+    }
+  }
+  if (!enabled_) {
+    CUPTI_CALL(cuptiActivityRegisterCallbacks(BufferRequested, BufferCompleted));
+    for (auto kind : kTracedKinds) {
+      CUPTI_CALL(cuptiActivityEnable(kind));
+    }
+    enabled_ = true;
+  }
+  CUPTI_CALL(cuptiGetTimestamp(&cupti_start_ns_));
+  host_start_us_ = ProfileStat::NowInMicrosec();
+  tracing_.store(true, std::memory_order_relaxed);
+}
+
+void CuptiProfiler::Stop() {
+  if (!enabled_) {
+    return;
+  }
+  tracing_.store(false, std::memory_order_relaxed);
+  CUPTI_CALL(cuptiActivityFlushAll(0));
+  for (auto kind : kTracedKinds) {
+    CUPTI_CALL(cuptiActivityDisable(kind));
+  }
+  enabled_ = false;
+}
+
+void CuptiProfiler::PushOp(int64_t func_index, int64_t pc, const std::string& op_name) {
+  uint64_t external_id = EncodeExternalId(func_index, pc);
+  {
+    std::lock_guard<std::mutex> lock(op_mu_);
+    auto it = op_names_.find(external_id);
+    if (it == op_names_.end()) {
+      op_names_.emplace(external_id, op_name);
+    } else if (it->second != op_name) {
+      // The same instruction of another executable.
+      it->second = op_name;
+    }
+  }
+  CUPTI_CALL(cuptiActivityPushExternalCorrelationId(CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0,
+                                                     external_id));
+}
+
+void CuptiProfiler::PopOp() {
+  uint64_t external_id;
+  CUPTI_CALL(
+      cuptiActivityPopExternalCorrelationId(CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0, &external_id));
+}
+
+void CuptiProfiler::Collect() {
+  if (enabled_) {
+    CUPTI_CALL(cuptiActivityFlushAll(0));
+  }
+  std::lock_guard<std::mutex> ring_lock(ring_mu_);
+  std::lock_guard<std::mutex> op_lock(op_mu_);
+  if (ring_.empty() || num_records_ == 0) {
+    return;
+  }
+  uint64_t capacity = ring_.size();
+  if (num_records_ > capacity) {
+    LOG(WARNING) << "CUPTI trace ring is full, " << num_records_ - capacity
+                 << " oldest activities are dropped. Consider a larger capacity.";
+  }
+  uint64_t first = num_records_ > capacity ? num_records_ - capacity : 0;
+  auto* prof = Profiler::Get();
+  for (uint64_t i = first; i < num_records_; ++i) {
+    const CuptiActivityRecord& record = ring_[i % capacity];
+    uint64_t start = host_start_us_ + (record.start - cupti_start_ns_) / 1000;
+    uint64_t end = host_start_us_ + (record.end - cupti_start_ns_) / 1000;
+    std::string name;
+    if (record.kind == CuptiActivityRecord::kKernel) {
+      name = kernel_names_[record.name_index];
+    } else {
+      name = record.kind == CuptiActivityRecord::kMemcpy ? "Memcpy" : "Memset";
+    }
+    std::vector<std::string> args;
+    auto corr_it = correlation_.find(record.correlation_id);
+    if (corr_it != correlation_.end()) {
+      uint64_t external_id = corr_it->second;
+      auto op_it = op_names_.find(external_id);
+      if (op_it != op_names_.end()) {
+        args.push_back(op_it->second);
+      }
+      args.push_back("func=" + std::to_string(external_id >> 32) +
+                     ",pc=" + std::to_string(external_id & 0xffffffffULL));
+    }
+    prof->AddNewProfileStat("CUPTI Stream " + std::to_string(record.stream_id), name, start, end,
+                            args);
+  }
+  num_records_ = 0;
+  correlation_.clear();
+}
+
+void CuptiProfiler::Clear() {
+  if (enabled_) {
+    CUPTI_CALL(cuptiActivityFlushAll(0));
+  }
+  std::lock_guard<std::mutex> ring_lock(ring_mu_);
+  std::lock_guard<std::mutex> op_lock(op_mu_);
+  num_records_ = 0;
+  correlation_.clear();
+  op_names_.clear();
+}
+
+void CUPTIAPI CuptiProfiler::BufferRequested(uint8_t** buffer, size_t* size,
+                                            size_t* max_num_records) {
+  auto* self = Get();
+  std::lock_guard<std::mutex> lock(self->buffer_mu_);
+  *max_num_records = 0;
+  if (self->free_buffers_.empty()) {
+    // CUPTI drops the activities when no buffer is given, which keeps the memory bounded.
+    *buffer = nullptr;
+    *size = 0;
+    return;
+  }
+  *buffer = self->free_buffers_.back();
+  *size = kBufferSize;
+  self->free_buffers_.pop_back();
+}
+
+void CUPTIAPI CuptiProfiler::BufferCompleted(CUcontext ctx, uint32_t stream_id, uint8_t* buffer,
+                                            size_t size, size_t valid_size) {
+  auto* self = Get();
+  if (valid_size > 0) {
+    self->ParseBuffer(buffer, valid_size);
+  }
+  size_t dropped = 0;
+  if (cuptiActivityGetNumDroppedRecords(ctx, stream_id, &dropped) == CUPTI_SUCCESS &&
+      dropped > 0) {
+    LOG(WARNING) << "CUPTI dropped " << dropped << " activities. Consider more buffers.";
+  }
+  std::lock_guard<std::mutex> lock(self->buffer_mu_);
+  self->free_buffers_.push_back(buffer);
+}
+
+void CuptiProfiler::ParseBuffer(uint8_t* buffer, size_t valid_size) {
+  std::lock_guard<std::mutex> lock(ring_mu_);
+  CUpti_Activity* activity = nullptr;
+  while (cuptiActivityGetNextRecord(buffer, valid_size, &activity) == CUPTI_SUCCESS) {
+    CuptiActivityRecord record;
+    switch (activity->kind) {
+      case CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL:
+      case CUPTI_ACTIVITY_KIND_KERNEL: {
+        auto* kernel = reinterpret_cast<CUpti_ActivityKernel4*>(activity);
+        record = {kernel->start,    kernel->end,      kernel->correlationId,
+                  kernel->deviceId, kernel->streamId, InternKernelName(kernel->name),
+                  CuptiActivityRecord::kKernel};
+        AddRecord(record);
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_MEMCPY: {
+        auto* memcpy = reinterpret_cast<CUpti_ActivityMemcpy*>(activity);
+        record = {memcpy->start,    memcpy->end,      memcpy->correlationId,
+                  memcpy->deviceId, memcpy->streamId, -1,
+                  CuptiActivityRecord::kMemcpy};
+        AddRecord(record);
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_MEMSET: {
+        auto* memset = reinterpret_cast<CUpti_ActivityMemset*>(activity);
+        record = {memset->start,    memset->end,      memset->correlationId,
+                  memset->deviceId, memset->streamId, -1,
+                  CuptiActivityRecord::kMemset};
+        AddRecord(record);
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION: {
+        auto* corr = reinterpret_cast<CUpti_ActivityExternalCorrelation*>(activity);
+        if (corr->externalKind == CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0) {
+          correlation_[corr->correlationId] = corr->externalId;
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+void CuptiProfiler::AddRecord(const CuptiActivityRecord& record) {
+  if (ring_.empty()) {
+    return;
+  }
+  ring_[num_records_ % ring_.size()] = record;
+  ++num_records_;
+}
+
+int32_t CuptiProfiler::InternKernelName(const char* name) {
+  // CUPTI shares the name string among all records of the same kernel, so the pointer is a
+  // cheap key; the string is copied once.
+  auto it = kernel_name_index_.find(name);
+  if (it != kernel_name_index_.end()) {
+    return it->second;
+  }
+  int32_t index = kernel_names_.size();
+  kernel_names_.emplace_back(name ? name : "unknown");
+  kernel_name_index_.emplace(name, index);
+  return index;
+}
+
+void StartCuptiProfile(int64_t capacity, int64_t num_buffers) {
+  CuptiProfiler::Get()->Start(capacity, num_buffers);
+}
+
+void StopCuptiProfile() {
+  CuptiProfiler::Get()->Stop();
+}
+
+void CollectCuptiProfile() {
+  CuptiProfiler::Get()->Collect();
+}
+
+void ClearCuptiProfile() {
+  CuptiProfiler::Get()->Clear();
+}
+
+RAF_REGISTER_GLOBAL("raf.profiler.StartCuptiProfile").set_body_typed(StartCuptiProfile);
+RAF_REGISTER_GLOBAL("raf.profiler.StopCuptiProfile").set_body_typed(StopCuptiProfile);
+RAF_REGISTER_GLOBAL("raf.profiler.CollectCuptiProfile").set_body_typed(CollectCuptiProfile);
+RAF_REGISTER_GLOBAL("raf.profiler.ClearCuptiProfile").set_body_typed(ClearCuptiProfile);
+
+}  // namespace profiler
+}  // namespace raf
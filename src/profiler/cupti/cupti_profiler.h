@@ -0,0 +1,157 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/cupti/cupti_profiler.h
+ * \brief Low-overhead per-kernel tracer based on the CUPTI activity API. GPU activities are
+ * recorded asynchronously by CUPTI into preallocated buffers, and are correlated with the VM
+ * instruction (function index and PC) and the op that launched them.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef RAF_USE_CUPTI
+#include <cupti.h>
+
+#define CUPTI_CALL(func)                                                  \
+  do {                                                                    \
+    CUptiResult e = (func);                                               \
+    if (e != CUPTI_SUCCESS) {                                             \
+      const char* msg;                                                    \
+      cuptiGetResultString(e, &msg);                                      \
+      LOG(FATAL) << "CUPTI error " << static_cast<int>(e) << ": " << msg; \
+    }                                                                     \
+  } while (false)
+
+#define WITH_CUPTI_TRACE(FUNC_INDEX, PC, NAME, CODE_SNIPPET) \
+  {                                                          \
+    auto* _cupti = raf::profiler::CuptiProfiler::Get();      \
+    if (_cupti->IsTracing()) {                               \
+      _cupti->PushOp(FUNC_INDEX, PC, NAME);                  \
+      CODE_SNIPPET                                           \
+      _cupti->PopOp();                                       \
+    } else {                                                 \
+      CODE_SNIPPET                                           \
+    }                                                        \
+  }
+
+#else
+
+#define WITH_CUPTI_TRACE(FUNC_INDEX, PC, NAME, CODE_SNIPPET) \
+  { CODE_SNIPPET }
+
+#endif
+
+#ifdef RAF_USE_CUPTI
+
+namespace raf {
+namespace profiler {
+
+/*! \brief A GPU activity reported by CUPTI. Plain data so that the ring never allocates. */
+struct CuptiActivityRecord {
+  enum Kind : uint8_t { kKernel, kMemcpy, kMemset };
+  /*! \brief Start and end timestamps in the CUPTI clock (ns). */
+  uint64_t start;
+  uint64_t end;
+  /*! \brief The CUPTI correlation id of the API call that launched this activity. */
+  uint32_t correlation_id;
+  uint32_t device_id;
+  uint32_t stream_id;
+  /*! \brief Index into the interned kernel names, or -1 for copies and sets. */
+  int32_t name_index;
+  Kind kind;
+};
+
+class CuptiProfiler {
+ public:
+  ~CuptiProfiler();
+  static CuptiProfiler* Get();
+  /*!
+   * \brief Start tracing. All buffers are allocated here so that tracing itself does not
+   * allocate on the host critical path.
+   * \param capacity The number of activity records kept in the ring. When the ring is full the
+   * oldest records are overwritten.
+   * \param num_buffers The number of activity buffers handed to CUPTI.
+   */
+  void Start(int64_t capacity, int64_t num_buffers);
+  /*! \brief Stop tracing and flush the pending activity buffers. */
+  void Stop();
+  /*! \brief Flush CUPTI and convert the traced activities into profile stats. */
+  void Collect();
+  /*! \brief Drop all traced activities. */
+  void Clear();
+
+  inline bool IsTracing() const {
+    return tracing_.load(std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Tag the GPU work launched by the calling thread until PopOp with a VM instruction.
+   * \param func_index The index of the VM function.
+   * \param pc The program counter of the InvokeJit instruction.
+   * \param op_name The name of the op being executed.
+   */
+  void PushOp(int64_t func_index, int64_t pc, const std::string& op_name);
+  /*! \brief Stop tagging the GPU work launched by the calling thread. */
+  void PopOp();
+
+ private:
+  CuptiProfiler() = default;
+
+  static void CUPTIAPI BufferRequested(uint8_t** buffer, size_t* size, size_t* max_num_records);
+  static void CUPTIAPI BufferCompleted(CUcontext ctx, uint32_t stream_id, uint8_t* buffer,
+                                       size_t size, size_t valid_size);
+  /*! \brief Parse the records in an activity buffer. Runs on the CUPTI worker thread. */
+  void ParseBuffer(uint8_t* buffer, size_t valid_size);
+  /*! \brief Push a record into the ring. The caller must hold ring_mu_. */
+  void AddRecord(const CuptiActivityRecord& record);
+  /*! \brief Intern a kernel name. The caller must hold ring_mu_. */
+  int32_t InternKernelName(const char* name);
+
+  /*! \brief The size of each activity buffer in bytes. */
+  static constexpr size_t kBufferSize = 4 << 20;
+  /*! \brief The alignment CUPTI requires for the activity buffers. */
+  static constexpr size_t kBufferAlign = 8;
+
+  /*! \brief Whether the VM should tag its kernels. */
+  std::atomic<bool> tracing_{false};
+  /*! \brief Whether the CUPTI callbacks and activity kinds are registered. */
+  bool enabled_ = false;
+
+  /*! \brief The preallocated activity buffers and the ones not held by CUPTI. */
+  std::vector<std::vector<uint8_t>> buffers_;
+  std::vector<uint8_t*> free_buffers_;
+  std::mutex buffer_mu_;
+
+  /*! \brief The ring of traced activities. */
+  std::vector<CuptiActivityRecord> ring_;
+  /*! \brief The number of activities pushed into the ring since the last clear. */
+  uint64_t num_records_ = 0;
+  /*! \brief The CUPTI correlation id -> external (VM instruction) id. */
+  std::unordered_map<uint32_t, uint64_t> correlation_;
+  /*! \brief The interned kernel names. */
+  std::vector<std::string> kernel_names_;
+  std::unordered_map<const char*, int32_t> kernel_name_index_;
+  std::mutex ring_mu_;
+
+  /*! \brief The op name of each tagged VM instruction, keyed by its external id. */
+  std::unordered_map<uint64_t, std::string> op_names_;
+  std::mutex op_mu_;
+
+  /*! \brief The CUPTI and host timestamps when tracing started, to align the two clocks. */
+  uint64_t cupti_start_ns_ = 0;
+  uint64_t host_start_us_ = 0;
+};
+
+}  // namespace profiler
+}  // namespace raf
+
+#endif
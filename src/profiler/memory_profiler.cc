@@ -7,6 +7,7 @@
  * \file src/profiler/memory_profiler.cc
  * \brief Memory profiler implementation
  */
+#include <algorithm>
 #include "raf/registry.h"
 #include "raf/memory_profiler.h"
 #include "raf/memory_pool.h"
@@ -33,6 +34,50 @@ void MemoryProfiler::Record(const Device& device, const std::string& tag) {
     // GC was triggered if the current allocated memory is smaller than the previous one.
     memory_stats_[device_str].num_gc++;
   }
+  auto& stat = memory_stats_[device_str];
+  for (size_t idx : stat.pending_ops) {
+    stat.allocations[idx].op = tag;
+  }
+  stat.pending_ops.clear();
+}
+
+void MemoryProfiler::RecordAlloc(const Device& device, const void* key, int64_t nbytes,
+                                 const std::string& var, int64_t stream_id) {
+  auto& stat = memory_stats_[std::string(device.c_str())];
+  if (stat.live_allocations.count(key)) {
+    return;
+  }
+  AllocationRecord record;
+  record.nbytes = nbytes;
+  record.var = var;
+  record.stream_id = stream_id;
+  record.alloc_trace = stat.traces.size();
+  record.alloc_seq = stat.num_events++;
+  stat.live_allocations[key] = stat.allocations.size();
+  stat.pending_ops.push_back(stat.allocations.size());
+  stat.allocations.push_back(std::move(record));
+  stat.live_bytes += nbytes;
+  if (stat.live_bytes > stat.peak_live_bytes) {
+    stat.peak_live_bytes = stat.live_bytes;
+    stat.peak_seq = stat.allocations.back().alloc_seq;
+  }
+}
+
+void MemoryProfiler::RecordFree(const Device& device, const void* key) {
+  auto stat_it = memory_stats_.find(std::string(device.c_str()));
+  if (stat_it == memory_stats_.end()) {
+    return;
+  }
+  auto& stat = stat_it->second;
+  auto it = stat.live_allocations.find(key);
+  if (it == stat.live_allocations.end()) {
+    return;
+  }
+  auto& record = stat.allocations[it->second];
+  record.free_trace = stat.traces.size();
+  record.free_seq = stat.num_events++;
+  stat.live_bytes -= record.nbytes;
+  stat.live_allocations.erase(it);
 }
 
 void MemoryProfiler::Reset() {
@@ -88,6 +133,96 @@ std::string MemoryProfiler::GetMemoryTrace(const Device& device) {
   return os.str();
 }
 
+Map<String, ObjectRef> MemoryProfiler::GetAllocationReport(const Device& device,
+                                                           float predicted_peak) {
+  auto to_mb = [](double nbytes) { return FloatImm(DataType::Float(32), nbytes / 1048576.0); };
+  auto device_str = std::string(device.c_str());
+  MemoryStat empty;
+  const auto& stat = memory_stats_.count(device_str) ? memory_stats_[device_str] : empty;
+
+  // The live set when the tracked live bytes reach the peak.
+  std::vector<const AllocationRecord*> live_set;
+  std::unordered_map<std::string, int64_t> live_by_op;
+  for (const auto& record : stat.allocations) {
+    if (record.alloc_seq <= stat.peak_seq &&
+        (record.free_seq == -1 || record.free_seq > stat.peak_seq)) {
+      live_set.push_back(&record);
+      live_by_op[record.op] += record.nbytes;
+    }
+  }
+  std::sort(live_set.begin(), live_set.end(),
+            [](const AllocationRecord* a, const AllocationRecord* b) {
+              return a->nbytes > b->nbytes;
+            });
+  Array<ObjectRef> live_items;
+  for (auto record : live_set) {
+    Map<String, ObjectRef> item;
+    item.Set("var", String(record->var));
+    item.Set("op", String(record->op));
+    item.Set("stream", Integer(record->stream_id));
+    item.Set("size", to_mb(record->nbytes));
+    live_items.push_back(item);
+  }
+  Map<String, FloatImm> op_items;
+  for (const auto& kv : live_by_op) {
+    op_items.Set(kv.first, to_mb(kv.second));
+  }
+
+  Map<String, ObjectRef> ret;
+  ret.Set("peak_live", to_mb(stat.peak_live_bytes));
+  ret.Set("live_at_peak", live_items);
+  ret.Set("live_at_peak_by_op", op_items);
+  ret.Set("num_allocations", Integer(static_cast<int64_t>(stat.allocations.size())));
+
+  // The fragmentation of the pool when it uses the most memory.
+  float pool_used = 0, pool_allocated = 0;
+  if (!stat.traces.empty()) {
+    pool_used = stat.traces[stat.max_trace_idx].used;
+    pool_allocated = stat.traces[stat.max_trace_idx].allocated;
+  }
+  ret.Set("peak_pool_used", FloatImm(DataType::Float(32), pool_used));
+  ret.Set("peak_pool_allocated", FloatImm(DataType::Float(32), pool_allocated));
+  ret.Set("fragmentation",
+          FloatImm(DataType::Float(32), pool_allocated > 0 ? 1 - pool_used / pool_allocated : 0));
+
+  if (predicted_peak > 0) {
+    // The pool peak also counts the parameters and inputs, as EstimateMemory does by default.
+    float measured = pool_used > 0 ? pool_used : stat.peak_live_bytes / 1048576.0;
+    ret.Set("predicted_peak", FloatImm(DataType::Float(32), predicted_peak));
+    ret.Set("prediction_error",
+            FloatImm(DataType::Float(32), (measured - predicted_peak) / predicted_peak));
+  }
+  return ret;
+}
+
+std::string MemoryProfiler::GetAllocationTrace(const Device& device) {
+  auto device_str = std::string(device.c_str());
+  if (memory_stats_.count(device_str) == 0) {
+    return "";
+  }
+
+  std::ostringstream os;
+  os << "Sizes are in MBs. Trace indices refer to the memory trace. -1 means never freed."
+     << std::endl;
+  os << std::setw(8) << std::left << "#Alloc\t" << std::setw(8) << std::left << "#Free";
+  os << "\t" << std::setw(15) << std::left << "size";
+  os << "\t" << std::setw(8) << std::left << "stream";
+  os << "\t" << std::setw(30) << std::left << "var";
+  os << "\t" << "op";
+  os << std::endl;
+
+  for (const auto& record : memory_stats_[device_str].allocations) {
+    os << std::setw(8) << std::left << record.alloc_trace << "\t" << std::setw(8) << std::left
+       << record.free_trace;
+    os << "\t" << std::setw(15) << std::left << record.nbytes / 1048576.0;
+    os << "\t" << std::setw(8) << std::left << record.stream_id;
+    os << "\t" << std::setw(30) << std::left << record.var;
+    os << "\t" << record.op;
+    os << std::endl;
+  }
+  return os.str();
+}
+
 void EnableMemoryProfiler() {
   MemoryProfiler::Get()->SetProfile(true);
 }
@@ -108,6 +243,14 @@ std::string GetMemoryTrace(const Device& device) {
   return MemoryProfiler::Get()->GetMemoryTrace(device);
 }
 
+Map<String, ObjectRef> GetAllocationReport(const Device& device, double predicted_peak) {
+  return MemoryProfiler::Get()->GetAllocationReport(device, predicted_peak);
+}
+
+std::string GetAllocationTrace(const Device& device) {
+  return MemoryProfiler::Get()->GetAllocationTrace(device);
+}
+
 RAF_REGISTER_GLOBAL("raf.memory_profiler.EnableMemoryProfiler")
     .set_body_typed(EnableMemoryProfiler);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.DisableMemoryeProfiler")
@@ -115,6 +258,9 @@ RAF_REGISTER_GLOBAL("raf.memory_profiler.DisableMemoryeProfiler")
 RAF_REGISTER_GLOBAL("raf.memory_profiler.ResetMemoryProfiler").set_body_typed(ResetMemoryProfiler);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.GetMaxMemoryInfo").set_body_typed(GetMaxMemoryInfo);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.GetMemoryTrace").set_body_typed(GetMemoryTrace);
+RAF_REGISTER_GLOBAL("raf.memory_profiler.GetAllocationReport")
+    .set_body_typed(GetAllocationReport);
+RAF_REGISTER_GLOBAL("raf.memory_profiler.GetAllocationTrace").set_body_typed(GetAllocationTrace);
 
 }  // namespace memory_profiler
 }  // namespace raf
@@ -0,0 +1,63 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/nvtx/nvtx.cc
+ * \brief NVTX ranges of the ops, the passes and the VM phases.
+ */
+#include <nvtx3/nvToolsExt.h>
+#include <cstdlib>
+#include "raf/registry.h"
+#include "./nvtx.h"
+
+namespace raf {
+namespace profiler {
+namespace nvtx {
+
+/*! \brief Whether the ranges are enabled when the library is loaded. */
+bool DefaultEnabled() {
+  const char* env = std::getenv("RAF_NVTX");
+  if (env != nullptr) {
+    return std::atoi(env) != 0;
+  }
+  // Nsight Systems injects its NVTX handler through this variable.
+  return std::getenv("NVTX_INJECTION64_PATH") != nullptr;
+}
+
+std::atomic<bool> enabled{DefaultEnabled()};
+
+/*! \brief Get the handle of a domain, which is created on the first use. */
+nvtxDomainHandle_t GetDomain(Domain domain) {
+  static const char* names[] = {"raf.vm", "raf.op", "raf.pass", "raf.jit", "raf.comm"};
+  static_assert(sizeof(names) / sizeof(names[0]) == static_cast<int>(Domain::kNumDomains),
+                "Each NVTX domain needs a name");
+  static nvtxDomainHandle_t handles[static_cast<int>(Domain::kNumDomains)] = {
+      nvtxDomainCreateA(names[0]), nvtxDomainCreateA(names[1]), nvtxDomainCreateA(names[2]),
+      nvtxDomainCreateA(names[3]), nvtxDomainCreateA(names[4])};
+  return handles[static_cast<int>(domain)];
+}
+
+void PushRange(Domain domain, const std::string& message) {
+  nvtxEventAttributes_t attrs = {0};
+  attrs.version = NVTX_VERSION;
+  attrs.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE;
+  attrs.messageType = NVTX_MESSAGE_TYPE_ASCII;
+  attrs.message.ascii = message.c_str();
+  nvtxDomainRangePushEx(GetDomain(domain), &attrs);
+}
+
+void PopRange(Domain domain) {
+  nvtxDomainRangePop(GetDomain(domain));
+}
+
+RAF_REGISTER_GLOBAL("raf.profiler.EnableNVTX").set_body_typed([](bool enable) {
+  enabled.store(enable, std::memory_order_relaxed);
+});
+
+RAF_REGISTER_GLOBAL("raf.profiler.NVTXEnabled").set_body_typed([]() { return IsEnabled(); });
+
+}  // namespace nvtx
+}  // namespace profiler
+}  // namespace raf
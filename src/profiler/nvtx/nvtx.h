@@ -0,0 +1,105 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/nvtx/nvtx.h
+ * \brief NVTX ranges of the ops, the passes and the VM phases, so they show up in the timelines of
+ * Nsight Systems. Each subsystem has its own domain, so its ranges can be filtered.
+ */
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#ifdef RAF_USE_NVTX
+
+namespace raf {
+namespace profiler {
+namespace nvtx {
+
+/*! \brief The NVTX domains, which are named "raf.<subsystem>" in Nsight Systems. */
+enum class Domain : int {
+  /*! \brief The VM phases, e.g., preparing the context. */
+  kVM = 0,
+  /*! \brief The ops executed by the VM. */
+  kOp,
+  /*! \brief The passes run by RAFSequential. */
+  kPass,
+  /*! \brief The JIT compilation of the TVM ops. */
+  kJIT,
+  /*! \brief The NCCL collectives. */
+  kComm,
+  kNumDomains,
+};
+
+/*!
+ * \brief Whether the ranges are emitted. It is on by default when the process runs under an
+ * NVTX tool such as Nsight Systems, which sets NVTX_INJECTION64_PATH, and can be overridden by
+ * the RAF_NVTX environment variable or raf.utils.profiler.enable_nvtx.
+ */
+extern std::atomic<bool> enabled;
+
+inline bool IsEnabled() {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+/*! \brief Push a range to the domain on the calling thread. */
+void PushRange(Domain domain, const std::string& message);
+
+/*! \brief Pop the latest range of the domain on the calling thread. */
+void PopRange(Domain domain);
+
+/*!
+ * \brief A range that lasts until the end of the scope. The message is only built when the ranges
+ * are enabled, so a disabled range costs a relaxed load.
+ */
+class ScopedRange {
+ public:
+  template <typename FMessage>
+  ScopedRange(Domain domain, FMessage f_message) : domain_(domain) {
+    if (IsEnabled()) {
+      PushRange(domain_, f_message());
+      active_ = true;
+    }
+  }
+
+  ~ScopedRange() {
+    if (active_) {
+      PopRange(domain_);
+    }
+  }
+
+  ScopedRange(const ScopedRange&) = delete;
+  ScopedRange& operator=(const ScopedRange&) = delete;
+
+ private:
+  Domain domain_;
+  bool active_ = false;
+};
+
+}  // namespace nvtx
+}  // namespace profiler
+}  // namespace raf
+
+#define RAF_NVTX_CONCAT_IMPL(A, B) A##B
+#define RAF_NVTX_CONCAT(A, B) RAF_NVTX_CONCAT_IMPL(A, B)
+
+/*!
+ * \brief Annotate the rest of the scope with a range, e.g., RAF_NVTX_RANGE(kPass, name). The
+ * message expression is not evaluated when the ranges are disabled.
+ */
+#define RAF_NVTX_RANGE(DOMAIN, MESSAGE)                                     \
+  raf::profiler::nvtx::ScopedRange RAF_NVTX_CONCAT(_nvtx_range_, __LINE__)( \
+      raf::profiler::nvtx::Domain::DOMAIN, [&]() { return std::string(MESSAGE); })
+
+#define RAF_NVTX_ENABLED() raf::profiler::nvtx::IsEnabled()
+
+#else
+
+#define RAF_NVTX_RANGE(DOMAIN, MESSAGE)
+
+#define RAF_NVTX_ENABLED() false
+
+#endif
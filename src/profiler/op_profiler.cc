@@ -12,7 +12,9 @@
 #include "raf/ir.h"
 #include "../op/dialect/tvm/tvm_utils.h"
 #include "../requests.h"
+#include <algorithm>
 #include <chrono>
+#include <unordered_set>
 
 namespace raf {
 namespace op_profiler {
@@ -35,28 +37,124 @@ OpProfiler* OpProfiler::Get(const Device& device) {
   }
 }
 
-OpWithData::OpWithData(const Device device, const Expr& op, const int stream_id)
-    : stream_id(stream_id) {
+DummyArena::DummyArena(const Device& device, int64_t nbytes) : device_(device), nbytes_(nbytes) {
+  memory_ = memory_pool::Memory::Alloc(device, std::max<int64_t>(nbytes, 1), kAlign);
+  // Zero the arena to avoid memory errors of the ops reading integer inputs as indices.
+#ifdef RAF_USE_CUDA
+  if (device.device_type() == DevType::kCUDA()) {
+    CUDA_CALL(cudaMemset(memory_->data, 0, nbytes));
+  } else
+#endif
+    memset(memory_->data, 0, nbytes);
+}
+
+int64_t DummyArena::TypeBytes(const Type& type) {
+  if (auto tensor_type = type.as<TensorTypeNode>()) {
+    int64_t nbytes = tensor_type->dtype.bytes();
+    for (auto v : tensor_type->shape) {
+      const auto* int_imm = v.as<IntImmNode>();
+      CHECK(int_imm != nullptr) << "Only supports creating dummy tensor value with static shape.";
+      nbytes *= int_imm->value;
+    }
+    return (nbytes + kAlign - 1) / kAlign * kAlign;
+  } else if (auto tuple_type = type.as<TupleTypeNode>()) {
+    int64_t nbytes = 0;
+    for (auto field_type : tuple_type->fields) {
+      nbytes += TypeBytes(field_type);
+    }
+    return nbytes;
+  }
+  LOG(FATAL) << "NotImplementedError: Do not support creating dummy value for type " << type;
+  throw;
+}
+
+int64_t DummyArena::CallBytes(const Call& call) {
+  int64_t nbytes = TypeBytes(call->checked_type());
+  for (auto arg : call->args) {
+    if (!arg->IsInstance<RelayConstantNode>()) {
+      nbytes += TypeBytes(arg->checked_type());
+    }
+  }
+  return nbytes;
+}
+
+Value DummyArena::Create(const Type& type) {
+  if (auto tensor_type = type.as<TensorTypeNode>()) {
+    std::vector<int64_t> shape;
+    for (auto v : tensor_type->shape) {
+      shape.push_back(v.as<IntImmNode>()->value);
+    }
+    int64_t nbytes = TypeBytes(type);
+    CHECK_LE(offset_ + nbytes, nbytes_) << "The dummy arena is too small";
+    void* data = static_cast<char*>(memory_->data) + offset_;
+    offset_ += nbytes;
+    return TensorValue::Assemble(device_, tensor_type->dtype, shape, {}, data, memory_);
+  } else if (auto tuple_type = type.as<TupleTypeNode>()) {
+    Array<Value> fields;
+    for (auto field_type : tuple_type->fields) {
+      fields.push_back(Create(field_type));
+    }
+    return TupleValue::make(fields);
+  }
+  LOG(FATAL) << "NotImplementedError: Do not support creating dummy value for type " << type;
+  throw;
+}
+
+OpWithData::OpWithData(const Device device, const Expr& op, const int stream_id,
+                       OpEnvPtr built_op_env)
+    : op_env(built_op_env), stream_id(stream_id) {
   // Nothing to do with non-call nodes.
   if (!op->IsInstance<CallNode>()) {
     return;
   }
 
-  // JIT the op.
+  // JIT the op if it has not been built.
   auto call = Downcast<Call>(op);
-  CallValues call_values = CreateDummyCallValues(call, device);
-  op_env = Dispatch(call_values);
+  if (op_env == nullptr) {
+    CallValues call_values = CreateDummyCallValues(call, device);
+    op_env = Dispatch(call_values);
+  }
 
   // Create the dummy inputs and outputs.
   output = CreateDummyValueFromType(op->checked_type(), device);
-  std::vector<Value> temp_inputs;
+  std::vector<Value> args;
   for (auto arg : call->args) {
-    if (auto const_node = arg.as<RelayConstantNode>()) {
+    if (!arg->IsInstance<RelayConstantNode>()) {
+      args.push_back(CreateDummyValueFromType(arg->checked_type(), device));
+    } else {
+      args.push_back(Value());
+    }
+  }
+  Prepare(call, args);
+}
+
+OpWithData::OpWithData(const Device device, const Expr& op, OpEnvPtr op_env, DummyArena* arena)
+    : op_env(op_env) {
+  if (op_env == nullptr || !op->IsInstance<CallNode>()) {
+    return;
+  }
+  auto call = Downcast<Call>(op);
+  output = arena->Create(op->checked_type());
+  std::vector<Value> args;
+  for (auto arg : call->args) {
+    if (!arg->IsInstance<RelayConstantNode>()) {
+      args.push_back(arena->Create(arg->checked_type()));
+    } else {
+      args.push_back(Value());
+    }
+  }
+  Prepare(call, args);
+}
+
+void OpWithData::Prepare(const Call& call, const std::vector<Value>& args) {
+  std::vector<Value> temp_inputs;
+  for (size_t i = 0; i < call->args.size(); ++i) {
+    if (auto const_node = call->args[i].as<RelayConstantNode>()) {
       const auto casted_const_node = static_cast<const ConstantNode*>(const_node);
       CHECK_NOTNULL(casted_const_node);
       temp_inputs.push_back(Downcast<Value>(casted_const_node->value));
     } else {
-      temp_inputs.push_back(CreateDummyValueFromType(arg->checked_type(), device));
+      temp_inputs.push_back(args[i]);
     }
   }
   for (int k : op_env->arg_indices) {
@@ -121,13 +219,23 @@ std::pair<std::vector<float>, float> OpProfiler::ProfileOpGroup(const std::vecto
     return latency_and_workspace_size_cache_[key];
   }
 
-  // Prepare ops for profiling.
+  // Prepare ops for profiling. The built OpEnvs are reused, except for the repeated ops in the
+  // group, which need their own workspaces.
   std::vector<OpWithDataPtr> ops_with_data;
+  std::unordered_set<std::string> used_op_envs;
   int64_t total_workspace_size = 0;
   for (size_t i = 0; i < ops.size(); ++i) {
     auto op = ops[i];
     auto stream_id = stream_ids.empty() ? -1 : stream_ids[i];
-    auto single_op_with_data = std::make_shared<OpWithData>(device_, op, stream_id);
+    OpEnvPtr op_env = nullptr;
+    if (auto call_node = op.as<CallNode>()) {
+      auto call_key_str = HashKeyToStr(HashCall(GetRef<Call>(call_node)));
+      auto it = op_env_cache_.find(call_key_str);
+      if (it != op_env_cache_.end() && used_op_envs.insert(call_key_str).second) {
+        op_env = it->second;
+      }
+    }
+    auto single_op_with_data = std::make_shared<OpWithData>(device_, op, stream_id, op_env);
     ops_with_data.push_back(single_op_with_data);
     // Currently using the sum of the workspace sizes of all ops as workspace size
     // Might need refactoring
@@ -179,6 +287,72 @@ std::pair<std::vector<float>, float> OpProfiler::ProfileOp(const Expr& op, int32
   return std::make_pair(std::vector<float>(repeat, 0.0), 0.0f);
 }
 
+std::vector<std::pair<std::vector<float>, float>> OpProfiler::ProfileOps(
+    const std::vector<Expr>& ops, int32_t warmup, int32_t exec_number, int32_t repeat,
+    int num_threads) {
+  // Dedup the calls that miss the cache.
+  std::vector<std::string> keys(ops.size());
+  std::vector<Call> calls;
+  std::vector<std::string> call_keys;
+  std::vector<std::string> latency_keys;
+  std::unordered_set<std::string> seen;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    if (auto call_node = ops[i].as<CallNode>()) {
+      auto call = GetRef<Call>(call_node);
+      auto call_hash_key = HashCall(call);
+      auto call_key_str = HashKeyToStr(call_hash_key);
+      keys[i] = HashKeyToStr(call_hash_key << warmup << exec_number << repeat);
+      if (latency_and_workspace_size_cache_.count(keys[i]) == 0 && seen.insert(keys[i]).second) {
+        calls.push_back(call);
+        call_keys.push_back(call_key_str);
+        latency_keys.push_back(keys[i]);
+      }
+    }
+  }
+
+  if (!calls.empty()) {
+    int64_t arena_bytes = 0;
+    for (const auto& call : calls) {
+      arena_bytes = std::max(arena_bytes, DummyArena::CallBytes(call));
+    }
+    DummyArena arena(device_, arena_bytes);
+
+    // Create the dummy call values serially. Since building an op does not need meaningful data,
+    // all calls share the same region of the arena.
+    std::vector<CallValues> call_values;
+    for (const auto& call : calls) {
+      arena.Rewind();
+      call_values.push_back(CreateDummyCallValues(
+          call, device_, [&arena](const Type& type) { return arena.Create(type); }));
+    }
+
+    // Build the ops concurrently.
+    std::vector<OpEnvPtr> op_envs = DispatchParallel(call_values, num_threads);
+
+    // Profile the ops one by one on the same arena.
+    for (size_t i = 0; i < calls.size(); ++i) {
+      op_env_cache_[call_keys[i]] = op_envs[i];
+      arena.Rewind();
+      OpWithDataPtr op_with_data =
+          std::make_shared<OpWithData>(device_, calls[i], op_envs[i], &arena);
+      std::vector<float> cost = RunOp(op_with_data, warmup, exec_number, repeat);
+      int64_t workspace_size = op_with_data->workspace_size;
+      latency_and_workspace_size_cache_[latency_keys[i]] =
+          std::make_pair(std::move(cost), workspace_size);
+    }
+  }
+
+  std::vector<std::pair<std::vector<float>, float>> ret;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    if (keys[i].empty()) {
+      ret.push_back(std::make_pair(std::vector<float>(repeat, 0.0), 0.0f));
+    } else {
+      ret.push_back(latency_and_workspace_size_cache_[keys[i]]);
+    }
+  }
+  return ret;
+}
+
 std::vector<float> CPUOpProfiler::RunOp(const OpWithDataPtr& op_with_data, int32_t warmup,
                                         int32_t exec_number, int32_t repeat) {
   if (!op_with_data->profilable()) {
@@ -389,6 +563,36 @@ RAF_REGISTER_GLOBAL("raf.op_profiler.ProfileGroup")
       *ret = results;
     });
 
+RAF_REGISTER_GLOBAL("raf.op_profiler.ProfileBatch")
+    .set_body([](tvm::runtime::TVMArgs args, tvm::runtime::TVMRetValue* ret) {
+      CHECK_GE(args.size(), 2U)
+          << "Expected (exprs, device, <warmup>, <exec>, <repeat>, <num_threads>)";
+      Array<Expr> exprs = args[0];
+      Device device = args[1];
+      int warmup = (args.size() >= 3) ? args[2] : 10;
+      int exec_number = (args.size() >= 4) ? args[3] : 10;
+      int repeat = (args.size() >= 5) ? args[4] : 1;
+      int num_threads = (args.size() == 6) ? args[5] : 0;
+      auto profiler = OpProfiler::Get(device);
+
+      Array<Map<String, ObjectRef>> results;
+      auto lat_and_workspace_sizes =
+          profiler->ProfileOps(std::vector<Expr>(exprs.begin(), exprs.end()), warmup, exec_number,
+                               repeat, num_threads);
+      for (const auto& lat_and_workspace_size : lat_and_workspace_sizes) {
+        Map<String, ObjectRef> result;
+        Array<FloatImm> lat_results;
+        for (float lat : lat_and_workspace_size.first) {
+          lat_results.push_back(FloatImm(DataType::Float(32), lat));
+        }
+        result.Set("latency", lat_results);
+        result.Set("workspace_size",
+                   FloatImm(DataType::Float(32), lat_and_workspace_size.second));
+        results.push_back(result);
+      }
+      *ret = results;
+    });
+
 RAF_REGISTER_GLOBAL("raf.op_profiler.ResetCache").set_body_typed([](const Device& device) {
   auto profiler = OpProfiler::Get(device);
   return profiler->Reset();
@@ -0,0 +1,160 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file tests/cpp/bench/alloc_bench.cc
+ * \brief Replay of the allocation traces captured from the VM against the memory pools. Every
+ * trace is replayed on a new pool of each kind, and the allocation throughput, the peak reserved
+ * memory and the fragmentation at the peak are compared.
+ *
+ * Usage:
+ *   raf_alloc_bench --traces a.trace,b.trace [--pools page_unit_pool,no_pool,...] [--repeat 5]
+ *                   [--output results.json]
+ *
+ * The traces are captured by raf.utils.memory_profiler.start_alloc_trace and stop_alloc_trace,
+ * and are replayed on the device they are captured on. The results written to --output are keyed
+ * by "trace/pool" so that runs can be diffed for regressions.
+ */
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <raf/alloc_trace.h>
+#include <raf/device.h>
+#include <raf/registry.h>
+
+namespace raf {
+namespace bench {
+
+using memory_pool::AllocReplayStats;
+using memory_pool::AllocTrace;
+
+/*! \brief The command line options. */
+struct BenchOptions {
+  std::vector<std::string> traces;
+  std::vector<std::string> pools = {"page_unit_pool", "size_class_pool", "no_pool"};
+  int repeat = 5;
+  std::string output;
+};
+
+/*! \brief The result of replaying a trace against a pool. */
+struct BenchResult {
+  std::string trace;
+  std::string pool;
+  AllocReplayStats stats;
+};
+
+std::vector<std::string> Split(const std::string& str) {
+  std::vector<std::string> ret;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      ret.push_back(item);
+    }
+  }
+  return ret;
+}
+
+BenchOptions ParseOptions(int argc, char** argv) {
+  BenchOptions opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string key = argv[i];
+    std::string value;
+    auto eq = key.find('=');
+    if (eq != std::string::npos) {
+      value = key.substr(eq + 1);
+      key = key.substr(0, eq);
+    } else {
+      CHECK_LT(i + 1, argc) << "Missing the value of " << key;
+      value = argv[++i];
+    }
+    if (key == "--traces") {
+      opts.traces = Split(value);
+    } else if (key == "--pools") {
+      opts.pools = Split(value);
+    } else if (key == "--repeat") {
+      opts.repeat = std::stoi(value);
+    } else if (key == "--output") {
+      opts.output = value;
+    } else {
+      LOG(FATAL) << "Unknown option " << key;
+    }
+  }
+  CHECK(!opts.traces.empty()) << "--traces is required";
+  CHECK_GT(opts.repeat, 0) << "--repeat must be positive";
+  return opts;
+}
+
+double EventsPerSec(const AllocReplayStats& stats) {
+  return stats.seconds > 0 ? stats.num_events / stats.seconds : 0;
+}
+
+void PrintResult(const BenchResult& res) {
+  const AllocReplayStats& s = res.stats;
+  std::cout << std::left << std::setw(48) << res.trace + "/" + res.pool << std::right << std::fixed
+            << std::setprecision(2) << std::setw(12) << EventsPerSec(s) / 1e6 << " M events/s"
+            << std::setw(12) << s.peak_requested_mb << " MB requested" << std::setw(12)
+            << s.peak_reserved_mb << " MB reserved" << std::setw(8) << s.fragmentation * 100
+            << "% fragmented" << std::endl;
+}
+
+void WriteJSON(const std::string& path, const std::vector<BenchResult>& results,
+               const BenchOptions& opts) {
+  std::ofstream os(path);
+  CHECK(os.good()) << "Cannot open " << path;
+  static const PackedFunc& git_version = registry::GetPackedFunc("raf.build_info.git_version");
+  std::string git = git_version();
+  os << std::setprecision(6) << "{\n"
+     << "  \"git_version\": \"" << git << "\",\n"
+     << "  \"repeat\": " << opts.repeat << ",\n"
+     << "  \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchResult& res = results[i];
+    const AllocReplayStats& s = res.stats;
+    os << (i ? "," : "") << "\n    {\"key\": \"" << res.trace << "/" << res.pool
+       << "\", \"trace\": \"" << res.trace << "\", \"pool\": \"" << res.pool
+       << "\", \"num_events\": " << s.num_events << ", \"seconds\": " << s.seconds
+       << ", \"events_per_sec\": " << EventsPerSec(s)
+       << ", \"peak_requested_mb\": " << s.peak_requested_mb
+       << ", \"peak_used_mb\": " << s.peak_used_mb
+       << ", \"peak_reserved_mb\": " << s.peak_reserved_mb
+       << ", \"fragmentation\": " << s.fragmentation << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+int Main(int argc, char** argv) {
+  BenchOptions opts = ParseOptions(argc, argv);
+  std::vector<BenchResult> results;
+  for (const auto& path : opts.traces) {
+    AllocTrace trace = AllocTrace::Load(path);
+    std::cout << path << ": " << trace.events.size() << " events on "
+              << trace.device.c_str() << std::endl;
+    for (const auto& pool : opts.pools) {
+      BenchResult res;
+      res.trace = path;
+      res.pool = pool;
+      res.stats = memory_pool::ReplayAllocTrace(trace, pool, opts.repeat);
+      PrintResult(res);
+      results.push_back(std::move(res));
+    }
+  }
+  if (!opts.output.empty()) {
+    WriteJSON(opts.output, results, opts);
+    std::cout << "Results are written to " << opts.output << std::endl;
+  }
+  return 0;
+}
+
+}  // namespace bench
+}  // namespace raf
+
+int main(int argc, char** argv) {
+  return raf::bench::Main(argc, argv);
+}
@@ -0,0 +1,578 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file tests/cpp/bench/op_bench.cc
+ * \brief Micro-benchmarks of the key ops on each of their dialects. Every case is timed with the
+ * op profiler and compared against the roofline bound given by the FLOPs from EstimateGFLOPS, the
+ * bytes of the inputs and outputs, and the peak throughput of the device.
+ *
+ * Usage:
+ *   raf_op_bench [--device cuda|cpu] [--ops matmul,conv2d,...] [--dialects cublas,tvm,...]
+ *                [--dtypes float32,float16] [--warmup 10] [--number 10] [--repeat 5]
+ *                [--peak-tflops 0] [--peak-gbps 0] [--output results.json]
+ *
+ * The peak TFLOPs of the benchmarked dtype has to be given, as it cannot be queried from the
+ * device. The peak GB/s is queried from the CUDA device when not given. The results written to
+ * --output are keyed by "op/dialect/dtype/shape" so that runs can be diffed for regressions.
+ */
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef RAF_USE_CUDA
+#include <cuda_runtime.h>
+#endif
+
+#include <raf/communicator.h>
+#include <raf/device.h>
+#include <raf/dialect.h>
+#include <raf/ir.h>
+#include <raf/ir_ext.h>
+#include <raf/op.h>
+#include <raf/op_profiler.h>
+#include <raf/op_utils.h>
+#include <raf/pass.h>
+#include <raf/registry.h>
+#include <raf/value.h>
+
+namespace raf {
+namespace bench {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+using op_profiler::OpProfiler;
+
+/*! \brief The command line options. */
+struct BenchOptions {
+  std::string device = "cuda";
+  std::vector<std::string> ops;
+  std::vector<std::string> dialects;
+  std::vector<std::string> dtypes = {"float32", "float16"};
+  int warmup = 10;
+  int number = 10;
+  int repeat = 5;
+  double peak_tflops = 0;
+  double peak_gbps = 0;
+  std::string output;
+};
+
+/*! \brief A benchmarked op with its input shapes. */
+struct BenchCase {
+  /*! \brief The base op name without the "raf.op." prefix. */
+  std::string op;
+  /*! \brief The readable shape, e.g., "m=1024,k=1024,n=1024". */
+  std::string shape;
+  std::string dtype;
+  /*! \brief The dialects to benchmark this op on. */
+  std::vector<std::string> dialects;
+  /*! \brief The types of the tensor inputs. */
+  std::vector<Type> input_types;
+  /*! \brief The constant args following the tensor inputs. */
+  std::vector<Value> consts;
+  /*! \brief Whether the tensor inputs are passed as one tuple, as the allreduce does. */
+  bool tuple_input = false;
+  /*!
+   * \brief For collectives, the ratio between the bytes crossing the links of each rank and the
+   * bytes of the input, as a function of the number of ranks. Zero for other ops.
+   */
+  double (*bus_factor)(int) = nullptr;
+};
+
+/*! \brief The result of a benchmark case on one dialect. */
+struct BenchResult {
+  const BenchCase* bench_case;
+  std::string dialect;
+  /*! \brief "ok", "unsupported" or "fallback". */
+  std::string status;
+  /*! \brief The name of the OpEnv that was dispatched. */
+  std::string kernel;
+  double latency_us = 0;
+  double latency_min_us = 0;
+  double gflop = 0;
+  double bytes = 0;
+  double tflops = 0;
+  double gbps = 0;
+  /*! \brief The TFLOPs or GB/s bound by the roofline, and the fraction achieved. */
+  double roofline = 0;
+  double roofline_frac = 0;
+};
+
+std::vector<std::string> Split(const std::string& str) {
+  std::vector<std::string> ret;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      ret.push_back(item);
+    }
+  }
+  return ret;
+}
+
+bool Selected(const std::vector<std::string>& filter, const std::string& name) {
+  return filter.empty() || std::find(filter.begin(), filter.end(), name) != filter.end();
+}
+
+BenchOptions ParseOptions(int argc, char** argv) {
+  BenchOptions opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string key = argv[i];
+    std::string value;
+    auto eq = key.find('=');
+    if (eq != std::string::npos) {
+      value = key.substr(eq + 1);
+      key = key.substr(0, eq);
+    } else {
+      CHECK_LT(i + 1, argc) << "Missing the value of " << key;
+      value = argv[++i];
+    }
+    if (key == "--device") {
+      opts.device = value;
+    } else if (key == "--ops") {
+      opts.ops = Split(value);
+    } else if (key == "--dialects") {
+      opts.dialects = Split(value);
+    } else if (key == "--dtypes") {
+      opts.dtypes = Split(value);
+    } else if (key == "--warmup") {
+      opts.warmup = std::stoi(value);
+    } else if (key == "--number") {
+      opts.number = std::stoi(value);
+    } else if (key == "--repeat") {
+      opts.repeat = std::stoi(value);
+    } else if (key == "--peak-tflops") {
+      opts.peak_tflops = std::stod(value);
+    } else if (key == "--peak-gbps") {
+      opts.peak_gbps = std::stod(value);
+    } else if (key == "--output") {
+      opts.output = value;
+    } else {
+      LOG(FATAL) << "Unknown option " << key;
+    }
+  }
+  CHECK_GT(opts.repeat, 0) << "--repeat must be positive";
+  return opts;
+}
+
+Type MakeTensorType(const std::vector<int64_t>& shape, const std::string& dtype) {
+  Array<PrimExpr> dims;
+  for (auto dim : shape) {
+    dims.push_back(Integer(dim));
+  }
+  return TensorType(dims, DataType(tvm::runtime::String2DLDataType(dtype)));
+}
+
+/*! \brief The bytes of the tensors in the type, i.e., the least traffic to DRAM. */
+int64_t BytesOfType(const Type& type) {
+  if (auto tuple = type.as<TupleTypeNode>()) {
+    int64_t total = 0;
+    for (const auto& field : tuple->fields) {
+      total += BytesOfType(field);
+    }
+    return total;
+  }
+  auto ttype = type.as<TensorTypeNode>();
+  CHECK(ttype) << "Expected a tensor type, but got " << type;
+  int64_t bytes = (ttype->dtype.bits() * ttype->dtype.lanes() + 7) / 8;
+  for (const auto& dim : ttype->shape) {
+    auto imm = dim.as<IntImmNode>();
+    CHECK(imm) << "Benchmarked shapes must be static";
+    bytes *= imm->value;
+  }
+  return bytes;
+}
+
+double AllReduceBusFactor(int size) {
+  return 2.0 * (size - 1) / size;
+}
+
+double GatherScatterBusFactor(int size) {
+  return 1.0 * (size - 1) / size;
+}
+
+/*! \brief The sweep of shapes of each op. */
+std::vector<BenchCase> MakeCases(const std::string& dtype) {
+  std::vector<BenchCase> cases;
+  auto shape_str = [](const std::vector<std::string>& names, const std::vector<int64_t>& dims) {
+    std::ostringstream os;
+    for (size_t i = 0; i < names.size(); ++i) {
+      os << (i ? "," : "") << names[i] << "=" << dims[i];
+    }
+    return os.str();
+  };
+
+  // (m, k, n)
+  for (auto mkn : std::vector<std::vector<int64_t>>{{1024, 1024, 1024},
+                                                    {4096, 4096, 4096},
+                                                    {8192, 1024, 4096},
+                                                    {8192, 4096, 1024},
+                                                    {128, 4096, 4096},
+                                                    {4096, 4096, 16384}}) {
+    BenchCase c;
+    c.op = "matmul";
+    c.shape = shape_str({"m", "k", "n"}, mkn);
+    c.dtype = dtype;
+    c.dialects = {"cublas", "cublaslt", "cutlass", "tvm"};
+    c.input_types = {MakeTensorType({mkn[0], mkn[1]}, dtype),
+                     MakeTensorType({mkn[1], mkn[2]}, dtype)};
+    cases.push_back(c);
+  }
+
+  // (n, c, h, w, k, r, stride), with "same" padding.
+  for (auto conv : std::vector<std::vector<int64_t>>{{32, 64, 56, 56, 64, 3, 1},
+                                                     {32, 64, 56, 56, 256, 1, 1},
+                                                     {32, 128, 28, 28, 128, 3, 1},
+                                                     {32, 256, 56, 56, 512, 1, 2},
+                                                     {32, 512, 7, 7, 512, 3, 1}}) {
+    BenchCase c;
+    c.op = "conv2d";
+    c.shape = shape_str({"n", "c", "h", "w", "k", "r", "stride"}, conv);
+    c.dtype = dtype;
+    c.dialects = {"cudnn", "cutlass", "tvm"};
+    c.input_types = {MakeTensorType({conv[0], conv[1], conv[2], conv[3]}, dtype),
+                     MakeTensorType({conv[4], conv[1], conv[5], conv[5]}, dtype)};
+    c.consts = {ArrayToIntTuple(std::vector<int64_t>{conv[6], conv[6]}),
+                ArrayToIntTuple(std::vector<int64_t>{conv[5] / 2, conv[5] / 2}),
+                ArrayToIntTuple(std::vector<int64_t>{1, 1}),
+                ScalarValue::make(int64_t(1)),
+                StringValue::make("NCHW"),
+                StringValue::make("OIHW"),
+                StringValue::make("NCHW")};
+    cases.push_back(c);
+  }
+
+  // (rows, hidden)
+  for (auto rh : std::vector<std::vector<int64_t>>{
+           {8192, 768}, {8192, 1024}, {4096, 4096}, {16384, 8192}}) {
+    BenchCase c;
+    c.op = "layer_norm";
+    c.shape = shape_str({"rows", "hidden"}, rh);
+    c.dtype = dtype;
+    c.dialects = {"cuda", "tvm"};
+    c.input_types = {MakeTensorType(rh, dtype), MakeTensorType({rh[1]}, dtype),
+                     MakeTensorType({rh[1]}, dtype)};
+    c.consts = {ScalarValue::make(int64_t(-1)), ScalarValue::make(1e-5)};
+    cases.push_back(c);
+  }
+
+  // (rows, cols)
+  for (auto rc : std::vector<std::vector<int64_t>>{
+           {8192, 1024}, {4096, 4096}, {1024, 32000}, {65536, 512}}) {
+    BenchCase c;
+    c.op = "softmax";
+    c.shape = shape_str({"rows", "cols"}, rc);
+    c.dtype = dtype;
+    c.dialects = {"cudnn", "tvm"};
+    c.input_types = {MakeTensorType(rc, dtype)};
+    c.consts = {ScalarValue::make(int64_t(-1))};
+    cases.push_back(c);
+  }
+
+  // Collectives over (elements). The sizes are multiples of any practical number of ranks.
+  for (int64_t elems : {1 << 20, 1 << 23, 1 << 26}) {
+    std::string shape = shape_str({"elems"}, {elems});
+    BenchCase allreduce;
+    allreduce.op = "_allreduce";
+    allreduce.shape = shape;
+    allreduce.dtype = dtype;
+    allreduce.dialects = {"nccl"};
+    allreduce.input_types = {MakeTensorType({elems}, dtype)};
+    allreduce.consts = {StringValue::make("sum")};
+    allreduce.tuple_input = true;
+    allreduce.bus_factor = AllReduceBusFactor;
+    cases.push_back(allreduce);
+
+    BenchCase allgather = allreduce;
+    allgather.op = "_allgather";
+    allgather.consts = {ScalarValue::make(int64_t(0))};
+    allgather.tuple_input = false;
+    allgather.bus_factor = GatherScatterBusFactor;
+    cases.push_back(allgather);
+
+    BenchCase reduce_scatter = allreduce;
+    reduce_scatter.op = "_reduce_scatter";
+    reduce_scatter.tuple_input = false;
+    reduce_scatter.bus_factor = GatherScatterBusFactor;
+    cases.push_back(reduce_scatter);
+  }
+  return cases;
+}
+
+/*!
+ * \brief Make the call of the case on the given dialect, or on the base op if the dialect is
+ * empty. CUTLASS only builds fused functions, so its op is wrapped into a primitive function.
+ */
+Expr MakeCall(const BenchCase& c, const std::string& dialect, const Array<Var>& params) {
+  Op base_op = Op::Get("raf.op." + c.op);
+  auto make_args = [&c](const Array<Var>& inputs) {
+    Array<Expr> args;
+    if (c.tuple_input) {
+      args.push_back(Tuple(Array<Expr>(inputs.begin(), inputs.end())));
+    } else {
+      args = Array<Expr>(inputs.begin(), inputs.end());
+    }
+    for (const auto& value : c.consts) {
+      args.push_back(MakeConstant(value));
+    }
+    return args;
+  };
+  if (dialect.empty()) {
+    return Call(base_op, make_args(params));
+  }
+  Op dialect_op = OpDialect::Lower(base_op, dialect);
+  CHECK(dialect_op.defined()) << "No " << dialect << " dialect for " << base_op->name;
+  if (dialect != "cutlass") {
+    return Call(dialect_op, make_args(params));
+  }
+  Array<Var> fn_params;
+  for (const auto& param : params) {
+    fn_params.push_back(MakeVar("p", param->type_annotation));
+  }
+  auto func = Function(fn_params, Call(dialect_op, make_args(fn_params)), Type(), {});
+  func = WithAttr(std::move(func), attr::kPrimitive, tvm::Integer(1));
+  func = WithAttr(std::move(func), attr::kDialect, String(dialect));
+  func = WithAttr(std::move(func), attr::kPatternName, String(c.op));
+  return Call(func, Array<Expr>(params.begin(), params.end()));
+}
+
+/*! \brief Wrap the call into a type-inferred main function in A-normal form. */
+IRModule MakeModule(const BenchCase& c, const std::string& dialect) {
+  Array<Var> params;
+  for (size_t i = 0; i < c.input_types.size(); ++i) {
+    params.push_back(MakeVar("x" + std::to_string(i), c.input_types[i]));
+  }
+  Var out = MakeVar("out", {});
+  Function func(params, Let(out, MakeCall(c, dialect, params), out), {}, {});
+  return pass::InferType()(IRModule::FromExpr(func));
+}
+
+Call GetCall(const IRModule& mod) {
+  auto func = Downcast<Function>(mod->Lookup("main"));
+  return Downcast<Call>(Downcast<Let>(func->body)->value);
+}
+
+/*! \brief The GFLOPs of the case given by EstimateGFLOPS, or 0 if it cannot be estimated. */
+double EstimateGFLOP(const BenchCase& c) {
+  if (c.bus_factor) {
+    return 0;
+  }
+  static const PackedFunc& estimate = registry::GetPackedFunc("raf.pass_.EstimateGFLOPS");
+  Map<Var, FloatImm> flops = estimate(MakeModule(c, ""));
+  double total = 0;
+  for (const auto& kv : flops) {
+    if (std::isfinite(kv.second->value)) {
+      total += kv.second->value;
+    }
+  }
+  return total;
+}
+
+/*! \brief The peak DRAM bandwidth of the device in GB/s. */
+double QueryPeakGBps(const Device& device) {
+#ifdef RAF_USE_CUDA
+  if (device.device_type() == DevType::kCUDA()) {
+    int clock_khz = 0, bus_bits = 0;
+    cudaDeviceGetAttribute(&clock_khz, cudaDevAttrMemoryClockRate, device.device_id());
+    cudaDeviceGetAttribute(&bus_bits, cudaDevAttrGlobalMemoryBusWidth, device.device_id());
+    // Double data rate.
+    return 2.0 * clock_khz * 1e3 * (bus_bits / 8) / 1e9;
+  }
+#endif
+  return 0;
+}
+
+std::string DeviceName(const Device& device) {
+#ifdef RAF_USE_CUDA
+  if (device.device_type() == DevType::kCUDA()) {
+    cudaDeviceProp prop;
+    if (cudaGetDeviceProperties(&prop, device.device_id()) == cudaSuccess) {
+      return prop.name;
+    }
+  }
+#endif
+  return device.c_str();
+}
+
+int NumRanks() {
+  return std::max(1, distributed::communicator::GetGlobalCommunicator()->world_size);
+}
+
+BenchResult RunCase(const BenchCase& c, const std::string& dialect, double gflop,
+                    const Device& device, const BenchOptions& opts) {
+  BenchResult res;
+  res.bench_case = &c;
+  res.dialect = dialect;
+  res.gflop = gflop;
+  if (!Dialect::IsEnabled(dialect, device.device_type())) {
+    res.status = "unsupported";
+    return res;
+  }
+
+  auto* profiler = OpProfiler::Get(device);
+  std::vector<float> latencies;
+  try {
+    IRModule mod = MakeModule(c, dialect);
+    Call call = GetCall(mod);
+    res.bytes = BytesOfType(call->checked_type());
+    for (const auto& arg : call->args) {
+      if (!arg->IsInstance<RelayConstantNode>()) {
+        res.bytes += BytesOfType(arg->checked_type());
+      }
+    }
+    // The latency cache of the profiler is keyed by the types of the call, not the dialect.
+    profiler->Reset();
+    latencies = profiler->ProfileOp(call, opts.warmup, opts.number, opts.repeat).first;
+    auto env = profiler->GetOpEnv(call);
+    res.kernel = env ? env->name() : "";
+  } catch (const dmlc::Error& e) {
+    DLOG(INFO) << c.op << " on " << dialect << " failed: " << e.what();
+    res.status = "unsupported";
+    return res;
+  }
+  // The dispatcher silently falls back to other dialects when this one rejects the call.
+  bool fused = dialect == "cutlass";
+  if (!fused && res.kernel.find("raf.op." + dialect + ".") == std::string::npos) {
+    res.status = "fallback";
+    return res;
+  }
+  res.status = "ok";
+
+  std::sort(latencies.begin(), latencies.end());
+  res.latency_us = latencies[latencies.size() / 2];
+  res.latency_min_us = latencies.front();
+  if (res.latency_us <= 0) {
+    return res;
+  }
+  double seconds = res.latency_us * 1e-6;
+  if (c.bus_factor) {
+    // The bus bandwidth of the collective, comparable to the link bandwidth for any #ranks.
+    double input_bytes = 0;
+    for (const auto& type : c.input_types) {
+      input_bytes += BytesOfType(type);
+    }
+    res.bytes = input_bytes * c.bus_factor(NumRanks());
+    res.gbps = res.bytes / seconds / 1e9;
+    return res;
+  }
+  res.tflops = res.gflop / seconds / 1e3;
+  res.gbps = res.bytes / seconds / 1e9;
+  // The roofline: attainable TFLOPs = min(peak TFLOPs, arithmetic intensity * peak bandwidth).
+  // Ops without FLOPs estimation, or with an unknown compute peak, are bound by the bandwidth.
+  double intensity = res.gflop * 1e9 / res.bytes;
+  double bw_bound = intensity * opts.peak_gbps / 1e3;
+  if (res.gflop > 0 && opts.peak_tflops > 0) {
+    res.roofline = opts.peak_gbps > 0 ? std::min(opts.peak_tflops, bw_bound) : opts.peak_tflops;
+    res.roofline_frac = res.tflops / res.roofline;
+  } else if (opts.peak_gbps > 0) {
+    res.roofline = opts.peak_gbps;
+    res.roofline_frac = res.gbps / opts.peak_gbps;
+  }
+  return res;
+}
+
+std::string ResultKey(const BenchResult& res) {
+  const BenchCase& c = *res.bench_case;
+  return c.op + "/" + res.dialect + "/" + c.dtype + "/" + c.shape;
+}
+
+void PrintResult(const BenchResult& res) {
+  std::cout << std::left << std::setw(72) << ResultKey(res) << std::right;
+  if (res.status != "ok") {
+    std::cout << "  " << res.status << std::endl;
+    return;
+  }
+  std::cout << std::fixed << std::setprecision(2) << std::setw(12) << res.latency_us << " us"
+            << std::setw(10) << res.tflops << " TFLOPs" << std::setw(10) << res.gbps << " GB/s";
+  if (res.roofline > 0) {
+    std::cout << std::setw(8) << res.roofline_frac * 100 << "% of roofline";
+  }
+  std::cout << std::endl;
+}
+
+void WriteJSON(const std::string& path, const std::vector<BenchResult>& results,
+               const Device& device, const BenchOptions& opts) {
+  std::ofstream os(path);
+  CHECK(os.good()) << "Cannot open " << path;
+  static const PackedFunc& git_version = registry::GetPackedFunc("raf.build_info.git_version");
+  std::string git = git_version();
+  os << std::setprecision(6) << "{\n"
+     << "  \"device\": \"" << DeviceName(device) << "\",\n"
+     << "  \"git_version\": \"" << git << "\",\n"
+     << "  \"num_ranks\": " << NumRanks() << ",\n"
+     << "  \"peak_tflops\": " << opts.peak_tflops << ",\n"
+     << "  \"peak_gbps\": " << opts.peak_gbps << ",\n"
+     << "  \"warmup\": " << opts.warmup << ",\n"
+     << "  \"number\": " << opts.number << ",\n"
+     << "  \"repeat\": " << opts.repeat << ",\n"
+     << "  \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchResult& res = results[i];
+    const BenchCase& c = *res.bench_case;
+    os << (i ? "," : "") << "\n    {\"key\": \"" << ResultKey(res) << "\", \"op\": \"" << c.op
+       << "\", \"dialect\": \"" << res.dialect << "\", \"dtype\": \"" << c.dtype
+       << "\", \"shape\": \"" << c.shape << "\", \"status\": \"" << res.status
+       << "\", \"kernel\": \"" << res.kernel << "\", \"latency_us\": " << res.latency_us
+       << ", \"latency_min_us\": " << res.latency_min_us << ", \"gflop\": " << res.gflop
+       << ", \"bytes\": " << res.bytes << ", \"tflops\": " << res.tflops
+       << ", \"gbps\": " << res.gbps << ", \"roofline\": " << res.roofline
+       << ", \"roofline_frac\": " << res.roofline_frac << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+int Main(int argc, char** argv) {
+  BenchOptions opts = ParseOptions(argc, argv);
+  Device device = opts.device == "cpu" ? Device(DevType::kCPU(), 0) : Device(DevType::kCUDA(), 0);
+  tvm::With<Device> device_scope(device);
+  if (opts.peak_gbps <= 0) {
+    opts.peak_gbps = QueryPeakGBps(device);
+  }
+  std::cout << "Device: " << DeviceName(device) << ", peak " << opts.peak_tflops << " TFLOPs, "
+            << opts.peak_gbps << " GB/s" << std::endl;
+
+  std::vector<BenchCase> cases;
+  for (const auto& dtype : opts.dtypes) {
+    for (auto& c : MakeCases(dtype)) {
+      if (Selected(opts.ops, c.op)) {
+        cases.push_back(std::move(c));
+      }
+    }
+  }
+  std::vector<BenchResult> results;
+  for (const auto& c : cases) {
+    double gflop = 0;
+    try {
+      gflop = EstimateGFLOP(c);
+    } catch (const dmlc::Error& e) {
+      LOG(WARNING) << "Cannot estimate the FLOPs of " << c.op << " " << c.shape;
+    }
+    for (const auto& dialect : c.dialects) {
+      if (Selected(opts.dialects, dialect)) {
+        results.push_back(RunCase(c, dialect, gflop, device, opts));
+        PrintResult(results.back());
+      }
+    }
+  }
+  if (!opts.output.empty()) {
+    WriteJSON(opts.output, results, device, opts);
+    std::cout << "Results are written to " << opts.output << std::endl;
+  }
+  return 0;
+}
+
+}  // namespace bench
+}  // namespace raf
+
+int main(int argc, char** argv) {
+  return raf::bench::Main(argc, argv);
+}
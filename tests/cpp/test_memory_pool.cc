@@ -5,14 +5,25 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdio>
+
+#include <raf/alloc_trace.h>
 #include <raf/device.h>
+#include <raf/device_api.h>
 #include <raf/memory_pool.h>
+#include <raf/registry.h>
 
 using raf::Device;
 using raf::DevType;
 using raf::kDefaultMemoryAlignment;
+using raf::memory_pool::AllocEvent;
+using raf::memory_pool::AllocReplayStats;
+using raf::memory_pool::AllocTrace;
+using raf::memory_pool::AllocTracer;
 using raf::memory_pool::Memory;
+using raf::device_api::DeviceAPI;
 using raf::memory_pool::MemoryPool;
+using raf::memory_pool::TenantScope;
 
 TEST(NoPool, CPU) {
   Device dev{DevType::kCPU(), 0};
@@ -63,6 +74,187 @@ TEST(PageUnitPool, CPU) {
   Memory::RemovePool(dev);
 }
 
+TEST(SizeClassPool, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "size_class_pool");
+  {
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 0);
+    ASSERT_EQ(result.use_count(), 1);
+    ASSERT_EQ(result->data, nullptr);
+  }
+  for (int memory : {11, 19, 2019, 1024124}) {
+    for (int align : {(int)kDefaultMemoryAlignment, 512, 1024, 4096}) {
+      std::shared_ptr<Memory> result = Memory::Alloc(dev, memory, align);
+      ASSERT_EQ(result.use_count(), 1);
+      int64_t address = (int64_t)result->data;
+      ASSERT_EQ(address % align, 0);
+    }
+  }
+  auto pool_size = Memory::GetPoolSize(dev);
+  ASSERT_EQ(pool_size.first, 0);  // No block is used.
+
+  // A freed block is split to serve smaller requests, and coalesced back once they are freed.
+  void* large_ptr = nullptr;
+  {
+    std::shared_ptr<Memory> large = Memory::Alloc(dev, 8192);
+    large_ptr = large->data;
+  }
+  {
+    std::shared_ptr<Memory> a = Memory::Alloc(dev, 4096);
+    std::shared_ptr<Memory> b = Memory::Alloc(dev, 4096);
+    ASSERT_NE(a->data, b->data);
+    pool_size = Memory::GetPoolSize(dev);
+    auto used_size = pool_size.first * 1048576.0;
+    auto abs_diff = (used_size > 8192) ? used_size - 8192 : 8192 - used_size;
+    ASSERT_LE(abs_diff, 1);
+  }
+  std::shared_ptr<Memory> result = Memory::Alloc(dev, 8192);
+  ASSERT_EQ(result->data, large_ptr);
+  result.reset();
+  pool_size = Memory::GetPoolSize(dev);
+  ASSERT_EQ(pool_size.first, 0);
+  Memory::RemovePool(dev);
+}
+
+TEST(TenantPool, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  setenv("RAF_MEMORY_POOL_SIZE_LIMIT", "65536", 1);
+  Memory::InitPool(dev, "tenant_pool");
+  unsetenv("RAF_MEMORY_POOL_SIZE_LIMIT");
+  Memory::SetTenant(dev, "a", 16384, 32768);
+  Memory::SetTenant(dev, "b", 16384, 0);
+  {
+    TenantScope scope("a");
+    void* ptr = nullptr;
+    {
+      std::shared_ptr<Memory> result = Memory::Alloc(dev, 4000);
+      ptr = result->data;
+    }
+    // The chunks released by a tenant are cached for its later requests.
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 4096);
+    ASSERT_EQ(result->data, ptr);
+    // The quota bounds the memory used by the tenant at a time.
+    ASSERT_ANY_THROW(Memory::Alloc(dev, 32768));
+    auto chunks = Memory::AllocBatch(dev, {8192, 8192, 8192});
+  }
+  auto stats = Memory::GetTenantStats(dev);
+  ASSERT_EQ(stats["a"].used_bytes, 0);
+  ASSERT_EQ(stats["a"].cached_bytes, 28672);
+  ASSERT_EQ(stats["a"].peak_bytes, 28672);
+  ASSERT_EQ(stats["a"].num_allocs, 5);
+  {
+    TenantScope scope("b");
+    // The cached chunks of a beyond its reservation are reclaimed to serve b.
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 40960);
+    stats = Memory::GetTenantStats(dev);
+    ASSERT_GE(stats["a"].reclaimed_bytes, 4096);
+    ASSERT_GE(stats["a"].cached_bytes, 16384);
+    ASSERT_EQ(stats["b"].used_bytes, 40960);
+    // The reservation of a is not available to b.
+    ASSERT_ANY_THROW(Memory::Alloc(dev, 16384));
+    auto pool_size = Memory::GetPoolSize(dev);
+    ASSERT_LE(pool_size.second * 1048576.0, 65536);
+  }
+  stats = Memory::GetTenantStats(dev);
+  ASSERT_EQ(stats["b"].used_bytes, 0);
+  ASSERT_EQ(stats["b"].peak_bytes, 40960);
+  Memory::RemovePool(dev);
+}
+
+TEST(PinnedHostPool, CUDAHost) {
+  if (raf::registry::Registry::Get("raf.device_api._make.cuda_host") == nullptr) {
+    GTEST_SKIP() << "CUDA is not enabled";
+  }
+  Device dev{DevType::kCUDAHost(), 0};
+  Memory::InitPool(dev, "pinned_host_pool");
+  // The requests of the same size class reuse the cached buffer.
+  void* ptr = nullptr;
+  {
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 1000);
+    ASSERT_EQ(result.use_count(), 1);
+    ASSERT_EQ(Memory::GetAllocBytes(dev, 1000), 1024);
+    ptr = result->data;
+  }
+  {
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 900);
+    ASSERT_EQ(result->data, ptr);
+  }
+  auto pool_size = Memory::GetPoolSize(dev);
+  ASSERT_EQ(pool_size.first, 0);
+
+  // A buffer released on a stream is reused by the same stream right away, and by the others
+  // once the stream is finished.
+  Device gpu{DevType::kCUDA(), 0};
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  void* stream = api->CreateStream(gpu);
+  {
+    std::shared_ptr<Memory> result = Memory::AllocAsync(dev, 1 << 20, stream);
+    ASSERT_EQ(result->stream, stream);
+    ptr = result->data;
+  }
+  {
+    std::shared_ptr<Memory> result = Memory::AllocAsync(dev, 1 << 20, stream);
+    ASSERT_EQ(result->data, ptr);
+  }
+  api->WaitStream(stream);
+  {
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 1 << 20);
+    ASSERT_EQ(result->data, ptr);
+  }
+  api->FreeStream(gpu, stream);
+  Memory::RemovePool(dev);
+}
+
+TEST(AllocTrace, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "no_pool");
+  AllocTracer* tracer = AllocTracer::Get();
+  tracer->Start(dev);
+  {
+    std::shared_ptr<Memory> a = tracer->Track(Memory::Alloc(dev, 4096), 4096, 64, -1);
+    std::shared_ptr<Memory> b = tracer->Track(Memory::Alloc(dev, 100, 512), 100, 512, 2);
+    std::shared_ptr<Memory> alias = a;
+    a.reset();
+    ASSERT_NE(alias->data, nullptr);
+  }
+  // The buffers on other devices are not traced.
+  Device host{DevType::kCUDAHost(), 0};
+  std::shared_ptr<Memory> other = std::make_shared<Memory>();
+  other->device = host;
+  ASSERT_EQ(tracer->Track(other, 8, 64, -1), other);
+  AllocTrace trace = tracer->Stop();
+  ASSERT_FALSE(tracer->IsTracing());
+  // b is released before a, whose alias is the last reference.
+  ASSERT_EQ(trace.events.size(), 4U);
+  ASSERT_EQ(trace.events[2].kind, AllocEvent::kFree);
+  ASSERT_EQ(trace.events[2].id, 1U);
+  ASSERT_EQ(trace.events[3].id, 0U);
+  ASSERT_EQ(trace.PeakLiveBytes(), 4196);
+
+  std::string path = "alloc_trace_test.trace";
+  trace.Save(path);
+  AllocTrace loaded = AllocTrace::Load(path);
+  std::remove(path.c_str());
+  ASSERT_TRUE(loaded.device == dev);
+  ASSERT_EQ(loaded.events.size(), trace.events.size());
+  for (size_t i = 0; i < trace.events.size(); ++i) {
+    ASSERT_EQ(loaded.events[i].kind, trace.events[i].kind);
+    ASSERT_EQ(loaded.events[i].id, trace.events[i].id);
+    ASSERT_EQ(loaded.events[i].timestamp_ns, trace.events[i].timestamp_ns);
+    ASSERT_EQ(loaded.events[i].nbytes, trace.events[i].nbytes);
+    ASSERT_EQ(loaded.events[i].alignment, trace.events[i].alignment);
+    ASSERT_EQ(loaded.events[i].stream_id, trace.events[i].stream_id);
+  }
+
+  // The replay reserves at least the requested memory, and restores the current pool.
+  AllocReplayStats stats = raf::memory_pool::ReplayAllocTrace(loaded, "page_unit_pool", 2);
+  ASSERT_EQ(stats.num_events, 4);
+  ASSERT_GE(stats.peak_reserved_mb, stats.peak_requested_mb);
+  ASSERT_GE(stats.fragmentation, 0);
+  ASSERT_EQ(Memory::GetPool(dev)->GetName(), "no_pool");
+  Memory::RemovePool(dev);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,65 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <raf/profiler.h>
+
+using raf::profiler::AnalyzeTrace;
+using raf::profiler::ProfileStat;
+using raf::profiler::TraceSummary;
+
+ProfileStat MakeStat(const std::string& stream, const std::string& name, uint64_t start,
+                     uint64_t end) {
+  return ProfileStat(stream, name, start, end, {});
+}
+
+TEST(TraceAnalysis, ExposedCommunication) {
+  // Compute: [0, 10) [10, 20) and [30, 40); allreduce: [15, 35).
+  std::vector<ProfileStat> stats = {
+      MakeStat("Stream 1", "fwd", 0, 10),
+      MakeStat("Stream 1", "bwd", 10, 20),
+      MakeStat("Stream 4", "allreduce", 15, 35),
+      MakeStat("Stream 1", "update", 30, 40),
+      MakeStat("VMInstruction", "InvokeJit", 0, 100),
+  };
+  TraceSummary summary = AnalyzeTrace(stats, {"Stream 4"});
+  ASSERT_EQ(summary.makespan, 40U);
+  ASSERT_EQ(summary.exposed_comm.size(), 1U);
+  ASSERT_EQ(summary.exposed_comm[0].name, "allreduce");
+  ASSERT_EQ(summary.exposed_comm[0].duration, 20U);
+  ASSERT_EQ(summary.exposed_comm[0].exposed, 10U);
+  ASSERT_EQ(summary.stream_idle["Stream 1"], 10U);
+  ASSERT_EQ(summary.stream_idle["Stream 4"], 20U);
+  ASSERT_EQ(summary.stream_idle.count("VMInstruction"), 0U);
+}
+
+TEST(TraceAnalysis, CriticalPath) {
+  // The update waits for the allreduce, which waits for the backward.
+  std::vector<ProfileStat> stats = {
+      MakeStat("Stream 1", "fwd", 0, 10),
+      MakeStat("Stream 1", "bwd", 10, 20),
+      MakeStat("Stream 1", "other", 20, 25),
+      MakeStat("Stream 4", "allreduce", 22, 35),
+      MakeStat("Stream 1", "update", 36, 40),
+  };
+  TraceSummary summary = AnalyzeTrace(stats, {"Stream 4"});
+  // update <- allreduce <- bwd <- fwd, with 1us gap before update and 2us before allreduce.
+  ASSERT_EQ(summary.critical_path, 37U);
+  ASSERT_EQ(summary.critical_path_idle, 3U);
+  ASSERT_EQ(summary.critical_path_ops.count("other"), 0U);
+  ASSERT_EQ(summary.critical_path_ops["allreduce"], 13U);
+  ASSERT_EQ(summary.critical_path_ops["fwd"], 10U);
+}
+
+TEST(TraceAnalysis, Empty) {
+  TraceSummary summary = AnalyzeTrace({}, {"Stream 4"});
+  ASSERT_EQ(summary.makespan, 0U);
+  ASSERT_EQ(summary.critical_path, 0U);
+  ASSERT_TRUE(summary.exposed_comm.empty());
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <raf/tuning_db.h>
+
+using raf::op::TuningDatabase;
+
+std::string TempPath(const std::string& name) {
+  return "/tmp/raf_test_tuning_db_" + std::to_string(getpid()) + "_" + name;
+}
+
+TEST(TuningDatabase, InMemory) {
+  TuningDatabase db("");
+  std::string value;
+  ASSERT_FALSE(db.Get("a", &value));
+  db.Put("a", "1");
+  db.Put("b", std::string("\0\1\2", 3));
+  db.Put("a", "2");
+  ASSERT_TRUE(db.Get("a", &value));
+  ASSERT_EQ(value, "2");
+  ASSERT_TRUE(db.Get("b", &value));
+  ASSERT_EQ(value, std::string("\0\1\2", 3));
+  ASSERT_EQ(db.Size(), 2U);
+}
+
+TEST(TuningDatabase, Persist) {
+  std::string path = TempPath("persist");
+  std::remove(path.c_str());
+  {
+    TuningDatabase db(path);
+    db.Put("a", "1");
+    db.Put("b", "2");
+    db.Put("a", "3");
+  }
+  TuningDatabase db(path);
+  std::string value;
+  ASSERT_EQ(db.Size(), 2U);
+  ASSERT_TRUE(db.Get("a", &value));
+  ASSERT_EQ(value, "3");
+  ASSERT_TRUE(db.Get("b", &value));
+  ASSERT_EQ(value, "2");
+
+  // The records appended by another writer are visible on a lookup miss.
+  TuningDatabase writer(path);
+  writer.Put("c", "4");
+  ASSERT_TRUE(db.Get("c", &value));
+  ASSERT_EQ(value, "4");
+  std::remove(path.c_str());
+}
+
+TEST(TuningDatabase, Import) {
+  std::string shipped = TempPath("shipped");
+  std::string local = TempPath("local");
+  std::remove(shipped.c_str());
+  std::remove(local.c_str());
+  {
+    TuningDatabase db(shipped);
+    db.Put("a", "1");
+    db.Put("b", "2");
+  }
+  TuningDatabase db(local);
+  ASSERT_EQ(db.Import(shipped), 2);
+  std::string value;
+  ASSERT_TRUE(db.Get("b", &value));
+  ASSERT_EQ(value, "2");
+  // The imported records are not appended to the local log.
+  ASSERT_EQ(TuningDatabase(local).Size(), 0U);
+  std::remove(shipped.c_str());
+  std::remove(local.c_str());
+}
+
+TEST(TuningDatabase, TruncatedTail) {
+  std::string path = TempPath("truncated");
+  std::remove(path.c_str());
+  {
+    TuningDatabase db(path);
+    db.Put("a", "1");
+    db.Put("b", "2");
+  }
+  // Simulate a crash in the middle of appending a record.
+  std::ifstream ifs(path, std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  ifs.close();
+  std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+  ofs << data.substr(0, data.size() - 1);
+  ofs.close();
+
+  TuningDatabase db(path);
+  std::string value;
+  ASSERT_EQ(db.Size(), 1U);
+  ASSERT_TRUE(db.Get("a", &value));
+  ASSERT_FALSE(db.Get("b", &value));
+  std::remove(path.c_str());
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include <raf/device.h>
+#include <raf/value.h>
+#include <raf/vm/vm.h>
+
+using raf::Device;
+using raf::DevType;
+using raf::executor::vm::Executable;
+using raf::executor::vm::Index;
+using raf::executor::vm::Instruction;
+using raf::executor::vm::StorageValueObj;
+using raf::executor::vm::VirtualMachine;
+using raf::executor::vm::VMContext;
+using raf::executor::vm::VMFunction;
+using raf::ir::make_object;
+using raf::value::TupleValueObj;
+using raf::value::Value;
+
+using AllocBatches = std::vector<std::tuple<Index, Index, Index>>;
+
+constexpr DLDataType kFloat32{kDLFloat, 32, 1};
+
+Instruction AllocStorage(Index size_reg, Index alignment, DevType device_type, Index device_id,
+                         Index dst, bool alloc_async = false) {
+  return Instruction::AllocStorage(size_reg, alignment, kFloat32, device_type, device_id, dst,
+                                   alloc_async);
+}
+
+/*!
+ * \brief The executable of two functions. "main" allocates five CPU storages of two alignments
+ * and returns all but the freed one. "devices" allocates on the CPU and two GPUs, and is only
+ * analyzed, not executed.
+ */
+raf::ir::ObjectPtr<Executable> MakeExecutable() {
+  auto exec = make_object<Executable>();
+  std::vector<Instruction> main = {
+      Instruction::LoadConsti(64, 0),
+      Instruction::LoadConsti(256, 1),
+      AllocStorage(0, 64, DevType::kCPU(), 0, 2),
+      AllocStorage(1, 64, DevType::kCPU(), 0, 3),
+      AllocStorage(0, 64, DevType::kCPU(), 0, 4),
+      AllocStorage(0, 128, DevType::kCPU(), 0, 5),
+      AllocStorage(1, 128, DevType::kCPU(), 0, 6),
+      Instruction::Free(3),
+      Instruction::AllocTuple({2, 4, 5, 6}, 7),
+      Instruction::Ret(7),
+  };
+  std::vector<Instruction> devices = {
+      Instruction::LoadConsti(64, 0),
+      AllocStorage(0, 64, DevType::kCPU(), 0, 1),
+      AllocStorage(0, 64, DevType::kCUDA(), 0, 2),
+      AllocStorage(0, 64, DevType::kCUDA(), 0, 3),
+      AllocStorage(0, 64, DevType::kCUDA(), 1, 4),
+      AllocStorage(0, 64, DevType::kCUDA(), 1, 5),
+      AllocStorage(0, 64, DevType::kCUDA(), 0, 6, true),
+      AllocStorage(0, 64, DevType::kCUDA(), 0, 7, true),
+      Instruction::Free(2),
+      Instruction::Free(3),
+      Instruction::Free(4),
+      Instruction::Free(5),
+      Instruction::Free(6),
+      Instruction::Free(7),
+      Instruction::Ret(1),
+  };
+  exec->functions.push_back(VMFunction("main", {}, main, 8));
+  exec->functions.push_back(VMFunction("devices", {}, devices, 8));
+  exec->global_map["main"] = 0;
+  exec->global_map["devices"] = 1;
+  return exec;
+}
+
+TEST(AllocBatch, Runs) {
+  auto exec = MakeExecutable();
+  VirtualMachine vm(false, false);
+  vm.LoadExecutable(exec.get());
+  // The runs are split by the alignment, the device type and the device id. The asynchronous CUDA
+  // allocations are not batched.
+  AllocBatches expected = {{0, 2, 3}, {0, 5, 2}, {1, 2, 2}, {1, 4, 2}};
+  ASSERT_EQ(vm.GetAllocBatches(), expected);
+}
+
+TEST(AllocBatch, PersistentStorage) {
+  auto exec = MakeExecutable();
+  VirtualMachine vm(false, false, false, false, false, /*persistent_storage=*/true);
+  vm.LoadExecutable(exec.get());
+  // The storages returned by "main" are persistent, which leaves no run of two.
+  AllocBatches expected = {{1, 2, 2}, {1, 4, 2}};
+  ASSERT_EQ(vm.GetAllocBatches(), expected);
+}
+
+TEST(AllocBatch, Execute) {
+  auto exec = MakeExecutable();
+  Device dev{DevType::kCPU(), 0};
+  for (bool persistent_storage : {false, true}) {
+    VirtualMachine vm(false, false, false, false, false, persistent_storage);
+    vm.LoadExecutable(exec.get());
+    vm.SetDevices({dev});
+    for (bool batching : {true, false}) {
+      vm.EnableAllocBatching(batching);
+      // Repeated runs of the same executable.
+      for (int iter = 0; iter < 3; ++iter) {
+        VMContext ctx = vm.PrepareVMContext("main", {});
+        Value out = vm.Run(ctx);
+        const auto* tup = out.as<TupleValueObj>();
+        ASSERT_NE(tup, nullptr);
+        ASSERT_EQ(tup->fields.size(), 4U);
+        std::vector<int64_t> sizes = {64, 64, 64, 256};
+        std::vector<uintptr_t> alignments = {64, 64, 128, 128};
+        std::set<void*> buffers;
+        for (size_t i = 0; i < sizes.size(); ++i) {
+          const auto* storage = tup->fields[i].as<StorageValueObj>();
+          ASSERT_NE(storage, nullptr);
+          ASSERT_EQ(storage->size, sizes[i]);
+          ASSERT_EQ(storage->buffer->device.device_type(), DevType::kCPU());
+          ASSERT_EQ(reinterpret_cast<uintptr_t>(storage->buffer->data) % alignments[i], 0U);
+          buffers.insert(storage->buffer->data);
+        }
+        ASSERT_EQ(buffers.size(), sizes.size());
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
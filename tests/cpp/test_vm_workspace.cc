@@ -0,0 +1,113 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <raf/device.h>
+#include <raf/op.h>
+#include <raf/vm/vm.h>
+
+using raf::Device;
+using raf::DevType;
+using raf::executor::vm::VirtualMachine;
+using raf::executor::vm::VMContext;
+using raf::executor::vm::VMContextObj;
+using raf::op::CallValues;
+using raf::op::OpEnv;
+using raf::op::OpEnvPtr;
+using raf::value::Value;
+
+class WorkspaceOpEnv : public OpEnv {
+ public:
+  WorkspaceOpEnv(const Device& device, int64_t nbytes) : nbytes(nbytes) {
+    RequestWorkspace(&workspace, device, nbytes);
+  }
+  std::string name() const override {
+    return "cpptest.workspace";
+  }
+  void Execute(const CallValues& call) override final {
+  }
+  void Execute(const std::vector<Value>& inputs, Value output) override final {
+  }
+
+  void* workspace = nullptr;
+  int64_t nbytes;
+};
+
+class WorkspaceVM : public VirtualMachine {
+ public:
+  WorkspaceVM() : VirtualMachine(false, false) {
+  }
+  using VirtualMachine::PrepareWorkspace;
+  using VirtualMachine::ReleaseWorkspace;
+};
+
+VMContext MakeContext() {
+  return VMContext(raf::ir::make_object<VMContextObj>());
+}
+
+TEST(Workspace, CPUContexts) {
+  Device dev{DevType::kCPU(), 0};
+  WorkspaceVM vm;
+  VMContext ctx_a = MakeContext();
+  VMContext ctx_b = MakeContext();
+  auto env_a = std::make_shared<WorkspaceOpEnv>(dev, 1024);
+  auto env_b = std::make_shared<WorkspaceOpEnv>(dev, 4096);
+  vm.PrepareWorkspace(ctx_a, env_a);
+  std::memset(env_a->workspace, 0xa, env_a->nbytes);
+  // A larger workspace of another context must not move or release the first one.
+  vm.PrepareWorkspace(ctx_b, env_b);
+  ASSERT_NE(env_a->workspace, nullptr);
+  ASSERT_NE(env_b->workspace, nullptr);
+  ASSERT_NE(env_a->workspace, env_b->workspace);
+  std::memset(env_b->workspace, 0xb, env_b->nbytes);
+  auto* bytes = static_cast<unsigned char*>(env_a->workspace);
+  for (int64_t i = 0; i < env_a->nbytes; ++i) {
+    ASSERT_EQ(bytes[i], 0xa);
+  }
+  vm.ReleaseWorkspace(ctx_a, env_a);
+  vm.ReleaseWorkspace(ctx_b, env_b);
+}
+
+TEST(Workspace, CPUContextsConcurrent) {
+  Device dev{DevType::kCPU(), 0};
+  WorkspaceVM vm;
+  constexpr int kNumThreads = 4;
+  std::vector<int> failures(kNumThreads, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      VMContext ctx = MakeContext();
+      for (int iter = 0; iter < 200; ++iter) {
+        // Growing sizes exercise the reallocation of a shared workspace, if any.
+        auto env = std::make_shared<WorkspaceOpEnv>(dev, 256 * (iter % 16 + 1));
+        vm.PrepareWorkspace(ctx, env);
+        auto* bytes = static_cast<unsigned char*>(env->workspace);
+        std::memset(bytes, t + 1, env->nbytes);
+        std::this_thread::yield();
+        for (int64_t i = 0; i < env->nbytes; ++i) {
+          failures[t] += bytes[i] != t + 1;
+        }
+        vm.ReleaseWorkspace(ctx, env);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < kNumThreads; ++t) {
+    ASSERT_EQ(failures[t], 0) << "The workspace of thread " << t << " was overwritten";
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
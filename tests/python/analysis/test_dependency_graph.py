@@ -6,7 +6,7 @@ import pytest
 import raf
 from raf.testing import randn
 from raf._ffi.pass_ import ToGraphNormalForm
-from raf._ffi.analysis import GetDependencyGraphNodesEdges
+from raf._ffi.analysis import GetDependencyGraphNodesEdges, GetCompactDependencyGraphNodesEdges
 
 
 def test_prune_atomic_nodes():
@@ -92,5 +92,39 @@ def test_prune_redundant_edges():
     assert pruned_num_edges == 3
 
 
+@pytest.mark.parametrize("prune_atomic_nodes", [False, True])
+@pytest.mark.parametrize("prune_redundant_edges", [False, True])
+def test_compact_graph(prune_atomic_nodes, prune_redundant_edges):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.atan(x)
+            z = raf.atan(y)
+            w = raf.add(y, z)
+            w = raf.add(w, w)
+            return raf.concatenate([y, z, w])
+
+    model = Model()
+    x, _ = randn([2, 2])
+    mod = ToGraphNormalForm()(model._internal(x).mod)
+    expr = mod["main"].body
+
+    def to_list(graph):
+        nodes = list(graph["nodes"])
+        index = {node: i for i, node in enumerate(nodes)}
+        edges = [(index[edge[0]], index[edge[1]]) for edge in graph["edges"]]
+        return nodes, sorted(edges)
+
+    args = (expr, prune_atomic_nodes, prune_redundant_edges)
+    nodes, edges = to_list(GetDependencyGraphNodesEdges(*args))
+    compact_nodes, compact_edges = to_list(GetCompactDependencyGraphNodesEdges(*args))
+    assert len(nodes) == len(compact_nodes)
+    assert all(lhs.same_as(rhs) for lhs, rhs in zip(nodes, compact_nodes) if lhs is not None)
+    assert edges == compact_edges
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,53 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+import numpy as np
+import pytest
+
+import raf
+from raf._ffi.executor import GetInterpreterOpEnvCacheStats, ClearInterpreterOpEnvCache
+from raf.testing import check, get_testable_devices, randn
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_op_env_cache(device):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.matmul(x, x)
+            y = raf.relu(y)
+            return raf.sum(y, axis=1)
+
+    def get_stats():
+        return {k: v.value for k, v in GetInterpreterOpEnvCacheStats().items()}
+
+    model = Model()
+    model.infer_mode()
+    m_x, n_x = randn([8, 8], device=device)
+    ref = np.sum(np.maximum(np.matmul(n_x, n_x), 0), axis=1)
+
+    ClearInterpreterOpEnvCache()
+    before = get_stats()
+    check(model(m_x), ref, rtol=1e-4, atol=1e-4)
+    first = get_stats()
+    assert first["miss"] > before["miss"]
+
+    # The second run reuses the op envs of the first run, even though the IR is re-created.
+    check(model(m_x), ref, rtol=1e-4, atol=1e-4)
+    second = get_stats()
+    assert second["miss"] == first["miss"]
+    assert second["hit"] > first["hit"]
+
+    # A different shape is dispatched again.
+    m_x, n_x = randn([4, 4], device=device)
+    ref = np.sum(np.maximum(np.matmul(n_x, n_x), 0), axis=1)
+    check(model(m_x), ref, rtol=1e-4, atol=1e-4)
+    assert get_stats()["miss"] > second["miss"]
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
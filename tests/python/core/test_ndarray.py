@@ -37,6 +37,20 @@ def test_move_device():
     np.testing.assert_allclose(np.array([1, 2, 3], dtype="float32"), a.numpy())
 
 
+@pytest.mark.skipif(
+    not raf.build.with_cuda() or not tvm.cuda(1).exist, reason="Two GPUs are required"
+)
+def test_move_between_gpus():
+    n_x = np.random.randn(4, 8).astype("float32")
+    m_x = raf.array(n_x, device="cuda(0)")
+    m_y = m_x.to(device="cuda(1)")
+    assert m_y.device == "cuda(1)"
+    np.testing.assert_equal(m_y.numpy(), n_x)
+    m_z = m_y.to(device="cuda(0)")
+    assert m_z.device == "cuda(0)"
+    np.testing.assert_equal(m_z.numpy(), n_x)
+
+
 def test_bf16_ndarray():
     def np_float2np_bf16(arr):
         """Convert a numpy array of float to a numpy array
@@ -67,5 +81,23 @@ def test_bf16_ndarray():
     np.testing.assert_equal(n_x, n_y)
 
 
+@pytest.mark.parametrize("dtype", ["float16", "bfloat16"])
+def test_convert_dtype(dtype):
+    # More elements than a conversion chunk, so that the chunks are stitched.
+    n_x = np.random.randn(3, (1 << 21) + 7).astype("float32")
+    n_x[0, :3] = [np.nan, np.inf, -np.inf]
+    m_x = raf.array(n_x)
+    m_y = m_x.to(dtype=dtype)
+    assert m_y.dtype == dtype
+    assert m_y.shape == m_x.shape
+    m_z = m_y.to(dtype="float32")
+    assert m_z.dtype == "float32"
+    n_z = m_z.numpy()
+    assert np.isnan(n_z[0, 0])
+    np.testing.assert_equal(n_z[0, 1:3], n_x[0, 1:3])
+    rtol = 1e-3 if dtype == "float16" else 1e-2
+    np.testing.assert_allclose(n_z[1:], n_x[1:], rtol=rtol, atol=rtol)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -3,8 +3,12 @@
 
 import numpy as np
 import pytest
+import torch
+from torch.utils import dlpack as torch_dlpack
 
 import raf
+from raf._core.executor import VMExecutor
+from raf.testing import check, get_testable_devices
 
 
 def test_raf_array_cpu():
@@ -20,6 +24,29 @@ def test_raf_array_cuda():
     assert np.all(array == [1, 2, 3])
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_dlpack_torch(device):
+    from tvm import relay
+
+    t_x = torch.randn(3, 4, device="cuda" if device == "cuda" else "cpu")
+    m_x = raf.from_dlpack(t_x)
+    assert m_x.device.startswith(device)
+
+    # The memory is shared with the torch tensor.
+    t_x.add_(1)
+    check(m_x, t_x.cpu().numpy())
+
+    # The VM takes the torch tensor as is, and the output goes back to torch without a copy.
+    x = raf.ir.var("x", shape=(3, 4))
+    mod = raf.ir.IRModule()
+    mod["main"] = relay.Function([x], raf.ir.op.relu(x))
+    vm = VMExecutor(mod, device).vm
+    m_y = vm.run(t_x)
+    t_y = torch_dlpack.from_dlpack(m_y)
+    assert t_y.device == t_x.device
+    assert t_y.data_ptr() == m_y.data
+    check(t_y.cpu().numpy(), torch.relu(t_x).cpu().numpy())
+
+
 if __name__ == "__main__":
-    test_raf_array_cpu()
-    test_raf_array_cuda()
+    pytest.main([__file__])
@@ -1,10 +1,13 @@
 # Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
 # SPDX-License-Identifier: Apache-2.0
 
+import re
 import pytest
 import numpy as np
 import raf
 from raf._core.executor import VMExecutor
+from raf._core.ndarray import Symbol
+from raf._lib import relay
 from raf.testing import check, compile_vm_model, run_vm_model, get_arr_addr, randn
 from raf.testing import get_testable_devices
 
@@ -77,6 +80,496 @@ def test_cuda_graph(shape):
     assert executable.globals[0] == "main"
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_cuda_graph_shape_buckets():
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.argwhere(x)
+            y = raf.add(y, y)
+            z = raf.multiply(y, y)
+            return z
+
+    dev = "cuda"
+    model = Model()
+    model.infer_mode()
+    inputs = []
+    for num_nonzeros in [3, 5, 7]:
+        n_x = np.zeros([4, 4], dtype="float32")
+        n_x.reshape(-1)[:num_nonzeros] = 1
+        inputs.append(raf.array(n_x, device=dev))
+    mod = model._internal(inputs[0]).mod
+    executor = VMExecutor(mod, dev, enable_cuda_graph=True)
+    # The graphs of the segment after argwhere are cached by shapes, and replayed (or updated)
+    # when the shape comes back.
+    for i in [0, 1, 0, 2, 1, 0, 2, 2]:
+        m_z = executor.vm.run(inputs[i]).numpy()
+        ref_z = model(inputs[i]).numpy()
+        np.testing.assert_allclose(m_z, ref_z, rtol=1e-5, atol=1e-5)
+
+
+def test_infer_type_memoization():
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.argwhere(x)
+            y = raf.add(y, y)
+            z = raf.multiply(y, y)
+            return z
+
+    model = Model()
+    model.infer_mode()
+    inputs = []
+    for num_nonzeros in [3, 5, 7]:
+        n_x = np.zeros([4, 4], dtype="float32")
+        n_x.reshape(-1)[:num_nonzeros] = 1
+        inputs.append(raf.array(n_x))
+    mod = model._internal(inputs[0]).mod
+    executor = VMExecutor(mod, "cpu")
+    # The inferred types after argwhere are memoized by shapes, and reused for a repeated shape.
+    for i in [0, 1, 0, 2, 1, 0, 2, 2]:
+        m_z = executor.vm.run(inputs[i]).numpy()
+        ref_z = model(inputs[i]).numpy()
+        np.testing.assert_allclose(m_z, ref_z, rtol=1e-5, atol=1e-5)
+
+
+def test_shape_buckets():
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            z = raf.relu(y)
+            return z
+
+    model = Model()
+    model.infer_mode()
+    x = Symbol.make_var("x", relay.TensorType((relay.Any(), 16)))
+    mod = model._internal(x).mod
+    config = {"raf.vm.shape_buckets": [{"x": [2, 16]}, {"x": [4, 16]}]}
+    with raf.ir.PassContext(config=config):
+        executor = VMExecutor(mod, "cpu")
+    assert "main_bucket0" in executor.executable.globals
+    assert "main_bucket1" in executor.executable.globals
+
+    # The inputs run the versions of their shape buckets, or the general version otherwise.
+    for batch, func in [(4, "main_bucket1"), (3, "main"), (2, "main_bucket0")]:
+        m_x, n_x = randn((batch, 16))
+        executor.vm.set_counters(True)
+        m_z = executor.vm.run(m_x)
+        counters = executor.vm.get_counters()
+        executor.vm.set_counters(False)
+        executor.vm.reset_counters()
+        assert {item["func"] for item in counters["pc_counts"]} == {func}
+        check(m_z, np.maximum(n_x + n_x, 0))
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_cuda_graph_segments():
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            y = raf.matmul(y, x)
+            y = raf.relu(y)
+            z = raf.argwhere(y)
+            return z
+
+    dev = "cuda"
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([8, 8], device=dev)
+    ref_z = model(m_x).numpy()
+    mod = model._internal(m_x).mod
+    # The dynamic shape prevents capturing the whole function into one CUDA graph.
+    executor = VMExecutor(mod, dev, enable_cuda_graph=True)
+    # The segments are executed eagerly for the first time, then captured and replayed.
+    for _ in range(3):
+        m_z = executor.vm.run(m_x).numpy()
+        np.testing.assert_allclose(m_z, ref_z, rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_cuda_graph_multi_stream():
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            a = raf.relu(raf.matmul(x, x))
+            b = raf.tanh(raf.add(x, x))
+            return raf.add(a, b)
+
+    dev = "cuda"
+    model = Model()
+    model.infer_mode()
+    inputs = [randn([16, 16], device=dev) for _ in range(2)]
+    mod = model._internal(inputs[0][0]).mod
+    # The branches run on different streams, which are captured into one graph with the events
+    # between them.
+    with raf.ir.PassContext(opt_level=2, config={"raf.stream_schedule.policy": "wavefront"}):
+        executor = VMExecutor(mod, dev, enable_cuda_graph=True)
+    # The graph is captured by the first run and replayed by the others. The input bound to the
+    # graph is used without copy, and the other one is copied into the bound buffer.
+    for i in [0, 0, 1, 1]:
+        m_x, n_x = inputs[i]
+        ref = np.maximum(np.matmul(n_x, n_x), 0) + np.tanh(n_x + n_x)
+        check(executor.vm.run(m_x), ref, rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_stream_ordered_alloc():
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            z = raf.relu(y)
+            a = raf.add(x, z)
+            return a
+
+    dev = "cuda"
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([16, 16], device=dev)
+    ref_z = model(m_x).numpy()
+    mod = model._internal(m_x).mod
+    with raf.ir.PassContext(opt_level=2, config={"raf.stream_schedule.policy": "wavefront"}):
+        executor = VMExecutor(mod, dev, stream_ordered_alloc=True)
+    for _ in range(3):
+        m_z = executor.vm.run(m_x).numpy()
+        np.testing.assert_allclose(m_z, ref_z, rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_threaded_dispatch(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            z = raf.relu(y)
+            a = raf.add(x, z)
+            return a
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([4, 4], device=device)
+    ref_z = model(m_x).numpy()
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, device, threaded_dispatch=True)
+    # execute multiple times to reuse the decoded instructions and the op envs
+    for _ in range(3):
+        m_z = executor.vm.run(m_x).numpy()
+        np.testing.assert_allclose(m_z, ref_z, rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("threaded_dispatch", [False, True])
+def test_counters(device, threaded_dispatch):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            z = raf.relu(y)
+            return z
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([4, 4], device=device)
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, device, threaded_dispatch=threaded_dispatch)
+    vm = executor.vm
+
+    # Nothing is counted before the counter mode is on.
+    vm.run(m_x)
+    assert not vm.get_counters()["opcode_counts"]
+
+    vm.set_counters(True)
+    for _ in range(3):
+        vm.run(m_x)
+    vm.set_counters(False)
+    vm.run(m_x)
+    counters = vm.get_counters()
+    assert counters["opcode_counts"]["InvokeJit"] % 3 == 0
+    assert counters["opcode_counts"]["Ret"] == 3
+    # Each executed instruction is counted once per run.
+    assert all(item["count"] == 3 for item in counters["pc_counts"])
+    assert sum(item["count"] for item in counters["pc_counts"]) == sum(
+        counters["opcode_counts"].values()
+    )
+    assert counters["prepare_op_env_us"] > 0
+    assert counters["num_allocs"] > 0
+
+    vm.reset_counters()
+    assert not vm.get_counters()["pc_counts"]
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_serving_mode(device):
+    # pylint: disable=protected-access
+    import threading
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            y = raf.matmul(y, x)
+            z = raf.relu(y)
+            return z
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([16, 16], device=device)
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, device, serving_mode=True)
+
+    inputs = [randn([16, 16], device=device)[0] for _ in range(4)]
+    refs = [model(m_x).numpy() for m_x in inputs]
+    errors = []
+
+    def worker(idx):
+        try:
+            for _ in range(5):
+                m_z = executor.vm.run(inputs[idx]).numpy()
+                np.testing.assert_allclose(m_z, refs[idx], rtol=1e-4, atol=1e-4)
+        except Exception as err:  # pylint: disable=broad-except
+            errors.append(err)
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(len(inputs))]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert not errors, errors
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_batching_executor(device):
+    # pylint: disable=protected-access
+    import threading
+    from raf._core.vm import BatchingExecutor
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            z = raf.relu(y)
+            return z
+
+    batch_size = 4
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([batch_size, 8], device=device)
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, device)
+    batching = BatchingExecutor(
+        executor.vm, [0], max_batch_size=batch_size, max_delay_us=2000, batch_buckets=[batch_size]
+    )
+
+    # Requests smaller than the compiled batch size are coalesced and padded.
+    requests = [np.random.randn(1 + i % 2, 8).astype("float32") for i in range(6)]
+    results = [None] * len(requests)
+
+    def worker(idx):
+        results[idx] = batching(raf.array(requests[idx], device=device)).numpy()
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(len(requests))]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    for n_x, n_z in zip(requests, results):
+        np.testing.assert_allclose(n_z, np.maximum(n_x + n_x, 0), rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_generation_scheduler(device):
+    # pylint: disable=protected-access, too-many-locals
+    import threading
+    from raf._core.vm import GenerationScheduler
+
+    class Step(raf.Model):
+        # pylint: disable=attribute-defined-outside-init, too-many-arguments
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(
+            self, tokens, positions, slots, tables, mask, k_cache, v_cache, scale, vocab
+        ):  # pylint: disable=no-self-use, unused-argument
+            x = raf.reshape(raf.cast(tokens, "float32"), (-1, 1, 1))
+            k_cache = raf.kv_cache_append(k_cache, x, slots)
+            v_cache = raf.kv_cache_append(v_cache, x, slots)
+            keys = raf.reshape(raf.kv_cache_gather(k_cache, tables), (max_num_tokens, -1))
+            values = raf.reshape(raf.kv_cache_gather(v_cache, tables), (max_num_tokens, -1))
+            # The attention picks the largest token of the prefix, and the next token is one more.
+            probs = raf.softmax(raf.add(raf.multiply(keys, scale), mask))
+            out = raf.sum(raf.multiply(probs, values), axis=1, keepdims=True)
+            diff = raf.subtract(out, vocab)
+            return raf.negative(raf.multiply(diff, diff))
+
+    num_blocks, block_size, max_num_tokens, max_seq_len, vocab_size = 6, 2, 8, 8, 16
+    max_blocks = max_seq_len // block_size
+    n_args = [
+        np.zeros([max_num_tokens], dtype="int64"),
+        np.zeros([max_num_tokens], dtype="int64"),
+        np.zeros([max_num_tokens], dtype="int64"),
+        np.zeros([max_num_tokens, max_blocks], dtype="int64"),
+        np.zeros([max_num_tokens, max_blocks * block_size], dtype="float32"),
+        np.zeros([num_blocks, block_size, 1, 1], dtype="float32"),
+        np.zeros([num_blocks, block_size, 1, 1], dtype="float32"),
+    ]
+    params = [
+        raf.array(np.array(50.0, dtype="float32"), device=device),
+        raf.array(np.arange(-1, vocab_size - 1, dtype="float32").reshape(1, -1), device=device),
+    ]
+    model = Step()
+    model.infer_mode()
+    m_args = [raf.array(arg, device=device) for arg in n_args] + params
+    mod = model._internal(*m_args).mod
+    executor = VMExecutor(mod, device)
+    # Only 6 blocks for 4 sequences of up to 8 tokens, so the sequences are preempted.
+    scheduler = GenerationScheduler(
+        executor.vm,
+        num_layers=1,
+        num_blocks=num_blocks,
+        block_size=block_size,
+        token_shape=(1, 1),
+        max_num_tokens=max_num_tokens,
+        max_num_seqs=3,
+        max_seq_len=max_seq_len,
+        device=device,
+        eos_token_id=9,
+        params=params,
+    )
+
+    prompts = [[1, 3, 2], [4], [0, 2], [7, 1, 5, 3]]
+    results = [None] * len(prompts)
+
+    def worker(idx):
+        results[idx] = scheduler.generate(prompts[idx], max_new_tokens=4)
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(len(prompts))]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    # A sequence ends at EOS, after max_new_tokens, or at max_seq_len.
+    assert results == [[4, 5, 6, 7], [5, 6, 7, 8], [3, 4, 5, 6], [8, 9]]
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_shared_constants(device):
+    # pylint: disable=protected-access
+    from tvm import relay
+    from raf._core.device import Device
+    from raf._core.vm import VirtualMachine
+
+    shape = (3, 5)
+    n_c = np.random.randn(1, 5).astype("float32")
+    x = raf.ir.var("x", shape=shape)
+    y = raf.ir.op.add(x, raf.ir.const(n_c))
+    y = raf.ir.op.multiply(y, raf.ir.const(n_c))
+    mod = raf.ir.IRModule()
+    mod["main"] = relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    executor = VMExecutor(mod, device)
+
+    # The VMs running the same executable share the constants on the device.
+    vms = [executor.vm, VirtualMachine(executor.executable, Device(device))]
+    for _ in range(2):
+        for vm in vms:
+            m_x, n_x = randn(shape, device=device)
+            check(vm.run(m_x), (n_x + n_c) * n_c)
+
+
+def run_with_ipc_constants(path, handle, n_x, queue):
+    # pylint: disable=import-outside-toplevel
+    from raf._core.device import Device
+    from raf._core.vm import Executable, VirtualMachine
+
+    vm = VirtualMachine(Executable.load_aot(path), Device("cuda"), ipc_constants=handle)
+    queue.put(vm.run(raf.array(n_x, device="cuda")).numpy())
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_ipc_constants(tmp_path):
+    # pylint: disable=protected-access
+    import multiprocessing
+    from tvm import relay
+
+    shape = (3, 5)
+    n_c = np.random.randn(1, 5).astype("float32")
+    x = raf.ir.var("x", shape=shape)
+    y = raf.ir.op.add(x, raf.ir.const(n_c))
+    y = raf.ir.op.multiply(y, raf.ir.const(n_c))
+    mod = raf.ir.IRModule()
+    mod["main"] = relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    executor = VMExecutor(mod, "cuda")
+    m_x, n_x = randn(shape, device="cuda")
+    check(executor.vm.run(m_x), (n_x + n_c) * n_c)
+    executor.executable.export_aot(str(tmp_path))
+
+    # The exporting VM keeps using the constants, which are moved to the shared buffer.
+    handle = executor.vm.export_constants()
+    check(executor.vm.run(m_x), (n_x + n_c) * n_c)
+
+    # Another process imports the constants instead of uploading them.
+    ctx = multiprocessing.get_context("spawn")
+    queue = ctx.Queue()
+    proc = ctx.Process(
+        target=run_with_ipc_constants, args=(str(tmp_path), bytes(handle), n_x, queue)
+    )
+    proc.start()
+    out = queue.get(timeout=600)
+    proc.join()
+    assert proc.exitcode == 0
+    check(out, (n_x + n_c) * n_c)
+
+
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("shape", [[3, 3], [4, 4]])
 def test_tuple(device, shape):
@@ -218,5 +711,834 @@ def test_reshape():
     check(out, ref_out)
 
 
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_persistent_storage(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            y = raf.matmul(y, x)
+            z = raf.relu(y)
+            return z
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([16, 16], device=device)
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, device, persistent_storage=True)
+    ref_z = model(m_x).numpy()
+
+    m_z = executor.vm.run(m_x)
+    addr = get_arr_addr(m_z)
+    check(m_z, ref_z)
+    # The output buffer is reused once the output of the previous execution is released.
+    m_z = None
+    m_z = executor.vm.run(m_x)
+    assert get_arr_addr(m_z) == addr
+    check(m_z, ref_z)
+    # The output buffer is not overwritten while it is still held by the user.
+    m_z2 = executor.vm.run(m_x)
+    assert get_arr_addr(m_z2) != addr
+    check(m_z, ref_z)
+    check(m_z2, ref_z)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("persistent_storage", [False, True])
+def test_alloc_batching(device, persistent_storage):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            a = raf.add(x, x)
+            b = raf.multiply(a, x)
+            c = raf.relu(b)
+            d = raf.subtract(c, a)
+            return a, b, d
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([16, 16], device=device)
+    mod = model._internal(m_x).mod
+    refs = [ref.numpy() for ref in model(m_x)]
+    num_allocs = {}
+    for batching in [True, False]:
+        executor = VMExecutor(mod, device, persistent_storage=persistent_storage)
+        vm = executor.vm
+        vm.set_alloc_batching(batching)
+        vm.set_counters(True)
+        for _ in range(3):
+            outs = vm.run(m_x)
+            for out, ref in zip(outs, refs):
+                check(out, ref)
+        if persistent_storage:
+            # The persistent output buffers are still reused once the outputs are released.
+            addrs = [get_arr_addr(out) for out in outs]
+            outs = None
+            outs = vm.run(m_x)
+            assert [get_arr_addr(out) for out in outs] == addrs
+            for out, ref in zip(outs, refs):
+                check(out, ref)
+        vm.set_counters(False)
+        num_allocs[batching] = vm.get_counters()["num_allocs"]
+    # Batching changes how the storages are allocated, but not how many.
+    assert num_allocs[True] == num_allocs[False]
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_op_env_reuse(device):
+    # pylint: disable=protected-access, import-outside-toplevel
+    from raf.utils import profiler
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.matmul(x, x)
+            z = raf.relu(y)
+            return z
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([8, 8], device=device)
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, device)
+    ref_z = model(m_x).numpy()
+    check(executor.vm.run(m_x), ref_z)
+
+    # The OpEnvs are reused from the previous invocations, while the profiler still gets the keys.
+    profiler.clear()
+    profiler.start()
+    m_x2, _ = randn([8, 8], device=device)
+    check(executor.vm.run(m_x2), model(m_x2).numpy())
+    profiler.stop()
+    events = [e for e in profiler.get()["traceEvents"] if e["cat"] == "ComputationOperator"]
+    profiler.clear()
+    if device == "cpu":
+        assert events
+    assert all("T<8x8x" in e["args"]["args_string"] for e in events)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_frozen(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            y = raf.matmul(y, x)
+            z = raf.relu(y)
+            return z
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([16, 16], device=device)
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, device, frozen=True)
+    # The first execution records the kernels, and the following ones replay them on the inputs
+    # copied into the pre-bound buffers.
+    for _ in range(3):
+        m_x, _ = randn([16, 16], device=device)
+        check(executor.vm.run(m_x), model(m_x).numpy())
+    # The bytecode is interpreted when counted.
+    executor.vm.set_counters(True)
+    m_x, _ = randn([16, 16], device=device)
+    check(executor.vm.run(m_x), model(m_x).numpy())
+    executor.vm.set_counters(False)
+    assert executor.vm.get_counters()["opcode_counts"]["InvokeJit"] > 0
+    m_x, _ = randn([16, 16], device=device)
+    check(executor.vm.run(m_x), model(m_x).numpy())
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_jit_warmup(device):
+    # pylint: disable=protected-access, import-outside-toplevel
+    from raf.utils import profiler
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            y = raf.matmul(y, x)
+            z = raf.relu(y)
+            z = raf.sum(z, axis=1)
+            return z
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([16, 16], device=device)
+    mod = model._internal(m_x).mod
+    profiler.clear()
+    profiler.start()
+    with raf.ir.PassContext(config={"raf.vm.jit_warmup_threads": 4}):
+        executor = VMExecutor(mod, device)
+    profiler.stop()
+    durations = profiler.get_category_durations(profiler.get(), "Compile")
+    profiler.clear()
+    assert "JITWarmup" in durations
+    check(executor.vm.run(m_x), model(m_x).numpy())
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_compile_cache(device):
+    # pylint: disable=protected-access, import-outside-toplevel
+    from raf.utils import profiler
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.matmul(x, x)
+            return raf.relu(y)
+
+    def compile_model(config):
+        mod = model._internal(m_x).mod
+        profiler.clear()
+        profiler.start()
+        with raf.ir.PassContext(config=config):
+            executor = VMExecutor(mod, device)
+        profiler.stop()
+        durations = profiler.get_category_durations(profiler.get(), "Compile")
+        profiler.clear()
+        check(executor.vm.run(m_x), model(m_x).numpy())
+        return durations
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([8, 8], device=device)
+    config = {"raf.vm.compile_cache": True}
+    compile_model(config)
+    durations = compile_model(config)
+    assert "LoadCompiledModule" in durations and "OptimizeModule" not in durations
+    # A different config misses the cache.
+    durations = compile_model({"raf.vm.compile_cache": True, "raf.vm.optimize.anf_only": True})
+    assert "OptimizeModule" in durations
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_reuse_registers(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.relu(x)
+            y = raf.matmul(y, x)
+            y = raf.add(y, x)
+            y = raf.matmul(y, y)
+            y = raf.tanh(y)
+            return raf.add(y, x)
+
+    def compile_model(reuse_registers):
+        mod = model._internal(m_x).mod
+        with raf.ir.PassContext(config={"raf.vm.reuse_registers": reuse_registers}):
+            executor = VMExecutor(mod, device)
+        bytecode = executor.executable.bytecode
+        num_regs = int(re.search(r"# reg file size = (\d+)", bytecode).group(1))
+        # The recycled frame is run again with the released registers.
+        for _ in range(2):
+            check(executor.vm.run(m_x), ref_y, rtol=1e-4, atol=1e-4)
+        return bytecode, num_regs
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([8, 8], device=device)
+    ref_y = model(m_x).numpy()
+    bytecode, num_regs = compile_model(True)
+    base_bytecode, base_num_regs = compile_model(False)
+    assert "kill_register" in bytecode and "kill_register" not in base_bytecode
+    assert num_regs < base_num_regs
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_input_prefetcher(device):
+    # pylint: disable=protected-access
+    from raf._core.vm import InputPrefetcher
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):  # pylint: disable=no-self-use
+            return raf.add(x, y)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([4, 8], device=device)
+    mod = model._internal(m_x, m_x).mod
+    executor = VMExecutor(mod, device)
+
+    batches = [
+        (np.random.randn(4, 8).astype("float32"), np.random.randn(4, 8).astype("float32"))
+        for _ in range(5)
+    ]
+    prefetcher = InputPrefetcher(device, depth=2)
+    results = []
+    for inputs in prefetcher.prefetch(batches):
+        assert all(x.device.startswith(device) for x in inputs)
+        results.append(executor.vm.run(*inputs).numpy())
+    assert len(results) == len(batches)
+    for (n_x, n_y), n_z in zip(batches, results):
+        np.testing.assert_allclose(n_z, n_x + n_y, rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("serving_mode", [False, True])
+def test_run_future(device, serving_mode):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.matmul(x, x)
+            return raf.relu(y)
+
+    model = Model()
+    model.infer_mode()
+    m_x, n_x = randn([32, 32], device=device)
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, device, serving_mode=serving_mode)
+
+    futures = [executor.vm.run_future(m_x) for _ in range(3)]
+    ref = np.maximum(np.matmul(n_x, n_x), 0)
+    for future in futures:
+        check(future.result(), ref, rtol=1e-4, atol=1e-4)
+        assert future.done()
+    np.testing.assert_allclose(futures[-1].numpy(), ref, rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_async_dispatch(device):
+    # pylint: disable=protected-access
+    from raf._core.vm import VirtualMachine
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.matmul(x, x)
+            return raf.relu(y)
+
+    model = Model()
+    model.infer_mode()
+    inputs = [randn([32, 32], device=device) for _ in range(5)]
+    mod = model._internal(inputs[0][0]).mod
+    executor = VMExecutor(mod, device)
+    vm = VirtualMachine(executor.executable, executor.device, async_dispatch=True)
+
+    # More executions than the depth of the dispatch queue are submitted before any is read.
+    futures = [vm.run_future(m_x) for m_x, _ in inputs]
+    # A synchronous run is launched after the pending ones.
+    m_x, n_x = inputs[0]
+    check(vm.run(m_x), np.maximum(np.matmul(n_x, n_x), 0), rtol=1e-4, atol=1e-4)
+    for future, (_, n_x) in zip(futures, inputs):
+        check(future.result(), np.maximum(np.matmul(n_x, n_x), 0), rtol=1e-4, atol=1e-4)
+        assert future.done()
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("serving_mode", [False, True])
+def test_host_outputs(serving_mode):
+    # pylint: disable=protected-access
+    from raf._core.vm import VirtualMachine
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.matmul(x, x)
+            return raf.relu(y), y
+
+    device = "cuda"
+    model = Model()
+    model.infer_mode()
+    inputs = [randn([32, 32], device=device) for _ in range(6)]
+    mod = model._internal(inputs[0][0]).mod
+    executor = VMExecutor(mod, device)
+    vm = VirtualMachine(
+        executor.executable, executor.device, serving_mode=serving_mode, host_outputs=True
+    )
+
+    # More executions than the staging slots are in flight, and the outputs of all of them are
+    # held, so that the pinned buffers in use are not reused.
+    futures = [vm.run_future(m_x) for m_x, _ in inputs]
+    outputs = [future.result() for future in futures]
+    for (out, y), (_, n_x) in zip(outputs, inputs):
+        n_y = np.matmul(n_x, n_x)
+        assert out.device.startswith("cpu")
+        check(out, np.maximum(n_y, 0), rtol=1e-4, atol=1e-4)
+        check(y, n_y, rtol=1e-4, atol=1e-4)
+    m_x, n_x = inputs[0]
+    out, _ = vm.run(m_x)
+    assert out.device.startswith("cpu")
+    check(out, np.maximum(np.matmul(n_x, n_x), 0), rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_run_steps(device):
+    # pylint: disable=protected-access
+    from raf._core.vm import InputPrefetcher
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):  # pylint: disable=no-self-use
+            return raf.matmul(x, w)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([4, 8], device=device)
+    m_w, n_w = randn([8, 8], device=device)
+    mod = model._internal(m_x, m_w).mod
+    executor = VMExecutor(mod, device)
+
+    batches = [np.random.randn(4, 8).astype("float32") for _ in range(4)]
+    # The weight stays bound to the context, while the batches are rebound at each step.
+    source = iter(batches)
+    outs = executor.vm.run_steps(
+        len(batches), m_x, m_w, next_batch=lambda: [next(source)], batch_args=[0]
+    )
+    assert len(outs) == len(batches)
+    for n_x, out in zip(batches, outs):
+        check(out, np.matmul(n_x, n_w), rtol=1e-4, atol=1e-4)
+
+    prefetcher = InputPrefetcher(device, depth=2)
+    prefetcher.push(batches[0])
+    prefetcher.push(batches[1])
+    outs = executor.vm.run_steps(2, m_x, m_w, next_batch=prefetcher, batch_args=[0])
+    for n_x, out in zip(batches, outs):
+        check(out, np.matmul(n_x, n_w), rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_reset_context(device):
+    # pylint: disable=protected-access
+    from tvm import relay
+
+    shape = (3, 5)
+    n_c = np.random.randn(1, 5).astype("float32")
+    x = raf.ir.var("x", shape=shape)
+    y = raf.ir.op.add(x, raf.ir.const(n_c))
+    y = raf.ir.op.multiply(y, raf.ir.const(n_c))
+    mod = raf.ir.IRModule()
+    mod["main"] = relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    vm = VMExecutor(mod, device).vm
+
+    # The context and its constant registers are reused by the following executions.
+    m_x, n_x = randn(shape, device=device)
+    ctx = vm.prepare_context("main", m_x)
+    check(vm.run_context(ctx), (n_x + n_c) * n_c)
+    for _ in range(3):
+        m_x, n_x = randn(shape, device=device)
+        vm.reset_context(ctx, m_x)
+        check(vm.run_context(ctx), (n_x + n_c) * n_c)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_reset_context_tuple(device):
+    # pylint: disable=protected-access
+    from tvm import relay
+
+    shape = (3, 5)
+    x = raf.ir.var("x", shape=shape)
+    tup = relay.Tuple([raf.ir.op.relu(x), raf.ir.op.tanh(x)])
+    y = raf.ir.op.add(relay.TupleGetItem(tup, 0), relay.TupleGetItem(tup, 1))
+    mod = raf.ir.IRModule()
+    mod["main"] = relay.Function([x], relay.Tuple([y, x]))
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    vm = VMExecutor(mod, device).vm
+
+    # The tuples kept by the recycled frame are refilled by the following executions.
+    m_x, n_x = randn(shape, device=device)
+    ctx = vm.prepare_context("main", m_x)
+    for _ in range(3):
+        out = vm.run_context(ctx)
+        check(out[0], np.maximum(n_x, 0) + np.tanh(n_x), rtol=1e-5, atol=1e-5)
+        check(out[1], n_x)
+        m_x, n_x = randn(shape, device=device)
+        vm.reset_context(ctx, m_x)
+
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("threaded_dispatch", [False, True])
+def test_fork_join(threaded_dispatch):
+    # pylint: disable=protected-access
+    from tvm import relay
+
+    # The sub-models are independent, so they are launched on separate streams and joined before
+    # their outputs are added.
+    shape = (16, 16)
+    mod = raf.ir.IRModule()
+    sub_models = []
+    for i, op in enumerate([raf.ir.op.relu, raf.ir.op.tanh, raf.ir.op.sigmoid]):
+        x = raf.ir.var("x", shape=shape)
+        sub_models.append(relay.GlobalVar("sub%d" % i))
+        mod[sub_models[-1]] = relay.Function([x], op(raf.ir.op.matmul(x, x)))
+    x = raf.ir.var("x", shape=shape)
+    outs = [relay.Call(sub_model, [x]) for sub_model in sub_models]
+    y = raf.ir.op.add(raf.ir.op.add(outs[0], outs[1]), outs[2])
+    mod["main"] = relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    vm = VMExecutor(mod, "cuda", threaded_dispatch=threaded_dispatch, fork_join=True).vm
+
+    for _ in range(3):
+        m_x, n_x = randn(shape, device="cuda")
+        n_y = np.matmul(n_x, n_x)
+        expected = np.maximum(n_y, 0) + np.tanh(n_y) + 1 / (1 + np.exp(-n_y))
+        check(vm.run(m_x), expected, rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize("threaded_dispatch", [False, True])
+def test_direct_call(threaded_dispatch):
+    # pylint: disable=protected-access
+    from tvm import relay
+
+    # The layer body is a global function called through a variable, as after LambdaLift.
+    shape = (4, 4)
+    mod = raf.ir.IRModule()
+    layer = relay.GlobalVar("layer")
+    x = raf.ir.var("x", shape=shape)
+    mod[layer] = relay.Function([x], raf.ir.op.relu(raf.ir.op.add(x, x)))
+    x = raf.ir.var("x", shape=shape)
+    f = relay.Var("f")
+    y = x
+    for _ in range(3):
+        y = relay.Call(f, [y])
+    mod["main"] = relay.Function([x], relay.Let(f, layer, y))
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    vm = VMExecutor(mod, "cpu", threaded_dispatch=threaded_dispatch).vm
+
+    vm.set_counters(True)
+    for _ in range(2):
+        m_x, n_x = randn(shape)
+        n_y = n_x
+        for _ in range(3):
+            n_y = np.maximum(n_y + n_y, 0)
+        check(vm.run(m_x), n_y)
+    counters = vm.get_counters()
+    # The calls of the known function skip the closure.
+    assert counters["opcode_counts"]["InvokeFunc"] == 6
+    assert "InvokeClosure" not in counters["opcode_counts"]
+
+
+@pytest.mark.parametrize("lower_tail_calls", [False, True])
+@pytest.mark.parametrize("exit_branch", ["param", "let"])
+def test_tail_call_loop(lower_tail_calls, exit_branch):
+    # pylint: disable=protected-access, too-many-locals
+    from tvm import relay
+
+    # A loop in the form of a tail-recursive function, as lowered from python/raf/hybrid, which
+    # computes a, b = b, a + b for n iterations.
+    shape = (4, 4)
+    mod = raf.ir.IRModule()
+    loop = relay.GlobalVar("loop")
+    i = raf.ir.var("i", shape=(), dtype="float32")
+    n = raf.ir.var("n", shape=(), dtype="float32")
+    a = raf.ir.var("a", shape=shape, dtype="float32")
+    b = raf.ir.var("b", shape=shape, dtype="float32")
+    i_1 = raf.ir.op.add(i, raf.ir.op.ones_like(i))
+    # The exit branch is either a bare param that emits no instructions, or a let chain.
+    exit_value = a if exit_branch == "param" else raf.ir.op.multiply(raf.ir.op.add(a, a), a)
+    # The parameters a and b are swapped, so they have to be updated in parallel.
+    body = relay.If(
+        raf.ir.op.greater(n, i), relay.Call(loop, [i_1, n, b, raf.ir.op.add(a, b)]), exit_value
+    )
+    mod[loop] = relay.Function([i, n, a, b], body, relay.TensorType(shape, "float32"))
+    params = [
+        raf.ir.var(name, shape=shape_, dtype="float32")
+        for name, shape_ in [("i", ()), ("n", ()), ("a", shape), ("b", shape)]
+    ]
+    mod["main"] = relay.Function(params, relay.Call(loop, params))
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    with raf.ir.PassContext(config={"raf.vm.lower_tail_calls": lower_tail_calls}):
+        vm = VMExecutor(mod, "cpu").vm
+
+    vm.set_counters(True)
+    num_iters = 5
+    m_i = raf.array(np.array(0, dtype="float32"))
+    m_n = raf.array(np.array(num_iters, dtype="float32"))
+    m_a, n_a = randn(shape)
+    m_b, n_b = randn(shape)
+    for _ in range(num_iters):
+        n_a, n_b = n_b, n_a + n_b
+    if exit_branch == "let":
+        n_a = (n_a + n_a) * n_a
+    for _ in range(2):
+        check(vm.run(m_i, m_n, m_a, m_b), n_a, rtol=1e-4, atol=1e-4)
+    counts = vm.get_counters()["opcode_counts"]
+    if lower_tail_calls:
+        # Only main calls the loop, whose iterations jump back to its entry in the same frame.
+        assert counts["InvokeFunc"] == 2
+        assert counts["Goto"] == 2 * num_iters
+    else:
+        assert counts["InvokeFunc"] == 2 * (num_iters + 1)
+
+
+@pytest.mark.parametrize("threaded_dispatch", [False, True])
+def test_cpu_lanes(threaded_dispatch):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            # The three branches form the chains of a wave, which run on separate CPU lanes.
+            a = raf.relu(raf.matmul(x, x))
+            b = raf.tanh(raf.matmul(x, x))
+            c = raf.sigmoid(raf.matmul(x, x))
+            return raf.add(raf.add(a, b), c)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([32, 32], device="cpu")
+    ref_y = model(m_x).numpy()
+    mod = model._internal(m_x).mod
+    with raf.ir.PassContext(config={"raf.stream_schedule.policy": "wavefront"}):
+        executor = VMExecutor(mod, "cpu", threaded_dispatch=threaded_dispatch)
+    for _ in range(3):
+        m_y = executor.vm.run(m_x).numpy()
+        np.testing.assert_allclose(m_y, ref_y, rtol=1e-4, atol=1e-4)
+
+
+def test_huge_page_pool():
+    # pylint: disable=protected-access
+    from raf._ffi.memory_pool import InitPool
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.relu(raf.matmul(x, x))
+            return raf.add(y, x)
+
+    model = Model()
+    model.infer_mode()
+    # The activations take a few huge pages.
+    m_x, _ = randn([1024, 1024], device="cpu")
+    ref_y = model(m_x).numpy()
+    mod = model._internal(m_x).mod
+    InitPool(raf.Device("cpu"), "huge_page_pool")
+    try:
+        executor = VMExecutor(mod, "cpu")
+        for _ in range(3):
+            m_y = executor.vm.run(m_x).numpy()
+            np.testing.assert_allclose(m_y, ref_y, rtol=1e-4, atol=1e-4)
+    finally:
+        InitPool(raf.Device("cpu"), "page_unit_pool")
+
+
+def test_kernel_cache_capacity():
+    # pylint: disable=protected-access
+    from raf._ffi.cache import DumpMetric, GetCacheSize, SetCacheCapacity
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            return raf.tanh(x)
+
+    def run_all():
+        model = Model()
+        for n in range(1, 21):
+            m_x, n_x = randn([n, 3], device="cpu")
+            check(run_vm_model(model, "cpu", [m_x]), np.tanh(n_x), rtol=1e-4, atol=1e-4)
+
+    run_all()
+    assert GetCacheSize("tvm_cpu") >= 20
+    # The capacity is split among the 16 shards, so each shard keeps one kernel.
+    SetCacheCapacity("tvm_cpu", 1)
+    try:
+        assert GetCacheSize("tvm_cpu") <= 16
+        assert DumpMetric("tvm_cpu")["CacheEviction"] > 0
+        # The evicted kernels are built again.
+        run_all()
+        assert GetCacheSize("tvm_cpu") <= 16
+    finally:
+        SetCacheCapacity("tvm_cpu", 0)
+
+
+@pytest.mark.parametrize("mode", ["any", "pow2"])
+def test_symbolic_shape_kernel(mode):
+    # pylint: disable=protected-access
+    from raf._ffi.cache import DumpMetric
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            return raf.tanh(raf.add(x, x))
+
+    def num_builds():
+        return int(dict(DumpMetric("tvm_cpu")).get("CacheSet", 0))
+
+    model = Model()
+    before = num_builds()
+    with raf.ir.PassContext(config={"raf.tvm.symbolic_shape": mode}):
+        for n in range(33, 41):
+            m_x, n_x = randn([n, 7], device="cpu")
+            check(run_vm_model(model, "cpu", [m_x]), np.tanh(n_x + n_x), rtol=1e-4, atol=1e-4)
+    # All shapes are in the power-of-two range (32, 64], so one kernel is built by both modes.
+    assert num_builds() - before == 1
+
+
+def test_tuning_database(tmp_path):
+    # pylint: disable=import-outside-toplevel
+    from tvm import auto_scheduler
+    from raf._core.executor import MetaFallbackContext
+    from raf.utils.tuner import extract_tuning_tasks, save_to_database
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):  # pylint: disable=no-self-use
+            return raf.matmul(x, y)
+
+    model = Model()
+    m_x, _ = randn([16, 16], device="cpu")
+    m_y, _ = randn([16, 16], device="cpu")
+    tasks, _ = extract_tuning_tasks(model, [m_x, m_y], "cpu")
+    assert tasks
+    task = tasks[0]
+    context = MetaFallbackContext(verbose=0)
+    assert context.query(task.target, task.workload_key, True, task.compute_dag, "f") is None
+
+    # Store a record as if it were tuned, which is then found by a new dispatch context.
+    inp = auto_scheduler.MeasureInput(task, task.compute_dag.get_init_state())
+    res = auto_scheduler.MeasureResult([0.1], 0, "", 0.1, 0)
+    log_file = str(tmp_path / "tuning.json")
+    auto_scheduler.save_records(log_file, [inp], [res])
+    assert save_to_database(log_file) == 1
+    # The stored record is only replaced by a faster one.
+    assert save_to_database(log_file) == 0
+    context = MetaFallbackContext(verbose=0)
+    state = context.query(task.target, task.workload_key, True, task.compute_dag, "f")
+    assert state is not None
+
+
+def test_model_executor_cache():
+    from raf._ffi.cache import DumpMetric, GetCacheSize, SetCacheCapacity
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            return raf.tanh(x)
+
+    def get_metric(name):
+        return DumpMetric("model_executor").get(name, 0)
+
+    model = Model()
+    model.infer_mode()
+    hits, misses = get_metric("CacheHit"), get_metric("CacheMiss")
+    for shape in [[2, 3], [4, 3], [2, 3], [4, 3]]:
+        m_x, n_x = randn(shape, device="cpu")
+        check(model.run_vm(m_x, device="cpu"), np.tanh(n_x), rtol=1e-4, atol=1e-4)
+    # Each input signature is compiled once.
+    assert get_metric("CacheMiss") - misses == 2
+    assert get_metric("CacheHit") - hits == 2
+    assert GetCacheSize("model_executor") >= 2
+
+    evictions = get_metric("CacheEviction")
+    SetCacheCapacity("model_executor", 1)
+    try:
+        for shape in [[5, 3], [6, 3]]:
+            m_x, n_x = randn(shape, device="cpu")
+            check(model.run_vm(m_x, device="cpu"), np.tanh(n_x), rtol=1e-4, atol=1e-4)
+        assert get_metric("CacheEviction") - evictions >= 1
+    finally:
+        SetCacheCapacity("model_executor", 8)
+
+
+def test_dtr():
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            a = raf.relu(x)
+            b = raf.tanh(a)
+            c = raf.sigmoid(b)
+            d = raf.exp(c)
+            e = raf.add(c, d)
+            e = raf.add(e, b)
+            return raf.add(e, a)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([64, 64], device="cpu")
+    mod = model._internal(m_x).mod
+    # Only a few 16KB tensors fit in the budget, so the early ones are evicted and recomputed.
+    executor = VMExecutor(mod, "cpu", dtr_budget=40000)
+    executor.vm.set_counters(True)
+    for _ in range(2):
+        m_x, _ = randn([64, 64], device="cpu")
+        check(executor.vm.run(m_x), model(m_x).numpy(), rtol=1e-4, atol=1e-4)
+    counters = executor.vm.get_counters()
+    assert counters["num_dtr_evictions"] > 0
+    assert counters["num_dtr_rematerializations"] > 0
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
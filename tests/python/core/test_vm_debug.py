@@ -113,5 +113,47 @@ def test_vm_memory_profiler(device, pool_name):
             assert peak_memory == 0
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_vm_allocation_report(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init,no-self-use
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            y = raf.conv2d(x, w, stride=1, padding=1, dilation=1, groups=1)
+            y = raf.conv2d(y, w, stride=1, padding=1, dilation=1, groups=1)
+            y = raf.conv2d(y, w, stride=1, padding=1, dilation=1, groups=1)
+            return y
+
+    xshape = (8, 3, 64, 64)
+    wshape = (3, 3, 3, 3)
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn(xshape, device=device)
+    m_w, _ = randn(wshape, device=device)
+
+    mod = model._internal(m_x, m_w).mod
+    with tvm.transform.PassContext(opt_level=3):
+        raf.utils.memory_profiler.reset()
+        raf.utils.memory_profiler.start()
+        VMExecutor(mod, device).make_executor()(m_x, m_w)
+        raf.utils.memory_profiler.stop()
+
+    buffer_size = (8 * 3 * 64 * 64) * 4 / 1048576
+    report = raf.utils.memory_profiler.get_allocation_report(raf.Device(device), 2 * buffer_size)
+    # The input of a conv2d and its output are live at the same time.
+    assert report["peak_live"].value >= 2 * buffer_size - 1e-3
+    live = report["live_at_peak"]
+    assert len(live) >= 2
+    assert any("conv2d" in str(item["op"]) for item in live)
+    assert all(str(item["var"]) for item in live)
+    assert "prediction_error" in report
+    assert 0 <= report["fragmentation"].value <= 1
+    assert raf.utils.memory_profiler.get_allocation_trace(raf.Device(device))
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -2,6 +2,8 @@
 # SPDX-License-Identifier: Apache-2.0
 
 # pylint: disable=invalid-name,protected-access,attribute-defined-outside-init
+import json
+
 import pytest
 import numpy as np
 import raf
@@ -19,7 +21,7 @@ def run_exec(exe, inputs):
     return out
 
 
-def serialize_and_load(exe):
+def serialize_and_load(exe, from_file=False):
     code, lib = exe.save()
     tmp = tvm.contrib.utils.tempdir()
     if lib is not None:
@@ -30,8 +32,10 @@ def serialize_and_load(exe):
         fo.write(code)
 
     # load from file
-    loaded_code = bytearray(open(code_path, "rb").read())
     loaded_lib = None if lib is None else tvm.runtime.load_module(lib_path)
+    if from_file:
+        return Executable.load_exec_from_file(code_path, loaded_lib)
+    loaded_code = bytearray(open(code_path, "rb").read())
     return Executable.load_exec(loaded_code, loaded_lib)
 
 
@@ -66,7 +70,8 @@ def test_simple(fuse):
 
 
 @pytest.mark.parametrize("fuse", [True, False])
-def test_constant(fuse):
+@pytest.mark.parametrize("from_file", [True, False])
+def test_constant(fuse, from_file):
     shape = (3, 5)
     konst1 = raf.ir.const(np.random.randn(1, 5).astype("float32"))
     x = raf.ir.var("x", shape=shape)
@@ -82,13 +87,14 @@ def test_constant(fuse):
     m_x, _ = randn(shape)
     ref_y = executor.make_executor()(m_x)
 
-    loaded_exe = serialize_and_load(executor.executable)
+    loaded_exe = serialize_and_load(executor.executable, from_file)
     m_y = run_exec(loaded_exe, [m_x])
     check(m_y, ref_y)
 
 
 @pytest.mark.parametrize("fuse", [True, False])
-def test_tuple(fuse):
+@pytest.mark.parametrize("from_file", [True, False])
+def test_tuple(fuse, from_file):
     rand, _ = randn((1,), device="cpu")
 
     class Model(raf.Model):
@@ -108,12 +114,42 @@ def test_tuple(fuse):
         executor = VMExecutor(mod, "cpu")
     ref_out = executor.make_executor()(m_x, rand)
 
-    loaded_exe = serialize_and_load(executor.executable)
+    loaded_exe = serialize_and_load(executor.executable, from_file)
     out = run_exec(loaded_exe, [m_x, rand])
     assert len(out) == len(ref_out)
     for t, ref_t in zip(out, ref_out):
         check(t, ref_t)
 
 
+@pytest.mark.parametrize("fuse", [True, False])
+def test_aot(fuse):
+    shape = (3, 5)
+    x = raf.ir.var("x", shape=shape)
+    y = raf.ir.op.add(x, x)
+    y = raf.ir.op.multiply(y, x)
+    mod = raf.ir.IRModule()
+    mod["main"] = relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+
+    opt_level = 3 if fuse else 1
+    with raf.ir.PassContext(opt_level=opt_level):
+        executor = VMExecutor(mod, "cpu")
+    m_x, _ = randn(shape)
+    ref_y = executor.make_executor()(m_x)
+
+    tmp = tvm.contrib.utils.tempdir()
+    executor.executable.export_aot(tmp.path)
+    lib = tvm.runtime.load_module(tmp.relpath("kernels.so"))
+    with open(tmp.relpath("kernels.json"), "r") as manifest_file:
+        manifest = json.load(manifest_file)
+    assert manifest
+    for entry in manifest:
+        assert lib.get_function(entry["func_name"]) is not None
+
+    loaded_exe = Executable.load_aot(tmp.path)
+    m_y = run_exec(loaded_exe, [m_x])
+    check(m_y, ref_y)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -178,6 +178,53 @@ def test_allreduce_with_subcomm(dtype, rank_list):
             check(y, target_y)
 
 
+@pytest.mark.skipif(skip_dist_test(min_rank_num=4), reason=SKIP_REASON)
+def test_warm_up_communicators():
+    """Testing the sub-communicators created ahead of time by a background thread."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            x = raf.allreduce(x, "sum", [[0, 1], [2, 3]])
+            x = raf.allreduce(x, "sum", [[1, 2, 3]])
+            return x
+
+    model = TestModel()
+    _, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    x = raf.array(np.ones(shape=(4, 4), dtype="float32") * (rank + 1), device=device)
+    dist.warm_up_communicators(model._internal(x).mod)
+    # Moving the weights overlaps with the creation of the communicators.
+    model.to(device=device)
+    y = run_vm_model(model, device, [x])
+    dist.wait_communicators()
+    # After the first allreduce, ranks 0 and 1 have 1 + 2, and ranks 2 and 3 have 3 + 4.
+    target = 3 if rank == 0 else 3 + 7 + 7
+    check(y, np.ones(shape=(4, 4), dtype="float32") * target)
+
+
+def test_get_rank_lists():
+    """Testing collecting the distinct rank lists of a module in a sorted order."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            x = raf.allreduce(x, "sum", [[1, 2, 3]])
+            x = raf.allreduce(x, "sum", [[0, 1], [2, 3]])
+            x = raf.allgather(x, 0, [[1, 2, 3]])
+            return raf.allreduce(x, "sum")
+
+    x = raf.array(np.ones(shape=(4, 4), dtype="float32"))
+    rank_lists = dist.get_rank_lists(TestModel()._internal(x).mod)
+    assert rank_lists == [((0, 1), (2, 3)), ((1, 2, 3),)]
+
+
 @pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
 @pytest.mark.parametrize("axis", [0, 1])
 def test_allgather(axis):
@@ -803,6 +850,172 @@ def test_all_to_all_with_tensor_list(group_use_memcpy, dtype):
     check(y2, target_y2)
 
 
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+def test_all_to_allv():
+    """Testing all_to_allv with variable-size blocks."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, send_counts):
+            return raf.all_to_allv(x, send_counts)
+
+    if raf.build.with_nccl() < 20700:
+        pytest.skip("all_to_allv is not supported in NCCL < 2.7")
+
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    capacity = 3
+
+    def count(src, dst):
+        return (src + dst) % capacity + 1
+
+    # each src rank s sends count(s, d) rows with value (s * total_rank + d) to dst rank d
+    x_np = np.concatenate(
+        [
+            np.ones((capacity, 4), dtype="float32") * (rank * total_rank + d)
+            for d in range(total_rank)
+        ]
+    )
+    counts_np = np.array([count(rank, d) for d in range(total_rank)], dtype="int64")
+    x = raf.array(x_np, device=device)
+    send_counts = raf.array(counts_np, device=device)
+    model.to(device=device)
+    y = run_vm_model(model, device, [x, send_counts])
+
+    target_y = np.zeros_like(x_np)
+    for s in range(total_rank):
+        target_y[s * capacity : s * capacity + count(s, rank)] = s * total_rank + rank
+    target_counts = np.array([count(s, rank) for s in range(total_rank)], dtype="int64")
+    check(y[0], target_y)
+    check(y[1], target_counts)
+
+
+def test_moe_dispatch_combine():
+    """Testing the token dispatch and combine of MoE, which do not need communication."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, expert_indices, gates):
+            blocks, counts, slots = raf.moe_dispatch(x, expert_indices, 3, 2)
+            return blocks, counts, raf.moe_combine(blocks, slots, gates)
+
+    model = TestModel()
+    x_np = np.arange(10, dtype="float32").reshape((5, 2))
+    # Expert 1 gets 3 tokens, so the last one of them (token 3) is dropped with capacity 2.
+    indices_np = np.array([1, 0, 1, 1, 2], dtype="int64")
+    gates_np = np.array([0.5, 1.0, 2.0, 3.0, 4.0], dtype="float32")
+    args = [raf.array(x_np), raf.array(indices_np), raf.array(gates_np)]
+    blocks, counts, out = run_model(model, args, "cpu")
+
+    target_blocks = np.zeros((6, 2), dtype="float32")
+    target_blocks[0] = x_np[1]
+    target_blocks[2] = x_np[0]
+    target_blocks[3] = x_np[2]
+    target_blocks[4] = x_np[4]
+    target_out = x_np * gates_np[:, None]
+    target_out[3] = 0
+    check(blocks, target_blocks)
+    check(counts, np.array([1, 2, 1], dtype="int64"))
+    check(out, target_out)
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+def test_sharded_embedding():
+    """Testing the lookup of a row-sharded embedding table."""
+    if raf.build.with_nccl() < 20700:
+        pytest.skip("all_to_allv is not supported in NCCL < 2.7")
+
+    total_rank, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    rows_per_shard, dim = 3, 4
+    table_np = np.arange(total_rank * rows_per_shard * dim, dtype="float32")
+    table_np = table_np.reshape((total_rank * rows_per_shard, dim))
+    model = raf.model.nn.ShardedEmbedding(total_rank * rows_per_shard, dim, 5)
+    assert model.w.model_parallel
+    model.w = raf.array(table_np[rank * rows_per_shard : (rank + 1) * rows_per_shard])
+    model.w.model_parallel = True
+    # Each rank looks up rows of all shards, including duplicated rows.
+    indices_np = np.array(
+        [(rank + 1) % (total_rank * rows_per_shard), 0, rows_per_shard, 0, rank], dtype="int64"
+    )
+    model.to(device=device)
+    assert model.w.model_parallel
+    y = run_vm_model(model, device, [raf.array(indices_np, device=device)])
+    check(y, table_np[indices_np])
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+@pytest.mark.parametrize("computation", ["sum", "avg"])
+def test_allreduce_hierarchical(computation):
+    """Testing allreduce with the hierarchical schedule, which falls back to the flat allreduce
+    if all ranks are on the same node."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x1, x2):
+            return raf.allreduce([x1, x2], computation=computation)
+
+    if computation == "avg" and raf.build.with_nccl() < 21000:
+        pytest.skip("avg is not supported in NCCL < 2.10")
+
+    dcfg = dist.get_config()
+    dcfg.enable_hierarchical_allreduce = True
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    # Use an odd number of elements to also cover the fallback when the buffer cannot be
+    # evenly scattered.
+    x1 = raf.array(np.ones(shape=(4, 4), dtype="float32") * (rank + 1), device=device)
+    x2 = raf.array(np.ones(shape=(3, 3), dtype="float32") * (-rank - 1), device=device)
+    model.to(device=device)
+    y = run_vm_model(model, device, [x1, x2])
+    scale = sum(range(1, total_rank + 1))
+    if computation == "avg":
+        scale = scale / total_rank
+    check(y[0], np.ones(shape=(4, 4), dtype="float32") * scale)
+    check(y[1], np.ones(shape=(3, 3), dtype="float32") * -scale)
+    dcfg.enable_hierarchical_allreduce = False
+
+
+@pytest.mark.skipif(
+    not raf.build.with_mpi() or get_dist_comm_info()[0] < 2, reason="MPI is not enabled"
+)
+@pytest.mark.parametrize("computation", ["sum", "max", "avg"])
+def test_allreduce_on_cpu(computation):
+    """Testing allreduce on CPU, which is dispatched to the MPI dialect."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.allreduce(x, computation=computation)
+
+    model = TestModel()
+    total_rank, rank, _ = get_dist_comm_info(verbose=True)
+    x = raf.array(np.ones(shape=(4, 4), dtype="float32") * (rank + 1), device="cpu")
+    y = run_model(model, [x], "cpu")
+    ones = np.ones(shape=(4, 4), dtype="float32")
+    if computation == "sum":
+        target_y = ones * sum(range(1, total_rank + 1))
+    elif computation == "max":
+        target_y = ones * total_rank
+    else:
+        target_y = ones * sum(range(1, total_rank + 1)) / total_rank
+    check(y, target_y)
+
+
 if __name__ == "__main__":
     if os.environ.get("RAF_FILE_STORE_PATH", None):
         dist.set_default_communicator("void")
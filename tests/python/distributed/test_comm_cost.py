@@ -0,0 +1,60 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import pytest
+import raf
+from raf._ffi.op_profiler import EstimateLatency
+from raf._lib import relay
+from raf.distributed import comm_cost
+from raf.testing import run_infer_type
+
+
+def test_fit_alpha_beta():
+    nbytes = [1 << 12, 1 << 16, 1 << 20, 1 << 24]
+    latencies = [20.0 + 1e-4 * size for size in nbytes]
+    alpha, beta = comm_cost.fit_alpha_beta(nbytes, latencies)
+    assert alpha == pytest.approx(20.0, rel=1e-6)
+    assert beta == pytest.approx(1e-4, rel=1e-6)
+    # A single size cannot determine the bandwidth.
+    assert comm_cost.fit_alpha_beta([1024], [5.0]) == (5.0, 0.0)
+
+
+def test_scope_rank_lists():
+    rank_lists = comm_cost.get_scope_rank_lists(8, 4)
+    assert rank_lists["global"] is None
+    assert rank_lists["intra"] == [[0, 1, 2, 3], [4, 5, 6, 7]]
+    assert rank_lists["inter"] == [[0, 4], [1, 5], [2, 6], [3, 7]]
+    assert set(comm_cost.get_scope_rank_lists(4, 4)) == {"global", "intra"}
+    assert set(comm_cost.get_scope_rank_lists(4, 1)) == {"global", "inter"}
+
+
+def test_estimate_latency():
+    device = raf.Device("cpu")
+    x = raf.ir.var("x", shape=(256, 16), dtype="float32")
+    allreduce = run_infer_type(raf.ir.op._allreduce(relay.Tuple([x]), "sum")).body
+    y = raf.ir.var("y", shape=(64,), dtype="float16")
+    allgather = run_infer_type(raf.ir.op._allgather(y, 0)).body
+    try:
+        comm_cost.clear_comm_cost()
+        assert comm_cost.estimate_comm_latency("raf.op._allreduce", "global", 1024) == -1
+
+        comm_cost.set_comm_cost("raf.op._allreduce", "global", 10.0, 0.01)
+        comm_cost.set_comm_cost("raf.op._allreduce", "intra", 5.0, 0.001)
+        assert comm_cost.get_comm_cost() == {
+            ("raf.op._allreduce", "global"): (10.0, 0.01),
+            ("raf.op._allreduce", "intra"): (5.0, 0.001),
+        }
+        lat = EstimateLatency(allreduce, device).value
+        assert lat == pytest.approx(10.0 + 0.01 * 256 * 16 * 4, rel=1e-5)
+
+        # The message size of allgather is its output size.
+        comm_cost.set_comm_cost("raf.op._allgather", "global", 1.0, 0.5)
+        lat = EstimateLatency(allgather, device).value
+        size = raf.distributed.get_communicator().size
+        assert lat == pytest.approx(1.0 + 0.5 * 64 * 2 * size, rel=1e-5)
+    finally:
+        comm_cost.clear_comm_cost()
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
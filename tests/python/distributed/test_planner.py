@@ -0,0 +1,97 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init, no-self-use
+import pytest
+import raf
+from raf._ffi.distributed import GroupBucketSize
+from raf.distributed import planner
+from raf.testing import randn
+from raf.utils import cost_model
+
+
+def make_profile(n_layers=24, hidden=4096, seq=1024):
+    # A transformer-like model with 4 GEMMs of 3 * hidden^2 params per layer in float16.
+    param_sizes = [3 * hidden * hidden * 2 for _ in range(4 * n_layers)]
+    gemm_bytes = 4 * n_layers * seq * hidden * 2
+    return planner.ModelProfile(
+        param_sizes,
+        fwd_ms_per_sample=2.0 * n_layers,
+        act_bytes_per_sample=8 * gemm_bytes,
+        gemm_bytes_per_sample=gemm_bytes,
+        n_gemms=4 * n_layers,
+    )
+
+
+def test_data_parallel_when_fit():
+    profile = make_profile(n_layers=2, hidden=1024)
+    cluster = planner.ClusterSpec(1, 8, 32, intra_node_gbps=150, inter_node_gbps=12)
+    plans = planner.plan_parallelism(profile, cluster, global_batch_size=64)
+    assert plans
+    best = plans[0]
+    # A small model fits on each GPU, so it is replicated without partitioning.
+    assert (best.dp, best.tp, best.pp, best.zero_opt_level) == (8, 1, 1, 0)
+    assert best.bucket_size > 0
+    assert best.pass_pipeline == ["with_autodiff", "with_data_parallel"]
+    assert all(plan.peak_memory_mb <= 32 * 1e9 * 0.9 / 1048576 for plan in plans)
+    assert all(plans[i].step_ms <= plans[i + 1].step_ms for i in range(len(plans) - 1))
+
+
+def test_partition_when_not_fit():
+    profile = make_profile()
+    cluster = planner.ClusterSpec(2, 8, 16, intra_node_gbps=150, inter_node_gbps=12)
+    plain = planner.estimate_plan(profile, cluster, 64, 16, 1, 1, 0, 1)
+    assert plain.memory > 16 * 1e9
+    best = planner.plan_parallelism(profile, cluster, global_batch_size=64)[0]
+    # The model states do not fit without partitioning them.
+    assert best.zero_opt_level > 0 or best.tp > 1 or best.pp > 1
+    assert best.memory <= 16 * 1e9 * 0.9
+
+    hybrid = planner.plan_parallelism(profile, cluster, global_batch_size=64, allow_hybrid=True)
+    assert hybrid[0].step_ms <= best.step_ms
+    assert hybrid[0].dp * hybrid[0].tp * hybrid[0].pp == cluster.world_size
+    # TP stays within a node.
+    assert all(plan.tp <= cluster.gpus_per_node for plan in hybrid)
+
+
+def test_apply():
+    profile = make_profile(n_layers=2, hidden=1024)
+    cluster = planner.ClusterSpec(1, 4, 32, intra_node_gbps=150, inter_node_gbps=12)
+    best = planner.plan_parallelism(profile, cluster, global_batch_size=32)[0]
+    dcfg = raf.distributed.get_config()
+    prev = dcfg.dumps()
+    prev_bucket_size = dcfg.group_bucket_size
+    try:
+        best.apply()
+        assert dcfg.enable_data_parallel == (best.dp > 1)
+        assert dcfg.zero_opt_level == best.zero_opt_level
+        assert dcfg.group_bucket_size == best.bucket_size
+    finally:
+        dcfg.loads(prev)
+        GroupBucketSize(prev_bucket_size)
+
+
+def test_profile_model():
+    class MLP(raf.Model):
+        def build(self):
+            self.fc1 = raf.model.Linear(16, 32)
+            self.fc2 = raf.model.Linear(32, 8)
+
+        @raf.model.trace
+        def forward(self, x):
+            return self.fc2(raf.relu(self.fc1(x)))
+
+    model = MLP()
+    model.train_mode()
+    cost_model.set_device_spec("cpu", 100.0, 10.0, 5.0)
+    m_x, _ = randn((4, 16))
+    profile = planner.profile_model(model, "cpu", [m_x])
+    assert profile.param_bytes == (16 * 32 + 32 + 32 * 8 + 8) * 4
+    assert profile.n_gemms == 2
+    assert profile.gemm_bytes_per_sample == (32 + 8) * 4
+    assert profile.fwd_ms_per_sample > 0
+    assert profile.act_bytes_per_sample >= profile.gemm_bytes_per_sample
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
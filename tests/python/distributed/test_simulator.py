@@ -0,0 +1,123 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+# pylint: disable=protected-access
+import pytest
+import raf
+import tvm
+from tvm import relay
+
+from raf._core.vm import VMCompiler
+from raf.distributed import simulator
+from raf.distributed.simulator import SimulatedOp, SimulationResult
+from raf.ir import ScopeBuilder
+
+SHAPE = (512, 512)
+SIG = "T<512x512xf32>,|T<512x512xf32>"
+
+
+def compile_mod(mod, device, stream_policy=None):
+    config = {}
+    if stream_policy is not None:
+        config["raf.stream_schedule.policy"] = stream_policy
+    disabled_pass = ["FuseDialect", "FuseTVM"]
+    with tvm.transform.PassContext(opt_level=3, config=config, disabled_pass=disabled_pass):
+        mod, _ = VMCompiler().optimize(mod, device)
+    return mod
+
+
+def test_load_profile():
+    def event(name, phase, ts, args="T<4xf32>,|T<4xf32>", cat="Stream 1"):
+        return {"name": name, "cat": cat, "ph": phase, "ts": ts, "args": {"args_string": args}}
+
+    trace = {
+        "traceEvents": [
+            event("raf_op_tvm_relu", "B", 0),
+            event("raf_op_tvm_relu", "E", 10),
+            event("raf_op_tvm_relu", "B", 20),
+            event("raf_op_tvm_relu", "E", 40),
+            event("raf_op_tvm_add", "B", 50),
+            event("raf_op_tvm_add", "E", 55),
+            # The events without signatures are not ops.
+            event("InvokePacked", "B", 0, args="", cat="VMInstruction"),
+            event("InvokePacked", "E", 60, args="", cat="VMInstruction"),
+        ]
+    }
+    profile = simulator.load_profile(trace)
+    assert profile == {
+        "raf_op_tvm_relu@T<4xf32>,|T<4xf32>": 15.0,
+        "raf_op_tvm_add@T<4xf32>,|T<4xf32>": 5.0,
+    }
+
+
+def test_result():
+    ops = [
+        SimulatedOp("matmul", 1, 0.0, 100.0, "comp", "profile"),
+        SimulatedOp("_allreduce", 4, 50.0, 100.0, "comm", "comm_model"),
+        SimulatedOp("matmul", 1, 100.0, 20.0, "comp", "profile"),
+    ]
+    result = SimulationResult(ops, 4.0)
+    assert result.step_ms == pytest.approx(0.15)
+    assert result.comm_ms == pytest.approx(0.1)
+    # The allreduce overlaps with both matmuls for 70 us.
+    assert result.exposed_comm_ms == pytest.approx(0.03)
+    assert result.stream_busy_ms == pytest.approx({1: 0.12, 4: 0.1})
+    assert result.profiled_ratio == pytest.approx(2 / 3)
+    events = result.to_chrome_trace()["traceEvents"]
+    assert [(e["tid"], e["ts"], e["dur"]) for e in events] == [
+        ("Stream 1", 0.0, 100.0),
+        ("Stream 4", 50.0, 100.0),
+        ("Stream 1", 100.0, 20.0),
+    ]
+
+
+def test_sequential():
+    data = raf.ir.var("x", shape=SHAPE)
+    sb = ScopeBuilder()
+    a_1 = sb.let("a1", raf.ir.op.relu(data))
+    a_2 = sb.let("a2", raf.ir.op.relu(a_1))
+    a_3 = sb.let("a3", raf.ir.op.relu(a_2))
+    sb.ret(a_3)
+    mod = tvm.IRModule.from_expr(relay.Function([data], sb.get()))
+    mod = compile_mod(mod, "cpu")
+
+    # The unique suffix of the OpEnv name is ignored.
+    profile = {f"raf_op_tvm_relu_2@{SIG}": 10.0}
+    result = simulator.simulate(mod, "cpu", profile, optimize=False)
+    assert [(op.name, op.start_us, op.dur_us, op.source) for op in result.ops] == [
+        ("relu", 0.0, 10.0, "profile"),
+        ("relu", 10.0, 10.0, "profile"),
+        ("relu", 20.0, 10.0, "profile"),
+    ]
+    assert result.step_ms == pytest.approx(0.03)
+    assert result.exposed_comm_ms == 0
+    assert result.peak_memory_mb == pytest.approx(3)
+
+    # The ops that are not profiled are estimated by the analytical cost model.
+    result = simulator.simulate(mod, "cpu", include_memory=False, optimize=False)
+    assert all(op.source == "analytical" and op.dur_us > 0 for op in result.ops)
+    assert result.peak_memory_mb is None
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_multi_stream():
+    data = raf.ir.var("x", shape=SHAPE)
+    sb = ScopeBuilder()
+    a_1 = sb.let("a1", raf.ir.op.relu(data))
+    a_2 = sb.let("a2", raf.ir.op.tanh(data))
+    a_3 = sb.let("a3", raf.ir.op.add(a_1, a_2))
+    sb.ret(a_3)
+    mod = tvm.IRModule.from_expr(relay.Function([data], sb.get()))
+    mod = compile_mod(mod, "cuda", stream_policy="wavefront")
+
+    profile = {f"raf_op_tvm_relu@{SIG}": 10.0, f"raf_op_tvm_tanh@{SIG}": 30.0}
+    result = simulator.simulate(mod, "cuda", profile, optimize=False)
+    ops = {op.name: op for op in result.ops}
+    # The two branches run concurrently, and the add waits for both.
+    assert ops["relu"].stream_id != ops["tanh"].stream_id
+    assert ops["relu"].start_us == ops["tanh"].start_us == 0
+    assert ops["add"].start_us == pytest.approx(30.0)
+    assert result.step_ms == pytest.approx((30.0 + ops["add"].dur_us) / 1e3)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -4,6 +4,9 @@
 # pylint:disable=missing-module-docstring,missing-function-docstring,missing-class-docstring
 # pylint:disable=not-callable,abstract-method,too-many-locals,invalid-name,protected-access
 # pylint: disable=too-many-statements
+import os
+import subprocess
+import sys
 import tempfile
 import pytest
 import torch
@@ -380,6 +383,58 @@ def test_save_and_load_model(shape_dict):
         from_pytorch(t_model, shape_dict, model_path, hash_path)
 
 
+@pytest.mark.parametrize("shape_dict", [{"input0": ((8, 3, 28, 28), "float32")}])
+def test_fast_import(shape_dict):
+    input_shape = list(shape_dict.values())[0][0]
+
+    t_model = TorchLeNet(input_shape[2])
+    t_model.eval()
+    m_x, t_x = randn_torch(input_shape, device="cpu")
+    t_y = t_model(t_x)
+    with tempfile.TemporaryDirectory(prefix="raf_test_") as temp_dir:
+        # The first import converts and caches the module, and the second one loads it.
+        for _ in range(2):
+            m_model = from_pytorch(
+                t_model, shape_dict, zero_copy=True, num_threads=2, cache_dir=temp_dir
+            )
+            m_model.infer_mode()
+            check(m_model(m_x), t_y, rtol=1e-4, atol=1e-4)
+        assert len(os.listdir(temp_dir)) == 1
+
+    # The params share the tensors of the PyTorch model.
+    with torch.no_grad():
+        t_model.linear3.bias.add_(1.0)
+    check(m_model(m_x), t_model(t_x), rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize("zero_copy", [False, True])
+def test_tied_params(zero_copy):
+    class TorchModel(nn.Module):
+        def __init__(self):
+            super(TorchModel, self).__init__()
+            self.embed = nn.Embedding(16, 8)
+            self.proj = nn.Linear(8, 16, bias=False)
+            self.proj.weight = self.embed.weight
+
+        def forward(self, x):
+            return self.proj(self.embed(x))
+
+    shape_dict = {"input0": ((4, 6), "int64")}
+    t_model = TorchModel()
+    m_model = from_pytorch(t_model, shape_dict, zero_copy=zero_copy)
+    # The tied weight is one param of the main function, so AutoDiff sums up the gradients of
+    # both uses, and the optimizers keep one state for it.
+    m_params = m_model.state()
+    assert len(m_params) == 1, list(m_params.keys())
+
+    t_x = torch.randint(16, (4, 6))
+    m_x = raf.array(t_x.numpy())
+    m_model.infer_mode()
+    t_model.eval()
+    assert len(m_model._internal(m_x).mod["main"].params) == 2
+    check(m_model(m_x), t_model(t_x), rtol=1e-4, atol=1e-4)
+
+
 def test_learnable_params():
     class TorchModel(nn.Module):
         def __init__(self, shape):
@@ -411,5 +466,11 @@ def test_learnable_params():
     assert not m_params["model_buffer"].requires_grad
 
 
+def test_import_raf_without_torch():
+    # PyTorch is imported by the frontend on use, so a fresh process importing RAF must not load it.
+    script = "import sys, raf; assert 'torch' not in sys.modules, 'import raf loaded torch'"
+    subprocess.run([sys.executable, "-c", script], check=True)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
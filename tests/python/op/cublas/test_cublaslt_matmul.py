@@ -0,0 +1,73 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,too-many-arguments,protected-access,no-self-use
+# pylint: disable=attribute-defined-outside-init
+import pytest
+import torch
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, DialectChecker
+
+
+def verify_ir(mod):
+    with raf.device("cuda"):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.FuseDialect()(mod)
+        # The CUTLASS fusion has a higher priority when it is enabled.
+        if not raf.build.with_cutlass():
+            DialectChecker("cublaslt").visit(mod["main"])
+
+
+@pytest.mark.skipif(not raf.build.with_cublas(), reason="cuBLAS is not enabled")
+@pytest.mark.parametrize("m", [1, 15])
+@pytest.mark.parametrize("n", [16, 24])
+@pytest.mark.parametrize("k", [16, 32])
+@pytest.mark.parametrize("transpose_b", [False, True])
+@pytest.mark.parametrize("bias_shape", [None, "vector", "tensor"])
+@pytest.mark.parametrize(
+    "epilogue",
+    [
+        [None, None],
+        [raf._op.sym.relu, torch.nn.functional.relu],
+        [raf._op.sym.gelu, torch.nn.GELU(approximate="tanh")],
+    ],
+)
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_matmul_bias_epilogue(m, n, k, transpose_b, bias_shape, epilogue, dtype):
+    m_epilogue, t_epilogue = epilogue
+    if bias_shape is None and m_epilogue is None:
+        pytest.skip("A single matmul is not fused")
+
+    class TestModel(raf.Model):
+        def build(self):
+            self.epilogue = m_epilogue
+
+        @raf.model.trace
+        def forward(self, x, w, bias):
+            x = raf.matmul_nt(x, w) if transpose_b else raf.matmul(x, w)
+            x = raf.add(x, bias) if bias_shape else x
+            x = self.epilogue(x) if self.epilogue else x
+            return x
+
+    device = "cuda"
+    m_x, t_x = randn_torch([m, k], dtype=dtype, device=device)
+    m_w, t_w = randn_torch([n, k] if transpose_b else [k, n], dtype=dtype, device=device)
+    bias_shape_value = [m, n] if bias_shape == "tensor" else [n]
+    m_bias, t_bias = randn_torch(bias_shape_value, dtype=dtype, device=device)
+    model = TestModel()
+    model.to(device=device)
+    mod = model._internal(m_x, m_w, m_bias).mod
+    verify_ir(mod)
+    m_y = run_vm_model(model, device, [m_x, m_w, m_bias])
+    t_y = torch.matmul(t_x, t_w.T if transpose_b else t_w)
+    t_y = t_y + t_bias if bias_shape else t_y
+    t_y = t_epilogue(t_y) if t_epilogue else t_y
+    # The results differ a bit from PyTorch since TF32 is allowed by default.
+    tol = 1e-2 if dtype == "float16" else 1e-3
+    check(m_y, t_y, rtol=tol, atol=tol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,59 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=no-self-use
+import numpy as np
+import pytest
+import raf
+from raf.testing import check, randn, run_vm_model, with_dialect
+from raf.utils.sparse import CSRMatrix
+
+
+@with_dialect("cusparse")
+@pytest.mark.skipif(not raf.build.with_cublas(), reason="cuBLAS is not enabled")
+@pytest.mark.parametrize("index_dtype", ["int32", "int64"])
+@pytest.mark.parametrize("transpose_a", [False, True])
+def test_csr_spmm(index_dtype, transpose_a):
+    class Spmm(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, indptr, indices, values, dense):
+            if transpose_a:
+                return raf.csr_spmm_tn(indptr, indices, values, dense, (64, 16))
+            return raf.csr_spmm(indptr, indices, values, dense)
+
+    dense = np.random.randn(128, 64).astype("float32")
+    dense *= np.random.rand(128, 64) < 0.05
+    csr = CSRMatrix.from_dense(dense, index_dtype)
+    m_x, n_x = randn((128 if transpose_a else 64, 16), device="cuda")
+    args = list(csr.tensors("cuda")) + [m_x]
+    n_y = (dense.T if transpose_a else dense) @ n_x
+    check(run_vm_model(Spmm(), "cuda", args), n_y, rtol=1e-4, atol=1e-4)
+
+
+@with_dialect("cusparse")
+@pytest.mark.skipif(not raf.build.with_cublas(), reason="cuBLAS is not enabled")
+def test_csr_sddmm():
+    class Sddmm(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, indptr, indices, x1, x2):
+            return raf.csr_sddmm(indptr, indices, x1, x2)
+
+    dense = np.random.rand(128, 64) < 0.05
+    csr = CSRMatrix.from_dense(dense.astype("float32"))
+    m_indptr, m_indices, _ = csr.tensors("cuda")
+    m_x1, n_x1 = randn((128, 32), device="cuda")
+    m_x2, n_x2 = randn((64, 32), device="cuda")
+    rows = np.repeat(np.arange(128), np.diff(csr.indptr))
+    n_y = (n_x1 @ n_x2.T)[rows, csr.indices]
+    m_y = run_vm_model(Sddmm(), "cuda", [m_indptr, m_indices, m_x1, m_x2])
+    check(m_y, n_y, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
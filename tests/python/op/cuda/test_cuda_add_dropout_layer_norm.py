@@ -0,0 +1,118 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, too-many-arguments, too-many-locals
+import numpy as np
+import pytest
+import torch
+import raf
+from raf.testing import check, randn_torch, run_vm_model, with_dialect
+from raf.optim.optim import with_autodiff
+
+
+class AddDropoutLayerNorm(raf.Model):
+    def build(self, p, affine):
+        self.p = p
+        self.affine = affine
+
+    @raf.model.trace
+    def forward(self, x, residual, scale, bias):
+        if self.affine:
+            return raf.add_dropout_layer_norm(x, residual, scale, bias, p=self.p)
+        return raf.add_dropout_layer_norm(x, residual, p=self.p)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(4, 7, 64), (13, 1000), (2, 9000), (3, 37)])
+@pytest.mark.parametrize("affine", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_add_layer_norm(shape, affine, dtype):
+    device = "cuda"
+    m_x, t_x = randn_torch(shape, device=device, dtype=dtype, requires_grad=True)
+    m_r, t_r = randn_torch(shape, device=device, dtype=dtype, requires_grad=True)
+    m_w, t_w = randn_torch(shape[-1:], device=device, dtype=dtype, requires_grad=True)
+    m_b, t_b = randn_torch(shape[-1:], device=device, dtype=dtype, requires_grad=True)
+    m_dy, t_dy = randn_torch(shape, device=device, dtype=dtype)
+
+    m_model = with_autodiff(AddDropoutLayerNorm(0.0, affine))
+    m_out, m_grads = run_vm_model(m_model, device, [m_dy, m_x, m_r, m_w, m_b])
+    t_z = t_x + t_r
+    if affine:
+        t_y = torch.nn.functional.layer_norm(t_z.float(), shape[-1:], t_w.float(), t_b.float())
+    else:
+        t_y = torch.nn.functional.layer_norm(t_z.float(), shape[-1:])
+    t_y.backward(t_dy.float())
+
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_out[0], t_y, rtol=tol, atol=tol)
+    check(m_out[1], t_z, rtol=tol, atol=tol)
+    check(m_grads[0], t_x.grad, rtol=tol, atol=tol)
+    check(m_grads[1], t_r.grad, rtol=tol, atol=tol)
+    if affine:
+        # The gradients of scale and bias are summed over all rows.
+        check(m_grads[2], t_w.grad, rtol=tol, atol=tol * 10)
+        check(m_grads[3], t_b.grad, rtol=tol, atol=tol * 10)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(64, 256), (37, 333)])
+def test_add_dropout_layer_norm(shape):
+    device, p = "cuda", 0.3
+    m_x, t_x = randn_torch(shape, device=device, requires_grad=True)
+    m_r, t_r = randn_torch(shape, device=device, requires_grad=True)
+    m_w, t_w = randn_torch(shape[-1:], device=device, requires_grad=True)
+    m_b, t_b = randn_torch(shape[-1:], device=device, requires_grad=True)
+    m_dy, t_dy = randn_torch(shape, device=device)
+
+    m_model = with_autodiff(AddDropoutLayerNorm(p, True))
+    m_out, m_grads = run_vm_model(m_model, device, [m_dy, m_x, m_r, m_w, m_b])
+
+    # The residual sum reveals the dropout mask.
+    t_dropped = torch.tensor(m_out[1].numpy(), device=device) - t_r.detach()
+    t_keep = (t_dropped != 0).float()
+    drop_ratio = 1 - t_keep.mean().item()
+    assert abs(drop_ratio - p) < 0.05, drop_ratio
+
+    t_z = t_x * t_keep / (1 - p) + t_r
+    t_y = torch.nn.functional.layer_norm(t_z, shape[-1:], t_w, t_b)
+    t_y.backward(t_dy)
+    check(m_out[0], t_y, rtol=1e-4, atol=1e-4)
+    check(m_out[1], t_z, rtol=1e-4, atol=1e-4)
+    check(m_grads[0], t_x.grad, rtol=1e-4, atol=1e-4)
+    check(m_grads[1], t_r.grad, rtol=1e-4, atol=1e-4)
+    check(m_grads[2], t_w.grad, rtol=1e-4, atol=1e-3)
+    check(m_grads[3], t_b.grad, rtol=1e-4, atol=1e-3)
+
+    # Each execution draws a new mask.
+    m_out_2 = run_vm_model(m_model, device, [m_dy, m_x, m_r, m_w, m_b])[0]
+    assert not np.array_equal(m_out[1].numpy(), m_out_2[1].numpy())
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(6, 128), (3, 10000)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_fused_add_layer_norm(shape, dtype):
+    class AddLayerNorm(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, residual, scale, bias):
+            return raf.layer_norm(raf.add(residual, x), scale, bias)
+
+    device = "cuda"
+    m_x, t_x = randn_torch(shape, device=device, dtype=dtype)
+    m_r, t_r = randn_torch(shape, device=device, dtype=dtype)
+    m_w, t_w = randn_torch(shape[-1:], device=device, dtype=dtype)
+    m_b, t_b = randn_torch(shape[-1:], device=device, dtype=dtype)
+    m_y = run_vm_model(AddLayerNorm(), device, [m_x, m_r, m_w, m_b])
+    t_y = torch.nn.functional.layer_norm((t_x + t_r).float(), shape[-1:], t_w.float(), t_b.float())
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_y, t_y, rtol=tol, atol=tol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
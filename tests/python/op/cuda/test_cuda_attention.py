@@ -0,0 +1,113 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, too-many-arguments, too-many-locals
+import math
+
+import numpy as np
+import pytest
+import torch
+import raf
+from raf.testing import check, randn_torch, run_vm_model, with_dialect
+from raf.optim.optim import with_autodiff
+
+
+class Attention(raf.Model):
+    def build(self, scale, causal, p):
+        self.scale = scale
+        self.causal = causal
+        self.p = p
+
+    @raf.model.trace
+    def forward(self, q, k, v):
+        return raf.attention(q, k, v, scale=self.scale, causal=self.causal, p=self.p)
+
+
+def torch_attention(q, k, v, scale, causal, keep=None, p=0.0):
+    scores = torch.matmul(q, k.transpose(-1, -2)) * scale
+    if causal:
+        seq_q, seq_k = scores.shape[-2:]
+        mask = torch.ones(seq_q, seq_k, dtype=torch.bool, device=q.device)
+        mask = torch.tril(mask, diagonal=seq_k - seq_q)
+        scores = scores.masked_fill(~mask, float("-inf"))
+    # The rows without any attended key output zeros.
+    probs = torch.nan_to_num(torch.softmax(scores.float(), dim=-1)).to(q.dtype)
+    if keep is not None:
+        probs = probs * keep / (1 - p)
+    return torch.matmul(probs, v)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "shape",
+    [
+        [(2, 3, 37, 64), (2, 3, 37, 64)],
+        [(4, 128, 32), (4, 70, 32)],
+        [(2, 17, 128), (2, 130, 128)],
+    ],
+)
+@pytest.mark.parametrize("causal", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_attention(shape, causal, dtype):
+    q_shape, kv_shape = shape
+    device = "cuda"
+    scale = 1.0 / math.sqrt(q_shape[-1])
+    m_q, t_q = randn_torch(q_shape, device=device, dtype=dtype, requires_grad=True)
+    m_k, t_k = randn_torch(kv_shape, device=device, dtype=dtype, requires_grad=True)
+    m_v, t_v = randn_torch(kv_shape, device=device, dtype=dtype, requires_grad=True)
+    m_dy, t_dy = randn_torch(q_shape, device=device, dtype=dtype)
+
+    m_model = with_autodiff(Attention(scale, causal, 0.0))
+    m_y = run_vm_model(m_model, device, [m_dy, m_q, m_k, m_v])
+    m_out, (m_dq, m_dk, m_dv) = m_y[0][0], m_y[1]
+    t_out = torch_attention(t_q, t_k, t_v, scale, causal)
+    t_out.backward(t_dy)
+
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_out, t_out, rtol=tol, atol=tol)
+    check(m_dq, t_q.grad, rtol=tol, atol=tol)
+    check(m_dk, t_k.grad, rtol=tol, atol=tol)
+    check(m_dv, t_v.grad, rtol=tol, atol=tol)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("causal", [False, True])
+def test_attention_dropout(causal):
+    batch, seq, head_dim, p = 4, 100, 64, 0.3
+    device = "cuda"
+    scale = 0.125
+    m_q, t_q = randn_torch((batch, seq, head_dim), device=device, requires_grad=True)
+    m_k, t_k = randn_torch((batch, head_dim, head_dim), device=device, requires_grad=True)
+    # With the identity values, the output is exactly the probabilities after dropout, which
+    # reveals the dropout mask.
+    n_v = np.tile(np.eye(head_dim, dtype="float32"), (batch, 1, 1))
+    m_v = raf.array(n_v, device=device)
+    m_v.requires_grad = True
+    t_v = torch.tensor(n_v, device=device, requires_grad=True)
+    m_dy, t_dy = randn_torch((batch, seq, head_dim), device=device)
+
+    m_model = with_autodiff(Attention(scale, causal, p))
+    m_y = run_vm_model(m_model, device, [m_dy, m_q, m_k, m_v])
+    m_out, (m_dq, m_dk, m_dv) = m_y[0][0], m_y[1]
+
+    t_keep = torch.tensor(m_out.numpy() != 0, device=device, dtype=torch.float32)
+    t_attended = torch_attention(t_q, t_k, t_v, scale, causal).detach() != 0
+    drop_ratio = 1 - t_keep.sum().item() / t_attended.sum().item()
+    assert abs(drop_ratio - p) < 0.05, drop_ratio
+
+    t_out = torch_attention(t_q, t_k, t_v, scale, causal, t_keep, p)
+    t_out.backward(t_dy)
+    check(m_out, t_out, rtol=1e-4, atol=1e-4)
+    check(m_dq, t_q.grad, rtol=1e-4, atol=1e-4)
+    check(m_dk, t_k.grad, rtol=1e-4, atol=1e-4)
+    check(m_dv, t_v.grad, rtol=1e-4, atol=1e-4)
+
+    # Each execution draws a new mask.
+    m_out_2 = run_vm_model(m_model, device, [m_dy, m_q, m_k, m_v])[0][0]
+    assert not np.array_equal(m_out.numpy(), m_out_2.numpy())
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
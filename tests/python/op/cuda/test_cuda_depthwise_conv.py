@@ -0,0 +1,75 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, too-many-arguments, too-many-locals
+import pytest
+import torch.nn.functional as F
+import raf
+from raf.testing import randn_torch, run_vm_model, check, with_dialect
+
+
+class Conv2D(raf.Model):
+    def build(self, **kwargs):
+        self.attrs = kwargs  # pylint: disable=attribute-defined-outside-init
+
+    @raf.model.trace
+    def forward(self, x, w):
+        return raf.conv2d(x, w, **self.attrs)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("xshape", [(2, 8, 17, 33), (1, 32, 7, 7)])
+@pytest.mark.parametrize("multiplier", [1, 2])
+@pytest.mark.parametrize("kernel", [3, 5])
+@pytest.mark.parametrize("stride", [1, 2])
+@pytest.mark.parametrize("dilation", [1, 2])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_depthwise_conv2d(xshape, multiplier, kernel, stride, dilation, dtype):
+    channels = xshape[1]
+    wshape = (channels * multiplier, 1, kernel, kernel)
+    padding = kernel // 2
+    model = Conv2D(stride=stride, padding=padding, dilation=dilation, groups=channels)
+    m_x, t_x = randn_torch(xshape, device="cuda", dtype=dtype, requires_grad=True)
+    m_w, t_w = randn_torch(wshape, device="cuda", dtype=dtype, requires_grad=True)
+    m_y = model(m_x, m_w)
+    v_y = run_vm_model(model, "cuda", [m_x, m_w])
+    t_y = F.conv2d(t_x, t_w, stride=stride, padding=padding, dilation=dilation, groups=channels)
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_y, t_y, rtol=tol, atol=tol)
+    check(v_y, t_y, rtol=tol, atol=tol)
+    m_dy, t_dy = randn_torch(t_y.shape, device="cuda", dtype=dtype)
+    m_y.backward(m_dy)
+    t_y.backward(t_dy)
+    # The filter gradient sums over the batch and the output pixels.
+    check(m_x.grad, t_x.grad, rtol=tol, atol=tol)
+    check(m_w.grad, t_w.grad, rtol=tol * 10, atol=tol * 10)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("channels", [8, 12, 64])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_depthwise_conv2d_nhwc(channels, dtype):
+    # The channels that are not a multiple of the vector width are computed one by one.
+    model = Conv2D(
+        stride=1,
+        padding=1,
+        dilation=1,
+        groups=channels,
+        layout="NHWC",
+        kernel_layout="OHWI",
+        out_layout="NHWC",
+    )
+    m_x, t_x = randn_torch((2, 9, 10, channels), device="cuda", dtype=dtype)
+    m_w, t_w = randn_torch((channels, 3, 3, 1), device="cuda", dtype=dtype)
+    v_y = run_vm_model(model, "cuda", [m_x, m_w])
+    t_y = F.conv2d(
+        t_x.permute(0, 3, 1, 2), t_w.permute(0, 3, 1, 2), stride=1, padding=1, groups=channels
+    ).permute(0, 2, 3, 1)
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(v_y, t_y, rtol=tol, atol=tol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,72 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use
+import numpy as np
+import pytest
+import raf
+from raf.testing import randn, run_vm_model, with_dialect
+
+
+class Dropout(raf.Model):
+    def build(self, p):
+        self.p = p
+
+    @raf.model.trace
+    def forward(self, x):
+        return raf._op.sym._contrib_dropout(x, self.p)
+
+
+class DropoutReplay(raf.Model):
+    def build(self, p):
+        self.p = p
+
+    @raf.model.trace
+    def forward(self, x, state):
+        return raf._op.sym._contrib_dropout(x, self.p, state)
+
+
+class DropoutDx(raf.Model):
+    def build(self, p):
+        self.p = p
+
+    @raf.model.trace
+    def forward(self, dy, mask, state):
+        return raf._op.sym._contrib_dropout_dx(dy, mask, state, self.p)
+
+
+def check_dropout(x, y, p):
+    x, y = x.numpy().astype("float32"), y.numpy().astype("float32")
+    keep = y != 0
+    np.testing.assert_allclose(y[keep], x[keep] / (1 - p), rtol=1e-2, atol=1e-2)
+    assert abs((1 - keep.mean()) - p) < 0.02
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(128, 1024), (3, 333)])
+@pytest.mark.parametrize("p", [0.1, 0.5])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_dropout(shape, p, dtype):
+    m_x, _ = randn(shape, device="cuda", dtype=dtype, positive=True)
+    m_y, m_mask, m_state = run_vm_model(Dropout(p), "cuda", [m_x])
+    check_dropout(m_x, m_y, p)
+    # The state is the 16-byte Philox state rather than a mask.
+    assert m_state.numpy().nbytes == 16
+
+    # Each execution draws a new mask.
+    m_other, _, _ = run_vm_model(Dropout(p), "cuda", [m_x])
+    assert not np.array_equal(m_y.numpy(), m_other.numpy())
+
+    # The backward regenerates the same mask from the state.
+    m_dy, _ = randn(shape, device="cuda", dtype=dtype, positive=True)
+    m_dx = run_vm_model(DropoutDx(p), "cuda", [m_dy, m_mask, m_state])
+    np.testing.assert_array_equal(m_dx.numpy() != 0, m_y.numpy() != 0)
+
+    # Replaying the state reproduces the output, which is how the dropout is rematerialized.
+    m_replay, _, _ = run_vm_model(DropoutReplay(p), "cuda", [m_x, m_state])
+    np.testing.assert_array_equal(m_replay.numpy(), m_y.numpy())
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
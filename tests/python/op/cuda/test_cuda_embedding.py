@@ -0,0 +1,160 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, too-many-arguments, too-many-locals
+import numpy as np
+import pytest
+import torch
+import raf
+from raf.testing import check, randn_torch, run_vm_model, with_dialect
+from raf.optim.optim import with_autodiff
+from raf.utils import embedding_cache
+
+
+class EmbeddingDx(raf.Model):
+    def build(self, num_weight, sparse):
+        self.num_weight = num_weight
+        self.sparse = sparse
+
+    @raf.model.trace
+    def forward(self, dy, indices):
+        if self.sparse:
+            return raf._op.sym.embedding_dx_sparse(dy, indices, self.num_weight)
+        return raf._op.sym.embedding_dx(dy, indices, self.num_weight)
+
+
+class EmbeddingPosition(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x, indices, position, position_ids):
+        return raf._op.sym.embedding_position(x, indices, position, position_ids)
+
+
+class EmbeddingCacheLookup(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, indices, table, tags, rows):
+        return raf._op.sym.embedding_cache(table, indices, tags, rows)
+
+
+class EmbeddingCacheSgd(raf.Model):
+    def build(self, learning_rate):
+        self.learning_rate = learning_rate
+
+    @raf.model.trace
+    def forward(self, dy, indices, table, tags, rows):
+        return raf._op.sym.embedding_cache_sgd(table, dy, indices, tags, rows, self.learning_rate)
+
+
+def gen_indices(shape, num_weight, skewed):
+    if skewed:
+        # Most indices hit a few hot rows, like the padding and the frequent tokens.
+        indices = np.random.zipf(1.5, size=shape) % num_weight
+    else:
+        indices = np.random.randint(0, num_weight, size=shape)
+    indices = indices.astype("int64")
+    return raf.array(indices, device="cuda"), torch.tensor(indices, device="cuda")
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [((4, 50), 100, 64), ((3000,), 7, 33), ((2, 5), 1000, 8)])
+@pytest.mark.parametrize("skewed", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_embedding_dx(shape, skewed, dtype):
+    ind_shape, num_weight, hidden = shape
+    m_ind, t_ind = gen_indices(ind_shape, num_weight, skewed)
+    m_dy, t_dy = randn_torch(ind_shape + (hidden,), device="cuda", dtype=dtype)
+    model = EmbeddingDx((num_weight, hidden), False)
+    m_dx = run_vm_model(model, "cuda", [m_dy, m_ind])
+    t_dx = torch.zeros((num_weight, hidden), device="cuda", dtype=torch.float32)
+    t_dx.index_add_(0, t_ind.flatten(), t_dy.float().reshape(-1, hidden))
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    check(m_dx, t_dx, rtol=tol, atol=tol)
+
+    # The gradient is deterministic.
+    for _ in range(3):
+        other = run_vm_model(model, "cuda", [m_dy, m_ind])
+        np.testing.assert_array_equal(other.numpy(), m_dx.numpy())
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [((4, 50), 100, 64), ((3000,), 7, 33)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_embedding_dx_sparse(shape, dtype):
+    ind_shape, num_weight, hidden = shape
+    m_ind, t_ind = gen_indices(ind_shape, num_weight, True)
+    m_dy, t_dy = randn_torch(ind_shape + (hidden,), device="cuda", dtype=dtype)
+    model = EmbeddingDx((num_weight, hidden), True)
+    m_rows, m_values = run_vm_model(model, "cuda", [m_dy, m_ind])
+    t_dx = torch.zeros((num_weight, hidden), device="cuda", dtype=torch.float32)
+    t_dx.index_add_(0, t_ind.flatten(), t_dy.float().reshape(-1, hidden))
+
+    rows = m_rows.numpy()
+    values = m_values.numpy()
+    distinct = np.unique(t_ind.cpu().numpy())
+    n_distinct = len(distinct)
+    np.testing.assert_array_equal(rows[:n_distinct], distinct)
+    np.testing.assert_array_equal(rows[n_distinct:], -1)
+    np.testing.assert_array_equal(values[n_distinct:], 0)
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    check(values[:n_distinct], t_dx[distinct].cpu().numpy(), rtol=tol, atol=tol)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [((2, 128), 1000, 512, 768), ((3, 7), 30, 7, 33)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_embedding_position(shape, dtype):
+    ind_shape, num_weight, max_position, hidden = shape
+    m_ind, t_ind = gen_indices(ind_shape, num_weight, False)
+    position_ids = np.broadcast_to(np.arange(ind_shape[-1]) % max_position, ind_shape)
+    position_ids = np.ascontiguousarray(position_ids).astype("int64")
+    m_pos_ids, t_pos_ids = raf.array(position_ids, device="cuda"), torch.tensor(
+        position_ids, device="cuda"
+    )
+    m_x, t_x = randn_torch((num_weight, hidden), device="cuda", dtype=dtype, requires_grad=True)
+    m_p, t_p = randn_torch((max_position, hidden), device="cuda", dtype=dtype, requires_grad=True)
+    m_dy, t_dy = randn_torch(ind_shape + (hidden,), device="cuda", dtype=dtype)
+
+    model = with_autodiff(EmbeddingPosition())
+    m_out, m_grads = run_vm_model(model, "cuda", [m_dy, m_x, m_ind, m_p, m_pos_ids])
+    t_out = t_x.float()[t_ind] + t_p.float()[t_pos_ids]
+    t_out.backward(t_dy.float())
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    check(m_out, t_out, rtol=tol, atol=tol)
+    check(m_grads[0], t_x.grad, rtol=tol, atol=tol)
+    check(m_grads[2], t_p.grad, rtol=tol, atol=tol)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("num_sets,num_ways", [(4, 2), (64, 8)])
+def test_embedding_cache(num_sets, num_ways):
+    num_weight, hidden, learning_rate = 100, 33, 0.1
+    n_table = np.random.randn(num_weight, hidden).astype("float32")
+    cache = embedding_cache.EmbeddingCache(n_table, num_sets, num_ways, device="cuda")
+    lookup = EmbeddingCacheLookup()
+    sgd = EmbeddingCacheSgd(learning_rate)
+    for _ in range(5):
+        m_ind, _ = gen_indices((4, 50), num_weight, True)
+        n_ind = m_ind.numpy()
+        m_out = run_vm_model(lookup, "cuda", [m_ind, *cache.states()])
+        check(m_out, n_table[n_ind], rtol=1e-5, atol=1e-5)
+        m_dy, t_dy = randn_torch((4, 50, hidden), device="cuda")
+        run_vm_model(sgd, "cuda", [m_dy, m_ind, *cache.states()])
+        n_grad = np.zeros_like(n_table)
+        np.add.at(n_grad, n_ind.flatten(), t_dy.cpu().numpy().reshape(-1, hidden))
+        n_table -= learning_rate * n_grad
+        assert 0 < cache.num_cached_rows <= num_sets * num_ways
+    # The dirty rows in the cache are written back to the table.
+    check(cache.read_table(), n_table, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,87 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use
+import numpy as np
+import pytest
+import raf
+from raf.testing import check, run_vm_model, with_dialect
+
+
+class GlobalNormModel(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, *tensors):
+        return raf._op.sym.global_norm_and_check(list(tensors))
+
+
+# The shapes cover tensors of several chunks and lists split over several kernel launches.
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "shapes",
+    [
+        [(3, 4)],
+        [(1000, 300), (7,), (65536,), (65537,)],
+        [(i + 1, 5) for i in range(150)],
+    ],
+)
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_global_norm_and_check(shapes, dtype):
+    n_xs = [np.random.randn(*shape).astype(dtype) for shape in shapes]
+    m_xs = [raf.array(n_x, device="cuda") for n_x in n_xs]
+    model = GlobalNormModel()
+    m_norm, m_found_inf = run_vm_model(model, "cuda", m_xs)
+    n_norm = np.sqrt(sum(np.sum(np.square(n_x.astype("float64"))) for n_x in n_xs))
+    check(m_norm, n_norm, rtol=1e-4, atol=1e-4)
+    assert not m_found_inf.numpy()
+    # The partial sums are reduced in a fixed order, so the norm is deterministic.
+    check(run_vm_model(model, "cuda", m_xs)[0], m_norm, rtol=0, atol=0)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("value", [np.inf, -np.inf, np.nan])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_global_norm_overflow(value, dtype):
+    n_xs = [np.random.randn(100, 10).astype(dtype) for _ in range(3)]
+    n_xs[1][42, 3] = value
+    m_xs = [raf.array(n_x, device="cuda") for n_x in n_xs]
+    _, m_found_inf = run_vm_model(GlobalNormModel(), "cuda", m_xs)
+    assert m_found_inf.numpy()
+
+
+class UpdateLossScaleModel(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, grad_norm, loss_scale, good_steps):
+        return raf._op.sym.update_loss_scale(grad_norm, loss_scale, good_steps, 2.0, 0.5, 3, 1.0)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "inputs_outputs",
+    [
+        # A good step is counted, and the scale grows at the end of the interval.
+        [(1.0, 8.0, 0.0), (8.0, 1.0)],
+        [(1.0, 8.0, 2.0), (16.0, 0.0)],
+        # The scale backs off on overflow, but not below the minimum.
+        [(np.inf, 8.0, 2.0), (4.0, 0.0)],
+        [(np.nan, 1.5, 1.0), (1.0, 0.0)],
+    ],
+)
+def test_update_loss_scale(inputs_outputs):
+    inputs, (scale, steps) = inputs_outputs
+    m_inputs = [raf.array(np.array(x, dtype="float32"), device="cuda") for x in inputs]
+    m_scale, m_steps = run_vm_model(UpdateLossScaleModel(), "cuda", m_inputs)
+    check(m_scale, scale)
+    check(m_steps, steps)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
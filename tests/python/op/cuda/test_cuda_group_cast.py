@@ -0,0 +1,37 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use
+import pytest
+import numpy as np
+
+import raf
+from raf.testing import check, with_dialect
+from raf.testing.utils import run_model
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shapes", [[(3, 4), (5,)], [(65536 * 2 + 7,), (1, 3), (1024, 1024)]])
+@pytest.mark.parametrize("itype,otype", [("float32", "float16"), ("float16", "float32")])
+def test_group_cast(shapes, itype, otype):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, tensors):
+            return raf.group_cast(tensors, otype)
+
+    device = "cuda(0)"
+    n_x = [np.random.randn(*shape).astype(itype) for shape in shapes]
+    m_x = [raf.array(x, device=device) for x in n_x]
+    outs = run_model(Model(), [m_x], device)
+    assert len(outs) == len(n_x)
+    for n_out, out in zip(n_x, outs):
+        assert out.dtype == otype
+        check(out, n_out.astype(otype), rtol=1e-3, atol=1e-3)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,145 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, too-many-arguments, too-many-locals
+import numpy as np
+import pytest
+import torch
+import raf
+from raf.testing import check, run_vm_model, with_dialect
+
+
+class TestModel(raf.Model):
+    def build(self, op, **kwargs):
+        self.op = op  # pylint: disable=attribute-defined-outside-init
+        self.attrs = kwargs  # pylint: disable=attribute-defined-outside-init
+
+    @raf.model.trace
+    def forward(self, *args):
+        return self.op(*args, **self.attrs)
+
+
+class AdvIndexDx(raf.Model):
+    def build(self, num_indices):
+        self.num_indices = num_indices  # pylint: disable=attribute-defined-outside-init
+
+    @raf.model.trace
+    def forward(self, dy, data, *indices):
+        return raf._op.sym.adv_index_dx(dy, [data, *indices[: self.num_indices]])[0]
+
+
+def check_deterministic(model, m_args, m_dx):
+    # The rows are summed by a sorted segmented reduction without atomics.
+    check(run_vm_model(model, "cuda", m_args), m_dx, rtol=0, atol=0)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "config",
+    [
+        ((50, 16), (200,), 0),
+        ((4, 30, 8), (10, 20), 1),
+        ((6, 40), (3, 5), -1),
+        ((5, 7, 3), (64,), None),
+    ],
+)
+@pytest.mark.parametrize("mode", ["clip", "wrap"])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@pytest.mark.parametrize("index_dtype", ["int32", "int64"])
+def test_take_dx(config, mode, dtype, index_dtype):
+    x_shape, indices_shape, axis = config
+    n_x = np.random.randn(*x_shape).astype(dtype)
+    # Few distinct indices, some of them out of range, so that many rows are summed together.
+    range_ = n_x.size if axis is None else x_shape[axis]
+    n_indices = np.random.randint(-3, min(range_, 8) + 3, size=indices_shape).astype(index_dtype)
+    # The flat position in x of each element of y.
+    n_pos = np.take(np.arange(n_x.size).reshape(x_shape), n_indices, axis=axis, mode=mode)
+    n_dy = np.random.randn(*n_pos.shape).astype(dtype)
+    n_dx = np.zeros(n_x.size, dtype="float32")
+    np.add.at(n_dx, n_pos.reshape(-1), n_dy.astype("float32").reshape(-1))
+    n_dx = n_dx.reshape(x_shape)
+
+    model = TestModel(raf._op.sym.take_dx, axis=axis, mode=mode)
+    m_args = [raf.array(arg, device="cuda") for arg in [n_x, n_dy, n_indices]]
+    m_dx = run_vm_model(model, "cuda", m_args)
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_dx, n_dx, rtol=tol, atol=tol)
+    check_deterministic(model, m_args, m_dx)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("config", [((32, 5), (64, 5), 0), ((3, 9, 4), (3, 20, 2), 1)])
+@pytest.mark.parametrize("index_dtype", ["int32", "int64"])
+def test_gather_dx(config, index_dtype):
+    # pylint: disable=not-callable
+    data_shape, indices_shape, axis = config
+    n_data = np.random.randn(*data_shape).astype("float32")
+    n_indices = np.random.randint(0, 4, size=indices_shape).astype(index_dtype)
+    t_data = torch.tensor(n_data, requires_grad=True)
+    t_y = torch.gather(t_data, axis, torch.tensor(n_indices.astype("int64")))
+    t_dy = torch.randn(t_y.shape)
+    t_y.backward(t_dy)
+
+    model = TestModel(raf._op.sym.gather_dx, axis=axis)
+    m_args = [raf.array(arg, device="cuda") for arg in [n_data, n_indices, t_dy.numpy()]]
+    m_dx = run_vm_model(model, "cuda", m_args)
+    check(m_dx, t_data.grad, rtol=1e-4, atol=1e-4)
+    check_deterministic(model, m_args, m_dx)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "config",
+    [
+        ((10, 6, 3), [(40,)]),
+        ((10, 6, 3), [(5, 1), (1, 8)]),
+        ((4, 5, 6, 2), [(7,), (7,), (7,)]),
+    ],
+)
+def test_adv_index_dx(config):
+    data_shape, indices_shapes = config
+    n_data = np.random.randn(*data_shape).astype("float32")
+    n_indices = [
+        np.random.randint(-data_shape[k], data_shape[k], size=shape).astype("int64")
+        for k, shape in enumerate(indices_shapes)
+    ]
+    n_y = n_data[tuple(n_indices)]
+    n_dy = np.random.randn(*n_y.shape).astype("float32")
+    n_dx = np.zeros_like(n_data)
+    np.add.at(n_dx, tuple(n_indices), n_dy)
+
+    model = AdvIndexDx(len(n_indices))
+    m_args = [raf.array(arg, device="cuda") for arg in [n_dy, n_data, *n_indices]]
+    m_dx = run_vm_model(model, "cuda", m_args)
+    check(m_dx, n_dx, rtol=1e-4, atol=1e-4)
+    check_deterministic(model, m_args, m_dx)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("config", [((8, 5), (3, 5), 0), ((4, 9, 3), (4, 6, 3), 1)])
+def test_scatter_dx(config):
+    # pylint: disable=not-callable
+    x_shape, index_shape, axis = config
+    n_x = np.random.randn(*x_shape).astype("float32")
+    n_src = np.random.randn(*index_shape).astype("float32")
+    # Each column of the index is a permutation, so that no element is written twice.
+    n_index = np.argsort(np.random.rand(*x_shape), axis=axis)
+    n_index = np.take(n_index, np.arange(index_shape[axis]), axis=axis)
+    t_x = torch.tensor(n_x, requires_grad=True)
+    t_y = torch.scatter(t_x, axis, torch.tensor(n_index), torch.tensor(n_src))
+    t_dy = torch.randn(t_y.shape)
+    t_y.backward(t_dy)
+
+    model = TestModel(raf._op.sym.scatter_dx, axis=axis)
+    args = [n_x, t_y.detach().numpy(), t_dy.numpy(), n_index, n_src]
+    m_args = [raf.array(arg, device="cuda") for arg in args]
+    m_dx = run_vm_model(model, "cuda", m_args)
+    check(m_dx, t_x.grad)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,65 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init, protected-access
+import sys
+import numpy as np
+import pytest
+from tvm import relay
+import raf
+from raf._op.dialect import DialectPreference
+from raf.testing import check, run_vm_model
+
+
+class ThreefryDistribution(raf.Model):
+    def build(self, op, shape, **kwargs):
+        self.op = op
+        self.shape = shape
+        self.attrs = kwargs
+
+    @raf.model.trace
+    def forward(self, key):
+        return self.op(key, self.shape, **self.attrs)
+
+
+def make_key():
+    seed = np.random.randint(0, high=sys.maxsize)
+    return raf.array(relay.random.threefry_key(seed).data.numpy(), dtype="uint64", device="cuda")
+
+
+def run_with_dialect(dialect, model, key):
+    with DialectPreference([dialect]):
+        return run_vm_model(model, "cuda", [key])
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(3, 5), (1000, 1000)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_threefry_uniform(shape, dtype):
+    key = make_key()
+    model = ThreefryDistribution(raf.threefry_uniform, shape, low=-2.0, high=2.0, dtype=dtype)
+    m_y = run_with_dialect("cuda", model, key)
+    n_y = m_y.numpy()
+    assert n_y.shape == shape and n_y.dtype == dtype
+    assert np.all(n_y >= -2.0) and np.all(n_y <= 2.0)
+    if n_y.size > 1000:
+        np.testing.assert_allclose(np.mean(n_y.astype("float64")), 0.0, atol=0.01)
+    # Both dialects compute each number from the key and its index in the same way.
+    tol = 1e-6 if dtype == "float32" else 1e-3
+    check(run_with_dialect("tvm", model, key), m_y, rtol=tol, atol=tol)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_threefry_normal():
+    key = make_key()
+    model = ThreefryDistribution(raf.threefry_normal, (1000, 1000), mean=1.0, stddev=2.0)
+    m_y = run_with_dialect("cuda", model, key)
+    n_y = m_y.numpy()
+    assert np.all(np.isfinite(n_y))
+    np.testing.assert_allclose(np.mean(n_y), 1.0, atol=0.01)
+    np.testing.assert_allclose(np.std(n_y), 2.0, atol=0.01)
+    check(run_with_dialect("tvm", model, key), m_y, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
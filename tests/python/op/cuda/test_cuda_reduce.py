@@ -0,0 +1,76 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use
+import numpy as np
+import pytest
+import raf
+from raf.testing import check, run_vm_model, with_dialect
+
+
+class TestModel(raf.Model):
+    def build(self, op, **kwargs):
+        self.op = op  # pylint: disable=attribute-defined-outside-init
+        self.attrs = kwargs  # pylint: disable=attribute-defined-outside-init
+
+    @raf.model.trace
+    def forward(self, x):
+        return self.op(x, **self.attrs)
+
+
+# The shapes cover the warp, block and split row reductions, and the plain and split column
+# reductions, with and without vectorized loads.
+SHAPES_AND_AXES = [
+    ((64, 128), -1),
+    ((7, 1001), 1),
+    ((300, 5000), 1),
+    ((2, 200000), 1),
+    ((3, 65537), -1),
+    ((16, 1000, 40), 1),
+    ((3, 50000, 4), 1),
+    ((4, 1, 6, 5), (1, 2)),
+    ((2, 3, 4), None),
+]
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape_and_axis", SHAPES_AND_AXES)
+@pytest.mark.parametrize(
+    "ops",
+    [
+        (np.sum, raf._op.sym.sum),
+        (np.mean, raf._op.sym.mean),
+        (np.max, raf._op.sym.max),
+        (np.min, raf._op.sym.min),
+    ],
+)
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_reduce(shape_and_axis, ops, dtype):
+    shape, axis = shape_and_axis
+    n_op, m_op = ops
+    n_x = np.random.randn(*shape).astype(dtype)
+    model = TestModel(m_op) if axis is None else TestModel(m_op, axis=axis)
+    m_y = run_vm_model(model, "cuda", [raf.array(n_x, device="cuda")])
+    n_y = n_op(n_x.astype("float64"), axis=axis)
+    if dtype == "float32":
+        check(m_y, n_y, rtol=1e-4, atol=1e-3)
+    else:
+        check(m_y, n_y, rtol=1e-2, atol=1e-1)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(3, 100), (1000, 1000), (1 << 22,)])
+def test_l2norm(shape):
+    n_x = np.random.randn(*shape).astype("float32")
+    model = TestModel(raf._op.sym.l2norm)
+    m_args = [raf.array(n_x, device="cuda")]
+    m_y = run_vm_model(model, "cuda", m_args)
+    check(m_y, np.linalg.norm(n_x.astype("float64")), rtol=1e-4, atol=1e-4)
+    # The partial results are reduced in a fixed order, so the result is deterministic.
+    check(run_vm_model(model, "cuda", m_args), m_y, rtol=0, atol=0)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
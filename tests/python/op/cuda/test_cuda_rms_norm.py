@@ -0,0 +1,124 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, too-many-arguments, too-many-locals
+import numpy as np
+import pytest
+import torch
+import raf
+from raf.testing import check, randn_torch, run_vm_model, with_dialect
+from raf.optim.optim import with_autodiff
+
+
+class RMSNorm(raf.Model):
+    def build(self, affine):
+        self.affine = affine
+
+    @raf.model.trace
+    def forward(self, x, scale):
+        if self.affine:
+            return raf.rms_norm(x, scale, eps=1e-6)
+        return raf.rms_norm(x, eps=1e-6)
+
+
+class RotaryEmbedding(raf.Model):
+    def build(self, seq_axis, interleaved):
+        self.seq_axis = seq_axis
+        self.interleaved = interleaved
+
+    @raf.model.trace
+    def forward(self, x, cos, sin):
+        return raf.rotary_embedding(
+            x, cos, sin, seq_axis=self.seq_axis, interleaved=self.interleaved
+        )
+
+
+def torch_rms_norm(x, scale):
+    x = x.float()
+    y = x * torch.rsqrt(x.pow(2).mean(-1, keepdim=True) + 1e-6)
+    if scale is not None:
+        y = y * scale.float()
+    return y
+
+
+def torch_rotary_embedding(x, cos, sin, seq_axis, interleaved):
+    seq_axis = seq_axis % x.dim()
+    half = cos.shape[-1]
+    # Broadcast the tables of shape [seq, half] over the axes after seq_axis.
+    view = [cos.shape[0]] + [1] * (x.dim() - seq_axis - 2) + [half]
+    cos, sin = cos.view(view), sin.view(view)
+    rot, rest = x[..., : 2 * half], x[..., 2 * half :]
+    if interleaved:
+        x1, x2 = rot[..., 0::2], rot[..., 1::2]
+        out = torch.stack([x1 * cos - x2 * sin, x2 * cos + x1 * sin], dim=-1).flatten(-2)
+    else:
+        x1, x2 = rot[..., :half], rot[..., half:]
+        out = torch.cat([x1 * cos - x2 * sin, x2 * cos + x1 * sin], dim=-1)
+    return torch.cat([out, rest], dim=-1)
+
+
+def rotary_tables(seq_len, half, dtype):
+    inv_freq = 1.0 / (10000 ** (np.arange(half) / half))
+    angles = np.outer(np.arange(seq_len), inv_freq)
+    m_cos = raf.array(np.cos(angles).astype(dtype), device="cuda")
+    m_sin = raf.array(np.sin(angles).astype(dtype), device="cuda")
+    t_cos = torch.tensor(np.cos(angles).astype(dtype), device="cuda")
+    t_sin = torch.tensor(np.sin(angles).astype(dtype), device="cuda")
+    return m_cos, m_sin, t_cos, t_sin
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(4, 7, 64), (13, 1000), (2, 9000), (3, 37)])
+@pytest.mark.parametrize("affine", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_rms_norm(shape, affine, dtype):
+    device = "cuda"
+    m_x, t_x = randn_torch(shape, device=device, dtype=dtype, requires_grad=True)
+    m_w, t_w = randn_torch(shape[-1:], device=device, dtype=dtype, requires_grad=True)
+    m_dy, t_dy = randn_torch(shape, device=device, dtype=dtype)
+
+    m_model = with_autodiff(RMSNorm(affine))
+    m_out, m_grads = run_vm_model(m_model, device, [m_dy, m_x, m_w])
+    t_y = torch_rms_norm(t_x, t_w if affine else None)
+    t_y.backward(t_dy.float())
+
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_out, t_y, rtol=tol, atol=tol)
+    check(m_grads[0], t_x.grad, rtol=tol, atol=tol)
+    if affine:
+        # The gradient of scale is summed over all rows.
+        check(m_grads[1], t_w.grad, rtol=tol, atol=tol * 10)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "shape_axis_half",
+    [
+        [(2, 4, 17, 64), -2, 32],
+        [(2, 17, 4, 64), 1, 32],
+        [(3, 9, 80), -2, 16],
+    ],
+)
+@pytest.mark.parametrize("interleaved", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_rotary_embedding(shape_axis_half, interleaved, dtype):
+    shape, seq_axis, half = shape_axis_half
+    device = "cuda"
+    m_x, t_x = randn_torch(shape, device=device, dtype=dtype, requires_grad=True)
+    m_dy, t_dy = randn_torch(shape, device=device, dtype=dtype)
+    m_cos, m_sin, t_cos, t_sin = rotary_tables(shape[seq_axis], half, dtype)
+
+    m_model = with_autodiff(RotaryEmbedding(seq_axis, interleaved))
+    m_out, m_grads = run_vm_model(m_model, device, [m_dy, m_x, m_cos, m_sin])
+    t_y = torch_rotary_embedding(t_x, t_cos, t_sin, seq_axis, interleaved)
+    t_y.backward(t_dy)
+
+    tol = 1e-5 if dtype == "float32" else 1e-2
+    check(m_out, t_y, rtol=tol, atol=tol)
+    check(m_grads[0], t_x.grad, rtol=tol, atol=tol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
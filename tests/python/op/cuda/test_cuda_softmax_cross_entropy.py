@@ -0,0 +1,73 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, too-many-arguments, too-many-locals
+import numpy as np
+import pytest
+import torch
+import torch.nn.functional as F
+import raf
+from raf.testing import check, randn_torch, run_vm_model, with_dialect
+from raf.optim.optim import with_autodiff
+
+
+class SoftmaxCrossEntropy(raf.Model):
+    def build(self, ignore_index, label_smoothing):
+        self.ignore_index = ignore_index
+        self.label_smoothing = label_smoothing
+
+    @raf.model.trace
+    def forward(self, y_true, y_pred):
+        return raf._op.sym.softmax_cross_entropy(
+            y_true, y_pred, ignore_index=self.ignore_index, label_smoothing=self.label_smoothing
+        )
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(8, 10), (37, 1000), (4, 32000)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@pytest.mark.parametrize("label_dtype", ["int64", "int32"])
+@pytest.mark.parametrize("label_smoothing", [0.0, 0.1])
+def test_softmax_cross_entropy(shape, dtype, label_dtype, label_smoothing):
+    n, c = shape
+    device = "cuda"
+    ignore_index = -100
+    m_pred, t_pred = randn_torch(shape, device=device, dtype=dtype, requires_grad=True)
+    n_true = np.random.randint(0, c, size=n).astype(label_dtype)
+    n_true[::3] = ignore_index
+    m_true = raf.array(n_true, device=device)
+    t_true = torch.tensor(n_true.astype("int64"), device=device)
+    m_dy, t_dy = randn_torch((1,), device=device)
+
+    m_model = with_autodiff(SoftmaxCrossEntropy(ignore_index, label_smoothing))
+    m_y = run_vm_model(m_model, device, [m_dy, m_true, m_pred])
+    m_loss, m_dpred = m_y[0], m_y[1][1]
+    t_loss = F.cross_entropy(
+        t_pred.float(), t_true, ignore_index=ignore_index, label_smoothing=label_smoothing
+    )
+    t_loss.backward(t_dy[0])
+
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_loss, t_loss.reshape((1,)), rtol=tol, atol=tol)
+    check(m_dpred, t_pred.grad, rtol=tol, atol=tol)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_softmax_cross_entropy_all_ignored():
+    n, c = 4, 16
+    device = "cuda"
+    m_pred, _ = randn_torch((n, c), device=device, requires_grad=True)
+    m_true = raf.array(np.full((n,), -1, dtype="int64"), device=device)
+    m_dy, _ = randn_torch((1,), device=device)
+
+    m_model = with_autodiff(SoftmaxCrossEntropy(-1, 0.0))
+    m_y = run_vm_model(m_model, device, [m_dy, m_true, m_pred])
+    # No row is counted, so both the loss and the gradient are zeros.
+    np.testing.assert_equal(m_y[0].numpy(), np.zeros((1,), dtype="float32"))
+    np.testing.assert_equal(m_y[1][1].numpy(), np.zeros((n, c), dtype="float32"))
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,78 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, too-many-arguments
+import numpy as np
+import pytest
+import raf
+from raf.testing import check, run_vm_model, with_dialect
+
+
+class TestModel(raf.Model):
+    def build(self, op, **kwargs):
+        self.op = op  # pylint: disable=attribute-defined-outside-init
+        self.attrs = kwargs  # pylint: disable=attribute-defined-outside-init
+
+    @raf.model.trace
+    def forward(self, *args):
+        return self.op(*args, **self.attrs)
+
+
+def gen_data(shape, dtype, num_unique=None):
+    """Generate the data of distinct values, or of num_unique values to test the ties."""
+    size = int(np.prod(shape))
+    if num_unique is None:
+        n_x = np.random.permutation(size) - size // 2
+    else:
+        n_x = np.random.randint(0, num_unique, size=size)
+    # float16 is exact for the integers up to 2048.
+    if dtype == "float16":
+        n_x = n_x % 2048
+    return n_x.reshape(shape).astype(dtype)
+
+
+def np_argsort(n_x, is_ascend):
+    # The equal elements keep their order in both directions.
+    key = n_x.astype("float64") if is_ascend else -n_x.astype("float64")
+    return np.argsort(key, axis=-1, kind="stable")
+
+
+# The rows of 7 and 300 elements are sorted in shared memory, and the others by the radix sort.
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(3, 7), (64, 300), (1, 5000), (6, 4, 3000)])
+@pytest.mark.parametrize("dtype", ["float32", "float16", "int32", "int64"])
+@pytest.mark.parametrize("is_ascend", [True, False])
+def test_argsort_sort(shape, dtype, is_ascend):
+    n_x = gen_data(shape, dtype)
+    m_x = raf.array(n_x, device="cuda")
+    n_idx = np_argsort(n_x, is_ascend)
+
+    model = TestModel(raf._op.sym.argsort, axis=-1, is_ascend=is_ascend, dtype="int64")
+    check(run_vm_model(model, "cuda", [m_x]), n_idx)
+    model = TestModel(raf._op.sym.sort, axis=-1, is_ascend=is_ascend)
+    check(run_vm_model(model, "cuda", [m_x]), np.take_along_axis(n_x, n_idx, axis=-1))
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(8, 50), (16, 1000), (2, 10000)])
+@pytest.mark.parametrize("k", [1, 5])
+@pytest.mark.parametrize("index_dtype", ["int32", "int64"])
+@pytest.mark.parametrize("is_ascend", [True, False])
+def test_topk(shape, k, index_dtype, is_ascend):
+    n_x = gen_data(shape, "float32", num_unique=shape[-1] // 4)
+    m_x = raf.array(n_x, device="cuda")
+    n_idx = np_argsort(n_x, is_ascend)[..., :k]
+
+    model = TestModel(
+        raf._op.sym.topk, k=k, axis=-1, ret_type="both", is_ascend=is_ascend, dtype=index_dtype
+    )
+    m_values, m_indices = run_vm_model(model, "cuda", [m_x])
+    assert m_indices.dtype == index_dtype
+    check(m_indices, n_idx.astype(index_dtype))
+    check(m_values, np.take_along_axis(n_x, n_idx, axis=-1))
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
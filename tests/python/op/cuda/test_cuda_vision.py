@@ -0,0 +1,256 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use, too-many-arguments, too-many-locals
+import numpy as np
+import pytest
+import torch
+import torchvision
+import raf
+from raf.testing import check, run_vm_model, with_dialect
+
+import tvm.topi.testing
+
+
+class TestModel(raf.Model):
+    def build(self, op, **kwargs):
+        self.op = op  # pylint: disable=attribute-defined-outside-init
+        self.attrs = kwargs  # pylint: disable=attribute-defined-outside-init
+
+    @raf.model.trace
+    def forward(self, *args):
+        return self.op(*args, **self.attrs)
+
+
+class GetValidCountsNms(raf.Model):
+    def build(self, return_indices):
+        self.return_indices = return_indices  # pylint: disable=attribute-defined-outside-init
+
+    @raf.model.trace
+    def forward(self, data, score_threshold, max_output_size, iou_threshold):
+        valid_count, boxes, indices = raf.get_valid_counts(data, score_threshold, 0, 1)
+        return raf.non_max_suppression(
+            boxes,
+            valid_count,
+            indices,
+            max_output_size,
+            iou_threshold,
+            top_k=-1,
+            return_indices=self.return_indices,
+        )
+
+
+def gen_boxes(batch, num_anchors, num_classes=3):
+    """Generate the boxes of (class id, score, left, top, right, bottom) of distinct scores."""
+    data = np.zeros((batch, num_anchors, 6), dtype="float32")
+    data[:, :, 0] = np.random.randint(-1, num_classes, size=(batch, num_anchors))
+    for b in range(batch):
+        data[b, :, 1] = (np.random.permutation(num_anchors) + 1) / num_anchors
+    corners = np.random.uniform(0, 100, size=(batch, num_anchors, 2))
+    sizes = np.random.uniform(5, 30, size=(batch, num_anchors, 2))
+    data[:, :, 2:4] = corners
+    data[:, :, 4:6] = corners + sizes
+    return data
+
+
+def np_iou(box_a, box_b):
+    width = max(0, min(box_a[2], box_b[2]) - max(box_a[0], box_b[0]))
+    height = max(0, min(box_a[3], box_b[3]) - max(box_a[1], box_b[1]))
+    inter = width * height
+    union = (
+        (box_a[2] - box_a[0]) * (box_a[3] - box_a[1])
+        + (box_b[2] - box_b[0]) * (box_b[3] - box_b[1])
+        - inter
+    )
+    return 0 if union <= 0 else inter / union
+
+
+def np_get_valid_counts(data, score_threshold):
+    valid = (data[:, :, 1] > score_threshold) & (data[:, :, 0] >= 0)
+    valid_count = valid.sum(axis=1).astype("int32")
+    out = np.full_like(data, -1)
+    out_indices = np.full(data.shape[:2], -1, dtype="int32")
+    for b in range(data.shape[0]):
+        (idx,) = np.nonzero(valid[b])
+        out[b, : len(idx)] = data[b, idx]
+        out_indices[b, : len(idx)] = idx
+    return valid_count, out, out_indices
+
+
+def np_nms(data, valid_count, indices, max_output_size, iou_threshold, force_suppress, top_k):
+    """The non-maximum suppression of the boxes of positive scores, where the kept boxes are at
+    their sorted positions in the boxes and are compacted in the indices."""
+    batch, num_anchors, _ = data.shape
+    out = np.full_like(data, -1)
+    out_indices = np.full((batch, num_anchors), -1, dtype="int32")
+    out_count = np.zeros((batch, 1), dtype="int32")
+    for b in range(batch):
+        order = np.argsort(-data[b, : valid_count[b], 1], kind="stable")
+        if 0 < top_k < len(order):
+            order = order[:top_k]
+        kept = []
+        for pos, j in enumerate(order):
+            if len(kept) == max_output_size:
+                break
+            suppressed = any(
+                (force_suppress or data[b, k, 0] == data[b, j, 0])
+                and np_iou(data[b, k, 2:], data[b, j, 2:]) >= iou_threshold
+                for _, k in kept
+            )
+            if not suppressed:
+                kept.append((pos, j))
+        for pos, j in kept:
+            out[b, pos] = data[b, j]
+        out_indices[b, : len(kept)] = [indices[b, j] for _, j in kept]
+        out_count[b] = len(kept)
+    return out, out_indices, out_count
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(1, 2500), (16, 500)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_get_valid_counts(shape, dtype):
+    n_data = gen_boxes(*shape).astype(dtype)
+    n_s = np.array(0.3, dtype="float32")
+    model = TestModel(raf._op.sym.get_valid_counts, id_index=0, score_index=1)
+    m_args = [raf.array(arg, device="cuda") for arg in [n_data, n_s]]
+    m_out = run_vm_model(model, "cuda", m_args)
+    n_out = np_get_valid_counts(n_data, n_s)
+    for m_val, n_val in zip(m_out, n_out):
+        check(m_val, n_val)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(1, 5), (2, 300), (4, 1000)])
+@pytest.mark.parametrize("force_suppress", [False, True])
+@pytest.mark.parametrize("top_k", [-1, 100])
+@pytest.mark.parametrize("max_output_size", [-1, 20])
+def test_nms(shape, force_suppress, top_k, max_output_size):
+    n_data = gen_boxes(*shape)
+    n_data[:, :, 0] = np.abs(n_data[:, :, 0])
+    n_valid_count = np.random.randint(shape[1] // 2, shape[1] + 1, size=shape[0]).astype("int32")
+    n_indices = np.stack([np.random.permutation(shape[1]) for _ in range(shape[0])])
+    n_indices = n_indices.astype("int32")
+    n_max = np.array(max_output_size, dtype="int32")
+    n_iou = np.array(0.3, dtype="float32")
+    n_out, n_out_indices, n_out_count = np_nms(
+        n_data, n_valid_count, n_indices, max_output_size, 0.3, force_suppress, top_k
+    )
+    args = [n_data, n_valid_count, n_indices, n_max, n_iou]
+    m_args = [raf.array(arg, device="cuda") for arg in args]
+
+    for return_indices in [False, True]:
+        model = TestModel(
+            raf._op.sym.non_max_suppression,
+            force_suppress=force_suppress,
+            top_k=top_k,
+            return_indices=return_indices,
+        )
+        m_out = run_vm_model(model, "cuda", m_args)
+        if return_indices:
+            check(m_out[0], n_out_indices)
+            check(m_out[1], n_out_count)
+        else:
+            check(m_out, n_out)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(1, 100), (3, 700)])
+@pytest.mark.parametrize("return_indices", [False, True])
+def test_fused_get_valid_counts_nms(shape, return_indices):
+    n_data = gen_boxes(*shape)
+    n_args = [
+        n_data,
+        np.array(0.2, dtype="float32"),
+        np.array(-1, dtype="int32"),
+        np.array(0.4, dtype="float32"),
+    ]
+    model = GetValidCountsNms(return_indices)
+    m_out = run_vm_model(model, "cuda", [raf.array(arg, device="cuda") for arg in n_args])
+    n_valid_count, n_boxes, n_indices = np_get_valid_counts(n_data, 0.2)
+    n_out, n_out_indices, n_out_count = np_nms(
+        n_boxes, n_valid_count, n_indices, -1, 0.4, False, -1
+    )
+    if return_indices:
+        check(m_out[0], n_out_indices)
+        check(m_out[1], n_out_count)
+    else:
+        check(m_out, n_out)
+
+
+def gen_rois(data_shape, num_rois):
+    n_rois = np.random.uniform(size=(num_rois, 5)).astype("float32") * data_shape[2]
+    n_rois[:, 0] = np.random.randint(low=0, high=data_shape[0], size=num_rois)
+    return n_rois
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "config",
+    [((1, 4, 16, 16), 32, (7, 7), 1.0, -1), ((4, 4, 40, 50), 300, (7, 5), 0.5, 2)],
+)
+@pytest.mark.parametrize("mode", ["avg", "max"])
+def test_roi_align(config, mode):
+    data_shape, num_rois, pooled_size, spatial_scale, sample_ratio = config
+    n_data = np.random.uniform(size=data_shape).astype("float32")
+    n_rois = gen_rois(data_shape, num_rois)
+    n_out = tvm.topi.testing.roi_align_nchw_python(
+        n_data,
+        n_rois,
+        pooled_size=pooled_size,
+        spatial_scale=spatial_scale,
+        sample_ratio=sample_ratio,
+        mode=mode,
+    )
+    model = TestModel(
+        raf._op.sym.roi_align,
+        pooled_size=pooled_size,
+        spatial_scale=spatial_scale,
+        sample_ratio=sample_ratio,
+        layout="NCHW",
+        mode=mode,
+    )
+    m_args = [raf.array(arg, device="cuda") for arg in [n_data, n_rois]]
+    m_out = run_vm_model(model, "cuda", m_args)
+    check(m_out, n_out, rtol=1e-5, atol=1e-5)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "config",
+    [((1, 4, 16, 16), 32, (7, 7), 1.0, -1), ((4, 3, 40, 50), 700, (7, 5), 0.5, 2)],
+)
+def test_roi_align_dx(config):
+    # pylint: disable=not-callable
+    data_shape, num_rois, pooled_size, spatial_scale, sample_ratio = config
+    n_data = np.random.uniform(size=data_shape).astype("float32")
+    n_rois = gen_rois(data_shape, num_rois)
+    t_data = torch.tensor(n_data, requires_grad=True)
+    t_y = torchvision.ops.roi_align(
+        t_data, torch.tensor(n_rois), pooled_size, spatial_scale, sample_ratio
+    )
+    t_dy = torch.randn(t_y.shape)
+    t_y.backward(t_dy)
+
+    model = TestModel(
+        raf._op.sym.roi_align_dx,
+        pooled_size=pooled_size,
+        spatial_scale=spatial_scale,
+        sample_ratio=sample_ratio,
+        layout="NCHW",
+        mode="avg",
+    )
+    m_args = [raf.array(arg, device="cuda") for arg in [n_data, n_rois, t_dy.numpy()]]
+    m_dx = run_vm_model(model, "cuda", m_args)
+    check(m_dx, t_data.grad, rtol=1e-4, atol=1e-4)
+    # The gradient is gathered without atomics, so it is deterministic.
+    check(run_vm_model(model, "cuda", m_args), m_dx, rtol=0, atol=0)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
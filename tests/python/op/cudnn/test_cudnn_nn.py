@@ -267,6 +267,7 @@ def test_raf_batch_norm_train(shape, momentum, eps, dtype):
 
 
 @with_dialect(["cudnn"])
+@with_dialect(["cudnn", "tvm"])
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize("dropout", [0.4, 0.6])
 def test_raf_dropout(dropout):
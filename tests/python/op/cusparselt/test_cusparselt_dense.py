@@ -0,0 +1,48 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=no-member
+import pytest
+import torch
+import raf
+from raf._core.executor import VMExecutor
+from raf.testing import check, randn_torch, with_dialect
+
+
+def prune_24(t_w):
+    rows, cols = t_w.shape
+    t_w = t_w.reshape(rows, cols // 4, 4)
+    idx = torch.topk(t_w.abs(), 2, dim=-1).indices
+    return torch.zeros_like(t_w).scatter(-1, idx, t_w.gather(-1, idx)).reshape(rows, cols)
+
+
+class Model(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x, w):
+        return raf.dense(x, w)
+
+
+@with_dialect("cusparselt")
+@pytest.mark.skipif(not raf.build.with_cusparselt(), reason="cuSPARSELt is not enabled")
+@pytest.mark.parametrize("mode", ["pruned", "prune"])
+def test_sparse24_dense(mode):
+    m_x, t_x = randn_torch((64, 128), device="cuda", dtype="float16")
+    m_w, t_w = randn_torch((32, 128), device="cuda", dtype="float16")
+    t_w = prune_24(t_w)
+    if mode == "pruned":
+        m_w = raf.array(t_w.cpu().numpy(), device="cuda")
+    mod = Model()._internal(m_x, m_w).mod
+    with raf.ir.PassContext(config={"raf.sparsity_24": mode}):
+        executor = VMExecutor(mod, "cuda").make_executor()
+        # The second run reuses the compressed weight and the searched algorithm.
+        for _ in range(2):
+            m_y = executor(m_x, m_w)
+    t_y = torch.matmul(t_x.float(), t_w.float().T)
+    check(m_y, t_y, rtol=1e-2, atol=1e-2)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -8,7 +8,7 @@ import torch
 import torch.nn.functional as F
 
 import raf
-from raf.testing import randn_torch, run_vm_model, check, DialectChecker
+from raf.testing import randn_torch, run_vm_model, check, DialectChecker, with_dialect
 from raf.model.nn import Linear
 
 
@@ -143,5 +143,37 @@ def test_batch_matmul_nt_add(batch_size1, batch_size2, m, n, k, dtype, epilogue)
     check(m_y, t_y, rtol=rtol, atol=atol)
 
 
+@pytest.mark.skipif(not raf.build.with_cutlass(), reason="CUTLASS is not enabled")
+@with_dialect("cutlass")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@pytest.mark.parametrize("transpose_b", [True, False])
+def test_grouped_matmul(dtype, transpose_b):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, a_0, a_1, a_2, b_0, b_1, b_2):  # pylint: disable=no-self-use
+            return raf.grouped_matmul([a_0, a_1, a_2], [b_0, b_1, b_2], transpose_b=transpose_b)
+
+    device = "cuda"
+    # The experts with uneven numbers of tokens, including an empty one.
+    shapes = [(37, 64, 128), (0, 64, 128), (128, 64, 128)]
+    m_a, t_a, m_b, t_b = [], [], [], []
+    for m, k, n in shapes:
+        m_x, t_x = randn_torch((m, k), device=device, dtype=dtype)
+        m_y, t_y = randn_torch((n, k) if transpose_b else (k, n), device=device, dtype=dtype)
+        m_a.append(m_x)
+        t_a.append(t_x)
+        m_b.append(m_y)
+        t_b.append(t_y)
+    model = TestModel()
+    m_c = run_vm_model(model, device, m_a + m_b)
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    for i, (t_x, t_y) in enumerate(zip(t_a, t_b)):
+        t_c = torch.matmul(t_x, t_y.T if transpose_b else t_y)
+        check(m_c[i], t_c, rtol=tol, atol=tol)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
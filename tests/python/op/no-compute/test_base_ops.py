@@ -29,11 +29,10 @@ def test_size(shape, axis, device):
     assert m_y.shape == n_y.shape
     assert (m_y.numpy() == n_y).all()
     # traced
-    if device != "cuda":  # TODO: vm not support heterogeneous now
-        model = Model(axis=axis)
-        v_y = run_vm_model(model, device, [m_x], opt_level=1)
-        assert v_y.shape == n_y.shape
-        assert (v_y.numpy() == n_y).all()
+    model = Model(axis=axis)
+    v_y = run_vm_model(model, device, [m_x], opt_level=1)
+    assert v_y.shape == n_y.shape
+    assert (v_y.numpy() == n_y).all()
 
 
 @pytest.mark.parametrize("shape", [[5, 3], [5, 3, 2], [5, 2, 2, 2]])
@@ -55,11 +54,10 @@ def test_numel(shape, device):
     assert m_y.shape == n_y.shape
     assert (m_y.numpy() == n_y).all()
     # traced
-    if device != "cuda":  # TODO: vm not support heterogeneous now
-        model = Model()
-        v_y = run_vm_model(model, device, [m_x], opt_level=1)
-        assert v_y.shape == n_y.shape
-        assert (v_y.numpy() == n_y).all()
+    model = Model()
+    v_y = run_vm_model(model, device, [m_x], opt_level=1)
+    assert v_y.shape == n_y.shape
+    assert (v_y.numpy() == n_y).all()
 
 
 @pytest.mark.parametrize("shape", [[5, 3], [5, 3, 2], [5, 2, 2, 2]])
@@ -81,11 +79,10 @@ def test_shape_as_tensor(shape, device):
     assert m_y.shape == n_y.shape
     assert (m_y.numpy() == n_y).all()
     # traced
-    if device != "cuda":  # TODO: vm not support heterogeneous now
-        model = Model()
-        v_y = run_vm_model(model, device, [m_x], opt_level=1)
-        assert v_y.shape == n_y.shape
-        assert (v_y.numpy() == n_y).all()
+    model = Model()
+    v_y = run_vm_model(model, device, [m_x], opt_level=1)
+    assert v_y.shape == n_y.shape
+    assert (v_y.numpy() == n_y).all()
 
 
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
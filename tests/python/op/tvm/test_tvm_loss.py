@@ -124,6 +124,40 @@ def test_cross_entropy(device, n, c):
     check(m_pred.grad, t_pred.grad)
 
 
+@pytest.mark.parametrize("device", ["cpu"])
+@pytest.mark.parametrize("n", [3, 7])
+@pytest.mark.parametrize("c", [2, 6])
+@pytest.mark.parametrize("label_smoothing", [0.0, 0.1])
+def test_softmax_cross_entropy(device, n, c, label_smoothing):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, y_true, y_pred):  # pylint: disable=no-self-use
+            return raf._op.sym.softmax_cross_entropy(
+                y_true, y_pred, ignore_index=-100, label_smoothing=label_smoothing
+            )
+
+    model = TestModel()
+    m_pred, t_pred = randn_torch((n, c), device=device, requires_grad=True)
+    np_true = np.random.randint(0, c, size=n).astype("int64")
+    np_true[0] = -100
+    m_true = raf.array(np_true, device=device)
+    t_true = torch.tensor(np_true, device=device)
+    # forward
+    t_loss = F.cross_entropy(t_pred, t_true, ignore_index=-100, label_smoothing=label_smoothing)
+    m_loss = model(y_true=m_true, y_pred=m_pred)
+    v_loss = run_vm_model(model, device, [m_true, m_pred])
+    check(m_loss, t_loss.reshape((1,)))
+    check(v_loss, t_loss.reshape((1,)))
+    # backward
+    m_dy, t_dy = randn_torch((1,), device=device)
+    t_loss.backward(t_dy[0])
+    m_loss.backward(m_dy)
+    check(m_pred.grad, t_pred.grad)
+
+
 # TODO(@icemelon9): enable vm test in the future
 @pytest.mark.parametrize(
     "shape",
@@ -628,6 +628,77 @@ def test_matmul(device, dtype, n, k, m, transpose_a, transpose_b):
     check(m_b.grad, t_b.grad, rtol=1e-4, atol=1e-4)
 
 
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("transpose_b", [True, False])
+def test_grouped_matmul(device, transpose_b):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, a_0, a_1, a_2, b_0, b_1, b_2):
+            return raf.grouped_matmul([a_0, a_1, a_2], [b_0, b_1, b_2], transpose_b=transpose_b)
+
+    # The problems have different numbers of rows, e.g., the tokens routed to each expert.
+    shapes = [(5, 8, 16), (1, 8, 16), (12, 4, 6)]
+    m_a, t_a, m_b, t_b = [], [], [], []
+    for m, k, n in shapes:
+        m_x, t_x = randn_torch((m, k), device=device)
+        m_y, t_y = randn_torch((n, k) if transpose_b else (k, n), device=device)
+        m_a.append(m_x)
+        t_a.append(t_x)
+        m_b.append(m_y)
+        t_b.append(t_y)
+    model = TestModel()
+    m_c = run_vm_model(model, device, m_a + m_b)
+    for i, (t_x, t_y) in enumerate(zip(t_a, t_b)):
+        t_c = torch.matmul(t_x, t_y.T if transpose_b else t_y)  # pylint: disable=no-member
+        check(m_c[i], t_c, rtol=1e-4, atol=1e-4)
+
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_prune_24(device):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, w):
+            return raf.prune_24(w)
+
+    m_w, n_w = randn((6, 16), device=device)
+    m_y = run_vm_model(TestModel(), device, [m_w])
+    # Keep the two elements with the largest magnitudes in each group of four.
+    groups = n_w.reshape(6, 4, 4)
+    order = np.argsort(-np.abs(groups), axis=-1, kind="stable")
+    mask = np.zeros_like(groups, dtype=bool)
+    np.put_along_axis(mask, order[..., :2], True, axis=-1)
+    n_y = np.where(mask, groups, 0).reshape(6, 16)
+    check(m_y, n_y)
+
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_sparse24_dense(device):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            return raf.sparse24_dense(x, raf.prune_24(w))
+
+    m_x, t_x = randn_torch((8, 16), device=device)
+    m_w, t_w = randn_torch((12, 16), device=device)
+    m_y = run_vm_model(TestModel(), device, [m_x, m_w])
+    t_w = t_w.reshape(12, 4, 4)
+    idx = torch.topk(t_w.abs(), 2, dim=-1).indices
+    t_w = torch.zeros_like(t_w).scatter(-1, idx, t_w.gather(-1, idx)).reshape(12, 16)
+    check(m_y, torch.matmul(t_x, t_w.T), rtol=1e-4, atol=1e-4)  # pylint: disable=no-member
+
+
 @with_dialect("tvm")
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("shape", [[8, 8, 8, 8], [8, 8, 8, 8, 8]])
@@ -708,6 +779,65 @@ def test_raf_batch_norm_train(shape, momentum, eps, device):
     check(m_b.grad, t_b.grad, rtol=1e-4, atol=1e-4)
 
 
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("layout", ["NCHW", "NHWC"])
+@pytest.mark.parametrize("with_z", [False, True])
+@with_seed(0)
+def test_raf_batch_norm_relu_train(layout, with_z, device):
+    # pylint: disable=too-many-arguments
+    momentum, eps = 0.1, 1e-5
+    shape = [4, 8, 6, 6]
+    stats_shape = [shape[1]]
+    m_x, t_x = randn_torch(shape, device=device, requires_grad=True)
+    m_z, t_z = randn_torch(shape, device=device, requires_grad=True)
+    m_m, t_m = randn_torch(stats_shape, device=device)
+    m_v, t_v = randn_torch(stats_shape, device=device, positive=True)
+    m_w, t_w = randn_torch(stats_shape, device=device, requires_grad=True)
+    m_b, t_b = randn_torch(stats_shape, device=device, requires_grad=True)
+
+    def to_layout(t_data):
+        return t_data.permute(0, 2, 3, 1).contiguous() if layout == "NHWC" else t_data
+
+    class TestModel(raf.Model):
+        def build(self, m_m, m_v):
+            self.m_m = m_m
+            self.m_v = m_v
+
+        @raf.model.trace
+        def forward(self, m_x, m_z, m_w, m_b):
+            result = raf._op.sym.batch_norm_relu_train(
+                m_x, self.m_m, self.m_v, m_w, m_b, m_z if with_z else None, momentum, eps, layout
+            )
+            trace_mutate_attr(self, "m_m", result[1])
+            trace_mutate_attr(self, "m_v", result[2])
+            return result[0]
+
+    m_x = raf.array(to_layout(t_x).detach().cpu().numpy(), device=device)
+    m_z = raf.array(to_layout(t_z).detach().cpu().numpy(), device=device)
+    m_x.requires_grad = True
+    m_z.requires_grad = True
+    model = TestModel(m_m, m_v)
+    m_y = model(m_x, m_z, m_w, m_b)
+    t_y = F.batch_norm(t_x, t_m, t_v, t_w, t_b, True, momentum, eps)
+    if with_z:
+        t_y = t_y + t_z
+    t_y = F.relu(t_y)
+    check(m_y, to_layout(t_y), rtol=1e-4, atol=1e-4)
+    check(m_m, t_m, rtol=1e-4, atol=1e-4)
+    check(m_v, t_v, rtol=1e-4, atol=1e-4)
+    # backward
+    m_dy, t_dy = randn_torch(shape, device=device)
+    m_dy = raf.array(to_layout(t_dy).cpu().numpy(), device=device)
+    m_y.backward(m_dy)
+    t_y.backward(t_dy)
+    check(m_x.grad, to_layout(t_x.grad), rtol=1e-4, atol=1e-4)
+    check(m_w.grad, t_w.grad, rtol=1e-4, atol=1e-4)
+    check(m_b.grad, t_b.grad, rtol=1e-4, atol=1e-4)
+    if with_z:
+        check(m_z.grad, to_layout(t_z.grad), rtol=1e-4, atol=1e-4)
+
+
 @with_dialect("tvm")
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("dtype", ["float32"])
@@ -40,5 +40,45 @@ def test_threefry_generate(device, shape):
             raise ValueError("Random state not updated.")
 
 
+def make_key(device):
+    seed = np.random.randint(0, high=sys.maxsize)
+    return raf.array(relay.random.threefry_key(seed).data.numpy(), dtype="uint64", device=device)
+
+
+class ThreefryDistribution(raf.Model):
+    def build(self, op, shape, **kwargs):
+        self.op = op
+        self.shape = shape
+        self.attrs = kwargs
+
+    @raf.model.trace
+    def forward(self, key):
+        return self.op(key, self.shape, **self.attrs)
+
+
+@pytest.mark.parametrize("device", ["cpu"])
+@pytest.mark.parametrize("shape", [(64, 64), (10001,)])
+def test_threefry_uniform(device, shape):
+    key = make_key(device)
+    model = ThreefryDistribution(raf.threefry_uniform, shape, low=-1.0, high=3.0)
+    n_y = run_vm_model(model, device, [key]).numpy()
+    assert n_y.shape == shape and n_y.dtype == "float32"
+    assert np.all(n_y >= -1.0) and np.all(n_y < 3.0)
+    np.testing.assert_allclose(np.mean(n_y), 1.0, atol=0.1)
+    # The same key gives the same numbers, and another key gives others.
+    np.testing.assert_equal(run_vm_model(model, device, [key]).numpy(), n_y)
+    assert not np.array_equal(run_vm_model(model, device, [make_key(device)]).numpy(), n_y)
+
+
+@pytest.mark.parametrize("device", ["cpu"])
+def test_threefry_normal(device):
+    key = make_key(device)
+    model = ThreefryDistribution(raf.threefry_normal, (256, 256), mean=2.0, stddev=0.5)
+    n_y = run_vm_model(model, device, [key]).numpy()
+    assert np.all(np.isfinite(n_y))
+    np.testing.assert_allclose(np.mean(n_y), 2.0, atol=0.02)
+    np.testing.assert_allclose(np.std(n_y), 0.5, atol=0.02)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,80 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=no-self-use, too-many-locals, protected-access
+import numpy as np
+import pytest
+import raf
+from raf.testing import check, get_testable_devices, randn, run_vm_model, with_dialect
+from raf.utils.sparse import CSRMatrix
+
+
+def random_csr(shape, density, index_dtype):
+    dense = np.random.randn(*shape).astype("float32")
+    dense *= np.random.rand(*shape) < density
+    # Keep an empty row to cover the rows without non-zeros.
+    dense[0] = 0
+    return CSRMatrix.from_dense(dense, index_dtype)
+
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("index_dtype", ["int32", "int64"])
+def test_csr_spmm(device, index_dtype):
+    class Spmm(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, indptr, indices, values, dense):
+            return raf.csr_spmm(indptr, indices, values, dense)
+
+    csr = random_csr((6, 5), 0.3, index_dtype)
+    n_a = csr.to_dense()
+    m_indptr, m_indices, m_values = csr.tensors(device)
+    m_values.requires_grad = True
+    m_x, n_x = randn((5, 3), device=device, requires_grad=True)
+    model = Spmm()
+    args = [m_indptr, m_indices, m_values, m_x]
+    m_y = model(*args)
+    check(m_y, n_a @ n_x, rtol=1e-4, atol=1e-4)
+    check(run_vm_model(model, device, args), n_a @ n_x, rtol=1e-4, atol=1e-4)
+    # The gradient of the values is only taken at the non-zeros.
+    m_dy, n_dy = randn(m_y.shape, device=device)
+    m_y.backward(m_dy)
+    rows = np.repeat(np.arange(6), np.diff(csr.indptr))
+    check(m_values.grad, (n_dy @ n_x.T)[rows, csr.indices], rtol=1e-4, atol=1e-4)
+    check(m_x.grad, n_a.T @ n_dy, rtol=1e-4, atol=1e-4)
+
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_csr_sddmm(device):
+    class Sddmm(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, indptr, indices, x1, x2):
+            return raf.csr_sddmm(indptr, indices, x1, x2)
+
+    csr = random_csr((6, 5), 0.3, "int32")
+    m_indptr, m_indices, _ = csr.tensors(device)
+    m_x1, n_x1 = randn((6, 4), device=device, requires_grad=True)
+    m_x2, n_x2 = randn((5, 4), device=device, requires_grad=True)
+    model = Sddmm()
+    args = [m_indptr, m_indices, m_x1, m_x2]
+    rows = np.repeat(np.arange(6), np.diff(csr.indptr))
+    n_y = (n_x1 @ n_x2.T)[rows, csr.indices]
+    m_y = model(*args)
+    check(m_y, n_y, rtol=1e-4, atol=1e-4)
+    check(run_vm_model(model, device, args), n_y, rtol=1e-4, atol=1e-4)
+    m_dy, n_dy = randn(m_y.shape, device=device)
+    m_y.backward(m_dy)
+    n_dy_dense = CSRMatrix(csr.indptr, csr.indices, n_dy, csr.shape).to_dense()
+    check(m_x1.grad, n_dy_dense @ n_x2, rtol=1e-4, atol=1e-4)
+    check(m_x2.grad, n_dy_dense.T @ n_x1, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -18,6 +18,7 @@ from raf.testing import (
     randn_torch,
     randint,
     check,
+    get_arr_addr,
     run_vm_model,
 )
 import tvm.topi.testing as npx  # pylint: disable=no-name-in-module
@@ -191,6 +192,28 @@ def test_transpose(shape, device):
     check(m_x.grad, n_x_grad)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize(
+    "op_attrs",
+    [
+        (raf._op.sym.transpose, {"axes": (2, 1, 0, 3)}),
+        (raf._op.sym.swap_axis, {"axis1": 0, "axis2": 2}),
+    ],
+)
+def test_transpose_view(op_attrs, device):
+    # Only the axes of size 1 are moved, so the output is a view of the input.
+    op, attrs = op_attrs
+    model = TestModel(op, **attrs)
+    m_x, n_x = randn((1, 4, 1, 3), device=device)
+    n_y = np.reshape(n_x, (1, 4, 1, 3))
+    m_y = model(m_x)
+    v_y = run_vm_model(model, device, [m_x])
+    check(m_y, n_y)
+    check(v_y, n_y)
+    assert get_arr_addr(m_y) == get_arr_addr(m_x)
+    assert get_arr_addr(v_y) == get_arr_addr(m_x)
+
+
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("axis", [0, 1])
 @pytest.mark.parametrize(
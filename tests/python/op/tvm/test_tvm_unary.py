@@ -172,6 +172,23 @@ def test_pos_unary_ops_without_grad(ops, shape, dtype, device):
     verify_unify_op(m_op, m_x, device, n_y)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_fast_math(device):
+    # pylint: disable=import-outside-toplevel
+    from raf.utils.fast_math import check_accuracy
+
+    errors = check_accuracy(shape=(4096,), device=device)
+    # The tanh approximation of GELU differs from the erf one by up to 4.7e-4 for GELU and 8.7e-4
+    # for its gradient.
+    abs_tols = {"raf.op.gelu": 1e-3, "raf.op.gelu_dx": 2e-3, "raf.op.exp": None}
+    for op_name, (abs_err, rel_err) in errors.items():
+        abs_tol = abs_tols.get(op_name, 1e-4)
+        if abs_tol is None:
+            assert rel_err < 1e-4, op_name
+        else:
+            assert abs_err < abs_tol, op_name
+
+
 # TODO(@icemelon9, @yzhliu): shape op doesn't work in the trace, so cannot test in VM.
 @pytest.mark.parametrize("device", get_testable_devices())
 def test_shape(device):
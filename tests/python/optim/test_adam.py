@@ -0,0 +1,223 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=unused-variable, too-many-locals, attribute-defined-outside-init
+import pytest
+import numpy as np
+import torch
+import torch.nn as nn
+import torch.nn.functional as F
+
+import raf
+from raf.model import Conv2d, Linear, BatchNorm
+from raf.testing import run_vm_model, one_hot_torch, randn_torch, t2m_param, check, with_seed
+
+
+class TorchTest(nn.Module):  # pylint: disable=abstract-method
+    def __init__(self, input_shape=28, num_classes=10):
+        super(TorchTest, self).__init__()
+        self.conv1 = nn.Conv2d(in_channels=3, out_channels=6, kernel_size=5, padding=2, bias=False)
+        self.bn1 = nn.BatchNorm2d(6)
+        self.linear1 = nn.Linear((input_shape // 2) ** 2 * 6, num_classes)
+
+    def forward(self, x, y_true):  # pylint: disable=arguments-differ
+        out = self.bn1(self.conv1(x))
+        out = torch.sigmoid(out)  # pylint: disable=no-member
+        out = F.avg_pool2d(out, (2, 2), (2, 2))
+        out = torch.flatten(out, 1)  # pylint: disable=no-member
+        out = self.linear1(out)
+        y_pred = F.log_softmax(out, dim=-1)
+        return F.nll_loss(y_pred, y_true)
+
+
+class RAFTest(raf.Model):
+    def build(self, input_shape=28, num_classes=10):
+        self.conv1 = Conv2d(in_channels=3, out_channels=6, kernel_size=5, padding=2, bias=False)
+        self.bn1 = BatchNorm(6)
+        self.linear1 = Linear((input_shape // 2) ** 2 * 6, num_classes)
+
+    @raf.model.trace
+    def forward(self, x, y_true):
+        out = self.bn1(self.conv1(x))
+        out = raf.sigmoid(out)
+        out = raf.avg_pool2d(out, (2, 2), (2, 2))
+        out = raf.batch_flatten(out)
+        out = self.linear1(out)
+        y_pred = raf.log_softmax(out)
+        return raf.nll_loss(y_true=y_true, y_pred=y_pred)
+
+
+class RAFSimpleTest(raf.Model):
+    def build(self, shape, dtype):
+        self.x = raf.array(np.random.randn(*shape).astype(dtype))
+
+    @raf.model.trace
+    def forward(self):
+        return raf.relu(self.x)
+
+
+def copy_params(m_model, t_model, device):
+    m_model.conv1.w = t2m_param(t_model.conv1.weight, device=device)
+    m_model.linear1.w = t2m_param(t_model.linear1.weight, device=device)
+    m_model.linear1.b = t2m_param(t_model.linear1.bias, device=device)
+    m_model.bn1.w = t2m_param(t_model.bn1.weight, device=device)
+    m_model.bn1.b = t2m_param(t_model.bn1.bias, device=device)
+    m_model.bn1.running_mean = t2m_param(t_model.bn1.running_mean, device=device)
+    m_model.bn1.running_var = t2m_param(t_model.bn1.running_var, device=device)
+
+
+def check_params(m_model, t_model, tol):
+    check(m_model.conv1.w, t_model.conv1.weight, rtol=tol, atol=tol)
+    check(m_model.linear1.w, t_model.linear1.weight, rtol=tol, atol=tol)
+    check(m_model.linear1.b, t_model.linear1.bias, rtol=tol, atol=tol)
+    check(m_model.bn1.w, t_model.bn1.weight, rtol=tol, atol=tol)
+    check(m_model.bn1.b, t_model.bn1.bias, rtol=tol, atol=tol)
+
+
+@with_seed(0)
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("adamw", [False, True])
+def test_adam(adamw):
+    device, shape, n_classes = "cuda", 28, 10
+    t_model = TorchTest(shape, n_classes)
+    t_model.to(device=device)
+    m_model = RAFTest(shape, n_classes)
+    m_model.to(device=device)
+    copy_params(m_model, t_model, device)
+    m_model.train_mode()
+    t_model.train()
+
+    if adamw:
+        m_optimizer = raf.optim.AdamW(m_model.state().values(), lr=0.01, weight_decay=0.1)
+        t_optimizer = torch.optim.AdamW(t_model.parameters(), lr=0.01, weight_decay=0.1)
+    else:
+        m_optimizer = raf.optim.Adam(m_model.state().values(), lr=0.01, weight_decay=0.1)
+        t_optimizer = torch.optim.Adam(t_model.parameters(), lr=0.01, weight_decay=0.1)
+    for i in range(3):
+        t_optimizer.zero_grad()
+        m_x, t_x = randn_torch([1, 3, shape, shape], requires_grad=True, device=device)
+        m_y, t_y = one_hot_torch(size=1, num_classes=n_classes, device=device)
+        m_loss = m_model(m_x, m_y)
+        t_loss = t_model(t_x, t_y)
+        m_loss.backward()
+        t_loss.backward()
+        m_optimizer.step()
+        t_optimizer.step()
+        check_params(m_model, t_model, 1e-3)
+
+
+@with_seed(0)
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("adamw", [False, True])
+def test_traced_adam(adamw):
+    device, shape, n_classes = "cuda", 28, 10
+    t_model = TorchTest(shape, n_classes)
+    t_model.to(device=device)
+    m_model = RAFTest(shape, n_classes)
+    m_model.to(device=device)
+    copy_params(m_model, t_model, device)
+    m_model.train_mode()
+    t_model.train()
+
+    m_optimizer = raf.optim.adam.with_adam(lr=0.01, weight_decay=0.1, adamw=adamw)(m_model)
+    t_optim = torch.optim.AdamW if adamw else torch.optim.Adam
+    t_optimizer = t_optim(t_model.parameters(), lr=0.01, weight_decay=0.1)
+    for i in range(4):
+        m_dy, t_dy = randn_torch((), std=0.0, mean=1.0, device=device, requires_grad=False)
+        m_x, t_x = randn_torch([1, 3, shape, shape], requires_grad=True, device=device)
+        m_y, t_y = one_hot_torch(size=1, num_classes=n_classes, device=device)
+        m_loss = run_vm_model(m_optimizer, device, [m_dy, m_x, m_y])
+        t_optimizer.zero_grad()
+        t_loss = t_model(t_x, t_y)
+        t_loss.backward(t_dy)
+        t_optimizer.step()
+        check_params(m_model, t_model, 1e-3)
+
+    # All parameters are updated by a single kernel.
+    record = m_optimizer._internal(m_dy, m_x, m_y)
+    text = raf.ir.AsText(record.mod)
+    assert text.count("raf.op.multi_tensor_adam") == 1, text
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_traced_adam_simple(dtype):
+    device, shape = "cuda", (4, 4)
+    m_model = RAFSimpleTest(shape, dtype)
+    m_model.to(device=device)
+    t_x = torch.tensor(m_model.x.numpy().astype("float32"), device=device, requires_grad=True)
+    m_model.train_mode()
+    m_optimizer = raf.optim.adam.with_adam(lr=0.1, adamw=True, weight_decay=0.01)(m_model)
+    t_optimizer = torch.optim.AdamW([t_x], lr=0.1, weight_decay=0.01)
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    for i in range(4):
+        m_dy, t_dy = randn_torch(shape, device=device, dtype=dtype, requires_grad=False)
+        run_vm_model(m_optimizer, device, [m_dy])
+        t_optimizer.zero_grad()
+        torch.relu(t_x).backward(t_dy.float())
+        t_optimizer.step()
+        assert m_model.x.dtype == dtype
+        check(m_model.x, t_x, rtol=tol, atol=tol)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_traced_adam_clip_and_skip(dtype):
+    device, shape, max_norm = "cuda", (4, 4), 0.5
+    m_model = RAFSimpleTest(shape, dtype)
+    m_model.to(device=device)
+    t_x = torch.tensor(m_model.x.numpy().astype("float32"), device=device, requires_grad=True)
+    m_model.train_mode()
+    m_optimizer = raf.optim.adam.with_adam(lr=0.1, max_grad_norm=max_norm)(m_model)
+    t_optimizer = torch.optim.Adam([t_x], lr=0.1)
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    for i in range(4):
+        m_dy, t_dy = randn_torch(shape, device=device, dtype=dtype, requires_grad=False)
+        if i == 1:
+            # The step with inf gradients is skipped and not counted.
+            m_dy = raf.array(np.full(shape, np.inf, dtype=dtype), device=device)
+            run_vm_model(m_optimizer, device, [m_dy])
+            check(m_model.x, t_x, rtol=tol, atol=tol)
+            continue
+        run_vm_model(m_optimizer, device, [m_dy])
+        t_optimizer.zero_grad()
+        torch.relu(t_x).backward(t_dy.float())
+        torch.nn.utils.clip_grad_norm_([t_x], max_norm)
+        t_optimizer.step()
+        check(m_model.x, t_x, rtol=tol, atol=tol)
+    check(m_optimizer.step, 3.0)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_traced_adam_loss_scale(dtype):
+    device, shape = "cuda", (4, 4)
+    m_model = RAFSimpleTest(shape, dtype)
+    m_model.to(device=device)
+    t_x = torch.tensor(m_model.x.numpy().astype("float32"), device=device, requires_grad=True)
+    m_model.train_mode()
+    scaler = raf.amp.DynamicLossScaler(init_scale=1024.0, growth_interval=2)
+    m_optimizer = raf.optim.adam.with_adam(lr=0.1, loss_scaler=scaler)(m_model)
+    t_optimizer = torch.optim.Adam([t_x], lr=0.1)
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    # The scale is halved by the overflow at step 1, and doubled after steps 2 and 3.
+    expected_scales = [1024.0, 512.0, 512.0, 1024.0]
+    for i in range(4):
+        m_dy, t_dy = randn_torch(shape, device=device, dtype=dtype, requires_grad=False)
+        if i == 1:
+            m_dy = raf.array(np.full(shape, np.inf, dtype=dtype), device=device)
+            run_vm_model(m_optimizer, device, [m_dy])
+        else:
+            # The gradients are unscaled by the kernel, so the updates are not scaled.
+            run_vm_model(m_optimizer, device, [m_dy])
+            t_optimizer.zero_grad()
+            torch.relu(t_x).backward(t_dy.float())
+            t_optimizer.step()
+        check(m_model.x, t_x, rtol=tol, atol=tol)
+        check(m_optimizer.loss_scale, expected_scales[i])
+    check(m_optimizer.good_steps, 0.0)
+    check(m_optimizer.step, 3.0)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -219,6 +219,9 @@ def test_state_partition(mock_get_config, mock_get_comm):
             self.enable_data_parallel = True
             self.zero_opt_level = 2
             self.group_bucket_size = 50000000
+            self.zero_defer_allgather = False
+            self.zero_offload = False
+            self.zero_flat_buffer = False
 
     mock_get_config.return_value = MockConfig()
 
@@ -0,0 +1,54 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import pytest
+
+from raf.optim.pipeline import get_1f1b_schedule
+
+
+@pytest.mark.parametrize("n_stages", [1, 2, 4])
+@pytest.mark.parametrize("n_micro_batches", [1, 3, 8])
+def test_1f1b_schedule(n_stages, n_micro_batches):
+    schedules = [get_1f1b_schedule(s, n_stages, n_micro_batches) for s in range(n_stages)]
+    # Each stage runs the forward and backward of each micro-batch once.
+    for schedule in schedules:
+        for event in ["forward", "backward"]:
+            done = sorted(idx for e, idx in schedule if e == event)
+            assert done == list(range(n_micro_batches))
+
+    # The first stage keeps at most n_stages micro-batches in flight.
+    n_flight, max_flight = 0, 0
+    for event, _ in schedules[0]:
+        n_flight += {"forward": 1, "backward": -1}.get(event, 0)
+        max_flight = max(max_flight, n_flight)
+    assert max_flight == min(n_stages, n_micro_batches)
+
+    # Simulate the blocking send/recv, which completes only when the peer issues the matching one.
+    peer_event = {
+        "send_act": (1, "recv_act"),
+        "recv_act": (-1, "send_act"),
+        "send_grad": (-1, "recv_grad"),
+        "recv_grad": (1, "send_grad"),
+    }
+    pcs = [0] * n_stages
+    while any(pc < len(schedule) for pc, schedule in zip(pcs, schedules)):
+        progress = False
+        for stage in range(n_stages):
+            if pcs[stage] == len(schedules[stage]):
+                continue
+            event, idx = schedules[stage][pcs[stage]]
+            if event not in peer_event:
+                pcs[stage] += 1
+                progress = True
+                continue
+            offset, expected = peer_event[event]
+            peer = stage + offset
+            if pcs[peer] < len(schedules[peer]) and schedules[peer][pcs[peer]] == (expected, idx):
+                pcs[stage] += 1
+                pcs[peer] += 1
+                progress = True
+        assert progress, "Deadlock at %s" % [s[pc] for s, pc in zip(schedules, pcs)]
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
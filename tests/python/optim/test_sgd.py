@@ -173,7 +173,8 @@ def test_traced_sgd_simple(device):
 
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize("config", [(10, 32, 10)])
-def test_traced_sgd(config):
+@pytest.mark.parametrize("multi_tensor", [False, True])
+def test_traced_sgd(config, multi_tensor):
     # pylint: disable=too-many-locals
     device = "cuda"
     t_model = TorchTest(config[1], config[2])
@@ -191,7 +192,9 @@ def test_traced_sgd(config):
     batch_size = config[0]
     m_model.train_mode()
     t_model.train()
-    m_optimizer = raf.optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(m_model)
+    m_optimizer = raf.optim.sgd.with_sgd(
+        learning_rate=0.1, momentum=0.01, multi_tensor=multi_tensor
+    )(m_model)
     t_optimizer = torch.optim.SGD(t_model.parameters(), lr=0.1, momentum=0.01)
 
     for i in range(batch_size):
@@ -254,6 +257,9 @@ def test_state_partition(mock_get_config, mock_get_comm):
             self.enable_data_parallel = True
             self.zero_opt_level = 2
             self.group_bucket_size = 50000000
+            self.zero_defer_allgather = False
+            self.zero_offload = False
+            self.zero_flat_buffer = False
 
     mock_get_config.return_value = MockConfig()
 
@@ -0,0 +1,52 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+import pytest
+import numpy as np
+
+import raf
+from raf._ffi.pass_ import AccumulateGradient, AutoDiff, InferType
+from raf.ir import RAFSequential
+from raf.testing import check, randn, get_testable_devices
+
+
+class Model(raf.Model):
+    def build(self, w):
+        self.w = w
+
+    @raf.model.trace
+    def forward(self, x):
+        return raf.mean(raf.tanh(raf.matmul(x, self.w)))
+
+
+def test_accumulate_gradient():
+    x = randn((4, 3))[0]
+    w = randn((3, 2), requires_grad=True)[0]
+    model = Model(w)
+    record = model._internal(x)
+    passes = [InferType(), AutoDiff(record.requires_grads)]
+    ref_func = RAFSequential(passes)(record.mod)["main"]
+    func = RAFSequential(passes + [AccumulateGradient([False, True])])(record.mod)["main"]
+    # The accumulated gradient of w is an extra parameter, and it is added to the local gradient.
+    assert len(func.params) == len(ref_func.params) + 1
+    num_add = raf.ir.AsText(ref_func).count("raf.op.add(")
+    assert raf.ir.AsText(func).count("raf.op.add(") == num_add + 1
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_grad_accumulation_steps(device):
+    x = randn((4, 3), device=device, requires_grad=True)[0]
+    w = randn((3, 2), device=device, requires_grad=True)[0]
+    dy = raf.array(np.ones((), dtype="float32"), device=device)
+    model = Model(w)
+    ref_y, ref_dxs = raf.optim.optim.with_autodiff(model)(dy, x)
+    with raf.ir.PassContext(config={"raf.optim.grad_accumulation_steps": 2}):
+        y, dxs = raf.optim.optim.with_autodiff(Model(w))(dy, x)
+    check(y, ref_y, rtol=1e-5, atol=1e-5)
+    for dx, ref_dx in zip(dxs, ref_dxs):
+        check(dx, ref_dx, rtol=1e-5, atol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -131,6 +131,31 @@ def test_tuple_from_op():
         verify_cast_num(model, args, 2)
 
 
+@pytest.mark.parametrize("amp_dtype", ["float16", "bfloat16"])
+def test_dtype_policy(amp_dtype):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            y = raf.matmul(x, w)
+            z = raf.exp(y)
+            return z
+
+    model = Model()
+    m_x, _ = randn((4, 4), requires_grad=False)
+    m_w, _ = randn((4, 4), requires_grad=True)
+    args = [m_x, m_w]
+
+    with raf.ir.PassContext(config={"raf.amp.dtype": amp_dtype}):
+        # Cast 2 inputs. exp runs in float32 for float16, so the output of matmul is cast back.
+        verify_cast_num(model, args, 3 if amp_dtype == "float16" else 2)
+        amp_model = raf.amp.autocast(model, args)
+        ret_type = amp_model._internal(*args).mod["main"].checked_type.ret_type
+        assert ret_type.dtype == ("float32" if amp_dtype == "float16" else "bfloat16")
+
+
 @pytest.mark.parametrize("out_dtype", ["float16", "float32"])
 def test_existing_cast_with_always_op(out_dtype):
     xshape = (1, 3, 224, 224)
@@ -343,6 +368,50 @@ def test_cast_reuse():
     verify_cast_num(model, [m_x], 5)
 
 
+class GroupCastModel(raf.Model):
+    def build(self):
+        self.w1, _ = randn((32, 32), requires_grad=True)
+        self.w2, _ = randn((32, 32), requires_grad=True)
+
+    @raf.model.trace
+    def forward(self, x):
+        out1 = raf.matmul(x, self.w1)
+        out2 = raf.matmul(out1, self.w2)
+        out3 = raf.matmul(out1, self.w1)  # Should reuse the cast of w1.
+        return raf.add(out2, out3)
+
+
+def test_group_cast():
+    model = GroupCastModel()
+    model.infer_mode()
+    m_x, _ = randn((16, 32), requires_grad=False)
+    args = [m_x]
+
+    with raf.ir.PassContext(config={"raf.amp.group_cast": True}):
+        amp_model = raf.amp.autocast(model, args)
+    mod = amp_model._internal(*args).mod
+    text = AsText(raf._ffi.pass_.InferType()(mod)["main"])
+    # The casts of x, w1, and w2 are batched into one group_cast at the beginning.
+    assert text.count("raf.op.group_cast(") == 1, text
+    assert text.count("raf.op.cast(") == 0, text
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_group_cast_correctness():
+    device = "cuda"
+    model = GroupCastModel()
+    model.infer_mode()
+    model.to(device=device)
+    m_x, _ = randn((16, 32), requires_grad=False, device=device)
+    args = [m_x]
+
+    ref_outs = run_vm_model(raf.amp.autocast(model, args), device, args)
+    with raf.ir.PassContext(config={"raf.amp.group_cast": True}):
+        amp_model = raf.amp.autocast(model, args)
+    outs = run_vm_model(amp_model, device, args)
+    check(ref_outs, outs, rtol=1e-3, atol=1e-3)
+
+
 @pytest.mark.parametrize(
     "params",
     [
@@ -0,0 +1,50 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import pytest
+import raf
+from raf._ffi.pass_ import CompressActivation, InferType
+from raf.testing import randn
+
+
+class Model(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x):
+        a_1 = raf.relu(x)
+        a_2 = raf.exp(a_1)
+        a_3 = raf.exp(a_2)
+        a_4 = raf.relu_dx(x, a_1, a_3)
+        # The output of exp is used by its backward right away, so it is not compressed.
+        a_5 = raf.exp(a_4)
+        a_6 = raf.relu_dx(a_4, a_5, a_5)
+        return a_6
+
+
+@pytest.mark.parametrize("dtype", ["none", "float16", "bfloat16"])
+def test_compress_activation(dtype):
+    m_x, _ = randn((4, 8), dtype="float32")
+    mod = InferType()(Model()._internal(m_x).mod)
+    ref_ret_type = mod["main"].checked_type.ret_type
+    with raf.ir.PassContext(config={"raf.activation_compression": dtype}):
+        mod = CompressActivation()(mod)
+    text = raf.ir.AsText(mod["main"])
+    if dtype == "none":
+        assert "raf.op.cast(" not in text, text
+        return
+    # Only the output of the first relu is saved across the forward ops, so it is compressed
+    # after its last forward use and decompressed before the first relu_dx.
+    assert text.count("raf.op.cast(") == 2, text
+    assert text.count(f'"{dtype}"') == 1, text
+    lines = [line for line in text.split("\n") if "raf.op." in line]
+    ops = [line.split("raf.op.")[1].split("(")[0] for line in lines]
+    assert ops == ["relu", "exp", "cast", "exp", "cast", "relu_dx", "exp", "relu_dx"], text
+    mod = InferType()(mod)
+    assert mod["main"].checked_type.ret_type == ref_ret_type
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,60 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+import pytest
+import raf
+from raf._core.executor import VMExecutor
+from raf.testing import check, randn, get_testable_devices
+
+
+def count_ops(mod, op_name):
+    text = raf.ir.AsText(mod["main"])
+    return text.count(op_name + "(")
+
+
+class Model(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x, w1, w2, scale, bias, mean, var):
+        a_1 = raf.relu(raf.conv2d(x, w1, padding=1))
+        a_2 = raf.conv2d(a_1, w2, padding=1)
+        a_3 = raf.relu(raf.add(a_2, a_1))
+        a_4 = raf.max_pool2d(a_3, kernel=2, stride=2)
+        # batch_norm has no layout, so the region ends here.
+        return raf.batch_norm_infer(a_4, mean, var, scale, bias)
+
+
+def gen_args(device="cpu"):
+    x = randn((2, 8, 16, 16), device=device)[0]
+    w1 = randn((8, 8, 3, 3), device=device)[0]
+    w2 = randn((8, 8, 3, 3), device=device)[0]
+    vecs = [randn((8,), device=device, positive=True)[0] for _ in range(4)]
+    return [x, w1, w2] + vecs
+
+
+def test_convert_layout():
+    model = Model()
+    mod = model._internal(*gen_args()).mod
+    mod = raf._ffi.pass_.ConvertLayout()(mod)
+    text = raf.ir.AsText(mod["main"])
+    assert text.count('"NHWC"') == 2 * 2 + 1
+    # The input and the two weights come in, and the pooled tensor goes to batch_norm.
+    assert count_ops(mod, "raf.op.transpose") == 4
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_convert_layout_vm(device):
+    model = Model()
+    args = gen_args(device)
+    ref = model(*args)
+    mod = model._internal(*args).mod
+    with raf.ir.PassContext(config={"raf.vm.optimize.convert_layout": True}):
+        out = VMExecutor(mod, device).make_executor()(*args)
+    check(out, ref, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -217,5 +217,250 @@ def test_dp(config):
     dcfg.enable_data_parallel = False
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("compression", ["float16", "bfloat16"])
+def test_dp_gradient_compression(compression):
+    dcfg = dist.get_config()
+    dcfg.enable_data_parallel = True
+    dcfg.gradient_compression = compression
+    comm = dist.get_communicator()
+    device = f"cuda({comm.local_rank})"
+    const, _ = randn([2, 2], device=device)
+
+    class TestModel(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            self.c = const
+
+        # pylint: enable=attribute-defined-outside-init
+
+        @raf.model.trace
+        def forward(self, x, y_true):
+            y_pred = raf.matmul(x, self.c)
+            loss = raf.nll_loss(y_true=y_true, y_pred=y_pred)
+            return loss
+
+    m_model = TestModel()
+    m_model.to(device=device)
+    m_model.train_mode()
+
+    m_x, _ = randn([2, 2], device=device, requires_grad=True)
+    m_y = one_hot(batch_size=2, num_classes=2, device=device)
+    m_x.requires_grad = True
+    m_y.requires_grad = True
+
+    record = m_model._internal(m_x, m_y)
+    passes = [InferType(), AutoDiff(record.requires_grads), InferType(), AutoDataParallel()]
+    text = RAFSequential(passes)(record.mod)["main"].astext()
+    # Each float32 gradient is cast to the compressed dtype before the allreduce and cast back
+    # after it, while the int64 gradient of y_true is communicated as is.
+    num_allreduce = text.count("raf.op._allreduce(")
+    assert num_allreduce == 3
+    assert text.count('str"%s"' % compression) == num_allreduce - 1
+    assert text.count('str"float32"') == num_allreduce - 1
+    dcfg.gradient_compression = "none"
+    dcfg.enable_data_parallel = False
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_dp_local_grads():
+    dcfg = dist.get_config()
+    dcfg.enable_data_parallel = True
+    comm = dist.get_communicator()
+    device = f"cuda({comm.local_rank})"
+    const, _ = randn([2, 2], device=device)
+
+    class TestModel(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            self.c = const
+
+        # pylint: enable=attribute-defined-outside-init
+
+        @raf.model.trace
+        def forward(self, x, y_true):
+            y_pred = raf.matmul(x, self.c)
+            loss = raf.nll_loss(y_true=y_true, y_pred=y_pred)
+            return loss
+
+    m_model = TestModel()
+    m_model.to(device=device)
+    m_model.train_mode()
+
+    m_x, _ = randn([2, 2], device=device, requires_grad=True)
+    m_y = one_hot(batch_size=2, num_classes=2, device=device)
+    m_y.requires_grad = True
+
+    record = m_model._internal(m_x, m_y)
+    # The gradient of x is local to the rank, e.g., as if x were a shard of a parameter.
+    local_grads = [True, False, False]
+    passes = [InferType(), AutoDiff(record.requires_grads), InferType()]
+    text = RAFSequential(passes + [AutoDataParallel()])(record.mod)["main"].astext()
+    assert text.count("raf.op._allreduce(") == 3
+    text = RAFSequential(passes + [AutoDataParallel(local_grads)])(record.mod)["main"].astext()
+    assert text.count("raf.op._allreduce(") == 2
+    dcfg.enable_data_parallel = False
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_dp_tune_bucket_size():
+    from raf._ffi.distributed import GroupBucketSize
+    from raf.distributed import comm_cost
+
+    dcfg = dist.get_config()
+    dcfg.enable_data_parallel = True
+    bucket_size = dcfg.group_bucket_size
+    comm = dist.get_communicator()
+    device = f"cuda({comm.local_rank})"
+    const, _ = randn([4, 4], device=device)
+
+    class TestModel(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            self.c = const
+
+        # pylint: enable=attribute-defined-outside-init
+
+        @raf.model.trace
+        def forward(self, x, y_true):
+            y_pred = raf.matmul(x, self.c)
+            loss = raf.nll_loss(y_true=y_true, y_pred=y_pred)
+            return loss
+
+    m_model = TestModel()
+    m_model.to(device=device)
+    m_model.train_mode()
+
+    m_x, _ = randn([4, 4], device=device, requires_grad=True)
+    m_y = one_hot(batch_size=4, num_classes=4, device=device)
+    m_y.requires_grad = True
+
+    record = m_model._internal(m_x, m_y)
+    passes = [InferType(), AutoDiff(record.requires_grads), InferType(), AutoDataParallel()]
+    try:
+        GroupBucketSize(1)
+        # The fixed latency of allreduce dominates, so all 36 gradient elements go into one bucket.
+        comm_cost.clear_comm_cost()
+        comm_cost.set_comm_cost("raf.op._allreduce", "global", 1e6, 1e-3)
+        config = {"raf.data_parallel.tune_bucket_size": True}
+        with raf.Device(device), tvm.transform.PassContext(config=config):
+            RAFSequential(passes)(record.mod)
+        assert dcfg.group_bucket_size >= 36
+    finally:
+        comm_cost.clear_comm_cost()
+        dcfg.enable_allreduce_bucketing = False
+        GroupBucketSize(bucket_size)
+        dcfg.enable_data_parallel = False
+
+
+def test_dp_search_bucket_size():
+    search = raf._ffi.pass_.data_parallel.SearchBucketSize
+    sizes, nbytes = [4, 4, 4, 4], [16, 16, 16, 16]
+    ready_time = [1.0, 2.0, 3.0, 4.0]
+    # Free communication exposes nothing with any bucket size, and the largest one wins the tie.
+    assert search(ready_time, 4.0, sizes, nbytes, 0.0, 0.0, 0.0) == 16
+    # The fixed latency dominates, so all the gradients go into one bucket.
+    assert search(ready_time, 4.0, sizes, nbytes, 10.0, 0.0, 0.0) == 16
+
+    # The first gradient is ready long before the second one, so its allreduce is overlapped with
+    # the computation if it is launched alone. Bucket sizes 1, 2, 4 and 8 tie, and 8 is taken.
+    assert search([0.0, 10.0], 10.0, [8, 8], [32, 32], 1.0, 1.0, 0.0) == 8
+    assert search([0.0, 10.0], 10.0, [8, 8], [32, 32], 1.0, 0.0, 0.25) == 8
+
+    # No gradient, or the ready time does not match the gradients.
+    assert search([], 10.0, [], [], 1.0, 1.0, 0.0) == 0
+    assert search([0.0], 10.0, [8, 8], [32, 32], 1.0, 1.0, 0.0) == 0
+
+
+def test_dp_fit_allreduce_cost():
+    fit = raf._ffi.pass_.data_parallel.FitAllreduceCost
+    alpha, beta = [x.value for x in fit([1, 2, 3, 4], [7.0, 9.0, 11.0, 13.0])]
+    assert alpha == pytest.approx(5.0)
+    assert beta == pytest.approx(2.0)
+    # The same size everywhere leaves only the mean latency.
+    alpha, beta = [x.value for x in fit([8, 8], [4.0, 6.0])]
+    assert alpha == pytest.approx(5.0)
+    assert beta == 0.0
+
+
+def test_dp_search_bucket_size_from_profile():
+    search = raf._ffi.pass_.data_parallel.SearchBucketSizeFromProfile
+    # Accumulated over 2 iterations: the allreduce of the first gradient takes 5, the computation
+    # takes 10, and the allreduce of the second gradient takes 13, i.e., alpha = 1 and beta = 1.
+    op_durations = [-10, 20, -26]
+    sizes, nbytes = [4, 12], [16, 48]
+    # Launching the first gradient alone hides it behind the computation.
+    assert search(op_durations, 2, sizes, nbytes, []) == 4
+    # Free communication with the calibrated cost.
+    assert search(op_durations, 2, sizes, nbytes, [0.0, 0.0, 0.0]) == 16
+    # The profiled allreduces cannot be matched with the gradients.
+    assert search(op_durations, 2, [4, 4, 8], [16, 16, 32], []) == 0
+
+
+def test_dp_bucket_size_dynamic_shape():
+    get_grad_sizes = raf._ffi.pass_.data_parallel.GetGradSizes
+    search = raf._ffi.pass_.data_parallel.SearchBucketSizeFromProfile
+
+    def grad_sizes(types, compress_dtype="none"):
+        sizes, nbytes = get_grad_sizes(types, compress_dtype)
+        return [x.value for x in sizes], [x.value for x in nbytes]
+
+    static = [relay.TensorType((2, 3), "float32"), relay.TensorType((4,), "float32")]
+    assert grad_sizes(static) == ([6, 4], [24, 16])
+    assert grad_sizes(static, "float16") == ([6, 4], [12, 8])
+
+    # A gradient with a dynamic shape leaves no sizes, so the tuning is skipped.
+    dynamic = [relay.TensorType((2, 3), "float32"), relay.TensorType((relay.Any(),), "float32")]
+    sizes, nbytes = grad_sizes(dynamic)
+    assert sizes == [] and nbytes == []
+    assert search([-10, 20, -26], 2, sizes, nbytes, []) == 0
+    assert search([-10, 20, -26], 2, sizes, nbytes, [0.0, 0.0, 0.0]) == 0
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_dp_sparse_embedding_grad():
+    dcfg = dist.get_config()
+    dcfg.enable_data_parallel = True
+    comm = dist.get_communicator()
+    device = f"cuda({comm.local_rank})"
+    table, _ = randn([1000, 16], device=device)
+    const, _ = randn([16, 4], device=device)
+
+    class TestModel(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            self.table = table
+            self.c = const
+
+        # pylint: enable=attribute-defined-outside-init
+
+        @raf.model.trace
+        def forward(self, indices, y_true):
+            y_pred = raf.matmul(raf.embedding(self.table, indices), self.c)
+            loss = raf.nll_loss(y_true=y_true, y_pred=y_pred)
+            return loss
+
+    m_model = TestModel()
+    m_model.to(device=device)
+    m_model.train_mode()
+
+    m_indices = one_hot(batch_size=8, num_classes=1000, device=device)
+    m_y = one_hot(batch_size=8, num_classes=4, device=device)
+
+    record = m_model._internal(m_indices, m_y)
+    passes = [InferType(), AutoDiff(record.requires_grads), InferType(), AutoDataParallel()]
+    text = RAFSequential(passes)(record.mod)["main"].astext()
+    # The 8 rows of the embedding gradient are allgathered instead of allreducing 1000 rows.
+    assert text.count("raf.op._allreduce(") == 1
+    assert text.count("raf.op.embedding_dx_sparse(") == 1
+    assert text.count("raf.op._allgather(") == 2
+    config = {"raf.data_parallel.sparse_embedding_grad": False}
+    with tvm.transform.PassContext(config=config):
+        text = RAFSequential(passes)(record.mod)["main"].astext()
+    assert text.count("raf.op._allreduce(") == 2
+    assert "raf.op._allgather(" not in text
+    dcfg.enable_data_parallel = False
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -599,5 +599,85 @@ def test_fifo_schedule(model_class, shape):
     assert equal_to_any, "\n".join(err_msgs)
 
 
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_bucket_schedule():
+    class BucketModel(raf.Model):
+        # atan -> atan -> atan
+        #   |       |       |
+        # allreduce allreduce allreduce
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            a0 = raf.atan(x)
+            a1 = raf.atan(a0)
+            a2 = raf.atan(a1)
+            r0 = raf.allreduce(a0)
+            r1 = raf.allreduce(a1)
+            r2 = raf.allreduce(a2)
+            return raf.concatenate([r0, r1, r2])
+
+    shape = (64, 128)
+    model = BucketModel()
+    x, _ = randn(shape)
+    mod = model._internal(x).mod
+
+    dcfg = raf.distributed.get_config()
+    bucket_size = dcfg.group_bucket_size
+    dcfg.enable_allreduce_bucketing = True
+    # The first two allreduces fill up a bucket, and the last one is launched alone.
+    raf._ffi.distributed.GroupBucketSize(shape[0] * shape[1] * 2)
+    try:
+        mod = RAFSequential([ToGraphNormalForm(), DataParallelSchedule()])(mod)
+    finally:
+        dcfg.enable_allreduce_bucketing = False
+        raf._ffi.distributed.GroupBucketSize(bucket_size)
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op._allreduce(") == 2, text
+    mod = raf._ffi.pass_.InferType()(mod)
+    assert mod["main"].checked_type.ret_type.concrete_shape == (shape[0] * 3, shape[1])
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_zero_pipeline_schedule():
+    class ZeroModel(raf.Model):
+        # atan -> reduce -> update -> gather
+        #   |
+        # atan -> reduce -> update -> gather
+        def build(self, shape):
+            self.c, _ = randn(shape, device="cuda")
+
+        @raf.model.trace
+        def forward(self, x):
+            a0 = raf.atan(x)
+            a1 = raf.atan(a0)
+            r0 = raf.allreduce(a0)
+            r1 = raf.allreduce(a1)
+            u0 = raf.multiply(r0, self.c)
+            u1 = raf.multiply(r1, self.c)
+            g0 = raf.allgather(u0, axis=0)
+            g1 = raf.allgather(u1, axis=0)
+            return raf.concatenate([g0, g1])
+
+    shape = (64, 128)
+    model = ZeroModel(shape)
+    x, _ = randn(shape)
+    mod = model._internal(x).mod
+
+    dcfg = raf.distributed.get_config()
+    dcfg.zero_opt_level = 1
+    try:
+        mod = RAFSequential([ToGraphNormalForm(), DataParallelSchedule()])(mod)
+    finally:
+        dcfg.zero_opt_level = 0
+    text = raf.ir.AsText(mod["main"])
+    # The first allgather is launched before the second update, so they overlap.
+    first_gather = text.index("raf.op._allgather(")
+    second_update = text.rindex("raf.op.multiply(")
+    assert first_gather < second_update, text
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,75 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import pytest
+import raf
+from raf._core.ndarray import array
+from raf._ffi.pass_ import DedupConstant
+from raf.ir import ScopeBuilder
+from raf.testing import randn
+
+import tvm
+from tvm import relay
+
+
+def test_dedup_constant():
+    shape = (4, 4)
+    matmul_op = raf._ffi.op.GetOp("raf.op.matmul")
+    add_op = raf._ffi.op.GetOp("raf.op.add")
+    null = raf.ir.const(None)
+
+    _, n_w = randn(shape)
+    _, n_b = randn(shape)
+    data_x = raf.ir.var("x", shape=shape, dtype="float32")
+    # The tied weights are different tensors with the same content.
+    const_w1 = raf.ir.const(array(n_w))
+    const_w2 = raf.ir.const(array(n_w.copy()))
+    # The tensors with the same shape but different content are kept.
+    const_b = raf.ir.const(array(n_b))
+    # The tensors with the same content but a different shape are kept.
+    const_w3 = raf.ir.const(array(n_w.reshape((2, 8)).copy()))
+
+    sb = ScopeBuilder()
+    a_1 = sb.let("a1", relay.Call(matmul_op, [data_x, const_w1]))
+    a_2 = sb.let("a2", relay.Call(matmul_op, [data_x, const_w2]))
+    a_3 = sb.let("a3", relay.Call(add_op, [a_1, a_2, null, null]))
+    a_4 = sb.let("a4", relay.Call(add_op, [a_3, const_b, null, null]))
+    a_5 = sb.let("a5", relay.Call(add_op, [const_w3, const_w3, null, null]))
+    a_6 = sb.let("a6", relay.Tuple([a_4, a_5]))
+    sb.ret(a_6)
+    func = relay.Function([data_x], sb.get())
+    mod = tvm.IRModule.from_expr(func)
+    mod = DedupConstant()(mod)
+
+    consts = []
+    body = mod["main"].body
+    while isinstance(body, relay.Let):
+        if isinstance(body.value, relay.Call):
+            for arg in body.value.args:
+                if isinstance(arg, relay.Constant) and not arg.same_as(null):
+                    consts.append(arg)
+        body = body.body
+    w_1, w_2, b, w_3 = consts[:4]
+    assert w_1.same_as(w_2)
+    assert not w_1.same_as(b)
+    assert not w_1.same_as(w_3)
+
+
+def test_dedup_constant_unchanged():
+    shape = (4, 4)
+    add_op = raf._ffi.op.GetOp("raf.op.add")
+    null = raf.ir.const(None)
+
+    _, n_a = randn(shape)
+    _, n_b = randn(shape)
+    data_x = raf.ir.var("x", shape=shape, dtype="float32")
+    y = relay.Call(add_op, [data_x, raf.ir.const(array(n_a)), null, null])
+    y = relay.Call(add_op, [y, raf.ir.const(array(n_b)), null, null])
+    mod = tvm.IRModule.from_expr(relay.Function([data_x], y))
+    new_mod = DedupConstant()(mod)
+    assert tvm.ir.structural_equal(mod["main"], new_mod["main"])
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
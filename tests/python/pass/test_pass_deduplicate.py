@@ -69,8 +69,23 @@ def test_simple_no_dedeplicate2():
     assert tvm.ir.structural_equal(mod, new_mod)
 
 
+def test_fingerprint_dedeplicate():
+    x = raf.ir.var("x")
+    y = x
+    for _ in range(3):
+        y = raf.ir.op.tanh(raf.ir.op.relu(y))
+    f = relay.Function([x], y)
+    mod = IRModule.from_expr(f)
+    with raf.ir.PassContext(config={"raf.deduplicate.fingerprint_depth": 1}):
+        new_mod = raf._ffi.pass_.Deduplicate(0, False, True, None)(mod)
+    text = raf.ir.AsText(new_mod)
+    assert " = fn" in text
+    assert text.count("relu") == 2 and text.count("tanh") == 2
+
+
 @pytest.mark.parametrize("must_dominate", [True, False])
-def test_resnet_infer(must_dominate):
+@pytest.mark.parametrize("fingerprint_depth", [0, 4])
+def test_resnet_infer(must_dominate, fingerprint_depth):
     x = np.random.randn(1, 3, 32, 32)
     m_x = raf.array(x, dtype="float32")
     model = resnet.RAFResNet50([3, 4, 6, 3])
@@ -81,7 +96,9 @@ def test_resnet_infer(must_dominate):
     infer_mod = raf._ffi.pass_.InferType()(infer_mod)
     ref_y = model(m_x)
 
-    new_mod = raf._ffi.pass_.Deduplicate(0, True, must_dominate, None)(infer_mod)
+    config = {"raf.deduplicate.fingerprint_depth": fingerprint_depth}
+    with raf.ir.PassContext(config=config):
+        new_mod = raf._ffi.pass_.Deduplicate(0, True, must_dominate, None)(infer_mod)
     assert " = fn" in raf.ir.AsText(new_mod)
     new_mod = raf._ffi.pass_.ToANormalForm()(new_mod)
     new_model = raf.frontend.FrameworkModel(new_mod, new_mod, model.state(), {})
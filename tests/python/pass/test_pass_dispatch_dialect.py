@@ -134,5 +134,39 @@ def test_dialect_pref():
     assert tvm.ir.structural_equal(mod["main"], func_expected)
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_profile_guided():
+    class Model(raf.Model):
+        def build(self):
+            self.conv = Conv2d(16, 16, kernel_size=(3, 3), padding=1, bias=False)
+
+        @raf.model.trace
+        def forward(self, x):
+            y = self.conv(x)
+            y = raf.relu(y)
+            return y
+
+    class OpCollector(tvm.relay.ExprVisitor):
+        def __init__(self):
+            super().__init__()
+            self.ops = []
+
+        def visit_op(self, op):
+            self.ops.append(op.name)
+
+    model = Model()
+    m_x, _ = randn((1, 16, 64, 64), device="cpu")
+    mod = model._internal(m_x).mod
+    with raf.ir.PassContext(config={"raf.dispatch_dialect.profile_guided": True}):
+        mod = optimize(mod)
+    collector = OpCollector()
+    collector.visit(mod["main"])
+    # Which dialect wins depends on the profiling results, but each op must be dispatched
+    # to one of its dialects.
+    assert len(collector.ops) == 2
+    assert any(op in collector.ops for op in ("raf.op.cudnn.conv2d", "raf.op.tvm.conv2d"))
+    assert any(op in collector.ops for op in ("raf.op.cudnn.relu", "raf.op.tvm.relu"))
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -538,6 +538,63 @@ def test_memory_copy_ops(shape, comp_stream, fuse_tensor_stream, defuse_tensor_s
     dcfg.enable_data_parallel = False
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape,comp_stream,comm_stream,fuse_tensor_stream", [[(64, 128), 1, 4, 5]])
+def test_shared_event(shape, comp_stream, comm_stream, fuse_tensor_stream):
+    dcfg = dist.get_config()
+    dcfg.enable_data_parallel = True
+
+    with Device("cuda(0)"):
+
+        def construct_model_func():
+            # The tuple (1) is consumed by allreduce (2) and fuse_tensor (3) on different streams,
+            # which wait for the same event instead of one event each.
+            # atan (0) -> tuple (1) -> allreduce (2) ---> atan (4) -> concat (7)
+            #                     \-> fuse_tensor (3) -> atan (5) -/
+            builder = ANFBuilder()
+            x = extended_var("x", shape=shape)
+            x_0 = builder.call("atan", [x])
+            x_1 = builder.make_tuple([x_0])
+            x_2 = builder.call("_allreduce", [x_1, raf.ir.const("sum")])
+            x_3 = builder.call("fuse_tensor", [x_1])
+            x_4 = builder.call("atan", [x_2])
+            x_5 = builder.call("atan", [x_3])
+            x_6 = builder.make_tuple([x_4, x_5])
+            x_7 = builder.call("concatenate", [x_6, raf.ir.const(0)])
+            return tvm.relay.Function([x], builder.ret(x_7))
+
+        def expected():
+            builder = ANFBuilder()
+            x = extended_var("x", shape=shape)
+            builder.set_stream(0, comp_stream)
+            x_0 = builder.call("atan", [x])
+            x_1 = builder.make_tuple([x_0])
+            builder.add_event(1, comp_stream)
+            builder.set_stream(0, comm_stream)
+            builder.wait_event(1, comm_stream)
+            x_2 = builder.call("_allreduce", [x_1, raf.ir.const("sum")])
+            builder.add_event(2, comm_stream)
+            builder.set_stream(0, fuse_tensor_stream)
+            builder.wait_event(1, fuse_tensor_stream)
+            x_3 = builder.call("fuse_tensor", [x_1])
+            builder.add_event(3, fuse_tensor_stream)
+            builder.set_stream(0, comp_stream)
+            builder.wait_event(2, comp_stream)
+            x_4 = builder.call("atan", [x_2])
+            builder.wait_event(3, comp_stream)
+            x_5 = builder.call("atan", [x_3])
+            x_6 = builder.make_tuple([x_4, x_5])
+            x_7 = builder.call("concatenate", [x_6, raf.ir.const(0)])
+            return tvm.relay.Function([x], builder.ret(x_7))
+
+        mod = tvm.IRModule()
+        mod["main"] = construct_model_func()
+        mod = RAFSequential([EnforceSync()])(mod)
+
+    assert tvm.ir.structural_equal(mod["main"], expected())
+    dcfg.enable_data_parallel = False
+
+
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize(
     "shape,comp_stream,comm_stream,fuse_tensor_stream,defuse_tensor_stream",
@@ -637,5 +694,108 @@ def test_dependency_analysis(
     dcfg.enable_data_parallel = False
 
 
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape,comp_stream,comm_stream", [[(64, 128), 1, 4]])
+def test_stream_priority(shape, comp_stream, comm_stream):
+    dcfg = dist.get_config()
+    dcfg.enable_data_parallel = True
+
+    with Device("cuda(0)"):
+
+        def construct_model_func():
+            # atan -> allreduce -> atan
+            builder = ANFBuilder()
+            x = extended_var("x", shape=shape)
+            x_0 = builder.call("atan", [x])
+            x_1 = builder.make_tuple([x_0])
+            x_2 = builder.call("_allreduce", [x_1, raf.ir.const("sum")])
+            x_3 = builder.call("atan", [x_2])
+            return tvm.relay.Function([x], builder.ret(x_3))
+
+        def expected():
+            # The communication stream is set with the high priority.
+            builder = ANFBuilder()
+            x = extended_var("x", shape=shape)
+            builder.set_stream(0, comp_stream)
+            x_0 = builder.call("atan", [x])
+            x_1 = builder.make_tuple([x_0])
+            builder.add_event(1, comp_stream)
+            builder.set_stream(0, comm_stream, 1)
+            builder.wait_event(1, comm_stream)
+            x_2 = builder.call("_allreduce", [x_1, raf.ir.const("sum")])
+            builder.add_event(2, comm_stream)
+            builder.set_stream(0, comp_stream)
+            builder.wait_event(2, comp_stream)
+            x_3 = builder.call("atan", [x_2])
+            return tvm.relay.Function([x], builder.ret(x_3))
+
+        mod = tvm.IRModule()
+        mod["main"] = construct_model_func()
+        with PassContext(config={"raf.stream_schedule.use_priority": True}):
+            mod = RAFSequential([EnforceSync()])(mod)
+
+    assert tvm.ir.structural_equal(mod["main"], expected())
+    dcfg.enable_data_parallel = False
+
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape,comp_stream,comm_streams", [[(64, 128), 1, (4, 7)]])
+def test_comm_streams(shape, comp_stream, comm_streams):
+    dcfg = dist.get_config()
+    dcfg.enable_data_parallel = True
+    dcfg.num_comm_streams = 2
+
+    with Device("cuda(0)"):
+
+        def construct_model_func():
+            #      /-> allreduce -\
+            # atan                 concat
+            #      \-> allgather -/
+            builder = ANFBuilder()
+            x = extended_var("x", shape=shape)
+            x_0 = builder.call("atan", [x])
+            x_1 = builder.make_tuple([x_0])
+            x_2 = builder.call("_allreduce", [x_1, raf.ir.const("sum")])
+            x_3 = builder.call("_allgather", [x_0, raf.ir.const(0)])
+            x_4 = builder.make_tuple([x_2, x_3])
+            x_5 = builder.call("concatenate", [x_4, raf.ir.const(0)])
+            return tvm.relay.Function([x], builder.ret(x_5))
+
+        def expected():
+            # The allreduce and the allgather are on different communication streams, so they
+            # do not wait for each other.
+            builder = ANFBuilder()
+            x = extended_var("x", shape=shape)
+            builder.set_stream(0, comp_stream)
+            x_0 = builder.call("atan", [x])
+            builder.add_event(1, comp_stream)
+            x_1 = builder.make_tuple([x_0])
+            builder.add_event(2, comp_stream)
+            builder.set_stream(0, comm_streams[0])
+            builder.wait_event(2, comm_streams[0])
+            x_2 = builder.call("_allreduce", [x_1, raf.ir.const("sum")])
+            builder.add_event(3, comm_streams[0])
+            builder.set_stream(0, comm_streams[1])
+            builder.wait_event(1, comm_streams[1])
+            x_3 = builder.call("_allgather", [x_0, raf.ir.const(0)])
+            builder.add_event(4, comm_streams[1])
+            builder.set_stream(0, comp_stream)
+            builder.wait_event(3, comp_stream)
+            builder.wait_event(4, comp_stream)
+            x_4 = builder.make_tuple([x_2, x_3])
+            x_5 = builder.call("concatenate", [x_4, raf.ir.const(0)])
+            return tvm.relay.Function([x], builder.ret(x_5))
+
+        mod = tvm.IRModule()
+        mod["main"] = construct_model_func()
+        mod = RAFSequential([EnforceSync()])(mod)
+
+    assert tvm.ir.structural_equal(mod["main"], expected())
+    dcfg.num_comm_streams = 1
+    dcfg.enable_data_parallel = False
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
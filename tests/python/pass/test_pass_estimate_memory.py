@@ -13,13 +13,18 @@ from raf.ir import ScopeBuilder
 from raf.testing import check
 
 
-def verify_memory(mod, device, expected_trace, disable_fusion=True, include_param=False):
+def verify_memory(
+    mod, device, expected_trace, disable_fusion=True, include_param=False, stream_policy=None
+):  # pylint: disable=too-many-arguments
     disabled_pass = []
     if disable_fusion:
         disabled_pass += ["FuseDialect", "FuseTVM"]
+    config = {}
+    if stream_policy is not None:
+        config["raf.stream_schedule.policy"] = stream_policy
 
     compiler = VMCompiler()
-    with tvm.transform.PassContext(opt_level=3, disabled_pass=disabled_pass):
+    with tvm.transform.PassContext(opt_level=3, config=config, disabled_pass=disabled_pass):
         mod, _ = compiler.optimize(mod, device)
     mod = InferType()(mod)
     trace = [(name, mem.value) for name, mem in EstimateMemory(mod, Device(device), include_param)]
@@ -74,5 +79,26 @@ def test_workspace():
     verify_memory(get_mod(), "cuda", [(1, float("inf")), 2, 1], True)
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_multi_stream():
+    shape = (512, 512)  # 1 MB
+
+    def get_mod():
+        data = raf.ir.var("x", shape=shape)
+
+        sb = ScopeBuilder()
+        a_1 = sb.let("a1", raf.ir.op.relu(data))
+        a_2 = sb.let("a2", raf.ir.op.tanh(data))
+        a_3 = sb.let("a3", raf.ir.op.add(a_1, a_2))
+        sb.ret(a_3)
+        func = relay.Function([data], sb.get())
+        return tvm.IRModule.from_expr(func)
+
+    # Sequential execution: a1 -> a2 -> a3.
+    verify_memory(get_mod(), "cuda", [1, 2, 3, 1], True)
+    # The two branches may run concurrently, so both a1 and a2 could be alive at either of them.
+    verify_memory(get_mod(), "cuda", [2, 2, 3, 1], True, stream_policy="wavefront")
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
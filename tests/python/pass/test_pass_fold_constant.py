@@ -3,6 +3,8 @@
 
 import pytest
 import raf
+from raf._core.executor import VMExecutor
+from raf.model.trace import _get_func_inputs
 from raf.testing import get_testable_devices, randn, check
 import tvm
 
@@ -83,5 +85,47 @@ def test_fold_const_ir(device, shape):
     assert tvm.ir.structural_equal(func_folded, func_expected)
 
 
+def test_prepack_weights():
+    # pylint: disable=protected-access
+    shape = [4, 4]
+    w_1, _ = randn(shape)
+    w_2, _ = randn(shape)
+    w_3, _ = randn([2] + shape)
+
+    class ModelWithWeights(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            self.w_1 = w_1
+            self.w_2 = w_2
+            self.w_3 = w_3
+
+        @raf.model.trace
+        def forward(self, x, y):
+            a = raf.matmul(x, self.w_1)
+            b = raf.matmul_nt(a, self.w_2)
+            return b, raf.batch_matmul(y, self.w_3)
+
+    model = ModelWithWeights()
+    model.infer_mode()
+    m_x, _ = randn(shape)
+    m_y, _ = randn([2] + shape)
+    ref_outs = model(m_x, m_y)
+    record = model._internal(m_x, m_y)
+    args = _get_func_inputs(record, [m_x, m_y], {}, get_handle=False)
+    handles = [arg._ndarray__handle for arg in args]
+    mod = raf._core.module.IRModule.from_expr(raf._ffi.pass_.BindParam(record.mod["main"], handles))
+
+    with raf.Device("cpu"):
+        with raf.ir.PassContext(config={"raf.fold_const.prepack_weights": True}):
+            mod = raf._ffi.pass_.FoldConstant()(mod)
+    text = raf.ir.AsText(mod["main"])
+    # The weights are transposed at compile time for dense and batch_matmul_nt.
+    assert text.count("raf.op.dense(") == 2, text
+    assert text.count("raf.op.batch_matmul_nt(") == 1, text
+    assert "raf.op.matmul" not in text and "raf.op.transpose" not in text, text
+    outs = VMExecutor(mod, "cpu").make_executor()(*args)
+    for out, ref_out in zip(outs, ref_outs):
+        check(out, ref_out)
+
 if __name__ == "__main__":
     pytest.main([__file__])
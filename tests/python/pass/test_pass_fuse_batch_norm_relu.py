@@ -0,0 +1,73 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+import pytest
+import raf
+from raf.model.trace import trace_mutate_attr
+from raf.testing import check, randn, get_testable_devices
+
+
+def count_ops(mod, op_name):
+    text = raf.ir.AsText(mod["main"])
+    return text.count(op_name + "(")
+
+
+class Model(raf.Model):
+    def build(self, mean, var):
+        self.mean = mean
+        self.var = var
+
+    @raf.model.trace
+    def forward(self, x, z, w, b):
+        a_1 = raf.batch_norm_train(x, self.mean, self.var, w, b, 0.1, 1e-5)
+        trace_mutate_attr(self, "mean", a_1[1])
+        trace_mutate_attr(self, "var", a_1[2])
+        a_2 = raf.relu(raf.add(a_1[0], z))
+        a_3 = raf.batch_norm_train(a_2, self.mean, self.var, w, b, 0.1, 1e-5)
+        a_4 = raf.relu(a_3[0])
+        # The output of the third batch_norm is used twice, so it is not fused.
+        a_5 = raf.batch_norm_train(a_4, self.mean, self.var, w, b, 0.1, 1e-5)
+        return raf.add(raf.relu(a_5[0]), a_5[0])
+
+
+def gen_args(device="cpu"):
+    x = randn((2, 4, 6, 6), device=device)[0]
+    z = randn((2, 4, 6, 6), device=device)[0]
+    w = randn((4,), device=device)[0]
+    b = randn((4,), device=device)[0]
+    mean = randn((4,), device=device)[0]
+    var = randn((4,), device=device, positive=True)[0]
+    return [x, z, w, b], mean, var
+
+
+def test_fuse_batch_norm_relu():
+    args, mean, var = gen_args()
+    model = Model(mean, var)
+    mod = model._internal(*args).mod
+    mod = raf._ffi.pass_.FuseBatchNormRelu()(mod)
+    assert count_ops(mod, "raf.op.batch_norm_relu_train") == 2
+    assert count_ops(mod, "raf.op.batch_norm_train") == 1
+    assert count_ops(mod, "raf.op.relu") == 1
+    assert count_ops(mod, "raf.op.add") == 1
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_fuse_batch_norm_relu_autodiff(device):
+    # pylint: disable=invalid-name
+    args, mean, var = gen_args(device)
+    model = Model(mean, var)
+    ref_model = Model(raf.array(mean.numpy(), device=device), raf.array(var.numpy(), device=device))
+    for arg in args:
+        arg.requires_grad = True
+    dy = randn((2, 4, 6, 6), device=device)[0]
+    m_y = raf.optim.optim.with_autodiff(ref_model)(dy, *args)
+    with raf.ir.PassContext(config={"raf.optim.fuse_batch_norm_relu": True}):
+        y = raf.optim.optim.with_autodiff(model)(dy, *args)
+    check(y[0], m_y[0], rtol=1e-4, atol=1e-4)
+    for dx, m_dx in zip(y[1], m_y[1]):
+        check(dx, m_dx, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
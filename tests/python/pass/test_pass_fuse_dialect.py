@@ -217,5 +217,35 @@ def test_duplicate():
     assert tvm.ir.structural_equal(mod["main"], func_expected)
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dropout", [False, True])
+def test_add_dropout_layer_norm(dropout):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, residual, scale, bias):
+            if dropout:
+                x = raf._op.sym._contrib_dropout(x, p=0.1)[0]
+            out = raf.add(x, residual)
+            return raf.layer_norm(out, scale, bias)
+
+    shape = (4, 16, 64)
+    m_x, _ = randn(shape, device="cpu")
+    m_r, _ = randn(shape, device="cpu")
+    m_w, _ = randn((64,), device="cpu")
+    m_b, _ = randn((64,), device="cpu")
+    model = Model()
+    mod = model._internal(m_x, m_r, m_w, m_b).mod
+    mod = optimize(mod)
+    text = raf.ir.AsText(mod["main"])
+    assert '"add_dropout_layer_norm"' in text, text
+    assert "raf.op.cuda.layer_norm" in text, text
+    assert ("raf.op.cuda._contrib_dropout" in text) == dropout, text
+    # The whole block is a single call to the fused function.
+    assert text.count("raf.op.cuda.add") == 1, text
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -9,7 +9,7 @@ import raf
 from raf.ir import ScopeBuilder
 from raf.model import Conv2d
 from raf.model.trace import trace_mutate_attr
-from raf.testing import run_infer_type, randn
+from raf.testing import run_infer_type, randn, check, get_vm_executor
 import tvm
 from tvm import relay
 
@@ -714,5 +714,126 @@ def test_deduplicate():
     assert tvm.ir.structural_equal(mod_after["main"], func_expected)
 
 
+
+def test_profile_guided():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.relu(x)
+            y = raf.log(y)
+            y = raf.exp(y)
+            return y
+
+    class OpCounter(tvm.relay.ExprVisitor):
+        def __init__(self):
+            super().__init__()
+            self.num_ops = 0
+            self.num_funcs = 0
+
+        def visit_function(self, fn):
+            if fn.attrs and "Primitive" in fn.attrs.keys():
+                self.num_funcs += 1
+            super().visit_function(fn)
+
+        def visit_op(self, _):
+            self.num_ops += 1
+
+    model = Model()
+    m_x, _ = randn((10, 20), device="cpu")
+    mod = model._internal(m_x).mod
+    with raf.Device("cpu"):
+        with raf.ir.PassContext(config={"raf.fuse_tvm.profile_guided": True}):
+            mod = fuse_module(mod)
+    counter = OpCounter()
+    counter.visit(mod["main"])
+    # Whether the ops are fused depends on the profiling results, but all ops must be kept
+    # in either one fused function or three single-op functions.
+    assert counter.num_ops == 3
+    assert counter.num_funcs in (1, 3)
+
+
+def test_fuse_random_mask():
+    konst, _ = randn((1,), device="cpu")
+
+    class Model(raf.Model):
+        def build(self):
+            self.c = konst
+
+        @raf.model.trace
+        def forward(self, key, x):
+            u = raf.threefry_uniform(key, (10, 20))
+            mask = raf.cast(raf.greater_equal(u, self.c), "float32")
+            return raf.multiply(x, mask)
+
+    class OpCounter(tvm.relay.ExprVisitor):
+        def __init__(self):
+            super().__init__()
+            self.num_ops = 0
+            self.num_funcs = 0
+
+        def visit_function(self, fn):
+            if fn.attrs and "Primitive" in fn.attrs.keys():
+                self.num_funcs += 1
+            super().visit_function(fn)
+
+        def visit_op(self, _):
+            self.num_ops += 1
+
+    model = Model()
+    m_key = raf.array(np.arange(10), dtype="uint64", device="cpu")
+    m_x, _ = randn((10, 20), device="cpu")
+    mod = model._internal(m_key, m_x).mod
+    mod = fuse_module(mod)
+    counter = OpCounter()
+    counter.visit(mod["main"])
+    # The random numbers are generated in the fused kernel instead of being materialized.
+    assert counter.num_ops == 4
+    assert counter.num_funcs == 1
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_nvrtc(dtype):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):
+            a = raf.relu(raf.add(x, y))
+            return raf.sum(raf.multiply(a, x), axis=-1)
+
+    class DialectCollector(tvm.relay.ExprVisitor):
+        def __init__(self):
+            super().__init__()
+            self.dialects = []
+
+        def visit_function(self, fn):
+            if fn.attrs and "Dialect" in fn.attrs.keys():
+                self.dialects.append(fn.attrs["Dialect"])
+            super().visit_function(fn)
+
+    model = Model()
+    m_x, n_x = randn((10, 20), device="cuda", dtype=dtype)
+    m_y, n_y = randn((20,), device="cuda", dtype=dtype)
+    mod = model._internal(m_x, m_y).mod
+    with raf.Device("cuda"):
+        with raf.ir.PassContext(config={"raf.fuse_tvm.nvrtc": True}):
+            mod = fuse_module(mod)
+    collector = DialectCollector()
+    collector.visit(mod["main"])
+    assert collector.dialects == ["nvrtc"]
+
+    executor = get_vm_executor(mod, "cuda", disable_fusion=True)
+    m_out = executor(m_x, m_y)
+    n_x = n_x.astype("float32")
+    n_out = np.sum(np.maximum(n_x + n_y.astype("float32"), 0) * n_x, axis=-1)
+    tol = 1e-5 if dtype == "float32" else 1e-2
+    check(m_out, n_out, rtol=tol, atol=tol)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -4,6 +4,7 @@
 # pylint: disable=invalid-name,protected-access,too-many-locals,attribute-defined-outside-init
 import numpy as np
 import pytest
+import torch
 import raf
 import tvm
 from tvm import relay
@@ -12,7 +13,7 @@ from raf._ffi.pass_ import LambdaLift, FlattenClosure, InlineBackward
 from raf.ir import RAFSequential, ScopeBuilder
 from raf.model import BatchNorm
 from raf.model.trace import _get_func_inputs
-from raf.testing import get_testable_devices, randn, check, utils, one_hot_torch
+from raf.testing import get_testable_devices, randn, randn_torch, check, utils, one_hot_torch
 
 
 def ad_passes(mod, requires_grads=None):
@@ -890,5 +891,70 @@ def test_simplify_sum():
     assert len(list(filter(lambda x: x, sum_ops))) == 1
 
 
+def test_unused_tuple_field():
+    def get_mod():
+        mod = tvm.IRModule()
+        x = raf.ir.var("x", shape=(1, 100), dtype="float32")
+        a = relay.tanh(x)
+        b = relay.erf(x)
+        c = relay.Tuple([a, b])
+        out = relay.nn.relu(relay.TupleGetItem(c, 0))
+        mod["main"] = relay.Function([x], out)
+        return mod
+
+    mod = FromRelay()(get_mod())
+    mod = RAFSequential([InferType(), AutoDiff([])])(mod)
+    # The gradient of the unused field is a symbolic zero, so neither zeros are made for it nor
+    # the backward of erf is computed.
+    ops = list()
+    find_ops = lambda x: ops.append(x.op.name) if isinstance(x, tvm.relay.Call) else None
+    tvm.relay.analysis.post_order_visit(mod["main"], find_ops)
+    assert "raf.op.zeros" not in ops and "raf.op.zeros_like" not in ops, ops
+    assert "raf.op.erf_dx" not in ops, ops
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_inplace_grad_accumulation(device):
+    def get_mod():
+        mod = tvm.IRModule()
+        x = raf.ir.var("x", shape=(4, 100), dtype="float32")
+        a = relay.tanh(x)
+        out = relay.add(relay.add(relay.nn.relu(a), relay.erf(a)), relay.sigmoid(a))
+        mod["main"] = relay.Function([x], out)
+        return mod
+
+    mod = FromRelay()(get_mod())
+    ad_mod = RAFSequential([InferType(), AutoDiff([])])(mod)
+    # The 3 gradients of %a are summed by an add to a new tensor, and then an add in place.
+    adds = list()
+
+    def find_adds(expr):
+        if isinstance(expr, tvm.relay.Call) and expr.op.name == "raf.op.add":
+            adds.append(expr)
+
+    tvm.relay.analysis.post_order_visit(ad_mod["main"], find_adds)
+    inplace = [add for add in adds if isinstance(add.args[2], tvm.relay.Var)]
+    assert len(inplace) == 1, raf.ir.AsText(ad_mod["main"])
+    assert inplace[0].args[0].same_as(inplace[0].args[2])
+
+    # The accumulated gradient is still correct.
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            a = raf.tanh(x)
+            return raf.add(raf.add(raf.relu(a), raf.erf(a)), raf.sigmoid(a))
+
+    m_x, t_x = randn_torch((4, 100), device=device, requires_grad=True)
+    m_dy, t_dy = randn_torch((4, 100), device=device)
+    Model()(m_x).backward(m_dy)
+    t_a = torch.tanh(t_x)
+    t_y = torch.relu(t_a) + torch.erf(t_a) + torch.sigmoid(t_a)
+    t_y.backward(t_dy)
+    check(m_x.grad, t_x.grad, rtol=1e-4, atol=1e-4)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
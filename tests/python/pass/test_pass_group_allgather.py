@@ -62,6 +62,9 @@ def test_group(mock_get_config, mock_get_comm):
             self.enable_data_parallel = True
             self.zero_opt_level = 2
             self.group_bucket_size = 5000000000
+            self.zero_defer_allgather = False
+            self.zero_offload = False
+            self.zero_flat_buffer = False
 
     mock_get_config.return_value = MockConfig()
 
@@ -0,0 +1,71 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init,protected-access,no-self-use
+import pytest
+
+import raf
+from raf.ir.pass_manager import RAFSequential
+from raf._ffi.pass_ import DataParallelSchedule, GroupCollectives, InferType, ToGraphNormalForm
+from raf.testing import randn
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_group_independent_collectives():
+    class Model(raf.Model):
+        #      /-> allreduce -\
+        # atan --> allreduce --> concat
+        #      \-> reduce_scatter -> allgather -/
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            a0 = raf.atan(x)
+            r0 = raf.allreduce(a0)
+            r1 = raf.allreduce(a0)
+            s0 = raf.reduce_scatter(a0)
+            g0 = raf.allgather(s0, axis=0)
+            return raf.concatenate([r0, r1, g0])
+
+    shape = (64, 128)
+    model = Model()
+    x, _ = randn(shape)
+    mod = model._internal(x).mod
+    mod = RAFSequential([ToGraphNormalForm(), DataParallelSchedule()])(mod)
+    ref_ret_type = InferType()(mod)["main"].checked_type.ret_type
+    mod = GroupCollectives()(mod)
+    text = raf.ir.AsText(mod["main"])
+    # The independent allreduces and reduce-scatter are launched as one group, while the
+    # allgather takes the output of the reduce-scatter, so it is launched after the group.
+    assert text.count("raf.op._group_comm(") == 1, text
+    assert text.count("raf.op._allreduce(") == 0, text
+    assert text.count("raf.op._reduce_scatter(") == 0, text
+    assert text.count("raf.op._allgather(") == 1, text
+    assert text.index("raf.op._group_comm(") < text.index("raf.op._allgather("), text
+    mod = InferType()(mod)
+    assert mod["main"].checked_type.ret_type == ref_ret_type
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_group_keeps_dependent_collectives():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            r0 = raf.allreduce(x)
+            return raf.allreduce(r0, computation="max")
+
+    x, _ = randn((64, 128))
+    mod = Model()._internal(x).mod
+    mod = RAFSequential([ToGraphNormalForm(), DataParallelSchedule()])(mod)
+    mod = GroupCollectives()(mod)
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op._group_comm(") == 0, text
+    assert text.count("raf.op._allreduce(") == 2, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,54 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+import pytest
+import raf
+from raf._core.executor import VMExecutor
+from raf.testing import check, randn, get_testable_devices
+
+
+def count_ops(mod, op_name):
+    text = raf.ir.AsText(mod["main"])
+    return text.count(op_name + "(")
+
+
+class Model(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x1, x2, x3, w):
+        a_1 = raf.matmul(x1, w)
+        a_2 = raf.matmul(x2, w)
+        a_3 = raf.matmul_nt(x3, w)
+        a_4 = raf.matmul(a_1, w)
+        out = raf.add(a_2, a_4)
+        return raf.add(out, a_3)
+
+
+def test_horizontal_fuse():
+    model = Model()
+    args = [randn((4, 4))[0] for _ in range(4)]
+    mod = model._internal(*args).mod
+    mod = raf._ffi.pass_.HorizontalFuse()(mod)
+    # The first two matmuls are independent and have the same shapes. The third one is matmul_nt,
+    # and the fourth one depends on the first one, so they are not fused.
+    assert count_ops(mod, "raf.op.batch_matmul") == 1
+    assert count_ops(mod, "raf.op.matmul") == 1
+    assert count_ops(mod, "raf.op.matmul_nt") == 1
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_horizontal_fuse_vm(device):
+    model = Model()
+    args = [randn((4, 4), device=device)[0] for _ in range(4)]
+    ref = model(*args)
+    mod = model._internal(*args).mod
+    with raf.ir.PassContext(config={"raf.vm.optimize.horizontal_fuse": True}):
+        out = VMExecutor(mod, device).make_executor()(*args)
+    check(out, ref)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
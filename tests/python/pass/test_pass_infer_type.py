@@ -303,6 +303,29 @@ def test_constant_tensor_tuple():
     check(m_c2, ToTVM(ExtractValue(func.body)[1]).numpy())
 
 
+@pytest.mark.parametrize("incremental", [True, False])
+def test_incremental(incremental):
+    # Rewrite the first binding to change its type, and reuse the unchanged second binding.
+    x = extended_var("x", shape=(3, 4))
+    a = extended_var("a")
+    b = extended_var("b")
+    body = relay.Let(a, raf.ir.op.transpose(x, (1, 0)), relay.Let(b, raf.ir.op.relu(a), b))
+    mod = IRModule.from_expr(relay.Function([x], body))
+    with raf.ir.PassContext(config={"raf.type_infer.incremental": incremental}):
+        func = InferType()(mod)["main"]
+        assert str(func.checked_type.ret_type) == str(relay.TensorType((4, 3)))
+
+        relu_call = func.body.body.value
+        body = relay.Let(a, raf.ir.op.reshape(x, (2, 6)), relay.Let(b, relu_call, b))
+        mod = IRModule.from_expr(relay.Function([x], body))
+        func = InferType()(mod)["main"]
+        assert str(func.checked_type.ret_type) == str(relay.TensorType((2, 6)))
+
+        # Inferring an unchanged module gives the same types.
+        func = InferType()(IRModule.from_expr(func))["main"]
+        assert str(func.body.body.value.checked_type) == str(relay.TensorType((2, 6)))
+
+
 def test_closure_with_const_args1():
     rand, _ = randn((1,), device="cpu")
 
@@ -400,27 +423,27 @@ def test_closure_param_type_update():
     class ResultChecker(relay.ExprVisitor):
         def __init__(self):
             super(ResultChecker, self).__init__()
-            self.cudnn_dropout_cnt = 0
+            self.cuda_dropout_cnt = 0
 
         def visit_let(self, let):
             call_op = let.value.op
             if (
                 not isinstance(call_op, relay.Function)
-                and call_op.name == "raf.op.cudnn._contrib_dropout"
+                and call_op.name == "raf.op.cuda._contrib_dropout"
             ):
-                # Make sure 3 dropouts are dispatched to cudnn.
-                self.cudnn_dropout_cnt += 1
+                # Make sure 3 dropouts are dispatched to cuda.
+                self.cuda_dropout_cnt += 1
             super().visit_let(let)
 
         def visit_function(self, fn):
-            # The mask in CuDNN dropout has 0-dim so the closure param should be updated.
+            # The mask in CUDA dropout has 0-dim so the closure param should be updated.
             dropout_mask_type = fn.params[0].checked_type.fields[1]
             assert len(dropout_mask_type.shape) == 0
             super().visit_function(fn)
 
     checker = ResultChecker()
     checker.visit(mod["main"].body)
-    assert checker.cudnn_dropout_cnt == 3
+    assert checker.cuda_dropout_cnt == 3
 
 
 def test_multi_functions():
@@ -256,6 +256,32 @@ def test_chain():
     assert bytecode.count("alloc_tensor") == 1
 
 
+def test_validate_without_if():
+    shape = (10, 20)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            a_1 = raf.add(x, x)
+            a_2 = raf.add(a_1, x, out=a_1)
+            a_3 = raf.add(a_2, x, out=a_2)
+            return a_3
+
+    # A straight-line function has no mandatory memory sharing, so the validator is the first
+    # user of the liveness union find forest.
+    model = Model()
+    x = raf.array(np.random.randn(*shape), device="cpu")
+    mod = lower(model, [x])
+    mod = pass_.ValidateInplaceUpdate(True)(mod)
+    variables = extract_vars(mod["main"].body)
+    assert len(variables) == 3
+    assert ExtendedVar(variables[1]).may_share == variables[0]
+    assert ExtendedVar(variables[2]).may_share == variables[1]
+
+
 def test_reduce():
     shape = (4, 4)
     device = "cpu"
@@ -15,6 +15,7 @@ from tvm.relay.transform import function_pass, FunctionPass
 from raf._ffi import pass_
 from raf._ffi.pass_ import FromRelay
 from raf.ir import RAFSequential
+from raf.utils import pass_profiler
 
 
 def get_var_func():
@@ -156,5 +157,67 @@ def test_sequential_pass():
     assert isinstance(ret_mod["mySub"].body.checked_type, tvm.ir.TensorType)
 
 
+def test_pass_instrument():
+    shape = (10,)
+    dtype = "float32"
+    tp = relay.TensorType(shape, dtype)
+    x = relay.var("x", tp)
+    y = relay.var("y", tp)
+    v_sub = relay.GlobalVar("mySub")
+    sub = relay.Function([x, y], relay.log(relay.subtract(x, y)))
+    mod = FromRelay()(tvm.IRModule({v_sub: sub}))
+
+    inner = RAFSequential(passes=[pass_.ToANormalForm()], opt_level=1, name="inner")
+    outer = RAFSequential(passes=[pass_.InferType(), inner], opt_level=1, name="outer")
+    pass_profiler.clear()
+    pass_profiler.start()
+    with PassContext():
+        outer(mod)
+    pass_profiler.stop()
+    records = pass_profiler.get()
+    pass_profiler.clear()
+
+    assert [(r["name"], r["parent"], r["depth"]) for r in records] == [
+        ("InferType", "outer", 0),
+        ("inner", "outer", 0),
+        ("ToANormalForm", "inner", 1),
+    ]
+    anf = records[2]
+    assert anf["calls_before"] == anf["calls_after"] == 2
+    assert anf["lets_before"] == 0 and anf["lets_after"] == 2
+    # The time of a sequence includes its passes.
+    assert records[1]["time_us"] >= anf["time_us"]
+    assert all(r["peak_rss_kb"] >= r["rss_after_kb"] > 0 for r in records)
+    summary = pass_profiler.get_summary(records)
+    assert {item["name"] for item in summary} == {"InferType", "inner", "ToANormalForm"}
+
+    # Nothing is recorded when stopped.
+    with PassContext():
+        outer(mod)
+    assert not pass_profiler.get()
+
+
+def test_parallel_function_pass():
+    tp = relay.TensorType((10,), "float32")
+    funcs = {}
+    for i in range(8):
+        x = relay.var("x", tp)
+        y = relay.var("y", tp)
+        body = relay.exp(relay.subtract(relay.add(x, y), relay.log(x)))
+        funcs[relay.GlobalVar("func%d" % i)] = relay.Function([x, y], body)
+    mod = FromRelay()(tvm.IRModule(funcs))
+
+    def run(num_threads):
+        with PassContext(config={"raf.pass.function_pass_threads": num_threads}):
+            return pass_.FuseTVM()(pass_.InferType()(mod))
+
+    ref_mod = run(1)
+    par_mod = run(4)
+    assert [gv.name_hint for gv in par_mod.get_global_vars()] == [
+        gv.name_hint for gv in ref_mod.get_global_vars()
+    ]
+    assert tvm.ir.structural_equal(par_mod, ref_mod, map_free_vars=True)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
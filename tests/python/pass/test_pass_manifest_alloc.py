@@ -2,12 +2,15 @@
 # SPDX-License-Identifier: Apache-2.0
 
 # pylint: disable=no-self-use, protected-access, attribute-defined-outside-init
+import numpy as np
 import pytest
 import raf
-from raf._lib import tvm
+from raf._lib import tvm, relay
+from raf._core.executor import VMExecutor
 from raf._core.module import IRModule
 from raf._core.device import Device
-from raf.testing import get_testable_devices, randn
+from raf._core.ndarray import Symbol
+from raf.testing import get_testable_devices, randn, check
 
 
 @pytest.mark.parametrize("device", get_testable_devices())
@@ -174,5 +177,110 @@ def test_device():
     assert 'raf.op.vm.alloc_storage(int64(100), int64(128), int32(2), int32(1), str"int32")' in text
 
 
+def test_host_shape_ops():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.relu(x)
+            return raf.shape_as_tensor(y)
+
+    model = Model()
+    m_x, _ = randn((4, 16))
+    mod = raf._ffi.pass_.InferType()(model._internal(m_x).mod)
+    with Device("cuda"):
+        mod = raf._ffi.pass_.ManifestAlloc()(mod)
+    text = raf.ir.AsText(mod["main"])
+
+    # The output of relu is on the device, while the shape tensor is on CPU (int32(1)).
+    assert 'int64(256), int64(128), int32(2), int32(0), str"float32")' in text
+    assert 'int64(8), int64(128), int32(1), int32(0), str"int32")' in text
+
+def test_upper_bound_shapes():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            y = raf.relu(y)
+            return y
+
+    model = Model()
+    x = Symbol.make_var("x", relay.TensorType((relay.Any(), 16)))
+    mod = model._internal(x).mod
+    config = {"raf.manifest_alloc.upper_bound_shapes": {"x": [8, 16]}}
+
+    def manifest(mod):
+        mod = raf._ffi.pass_.InferType()(mod)
+        with Device("cpu"):
+            return raf._ffi.pass_.ManifestAlloc()(mod)
+
+    # The storages are allocated at the runtime sizes by default.
+    text = raf.ir.AsText(manifest(mod)["main"])
+    assert "raf.op.vm.alloc_storage(int64(" not in text
+
+    # The storages are allocated at the upper-bound size, and the tensors are of runtime shapes.
+    with tvm.transform.PassContext(config=config):
+        text = raf.ir.AsText(manifest(mod)["main"])
+    assert text.count("raf.op.vm.alloc_storage(int64(512)") == 2
+    assert "raf.op.vm.infer_type" in text
+
+    # The original function is not typed at the upper-bound shapes.
+    assert "Tensor[(?, 16), float32]" in raf.ir.AsText(raf._ffi.pass_.InferType()(mod)["main"])
+
+    m_x, n_x = randn((5, 16))
+    with tvm.transform.PassContext(config=config):
+        out = VMExecutor(mod, "cpu").make_executor()(m_x)
+    check(out, np.maximum(n_x + n_x, 0))
+
+
+def test_concat_split_views():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):
+            a = raf.relu(x)
+            b = raf.exp(y)
+            c = raf.concatenate([a, b], axis=0)
+            d = raf.relu(c)
+            e = raf.split(d, 2, axis=0)
+            return raf.add(e[0], e[1])
+
+    model = Model()
+    m_x, n_x = randn((4, 16))
+    m_y, n_y = randn((4, 16))
+    mod = model._internal(m_x, m_y).mod
+    config = {"raf.manifest_alloc.concat_split_views": True}
+
+    def manifest(mod):
+        mod = raf._ffi.pass_.InferType()(mod)
+        with Device("cpu"):
+            return raf._ffi.pass_.ManifestAlloc()(mod)
+
+    text = raf.ir.AsText(manifest(mod)["main"])
+    assert "raf.op.concatenate" in text
+    assert "raf.op.split" in text
+
+    # relu and exp write to the halves of the concatenate output, and the split outputs are the
+    # halves of the relu output, so neither concatenate nor split is invoked.
+    with tvm.transform.PassContext(config=config):
+        text = raf.ir.AsText(manifest(mod)["main"])
+    assert "raf.op.concatenate" not in text
+    assert "raf.op.split" not in text
+    assert text.count("raf.op.vm.alloc_storage(int64(512)") == 2
+    assert text.count("int64(256))") == 2
+
+    with tvm.transform.PassContext(config=config):
+        out = VMExecutor(mod, "cpu").make_executor()(m_x, m_y)
+    n_d = np.maximum(np.concatenate([np.maximum(n_x, 0), np.exp(n_y)]), 0)
+    check(out, n_d[:4] + n_d[4:])
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
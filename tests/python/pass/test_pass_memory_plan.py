@@ -6,6 +6,7 @@
 import pytest
 import raf
 from raf._lib import tvm
+from raf.ir import ScopeBuilder
 from raf.testing import get_testable_devices, randn, check, run_vm_model
 
 
@@ -167,5 +168,109 @@ def test_set_shape():
     verify_correctness(model, "cpu", args, fusion=False)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_memory_plan_arena(device):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, a, b, c, d):
+            t0 = raf.add(a, a)
+            t1 = raf.add(t0, b)
+            t2 = raf.add(t1, c)
+            t3 = raf.add(t2, t0)
+            t4 = raf.add(t3, d)
+            return t4
+
+    shape = (5, 5)
+    model = Model()
+    model.infer_mode()
+    args = [randn(shape, device=device)[0] for _ in range(4)]
+    mod = model._internal(*args).mod
+
+    device_name = device if device != "cpu" else "llvm"
+    config = {"raf.memory_plan.use_arena": True}
+    disabled_pass = ["FuseDialect", "FuseTVM"]
+    with tvm.transform.PassContext(opt_level=3, config=config, disabled_pass=disabled_pass):
+        opt_mod, _ = raf._core.vm.VMCompiler().optimize(mod, device=device_name, params={})
+        executor = raf._core.executor.VMExecutor(mod, device)
+
+    # The 4 intermediate tensors are packed into one arena, which is smaller than their total size
+    # because t1 and t3 are not alive at the same time. The output has its own storage.
+    storage_sizes = []
+    for line in raf.ir.AsText(opt_mod["main"]).split("\n"):
+        if line.find("raf.op.vm.alloc_storage") != -1:
+            storage_sizes.append(int(line[line.find("int64(") + 6 : line.find(")")]))
+    assert len(storage_sizes) == 2, storage_sizes
+    assert sum(storage_sizes) < 500, storage_sizes
+
+    check(executor.make_executor()(*args), model(*args))
+
+
+def test_memory_plan_symbolic_size():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.argwhere(x)
+            y = raf.add(y, y)
+            y = raf.argwhere(y)
+            y = raf.abs(y)
+            y = raf.argwhere(y)
+            y = raf.add(y, y)
+            return y
+
+    model = Model()
+    m_x, _ = randn((4, 4), device="cpu")
+    mod = model._internal(m_x).mod
+
+    def run(use_symbolic_size):
+        config = {"raf.memory_plan.use_symbolic_size": use_symbolic_size}
+        with tvm.transform.PassContext(opt_level=3, config=config):
+            opt_mod, _ = raf._core.vm.VMCompiler().optimize(mod, device="llvm", params={})
+            executor = raf._core.executor.VMExecutor(mod, "cpu")
+        text = raf.ir.AsText(opt_mod["main"])
+        return text.count("raf.op.vm.alloc_storage"), executor.make_executor()(m_x)
+
+    ref_num_storages, ref_out = run(False)
+    num_storages, out = run(True)
+    # Dynamic tensors may reuse the storages of the dead ones, but never allocate more.
+    assert num_storages <= ref_num_storages
+    check(out, ref_out)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_memory_plan_contiguous_collectives():
+    shape = (4, 4)
+    data_a = raf.ir.var("a", shape=shape, dtype="float32")
+    data_b = raf.ir.var("b", shape=shape, dtype="float32")
+    sb = ScopeBuilder()
+    a_1 = sb.let("a1", raf.ir.op.add(data_a, data_a))
+    a_2 = sb.let("a2", raf.ir.op.add(data_b, data_b))
+    a_3 = sb.let("a3", tvm.relay.Tuple([a_1, a_2]))
+    a_4 = sb.let("a4", raf.ir.op._allreduce(a_3, "sum"))
+    sb.ret(a_4)
+    mod = tvm.IRModule.from_expr(tvm.relay.Function([data_a, data_b], sb.get()))
+
+    def get_storage_sizes(contiguous_collectives):
+        config = {"raf.memory_plan.contiguous_collectives": contiguous_collectives}
+        disabled_pass = ["FuseDialect", "FuseTVM"]
+        with tvm.transform.PassContext(opt_level=3, config=config, disabled_pass=disabled_pass):
+            opt_mod, _ = raf._core.vm.VMCompiler().optimize(mod, device="cuda", params={})
+        storage_sizes = []
+        for line in raf.ir.AsText(opt_mod["main"]).split("\n"):
+            if line.find("raf.op.vm.alloc_storage") != -1:
+                storage_sizes.append(int(line[line.find("int64(") + 6 : line.find(")")]))
+        return storage_sizes
+
+    # The two inputs of the allreduce share one storage, while the outputs are the final outputs
+    # so they keep their own storages.
+    assert sorted(get_storage_sizes(False)) == [64, 64, 64, 64]
+    assert sorted(get_storage_sizes(True)) == [64, 64, 128]
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
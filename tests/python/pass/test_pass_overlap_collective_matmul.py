@@ -0,0 +1,66 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init
+import pytest
+
+import raf
+from raf._ffi.pass_ import AutoDiff, InferType, OverlapCollectiveMatmul, ShardTensorParallel
+from raf.model import Linear
+from raf.model.trace import _get_func_inputs
+from raf.testing import randn
+
+
+class MLP(raf.Model):
+    def build(self):
+        self.linear1 = Linear(8, 16)
+        self.linear2 = Linear(16, 8)
+
+    @raf.model.trace
+    def forward(self, x):
+        out = self.linear1(x)
+        out = raf.relu(out)
+        out = self.linear2(out)
+        return raf.sum(out)
+
+
+def shard_mlp(m_x):
+    model = MLP()
+    record = model._internal(m_x)
+    params = {param._ndarray__handle: name for name, param in model.state().items()}
+    specs = {"linear1.w": 0, "linear1.b": 0, "linear2.w": 1}
+    inputs = _get_func_inputs(record, [m_x], {})
+    param_indices = [i for i, x in enumerate(inputs) if x in params]
+    axes = [specs.get(params[inputs[i]], -1) for i in param_indices]
+    # The collectives are inferred with the global communicator, which has only one rank.
+    return ShardTensorParallel(1, 0, param_indices, axes)(record.mod)
+
+
+@pytest.mark.parametrize("n_chunk", [2, 4])
+def test_mlp(n_chunk):
+    m_x, _ = randn((4, 8), dtype="float32")
+    mod = shard_mlp(m_x)
+    ref_ret_type = InferType()(mod)["main"].checked_type.ret_type
+    mod = OverlapCollectiveMatmul(n_chunk)(mod)
+    text = raf.ir.AsText(mod["main"])
+    # Both the allgather of the column parallel dense and the reduce-scatter of the row parallel
+    # dense are split into chunks, each with its own GEMM.
+    assert text.count("raf.op._allgather(") == n_chunk, text
+    assert text.count("raf.op._reduce_scatter(") == n_chunk, text
+    assert text.count("raf.op.dense(") == 2 * n_chunk, text
+    mod = InferType()(mod)
+    assert mod["main"].checked_type.ret_type == ref_ret_type
+    InferType()(AutoDiff([])(mod))
+
+
+def test_indivisible_samples():
+    # The samples cannot be split into the chunks evenly, so the collectives are kept.
+    m_x, _ = randn((3, 8), dtype="float32")
+    mod = OverlapCollectiveMatmul(2)(shard_mlp(m_x))
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op._allgather(") == 1, text
+    assert text.count("raf.op._reduce_scatter(") == 1, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -153,5 +153,96 @@ def test_basic(mock_get_config, mock_get_comm, opt_level, batch):
         verify_ir(opt_level, ad_model, [m_dy, m_x, m_ytrue], 4, 1, 9, 9)
 
 
+@patch("raf.distributed.get_communicator")
+@patch("raf.distributed.get_config")
+def test_offload(mock_get_config, mock_get_comm):
+    class Model(raf.Model):
+        def build(self):
+            self.linear1 = Linear(16, 8)
+            self.linear2 = Linear(8, 4)
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.sum(self.linear2(raf.relu(self.linear1(x))))
+
+    class MockConfig:
+        def __init__(self):
+            self.enable_data_parallel = True
+            self.zero_opt_level = 1
+
+    mock_get_config.return_value = MockConfig()
+
+    class MockComm:
+        def __init__(self):
+            self.size = 4
+            self.rank = 1
+
+    mock_get_comm.return_value = MockComm()
+
+    ad_model = with_autodiff(Model())
+    m_x, _ = randn((2, 16), dtype="float32")
+    m_dy, _ = randn((), dtype="float32")
+    mod = InferType()(ad_model._internal(m_dy, m_x).mod)
+    mod = PartitionGradient(1, 4, 1, 5000000000, "cuda(0)")(mod)
+    mod = InferType()(mod)
+    text = raf.ir.AsText(mod)
+    # Each of the 5 gradient partitions (x and 4 parameters) is copied to the host.
+    assert text.count("raf.op.split") == 5, text
+    assert text.count("raf.op.device_copy(") == 5, text
+    assert text.count('"cuda(0)", "cpu"') == 5, text
+
+
+@patch("raf.distributed.get_communicator")
+@patch("raf.distributed.get_config")
+@pytest.mark.parametrize("opt_level", [1, 2])
+def test_flat_buffer(mock_get_config, mock_get_comm, opt_level):
+    class Model(raf.Model):
+        def build(self):
+            self.linear1 = Linear(16, 8)
+            self.linear2 = Linear(8, 4)
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.sum(self.linear2(raf.relu(self.linear1(x))))
+
+    class MockConfig:
+        def __init__(self):
+            self.enable_data_parallel = True
+            self.zero_opt_level = opt_level
+
+    mock_get_config.return_value = MockConfig()
+
+    class MockComm:
+        def __init__(self):
+            self.size = 4
+            self.rank = 1
+
+    mock_get_comm.return_value = MockComm()
+    if opt_level == 2 and raf.build.with_nccl() is None:
+        pytest.skip("NCCL is not supported")
+
+    ad_model = with_autodiff(Model())
+    m_x, _ = randn((2, 16), dtype="float32")
+    m_dy, _ = randn((), dtype="float32")
+    mod = InferType()(ad_model._internal(m_dy, m_x).mod)
+    # The gradients of the 4 parameters (8 + 32 + 128 + 4 elements) are packed into one flat
+    # buffer, while the gradient of x is partitioned alone.
+    mod = PartitionGradient(opt_level, 4, 1, 5000000000, "", [[1, 2, 3, 4]])(mod)
+    mod = InferType()(mod)
+    text = raf.ir.AsText(mod)
+    assert text.count("raf.op.concatenate(") == 1, text
+    # Only the gradient of x in shape (2, 16) is padded.
+    assert text.count("raf.op.pad(") == 1, text
+    if opt_level == 1:
+        assert text.count("raf.op.split(") == 2, text
+    else:
+        assert text.count("raf.op._reduce_scatter(") == 1, text
+
+    # The 4 gradients are replaced by the same partition of the flat buffer in shape (43,).
+    ret_type = mod["main"].checked_type.ret_type
+    grad_types = ret_type.fields[1].fields
+    assert all(tuple(grad_types[i].shape) == (43,) for i in range(1, 5))
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,79 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init
+import math
+import pytest
+
+import raf
+from raf._ffi.pass_ import PartitionParameter, InferType
+from raf.model import Linear
+from raf.model.trace import _get_func_inputs
+from raf.optim.optim import with_autodiff
+from raf.testing import randn
+
+
+class Model(raf.Model):
+    def build(self):
+        self.linear1 = Linear(10, 7)
+        self.linear2 = Linear(7, 5)
+
+    @raf.model.trace
+    def forward(self, x):
+        out = self.linear1(x)
+        out = raf.relu(out)
+        out = self.linear2(out)
+        return raf.sum(out)
+
+
+@pytest.mark.parametrize("n_part", [1, 4])
+def test_partition_parameter(n_part):
+    model = Model()
+    ad_model = with_autodiff(model)
+    m_x, _ = randn((3, 10), dtype="float32")
+    m_dy, _ = randn((), dtype="float32")
+    record = ad_model._internal(m_dy, m_x)
+    mod = InferType()(record.mod)
+    params = {param._ndarray__handle: param for param in ad_model.state().values()}
+    inputs = _get_func_inputs(record, [m_dy, m_x], {})
+    param_indices = [i for i, x in enumerate(inputs) if x in params]
+    assert len(param_indices) == 4
+
+    mod = PartitionParameter(n_part, param_indices)(mod)
+    func = mod["main"]
+    for idx in param_indices:
+        dim0 = params[inputs[idx]].shape[0]
+        assert func.params[idx].type_annotation.concrete_shape[0] == math.ceil(dim0 / n_part)
+
+    text = raf.ir.AsText(func)
+    # Each parameter is gathered before the forward, and some are gathered again before the
+    # backward.
+    n_gather = text.count("raf.op._allgather(")
+    assert n_gather > len(param_indices), text
+    # The first dimensions of all parameters are not dividable by 4, so all of them are padded.
+    assert text.count("raf.op.strided_slice(") == (n_gather if n_part == 4 else 0), text
+    if n_part == 1:
+        # The allgather type is inferred with the global communicator, which has only one rank.
+        InferType()(mod)
+
+
+def test_partition_parameter_gather_once():
+    model = Model()
+    ad_model = with_autodiff(model)
+    m_x, _ = randn((3, 10), dtype="float32")
+    m_dy, _ = randn((), dtype="float32")
+    record = ad_model._internal(m_dy, m_x)
+    mod = InferType()(record.mod)
+    params = {param._ndarray__handle: param for param in ad_model.state().values()}
+    inputs = _get_func_inputs(record, [m_dy, m_x], {})
+    param_indices = [i for i, x in enumerate(inputs) if x in params]
+
+    # The deferred allgather of ZeRO-1/2 keeps the parameters gathered in the forward for the
+    # backward, so each parameter is gathered only once.
+    mod = PartitionParameter(4, param_indices, False)(mod)
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op._allgather(") == len(param_indices), text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
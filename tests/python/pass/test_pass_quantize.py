@@ -0,0 +1,62 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+import numpy as np
+import pytest
+import raf
+from raf._core.executor import VMExecutor
+from raf.testing import check, randn
+
+
+def count_ops(mod, op_name):
+    text = raf.ir.AsText(mod["main"])
+    return text.count(op_name + "(")
+
+
+class Model(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x, w1, w2):
+        a_1 = raf.relu(raf.conv2d(x, w1, padding=1))
+        a_2 = raf.reshape(a_1, (2, 8 * 8 * 8))
+        return raf.dense(a_2, w2)
+
+
+def gen_args():
+    x = randn((2, 4, 8, 8))[0]
+    w1 = randn((8, 4, 3, 3))[0]
+    w2 = randn((16, 8 * 8 * 8))[0]
+    return [x, w1, w2]
+
+
+def test_insert_observers():
+    model = Model()
+    mod = model._internal(*gen_args()).mod
+    mod = raf._ffi.pass_.InsertQuantObservers()(mod)
+    assert count_ops(mod, "raf.op.max") == 2
+    ret_type = mod["main"].checked_type.ret_type
+    assert len(ret_type.fields) == 3
+
+
+def test_quantize():
+    model = Model()
+    args = gen_args()
+    ref = model(*args)
+    abs_max = raf.quantization.calibrate(model, [args], "cpu")
+    assert len(abs_max) == 2
+    assert np.isclose(abs_max[0], np.abs(args[0].numpy()).max())
+
+    q_model = raf.quantization.quantize(model, args, abs_max)
+    mod = q_model._internal(*args).mod
+    assert count_ops(mod, "raf.op.quantized_conv2d") == 1
+    assert count_ops(mod, "raf.op.quantized_dense") == 1
+    out = VMExecutor(mod, "cpu").make_executor()(*args)
+    # The int8 error of the dense is relative to the range of its inputs.
+    check(out, ref, rtol=0.1, atol=0.05 * np.abs(ref.numpy()).max())
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -12,13 +12,13 @@ from raf._ffi.memory_pool import InitPool
 from raf.ir import ScopeBuilder
 from raf.model import Conv2d
 from raf.model.trace import _get_func_inputs
-from raf.testing import run_infer_type, randn
+from raf.testing import check, run_infer_type, randn
 
 import tvm
 from tvm import relay
 
 
-def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks):
+def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks, planner="greedy"):
     """Verify the result of rematerialization pass.
 
     Parameters
@@ -33,6 +33,8 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
         The expected IR after rematerialization.
     expected_peaks: Tuple[float, float]
         The expected peak memory in MBs without and with rematerialization.
+    planner: str
+        The rematerialization planner.
     """
     if not isinstance(model_or_mod, tvm.IRModule):
         record = model_or_mod._internal(*args)
@@ -47,6 +49,7 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
             config={
                 "raf.memory_budget": int(budget_in_mbs * 1048576),
                 "raf.remat.use_gflops_cost": True,
+                "raf.remat.planner": planner,
             }
         ):
             ir_mod = raf._ffi.pass_.InferType()(ir_mod)
@@ -78,6 +81,7 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
                 "raf.memory_budget": int(budget * 1048576),
                 # Use GFLOPS cost to avoid flaky behavior in tests
                 "raf.remat.use_gflops_cost": True,
+                "raf.remat.planner": planner,
             },
         ):
             raf.utils.memory_profiler.reset()
@@ -95,7 +99,8 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
 
 
 @pytest.mark.parametrize("budget_type", ["low", "remat", "high"])
-def test_simple(budget_type):
+@pytest.mark.parametrize("planner", ["greedy", "dp"])
+def test_simple(budget_type, planner):
     shape = (16, 16, 64, 64)  # 4 MBs
     data_size, weight_size = np.prod(shape), np.prod((16, 16, 3, 3))
 
@@ -239,7 +244,65 @@ def test_simple(budget_type):
         sb.ret(a_9)
         return relay.Function([data, weight], sb.get())
 
-    verify_remat(model, [m_x], budget, expected(), (before_peak, budget))
+    verify_remat(model, [m_x], budget, expected(), (before_peak, budget), planner)
+
+
+@pytest.mark.parametrize("policy", ["never", "prefer", "checkpoint"])
+def test_recompute_policy(policy):
+    shape = (16, 16, 64, 64)  # 4 MBs
+    data_size, weight_size = np.prod(shape), np.prod((16, 16, 3, 3))
+    # Need to rematerialize one tensor to fit into this budget.
+    budget = data_size * 5 + weight_size
+
+    class Model(raf.Model):
+        def build(self):
+            self.conv = Conv2d(16, 16, kernel_size=(3, 3), padding=1, bias=False)
+
+        @raf.model.trace
+        def forward(self, x):
+            a_1 = self.conv(x)
+            a_2 = raf.max_pool2d(a_1, (3, 3), 1, 1)
+            a_3 = raf.max_pool2d(a_2, (3, 3), 1, 1)
+            a_4 = raf.max_pool2d(a_3, (3, 3), 1, 1)
+
+            a_5 = raf.max_pool2d_dx(a_3, a_4, a_4, (3, 3), 1, 1, 1, False, True)
+            a_6 = raf.max_pool2d_dx(a_2, a_3, a_5, (3, 3), 1, 1, 1, False, True)
+            a_7 = raf.max_pool2d_dx(a_1, a_2, a_6, (3, 3), 1, 1, 1, False, True)
+            a_8 = raf.conv2d_dx(x, a_1, a_7, shape, 1, 1, 1, 1)
+            a_9 = raf.softmax(a_8)
+            return a_9
+
+    m_x, _ = randn(shape, device="cpu")
+    config = {
+        "raf.memory_budget": int(budget * 4),
+        "raf.remat.use_gflops_cost": True,
+    }
+    if policy == "never":
+        config["raf.remat.never_recompute"] = ["max_pool2d"]
+    elif policy == "prefer":
+        config["raf.remat.prefer_recompute"] = ["raf.op.conv2d"]
+    else:
+        # Only keep the output of conv2d, which is the input of the max_pool2d "layers".
+        config["raf.remat.never_recompute"] = ["conv2d"]
+        config["raf.remat.policy"] = "checkpoint"
+
+    mod = Model()._internal(m_x).mod
+    with Device("cpu"):
+        with raf.ir.PassContext(config=config):
+            mod = raf._ffi.pass_.InferType()(mod)
+            mod = raf._ffi.pass_.InlinePrimitives()(mod)
+            mod = raf._ffi.pass_.InplaceUpdate()(mod)
+            mod = raf._ffi.pass_.Rematerialization()(mod)
+    text = raf.ir.AsText(mod["main"])
+    num_conv2d = text.count("raf.op.conv2d(")
+    num_max_pool2d = text.count("raf.op.max_pool2d(")
+    if policy == "never":
+        # max_pool2d is cheaper to recompute, but conv2d has to be recomputed instead.
+        assert num_conv2d == 2 and num_max_pool2d == 3, text
+    elif policy == "prefer":
+        assert num_conv2d == 2, text
+    else:
+        assert num_conv2d == 1 and num_max_pool2d > 3, text
 
 
 def test_closure():
@@ -666,5 +729,47 @@ def test_concat():
     verify_remat(get_mod(), [m_p0, m_p1], 32, get_mod()["main"], (24.00, 24.00))
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_offload():
+    shape = (16, 16, 64, 64)  # 4 MBs
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            a_1 = raf.relu(x)
+            a_2 = raf.max_pool2d(a_1, (3, 3), 1, 1)
+            a_3 = raf.max_pool2d(a_2, (3, 3), 1, 1)
+            a_4 = raf.max_pool2d_dx(a_2, a_3, a_3, (3, 3), 1, 1, 1, False, True)
+            a_5 = raf.add(a_4, a_1)
+            return a_5
+
+    model = Model()
+    m_x, _ = randn(shape, device="cuda")
+    record = model._internal(m_x)
+    mod = record.mod
+
+    def run(offload_bandwidth):
+        # A very high bandwidth makes offloading always cheaper than recomputing.
+        config = {"raf.memory_budget": int(17 * 1048576)}
+        if offload_bandwidth:
+            config["raf.remat.offload_bandwidth"] = offload_bandwidth
+        with Device("cuda"):
+            with raf.ir.PassContext(config=config):
+                ir_mod = raf._ffi.pass_.InferType()(mod)
+                ir_mod = raf._ffi.pass_.Rematerialization()(ir_mod)
+        with tvm.transform.PassContext(opt_level=3, config=config):
+            out = VMExecutor(mod, "cuda").make_executor()(m_x)
+        return raf.ir.AsText(ir_mod["main"]), out
+
+    remat_text, remat_out = run(0)
+    offload_text, offload_out = run(1000000)
+    assert "raf.op.device_copy" not in remat_text
+    assert offload_text.count("raf.op.device_copy") == 2, offload_text
+    check(offload_out, remat_out)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
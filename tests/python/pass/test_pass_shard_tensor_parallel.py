@@ -0,0 +1,138 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init
+import pytest
+
+import raf
+from raf._ffi.pass_ import ShardTensorParallel, AutoDiff, InferType
+from raf.model import Linear
+from raf.model.trace import _get_func_inputs
+from raf.testing import randn, randint
+
+
+class MLP(raf.Model):
+    def build(self):
+        self.linear1 = Linear(8, 16)
+        self.linear2 = Linear(16, 8)
+
+    @raf.model.trace
+    def forward(self, x):
+        out = self.linear1(x)
+        out = raf.relu(out)
+        out = self.linear2(out)
+        return raf.sum(out)
+
+
+class TransformerMLP(raf.Model):
+    def build(self):
+        self.linear1 = Linear(8, 16)
+        self.linear2 = Linear(16, 8)
+        self.ln_w, _ = randn((8,), requires_grad=True)
+        self.ln_b, _ = randn((8,), requires_grad=True)
+
+    @raf.model.trace
+    def forward(self, x):
+        out = self.linear1(x)
+        out = raf.gelu(out)
+        out = self.linear2(out)
+        out = raf._op.sym._contrib_dropout(out, p=0.1)[0]
+        out = raf.add(out, x)
+        out = raf.layer_norm(out, self.ln_w, self.ln_b)
+        return raf.sum(out)
+
+
+class Embedding(raf.Model):
+    def build(self):
+        self.table, _ = randn((16, 4), requires_grad=True)
+
+    @raf.model.trace
+    def forward(self, indices):
+        return raf.sum(raf.embedding(self.table, indices))
+
+
+def shard(model, args, specs, n_part, rank):
+    record = model._internal(*args)
+    params = {param._ndarray__handle: name for name, param in model.state().items()}
+    inputs = _get_func_inputs(record, args, {})
+    param_indices = [i for i, x in enumerate(inputs) if x in params]
+    axes = [specs.get(params[inputs[i]], -1) for i in param_indices]
+    mod = ShardTensorParallel(n_part, rank, param_indices, axes)(record.mod)
+    return mod, {params[inputs[i]]: i for i in param_indices}
+
+
+@pytest.mark.parametrize("n_part", [1, 4])
+def test_mlp(n_part):
+    model = MLP()
+    m_x, _ = randn((2, 8), dtype="float32")
+    specs = {"linear1.w": 0, "linear1.b": 0, "linear2.w": 1}
+    mod, indices = shard(model, [m_x], specs, n_part, n_part - 1)
+    func = mod["main"]
+    shapes = {name: func.params[idx].type_annotation.concrete_shape for name, idx in indices.items()}
+    assert shapes["linear1.w"] == (16 // n_part, 8)
+    assert shapes["linear1.b"] == (16 // n_part,)
+    assert shapes["linear2.w"] == (8, 16 // n_part)
+    assert shapes["linear2.b"] == (8,)
+
+    # The input is gathered before the column parallel dense, the output of the row parallel dense
+    # is reduce-scattered, and the replicated bias is broadcasted. The relu and the bias add of the
+    # column parallel dense work on the partitioned features.
+    text = raf.ir.AsText(func)
+    assert text.count("raf.op._allgather(") == 1, text
+    assert text.count("raf.op._reduce_scatter(") == 1, text
+    assert text.count("raf.op._broadcast(") == 1, text
+    assert "raf.op.transpose(" not in text, text
+    if n_part == 1:
+        # The collectives are inferred with the global communicator, which has only one rank.
+        mod = AutoDiff([])(InferType()(mod))
+        InferType()(mod)
+
+
+def test_mlp_gather_features():
+    # The column parallel output is used by a reduction, so the features are gathered.
+    model = MLP()
+    m_x, _ = randn((2, 8), dtype="float32")
+    mod, _ = shard(model, [m_x], {"linear2.w": 0, "linear2.b": 0}, 2, 1)
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op._allgather(") == 2, text
+    assert text.count("raf.op.transpose(") == 2, text
+    assert text.count("raf.op.strided_slice(") == 1, text
+    assert text.count("raf.op._broadcast(") == 2, text
+
+
+@pytest.mark.parametrize("n_part", [1, 4])
+def test_sequence_parallel_region(n_part):
+    # The dropout, the residual add and the layer norm after the row parallel dense work on the
+    # local tokens that the reduce-scatter leaves, so no allreduce is inserted and the region is
+    # not replicated across ranks.
+    model = TransformerMLP()
+    m_x, _ = randn((16, 8), dtype="float32")
+    specs = {"linear1.w": 0, "linear1.b": 0, "linear2.w": 1}
+    mod, _ = shard(model, [m_x], specs, n_part, 0)
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op._allgather(") == 1, text
+    assert text.count("raf.op._reduce_scatter(") == 1, text
+    assert "raf.op._allreduce(" not in text, text
+    # The bias of the row parallel dense and the layer norm parameters are replicated.
+    assert text.count("raf.op._broadcast(") == 3, text
+    if n_part == 1:
+        InferType()(mod)
+
+
+@pytest.mark.parametrize("n_part", [1, 4])
+def test_embedding(n_part):
+    model = Embedding()
+    m_indices, _ = randint((2, 3), low=0, high=16)
+    mod, indices = shard(model, [m_indices], {"table": 0}, n_part, 0)
+    func = mod["main"]
+    assert func.params[indices["table"]].type_annotation.concrete_shape == (16 // n_part, 4)
+    text = raf.ir.AsText(func)
+    assert text.count("raf.op._allgather(") == 1, text
+    assert text.count("raf.op._reduce_scatter(") == 1, text
+    assert text.count("raf.op.clip(") == 1, text
+    if n_part == 1:
+        InferType()(mod)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
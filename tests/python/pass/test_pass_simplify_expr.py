@@ -151,6 +151,162 @@ def test_reshape():
     assert "raf.op.reshape" not in text, text
 
 
+def test_transpose():
+    device = "cpu"
+    shape = (2, 3, 4)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.transpose(x, (0, 2, 1))
+            y = raf.transpose(y, (0, 2, 1))
+            z = raf.transpose(y, (1, 0, 2))
+            z = raf.transpose(z, (2, 1, 0))
+            return z
+
+    model = Model()
+    m_x, _ = randn(shape, device=device, dtype="float32")
+    mod = model._internal(m_x).mod
+    mod = simplify(mod, device)
+    text = raf.ir.AsText(mod["main"])
+    # The first two cancel out, and the last two become one.
+    assert text.count("raf.op.transpose") == 1, text
+    ret_type = InferType()(mod)["main"].checked_type.ret_type
+    assert tuple(int(dim) for dim in ret_type.shape) == (4, 2, 3), text
+
+
+@pytest.mark.parametrize("op", ["matmul", "matmul_nt", "matmul_tn", "dense", "batch_matmul_tt"])
+@pytest.mark.parametrize("trans", [[True, False], [False, True], [True, True]])
+def test_transpose_matmul(op, trans):
+    device = "cpu"
+    is_batch = op.startswith("batch")
+    shape = (2, 4, 4) if is_batch else (4, 4)
+    axes = (0, 2, 1) if is_batch else (1, 0)
+    op_trans = [op.endswith(("_tn", "_tt")), op.endswith(("_nt", "_tt")) or op == "dense"]
+    matmul_op = getattr(raf._op.sym, op)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            x = raf.transpose(x, axes) if trans[0] else x
+            w = raf.transpose(w, axes) if trans[1] else w
+            return matmul_op(x, w)
+
+    model = Model()
+    m_x, _ = randn(shape, device=device, dtype="float32")
+    m_w, _ = randn(shape, device=device, dtype="float32")
+    mod = model._internal(m_x, m_w).mod
+    mod = simplify(mod, device)
+    text = raf.ir.AsText(mod["main"])
+    assert "raf.op.transpose" not in text, text
+    new_trans = [a != b for a, b in zip(trans, op_trans)]
+    suffix = "_%s%s" % tuple("t" if t else "n" for t in new_trans)
+    new_op = ("batch_matmul" if is_batch else "matmul") + ("" if suffix == "_nn" else suffix)
+    assert "raf.op.%s(" % new_op in text, text
+
+
+def test_reshape_elemwise():
+    device = "cpu"
+    shape = (2, 3, 4)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.reshape(x, (6, 4))
+            y = raf.gelu(y)
+            y = raf.reshape(y, shape)
+            z = raf.reshape(y, (2, 12))
+            z = raf.relu(z)
+            z = raf.reshape(z, (24,))
+            return z
+
+    model = Model()
+    m_x, _ = randn(shape, device=device, dtype="float32")
+    mod = model._internal(m_x).mod
+    mod = simplify(mod, device)
+    text = raf.ir.AsText(mod["main"])
+    # The first pair cancels out, and the second pair becomes one.
+    assert text.count("raf.op.reshape") == 1, text
+    assert "raf.op.gelu(%x" in text, text
+
+
+@pytest.mark.parametrize("op", ["conv2d", "max_pool2d", "avg_pool2d"])
+@pytest.mark.parametrize("layout", ["NCHW", "NHWC"])
+@pytest.mark.parametrize("symmetric", [False, True])
+def test_pad_conv_pool(op, layout, symmetric):
+    device = "cpu"
+    shape = (2, 4, 8, 8) if layout == "NCHW" else (2, 8, 8, 4)
+    # The (before, after) padding of each axis.
+    spatial_pad = (1, 1, 2, 2) if symmetric else (0, 1, 1, 2)
+    pad_width = (0, 0, 0, 0) + spatial_pad if layout == "NCHW" else (0, 0) + spatial_pad + (0, 0)
+    pad_value = float("-inf") if op == "max_pool2d" else 0.0
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            y = raf.pad(x, pad_width, pad_value)
+            if op == "conv2d":
+                kernel_layout = "OIHW" if layout == "NCHW" else "OHWI"
+                return raf.conv2d(
+                    y, w, padding=1, layout=layout, kernel_layout=kernel_layout, out_layout=layout
+                )
+            pool_op = getattr(raf, op)
+            return pool_op(y, 3, 1, padding=1, layout=layout)
+
+    model = Model()
+    m_x, _ = randn(shape, device=device, dtype="float32")
+    wshape = (4, 4, 3, 3) if layout == "NCHW" else (4, 3, 3, 4)
+    m_w, _ = randn(wshape, device=device, dtype="float32")
+    mod = model._internal(m_x, m_w).mod
+    ty_before = InferType()(mod)["main"].checked_type.ret_type
+    mod = simplify(mod, device)
+    text = raf.ir.AsText(mod["main"])
+    assert "raf.op.pad" not in text, text
+    ty_after = InferType()(mod)["main"].checked_type.ret_type
+    assert tvm.ir.structural_equal(ty_before, ty_after)
+
+
+def test_pad_conv_pool_not_folded():
+    device = "cpu"
+    shape = (2, 4, 8, 8)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            # The non-zero pad cannot be folded into conv2d, the zero pad cannot be folded into
+            # max_pool2d, and the pad of the channels cannot be folded.
+            y1 = raf.conv2d(raf.pad(x, (0, 0, 0, 0, 1, 1, 1, 1), 1.0), w)
+            y2 = raf.max_pool2d(raf.pad(x, (0, 0, 0, 0, 1, 1, 1, 1)), 3, 1)
+            y3 = raf.avg_pool2d(raf.pad(x, (0, 0, 1, 1, 1, 1, 1, 1)), 3, 1)
+            # The pad that is used twice is kept anyway.
+            y4 = raf.pad(x, (0, 0, 0, 0, 1, 1, 1, 1))
+            y4 = raf.add(raf.conv2d(y4, w), raf.sum(y4))
+            return y1, y2, y3, y4
+
+    model = Model()
+    m_x, _ = randn(shape, device=device, dtype="float32")
+    m_w, _ = randn((4, 4, 3, 3), device=device, dtype="float32")
+    mod = model._internal(m_x, m_w).mod
+    mod = simplify(mod, device)
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op.pad") == 4, text
+
+
 @pytest.mark.parametrize("ndim", [2, 3])
 @pytest.mark.parametrize("act", [False, True])
 @pytest.mark.parametrize("shape_compatible", [False, True])
@@ -295,5 +451,42 @@ def test_dropout():
     assert "raf.op._contrib_dropout" not in text, text
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("scale_op", [None, "multiply", "divide"])
+@pytest.mark.parametrize("dropout", [False, True])
+def test_attention(scale_op, dropout):
+    device = "cuda"
+    shape = (6, 16, 32)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, q, k, v):
+            scores = raf.batch_matmul_nt(q, k)
+            if scale_op is not None:
+                scores = getattr(raf, scale_op)(scores, 8.0)
+            probs = raf.softmax(scores, axis=-1)
+            if dropout:
+                probs = raf._op.sym._contrib_dropout(probs, p=0.1)[0]
+            return raf.batch_matmul(probs, v)
+
+    model = Model()
+    args = [randn(shape, device=device, dtype="float32")[0] for _ in range(3)]
+    mod = simplify(InferType()(model._internal(*args).mod), device)
+    text = raf.ir.AsText(mod["main"])
+    assert "raf.op.attention" in text and "raf.op.softmax" not in text, text
+
+    # The probabilities are used by the backward after AutoDiff, so they cannot be fused.
+    for arg in args:
+        arg.requires_grad = True
+    record = model._internal(*args)
+    mod = AutoDiff(record.requires_grads)(InferType()(record.mod))
+    mod = simplify(mod, device)
+    text = raf.ir.AsText(mod["main"])
+    assert "raf.op.attention" not in text, text
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
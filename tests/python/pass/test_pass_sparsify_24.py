@@ -0,0 +1,44 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import pytest
+import raf
+from raf._ffi.pass_ import Sparsify24, InferType
+from raf.testing import randn
+
+
+class Model(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x, w1, w2):
+        a_1 = raf.relu(raf.dense(x, w1))
+        # The weight of the second dense is an activation, so it is not sparsified.
+        a_2 = raf.dense(a_1, a_1)
+        return raf.matmul_nt(a_2, w2)
+
+
+@pytest.mark.parametrize("mode", ["none", "pruned", "prune"])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_sparsify_24(mode, dtype):
+    m_x, _ = randn((16, 32), dtype=dtype)
+    m_w1, _ = randn((16, 32), dtype=dtype)
+    m_w2, _ = randn((8, 16), dtype=dtype)
+    mod = InferType()(Model()._internal(m_x, m_w1, m_w2).mod)
+    ref_ret_type = mod["main"].checked_type.ret_type
+    with raf.ir.PassContext(config={"raf.sparsity_24": mode}):
+        mod = Sparsify24()(mod)
+    text = raf.ir.AsText(mod["main"])
+    if mode == "none" or dtype == "float32":
+        assert "raf.op.sparse24_dense(" not in text, text
+        return
+    assert text.count("raf.op.sparse24_dense(") == 2, text
+    assert text.count("raf.op.dense(") == 1, text
+    assert text.count("raf.op.prune_24(") == (2 if mode == "prune" else 0), text
+    assert mod["main"].checked_type.ret_type == ref_ret_type
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -2,6 +2,8 @@
 # SPDX-License-Identifier: Apache-2.0
 
 # pylint: disable=no-self-use, protected-access, unused-variable, too-many-locals, too-many-statements
+import re
+
 import pytest
 import raf
 from raf.testing import randn
@@ -215,5 +217,85 @@ def test_ios_schedule_stacked_blocks():
     verify_schedule(mod)
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_ios_schedule_memory_budget():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            outs = []
+            for _ in range(4):
+                outs.append(raf.sum(raf.atan(x), axis=1))
+            return raf.concatenate(outs)
+
+    model = Model()
+    input_shape = [1024, 256]  # 1 MB
+    x, _ = randn(input_shape)
+    mod = model._internal(x).mod
+
+    def get_num_streams(memory_budget):
+        with raf.ir.PassContext(
+            config={
+                "raf.stream_schedule.ios.max_stream_num": 8,
+                "raf.stream_schedule.ios.warmup": 1,
+                "raf.stream_schedule.ios.number": 2,
+                "raf.stream_schedule.ios.repeat": 2,
+                "raf.stream_schedule.ios.memory_budget": memory_budget,
+            }
+        ):
+            ret = raf._ffi.pass_.ToGraphNormalForm()(mod)
+            ret = raf._ffi.pass_.ToBasicBlockNormalForm()(ret)
+            ret = raf._ffi.pass_.InferType()(ret)
+            ret = raf._ffi.pass_.IOSStreamSchedule()(ret)
+        verify_schedule(ret)
+        stream_ids = re.findall(r"raf.op.set_stream\(int64\(0\), int64\((\d+)\)\)", str(ret))
+        return len(set(stream_ids))
+
+    # Each atan produces a 1 MB tensor, so at most 2 of them can be alive at the same time.
+    assert get_num_streams(2) <= 2
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("time_budget", [0, 1])
+def test_ios_schedule_repeated_blocks(time_budget):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            # The identical layers are scheduled once. With a tight time budget, the blocks are
+            # scheduled by beam search instead.
+            for _ in range(4):
+                p_0 = raf.atan(x)
+                p_1 = raf.relu(raf.atan(x))
+                p_2 = raf.atan(raf.relu(raf.atan(x)))
+                x = raf.concatenate([p_0, p_1, p_2], axis=1)
+                x = raf.sum(x, axis=1, keepdims=True)
+            return x
+
+    model = Model()
+    x, _ = randn([64, 1])
+    mod = model._internal(x).mod
+
+    with raf.ir.PassContext(
+        config={
+            "raf.stream_schedule.ios.max_stream_num": 4,
+            "raf.stream_schedule.ios.warmup": 1,
+            "raf.stream_schedule.ios.number": 2,
+            "raf.stream_schedule.ios.repeat": 2,
+            "raf.stream_schedule.ios.time_budget": time_budget,
+            "raf.stream_schedule.ios.beam_width": 2,
+        }
+    ):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.InferType()(mod)
+        mod = raf._ffi.pass_.IOSStreamSchedule()(mod)
+    verify_schedule(mod)
+
+
 if __name__ == "__main__":
     pytest.main([__file__, "-s"])
@@ -0,0 +1,66 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import os
+
+import numpy as np
+import pytest
+import raf
+from raf.testing import check, get_testable_devices, randn
+from raf.utils import checkpoint
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_checkpoint(device, tmp_path):
+    path = str(tmp_path / "ckpt")
+    m_w, n_w = randn((5, 7), device=device)
+    m_b, n_b = randn((7,), device=device)
+    m_s = raf.array(np.arange(3, dtype="int64"), device=device)
+
+    # Each rank saves its own shard.
+    handles = [
+        checkpoint.save(path, {"w": m_w, "b": m_b}, rank=0),
+        checkpoint.save(path, {"step": m_s}, rank=1),
+    ]
+    # The tensors are snapshotted, so updating them does not change the checkpoint.
+    m_w.update(raf.array(np.zeros((5, 7), dtype="float32"), device=device))
+    for handle in handles:
+        handle.wait()
+        assert handle.done()
+    assert os.path.getsize(os.path.join(path, "rank0.data")) % 4096 == 5 * 7 * 4
+
+    for load_device in ["cpu", device]:
+        state = checkpoint.load(path, device=load_device, rank=0)
+        assert sorted(state.keys()) == ["b", "w"]
+        assert state["w"].device.startswith(load_device)
+        check(state["w"], n_w)
+        check(state["b"], n_b)
+        state = checkpoint.load(path, device=load_device, rank=1)
+        check(state["step"], np.arange(3, dtype="int64"))
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("device_copy", [False, True])
+def test_checkpoint_manager(device, device_copy, tmp_path):
+    m_w, _ = randn((64, 33), device=device)
+    manager = checkpoint.CheckpointManager(
+        str(tmp_path), every=2, keep=2, num_threads=3, device_copy=device_copy
+    )
+    expected = {}
+    for step in range(6):
+        # Emulate the in-place update of the optimizer.
+        n_w = m_w.numpy() + 1
+        m_w.update(raf.array(n_w, device=device))
+        path = manager.step(step, lambda: {"w": m_w})
+        assert (path is not None) == (step % 2 == 1)
+        if path is not None:
+            expected[path] = n_w
+    manager.wait()
+    assert manager.saved == [str(tmp_path / "step-3"), str(tmp_path / "step-5")]
+    assert not os.path.exists(str(tmp_path / "step-1" / "rank0.data"))
+    for path in manager.saved:
+        check(checkpoint.load(path, device=device)["w"], expected[path])
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
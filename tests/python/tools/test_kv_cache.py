@@ -0,0 +1,81 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init,no-self-use,too-many-arguments,too-many-locals
+import numpy as np
+import pytest
+import raf
+from raf.testing import check, get_testable_devices, randn, run_vm_model
+from raf.utils import kv_cache
+
+
+def test_block_allocator():
+    cache = kv_cache.KVCache(1, num_blocks=4, block_size=2, token_shape=(3,))
+    assert cache.caches[0][0].shape == (4, 2, 3)
+    slots_a = cache.append(0, 3).numpy()
+    slots_b = cache.append(1, 1).numpy()
+    # Sequence 0 takes two blocks and sequence 1 takes one.
+    assert cache.num_free_blocks == 1
+    assert slots_a[0] // 2 == slots_a[1] // 2 != slots_a[2] // 2
+    assert slots_b[0] // 2 not in slots_a // 2
+    # The next token of sequence 0 fills its second block.
+    assert cache.append(0, 1).numpy()[0] == slots_a[2] + 1
+    np.testing.assert_equal(cache.seq_lens([0, 1]).numpy(), [4, 1])
+    tables = cache.block_tables([0, 1]).numpy()
+    np.testing.assert_equal(tables[0], [slots_a[0] // 2, slots_a[2] // 2])
+    np.testing.assert_equal(tables[1], [slots_b[0] // 2, 0])
+    with pytest.raises(Exception, match="Out of KV cache blocks"):
+        cache.append(1, 4)
+    # The failed append takes no block, and the freed blocks are reused.
+    assert cache.num_free_blocks == 1
+    cache.free(0)
+    assert cache.num_free_blocks == 3
+    cache.append(2, 6)
+    assert cache.num_free_blocks == 0
+
+
+class DecodeStep(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, q, k, v, k_cache, v_cache, slots, tables, mask):
+        k_cache = raf.kv_cache_append(k_cache, k, slots)
+        v_cache = raf.kv_cache_append(v_cache, v, slots)
+        keys = raf.kv_cache_gather(k_cache, tables)
+        values = raf.kv_cache_gather(v_cache, tables)
+        keys = raf.reshape(keys, (-1, 8))
+        values = raf.reshape(values, (-1, 8))
+        scores = raf.add(raf.matmul_nt(q, keys), mask)
+        return raf.matmul(raf.softmax(scores), values)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_incremental_decoding(device):
+    cache = kv_cache.KVCache(1, num_blocks=8, block_size=2, token_shape=(1, 8), device=device)
+    k_cache, v_cache = cache.caches[0]
+    model = DecodeStep()
+    n_keys, n_values = [], []
+    for _ in range(5):
+        m_q, n_q = randn((1, 8), device=device)
+        m_k, n_k = randn((1, 1, 8), device=device)
+        m_v, n_v = randn((1, 1, 8), device=device)
+        n_keys.append(n_k.reshape(8))
+        n_values.append(n_v.reshape(8))
+        slots = cache.append(0, 1)
+        tables = cache.block_tables([0])
+        length = cache.seq_lens([0]).numpy()[0]
+        n_mask = np.zeros((1, tables.shape[1] * 2), dtype="float32")
+        n_mask[:, length:] = -1e9
+        m_mask = raf.array(n_mask, device=device)
+        args = [m_q, m_k, m_v, k_cache, v_cache, slots, tables, m_mask]
+        m_y = run_vm_model(model, device, args)
+        # Only the new token is computed, and the attention covers the whole prefix.
+        n_scores = n_q @ np.stack(n_keys).T
+        n_probs = np.exp(n_scores - n_scores.max())
+        n_probs /= n_probs.sum()
+        check(m_y, n_probs @ np.stack(n_values), rtol=1e-4, atol=1e-4)
+    # The caches are updated in place.
+    n_cache = k_cache.numpy().reshape(-1, 8)
+    n_slots = [s for b in cache.block_tables([0]).numpy()[0] for s in (2 * b, 2 * b + 1)]
+    check(n_cache[n_slots[:5]], np.stack(n_keys))
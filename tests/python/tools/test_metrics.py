@@ -0,0 +1,75 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+# pylint: disable=protected-access
+import pytest
+
+import raf
+from raf._op import sym
+from raf.utils import metrics
+from raf.testing import randn, get_vm_executor, run_vm_executor
+
+
+class TestModel(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x):  # pylint: disable=no-self-use
+        y = sym.relu(x)
+        return sym.add(y, x)
+
+
+def run_twice(device):
+    model = TestModel()
+    m_x, _ = randn((4, 4), device=device)
+    record = model._internal(m_x)
+    executor = get_vm_executor(record.mod, device)
+    for _ in range(2):
+        run_vm_executor(executor, record, [m_x], device)
+
+
+def test_vm_metrics():
+    metrics.reset()
+    run_twice("cpu")
+
+    latency = metrics.get("raf_vm_run_latency_us")
+    assert latency["type"] == "histogram"
+    assert latency["count"] == 2
+    assert sum(latency["bucket_counts"]) == 2
+    assert len(latency["bucket_counts"]) == len(latency["bounds"]) + 1
+    assert latency["sum"] > 0
+
+    # The OpEnvs are created by the first run and reused by the second one.
+    misses = metrics.get("raf_op_env_cache_total", result="miss")["value"]
+    fast_hits = metrics.get("raf_op_env_cache_total", result="fast_hit")["value"]
+    assert misses > 0
+    assert fast_hits == misses
+
+    used = metrics.get("raf_memory_pool_used_mb", device="cpu(0)", pool="page_unit_pool")
+    reserved = metrics.get("raf_memory_pool_reserved_mb", device="cpu(0)", pool="page_unit_pool")
+    assert used["type"] == reserved["type"] == "gauge"
+    assert 0 <= used["value"] <= reserved["value"]
+
+    metrics.reset()
+    assert metrics.get("raf_vm_run_latency_us")["count"] == 0
+    assert metrics.get("raf_op_env_cache_total", result="miss")["value"] == 0
+
+
+def test_export_prometheus():
+    metrics.reset()
+    run_twice("cpu")
+
+    lines = metrics.export_prometheus().splitlines()
+    assert "# TYPE raf_vm_run_latency_us histogram" in lines
+    assert "# TYPE raf_op_env_cache_total counter" in lines
+    assert "# TYPE raf_memory_pool_used_mb gauge" in lines
+    # The buckets are cumulative, so the overflow bucket has all observations.
+    assert 'raf_vm_run_latency_us_bucket{le="+Inf"} 2' in lines
+    assert "raf_vm_run_latency_us_count 2" in lines
+    # Each metric name has one HELP line.
+    helps = [line for line in lines if line.startswith("# HELP raf_op_env_cache_total ")]
+    assert len(helps) == 1
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
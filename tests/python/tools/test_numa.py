@@ -0,0 +1,51 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import os
+import subprocess
+import sys
+
+import pytest
+from raf.utils import numa
+
+
+def test_topology():
+    num_nodes = numa.num_nodes()
+    assert num_nodes >= 1
+    assert 0 <= numa.current_node() < num_nodes
+    if sys.platform.startswith("linux"):
+        assert numa.pin_thread(0)
+        assert numa.current_node() == 0
+    assert not numa.pin_thread(num_nodes)
+
+
+@pytest.mark.skipif(numa.num_nodes() < 2, reason="The host has a single NUMA node")
+def test_numa_cpu_model():
+    # The options are read once, so the model runs in a new process.
+    script = """
+import numpy as np
+import raf
+from raf._core.executor import VMExecutor
+from raf.testing import randn
+
+class Model(raf.Model):
+    def build(self):
+        self.w, _ = randn((32, 32))
+
+    @raf.model.trace
+    def forward(self, x):
+        return raf.relu(raf.matmul(x, self.w))
+
+model = Model()
+model.infer_mode()
+m_x, _ = randn((32, 32))
+ref = model(m_x).numpy()
+vm = VMExecutor(model._internal(m_x).mod, "cpu").vm
+np.testing.assert_allclose(vm.run(m_x).numpy(), ref, rtol=1e-5, atol=1e-5)
+"""
+    env = dict(os.environ, RAF_CPU_NUMA_BIND="1", RAF_CPU_NUMA_REPLICATE="1", RAF_CPU_NUMA_PIN="1")
+    subprocess.run([sys.executable, "-c", script], env=env, check=True)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -2,10 +2,11 @@
 # SPDX-License-Identifier: Apache-2.0
 
 # pylint: disable=no-self-use,protected-access
+import numpy as np
 import pytest
 
 import raf
-from raf._ffi.op_profiler import Profile, ProfileGroup, ResetCache, GetCacheSize
+from raf._ffi.op_profiler import Profile, ProfileBatch, ProfileGroup, ResetCache, GetCacheSize
 from raf.testing import get_testable_devices, run_infer_type, randn
 
 
@@ -40,6 +41,64 @@ def test_single_op(device_str):
     assert GetCacheSize(device) == 2
 
 
+@pytest.mark.parametrize("device_str", get_testable_devices())
+def test_batch(device_str):
+    data = raf.ir.var("x", shape=(16, 16))
+    softmax = run_infer_type(raf.ir.op.softmax(data)).body
+    relu = run_infer_type(raf.ir.op.relu(data)).body
+    data_big = raf.ir.var("x", shape=(64, 64))
+    softmax_big = run_infer_type(raf.ir.op.softmax(data_big)).body
+    non_call = run_infer_type(data)
+
+    device = raf.Device(device_str)
+    ResetCache(device)
+
+    # The duplicated softmax is profiled once, and the non-call expression costs nothing.
+    res = ProfileBatch([softmax, relu, softmax, softmax_big, non_call], device, 2, 1, 2, 2)
+    assert len(res) == 5
+    for item in res[:4]:
+        lat = item["latency"]
+        assert len(lat) == 2 and lat[0].value > 0 and lat[1].value > 0
+        assert item["workspace_size"].value == 0
+    assert [lat.value for lat in res[0]["latency"]] == [lat.value for lat in res[2]["latency"]]
+    assert all(lat.value == 0 for lat in res[4]["latency"])
+    assert GetCacheSize(device) == 3
+
+    # The batch shares the cache with single ops.
+    res = Profile(relu, device, 2, 1, 2)
+    assert GetCacheSize(device) == 3
+    ProfileBatch([relu, softmax_big], device, 2, 1, 2)
+    assert GetCacheSize(device) == 3
+
+
+def test_analytical_cost_model():
+    from raf._ffi.op_profiler import EstimateLatency
+    from raf.utils import cost_model
+
+    device = "cpu"
+    spec = cost_model.get_device_spec(device)
+    x = raf.ir.var("x", shape=(64, 32))
+    w = raf.ir.var("w", shape=(32, 16))
+    matmul = run_infer_type(raf.ir.op.matmul(x, w)).body
+    y = raf.ir.var("y", shape=(16, 16))
+    relu = run_infer_type(raf.ir.op.relu(y)).body
+
+    try:
+        # Compute bound.
+        cost_model.set_device_spec(device, 1.0, 1e9, 2.0)
+        lat = EstimateLatency(matmul, raf.Device(device)).value
+        np.testing.assert_allclose(lat, 2.0 + 2 * 64 * 32 * 16 / 1e9 * 1e6, rtol=1e-3)
+
+        # Memory bound: the input and output of relu.
+        cost_model.set_device_spec(device, 1e9, 1.0, 2.0)
+        lat = EstimateLatency(relu, raf.Device(device)).value
+        np.testing.assert_allclose(lat, 2.0 + 2 * 16 * 16 * 4 / 1e9 * 1e6, rtol=1e-3)
+    finally:
+        cost_model.set_device_spec(
+            device, spec["peak_gflops"], spec["peak_gbps"], spec["launch_us"]
+        )
+
+
 def test_no_compute_op():
     data = raf.ir.var("x", shape=(16, 16))
     expr = run_infer_type(data)  # expr is a var so no way to profile it.
@@ -6,8 +6,12 @@ import numpy as np
 
 import raf
 from raf._op import sym
+from raf.model import Linear
 from raf.utils import profiler
-from raf.testing import randn
+from raf._core.executor import VMExecutor
+from raf.testing import randn, run_vm_model, run_vm_executor
+from raf.testing.benchmark import benchmark_training
+from raf.testing.memory_benchmark import compare_with_baseline, measure_memory
 
 
 class TestNet(raf.Model):
@@ -39,6 +43,16 @@ class TestCuda(raf.Model):
         return raf.matmul(m_a, m_b)
 
 
+class TestMLP(raf.Model):
+    def build(self):
+        self.linear = Linear(8, 4)
+
+    @raf.model.trace
+    def forward(self, x, y_true):
+        y_pred = sym.log_softmax(self.linear(x))
+        return sym.nll_loss(y_true, y_pred)
+
+
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize("i", [0])
 def test_profiler_with_cuda(i):
@@ -73,6 +87,48 @@ def test_profiler_with_cuda(i):
     assert len(data["traceEvents"]) == 0
 
 
+@pytest.mark.skipif(not raf.build.with_cupti(), reason="CUPTI is not enabled")
+def test_kernel_trace():
+    profiler.clear()
+    m_x, _ = randn((4, 8), device="cuda")
+    m_y, _ = randn((8, 4), device="cuda")
+    model = TestCuda()
+    model.to(device="cuda")
+    run_vm_model(model, "cuda", [m_x, m_y])
+
+    profiler.start_kernel_trace(capacity=16)
+    for _ in range(20):
+        run_vm_model(model, "cuda", [m_x, m_y])
+    profiler.stop_kernel_trace()
+    data = profiler.get()
+    kernels = [e for e in data["traceEvents"] if e["cat"].startswith("CUPTI Stream")]
+    # Each activity has a begin and an end event, and only the latest ones are kept.
+    assert 0 < len(kernels) <= 2 * 16
+    assert any("matmul" in e["args"]["args_string"] for e in kernels)
+    assert all(e["ph"] in ("B", "E") for e in kernels)
+
+    profiler.clear()
+    data = profiler.get()
+    assert len(data["traceEvents"]) == 0
+
+
+@pytest.mark.skipif(not raf.build.with_nvtx(), reason="NVTX is not enabled")
+def test_nvtx():
+    m_x, _ = randn((4, 8), device="cuda")
+    m_y, _ = randn((8, 4), device="cuda")
+    model = TestCuda()
+    model.to(device="cuda")
+    enabled = profiler.nvtx_enabled()
+    try:
+        # The ranges do not change the results whether they are emitted or not.
+        for enable in [True, False]:
+            profiler.enable_nvtx(enable)
+            assert profiler.nvtx_enabled() == enable
+            run_vm_model(model, "cuda", [m_x, m_y])
+    finally:
+        profiler.enable_nvtx(enabled)
+
+
 @pytest.mark.parametrize("i", [0])
 def test_profiler_without_cuda(i):
     profiler.clear()
@@ -105,5 +161,80 @@ def test_profiler_without_cuda(i):
     assert len(data["traceEvents"]) == 0
 
 
+def test_analyze_utilization():
+    device = "cpu"
+    model = TestCuda()
+    m_a, _ = randn((64, 32), device=device)
+    m_b, _ = randn((32, 16), device=device)
+    record = model._internal(m_a, m_b)
+    with raf.ir.PassContext(opt_level=3, config={"raf.vm.estimate_op_work": True}):
+        executor = VMExecutor(record.mod, device).make_executor()
+    # JIT the ops before profiling.
+    run_vm_executor(executor, record, [m_a, m_b], device)
+
+    profiler.clear()
+    profiler.start()
+    for _ in range(2):
+        run_vm_executor(executor, record, [m_a, m_b], device)
+    profiler.stop()
+    ret = profiler.analyze_utilization(device, peak_gflops=100.0, peak_gbps=10.0)
+    ops = [op for op in ret["ops"] if "matmul" in op["type"]]
+    assert len(ops) == 1 and ops[0]["count"] == 2
+    matmul = ops[0]
+    # Each matmul has 2 * 64 * 32 * 16 FLOPs and accesses (64 * 32 + 32 * 16 + 64 * 16) floats.
+    assert matmul["gflops"] == pytest.approx(2 * 2 * 64 * 32 * 16 / 1e9, rel=0.1)
+    assert matmul["gbytes"] == pytest.approx(2 * 4 * (64 * 32 + 32 * 16 + 64 * 16) / 1e9)
+    assert matmul["mfu"] == pytest.approx(matmul["achieved_gflops"] / 100.0)
+    assert matmul["bandwidth_util"] == pytest.approx(matmul["achieved_gbps"] / 10.0)
+    assert 0 < ret["coverage"] <= 1
+    assert ret["gflops"] >= matmul["gflops"]
+    # The whole step includes the gaps between the ops.
+    assert ret["makespan"] >= matmul["time"]
+    profiler.clear()
+
+
+def test_training_benchmark():
+    device = "cpu"
+    model = TestMLP()
+    model.to(device=device)
+    model.train_mode()
+    trainer = raf.optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(model)
+    m_dy = raf.array(np.ones((), dtype="float32"), device=device)
+    m_x, _ = randn((2, 8), device=device)
+    m_y = raf.array(np.array([1, 3], dtype="int64"), device=device)
+    ret = benchmark_training(trainer, [m_dy, m_x, m_y], 2, device, warmup=1, number=2)
+    assert set(ret["compile_breakdown"].keys()) == {"OptimizeModule", "CodeGen"}
+    assert "ManifestAlloc" in ret["passes"] and "MemoryPlan" in ret["passes"]
+    assert ret["jit"] and all(t >= 0 for t in ret["jit"].values())
+    # The passes run inside the compilation.
+    assert ret["passes"]["ManifestAlloc"] <= ret["compile"]
+    assert ret["samples_per_sec"] > 0
+    assert ret["peak_memory"]["max_used"] > 0
+
+
+
+def test_memory_benchmark():
+    device = "cpu"
+    model = TestMLP()
+    model.to(device=device)
+    model.train_mode()
+    trainer = raf.optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(model)
+    m_dy = raf.array(np.ones((), dtype="float32"), device=device)
+    m_x, _ = randn((2, 8), device=device)
+    m_y = raf.array(np.array([1, 3], dtype="int64"), device=device)
+    ret = measure_memory(trainer, [m_dy, m_x, m_y], device)
+    assert ret["estimated_peak"] > 0
+    assert ret["num_storages"] > 0 and ret["storage_size"] > 0
+    assert ret["measured_peak"]["max_used"] > 0
+    assert "remat" not in ret
+
+    results = {"mlp": ret}
+    assert not compare_with_baseline(results, results)
+    # A model missing in the baseline is skipped.
+    assert not compare_with_baseline(results, {})
+    baseline = {"mlp": dict(ret, num_storages=ret["num_storages"] - 1)}
+    regressions = compare_with_baseline(results, baseline, rtol=0)
+    assert len(regressions) == 1 and "num_storages" in regressions[0]
+
 if __name__ == "__main__":
     pytest.main([__file__])